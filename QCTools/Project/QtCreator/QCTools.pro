@@ -23,13 +23,24 @@ contains(DEFINES, USE_BREW) {
 SUBDIRS = \
         qctools-lib \
         qctools-cli \
+        qctools-bench \
+        qctools-microbench \
+        qctools-capi \
+        qctools-tests \
         qctools-gui
 
 qctools-lib.subdir = qctools-lib
 qctools-cli.subdir = qctools-cli
+qctools-bench.subdir = qctools-bench
+qctools-microbench.subdir = qctools-microbench
+qctools-capi.subdir = qctools-capi
+qctools-tests.subdir = qctools-tests
 qctools-gui.subdir = qctools-gui
 
 qctools-cli.depends = qctools-lib
+qctools-bench.depends = qctools-lib
+qctools-microbench.depends = qctools-lib
+qctools-capi.depends = qctools-lib
 qctools-gui.depends = qctools-lib
 
 message('leaving QCTools.pro')
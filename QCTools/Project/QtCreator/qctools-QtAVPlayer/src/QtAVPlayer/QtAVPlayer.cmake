@@ -35,6 +35,9 @@ set(QtAVPlayer_PRIVATE_HEADERS
     ${QT_AVPLAYER_DIR}/qavhwdevice_p.h
     ${QT_AVPLAYER_DIR}/qavdemuxer_p.h
     ${QT_AVPLAYER_DIR}/qavpacket_p.h
+    ${QT_AVPLAYER_DIR}/qavpool_p.h
+    ${QT_AVPLAYER_DIR}/qavbufferpool_p.h
+    ${QT_AVPLAYER_DIR}/qavtrace_p.h
     ${QT_AVPLAYER_DIR}/qavstreamframe_p.h
     ${QT_AVPLAYER_DIR}/qavframe_p.h
     ${QT_AVPLAYER_DIR}/qavpacketqueue_p.h
@@ -77,6 +80,8 @@ set(QtAVPlayer_SOURCES
     ${QT_AVPLAYER_DIR}/qavsubtitlecodec.cpp
     ${QT_AVPLAYER_DIR}/qavdemuxer.cpp
     ${QT_AVPLAYER_DIR}/qavpacket.cpp
+    ${QT_AVPLAYER_DIR}/qavpool.cpp
+    ${QT_AVPLAYER_DIR}/qavbufferpool.cpp
     ${QT_AVPLAYER_DIR}/qavframe.cpp
     ${QT_AVPLAYER_DIR}/qavstreamframe.cpp
     ${QT_AVPLAYER_DIR}/qavvideoframe.cpp
@@ -12,6 +12,9 @@ PRIVATE_HEADERS += \
     $$PWD/qavhwdevice_p.h \
     $$PWD/qavdemuxer_p.h \
     $$PWD/qavpacket_p.h \
+    $$PWD/qavpool_p.h \
+    $$PWD/qavbufferpool_p.h \
+    $$PWD/qavtrace_p.h \
     $$PWD/qavstreamframe_p.h \
     $$PWD/qavframe_p.h \
     $$PWD/qavpacketqueue_p.h \
@@ -52,6 +55,8 @@ SOURCES += \
     $$PWD/qavsubtitlecodec.cpp \
     $$PWD/qavdemuxer.cpp \
     $$PWD/qavpacket.cpp \
+    $$PWD/qavpool.cpp \
+    $$PWD/qavbufferpool.cpp \
     $$PWD/qavframe.cpp \
     $$PWD/qavstreamframe.cpp \
     $$PWD/qavvideoframe.cpp \
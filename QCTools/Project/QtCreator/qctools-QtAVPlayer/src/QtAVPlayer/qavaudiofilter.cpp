@@ -71,8 +71,9 @@ int QAVAudioFilter::write(const QAVFrame &frame)
 
     for (auto &filter : d->inputs) {
         QAVFrame ref = d->sourceFrame;
-        QMutexLocker locker(&d->graphMutex);
+        d->lockGraph();
         int ret = av_buffersrc_add_frame_flags(filter.ctx(), ref.frame(), AV_BUFFERSRC_FLAG_PUSH);
+        d->graphMutex.unlock();
         if (ret < 0)
             return ret;
     }
@@ -102,10 +103,9 @@ int QAVAudioFilter::read(QAVFrame &frame)
                 QAVFrame out = d->sourceFrame;
                 // av_buffersink_get_frame_flags allocates frame's data
                 av_frame_unref(out.frame());
-                {
-                    QMutexLocker locker(&d->graphMutex);
-                    ret = av_buffersink_get_frame_flags(filter.ctx(), out.frame(), 0);
-                }
+                d->lockGraph();
+                ret = av_buffersink_get_frame_flags(filter.ctx(), out.frame(), 0);
+                d->graphMutex.unlock();
                 if (ret < 0)
                     break;
 
@@ -118,10 +118,7 @@ int QAVAudioFilter::read(QAVFrame &frame)
 #endif
                 out.setFrameRate(av_buffersink_get_frame_rate(filter.ctx()));
                 out.setTimeBase(av_buffersink_get_time_base(filter.ctx()));
-                out.setFilterName(
-                    !filter.name().isEmpty()
-                    ? filter.name()
-                    : QString(QLatin1String("%1:%2")).arg(d->name).arg(QString::number(i)));
+                d->setOutputName(out, i, filter.name());
                 if (!out.stream())
                     out.setStream(d->stream);
                 d->outputFrames.push_back(out);
@@ -0,0 +1,204 @@
+/*********************************************************
+ * Copyright (C) 2020, Val Doroshchuk <valbok@gmail.com> *
+ *                                                       *
+ * This file is part of QtAVPlayer.                      *
+ * Free Qt Media Player based on FFmpeg.                 *
+ *********************************************************/
+
+#include "qavbufferpool_p.h"
+#include <atomic>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+#if defined(Q_OS_LINUX)
+#include <sys/mman.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+// Lines and planes start on a cache line, also enough for the AVX-512 code of the decoders and filters
+static const int alignment = 64;
+static const size_t hugePageSize = 2 * 1024 * 1024;
+
+#if LIBAVUTIL_VERSION_MAJOR < 57
+using pool_size_t = int;
+#else
+using pool_size_t = size_t;
+#endif
+
+static std::atomic<quint64> buffersCount {0};
+static std::atomic<quint64> requestsCount {0};
+static std::atomic<qint64> bytesCount {0};
+static std::atomic<qint64> hugePagesBytesCount {0};
+
+// Size of the allocation in opaque, odd if mapped
+static void free_plane(void *opaque, uint8_t *data)
+{
+    const uintptr_t info = reinterpret_cast<uintptr_t>(opaque);
+    const size_t size = info & ~uintptr_t(1);
+    bytesCount -= size;
+#if defined(Q_OS_LINUX)
+    if (info & 1) {
+        hugePagesBytesCount -= size;
+        munmap(data, size);
+        return;
+    }
+#endif
+    qFreeAligned(data);
+}
+
+static AVBufferRef *alloc_plane(void *, pool_size_t size)
+{
+    uint8_t *data = nullptr;
+    uintptr_t info = size;
+#if defined(Q_OS_LINUX)
+    if (size_t(size) >= hugePageSize) {
+        // Whole huge pages, the kernel backs them with huge pages if enabled for madvise or always
+        const size_t mapped = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+        void *p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+            madvise(p, mapped, MADV_HUGEPAGE);
+#endif
+            data = static_cast<uint8_t *>(p);
+            info = mapped | 1;
+            hugePagesBytesCount += mapped;
+        }
+    }
+#endif
+    if (!data)
+        data = static_cast<uint8_t *>(qMallocAligned(size, alignment));
+    if (!data)
+        return nullptr;
+
+    bytesCount += info & ~uintptr_t(1);
+    AVBufferRef *ref = av_buffer_create(data, size, free_plane, reinterpret_cast<void *>(info), 0);
+    if (!ref) {
+        free_plane(reinterpret_cast<void *>(info), data);
+        return nullptr;
+    }
+    ++buffersCount;
+    return ref;
+}
+
+QAVBufferPool::~QAVBufferPool()
+{
+    reset();
+}
+
+void QAVBufferPool::reset()
+{
+    for (auto &pool : m_pools)
+        av_buffer_pool_uninit(&pool);
+    m_format = -1;
+    m_width = 0;
+    m_height = 0;
+}
+
+// Same layout as avcodec_default_get_buffer2(), with lines widened to the alignment
+bool QAVBufferPool::configure(AVCodecContext *avctx, const AVFrame *frame)
+{
+    reset();
+    const AVPixelFormat format = AVPixelFormat(frame->format);
+    int w = frame->width;
+    int h = frame->height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(avctx, &w, &h, linesizeAlign);
+
+    int linesize[4] = {};
+    bool unaligned = false;
+    do {
+        if (av_image_fill_linesizes(linesize, format, w) < 0)
+            return false;
+        w += w & ~(w - 1);
+        unaligned = false;
+        for (int i = 0; i < 4; ++i)
+            unaligned |= linesize[i] % alignment != 0;
+    } while (unaligned);
+
+    size_t sizes[4] = {};
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(56, 56, 100)
+    ptrdiff_t linesizes[4];
+    for (int i = 0; i < 4; ++i)
+        linesizes[i] = linesize[i];
+    if (av_image_fill_plane_sizes(sizes, format, h, linesizes) < 0)
+        return false;
+#else
+    uint8_t *data[4] = {};
+    const int size = av_image_fill_pointers(data, format, h, nullptr, linesize);
+    if (size < 0)
+        return false;
+    for (int i = 0; i < 4 && linesize[i]; ++i)
+        sizes[i] = (i < 3 && linesize[i + 1] ? data[i + 1] : data[0] + size) - data[i];
+#endif
+
+    for (int i = 0; i < 4 && linesize[i]; ++i) {
+        // Read ahead of the end of the plane by the SIMD code
+        m_pools[i] = av_buffer_pool_init2(sizes[i] + 16 + alignment - 1, nullptr, alloc_plane, nullptr);
+        if (!m_pools[i]) {
+            reset();
+            return false;
+        }
+        m_linesize[i] = linesize[i];
+    }
+    m_format = frame->format;
+    m_width = frame->width;
+    m_height = frame->height;
+    return true;
+}
+
+int QAVBufferPool::get(AVCodecContext *avctx, AVFrame *frame, int flags)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(AVPixelFormat(frame->format));
+    int defaultFlags = AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM;
+#ifdef AV_PIX_FMT_FLAG_PSEUDOPAL
+    defaultFlags |= AV_PIX_FMT_FLAG_PSEUDOPAL;
+#endif
+    if (avctx->codec_type != AVMEDIA_TYPE_VIDEO || !(avctx->codec->capabilities & AV_CODEC_CAP_DR1)
+        || !desc || (desc->flags & defaultFlags))
+    {
+        return avcodec_default_get_buffer2(avctx, frame, flags);
+    }
+
+    {
+        // Frame threads of the decoder allocate concurrently
+        QMutexLocker locker(&m_mutex);
+        if (frame->format != m_format || frame->width != m_width || frame->height != m_height) {
+            if (!configure(avctx, frame)) {
+                locker.unlock();
+                return avcodec_default_get_buffer2(avctx, frame, flags);
+            }
+        }
+
+        for (int i = 0; i < 4 && m_pools[i]; ++i) {
+            frame->buf[i] = av_buffer_pool_get(m_pools[i]);
+            if (!frame->buf[i]) {
+                av_frame_unref(frame);
+                return AVERROR(ENOMEM);
+            }
+            frame->data[i] = frame->buf[i]->data;
+            frame->linesize[i] = m_linesize[i];
+            ++requestsCount;
+        }
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+QAVBufferPool::Counters QAVBufferPool::counters()
+{
+    Counters result;
+    const quint64 requests = requestsCount;
+    result.buffers = buffersCount;
+    result.buffersReused = requests > result.buffers ? requests - result.buffers : 0;
+    result.bytes = bytesCount;
+    result.hugePagesBytes = hugePagesBytesCount;
+    return result;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,67 @@
+/*********************************************************
+ * Copyright (C) 2020, Val Doroshchuk <valbok@gmail.com> *
+ *                                                       *
+ * This file is part of QtAVPlayer.                      *
+ * Free Qt Media Player based on FFmpeg.                 *
+ *********************************************************/
+
+#ifndef QAVBUFFERPOOL_P_H
+#define QAVBUFFERPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtAVPlayer/qtavplayerglobal.h>
+#include <QMutex>
+
+QT_BEGIN_NAMESPACE
+
+struct AVBufferPool;
+struct AVCodecContext;
+struct AVFrame;
+
+// Planes of the frames of a software video decoder (AVCodecContext::get_buffer2), 64-byte aligned lines,
+// taken from one pool by plane sized to the frames of the stream and recreated when their size or format changes.
+// Planes of 2 MiB and more (4K, 8K) are mapped on transparent huge pages on Linux, fewer TLB misses while
+// decoding and filtering them. Hardware frames, palettes and decoders without direct rendering use the default.
+class QAVBufferPool
+{
+public:
+    // Planes still referenced by frames are freed with their last frame
+    ~QAVBufferPool();
+
+    int get(AVCodecContext *avctx, AVFrame *frame, int flags);
+
+    // Planes allocated by all pools, taken from the pools instead, and bytes allocated now (also the free ones of the pools)
+    struct Counters
+    {
+        quint64 buffers = 0;
+        quint64 buffersReused = 0;
+        qint64 bytes = 0;
+        qint64 hugePagesBytes = 0;
+    };
+    static Counters counters();
+
+private:
+    bool configure(AVCodecContext *avctx, const AVFrame *frame);
+    void reset();
+
+    QMutex m_mutex;
+    int m_format = -1;
+    int m_width = 0;
+    int m_height = 0;
+    int m_linesize[4] = {};
+    AVBufferPool *m_pools[4] = {};
+};
+
+QT_END_NAMESPACE
+
+#endif
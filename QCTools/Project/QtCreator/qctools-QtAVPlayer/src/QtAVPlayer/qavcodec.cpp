@@ -41,7 +41,7 @@ void QAVCodec::setCodec(const AVCodec *c)
     d_func()->codec = c;
 }
 
-bool QAVCodec::open(AVStream *stream)
+bool QAVCodec::open(AVStream *stream, const QMap<QString, QString> &opts)
 {
     Q_D(QAVCodec);
 
@@ -67,7 +67,13 @@ bool QAVCodec::open(AVStream *stream)
 
     av_opt_set_int(d->avctx, "refcounted_frames", true, 0);
     av_opt_set_int(d->avctx, "threads", 1, 0);
-    ret = avcodec_open2(d->avctx, d->codec, nullptr);
+    AVDictionary *dict = nullptr;
+    for (const auto & key: opts.keys())
+        av_dict_set(&dict, key.toUtf8().constData(), opts[key].toUtf8().constData(), 0);
+    ret = avcodec_open2(d->avctx, d->codec, &dict);
+    for (AVDictionaryEntry *t = nullptr; (t = av_dict_get(dict, "", t, AV_DICT_IGNORE_SUFFIX));)
+        qWarning() << "Unknown decoder option:" << t->key;
+    av_dict_free(&dict);
     if (ret < 0) {
         qWarning() << "Could not open the codec:" << d->codec->name << ret;
         return false;
@@ -79,6 +85,15 @@ bool QAVCodec::open(AVStream *stream)
     return true;
 }
 
+void QAVCodec::reuse(AVStream *stream)
+{
+    Q_D(QAVCodec);
+    d->avctx->pkt_timebase = stream->time_base;
+    d->avctx->framerate = stream->avg_frame_rate;
+    stream->discard = AVDISCARD_DEFAULT;
+    d->stream = stream;
+}
+
 AVCodecContext *QAVCodec::avctx() const
 {
     return d_func()->avctx;
@@ -22,6 +22,7 @@
 #include "qavpacket_p.h"
 #include "qavframe.h"
 #include <QtAVPlayer/qtavplayerglobal.h>
+#include <QMap>
 #include <memory>
 
 QT_BEGIN_NAMESPACE
@@ -35,7 +36,10 @@ class QAVCodec
 public:
     virtual ~QAVCodec();
 
-    bool open(AVStream *stream);
+    // Options of the decoder, e.g. threads and thread_type, one thread if not set
+    bool open(AVStream *stream, const QMap<QString, QString> &opts = {});
+    // Opened for a stream of the same parameters and flushed, decodes this one
+    void reuse(AVStream *stream);
     AVCodecContext *avctx() const;
     void setCodec(const AVCodec *c);
     const AVCodec *codec() const;
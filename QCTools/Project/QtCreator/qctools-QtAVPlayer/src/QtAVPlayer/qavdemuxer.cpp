@@ -11,6 +11,7 @@
 #include "qavsubtitlecodec_p.h"
 #include "qavhwdevice_p.h"
 #include "qaviodevice.h"
+#include "qavtrace_p.h"
 #include <QtAVPlayer/qtavplayerglobal.h>
 
 #if defined(QT_AVPLAYER_VA_X11) && QT_CONFIG(opengl)
@@ -44,7 +45,11 @@ extern "C" {
 #include <QDir>
 #include <QSharedPointer>
 #include <QMutexLocker>
+#include <QElapsedTimer>
 #include <atomic>
+#include <algorithm>
+#include <list>
+#include <cstring>
 #include <QDebug>
 
 extern "C" {
@@ -54,6 +59,9 @@ extern "C" {
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(59, 0, 0)
 #include <libavcodec/bsf.h>
 #endif
+#include <libavutil/hash.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
 }
 
 QT_BEGIN_NAMESPACE
@@ -83,10 +91,27 @@ public:
     QString inputFormat;
     QString inputVideoCodec;
     QMap<QString, QString> inputOptions;
+    QMap<QString, QString> decoderOptions;
+    bool hardwareFrames = false;
+    QString hardwareDevice;
+    QString frameHash;
+    std::atomic_int videoDiscard = AVDISCARD_DEFAULT;
+    bool fastProbe = false;
+    qint64 probeTime = 0;
+    QAVDemuxer::FileReader fileReader;
+    // Of the source loaded, used without the lock by the callbacks of the format
+    QAVDemuxer::FileReader loadedFileReader;
+    decltype(AVFormatContext::io_open) defaultIoOpen = nullptr;
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(59, 17, 100)
+    decltype(AVFormatContext::io_close2) defaultIoClose = nullptr;
+#else
+    decltype(AVFormatContext::io_close) defaultIoClose = nullptr;
+#endif
 
     bool eof = false;
     QList<QAVPacket> packets;
     QString bsfs;
+    QVector<QPair<double, qint64>> keyFrames;
 };
 
 static int decode_interrupt_cb(void *ctx)
@@ -95,6 +120,86 @@ static int decode_interrupt_cb(void *ctx)
     return d ? int(d->abortRequest) : 0;
 }
 
+// Files read by QAVDemuxer::FileReader, in memory
+struct memory_file
+{
+    QByteArray data;
+    int64_t pos = 0;
+};
+
+static const int memory_file_buffer_size = 256 * 1024;
+
+static int memory_file_read(void *opaque, uint8_t *buf, int size)
+{
+    auto file = static_cast<memory_file *>(opaque);
+    int64_t bytes = std::min<int64_t>(size, file->data.size() - file->pos);
+    if (bytes <= 0)
+        return AVERROR_EOF;
+    memcpy(buf, file->data.constData() + file->pos, bytes);
+    file->pos += bytes;
+    return int(bytes);
+}
+
+static int64_t memory_file_seek(void *opaque, int64_t offset, int whence)
+{
+    auto file = static_cast<memory_file *>(opaque);
+    switch (whence & ~AVSEEK_FORCE) {
+        case AVSEEK_SIZE: return file->data.size();
+        case SEEK_SET: break;
+        case SEEK_CUR: offset += file->pos; break;
+        case SEEK_END: offset += file->data.size(); break;
+        default: return AVERROR(EINVAL);
+    }
+    if (offset < 0 || offset > file->data.size())
+        return AVERROR(EINVAL);
+    file->pos = offset;
+    return offset;
+}
+
+static int memory_file_open(AVFormatContext *s, AVIOContext **pb, const char *url, int flags, AVDictionary **options)
+{
+    auto d = static_cast<QAVDemuxerPrivate *>(s->opaque);
+    QByteArray data;
+    if ((flags & AVIO_FLAG_WRITE) || !d->loadedFileReader || !d->loadedFileReader(QString::fromUtf8(url), data))
+        return d->defaultIoOpen(s, pb, url, flags, options);
+
+    auto buffer = static_cast<unsigned char *>(av_malloc(memory_file_buffer_size));
+    auto file = new memory_file { std::move(data) };
+    *pb = buffer ? avio_alloc_context(buffer, memory_file_buffer_size, 0, file, &memory_file_read, nullptr, &memory_file_seek) : nullptr;
+    if (!*pb) {
+        av_free(buffer);
+        delete file;
+        return AVERROR(ENOMEM);
+    }
+    (*pb)->seekable = AVIO_SEEKABLE_NORMAL;
+    return 0;
+}
+
+static bool memory_file_close(AVIOContext *pb)
+{
+    if (!pb || pb->read_packet != &memory_file_read)
+        return false;
+    delete static_cast<memory_file *>(pb->opaque);
+    av_freep(&pb->buffer);
+    avio_context_free(&pb);
+    return true;
+}
+
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(59, 17, 100)
+static int memory_file_close2(AVFormatContext *s, AVIOContext *pb)
+{
+    if (memory_file_close(pb))
+        return 0;
+    return static_cast<QAVDemuxerPrivate *>(s->opaque)->defaultIoClose(s, pb);
+}
+#else
+static void memory_file_close2(AVFormatContext *s, AVIOContext *pb)
+{
+    if (!memory_file_close(pb))
+        static_cast<QAVDemuxerPrivate *>(s->opaque)->defaultIoClose(s, pb);
+}
+#endif
+
 QAVDemuxer::QAVDemuxer()
     : d_ptr(new QAVDemuxerPrivate(this))
 {
@@ -121,7 +226,8 @@ void QAVDemuxer::abort(bool stop)
     d->abortRequest = stop;
 }
 
-static int setup_video_codec(const QString &inputVideoCodec, AVStream *stream, QAVVideoCodec &codec)
+static int setup_video_codec(const QString &inputVideoCodec, const QMap<QString, QString> &decoderOptions, bool hardwareFrames,
+                             const QString &hardwareDevice, AVStream *stream, QAVVideoCodec &codec)
 {
     const AVCodec *videoCodec = nullptr;
     if (!inputVideoCodec.isEmpty()) {
@@ -181,8 +287,28 @@ static int setup_video_codec(const QString &inputVideoCodec, AVStream *stream, Q
         }
     }
 
+    // Decoding on the hardware without rendering (analysis), e.g. QT_AVPLAYER_HWDECODE=vaapi|cuda|qsv|videotoolbox|d3d11va
+    // on the device of hardwareDevice if set (e.g. /dev/dri/renderD129, a CUDA index), "none" for software decoding
+    const QByteArray downloadDevice = qgetenv("QT_AVPLAYER_HWDECODE");
+    const QByteArray deviceName = hardwareDevice.toUtf8();
+    if (!downloadDevice.isEmpty() && !codec.device() && deviceName != "none") {
+        const AVHWDeviceType type = av_hwdevice_find_type_by_name(downloadDevice.constData());
+        AVBufferRef *hw_device_ctx = nullptr;
+        if (type == AV_HWDEVICE_TYPE_NONE) {
+            qWarning() << "Unknown hardware device type:" << downloadDevice;
+        } else if (av_hwdevice_ctx_create(&hw_device_ctx, type, deviceName.isEmpty() ? nullptr : deviceName.constData(), nullptr, 0) >= 0) {
+            qDebug() << "Using hardware device context with download:" << downloadDevice << deviceName;
+            codec.avctx()->hw_device_ctx = hw_device_ctx;
+            codec.setDownloadDevice(type);
+            codec.setHardwareFrames(hardwareFrames);
+        } else {
+            qWarning() << "Could not create hardware device context:" << downloadDevice << deviceName << ", using software decoding";
+            av_buffer_unref(&hw_device_ctx);
+        }
+    }
+
     // Open codec after hwdevices
-    if (!codec.open(stream)) {
+    if (!codec.open(stream, decoderOptions)) {
         qWarning() << "Could not open video codec for stream";
         return AVERROR(EINVAL);
     }
@@ -320,6 +446,19 @@ int QAVDemuxer::load(const QString &url, QAVIODevice *dev)
         d->ctx->pb = dev->ctx();
         d->ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
     }
+    d->loadedFileReader = d->fileReader;
+    if (d->loadedFileReader) {
+        d->ctx->opaque = d;
+        d->defaultIoOpen = d->ctx->io_open;
+        d->ctx->io_open = &memory_file_open;
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(59, 17, 100)
+        d->defaultIoClose = d->ctx->io_close2;
+        d->ctx->io_close2 = &memory_file_close2;
+#else
+        d->defaultIoClose = d->ctx->io_close;
+        d->ctx->io_close = &memory_file_close2;
+#endif
+    }
 
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(59, 0, 0)
     const
@@ -337,16 +476,22 @@ int QAVDemuxer::load(const QString &url, QAVIODevice *dev)
     AVDictionary *opts = nullptr;
     for (const auto & key: d->inputOptions.keys())
         av_dict_set(&opts, key.toUtf8().constData(), d->inputOptions[key].toUtf8().constData(), 0);
+    // Probing options of the input are kept
+    const bool fastProbe = d->fastProbe && !d->inputOptions.contains(QLatin1String("probesize")) && !d->inputOptions.contains(QLatin1String("analyzeduration"));
     locker.unlock();
     int ret = avformat_open_input(&d->ctx, url.toUtf8().constData(), inputFormat, &opts);
     if (ret < 0)
         return ret;
 
-    ret = avformat_find_stream_info(d->ctx, NULL);
+    QElapsedTimer probeTimer;
+    probeTimer.start();
+    ret = findStreamInfo(d->ctx, fastProbe);
     if (ret < 0)
         return ret;
 
     locker.relock();
+    d->probeTime = probeTimer.elapsed();
+    qDebug() << "Stream parameters found in" << d->probeTime << "ms" << (fastProbe ? "(fast probe)" : "");
     av_log_set_callback(log_callback);
 
 #if LIBAVUTIL_VERSION_INT < AV_VERSION_INT(59, 8, 0)
@@ -354,8 +499,8 @@ int QAVDemuxer::load(const QString &url, QAVIODevice *dev)
     if (d->ctx->pb)
         d->seekable |= bool(d->ctx->pb->seekable);
 #else
-    // TODO: Search and implement replacement function for seek
-    d->seekable = true;
+    // Custom and pipe inputs without seek (sequential QIODevice, pipe:0) are not seekable
+    d->seekable = !d->ctx->pb || bool(d->ctx->pb->seekable);
 #endif
 
     ret = resetCodecs();
@@ -401,6 +546,201 @@ int QAVDemuxer::load(const QString &url, QAVIODevice *dev)
     return 0;
 }
 
+// Parameters needed to open the decoders and to convert the frames, the time stamps, and the duration
+static bool has_stream_parameters(const AVFormatContext *ctx)
+{
+    bool hasDuration = ctx->duration != AV_NOPTS_VALUE;
+    for (unsigned i = 0; i < ctx->nb_streams; ++i) {
+        const AVStream *st = ctx->streams[i];
+        const AVCodecParameters *par = st->codecpar;
+        switch (par->codec_type) {
+            case AVMEDIA_TYPE_VIDEO:
+                if (par->codec_id == AV_CODEC_ID_NONE || !par->width || !par->height || (!st->avg_frame_rate.num && !st->r_frame_rate.num))
+                    return false;
+                break;
+            case AVMEDIA_TYPE_AUDIO:
+#if LIBAVCODEC_VERSION_INT <= AV_VERSION_INT(59, 23, 0)
+                if (par->codec_id == AV_CODEC_ID_NONE || !par->sample_rate || !par->channels)
+#else
+                if (par->codec_id == AV_CODEC_ID_NONE || !par->sample_rate || !par->ch_layout.nb_channels)
+#endif
+                    return false;
+                break;
+            default:
+                continue;
+        }
+        if (st->time_base.num <= 0 || st->time_base.den <= 0)
+            return false;
+        hasDuration |= st->duration != AV_NOPTS_VALUE;
+    }
+    return ctx->nb_streams && hasDuration;
+}
+
+int QAVDemuxer::findStreamInfo(AVFormatContext *ctx, bool fast)
+{
+    if (!fast)
+        return avformat_find_stream_info(ctx, NULL);
+
+    // Timings of the format from the ones of the streams, as avformat_find_stream_info() does
+    if (has_stream_parameters(ctx)) {
+        int64_t start = INT64_MAX;
+        int64_t end = INT64_MIN;
+        for (unsigned i = 0; i < ctx->nb_streams; ++i) {
+            AVStream *st = ctx->streams[i];
+            if (st->codecpar->codec_type != AVMEDIA_TYPE_VIDEO && st->codecpar->codec_type != AVMEDIA_TYPE_AUDIO)
+                continue;
+            if (!st->avg_frame_rate.num)
+                st->avg_frame_rate = st->r_frame_rate;
+            if (st->duration == AV_NOPTS_VALUE)
+                continue;
+            int64_t streamStart = st->start_time != AV_NOPTS_VALUE ? av_rescale_q(st->start_time, st->time_base, AV_TIME_BASE_Q) : 0;
+            start = std::min(start, streamStart);
+            end = std::max(end, streamStart + av_rescale_q(st->duration, st->time_base, AV_TIME_BASE_Q));
+        }
+        if (ctx->start_time == AV_NOPTS_VALUE && start != INT64_MAX)
+            ctx->start_time = start;
+        if (ctx->duration == AV_NOPTS_VALUE && end > start)
+            ctx->duration = end - start;
+        if (!ctx->bit_rate && ctx->pb && ctx->duration > 0) {
+            int64_t size = avio_size(ctx->pb);
+            if (size > 0)
+                ctx->bit_rate = av_rescale(size, 8 * AV_TIME_BASE, ctx->duration);
+        }
+        return 0;
+    }
+
+    const int64_t probeSize = ctx->probesize;
+    const int64_t analyzeDuration = ctx->max_analyze_duration;
+    ctx->probesize = fastProbeSize;
+    ctx->max_analyze_duration = fastProbeDuration;
+    int ret = avformat_find_stream_info(ctx, NULL);
+    ctx->probesize = probeSize;
+    ctx->max_analyze_duration = analyzeDuration;
+    if (ret >= 0 && has_stream_parameters(ctx))
+        return ret;
+
+    qDebug() << "Stream parameters missing after the fast probe, probing fully";
+    return avformat_find_stream_info(ctx, NULL);
+}
+
+// Decoders released by the streams of the sources unloaded, see QAVDemuxer::setCodecPoolSize()
+struct QAVCodecPoolData
+{
+    QMutex mutex;
+    std::list<std::pair<QByteArray, QAVCodec *>> codecs; // By key, the last released first
+    std::atomic_int size {0};
+};
+
+// Never destroyed, streams of static objects may be released after the end of main()
+static QAVCodecPoolData &codecPool()
+{
+    static QAVCodecPoolData *data = new QAVCodecPoolData;
+    return *data;
+}
+
+static std::atomic<quint64> codecsCount {0};
+static std::atomic<quint64> codecsReusedCount {0};
+
+// Everything the decoder is opened with, empty if the decoders are not kept
+static QByteArray codec_pool_key(const AVStream *stream, const QString &inputVideoCodec, const QMap<QString, QString> &opts)
+{
+    if (codecPool().size <= 0)
+        return {};
+
+    const AVCodecParameters *par = stream->codecpar;
+#if LIBAVCODEC_VERSION_INT <= AV_VERSION_INT(59, 23, 0)
+    const int channels = par->channels;
+#else
+    const int channels = par->ch_layout.nb_channels;
+#endif
+    const qint64 values[] = {
+        par->codec_type, par->codec_id, par->codec_tag, par->format, par->bits_per_raw_sample, par->profile, par->level,
+        par->width, par->height, par->sample_aspect_ratio.num, par->sample_aspect_ratio.den, par->field_order,
+        par->color_range, par->color_primaries, par->color_trc, par->color_space, par->chroma_location,
+        par->sample_rate, channels, par->block_align, par->frame_size,
+        stream->time_base.num, stream->time_base.den, stream->avg_frame_rate.num, stream->avg_frame_rate.den
+    };
+    QByteArray key;
+    for (auto value : values)
+        key += QByteArray::number(value) + ' ';
+    if (par->codec_type == AVMEDIA_TYPE_VIDEO)
+        key += inputVideoCodec.toUtf8() + ' ';
+    for (auto it = opts.begin(); it != opts.end(); ++it)
+        key += it.key().toUtf8() + '=' + it.value().toUtf8() + ' ';
+    key += QByteArray(reinterpret_cast<const char *>(par->extradata), par->extradata_size);
+    return key;
+}
+
+static void release_codec(const QByteArray &key, QAVCodec *codec)
+{
+    auto avctx = codec->avctx();
+    if (avctx && avcodec_is_open(avctx) && !avctx->hw_device_ctx) {
+        // Same state as an opened decoder, also after the end of the stream
+        codec->flushBuffers();
+        auto &d = codecPool();
+        QMutexLocker locker(&d.mutex);
+        if (int(d.codecs.size()) < d.size) {
+            d.codecs.emplace_front(key, codec);
+            return;
+        }
+    }
+    delete codec;
+}
+
+// Released to the pool by the last stream using it if key is not empty
+static QSharedPointer<QAVCodec> pooled_codec(QAVCodec *codec, const QByteArray &key)
+{
+    ++codecsCount;
+    if (key.isEmpty())
+        return QSharedPointer<QAVCodec>(codec);
+    return QSharedPointer<QAVCodec>(codec, [key](QAVCodec *c) { release_codec(key, c); });
+}
+
+static QSharedPointer<QAVCodec> take_codec(const QByteArray &key, AVStream *stream)
+{
+    if (key.isEmpty())
+        return {};
+
+    QAVCodec *codec = nullptr;
+    {
+        auto &d = codecPool();
+        QMutexLocker locker(&d.mutex);
+        auto it = std::find_if(d.codecs.begin(), d.codecs.end(), [&](const std::pair<QByteArray, QAVCodec *> &c) { return c.first == key; });
+        if (it == d.codecs.end())
+            return {};
+        codec = it->second;
+        d.codecs.erase(it);
+    }
+    codec->reuse(stream);
+    ++codecsReusedCount;
+    qDebug() << "Reusing the decoder:" << codec->codec()->name;
+    return QSharedPointer<QAVCodec>(codec, [key](QAVCodec *c) { release_codec(key, c); });
+}
+
+void QAVDemuxer::setCodecPoolSize(int count)
+{
+    auto &d = codecPool();
+    std::list<std::pair<QByteArray, QAVCodec *>> removed;
+    {
+        QMutexLocker locker(&d.mutex);
+        d.size = qMax(0, count);
+        while (int(d.codecs.size()) > d.size) {
+            removed.push_back(d.codecs.back());
+            d.codecs.pop_back();
+        }
+    }
+    for (auto &codec : removed)
+        delete codec.second;
+}
+
+QAVDemuxer::CodecCounters QAVDemuxer::codecCounters()
+{
+    CodecCounters result;
+    result.codecs = codecsCount;
+    result.codecsReused = codecsReusedCount;
+    return result;
+}
+
 int QAVDemuxer::resetCodecs()
 {
     Q_D(QAVDemuxer);
@@ -414,15 +754,28 @@ int QAVDemuxer::resetCodecs()
         switch (type) {
             case AVMEDIA_TYPE_VIDEO:
             {
-                QSharedPointer<QAVCodec> codec(new QAVVideoCodec);
+                const QByteArray key = codec_pool_key(d->ctx->streams[i], d->inputVideoCodec, d->decoderOptions);
+                QSharedPointer<QAVCodec> codec = take_codec(key, d->ctx->streams[i]);
+                if (codec) {
+                    d->availableStreams.push_back({ int(i), d->ctx, codec });
+                    break;
+                }
+                codec = pooled_codec(new QAVVideoCodec, key);
                 d->availableStreams.push_back({ int(i), d->ctx, codec });
-                ret = setup_video_codec(d->inputVideoCodec, d->ctx->streams[i], *static_cast<QAVVideoCodec *>(codec.data()));
+                ret = setup_video_codec(d->inputVideoCodec, d->decoderOptions, d->hardwareFrames, d->hardwareDevice, d->ctx->streams[i], *static_cast<QAVVideoCodec *>(codec.data()));
             } break;
             case AVMEDIA_TYPE_AUDIO:
-                d->availableStreams.push_back({ int(i), d->ctx, QSharedPointer<QAVCodec>(new QAVAudioCodec) });
-                if (!d->availableStreams.last().codec()->open(d->ctx->streams[i]))
+            {
+                const QByteArray key = codec_pool_key(d->ctx->streams[i], QString(), d->decoderOptions);
+                QSharedPointer<QAVCodec> codec = take_codec(key, d->ctx->streams[i]);
+                if (codec) {
+                    d->availableStreams.push_back({ int(i), d->ctx, codec });
+                    break;
+                }
+                d->availableStreams.push_back({ int(i), d->ctx, pooled_codec(new QAVAudioCodec, key) });
+                if (!d->availableStreams.last().codec()->open(d->ctx->streams[i], d->decoderOptions))
                     qWarning() << "Could not open audio codec for stream:" << i;
-                break;
+            } break;
             case AVMEDIA_TYPE_SUBTITLE:
                 d->availableStreams.push_back({ int(i), d->ctx, QSharedPointer<QAVCodec>(new QAVSubtitleCodec) });
                 if (!d->availableStreams.last().codec()->open(d->ctx->streams[i]))
@@ -621,7 +974,9 @@ QAVPacket QAVDemuxer::read()
 
     QAVPacket pkt;
     bool eof = false;
+    QAVTrace trace("demux read");
     int ret = av_read_frame(d->ctx, pkt.packet());
+    trace.setArg(ret < 0 ? -1 : pkt.packet()->stream_index);
     if (ret < 0) {
         if (ret == AVERROR_EOF || avio_feof(d->ctx->pb)) {
             eof = true;
@@ -651,10 +1006,74 @@ QAVPacket QAVDemuxer::read()
     return pkt;
 }
 
+// Hash of the data of a decoded frame as written by the framehash muxer for the raw codec of its format: the visible
+// bytes of each line of each plane, and the samples of each plane for audio; false for hardware frames
+static bool hashFrame(AVHashContext *ctx, const AVFrame *frame, AVMediaType type)
+{
+    av_hash_init(ctx);
+    if (type == AVMEDIA_TYPE_VIDEO) {
+        const AVPixelFormat format = AVPixelFormat(frame->format);
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+        int linesizes[4] = {};
+        if (!desc || frame->hw_frames_ctx || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)
+            || av_image_fill_linesizes(linesizes, format, frame->width) < 0)
+        {
+            return false;
+        }
+        const int planes = av_pix_fmt_count_planes(format);
+        for (int i = 0; i < planes; ++i) {
+            const int height = i == 1 || i == 2 ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) : frame->height;
+            const uint8_t *line = frame->data[i];
+            for (int y = 0; y < height; ++y, line += frame->linesize[i])
+                av_hash_update(ctx, line, linesizes[i]);
+        }
+        if (desc->flags & AV_PIX_FMT_FLAG_PAL)
+            av_hash_update(ctx, frame->data[1], AVPALETTE_SIZE);
+        return true;
+    }
+
+#if LIBAVUTIL_VERSION_INT <= AV_VERSION_INT(57, 23, 0)
+    const int channels = frame->channels;
+#else
+    const int channels = frame->ch_layout.nb_channels;
+#endif
+    const AVSampleFormat format = AVSampleFormat(frame->format);
+    const int bytes = av_get_bytes_per_sample(format);
+    if (bytes <= 0 || channels <= 0)
+        return false;
+    const bool planar = av_sample_fmt_is_planar(format);
+    const int planes = planar ? channels : 1;
+    for (int i = 0; i < planes; ++i)
+        av_hash_update(ctx, frame->extended_data[i], frame->nb_samples * bytes * (planar ? 1 : channels));
+    return true;
+}
+
 void QAVDemuxer::decode(const QAVPacket &pkt, QList<QAVFrame> &frames) const
 {
     if (!pkt.stream())
         return;
+    QAVTrace trace("decode", pkt.stream().index());
+
+    // Once per packet, the frames are hashed by the thread decoding them
+    AVHashContext *hash = nullptr;
+    QByteArray hashKey;
+    {
+        Q_D(const QAVDemuxer);
+        QMutexLocker locker(&d->mutex);
+        if (!d->frameHash.isEmpty() && av_hash_alloc(&hash, d->frameHash.toUtf8().constData()) >= 0)
+            hashKey = QByteArray("framehash.") + d->frameHash.toLower().toUtf8();
+    }
+    const AVMediaType type = pkt.stream().stream()->codecpar->codec_type;
+    const int first = frames.size();
+
+    // Only the thread decoding the stream uses its context, frame threads get it with the next packet
+    if (type == AVMEDIA_TYPE_VIDEO) {
+        Q_D(const QAVDemuxer);
+        AVCodecContext *avctx = pkt.stream().codec()->avctx();
+        if (avctx && avctx->skip_frame != d->videoDiscard)
+            avctx->skip_frame = static_cast<AVDiscard>(d->videoDiscard.load());
+    }
+
     int sent = 0;
     do {
         sent = pkt.send();
@@ -673,6 +1092,18 @@ void QAVDemuxer::decode(const QAVPacket &pkt, QList<QAVFrame> &frames) const
             frames.push_back(frame);
         }
     } while (sent == AVERROR(EAGAIN));
+
+    if (!hash)
+        return;
+    for (int i = first; i < frames.size(); ++i) {
+        AVFrame *frame = frames[i].frame();
+        if (!hashFrame(hash, frame, type))
+            continue;
+        char hex[2 * AV_HASH_MAX_SIZE + 1];
+        av_hash_final_hex(hash, reinterpret_cast<uint8_t *>(hex), sizeof(hex));
+        av_dict_set(&frame->metadata, hashKey.constData(), hex, 0);
+    }
+    av_hash_freep(&hash);
 }
 
 void QAVDemuxer::decode(const QAVPacket &pkt, QList<QAVSubtitleFrame> &frames) const
@@ -705,6 +1136,18 @@ bool QAVDemuxer::seekable() const
     return d_func()->seekable;
 }
 
+// Formats without timestamp seeking of their own (a search on the timestamps of the packets), or with timestamp discontinuities
+static bool preferByteSeek(const AVInputFormat *format)
+{
+    if (format->flags & AVFMT_NO_BYTE_SEEK)
+        return false;
+#if LIBAVUTIL_VERSION_INT < AV_VERSION_INT(59, 8, 0)
+    if (!format->read_seek && !format->read_seek2)
+        return true;
+#endif
+    return format->flags & AVFMT_TS_DISCONT;
+}
+
 int QAVDemuxer::seek(double sec)
 {
     Q_D(QAVDemuxer);
@@ -713,15 +1156,49 @@ int QAVDemuxer::seek(double sec)
         return AVERROR(EINVAL);
 
     d->eof = false;
-    locker.unlock();
 
+    // Last key frame not after the position, slightly earlier positions included for the rounding of the callers
+    int64_t max = sec * AV_TIME_BASE;
+    auto keyFrame = std::upper_bound(d->keyFrames.cbegin(), d->keyFrames.cend(), sec + 0.0005,
+                                     [](double pos, const QPair<double, qint64> &k) { return pos < k.first; });
+    if (keyFrame != d->keyFrames.cbegin()) {
+        --keyFrame;
+        const bool byteSeek = keyFrame->second >= 0 && preferByteSeek(d->ctx->iformat);
+        const qint64 pos = keyFrame->second;
+        sec = qMin(sec, keyFrame->first);
+        locker.unlock();
+        if (byteSeek && av_seek_frame(d->ctx, -1, pos, AVSEEK_FLAG_BYTE) >= 0)
+            return 0;
+    } else {
+        locker.unlock();
+    }
+
+    // Up to the position, the key frame is the target if known
     int flags = AVSEEK_FLAG_BACKWARD;
     int64_t target = sec * AV_TIME_BASE;
     int64_t min = INT_MIN;
-    int64_t max = target;
     return avformat_seek_file(d->ctx, -1, min, target, max, flags);
 }
 
+void QAVDemuxer::setKeyFrames(const QVector<QPair<double, qint64>> &keyFrames)
+{
+    Q_D(QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    d->keyFrames = keyFrames;
+}
+
+double QAVDemuxer::keyFrame(double sec) const
+{
+    Q_D(const QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    // Same rounding as seek()
+    auto keyFrame = std::upper_bound(d->keyFrames.cbegin(), d->keyFrames.cend(), sec + 0.0005,
+                                     [](double pos, const QPair<double, qint64> &k) { return pos < k.first; });
+    if (keyFrame == d->keyFrames.cbegin())
+        return -1;
+    return (keyFrame - 1)->first;
+}
+
 double QAVDemuxer::duration() const
 {
     Q_D(const QAVDemuxer);
@@ -826,6 +1303,120 @@ void QAVDemuxer::setInputOptions(const QMap<QString, QString> &opts)
     d->inputOptions = opts;
 }
 
+QMap<QString, QString> QAVDemuxer::decoderOptions() const
+{
+    Q_D(const QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    return d->decoderOptions;
+}
+
+void QAVDemuxer::setDecoderOptions(const QMap<QString, QString> &opts)
+{
+    Q_D(QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    d->decoderOptions = opts;
+}
+
+bool QAVDemuxer::hardwareFrames() const
+{
+    Q_D(const QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    return d->hardwareFrames;
+}
+
+void QAVDemuxer::setHardwareFrames(bool keep)
+{
+    Q_D(QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    d->hardwareFrames = keep;
+    // Also the codecs already opened, before their first frames
+    for (auto &stream : d->availableStreams) {
+        if (stream.stream()->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && stream.codec())
+            static_cast<QAVVideoCodec *>(stream.codec().data())->setHardwareFrames(keep);
+    }
+}
+
+QString QAVDemuxer::hardwareDevice() const
+{
+    Q_D(const QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    return d->hardwareDevice;
+}
+
+void QAVDemuxer::setHardwareDevice(const QString &device)
+{
+    Q_D(QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    d->hardwareDevice = device;
+}
+
+QString QAVDemuxer::frameHash() const
+{
+    Q_D(const QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    return d->frameHash;
+}
+
+bool QAVDemuxer::setFrameHash(const QString &algorithm)
+{
+    AVHashContext *hash = nullptr;
+    if (!algorithm.isEmpty() && av_hash_alloc(&hash, algorithm.toUtf8().constData()) < 0)
+        return false;
+    av_hash_freep(&hash);
+
+    Q_D(QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    d->frameHash = algorithm;
+    return true;
+}
+
+int QAVDemuxer::videoDiscard() const
+{
+    Q_D(const QAVDemuxer);
+    return d->videoDiscard;
+}
+
+void QAVDemuxer::setVideoDiscard(int discard)
+{
+    Q_D(QAVDemuxer);
+    d->videoDiscard = discard;
+}
+
+bool QAVDemuxer::fastProbe() const
+{
+    Q_D(const QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    return d->fastProbe;
+}
+
+void QAVDemuxer::setFastProbe(bool fast)
+{
+    Q_D(QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    d->fastProbe = fast;
+}
+
+qint64 QAVDemuxer::probeTime() const
+{
+    Q_D(const QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    return d->probeTime;
+}
+
+QAVDemuxer::FileReader QAVDemuxer::fileReader() const
+{
+    Q_D(const QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    return d->fileReader;
+}
+
+void QAVDemuxer::setFileReader(const FileReader &reader)
+{
+    Q_D(QAVDemuxer);
+    QMutexLocker locker(&d->mutex);
+    d->fileReader = reader;
+}
+
 void QAVDemuxer::onFrameSent(const QAVStreamFrame &frame)
 {
     Q_D(QAVDemuxer);
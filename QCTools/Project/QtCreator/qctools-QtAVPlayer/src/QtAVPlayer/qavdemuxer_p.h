@@ -24,6 +24,9 @@
 #include "qavframe.h"
 #include "qavsubtitleframe.h"
 #include <QMap>
+#include <QPair>
+#include <QVector>
+#include <functional>
 #include <memory>
 
 QT_BEGIN_NAMESPACE
@@ -72,6 +75,13 @@ public:
     double duration() const;
     bool seekable() const;
     int seek(double sec);
+
+    // Key frames (seconds, byte offset of their packet or -1) by increasing time, e.g. from a previous
+    // analysis: seeks go to the key frame before the position, by byte offset if the format has no
+    // timestamp seeking of its own (MPEG-TS, MPEG-PS, raw streams), so they start on this key frame
+    void setKeyFrames(const QVector<QPair<double, qint64>> &keyFrames);
+    // Time of the key frame a seek to the position starts on, -1 if not known
+    double keyFrame(double sec) const;
     bool eof() const;
     double videoFrameRate() const;
 
@@ -89,6 +99,53 @@ public:
     QMap<QString, QString> inputOptions() const;
     void setInputOptions(const QMap<QString, QString> &opts);
 
+    QMap<QString, QString> decoderOptions() const;
+    void setDecoderOptions(const QMap<QString, QString> &opts);
+
+    bool hardwareFrames() const;
+    void setHardwareFrames(bool keep);
+
+    QString hardwareDevice() const;
+    void setHardwareDevice(const QString &device);
+
+    // Algorithm of av_hash for the hash of the decoded frames in their metadata, see QAVPlayer::setFrameHash()
+    QString frameHash() const;
+    bool setFrameHash(const QString &algorithm);
+
+    // AVDiscard of the video decoders (skip_frame), applied from the next packet decoded, see QAVPlayer::setScrub()
+    int videoDiscard() const;
+    void setVideoDiscard(int discard);
+
+    // Parameters of the streams found by findStreamInfo() with fast set, applied when the source is loaded
+    bool fastProbe() const;
+    void setFastProbe(bool fast);
+    // Milliseconds spent finding the parameters of the streams of the source loaded
+    qint64 probeTime() const;
+
+    // Same as avformat_find_stream_info(), fast: from the headers only if the container has the parameters of all the
+    // audio and video streams (MXF, MOV...), else from packets read up to fastProbeSize bytes and fastProbeDuration
+    // microseconds, then the default probing only if parameters are still missing
+    static const int64_t fastProbeSize = 1 << 20;
+    static const int64_t fastProbeDuration = 1000000;
+    static int findStreamInfo(AVFormatContext *ctx, bool fast);
+
+    // Decoders of the audio and video streams of the sources unloaded, flushed and kept by all the demuxers (0 by default),
+    // the last one released first; reused by the streams loaded afterwards with the same parameters, extradata and
+    // decoder options instead of being opened again (e.g. the short clips of a batch), not the decoders on a device
+    static void setCodecPoolSize(int count);
+    struct CodecCounters
+    {
+        quint64 codecs = 0;
+        quint64 codecsReused = 0;
+    };
+    static CodecCounters codecCounters();
+
+    // Reads the whole file of an url opened by the format (e.g. an image of image2), false if FFmpeg reads it
+    // Called from the demuxer threads, applied when the source is loaded
+    using FileReader = std::function<bool(const QString &url, QByteArray &data)>;
+    FileReader fileReader() const;
+    void setFileReader(const FileReader &reader);
+
     void onFrameSent(const QAVStreamFrame &frame);
     QAVStream::Progress progress(const QAVStream &s) const;
 
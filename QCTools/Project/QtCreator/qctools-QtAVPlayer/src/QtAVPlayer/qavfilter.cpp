@@ -28,4 +28,21 @@ bool QAVFilter::isEmpty() const
     return d_func()->isEmpty;
 }
 
+void QAVFilter::setName(const QString &name)
+{
+    Q_D(QAVFilter);
+    d->name = name;
+    d->outputNames.clear();
+}
+
+quint64 QAVFilter::graphWaits() const
+{
+    return d_func()->graphWaits;
+}
+
+quint64 QAVFilter::takeGraphWaits()
+{
+    return d_func()->graphWaits.exchange(0);
+}
+
 QT_END_NAMESPACE
@@ -37,6 +37,11 @@ public:
     // Checks if all frames have been read
     bool isEmpty() const;
     virtual void flush() = 0;
+    // Prefix of the names of the output frames, the index of the graph
+    void setName(const QString &name);
+    // Count of writes and reads which waited for another thread using the graph, reset by takeGraphWaits()
+    quint64 graphWaits() const;
+    quint64 takeGraphWaits();
 
 protected:
     QAVFilter(
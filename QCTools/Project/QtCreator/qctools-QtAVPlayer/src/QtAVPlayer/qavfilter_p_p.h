@@ -22,7 +22,9 @@
 #include <QtAVPlayer/qavframe.h>
 #include <QtAVPlayer/qavstream.h>
 #include <QList>
+#include <QPair>
 #include <QMutex>
+#include <atomic>
 
 QT_BEGIN_NAMESPACE
 
@@ -39,8 +41,33 @@ public:
     QString name;
     QAVFrame sourceFrame;
     QList<QAVFrame> outputFrames;
-    bool isEmpty = true;
+    std::atomic<bool> isEmpty {true}; // Read by the threads of the other media types, see QAVFilters::isEmpty()
     QMutex &graphMutex;
+    std::atomic<quint64> graphWaits {0};
+    // Names and identifiers of the frames of each output, made with the first frame of the output and by setName()
+    QList<QPair<QString, int>> outputNames;
+
+    // Name of its output in the graph, else the one of the filter and the index of the output
+    void setOutputName(QAVFrame &frame, int output, const QString &outputName)
+    {
+        while (output >= outputNames.size())
+            outputNames.append({});
+        auto &item = outputNames[output];
+        if (item.first.isEmpty()) {
+            item.first = !outputName.isEmpty() ? outputName : QString(QLatin1String("%1:%2")).arg(name).arg(QString::number(output));
+            item.second = QAVFrame::filterOutputId(item.first);
+        }
+        frame.setFilterName(item.first, item.second);
+    }
+
+    // The graph may be used by the filter of the other media type from another thread, its waits are counted
+    void lockGraph()
+    {
+        if (!graphMutex.tryLock()) {
+            ++graphWaits;
+            graphMutex.lock();
+        }
+    }
 };
 
 QT_END_NAMESPACE
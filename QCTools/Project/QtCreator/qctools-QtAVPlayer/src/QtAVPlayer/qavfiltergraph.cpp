@@ -53,7 +53,7 @@ QAVFilterGraph::~QAVFilterGraph()
     avfilter_inout_free(&d->outputs);
 }
 
-int QAVFilterGraph::parse(const QString &desc)
+int QAVFilterGraph::parse(const QString &desc, int threads)
 {
     Q_D(QAVFilterGraph);
     d->desc = desc;
@@ -61,6 +61,9 @@ int QAVFilterGraph::parse(const QString &desc)
     avfilter_inout_free(&d->inputs);
     avfilter_inout_free(&d->outputs);
     d->graph = avfilter_graph_alloc();
+    if (!d->graph)
+        return AVERROR(ENOMEM);
+    d->graph->nb_threads = threads;
     return avfilter_graph_parse2(d->graph, desc.toUtf8().constData(), &d->inputs, &d->outputs);
 }
 
@@ -152,6 +155,16 @@ QString QAVFilterGraph::desc() const
     return d->desc;
 }
 
+bool QAVFilterGraph::hasInputs(AVMediaType type) const
+{
+    Q_D(const QAVFilterGraph);
+    for (AVFilterInOut *cur = d->inputs; cur; cur = cur->next) {
+        if (avfilter_pad_get_type(cur->filter_ctx->input_pads, cur->pad_idx) == type)
+            return true;
+    }
+    return false;
+}
+
 QMutex &QAVFilterGraph::mutex()
 {
     Q_D(QAVFilterGraph);
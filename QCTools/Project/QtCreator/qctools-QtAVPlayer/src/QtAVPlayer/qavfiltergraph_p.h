@@ -40,10 +40,13 @@ public:
     QAVFilterGraph();
     ~QAVFilterGraph();
 
-    int parse(const QString &desc);
+    // Slice threading of the filters, 0 for one thread per core
+    int parse(const QString &desc, int threads = 0);
     int apply(const QAVFrame &frame);
     int config();
     QString desc() const;
+    // After parse(), if the graph has inputs of this type
+    bool hasInputs(AVMediaType type) const;
     QMutex &mutex();
 
     AVFilterGraph *graph() const;
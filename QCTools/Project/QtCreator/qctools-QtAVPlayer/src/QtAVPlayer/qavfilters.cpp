@@ -8,7 +8,13 @@
 #include "qavfilters_p.h"
 #include "qavvideofilter_p.h"
 #include "qavaudiofilter_p.h"
+#include "qavtrace_p.h"
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QtConcurrent/qtconcurrentrun.h>
+#include <QReadLocker>
+#include <QWriteLocker>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -16,118 +22,358 @@ extern "C" {
 
 QT_BEGIN_NAMESPACE
 
+static bool filtersEmpty(const std::vector<std::unique_ptr<QAVFilter>> &filters);
+
+// Graphs used by the video and audio threads together, the waits for their creation are counted
+class QAVFiltersReadLocker
+{
+public:
+    QAVFiltersReadLocker(QReadWriteLock &lock, std::atomic<quint64> &waits) : m_lock(lock)
+    {
+        if (!m_lock.tryLockForRead()) {
+            ++waits;
+            m_lock.lockForRead();
+        }
+    }
+    ~QAVFiltersReadLocker() { m_lock.unlock(); }
+
+private:
+    Q_DISABLE_COPY(QAVFiltersReadLocker)
+    QReadWriteLock &m_lock;
+};
+
+static quint64 takeGraphWaits(const std::vector<std::unique_ptr<QAVFilter>> &filters)
+{
+    quint64 result = 0;
+    for (const auto &filter : filters)
+        result += filter->takeGraphWaits();
+    return result;
+}
+
+static void addElapsed(
+    const std::vector<std::atomic<qint64>> &elapsed,
+    const QList<QString> &descs,
+    QMap<QString, qint64> &result)
+{
+    for (size_t i = 0; i < elapsed.size() && int(i) < descs.size(); ++i)
+        result[descs[int(i)]] += elapsed[i] / 1000;
+}
+
 int QAVFilters::createFilters(
     const QList<QString> &filterDescs,
     const QAVFrame &frame,
-    const QAVDemuxer &demuxer)
+    const QAVDemuxer &demuxer,
+    int threads,
+    bool parallel,
+    const QList<bool> &cacheable,
+    bool keep)
 {
-    QMutexLocker locker(&m_mutex);
+    QWriteLocker locker(&m_lock);
+    addElapsed(m_videoElapsed, m_elapsedDescs, m_elapsedBefore);
+    addElapsed(m_audioElapsed, m_elapsedDescs, m_elapsedBefore);
+    m_waits += takeGraphWaits(m_videoFilters) + takeGraphWaits(m_audioFilters);
+
+    QAVStream videoStream = m_fixedVideoStream;
+    QAVStream audioStream = m_fixedAudioStream;
+    if (!m_fixedStreams) {
+        const auto videoStreams = demuxer.currentVideoStreams();
+        videoStream = !videoStreams.isEmpty() ? videoStreams.first() : QAVStream();
+        const auto audioStreams = demuxer.currentAudioStreams();
+        audioStream = !audioStreams.isEmpty() ? audioStreams.first() : QAVStream();
+    }
+
+    // Current graphs, reusable if they are drained (frames written later would be mixed with the pending ones)
+    // and not created for other parameters
+    std::list<CachedGraph> previous;
+    if (!m_flushed && !frame && m_threads == threads
+        && m_videoStream == videoStream.index() && m_audioStream == audioStream.index()
+        && filtersEmpty(m_videoFilters) && filtersEmpty(m_audioFilters))
+    {
+        for (size_t i = 0; i < m_filterGraphs.size(); ++i) {
+            CachedGraph graph;
+            graph.desc = m_elapsedDescs[int(i)];
+            graph.threads = m_threads;
+            graph.videoStream = m_videoStream;
+            graph.audioStream = m_audioStream;
+            graph.cacheable = m_graphCacheable[i];
+            graph.graph = std::move(m_filterGraphs[i]);
+            graph.videoFilter = std::move(m_videoFilters[i]);
+            graph.audioFilter = std::move(m_audioFilters[i]);
+            graph.videoActive = m_videoActive[i];
+            graph.audioActive = m_audioActive[i];
+            previous.push_back(std::move(graph));
+        }
+    }
+    m_videoElapsed.clear();
+    m_audioElapsed.clear();
+    m_elapsedDescs.clear();
     m_videoFilters.clear();
     m_audioFilters.clear();
+    m_videoActive.clear();
+    m_audioActive.clear();
     m_filterGraphs.clear();
-    for (int i = 0; i < filterDescs.size(); ++i) {
-        const auto & filterDesc = filterDescs[i];
-        std::unique_ptr<QAVFilterGraph> graph(!filterDesc.isEmpty() ? new QAVFilterGraph : nullptr);
-        if (graph) {
-            int ret = graph->parse(filterDesc);
-            if (ret < 0) {
-                qWarning() << "Could not parse filter desc:" << filterDesc << ret;
-                return ret;
-            }
-            QAVFrame videoFrame;
-            QAVFrame audioFrame;
-            const auto videoStreams = demuxer.currentVideoStreams();
-            const auto videoStream = !videoStreams.isEmpty() ? videoStreams.first() : QAVStream();
-            videoFrame.setStream(videoStream);
-            const auto audioStreams = demuxer.currentAudioStreams();
-            const auto audioStream = !audioStreams.isEmpty() ? audioStreams.first() : QAVStream();
-            audioFrame.setStream(audioStream);
-            auto stream = frame.stream().stream();
-            if (stream) {
-                switch (stream->codecpar->codec_type) {
-                case AVMEDIA_TYPE_VIDEO:
-                    videoFrame = frame;
-                    break;
-                case AVMEDIA_TYPE_AUDIO:
-                    audioFrame = frame;
-                    break;
-                default:
-                    qWarning() << "Unsupported codec type:" << stream->codecpar->codec_type;
-                    return AVERROR(ENOTSUP);
-                }
-            }
-            ret = graph->apply(videoFrame);
-            if (ret < 0) {
-                qWarning() << "Could not create video filters:" << ret;
-                return ret;
-            }
-            ret = graph->apply(audioFrame);
-            if (ret < 0) {
-                qWarning() << "Could not create audio filters:" << ret;
-                return ret;
-            }
-            ret = graph->config();
-            if (ret < 0) {
-                qWarning() << "Could not configure filter graph:" << ret;
-                return ret;
+    m_graphCacheable.clear();
+    m_graphFresh.clear();
+    m_graphDescs.clear();
+    m_parallel = parallel;
+    m_threads = threads;
+    m_videoStream = videoStream.index();
+    m_audioStream = audioStream.index();
+    m_flushed = false;
+
+    // Graphs for the parameters of a frame replace the ones which did not support it
+    if (frame) {
+        m_cache.remove_if([&](const CachedGraph &graph) { return filterDescs.contains(graph.desc); });
+    }
+
+    auto take = [&](std::list<CachedGraph> &graphs, const QString &desc) {
+        for (auto it = graphs.begin(); it != graphs.end(); ++it) {
+            if (it->desc == desc && it->threads == threads
+                && it->videoStream == m_videoStream && it->audioStream == m_audioStream)
+            {
+                CachedGraph graph = std::move(*it);
+                graphs.erase(it);
+                return graph;
             }
+        }
+        return CachedGraph();
+    };
 
-            auto videoInput = graph->videoInputFilters();
-            auto videoOutput = graph->videoOutputFilters();
-            m_videoFilters.emplace_back(
-                std::unique_ptr<QAVFilter>(
-                    new QAVVideoFilter(
-                        videoStream,
-                        QString::number(i),
-                        videoInput,
-                        videoOutput,
-                        graph->mutex())
-                )
-            );
-            auto audioInput = graph->audioInputFilters();
-            auto audioOutput = graph->audioOutputFilters();
-            m_audioFilters.emplace_back(
-                std::unique_ptr<QAVFilter>(
-                    new QAVAudioFilter(
-                        audioStream,
-                        QString::number(i),
-                        audioInput,
-                        audioOutput,
-                        graph->mutex())
-                )
-            );
-            qDebug() << __FUNCTION__ << ":" << filterDesc
-                << "video[ input:" << videoInput.size() << "-> output:" << videoOutput.size() << "]"
-                << "audio[ input:" << audioInput.size() << "-> output:" << audioOutput.size() << "]";
+    int ret = 0;
+    for (int i = 0; i < filterDescs.size() && ret >= 0; ++i) {
+        const auto & filterDesc = filterDescs[i];
+        if (filterDesc.isEmpty())
+            continue;
+        const bool isCacheable = i < cacheable.size() && cacheable[i];
+
+        // Unchanged graphs go on with the next frames, others are taken from the cache or created
+        bool fresh = false;
+        CachedGraph graph;
+        if (keep)
+            graph = take(previous, filterDesc);
+        if (!graph.graph) {
+            fresh = true;
+            if (isCacheable && !frame)
+                graph = take(m_cache, filterDesc);
+        }
+        if (graph.graph) {
+            graph.videoFilter->setName(QString::number(i));
+            graph.audioFilter->setName(QString::number(i));
+            qDebug() << __FUNCTION__ << ":" << filterDesc << (fresh ? "cached" : "kept");
+        } else {
+            ret = createGraph(filterDesc, QString::number(i), frame, videoStream, audioStream, threads, graph);
+            if (ret < 0)
+                break;
+            // Inputs of a type without stream, see setStreams()
+            if (!graph.graph)
+                continue;
         }
 
-        m_filterGraphs.push_back(std::move(graph));
+        m_filterGraphs.push_back(std::move(graph.graph));
+        m_videoFilters.push_back(std::move(graph.videoFilter));
+        m_audioFilters.push_back(std::move(graph.audioFilter));
+        m_videoActive.push_back(graph.videoActive);
+        m_audioActive.push_back(graph.audioActive);
+        m_graphCacheable.push_back(isCacheable);
+        m_graphFresh.push_back(fresh);
+        m_graphDescs.push_back(i);
+        m_elapsedDescs.append(filterDesc);
+    }
+
+    // Replaced graphs without state between frames are kept for a next use
+    for (auto &graph : previous) {
+        if (graph.cacheable && m_cacheSize > 0)
+            m_cache.push_front(std::move(graph));
     }
+    while (int(m_cache.size()) > m_cacheSize)
+        m_cache.pop_back();
 
     m_filterDescs = filterDescs;
+    m_videoElapsed = std::vector<std::atomic<qint64>>(m_elapsedDescs.size());
+    m_audioElapsed = std::vector<std::atomic<qint64>>(m_elapsedDescs.size());
+    return ret;
+}
+
+int QAVFilters::createGraph(
+    const QString &filterDesc,
+    const QString &name,
+    const QAVFrame &frame,
+    const QAVStream &videoStream,
+    const QAVStream &audioStream,
+    int threads,
+    CachedGraph &result)
+{
+    std::unique_ptr<QAVFilterGraph> graph(new QAVFilterGraph);
+    int ret = graph->parse(filterDesc, threads);
+    if (ret < 0) {
+        qWarning() << "Could not parse filter desc:" << filterDesc << ret;
+        return ret;
+    }
+    if (m_fixedStreams
+        && ((!videoStream && graph->hasInputs(AVMEDIA_TYPE_VIDEO)) || (!audioStream && graph->hasInputs(AVMEDIA_TYPE_AUDIO))))
+    {
+        return 0;
+    }
+    QAVFrame videoFrame;
+    QAVFrame audioFrame;
+    videoFrame.setStream(videoStream);
+    audioFrame.setStream(audioStream);
+    auto stream = frame.stream().stream();
+    if (stream) {
+        switch (stream->codecpar->codec_type) {
+        case AVMEDIA_TYPE_VIDEO:
+            videoFrame = frame;
+            break;
+        case AVMEDIA_TYPE_AUDIO:
+            audioFrame = frame;
+            break;
+        default:
+            qWarning() << "Unsupported codec type:" << stream->codecpar->codec_type;
+            return AVERROR(ENOTSUP);
+        }
+    }
+    ret = graph->apply(videoFrame);
+    if (ret < 0) {
+        qWarning() << "Could not create video filters:" << ret;
+        return ret;
+    }
+    ret = graph->apply(audioFrame);
+    if (ret < 0) {
+        qWarning() << "Could not create audio filters:" << ret;
+        return ret;
+    }
+    ret = graph->config();
+    if (ret < 0) {
+        qWarning() << "Could not configure filter graph:" << ret;
+        return ret;
+    }
+
+    auto videoInput = graph->videoInputFilters();
+    auto videoOutput = graph->videoOutputFilters();
+    result.videoFilter.reset(
+        new QAVVideoFilter(
+            videoStream,
+            name,
+            videoInput,
+            videoOutput,
+            graph->mutex())
+    );
+    result.videoActive = !videoInput.isEmpty();
+    auto audioInput = graph->audioInputFilters();
+    auto audioOutput = graph->audioOutputFilters();
+    result.audioFilter.reset(
+        new QAVAudioFilter(
+            audioStream,
+            name,
+            audioInput,
+            audioOutput,
+            graph->mutex())
+    );
+    result.audioActive = !audioInput.isEmpty();
+    qDebug() << __FUNCTION__ << ":" << filterDesc
+        << "video[ input:" << videoInput.size() << "-> output:" << videoOutput.size() << "]"
+        << "audio[ input:" << audioInput.size() << "-> output:" << audioOutput.size() << "]";
+    result.desc = filterDesc;
+    result.threads = threads;
+    result.videoStream = videoStream.index();
+    result.audioStream = audioStream.index();
+    result.graph = std::move(graph);
     return 0;
 }
 
+// Runs graph(i) for each graph, the active ones (with inputs of this type) by the pool if parallel.
+// Graphs have their own mutex and filters, the first active graph is run by this thread while the
+// others are run by the pool, graphs without inputs of this type only return and are run by this thread.
+// Returns once all of them are done, so each graph gets the frames in order.
+template <typename Graph>
+static int runGraphs(size_t count, const std::vector<bool> &active, bool parallel, Graph graph)
+{
+    std::vector<size_t> parallelGraphs;
+    if (parallel) {
+        for (size_t i = 0; i < count && i < active.size(); ++i)
+            if (active[i])
+                parallelGraphs.push_back(i);
+    }
+    if (parallelGraphs.size() < 2) {
+        int ret = 0;
+        for (size_t i = 0; i < count && ret >= 0; ++i)
+            ret = graph(i);
+        return ret;
+    }
+
+    QList<QFuture<int>> futures;
+    for (size_t i = 1; i < parallelGraphs.size(); ++i) {
+        size_t index = parallelGraphs[i];
+        futures.append(QtConcurrent::run([&graph, index]() { return graph(index); }));
+    }
+    int ret = graph(parallelGraphs[0]);
+    for (size_t i = 0; i < count; ++i) {
+        if (i >= active.size() || !active[i]) {
+            int inactiveRet = graph(i);
+            if (ret >= 0)
+                ret = inactiveRet;
+        }
+    }
+    for (auto &future : futures) {
+        int futureRet = future.result();
+        if (ret >= 0)
+            ret = futureRet;
+    }
+    return ret;
+}
+
+// Filters are by graph, frames are filtered while written in the graph (push) and read from it
 static int writeFrame(
     const QAVFrame &decodedFrame,
-    const std::vector<std::unique_ptr<QAVFilter>> &filters)
+    const std::vector<std::unique_ptr<QAVFilter>> &filters,
+    const std::vector<bool> &active,
+    const std::vector<bool> &selected,
+    bool parallel,
+    std::vector<std::atomic<qint64>> &elapsed)
 {
-    int ret = 0;
-    for (size_t i = 0; i < filters.size() && ret >= 0; ++i)
-        ret = filters[i]->write(decodedFrame);
-    return ret;
+    // The frame is referenced by each graph
+    return runGraphs(filters.size(), active, parallel, [&](size_t i) {
+        if (i < selected.size() && !selected[i])
+            return 0;
+        QElapsedTimer timer;
+        timer.start();
+        QAVTrace trace("filter write", i);
+        int ret = filters[i]->write(decodedFrame);
+        if (i < elapsed.size())
+            elapsed[i] += timer.nsecsElapsed();
+        return ret;
+    });
 }
 
 int QAVFilters::write(
     AVMediaType mediaType,
-    const QAVFrame &decodedFrame)
+    const QAVFrame &decodedFrame,
+    bool freshOnly,
+    const QList<bool> &skipped)
 {
-    QMutexLocker locker(&m_mutex);
+    QAVFiltersReadLocker locker(m_lock, m_waits);
     switch (mediaType) {
-    case AVMEDIA_TYPE_VIDEO:
-        return writeFrame(decodedFrame, m_videoFilters);
+    case AVMEDIA_TYPE_VIDEO: {
+        // Fresh graphs did not get the video frames written before
+        std::vector<bool> selected;
+        {
+            QMutexLocker freshLocker(&m_freshMutex);
+            if (freshOnly)
+                selected = m_graphFresh;
+            m_graphFresh.assign(m_graphFresh.size(), false);
+        }
+        if (!skipped.isEmpty()) {
+            selected.resize(m_videoFilters.size(), true);
+            for (size_t i = 0; i < selected.size(); ++i) {
+                const int desc = m_graphDescs[i];
+                if (desc < skipped.size() && skipped[desc])
+                    selected[i] = false;
+            }
+        }
+        return writeFrame(decodedFrame, m_videoFilters, m_videoActive, selected, m_parallel, m_videoElapsed);
+    }
     case AVMEDIA_TYPE_AUDIO:
-        return writeFrame(decodedFrame, m_audioFilters);
+        return writeFrame(decodedFrame, m_audioFilters, m_audioActive, {}, m_parallel, m_audioElapsed);
     default:
         qWarning() << "Unsupported codec type:" << mediaType;
         break;
@@ -138,23 +384,36 @@ int QAVFilters::write(
 static int readFrames(
     const QAVFrame &decodedFrame,
     const std::vector<std::unique_ptr<QAVFilter>> &filters,
-    QList<QAVFrame> &filteredFrames)
+    const std::vector<bool> &active,
+    bool parallel,
+    QList<QAVFrame> &filteredFrames,
+    std::vector<std::atomic<qint64>> &elapsed)
 {
-    QAVFrame frame;
     if (filters.empty()) {
         if (decodedFrame)
             filteredFrames.append(decodedFrame);
         return 0;
     }
 
-    // Read all frames from all filters at once
-    for (size_t i = 0; i < filters.size(); ++i) {
+    // Read all frames from all filters at once, the graphs are drained as they were written
+    // and their frames are appended by graph
+    std::vector<QList<QAVFrame>> graphFrames(filters.size());
+    runGraphs(filters.size(), active, parallel, [&](size_t i) {
+        QElapsedTimer timer;
+        timer.start();
+        QAVTrace trace("filter read", i);
+        QAVFrame frame;
         do {
             int ret = filters[i]->read(frame);
-            if (ret >= 0 && (!frame.filterName().isEmpty() || i == 0))
-                filteredFrames.append(frame);
+            if (ret >= 0 && (frame.filterOutput() >= 0 || i == 0))
+                graphFrames[i].append(frame);
         } while (!filters[i]->isEmpty());
-    }
+        if (i < elapsed.size())
+            elapsed[i] += timer.nsecsElapsed();
+        return 0;
+    });
+    for (const auto &frames : graphFrames)
+        filteredFrames.append(frames);
     return 0;
 }
 
@@ -163,12 +422,12 @@ int QAVFilters::read(
     const QAVFrame &decodedFrame,
     QList<QAVFrame> &filteredFrames)
 {
-    QMutexLocker locker(&m_mutex);
+    QAVFiltersReadLocker locker(m_lock, m_waits);
     switch (mediaType) {
     case AVMEDIA_TYPE_VIDEO:
-        return readFrames(decodedFrame, m_videoFilters, filteredFrames);
+        return readFrames(decodedFrame, m_videoFilters, m_videoActive, m_parallel, filteredFrames, m_videoElapsed);
     case AVMEDIA_TYPE_AUDIO:
-        return readFrames(decodedFrame, m_audioFilters, filteredFrames);
+        return readFrames(decodedFrame, m_audioFilters, m_audioActive, m_parallel, filteredFrames, m_audioElapsed);
     default:
         qWarning() << "Unsupported codec type:" << mediaType;
         break;
@@ -178,10 +437,30 @@ int QAVFilters::read(
 
 QList<QString> QAVFilters::filterDescs() const
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
     return m_filterDescs;
 }
 
+QMap<QString, qint64> QAVFilters::elapsed() const
+{
+    QReadLocker locker(&m_lock);
+    auto result = m_elapsedBefore;
+    addElapsed(m_videoElapsed, m_elapsedDescs, result);
+    addElapsed(m_audioElapsed, m_elapsedDescs, result);
+    return result;
+}
+
+quint64 QAVFilters::waits() const
+{
+    QReadLocker locker(&m_lock);
+    quint64 result = m_waits;
+    for (const auto &filter : m_videoFilters)
+        result += filter->graphWaits();
+    for (const auto &filter : m_audioFilters)
+        result += filter->graphWaits();
+    return result;
+}
+
 static bool filtersEmpty(const std::vector<std::unique_ptr<QAVFilter>> &filters)
 {
     for (const auto &filter : filters)
@@ -192,10 +471,43 @@ static bool filtersEmpty(const std::vector<std::unique_ptr<QAVFilter>> &filters)
 
 bool QAVFilters::isEmpty() const
 {
-    QMutexLocker locker(&m_mutex);
+    QReadLocker locker(&m_lock);
     return filtersEmpty(m_videoFilters) && filtersEmpty(m_audioFilters);
 }
 
+int QAVFilters::freshGraphs(bool *refilterable) const
+{
+    QReadLocker locker(&m_lock);
+    QMutexLocker freshLocker(&m_freshMutex);
+    int result = 0;
+    bool stateless = true;
+    for (size_t i = 0; i < m_graphFresh.size(); ++i) {
+        if (!m_graphFresh[i])
+            continue;
+        ++result;
+        stateless &= m_graphCacheable[i] && !m_audioActive[i];
+    }
+    if (refilterable)
+        *refilterable = stateless;
+    return result;
+}
+
+void QAVFilters::setStreams(const QAVStream &videoStream, const QAVStream &audioStream)
+{
+    QWriteLocker locker(&m_lock);
+    m_fixedStreams = true;
+    m_fixedVideoStream = videoStream;
+    m_fixedAudioStream = audioStream;
+}
+
+void QAVFilters::setCacheSize(int count)
+{
+    QWriteLocker locker(&m_lock);
+    m_cacheSize = qMax(0, count);
+    while (int(m_cache.size()) > m_cacheSize)
+        m_cache.pop_back();
+}
+
 static void flushFilters(const std::vector<std::unique_ptr<QAVFilter>> &filters)
 {
     for (const auto &filter: filters)
@@ -204,17 +516,30 @@ static void flushFilters(const std::vector<std::unique_ptr<QAVFilter>> &filters)
 
 void QAVFilters::flush()
 {
-    QMutexLocker locker(&m_mutex);
+    QWriteLocker locker(&m_lock);
     flushFilters(m_videoFilters);
     flushFilters(m_audioFilters);
+    // The graphs got the end of their inputs
+    m_flushed = true;
 }
 
 void QAVFilters::clear()
 {
-    QMutexLocker locker(&m_mutex);
+    QWriteLocker locker(&m_lock);
     m_videoFilters.clear();
     m_audioFilters.clear();
+    m_videoActive.clear();
+    m_audioActive.clear();
     m_filterGraphs.clear();
+    m_videoElapsed.clear();
+    m_audioElapsed.clear();
+    m_elapsedDescs.clear();
+    m_elapsedBefore.clear();
+    m_waits = 0;
+    m_graphCacheable.clear();
+    m_graphFresh.clear();
+    m_graphDescs.clear();
+    m_cache.clear();
 }
 
 QT_END_NAMESPACE
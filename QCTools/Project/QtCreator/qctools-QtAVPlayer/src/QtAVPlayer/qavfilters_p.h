@@ -24,7 +24,11 @@
 #include "qavfilter_p.h"
 #include "qavdemuxer_p.h"
 #include "qavfiltergraph_p.h"
+#include <QMap>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <atomic>
+#include <list>
 #include <vector>
 #include <memory>
 
@@ -34,19 +38,44 @@ class QAVFilters
 {
 public:
     QAVFilters() = default;
+    // Cacheable graphs keep no state between frames: once replaced they are kept (see setCacheSize()),
+    // and the graphs kept for the same description and streams are reused instead of created again,
+    // unless they are created for the parameters of a frame.
+    // If keep, the current graphs of unchanged descriptions go on with the next frames when drained,
+    // the others are fresh: they did not get the frames written before.
     int createFilters(
         const QList<QString> &filterDescs,
         const QAVFrame &frame,
-        const QAVDemuxer &demuxer);
+        const QAVDemuxer &demuxer,
+        int threads = 0,
+        bool parallel = false,
+        const QList<bool> &cacheable = {},
+        bool keep = false);
+    // Graphs of these streams instead of the first current streams of the demuxer, the graphs with inputs
+    // of a type without stream are skipped
+    void setStreams(const QAVStream &videoStream, const QAVStream &audioStream);
+    // Count of replaced graphs kept, 0 by default
+    void setCacheSize(int count);
+    // Only to the fresh graphs if freshOnly, no graph is fresh after a video frame; a video frame is not written
+    // to the graphs skipped, by index of the descriptions
     int write(
         AVMediaType mediaType,
-        const QAVFrame &decodedFrame);
+        const QAVFrame &decodedFrame,
+        bool freshOnly = false,
+        const QList<bool> &skipped = {});
     int read(
         AVMediaType mediaType,
         const QAVFrame &decodedFrame,
         QList<QAVFrame> &filteredFrames);
     QList<QString> filterDescs() const;
+    // Microseconds spent in each filter graph (writes and reads), by description, since clear()
+    QMap<QString, qint64> elapsed() const;
+    // Writes and reads which waited for another thread since clear(): for the graphs being created, or for the
+    // filters of the other media type of the same graph (the video and audio threads share no other lock)
+    quint64 waits() const;
     bool isEmpty() const;
+    // Count of fresh graphs, refilterable is set if they are all cacheable without audio inputs
+    int freshGraphs(bool *refilterable = nullptr) const;
     void flush();
     void clear();
 
@@ -57,7 +86,55 @@ private:
     std::vector<std::unique_ptr<QAVFilterGraph>> m_filterGraphs;
     std::vector<std::unique_ptr<QAVFilter>> m_videoFilters;
     std::vector<std::unique_ptr<QAVFilter>> m_audioFilters;
-    mutable QMutex m_mutex;
+    // Graphs with inputs of this type, written and drained by the thread pool if parallel
+    std::vector<bool> m_videoActive;
+    std::vector<bool> m_audioActive;
+    bool m_parallel = false;
+    // Nanoseconds, by graph (same index as the filters), written by the thread of each media type
+    std::vector<std::atomic<qint64>> m_videoElapsed;
+    std::vector<std::atomic<qint64>> m_audioElapsed;
+    QList<QString> m_elapsedDescs;
+    QMap<QString, qint64> m_elapsedBefore; // Of the graphs created before the current ones
+
+    std::vector<bool> m_graphCacheable;
+    std::vector<bool> m_graphFresh; // Locked by m_freshMutex
+    std::vector<int> m_graphDescs; // Index of the description of each graph
+    mutable QMutex m_freshMutex;
+
+    // Replaced graphs, the last replaced first
+    struct CachedGraph
+    {
+        QString desc;
+        int threads = 0;
+        int videoStream = -1;
+        int audioStream = -1;
+        bool cacheable = false;
+        std::unique_ptr<QAVFilterGraph> graph;
+        std::unique_ptr<QAVFilter> videoFilter;
+        std::unique_ptr<QAVFilter> audioFilter;
+        bool videoActive = false;
+        bool audioActive = false;
+    };
+    int createGraph(
+        const QString &filterDesc,
+        const QString &name,
+        const QAVFrame &frame,
+        const QAVStream &videoStream,
+        const QAVStream &audioStream,
+        int threads,
+        CachedGraph &result);
+    std::list<CachedGraph> m_cache;
+    int m_cacheSize = 0;
+    bool m_flushed = false; // Current graphs got the end of their inputs
+    int m_threads = 0;
+    int m_videoStream = -1;
+    int m_audioStream = -1;
+    bool m_fixedStreams = false; // See setStreams()
+    QAVStream m_fixedVideoStream;
+    QAVStream m_fixedAudioStream;
+    // Graphs changed exclusively, used by the video and audio threads together otherwise
+    mutable QReadWriteLock m_lock;
+    std::atomic<quint64> m_waits {0}; // Of the replaced graphs and for m_lock
 };
 
 QT_END_NAMESPACE
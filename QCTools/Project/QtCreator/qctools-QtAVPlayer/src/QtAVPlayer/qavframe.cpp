@@ -8,7 +8,10 @@
 #include "qavframe.h"
 #include "qavstream.h"
 #include "qavframe_p.h"
+#include "qavpool_p.h"
 #include <QDebug>
+#include <QHash>
+#include <QMutex>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -30,7 +33,7 @@ QAVFrame::QAVFrame(const QAVFrame &other)
 QAVFrame::QAVFrame(QAVFramePrivate &d)
     : QAVStreamFrame(d)
 {
-    d.frame = av_frame_alloc();
+    d.frame = QAVPool::frame();
 }
 
 QAVFrame &QAVFrame::operator=(const QAVFrame &other)
@@ -49,6 +52,7 @@ QAVFrame &QAVFrame::operator=(const QAVFrame &other)
     d->frameRate = other_priv->frameRate;
     d->timeBase = other_priv->timeBase;
     d->filterName = other_priv->filterName;
+    d->filterOutput = other_priv->filterOutput;
     return *this;
 }
 
@@ -61,7 +65,7 @@ QAVFrame::operator bool() const
 QAVFrame::~QAVFrame()
 {
     Q_D(QAVFrame);
-    av_frame_free(&d->frame);
+    QAVPool::release(d->frame);
 }
 
 AVFrame *QAVFrame::frame() const
@@ -88,9 +92,35 @@ QString QAVFrame::filterName() const
 }
 
 void QAVFrame::setFilterName(const QString &name)
+{
+    setFilterName(name, filterOutputId(name));
+}
+
+int QAVFrame::filterOutput() const
+{
+    return d_func()->filterOutput;
+}
+
+void QAVFrame::setFilterName(const QString &name, int output)
 {
     Q_D(QAVFrame);
     d->filterName = name;
+    d->filterOutput = output;
+}
+
+int QAVFrame::filterOutputId(const QString &name)
+{
+    static QMutex mutex;
+    static QHash<QString, int> ids;
+    if (name.isEmpty())
+        return -1;
+    QMutexLocker locker(&mutex);
+    auto it = ids.constFind(name);
+    if (it != ids.constEnd())
+        return it.value();
+    int id = ids.size();
+    ids.insert(name, id);
+    return id;
 }
 
 double QAVFramePrivate::pts() const
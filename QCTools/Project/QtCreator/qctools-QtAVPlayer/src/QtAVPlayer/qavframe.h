@@ -30,6 +30,14 @@ public:
     void setTimeBase(const AVRational &value);
     QString filterName() const;
     void setFilterName(const QString &name);
+    // Identifier of the output of the filters the frame has been read from (see filterOutputId()), -1 if none
+    // Set with the name, for routing the frames without comparing their names
+    int filterOutput() const;
+    void setFilterName(const QString &name, int output);
+
+    // Identifier of the outputs named name, the same for all the graphs and players of the process: small
+    // consecutive integers from 0 in the order of the first call for each name, usable as the index of a table
+    static int filterOutputId(const QString &name);
 
 protected:
     QAVFrame(QAVFramePrivate &d);
@@ -41,6 +41,7 @@ public:
     AVRational timeBase{};
     // Name of a filter the frame has retrieved from
     QString filterName;
+    int filterOutput = -1;
 };
 
 QT_END_NAMESPACE
@@ -7,6 +7,7 @@
 
 #include "qavpacket_p.h"
 #include "qavcodec_p.h"
+#include "qavpool_p.h"
 #include "qavstream.h"
 #include <QSharedPointer>
 #include <QDebug>
@@ -29,7 +30,7 @@ public:
 QAVPacket::QAVPacket()
     : d_ptr(new QAVPacketPrivate)
 {
-    d_ptr->pkt = av_packet_alloc();
+    d_ptr->pkt = QAVPool::packet();
     d_ptr->pkt->size = 0;
     d_ptr->pkt->stream_index = -1;
     d_ptr->pkt->pts = AV_NOPTS_VALUE;
@@ -60,7 +61,7 @@ QAVPacket::operator bool() const
 QAVPacket::~QAVPacket()
 {
     Q_D(QAVPacket);
-    av_packet_free(&d->pkt);
+    QAVPool::release(d->pkt);
 }
 
 AVPacket *QAVPacket::packet() const
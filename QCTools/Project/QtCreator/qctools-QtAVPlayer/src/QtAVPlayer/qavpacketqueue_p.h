@@ -26,10 +26,12 @@
 #include "qavsubtitleframe.h"
 #include "qavstreamframe.h"
 #include "qavdemuxer_p.h"
+#include "qavtrace_p.h"
 #include <QMutex>
 #include <QWaitCondition>
 #include <QList>
 #include <math.h>
+#include <atomic>
 #include <memory>
 
 extern "C" {
@@ -79,6 +81,7 @@ public:
         }
 
         prevPts = pts;
+        shownTime = time;
         frameTimer += delay;
         if ((delay > 0 && time - frameTimer > maxThreshold) || !shouldSync)
             frameTimer = time;
@@ -92,11 +95,41 @@ public:
         return prevPts;
     }
 
+    // Scrubbing, one frame by frame duration of the source at most: a frame due less than a frame duration after
+    // the last one shown, or late by more than a frame duration while one was shown in the last frame duration
+    bool scrubDrop(double pts, double speed) const
+    {
+        QMutexLocker locker(&m_mutex);
+        const double interval = frameRate > 0 ? frameRate : minThreshold;
+        if (frameTimer <= 0 || speed <= 0)
+            return false;
+        const double delay = (pts - prevPts) / speed;
+        if (isnan(delay) || delay < 0 || delay > maxFrameDuration)
+            return false;
+        // Time stamps are not exact, the frame due one frame duration later is kept
+        if (delay < interval * 0.9)
+            return true;
+        const double time = av_gettime_relative() / 1000000.0;
+        return time > frameTimer + delay + interval && time - shownTime < interval;
+    }
+
+    // Time the consumer spent in the decoder, in seconds, and the frames it returned
+    double decodeTime() const
+    {
+        return m_decodeTime / 1000000.0;
+    }
+
+    quint64 decodedFrames() const
+    {
+        return m_decodedCount;
+    }
+
     void clear()
     {
         QMutexLocker locker(&m_mutex);
         prevPts = 0;
         frameTimer = 0;
+        shownTime = 0;
     }
 
     void setFrameRate(double v)
@@ -109,6 +142,7 @@ private:
     double frameRate = 0;
     double frameTimer = 0;
     double prevPts = 0;
+    double shownTime = 0;
     mutable QMutex m_mutex;
     const double maxFrameDuration = 10.0;
     const double minThreshold = 0.04;
@@ -117,6 +151,27 @@ private:
     const double refreshRate = 0.01;
 };
 
+// Bytes of the buffers referenced by a decoded frame, shared with the other references to them
+inline qint64 qavFrameBytes(const QAVFrame &frame)
+{
+    const AVFrame *f = frame.frame();
+    if (!f)
+        return 0;
+    qint64 bytes = 0;
+    for (auto buf : f->buf) {
+        if (buf)
+            bytes += buf->size;
+    }
+    for (int i = 0; i < f->nb_extended_buf; ++i)
+        bytes += f->extended_buf[i]->size;
+    return bytes;
+}
+
+inline qint64 qavFrameBytes(const QAVSubtitleFrame &)
+{
+    return 0;
+}
+
 template<class T>
 class QAVPacketQueue
 {
@@ -140,14 +195,61 @@ public:
     bool isEmpty() const
     {
         QMutexLocker locker(&m_mutex);
-        return m_packets.isEmpty() && m_decodedFrames.isEmpty();
+        // Decoding state is read before the frames, so a packet being decoded is seen in one of them
+        return m_packets.isEmpty() && !m_decoding && m_aheadFrames.isEmpty() && !m_framesCount;
+    }
+
+    // Frames decoded ahead of the consumer by decodeAhead() from another thread, 0 (default) for decoding by
+    // frontFrame(); set before the first packet
+    void setDecodeAhead(int frames)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_aheadMax = frames;
+    }
+
+    int decodeAhead() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_aheadMax;
+    }
+
+    // Decodes the next packet while the consumer goes on with the frames before, waits for room among the
+    // frames decoded ahead and for a packet (not woken by wake(), only by enqueue() and abort())
+    void decodeNext()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_abort && m_aheadFrames.size() >= m_aheadMax) {
+            QAVTrace trace("decode ahead wait");
+            m_aheadWaiter.wait(&m_mutex);
+        }
+        if (m_abort)
+            return;
+        QAVPacket packet = dequeue(false);
+        const quint64 generation = m_generation;
+        locker.unlock();
+
+        // Only this thread uses the decoder, the frames are kept if the packets were not cleared meanwhile
+        QList<T> frames;
+        const int64_t start = av_gettime_relative();
+        m_demuxer.decode(packet, frames);
+        m_decodeTime += av_gettime_relative() - start;
+        m_decodedCount += frames.size();
+
+        locker.relock();
+        if (generation == m_generation && !frames.isEmpty()) {
+            m_aheadFrames.append(frames);
+            m_framesWaiter.wakeAll();
+        }
+        m_decoding = false;
     }
 
     void enqueue(const QAVPacket &packet)
     {
         QMutexLocker locker(&m_mutex);
         m_packets.append(packet);
-        m_bytes += packet.packet()->size + sizeof(packet);
+        const int size = packet.packet()->size + sizeof(packet);
+        m_averageBytes = m_averageBytes > 0 ? m_averageBytes * 0.9 + size * 0.1 : size;
+        m_bytes += size;
         m_duration += packet.duration();
         m_consumerWaiter.wakeAll();
         m_abort = false;
@@ -156,9 +258,43 @@ public:
 
     bool frontFrame(T &frame)
     {
-        QMutexLocker locker(&m_mutex);
-        if (m_decodedFrames.isEmpty())
-            m_demuxer.decode(dequeue(), m_decodedFrames);
+        QMutexLocker framesLocker(&m_framesMutex);
+        if (m_decodedFrames.isEmpty() && decodeAhead() > 0) {
+            // Waiting for the decoder does not keep the frames locked either
+            framesLocker.unlock();
+            QMutexLocker locker(&m_mutex);
+            if (m_aheadFrames.isEmpty() && !m_abort && !m_wake) {
+                QAVTrace trace("decoded frames wait");
+                m_framesWaiter.wait(&m_mutex);
+            }
+            locker.unlock();
+
+            framesLocker.relock();
+            locker.relock();
+            if (m_decodedFrames.isEmpty()) {
+                m_decodedFrames.swap(m_aheadFrames);
+                m_framesCount = m_decodedFrames.size();
+                m_aheadWaiter.wakeAll();
+            }
+        } else if (m_decodedFrames.isEmpty()) {
+            // Waiting for a packet does not keep the frames locked, clearing must not wait for the demuxer
+            framesLocker.unlock();
+            QMutexLocker locker(&m_mutex);
+            QAVPacket packet = dequeue();
+            const quint64 generation = m_generation;
+            locker.unlock();
+
+            // Decoding keeps only the frames locked, the demuxer is not blocked while a packet is decoded
+            framesLocker.relock();
+            if (generation == currentGeneration() && m_decodedFrames.isEmpty()) {
+                const int64_t start = av_gettime_relative();
+                m_demuxer.decode(packet, m_decodedFrames);
+                m_decodeTime += av_gettime_relative() - start;
+                m_decodedCount += m_decodedFrames.size();
+                m_framesCount = m_decodedFrames.size();
+            }
+            m_decoding = false;
+        }
         if (m_decodedFrames.isEmpty())
             return false;
         frame = m_decodedFrames.front();
@@ -167,15 +303,18 @@ public:
 
     void popFrame()
     {
-        QMutexLocker locker(&m_mutex);
+        QMutexLocker framesLocker(&m_framesMutex);
         if (!m_decodedFrames.isEmpty())
             m_decodedFrames.pop_front();
+        m_framesCount = m_decodedFrames.size();
     }
 
     void waitForEmpty()
     {
+        QMutexLocker framesLocker(&m_framesMutex);
         QMutexLocker locker(&m_mutex);
         clearPackets();
+        framesLocker.unlock();
         if (!m_abort && !m_waitingForPackets)
             m_producerWaiter.wait(&m_mutex);
     }
@@ -187,6 +326,8 @@ public:
         m_waitingForPackets = true;
         m_consumerWaiter.wakeAll();
         m_producerWaiter.wakeAll();
+        m_framesWaiter.wakeAll();
+        m_aheadWaiter.wakeAll();
     }
 
     bool enough() const
@@ -196,40 +337,87 @@ public:
         return m_packets.size() > minFrames && (!m_duration || m_duration > 1.0);
     }
 
-    int bytes() const
+    qint64 bytes() const
     {
         QMutexLocker locker(&m_mutex);
         return m_bytes;
     }
 
+    int count() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_packets.size();
+    }
+
+    // Bytes of the frames decoded and not taken by the consumer yet, the value of the previous call
+    // while the consumer is decoding (not waited for)
+    qint64 framesBytes() const
+    {
+        if (!m_framesMutex.tryLock())
+            return m_framesBytes;
+        qint64 bytes = 0;
+        for (const auto &frame : m_decodedFrames)
+            bytes += qavFrameBytes(frame);
+        m_framesMutex.unlock();
+
+        QMutexLocker locker(&m_mutex);
+        for (const auto &frame : m_aheadFrames)
+            bytes += qavFrameBytes(frame);
+        m_framesBytes = bytes;
+        return bytes;
+    }
+
+    // Bytes needed for at least minFrames packets, or for the packets taken by the consumer in the duration (seconds)
+    qint64 lookaheadBytes(int minFrames, double duration) const
+    {
+        QMutexLocker locker(&m_mutex);
+        const double frames = qMax<double>(minFrames, m_rate * duration);
+        return qint64(frames * m_averageBytes);
+    }
+
+    // Time the consumer waited for packets, in seconds
+    double stallTime() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_stallTime;
+    }
+
     void clear()
     {
+        QMutexLocker framesLocker(&m_framesMutex);
         QMutexLocker locker(&m_mutex);
         clearPackets();
     }
 
     void clearFrames()
     {
-        QMutexLocker locker(&m_mutex);
+        QMutexLocker framesLocker(&m_framesMutex);
         m_decodedFrames.clear();
+        m_framesCount = 0;
     }
 
     void wake(bool wake)
     {
         QMutexLocker locker(&m_mutex);
-        if (wake)
+        if (wake) {
             m_consumerWaiter.wakeAll();
+            m_framesWaiter.wakeAll();
+        }
         m_wake = wake;
     }
 
 private:
-    QAVPacket dequeue()
+    // Called with m_mutex locked
+    QAVPacket dequeue(bool wakeable = true)
     {
         if (m_packets.isEmpty()) {
             m_producerWaiter.wakeAll();
-            if (!m_abort && !m_wake) {
+            if (!m_abort && !(m_wake && wakeable)) {
                 m_waitingForPackets = true;
+                const double start = av_gettime_relative() / 1000000.0;
+                QAVTrace trace("packet queue wait");
                 m_consumerWaiter.wait(&m_mutex);
+                m_stallTime += av_gettime_relative() / 1000000.0 - start;
                 m_waitingForPackets = false;
             }
         }
@@ -239,31 +427,82 @@ private:
         auto packet = m_packets.takeFirst();
         m_bytes -= packet.packet()->size + sizeof(packet);
         m_duration -= packet.duration();
+        m_decoding = true;
+        updateRate();
         return packet;
     }
 
+    // Packets taken per second, averaged over windows of half a second
+    void updateRate()
+    {
+        const double time = av_gettime_relative() / 1000000.0;
+        ++m_rateCount;
+        if (!m_rateStart) {
+            m_rateStart = time;
+            return;
+        }
+        const double elapsed = time - m_rateStart;
+        if (elapsed < 0.5)
+            return;
+        const double rate = m_rateCount / elapsed;
+        m_rate = m_rate > 0 ? m_rate * 0.5 + rate * 0.5 : rate;
+        m_rateStart = time;
+        m_rateCount = 0;
+    }
+
+    quint64 currentGeneration() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_generation;
+    }
+
+    // Called with both m_framesMutex and m_mutex locked
     void clearPackets()
     {
         m_packets.clear();
         m_decodedFrames.clear();
+        m_framesCount = 0;
+        m_aheadFrames.clear();
+        m_aheadWaiter.wakeAll();
         m_bytes = 0;
         m_duration = 0;
+        // A packet dequeued before is not decoded anymore
+        ++m_generation;
     }
 
     const AVMediaType m_mediaType = AVMEDIA_TYPE_UNKNOWN;
     QAVDemuxer &m_demuxer;
+    // Locked by the demuxer and by the consumer for short operations only
     QList<QAVPacket> m_packets;
-    // Tracks decoded frames to prevent EOF if not all frames are landed
-    QList<T> m_decodedFrames;
     mutable QMutex m_mutex;
+    // Tracks decoded frames to prevent EOF if not all frames are landed, used by the consumer only while decoding
+    // Lock order is m_framesMutex then m_mutex
+    QList<T> m_decodedFrames;
+    mutable QMutex m_framesMutex;
+    mutable std::atomic<qint64> m_framesBytes {0};
+    std::atomic_bool m_decoding {false};
+    std::atomic_int m_framesCount {0};
+    quint64 m_generation = 0;
     QWaitCondition m_consumerWaiter;
     QWaitCondition m_producerWaiter;
+    // Decoded by decodeNext() and not taken by frontFrame() yet, locked by m_mutex
+    QList<T> m_aheadFrames;
+    int m_aheadMax = 0;
+    QWaitCondition m_framesWaiter; // Consumer waiting for decoded frames
+    QWaitCondition m_aheadWaiter; // Decoder waiting for room
     bool m_abort = false;
     bool m_waitingForPackets = true;
     bool m_wake = false;
 
-    int m_bytes = 0;
+    qint64 m_bytes = 0;
     int m_duration = 0;
+    double m_averageBytes = 0;
+    double m_rate = 0;
+    double m_rateStart = 0;
+    int m_rateCount = 0;
+    double m_stallTime = 0;
+    std::atomic<qint64> m_decodeTime {0}; // Microseconds
+    std::atomic<quint64> m_decodedCount {0};
 
 private:
     Q_DISABLE_COPY(QAVPacketQueue)
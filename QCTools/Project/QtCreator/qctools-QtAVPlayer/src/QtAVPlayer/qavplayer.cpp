@@ -18,12 +18,21 @@
 #include "qavvideofilter_p.h"
 #include "qavaudiofilter_p.h"
 #include "qavfilters_p.h"
+#include "qavpool_p.h"
+#include "qavbufferpool_p.h"
+#include "qavtrace_p.h"
 #include <QtConcurrent/qtconcurrentrun.h>
 #include <QLoggingCategory>
 #include <functional>
+#include <map>
+#include <memory>
+#include <vector>
 
 extern "C" {
 #include <libavformat/avformat.h>
+#include <libavutil/hash.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
 }
 
 QT_BEGIN_NAMESPACE
@@ -41,6 +50,30 @@ enum PendingMediaStatus
     EndOfMedia
 };
 
+// Loader, demuxer, video and audio threads, the decode stages and the tracks add their own
+static const int playerThreads = 4;
+
+// Current stream after the first one of its type, see QAVPlayer::setStreamThreads()
+struct QAVStreamTrack
+{
+    QAVStreamTrack(const QAVStream &s, AVMediaType mediaType, QAVDemuxer &demuxer)
+        : stream(s)
+        , queue(mediaType, demuxer)
+    {
+        if (mediaType == AVMEDIA_TYPE_VIDEO)
+            filters.setStreams(stream, {});
+        else
+            filters.setStreams({}, stream);
+    }
+
+    QAVStream stream;
+    QAVPacketQueue<QAVFrame> queue;
+    QAVQueueClock clock;
+    QAVFilters filters;
+    QFuture<void> future;
+    QFuture<void> decodeFuture;
+};
+
 class QAVPlayerPrivate
 {
     Q_DECLARE_PUBLIC(QAVPlayer)
@@ -51,7 +84,7 @@ public:
         , audioQueue(AVMEDIA_TYPE_AUDIO, demuxer)
         , subtitleQueue(AVMEDIA_TYPE_SUBTITLE, demuxer)
     {
-        threadPool.setMaxThreadCount(4);
+        threadPool.setMaxThreadCount(playerThreads);
     }
 
     QAVPlayer::Error currentError() const;
@@ -72,13 +105,26 @@ public:
     double pts() const;
     void applyFilters();
     void applyFilters(bool reset, const QAVFrame &frame);
+    bool applyFilters(QAVFilters &target, bool reset, const QAVFrame &frame);
+    void applyFilters(QAVStreamTrack &track, bool reset, const QAVFrame &frame);
+    QAVStreamTrack *streamTrack(const QAVPacket &packet, AVMediaType mediaType);
+    template <class Fn>
+    void forTracks(Fn fn) const;
+    bool tracksEmpty() const;
 
     void terminate();
 
     void doWait();
+    int64_t waitDemuxer(const std::function<bool()> &shouldWait);
+    qint64 queueBudget() const;
+    void wakeDemuxer();
     void wait(bool v);
     void doLoad();
     void doDemux();
+    bool sampleVideo(const QAVStream &stream, bool isKey, bool decoded);
+    void updateVideoDiscard();
+    QList<bool> duplicateGraphs(const QAVFrame &frame, QByteArray &hash);
+    void setFrameHash(const QAVStream &stream, const QByteArray &hash);
     bool skipFrame(
         bool master,
         const QAVStreamFrame &frame,
@@ -94,7 +140,8 @@ public:
         QAVQueueClock &clock,
         QAVPacketQueue<QAVFrame> &queue,
         bool &sync,
-        const std::function<void(const QAVFrame &frame)> &cb);
+        const std::function<void(const QAVFrame &frame)> &cb,
+        QAVStreamTrack *track = nullptr);
     void doPlayStep(
         QAVQueueClock &clock,
         QAVPacketQueue<QAVSubtitleFrame> &queue,
@@ -104,6 +151,9 @@ public:
     void doPlayVideo();
     void doPlayAudio();
     void doPlaySubtitle();
+    void doPlayTrack(QAVStreamTrack *track);
+    void doDecode(QAVPacketQueue<QAVFrame> *queue);
+    QFuture<void> startDecode(QAVPacketQueue<QAVFrame> &queue);
 
     template <class T>
     void dispatch(T fn);
@@ -124,6 +174,10 @@ public:
     double duration = 0;
     double pendingPosition = 0;
     bool pendingSeek = false;
+    // Position reached by decoding forward from the last seek, without seeking again, see QAVPlayer::seek()
+    bool pendingForward = false;
+    // Key frame the last seek of the demuxer started on, -1 if not known
+    double seekKeyFrame = -1;
     double currPts = 0.0;
     mutable QMutex positionMutex;
     bool synced = true;
@@ -148,6 +202,22 @@ public:
     QAVPacketQueue<QAVSubtitleFrame> subtitleQueue;
     QAVQueueClock subtitleClock;
 
+    // Created by the demuxer for the first packet of their stream, kept until the source is changed
+    std::atomic_bool streamThreads {false};
+    std::atomic_int decodeAhead {0};
+
+    // Threads of the pool running a loop of the player, see QAVPlayer::setThreadPriority()
+    QThread::Priority threadPriority = QThread::InheritPriority;
+    std::function<void()> threadInit;
+    QList<QThread *> workerThreads;
+    mutable QMutex workerThreadsMutex;
+    void enterWorker();
+    void leaveWorker();
+    QFuture<void> videoDecodeFuture;
+    QFuture<void> audioDecodeFuture;
+    std::vector<std::unique_ptr<QAVStreamTrack>> tracks;
+    mutable QMutex tracksMutex;
+
     bool quit = 0;
     bool isWaiting = false;
     mutable QMutex waitMutex;
@@ -155,8 +225,36 @@ public:
     bool eof = false;
     std::atomic_bool startDemuxing {false};
 
+    // Demuxer sleeps until the consumers take packets or the state changes
+    QMutex demuxerMutex;
+    QWaitCondition demuxerWaiter;
+    std::atomic_bool demuxerWaiting {false};
+    std::atomic<quint64> demuxerWakeups {0};
+    std::atomic<qint64> maxQueueBytes {0};
+    std::atomic_int maxQueueFrames {0};
+    std::atomic<qint64> demuxerStallTime {0}; // Microseconds
+    std::atomic<qint64> demuxedBytes {0};
+    std::atomic<quint64> demuxedPackets {0};
+
     QList<QString> filterDescs;
+    QList<bool> filterCacheable; // By graph, see QAVPlayer::setFilters()
     QAVFilters filters;
+    // Last decoded video frame sent to the filters and shown, see QAVPlayer::refilter()
+    QAVFrame lastVideoFrame;
+    mutable QMutex lastVideoFrameMutex;
+    std::atomic_int filterThreads {0};
+    std::atomic_bool parallelFilters {false};
+
+    std::atomic_int videoSampling {0};
+    std::map<int, quint64> sampledPackets; // By stream, demuxer thread only
+    std::map<int, quint64> sampledFrames; // By stream, locked by sampledFramesMutex (video threads)
+    QMutex sampledFramesMutex;
+
+    std::atomic_bool scrub {false};
+
+    QList<bool> skipDuplicateFrames; // By graph, see QAVPlayer::setSkipDuplicateFrames()
+    std::map<int, QByteArray> frameHashes; // Of the last video frame written, by stream
+    mutable QMutex duplicatesMutex;
 };
 
 static QString err_str(int err)
@@ -326,17 +424,51 @@ void QAVPlayerPrivate::terminate()
     subtitleQueue.clear();
     subtitleQueue.abort();
     subtitleClock.clear();
+    forTracks([](QAVStreamTrack &track) {
+        track.queue.clear();
+        track.queue.abort();
+        track.clock.clear();
+    });
     if (dev)
         dev->abort(true);
     loaderFuture.waitForFinished();
     demuxerFuture.waitForFinished();
     videoPlayFuture.waitForFinished();
     audioPlayFuture.waitForFinished();
+    // The demuxer may have enqueued a packet after the abort
+    videoQueue.abort();
+    audioQueue.abort();
+    forTracks([](QAVStreamTrack &track) { track.queue.abort(); });
+    videoDecodeFuture.waitForFinished();
+    audioDecodeFuture.waitForFinished();
+    forTracks([](QAVStreamTrack &track) {
+        track.future.waitForFinished();
+        track.decodeFuture.waitForFinished();
+    });
+    {
+        QMutexLocker locker(&tracksMutex);
+        tracks.clear();
+    }
+    videoQueue.setDecodeAhead(0);
+    audioQueue.setDecodeAhead(0);
+    threadPool.setMaxThreadCount(playerThreads);
     pendingPosition = 0;
     pendingSeek = false;
+    pendingForward = false;
+    seekKeyFrame = -1;
     currPts = 0.0;
     pendingMediaStatuses.clear();
     filters.clear();
+    {
+        QMutexLocker locker(&lastVideoFrameMutex);
+        lastVideoFrame = QAVFrame();
+    }
+    sampledPackets.clear();
+    sampledFrames.clear();
+    {
+        QMutexLocker locker(&duplicatesMutex);
+        frameHashes.clear();
+    }
     setDuration(0);
     error = QAVPlayer::NoError;
     dev.reset();
@@ -363,6 +495,7 @@ void QAVPlayerPrivate::step(bool hasFrame)
         videoQueue.wake(false);
         audioQueue.wake(false);
         subtitleQueue.wake(false);
+        forTracks([](QAVStreamTrack &track) { track.queue.wake(false); });
     } else {
         wait(false);
     }
@@ -444,6 +577,7 @@ bool QAVPlayerPrivate::doStep(PendingMediaStatus status, bool hasFrame)
         && videoQueue.isEmpty()
         && audioQueue.isEmpty()
         && filters.isEmpty()
+        && tracksEmpty()
         && !isSeeking())
     {
         result = true;
@@ -476,31 +610,173 @@ void QAVPlayerPrivate::wait(bool v)
     videoQueue.wake(true);
     audioQueue.wake(true);
     subtitleQueue.wake(true);
+    forTracks([](QAVStreamTrack &track) { track.queue.wake(true); });
+    wakeDemuxer();
+}
+
+int64_t QAVPlayerPrivate::waitDemuxer(const std::function<bool()> &shouldWait)
+{
+    QMutexLocker locker(&demuxerMutex);
+    // Set before checking, so a wake after the check is not lost
+    demuxerWaiting = true;
+    int64_t waited = 0;
+    if (!quit && shouldWait()) {
+        const int64_t start = av_gettime_relative();
+        QAVTrace trace("demuxer wait");
+        demuxerWaiter.wait(&demuxerMutex);
+        waited = av_gettime_relative() - start;
+    }
+    demuxerWaiting = false;
+    return waited;
+}
+
+qint64 QAVPlayerPrivate::queueBudget() const
+{
+    const qint64 bytes = maxQueueBytes;
+    if (bytes > 0)
+        return bytes;
+
+    // Uncompressed frames are several MiB each, a fixed budget would leave about one frame of lookahead
+    const qint64 minBytes = 15 * 1024 * 1024;
+    const qint64 maxBytes = 1024 * 1024 * 1024;
+    const int minFrames = 16;
+    const double duration = 0.5;
+    qint64 budget = videoQueue.lookaheadBytes(minFrames, duration) + audioQueue.lookaheadBytes(minFrames, duration);
+    forTracks([&](QAVStreamTrack &track) { budget += track.queue.lookaheadBytes(minFrames, duration); });
+    return qBound(minBytes, budget, maxBytes);
+}
+
+void QAVPlayerPrivate::wakeDemuxer()
+{
+    ++demuxerWakeups;
+    if (demuxerWaiting) {
+        QMutexLocker locker(&demuxerMutex);
+        demuxerWaiter.wakeAll();
+    }
 }
 
 void QAVPlayerPrivate::applyFilters()
 {
     applyFilters(false, {});
+    forTracks([this](QAVStreamTrack &track) { applyFilters(track, false, {}); });
 }
 
 void QAVPlayerPrivate::applyFilters(bool reset, const QAVFrame &frame)
 {
-    if ((filterDescs == filters.filterDescs()) && !reset)
+    if (!applyFilters(filters, reset, frame))
         return;
-    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << filters.filterDescs() << "->" << filterDescs << "reset:" << reset;
-    int ret = filters.createFilters(filterDescs, frame, demuxer);
-    if (ret < 0) {
-        setError(QAVPlayer::FilterError, QLatin1String("Could not create filters: ") + err_str(ret));
-        return;
-    }
     videoQueue.clearFrames();
     audioQueue.clearFrames();
     if (error == QAVPlayer::FilterError)
         setMediaStatus(QAVPlayer::LoadedMedia);
 }
 
+// Returns true if the graphs are created
+bool QAVPlayerPrivate::applyFilters(QAVFilters &target, bool reset, const QAVFrame &frame)
+{
+    if ((filterDescs == target.filterDescs()) && !reset)
+        return false;
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << target.filterDescs() << "->" << filterDescs << "reset:" << reset;
+    int ret = target.createFilters(filterDescs, frame, demuxer, filterThreads, parallelFilters, filterCacheable, !reset);
+    if (ret < 0) {
+        setError(QAVPlayer::FilterError, QLatin1String("Could not create filters: ") + err_str(ret));
+        return false;
+    }
+    return true;
+}
+
+void QAVPlayerPrivate::applyFilters(QAVStreamTrack &track, bool reset, const QAVFrame &frame)
+{
+    if (applyFilters(track.filters, reset, frame))
+        track.queue.clearFrames();
+}
+
+// Tracks are only removed once their threads are finished, see terminate()
+template <class Fn>
+void QAVPlayerPrivate::forTracks(Fn fn) const
+{
+    std::vector<QAVStreamTrack *> current;
+    {
+        QMutexLocker locker(&tracksMutex);
+        for (const auto &track : tracks)
+            current.push_back(track.get());
+    }
+    for (auto track : current)
+        fn(*track);
+}
+
+bool QAVPlayerPrivate::tracksEmpty() const
+{
+    bool result = true;
+    forTracks([&](QAVStreamTrack &track) { result = result && track.queue.isEmpty() && track.filters.isEmpty(); });
+    return result;
+}
+
+// Track of the stream of the packet if it is not the first current stream of its type, created for its first packet
+QAVStreamTrack *QAVPlayerPrivate::streamTrack(const QAVPacket &packet, AVMediaType mediaType)
+{
+    if (!streamThreads)
+        return nullptr;
+    const int index = packet.packet()->stream_index;
+    const auto streams = mediaType == AVMEDIA_TYPE_VIDEO ? demuxer.currentVideoStreams() : demuxer.currentAudioStreams();
+    if (streams.isEmpty() || streams.first().index() == index)
+        return nullptr;
+
+    QMutexLocker locker(&tracksMutex);
+    for (const auto &track : tracks) {
+        if (track->stream.index() == index)
+            return track.get();
+    }
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ": thread for stream" << index;
+    tracks.emplace_back(new QAVStreamTrack(packet.stream(), mediaType, demuxer));
+    auto track = tracks.back().get();
+    applyFilters(*track, true, {});
+    track->decodeFuture = startDecode(track->queue);
+    threadPool.setMaxThreadCount(threadPool.maxThreadCount() + 1);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    track->future = QtConcurrent::run(&threadPool, this, &QAVPlayerPrivate::doPlayTrack, track);
+#else
+    track->future = QtConcurrent::run(&threadPool, &QAVPlayerPrivate::doPlayTrack, this, track);
+#endif
+    return track;
+}
+
+void QAVPlayerPrivate::enterWorker()
+{
+    std::function<void()> init;
+    {
+        QMutexLocker locker(&workerThreadsMutex);
+        auto thread = QThread::currentThread();
+        workerThreads.append(thread);
+        if (threadPriority != QThread::InheritPriority)
+            thread->setPriority(threadPriority);
+        init = threadInit;
+    }
+    if (init)
+        init();
+}
+
+void QAVPlayerPrivate::leaveWorker()
+{
+    QMutexLocker locker(&workerThreadsMutex);
+    auto thread = QThread::currentThread();
+    workerThreads.removeOne(thread);
+    // Pool threads are reused by the other loops
+    if (threadPriority != QThread::InheritPriority)
+        thread->setPriority(QThread::NormalPriority);
+}
+
+// Loop of a worker thread, registered while it runs
+struct QAVWorkerScope
+{
+    explicit QAVWorkerScope(QAVPlayerPrivate *d) : d(d) { d->enterWorker(); }
+    ~QAVWorkerScope() { d->leaveWorker(); }
+    QAVPlayerPrivate *d;
+};
+
 void QAVPlayerPrivate::doLoad()
 {
+    QAVWorkerScope worker(this);
     demuxer.abort(false);
     demuxer.unload();
     int ret = demuxer.load(url, dev.get());
@@ -523,6 +799,10 @@ void QAVPlayerPrivate::doLoad()
         step(false);
     });
 
+    if (!q_ptr->availableVideoStreams().isEmpty())
+        videoDecodeFuture = startDecode(videoQueue);
+    if (!q_ptr->availableAudioStreams().isEmpty())
+        audioDecodeFuture = startDecode(audioQueue);
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     demuxerFuture = QtConcurrent::run(&threadPool, this, &QAVPlayerPrivate::doDemux);
     if (!q_ptr->availableVideoStreams().isEmpty())
@@ -545,17 +825,32 @@ void QAVPlayerPrivate::doLoad()
 
 void QAVPlayerPrivate::doDemux()
 {
-    const int maxQueueBytes = 15 * 1024 * 1024;
+    QAVWorkerScope worker(this);
     QMutex waiterMutex;
     QWaitCondition waiter;
+    auto isFull = [&]() {
+        const int maxFrames = maxQueueFrames;
+        qint64 bytes = videoQueue.bytes() + audioQueue.bytes();
+        bool enough = videoQueue.enough() && audioQueue.enough();
+        bool maxed = maxFrames > 0 && (videoQueue.count() >= maxFrames || audioQueue.count() >= maxFrames);
+        // The queues of the other streams are filled as the ones of the first streams
+        forTracks([&](QAVStreamTrack &track) {
+            bytes += track.queue.bytes();
+            enough = enough && track.queue.enough();
+            maxed = maxed || (maxFrames > 0 && track.queue.count() >= maxFrames);
+        });
+        return bytes > queueBudget() || enough || maxed || !startDemuxing;
+    };
+
+    // A seek does not wait for the queued packets to be decoded, they are dropped
+    auto shouldWait = [&]() { return isFull() && !isSeeking(); };
 
     while (!quit) {
-        if (videoQueue.bytes() + audioQueue.bytes() > maxQueueBytes
-            || (videoQueue.enough() && audioQueue.enough())
-            || !startDemuxing)
-        {
-            QMutexLocker locker(&waiterMutex);
-            waiter.wait(&waiterMutex, 10);
+        if (shouldWait()) {
+            // Woken by the consumers when they take packets, or by play and seek
+            const int64_t waited = waitDemuxer(shouldWait);
+            if (startDemuxing)
+                demuxerStallTime += waited;
             continue;
         }
 
@@ -580,15 +875,23 @@ void QAVPlayerPrivate::doDemux()
                     qCDebug(lcAVPlayer) << "Waiting subtitle thread finished processing packets";
                     subtitleQueue.waitForEmpty();
                     subtitleClock.clear();
+                    qCDebug(lcAVPlayer) << "Waiting stream threads finished processing packets";
+                    forTracks([](QAVStreamTrack &track) {
+                        track.queue.waitForEmpty();
+                        track.clock.clear();
+                    });
                     qCDebug(lcAVPlayer) << "Flush codec buffers";
                     demuxer.flushCodecBuffers();
                     qCDebug(lcAVPlayer) << "Reset filters";
                     applyFilters(true, {});
+                    forTracks([this](QAVStreamTrack &track) { applyFilters(track, true, {}); });
                     qCDebug(lcAVPlayer) << "Start reading packets from" << pos * 1000;
                 } else {
                     qWarning() << "Could not seek:" << ret << ":" << err_str(ret);
                 }
+                const double keyFrame = ret >= 0 ? demuxer.keyFrame(pos) : -1;
                 locker.relock();
+                seekKeyFrame = keyFrame;
                 if (qFuzzyCompare(pendingPosition, pos))
                     pendingSeek = false;
             }
@@ -597,13 +900,23 @@ void QAVPlayerPrivate::doDemux()
         auto packet = demuxer.read();
         if (packet.stream()) {
             endOfFile(false);
+            demuxedBytes += packet.packet()->size;
+            ++demuxedPackets;
             // Empty packet points to EOF and it needs to flush codecs
             switch (demuxer.currentCodecType(packet.packet()->stream_index)) {
                 case AVMEDIA_TYPE_VIDEO:
-                    videoQueue.enqueue(packet);
+                    if (packet.packet()->size > 0 && !sampleVideo(packet.stream(), packet.packet()->flags & AV_PKT_FLAG_KEY, false))
+                        break;
+                    if (auto track = streamTrack(packet, AVMEDIA_TYPE_VIDEO))
+                        track->queue.enqueue(packet);
+                    else
+                        videoQueue.enqueue(packet);
                     break;
                 case AVMEDIA_TYPE_AUDIO:
-                    audioQueue.enqueue(packet);
+                    if (auto track = streamTrack(packet, AVMEDIA_TYPE_AUDIO))
+                        track->queue.enqueue(packet);
+                    else
+                        audioQueue.enqueue(packet);
                     break;
                 case AVMEDIA_TYPE_SUBTITLE:
                     subtitleQueue.enqueue(packet);
@@ -612,14 +925,17 @@ void QAVPlayerPrivate::doDemux()
                     break;
             }
         } else {
+            const quint64 wakeups = demuxerWakeups;
             if (demuxer.eof()
                 && videoQueue.isEmpty()
                 && audioQueue.isEmpty()
                 && subtitleQueue.isEmpty()
                 && filters.isEmpty()
+                && tracksEmpty()
                 && !isEndOfFile())
             {
                 filters.flush();
+                forTracks([](QAVStreamTrack &track) { track.filters.flush(); });
                 endOfFile(true);
                 qCDebug(lcAVPlayer) << "EndOfMedia";
                 setPendingMediaStatus(EndOfMedia);
@@ -627,13 +943,113 @@ void QAVPlayerPrivate::doDemux()
                 wait(false);
             }
 
-            QMutexLocker locker(&waiterMutex);
-            waiter.wait(&waiterMutex, 10);
+            if (demuxer.eof()) {
+                // Nothing to do until the queues are drained or a seek
+                waitDemuxer([&]() { return wakeups == demuxerWakeups; });
+            } else {
+                // Read error, retried
+                QMutexLocker locker(&waiterMutex);
+                waiter.wait(&waiterMutex, 10);
+            }
         }
     }
     qCDebug(lcAVPlayer) << __FUNCTION__ << "finished";
 }
 
+// Packets are dropped if the frames can be decoded without them, else the frames are dropped once decoded
+bool QAVPlayerPrivate::sampleVideo(const QAVStream &stream, bool isKey, bool decoded)
+{
+    const int every = videoSampling;
+    if (every == 0 || every == 1)
+        return true;
+
+    const AVCodecDescriptor *desc = avcodec_descriptor_get(stream.stream()->codecpar->codec_id);
+    const bool intraOnly = desc && (desc->props & AV_CODEC_PROP_INTRA_ONLY);
+    if (every < 0)
+        return decoded || isKey;
+    if (decoded == intraOnly)
+        return true;
+
+    QMutexLocker locker(decoded ? &sampledFramesMutex : nullptr);
+    auto &count = (decoded ? sampledFrames : sampledPackets)[stream.index()];
+    return count++ % every == 0;
+}
+
+// Frames the video decoders skip when scrubbing, by speed
+void QAVPlayerPrivate::updateVideoDiscard()
+{
+    const qreal s = q_ptr->speed();
+    int discard = AVDISCARD_DEFAULT;
+    if (scrub && synced && s >= 8)
+        discard = AVDISCARD_NONKEY;
+    else if (scrub && synced && s >= 2)
+        discard = AVDISCARD_NONREF;
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << demuxer.videoDiscard() << "->" << discard;
+    demuxer.setVideoDiscard(discard);
+}
+
+// Pixels of a software video frame, with its format and size; empty for hardware frames
+static QByteArray frameHash(const AVFrame *frame)
+{
+    const AVPixelFormat format = AVPixelFormat(frame->format);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    int linesizes[4] = {};
+    if (!desc || frame->hw_frames_ctx || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)
+        || av_image_fill_linesizes(linesizes, format, frame->width) < 0)
+    {
+        return {};
+    }
+    AVHashContext *ctx = nullptr;
+    if (av_hash_alloc(&ctx, "murmur3") < 0)
+        return {};
+
+    av_hash_init(ctx);
+    const int planes = av_pix_fmt_count_planes(format);
+    for (int i = 0; i < planes; ++i) {
+        const int height = i == 1 || i == 2 ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) : frame->height;
+        const uint8_t *line = frame->data[i];
+        for (int y = 0; y < height; ++y, line += frame->linesize[i])
+            av_hash_update(ctx, line, linesizes[i]);
+    }
+    if (desc->flags & AV_PIX_FMT_FLAG_PAL)
+        av_hash_update(ctx, frame->data[1], AVPALETTE_SIZE);
+
+    QByteArray hash(av_hash_get_size(ctx), 0);
+    av_hash_final(ctx, reinterpret_cast<uint8_t *>(hash.data()));
+    av_hash_freep(&ctx);
+    const int info[] = { frame->format, frame->width, frame->height };
+    hash.append(reinterpret_cast<const char *>(info), sizeof(info));
+    return hash;
+}
+
+// Graphs not written with the frame if it has the pixels of the last frame written of its stream, hash is the one of the frame
+QList<bool> QAVPlayerPrivate::duplicateGraphs(const QAVFrame &frame, QByteArray &hash)
+{
+    QList<bool> skipped;
+    {
+        QMutexLocker locker(&duplicatesMutex);
+        skipped = skipDuplicateFrames;
+    }
+    if (skipped.isEmpty())
+        return {};
+
+    hash = frameHash(frame.frame());
+    QMutexLocker locker(&duplicatesMutex);
+    auto it = frameHashes.find(frame.stream().index());
+    if (hash.isEmpty() || it == frameHashes.end() || it->second != hash)
+        return {};
+    return skipped;
+}
+
+void QAVPlayerPrivate::setFrameHash(const QAVStream &stream, const QByteArray &hash)
+{
+    QMutexLocker locker(&duplicatesMutex);
+    if (hash.isEmpty())
+        frameHashes.erase(stream.index());
+    else
+        frameHashes[stream.index()] = hash;
+}
+
 static double streamDuration(const QAVStreamFrame &frame, const QAVDemuxer &demuxer)
 {
     double duration = demuxer.duration();
@@ -679,10 +1095,12 @@ bool QAVPlayerPrivate::skipFrame(
         }
         result = pos < requestedPos && !isQueueEOF && !lastFrame;
         if (master) {
-            if (result)
+            if (result) {
                 qCDebug(lcAVPlayer) << __FUNCTION__ << pos << "<" << requestedPos;
-            else
+            } else {
                 pendingPosition = 0;
+                pendingForward = false;
+            }
         }
     }
 
@@ -695,26 +1113,54 @@ void QAVPlayerPrivate::doPlayStep(
     QAVQueueClock &clock,
     QAVPacketQueue<QAVFrame> &queue,
     bool &sync,
-    const std::function<void(const QAVFrame &frame)> &cb)
+    const std::function<void(const QAVFrame &frame)> &cb,
+    QAVStreamTrack *track)
 {
     doWait();
 
     // 1. Decode a frame
     QAVFrame decodedFrame;
     queue.frontFrame(decodedFrame);
+    wakeDemuxer();
     bool flushEvents = false;
     int ret = 0;
 
-    // Determine if current thread is handling events and pts
-    if (decodedFrame)
+    // Determine if current thread is handling events and pts, never the thread of a track
+    if (decodedFrame && !track)
         master = demuxer.isMasterStream(decodedFrame.stream());
+    QAVFilters &streamFilters = track ? track->filters : filters;
+
+    // Not sent to the filters, see setVideoSampling()
+    if (decodedFrame && queue.mediaType() == AVMEDIA_TYPE_VIDEO && !sampleVideo(decodedFrame.stream(), true, true)) {
+        queue.popFrame();
+        if (master)
+            step(false);
+        return;
+    }
+
+    // Not worth filtering at this speed, see setScrub()
+    if (decodedFrame && queue.mediaType() == AVMEDIA_TYPE_VIDEO && scrub && synced) {
+        const qreal speed = q_ptr->speed();
+        if (speed > 1 && clock.scrubDrop(decodedFrame.pts(), speed)) {
+            queue.popFrame();
+            if (master)
+                step(false);
+            return;
+        }
+    }
+
+    // Same pixels as the last frame written, see setSkipDuplicateFrames()
+    QList<bool> skipped;
+    QByteArray hash;
+    if (decodedFrame && queue.mediaType() == AVMEDIA_TYPE_VIDEO)
+        skipped = duplicateGraphs(decodedFrame, hash);
 
     // 2. Filter decoded frame
     QList<QAVFrame> filteredFrames;
     if (decodedFrame)
-        ret = filters.write(queue.mediaType(), decodedFrame);
+        ret = streamFilters.write(queue.mediaType(), decodedFrame, false, skipped);
     if (ret >= 0 || ret == AVERROR(EAGAIN))
-        ret = filters.read(queue.mediaType(), decodedFrame, filteredFrames);
+        ret = streamFilters.read(queue.mediaType(), decodedFrame, filteredFrames);
     if (ret < 0 && ret != AVERROR(EAGAIN)) {
         // Try filters again
         filteredFrames.clear();
@@ -722,10 +1168,21 @@ void QAVPlayerPrivate::doPlayStep(
             setError(QAVPlayer::FilterError, err_str(ret));
             return;
         }
-        applyFilters(true, decodedFrame);
+        if (track)
+            applyFilters(*track, true, decodedFrame);
+        else
+            applyFilters(true, decodedFrame);
     } else {
         // The frame is already filtered, decode next one
         queue.popFrame();
+        if (decodedFrame && queue.mediaType() == AVMEDIA_TYPE_VIDEO)
+            setFrameHash(decodedFrame.stream(), hash);
+        if (!skipped.isEmpty()) {
+            QAVFrame duplicate = decodedFrame;
+            static const int duplicateOutput = QAVFrame::filterOutputId(QLatin1String("duplicate"));
+            duplicate.setFilterName(QLatin1String("duplicate"), duplicateOutput);
+            filteredFrames.append(duplicate);
+        }
     }
 
     // 3. Sync filtered frames
@@ -744,6 +1201,10 @@ void QAVPlayerPrivate::doPlayStep(
                     setPts(frame.pts());
                 if (!flushEvents)
                     flushEvents = true;
+                if (decodedFrame && queue.mediaType() == AVMEDIA_TYPE_VIDEO && !track) {
+                    QMutexLocker locker(&lastVideoFrameMutex);
+                    lastVideoFrame = decodedFrame;
+                }
                 cb(frame);
                 demuxer.onFrameSent(frame);
             }
@@ -759,6 +1220,7 @@ void QAVPlayerPrivate::doPlayStep(
 
 void QAVPlayerPrivate::doPlayVideo()
 {
+    QAVWorkerScope worker(this);
     videoClock.setFrameRate(demuxer.videoFrameRate());
     bool master = true;
     bool sync = true;
@@ -782,6 +1244,7 @@ void QAVPlayerPrivate::doPlayVideo()
 
 void QAVPlayerPrivate::doPlayAudio()
 {
+    QAVWorkerScope worker(this);
     bool master = false;
     const double ref = -1;
     bool sync = true;
@@ -807,6 +1270,66 @@ void QAVPlayerPrivate::doPlayAudio()
     qCDebug(lcAVPlayer) << __FUNCTION__ << "finished";
 }
 
+// Decode stage of the queue if frames are decoded ahead, see QAVPlayer::setDecodeAhead()
+QFuture<void> QAVPlayerPrivate::startDecode(QAVPacketQueue<QAVFrame> &queue)
+{
+    const int frames = decodeAhead;
+    if (frames <= 0)
+        return {};
+    queue.setDecodeAhead(frames);
+    threadPool.setMaxThreadCount(threadPool.maxThreadCount() + 1);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    return QtConcurrent::run(&threadPool, this, &QAVPlayerPrivate::doDecode, &queue);
+#else
+    return QtConcurrent::run(&threadPool, &QAVPlayerPrivate::doDecode, this, &queue);
+#endif
+}
+
+void QAVPlayerPrivate::doDecode(QAVPacketQueue<QAVFrame> *queue)
+{
+    QAVWorkerScope worker(this);
+    while (!quit) {
+        queue->decodeNext();
+        // A packet is taken, the demuxer may have room
+        wakeDemuxer();
+    }
+    qCDebug(lcAVPlayer) << __FUNCTION__ << queue->mediaType() << "finished";
+}
+
+// Frames of the stream are not synced with the first streams
+void QAVPlayerPrivate::doPlayTrack(QAVStreamTrack *track)
+{
+    QAVWorkerScope worker(this);
+    const bool video = track->queue.mediaType() == AVMEDIA_TYPE_VIDEO;
+    if (video)
+        track->clock.setFrameRate(demuxer.videoFrameRate());
+    bool master = false;
+    bool sync = true;
+
+    while (!quit) {
+        doPlayStep(
+            master,
+            -1,
+            track->clock,
+            track->queue,
+            sync,
+            [&](const QAVFrame &frame) {
+                if (video) {
+                    Q_EMIT q_ptr->videoFrame(frame);
+                } else {
+                    frame.frame()->sample_rate *= q_ptr->speed();
+                    Q_EMIT q_ptr->audioFrame(frame);
+                }
+            },
+            track
+        );
+    }
+
+    track->queue.clear();
+    track->clock.clear();
+    qCDebug(lcAVPlayer) << __FUNCTION__ << track->stream.index() << "finished";
+}
+
 void QAVPlayerPrivate::doPlayStep(
     QAVQueueClock &clock,
     QAVPacketQueue<QAVSubtitleFrame> &queue,
@@ -817,7 +1340,9 @@ void QAVPlayerPrivate::doPlayStep(
 
     // 1. Decode a frame
     QAVSubtitleFrame decodedFrame;
-    if (!queue.frontFrame(decodedFrame))
+    const bool hasFrame = queue.frontFrame(decodedFrame);
+    wakeDemuxer();
+    if (!hasFrame)
         return;
 
     // 2. Sync decoded frame
@@ -838,6 +1363,7 @@ void QAVPlayerPrivate::doPlayStep(
 
 void QAVPlayerPrivate::doPlaySubtitle()
 {
+    QAVWorkerScope worker(this);
     bool sync = true;
     while (!quit) {
         doPlayStep(
@@ -1118,8 +1644,14 @@ void QAVPlayer::seek(qint64 pos)
     qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << "pos:" << pos;
     {
         QMutexLocker locker(&d->positionMutex);
-        d->pendingSeek = true;
-        d->pendingPosition = pos / 1000.0;
+        // The last position wins: a seek the demuxer has not done yet is replaced, and a later position
+        // in the group of pictures being decoded after the previous seek is reached by decoding on
+        const double position = pos / 1000.0;
+        const bool forward = !d->pendingSeek && d->pendingPosition > 0 && position >= d->pendingPosition
+            && d->seekKeyFrame >= 0 && d->demuxer.keyFrame(position) == d->seekKeyFrame;
+        d->pendingSeek = !forward;
+        d->pendingForward = forward;
+        d->pendingPosition = position;
     }
 
     d->setPendingMediaStatus(SeekingMedia);
@@ -1139,7 +1671,7 @@ qint64 QAVPlayer::position() const
 
     {
         QMutexLocker locker(&d->positionMutex);
-        if (d->pendingSeek)
+        if (d->pendingSeek || d->pendingForward)
             return d->pendingPosition * 1000 + (d->pendingPosition < 0 ? duration() : 0);
     }
 
@@ -1161,6 +1693,7 @@ void QAVPlayer::setSpeed(qreal r)
         qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->speed << "->" << r;
         d->speed = r;
     }
+    d->updateVideoDiscard();
     Q_EMIT speedChanged(r);
 }
 
@@ -1178,6 +1711,11 @@ double QAVPlayer::videoFrameRate() const
 }
 
 void QAVPlayer::setFilter(const QString &desc)
+{
+    setFilter(desc, false);
+}
+
+void QAVPlayer::setFilter(const QString &desc, bool cacheable)
 {
     Q_D(QAVPlayer);
     {
@@ -1185,11 +1723,12 @@ void QAVPlayer::setFilter(const QString &desc)
         if (d->filterDescs.size() == 1 && d->filterDescs.front() == desc)
             return;
 
-        qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->filterDescs << "->" << desc;
+        qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->filterDescs << "->" << desc << "cacheable:" << cacheable;
         if (desc.isEmpty())
             d->filterDescs.clear();
         else
             d->filterDescs = {desc};
+        d->filterCacheable = {cacheable};
     }
 
     Q_EMIT filtersChanged({desc});
@@ -1198,12 +1737,18 @@ void QAVPlayer::setFilter(const QString &desc)
 }
 
 void QAVPlayer::setFilters(const QList<QString> &filters)
+{
+    setFilters(filters, {});
+}
+
+void QAVPlayer::setFilters(const QList<QString> &filters, const QList<bool> &cacheable)
 {
     Q_D(QAVPlayer);
     {
         QMutexLocker locker(&d->stateMutex);
-        qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->filterDescs << "->" << filters;
+        qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->filterDescs << "->" << filters << "cacheable:" << cacheable;
         d->filterDescs = filters;
+        d->filterCacheable = cacheable;
     }
 
     Q_EMIT filtersChanged(filters);
@@ -1218,6 +1763,67 @@ QList<QString> QAVPlayer::filters() const
     return d->filterDescs;
 }
 
+void QAVPlayer::setFilterCacheSize(int count)
+{
+    Q_D(QAVPlayer);
+    d->filters.setCacheSize(count);
+}
+
+bool QAVPlayer::refilter()
+{
+    Q_D(QAVPlayer);
+    {
+        // The video thread waits, so the filters get only this frame
+        QMutexLocker locker(&d->stateMutex);
+        if (d->state != QAVPlayer::PausedState || !d->pendingMediaStatuses.isEmpty() || d->mediaStatus == QAVPlayer::NoMedia)
+            return false;
+    }
+    {
+        QMutexLocker locker(&d->waitMutex);
+        if (!d->isWaiting)
+            return false;
+    }
+    if (d->isSeeking())
+        return false;
+
+    QAVFrame decodedFrame;
+    {
+        QMutexLocker locker(&d->lastVideoFrameMutex);
+        decodedFrame = d->lastVideoFrame;
+    }
+    if (!decodedFrame)
+        return false;
+
+    // Unchanged graphs already sent their frame
+    d->applyFilters();
+    bool refilterable = false;
+    int fresh = d->filters.freshGraphs(&refilterable);
+    if (!refilterable)
+        return false;
+
+    QList<QAVFrame> filteredFrames;
+    int ret = d->filters.write(AVMEDIA_TYPE_VIDEO, decodedFrame, true);
+    if (ret == AVERROR(ENOTSUP)) {
+        // Created for the parameters of the frame
+        d->applyFilters(true, decodedFrame);
+        fresh = d->filters.freshGraphs();
+        ret = d->filters.write(AVMEDIA_TYPE_VIDEO, decodedFrame);
+    }
+    if (ret >= 0 || ret == AVERROR(EAGAIN))
+        ret = d->filters.read(AVMEDIA_TYPE_VIDEO, decodedFrame, filteredFrames);
+    if (ret < 0 && ret != AVERROR(EAGAIN)) {
+        qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << err_str(ret);
+        return false;
+    }
+    if (filteredFrames.size() < fresh)
+        return false;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << filteredFrames.size() << "frames at pos" << decodedFrame.pts();
+    for (const auto &frame : filteredFrames)
+        Q_EMIT videoFrame(frame);
+    return true;
+}
+
 void QAVPlayer::setBitstreamFilter(const QString &desc)
 {
     Q_D(QAVPlayer);
@@ -1251,6 +1857,7 @@ void QAVPlayer::setSynced(bool sync)
         return;
 
     d->synced = sync;
+    d->updateVideoDiscard();
     Q_EMIT syncedChanged(sync);
 }
 
@@ -1313,6 +1920,375 @@ void QAVPlayer::setInputOptions(const QMap<QString, QString>  &opts)
     Q_EMIT inputOptionsChanged(opts);
 }
 
+void QAVPlayer::setFileReader(const std::function<bool(const QString &url, QByteArray &data)> &reader)
+{
+    Q_D(QAVPlayer);
+    d->demuxer.setFileReader(reader);
+}
+
+QMap<QString, QString> QAVPlayer::decoderOptions() const
+{
+    Q_D(const QAVPlayer);
+    return d->demuxer.decoderOptions();
+}
+
+void QAVPlayer::setDecoderOptions(const QMap<QString, QString> &opts)
+{
+    Q_D(QAVPlayer);
+    auto current = decoderOptions();
+    if (opts == current)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << current << "->" << opts;
+    d->demuxer.setDecoderOptions(opts);
+    Q_EMIT decoderOptionsChanged(opts);
+}
+
+bool QAVPlayer::hardwareFrames() const
+{
+    Q_D(const QAVPlayer);
+    return d->demuxer.hardwareFrames();
+}
+
+void QAVPlayer::setHardwareFrames(bool keep)
+{
+    Q_D(QAVPlayer);
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << keep;
+    d->demuxer.setHardwareFrames(keep);
+}
+
+QString QAVPlayer::hardwareDevice() const
+{
+    Q_D(const QAVPlayer);
+    return d->demuxer.hardwareDevice();
+}
+
+void QAVPlayer::setHardwareDevice(const QString &device)
+{
+    Q_D(QAVPlayer);
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << device;
+    d->demuxer.setHardwareDevice(device);
+}
+
+QString QAVPlayer::frameHash() const
+{
+    Q_D(const QAVPlayer);
+    return d->demuxer.frameHash();
+}
+
+bool QAVPlayer::setFrameHash(const QString &algorithm)
+{
+    Q_D(QAVPlayer);
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << algorithm;
+    return d->demuxer.setFrameHash(algorithm);
+}
+
+bool QAVPlayer::fastProbe() const
+{
+    Q_D(const QAVPlayer);
+    return d->demuxer.fastProbe();
+}
+
+void QAVPlayer::setFastProbe(bool fast)
+{
+    Q_D(QAVPlayer);
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << fast;
+    d->demuxer.setFastProbe(fast);
+}
+
+qint64 QAVPlayer::maxQueueBytes() const
+{
+    Q_D(const QAVPlayer);
+    return d->maxQueueBytes;
+}
+
+void QAVPlayer::setMaxQueueBytes(qint64 bytes)
+{
+    Q_D(QAVPlayer);
+    if (bytes == d->maxQueueBytes)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->maxQueueBytes << "->" << bytes;
+    d->maxQueueBytes = bytes;
+    d->wakeDemuxer();
+    Q_EMIT maxQueueBytesChanged(bytes);
+}
+
+int QAVPlayer::maxQueueFrames() const
+{
+    Q_D(const QAVPlayer);
+    return d->maxQueueFrames;
+}
+
+void QAVPlayer::setMaxQueueFrames(int frames)
+{
+    Q_D(QAVPlayer);
+    if (frames == d->maxQueueFrames)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->maxQueueFrames << "->" << frames;
+    d->maxQueueFrames = frames;
+    d->wakeDemuxer();
+    Q_EMIT maxQueueFramesChanged(frames);
+}
+
+void QAVPlayer::setKeyFrames(const QVector<QPair<double, qint64>> &keyFrames)
+{
+    Q_D(QAVPlayer);
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << keyFrames.size();
+    d->demuxer.setKeyFrames(keyFrames);
+}
+
+qint64 QAVPlayer::demuxerStallTime() const
+{
+    Q_D(const QAVPlayer);
+    return d->demuxerStallTime / 1000;
+}
+
+qint64 QAVPlayer::decoderStallTime() const
+{
+    Q_D(const QAVPlayer);
+    // Subtitles are sparse, their decoder waiting is not a stall
+    double stallTime = d->videoQueue.stallTime() + d->audioQueue.stallTime();
+    d->forTracks([&](QAVStreamTrack &track) { stallTime += track.queue.stallTime(); });
+    return qint64(stallTime * 1000);
+}
+
+QMap<QString, qint64> QAVPlayer::filterTimes() const
+{
+    Q_D(const QAVPlayer);
+    auto result = d->filters.elapsed();
+    d->forTracks([&](QAVStreamTrack &track) {
+        const auto elapsed = track.filters.elapsed();
+        for (auto it = elapsed.begin(); it != elapsed.end(); ++it)
+            result[it.key()] += it.value();
+    });
+    for (auto &time : result)
+        time /= 1000;
+    return result;
+}
+
+QAVPlayer::Counters QAVPlayer::counters() const
+{
+    Q_D(const QAVPlayer);
+    Counters result;
+    result.demuxedBytes = d->demuxedBytes;
+    result.demuxedPackets = d->demuxedPackets;
+    result.videoFrames = d->videoQueue.decodedFrames();
+    result.videoDecodeTime = qint64(d->videoQueue.decodeTime() * 1000);
+    result.audioFrames = d->audioQueue.decodedFrames();
+    result.audioDecodeTime = qint64(d->audioQueue.decodeTime() * 1000);
+    result.videoQueuePackets = d->videoQueue.count();
+    result.videoQueueBytes = d->videoQueue.bytes();
+    result.audioQueuePackets = d->audioQueue.count();
+    result.audioQueueBytes = d->audioQueue.bytes();
+    result.videoFramesBytes = d->videoQueue.framesBytes();
+    result.audioFramesBytes = d->audioQueue.framesBytes();
+    result.filterWaits = d->filters.waits();
+    result.probeTime = d->demuxer.probeTime();
+    d->forTracks([&](QAVStreamTrack &track) {
+        auto &queue = track.queue;
+        if (queue.mediaType() == AVMEDIA_TYPE_VIDEO) {
+            result.videoFrames += queue.decodedFrames();
+            result.videoDecodeTime += qint64(queue.decodeTime() * 1000);
+            result.videoQueuePackets += queue.count();
+            result.videoQueueBytes += queue.bytes();
+            result.videoFramesBytes += queue.framesBytes();
+        } else {
+            result.audioFrames += queue.decodedFrames();
+            result.audioDecodeTime += qint64(queue.decodeTime() * 1000);
+            result.audioQueuePackets += queue.count();
+            result.audioQueueBytes += queue.bytes();
+            result.audioFramesBytes += queue.framesBytes();
+        }
+        result.filterWaits += track.filters.waits();
+    });
+    return result;
+}
+
+QAVPlayer::Allocations QAVPlayer::allocations()
+{
+    const auto counters = QAVPool::counters();
+    Allocations result;
+    result.frames = counters.frames;
+    result.framesReused = counters.framesReused;
+    result.packets = counters.packets;
+    result.packetsReused = counters.packetsReused;
+    const auto codecCounters = QAVDemuxer::codecCounters();
+    result.decoders = codecCounters.codecs;
+    result.decodersReused = codecCounters.codecsReused;
+    const auto bufferCounters = QAVBufferPool::counters();
+    result.frameBuffers = bufferCounters.buffers;
+    result.frameBuffersReused = bufferCounters.buffersReused;
+    result.frameBuffersBytes = bufferCounters.bytes;
+    result.frameBuffersHugePagesBytes = bufferCounters.hugePagesBytes;
+    return result;
+}
+
+void QAVPlayer::setDecoderPoolSize(int count)
+{
+    QAVDemuxer::setCodecPoolSize(count);
+}
+
+void QAVPlayer::setTraceFunction(TraceFunction function)
+{
+    QAVTrace::function() = function;
+}
+
+int QAVPlayer::filterThreads() const
+{
+    Q_D(const QAVPlayer);
+    return d->filterThreads;
+}
+
+void QAVPlayer::setFilterThreads(int threads)
+{
+    Q_D(QAVPlayer);
+    if (threads == d->filterThreads)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->filterThreads << "->" << threads;
+    d->filterThreads = threads;
+    Q_EMIT filterThreadsChanged(threads);
+}
+
+bool QAVPlayer::parallelFilters() const
+{
+    Q_D(const QAVPlayer);
+    return d->parallelFilters;
+}
+
+void QAVPlayer::setParallelFilters(bool parallel)
+{
+    Q_D(QAVPlayer);
+    if (parallel == d->parallelFilters)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->parallelFilters << "->" << parallel;
+    d->parallelFilters = parallel;
+    Q_EMIT parallelFiltersChanged(parallel);
+}
+
+int QAVPlayer::decodeAhead() const
+{
+    Q_D(const QAVPlayer);
+    return d->decodeAhead;
+}
+
+void QAVPlayer::setDecodeAhead(int frames)
+{
+    Q_D(QAVPlayer);
+    if (frames == d->decodeAhead)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->decodeAhead << "->" << frames;
+    d->decodeAhead = frames;
+    Q_EMIT decodeAheadChanged(frames);
+}
+
+QThread::Priority QAVPlayer::threadPriority() const
+{
+    Q_D(const QAVPlayer);
+    QMutexLocker locker(&d->workerThreadsMutex);
+    return d->threadPriority;
+}
+
+void QAVPlayer::setThreadPriority(QThread::Priority priority)
+{
+    Q_D(QAVPlayer);
+    {
+        QMutexLocker locker(&d->workerThreadsMutex);
+        if (priority == d->threadPriority)
+            return;
+
+        qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->threadPriority << "->" << priority;
+        d->threadPriority = priority;
+        for (auto thread : d->workerThreads)
+            thread->setPriority(priority == QThread::InheritPriority ? QThread::NormalPriority : priority);
+    }
+    Q_EMIT threadPriorityChanged(priority);
+}
+
+void QAVPlayer::setThreadInit(const std::function<void()> &init)
+{
+    Q_D(QAVPlayer);
+    QMutexLocker locker(&d->workerThreadsMutex);
+    d->threadInit = init;
+}
+
+bool QAVPlayer::streamThreads() const
+{
+    Q_D(const QAVPlayer);
+    return d->streamThreads;
+}
+
+void QAVPlayer::setStreamThreads(bool enabled)
+{
+    Q_D(QAVPlayer);
+    if (enabled == d->streamThreads)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->streamThreads << "->" << enabled;
+    d->streamThreads = enabled;
+    Q_EMIT streamThreadsChanged(enabled);
+}
+
+int QAVPlayer::videoSampling() const
+{
+    Q_D(const QAVPlayer);
+    return d->videoSampling;
+}
+
+void QAVPlayer::setVideoSampling(int every)
+{
+    Q_D(QAVPlayer);
+    if (every == d->videoSampling)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->videoSampling << "->" << every;
+    d->videoSampling = every;
+    Q_EMIT videoSamplingChanged(every);
+}
+
+bool QAVPlayer::scrub() const
+{
+    Q_D(const QAVPlayer);
+    return d->scrub;
+}
+
+void QAVPlayer::setScrub(bool enabled)
+{
+    Q_D(QAVPlayer);
+    if (enabled == d->scrub)
+        return;
+
+    qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->scrub << "->" << enabled;
+    d->scrub = enabled;
+    d->updateVideoDiscard();
+    Q_EMIT scrubChanged(enabled);
+}
+
+QList<bool> QAVPlayer::skipDuplicateFrames() const
+{
+    Q_D(const QAVPlayer);
+    QMutexLocker locker(&d->duplicatesMutex);
+    return d->skipDuplicateFrames;
+}
+
+void QAVPlayer::setSkipDuplicateFrames(const QList<bool> &graphs)
+{
+    Q_D(QAVPlayer);
+    {
+        QMutexLocker locker(&d->duplicatesMutex);
+        if (graphs == d->skipDuplicateFrames)
+            return;
+
+        qCDebug(lcAVPlayer) << __FUNCTION__ << ":" << d->skipDuplicateFrames << "->" << graphs;
+        d->skipDuplicateFrames = graphs;
+    }
+    Q_EMIT skipDuplicateFramesChanged(graphs);
+}
+
 QAVStream::Progress QAVPlayer::progress(const QAVStream &s) const
 {
     return d_func()->demuxer.progress(s);
@@ -14,6 +14,10 @@
 #include <QtAVPlayer/qavstream.h>
 #include <QtAVPlayer/qtavplayerglobal.h>
 #include <QString>
+#include <QThread>
+#include <QPair>
+#include <QVector>
+#include <functional>
 #include <memory>
 
 QT_BEGIN_NAMESPACE
@@ -79,9 +83,24 @@ public:
     double videoFrameRate() const;
 
     void setFilter(const QString &desc);
+    // Cacheable: the graph keeps no state between frames (no temporal filter), so once replaced
+    // it may be kept and reused when it is set again, see setFilterCacheSize()
+    void setFilter(const QString &desc, bool cacheable);
+    // Graphs fed with the same decoded frames, as for views of the same media: the graphs of unchanged
+    // descriptions go on when others are changed, cacheable is by graph (none if empty)
     void setFilters(const QList<QString> &filters);
+    void setFilters(const QList<QString> &filters, const QList<bool> &cacheable);
     QList<QString> filters() const;
 
+    // Cacheable filter graphs kept once replaced, 0 by default
+    void setFilterCacheSize(int count);
+
+    // Paused: filters the last shown video frame again with the graphs changed since it was shown and
+    // sends the result with videoFrame(), instead of decoding it again after a seek; false if there is
+    // no such frame, a changed graph is not cacheable, has audio inputs or needs more frames, or the
+    // player is not idle and paused
+    bool refilter();
+
     void setBitstreamFilter(const QString &desc);
     QString bitstreamFilter() const;
 
@@ -100,12 +119,178 @@ public:
     QMap<QString, QString> inputOptions() const;
     void setInputOptions(const QMap<QString, QString> &opts);
 
+    // Reads the whole file of an url opened by the format (e.g. the images of an image2 sequence), returns false
+    // if FFmpeg reads it; called from the demuxer threads, applied when the source is set
+    void setFileReader(const std::function<bool(const QString &url, QByteArray &data)> &reader);
+
+    // Options of the decoders (e.g. threads, thread_type), applied when the source is loaded
+    QMap<QString, QString> decoderOptions() const;
+    void setDecoderOptions(const QMap<QString, QString> &opts);
+
+    // Frames decoded on a device not used for rendering (QT_AVPLAYER_HWDECODE) are kept on the device instead of
+    // downloaded, for filters working on hardware frames (e.g. scale_vaapi then hwdownload); applied to the source
+    // loaded if no frame was decoded yet and to the next ones
+    bool hardwareFrames() const;
+    void setHardwareFrames(bool keep);
+
+    // Device on which the frames are decoded without rendering (QT_AVPLAYER_HWDECODE), as av_hwdevice_ctx_create()
+    // takes it (e.g. /dev/dri/renderD129 for vaapi, 1 for cuda), empty (default) for the default one of the type,
+    // "none" for software decoding, e.g. when the devices are saturated; applied when the source is loaded
+    QString hardwareDevice() const;
+    void setHardwareDevice(const QString &device);
+
+    // Decoded video and audio frames get the hash of their data in their metadata, with the key "framehash.<algorithm>"
+    // (lower case), e.g. for the fixity of the frames without decoding them again: the data is the one the framehash
+    // muxer hashes for the raw codec of the format of the frame (framemd5 of rawvideo), hashed by the thread decoding
+    // the frame (see setDecodeAhead()) and kept by the filters in their frames; the algorithm is one of av_hash (MD5,
+    // murmur3, CRC32, SHA256...), empty (default) for none; false if it is not known; hardware frames are not hashed
+    QString frameHash() const;
+    bool setFrameHash(const QString &algorithm);
+
+    // Parameters of the streams from the headers when the container has all of them (MXF, MOV...), else from
+    // packets read in a capped size and duration, fully probed only if parameters are still missing; applied when
+    // the source is set, if the input options have no probesize or analyzeduration
+    bool fastProbe() const;
+    void setFastProbe(bool fast);
+
+    // Threads of the filter graphs, 0 for one per core
+    int filterThreads() const;
+    void setFilterThreads(int threads);
+
+    // Filter graphs of the same frame written and drained by the thread pool, each graph still gets the frames in
+    // order and its filtered frames are in the order of the graphs
+    bool parallelFilters() const;
+    void setParallelFilters(bool parallel);
+
+    // Each current video and audio stream after the first ones has its own queue, decoder thread and filter graphs
+    // (the graphs with inputs of its type only), created for its first packet, instead of sharing the ones of the
+    // first stream; its frames are not synced with the first streams; the demuxer waits while all the queues have
+    // enough packets or they are over the budget of maxQueueBytes(), the end of the media waits for all of them;
+    // counters() sums the streams of each type; taken into account for the packets read afterwards
+    bool streamThreads() const;
+    void setStreamThreads(bool enabled);
+
+    // Video and audio frames decoded ahead of the filters by a decoder thread of each stream, so a packet is decoded
+    // while the frames before are filtered; 0 (default) decodes in the thread of the filters; for the sources set
+    // afterwards (and the tracks created afterwards, see setStreamThreads())
+    int decodeAhead() const;
+    void setDecodeAhead(int frames);
+
+    // Priority of the demuxer, decoder and filter threads of the player while they run, changed at once for the
+    // running ones (e.g. the source the user looks at before the ones parsed in the background); InheritPriority
+    // (default) keeps the priority of the pool; applied where the system supports thread priorities
+    QThread::Priority threadPriority() const;
+    void setThreadPriority(QThread::Priority priority);
+
+    // Called by each thread of the player when it starts a loop (loader, demuxer, decoders, filters), before the
+    // decoders and the filter graphs it creates start their own threads (e.g. to bind them to some cores);
+    // applied to the loops started afterwards
+    void setThreadInit(const std::function<void()> &init);
+
+    // Video frames sent to the filters, for a quick look at long sources: 0 or 1 all of them, N > 1 one frame of N
+    // and -1 the key frames only; the packets of the other frames are not decoded if they can be (key frames only,
+    // codecs with intra frames only), else the frames are dropped after decoding; audio is not changed
+    int videoSampling() const;
+    void setVideoSampling(int every);
+
+    // Scrubbing when the speed is above 1 and frames are synced, e.g. to seek by fast playback: the video decoders
+    // skip the non-reference frames from speed 2 and all but the key frames from speed 8, and the decoded frames
+    // due less than a frame duration (of the source) after the last one shown, or too late, are dropped before the
+    // filters; false (default) sends all the frames to the filters at any speed
+    bool scrub() const;
+    void setScrub(bool enabled);
+
+    // Video frames with the same pixels as the last frame of their stream written to the filters (software frames,
+    // hashed) are not written to the graphs skipped, by graph as setFilters(): these graphs send nothing for them,
+    // the decoded frame is sent instead with videoFrame() and the filter name "duplicate", e.g. to reuse the results
+    // of graphs without temporal filters; empty (default) skips none, applied to the next frames
+    QList<bool> skipDuplicateFrames() const;
+    void setSkipDuplicateFrames(const QList<bool> &graphs);
+
+    // Bytes of packets read ahead by the demuxer for video and audio, 0 is adaptive:
+    // at least 15 MiB, and enough for 16 packets or half a second of what the decoders consume
+    qint64 maxQueueBytes() const;
+    void setMaxQueueBytes(qint64 bytes);
+
+    // Packets read ahead for each stream type, 0 means no limit other than the bytes
+    int maxQueueFrames() const;
+    void setMaxQueueFrames(int frames);
+
+    // Key frames of the video (seconds, byte offset of their packet or -1) by increasing time, e.g. from a previous
+    // analysis of the source: seeks and steps backward start from the key frame before the position; kept until changed
+    void setKeyFrames(const QVector<QPair<double, qint64>> &keyFrames);
+
+    // Milliseconds the demuxer waited for room in full queues, and the video and audio decoders waited for packets
+    qint64 demuxerStallTime() const;
+    qint64 decoderStallTime() const;
+
+    // Milliseconds spent in each filter graph of filters(), by description, since the source was set
+    QMap<QString, qint64> filterTimes() const;
+
+    // Packets read by the demuxer, frames returned by the video and audio decoders and the milliseconds spent
+    // decoding them since the source was set, and packets waiting in the queues now; filterWaits counts the writes
+    // to and reads from the filters which waited for another thread (the other media type of the same graph, or
+    // filters being replaced); probeTime is the milliseconds spent finding the parameters of the streams;
+    // FramesBytes are the buffers of the frames decoded and not filtered yet
+    struct Counters
+    {
+        qint64 demuxedBytes = 0;
+        quint64 demuxedPackets = 0;
+        quint64 videoFrames = 0;
+        qint64 videoDecodeTime = 0;
+        quint64 audioFrames = 0;
+        qint64 audioDecodeTime = 0;
+        int videoQueuePackets = 0;
+        qint64 videoQueueBytes = 0;
+        int audioQueuePackets = 0;
+        qint64 audioQueueBytes = 0;
+        qint64 videoFramesBytes = 0;
+        qint64 audioFramesBytes = 0;
+        quint64 filterWaits = 0;
+        qint64 probeTime = 0;
+    };
+    Counters counters() const;
+
+    // AVFrame and AVPacket allocations of all players, and reuses of released ones
+    // Allocations stop growing once the analysis loop is running
+    // Decoders opened by all players, and reuses of the ones of the pool (see setDecoderPoolSize())
+    // Planes of the frames of the software video decoders allocated, taken from their pools instead, and the bytes
+    // allocated now (also the free planes of the pools) of which the ones on huge pages (Linux)
+    struct Allocations
+    {
+        quint64 frames = 0;
+        quint64 framesReused = 0;
+        quint64 packets = 0;
+        quint64 packetsReused = 0;
+        quint64 decoders = 0;
+        quint64 decodersReused = 0;
+        quint64 frameBuffers = 0;
+        quint64 frameBuffersReused = 0;
+        qint64 frameBuffersBytes = 0;
+        qint64 frameBuffersHugePagesBytes = 0;
+    };
+    static Allocations allocations();
+
+    // Audio and video decoders of the sources unloaded by all players kept flushed (0 by default), the last one
+    // released first, for the sources loaded afterwards with streams of the same parameters, extradata and decoder
+    // options instead of opening new ones, e.g. a series of short clips of the same format; not the hardware decoders
+    static void setDecoderPoolSize(int count);
+
+    // Called by all players with each step of the pipeline once done ("demux read", "decode", "filter write",
+    // "filter read" and the waits of the queues), its begin and end in nanoseconds of std::chrono::steady_clock
+    // and its stream or filter graph index (-1 if none), from the thread running it; nullptr (default) for none
+    using TraceFunction = void (*)(const char *name, qint64 begin, qint64 end, qint64 arg);
+    static void setTraceFunction(TraceFunction function);
+
     QAVStream::Progress progress(const QAVStream &stream) const;
 
 public Q_SLOTS:
     void play();
     void pause();
     void stop();
+    // Seeks in a row are coalesced, the last position wins: the packets queued for a previous position are
+    // dropped without being decoded, and a later position in the same group of pictures (see setKeyFrames())
+    // is reached by decoding on from the previous one
     void seek(qint64 position);
     void setSpeed(qreal rate);
     void stepForward();
@@ -134,6 +319,17 @@ Q_SIGNALS:
     void inputFormatChanged(const QString &format);
     void inputVideoCodecChanged(const QString &codec);
     void inputOptionsChanged(const QMap<QString, QString> &opts);
+    void decoderOptionsChanged(const QMap<QString, QString> &opts);
+    void filterThreadsChanged(int threads);
+    void parallelFiltersChanged(bool parallel);
+    void streamThreadsChanged(bool enabled);
+    void decodeAheadChanged(int frames);
+    void threadPriorityChanged(QThread::Priority priority);
+    void videoSamplingChanged(int every);
+    void scrubChanged(bool enabled);
+    void skipDuplicateFramesChanged(const QList<bool> &graphs);
+    void maxQueueBytesChanged(qint64 bytes);
+    void maxQueueFramesChanged(int frames);
 
     void videoFrame(const QAVVideoFrame &frame);
     void audioFrame(const QAVAudioFrame &frame);
@@ -0,0 +1,123 @@
+/*********************************************************
+ * Copyright (C) 2020, Val Doroshchuk <valbok@gmail.com> *
+ *                                                       *
+ * This file is part of QtAVPlayer.                      *
+ * Free Qt Media Player based on FFmpeg.                 *
+ *********************************************************/
+
+#include "qavpool_p.h"
+#include <QMutex>
+#include <atomic>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+QT_BEGIN_NAMESPACE
+
+// Enough for the queues, the filters and the frames waiting in the event loops of several players
+static const size_t maxPooled = 512;
+
+struct QAVPoolData
+{
+    QMutex mutex;
+    std::vector<AVFrame *> frames;
+    std::vector<AVPacket *> packets;
+};
+
+// Never destroyed, frames and packets of static objects may be released after the end of main()
+static QAVPoolData &pool()
+{
+    static QAVPoolData *data = new QAVPoolData;
+    return *data;
+}
+
+static std::atomic<quint64> framesCount {0};
+static std::atomic<quint64> framesReusedCount {0};
+static std::atomic<quint64> packetsCount {0};
+static std::atomic<quint64> packetsReusedCount {0};
+
+AVFrame *QAVPool::frame()
+{
+    {
+        auto &d = pool();
+        QMutexLocker locker(&d.mutex);
+        if (!d.frames.empty()) {
+            AVFrame *frame = d.frames.back();
+            d.frames.pop_back();
+            ++framesReusedCount;
+            return frame;
+        }
+    }
+
+    ++framesCount;
+    return av_frame_alloc();
+}
+
+void QAVPool::release(AVFrame *&frame)
+{
+    if (!frame)
+        return;
+
+    // Same state as a new frame, buffers are released now
+    av_frame_unref(frame);
+    {
+        auto &d = pool();
+        QMutexLocker locker(&d.mutex);
+        if (d.frames.size() < maxPooled) {
+            d.frames.push_back(frame);
+            frame = nullptr;
+            return;
+        }
+    }
+    av_frame_free(&frame);
+}
+
+AVPacket *QAVPool::packet()
+{
+    {
+        auto &d = pool();
+        QMutexLocker locker(&d.mutex);
+        if (!d.packets.empty()) {
+            AVPacket *packet = d.packets.back();
+            d.packets.pop_back();
+            ++packetsReusedCount;
+            return packet;
+        }
+    }
+
+    ++packetsCount;
+    return av_packet_alloc();
+}
+
+void QAVPool::release(AVPacket *&packet)
+{
+    if (!packet)
+        return;
+
+    av_packet_unref(packet);
+    {
+        auto &d = pool();
+        QMutexLocker locker(&d.mutex);
+        if (d.packets.size() < maxPooled) {
+            d.packets.push_back(packet);
+            packet = nullptr;
+            return;
+        }
+    }
+    av_packet_free(&packet);
+}
+
+QAVPool::Counters QAVPool::counters()
+{
+    Counters result;
+    result.frames = framesCount;
+    result.framesReused = framesReusedCount;
+    result.packets = packetsCount;
+    result.packetsReused = packetsReusedCount;
+    return result;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,54 @@
+/*********************************************************
+ * Copyright (C) 2020, Val Doroshchuk <valbok@gmail.com> *
+ *                                                       *
+ * This file is part of QtAVPlayer.                      *
+ * Free Qt Media Player based on FFmpeg.                 *
+ *********************************************************/
+
+#ifndef QAVPOOL_P_H
+#define QAVPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtAVPlayer/qtavplayerglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+struct AVFrame;
+struct AVPacket;
+
+// Recycles the AVFrame and AVPacket shells of QAVFrame and QAVPacket.
+// Data buffers are already recycled by the buffer pools of the decoders and of the filters,
+// a shell is unreferenced when released so its buffers go back to their pool.
+// Shared by all players: frames are sent to other threads and may outlive their player.
+class QAVPool
+{
+public:
+    static AVFrame *frame();
+    static void release(AVFrame *&frame);
+
+    static AVPacket *packet();
+    static void release(AVPacket *&packet);
+
+    struct Counters
+    {
+        quint64 frames = 0;
+        quint64 framesReused = 0;
+        quint64 packets = 0;
+        quint64 packetsReused = 0;
+    };
+    static Counters counters();
+};
+
+QT_END_NAMESPACE
+
+#endif
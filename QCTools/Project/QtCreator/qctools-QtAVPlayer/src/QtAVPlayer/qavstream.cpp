@@ -80,6 +80,11 @@ int QAVStream::index() const
     return d_func()->index;
 }
 
+AVFormatContext *QAVStream::formatContext() const
+{
+    return d_func()->ctx;
+}
+
 static int streamRotation(const AVStream *stream)
 {
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(60, 29, 100)
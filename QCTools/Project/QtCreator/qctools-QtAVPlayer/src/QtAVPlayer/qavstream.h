@@ -31,6 +31,8 @@ public:
 
     int index() const;
     AVStream *stream() const;
+    // Context of the demuxer which owns the stream, valid while the demuxer is loaded
+    AVFormatContext *formatContext() const;
     double duration() const;
     int64_t framesCount() const;
     double frameRate() const;
@@ -0,0 +1,75 @@
+/*********************************************************
+ * Copyright (C) 2020, Val Doroshchuk <valbok@gmail.com> *
+ *                                                       *
+ * This file is part of QtAVPlayer.                      *
+ * Free Qt Media Player based on FFmpeg.                 *
+ *********************************************************/
+
+#ifndef QAVTRACE_P_H
+#define QAVTRACE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtAVPlayer/qtavplayerglobal.h>
+#include <atomic>
+#include <chrono>
+
+QT_BEGIN_NAMESPACE
+
+// Same as QAVPlayer::TraceFunction
+using QAVTraceFunction = void (*)(const char *name, qint64 begin, qint64 end, qint64 arg);
+
+// Step of the pipeline sent to the function of QAVPlayer::setTraceFunction() once done, by the thread
+// running it; the function is read once when the step starts, nothing else is done if none
+class QAVTrace
+{
+public:
+    explicit QAVTrace(const char *name, qint64 arg = -1)
+        : m_function(function().load(std::memory_order_relaxed))
+        , m_name(name)
+        , m_arg(arg)
+    {
+        if (m_function)
+            m_begin = now();
+    }
+
+    ~QAVTrace()
+    {
+        if (m_function)
+            m_function(m_name, m_begin, now(), m_arg);
+    }
+
+    void setArg(qint64 arg) { m_arg = arg; }
+
+    // Nanoseconds of std::chrono::steady_clock
+    static qint64 now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static std::atomic<QAVTraceFunction> &function()
+    {
+        static std::atomic<QAVTraceFunction> current(nullptr);
+        return current;
+    }
+
+private:
+    Q_DISABLE_COPY(QAVTrace)
+    const QAVTraceFunction m_function;
+    const char *const m_name;
+    qint64 m_arg;
+    qint64 m_begin = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
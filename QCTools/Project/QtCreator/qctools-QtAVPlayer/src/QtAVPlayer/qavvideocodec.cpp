@@ -7,6 +7,8 @@
 
 #include "qavvideocodec_p.h"
 #include "qavhwdevice_p.h"
+#include "qavpool_p.h"
+#include "qavbufferpool_p.h"
 #include "qavcodec_p_p.h"
 #include "qavpacket_p.h"
 #include "qavframe.h"
@@ -16,6 +18,7 @@
 extern "C" {
 #include <libavutil/pixdesc.h>
 #include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
 }
 
 QT_BEGIN_NAMESPACE
@@ -24,6 +27,10 @@ class QAVVideoCodecPrivate : public QAVCodecPrivate
 {
 public:
     QSharedPointer<QAVHWDevice> hw_device;
+    AVHWDeviceType download_type = AV_HWDEVICE_TYPE_NONE;
+    AVPixelFormat download_format = AV_PIX_FMT_NONE;
+    bool keep_frames = false;
+    QAVBufferPool buffers;
 };
 
 static bool isSoftwarePixelFormat(AVPixelFormat from)
@@ -112,6 +119,23 @@ static AVPixelFormat negotiate_pixel_format(AVCodecContext *c, const AVPixelForm
             }
         }
     }
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 0, 0)
+    else if (d->download_type != AV_HWDEVICE_TYPE_NONE) {
+        // Frames are downloaded after decoding, software format if the codec is not supported
+        for (int i = 0;; ++i) {
+            const AVCodecHWConfig *config = avcodec_get_hw_config(c->codec, i);
+            if (!config)
+                break;
+            if (config->device_type == d->download_type
+                && (config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)
+                && hardwareFormats.contains(config->pix_fmt)) {
+                pf = config->pix_fmt;
+                decStr = "hardware (downloaded)";
+                break;
+            }
+        }
+    }
+#endif
 
     auto dsc = av_pix_fmt_desc_get(pf);
     if (dsc)
@@ -122,11 +146,19 @@ static AVPixelFormat negotiate_pixel_format(AVCodecContext *c, const AVPixelForm
     return pf;
 }
 
+static int get_buffer(AVCodecContext *c, AVFrame *frame, int flags)
+{
+    return reinterpret_cast<QAVVideoCodecPrivate *>(c->opaque)->buffers.get(c, frame, flags);
+}
+
 QAVVideoCodec::QAVVideoCodec()
     : QAVFrameCodec(*new QAVVideoCodecPrivate)
 {
     d_ptr->avctx->opaque = d_ptr.get();
     d_ptr->avctx->get_format = negotiate_pixel_format;
+    // Planes from the pools of the stream, e.g. QT_AVPLAYER_NO_BUFFER_POOL=1 for the allocator of FFmpeg
+    if (!qEnvironmentVariableIsSet("QT_AVPLAYER_NO_BUFFER_POOL"))
+        d_ptr->avctx->get_buffer2 = get_buffer;
 }
 
 QAVVideoCodec::~QAVVideoCodec()
@@ -144,4 +176,73 @@ QAVHWDevice *QAVVideoCodec::device() const
     return d_func()->hw_device.data();
 }
 
+void QAVVideoCodec::setDownloadDevice(AVHWDeviceType type)
+{
+    Q_D(QAVVideoCodec);
+    d->download_type = type;
+    d->download_format = AV_PIX_FMT_NONE;
+}
+
+AVHWDeviceType QAVVideoCodec::downloadDevice() const
+{
+    return d_func()->download_type;
+}
+
+void QAVVideoCodec::setHardwareFrames(bool keep)
+{
+    d_func()->keep_frames = keep;
+}
+
+bool QAVVideoCodec::hardwareFrames() const
+{
+    return d_func()->keep_frames;
+}
+
+int QAVVideoCodec::read(QAVStreamFrame &frame)
+{
+    Q_D(QAVVideoCodec);
+    int ret = QAVFrameCodec::read(frame);
+    if (ret < 0 || d->download_type == AV_HWDEVICE_TYPE_NONE || d->keep_frames)
+        return ret;
+
+    AVFrame *hw = static_cast<QAVFrame *>(&frame)->frame();
+    if (!hw->hw_frames_ctx)
+        return ret; // Software fallback
+
+    // Once per stream: the software format of the decoder if the device can provide it, so the filters do not convert
+    if (d->download_format == AV_PIX_FMT_NONE) {
+        AVPixelFormat *formats = nullptr;
+        if (av_hwframe_transfer_get_formats(hw->hw_frames_ctx, AV_HWFRAME_TRANSFER_DIRECTION_FROM, &formats, 0) >= 0 && formats) {
+            d->download_format = formats[0];
+            for (int i = 0; formats[i] != AV_PIX_FMT_NONE; ++i) {
+                if (formats[i] == d->avctx->sw_pix_fmt) {
+                    d->download_format = formats[i];
+                    break;
+                }
+            }
+            av_freep(&formats);
+        }
+        if (d->download_format == AV_PIX_FMT_NONE)
+            d->download_format = d->avctx->sw_pix_fmt;
+    }
+
+    AVFrame *sw = QAVPool::frame();
+    if (!sw)
+        return AVERROR(ENOMEM);
+    sw->format = d->download_format;
+    ret = av_hwframe_transfer_data(sw, hw, 0);
+    if (ret >= 0)
+        ret = av_frame_copy_props(sw, hw);
+    if (ret < 0) {
+        qWarning() << "Could not download the frame from the hardware device:" << ret;
+        QAVPool::release(sw);
+        return ret;
+    }
+
+    av_frame_unref(hw);
+    av_frame_move_ref(hw, sw);
+    QAVPool::release(sw);
+    return 0;
+}
+
 QT_END_NAMESPACE
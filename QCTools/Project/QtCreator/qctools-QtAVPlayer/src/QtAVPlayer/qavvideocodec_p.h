@@ -21,6 +21,10 @@
 
 #include "qavframecodec_p.h"
 
+extern "C" {
+#include <libavutil/hwcontext.h>
+}
+
 QT_BEGIN_NAMESPACE
 
 class QAVVideoCodecPrivate;
@@ -34,6 +38,15 @@ public:
     void setDevice(const QSharedPointer<QAVHWDevice> &d);
     QAVHWDevice *device() const;
 
+    // Decoding on a device not used for rendering, frames are downloaded to memory after decoding
+    void setDownloadDevice(AVHWDeviceType type);
+    AVHWDeviceType downloadDevice() const;
+    // Frames of the download device kept on the device, for filters working on hardware frames
+    void setHardwareFrames(bool keep);
+    bool hardwareFrames() const;
+
+    int read(QAVStreamFrame &frame) override;
+
 private:
     Q_DISABLE_COPY(QAVVideoCodec)
     Q_DECLARE_PRIVATE(QAVVideoCodec)
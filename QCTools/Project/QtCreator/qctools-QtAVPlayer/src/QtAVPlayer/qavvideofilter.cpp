@@ -64,8 +64,9 @@ int QAVVideoFilter::write(const QAVFrame &frame)
             return AVERROR(ENOTSUP);
         }
         QAVFrame ref = d->sourceFrame;
-        QMutexLocker locker(&d->graphMutex);
+        d->lockGraph();
         int ret = av_buffersrc_add_frame_flags(filter.ctx(), ref.frame(), AV_BUFFERSRC_FLAG_PUSH);
+        d->graphMutex.unlock();
         if (ret < 0)
             return ret;
     }
@@ -96,10 +97,9 @@ int QAVVideoFilter::read(QAVFrame &frame)
                 QAVFrame out = d->sourceFrame;
                 // av_buffersink_get_frame_flags allocates frame's data
                 av_frame_unref(out.frame());
-                {
-                    QMutexLocker locker(&d->graphMutex);
-                    ret = av_buffersink_get_frame_flags(filter.ctx(), out.frame(), 0);
-                }
+                d->lockGraph();
+                ret = av_buffersink_get_frame_flags(filter.ctx(), out.frame(), 0);
+                d->graphMutex.unlock();
                 if (ret < 0)
                     break;
 
@@ -112,10 +112,7 @@ int QAVVideoFilter::read(QAVFrame &frame)
 #endif
                 out.setFrameRate(av_buffersink_get_frame_rate(filter.ctx()));
                 out.setTimeBase(av_buffersink_get_time_base(filter.ctx()));
-                out.setFilterName(
-                    !filter.name().isEmpty()
-                    ? filter.name()
-                    : QString(QLatin1String("%1:%2")).arg(d->name).arg(QString::number(i)));
+                d->setOutputName(out, i, filter.name());
                 if (!out.stream())
                     out.setStream(d->stream);
                 d->outputFrames.push_back(out);
@@ -140,6 +140,40 @@ QString QAVVideoFrame::formatName() const
     return QLatin1String(av_pix_fmt_desc_get(QAVVideoFrame::format())->name);
 }
 
+// Conversion context of the last conversion of the thread, reused while the size and the formats do not change
+class QAVVideoConvertContext
+{
+public:
+    ~QAVVideoConvertContext() { sws_freeContext(m_ctx); }
+
+    SwsContext *get(const QSize &size, AVPixelFormat src, AVPixelFormat dst)
+    {
+        if (m_ctx && size == m_size && src == m_src && dst == m_dst)
+            return m_ctx;
+
+        sws_freeContext(m_ctx);
+        m_ctx = sws_getContext(size.width(), size.height(), src,
+                               size.width(), size.height(), dst,
+                               SWS_BICUBIC, NULL, NULL, NULL);
+        if (m_ctx && sws_setColorspaceDetails(m_ctx, sws_getCoefficients(SWS_CS_ITU601),
+                                              0, sws_getCoefficients(SWS_CS_ITU709), 0, 0, 1 << 16, 1 << 16) == -1) {
+            qWarning() << "Colorspace not support";
+            sws_freeContext(m_ctx);
+            m_ctx = nullptr;
+        }
+        m_size = size;
+        m_src = src;
+        m_dst = dst;
+        return m_ctx;
+    }
+
+private:
+    SwsContext *m_ctx = nullptr;
+    QSize m_size;
+    AVPixelFormat m_src = AV_PIX_FMT_NONE;
+    AVPixelFormat m_dst = AV_PIX_FMT_NONE;
+};
+
 QAVVideoFrame QAVVideoFrame::convertTo(AVPixelFormat fmt) const
 {
     if (fmt == frame()->format)
@@ -150,25 +184,27 @@ QAVVideoFrame QAVVideoFrame::convertTo(AVPixelFormat fmt) const
         qWarning() << __FUNCTION__ << "Could not map:" << formatName();
         return QAVVideoFrame();
     }
-    auto ctx = sws_getContext(size().width(), size().height(), mapData.format,
-                              size().width(), size().height(), fmt,
-                              SWS_BICUBIC, NULL, NULL, NULL);
-    if (ctx == nullptr) {
-        qWarning() << __FUNCTION__ << ": Could not get sws context:" << formatName();
-        return QAVVideoFrame();
+
+    // Frames mapped from the GPU may already be in the format, the planes are copied only
+    if (mapData.format == fmt) {
+        QAVVideoFrame result(size(), fmt);
+        result.d_ptr->stream = d_ptr->stream;
+        av_image_copy(result.frame()->data, result.frame()->linesize, const_cast<const uint8_t **>(mapData.data), mapData.bytesPerLine,
+                      fmt, size().width(), size().height());
+        return result;
     }
 
-    int ret = sws_setColorspaceDetails(ctx, sws_getCoefficients(SWS_CS_ITU601),
-                                       0, sws_getCoefficients(SWS_CS_ITU709), 0, 0, 1 << 16, 1 << 16);
-    if (ret == -1) {
-        qWarning() << __FUNCTION__ << "Colorspace not support";
+    // Frames of a stream are converted by the same thread (decoder, player or thumbnails), one context per thread
+    static thread_local QAVVideoConvertContext convertContext;
+    auto ctx = convertContext.get(size(), mapData.format, fmt);
+    if (ctx == nullptr) {
+        qWarning() << __FUNCTION__ << ": Could not get sws context:" << formatName();
         return QAVVideoFrame();
     }
 
     QAVVideoFrame result(size(), fmt);
     result.d_ptr->stream = d_ptr->stream;
     sws_scale(ctx, mapData.data, mapData.bytesPerLine, 0, result.size().height(), result.frame()->data, result.frame()->linesize);
-    sws_freeContext(ctx);
 
     return result;
 }
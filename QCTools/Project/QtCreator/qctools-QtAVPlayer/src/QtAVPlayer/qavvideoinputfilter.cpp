@@ -25,6 +25,10 @@ public:
     QAVVideoInputFilterPrivate(QAVInOutFilter *q)
         : QAVInOutFilterPrivate(q)
     { }
+    ~QAVVideoInputFilterPrivate()
+    {
+        av_buffer_unref(&hw_frames_ctx);
+    }
 
     AVPixelFormat format = AV_PIX_FMT_NONE;
     int width = 0;
@@ -32,6 +36,8 @@ public:
     AVRational sample_aspect_ratio{};
     AVRational time_base{};
     AVRational frame_rate{};
+    // Of the hardware frames, the buffer source needs it before its initialization
+    AVBufferRef *hw_frames_ctx = nullptr;
 };
 
 QAVVideoInputFilter::QAVVideoInputFilter()
@@ -51,6 +57,8 @@ QAVVideoInputFilter::QAVVideoInputFilter(const QAVFrame &frame)
     d->sample_aspect_ratio = frm->sample_aspect_ratio.num && frm->sample_aspect_ratio.den ? frm->sample_aspect_ratio : stream->codecpar->sample_aspect_ratio;
     d->time_base = stream->time_base;
     d->frame_rate = stream->avg_frame_rate;
+    if (frm->hw_frames_ctx)
+        d->hw_frames_ctx = av_buffer_ref(frm->hw_frames_ctx);
 }
 
 QAVVideoInputFilter::QAVVideoInputFilter(const QAVVideoInputFilter &other)
@@ -71,6 +79,11 @@ QAVVideoInputFilter &QAVVideoInputFilter::operator=(const QAVVideoInputFilter &o
     d->sample_aspect_ratio = other.d_func()->sample_aspect_ratio;
     d->time_base = other.d_func()->time_base;
     d->frame_rate = other.d_func()->frame_rate;
+    if (d->hw_frames_ctx != other.d_func()->hw_frames_ctx) {
+        av_buffer_unref(&d->hw_frames_ctx);
+        if (other.d_func()->hw_frames_ctx)
+            d->hw_frames_ctx = av_buffer_ref(other.d_func()->hw_frames_ctx);
+    }
     return *this;
 }
 
@@ -93,9 +106,24 @@ int QAVVideoInputFilter::configure(AVFilterGraph *graph, AVFilterInOut *in)
     char name[255];
     snprintf(name, sizeof(name), "buffer_%d", index++);
 
-    int ret = avfilter_graph_create_filter(&d->ctx,
+    int ret = 0;
+    if (d->hw_frames_ctx) {
+        d->ctx = avfilter_graph_alloc_filter(graph, avfilter_get_by_name("buffer"), name);
+        if (!d->ctx)
+            return AVERROR(ENOMEM);
+        AVBufferSrcParameters *par = av_buffersrc_parameters_alloc();
+        if (!par)
+            return AVERROR(ENOMEM);
+        par->hw_frames_ctx = d->hw_frames_ctx;
+        ret = av_buffersrc_parameters_set(d->ctx, par);
+        av_free(par);
+        if (ret >= 0)
+            ret = avfilter_init_str(d->ctx, args.str);
+    } else {
+        ret = avfilter_graph_create_filter(&d->ctx,
                                            avfilter_get_by_name("buffer"),
                                            name, args.str, nullptr, graph);
+    }
     if (ret < 0)
         return ret;
 
@@ -110,7 +138,8 @@ bool QAVVideoInputFilter::supports(const QAVFrame &frame) const
     const auto & frm = frame.frame();
     return d->width == frm->width
            && d->height == frm->height
-           && d->format == frm->format;
+           && d->format == frm->format
+           && (d->hw_frames_ctx ? d->hw_frames_ctx->data : nullptr) == (frm->hw_frames_ctx ? frm->hw_frames_ctx->data : nullptr);
 }
 
 QT_END_NAMESPACE
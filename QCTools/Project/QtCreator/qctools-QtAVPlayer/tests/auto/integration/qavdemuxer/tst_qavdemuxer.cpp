@@ -40,6 +40,8 @@ private slots:
     void metadata();
     void videoCodecs();
     void inputOptions();
+    void keyFrames_data();
+    void keyFrames();
 };
 
 void tst_QAVDemuxer::construction()
@@ -434,5 +436,45 @@ void tst_QAVDemuxer::inputOptions()
     QVERIFY(d.load(file.absoluteFilePath()) >= 0);
 }
 
+void tst_QAVDemuxer::keyFrames_data()
+{
+    QTest::addColumn<QString>("file");
+
+    QTest::newRow("mp4") << QString("colors.mp4");
+    QTest::newRow("mpeg") << QString("star_trails.mpeg");
+}
+
+void tst_QAVDemuxer::keyFrames()
+{
+    QFETCH(QString, file);
+
+    QAVDemuxer d;
+    QVERIFY(d.load(QFileInfo(testData(file)).absoluteFilePath()) >= 0);
+    QVERIFY(!d.currentVideoStreams().isEmpty());
+    const int videoIndex = d.currentVideoStreams().first().index();
+
+    QVector<QPair<double, qint64>> keyFrames;
+    QAVPacket p;
+    while ((p = d.read())) {
+        if (p.packet()->stream_index == videoIndex && (p.packet()->flags & AV_PKT_FLAG_KEY))
+            keyFrames.append({p.pts(), p.packet()->pos});
+    }
+    if (keyFrames.size() < 3)
+        QSKIP("Not enough key frames");
+
+    // Between 2 key frames, the first video packet read is the first key frame
+    d.setKeyFrames(keyFrames);
+    const auto keyFrame = keyFrames[keyFrames.size() / 2];
+    const auto next = keyFrames[keyFrames.size() / 2 + 1];
+    QVERIFY(d.seek((keyFrame.first + next.first) / 2) >= 0);
+    while ((p = d.read())) {
+        if (p.packet()->stream_index == videoIndex)
+            break;
+    }
+    QVERIFY(p);
+    QVERIFY(p.packet()->flags & AV_PKT_FLAG_KEY);
+    QCOMPARE(p.pts(), keyFrame.first);
+}
+
 QTEST_MAIN(tst_QAVDemuxer)
 #include "tst_qavdemuxer.moc"
@@ -14,6 +14,8 @@
 
 extern "C" {
 #include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavdevice/avdevice.h>
 }
 
 #ifndef TEST_DATA_DIR
@@ -88,6 +90,7 @@ private slots:
     void changeFormat();
     void filterName();
     void filterNameStep();
+    void filterOutput();
     void audioVideoFilter();
     void audioFilterVideoFrames();
     void multipleFilters();
@@ -96,13 +99,32 @@ private slots:
     void inputVideoCodec();
     void flushFilters();
     void multipleAudioStreams();
+    void streamThreads();
+    void decodeAhead();
+    void threadPriority();
+    void threadInit();
+    void hardwareDevice();
+    void fastProbe();
     void multipleVideoStreams_data();
     void multipleVideoStreams();
     void emptyStreams();
     void flushCodecs();
+    void videoSampling();
+    void scrub();
+    void coalescedSeeks();
+    void skipDuplicateFrames();
+    void frameHash();
     void multiFilterInputs_data();
     void multiFilterInputs();
     void streamMetadataRotate();
+    void refilter();
+    void refilterGraphs();
+    void decoderPool();
+    void traceFunction();
+    void framesBytes();
+    void throughput_data();
+    void throughput();
+    void frameBufferPool();
 };
 
 void tst_QAVPlayer::initTestCase()
@@ -3013,6 +3035,40 @@ void tst_QAVPlayer::filterNameStep()
     QVERIFY(set.isEmpty());
 }
 
+void tst_QAVPlayer::filterOutput()
+{
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    QAVPlayer p;
+    QFileInfo file(testData("small.mp4"));
+    p.setSource(file.absoluteFilePath());
+    p.setFilters({
+            "scale=iw/2:-1[scale]",
+            "[0:v]split=2[in1][in2];[in1]boxblur[out1];[in2]negate[out2]"
+        });
+    QMap<QString, int> outputs;
+    bool mismatch = false;
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &frame) {
+        if (frame.filterName().isEmpty())
+            return;
+        if (frame.filterOutput() != QAVFrame::filterOutputId(frame.filterName()))
+            mismatch = true;
+        outputs.insert(frame.filterName(), frame.filterOutput());
+    });
+
+    p.play();
+    QTRY_VERIFY_WITH_TIMEOUT(outputs.size() >= 3, 30000);
+    QVERIFY(!mismatch);
+    QVERIFY(outputs.value("scale") >= 0);
+    QVERIFY(outputs.value("out1") != outputs.value("out2"));
+    QCOMPARE(QAVFrame::filterOutputId("out1"), outputs.value("out1"));
+    QCOMPARE(QAVFrame::filterOutputId(QString()), -1);
+
+    QAVFrame frame;
+    QCOMPARE(frame.filterOutput(), -1);
+    frame.setFilterName("out2");
+    QCOMPARE(frame.filterOutput(), outputs.value("out2"));
+}
+
 void tst_QAVPlayer::audioVideoFilter()
 {
     qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
@@ -3235,6 +3291,201 @@ void tst_QAVPlayer::multipleAudioStreams()
     QCOMPARE(spy.count(), 1);
 }
 
+void tst_QAVPlayer::streamThreads()
+{
+    QMutex mutex;
+    QMap<int, int> frames;
+    QMap<int, QThread *> threads;
+    QAVPlayer p;
+
+    QFileInfo file(testData("guido.mp4"));
+    QObject::connect(&p, &QAVPlayer::audioFrame, &p, [&](const QAVAudioFrame &f) {
+        QMutexLocker locker(&mutex);
+        ++frames[f.stream().index()];
+        threads[f.stream().index()] = QThread::currentThread();
+    }, Qt::DirectConnection);
+
+    p.setSource(file.absoluteFilePath());
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::LoadedMedia);
+    QCOMPARE(p.streamThreads(), false);
+    p.setStreamThreads(true);
+    QCOMPARE(p.streamThreads(), true);
+    p.setAudioStreams(p.availableAudioStreams());
+    p.setFilter("volume=1");
+    p.setSynced(false);
+    p.play();
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+
+    // The second stream has a thread of its own and the end of the media waits for it
+    QMutexLocker locker(&mutex);
+    const auto audioStreams = p.availableAudioStreams();
+    QCOMPARE(frames.size(), 2);
+    QVERIFY(frames[audioStreams[0].index()] > 0);
+    QCOMPARE(frames[audioStreams[1].index()], frames[audioStreams[0].index()]);
+    QVERIFY(threads[audioStreams[0].index()] != threads[audioStreams[1].index()]);
+    QVERIFY(p.counters().audioFrames >= quint64(frames[audioStreams[0].index()] * 2));
+}
+
+void tst_QAVPlayer::decodeAhead()
+{
+    QFileInfo file(testData("guido.mp4"));
+    auto play = [&](int frames, int &videoFrames, int &audioFrames) {
+        QAVPlayer p;
+        std::atomic_int video {0};
+        std::atomic_int audio {0};
+        QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &) { ++video; }, Qt::DirectConnection);
+        QObject::connect(&p, &QAVPlayer::audioFrame, &p, [&](const QAVAudioFrame &) { ++audio; }, Qt::DirectConnection);
+        p.setDecodeAhead(frames);
+        QCOMPARE(p.decodeAhead(), frames);
+        p.setSource(file.absoluteFilePath());
+        p.setFilter("hflip");
+        p.setSynced(false);
+        p.play();
+        QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+        videoFrames = video;
+        audioFrames = audio;
+    };
+
+    // Same frames with a decode stage, and the seek of the last test waits for it
+    int videoFrames = 0;
+    int audioFrames = 0;
+    play(0, videoFrames, audioFrames);
+    int aheadVideoFrames = 0;
+    int aheadAudioFrames = 0;
+    play(4, aheadVideoFrames, aheadAudioFrames);
+    QVERIFY(videoFrames > 0);
+    QCOMPARE(aheadVideoFrames, videoFrames);
+    QCOMPARE(aheadAudioFrames, audioFrames);
+
+    QAVPlayer p;
+    QSignalSpy seekedSpy(&p, &QAVPlayer::seeked);
+    p.setDecodeAhead(2);
+    p.setSource(file.absoluteFilePath());
+    p.setSynced(false);
+    p.play();
+    p.seek(1000);
+    QTRY_VERIFY(seekedSpy.count() > 0);
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+}
+
+void tst_QAVPlayer::threadPriority()
+{
+    QFileInfo file(testData("guido.mp4"));
+    QAVPlayer p;
+    QCOMPARE(p.threadPriority(), QThread::InheritPriority);
+    QSignalSpy spy(&p, &QAVPlayer::threadPriorityChanged);
+    std::atomic_int video {0};
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &) { ++video; }, Qt::DirectConnection);
+    p.setThreadPriority(QThread::LowPriority);
+    QCOMPARE(p.threadPriority(), QThread::LowPriority);
+    QCOMPARE(spy.count(), 1);
+    p.setThreadPriority(QThread::LowPriority);
+    QCOMPARE(spy.count(), 1);
+
+    // Changed while the threads run, the frames are the same
+    p.setDecodeAhead(2);
+    p.setSource(file.absoluteFilePath());
+    p.setSynced(false);
+    p.play();
+    QTRY_VERIFY(video > 0);
+    p.setThreadPriority(QThread::HighPriority);
+    QCOMPARE(p.threadPriority(), QThread::HighPriority);
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QCOMPARE(spy.count(), 2);
+}
+
+void tst_QAVPlayer::threadInit()
+{
+    QFileInfo file(testData("guido.mp4"));
+    QAVPlayer p;
+    QMutex mutex;
+    QSet<QThread *> threads;
+    p.setThreadInit([&]() {
+        QMutexLocker locker(&mutex);
+        threads.insert(QThread::currentThread());
+    });
+
+    // Loader, demuxer, video and audio threads, not the thread of the player
+    p.setSource(file.absoluteFilePath());
+    p.setSynced(false);
+    p.play();
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QMutexLocker locker(&mutex);
+    QVERIFY(threads.size() >= 2);
+    QVERIFY(!threads.contains(QThread::currentThread()));
+}
+
+void tst_QAVPlayer::hardwareDevice()
+{
+    QFileInfo file(testData("guido.mp4"));
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    qputenv("QT_AVPLAYER_HWDECODE", "vaapi");
+    auto decode = [&](const QString &device, int &frames, int &hardware) {
+        QAVPlayer p;
+        std::atomic_int video {0}, onDevice {0};
+        QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &f) {
+            ++video;
+            if (f.frame()->hw_frames_ctx)
+                ++onDevice;
+        }, Qt::DirectConnection);
+        p.setHardwareFrames(true);
+        p.setHardwareDevice(device);
+        QCOMPARE(p.hardwareDevice(), device);
+        p.setSource(file.absoluteFilePath());
+        p.setSynced(false);
+        p.play();
+        QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+        frames = video;
+        hardware = onDevice;
+    };
+
+    // Forced to software, and a device which does not exist falls back to software
+    int frames = 0, hardware = 0;
+    decode(QLatin1String("none"), frames, hardware);
+    QVERIFY(frames > 0);
+    QCOMPARE(hardware, 0);
+    int missingFrames = 0;
+    decode(QLatin1String("/dev/dri/qavplayer-missing"), missingFrames, hardware);
+    QCOMPARE(missingFrames, frames);
+    QCOMPARE(hardware, 0);
+    qunsetenv("QT_AVPLAYER_HWDECODE");
+}
+
+void tst_QAVPlayer::fastProbe()
+{
+    QFileInfo file(testData("guido.mp4"));
+    auto load = [&](bool fast, qint64 &duration, int &videoStreams, int &audioStreams, int &videoFrames) {
+        QAVPlayer p;
+        std::atomic_int video {0};
+        QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &) { ++video; }, Qt::DirectConnection);
+        p.setFastProbe(fast);
+        QCOMPARE(p.fastProbe(), fast);
+        p.setSource(file.absoluteFilePath());
+        QTRY_COMPARE(p.mediaStatus(), QAVPlayer::LoadedMedia);
+        QVERIFY(p.counters().probeTime >= 0);
+        duration = p.duration();
+        videoStreams = p.availableVideoStreams().size();
+        audioStreams = p.availableAudioStreams().size();
+        p.setSynced(false);
+        p.play();
+        QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+        videoFrames = video;
+    };
+
+    // The header of MP4 has the parameters, the streams and frames are the same as with the full probe
+    qint64 duration = 0, fastDuration = 0;
+    int videoStreams = 0, fastVideoStreams = 0;
+    int audioStreams = 0, fastAudioStreams = 0;
+    int videoFrames = 0, fastVideoFrames = 0;
+    load(false, duration, videoStreams, audioStreams, videoFrames);
+    load(true, fastDuration, fastVideoStreams, fastAudioStreams, fastVideoFrames);
+    QVERIFY(duration > 0);
+    QVERIFY(qAbs(fastDuration - duration) < 100);
+    QCOMPARE(fastVideoStreams, videoStreams);
+    QCOMPARE(fastAudioStreams, audioStreams);
+    QCOMPARE(fastVideoFrames, videoFrames);
+}
+
 void tst_QAVPlayer::multipleVideoStreams_data()
 {
     QTest::addColumn<QString>("path");
@@ -3376,6 +3627,198 @@ void tst_QAVPlayer::flushCodecs()
     QTRY_COMPARE(framesCount, 309);
 }
 
+void tst_QAVPlayer::videoSampling()
+{
+    QAVPlayer p;
+    QFileInfo file(testData("DHC0413_CreaseOrNot.mp4"));
+    int framesCount = 0;
+    int keyFramesCount = 0;
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &f) {
+        ++framesCount;
+        if (f.frame()->key_frame)
+            ++keyFramesCount;
+    }, Qt::DirectConnection);
+
+    QCOMPARE(p.videoSampling(), 0);
+    p.setVideoSampling(10);
+    QCOMPARE(p.videoSampling(), 10);
+    p.setSource(file.absoluteFilePath());
+    p.setSynced(false);
+    p.play();
+
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QTRY_COMPARE(framesCount, 31);
+
+    framesCount = 0;
+    keyFramesCount = 0;
+    p.setVideoSampling(-1);
+    p.setSource("");
+    p.setSource(file.absoluteFilePath());
+    p.play();
+
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QVERIFY(framesCount > 0);
+    QVERIFY(framesCount < 309);
+    QCOMPARE(keyFramesCount, framesCount);
+}
+
+void tst_QAVPlayer::scrub()
+{
+    QAVPlayer p;
+    QFileInfo file(testData("DHC0413_CreaseOrNot.mp4"));
+    int framesCount = 0;
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &) {
+        ++framesCount;
+    }, Qt::DirectConnection);
+    QSignalSpy spy(&p, &QAVPlayer::scrubChanged);
+
+    QVERIFY(!p.scrub());
+    p.setScrub(true);
+    QVERIFY(p.scrub());
+    QCOMPARE(spy.count(), 1);
+    p.setScrub(true);
+    QCOMPARE(spy.count(), 1);
+    p.setSource(file.absoluteFilePath());
+    p.setSpeed(4);
+    p.play();
+
+    QTRY_COMPARE_WITH_TIMEOUT(p.mediaStatus(), QAVPlayer::EndOfMedia, 15000);
+    // About one frame of 4 is shown
+    QVERIFY(framesCount > 0);
+    QVERIFY(framesCount < 309);
+
+    // All the frames at normal speed
+    framesCount = 0;
+    p.setSpeed(1);
+    p.setSynced(false);
+    p.setSource("");
+    p.setSource(file.absoluteFilePath());
+    p.play();
+
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QTRY_COMPARE(framesCount, 309);
+}
+
+void tst_QAVPlayer::coalescedSeeks()
+{
+    QAVPlayer p;
+    QFileInfo file(testData("colors.mp4"));
+    QAVVideoFrame frame;
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &f) { frame = f; });
+    qint64 seekPosition = -1;
+    QObject::connect(&p, &QAVPlayer::seeked, &p, [&](qint64 pos) { seekPosition = pos; });
+
+    p.setSource(file.absoluteFilePath());
+    p.pause();
+    QTRY_VERIFY(frame);
+
+    // Positions of a cursor dragged across the plots, the last one is shown
+    for (int pos = 1000; pos <= 9000; pos += 200)
+        p.seek(pos);
+    QCOMPARE(p.position(), 9000);
+    QTRY_VERIFY(qAbs(seekPosition - 9000) < 500);
+    QTRY_VERIFY(qAbs(frame.pts() - 9.0) < 0.5);
+    QCOMPARE(p.state(), QAVPlayer::PausedState);
+
+    // One group of pictures: the later positions are decoded on from the previous ones
+    p.setKeyFrames({{0.0, -1}});
+    seekPosition = -1;
+    p.seek(2000);
+    for (int pos = 2040; pos <= 3000; pos += 40)
+        p.seek(pos);
+    QCOMPARE(p.position(), 3000);
+    QTRY_VERIFY(qAbs(seekPosition - 3000) < 500);
+    QTRY_VERIFY(qAbs(frame.pts() - 3.0) < 0.5);
+
+    // Backward again
+    seekPosition = -1;
+    p.seek(1000);
+    QCOMPARE(p.position(), 1000);
+    QTRY_VERIFY(qAbs(seekPosition - 1000) < 500);
+    QTRY_VERIFY(qAbs(frame.pts() - 1.0) < 0.5);
+}
+
+void tst_QAVPlayer::skipDuplicateFrames()
+{
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    QAVPlayer p;
+    // Color bars, the frames are the same
+    QFileInfo file(testData("dv25_pal__411_4-3_2ch_32k_bars_sine.dv"));
+    QMap<QString, int> framesCount;
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &f) {
+        ++framesCount[f.filterName()];
+    }, Qt::DirectConnection);
+
+    QVERIFY(p.skipDuplicateFrames().isEmpty());
+    p.setSkipDuplicateFrames({true, false});
+    QCOMPARE(p.skipDuplicateFrames(), QList<bool>({true, false}));
+    p.setFilters({"negate", "null"});
+    p.setSource(file.absoluteFilePath());
+    p.setSynced(false);
+    p.play();
+
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    const int frames = framesCount["1:0"];
+    QVERIFY(frames > 1);
+    // Duplicates are not filtered by the skipped graph
+    QVERIFY(framesCount["duplicate"] > 0);
+    QCOMPARE(framesCount["0:0"] + framesCount["duplicate"], frames);
+
+    framesCount.clear();
+    p.setSkipDuplicateFrames({});
+    p.setSource("");
+    p.setSource(file.absoluteFilePath());
+    p.play();
+
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QCOMPARE(framesCount["0:0"], frames);
+    QCOMPARE(framesCount["1:0"], frames);
+    QVERIFY(!framesCount.contains("duplicate"));
+}
+
+void tst_QAVPlayer::frameHash()
+{
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    QAVPlayer p;
+    QFileInfo file(testData("av_sample.mkv"));
+    QList<QByteArray> videoHashes;
+    int audioHashes = 0;
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &f) {
+        auto e = av_dict_get(f.frame()->metadata, "framehash.md5", nullptr, 0);
+        if (e)
+            videoHashes.append(e->value);
+    }, Qt::DirectConnection);
+    QObject::connect(&p, &QAVPlayer::audioFrame, &p, [&](const QAVAudioFrame &f) {
+        if (av_dict_get(f.frame()->metadata, "framehash.md5", nullptr, 0))
+            ++audioHashes;
+    }, Qt::DirectConnection);
+
+    QVERIFY(p.frameHash().isEmpty());
+    QVERIFY(!p.setFrameHash("unknown"));
+    QVERIFY(p.frameHash().isEmpty());
+    QVERIFY(p.setFrameHash("MD5"));
+    QCOMPARE(p.frameHash(), QLatin1String("MD5"));
+    p.setSource(file.absoluteFilePath());
+    p.setSynced(false);
+    p.play();
+
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QCOMPARE(videoHashes.size(), 250);
+    QVERIFY(audioHashes > 0);
+    QCOMPARE(videoHashes[0].size(), 32);
+
+    // Kept by the filters, the same for the same frames
+    const auto hashes = videoHashes;
+    videoHashes.clear();
+    p.setFilter("negate");
+    p.setSource("");
+    p.setSource(file.absoluteFilePath());
+    p.play();
+
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QCOMPARE(videoHashes, hashes);
+}
+
 void tst_QAVPlayer::multiFilterInputs_data()
 {
     QTest::addColumn<QString>("filter");
@@ -3426,5 +3869,321 @@ void tst_QAVPlayer::streamMetadataRotate()
     QCOMPARE(p.currentVideoStreams()[0].metadata()["rotate"], "90");
 }
 
+void tst_QAVPlayer::refilter()
+{
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    QAVPlayer p;
+    QFileInfo file(testData("small.mp4"));
+    QAVVideoFrame frame;
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &f) { frame = f; });
+
+    QVERIFY(!p.refilter());
+    p.setFilterCacheSize(2);
+    p.setSource(file.absoluteFilePath());
+    p.pause();
+    QTRY_VERIFY(frame);
+    QCOMPARE(frame.size(), QSize(560, 320));
+    const double pts = frame.pts();
+
+    // The shown frame is filtered again, without seeking
+    QString desc = "scale=iw/2:-1";
+    p.setFilter(desc, true);
+    frame = QAVVideoFrame();
+    QTRY_VERIFY(p.refilter());
+    QVERIFY(frame);
+    QCOMPARE(frame.size(), QSize(560 / 2, 320 / 2));
+    QCOMPARE(frame.pts(), pts);
+
+    p.setFilter("negate", true);
+    frame = QAVVideoFrame();
+    QVERIFY(p.refilter());
+    QCOMPARE(frame.size(), QSize(560, 320));
+
+    // Graph of the cache
+    p.setFilter(desc, true);
+    frame = QAVVideoFrame();
+    QVERIFY(p.refilter());
+    QCOMPARE(frame.size(), QSize(560 / 2, 320 / 2));
+    QCOMPARE(frame.pts(), pts);
+
+    p.play();
+    QVERIFY(!p.refilter());
+    QTRY_VERIFY(frame.pts() > pts);
+    QCOMPARE(frame.size(), QSize(560 / 2, 320 / 2));
+}
+
+void tst_QAVPlayer::refilterGraphs()
+{
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    QAVPlayer p;
+    QFileInfo file(testData("small.mp4"));
+    QList<QAVVideoFrame> frames;
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &f) { frames.append(f); });
+
+    p.setParallelFilters(true);
+    p.setFilters({"scale=iw/2:-1", "negate"}, {true, true});
+    p.setSource(file.absoluteFilePath());
+    p.pause();
+    QTRY_COMPARE(frames.size(), 2);
+    const double pts = frames[0].pts();
+    QCOMPARE(frames[1].pts(), pts);
+
+    // Only the changed graph is fed with the shown frame
+    frames.clear();
+    p.setFilters({"scale=iw/2:-1", "scale=iw/4:-1"}, {true, true});
+    QTRY_VERIFY(p.refilter());
+    QCOMPARE(frames.size(), 1);
+    QCOMPARE(frames[0].filterName(), QLatin1String("1:0"));
+    QCOMPARE(frames[0].size(), QSize(560 / 4, 320 / 4));
+    QCOMPARE(frames[0].pts(), pts);
+
+    // Moved graphs are kept
+    frames.clear();
+    p.setFilters({"scale=iw/4:-1"}, {true});
+    QVERIFY(p.refilter());
+    QVERIFY(frames.isEmpty());
+
+    // Not cacheable
+    p.setFilters({"scale=iw/4:-1", "tblend"}, {true, false});
+    QVERIFY(!p.refilter());
+}
+
+void tst_QAVPlayer::decoderPool()
+{
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    QFileInfo file(testData("small.mp4"));
+    QAVPlayer::setDecoderPoolSize(4);
+
+    auto play = [&](int &frames) {
+        QAVPlayer p;
+        frames = 0;
+        QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &) { ++frames; }, Qt::DirectConnection);
+        p.setSource(file.absoluteFilePath());
+        p.play();
+        QTRY_COMPARE_WITH_TIMEOUT(p.mediaStatus(), QAVPlayer::EndOfMedia, 15000);
+    };
+
+    int frames = 0;
+    play(frames);
+    QVERIFY(frames > 0);
+    const auto before = QAVPlayer::allocations();
+
+    // Same streams: the decoders of the first player are flushed and decode the file again
+    int reusedFrames = 0;
+    play(reusedFrames);
+    QCOMPARE(reusedFrames, frames);
+    const auto after = QAVPlayer::allocations();
+    QVERIFY(after.decodersReused > before.decodersReused);
+    QCOMPARE(after.decoders, before.decoders);
+
+    QAVPlayer::setDecoderPoolSize(0);
+    play(frames);
+    QCOMPARE(QAVPlayer::allocations().decodersReused, after.decodersReused);
+}
+
+static std::atomic_int traceReads(0);
+static std::atomic_int traceDecodes(0);
+static std::atomic_int traceUnordered(0);
+
+void tst_QAVPlayer::traceFunction()
+{
+    QFileInfo file(testData("small.mp4"));
+    QAVPlayer::setTraceFunction([](const char *name, qint64 begin, qint64 end, qint64 arg) {
+        if (end < begin)
+            ++traceUnordered;
+        if (!qstrcmp(name, "demux read"))
+            ++traceReads;
+        else if (!qstrcmp(name, "decode") && arg >= 0)
+            ++traceDecodes;
+    });
+
+    auto play = [&]() {
+        QAVPlayer p;
+        p.setSource(file.absoluteFilePath());
+        p.play();
+        QTRY_COMPARE_WITH_TIMEOUT(p.mediaStatus(), QAVPlayer::EndOfMedia, 15000);
+    };
+
+    play();
+    QVERIFY(traceReads > 0);
+    QVERIFY(traceDecodes > 0);
+    QCOMPARE(traceUnordered.load(), 0);
+
+    // Nothing is called once removed
+    QAVPlayer::setTraceFunction(nullptr);
+    const int reads = traceReads;
+    play();
+    QCOMPARE(traceReads.load(), reads);
+}
+
+void tst_QAVPlayer::framesBytes()
+{
+    QFileInfo file(testData("guido.mp4"));
+    QAVPlayer p;
+    std::atomic_int video {0};
+    std::atomic<qint64> held {0};
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &) {
+        // The frames ahead are decoded while the first one is handled
+        if (video++ == 0) {
+            QThread::msleep(200);
+            held = p.counters().videoFramesBytes;
+        }
+    }, Qt::DirectConnection);
+    p.setDecodeAhead(4);
+    p.setSource(file.absoluteFilePath());
+    p.setSynced(false);
+    p.play();
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::EndOfMedia);
+    QVERIFY(held > 0);
+    QTRY_COMPARE(p.counters().videoFramesBytes, qint64(0));
+}
+
+// Video frames decoded by FFmpeg alone, without threads, queues nor filters, and the milliseconds spent
+static int decodeVideo(const QString &url, const QString &format, qint64 &elapsed)
+{
+    avdevice_register_all();
+    AVFormatContext *ctx = nullptr;
+    auto inputFormat = format.isEmpty() ? nullptr : av_find_input_format(format.toUtf8().constData());
+    if (avformat_open_input(&ctx, url.toUtf8().constData(), inputFormat, nullptr) < 0)
+        return -1;
+    int frames = -1;
+    AVCodecContext *codecCtx = nullptr;
+    QElapsedTimer timer;
+    timer.start();
+    int index = avformat_find_stream_info(ctx, nullptr) >= 0 ? av_find_best_stream(ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0) : -1;
+    const AVCodec *codec = index >= 0 ? avcodec_find_decoder(ctx->streams[index]->codecpar->codec_id) : nullptr;
+    if (codec && (codecCtx = avcodec_alloc_context3(codec))
+        && avcodec_parameters_to_context(codecCtx, ctx->streams[index]->codecpar) >= 0
+        && avcodec_open2(codecCtx, codec, nullptr) >= 0)
+    {
+        frames = 0;
+        AVPacket *pkt = av_packet_alloc();
+        AVFrame *frame = av_frame_alloc();
+        auto receive = [&] {
+            while (avcodec_receive_frame(codecCtx, frame) >= 0) {
+                ++frames;
+                av_frame_unref(frame);
+            }
+        };
+        while (av_read_frame(ctx, pkt) >= 0) {
+            if (pkt->stream_index == index && avcodec_send_packet(codecCtx, pkt) >= 0)
+                receive();
+            av_packet_unref(pkt);
+        }
+        avcodec_send_packet(codecCtx, nullptr);
+        receive();
+        av_frame_free(&frame);
+        av_packet_free(&pkt);
+    }
+    elapsed = timer.elapsed();
+    avcodec_free_context(&codecCtx);
+    avformat_close_input(&ctx);
+    return frames;
+}
+
+void tst_QAVPlayer::throughput_data()
+{
+    QTest::addColumn<QString>("source");
+    QTest::addColumn<QString>("format");
+    QTest::addColumn<QString>("filter");
+    QTest::addColumn<int>("outputs");
+    QTest::addColumn<double>("minRatio");
+
+    const QString generated = QLatin1String("testsrc2=size=1280x720:rate=25:duration=20");
+    const QString busy = QLatin1String("[0:v]split=3[in1][in2][in3];[in1]boxblur=4[out1];[in2]negate,hflip[out2];[in3]scale=iw/2:-1,format=gray[out3]");
+    QTest::newRow("generated") << generated << QString("lavfi") << QString() << 1 << 0.25;
+    QTest::newRow("generated busy filter") << generated << QString("lavfi") << busy << 3 << 0.05;
+    QTest::newRow("guido.mp4") << testData("guido.mp4") << QString() << QString() << 1 << 0.25;
+    QTest::newRow("guido.mp4 busy filter") << testData("guido.mp4") << QString() << busy << 3 << 0.05;
+}
+
+// Guards the unsynced path (demux, packet queues, decode and filter threads) against throughput regressions:
+// the frames per second of the player are compared to a raw FFmpeg decode of the same source, minRatio is
+// loose enough for loaded CI machines and can be raised by QT_AVPLAYER_MIN_THROUGHPUT_RATIO on a quiet one
+void tst_QAVPlayer::throughput()
+{
+    QFETCH(QString, source);
+    QFETCH(QString, format);
+    QFETCH(QString, filter);
+    QFETCH(int, outputs);
+    QFETCH(double, minRatio);
+
+    bool ok = false;
+    const double envRatio = qEnvironmentVariable("QT_AVPLAYER_MIN_THROUGHPUT_RATIO").toDouble(&ok);
+    if (ok && envRatio > 0 && filter.isEmpty())
+        minRatio = envRatio;
+
+    qint64 baselineTime = 0;
+    const int baselineFrames = decodeVideo(source, format, baselineTime);
+    QVERIFY(baselineFrames > 0);
+    const double baselineFps = baselineFrames * 1000.0 / qMax<qint64>(baselineTime, 1);
+
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    QAVPlayer p;
+    std::atomic_int frames {0};
+    std::atomic_int audioFrames {0};
+    QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &) { ++frames; }, Qt::DirectConnection);
+    QObject::connect(&p, &QAVPlayer::audioFrame, &p, [&](const QAVAudioFrame &) { ++audioFrames; }, Qt::DirectConnection);
+    if (!format.isEmpty())
+        p.setInputFormat(format);
+    p.setSource(source);
+    if (!filter.isEmpty())
+        p.setFilter(filter);
+    p.setSynced(false);
+
+    // The video stream only, as the raw decode
+    QTRY_COMPARE(p.mediaStatus(), QAVPlayer::LoadedMedia);
+    p.setAudioStreams({});
+
+    QElapsedTimer timer;
+    timer.start();
+    p.play();
+    QTRY_COMPARE_WITH_TIMEOUT(p.mediaStatus(), QAVPlayer::EndOfMedia, 120000);
+    const qint64 elapsed = qMax<qint64>(timer.elapsed(), 1);
+
+    QCOMPARE(frames.load(), baselineFrames * outputs);
+    QCOMPARE(audioFrames.load(), 0);
+    const double fps = baselineFrames * 1000.0 / elapsed;
+    const double ratio = fps / baselineFps;
+    qDebug() << "ffmpeg:" << baselineFps << "fps, player:" << fps << "fps, ratio:" << ratio
+             << "demuxer stall:" << p.demuxerStallTime() << "ms, decoder stall:" << p.decoderStallTime() << "ms"
+             << "filter waits:" << p.counters().filterWaits;
+    QVERIFY2(ratio >= minRatio, qPrintable(QString("%1 fps, %2 of the raw decode, below %3").arg(fps).arg(ratio).arg(minRatio)));
+}
+
+void tst_QAVPlayer::frameBufferPool()
+{
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    QFileInfo file(testData("guido.mp4"));
+    const auto before = QAVPlayer::allocations();
+    {
+        QAVPlayer p;
+        int frames = 0;
+        std::atomic_int unaligned {0};
+        QObject::connect(&p, &QAVPlayer::videoFrame, &p, [&](const QAVVideoFrame &frame) {
+            ++frames;
+            const AVFrame *f = frame.frame();
+            for (int i = 0; i < AV_NUM_DATA_POINTERS && f->data[i]; ++i) {
+                if (reinterpret_cast<quintptr>(f->data[i]) % 64 || f->linesize[i] % 64)
+                    ++unaligned;
+            }
+        }, Qt::DirectConnection);
+        p.setSource(file.absoluteFilePath());
+        p.setSynced(false);
+        p.play();
+        QTRY_COMPARE_WITH_TIMEOUT(p.mediaStatus(), QAVPlayer::EndOfMedia, 15000);
+        QVERIFY(frames > 0);
+        QCOMPARE(unaligned.load(), 0);
+    }
+
+    // The planes of the first frames are reused by the next ones
+    const auto after = QAVPlayer::allocations();
+    const quint64 allocated = after.frameBuffers - before.frameBuffers;
+    const quint64 reused = after.frameBuffersReused - before.frameBuffersReused;
+    QVERIFY(allocated > 0);
+    QVERIFY(reused > allocated);
+    QTRY_COMPARE(QAVPlayer::allocations().frameBuffersBytes, before.frameBuffersBytes);
+}
+
 QTEST_MAIN(tst_QAVPlayer)
 #include "tst_qavplayer.moc"
@@ -1,6 +1,6 @@
 message('entering qctools-cli.pro')
 
-QT += core network
+QT += core network sql
 QT -= gui
 
 CONFIG += c++1z
@@ -36,10 +36,26 @@ message("qctools: THIRD_PARTY_PATH = " $$absolute_path($$THIRD_PARTY_PATH))
 INCLUDEPATH += $$SOURCES_PATH
 
 HEADERS += $$SOURCES_PATH/Cli/version.h \
-           $$SOURCES_PATH/Cli/cli.h
+           $$SOURCES_PATH/Cli/cli.h \
+           $$SOURCES_PATH/Cli/batch.h \
+           $$SOURCES_PATH/Cli/columnsserver.h \
+           $$SOURCES_PATH/Cli/convert.h \
+           $$SOURCES_PATH/Cli/coordinator.h \
+           $$SOURCES_PATH/Cli/estimator.h \
+           $$SOURCES_PATH/Cli/live.h \
+           $$SOURCES_PATH/Cli/server.h \
+           $$SOURCES_PATH/Cli/watch.h
 
 SOURCES += $$SOURCES_PATH/Cli/main.cpp \
-           $$SOURCES_PATH/Cli/cli.cpp
+           $$SOURCES_PATH/Cli/cli.cpp \
+           $$SOURCES_PATH/Cli/batch.cpp \
+           $$SOURCES_PATH/Cli/columnsserver.cpp \
+           $$SOURCES_PATH/Cli/convert.cpp \
+           $$SOURCES_PATH/Cli/coordinator.cpp \
+           $$SOURCES_PATH/Cli/estimator.cpp \
+           $$SOURCES_PATH/Cli/live.cpp \
+           $$SOURCES_PATH/Cli/server.cpp \
+           $$SOURCES_PATH/Cli/watch.cpp
 
 
 # The following define makes your compiler emit warnings if you use
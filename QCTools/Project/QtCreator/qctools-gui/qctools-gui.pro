@@ -52,6 +52,10 @@ HEADERS += \
     $$SOURCES_PATH/GUI/FilesList.h \
     $$SOURCES_PATH/GUI/Help.h \
     $$SOURCES_PATH/GUI/Info.h \
+    $$SOURCES_PATH/GUI/MemoryView.h \
+    $$SOURCES_PATH/GUI/ParsingCounters.h \
+    $$SOURCES_PATH/GUI/PanelTileCache.h \
+    $$SOURCES_PATH/GUI/RenderBench.h \
     $$SOURCES_PATH/GUI/mainwindow.h \
     $$SOURCES_PATH/GUI/preferences.h \
     $$SOURCES_PATH/GUI/Comments.h \
@@ -82,6 +86,10 @@ SOURCES += \
     $$SOURCES_PATH/GUI/FilesList.cpp \
     $$SOURCES_PATH/GUI/Help.cpp \
     $$SOURCES_PATH/GUI/Info.cpp \
+    $$SOURCES_PATH/GUI/MemoryView.cpp \
+    $$SOURCES_PATH/GUI/ParsingCounters.cpp \
+    $$SOURCES_PATH/GUI/PanelTileCache.cpp \
+    $$SOURCES_PATH/GUI/RenderBench.cpp \
     $$SOURCES_PATH/GUI/main.cpp \
     $$SOURCES_PATH/GUI/mainwindow.cpp \
     $$SOURCES_PATH/GUI/mainwindow_Callbacks.cpp \
@@ -105,7 +113,6 @@ SOURCES += \
     $$SOURCES_PATH/GUI/barchartprofilesmodel.cpp \
     $$SOURCES_PATH/GUI/player.cpp \
     $$SOURCES_PATH/GUI/doublespinboxwithslider.cpp \
-    $$SOURCES_PATH/GUI/filters.cpp \
     $$SOURCES_PATH/GUI/filterselector.cpp \
     $$SOURCES_PATH/GUI/playercontrol.cpp \
     $$SOURCES_PATH/GUI/panelsview.cpp \
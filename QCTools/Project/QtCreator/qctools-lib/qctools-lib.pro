@@ -1,9 +1,11 @@
-QT = core network multimedia concurrent
+QT = core network multimedia concurrent sql
 
 TARGET = qctools
 TEMPLATE = lib
 CONFIG += c++1z
 CONFIG += staticlib
+# Also linked in the shared library of qctools-capi
+unix:QMAKE_CXXFLAGS += -fPIC
 
 message('qctools-lib: including ffmpeg')
 include(../ffmpeg.pri)
@@ -19,50 +21,178 @@ INCLUDEPATH += $$SOURCES_PATH/ThirdParty/tinyxml2
 
 QMAKE_CXXFLAGS += -DWITH_SYSTEM_FFMPEG=1
 
+# Messages of the hot paths, see Core/Tracing.h (qmake CONFIG+=tracing)
+tracing: DEFINES += QCTOOLS_TRACING
+
 include(../zlib.pri)
 
 HEADERS = \
     $$SOURCES_PATH/ThirdParty/tinyxml2/tinyxml2.h \
+    $$SOURCES_PATH/Core/AnalysisProfiles.h \
+    $$SOURCES_PATH/Core/AnalyzerPlugin.h \
+    $$SOURCES_PATH/Core/AnalyzerPlugins.h \
     $$SOURCES_PATH/Core/AudioCore.h \
     $$SOURCES_PATH/Core/AudioStats.h \
+    $$SOURCES_PATH/Core/AudioStatsKernel.h \
     $$SOURCES_PATH/Core/CommonStats.h \
+    $$SOURCES_PATH/Core/ConditionExpression.h \
     $$SOURCES_PATH/Core/Core.h \
+    $$SOURCES_PATH/Core/CpuFeatures.h \
     $$SOURCES_PATH/Core/VideoCore.h \
     $$SOURCES_PATH/Core/VideoStats.h \
+    $$SOURCES_PATH/Core/ExportQueue.h \
     $$SOURCES_PATH/Core/FormatStats.h \
+    $$SOURCES_PATH/Core/FrameFeed.h \
+    $$SOURCES_PATH/Core/FrameSnapshots.h \
+    $$SOURCES_PATH/Core/CaptionsTimecode.h \
+    $$SOURCES_PATH/Core/TimeCode.h \
+    $$SOURCES_PATH/Core/ImageSequenceReader.h \
+    $$SOURCES_PATH/Core/KeyFrameThumbnails.h \
+    $$SOURCES_PATH/Core/MatroskaAttachment.h \
+    $$SOURCES_PATH/Core/MemoryBudget.h \
+    $$SOURCES_PATH/Core/MemoryPressure.h \
+    $$SOURCES_PATH/Core/NumaNodes.h \
+    $$SOURCES_PATH/Core/PacketStatsParser.h \
+    $$SOURCES_PATH/Core/ParsingScheduler.h \
+    $$SOURCES_PATH/Core/QCvaultIndex.h \
+    $$SOURCES_PATH/Core/GrowingFileDevice.h \
+    $$SOURCES_PATH/Core/PipeDevice.h \
+    $$SOURCES_PATH/Core/ReadaheadDevice.h \
+    $$SOURCES_PATH/Core/RemoteReport.h \
+    $$SOURCES_PATH/Core/ReportFrames.h \
+    $$SOURCES_PATH/Core/UringQueue.h \
     $$SOURCES_PATH/Core/CommonStreamStats.h \
     $$SOURCES_PATH/Core/AudioStreamStats.h \
     $$SOURCES_PATH/Core/VideoStreamStats.h \
     $$SOURCES_PATH/Core/StreamsStats.h \
+    $$SOURCES_PATH/Core/StatsXmlReader.h \
+    $$SOURCES_PATH/Core/StatsXmlWriter.h \
+    $$SOURCES_PATH/Core/StatsKeyIndex.h \
+    $$SOURCES_PATH/Core/StatsColdChunks.h \
+    $$SOURCES_PATH/Core/StatsColumn.h \
+    $$SOURCES_PATH/Core/StatsComments.h \
+    $$SOURCES_PATH/Core/StatsNumbers.h \
+    $$SOURCES_PATH/Core/StatsColumnsCache.h \
+    $$SOURCES_PATH/Core/StatsArrowReport.h \
+    $$SOURCES_PATH/Core/StatsColumnsReport.h \
+    $$SOURCES_PATH/Core/StatsCompression.h \
+    $$SOURCES_PATH/Core/StatsDatabase.h \
+    $$SOURCES_PATH/Core/StatsDetectors.h \
+    $$SOURCES_PATH/Core/StatsPyramid.h \
+    $$SOURCES_PATH/Core/StatsRangeIndex.h \
+    $$SOURCES_PATH/Core/StatsStrings.h \
+    $$SOURCES_PATH/Core/StatsThresholds.h \
+    $$SOURCES_PATH/Core/StatsWindow.h \
+    $$SOURCES_PATH/Core/StatsGzipMembers.h \
+    $$SOURCES_PATH/Core/StatsReportStream.h \
+    $$SOURCES_PATH/Core/StatsIngest.h \
+    $$SOURCES_PATH/Core/CaptureFrameRing.h \
+    $$SOURCES_PATH/Core/StatsProcessParser.h \
+    $$SOURCES_PATH/Core/StatsReanalysisParser.h \
+    $$SOURCES_PATH/Core/StatsSegmentParser.h \
+    $$SOURCES_PATH/Core/StatsShots.h \
+    $$SOURCES_PATH/Core/StatsSketch.h \
+    $$SOURCES_PATH/Core/FilterGraphPlan.h \
+    $$SOURCES_PATH/Core/PanelBuilder.h \
+    $$SOURCES_PATH/Core/PanelFrameStore.h \
+    $$SOURCES_PATH/Core/SignalStatsKernel.h \
+    $$SOURCES_PATH/Core/FieldCompareKernel.h \
+    $$SOURCES_PATH/Core/HdrLightKernel.h \
+    $$SOURCES_PATH/Core/KernelsBenchmark.h \
+    $$SOURCES_PATH/Core/ThumbnailSprites.h \
+    $$SOURCES_PATH/Core/ThumbnailStore.h \
     $$SOURCES_PATH/Core/Timecode.h \
     $$SOURCES_PATH/Core/FileInformation.h \
     $$SOURCES_PATH/Core/SignalServerConnectionChecker.h \
     $$SOURCES_PATH/Core/SignalServer.h \
     $$SOURCES_PATH/Core/Preferences.h \
     $$SOURCES_PATH/Core/FFmpegVideoEncoder.h \
-    $$SOURCES_PATH/Core/logging.h
+    $$SOURCES_PATH/Core/logging.h \
+    $$SOURCES_PATH/Core/TraceEvents.h \
+    $$SOURCES_PATH/Core/Tracing.h
 
 
 SOURCES = \
     $$SOURCES_PATH/ThirdParty/tinyxml2/tinyxml2.cpp \
+    $$SOURCES_PATH/Core/AnalysisProfiles.cpp \
+    $$SOURCES_PATH/Core/AnalyzerPlugins.cpp \
     $$SOURCES_PATH/Core/AudioCore.cpp \
     $$SOURCES_PATH/Core/AudioStats.cpp \
+    $$SOURCES_PATH/Core/AudioStatsKernel.cpp \
     $$SOURCES_PATH/Core/CommonStats.cpp \
+    $$SOURCES_PATH/Core/ConditionExpression.cpp \
     $$SOURCES_PATH/Core/Core.cpp \
+    $$SOURCES_PATH/Core/CpuFeatures.cpp \
     $$SOURCES_PATH/Core/VideoCore.cpp \
     $$SOURCES_PATH/Core/VideoStats.cpp \
+    $$SOURCES_PATH/Core/ExportQueue.cpp \
     $$SOURCES_PATH/Core/FormatStats.cpp \
+    $$SOURCES_PATH/Core/FrameFeed.cpp \
+    $$SOURCES_PATH/Core/FrameSnapshots.cpp \
+    $$SOURCES_PATH/Core/CaptionsTimecode.cpp \
+    $$SOURCES_PATH/Core/TimeCode.cpp \
+    $$SOURCES_PATH/Core/ImageSequenceReader.cpp \
+    $$SOURCES_PATH/Core/KeyFrameThumbnails.cpp \
+    $$SOURCES_PATH/Core/MatroskaAttachment.cpp \
+    $$SOURCES_PATH/Core/MemoryBudget.cpp \
+    $$SOURCES_PATH/Core/MemoryPressure.cpp \
+    $$SOURCES_PATH/Core/NumaNodes.cpp \
+    $$SOURCES_PATH/Core/PacketStatsParser.cpp \
+    $$SOURCES_PATH/Core/ParsingScheduler.cpp \
+    $$SOURCES_PATH/Core/QCvaultIndex.cpp \
+    $$SOURCES_PATH/Core/GrowingFileDevice.cpp \
+    $$SOURCES_PATH/Core/PipeDevice.cpp \
+    $$SOURCES_PATH/Core/ReadaheadDevice.cpp \
+    $$SOURCES_PATH/Core/RemoteReport.cpp \
+    $$SOURCES_PATH/Core/ReportFrames.cpp \
+    $$SOURCES_PATH/Core/UringQueue.cpp \
     $$SOURCES_PATH/Core/CommonStreamStats.cpp \
     $$SOURCES_PATH/Core/AudioStreamStats.cpp \
     $$SOURCES_PATH/Core/VideoStreamStats.cpp \
     $$SOURCES_PATH/Core/StreamsStats.cpp \
+    $$SOURCES_PATH/Core/StatsXmlReader.cpp \
+    $$SOURCES_PATH/Core/StatsXmlWriter.cpp \
+    $$SOURCES_PATH/Core/StatsKeyIndex.cpp \
+    $$SOURCES_PATH/Core/StatsColdChunks.cpp \
+    $$SOURCES_PATH/Core/StatsColumnsCache.cpp \
+    $$SOURCES_PATH/Core/StatsArrowReport.cpp \
+    $$SOURCES_PATH/Core/StatsColumnsReport.cpp \
+    $$SOURCES_PATH/Core/StatsCompression.cpp \
+    $$SOURCES_PATH/Core/StatsDatabase.cpp \
+    $$SOURCES_PATH/Core/StatsDetectors.cpp \
+    $$SOURCES_PATH/Core/StatsPyramid.cpp \
+    $$SOURCES_PATH/Core/StatsRangeIndex.cpp \
+    $$SOURCES_PATH/Core/StatsComments.cpp \
+    $$SOURCES_PATH/Core/StatsNumbers.cpp \
+    $$SOURCES_PATH/Core/StatsStrings.cpp \
+    $$SOURCES_PATH/Core/StatsThresholds.cpp \
+    $$SOURCES_PATH/Core/StatsWindow.cpp \
+    $$SOURCES_PATH/Core/StatsGzipMembers.cpp \
+    $$SOURCES_PATH/Core/StatsReportStream.cpp \
+    $$SOURCES_PATH/Core/StatsIngest.cpp \
+    $$SOURCES_PATH/Core/StatsProcessParser.cpp \
+    $$SOURCES_PATH/Core/StatsReanalysisParser.cpp \
+    $$SOURCES_PATH/Core/StatsSegmentParser.cpp \
+    $$SOURCES_PATH/Core/StatsShots.cpp \
+    $$SOURCES_PATH/Core/StatsSketch.cpp \
+    $$SOURCES_PATH/Core/FilterGraphPlan.cpp \
+    $$SOURCES_PATH/Core/PanelBuilder.cpp \
+    $$SOURCES_PATH/Core/PanelFrameStore.cpp \
+    $$SOURCES_PATH/Core/SignalStatsKernel.cpp \
+    $$SOURCES_PATH/Core/FieldCompareKernel.cpp \
+    $$SOURCES_PATH/Core/HdrLightKernel.cpp \
+    $$SOURCES_PATH/Core/KernelsBenchmark.cpp \
+    $$SOURCES_PATH/Core/ThumbnailSprites.cpp \
+    $$SOURCES_PATH/Core/ThumbnailStore.cpp \
     $$SOURCES_PATH/Core/Timecode.cpp \
     $$SOURCES_PATH/Core/FileInformation.cpp \
     $$SOURCES_PATH/Core/SignalServerConnectionChecker.cpp \
     $$SOURCES_PATH/Core/SignalServer.cpp \
     $$SOURCES_PATH/Core/Preferences.cpp \
     $$SOURCES_PATH/Core/FFmpegVideoEncoder.cpp \
-    $$SOURCES_PATH/Core/logging.cpp
+    $$SOURCES_PATH/Core/logging.cpp \
+    $$SOURCES_PATH/Core/TraceEvents.cpp \
+    $$SOURCES_PATH/Core/Tracing.cpp
 
 
 include($$SOURCES_PATH/ThirdParty/qblowfish/qblowfish.pri)
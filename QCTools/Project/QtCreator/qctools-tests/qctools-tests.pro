@@ -0,0 +1,56 @@
+message('entering qctools-tests.pro')
+
+QT += testlib
+QT -= gui
+
+CONFIG += c++1z
+CONFIG += testcase console
+CONFIG -= app_bundle
+
+TARGET = tst_signalstatskernel
+
+TEMPLATE = app
+
+SOURCES_PATH = $$PWD/../../../Source
+message("qctools: SOURCES_PATH = " $$absolute_path($$SOURCES_PATH))
+
+INCLUDEPATH += $$SOURCES_PATH
+
+# The kernel and its dependencies only, not the whole of qctools-lib
+HEADERS += $$SOURCES_PATH/Core/CpuFeatures.h \
+           $$SOURCES_PATH/Core/SignalStatsKernel.h
+
+SOURCES += $$SOURCES_PATH/Tests/tst_signalstatskernel.cpp \
+           $$SOURCES_PATH/Core/CpuFeatures.cpp \
+           $$SOURCES_PATH/Core/SignalStatsKernel.cpp
+
+include(../zlib.pri)
+win32 {
+    LIBS += -lbcrypt -lwsock32 -lws2_32 -lpsapi
+}
+
+!win32 {
+    LIBS      += -lbz2
+}
+
+unix {
+    LIBS       += -lz -ldl
+    !macx:LIBS += -lrt
+}
+
+macx:LIBS += -liconv \
+             -framework CoreFoundation \
+             -framework Foundation \
+             -framework AppKit \
+             -framework AudioToolbox \
+             -framework QuartzCore \
+             -framework CoreGraphics \
+             -framework CoreAudio \
+             -framework CoreVideo \
+             -framework OpenGL \
+             -framework VideoDecodeAcceleration
+
+message('qctools-tests: including ffmpeg')
+include(../ffmpeg.pri)
+
+message('leaving qctools-tests.pro')
@@ -103,3 +103,9 @@ macx:!isEmpty(USE_BREW):equals(USE_BREW, true) {
     isEmpty(QMAKE_POST_LINK): QMAKE_POST_LINK = $$qwtlibs.commands
     else: QMAKE_POST_LINK = $${QMAKE_POST_LINK}$$escape_expand(\\n\\t)$$qwtlibs.commands
 }
+
+# OpenGL canvas of the plots, see Plot::setOpenGLCanvas()
+contains(QWT_CONFIG, QwtOpenGL) {
+    DEFINES += QCTOOLS_QWT_OPENGL
+    greaterThan(QT_MAJOR_VERSION, 5): QT += openglwidgets
+}
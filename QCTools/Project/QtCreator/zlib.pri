@@ -35,3 +35,14 @@ win32 {
 unix {
     LIBS += -lz
 }
+
+# Optional compressors of the reports, see Core/StatsCompression.h (qmake CONFIG+=libdeflate CONFIG+=zstd)
+libdeflate {
+    DEFINES += QCTOOLS_LIBDEFLATE
+    LIBS += -ldeflate
+}
+
+zstd {
+    DEFINES += QCTOOLS_ZSTD
+    LIBS += -lzstd
+}
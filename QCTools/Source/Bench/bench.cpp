@@ -0,0 +1,377 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "bench.h"
+#include "Core/FileInformation.h"
+#include "Core/Preferences.h"
+#include "Core/SignalServer.h"
+#include "Core/StatsColumnsCache.h"
+#include "Core/UringQueue.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QSize>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <iostream>
+#include <memory>
+
+extern "C"
+{
+#include <libavutil/avutil.h>
+}
+
+#if defined(Q_OS_WIN)
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+//---------------------------------------------------------------------------
+// Of the process since its start, in MB
+static double peakRss()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage))
+        return 0;
+  #if defined(Q_OS_MACOS)
+    return usage.ru_maxrss / (1024.0 * 1024.0); // Bytes
+  #else
+    return usage.ru_maxrss / 1024.0; // KB
+  #endif
+#endif
+}
+
+//---------------------------------------------------------------------------
+static activefilters parseFilters(const QString& names)
+{
+    activefilters filters;
+    for(const auto& name : names.split('+'))
+        for(int filter = 0; filter < ActiveFilter_Max; ++filter)
+            if(name == ActiveFilter_Name((activefilter)filter))
+                filters.set(filter);
+
+    return filters;
+}
+
+//---------------------------------------------------------------------------
+static QJsonObject step(const QString& name, qint64 elapsed, qint64 frames, qint64 bytes)
+{
+    return QJsonObject {
+        {"step", name},
+        {"seconds", elapsed / 1000.0},
+        {"frames", frames},
+        {"bytes", bytes},
+    };
+}
+
+//---------------------------------------------------------------------------
+QJsonObject Bench::measureParse(const QString& input, const activefilters& filters, bool exports)
+{
+    SignalServer signalServer;
+    Preferences prefs;
+    QJsonArray steps;
+
+    QElapsedTimer timer;
+    timer.start();
+    std::unique_ptr<FileInformation> info(new FileInformation(&signalServer, input, filters, prefs.activeAllTracks(), prefs.getActivePanels(), QString()));
+    info->setAutoCheckFileUploaded(false);
+    info->setAutoUpload(false);
+    if(!info->isValid())
+        return QJsonObject {{"error", "invalid input"}};
+
+    QEventLoop loop;
+    bool success = false;
+    QObject::connect(info.get(), &FileInformation::parsingCompleted, &loop, [&](bool isOk) {
+        success = isOk;
+        loop.quit();
+    });
+    info->startParse();
+    if(!info->parsed())
+        loop.exec();
+    if(!success || !info->parsed())
+        return QJsonObject {{"error", "analyzing failed"}};
+    steps.append(step("parse", timer.elapsed(), info->Frames_Count_Get(), QFileInfo(input).size()));
+
+    if(exports)
+    {
+        // Synchronous, the file is sent by statsFileGenerated()
+        QString report = input + ".qctools.xml.gz";
+        QFile::remove(report);
+        timer.restart();
+        info->Export_XmlGz(report, filters);
+        steps.append(step("export_xml_gz", timer.elapsed(), info->Frames_Count_Get(), QFileInfo(report).size()));
+
+        QFile file(report);
+        if(!file.open(QIODevice::ReadOnly))
+            return QJsonObject {{"error", "report can not be read"}};
+        QByteArray attachment = file.readAll();
+
+        QString mkvReport = input + ".qctools.mkv";
+        QFile::remove(mkvReport);
+        timer.restart();
+        info->makeMkvReport(mkvReport, attachment, QFileInfo(report).fileName(), [](int, int) {
+            QCoreApplication::processEvents();
+        });
+        steps.append(step("make_mkv_report", timer.elapsed(), info->thumbnailsCount(), QFileInfo(mkvReport).size()));
+    }
+
+    return QJsonObject {{"steps", steps}};
+}
+
+//---------------------------------------------------------------------------
+QJsonObject Bench::measureReload(const QString& report, const activefilters& filters)
+{
+    SignalServer signalServer;
+    Preferences prefs;
+
+    // The columns cache would be used instead of the report
+    QFile::remove(StatsColumnsCache::FileName(report));
+
+    QElapsedTimer timer;
+    timer.start();
+    std::unique_ptr<FileInformation> info(new FileInformation(&signalServer, report, filters, prefs.activeAllTracks(), prefs.getActivePanels(), QString()));
+    info->setAutoCheckFileUploaded(false);
+    info->setAutoUpload(false);
+    if(!info->hasStats())
+        return QJsonObject {{"error", "report can not be read"}};
+
+    return QJsonObject {{"steps", QJsonArray {step("reload", timer.elapsed(), info->Frames_Count_Get(), QFileInfo(report).size())}}};
+}
+
+//---------------------------------------------------------------------------
+QJsonObject Bench::run(const QStringList& arguments)
+{
+    QProcess process;
+    process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    process.start(QCoreApplication::applicationFilePath(), QStringList() << "--measure" << arguments);
+    if(!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit)
+        return QJsonObject {{"error", "measure crashed"}};
+
+    // Last line, the libraries may write before
+    auto lines = process.readAllStandardOutput().trimmed().split('\n');
+    auto document = QJsonDocument::fromJson(lines.last());
+    if(!document.isObject())
+        return QJsonObject {{"error", "no result"}};
+
+    return document.object();
+}
+
+//---------------------------------------------------------------------------
+void Bench::append(const Generator::Input& input, const QString& filters, const QJsonObject& measure)
+{
+    if(measure.contains("error"))
+    {
+        results.append(QJsonObject {{"input", input.toJson()}, {"filters", filters}, {"error", measure.value("error")}});
+        std::cerr << input.name().toStdString() << " " << filters.toStdString() << ": " << measure.value("error").toString().toStdString() << std::endl;
+        return;
+    }
+
+    for(const auto& item : measure.value("steps").toArray())
+    {
+        auto result = item.toObject();
+        double seconds = result.value("seconds").toDouble();
+        result.insert("input", input.toJson());
+        result.insert("filters", filters);
+        result.insert("frames_per_second", seconds > 0 ? result.value("frames").toDouble() / seconds : 0);
+        result.insert("megabytes_per_second", seconds > 0 ? result.value("bytes").toDouble() / (1024 * 1024) / seconds : 0);
+        result.insert("peak_rss_mb", measure.value("peak_rss_mb"));
+        result.insert("io", measure.value("io").toString("read"));
+        results.append(result);
+
+        std::cerr << input.name().toStdString() << " " << filters.toStdString() << " " << result.value("step").toString().toStdString()
+                  << " (" << result.value("io").toString().toStdString() << "): " << seconds << " s, "
+                  << result.value("frames_per_second").toDouble() << " frames/s" << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------------
+int Bench::exec(QCoreApplication& a)
+{
+    // Child process, one step
+    auto arguments = a.arguments();
+    int measure = arguments.indexOf("--measure");
+    if(measure > 0 && measure + 3 < arguments.size())
+    {
+        QString step = arguments.at(measure + 1);
+        QString input = arguments.at(measure + 2);
+        activefilters filters = parseFilters(arguments.at(measure + 3));
+        QString io = measure + 4 < arguments.size() ? arguments.at(measure + 4) : QString("read");
+        UringQueue::Enabled_Set(io == "uring");
+        if(io == "uring" && !UringQueue::IsAvailable())
+        {
+            std::cout << QJsonDocument(QJsonObject {{"error", "io_uring is not available"}, {"io", io}}).toJson(QJsonDocument::Compact).constData() << std::endl;
+            return 1;
+        }
+
+        QJsonObject result = step == "reload" ? measureReload(input, filters) : measureParse(input, filters, step == "export");
+        result.insert("peak_rss_mb", peakRss());
+        result.insert("io", io);
+        std::cout << QJsonDocument(result).toJson(QJsonDocument::Compact).constData() << std::endl;
+        return result.contains("error") ? 1 : 0;
+    }
+
+    QList<QSize> sizes = { QSize(720, 486), QSize(1920, 1080) };
+    QList<int> depths = { 8, 10 };
+    QList<int> durations = { 10 };
+    QString output;
+    QString codec = Generator::Input().codec;
+    QStringList ios = { "read" };
+    bool keep = false;
+    for(int i = 1; i < arguments.size(); ++i)
+    {
+        auto list = [&]() { return (i + 1) < arguments.size() ? arguments.at(++i).split(',') : QStringList(); };
+        if(arguments.at(i) == "-o" && (i + 1) < arguments.size())
+            output = arguments.at(++i);
+        else if(arguments.at(i) == "--sizes")
+        {
+            sizes.clear();
+            for(const auto& item : list())
+                sizes.append(QSize(item.section('x', 0, 0).toInt(), item.section('x', 1, 1).toInt()));
+        }
+        else if(arguments.at(i) == "--depths")
+        {
+            depths.clear();
+            for(const auto& item : list())
+                depths.append(item.toInt());
+        }
+        else if(arguments.at(i) == "--durations")
+        {
+            durations.clear();
+            for(const auto& item : list())
+                durations.append(item.toInt());
+        }
+        else if(arguments.at(i) == "--filters")
+            filterNames = list();
+        else if(arguments.at(i) == "--io")
+            ios = list();
+        else if(arguments.at(i) == "--codec" && (i + 1) < arguments.size())
+            codec = arguments.at(++i);
+        else if(arguments.at(i) == "--work-dir" && (i + 1) < arguments.size())
+            workDirectory = arguments.at(++i);
+        else if(arguments.at(i) == "--keep")
+            keep = true;
+        else
+        {
+            std::cout << "Usage: qctools-bench [options]" << std::endl
+                      << "-o <file>" << std::endl
+                      << "    Write the JSON results in this file instead of stdout." << std::endl
+                      << "--sizes <WxH,...>" << std::endl
+                      << "    Sizes of the generated inputs. Default is 720x486,1920x1080." << std::endl
+                      << "--depths <bits,...>" << std::endl
+                      << "    Bit depths of the generated inputs (yuv422p). Default is 8,10." << std::endl
+                      << "--durations <seconds,...>" << std::endl
+                      << "    Durations of the generated inputs. Default is 10." << std::endl
+                      << "--filters <name,...>" << std::endl
+                      << "    Filters parsed alone (names of the -f option of qcli). Default is all of them." << std::endl
+                      << "    Parsing with all of them, the exports and the reload are always measured." << std::endl
+                      << "--io <read,uring>" << std::endl
+                      << "    Readers of the inputs parsed with all the filters (see --io of qcli). Default is read." << std::endl
+                      << "--codec <encoder[:option=value...]>" << std::endl
+                      << "    Encoder of the video of the generated inputs. Default is " << Generator::Input().codec.toStdString() << "." << std::endl
+                      << "--work-dir <directory>" << std::endl
+                      << "    Directory of the inputs and reports, a temporary directory by default." << std::endl
+                      << "--keep" << std::endl
+                      << "    Keep the inputs and reports." << std::endl;
+            return 1;
+        }
+    }
+
+    QStringList allNames;
+    for(int filter = 0; filter < ActiveFilter_Max; ++filter)
+        allNames.append(ActiveFilter_Name((activefilter)filter));
+    if(filterNames.isEmpty())
+        filterNames = allNames;
+
+    std::unique_ptr<QTemporaryDir> temporaryDirectory;
+    if(workDirectory.isEmpty())
+    {
+        temporaryDirectory.reset(new QTemporaryDir);
+        temporaryDirectory->setAutoRemove(!keep);
+        workDirectory = temporaryDirectory->path();
+    }
+    QDir().mkpath(workDirectory);
+
+    for(const auto& size : sizes)
+        for(int depth : depths)
+            for(int duration : durations)
+            {
+                Generator::Input input;
+                input.width = size.width();
+                input.height = size.height();
+                input.depth = depth;
+                input.duration = duration;
+                input.codec = codec;
+                inputs.append(input);
+            }
+
+    for(const auto& input : inputs)
+    {
+        QString fileName = QDir(workDirectory).filePath(input.name() + ".mkv");
+        std::cerr << "generating " << fileName.toStdString() << std::endl;
+        QString error = Generator::make(input, fileName);
+        if(!error.isEmpty())
+        {
+            append(input, QString(), QJsonObject {{"error", error}});
+            continue;
+        }
+
+        for(const auto& name : filterNames)
+            append(input, name, run(QStringList() << "parse" << fileName << name));
+
+        QString all = allNames.join('+');
+        for(const auto& io : ios)
+            if(io != "read")
+                append(input, all, run(QStringList() << "parse" << fileName << all << io));
+        append(input, all, run(QStringList() << "export" << fileName << all));
+        append(input, all, run(QStringList() << "reload" << fileName + ".qctools.xml.gz" << all));
+
+        if(!keep)
+            for(const auto& suffix : { "", ".qctools.xml.gz", ".qctools.mkv" })
+                QFile::remove(fileName + suffix);
+    }
+
+    QJsonObject document {
+        {"ffmpeg", av_version_info()},
+        {"qt", qVersion()},
+        {"os", QSysInfo::prettyProductName()},
+        {"cpu", QSysInfo::currentCpuArchitecture()},
+        {"threads", QThread::idealThreadCount()},
+        {"results", results},
+    };
+    auto json = QJsonDocument(document).toJson();
+    if(output.isEmpty())
+    {
+        std::cout << json.constData();
+    }
+    else
+    {
+        QFile file(output);
+        if(!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+        {
+            std::cerr << output.toStdString() << " can not be written" << std::endl;
+            return 1;
+        }
+    }
+
+    for(const auto& result : results)
+        if(result.toObject().contains("error"))
+            return 1;
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef BENCH_H
+#define BENCH_H
+//---------------------------------------------------------------------------
+
+#include "Core/Core.h"
+#include "generator.h"
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVector>
+
+//---------------------------------------------------------------------------
+// Throughput of the analysis, for tracking regressions between releases.
+//
+// Synthetic inputs are generated for each size, bit depth and duration, then
+// each step is run by a process of its own so its peak memory is its own one:
+// parsing with each filter alone and with all of them, the export to
+// .qctools.xml.gz and to .qctools.mkv, and the reload of the report. Results
+// are written as JSON (seconds, frames/s, MB/s, peak RSS).
+class Bench
+{
+public:
+    int exec(QCoreApplication& a);
+
+private:
+    // Steps run by the child processes, the result is printed as one JSON line
+    QJsonObject measureParse(const QString& input, const activefilters& filters, bool exports);
+    QJsonObject measureReload(const QString& report, const activefilters& filters);
+
+    // Runs a step in a child process, with its arguments
+    QJsonObject run(const QStringList& arguments);
+    void append(const Generator::Input& input, const QString& filters, const QJsonObject& measure);
+
+    QVector<Generator::Input> inputs;
+    QStringList filterNames; // Each one alone, then all of them
+    QString workDirectory;
+    QJsonArray results;
+};
+
+#endif // BENCH_H
@@ -0,0 +1,245 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "generator.h"
+#include "Core/FFmpegVideoEncoder.h"
+#include <QStringList>
+#include <memory>
+
+extern "C"
+{
+#include <libavutil/channel_layout.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+}
+
+//---------------------------------------------------------------------------
+QString Generator::Input::name() const
+{
+    return QString("%1x%2_%3bit_%4s").arg(width).arg(height).arg(depth).arg(duration);
+}
+
+//---------------------------------------------------------------------------
+QJsonObject Generator::Input::toJson() const
+{
+    return QJsonObject {
+        {"width", width},
+        {"height", height},
+        {"depth", depth},
+        {"duration", duration},
+        {"rate", QString("%1/%2").arg(rateNum).arg(rateDen)},
+        {"channels", channels},
+        {"codec", codec},
+    };
+}
+
+//---------------------------------------------------------------------------
+namespace
+{
+struct output
+{
+    AVFilterContext*            sink {nullptr};
+    AVCodecContext*             codec {nullptr};
+    AVStream*                   stream {nullptr};
+    int64_t                     pts {0};            // Of the last frame, in the time base of the sink
+    bool                        done {false};
+};
+
+struct job
+{
+    AVFilterGraph*              graph {nullptr};
+    AVFormatContext*            format {nullptr};
+    output                      outputs[2];         // Video, audio
+    AVFrame*                    frame {nullptr};
+    AVPacket*                   packet {nullptr};
+
+    ~job()
+    {
+        for(auto& output : outputs)
+            avcodec_free_context(&output.codec);
+        if(format && format->pb)
+            avio_closep(&format->pb);
+        avformat_free_context(format);
+        avfilter_graph_free(&graph);
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+    }
+};
+
+QString errorString(int error)
+{
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {};
+    av_strerror(error, buffer, sizeof(buffer));
+    return QString::fromUtf8(buffer);
+}
+
+QString channelLayout(int channels)
+{
+    char buffer[64] = {};
+#if LIBAVUTIL_VERSION_INT <= AV_VERSION_INT(57, 23, 0)
+    av_get_channel_layout_string(buffer, sizeof(buffer), channels, av_get_default_channel_layout(channels));
+#else
+    AVChannelLayout layout;
+    av_channel_layout_default(&layout, channels);
+    av_channel_layout_describe(&layout, buffer, sizeof(buffer));
+    av_channel_layout_uninit(&layout);
+#endif
+    return QString::fromUtf8(buffer);
+}
+
+// Packets of the frame (nullptr flushes the encoder) written to the file
+int encode(job& Job, output& Output, AVFrame* frame)
+{
+    int result = avcodec_send_frame(Output.codec, frame);
+    while(result >= 0)
+    {
+        result = avcodec_receive_packet(Output.codec, Job.packet);
+        if(result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+            return 0;
+        if(result < 0)
+            break;
+
+        av_packet_rescale_ts(Job.packet, Output.codec->time_base, Output.stream->time_base);
+        Job.packet->stream_index = Output.stream->index;
+        result = av_interleaved_write_frame(Job.format, Job.packet);
+    }
+    return result;
+}
+}
+
+//---------------------------------------------------------------------------
+QString Generator::make(const Input& input, const QString& fileName)
+{
+    job Job;
+    Job.frame = av_frame_alloc();
+    Job.packet = av_packet_alloc();
+
+    // One graph with both sources, frames are pulled from its 2 sinks
+    QString pixelFormat = input.depth > 8 ? QString("yuv422p%1le").arg(input.depth) : QString("yuv422p");
+    QStringList sines;
+    for(int channel = 0; channel < input.channels; ++channel)
+        sines.append(QString("0.5*sin(%1*2*PI*t)").arg(1000 + channel * 100));
+    QString description = QString("testsrc2=size=%1x%2:rate=%3/%4:duration=%5,format=%6 [video]; "
+                                  "aevalsrc=%7:sample_rate=48000:channel_layout=%8:duration=%5,aformat=sample_fmts=s32 [audio]")
+            .arg(input.width).arg(input.height).arg(input.rateNum).arg(input.rateDen).arg(input.duration).arg(pixelFormat)
+            .arg(sines.join('|')).arg(channelLayout(input.channels));
+
+    Job.graph = avfilter_graph_alloc();
+    AVFilterInOut* inputs = nullptr;
+    AVFilterInOut* outputs = nullptr;
+    int result = avfilter_graph_parse2(Job.graph, description.toUtf8().constData(), &inputs, &outputs);
+    avfilter_inout_free(&inputs);
+    if(result < 0)
+    {
+        avfilter_inout_free(&outputs);
+        return "invalid filter graph: " + errorString(result);
+    }
+
+    int index = 0;
+    for(auto item = outputs; item && index < 2; item = item->next, ++index)
+    {
+        auto& Output = Job.outputs[index];
+        const char* sink = avfilter_pad_get_type(item->filter_ctx->output_pads, item->pad_idx) == AVMEDIA_TYPE_VIDEO ? "buffersink" : "abuffersink";
+        result = avfilter_graph_create_filter(&Output.sink, avfilter_get_by_name(sink), item->name, nullptr, nullptr, Job.graph);
+        if(result >= 0)
+            result = avfilter_link(item->filter_ctx, item->pad_idx, Output.sink, 0);
+        if(result < 0)
+            break;
+    }
+    avfilter_inout_free(&outputs);
+    if(result >= 0)
+        result = avfilter_graph_config(Job.graph, nullptr);
+    if(result < 0)
+        return "filter graph can not be configured: " + errorString(result);
+
+    result = avformat_alloc_output_context2(&Job.format, nullptr, "matroska", fileName.toUtf8().constData());
+    if(result < 0)
+        return "matroska muxer: " + errorString(result);
+
+    // Video as the encoders of the reports, audio as PCM
+    auto videoCodec = FFmpegVideoEncoder::Codec::parse(input.codec);
+    for(auto& Output : Job.outputs)
+    {
+        bool isVideo = av_buffersink_get_type(Output.sink) == AVMEDIA_TYPE_VIDEO;
+        const AVCodec* codec = isVideo ? videoCodec.encoder() : avcodec_find_encoder(AV_CODEC_ID_PCM_S24LE);
+        if(!codec)
+            return QString("no %1 encoder").arg(isVideo ? videoCodec.name : QString("pcm_s24le"));
+
+        Output.codec = avcodec_alloc_context3(codec);
+        Output.codec->time_base = av_buffersink_get_time_base(Output.sink);
+        if(isVideo)
+        {
+            Output.codec->width = av_buffersink_get_w(Output.sink);
+            Output.codec->height = av_buffersink_get_h(Output.sink);
+            Output.codec->pix_fmt = (AVPixelFormat) av_buffersink_get_format(Output.sink);
+            Output.codec->framerate = av_buffersink_get_frame_rate(Output.sink);
+            Output.codec->sample_aspect_ratio = av_buffersink_get_sample_aspect_ratio(Output.sink);
+        }
+        else
+        {
+            Output.codec->sample_fmt = (AVSampleFormat) av_buffersink_get_format(Output.sink);
+            Output.codec->sample_rate = av_buffersink_get_sample_rate(Output.sink);
+#if LIBAVUTIL_VERSION_INT <= AV_VERSION_INT(57, 23, 0)
+            Output.codec->channel_layout = av_buffersink_get_channel_layout(Output.sink);
+            Output.codec->channels = av_buffersink_get_channels(Output.sink);
+#else
+            av_buffersink_get_ch_layout(Output.sink, &Output.codec->ch_layout);
+#endif
+        }
+        if(Job.format->oformat->flags & AVFMT_GLOBALHEADER)
+            Output.codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+        // pix_fmt of the codec option is not used, frames are in the format of the graph
+        AVDictionary* options = isVideo ? videoCodec.dictionary() : nullptr;
+        result = avcodec_open2(Output.codec, codec, &options);
+        av_dict_free(&options);
+        if(result < 0)
+            return QString("%1 encoder can not be opened: %2").arg(codec->name).arg(errorString(result));
+
+        Output.stream = avformat_new_stream(Job.format, nullptr);
+        avcodec_parameters_from_context(Output.stream->codecpar, Output.codec);
+        Output.stream->time_base = Output.codec->time_base;
+    }
+
+    result = avio_open(&Job.format->pb, fileName.toUtf8().constData(), AVIO_FLAG_WRITE);
+    if(result >= 0)
+        result = avformat_write_header(Job.format, nullptr);
+    if(result < 0)
+        return QString("%1 can not be written: %2").arg(fileName).arg(errorString(result));
+
+    // The output the most behind is pulled, the muxer interleaves a few frames only
+    for(;;)
+    {
+        output* next = nullptr;
+        for(auto& Output : Job.outputs)
+            if(!Output.done && (!next || av_compare_ts(Output.pts, Output.codec->time_base, next->pts, next->codec->time_base) < 0))
+                next = &Output;
+        if(!next)
+            break;
+
+        result = av_buffersink_get_frame(next->sink, Job.frame);
+        if(result == AVERROR_EOF)
+        {
+            next->done = true;
+            result = encode(Job, *next, nullptr);
+        }
+        else if(result >= 0)
+        {
+            next->pts = Job.frame->pts;
+            result = encode(Job, *next, Job.frame);
+            av_frame_unref(Job.frame);
+        }
+        if(result < 0)
+            return QString("%1 can not be written: %2").arg(fileName).arg(errorString(result));
+    }
+
+    result = av_write_trailer(Job.format);
+    if(result < 0)
+        return QString("%1 can not be written: %2").arg(fileName).arg(errorString(result));
+
+    return QString();
+}
@@ -0,0 +1,41 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef GENERATOR_H
+#define GENERATOR_H
+//---------------------------------------------------------------------------
+
+#include <QJsonObject>
+#include <QString>
+
+//---------------------------------------------------------------------------
+// Synthetic inputs of the benchmark: testsrc2 video and a sine per audio
+// channel, made by libavfilter and encoded in Matroska, so the same input
+// is made on every machine without a sample file.
+class Generator
+{
+public:
+    struct Input
+    {
+        int                     width {1920};
+        int                     height {1080};
+        int                     depth {8};          // Bits per sample of yuv422p
+        int                     duration {10};      // Seconds
+        int                     rateNum {30000};
+        int                     rateDen {1001};
+        int                     channels {2};
+        QString                 codec {"ffv1:level=3:slices=16:threads=0"}; // See FFmpegVideoEncoder::Codec
+
+        QString                 name() const;       // "1920x1080_8bit_10s"
+        QJsonObject             toJson() const;
+    };
+
+    // Empty if the file is written, else the reason
+    static QString make(const Input& input, const QString& fileName);
+};
+
+#endif // GENERATOR_H
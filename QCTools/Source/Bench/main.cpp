@@ -0,0 +1,27 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+#include <QCoreApplication>
+#include "bench.h"
+
+// suppress debug output
+void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    Q_UNUSED(type);
+    Q_UNUSED(context);
+    Q_UNUSED(msg);
+}
+
+int main(int argc, char *argv[])
+{
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+
+    qInstallMessageHandler(messageHandler);
+    QCoreApplication a(argc, argv);
+
+    Bench bench;
+    return bench.exec(a);
+}
@@ -0,0 +1,208 @@
+"""In-process analysis with qctools-lib, through the C interface of libqctools_c.
+
+    with qctools.File("input.mkv", filters="signalstats+cropdetect") as f:
+        f.run(progress=lambda parsed: print(f"{parsed:.0%}"))
+        yavg = f.array(0, "lavfi.signalstats.YAVG")
+        summary = f.summary(0, "lavfi.signalstats.YAVG")
+
+Values are NumPy arrays. chunks() gives views on the memory of the analysis
+without copy, valid while the file is open; array() concatenates them.
+
+The library is searched as QCTOOLS_C_LIBRARY, then next to this module, then
+in the paths of the system.
+"""
+
+import ctypes
+import ctypes.util
+import os
+
+import numpy as np
+
+VERSION = 1
+
+OK = 0
+ERROR_ARGUMENT = -1
+ERROR_INPUT = -2
+ERROR_PARSING = -3
+
+STREAM_NONE = -1
+STREAM_VIDEO = 0
+STREAM_AUDIO = 1
+
+
+class Error(Exception):
+    def __init__(self, code, message):
+        super().__init__(message or f"error {code}")
+        self.code = code
+
+
+class _Summary(ctypes.Structure):
+    _fields_ = [
+        ("frozen", ctypes.c_int),
+        ("frames", ctypes.c_uint64),
+        ("min", ctypes.c_double),
+        ("max", ctypes.c_double),
+        ("mean", ctypes.c_double),
+        ("stddev", ctypes.c_double),
+        ("above", ctypes.c_uint64),
+        ("above2", ctypes.c_uint64),
+        ("p5", ctypes.c_double),
+        ("median", ctypes.c_double),
+        ("p95", ctypes.c_double),
+    ]
+
+
+_PROGRESS = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_double, ctypes.c_void_p)
+_library = None
+
+
+def _load():
+    global _library
+    if _library is not None:
+        return _library
+
+    names = [os.environ.get("QCTOOLS_C_LIBRARY")]
+    here = os.path.dirname(os.path.abspath(__file__))
+    for name in ("libqctools_c.so", "libqctools_c.dylib", "qctools_c.dll"):
+        names.append(os.path.join(here, name))
+    names.append(ctypes.util.find_library("qctools_c"))
+    for name in names:
+        if name and (os.path.exists(name) or not os.path.dirname(name)):
+            lib = ctypes.CDLL(name)
+            break
+    else:
+        raise OSError("libqctools_c not found, set QCTOOLS_C_LIBRARY")
+
+    file_p = ctypes.c_void_p
+    double_p = ctypes.POINTER(ctypes.c_double)
+    for name, restype, argtypes in (
+        ("qctools_version", ctypes.c_int, []),
+        ("qctools_new", file_p, []),
+        ("qctools_free", None, [file_p]),
+        ("qctools_error", ctypes.c_char_p, [file_p]),
+        ("qctools_set_filters", ctypes.c_int, [file_p, ctypes.c_char_p]),
+        ("qctools_open", ctypes.c_int, [file_p, ctypes.c_char_p]),
+        ("qctools_run", ctypes.c_int, [file_p, _PROGRESS, ctypes.c_void_p]),
+        ("qctools_streams_count", ctypes.c_int, [file_p]),
+        ("qctools_stream_type", ctypes.c_int, [file_p, ctypes.c_int]),
+        ("qctools_frames_count", ctypes.c_size_t, [file_p, ctypes.c_int]),
+        ("qctools_items_count", ctypes.c_int, [file_p, ctypes.c_int]),
+        ("qctools_item_name", ctypes.c_char_p, [file_p, ctypes.c_int, ctypes.c_int]),
+        ("qctools_item_find", ctypes.c_int, [file_p, ctypes.c_int, ctypes.c_char_p]),
+        ("qctools_chunk_size", ctypes.c_size_t, []),
+        ("qctools_item_chunk", double_p, [file_p, ctypes.c_int, ctypes.c_int, ctypes.c_size_t]),
+        ("qctools_item_copy", ctypes.c_size_t, [file_p, ctypes.c_int, ctypes.c_int, ctypes.c_size_t, ctypes.c_size_t, double_p]),
+        ("qctools_time_chunk", double_p, [file_p, ctypes.c_int, ctypes.c_size_t]),
+        ("qctools_item_summary", ctypes.c_int, [file_p, ctypes.c_int, ctypes.c_int, ctypes.POINTER(_Summary)]),
+    ):
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+
+    if lib.qctools_version() < VERSION:
+        raise OSError(f"libqctools_c version {lib.qctools_version()}, {VERSION} needed")
+    _library = lib
+    return lib
+
+
+class File:
+    """Analysis of one file, its stats are parsed by run() if it has none."""
+
+    def __init__(self, path, filters=None):
+        self._lib = _load()
+        self._file = self._lib.qctools_new()
+        try:
+            if filters is not None:
+                self._check(self._lib.qctools_set_filters(self._file, filters.encode()))
+            self._check(self._lib.qctools_open(self._file, os.fsencode(path)))
+        except Exception:
+            self.close()
+            raise
+        self._chunk_size = self._lib.qctools_chunk_size()
+
+    def close(self):
+        if self._file:
+            self._lib.qctools_free(self._file)
+            self._file = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def _check(self, code):
+        if code < 0:
+            raise Error(code, self._lib.qctools_error(self._file).decode(errors="replace"))
+
+    def run(self, progress=None):
+        """Blocks until parsed; progress(parsed) from 0 to 1, returning True cancels."""
+        callback = _PROGRESS(lambda parsed, opaque: 1 if progress(parsed) else 0) if progress else _PROGRESS()
+        self._check(self._lib.qctools_run(self._file, callback, None))
+
+    # Streams
+
+    def streams(self):
+        """Indexes of the streams with stats."""
+        return [s for s in range(self._lib.qctools_streams_count(self._file))
+                if self._lib.qctools_stream_type(self._file, s) != STREAM_NONE]
+
+    def stream_type(self, stream):
+        return self._lib.qctools_stream_type(self._file, stream)
+
+    def frames_count(self, stream):
+        return self._lib.qctools_frames_count(self._file, stream)
+
+    # Items
+
+    def items(self, stream):
+        """Names of the items of the stream, as the keys of the XML report."""
+        names = (self._lib.qctools_item_name(self._file, stream, i)
+                 for i in range(self._lib.qctools_items_count(self._file, stream)))
+        return [n.decode() for n in names if n]
+
+    def _item(self, stream, item):
+        if isinstance(item, str):
+            index = self._lib.qctools_item_find(self._file, stream, item.encode())
+            if index < 0:
+                raise KeyError(item)
+            return index
+        return item
+
+    # Values
+
+    def _chunk_lengths(self, frames):
+        for chunk in range((frames + self._chunk_size - 1) // self._chunk_size):
+            yield chunk, min(self._chunk_size, frames - chunk * self._chunk_size)
+
+    def chunks(self, stream, item):
+        """Views of the values by chunk, copies of them if the storage is compact."""
+        item = self._item(stream, item)
+        for chunk, length in self._chunk_lengths(self.frames_count(stream)):
+            pointer = self._lib.qctools_item_chunk(self._file, stream, item, chunk)
+            if pointer:
+                yield np.ctypeslib.as_array(pointer, shape=(length,))
+            else:
+                values = np.empty(length, dtype=np.float64)
+                self._lib.qctools_item_copy(self._file, stream, item, chunk * self._chunk_size, length,
+                                            values.ctypes.data_as(ctypes.POINTER(ctypes.c_double)))
+                yield values
+
+    def array(self, stream, item):
+        """Values of all the frames."""
+        values = list(self.chunks(stream, item))
+        return np.concatenate(values) if values else np.empty(0, dtype=np.float64)
+
+    def times(self, stream):
+        """Presentation times of the frames in seconds."""
+        values = [np.ctypeslib.as_array(self._lib.qctools_time_chunk(self._file, stream, chunk), shape=(length,))
+                  for chunk, length in self._chunk_lengths(self.frames_count(stream))]
+        return np.concatenate(values) if values else np.empty(0, dtype=np.float64)
+
+    def summary(self, stream, item):
+        summary = _Summary()
+        self._check(self._lib.qctools_item_summary(self._file, stream, self._item(stream, item), ctypes.byref(summary)))
+        return {name: getattr(summary, name) for name, _ in _Summary._fields_}
@@ -0,0 +1,358 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "CApi/qctools_c.h"
+#include "Core/CommonStats.h"
+#include "Core/FileInformation.h"
+#include "Core/Preferences.h"
+#include "Core/SignalServer.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+
+//---------------------------------------------------------------------------
+struct qctools_file
+{
+    SignalServer                signalServer;               // Not used, no upload
+    Preferences                 prefs;
+    activefilters               filters;
+    std::unique_ptr<FileInformation> info;
+    bool                        isCancelled {false};
+    std::string                 error;
+};
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+typedef StatsColumn<double> column;
+
+//---------------------------------------------------------------------------
+int Error(const qctools_file* file, int code, const char* message)
+{
+    const_cast<qctools_file*>(file)->error=message;
+    return code;
+}
+
+//---------------------------------------------------------------------------
+// Created on the first call if the process has none (not a Qt application)
+void Application_Create()
+{
+    if (QCoreApplication::instance())
+        return;
+
+    qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
+    static int argc=1;
+    static char Name[]="qctools";
+    static char* argv[]={Name, nullptr};
+    new QCoreApplication(argc, argv);
+}
+
+//---------------------------------------------------------------------------
+// NULL if the file is not open or the stream has no stats
+CommonStats* Stream_Get(const qctools_file* file, int stream)
+{
+    if (!file || !file->info || stream<0 || stream>=(int)file->info->Stats.size())
+        return nullptr;
+    return file->info->Stats[stream];
+}
+
+//---------------------------------------------------------------------------
+size_t Items_Count(CommonStats* Stat)
+{
+    int Type=Stat->Type_Get();
+    if (Type<0 || Type>=Type_Max)
+        return 0;
+    return PerStreamType[Type].CountOfItems;
+}
+
+//---------------------------------------------------------------------------
+// With the values of the item read if they are read on their first use
+CommonStats* Item_Get(const qctools_file* file, int stream, int item)
+{
+    auto Stat=Stream_Get(file, stream);
+    if (!Stat || item<0 || (size_t)item>=Items_Count(Stat))
+        return nullptr;
+    Stat->Item_Require(item);
+    return Stat;
+}
+
+//---------------------------------------------------------------------------
+// Chunks with frames, the last one is the frame count rounded up
+bool Chunk_IsValid(CommonStats* Stat, size_t chunk)
+{
+    return chunk<((Stat->x_Current_Get()+column::Chunk_Mask)>>column::Chunk_Shift);
+}
+
+}
+
+//***************************************************************************
+// Lifetime
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int qctools_version(void)
+{
+    return QCTOOLS_C_VERSION;
+}
+
+//---------------------------------------------------------------------------
+qctools_file* qctools_new(void)
+{
+    Application_Create();
+
+    auto file=new qctools_file;
+    file->filters=file->prefs.activeFilters();
+    return file;
+}
+
+//---------------------------------------------------------------------------
+void qctools_free(qctools_file* file)
+{
+    delete file;
+}
+
+//---------------------------------------------------------------------------
+const char* qctools_error(const qctools_file* file)
+{
+    return file?file->error.c_str():"";
+}
+
+//***************************************************************************
+// Configuration
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int qctools_set_filters(qctools_file* file, const char* filters)
+{
+    if (!file || file->info)
+        return QCTOOLS_ERROR_ARGUMENT;
+    if (!filters)
+    {
+        file->filters=file->prefs.activeFilters();
+        return QCTOOLS_OK;
+    }
+
+    // Unknown names are errors, not silently ignored
+    activefilters Filters;
+    for (const auto& Name : QString::fromUtf8(filters).split('+'))
+    {
+        if (Name.isEmpty())
+            continue;
+        int Filter=0;
+        while (Filter<ActiveFilter_Max && Name!=ActiveFilter_Name((activefilter)Filter))
+            Filter++;
+        if (Filter==ActiveFilter_Max)
+            return Error(file, QCTOOLS_ERROR_ARGUMENT, "unknown filter");
+        Filters.set(Filter);
+    }
+    file->filters=Filters;
+    return QCTOOLS_OK;
+}
+
+//***************************************************************************
+// Analysis
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int qctools_open(qctools_file* file, const char* path)
+{
+    if (!file || file->info || !path)
+        return QCTOOLS_ERROR_ARGUMENT;
+
+    file->info.reset(new FileInformation(&file->signalServer, QString::fromUtf8(path), file->filters, file->prefs.activeAllTracks(), file->prefs.getActivePanels(), QString()));
+    file->info->setAutoCheckFileUploaded(false);
+    file->info->setAutoUpload(false);
+    if (!file->info->isValid())
+    {
+        file->info.reset();
+        return Error(file, QCTOOLS_ERROR_INPUT, "invalid input");
+    }
+    file->error.clear();
+    return QCTOOLS_OK;
+}
+
+//---------------------------------------------------------------------------
+int qctools_run(qctools_file* file, qctools_progress progress, void* opaque)
+{
+    if (!file || !file->info || file->isCancelled)
+        return QCTOOLS_ERROR_ARGUMENT;
+    FileInformation* info=file->info.get();
+    if (info->hasStats() || info->parsed())
+        return QCTOOLS_OK;
+
+    QEventLoop Loop;
+    bool IsOk=false;
+    QObject::connect(info, &FileInformation::parsingCompleted, &Loop, [&](bool Success) {
+        IsOk=Success;
+        Loop.quit();
+    });
+
+    // The parsing continues in the background once cancelled, until the file is freed
+    QTimer Timer;
+    if (progress)
+    {
+        QObject::connect(&Timer, &QTimer::timeout, &Loop, [&]() {
+            auto Stat=info->ReferenceStat();
+            if (progress(Stat?Stat->State_Get():0, opaque))
+            {
+                file->isCancelled=true;
+                Loop.quit();
+            }
+        });
+        Timer.start(250);
+    }
+
+    info->startParse();
+    if (!info->parsed())
+        Loop.exec();
+    Timer.stop();
+
+    if (file->isCancelled)
+        return Error(file, QCTOOLS_ERROR_PARSING, "analyzing cancelled");
+    if (!IsOk || !info->parsed())
+        return Error(file, QCTOOLS_ERROR_PARSING, "analyzing failed");
+    if (progress)
+        progress(1, opaque);
+    return QCTOOLS_OK;
+}
+
+//***************************************************************************
+// Streams
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int qctools_streams_count(const qctools_file* file)
+{
+    return file && file->info?(int)file->info->Stats.size():0;
+}
+
+//---------------------------------------------------------------------------
+int qctools_stream_type(const qctools_file* file, int stream)
+{
+    auto Stat=Stream_Get(file, stream);
+    if (!Stat)
+        return QCTOOLS_STREAM_NONE;
+    switch (Stat->Type_Get())
+    {
+        case Type_Video : return QCTOOLS_STREAM_VIDEO;
+        case Type_Audio : return QCTOOLS_STREAM_AUDIO;
+        default         : return QCTOOLS_STREAM_NONE;
+    }
+}
+
+//---------------------------------------------------------------------------
+size_t qctools_frames_count(const qctools_file* file, int stream)
+{
+    auto Stat=Stream_Get(file, stream);
+    return Stat?Stat->x_Current_Get():0;
+}
+
+//***************************************************************************
+// Items
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int qctools_items_count(const qctools_file* file, int stream)
+{
+    auto Stat=Stream_Get(file, stream);
+    return Stat?(int)Items_Count(Stat):0;
+}
+
+//---------------------------------------------------------------------------
+const char* qctools_item_name(const qctools_file* file, int stream, int item)
+{
+    auto Stat=Stream_Get(file, stream);
+    if (!Stat || item<0 || (size_t)item>=Items_Count(Stat))
+        return nullptr;
+    return PerStreamType[Stat->Type_Get()].PerItem[item].FFmpeg_Name;
+}
+
+//---------------------------------------------------------------------------
+int qctools_item_find(const qctools_file* file, int stream, const char* name)
+{
+    auto Stat=Stream_Get(file, stream);
+    if (!Stat || !name)
+        return -1;
+    size_t Count=Items_Count(Stat);
+    const per_item* PerItem=PerStreamType[Stat->Type_Get()].PerItem;
+    for (size_t Pos=0; Pos<Count; Pos++)
+        if (PerItem[Pos].FFmpeg_Name && !strcmp(PerItem[Pos].FFmpeg_Name, name))
+            return (int)Pos;
+    return -1;
+}
+
+//***************************************************************************
+// Values
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+size_t qctools_chunk_size(void)
+{
+    return column::Chunk_Size;
+}
+
+//---------------------------------------------------------------------------
+const double* qctools_item_chunk(qctools_file* file, int stream, int item, size_t chunk)
+{
+    auto Stat=Item_Get(file, stream, item);
+    if (!Stat || !Chunk_IsValid(Stat, chunk))
+        return nullptr;
+    return Stat->y[item].DoubleChunk(chunk);
+}
+
+//---------------------------------------------------------------------------
+size_t qctools_item_copy(qctools_file* file, int stream, int item, size_t first, size_t count, double* values)
+{
+    auto Stat=Item_Get(file, stream, item);
+    if (!Stat || !values)
+        return 0;
+    size_t Frames=Stat->x_Current_Get();
+    if (first>=Frames)
+        return 0;
+    count=std::min(count, Frames-first);
+    const StatsValueColumn& Column=Stat->y[item];
+    for (size_t Pos=0; Pos<count; Pos++)
+        values[Pos]=Column.Get(first+Pos);
+    return count;
+}
+
+//---------------------------------------------------------------------------
+const double* qctools_time_chunk(qctools_file* file, int stream, size_t chunk)
+{
+    auto Stat=Stream_Get(file, stream);
+    if (!Stat || !Chunk_IsValid(Stat, chunk))
+        return nullptr;
+    return Stat->x[1].Chunk(chunk);
+}
+
+//---------------------------------------------------------------------------
+int qctools_item_summary(qctools_file* file, int stream, int item, qctools_summary* summary)
+{
+    auto Stat=Item_Get(file, stream, item);
+    if (!Stat || !summary)
+        return QCTOOLS_ERROR_ARGUMENT;
+
+    auto Summary=Stat->Summary_Get(item);
+    summary->frozen=Summary.Frozen;
+    summary->frames=Summary.Frames;
+    summary->min=Summary.Min;
+    summary->max=Summary.Max;
+    summary->mean=Summary.Mean;
+    summary->stddev=Summary.StdDev;
+    summary->above=Summary.Above;
+    summary->above2=Summary.Above2;
+    summary->p5=Summary.P5;
+    summary->median=Summary.Median;
+    summary->p95=Summary.P95;
+    return QCTOOLS_OK;
+}
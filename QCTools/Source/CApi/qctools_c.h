@@ -0,0 +1,130 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef QCTOOLS_C_H
+#define QCTOOLS_C_H
+//---------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+//---------------------------------------------------------------------------
+// C interface of the analysis, for using it in-process (e.g. from Python with
+// ctypes, see python/qctools.py) instead of running qcli and reading its
+// report.
+//
+// A file is created, its filters configured, it is opened (a media file,
+// or a .qctools.xml.gz / .qctools.mkv report) then run: the stats are
+// parsed if the file has none. The values of each item of each stream are
+// then read from the memory of the analysis, by chunks of
+// qctools_chunk_size() frames which stay valid until the file is freed, or
+// copied as double values.
+//
+// All the functions are called from one thread, the one of the first call:
+// the Qt application of the process is created there if there is none yet
+// and its event loop runs during qctools_run(). Functions returning an int
+// return QCTOOLS_OK or a negative error, see qctools_error() for the
+// message.
+
+#if defined(_WIN32)
+    #if defined(QCTOOLS_C_BUILD)
+        #define QCTOOLS_C_API __declspec(dllexport)
+    #else
+        #define QCTOOLS_C_API __declspec(dllimport)
+    #endif
+#else
+    #define QCTOOLS_C_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Incremented when the functions change, the existing ones are kept
+#define QCTOOLS_C_VERSION 1
+
+enum
+{
+    QCTOOLS_OK                  = 0,
+    QCTOOLS_ERROR_ARGUMENT      = -1,   // Invalid file, stream, item or state
+    QCTOOLS_ERROR_INPUT         = -2,   // File can not be opened
+    QCTOOLS_ERROR_PARSING       = -3,   // Analysis failed or cancelled
+};
+
+enum
+{
+    QCTOOLS_STREAM_NONE         = -1,   // Without stats
+    QCTOOLS_STREAM_VIDEO        = 0,
+    QCTOOLS_STREAM_AUDIO        = 1,
+};
+
+typedef struct qctools_file qctools_file;
+
+// Whole stream summary of an item, see CommonStats::Summary_Get()
+typedef struct qctools_summary
+{
+    int                         frozen;                     // 0 while parsing
+    uint64_t                    frames;                     // With a finite value
+    double                      min;
+    double                      max;
+    double                      mean;
+    double                      stddev;
+    uint64_t                    above;                      // Frames over the default limit of the item
+    uint64_t                    above2;                     // Frames over its second limit
+    double                      p5;
+    double                      median;
+    double                      p95;
+} qctools_summary;
+
+// Called while running with the parsed part of the file, from 0 to 1; a non 0 return cancels the analysis
+typedef int (*qctools_progress)(double parsed, void* opaque);
+
+QCTOOLS_C_API int               qctools_version             (void);
+
+// Lifetime
+QCTOOLS_C_API qctools_file*     qctools_new                 (void);
+QCTOOLS_C_API void              qctools_free                (qctools_file* file);
+// Message of the last error of the file, empty if none; valid until the next call with the file
+QCTOOLS_C_API const char*       qctools_error               (const qctools_file* file);
+
+// Configuration, before qctools_open(): filters are names as in the -f option of qcli separated by '+'
+// (e.g. "signalstats+cropdetect"), NULL for the filters of the preferences
+QCTOOLS_C_API int               qctools_set_filters         (qctools_file* file, const char* filters);
+
+// Analysis, path in UTF-8
+QCTOOLS_C_API int               qctools_open                (qctools_file* file, const char* path);
+// Blocks until the stats are parsed, progress may be NULL
+QCTOOLS_C_API int               qctools_run                 (qctools_file* file, qctools_progress progress, void* opaque);
+
+// Streams, by stream index of the file
+QCTOOLS_C_API int               qctools_streams_count       (const qctools_file* file);
+QCTOOLS_C_API int               qctools_stream_type         (const qctools_file* file, int stream);
+QCTOOLS_C_API size_t            qctools_frames_count        (const qctools_file* file, int stream);
+
+// Items of a stream, named as the keys of the frames of the XML report (e.g. "lavfi.signalstats.YAVG")
+QCTOOLS_C_API int               qctools_items_count         (const qctools_file* file, int stream);
+QCTOOLS_C_API const char*       qctools_item_name           (const qctools_file* file, int stream, int item);
+// -1 if the stream has no item with this name
+QCTOOLS_C_API int               qctools_item_find           (const qctools_file* file, int stream, const char* name);
+
+// Values by chunks: chunk N has the frames from N*qctools_chunk_size(), the last one is not full (see qctools_frames_count)
+QCTOOLS_C_API size_t            qctools_chunk_size          (void);
+// NULL if the values are not stored as double (compact storage) or not stored yet (no value written, read as zero),
+// they are then read with qctools_item_copy()
+QCTOOLS_C_API const double*     qctools_item_chunk          (qctools_file* file, int stream, int item, size_t chunk);
+// Frames from first to first+count, returns the count of values written to values
+QCTOOLS_C_API size_t            qctools_item_copy           (qctools_file* file, int stream, int item, size_t first, size_t count, double* values);
+// Presentation time of the frames in seconds
+QCTOOLS_C_API const double*     qctools_time_chunk          (qctools_file* file, int stream, size_t chunk);
+
+QCTOOLS_C_API int               qctools_item_summary        (qctools_file* file, int stream, int item, qctools_summary* summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // QCTOOLS_C_H
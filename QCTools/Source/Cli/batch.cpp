@@ -0,0 +1,699 @@
+#include "batch.h"
+#include "cli.h"
+#include "Core/NumaNodes.h"
+#include "Core/QCvaultIndex.h"
+#include "Core/StatsCompression.h"
+#include "Core/StatsDatabase.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+static QStringList HardwareDevices;
+static int HardwareSessions = 0;
+
+// Node and device of a file for its players created meanwhile
+struct placementScope
+{
+    placementScope(int node, const QString& device)
+    {
+        if(node >= 0)
+            FileInformation::NumaNode_Set(node);
+        FileInformation::HardwareDevice_Set(device);
+    }
+    ~placementScope()
+    {
+        FileInformation::NumaNode_Set(-1);
+        FileInformation::HardwareDevice_Set(QString());
+    }
+};
+
+Batch::Batch(int jobs, bool numa)
+{
+    pipelines = jobs > 0 ? jobs : std::max(1, QThread::idealThreadCount() / 2);
+
+    // The pool is the limit, files must not wait again once started
+    FileInformation::ParsingMax_Set(pipelines);
+
+    // Pipelines split between the nodes, at least one each
+    const auto& numaNodes = NumaNodes::Get();
+    if(numa && numaNodes.size() > 1)
+    {
+        int count = std::min((int)numaNodes.size(), pipelines);
+        for(int index = 0; index < count; ++index)
+        {
+            node Node;
+            Node.index = index;
+            Node.pipelines = pipelines / count + (index < pipelines % count ? 1 : 0);
+            nodes.push_back(Node);
+        }
+    }
+
+    // Sessions split between the devices as the pipelines, at least one each
+    int count = (int)HardwareDevices.size();
+    for(int index = 0; index < count; ++index)
+    {
+        device Device;
+        Device.name = HardwareDevices[index];
+        Device.sessions = HardwareSessions > 0 ? HardwareSessions : std::max(1, pipelines / count + (index < pipelines % count ? 1 : 0));
+        devices.push_back(Device);
+    }
+
+    connect(&progressTimer, &QTimer::timeout, this, &Batch::updateProgress);
+}
+
+Batch::~Batch()
+{
+    prepared.clear();
+    jobs.clear();
+    FileInformation::ParsingMax_Set(0);
+}
+
+QStringList Batch::nodesSummary() const
+{
+    QStringList lines;
+    for(const auto& Node : nodes)
+        lines.append(QString("node %1: %2 pipelines, %3 files, %4 s of parsing").arg(Node.index).arg(Node.pipelines).arg(Node.files).arg(Node.parsingTime / 1000.0, 0, 'f', 1));
+    for(const auto& Device : devices)
+        lines.append(QString("device %1: %2 sessions, %3 files").arg(Device.name).arg(Device.sessions).arg(Device.files));
+    if(!devices.empty())
+        lines.append(QString("software decoding: %1 files").arg(softwareFiles));
+    return lines;
+}
+
+void Batch::setHardwareDevices(const QStringList& names, int sessions)
+{
+    HardwareDevices = names;
+    HardwareSessions = sessions;
+}
+
+// Label value, backslashes, quotes and line feeds escaped
+static QByteArray metricsLabel(const QString& value)
+{
+    QByteArray result = value.toUtf8();
+    result.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return result;
+}
+
+QByteArray Batch::metrics() const
+{
+    QByteArray result;
+    auto family = [&](const char* name, const char* type, const char* help) {
+        result += QByteArray("# TYPE ") + name + ' ' + type + "\n# HELP " + name + ' ' + help + '\n';
+    };
+    auto sample = [&](const QByteArray& name, const QByteArray& labels, double value) {
+        result += name + (labels.isEmpty() ? QByteArray() : '{' + labels + '}') + ' ' + QByteArray::number(value, 'g', 17) + '\n';
+    };
+
+    int running = 0, paused = 0, exporting = 0;
+    for(const auto& Job : jobs)
+    {
+        if(Job->paused)
+            ++paused;
+        else if(Job->pipelines)
+            ++running;
+        else
+            ++exporting;
+    }
+    family("qctools_jobs", "gauge", "Files of the batch by state.");
+    sample("qctools_jobs", "state=\"queued\"", (double)requests.size());
+    sample("qctools_jobs", "state=\"running\"", running);
+    sample("qctools_jobs", "state=\"paused\"", paused);
+    sample("qctools_jobs", "state=\"exporting\"", exporting);
+    family("qctools_jobs_finished", "counter", "Files finished by status.");
+    sample("qctools_jobs_finished_total", "status=\"success\"", inputsDone - inputsFailed);
+    sample("qctools_jobs_finished_total", "status=\"failed\"", inputsFailed);
+    family("qctools_pipelines", "gauge", "Pipelines of the pool by state.");
+    sample("qctools_pipelines", "state=\"used\"", pipelinesUsed);
+    sample("qctools_pipelines", "state=\"free\"", pipelines - pipelinesUsed);
+    if(!devices.empty())
+    {
+        family("qctools_device_sessions", "gauge", "Decoder sessions of each hardware device by state.");
+        for(const auto& Device : devices)
+        {
+            QByteArray label = "device=\"" + metricsLabel(Device.name) + "\",";
+            sample("qctools_device_sessions", label + "state=\"used\"", Device.sessionsUsed);
+            sample("qctools_device_sessions", label + "state=\"free\"", Device.sessions - Device.sessionsUsed);
+        }
+        family("qctools_software_decoding", "counter", "Files decoded in software, the hardware devices being saturated.");
+        sample("qctools_software_decoding_total", "", softwareFiles);
+    }
+
+    // Counters read once per file, the families are written one after the other
+    struct item
+    {
+        QByteArray labels;
+        FileInformation::ParsingCounters counters;
+    };
+    std::vector<item> items;
+    for(const auto& Job : jobs)
+    {
+        if(!Job->pipelines)
+            continue;
+        int width = Job->info->width(), height = Job->info->height();
+        auto codec = Job->info->videoCodec();
+        item Item;
+        Item.labels = "job=\"" + metricsLabel(Job->Request.id.isEmpty() ? Job->Request.input : Job->Request.id) + "\","
+            "input=\"" + metricsLabel(QFileInfo(Job->Request.input).fileName()) + "\","
+            "codec=\"" + metricsLabel(codec.isEmpty() ? QString("none") : codec) + "\","
+            "resolution=\"" + (width && height ? QByteArray::number(width) + 'x' + QByteArray::number(height) : QByteArray("none")) + '"';
+        Item.counters = Job->info->parsingCounters();
+        items.push_back(std::move(Item));
+    }
+    auto perJob = [&](const char* name, const char* type, const char* help, const QByteArray& suffix, const QByteArray& labels,
+                      const std::function<double(const FileInformation::ParsingCounters&)>& value) {
+        if(help)
+            family(name, type, help);
+        for(const auto& Item : items)
+            sample(name + suffix, labels.isEmpty() ? Item.labels : Item.labels + ',' + labels, value(Item.counters));
+    };
+    typedef const FileInformation::ParsingCounters& counters;
+    perJob("qctools_job_elapsed_seconds", "gauge", "Time since the parsing started.", "", "", [](counters c) { return c.Elapsed / 1000.0; });
+    perJob("qctools_job_fps", "gauge", "Video frames decoded by second since the parsing started.", "", "", [](counters c) {
+        return c.Elapsed > 0 ? c.VideoFrames * 1000.0 / c.Elapsed : 0;
+    });
+    perJob("qctools_job_frames", "counter", "Frames decoded.", "_total", "media=\"video\"", [](counters c) { return (double)c.VideoFrames; });
+    perJob("qctools_job_frames", "counter", nullptr, "_total", "media=\"audio\"", [](counters c) { return (double)c.AudioFrames; });
+    perJob("qctools_job_read_bytes", "counter", "Bytes of packets demuxed.", "_total", "", [](counters c) { return (double)c.DemuxedBytes; });
+    perJob("qctools_job_decode_seconds", "counter", "Time spent decoding.", "_total", "media=\"video\"", [](counters c) { return c.VideoDecodeTime / 1000.0; });
+    perJob("qctools_job_decode_seconds", "counter", nullptr, "_total", "media=\"audio\"", [](counters c) { return c.AudioDecodeTime / 1000.0; });
+    family("qctools_job_filter_seconds", "counter", "Time spent in each filter graph.");
+    for(const auto& Item : items)
+        for(auto Graph = Item.counters.FilterTimes.begin(); Graph != Item.counters.FilterTimes.end(); ++Graph)
+            sample("qctools_job_filter_seconds_total", Item.labels + ",graph=\"" + metricsLabel(Graph.key()) + '"', Graph.value() / 1000.0);
+    perJob("qctools_job_backpressure_seconds", "counter", "Time the demuxer waited for room in full packet queues, and the decoders for packets.",
+           "_total", "stage=\"demuxer\"", [](counters c) { return c.DemuxerStallTime / 1000.0; });
+    perJob("qctools_job_backpressure_seconds", "counter", nullptr, "_total", "stage=\"decoder\"", [](counters c) { return c.DecoderStallTime / 1000.0; });
+    perJob("qctools_job_queue_bytes", "gauge", "Bytes of the packets queued.", "", "media=\"video\"", [](counters c) { return (double)c.VideoQueueBytes; });
+    perJob("qctools_job_queue_bytes", "gauge", nullptr, "", "media=\"audio\"", [](counters c) { return (double)c.AudioQueueBytes; });
+    perJob("qctools_job_memory_bytes", "gauge", "Memory by part of the file.", "", "subsystem=\"stats\"", [](counters c) { return (double)c.Memory.Stats; });
+    perJob("qctools_job_memory_bytes", "gauge", nullptr, "", "subsystem=\"thumbnails\"", [](counters c) { return (double)c.Memory.Thumbnails; });
+    perJob("qctools_job_memory_bytes", "gauge", nullptr, "", "subsystem=\"panels\"", [](counters c) { return (double)c.Memory.Panels; });
+    perJob("qctools_job_memory_bytes", "gauge", nullptr, "", "subsystem=\"packet_queues\"", [](counters c) { return (double)c.Memory.PacketQueues; });
+    perJob("qctools_job_memory_bytes", "gauge", nullptr, "", "subsystem=\"decoded_frames\"", [](counters c) { return (double)c.Memory.DecodedFrames; });
+
+    // Frame buffers are shared by the decoders of all files
+    if(!items.empty())
+    {
+        const auto& first = items.front().counters;
+        family("qctools_frame_buffers_bytes", "gauge", "Planes of the video decoders of all files.");
+        sample("qctools_frame_buffers_bytes", "", (double)first.FrameBuffersBytes);
+        family("qctools_frame_buffers", "counter", "Planes of the video decoders allocated, and reused from the pool.");
+        sample("qctools_frame_buffers_total", "state=\"allocated\"", (double)first.FrameBuffers);
+        sample("qctools_frame_buffers_total", "state=\"reused\"", (double)first.FrameBuffersReused);
+    }
+
+    result += "# EOF\n";
+    return result;
+}
+
+void Batch::add(const QString& input, const Options& options, const QString& output, const QString& id)
+{
+    request Request;
+    Request.id = id;
+    Request.input = input;
+    Request.output = output;
+    Request.options = options;
+    Request.queued.start();
+    Request.serial = ++serials;
+    requests.push_back(Request);
+    ++inputsCount;
+
+    next();
+}
+
+int Batch::exec()
+{
+    if(inputsDone < inputsCount)
+        loop.exec();
+
+    return error;
+}
+
+activefilters Batch::parseFilters(const QStringList& names, activefilters filters)
+{
+    if(!names.empty())
+    {
+        filters = 0;
+        foreach(QString filterString, names)
+        {
+            for(int filter = 0; filter < ActiveFilter_Max; ++filter)
+                if(filterString == ActiveFilter_Name((activefilter)filter))
+                    filters |= 1 << filter;
+        }
+    }
+
+    return filters;
+}
+
+int Batch::budget(int width, int height, const activefilters& filters)
+{
+    double cost = 1.0;
+    for(int filter = 0; filter < ActiveFilter_Max; ++filter)
+        if(filters.test(filter))
+            cost += ActiveFilter_Cost((activefilter)filter);
+
+    // Audio only files are cheap
+    double pixels = double(width) * height / (1920 * 1080);
+    if(pixels <= 0)
+        return 1;
+
+    return std::max(1, (int)std::lround(pixels * cost));
+}
+
+int Batch::priorityFromName(const QString& name)
+{
+    static const char* const names[] = {"low", "normal", "high"};
+    for(int priority = Priority_Low; priority <= Priority_High; ++priority)
+        if(name == QLatin1String(names[priority]))
+            return priority;
+    return -1;
+}
+
+void Batch::next()
+{
+    // Opening a file runs an event loop, files ended meanwhile are replaced by the current loop
+    if(starting)
+        return;
+
+    // A file larger than the free part of the pool uses what is free, it is not kept waiting
+    // Highest priority first, in request order; a paused file goes before the files of its priority not started, with
+    // all its pipelines (or alone), and a full pool pauses a file of a lower priority
+    starting = true;
+    for(;;)
+    {
+        auto Request = std::max_element(requests.begin(), requests.end(), [](const request& a, const request& b) {
+            return a.options.priority < b.options.priority;
+        });
+        job* Paused = nullptr;
+        for(const auto& Job : jobs)
+            if(Job->paused && (!Paused || Job->Request.options.priority > Paused->Request.options.priority))
+                Paused = Job.get();
+        if(Paused && Request != requests.end() && Paused->Request.options.priority < Request->options.priority)
+            Paused = nullptr;
+        if(!Paused && Request == requests.end())
+            break;
+
+        int priority = Paused ? Paused->Request.options.priority : Request->options.priority;
+        bool fits = Paused ? !pipelinesUsed || pipelinesUsed + Paused->pipelines <= pipelines : pipelinesUsed < pipelines;
+        if(!fits)
+        {
+            if(pause(priority))
+                continue;
+            break;
+        }
+
+        if(Paused)
+            resume(Paused);
+        else
+        {
+            request Next = *Request;
+            requests.erase(Request);
+            start(Next);
+        }
+    }
+    prepareAhead();
+    starting = false;
+
+    if(jobs.empty())
+        progressTimer.stop();
+    else if(!progressTimer.isActive())
+        progressTimer.start(500);
+
+    if(inputsDone == inputsCount)
+        loop.quit();
+}
+
+void Batch::prepareAhead()
+{
+    if(!nodes.empty() || lookahead <= 0)
+        return;
+
+    // The next requests in the order they are started, see next()
+    std::vector<request*> order;
+    for(auto& Request : requests)
+        order.push_back(&Request);
+    std::stable_sort(order.begin(), order.end(), [](const request* a, const request* b) {
+        return a->options.priority > b->options.priority;
+    });
+    if((int)order.size() > lookahead)
+        order.resize(lookahead);
+
+    // Requests not analyzed (report already there, invalid output...) have their result now
+    std::vector<quint64> done;
+    for(auto Request : order)
+    {
+        if(prepared.count(Request->serial))
+            continue;
+        auto Job = prepare(*Request, true);
+        if(Job)
+            prepared[Request->serial] = std::move(Job);
+        else
+            done.push_back(Request->serial);
+    }
+    requests.remove_if([&](const request& Request) {
+        return std::find(done.begin(), done.end(), Request.serial) != done.end();
+    });
+}
+
+std::unique_ptr<Batch::job> Batch::prepare(const request& Request, bool ahead)
+{
+    const QString& input = Request.input;
+    const Options& options = Request.options;
+
+    QString output = Request.output;
+    if(input.endsWith(".qctools.xml.gz") || input.endsWith(".qctools.xml.zst") || input.endsWith(".qctools.mkv") || input.endsWith(".qctools.columns"))
+    {
+        result(Request, QString(), InvalidInput, "already a QCTools report, skipped");
+        return nullptr;
+    }
+
+    // Same content already analyzed with at least these filters, whatever its name
+    QByteArray fingerprint;
+    if(!options.useQCvault.isEmpty())
+    {
+        fingerprint = QCvaultIndex::Fingerprint(input);
+        auto indexed = options.forceOutput ? QString() : QCvaultIndex::Find(options.useQCvault, fingerprint, options.filters);
+        if(!indexed.isEmpty())
+        {
+            result(Request, indexed, Success, "stats already in QCvault");
+            return nullptr;
+        }
+    }
+
+    QString QCvaultFileName;
+    if(!options.useQCvault.isEmpty())
+        QCvaultFileName = prefs.createQCvaultFileNameString(input);
+    bool outputInQCvault = false;
+    if(output.isEmpty() && !options.useQCvault.isEmpty())
+    {
+        auto fileNameQCvault = prefs.createQCvaultFileNameString(input, options.useQCvault);
+        if(fileNameQCvault.isEmpty())
+        {
+            result(Request, QString(), InvalidInput, "problem while creating output file name");
+            return nullptr;
+        }
+
+        output = fileNameQCvault + (options.createMkv ? ".qctools.mkv" : StatsCompression::Extension(StatsCompression::Format_Get()));
+        if(!QFileInfo(output).dir().mkpath("."))
+        {
+            result(Request, QString(), InvalidInput, "can not create output directory");
+            return nullptr;
+        }
+        outputInQCvault = true;
+    }
+    else if(output.isEmpty())
+        output = input + (options.createMkv ? ".qctools.mkv" : StatsCompression::Extension(StatsCompression::Format_Get()));
+
+    QFile file(output);
+    if(file.exists() && !options.forceOutput)
+    {
+        result(Request, output, OutputAlreadyExists, "output already exists");
+        return nullptr;
+    }
+    if(file.exists())
+        file.remove();
+
+    std::unique_ptr<job> Job(new job);
+    Job->Request = Request;
+    Job->Request.output = output;
+    Job->mkvReport = output.endsWith(".qctools.mkv");
+    if(outputInQCvault && !std::isfinite(options.start) && !std::isfinite(options.end))
+        Job->fingerprint = fingerprint; // Reports of a range are not indexed
+
+    // Node with the most free pipelines, its threads are bound while the players of the file are created
+    if(!nodes.empty())
+    {
+        auto Node = std::max_element(nodes.begin(), nodes.end(), [](const node& a, const node& b) {
+            return a.pipelines - a.pipelinesUsed < b.pipelines - b.pipelinesUsed;
+        });
+        Job->node = (int)(Node - nodes.begin());
+    }
+
+    // Device with the most free sessions, software decoding if none is free; the decoder of the parser opened ahead
+    // holds a session until the file is started
+    QString deviceName;
+    if(!devices.empty())
+    {
+        auto Device = std::max_element(devices.begin(), devices.end(), [](const device& a, const device& b) {
+            return a.sessions - a.sessionsUsed < b.sessions - b.sessionsUsed;
+        });
+        if(Device->sessionsUsed < Device->sessions)
+        {
+            Job->device = (int)(Device - devices.begin());
+            Job->sessions = 1;
+            Device->sessionsUsed += Job->sessions;
+            deviceName = Device->name;
+        }
+        else
+            deviceName = "none";
+    }
+    placementScope PlacementScope(Job->node >= 0 ? nodes[Job->node].index : -1, deviceName);
+
+    // Opened ahead without blocking and not parsed until started
+    Job->info.reset(new FileInformation(&signalServer, input, options.filters, options.activeAllTracks, prefs.getActivePanels(), QCvaultFileName, 0, !ahead));
+    Job->info->setAutoCheckFileUploaded(false);
+    Job->info->setAutoUpload(false);
+    if(ahead)
+        Job->info->open(false);
+    return Job;
+}
+
+void Batch::start(const request& Request)
+{
+    const Options& options = Request.options;
+
+    std::unique_ptr<job> Job;
+    auto Prepared = prepared.find(Request.serial);
+    if(Prepared != prepared.end())
+    {
+        Job = std::move(Prepared->second);
+        prepared.erase(Prepared);
+
+        // Still probing, the files ended meanwhile are replaced by the current loop (see next())
+        if(!Job->info->isOpened())
+        {
+            QEventLoop opening;
+            connect(Job->info.get(), &FileInformation::opened, &opening, &QEventLoop::quit);
+            opening.exec();
+        }
+    }
+    else
+        Job = prepare(Request, false);
+    if(!Job)
+        return;
+    const QString& input = Request.input;
+    const QString& output = Job->Request.output;
+
+    if(!Job->info->isValid())
+    {
+        releaseSessions(Job.get());
+        result(Request, output, InvalidInput, "invalid input");
+        return;
+    }
+
+    if(Job->info->hasStats() && !options.forceOutput)
+    {
+        releaseSessions(Job.get());
+        result(Request, input, Success, "stats already generated");
+        return;
+    }
+
+    // Thumbnails and panels need the whole file in one pipeline
+    int segments = options.segments > 0 ? options.segments : budget(Job->info->width(), Job->info->height(), options.filters);
+    segments = std::min(segments, Job->node >= 0 ? nodes[Job->node].pipelines - nodes[Job->node].pipelinesUsed : pipelines - pipelinesUsed);
+    // One decoder session per segment, with the one already held by the file
+    if(Job->device >= 0)
+        segments = std::max(1, std::min(segments, devices[Job->device].sessions - devices[Job->device].sessionsUsed + Job->sessions));
+    bool range = std::isfinite(options.start) || std::isfinite(options.end);
+    if(range)
+        Job->info->setParsingRange(options.start, options.end);
+    Job->info->setParsingSegments(Job->mkvReport || range ? 1 : segments);
+
+    auto JobPointer = Job.get();
+    connect(Job->info.get(), &FileInformation::parsingCompleted, this, [this, JobPointer](bool success) {
+        // Not in the middle of a signal of the parser, it may be deleted
+        QMetaObject::invokeMethod(this, [this, JobPointer, success]() {
+            parsed(JobPointer, success);
+        }, Qt::QueuedConnection);
+    });
+
+    if(options.streamExport && !Job->info->setStreamExport(Job->mkvReport ? QString() : output, options.filters))
+        Q_EMIT warning(Request.id, "stats report can not be written while analyzing, it will be written after");
+    {
+        // Players of the segments are created when the parsing starts
+        placementScope PlacementScope(Job->node >= 0 ? nodes[Job->node].index : -1,
+                                      Job->device >= 0 ? devices[Job->device].name : devices.empty() ? QString() : QString("none"));
+        Job->info->startParse();
+    }
+
+    Job->pipelines = Job->info->parsingSegments();
+    if(Job->device >= 0)
+    {
+        devices[Job->device].sessionsUsed += Job->pipelines - Job->sessions;
+        Job->sessions = Job->pipelines;
+        ++devices[Job->device].files;
+    }
+    else if(!devices.empty())
+        ++softwareFiles;
+    pipelinesUsed += Job->pipelines;
+    if(Job->node >= 0)
+        nodes[Job->node].pipelinesUsed += Job->pipelines;
+    Job->parsing.start();
+    Q_EMIT started(Request.id, input, Job->pipelines);
+
+    jobs.push_back(std::move(Job));
+}
+
+bool Batch::pause(int priority)
+{
+    // Lowest priority first, the last started first
+    for(int lower = Priority_Low; lower < priority; ++lower)
+        for(auto Item = jobs.rbegin(); Item != jobs.rend(); ++Item)
+        {
+            job* Job = Item->get();
+            if(Job->Request.options.priority != lower || !Job->pipelines || Job->paused)
+                continue;
+            Job->info->setParsingPaused(true);
+            if(!Job->info->parsingPaused())
+                continue; // Not pausable (packets only, end of the media)
+
+            Job->paused = true;
+            Job->pause.start();
+            pipelinesUsed -= Job->pipelines;
+            if(Job->node >= 0)
+                nodes[Job->node].pipelinesUsed -= Job->pipelines;
+            Q_EMIT paused(Job->Request.id);
+            return true;
+        }
+    return false;
+}
+
+void Batch::resume(job* Job)
+{
+    Job->info->setParsingPaused(false);
+    Job->paused = false;
+    Job->pausedTime += Job->pause.elapsed();
+    pipelinesUsed += Job->pipelines;
+    if(Job->node >= 0)
+        nodes[Job->node].pipelinesUsed += Job->pipelines;
+    Q_EMIT resumed(Job->Request.id);
+}
+
+void Batch::parsed(job* Job, bool success)
+{
+    // Ended while being paused, its pipelines are already free
+    if(Job->paused)
+    {
+        Job->paused = false;
+        Job->pausedTime += Job->pause.elapsed();
+    }
+    else
+    {
+        pipelinesUsed -= Job->pipelines;
+        if(Job->node >= 0)
+            nodes[Job->node].pipelinesUsed -= Job->pipelines;
+    }
+    if(Job->node >= 0)
+    {
+        node& Node = nodes[Job->node];
+        ++Node.files;
+        Node.parsingTime += Job->parsing.elapsed() - Job->pausedTime;
+    }
+    releaseSessions(Job);
+    Job->pipelines = 0;
+
+    if(!success || !Job->info->parsed())
+    {
+        finish(Job, ParsingFailure, "analyzing failed");
+        return;
+    }
+
+    // Export is done by the thread of the file, the pipelines can be used by the next files
+    connect(Job->info.get(), &FileInformation::statsFileGenerated, this, [this, Job](SharedFile statsFile, const QString& name) {
+        exported(Job, statsFile, name);
+    });
+    Job->info->setExportFilters(Job->Request.options.filters);
+    if(Job->mkvReport)
+        Job->info->startExport();
+    else
+        Job->info->startExport(Job->Request.output);
+
+    next();
+}
+
+void Batch::releaseSessions(job* Job)
+{
+    if(Job->device >= 0)
+        devices[Job->device].sessionsUsed -= Job->sessions;
+    Job->sessions = 0;
+}
+
+void Batch::exported(job* Job, SharedFile statsFile, const QString& name)
+{
+    if(Job->mkvReport)
+    {
+        // Other files continue while thumbnails and panels are added
+        Job->info->makeMkvReport(Job->Request.output, statsFile->readAll(), name, [](int, int) {
+            QCoreApplication::processEvents();
+        });
+    }
+
+    finish(Job, Success, "done");
+}
+
+void Batch::finish(job* Job, int error, const QString& message)
+{
+    request Request = Job->Request;
+    if(error == Success && !Job->fingerprint.isEmpty())
+        QCvaultIndex::Add(Request.options.useQCvault, Job->fingerprint, Request.options.filters, Request.output);
+    if(error == Success && !Request.options.index.isEmpty())
+    {
+        // Opened once, the stats of the file are still here
+        QString databaseError;
+        if(!database)
+        {
+            database.reset(new StatsDatabase);
+            if(!database->Open(Request.options.index, &databaseError))
+                database.reset();
+        }
+        if(!database || !database->Add(QFileInfo(Request.output).absoluteFilePath(), QFileInfo(Request.input).absoluteFilePath(), Job->info->Stats, Request.options.filters, QByteArray(), &databaseError))
+            Q_EMIT warning(Request.id, QString("report not indexed in %1: %2").arg(Request.options.index).arg(databaseError));
+    }
+
+    // Stats are released as soon as the report is written
+    qint64 ran = Job->parsing.elapsed() - Job->pausedTime;
+    jobs.remove_if([Job](const std::unique_ptr<job>& item) {
+        return item.get() == Job;
+    });
+
+    result(Request, Request.output, error, message, ran);
+    next();
+}
+
+void Batch::result(const request& Request, const QString& output, int error, const QString& message, qint64 ran)
+{
+    ++inputsDone;
+    if(error != Success)
+        ++inputsFailed;
+    if(error != Success && this->error == Success)
+        this->error = error;
+
+    Q_EMIT finished(Request.id, Request.input, output, error, message, Request.queued.elapsed() - ran, ran);
+}
+
+void Batch::updateProgress()
+{
+    for(const auto& Job : jobs)
+    {
+        if(!Job->pipelines)
+            continue; // Exporting
+
+        int64_t count = Job->info->Frames_Count_Get();
+        if(count > 0)
+            Q_EMIT progress(Job->Request.id, (int)std::min<int64_t>(100, Job->info->Frames_Pos_Get() * 100 / count));
+    }
+}
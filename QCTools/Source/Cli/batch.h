@@ -0,0 +1,205 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef BATCH_H
+#define BATCH_H
+//---------------------------------------------------------------------------
+
+#include "Core/FileInformation.h"
+#include "Core/Preferences.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QStringList>
+#include <QTimer>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+class StatsDatabase;
+
+//---------------------------------------------------------------------------
+// Analysis of several input files in one process, with a pool of parsing
+// pipelines (demux, decode, filters) shared by the files.
+//
+// Each file gets a count of pipelines (parsing segments, see -segments)
+// depending on its resolution and on the video filters, a file is started
+// as soon as the pipelines it needs are available. Reports are written and
+// finished() is emitted as soon as a file is done.
+//
+// With NUMA binding, the pool is split between the NUMA nodes (see
+// NumaNodes): a file is started on the node with the most free pipelines and
+// all its threads and frames stay on this node.
+//
+// With several hardware devices (see setHardwareDevices), each file decodes
+// on the device with the most free decoder sessions (one per pipeline) and
+// falls back to software decoding when all the devices are saturated.
+//
+// Files of a higher priority class are started first. When the pool is
+// full, the parsing of the running files of a lower class (the last started
+// first) is paused at a frame boundary (see FileInformation::setParsingPaused),
+// their stats stay in memory and they are resumed once the pipelines are
+// free again, before the files of their class not started yet.
+//
+// The next files to start (see setLookahead) are checked and opened ahead,
+// without blocking: their media is probed, their report read and their
+// filter graphs built while the running files are parsed, so the pipelines
+// do not wait for the storage between files. Not with NUMA binding, the
+// threads of a file are bound to its node when its players are created.
+class Batch : public QObject
+{
+    Q_OBJECT
+public:
+    enum priority
+    {
+        Priority_Low,
+        Priority_Normal,
+        Priority_High,
+    };
+
+    struct Options
+    {
+        activefilters           filters;
+        activealltracks         activeAllTracks;
+        QString                 useQCvault;
+        bool                    createMkv {true};
+        bool                    forceOutput {false};
+        bool                    streamExport {false};
+        int                     segments {0}; // 0 means depending on the file
+        double                  start {-std::numeric_limits<double>::infinity()}; // Time stamps of the range parsed, see FileInformation::setParsingRange
+        double                  end {std::numeric_limits<double>::infinity()};
+        QString                 index; // Database the reports are added to, see StatsDatabase
+        int                     priority {Priority_Normal};
+    };
+
+    // Jobs is the count of pipelines, 0 means one per 2 cores; numa binds each file to a NUMA node if there are several
+    explicit Batch(int jobs = 0, bool numa = false);
+    ~Batch();
+
+    // Output is named after the input if empty, id is sent back in the signals
+    void add(const QString& input, const Options& options, const QString& output = QString(), const QString& id = QString());
+
+    // Waits for the end of all files, returns Success if all files have been analyzed, else the error of the first failed file
+    int exec();
+
+    int pipelinesCount() const {return pipelines;}
+    // Count of the next files opened ahead, 2 by default, 0 for none
+    void setLookahead(int count) {lookahead = count;}
+    // Count of NUMA nodes used, 0 if not bound
+    int nodesCount() const {return (int)nodes.size();}
+    // Files and parsing time of each node, for comparing with a run without binding, and files of each hardware device
+    QStringList nodesSummary() const;
+    // Devices of QT_AVPLAYER_HWDECODE (see QAVPlayer::setHardwareDevice) the files of the batches created afterwards are
+    // decoded on, with sessions decoders at the same time on each device, 0 for the pool split between the devices
+    static void setHardwareDevices(const QStringList& names, int sessions = 0);
+    // Count of hardware devices used, 0 if none
+    int devicesCount() const {return (int)devices.size();}
+    // Counters of the jobs in OpenMetrics text format (see ColumnsServer): files queued, running and finished, and for
+    // each running file labelled by job, input, codec and resolution, its frames, bytes read, decoding, filtering and
+    // backpressure times and its memory by part
+    QByteArray metrics() const;
+
+    // Names as in the -f option, filters are kept if names is empty
+    static activefilters parseFilters(const QStringList& names, activefilters filters);
+
+    // Pipelines for a file of this size with these filters, 1 for SD and 2 for HD with signalstats
+    static int budget(int width, int height, const activefilters& filters);
+
+    // Priority of "low", "normal" or "high", -1 if unknown
+    static int priorityFromName(const QString& name);
+
+Q_SIGNALS:
+    void started(const QString& id, const QString& input, int segments);
+    void paused(const QString& id);
+    void resumed(const QString& id);
+    void progress(const QString& id, int percent);
+    void warning(const QString& id, const QString& message);
+    // Milliseconds waited (queued or paused) and run (parsing and export)
+    void finished(const QString& id, const QString& input, const QString& output, int error, const QString& message, qint64 waited, qint64 ran);
+
+private:
+    struct request
+    {
+        QString                 id;
+        QString                 input;
+        QString                 output;
+        Options                 options;
+        QElapsedTimer           queued; // Since add()
+        quint64                 serial {0}; // Of add(), key of the files opened ahead
+    };
+
+    struct job
+    {
+        request                 Request;
+        bool                    mkvReport {false};
+        QByteArray              fingerprint; // Of the input, if the report is added to the QCvault index
+        int                     pipelines {0}; // Count of pipelines used while parsing
+        int                     node {-1}; // Index in nodes, -1 if not bound
+        int                     device {-1}; // Index in devices, -1 for the default device or software decoding
+        int                     sessions {0}; // Decoders on the device, released once parsed
+        QElapsedTimer           parsing;
+        bool                    paused {false}; // Its pipelines are free
+        QElapsedTimer           pause; // Since the last pause
+        qint64                  pausedTime {0}; // Milliseconds, sum of the pauses ended
+        std::unique_ptr<FileInformation> info;
+    };
+
+    void next();
+    void prepareAhead();
+    std::unique_ptr<job> prepare(const request& Request, bool ahead);
+    void start(const request& Request);
+    bool pause(int priority);
+    void resume(job* Job);
+    void parsed(job* Job, bool success);
+    void releaseSessions(job* Job);
+    void exported(job* Job, SharedFile statsFile, const QString& name);
+    void finish(job* Job, int error, const QString& message);
+    void result(const request& Request, const QString& output, int error, const QString& message, qint64 ran = 0);
+    void updateProgress();
+
+    struct node
+    {
+        int                     index {0}; // See NumaNodes
+        int                     pipelines {0};
+        int                     pipelinesUsed {0};
+        int                     files {0};
+        qint64                  parsingTime {0}; // Milliseconds, sum of the files
+    };
+
+    struct device
+    {
+        QString                 name; // See QAVPlayer::setHardwareDevice
+        int                     sessions {0};
+        int                     sessionsUsed {0};
+        int                     files {0};
+    };
+
+    std::list<request>          requests;
+    Preferences                 prefs;
+    SignalServer                signalServer; // Not used, no upload of several files
+    QEventLoop                  loop;
+    QTimer                      progressTimer;
+    std::list<std::unique_ptr<job>> jobs;
+    std::map<quint64, std::unique_ptr<job>> prepared; // Opened ahead, by request serial
+    int                         lookahead {2};
+    quint64                     serials {0};
+    int                         pipelines {0}; // Pool size
+    int                         pipelinesUsed {0};
+    std::vector<node>           nodes; // Empty if not bound
+    std::vector<device>         devices; // Empty for the default device
+    int                         softwareFiles {0}; // Decoded in software, the devices being saturated
+    int                         inputsCount {0};
+    int                         inputsDone {0};
+    int                         inputsFailed {0};
+    int                         error {0};
+    bool                        starting {false};
+    std::unique_ptr<StatsDatabase> database; // Of options.index
+};
+
+#endif // BATCH_H
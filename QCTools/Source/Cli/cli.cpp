@@ -1,18 +1,275 @@
 #include "cli.h"
 #include <QtAVPlayer/qavplayer.h>
 #include "version.h"
+#include "Core/AnalysisProfiles.h"
+#include "Core/AnalyzerPlugins.h"
 #include "Core/CommonStats.h"
+#include "Core/CpuFeatures.h"
+#include "Core/FFmpegVideoEncoder.h"
 #include "Core/FileInformation.h"
+#include "Core/FrameSnapshots.h"
+#include "Core/FrameFeed.h"
+#include "Core/ThumbnailSprites.h"
+#include "Core/ImageSequenceReader.h"
+#include "Core/KernelsBenchmark.h"
+#include "Core/MemoryPressure.h"
+#include "Core/QCvaultIndex.h"
+#include "Core/GrowingFileDevice.h"
+#include "Core/PipeDevice.h"
+#include "Core/ReadaheadDevice.h"
+#include "Core/UringQueue.h"
+#include "Core/StatsArrowReport.h"
+#include "Core/StatsCompression.h"
+#include "Core/StatsDatabase.h"
+#include "Core/StatsDetectors.h"
+#include "Core/StatsThresholds.h"
+#include "Core/TraceEvents.h"
+#include "Core/Tracing.h"
+#include "batch.h"
+#include "convert.h"
+#include "coordinator.h"
+#include "estimator.h"
+#include "live.h"
+#include "server.h"
+#include "watch.h"
+#include "columnsserver.h"
 #include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
 #include <Core/logging.h>
 #include <clocale>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <iomanip>
+
+// Checkpoints of an analysis (see -checkpoint and --resume), next to the report
+static QString checkpointPartName(const QString& output, int index)
+{
+    return output + QString(".checkpoint%1.qctools.xml.gz").arg(index);
+}
+
+static QString checkpointStateName(const QString& output)
+{
+    return output + ".checkpoint.json";
+}
+
+// Levels of the native kernels the CPU has ("c avx2 avx512"...)
+static std::string availableCpuLevels()
+{
+    std::string levels;
+    for(int level = CpuFeatures::Level_C; level < CpuFeatures::Level_Max; ++level)
+        if(CpuFeatures::IsAvailable((CpuFeatures::level)level))
+            levels += std::string(levels.empty() ? "" : " ") + CpuFeatures::Name((CpuFeatures::level)level);
+    return levels;
+}
+
+// --cpu-features: features, levels and speed of the variants of the kernels
+static int reportCpuFeatures()
+{
+    static const int Width = 1920;
+    static const int Height = 1080;
+    static const int Frames = 100;
+
+    std::cout << "CPU features: " << CpuFeatures::Features() << std::endl;
+    std::cout << "Kernel levels: " << availableCpuLevels() << ", " << CpuFeatures::Name(CpuFeatures::Get())
+              << (CpuFeatures::Get() == CpuFeatures::Best() ? " is used" : " is used (set by -cpu)") << std::endl << std::endl;
+
+    std::cout << "Benchmark of the kernels, " << Frames << " frames of " << Width << "x" << Height << " (audio: 1920 samples of stereo) per level:" << std::endl;
+    double reference = 0;
+    std::string kernel;
+    for(const auto& result : KernelsBenchmark::Run(Width, Height, Frames))
+    {
+        if(result.Kernel != kernel)
+        {
+            kernel = result.Kernel;
+            reference = result.FramesPerSecond;
+        }
+        std::cout << std::left << std::setw(24) << (result.Level == CpuFeatures::Level_C ? result.Kernel : std::string())
+                  << std::setw(8) << CpuFeatures::Name(result.Level)
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(10) << result.FramesPerSecond << " frames/s";
+        if(result.Level != CpuFeatures::Level_C && reference > 0)
+            std::cout << std::setprecision(2) << std::setw(8) << result.FramesPerSecond / reference << "x";
+        if(!result.IsSame)
+            std::cout << "  values differ from the C ones";
+        std::cout << std::endl;
+    }
+
+    return Success;
+}
 
 Cli::Cli() : indexOfStreamWithKnownFrameCount(0), statsFileBytesWritten(0), statsFileBytesTotal(0), statsFileBytesUploaded(0), statsFileBytesToUpload(0)
 {
 
 }
 
+static activefilters selectFilters(const QStringList& filterStrings, activefilters filters)
+{
+    filters = Batch::parseFilters(filterStrings, filters);
+
+    std::cout << "filters selected: ";
+    if(filters.test(ActiveFilter_Video_signalstats))
+        std::cout << "signalstats" << " ";
+    if(filters.test(ActiveFilter_Video_cropdetect))
+        std::cout << "cropdetect" << " ";
+    if(filters.test(ActiveFilter_Video_Psnr))
+        std::cout << "psnr" << " ";
+    if(filters.test(ActiveFilter_Audio_EbuR128))
+        std::cout << "ebur128" << " ";
+    if(filters.test(ActiveFilter_Audio_aphasemeter))
+        std::cout << "aphasemeter" << " ";
+    if(filters.test(ActiveFilter_Audio_astats))
+        std::cout << "astats" << " ";
+    if(filters.test(ActiveFilter_Video_Ssim))
+        std::cout << "ssim" << " ";
+    if(filters.test(ActiveFilter_Video_Idet))
+        std::cout << "idet" << " ";
+    if(filters.test(ActiveFilter_Video_Deflicker))
+        std::cout << "deflicker" << " ";
+    if(filters.test(ActiveFilter_Video_Entropy))
+        std::cout << "entropy" << " ";
+    if(filters.test(ActiveFilter_Video_EntropyDiff))
+        std::cout << "entropy-diff" << " ";
+    if(filters.test(ActiveFilter_Video_blockdetect))
+        std::cout << "blockdetect" << " ";
+    if(filters.test(ActiveFilter_Video_blurdetect))
+        std::cout << "blurdetect" << " ";
+    if(filters.test(ActiveFilter_Video_blackdetect))
+        std::cout << "blackdetect" << " ";
+    if(filters.test(ActiveFilter_Video_freezedetect))
+        std::cout << "freezedetect" << " ";
+    if(filters.test(ActiveFilter_Audio_silencedetect))
+        std::cout << "silencedetect" << " ";
+    if(filters.test(ActiveFilter_Video_HdrLight))
+        std::cout << "hdr" << " ";
+
+    std::cout << std::endl;
+
+    return filters;
+}
+
+// Minimum, maximum, average and counts over the limits of each item from the frame first to the frame last (included)
+static void showRangeSummary(const FileInformation& info, size_t first, size_t last)
+{
+    for(size_t streamPos = 0; streamPos < info.Stats.size(); ++streamPos)
+    {
+        CommonStats* stats = info.Stats[streamPos];
+        if(!stats)
+            continue;
+
+        size_t end = last < stats->x_Current ? last + 1 : stats->x_Current;
+        if(first >= end)
+            continue;
+
+        size_t type = stats->Type_Get();
+        const struct stream_info& streamInfo = PerStreamType[type];
+        std::cout << std::endl << (type == Type_Video ? "video" : "audio") << " stream " << streamPos << ", frames " << first << " to " << end - 1 << ":" << std::endl;
+        for(size_t j = 0; j < streamInfo.CountOfItems; ++j)
+        {
+            auto range = stats->y_Range(j, first, end);
+            if(!range.Count)
+                continue;
+
+            const struct per_item& item = streamInfo.PerItem[j];
+            std::cout << std::fixed << std::setprecision(item.DigitsAfterComma) << "    " << item.Name;
+            if(range.Min <= range.Max)
+                std::cout << ": min " << range.Min << ", max " << range.Max;
+            std::cout << ", avg " << std::setprecision(item.DigitsAfterComma + 1) << range.Mean();
+            if(item.DefaultLimit != DBL_MAX)
+            {
+                std::cout << std::defaultfloat << ", above " << item.DefaultLimit << ": " << range.Above;
+                if(item.DefaultLimit2 != DBL_MAX)
+                    std::cout << ", above " << item.DefaultLimit2 << ": " << range.Above2;
+            }
+            std::cout << std::defaultfloat << std::endl;
+        }
+    }
+}
+
+// Summary of each item once the file is analyzed (see CommonStats::Summary_Get() and Sketch_Get()), with the t-digest
+// and the histogram so the summaries of parts of a file can be merged
+static bool writeSummary(const FileInformation& info, const activefilters& filters, const QString& fileName)
+{
+    QJsonArray streams;
+    for(size_t streamPos = 0; streamPos < info.Stats.size(); ++streamPos)
+    {
+        CommonStats* stats = info.Stats[streamPos];
+        if(!stats)
+            continue;
+
+        size_t type = stats->Type_Get();
+        const struct stream_info& streamInfo = PerStreamType[type];
+        QJsonArray items;
+        for(size_t j = 0; j < streamInfo.CountOfItems; ++j)
+        {
+            const struct per_item& item = streamInfo.PerItem[j];
+            if(item.Filter == activefilter(-1) || !filters.test(item.Filter) || !item.FFmpeg_Name)
+                continue;
+            auto summary = stats->Summary_Get(j);
+            if(!summary.Frozen || !summary.Frames)
+                continue;
+            auto sketch = stats->Sketch_Get(j);
+
+            QJsonObject object {
+                {"key", item.FFmpeg_Name},
+                {"frames", double(summary.Frames)},
+                {"min", summary.Min},
+                {"max", summary.Max},
+                {"mean", summary.Mean},
+                {"stddev", summary.StdDev},
+                {"p5", summary.P5},
+                {"median", summary.Median},
+                {"p95", summary.P95},
+            };
+            if(item.DefaultLimit != DBL_MAX)
+            {
+                object["above"] = QJsonObject {{"limit", item.DefaultLimit}, {"frames", double(summary.Above)}, {"seconds", sketch.DurationAbove(item.DefaultLimit)}};
+                if(item.DefaultLimit2 != DBL_MAX)
+                    object["above2"] = QJsonObject {{"limit", item.DefaultLimit2}, {"frames", double(summary.Above2)}, {"seconds", sketch.DurationAbove(item.DefaultLimit2)}};
+            }
+
+            QJsonObject percentiles;
+            for(int percentile : {1, 10, 25, 75, 90, 99})
+                percentiles[QString::number(percentile)] = sketch.Quantile(percentile / 100.0);
+            object["percentiles"] = percentiles;
+
+            QJsonArray centroids;
+            for(const auto& centroid : sketch.Centroids())
+                centroids.append(QJsonArray {centroid.Mean, centroid.Weight});
+            object["digest"] = QJsonObject {{"compression", double(StatsSketch::Compression)}, {"count", double(sketch.Count())}, {"min", sketch.Min()}, {"max", sketch.Max()}, {"centroids", centroids}};
+
+            QJsonArray counts;
+            QJsonArray durations;
+            for(const auto& bin : sketch.Bins())
+            {
+                counts.append(double(bin.Count));
+                durations.append(bin.Duration);
+            }
+            object["histogram"] = QJsonObject {{"origin", sketch.Bins_Origin()}, {"width", sketch.Bins_Width()}, {"counts", counts}, {"seconds", durations}};
+
+            items.append(object);
+        }
+        streams.append(QJsonObject {{"index", int(streamPos)}, {"media_type", type == Type_Video ? "video" : "audio"}, {"items", items}});
+    }
+
+    QSaveFile file(fileName);
+    return file.open(QIODevice::WriteOnly) && file.write(QJsonDocument(QJsonObject {{"streams", streams}}).toJson()) != -1 && file.commit();
+}
+
 int Cli::exec(QCoreApplication &a)
+{
+    int result = run(a);
+    if(!traceEventsFileName.isEmpty() && !TraceEvents::Stop(traceEventsFileName))
+        std::cerr << traceEventsFileName.toStdString() << " can not be written" << std::endl;
+    sendEvent(QJsonObject {{"event", "finished"}, {"code", result}});
+    return result;
+}
+
+int Cli::run(QCoreApplication &a)
 {
     std::string appName = "qcli";
     std::string copyright = "Copyright (C): 2013-2020, BAVC.\nCopyright (C): 2018-2020, RiceCapades LLC & MediaArea.net SARL.";
@@ -20,13 +277,71 @@ int Cli::exec(QCoreApplication &a)
     Logging logging;
 
     QString input;
+    QStringList inputs;
     QString output;
     QStringList filterStrings;
     bool forceOutput = false;
     bool showLongHelp = false;
     bool showShortHelp = false;
     bool showVersion = false;
+    bool showCpuFeatures = false;
     bool createMkv = true;
+    bool streamExport = false;
+    bool filterTimings = false;
+    bool rangeSummary = false;
+    QString summaryFileName;
+    QStringList detectorSpecs;
+    size_t rangeFirst = 0;
+    size_t rangeLast = SIZE_MAX;
+    QString thresholdsFileName;
+    std::unique_ptr<StatsThresholds> triage; // --two-pass
+    double triageTolerance = 0.2;
+    double triageMargin = 2;
+    bool progressJson = false;
+    bool merge = false;
+    QString indexFileName;
+    QString query;
+    bool estimate = false;
+    QString calibrationFileName;
+    double rangeStart = -std::numeric_limits<double>::infinity();
+    double rangeEnd = std::numeric_limits<double>::infinity();
+    bool rangeIsSet = false;
+    int rangeInFrames = -1; // Unknown, 0 time stamps, 1 frames
+    QString snapshotsDirectory;
+    QString compareReference;
+    QString compareVmafLog;
+    int checkpointInterval = 0; // s
+    bool resume = false;
+    QString snapshotsFormat = "jpg";
+    std::vector<double> snapshotTimes;
+    QString frameFeedDirectory;
+    double frameFeedInterval = 1; // s
+    int frameFeedWidth = 640;
+    QString spritesDirectory;
+    int spritesPerMinute = 60;
+    QString spritesFormat = "jpg";
+    int statsInterval = 0;
+    int segments = 1;
+    bool segmentsIsSet = false;
+    int jobs = 0;
+    int lookahead = 2;
+    int priority = Batch::Priority_Normal;
+    int decoderPool = 4;
+    bool numa = false;
+    QStringList hwDevices;
+    int hwSessions = 0;
+    bool serve = false;
+    QString serveName;
+    QString serveHttpName;
+    QString serveToken = qEnvironmentVariable("QCTOOLS_SERVE_TOKEN");
+    QString serveRoot;
+    QString serveHttpOrigin;
+    QStringList coordinateWorkers;
+    int shards = 0;
+    bool live = false;
+    double liveWindow = 10;
+    QString watchFolder;
+    QStringList convertFiles;
     QString useQCvault;
     bool ignoreQCvault = false;
     auto activeAllTracks = prefs.activeAllTracks();
@@ -36,15 +351,216 @@ int Cli::exec(QCoreApplication &a)
 
     bool uploadToSignalServer = false;
     bool forceUploadToSignalServer = false;
+    int uploadChunkSize = 0; // MiB
+    int uploadParallelChunks = 4;
 
     QString checkUploadFileName;
     std::setlocale(LC_NUMERIC, "C");
 
+    // Options below override the preferences for this run only
+    FileInformation::DecoderThreads_Set(prefs.decoderThreads());
+    FileInformation::DecoderThreadType_Set(prefs.decoderThreadType());
+    FileInformation::FilterThreads_Set(prefs.filterThreads());
+    FileInformation::ThumbnailsCodec_Set(prefs.thumbnailsCodec());
+    FileInformation::PanelsCodec_Set(prefs.panelsCodec());
+    auto reportCompression = StatsCompression::Format_FromName(prefs.reportCompression());
+    StatsCompression::Format_Set(StatsCompression::Check(reportCompression).isEmpty() ? reportCompression : StatsCompression::Format_Gzip);
+    StatsCompression::Level_Set(prefs.reportCompressionLevel());
+    MemoryPressure::Cgroup_Set(true); // Jobs in containers finish with less extras instead of being killed
+
     for(int i = 1; i < a.arguments().length(); ++i)
     {
         if(a.arguments().at(i) == "-i" && (i + 1) < a.arguments().length())
         {
             input = a.arguments().at(i + 1);
+            inputs.append(input);
+            ++i;
+        } else if(a.arguments().at(i) == "-manifest" && (i + 1) < a.arguments().length())
+        {
+            // One input file per line, relative to the manifest directory
+            QFile manifest(a.arguments().at(i + 1));
+            ++i;
+            if(!manifest.open(QIODevice::ReadOnly | QIODevice::Text))
+            {
+                std::cout << "manifest " << manifest.fileName().toStdString() << " can not be opened." << std::endl;
+                configHasIssues = true;
+                continue;
+            }
+            QDir manifestDir = QFileInfo(manifest).dir();
+            while(!manifest.atEnd())
+            {
+                QString line = QString::fromUtf8(manifest.readLine()).trimmed();
+                if(line.isEmpty() || line.startsWith('#'))
+                    continue;
+                input = manifestDir.filePath(line);
+                inputs.append(input);
+            }
+        } else if(a.arguments().at(i) == "--serve")
+        {
+            serve = true;
+            if((i + 1) < a.arguments().length() && !a.arguments().at(i + 1).startsWith('-'))
+            {
+                serveName = a.arguments().at(i + 1);
+                ++i;
+            }
+        } else if(a.arguments().at(i) == "--serve-http" && (i + 1) < a.arguments().length())
+        {
+            serveHttpName = a.arguments().at(i + 1);
+            ++i;
+        } else if(a.arguments().at(i) == "--serve-token" && (i + 1) < a.arguments().length())
+        {
+            serveToken = a.arguments().at(i + 1);
+            ++i;
+        } else if(a.arguments().at(i) == "--serve-root" && (i + 1) < a.arguments().length())
+        {
+            serveRoot = a.arguments().at(i + 1);
+            ++i;
+        } else if(a.arguments().at(i) == "--serve-http-origin" && (i + 1) < a.arguments().length())
+        {
+            serveHttpOrigin = a.arguments().at(i + 1);
+            ++i;
+        } else if(a.arguments().at(i) == "--watch" && (i + 1) < a.arguments().length())
+        {
+            watchFolder = a.arguments().at(i + 1);
+            ++i;
+        } else if(a.arguments().at(i) == "--convert" && (i + 1) < a.arguments().length())
+        {
+            convertFiles.append(a.arguments().at(i + 1));
+            ++i;
+        } else if(a.arguments().at(i) == "--follow")
+        {
+            GrowingFileDevice::Enabled_Set(true);
+            if((i + 1) < a.arguments().length() && !a.arguments().at(i + 1).startsWith('-'))
+            {
+                bool ok = false;
+                double idle = a.arguments().at(i + 1).toDouble(&ok);
+                if(!ok || idle <= 0)
+                {
+                    std::cout << "--follow idle time " << a.arguments().at(i + 1).toStdString() << " is not a count of seconds." << std::endl;
+                    configHasIssues = true;
+                }
+                else
+                    GrowingFileDevice::Idle_Set((int)(idle * 1000));
+                ++i;
+            }
+        } else if(a.arguments().at(i) == "-follow-sentinel" && (i + 1) < a.arguments().length())
+        {
+            GrowingFileDevice::Sentinel_Set(a.arguments().at(i + 1));
+            ++i;
+        } else if(a.arguments().at(i) == "--live")
+        {
+            live = true;
+            if((i + 1) < a.arguments().length() && !a.arguments().at(i + 1).startsWith('-'))
+            {
+                bool ok = false;
+                liveWindow = a.arguments().at(i + 1).toDouble(&ok);
+                if(!ok || liveWindow <= 0)
+                {
+                    std::cout << "--live window " << a.arguments().at(i + 1).toStdString() << " is not a count of seconds." << std::endl;
+                    configHasIssues = true;
+                    liveWindow = 10;
+                }
+                ++i;
+            }
+        } else if(a.arguments().at(i) == "--readahead")
+        {
+            // [<block size in KiB>[:<blocks>]]
+            int blockSize = 4096;
+            int blocks = 8;
+            if((i + 1) < a.arguments().length() && !a.arguments().at(i + 1).startsWith('-'))
+            {
+                auto values = a.arguments().at(i + 1).split(':');
+                bool ok = true;
+                blockSize = values[0].toInt(&ok);
+                if(ok && values.size() > 1)
+                    blocks = values[1].toInt(&ok);
+                if(!ok || values.size() > 2 || blockSize <= 0 || blocks <= 0)
+                {
+                    std::cout << "--readahead " << a.arguments().at(i + 1).toStdString() << " is not <block size in KiB>[:<blocks>]." << std::endl;
+                    configHasIssues = true;
+                }
+                ++i;
+            }
+            ReadaheadDevice::Default_Set((size_t)blockSize * 1024, blocks > 0 ? blocks : 0);
+        } else if(a.arguments().at(i) == "-pipe-buffer" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            int size = a.arguments().at(i + 1).toInt(&ok);
+            if(!ok || size <= 0)
+            {
+                std::cout << "-pipe-buffer " << a.arguments().at(i + 1).toStdString() << " is not a size in MiB." << std::endl;
+                configHasIssues = true;
+            }
+            else
+                PipeDevice::Buffer_Size_Set((size_t)size * 1024 * 1024);
+            ++i;
+        } else if(a.arguments().at(i).startsWith("--io="))
+        {
+            auto mode = a.arguments().at(i).mid(QString("--io=").length());
+            if(mode == "read" || mode == "uring")
+            {
+                UringQueue::Enabled_Set(mode == "uring");
+                if(mode == "uring" && !UringQueue::IsAvailable())
+                    std::cerr << "--io=uring: io_uring is not available, reading with blocking reads." << std::endl;
+            }
+            else
+            {
+                std::cout << "--io must be read or uring." << std::endl;
+                configHasIssues = true;
+            }
+        } else if(a.arguments().at(i) == "-sequence-ahead" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            int files = a.arguments().at(i + 1).toInt(&ok);
+            if(!ok || files < 0)
+            {
+                std::cout << "-sequence-ahead " << a.arguments().at(i + 1).toStdString() << " is not a count of files." << std::endl;
+                configHasIssues = true;
+            }
+            else
+                ImageSequenceReader::Ahead_Set(files);
+            ++i;
+        } else if(a.arguments().at(i) == "--coordinate" && (i + 1) < a.arguments().length())
+        {
+            coordinateWorkers = a.arguments().at(i + 1).split(',');
+            coordinateWorkers.removeAll(QString());
+            ++i;
+        } else if(a.arguments().at(i) == "-shards" && (i + 1) < a.arguments().length())
+        {
+            shards = a.arguments().at(i + 1).toInt();
+            ++i;
+        } else if(a.arguments().at(i) == "-jobs" && (i + 1) < a.arguments().length())
+        {
+            jobs = a.arguments().at(i + 1).toInt();
+            ++i;
+        } else if(a.arguments().at(i) == "-lookahead" && (i + 1) < a.arguments().length())
+        {
+            lookahead = a.arguments().at(i + 1).toInt();
+            ++i;
+        } else if(a.arguments().at(i) == "-priority" && (i + 1) < a.arguments().length())
+        {
+            priority = Batch::priorityFromName(a.arguments().at(i + 1));
+            if(priority < 0)
+            {
+                std::cout << "-priority " << a.arguments().at(i + 1).toStdString() << " is not low, normal or high." << std::endl;
+                configHasIssues = true;
+                priority = Batch::Priority_Normal;
+            }
+            ++i;
+        } else if(a.arguments().at(i) == "-decoder-pool" && (i + 1) < a.arguments().length())
+        {
+            decoderPool = a.arguments().at(i + 1).toInt();
+            ++i;
+        } else if(a.arguments().at(i) == "-numa")
+        {
+            numa = true;
+        } else if(a.arguments().at(i) == "-plugins" && (i + 1) < a.arguments().length())
+        {
+            if(!AnalyzerPlugins::Load(a.arguments().at(i + 1)))
+            {
+                std::cout << "-plugins " << a.arguments().at(i + 1).toStdString() << " has no analyzer plugin." << std::endl;
+                configHasIssues = true;
+            }
             ++i;
         } else if(a.arguments().at(i) == "-o" && (i + 1) < a.arguments().length())
         {
@@ -59,10 +575,38 @@ int Cli::exec(QCoreApplication &a)
             uploadToSignalServer = true;
         } else if(a.arguments().at(i) == "--log")
         {
-            logging.enable();
+            auto o = a.arguments().indexOf("-o");
+            logging.enable(o != -1 && FileInformation::IsStdoutExport(a.arguments().value(o + 1)));
+        } else if(a.arguments().at(i) == "--trace" && (i + 1) < a.arguments().length())
+        {
+            if(!Tracing::enable(a.arguments().at(i + 1)))
+            {
+                std::cout << "--trace must be a comma separated list of frames, panels, startup or all." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if(a.arguments().at(i) == "--trace-events" && (i + 1) < a.arguments().length())
+        {
+            traceEventsFileName = a.arguments().at(++i);
+            TraceEvents::Start();
         } else if(a.arguments().at(i) == "-uf")
         {
             forceUploadToSignalServer = true;
+        } else if(a.arguments().at(i) == "-upload-chunks" && (i + 1) < a.arguments().length())
+        {
+            // <chunk size in MiB>[:<parallel>]
+            auto values = a.arguments().at(i + 1).split(':');
+            bool ok = true;
+            uploadChunkSize = values[0].toInt(&ok);
+            if(ok && values.size() > 1)
+                uploadParallelChunks = values[1].toInt(&ok);
+            if(!ok || values.size() > 2 || uploadChunkSize <= 0 || uploadParallelChunks <= 0)
+            {
+                std::cout << "-upload-chunks " << a.arguments().at(i + 1).toStdString() << " is not <chunk size in MiB>[:<parallel>]." << std::endl;
+                configHasIssues = true;
+                uploadChunkSize = 0;
+            }
+            ++i;
         } else if(a.arguments().at(i) == "-c" && (i + 1) < a.arguments().length())
         {
             checkUploadFileName = a.arguments().at(i + 1);
@@ -70,6 +614,62 @@ int Cli::exec(QCoreApplication &a)
         } else if(a.arguments().at(i) == "-f" && (i + 1) < a.arguments().length())
         {
             filterStrings = a.arguments().at(i + 1).split('+');
+        } else if(a.arguments().at(i) == "-checkpoint" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            checkpointInterval = a.arguments().at(i + 1).toInt(&ok);
+            if(!ok || checkpointInterval <= 0)
+            {
+                std::cout << "-checkpoint " << a.arguments().at(i + 1).toStdString() << " is not a count of seconds." << std::endl;
+                configHasIssues = true;
+                checkpointInterval = 0;
+            }
+            ++i;
+        } else if(a.arguments().at(i) == "--resume")
+        {
+            resume = true;
+        } else if(a.arguments().at(i) == "-compare" && (i + 1) < a.arguments().length())
+        {
+            compareReference = a.arguments().at(i + 1);
+            ++i;
+        } else if(a.arguments().at(i) == "-compare-vmaf" && (i + 1) < a.arguments().length())
+        {
+            compareVmafLog = a.arguments().at(i + 1);
+            ++i;
+        } else if(a.arguments().at(i) == "--roi" && (i + 1) < a.arguments().length())
+        {
+            // <width>:<height>:<x>:<y>, as crop
+            auto values = a.arguments().at(i + 1).split(':');
+            QList<int> numbers;
+            bool ok = values.size() == 4;
+            for(const auto& value : values)
+                if(ok)
+                    numbers.append(value.toInt(&ok));
+            if(!ok || numbers[0] <= 0 || numbers[1] <= 0 || numbers[2] < 0 || numbers[3] < 0)
+            {
+                std::cout << "--roi " << a.arguments().at(i + 1).toStdString() << " is not <width>:<height>:<x>:<y>." << std::endl;
+                configHasIssues = true;
+            }
+            else
+                FileInformation::RegionOfInterest_Set(QRect(numbers[2], numbers[3], numbers[0], numbers[1]));
+            ++i;
+        } else if(a.arguments().at(i) == "-skip-duplicates")
+        {
+            FileInformation::FrameMemoization_Set(true);
+        } else if(a.arguments().at(i) == "-framehash" && (i + 1) < a.arguments().length())
+        {
+            if(!FileInformation::FrameHash_Set(a.arguments().at(i + 1)))
+            {
+                std::cout << "-framehash " << a.arguments().at(i + 1).toStdString() << " is not a known hash (MD5, murmur3, CRC32...)." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if(a.arguments().at(i) == "-captions-timecode")
+        {
+            FileInformation::CaptionsTimecode_Set(true);
+        } else if(a.arguments().at(i) == "-reanalyze")
+        {
+            FileInformation::Reanalysis_Set(true);
         } else if(a.arguments().at(i) == "-h")
         {
             showLongHelp = true;
@@ -88,76 +688,559 @@ int Cli::exec(QCoreApplication &a)
             ++i;
             if (i >= a.arguments().length())
             {
-                std::cout << "Missing argument after last option." << std::endl;
+                std::cout << "Missing argument after last option." << std::endl;
+                configHasIssues = true;
+                continue;
+            }
+
+            useQCvault = a.arguments().at(i);
+            if (useQCvault == "default")
+            {
+                useQCvault = prefs.defaultQCvaultPathString();
+                if (useQCvault.isEmpty())
+                {
+                    std::cout << "QCvault location can not be found." << std::endl;
+                    configHasIssues = true;
+                    continue;
+                }
+            }
+        } else if (a.arguments().at(i) == "-clear-qcvault")
+        {
+            configIsSet = true;
+
+            prefs.setQCvaultPathString(QString());
+            useQCvault = prefs.QCvaultPathString();
+            if (!useQCvault.isEmpty())
+            {
+                std::cout << "QCvault location can not be saved." << std::endl;
+                configHasIssues = true;
+                continue;
+            }
+            std::cout << "QCvault cleared." << std::endl;
+        } else if (a.arguments().at(i) == "-set-qcvault")
+        {
+            ++i;
+            if (i >= a.arguments().length() || a.arguments().at(i).isEmpty())
+            {
+                std::cout << "Missing argument after last option." << std::endl;
+                configHasIssues = true;
+                continue;
+            }
+            configIsSet = true;
+
+            prefs.setQCvaultPathString(a.arguments().at(i));
+            useQCvault = prefs.QCvaultPathString();
+            if (useQCvault.isEmpty())
+            {
+                std::cout << "QCvault location can not be saved." << std::endl;
+                configHasIssues = true;
+                continue;
+            }
+            std::cout << "QCvault set to " << useQCvault.toStdString() << std::endl;
+        } else if (a.arguments().at(i) == "-show-qcvault")
+        {
+            configIsSet = true;
+            bool HasError;
+            auto QCvaultPathString = prefs.QCvaultPathString(&HasError);
+            if (HasError)
+            {
+                std::cout << "Default QCvault location not available, use -qcvault instead, analyzing stopped." << std::endl;
+                configHasIssues = true;
+                continue;
+            }
+            if (QCvaultPathString.isEmpty())
+                std::cout << "QCvault path is not set." << std::endl;
+            else
+                std::cout << "QCvault path is " << QCvaultPathString.toStdString() << '.' << std::endl;
+        } else if (a.arguments().at(i) == "-s")
+        {
+            createMkv = false;
+        } else if (a.arguments().at(i) == "-a")
+        {
+            createMkv = true;
+        } else if (a.arguments().at(i) == "-compact")
+        {
+            CommonStats::CompactStorage_Set(true);
+        } else if (a.arguments().at(i) == "-thumbnails-decimation" && (i + 1) < a.arguments().length())
+        {
+            ThumbnailStore::Decimation_Set(a.arguments().at(i + 1).toInt());
+            ++i;
+        } else if (a.arguments().at(i) == "-thumbnails-uncompressed")
+        {
+            ThumbnailStore::Compression_Set(false);
+        } else if (a.arguments().at(i) == "-thumbnails-mipmap")
+        {
+            ThumbnailStore::Mipmap_Set(true);
+        } else if (a.arguments().at(i) == "-panels-in-memory")
+        {
+            PanelFrameStore::Spill_Set(false);
+        } else if (a.arguments().at(i) == "-memory-limit" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            auto megabytes = a.arguments().at(i + 1).toULongLong(&ok);
+            if(!ok)
+            {
+                std::cout << "-memory-limit " << a.arguments().at(i + 1).toStdString() << " is not a count of MB." << std::endl;
+                configHasIssues = true;
+            }
+            else
+                MemoryPressure::Limit_Set(megabytes * 1024 * 1024);
+            ++i;
+        } else if (a.arguments().at(i) == "-no-cgroup-limit")
+        {
+            MemoryPressure::Cgroup_Set(false);
+        } else if (a.arguments().at(i) == "-stream")
+        {
+            streamExport = true;
+        } else if (a.arguments().at(i) == "-segments" && (i + 1) < a.arguments().length())
+        {
+            segments = a.arguments().at(i + 1).toInt();
+            segmentsIsSet = true;
+            ++i;
+        } else if (a.arguments().at(i) == "-threads" && (i + 1) < a.arguments().length())
+        {
+            FileInformation::DecoderThreads_Set(a.arguments().at(i + 1).toInt());
+            ++i;
+        } else if (a.arguments().at(i) == "-thread-type" && (i + 1) < a.arguments().length())
+        {
+            auto type = a.arguments().at(i + 1);
+            if(type != "frame" && type != "slice" && type != "auto")
+            {
+                std::cout << "-thread-type must be frame, slice or auto." << std::endl;
+                configHasIssues = true;
+            }
+            FileInformation::DecoderThreadType_Set(type);
+            ++i;
+        } else if (a.arguments().at(i) == "-filter-threads" && (i + 1) < a.arguments().length())
+        {
+            FileInformation::FilterThreads_Set(a.arguments().at(i + 1).toInt());
+            ++i;
+        } else if (a.arguments().at(i) == "-decode-ahead" && (i + 1) < a.arguments().length())
+        {
+            FileInformation::DecodeAhead_Set(a.arguments().at(i + 1).toInt());
+            ++i;
+        } else if (a.arguments().at(i) == "-cpu" && (i + 1) < a.arguments().length())
+        {
+            auto level = CpuFeatures::FromName(a.arguments().at(i + 1).toStdString());
+            if(level == CpuFeatures::Level_Max || !CpuFeatures::Set(level))
+            {
+                std::cout << "-cpu " << a.arguments().at(i + 1).toStdString() << " is not a level of this CPU (" << availableCpuLevels() << ")." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "--cpu-features")
+        {
+            showCpuFeatures = true;
+        } else if ((a.arguments().at(i) == "-thumbnails-codec" || a.arguments().at(i) == "-panels-codec") && (i + 1) < a.arguments().length())
+        {
+            auto codec = a.arguments().at(i + 1);
+            auto issue = FFmpegVideoEncoder::Codec::parse(codec).check();
+            if(!issue.isEmpty())
+            {
+                std::cout << a.arguments().at(i).toStdString() << ": " << issue.toStdString() << "." << std::endl;
+                configHasIssues = true;
+            }
+            if(a.arguments().at(i) == "-thumbnails-codec")
+                FileInformation::ThumbnailsCodec_Set(codec);
+            else
+                FileInformation::PanelsCodec_Set(codec);
+            ++i;
+        } else if (a.arguments().at(i) == "-compression" && (i + 1) < a.arguments().length())
+        {
+            auto format = StatsCompression::Format_FromName(a.arguments().at(i + 1));
+            auto issue = StatsCompression::Check(format);
+            if(!issue.isEmpty())
+            {
+                std::cout << "-compression: " << issue.toStdString() << "." << std::endl;
+                configHasIssues = true;
+            }
+            else
+                StatsCompression::Format_Set(format);
+            ++i;
+        } else if (a.arguments().at(i) == "-compression-level" && (i + 1) < a.arguments().length())
+        {
+            StatsCompression::Level_Set(a.arguments().at(i + 1).toInt());
+            ++i;
+        } else if (a.arguments().at(i) == "-separate-filter-graphs")
+        {
+            FileInformation::FilterGraphsCombined_Set(false);
+        } else if (a.arguments().at(i) == "-stats-branches" && (i + 1) < a.arguments().length())
+        {
+            FileInformation::StatsBranches_Set(a.arguments().at(i + 1).toInt());
+            ++i;
+        } else if (a.arguments().at(i) == "-signalstats-kernel" && (i + 1) < a.arguments().length())
+        {
+            auto mode = a.arguments().at(i + 1);
+            if(mode == "on")
+                FileInformation::StatsKernel_Set(FileInformation::StatsKernel_On);
+            else if(mode == "check")
+                FileInformation::StatsKernel_Set(FileInformation::StatsKernel_Check);
+            else if(mode == "off")
+                FileInformation::StatsKernel_Set(FileInformation::StatsKernel_Off);
+            else
+            {
+                std::cout << "-signalstats-kernel must be on, off or check." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-field-kernel" && (i + 1) < a.arguments().length())
+        {
+            auto mode = a.arguments().at(i + 1);
+            if(mode == "on")
+                FileInformation::FieldKernel_Set(FileInformation::StatsKernel_On);
+            else if(mode == "check")
+                FileInformation::FieldKernel_Set(FileInformation::StatsKernel_Check);
+            else if(mode == "off")
+                FileInformation::FieldKernel_Set(FileInformation::StatsKernel_Off);
+            else
+            {
+                std::cout << "-field-kernel must be on, off or check." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-audio-kernel" && (i + 1) < a.arguments().length())
+        {
+            auto mode = a.arguments().at(i + 1);
+            if(mode == "on" || mode == "off")
+                FileInformation::AudioKernel_Set(mode == "on");
+            else
+            {
+                std::cout << "-audio-kernel must be on or off." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-audio-window" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            auto window = a.arguments().at(i + 1).toDouble(&ok);
+            if(ok && window > 0)
+                FileInformation::AudioKernelWindow_Set(window);
+            else
+            {
+                std::cout << "-audio-window must be a count of seconds greater than 0." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-audio-rows" && (i + 1) < a.arguments().length())
+        {
+            auto value = a.arguments().at(i + 1);
+            bool ok = false;
+            auto window = value.toDouble(&ok);
+            if(value == "frames")
+                FileInformation::AudioRowsWindow_Set(0);
+            else if(value == "video")
+                FileInformation::AudioRowsWindow_Set(-1);
+            else if(ok && window > 0)
+                FileInformation::AudioRowsWindow_Set(window);
+            else
+            {
+                std::cout << "-audio-rows must be frames, video or a count of seconds greater than 0." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-profile" && (i + 1) < a.arguments().length())
+        {
+            auto profile = AnalysisProfiles::FromName(a.arguments().at(i + 1));
+            if(profile == AnalysisProfiles::Profile_Max)
+            {
+                std::cout << "-profile must be full, luma-only or broadcast-legal." << std::endl;
+                configHasIssues = true;
+            }
+            else
+                FileInformation::AnalysisProfile_Set(profile);
+            ++i;
+        } else if (a.arguments().at(i) == "-filter-timings")
+        {
+            filterTimings = true;
+        } else if (a.arguments().at(i) == "-range-summary" && (i + 1) < a.arguments().length())
+        {
+            rangeSummary = true;
+            if(a.arguments().at(i + 1) != "all")
+            {
+                auto bounds = a.arguments().at(i + 1).split('-');
+                bool firstOk = false;
+                bool lastOk = false;
+                if(bounds.size() == 2)
+                {
+                    rangeFirst = bounds[0].toULongLong(&firstOk);
+                    rangeLast = bounds[1].toULongLong(&lastOk);
+                }
+                if(!firstOk || !lastOk || rangeFirst > rangeLast)
+                {
+                    std::cout << "-range-summary must be all or <first frame>-<last frame>." << std::endl;
+                    configHasIssues = true;
+                }
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-detect" && (i + 1) < a.arguments().length())
+        {
+            detectorSpecs.append(a.arguments().at(i + 1));
+            ++i;
+        } else if (a.arguments().at(i) == "-summary" && (i + 1) < a.arguments().length())
+        {
+            summaryFileName = a.arguments().at(i + 1);
+            ++i;
+        } else if (a.arguments().at(i) == "-thresholds" && (i + 1) < a.arguments().length())
+        {
+            thresholdsFileName = a.arguments().at(i + 1);
+            QFile preset(thresholdsFileName);
+            QString error;
+            thresholds.reset(new StatsThresholds);
+            if(!preset.open(QIODevice::ReadOnly))
+            {
+                std::cout << "thresholds preset " << thresholdsFileName.toStdString() << " can not be opened." << std::endl;
+                configHasIssues = true;
+            }
+            else if(!thresholds->Load(preset.readAll(), &error))
+            {
+                std::cout << "thresholds preset " << thresholdsFileName.toStdString() << " can not be read: " << error.toStdString() << "." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "--two-pass" && (i + 1) < a.arguments().length())
+        {
+            auto triageFileName = a.arguments().at(i + 1);
+            QFile preset(triageFileName);
+            QString error;
+            triage.reset(new StatsThresholds);
+            if(!preset.open(QIODevice::ReadOnly))
+            {
+                std::cout << "thresholds preset " << triageFileName.toStdString() << " can not be opened." << std::endl;
+                configHasIssues = true;
+            }
+            else if(!triage->Load(preset.readAll(), &error))
+            {
+                std::cout << "thresholds preset " << triageFileName.toStdString() << " can not be read: " << error.toStdString() << "." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if ((a.arguments().at(i) == "-triage-tolerance" || a.arguments().at(i) == "-triage-margin") && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            auto value = a.arguments().at(i + 1).toDouble(&ok);
+            if(!ok || value < 0)
+            {
+                std::cout << a.arguments().at(i).toStdString() << " must be a positive number." << std::endl;
+                configHasIssues = true;
+            }
+            (a.arguments().at(i) == "-triage-tolerance" ? triageTolerance : triageMargin) = value;
+            ++i;
+        } else if (a.arguments().at(i) == "-snapshots" && (i + 1) < a.arguments().length())
+        {
+            snapshotsDirectory = a.arguments().at(i + 1);
+            ++i;
+        } else if (a.arguments().at(i) == "-snapshots-format" && (i + 1) < a.arguments().length())
+        {
+            snapshotsFormat = a.arguments().at(i + 1).toLower();
+            if(snapshotsFormat != "jpg" && snapshotsFormat != "png")
+            {
+                std::cout << "-snapshots-format must be jpg or png." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-snapshot-times" && (i + 1) < a.arguments().length())
+        {
+            for(const auto& time : a.arguments().at(i + 1).split(','))
+            {
+                bool ok = false;
+                snapshotTimes.push_back(time.toDouble(&ok));
+                if(!ok)
+                {
+                    std::cout << "-snapshot-times must be a comma separated list of seconds." << std::endl;
+                    configHasIssues = true;
+                    break;
+                }
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-frame-feed" && (i + 1) < a.arguments().length())
+        {
+            frameFeedDirectory = a.arguments().at(i + 1);
+            ++i;
+        } else if (a.arguments().at(i) == "-frame-feed-interval" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            frameFeedInterval = a.arguments().at(i + 1).toDouble(&ok);
+            if(!ok || frameFeedInterval <= 0)
+            {
+                std::cout << "-frame-feed-interval must be a count of seconds above 0." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-frame-feed-width" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            frameFeedWidth = a.arguments().at(i + 1).toInt(&ok);
+            if(!ok || frameFeedWidth <= 0)
+            {
+                std::cout << "-frame-feed-width must be a count of pixels above 0." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-sprites" && (i + 1) < a.arguments().length())
+        {
+            spritesDirectory = a.arguments().at(i + 1);
+            ++i;
+        } else if (a.arguments().at(i) == "-sprites-per-minute" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            spritesPerMinute = a.arguments().at(i + 1).toInt(&ok);
+            if(!ok || spritesPerMinute <= 0)
+            {
+                std::cout << "-sprites-per-minute must be a count of thumbnails above 0." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-sprites-format" && (i + 1) < a.arguments().length())
+        {
+            spritesFormat = a.arguments().at(i + 1).toLower();
+            if(spritesFormat != "jpg" && spritesFormat != "webp")
+            {
+                std::cout << "-sprites-format must be jpg or webp." << std::endl;
                 configHasIssues = true;
-                continue;
             }
-
-            useQCvault = a.arguments().at(i);
-            if (useQCvault == "default")
+            ++i;
+        } else if ((a.arguments().at(i) == "--start" || a.arguments().at(i) == "--end") && (i + 1) < a.arguments().length())
+        {
+            // <seconds> or <frame>f
+            auto value = a.arguments().at(i + 1);
+            bool inFrames = value.endsWith('f');
+            if(inFrames)
+                value.chop(1);
+            bool ok = false;
+            auto number = value.toDouble(&ok);
+            if(!ok || (rangeInFrames != -1 && rangeInFrames != (int)inFrames))
             {
-                useQCvault = prefs.defaultQCvaultPathString();
-                if (useQCvault.isEmpty())
-                {
-                    std::cout << "QCvault location can not be found." << std::endl;
-                    configHasIssues = true;
-                    continue;
-                }
+                std::cout << "--start and --end must be both a time stamp in seconds or both a frame number followed by f." << std::endl;
+                configHasIssues = true;
             }
-        } else if (a.arguments().at(i) == "-clear-qcvault")
+            (a.arguments().at(i) == "--start" ? rangeStart : rangeEnd) = number;
+            rangeInFrames = inFrames;
+            rangeIsSet = true;
+            ++i;
+        } else if ((a.arguments().at(i) == "--sample-every" || a.arguments().at(i) == "--sample-rate") && (i + 1) < a.arguments().length())
         {
-            configIsSet = true;
-
-            prefs.setQCvaultPathString(QString());
-            useQCvault = prefs.QCvaultPathString();
-            if (!useQCvault.isEmpty())
+            auto value = a.arguments().at(i + 1);
+            bool ok = false;
+            if(a.arguments().at(i) == "--sample-rate")
             {
-                std::cout << "QCvault location can not be saved." << std::endl;
+                auto rate = value.toDouble(&ok);
+                ok = ok && rate > 0;
+                FileInformation::SamplingRate_Set(rate);
+            }
+            else if(value == "key")
+            {
+                ok = true;
+                FileInformation::Sampling_Set(-1);
+            }
+            else
+            {
+                auto every = value.toInt(&ok);
+                ok = ok && every > 0;
+                FileInformation::Sampling_Set(every);
+            }
+            if(!ok)
+            {
+                std::cout << a.arguments().at(i).toStdString() << " must be a frame count, key or a count of frames per second." << std::endl;
                 configHasIssues = true;
-                continue;
             }
-            std::cout << "QCvault cleared." << std::endl;
-        } else if (a.arguments().at(i) == "-set-qcvault")
-        {
             ++i;
-            if (i >= a.arguments().length() || a.arguments().at(i).isEmpty())
+        } else if (a.arguments().at(i) == "-lowres" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            auto lowres = a.arguments().at(i + 1).toInt(&ok);
+            if(!ok || lowres < 0 || lowres > 3)
             {
-                std::cout << "Missing argument after last option." << std::endl;
+                std::cout << "-lowres must be 0, 1, 2 or 3." << std::endl;
                 configHasIssues = true;
-                continue;
             }
-            configIsSet = true;
-
-            prefs.setQCvaultPathString(a.arguments().at(i));
-            useQCvault = prefs.QCvaultPathString();
-            if (useQCvault.isEmpty())
+            else
+                FileInformation::Lowres_Set(lowres);
+            ++i;
+        } else if (a.arguments().at(i) == "-skip-nonref")
+        {
+            FileInformation::SkipNonRef_Set(true);
+        } else if (a.arguments().at(i) == "-packet-stats")
+        {
+            FileInformation::PacketStats_Set(true);
+        } else if (a.arguments().at(i) == "-fast-probe")
+        {
+            FileInformation::FastProbe_Set(true);
+        } else if (a.arguments().at(i) == "-mkv-columns")
+        {
+            FileInformation::MkvColumns_Set(true);
+        } else if (a.arguments().at(i) == "-arrow-batch" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            auto frames = a.arguments().at(i + 1).toInt(&ok);
+            if(!ok || frames <= 0)
             {
-                std::cout << "QCvault location can not be saved." << std::endl;
+                std::cout << "-arrow-batch must be a count of frames." << std::endl;
                 configHasIssues = true;
-                continue;
             }
-            std::cout << "QCvault set to " << useQCvault.toStdString() << std::endl;
-        } else if (a.arguments().at(i) == "-show-qcvault")
+            else
+                StatsArrowReport::BatchFrames_Set(frames);
+            ++i;
+        } else if (a.arguments().at(i) == "--merge")
         {
-            configIsSet = true;
-            bool HasError;
-            auto QCvaultPathString = prefs.QCvaultPathString(&HasError);
-            if (HasError)
+            merge = true;
+        } else if (a.arguments().at(i) == "--index" && (i + 1) < a.arguments().length())
+        {
+            indexFileName = a.arguments().at(i + 1);
+            ++i;
+        } else if (a.arguments().at(i) == "--query" && (i + 1) < a.arguments().length())
+        {
+            query = a.arguments().at(i + 1);
+            ++i;
+        } else if (a.arguments().at(i) == "--estimate")
+        {
+            estimate = true;
+        } else if (a.arguments().at(i) == "--calibration" && (i + 1) < a.arguments().length())
+        {
+            calibrationFileName = a.arguments().at(i + 1);
+            ++i;
+        } else if (a.arguments().at(i).startsWith("--progress="))
+        {
+            auto mode = a.arguments().at(i).mid(QString("--progress=").length());
+            if(mode == "json" || mode == "bar")
+                progressJson = mode == "json";
+            else
             {
-                std::cout << "Default QCvault location not available, use -qcvault instead, analyzing stopped." << std::endl;
+                std::cout << "--progress must be bar or json." << std::endl;
                 configHasIssues = true;
-                continue;
             }
-            if (QCvaultPathString.isEmpty())
-                std::cout << "QCvault path is not set." << std::endl;
+        } else if (a.arguments().at(i) == "--stats-interval" && (i + 1) < a.arguments().length())
+        {
+            bool ok = false;
+            auto interval = a.arguments().at(i + 1).toDouble(&ok);
+            if(ok && interval > 0)
+                statsInterval = qMax(1, int(interval * 1000));
             else
-                std::cout << "QCvault path is " << QCvaultPathString.toStdString() << '.' << std::endl;
-        } else if (a.arguments().at(i) == "-s")
+            {
+                std::cout << "--stats-interval must be a count of seconds greater than 0." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
+        } else if (a.arguments().at(i) == "-hwdec" && (i + 1) < a.arguments().length())
         {
-            createMkv = false;
-        } else if (a.arguments().at(i) == "-a")
+            // Read by the demuxer of each parser, software decoding if the device or the codec is not supported
+            qputenv("QT_AVPLAYER_HWDECODE", a.arguments().at(i + 1).toUtf8());
+            ++i;
+        } else if (a.arguments().at(i) == "-hwfilters")
         {
-            createMkv = true;
+            FileInformation::GpuFilters_Set(true);
+        } else if (a.arguments().at(i) == "-hwdevices" && (i + 1) < a.arguments().length())
+        {
+            hwDevices = a.arguments().at(i + 1).split(',');
+            ++i;
+        } else if (a.arguments().at(i) == "-hwsessions" && (i + 1) < a.arguments().length())
+        {
+            hwSessions = a.arguments().at(i + 1).toInt();
+            if (hwSessions <= 0)
+            {
+                std::cout << "-hwsessions must be a count of decoders greater than 0." << std::endl;
+                configHasIssues = true;
+            }
+            ++i;
         } else if (a.arguments().at(i) == "-show-panels")
         {
             configIsSet = true;
@@ -373,12 +1456,43 @@ int Cli::exec(QCoreApplication &a)
         prefs.setActiveAllTracks(activeAllTracks);
     }
 
+    // -detect, for the stats created afterwards
+    QString detectorsError;
+    if (!StatsDetectors::Set(detectorSpecs, &detectorsError))
+    {
+        std::cout << "-detect " << detectorsError.toStdString() << "." << std::endl;
+        configHasIssues = true;
+    }
+
+    // -profile without -f, the filters of the profile
+    auto analysisProfile = (AnalysisProfiles::profile)FileInformation::AnalysisProfile_Get();
+    if (analysisProfile != AnalysisProfiles::Profile_Full && filterStrings.empty())
+    {
+        auto profileFilters = AnalysisProfiles::Filters(analysisProfile);
+        for(int filter = 0; filter < ActiveFilter_Max; ++filter)
+            if(profileFilters.test(filter))
+                filterStrings.append(ActiveFilter_Name((activefilter)filter));
+    }
+
+    if (!hwDevices.isEmpty() && !qEnvironmentVariableIsSet("QT_AVPLAYER_HWDECODE"))
+    {
+        std::cout << "-hwdevices needs -hwdec." << std::endl;
+        configHasIssues = true;
+    }
+
     if (configHasIssues)
         return InvalidInput;
 
+    // One file is decoded on the first device, the files of a batch are spread
+    Batch::setHardwareDevices(hwDevices, hwSessions);
+    if (!hwDevices.isEmpty())
+        FileInformation::HardwareDevice_Set(hwDevices.first());
+
+    QCTOOLS_TRACE(Category_Startup, "options parsed at {} ms", Tracing::elapsed());
+
     if(!showLongHelp)
     {
-        if(a.arguments().length() == 1 || (checkUploadFileName.isEmpty() && input.isEmpty()))
+        if(a.arguments().length() == 1 || (checkUploadFileName.isEmpty() && input.isEmpty() && !serve))
             showShortHelp = true;
     }
 
@@ -391,6 +1505,9 @@ int Cli::exec(QCoreApplication &a)
         return Success;
     }
 
+    if(showCpuFeatures)
+        return reportCpuFeatures();
+
     if(showLongHelp || showShortHelp)
     {
         if (configIsSet)
@@ -411,18 +1528,436 @@ int Cli::exec(QCoreApplication &a)
                 << std::endl
                 << "-i <input file>" << std::endl
                 << "    Specifies absolute path of input file, including extension." << std::endl
+                << "    May be used several times for analyzing several files (see -jobs)." << std::endl
+                << "-manifest <manifest file>" << std::endl
+                << "    Analyze the files listed in <manifest file>, one path per line (relative" << std::endl
+                << "    to the manifest directory), empty lines and lines starting with # ignored." << std::endl
+                << "--serve [<socket name>|tcp:[<address>:]<port>]" << std::endl
+                << "    Keep running and analyze the files sent as JSON lines, on stdin, to the local" << std::endl
+                << "    socket <socket name> or to the TCP port if set (of localhost if <address> is not set)," << std::endl
+                << "    e.g. {\"id\": 1, \"input\": \"file.mkv\"}" << std::endl
+                << "    (other members: output, filters, report (mkv or xml.gz), force, stream, segments," << std::endl
+                << "    start, end, priority; default to the command line options) or {\"command\": \"quit\"}." << std::endl
+                << "    With \"send\": true, the xml.gz report is written in a temporary directory of the" << std::endl
+                << "    server (output is ignored) and sent to the client while it is written (report" << std::endl
+                << "    events followed by its bytes, nothing more if the job fails), e.g. for qctools-gui opening" << std::endl
+                << "    qcli://<host>:<port>/<path of the file on the server>." << std::endl
+                << "    Events (queued, started, paused, resumed, progress, warning, finished with the" << std::endl
+                << "    seconds waited and run, error) are sent back as JSON lines, with the id of the" << std::endl
+                << "    job. Files share the pool of -jobs." << std::endl
+                << "--serve-token <token>" << std::endl
+                << "    With --serve, the first line of the clients of the socket must be" << std::endl
+                << "    {\"token\": \"<token>\"}, else they are disconnected; needed for a TCP <address>" << std::endl
+                << "    other than a loopback one. With --coordinate, sent to the workers. Default is the" << std::endl
+                << "    QCTOOLS_SERVE_TOKEN environment variable (also used by qctools-gui for qcli:// files)." << std::endl
+                << "--serve-root <directory>" << std::endl
+                << "    With --serve, the input and output paths of the clients of the socket must be in" << std::endl
+                << "    <directory> (relative ones are relative to it), default is the current directory." << std::endl
+                << "    Inputs may also be http(s) URLs. With --serve-http, the directory of the reports." << std::endl
+                << "--serve-http [<address>:]<port>" << std::endl
+                << "    With --serve, also answer HTTP GET requests (on localhost if <address> is not set)" << std::endl
+                << "    for the values of the reports of --serve-root, decimated for" << std::endl
+                << "    plotting: /columns?report=<path> (streams and column names, JSON) and" << std::endl
+                << "    /slice?report=<path>&stream=<index>&columns=YAVG,BRNG&start=<frame>&end=<frame>" << std::endl
+                << "    &points=<count> (minimum and maximum of each bucket of frames, float32 binary)," << std::endl
+                << "    and /metrics (counters of the jobs in OpenMetrics format, for Prometheus: files" << std::endl
+                << "    queued, running and finished, frames, bytes read, decoding, filtering and" << std::endl
+                << "    backpressure times and memory of each file by job, codec and resolution)." << std::endl
+                << "    <path> is relative to --serve-root, without \"..\"." << std::endl
+                << "--serve-http-origin <origin>" << std::endl
+                << "    With --serve-http, origin allowed to read the replies from a page served elsewhere" << std::endl
+                << "    (Access-Control-Allow-Origin), e.g. https://dashboard.example.com or *. Default is none." << std::endl
+                << "--coordinate <worker,...>" << std::endl
+                << "    Analyze the -i file with the --serve workers given as <host>:<port> (see --serve" << std::endl
+                << "    tcp:<port>) or local socket names: the file is split at key frames, the shards are" << std::endl
+                << "    analyzed by the workers (again by another worker if one fails or is slow) and their" << std::endl
+                << "    reports are merged in the -o report (default <input>.qctools.xml.gz, not .qctools.mkv)." << std::endl
+                << "    The workers must read the same input path, on a shared storage or an URL, and the" << std::endl
+                << "    reports of the shards are written next to the output, so it must be shared too." << std::endl
+                << "--live [<window>]" << std::endl
+                << "    Analyze the -i live stream (e.g. an SRT, UDP or RTMP URL), which may never end," << std::endl
+                << "    in a bounded memory: no report, only JSON lines on stdout, the min, max and average" << std::endl
+                << "    of each item over the last <window> seconds (10 is default) every second, the start" << std::endl
+                << "    and the end of the violations of -thresholds as alerts, and a decimated history of" << std::endl
+                << "    the whole analysis at the end of the stream. Messages go to stderr." << std::endl
+                << "--follow [<idle>]" << std::endl
+                << "    Analyze the input files while they are written (feeds recorded by an ingest" << std::endl
+                << "    server): the parser waits for the next bytes at the end of the file, until its" << std::endl
+                << "    sentinel file exists (see -follow-sentinel) or it did not grow for <idle> seconds" << std::endl
+                << "    (30 is default). Not with -segments, --packet-stats nor key frame previews." << std::endl
+                << "-follow-sentinel <suffix>" << std::endl
+                << "    Name of the file written once an input file is complete, the name of the input" << std::endl
+                << "    file followed by <suffix> (.done is default, empty for none)." << std::endl
+                << "--watch <folder>" << std::endl
+                << "    Analyze the media files landing in <folder>, until stopped: a file is started once" << std::endl
+                << "    its sentinel exists or it did not grow for the --follow idle time (30 s by default)," << std::endl
+                << "    or as soon as it is not empty with --follow. Reports are written next to the files." << std::endl
+                << "--convert <folder or report>" << std::endl
+                << "    Convert the XML reports (.qctools.xml.gz, .qctools.xml.zst, .qctools.xml) of the folder" << std::endl
+                << "    and of its subfolders, without their media: their columns cache (.qctools.cols) and" << std::endl
+                << "    their columnar report (.qctools.columns) are written next to them, then read back and" << std::endl
+                << "    compared with the report. -jobs reports are converted at the same time (one per core is" << std::endl
+                << "    default). Reports converted by a previous run and not changed since are skipped, unless" << std::endl
+                << "    -y is used. May be used several times." << std::endl
+                << "-shards <count>" << std::endl
+                << "    With --coordinate, count of shards (0 for 2 per pipeline of the workers, is default)." << std::endl
+                << "--readahead [<block size>[:<blocks>]]" << std::endl
+                << "    Read the local input files ahead by a thread, in blocks of <block size> KiB" << std::endl
+                << "    (4096 is default), <blocks> blocks ahead of the parser (8 is default), for files" << std::endl
+                << "    on network storage (NFS, object storage mounted with FUSE). Default is off." << std::endl
+                << "-pipe-buffer <size>" << std::endl
+                << "    With -i - (standard input, e.g. the output of a transcoder), MiB read ahead of" << std::endl
+                << "    the parser at most (64 is default), the writer waits when they are not read yet." << std::endl
+                << "--io=<read|uring>" << std::endl
+                << "    How the local input files are read: blocking reads (default), or io_uring on" << std::endl
+                << "    Linux 5.6 and later, for NVMe storage: the blocks of --readahead (8 blocks by" << std::endl
+                << "    default) or the images of -sequence-ahead are read at the same time." << std::endl
+                << "-sequence-ahead <count>" << std::endl
+                << "    With a DPX sequence as input, count of the next images opened and read at the" << std::endl
+                << "    same time while the current one is decoded (4 is default, 0 for none)." << std::endl
+                << "-jobs <count>" << std::endl
+                << "    With several input files, count of parsing pipelines shared by the files" << std::endl
+                << "    (0 for one pipeline per 2 cores, is default). Each file uses from 1 pipeline" << std::endl
+                << "    (SD) to several (HD and more, depending on the filters, see -segments) and" << std::endl
+                << "    its report is written as soon as it is analyzed. Signal Server flags and -o" << std::endl
+                << "    are not available with several input files." << std::endl
+                << "-lookahead <count>" << std::endl
+                << "    With several input files or --serve, count of the next files checked, probed" << std::endl
+                << "    and prepared while the running ones are analyzed, so the pipelines do not wait" << std::endl
+                << "    for the storage between files (2 is default, 0 for none, not with -numa)." << std::endl
+                << "-priority <low|normal|high>" << std::endl
+                << "    With several input files or --serve, priority of the files (normal is default)." << std::endl
+                << "    Files of a higher priority are started first and, when the pipelines are all used," << std::endl
+                << "    pause the analysis of the files of a lower priority, resumed once they are free." << std::endl
+                << "-decoder-pool <count>" << std::endl
+                << "    With several input files or --serve, count of the decoders of the files analyzed" << std::endl
+                << "    kept open and reused by the next files with streams of the same format, e.g. short" << std::endl
+                << "    clips of the same format (4 is default, 0 for none, not the hardware decoders)." << std::endl
+                << "-numa" << std::endl
+                << "    With several input files or -serve, split the pipelines of -jobs between the NUMA" << std::endl
+                << "    nodes (sockets) of the machine and keep the demux, decode and filter threads and the" << std::endl
+                << "    frames of each file on one node (Linux). The files and parsing time of each node are" << std::endl
+                << "    shown at the end, for comparison with a run without this option." << std::endl
+                << "-plugins <plugin file or directory>" << std::endl
+                << "    Loads analyzer plugins (see Core/AnalyzerPlugin.h), e.g. detectors of logos or" << std::endl
+                << "    dropouts. They run on the frames of the stats in the same decode pass, their values" << std::endl
+                << "    are additional stats of the streams. Plugins are also loaded from the paths of the" << std::endl
+                << "    QCTOOLS_ANALYZER_PLUGINS environment variable. Disables the segmented parsing." << std::endl
                 << "-o <output file>" << std::endl
                 << "    Specifies output file path, including extension. If no output file is" << std::endl
                 << "    declared, qctools will create an output named after the input file, suffixed" << std::endl
                 << "    with \".qctools.xml.gz\" (if -s used) or  \".qctools.mkv\" (if -a used)." << std::endl
+                << "    An output ending with \".qctools.columns\" is a columnar report (stats" << std::endl
+                << "    only, one binary column per value, faster to load than XML)." << std::endl
+                << "    An output ending with \".arrow\" or \".feather\" is an Arrow IPC table (stats" << std::endl
+                << "    only, one row per frame, read directly by pyarrow, pandas, polars or DuckDB and" << std::endl
+                << "    converted by them to Parquet)." << std::endl
+                << "    \"-\" writes the .qctools.xml.gz report to the standard output and \"-.xml\" the" << std::endl
+                << "    uncompressed XML, with the messages on the standard error. With -stream, it" << std::endl
+                << "    is sent while the file is analyzed." << std::endl
                 << "-s" << std::endl
                 << "    Stats only (no thumbnails, no panels)." << std::endl
                 << "-a" << std::endl
                 << "    All (stats + thumbnails + panels)." << std::endl
                 << "    Is default." << std::endl
+                << "-compact" << std::endl
+                << "    Keep stats in memory as float32/int32 instead of double (lower memory usage," << std::endl
+                << "    values are rounded to the precision needed by each item)." << std::endl
+                << "-thumbnails-decimation <count>" << std::endl
+                << "    Keep one thumbnail out of <count> frames in memory (.qctools.mkv output)," << std::endl
+                << "    the report repeats the kept thumbnail for the other frames. Default is 1." << std::endl
+                << "-thumbnails-uncompressed" << std::endl
+                << "    Keep the thumbnails uncompressed in memory (faster, uses more memory)." << std::endl
+                << "-thumbnails-mipmap" << std::endl
+                << "    Thumbnails of 144x144, 72x72 and 36x36 from one downscale of each frame; the" << std::endl
+                << "    tiles of -sprites are 144x144, the thumbnails of the report stay 72x72." << std::endl
+                << "-panels-in-memory" << std::endl
+                << "    Keep the panel frames in memory instead of a temporary file until the" << std::endl
+                << "    .qctools.mkv report is written (memory grows with the duration)." << std::endl
+                << "-memory-limit <MB>" << std::endl
+                << "    Memory the analysis of the input file may use (0 for no limit, default). Near it" << std::endl
+                << "    and near the limit of the cgroup of the process, the panel frames are spilled to" << std::endl
+                << "    temporary files, then the thumbnails decimated, the stats compressed in memory" << std::endl
+                << "    and at last the panels dropped, with a comment in the report at the frame." << std::endl
+                << "-no-cgroup-limit" << std::endl
+                << "    Do not use the memory limit of the cgroup (container) of the process." << std::endl
+                << "-stream" << std::endl
+                << "    Write the stats report while the input file is analyzed instead of after" << std::endl
+                << "    (frames of the different streams are interleaved by batches)." << std::endl
+                << "-segments <count>" << std::endl
+                << "    Analyze the input file as <count> segments in parallel, split at video key" << std::endl
+                << "    frames (0 for one segment per 2 cores). Stats only, not used with a" << std::endl
+                << "    .qctools.mkv output, pipes, DPX sequences or the EBU R128 filter." << std::endl
+                << "-threads <count>" << std::endl
+                << "    Threads of the video decoder of each parsing pipeline (0 for the cores count" << std::endl
+                << "    divided by the pipelines running at the same time, so one file uses all the" << std::endl
+                << "    cores). Default to the preferences, else 0." << std::endl
+                << "-thread-type <frame|slice|auto>" << std::endl
+                << "    Threading of the video decoder, auto means frame and slice threading." << std::endl
+                << "-filter-threads <count>" << std::endl
+                << "    Threads of the filter graph of each parsing pipeline (slice threading of the" << std::endl
+                << "    filters), 0 as for -threads." << std::endl
+                << "-decode-ahead <count>" << std::endl
+                << "    Frames of each stream decoded by a thread of their own while the frames" << std::endl
+                << "    before are filtered (default 4), 0 to decode in the thread of the filters." << std::endl
+                << "-cpu <c|avx2|avx512|neon>" << std::endl
+                << "    Instruction set of the native kernels (signalstats, field PSNR and SSIM, audio" << std::endl
+                << "    stats), to compare them. Default is the best one of the CPU." << std::endl
+                << "--cpu-features" << std::endl
+                << "    Show the features of the CPU and the instruction sets of the native kernels it has," << std::endl
+                << "    then the speed of the kernels with each of them on synthetic frames." << std::endl
+                << "-thumbnails-codec <encoder>[:<option>=<value>...]" << std::endl
+                << "-panels-codec <encoder>[:<option>=<value>...]" << std::endl
+                << "    Encoder of the thumbnails or of the panels in the .qctools.mkv report, with" << std::endl
+                << "    its FFmpeg options and pix_fmt, e.g. ffv1:slices=4:threads=2 or png:pred=none." << std::endl
+                << "    Default is mjpeg, intra encoders only." << std::endl
+                << "-compression <none|gzip|zstd>" << std::endl
+                << "    Compression of the report when its name is not given (<input>.qctools.xml," << std::endl
+                << "    <input>.qctools.xml.gz or <input>.qctools.xml.zst), else the one of its extension." << std::endl
+                << "    Default is gzip, zstd only if built with it. Reports are read whatever their compression." << std::endl
+                << "-compression-level <level>" << std::endl
+                << "    Compression level of the report, 0 (stored) to 9 for gzip, 1 to 22 for zstd." << std::endl
+                << "    Default is the one of the library." << std::endl
+                << "-mkv-columns" << std::endl
+                << "    Attach the stats to the .qctools.mkv report as a .qctools.columns report instead of" << std::endl
+                << "    the .qctools.xml.gz one, read without decompression when the report is opened." << std::endl
+                << "-separate-filter-graphs" << std::endl
+                << "    Run the stats, thumbnails and each panel in their own filter graph instead of" << std::endl
+                << "    one graph per stream type sharing the common filters (for comparison)." << std::endl
+                << "-stats-branches <count>" << std::endl
+                << "    Split the stats filters in this count of filter graphs run by several threads," << std::endl
+                << "    their metadata are merged back by frame. 1 runs them in one chain, 0 (default)" << std::endl
+                << "    uses half of the cores of each parsing pipeline, at most 4." << std::endl
+                << "-signalstats-kernel <on|off|check>" << std::endl
+                << "    Compute the signalstats values natively (SIMD) instead of with the FFmpeg filter," << std::endl
+                << "    check runs both and reports the frames where they differ. Default is off." << std::endl
+                << "-field-kernel <on|off|check>" << std::endl
+                << "    Compare the fields with psnr and ssim natively (SIMD), from the lines of the frame," << std::endl
+                << "    instead of with the split, field, psnr and ssim filters, check runs both and reports" << std::endl
+                << "    the frames where they differ. Not used with -compare. Default is off." << std::endl
+                << "-audio-kernel <on|off>" << std::endl
+                << "    Compute astats, aphasemeter and ebur128 natively (SIMD) in one pass over all the" << std::endl
+                << "    channels, without the stereo downmix and the resampling of the filters. Default is off." << std::endl
+                << "-audio-window <seconds>" << std::endl
+                << "    Length of the window of the RMS peak and trough of astats. Default is 0.4." << std::endl
+                << "-audio-rows <frames|video|seconds>" << std::endl
+                << "    One row of audio stats per decoded frame (default), per frame of the first video" << std::endl
+                << "    stream, or per window of this count of seconds; the audio values of each row are" << std::endl
+                << "    the ones of the samples of its window." << std::endl
+                << "-profile <full|luma-only|broadcast-legal>" << std::endl
+                << "    Columns analyzed: full (default) for all the ones of the filters selected, luma-only" << std::endl
+                << "    for the luma of signalstats (its chroma planes are not read), blockdetect, blurdetect" << std::endl
+                << "    and blackdetect, broadcast-legal for the levels of signalstats (extremes, saturation" << std::endl
+                << "    and BRNG), astats and ebur128. Without -f, the filters of the profile are selected." << std::endl
+                << "-filter-timings" << std::endl
+                << "    Show the time spent in each filter graph, by outputs, once the file is analyzed." << std::endl
+                << "-range-summary <all|first-last>" << std::endl
+                << "    Show the minimum, maximum and average of each value and the count of frames over" << std::endl
+                << "    its limits, from the first to the last frame (included), once the file is analyzed." << std::endl
+                << "-detect <FFmpeg name>:<method>[:<name>=<value>...]" << std::endl
+                << "    Detect sudden changes of a value while the file is analyzed, in the comments of the" << std::endl
+                << "    frames (so in the report) and as \"detected\" events with --progress=json. Methods:" << std::endl
+                << "    zscore (k=4 standard deviations from the weighted mean, alpha=0.05, warmup=30 frames)," << std::endl
+                << "    cusum (h=8, slack=0.5, alpha, warmup), jump (delta=<difference with the previous frame>)" << std::endl
+                << "    and flip (level=0.5, from above level to below -level or the reverse), e.g." << std::endl
+                << "    lavfi.signalstats.YAVG:zscore:k=5 or lavfi.aphasemeter.phase:flip. May be repeated." << std::endl
+                << "    Each segment of -segments is detected from its first frame." << std::endl
+                << "-summary <file>" << std::endl
+                << "    Write the summary of each value of the whole file as JSON once the file is analyzed:" << std::endl
+                << "    minimum, maximum, mean, standard deviation, percentiles, frames and seconds over its" << std::endl
+                << "    limits, and its t-digest and histogram, to merge with the ones of other parts of the" << std::endl
+                << "    file. Values of the crop items are the margins (as analyzed), not the positions." << std::endl
+                << "-thresholds <preset file>" << std::endl
+                << "    Evaluate the thresholds of a JSON preset ({\"filters\": [{\"id\", \"enabled\", \"metrics\":" << std::endl
+                << "    {<FFmpeg name>: {\"threshold\": {\"min\", \"max\"}}}}]}) while the file is analyzed and write" << std::endl
+                << "    only the aggregates and the ranges of frames out of the bounds, as JSON, in the output" << std::endl
+                << "    file (default named after the input file, suffixed with \".qctools.thresholds.json\")" << std::endl
+                << "    instead of the report. The filters are the enabled ones of the preset if -f is not used." << std::endl
+                << "-checkpoint <seconds>" << std::endl
+                << "    Every <seconds> while analyzing, write the stats of the frames analyzed since the" << std::endl
+                << "    previous checkpoint in <qctools-report>.checkpoint<N>.qctools.xml.gz, with the time" << std::endl
+                << "    reached in <qctools-report>.checkpoint.json. They are removed once the report is" << std::endl
+                << "    written. The file is analyzed in one segment. Not with a .qctools.mkv output." << std::endl
+                << "--resume" << std::endl
+                << "    Continue an analysis stopped after some checkpoints (same -i and -o): the file is" << std::endl
+                << "    analyzed from the time of the last checkpoint (read from some seconds before, as with" << std::endl
+                << "    --start) and the checkpoints are merged with it in the report. Without checkpoints" << std::endl
+                << "    the file is analyzed from the start. Use with -checkpoint for further checkpoints." << std::endl
+                << "-compare <reference>" << std::endl
+                << "    Compare each frame of the input with the frame of <reference> at the same time" << std::endl
+                << "    (e.g. a transcode with its mezzanine source): the psnr and ssim values of the report" << std::endl
+                << "    are between the 2 files instead of between the fields. <reference> is decoded at the" << std::endl
+                << "    same time, scaled to the size of the input, and its time stamps start with the ones" << std::endl
+                << "    of the input. The file is analyzed in one segment." << std::endl
+                << "-compare-vmaf <log.json>" << std::endl
+                << "    With -compare, also compute VMAF (FFmpeg with libvmaf), the scores of each frame" << std::endl
+                << "    are written in <log.json>." << std::endl
+                << "--roi <width>:<height>:<x>:<y>" << std::endl
+                << "    Compute the video stats on this rectangle of the frames only (in pixels of the" << std::endl
+                << "    decoded frames, as the crop filter), e.g. the picture of letterboxed or pillarboxed" << std::endl
+                << "    content or a burn-in area: the cost of the video filters is about the one of the" << std::endl
+                << "    region. Panels, thumbnails and audio stats are not changed. Not with -compare." << std::endl
+                << "-skip-duplicates" << std::endl
+                << "    Video frames with the same pixels as the previous frame (freeze frames, slates," << std::endl
+                << "    animation on twos...) are not filtered again: they get the stats of the previous" << std::endl
+                << "    frame with no differences (YDIF, UDIF and VDIF are 0) and 1 in qctools.duplicate." << std::endl
+                << "    Not with idet, deflicker, entropy-diff, blackdetect, freezedetect, -compare or -plugins." << std::endl
+                << "-framehash <algorithm>" << std::endl
+                << "    Hash of each decoded video and audio frame in the framehash.<algorithm> item of the" << std::endl
+                << "    report, for fixity checks without another decoding: the data hashed is the one of" << std::endl
+                << "    ffmpeg -f framemd5 (or framehash) for the raw format of the decoded frames." << std::endl
+                << "    <algorithm> is MD5, murmur3, CRC32, SHA256... as the hash option of framehash." << std::endl
+                << "-captions-timecode" << std::endl
+                << "    Closed captions and timecode of each video frame in the report, read from the" << std::endl
+                << "    frames while they are analyzed: qctools.cc.608 and qctools.cc.708 are the count of" << std::endl
+                << "    CEA-608 and CEA-708 byte pairs with data (A/53 captions), qctools.timecode is the" << std::endl
+                << "    SMPTE 12M timecode of the frame (else the one of the stream plus its position) and" << std::endl
+                << "    qctools.timecode.discontinuity is 1 where it does not follow the previous one." << std::endl
+                << "-reanalyze" << std::endl
+                << "    When the input has a report, only the filters of -f the report does not have are run," << std::endl
+                << "    on the media decoded again without thumbnails and panels; their values are merged in" << std::endl
+                << "    the report, which is written with all its filters (use -y to replace it). Frames are" << std::endl
+                << "    matched by position, the report must have all the frames of the file." << std::endl
+                << "-snapshots <directory>" << std::endl
+                << "    Write full resolution stills of frames while the file is analyzed, named" << std::endl
+                << "    s<stream>_f<frame>.<format>: the frames of -snapshot-times and, with -thresholds, the" << std::endl
+                << "    first frame of each range out of the bounds (also in the \"snapshot\" of the violation)." << std::endl
+                << "    The file is analyzed in one segment." << std::endl
+                << "-snapshots-format <jpg|png>" << std::endl
+                << "    Format of the stills. Default is jpg." << std::endl
+                << "-snapshot-times <seconds,...>" << std::endl
+                << "    Presentation times of the frames to write with -snapshots, as in the reports." << std::endl
+                << "-frame-feed <directory>" << std::endl
+                << "    Write downscaled grayscale frames while the file is analyzed, one by interval of each" << std::endl
+                << "    video stream (e.g. for text detection by OCR without decoding the file again), as" << std::endl
+                << "    binary PGM files named s<stream>_t<milliseconds>.pgm; a file is complete once it has" << std::endl
+                << "    this name. The file is analyzed in one segment." << std::endl
+                << "-frame-feed-interval <seconds>" << std::endl
+                << "    Time between two frames of -frame-feed. Default is 1." << std::endl
+                << "-frame-feed-width <pixels>" << std::endl
+                << "    Maximum width of the frames of -frame-feed, the height keeps the ratio. Default is 640." << std::endl
+                << "-sprites <directory>" << std::endl
+                << "    Write sprite sheets of the thumbnails (72x72) while the file is analyzed, for timelines" << std::endl
+                << "    without reading the media: sheets of 10x10 thumbnails sprites_<n>.<format> and their" << std::endl
+                << "    index sprites.json (time stamp, frame, shot start, sheet and position of each thumbnail)." << std::endl
+                << "    Thumbnails are the first frames of the shots (cuts found with the luma differences of" << std::endl
+                << "    signalstats), and more in the shots longer than the interval. The file is analyzed in" << std::endl
+                << "    one segment." << std::endl
+                << "-sprites-per-minute <count>" << std::endl
+                << "    Thumbnails by minute of a shot in the sheets of -sprites, a shot starting less than half" << std::endl
+                << "    this interval after the previous thumbnail has none. Default is 60." << std::endl
+                << "-sprites-format <jpg|webp>" << std::endl
+                << "    Format of the sheets of -sprites. Default is jpg." << std::endl
+                << "--start <seconds|frame f>, --end <seconds|frame f>" << std::endl
+                << "    Analyze only the frames from --start (included) to --end (excluded), as presentation" << std::endl
+                << "    times in seconds as in the reports or as frame numbers of the first video stream" << std::endl
+                << "    from 0 (e.g. 1500f). The file is read from some seconds before --start for the" << std::endl
+                << "    filters depending on the previous frames, in one segment. Time stamps of the report" << std::endl
+                << "    are kept, so reports of consecutive ranges can be merged." << std::endl
+                << "    With a report as input, writes the report of the range only (-o), e.g. a problem part" << std::endl
+                << "    to send to a reviewer: the frames of the range, with their thumbnails and panels" << std::endl
+                << "    copied from a .qctools.mkv report when they start with a key frame. The range starts" << std::endl
+                << "    with the first frame of its panel." << std::endl
+                << "--sample-every <count|key>, --sample-rate <frames per second>" << std::endl
+                << "    Analyze one video frame of <count>, the key frames only (the other frames are not" << std::endl
+                << "    decoded) or <frames per second> frames per second, for a preview report much faster" << std::endl
+                << "    than the full analysis. Times and durations of the report are the ones of the frames" << std::endl
+                << "    analyzed, so the frames not analyzed are gaps between them. Audio is fully analyzed." << std::endl
+                << "-lowres <0-3>" << std::endl
+                << "    Decode the video at its width and height divided by 2, 4 or 8, for a preview report" << std::endl
+                << "    faster than the full analysis. Only some decoders support it (JPEG 2000, MJPEG...)," << std::endl
+                << "    the others decode the full size. The sizes of the report are the decoded ones." << std::endl
+                << "-skip-nonref" << std::endl
+                << "    Do not decode the video frames no other frame refers to (B frames of most codecs)." << std::endl
+                << "-packet-stats" << std::endl
+                << "    Read the packets without decoding them, for a bitrate and GOP report at the speed of" << std::endl
+                << "    the disk: time stamps, durations, positions, sizes, key frames and picture types (from" << std::endl
+                << "    the bitstream) only, the filters are not run. Not for live streams and pipes." << std::endl
+                << "-fast-probe" << std::endl
+                << "    Take the parameters of the streams from the headers when the container has all of them" << std::endl
+                << "    (MXF, MOV...), else from the first MiB and second of packets, and probe the file fully only" << std::endl
+                << "    if parameters are still missing (e.g. MXF files with many audio tracks, DPX sequences)." << std::endl
+                << "-arrow-batch <frames>" << std::endl
+                << "    Frames per record batch of an .arrow output. Default is 65536." << std::endl
+                << "--two-pass <preset file>" << std::endl
+                << "    Analyze the key frames of the video (or the frames of --sample-every or --sample-rate)" << std::endl
+                << "    first, then all the frames of the ranges where a value of the thresholds preset (see" << std::endl
+                << "    -thresholds) is out of the bounds or near them, in a report of all the frames in these" << std::endl
+                << "    ranges and of the sampled frames elsewhere. The filters of the preset are added to the" << std::endl
+                << "    filters analyzed. Not with a .qctools.mkv output." << std::endl
+                << "-triage-tolerance <fraction>" << std::endl
+                << "    With --two-pass, values nearer to a bound than this fraction of the bound are suspect." << std::endl
+                << "    Default is 0.2." << std::endl
+                << "-triage-margin <seconds>" << std::endl
+                << "    With --two-pass, seconds analyzed before and after each suspect range. Default is 2." << std::endl
+                << "--merge" << std::endl
+                << "    Merge the stats of the reports given with -i (.qctools.xml.gz, .qctools.mkv or" << std::endl
+                << "    .qctools.columns) of consecutive ranges of the same media, e.g. from --start and" << std::endl
+                << "    --end, in one report given with -o (not .qctools.mkv), without decoding the media." << std::endl
+                << "    Frames are in time stamp order, overlapping ones are kept from the first report." << std::endl
+                << "    Streams and formats are from the first report, thumbnails and panels are not merged." << std::endl
+                << "--index <database>" << std::endl
+                << "    Add the summaries of the report to an SQLite database of reports, replacing the" << std::endl
+                << "    previous ones of the report: the reports given with -i (with the violations of" << std::endl
+                << "    -thresholds) or the report written. Several processes may add reports at the same time." << std::endl
+                << "--query <query>" << std::endl
+                << "    With --index, print the reports matching \"<metric> <op> <value> [for <seconds>]\", op is" << std::endl
+                << "    >, >=, < or <=, e.g. \"BRNG > 0.1 for 10\": all the frames of 10 consecutive seconds are" << std::endl
+                << "    above 0.1 (any frame without \"for\"), durations are rounded up to 1 to 10, 15, 20, 30" << std::endl
+                << "    or 45 seconds, then 1, 1.5, 2, 3, 5, 10, 15, 20, 30, 45 or 60 minutes. One line per" << std::endl
+                << "    stream: report, media, stream index, metric and peak or bound of the run, tab separated." << std::endl
+                << "    A query starting with SELECT or WITH is SQL on the tables reports, keys, metrics, runs" << std::endl
+                << "    and violations, with the names of the columns on the first line." << std::endl
+                << "--estimate" << std::endl
+                << "    Do not analyze the input, show as JSON the estimate of the analysis with the options" << std::endl
+                << "    given: wall time on this machine (wall_seconds), peak memory (peak_memory_mb) and size" << std::endl
+                << "    of the output (output_bytes), from the probe of the input and the filters and panels." << std::endl
+                << "--calibration <file>" << std::endl
+                << "    Results of qctools-bench on this machine (-o of qctools-bench) the rates of --estimate" << std::endl
+                << "    are computed from, else the rates are the ones of a recent 8-core machine." << std::endl
+                << "--progress=<bar|json>" << std::endl
+                << "    Show the progress as a bar (default) or as JSON objects, one per line, on stdout" << std::endl
+                << "    (on stderr with -o -): {\"event\": \"phase\"} when parse, export, mkv, upload, shards or ranges starts," << std::endl
+                << "    \"progress\" with the percent, the elapsed time and the ETA in seconds, plus the frames" << std::endl
+                << "    of each stream and the frames/s while analyzing, \"warning\" and \"finished\" with the" << std::endl
+                << "    exit code; \"started\" and \"done\" by file with several input files. Other messages" << std::endl
+                << "    are then on stderr." << std::endl
+                << "--stats-interval <seconds>" << std::endl
+                << "    Show the counters of the analysis at this interval and once the file is analyzed:" << std::endl
+                << "    read MB/s, decoded frames/s, time in each filter graph, queued packets and time" << std::endl
+                << "    waiting on full queues, for finding if it is bound by reading, decoding or filtering." << std::endl
+                << "--trace <categories>" << std::endl
+                << "    Write a message per frame of the parser (frames), per panel (panels) or per step of" << std::endl
+                << "    the startup with its time (startup), \"all\" for all of them," << std::endl
+                << "    with --log to its files else to stderr. Needs a build with CONFIG+=tracing." << std::endl
+                << "--trace-events <file>" << std::endl
+                << "    Write the timeline of the analysis in this file in the Chrome trace event format" << std::endl
+                << "    (chrome://tracing, ui.perfetto.dev): demux reads, decode, filter graph writes and" << std::endl
+                << "    reads, queue waits, stats ingest, report chunks and encoder calls, by thread." << std::endl
+                << "-hwdec <device type>" << std::endl
+                << "    Decode the video on the hardware (e.g. vaapi, cuda, qsv, videotoolbox, d3d11va)," << std::endl
+                << "    frames are downloaded once to memory for the filters. Falls back to software" << std::endl
+                << "    decoding if the device or the codec is not supported." << std::endl
+                << "-hwfilters" << std::endl
+                << "    With -hwdec vaapi, cuda, qsv, vulkan or videotoolbox, keep the frames on the device:" << std::endl
+                << "    the thumbnails and the panels starting with a resize are scaled by the scaler of the" << std::endl
+                << "    device, and the frames are downloaded once for the stats. 4:2:0 8 or 10 bit video only," << std::endl
+                << "    else frames are downloaded by the decoder as with -hwdec alone." << std::endl
+                << "-hwdevices <device>[,<device>...]" << std::endl
+                << "    With -hwdec, devices of the type the files are decoded on (e.g. /dev/dri/renderD128," << std::endl
+                << "    /dev/dri/renderD129 for vaapi, 0,1 for cuda). With several input files, --serve or" << std::endl
+                << "    --watch, each file goes to the device with the most free decoder sessions (one per" << std::endl
+                << "    segment) and is decoded in software when all the devices are saturated; the files" << std::endl
+                << "    of each device are shown at the end. Else the first device is used." << std::endl
+                << "-hwsessions <count>" << std::endl
+                << "    With -hwdevices, decoders at the same time on each device, e.g. the limit of the" << std::endl
+                << "    driver or what fits in the memory of the device (default is -jobs split between" << std::endl
+                << "    the devices)." << std::endl
                 << "-qcvault <QCvault path>" << std::endl
                 << "    Use the indicated path as the QCvault location." << std::endl
                 << "    Use \"-qcvault default\" for using the standard QCvault location." << std::endl
+                << "    Reports are indexed by the content of the media, a file already analyzed" << std::endl
+                << "    with at least the same filters is not analyzed again (see -y)." << std::endl
                 << "-set-qcvault <QCvault path>" << std::endl
                 << "    Register the indicated path as the QCvault location." << std::endl
                 << "    Use \"-set-qcvault default\" for using the standard QCvault location." << std::endl
@@ -465,6 +2000,12 @@ int Cli::exec(QCoreApplication &a)
                 << "            deflicker" << std::endl
                 << "            entropy" << std::endl
                 << "            entropy-diff" << std::endl
+                << "            blockdetect" << std::endl
+                << "            blurdetect" << std::endl
+                << "            blackdetect (duration of the black frames)" << std::endl
+                << "            freezedetect (duration of the frozen video)" << std::endl
+                << "            silencedetect (duration of the silences)" << std::endl
+                << "            hdr (light levels in nits, MaxCLL and MaxFALL, pixels over the peak)" << std::endl
                 << std::endl
                 << "-y" << std::endl
                 << "    Force creation of <qctools-report> even if it already exists" << std::endl
@@ -472,40 +2013,510 @@ int Cli::exec(QCoreApplication &a)
                 << "    Reset application settings" << std::endl
                 << std::endl;
 
-            std::cout
-                << "Signal Server flags:" << std::endl
-                << "-u" << std::endl
-                << "    Upload to Signal Server if <qctools-report> not exists here" << std::endl
-                << "-uf" << std::endl
-                << "    Force upload <qctools-report> to signalserver (even if file already exists)" << std::endl
-                << "-c <qctools-report>" << std::endl
-                << "    Check if uploaded to Signal Server" << std::endl
-                << std::endl;
+            std::cout
+                << "Signal Server flags:" << std::endl
+                << "-u" << std::endl
+                << "    Upload to Signal Server if <qctools-report> not exists here" << std::endl
+                << "-uf" << std::endl
+                << "    Force upload <qctools-report> to signalserver (even if file already exists)" << std::endl
+                << "-upload-chunks <chunk size>[:<parallel>]" << std::endl
+                << "    Upload in chunks of <chunk size> MiB, <parallel> at a time (4 is default), a failed" << std::endl
+                << "    chunk is sent again alone. With -uf and -stream, the upload starts while the" << std::endl
+                << "    <qctools-report> is written. Default is the whole file in one request." << std::endl
+                << "-c <qctools-report>" << std::endl
+                << "    Check if uploaded to Signal Server" << std::endl
+                << std::endl;
+
+            std::cout
+                << "Usage example: " << std::endl
+                << "    " << appName << " -i file.mkv" << std::endl
+                << "        generates qctools file in same directory named file.mkv.qctools.xml.gz" << std::endl
+                << "    " << appName << " -i file.mkv -o report.xml.gz" << std::endl
+                << "        generates qctools file in same directory named report.xml.gz" << std::endl
+                << "    " << appName << " -i file1.mkv -i file2.mkv -s -jobs 8" << std::endl
+                << "        generates qctools files for file1.mkv and file2.mkv, with up to 8 parsing" << std::endl
+                << "        pipelines at the same time" << std::endl
+                << "    " << appName << " -i file.mkv -u" << std::endl
+                << "        generate stats from file.mkv and upload to Signal Server if stats wasn't" << std::endl
+                << "        uploaded previously" << std::endl
+                << "    " << appName << " -i file.mkv -uf" << std::endl
+                << "        generate stats from file.mkv and upload to Signal Server unconditionally" << std::endl
+                << "    " << appName << " -i file.mkv.qctools.xml.gzip -u" << std::endl
+                << "        upload stats to Signal Server if stats wasn't uploaded" << std::endl
+                << "    " << appName << " -i file.mkv.qctools.xml.gzip -uf" << std::endl
+                << "        upload stats to Signal Server unconditionally" << std::endl
+                << "    " << appName << " -c file.mkv.qctools.xml.gzip" << std::endl
+                << "        checks if such a file exists on Signal Server" << std::endl
+                << std::endl;
+        }
+
+        return Success;
+    }
+
+    bool coordinate = !coordinateWorkers.isEmpty();
+    if(live && (serve || coordinate || merge || triage || !snapshotsDirectory.isEmpty() || rangeIsSet || inputs.size() != 1
+     || !output.isEmpty() || uploadToSignalServer || forceUploadToSignalServer || !checkUploadFileName.isEmpty()))
+    {
+        std::cout << "--live needs one input with -i and can not be used with --serve, --coordinate, --merge, --two-pass, -snapshots, --start, --end, -o, -u, -uf or -c." << std::endl;
+        return InvalidInput;
+    }
+
+    if(!compareReference.isEmpty() && (serve || coordinate || live || inputs.size() > 1))
+    {
+        std::cout << "-compare can not be used with --serve, --coordinate, --live or several input files." << std::endl;
+        return InvalidInput;
+    }
+    if(!compareVmafLog.isEmpty() && compareReference.isEmpty())
+    {
+        std::cout << "-compare-vmaf needs -compare." << std::endl;
+        return InvalidInput;
+    }
+
+    // Report database, see StatsDatabase
+    auto isReport = [](const QString& name) {
+        return name.endsWith(".qctools.xml.gz") || name.endsWith(".qctools.xml.zst") || name.endsWith(".qctools.mkv") || name.endsWith(".qctools.columns");
+    };
+    if(!query.isEmpty() && indexFileName.isEmpty())
+    {
+        std::cout << "--query needs --index <database>." << std::endl;
+        return InvalidInput;
+    }
+    bool indexReports = !indexFileName.isEmpty() && !merge && !inputs.isEmpty() && std::all_of(inputs.begin(), inputs.end(), isReport);
+    if(!query.isEmpty() || indexReports)
+    {
+        StatsDatabase database;
+        QString error;
+        if(!database.Open(indexFileName, &error))
+        {
+            std::cout << "database " << indexFileName.toStdString() << " can not be opened: " << error.toStdString() << "." << std::endl;
+            return InvalidInput;
+        }
+
+        if(!query.isEmpty())
+        {
+            bool isOk;
+            if(query.trimmed().startsWith("select", Qt::CaseInsensitive) || query.trimmed().startsWith("with", Qt::CaseInsensitive))
+            {
+                isOk = database.Sql(query, [](const QStringList& values) {
+                    std::cout << values.join('\t').toStdString() << std::endl;
+                }, &error);
+            }
+            else
+            {
+                std::vector<StatsDatabase::match> matches;
+                isOk = database.Query(query, matches, &error);
+                for(const auto& match : matches)
+                    std::cout << match.ReportFileName.toStdString() << '\t' << match.MediaFileName.toStdString() << '\t' << match.StreamIndex
+                              << '\t' << match.Key.toStdString() << '\t' << match.Value << std::endl;
+            }
+            if(!isOk)
+            {
+                std::cout << "query failed: " << error.toStdString() << "." << std::endl;
+                return InvalidInput;
+            }
+            return Success;
+        }
+
+        // Reports already written, the violations of the preset are evaluated on each one
+        signalServer = std::unique_ptr<SignalServer>(new SignalServer());
+        auto indexFilters = selectFilters(filterStrings, prefs.activeFilters());
+        for(const auto& report : inputs)
+        {
+            std::cout << "indexing report... " << report.toStdString() << std::endl;
+            FileInformation info(signalServer.get(), report, prefs.activeFilters(), activeAllTracks, prefs.getActivePanels(), QString());
+            if(!info.isValid() || !info.hasStats())
+            {
+                std::cout << report.toStdString() << " is not a QCTools report, indexing stopped." << std::endl;
+                return InvalidInput;
+            }
+
+            QByteArray violations;
+            if(thresholds)
+            {
+                StatsThresholds evaluated;
+                QFile preset(thresholdsFileName);
+                if(preset.open(QIODevice::ReadOnly) && evaluated.Load(preset.readAll()))
+                {
+                    evaluated.Update(info.Stats);
+                    violations = evaluated.Json(info.Stats);
+                }
+            }
+
+            QString media = info.fileName() != report ? info.fileName() : QString();
+            if(!database.Add(QFileInfo(report).absoluteFilePath(), media.isEmpty() ? media : QFileInfo(media).absoluteFilePath(), info.Stats, indexFilters, violations, &error))
+            {
+                std::cout << report.toStdString() << " can not be indexed: " << error.toStdString() << "." << std::endl;
+                return InvalidInput;
+            }
+        }
+        std::cout << "indexing " << inputs.size() << (inputs.size() > 1 ? " reports" : " report") << "... done, in " << indexFileName.toStdString() << std::endl;
+        return Success;
+    }
+
+    if(!indexFileName.isEmpty() && (serve || coordinate || live || merge || thresholds || triage || rangeIsSet))
+    {
+        std::cout << "--index can not be used with --serve, --coordinate, --live, --merge, -thresholds, --two-pass, --start or --end for a media file." << std::endl;
+        return InvalidInput;
+    }
+
+    if(thresholds && (serve || coordinate || inputs.size() > 1))
+    {
+        std::cout << "-thresholds can not be used with --serve, --coordinate or several input files." << std::endl;
+        return InvalidInput;
+    }
+
+    if(!snapshotsDirectory.isEmpty() && (serve || coordinate || inputs.size() > 1))
+    {
+        std::cout << "-snapshots can not be used with --serve, --coordinate or several input files." << std::endl;
+        return InvalidInput;
+    }
+
+    if(!frameFeedDirectory.isEmpty() && (serve || coordinate || inputs.size() > 1))
+    {
+        std::cout << "-frame-feed can not be used with --serve, --coordinate or several input files." << std::endl;
+        return InvalidInput;
+    }
+
+    if(!spritesDirectory.isEmpty() && (serve || coordinate || inputs.size() > 1))
+    {
+        std::cout << "-sprites can not be used with --serve, --coordinate or several input files." << std::endl;
+        return InvalidInput;
+    }
+
+    if(rangeIsSet && (serve || coordinate || inputs.size() > 1))
+    {
+        std::cout << "--start and --end can not be used with --serve, --coordinate or several input files." << std::endl;
+        return InvalidInput;
+    }
+
+    if(triage && (thresholds || !snapshotsDirectory.isEmpty() || rangeIsSet || serve || coordinate || inputs.size() > 1))
+    {
+        std::cout << "--two-pass can not be used with -thresholds, -snapshots, --start, --end, --serve, --coordinate or several input files." << std::endl;
+        return InvalidInput;
+    }
+
+    // Only the events and the report on stdout, messages go to stderr (see --serve for the JSON protocol)
+    if(progressJson && !serve)
+    {
+        events.reset(new std::ostream(FileInformation::IsStdoutExport(output) ? std::cerr.rdbuf() : std::cout.rdbuf()));
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    // Only the report on stdout, messages and progress go to stderr
+    if(FileInformation::IsStdoutExport(output))
+    {
+        std::cout.rdbuf(std::cerr.rdbuf());
+        if(thresholds || uploadToSignalServer || forceUploadToSignalServer)
+        {
+            std::cout << "-o " << output.toStdString() << " can not be used with -thresholds, -u or -uf." << std::endl;
+            return InvalidInput;
+        }
+    }
+
+    if(!serveHttpName.isEmpty() && !serve)
+    {
+        std::cout << "--serve-http needs --serve." << std::endl;
+        return InvalidInput;
+    }
+
+    // Only JSON on stdout
+    if(serve)
+    {
+        if(!inputs.isEmpty() || !output.isEmpty() || uploadToSignalServer || forceUploadToSignalServer || !checkUploadFileName.isEmpty())
+        {
+            std::cout << "-i, -manifest, -o, -u, -uf and -c can not be used with --serve." << std::endl;
+            return InvalidInput;
+        }
+
+        Batch::Options options;
+        options.filters = Batch::parseFilters(filterStrings, prefs.activeFilters());
+        options.activeAllTracks = activeAllTracks;
+        options.useQCvault = useQCvault;
+        options.createMkv = createMkv;
+        options.forceOutput = forceOutput;
+        options.streamExport = streamExport;
+        options.segments = segmentsIsSet ? segments : 0;
+        options.priority = priority;
+
+        FileInformation::DecoderPool_Set(decoderPool);
+        Server server(options, jobs, numa, lookahead);
+        server.setToken(serveToken);
+        if(!serveRoot.isEmpty() && !server.setRoot(serveRoot))
+        {
+            std::cout << "--serve-root " << serveRoot.toStdString() << " is not a directory." << std::endl;
+            return InvalidInput;
+        }
+        if(!serveName.isEmpty() && !server.listen(serveName))
+        {
+            std::cout << "can not listen on " << serveName.toStdString() << ": " << server.errorString().toStdString() << "." << std::endl;
+            return InvalidInput;
+        }
+        ColumnsServer columnsServer;
+        if(!serveRoot.isEmpty())
+            columnsServer.setRoot(serveRoot);
+        columnsServer.setOrigin(serveHttpOrigin.toUtf8());
+        if(!serveHttpName.isEmpty() && !columnsServer.listen(serveHttpName))
+        {
+            std::cout << "can not listen on " << serveHttpName.toStdString() << "." << std::endl;
+            return InvalidInput;
+        }
+        columnsServer.setMetrics([&server]() { return server.metrics(); });
+        return server.exec();
+    }
+
+    if(!convertFiles.isEmpty())
+    {
+        if(!inputs.isEmpty() || !output.isEmpty() || !watchFolder.isEmpty() || serve || live || uploadToSignalServer || forceUploadToSignalServer || !checkUploadFileName.isEmpty())
+        {
+            std::cout << "-i, -manifest, -o, -u, -uf, -c, --serve, --watch and --live can not be used with --convert." << std::endl;
+            return InvalidInput;
+        }
+
+        Convert convert(jobs, forceOutput);
+        return convert.exec(convertFiles);
+    }
+
+    if(!watchFolder.isEmpty())
+    {
+        if(!inputs.isEmpty() || !output.isEmpty() || serve || live || uploadToSignalServer || forceUploadToSignalServer || !checkUploadFileName.isEmpty())
+        {
+            std::cout << "-i, -manifest, -o, -u, -uf, -c, --serve and --live can not be used with --watch." << std::endl;
+            return InvalidInput;
+        }
+
+        Batch::Options options;
+        options.filters = selectFilters(filterStrings, prefs.activeFilters());
+        options.activeAllTracks = activeAllTracks;
+        options.useQCvault = useQCvault;
+        options.createMkv = createMkv;
+        options.forceOutput = forceOutput;
+        options.streamExport = streamExport;
+        options.segments = segmentsIsSet ? segments : 0;
+        options.index = indexFileName;
+        options.priority = priority;
+
+        FileInformation::DecoderPool_Set(decoderPool);
+        Watch watch(options, jobs, numa, lookahead);
+        if(!watch.watch(watchFolder))
+        {
+            std::cout << "can not watch " << watchFolder.toStdString() << "." << std::endl;
+            return InvalidInput;
+        }
+        return watch.exec();
+    }
+
+    // Only JSON on stdout
+    if(live)
+    {
+        std::ostream liveEvents(std::cout.rdbuf());
+        std::cout.rdbuf(std::cerr.rdbuf());
+
+        if(thresholds && filterStrings.empty())
+            filterStrings = thresholds->Filters();
+
+        LiveMonitor::Options options;
+        options.filters = selectFilters(filterStrings, prefs.activeFilters());
+        options.activeAllTracks = activeAllTracks;
+        options.window = liveWindow;
+        options.thresholds = thresholds.get();
+
+        FileInformation::Live_Set(true);
+        CommonStats::Window_Set(LiveMonitor::framesWindow(liveWindow));
+
+        std::cout << appName << " " << (VERSION) << std::endl << "analyzing live stream... " << input.toStdString() << std::endl;
+        LiveMonitor monitor(input, options, liveEvents);
+        return monitor.exec();
+    }
+
+    std::cout << appName << " " << (VERSION) << std::endl;
 
-            std::cout
-                << "Usage example: " << std::endl
-                << "    " << appName << " -i file.mkv" << std::endl
-                << "        generates qctools file in same directory named file.mkv.qctools.xml.gz" << std::endl
-                << "    " << appName << " -i file.mkv -o report.xml.gz" << std::endl
-                << "        generates qctools file in same directory named report.xml.gz" << std::endl
-                << "    " << appName << " -i file.mkv -u" << std::endl
-                << "        generate stats from file.mkv and upload to Signal Server if stats wasn't" << std::endl
-                << "        uploaded previously" << std::endl
-                << "    " << appName << " -i file.mkv -uf" << std::endl
-                << "        generate stats from file.mkv and upload to Signal Server unconditionally" << std::endl
-                << "    " << appName << " -i file.mkv.qctools.xml.gzip -u" << std::endl
-                << "        upload stats to Signal Server if stats wasn't uploaded" << std::endl
-                << "    " << appName << " -i file.mkv.qctools.xml.gzip -uf" << std::endl
-                << "        upload stats to Signal Server unconditionally" << std::endl
-                << "    " << appName << " -c file.mkv.qctools.xml.gzip" << std::endl
-                << "        checks if such a file exists on Signal Server" << std::endl
-                << std::endl;
+    // Reports of consecutive ranges of the same media in output, see --start and --end
+    auto mergeReports = [&](const QStringList& reports, const QString& output) -> int {
+        QFile file(FileInformation::IsStdoutExport(output) ? QString() : output);
+        // Not configured, nothing is checked nor uploaded
+        signalServer = std::unique_ptr<SignalServer>(new SignalServer());
+
+        std::vector<std::unique_ptr<FileInformation>> parts;
+        for(const auto& part : reports)
+        {
+            std::cout << "reading report... " << part.toStdString() << std::endl;
+            parts.emplace_back(new FileInformation(signalServer.get(), part, prefs.activeFilters(), activeAllTracks, prefs.getActivePanels(), QString()));
+            if(!parts.back()->isValid() || !parts.back()->hasStats())
+            {
+                std::cout << part.toStdString() << " is not a QCTools report, merging stopped." << std::endl;
+                return InvalidInput;
+            }
+        }
+
+        // In time order, whatever the order of the inputs
+        auto firstTimeStamp = [](const std::unique_ptr<FileInformation>& part) {
+            for(auto stat : part->Stats)
+                if(stat && stat->x_Current && stat->FirstTimeStamp != DBL_MAX)
+                    return stat->x[1][0] + stat->FirstTimeStamp;
+            return DBL_MAX;
+        };
+        std::stable_sort(parts.begin(), parts.end(), [&](const std::unique_ptr<FileInformation>& x, const std::unique_ptr<FileInformation>& y) {
+            return firstTimeStamp(x) < firstTimeStamp(y);
+        });
+        for(size_t i = 1; i < parts.size(); ++i)
+        {
+            QString error;
+            if(!parts.front()->appendStats(*parts[i], &error))
+            {
+                std::cout << parts[i]->fileName().toStdString() << " can not be merged: " << error.toStdString() << "." << std::endl;
+                return InvalidInput;
+            }
         }
 
+        if(file.exists())
+            file.remove();
+
+        std::cout << "generating QCTools report... " << std::endl;
+        progress = std::unique_ptr<ProgressBar>(newProgress("export"));
+        QObject::connect(parts.front().get(), &FileInformation::statsFileGenerationProgress, this, &Cli::onStatsFileGenerationProgress);
+        QObject::connect(parts.front().get(), &FileInformation::statsFileGenerated, &a, &QCoreApplication::quit);
+        parts.front()->setExportFilters(filterStrings.empty() ? activefilters().set() : selectFilters(filterStrings, prefs.activeFilters()));
+        parts.front()->startExport(output);
+        a.exec();
+        parts.front()->wait();
+
+        std::cout << std::endl << "generating QCTools report... done, in " << output.toStdString() << std::endl;
         return Success;
+    };
+
+    if(merge)
+    {
+        if(inputs.size() < 2 || output.isEmpty() || output.endsWith(".qctools.mkv") || uploadToSignalServer || forceUploadToSignalServer || !checkUploadFileName.isEmpty())
+        {
+            std::cout << "--merge needs several reports with -i and an -o output which is not .qctools.mkv, -u, -uf and -c can not be used." << std::endl;
+            return InvalidInput;
+        }
+
+        if(QFile(FileInformation::IsStdoutExport(output) ? QString() : output).exists() && !forceOutput)
+        {
+            std::cout << "file " << output.toStdString() << " already exists, exiting.. " << std::endl;
+            return OutputAlreadyExists;
+        }
+
+        return mergeReports(inputs, output);
     }
 
-    std::cout << appName << " " << (VERSION) << std::endl;
+    // Shards analyzed by the workers then merged, the report is uploaded as if it was the input
+    if(coordinate)
+    {
+        if(serve || merge || inputs.size() != 1 || input.endsWith(".qctools.xml.gz") || input.endsWith(".qctools.xml.zst") || input.endsWith(".qctools.mkv") || input.endsWith(".qctools.columns")
+         || output.endsWith(".qctools.mkv") || FileInformation::IsStdoutExport(output) || !checkUploadFileName.isEmpty())
+        {
+            std::cout << "--coordinate needs one media file with -i and an -o output which is not .qctools.mkv nor -, -c can not be used." << std::endl;
+            return InvalidInput;
+        }
+
+        if(output.isEmpty())
+            output = input + StatsCompression::Extension(StatsCompression::Format_Get());
+        if(QFile(output).exists() && !forceOutput)
+        {
+            std::cout << "file " << output.toStdString() << " already exists, exiting.. " << std::endl;
+            return OutputAlreadyExists;
+        }
+
+        Coordinator::Options options;
+        options.filters = filterStrings.join('+');
+        options.shards = shards;
+        options.token = serveToken;
+
+        std::cout << "analyzing input file with " << coordinateWorkers.size() << (coordinateWorkers.size() > 1 ? " workers... " : " worker... ") << input.toStdString() << std::endl;
+        Coordinator coordinator(input, output, coordinateWorkers, options);
+        progress = std::unique_ptr<ProgressBar>(newProgress("shards"));
+        QObject::connect(&coordinator, &Coordinator::progress, [this](int percent) {
+            progress->setValue(percent);
+        });
+        QObject::connect(&coordinator, &Coordinator::warning, [this](const QString& message) {
+            warning(message.toStdString());
+        });
+
+        QStringList reports;
+        int result = coordinator.exec(reports);
+        std::cout << std::endl;
+        if(result != Success)
+        {
+            std::cout << "analyzing with the workers failed." << std::endl;
+            return result;
+        }
+
+        result = reports.size() > 1 ? mergeReports(reports, output) : Success;
+        if(reports.size() > 1)
+        {
+            for(const auto& report : reports)
+                QFile::remove(report);
+        }
+        else if(!reports.isEmpty())
+        {
+            QFile::remove(output);
+            QFile::rename(reports.front(), output);
+        }
+        if(result != Success || (!uploadToSignalServer && !forceUploadToSignalServer))
+            return result;
+
+        input = output;
+        output = QString();
+    }
+
+    if(inputs.size() > 1)
+    {
+        if(!output.isEmpty() || uploadToSignalServer || forceUploadToSignalServer || !checkUploadFileName.isEmpty())
+        {
+            std::cout << "-o, -u, -uf and -c can not be used with several input files, analyzing stopped." << std::endl;
+            return InvalidInput;
+        }
+
+        Batch::Options options;
+        options.filters = selectFilters(filterStrings, prefs.activeFilters());
+        options.activeAllTracks = activeAllTracks;
+        options.useQCvault = useQCvault;
+        options.createMkv = createMkv;
+        options.forceOutput = forceOutput;
+        options.streamExport = streamExport;
+        options.segments = segmentsIsSet ? segments : 0;
+        options.index = indexFileName;
+        options.priority = priority;
+
+        FileInformation::DecoderPool_Set(decoderPool);
+        Batch batch(jobs, numa);
+        batch.setLookahead(lookahead);
+        std::cout << "analyzing " << inputs.size() << " input files, " << batch.pipelinesCount() << " parsing pipelines";
+        if(batch.nodesCount())
+            std::cout << " on " << batch.nodesCount() << " NUMA nodes";
+        if(batch.devicesCount())
+            std::cout << ", decoding on " << batch.devicesCount() << " devices";
+        std::cout << "... " << std::endl;
+
+        int inputsDone = 0;
+        QObject::connect(&batch, &Batch::started, [this](const QString&, const QString& input, int segments) {
+            std::cout << "analyzing input file... " << input.toStdString() << " (" << segments << (segments > 1 ? " segments)" : " segment)") << std::endl;
+            sendEvent(QJsonObject {{"event", "started"}, {"input", input}, {"segments", segments}});
+        });
+        QObject::connect(&batch, &Batch::warning, [this](const QString& id, const QString& message) {
+            std::cout << id.toStdString() << ": " << message.toStdString() << std::endl;
+            sendEvent(QJsonObject {{"event", "warning"}, {"input", id}, {"message", message}});
+        });
+        QObject::connect(&batch, &Batch::finished, [&](const QString&, const QString& input, const QString& output, int error, const QString& message, qint64 waited, qint64 ran) {
+            std::cout << "[" << ++inputsDone << "/" << inputs.size() << "] " << input.toStdString() << ": " << message.toStdString();
+            if(error == Success && !output.isEmpty())
+                std::cout << ", in " << output.toStdString();
+            std::cout << " (waited " << waited / 1000.0 << " s, ran " << ran / 1000.0 << " s)" << std::endl;
+            sendEvent(QJsonObject {{"event", "done"}, {"input", input}, {"output", output}, {"code", error}, {"message", message}, {"done", inputsDone}, {"total", inputs.size()},
+                                   {"wait_seconds", waited / 1000.0}, {"run_seconds", ran / 1000.0}});
+        });
+
+        for(const auto& batchInput : inputs)
+            batch.add(batchInput, options, QString(), batchInput);
+        int result = batch.exec();
+
+        std::cout << std::endl << "analyzing of " << inputs.size() << " input files completed" << std::endl;
+        for(const auto& line : batch.nodesSummary())
+            std::cout << line.toStdString() << std::endl;
+        return result;
+    }
 
     signalServer = std::unique_ptr<SignalServer>(new SignalServer());
 
@@ -519,6 +2530,7 @@ int Cli::exec(QCoreApplication &a)
     signalServer->setLogin(prefs.signalServerLogin());
     signalServer->setPassword(prefs.signalServerPassword());
     signalServer->setAutoUpload(prefs.isSignalServerAutoUploadEnabled());
+    signalServer->setChunkSize((qint64)uploadChunkSize * 1024 * 1024, uploadParallelChunks);
 
     if(!checkUploadFileName.isEmpty()) {
         std::cout << std::endl << "checking if " << QFileInfo(checkUploadFileName).fileName().toStdString() << " exists on signalserver side..." << std::endl;
@@ -542,7 +2554,17 @@ int Cli::exec(QCoreApplication &a)
     if(input.isEmpty())
         return NoInput;
 
-    if(!input.endsWith(".qctools.xml.gz") && !input.endsWith(".qctools.mkv")) // skip output if input is already .qctools.xml.gz
+    if(triage)
+    {
+        if(input.endsWith(".qctools.xml.gz") || input.endsWith(".qctools.xml.zst") || input.endsWith(".qctools.mkv") || input.endsWith(".qctools.columns") || output.endsWith(".qctools.mkv"))
+        {
+            std::cout << "--two-pass needs a media file as input and can not write a .qctools.mkv report." << std::endl;
+            return InvalidInput;
+        }
+        createMkv = false;
+    }
+
+    if(!input.endsWith(".qctools.xml.gz") && !input.endsWith(".qctools.xml.zst") && !input.endsWith(".qctools.mkv") && !input.endsWith(".qctools.columns")) // skip output if input is already .qctools.xml.gz
     {
         if (!useQCvault.isEmpty())
         {
@@ -559,7 +2581,7 @@ int Cli::exec(QCoreApplication &a)
                 return InvalidInput;
             }
 
-            output = fileNameQCvault + (createMkv ? ".qctools.mkv" : ".qctools.xml.gz");
+            output = fileNameQCvault + (thresholds ? ".qctools.thresholds.json" : createMkv ? ".qctools.mkv" : StatsCompression::Extension(StatsCompression::Format_Get()));
             auto outPath = QFileInfo(output).dir();
             if (!outPath.mkpath("."))
             {
@@ -569,19 +2591,85 @@ int Cli::exec(QCoreApplication &a)
         }
 
         if(output.isEmpty())
-            output = input + (createMkv ? ".qctools.mkv" : ".qctools.xml.gz");
+            output = input + (thresholds ? ".qctools.thresholds.json" : createMkv ? ".qctools.mkv" : StatsCompression::Extension(StatsCompression::Format_Get()));
+    }
+    else if(thresholds && output.isEmpty())
+        output = input + ".thresholds.json";
+
+    // Thresholds only: no report, so no thumbnails and no panels
+    // Two passes: the report is written once the ranges are analyzed, without thumbnails and panels
+    if(thresholds || triage)
+    {
+        createMkv = false;
+        streamExport = false;
     }
 
     bool mkvReport = output.endsWith(".qctools.mkv");
-    bool xmlGzReport = output.endsWith(".xml.gz");
+    bool xmlGzReport = output.endsWith(".xml.gz") || output.endsWith(".xml.zst");
     bool xmlReport = output.endsWith(".xml");
+    bool columnsReport = output.endsWith(".qctools.columns");
+    bool arrowReport = StatsArrowReport::IsArrowReport(output);
+
+    if(output.endsWith(".parquet", Qt::CaseInsensitive))
+    {
+        std::cout << "Parquet is not written, write an .arrow output and convert it (pyarrow, pandas, DuckDB...)." << std::endl;
+        return InvalidInput;
+    }
+
+    if(!output.isEmpty() && !thresholds && !xmlGzReport && !mkvReport && !xmlReport && !columnsReport && !arrowReport)
+    {
+        warning("non-standard extension (not *qctools.mkv, *.xml.gz, *.xml.zst, *.xml, *.qctools.columns or *.arrow) has been specified for output file.");
+    }
+    auto compressionIssue = StatsCompression::Check(StatsCompression::Format_FromFileName(output));
+    if(!output.isEmpty() && !mkvReport && !columnsReport && !arrowReport && !compressionIssue.isEmpty())
+    {
+        std::cout << output.toStdString() << ": " << compressionIssue.toStdString() << "." << std::endl;
+        return InvalidInput;
+    }
 
-    if(!output.isEmpty() && !xmlGzReport && !mkvReport && !xmlReport)
+    // Estimate only, the file is probed but not parsed
+    if(estimate)
     {
-        std::cout << "warning: non-standard extension (not *qctools.mkv, *.xml.gz or *.xml) has been specified for output file. " << std::endl;
+        if(input.endsWith(".qctools.xml.gz") || input.endsWith(".qctools.xml.zst") || input.endsWith(".qctools.mkv") || input.endsWith(".qctools.columns"))
+        {
+            std::cout << "--estimate needs a media file as input." << std::endl;
+            return InvalidInput;
+        }
+
+        Estimator estimator;
+        QString calibrationError;
+        if(!calibrationFileName.isEmpty() && !estimator.calibrate(calibrationFileName, &calibrationError))
+        {
+            std::cout << "--calibration " << calibrationFileName.toStdString() << " " << calibrationError.toStdString() << "." << std::endl;
+            return InvalidInput;
+        }
+        // Stdout is the JSON of the estimate
+        if(!estimator.isCalibrated())
+            std::cerr << "--estimate: no --calibration, the rates are the defaults of a reference machine." << std::endl;
+
+        if(filterStrings.empty() && thresholds)
+            filterStrings = thresholds->Filters();
+        auto panels = thresholds || triage ? decltype(prefs.getActivePanels())() : prefs.getActivePanels();
+        Estimator::Options options;
+        options.filters = selectFilters(filterStrings, prefs.activeFilters());
+        options.panels = panels.size();
+        options.pipelines = mkvReport || rangeIsSet || checkpointInterval || resume ? 1 : segments > 0 ? segments : std::max(1, QThread::idealThreadCount() / 2);
+        options.output = output;
+
+        FileInformation estimated(signalServer.get(), input, options.filters, activeAllTracks, panels, QString());
+        estimated.setAutoCheckFileUploaded(false);
+        estimated.setAutoUpload(false);
+        if(!estimated.isValid())
+        {
+            std::cout << "invalid input, estimate stopped.. " << std::endl;
+            return InvalidInput;
+        }
+
+        std::cout << QJsonDocument(estimator.estimate(estimated, options)).toJson().constData();
+        return Success;
     }
 
-    QFile file(output);
+    QFile file(FileInformation::IsStdoutExport(output) ? QString() : output);
     if(file.exists() && !forceOutput)
     {
         std::cout << "file " << output.toStdString() << " already exists, exiting.. " << std::endl;
@@ -594,74 +2682,116 @@ int Cli::exec(QCoreApplication &a)
         file.remove();
     }
 
-    activefilters filters = prefs.activeFilters();
-    if(!filterStrings.empty())
-    {
-        filters = 0;
-        foreach(QString filterString, filterStrings)
-        {
-            if(filterString == "signalstats")
-                filters |= 1 << ActiveFilter_Video_signalstats;
-            else if(filterString == "cropdetect")
-                filters |= 1 << ActiveFilter_Video_cropdetect;
-            else if(filterString == "psnr")
-                filters |= 1 << ActiveFilter_Video_Psnr;
-            else if(filterString == "ebur128")
-                filters |= 1 << ActiveFilter_Audio_EbuR128;
-            else if(filterString == "aphasemeter")
-                filters |= 1 << ActiveFilter_Audio_aphasemeter;
-            else if(filterString == "astats")
-                filters |= 1 << ActiveFilter_Audio_astats;
-            else if(filterString == "ssim")
-                filters |= 1 << ActiveFilter_Video_Ssim;
-            else if(filterString == "idet")
-                filters |= 1 << ActiveFilter_Video_Idet;
-            else if(filterString == "deflicker")
-                filters |= 1 << ActiveFilter_Video_Deflicker;
-            else if(filterString == "entropy")
-                filters |= 1 << ActiveFilter_Video_Entropy;
-            else if(filterString == "entropy-diff")
-                filters |= 1 << ActiveFilter_Video_EntropyDiff;
-            else if(filterString == "blockdetect")
-                filters |= 1 << ActiveFilter_Video_blockdetect;
-            else if(filterString == "blurdetect")
-                filters |= 1 << ActiveFilter_Video_blurdetect;
-        }
+    if(thresholds && filterStrings.empty())
+        filterStrings = thresholds->Filters();
+    activefilters filters = selectFilters(filterStrings, prefs.activeFilters());
+    if(triage)
+        filters |= Batch::parseFilters(triage->Filters(), activefilters());
+    if(!compareReference.isEmpty())
+    {
+        filters.set(ActiveFilter_Video_Psnr);
+        filters.set(ActiveFilter_Video_Ssim);
+        FileInformation::Compare_Set(compareReference, compareVmafLog);
     }
 
-    std::cout << "filters selected: ";
-    if(filters.test(ActiveFilter_Video_signalstats))
-        std::cout << "signalstats" << " ";
-    if(filters.test(ActiveFilter_Video_cropdetect))
-        std::cout << "cropdetect" << " ";
-    if(filters.test(ActiveFilter_Video_Psnr))
-        std::cout << "psnr" << " ";
-    if(filters.test(ActiveFilter_Audio_EbuR128))
-        std::cout << "ebur128" << " ";
-    if(filters.test(ActiveFilter_Audio_aphasemeter))
-        std::cout << "aphasemeter" << " ";
-    if(filters.test(ActiveFilter_Audio_astats))
-        std::cout << "astats" << " ";
-    if(filters.test(ActiveFilter_Video_Ssim))
-        std::cout << "ssim" << " ";
-    if(filters.test(ActiveFilter_Video_Idet))
-        std::cout << "idet" << " ";
-    if(filters.test(ActiveFilter_Video_Deflicker))
-        std::cout << "deflicker" << " ";
-    if(filters.test(ActiveFilter_Video_Entropy))
-        std::cout << "entropy" << " ";
-    if(filters.test(ActiveFilter_Video_EntropyDiff))
-        std::cout << "entropy-diff" << " ";
-    if(filters.test(ActiveFilter_Video_blockdetect))
-        std::cout << "blockdetect" << " ";
-    if(filters.test(ActiveFilter_Video_blurdetect))
-        std::cout << "blurdetect" << " ";
+    if((checkpointInterval || resume) && (thresholds || triage || rangeIsSet || mkvReport || FileInformation::IsStdoutExport(output)))
+    {
+        std::cout << "-checkpoint and --resume can not be used with -thresholds, --two-pass, --start, --end, a .qctools.mkv output or -o -." << std::endl;
+        return InvalidInput;
+    }
 
-    std::cout << std::endl;
+    // Thumbnails and panels need the whole file in one pipeline
+    if(segments == 0)
+        segments = std::max(1, QThread::idealThreadCount() / 2);
+    if(segments > 1 && mkvReport && !thresholds)
+        warning("-segments is ignored with a .qctools.mkv output.");
+    else if(segments > 1 && (checkpointInterval || resume))
+    {
+        if(segmentsIsSet)
+            warning("-segments is ignored with -checkpoint and --resume.");
+    }
+    else if(segments > 1)
+        FileInformation::ParsingSegments_Set(segments);
+
+    if(rangeIsSet && rangeStart >= rangeEnd)
+    {
+        std::cout << "--end must be after --start." << std::endl;
+        return InvalidInput;
+    }
+    if(rangeIsSet && segments > 1)
+        warning("-segments is ignored with --start or --end.");
+    if(!compareReference.isEmpty() && segments > 1 && segmentsIsSet)
+        warning("-segments is ignored with -compare.");
+
+    if(!snapshotsDirectory.isEmpty())
+    {
+        if(segments > 1)
+            warning("-segments is ignored with -snapshots.");
+        snapshots.reset(new FrameSnapshots(snapshotsDirectory, snapshotsFormat));
+        for(auto time : snapshotTimes)
+            snapshots->AddTime(time);
+        if(thresholds)
+            for(const auto& bounds : thresholds->Bounds())
+                snapshots->AddTrigger(bounds.Key, bounds.HasMin, bounds.Min, bounds.HasMax, bounds.Max);
+        FileInformation::FrameSnapshots_Set(snapshots.get());
+    }
+
+    if(!frameFeedDirectory.isEmpty())
+    {
+        if(segments > 1)
+            warning("-segments is ignored with -frame-feed.");
+        frameFeed.reset(new FrameFeed(frameFeedDirectory, frameFeedInterval, frameFeedWidth));
+        FileInformation::FrameFeed_Set(frameFeed.get());
+    }
+
+    if(!spritesDirectory.isEmpty())
+    {
+        if(segments > 1)
+            warning("-segments is ignored with -sprites.");
+        sprites.reset(new ThumbnailSprites(spritesDirectory, spritesPerMinute, spritesFormat));
+        FileInformation::ThumbnailSprites_Set(sprites.get());
+    }
 
-    info = std::unique_ptr<FileInformation>(new FileInformation(signalServer.get(), input, filters, activeAllTracks, prefs.getActivePanels(), useQCvault.isEmpty() ? QString() : prefs.createQCvaultFileNameString(input)));
+    // Key frames by default for the first pass
+    if(triage && !FileInformation::Sampling_Get() && !FileInformation::SamplingRate_Get())
+        FileInformation::Sampling_Set(-1);
+
+    info = std::unique_ptr<FileInformation>(new FileInformation(signalServer.get(), input, filters, activeAllTracks, thresholds || triage ? decltype(prefs.getActivePanels())() : prefs.getActivePanels(), useQCvault.isEmpty() ? QString() : prefs.createQCvaultFileNameString(input)));
+    QCTOOLS_TRACE(Category_Startup, "file opened at {} ms", Tracing::elapsed());
     info->setAutoCheckFileUploaded(false);
     info->setAutoUpload(false);
+    // Stats already there (a report as input): the range is the one exported, see below
+    bool exportRange = rangeIsSet && info->hasStats() && !forceOutput && !info->hasReanalysis();
+    if(rangeIsSet && !exportRange && !info->setParsingRange(rangeStart, rangeEnd, rangeInFrames == 1))
+    {
+        std::cout << "frame numbers can not be used without a video stream with a frame rate." << std::endl;
+        return InvalidInput;
+    }
+
+    // Parts written by a run stopped before its end, the analysis continues from the time of the last one
+    QStringList checkpointParts;
+    int resumedParts = 0;
+    if(resume)
+    {
+        QFile state(checkpointStateName(output));
+        QJsonObject object;
+        if(state.open(QIODevice::ReadOnly))
+            object = QJsonDocument::fromJson(state.readAll()).object();
+        for(int i = 0; i < object.value("parts").toInt(); ++i)
+            checkpointParts.append(checkpointPartName(output, i));
+        bool isValid = object.value("input").toString() == QFileInfo(input).absoluteFilePath() && !checkpointParts.isEmpty()
+                    && std::all_of(checkpointParts.begin(), checkpointParts.end(), [](const QString& part) { return QFileInfo::exists(part); });
+        if(isValid && info->setParsingRange(object.value("time").toDouble(), std::numeric_limits<double>::infinity(), false))
+        {
+            resumedParts = checkpointParts.size();
+            std::cout << "resuming from " << object.value("time").toDouble() << " s, after " << resumedParts << " checkpoints" << std::endl;
+        }
+        else
+        {
+            checkpointParts.clear();
+            warning("no checkpoint of this input for this output, analyzing from the start.");
+        }
+    }
 
     std::cout << std::endl << "analyzing input file... " << input.toStdString() << std::endl;
 
@@ -677,34 +2807,161 @@ int Cli::exec(QCoreApplication &a)
             indexOfStreamWithKnownFrameCount = i;
     }
 
-    if(!info->hasStats() || forceOutput)
+    // The values of the report are complete once merged at the end of the parsing
+    if(info->hasReanalysis())
+        streamExport = false;
+
+    bool parse = !info->hasStats() || forceOutput || info->hasReanalysis();
+    if(parse)
     {
         // parse
 
-        progress = std::unique_ptr<ProgressBar>(new ProgressBar(0, 100, 50, "%"));
-        progress->setValue(0);
+        progress = std::unique_ptr<ProgressBar>(newProgress("parse"));
 
         QObject::connect(&progressTimer, SIGNAL(timeout()), this, SLOT(updateParsingProgress()));
         progressTimer.start(500);
 
+        if(statsInterval)
+        {
+            QObject::connect(&countersTimer, SIGNAL(timeout()), this, SLOT(showParsingCounters()));
+            countersTimer.start(statsInterval);
+        }
+
         QObject::connect(info.get(), SIGNAL(parsingCompleted(bool)), &a, SLOT(quit()));
+        if(streamExport && !info->setStreamExport(mkvReport ? QString() : output, filters))
+            warning("stats report can not be written while analyzing, it will be written after.");
+        else if(streamExport && forceUploadToSignalServer && uploadChunkSize && !mkvReport)
+            info->uploadStreamExport(QFileInfo(output).fileName());
+
+        // The state is written after its part and replaced at once, so it is never ahead of the parts
+        QTimer checkpointTimer;
+        QObject::connect(&checkpointTimer, &QTimer::timeout, [&]() {
+            auto part = checkpointPartName(output, checkpointParts.size());
+            double time = info->writeCheckpoint(part, filters);
+            if(std::isnan(time))
+                return;
+            checkpointParts.append(part);
+            QSaveFile state(checkpointStateName(output));
+            QJsonObject object {{"input", QFileInfo(input).absoluteFilePath()}, {"time", time}, {"parts", checkpointParts.size()}};
+            if(!state.open(QIODevice::WriteOnly) || state.write(QJsonDocument(object).toJson()) == -1 || !state.commit())
+                warning("checkpoint state can not be written.");
+        });
+        if(checkpointInterval)
+            checkpointTimer.start(checkpointInterval * 1000);
+
         info->startParse();
+        QCTOOLS_TRACE(Category_Startup, "parsing started at {} ms", Tracing::elapsed());
         a.exec();
+        checkpointTimer.stop();
 
         QObject::disconnect(&progressTimer, SIGNAL(timeout()), this, SLOT(updateParsingProgress()));
+        sendDetectedEvents();
         if(info->parsed())
             progress->setValue(100);
 
         std::cout << std::endl << "analyzing " << (info->parsed() ? "completed" : "failed") << std::endl;
 
+        if(statsInterval)
+        {
+            // Totals of the analysis
+            countersTimer.stop();
+            QObject::disconnect(&countersTimer, SIGNAL(timeout()), this, SLOT(showParsingCounters()));
+            previousCounters.reset();
+            showParsingCounters();
+        }
+
+        if(filterTimings)
+        {
+            // Not known for the segments parsed in parallel, only the main parser is timed
+            auto times = info->filterTimes();
+            for(auto time = times.begin(); time != times.end(); ++time)
+                std::cout << "filter graph " << time.key().toStdString() << ": " << time.value() / 1000.0 << " s" << std::endl;
+        }
+
         if(!info->parsed())
             return ParsingFailure;
 
+        if(snapshots)
+            std::cout << snapshots->Count() << " stills written in " << snapshotsDirectory.toStdString() << std::endl;
+        if(frameFeed)
+            std::cout << frameFeed->Count() << " frames written in " << frameFeedDirectory.toStdString() << std::endl;
+        if(sprites)
+        {
+            if(!sprites->Finish())
+                warning("some sprite sheets could not be written.");
+            std::cout << sprites->Count() << " thumbnails in the sprite sheets of " << spritesDirectory.toStdString() << std::endl;
+        }
+    }
+
+    // The report keeps the filters it had
+    if(info->hasReanalysis())
+        filters |= info->reportFilters();
+
+    if(triage && parse)
+    {
+        // Second pass, all the frames of the ranges of the sampled streams near the bounds
+        std::vector<CommonStats*> sampled;
+        for(auto stat : info->Stats)
+            if(stat && stat->Sampling_Get())
+                sampled.push_back(stat);
+        auto regions = triage->Regions(sampled, triageTolerance, triageMargin);
+        FileInformation::Sampling_Set(0);
+        FileInformation::SamplingRate_Set(0);
+
+        std::cout << std::endl << regions.size() << " suspect ranges found" << std::endl;
+        progress = std::unique_ptr<ProgressBar>(newProgress("ranges"));
+        for(size_t i = 0; i < regions.size(); ++i)
+        {
+            std::cout << "analyzing suspect range " << i + 1 << "/" << regions.size() << " (" << regions[i].first << " s to " << regions[i].second << " s)..." << std::endl;
+
+            std::unique_ptr<FileInformation> part(new FileInformation(signalServer.get(), input, filters, activeAllTracks, decltype(prefs.getActivePanels())(), QString()));
+            part->setAutoCheckFileUploaded(false);
+            part->setAutoUpload(false);
+            part->setParsingRange(regions[i].first, regions[i].second, false);
+            QObject::connect(part.get(), SIGNAL(parsingCompleted(bool)), &a, SLOT(quit()));
+            part->startParse();
+            a.exec();
+
+            QString error;
+            if(!part->parsed() || !info->spliceStats(*part, &error))
+            {
+                std::cout << "analyzing of the suspect range failed" << (error.isEmpty() ? std::string() : ": " + error.toStdString()) << std::endl;
+                return ParsingFailure;
+            }
+            progress->setValue(100 * (i + 1) / regions.size());
+        }
+        if(regions.empty())
+            progress->setValue(100);
+    }
+
+    if(thresholds)
+    {
+        thresholds->Update(info->Stats);
+        auto snapshot = [&](size_t stream, size_t frame) {
+            auto fileName = snapshots ? snapshots->FileName(stream, frame) : QString();
+            return QFileInfo::exists(fileName) ? fileName : QString();
+        };
+        if(!file.open(QIODevice::WriteOnly) || file.write(thresholds->Json(info->Stats, snapshot)) == -1)
+        {
+            std::cout << "can not write " << output.toStdString() << "." << std::endl;
+            return InvalidInput;
+        }
+        file.close();
+        std::cout << std::endl << "thresholds evaluated, in " << output.toStdString() << std::endl;
+
+        if(rangeSummary)
+            showRangeSummary(*info, rangeFirst, rangeLast);
+        if(!summaryFileName.isEmpty() && !writeSummary(*info, filters, summaryFileName))
+            warning("can not write " + summaryFileName.toStdString());
+        return Success;
+    }
+
+    if(parse)
+    {
         // export
         std::cout << std::endl << "generating QCTools report... " << std::endl;
 
-        progress = std::unique_ptr<ProgressBar>(new ProgressBar(0, 100, 50, "%"));
-        progress->setValue(0);
+        progress = std::unique_ptr<ProgressBar>(newProgress("export"));
 
         QObject::connect(info.get(), &FileInformation::statsFileGenerationProgress, this, &Cli::onStatsFileGenerationProgress);
         QObject::connect(info.get(), &FileInformation::statsFileGenerated, this, [&](SharedFile statsFile, const QString& name) {
@@ -716,27 +2973,25 @@ int Cli::exec(QCoreApplication &a)
                 attachment = statsFile->readAll();
                 attachmentFileName = name;
 
-                info->makeMkvReport(output, attachment, attachmentFileName, [&] (int thumbnailIndex, int thumbnailsCount) {
-                        if(thumbnailIndex == 0) {
-                            std::cout << std::endl << "adding thumbnails to QCTools report... " << std::endl;
-
-                            progress = std::unique_ptr<ProgressBar>(new ProgressBar(0, 100, 50, "%"));
-                            progress->setValue(0);
-                        }
-                        progress->setValue(100 * thumbnailIndex/ thumbnailsCount);
-                        QCoreApplication::processEvents();
-                    }, [&](int panelIndex, int panelsCount) {
-                        if(panelIndex == 0)
-                        {
-                            std::cout << std::endl << "adding panels to QCTools report... " << std::endl;
+                bool encodingStarted = false;
+                QElapsedTimer encodingTimer;
+                encodingTimer.start();
+                info->makeMkvReport(output, attachment, attachmentFileName, [&] (int encodedCount, int encodedTotal) {
+                        if(!encodingStarted) {
+                            encodingStarted = true;
+                            std::cout << std::endl << "adding thumbnails and panels to QCTools report... " << std::endl;
 
-                            progress = std::unique_ptr<ProgressBar>(new ProgressBar(0, 100, 50, "%"));
-                            progress->setValue(0);
+                            progress = std::unique_ptr<ProgressBar>(newProgress("mkv"));
                         }
-
-                        progress->setValue(100 * panelIndex / panelsCount);
+                        if(encodedTotal)
+                            progress->setValue(100 * encodedCount / encodedTotal);
                         QCoreApplication::processEvents();
                     });
+
+                // For comparing the encoders, see -thumbnails-codec and -panels-codec
+                auto codecName = [](const QString& codec) { return codec.isEmpty() ? std::string("mjpeg") : codec.toStdString(); };
+                std::cout << std::endl << "thumbnails (" << codecName(FileInformation::ThumbnailsCodec_Get()) << ") and panels (" << codecName(FileInformation::PanelsCodec_Get())
+                          << ") encoded in " << encodingTimer.elapsed() / 1000.0 << " s" << std::endl;
             }
 
             a.quit();
@@ -753,6 +3008,65 @@ int Cli::exec(QCoreApplication &a)
         QObject::disconnect(info.get(), SIGNAL(statsFileGenerationProgress(quint64, quint64)), this, SLOT(onStatsFileGenerationProgress(quint64, quint64)));
 
         std::cout << std::endl << "generating QCTools report... done, in " << output.toStdString() << std::endl;
+
+        // Frames of the previous runs first, the checkpoints of this run are in the report
+        if(resumedParts)
+        {
+            auto reports = checkpointParts.mid(0, resumedParts);
+            reports.append(checkpointPartName(output, checkpointParts.size()));
+            QFile::remove(reports.back());
+            if(!QFile::rename(output, reports.back()))
+            {
+                std::cout << "can not merge the checkpoints in " << output.toStdString() << "." << std::endl;
+                return InvalidInput;
+            }
+            checkpointParts.append(reports.back());
+
+            // The configured server is kept for the upload, merging uses a server not configured
+            auto configuredSignalServer = std::move(signalServer);
+            int result = mergeReports(reports, output);
+            signalServer = std::move(configuredSignalServer);
+            if(result != Success)
+                return result;
+        }
+        for(const auto& part : checkpointParts)
+            QFile::remove(part);
+        if(checkpointInterval || resume)
+            QFile::remove(checkpointStateName(output));
+
+        // Found by content next time, reports of a range or of two passes are not complete
+        if(!useQCvault.isEmpty() && !rangeIsSet && !triage)
+            QCvaultIndex::Add(useQCvault, QCvaultIndex::Fingerprint(input), filters, output);
+
+        if(!indexFileName.isEmpty())
+        {
+            StatsDatabase database;
+            QString error;
+            if(!database.Open(indexFileName, &error) || !database.Add(QFileInfo(output).absoluteFilePath(), QFileInfo(input).absoluteFilePath(), info->Stats, filters, QByteArray(), &error))
+                warning(QString("report not indexed in %1: %2").arg(indexFileName).arg(error).toStdString());
+        }
+    }
+    else if(exportRange)
+    {
+        // Part of the report: the frames of the range, their thumbnails and panels copied if they can be
+        if(QFileInfo(output).absoluteFilePath() == QFileInfo(input).absoluteFilePath())
+        {
+            std::cout << "the report of a range can not replace its input, set -o." << std::endl;
+            return InvalidInput;
+        }
+        if(!info->setExportRange(rangeStart, rangeEnd, rangeInFrames == 1))
+        {
+            std::cout << "no frame from --start to --end." << std::endl;
+            return InvalidInput;
+        }
+        std::cout << std::endl << "generating QCTools report of the range... " << std::endl;
+        QElapsedTimer exportTimer;
+        exportTimer.start();
+        if(mkvReport)
+            info->Export_QCTools_Mkv(output, filters);
+        else
+            info->Export_XmlGz(output, filters);
+        std::cout << "generating QCTools report of the range... done, in " << output.toStdString() << " (" << exportTimer.elapsed() / 1000.0 << " s)" << std::endl;
     }
     else
     {
@@ -760,6 +3074,11 @@ int Cli::exec(QCoreApplication &a)
         output = input;
     }
 
+    if(rangeSummary)
+        showRangeSummary(*info, rangeFirst, rangeLast);
+    if(!summaryFileName.isEmpty() && !writeSummary(*info, filters, summaryFileName))
+        warning("can not write " + summaryFileName.toStdString());
+
     if(uploadToSignalServer || forceUploadToSignalServer)
     {
         std::cout << std::endl << "checking if " << output.toStdString() << " exists on signalserver side..." << std::endl;
@@ -788,8 +3107,7 @@ int Cli::exec(QCoreApplication &a)
             QObject::connect(info.get(), SIGNAL(signalServerUploadProgressChanged(qint64, qint64)), this, SLOT(onSignalServerUploadProgressChanged(qint64, qint64)));
 
             std::cout << "uploading... " << std::endl;
-            progress = std::unique_ptr<ProgressBar>(new ProgressBar(0, 100, 50, "%"));
-            progress->setValue(0);
+            progress = std::unique_ptr<ProgressBar>(newProgress("upload"));
 
             info->upload(QFileInfo(output));
             a.exec();
@@ -812,10 +3130,111 @@ int Cli::exec(QCoreApplication &a)
 
 void Cli::updateParsingProgress()
 {
-    int value = info->Frames_Pos_Get(indexOfStreamWithKnownFrameCount) * progress->getMax() /
-                info->Frames_Count_Get(indexOfStreamWithKnownFrameCount);
+    // The frames parsed meanwhile, the stats are not kept for the report
+    if(thresholds)
+        thresholds->Update(info->Stats);
+    sendDetectedEvents();
+
+    int value = (int)(info->Frames_Pos_Get(indexOfStreamWithKnownFrameCount) * progress->getMax() /
+                      info->Frames_Count_Get(indexOfStreamWithKnownFrameCount));
+
+    if(!events)
+    {
+        progress->setValue(value);
+        return;
+    }
+
+    // Frames/s since the previous call, the ETA is from the stream with the most frames
+    QJsonArray streams;
+    for(size_t i = 0; i < info->Stats.size(); ++i)
+        streams.append(QJsonObject {{"index", int(i)}, {"frames", qint64(info->Frames_Pos_Get(i))}, {"total", qint64(info->Frames_Count_Get(i))}});
+
+    auto frames = info->Frames_Pos_Get(indexOfStreamWithKnownFrameCount);
+    auto total = info->Frames_Count_Get(indexOfStreamWithKnownFrameCount);
+    auto time = phaseTimer.elapsed();
+    auto fps = time > parsedFramesTime ? (frames - parsedFrames) * 1000.0 / (time - parsedFramesTime) : 0.0;
+    parsedFrames = frames;
+    parsedFramesTime = time;
+
+    QJsonObject event {{"event", "progress"}, {"phase", phase}, {"percent", value}, {"elapsed", time / 1000.0}, {"fps", fps}, {"streams", streams}};
+    if(fps > 0 && total > frames)
+        event.insert("eta", (total - frames) / fps);
+    sendEvent(event);
+}
+
+void Cli::sendDetectedEvents()
+{
+    // Taken even without --progress=json, so the queue does not hold old events
+    size_t dropped = 0;
+    auto detected = StatsDetectors::Events_Take(&dropped);
+    if(!events)
+        return;
+
+    if(dropped)
+        sendEvent(QJsonObject {{"event", "detected_dropped"}, {"count", double(dropped)}});
+    for(const auto& event : detected)
+        sendEvent(QJsonObject {
+            {"event", "detected"},
+            {"stream_index", event.StreamIndex},
+            {"frame", double(event.Frame)},
+            {"time", event.Time},
+            {"key", QString::fromStdString(event.Key)},
+            {"method", QString::fromStdString(event.Method)},
+            {"value", event.Value},
+            {"score", event.Score},
+        });
+}
+
+void Cli::sendEvent(QJsonObject event)
+{
+    if(!events)
+        return;
+
+    *events << QJsonDocument(event).toJson(QJsonDocument::Compact).constData() << std::endl;
+}
+
+void Cli::warning(const std::string& message)
+{
+    std::cout << "warning: " << message << std::endl;
+    sendEvent(QJsonObject {{"event", "warning"}, {"message", QString::fromStdString(message)}});
+}
+
+ProgressBar* Cli::newProgress(const QString& name)
+{
+    phase = name;
+    phaseTimer.start();
+    phaseValue = -1;
+    parsedFrames = 0;
+    parsedFramesTime = 0;
+    sendEvent(QJsonObject {{"event", "phase"}, {"phase", phase}});
+
+    if(!events)
+        return new ProgressBar(0, 100, 50, "%");
+    return new ProgressBar(0, 100, 50, "%", [this](int value) { sendProgress(value); });
+}
+
+// Only the changes of percent, the ETA is from the elapsed time
+void Cli::sendProgress(int value)
+{
+    if(value == phaseValue)
+        return;
+    phaseValue = value;
+
+    auto time = phaseTimer.elapsed() / 1000.0;
+    QJsonObject event {{"event", "progress"}, {"phase", phase}, {"percent", value}, {"elapsed", time}};
+    if(value > 0 && value < 100)
+        event.insert("eta", time * (100 - value) / value);
+    sendEvent(event);
+}
 
-    progress->setValue(value);
+void Cli::showParsingCounters()
+{
+    // Rates since the previous call
+    auto counters = info->parsingCounters();
+    std::cout << std::endl;
+    for(const auto& line : counters.Lines(previousCounters.get()))
+        std::cout << "    " << line.toStdString() << std::endl;
+    previousCounters.reset(new FileInformation::ParsingCounters(counters));
 }
 
 void Cli::onStatsFileGenerationProgress(quint64 written, quint64 total)
@@ -11,8 +11,15 @@
 
 #include "Core/SignalServer.h"
 #include "Core/FileInformation.h"
+#include "Core/FrameSnapshots.h"
+#include "Core/FrameFeed.h"
+#include "Core/ThumbnailSprites.h"
 #include "Core/Preferences.h"
+#include "Core/StatsThresholds.h"
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <functional>
 #include <memory>
 #include <iostream>
 #include <QTimer>
@@ -34,12 +41,18 @@ public:
     static const char ForegroundChar = char('.');
     static const char BackgroundChar = char(' ');
 
-    ProgressBar(int min, int max, int width, const QString& append) : min(min), max(max), width(width), append(append) {
+    // Values are sent to callback, if set, instead of being shown
+    ProgressBar(int min, int max, int width, const QString& append, std::function<void(int)> callback = {}) : min(min), max(max), width(width), append(append), callback(callback) {
         setValue(min);
     }
 
     void setValue(int value) {
 
+        if(callback) {
+            callback(value);
+            return;
+        }
+
         int displayValue = value * width / (max - min);
         int backgroundWidth = width - displayValue;
 
@@ -65,6 +78,7 @@ private:
 
     int width;
     QString append;
+    std::function<void(int)> callback;
 };
 
 
@@ -77,17 +91,46 @@ public:
 
 public slots:
     void updateParsingProgress();
+    void showParsingCounters();
     void onStatsFileGenerationProgress(quint64 written, quint64 total);
     void onSignalServerUploadProgressChanged(qint64 written, qint64 total);
 
 private:
+    int run(QCoreApplication& a);
+
+    // --progress=json: one JSON object per line (phase, progress, warning, finished), else nothing
+    void sendEvent(QJsonObject event);
+    void sendDetectedEvents(); // -detect
+    void warning(const std::string& message);
+    ProgressBar* newProgress(const QString& name);
+    void sendProgress(int value);
+
     std::unique_ptr<FileInformation> info;
     std::unique_ptr<ProgressBar> progress;
     std::unique_ptr<SignalServer> signalServer;
+    std::unique_ptr<StatsThresholds> thresholds; // -thresholds
+    std::unique_ptr<FrameSnapshots> snapshots; // -snapshots
+    std::unique_ptr<FrameFeed> frameFeed; // -frame-feed
+    std::unique_ptr<ThumbnailSprites> sprites; // -sprites
 
     QTimer progressTimer;
     int indexOfStreamWithKnownFrameCount;
 
+    // --trace-events, written once done
+    QString traceEventsFileName;
+
+    // --stats-interval
+    QTimer countersTimer;
+    std::unique_ptr<FileInformation::ParsingCounters> previousCounters;
+
+    // --progress=json
+    std::unique_ptr<std::ostream> events;
+    QString phase;
+    QElapsedTimer phaseTimer;
+    int phaseValue = -1;
+    int64_t parsedFrames = 0;
+    qint64 parsedFramesTime = 0;
+
     quint64 statsFileBytesWritten;
     quint64 statsFileBytesTotal;
 
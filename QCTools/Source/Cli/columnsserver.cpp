@@ -0,0 +1,296 @@
+#include "columnsserver.h"
+#include "Core/CommonStats.h"
+#include "Core/Core.h"
+#include "Core/StatsRangeIndex.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrl>
+#include <QtEndian>
+#include <cfloat>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//---------------------------------------------------------------------------
+// Requests are small, a larger header is not a client of the dashboard
+static const int maxRequestSize = 16 * 1024;
+static const int defaultPoints = 1000;
+
+ColumnsServer::ColumnsServer() : root(QDir::current().canonicalPath())
+{
+    connect(&server, &QTcpServer::newConnection, this, [this]() {
+        while(QTcpSocket* socket = server.nextPendingConnection())
+        {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+                request(socket);
+            });
+        }
+    });
+}
+
+ColumnsServer::~ColumnsServer()
+{
+}
+
+bool ColumnsServer::listen(const QString& name)
+{
+    // <port> or <address>:<port>
+    auto port = name.mid(name.lastIndexOf(':') + 1);
+    auto address = name.left(name.length() - port.length());
+    address.chop(address.endsWith(':') ? 1 : 0);
+    bool ok = false;
+    auto portNumber = port.toUShort(&ok);
+    return ok && server.listen(address.isEmpty() ? QHostAddress(QHostAddress::LocalHost) : QHostAddress(address), portNumber);
+}
+
+bool ColumnsServer::setRoot(const QString& path)
+{
+    auto canonical = QDir(path).canonicalPath();
+    if(canonical.isEmpty())
+        return false;
+    root = canonical;
+    return true;
+}
+
+void ColumnsServer::request(QTcpSocket* socket)
+{
+    // Whole header, the body of a GET is ignored
+    auto data = socket->property("request").toByteArray() + socket->readAll();
+    auto headerEnd = data.indexOf("\r\n\r\n");
+    if(headerEnd < 0)
+    {
+        if(data.size() > maxRequestSize)
+            replyError(socket, 400, "request too large");
+        else
+            socket->setProperty("request", data);
+        return;
+    }
+    socket->setProperty("request", QVariant());
+    disconnect(socket, &QTcpSocket::readyRead, this, nullptr);
+
+    auto requestLine = data.left(data.indexOf("\r\n")).split(' ');
+    if(requestLine.size() != 3 || requestLine[0] != "GET")
+    {
+        replyError(socket, 400, "only GET requests are supported");
+        return;
+    }
+
+    QUrl url(QString::fromUtf8(requestLine[1]));
+    QUrlQuery query(url);
+    auto path = url.path();
+    if(path == "/metrics" && metrics)
+    {
+        reply(socket, 200, "application/openmetrics-text; version=1.0.0; charset=utf-8", metrics());
+        return;
+    }
+    if(path != "/columns" && path != "/slice")
+    {
+        replyError(socket, 404, "unknown path " + path + (metrics ? ", /columns, /slice or /metrics" : ", /columns or /slice"));
+        return;
+    }
+
+    auto fileName = query.queryItemValue("report", QUrl::FullyDecoded);
+    auto reportPath = fileName.isEmpty() ? QString() : inRoot(fileName);
+    if(!fileName.isEmpty() && reportPath.isEmpty())
+    {
+        replyError(socket, 404, fileName + " is not a report of the root directory");
+        return;
+    }
+    auto info = reportPath.isEmpty() ? nullptr : report(reportPath);
+    if(!info)
+    {
+        replyError(socket, 404, fileName.isEmpty() ? QString("no report") : fileName + " is not a QCTools report");
+        return;
+    }
+
+    if(path == "/columns")
+    {
+        reply(socket, 200, "application/json", columns(*info));
+        return;
+    }
+
+    QByteArray body;
+    headers extra;
+    QString error;
+    if(!slice(*info, query, body, extra, error))
+    {
+        replyError(socket, 400, error);
+        return;
+    }
+    reply(socket, 200, "application/octet-stream", body, extra);
+}
+
+void ColumnsServer::reply(QTcpSocket* socket, int status, const QByteArray& contentType, const QByteArray& body, const headers& extra)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + (status == 200 ? " OK" : status == 404 ? " Not Found" : " Bad Request") + "\r\n"
+        "Content-Type: " + contentType + "\r\n"
+        "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+        "Connection: close\r\n";
+    if(!origin.isEmpty())
+        response += "Access-Control-Allow-Origin: " + origin + "\r\n"
+            "Access-Control-Expose-Headers: X-QCTools-Start, X-QCTools-End, X-QCTools-Points\r\n";
+    for(const auto& header : extra)
+        response += header.first + ": " + header.second + "\r\n";
+    response += "\r\n";
+
+    socket->write(response);
+    socket->write(body);
+    socket->disconnectFromHost();
+}
+
+void ColumnsServer::replyError(QTcpSocket* socket, int status, const QString& message)
+{
+    reply(socket, status, "application/json", QJsonDocument(QJsonObject {{"error", message}}).toJson(QJsonDocument::Compact));
+}
+
+//---------------------------------------------------------------------------
+// Relative to the root and inside it once the links are resolved, else empty
+QString ColumnsServer::inRoot(const QString& fileName) const
+{
+    if(QDir::isAbsolutePath(fileName) || QDir::fromNativeSeparators(fileName).split('/').contains(".."))
+        return QString();
+
+    auto canonical = QFileInfo(QDir(root).filePath(fileName)).canonicalFilePath();
+    if(!canonical.startsWith(root.endsWith('/') ? root : root + '/'))
+        return QString();
+    return canonical;
+}
+
+//---------------------------------------------------------------------------
+// Opened once, the least recently used report is closed beyond reports_Max
+FileInformation* ColumnsServer::report(const QString& fileName)
+{
+    for(auto item = reports.begin(); item != reports.end(); ++item)
+        if(item->first == fileName)
+        {
+            reports.splice(reports.begin(), reports, item);
+            return reports.front().second.get();
+        }
+
+    auto lower = fileName.toLower();
+    if(!lower.endsWith(".qctools.xml.gz") && !lower.endsWith(".qctools.xml.zst") && !lower.endsWith(".qctools.xml")
+        && !lower.endsWith(".qctools.mkv") && !lower.endsWith(".qctools.columns"))
+        return nullptr;
+
+    std::unique_ptr<FileInformation> info(new FileInformation(&signalServer, fileName, activefilters(), activealltracks(),
+        QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>>(), QString()));
+    if(!info->isValid() || !info->hasStats())
+        return nullptr;
+
+    reports.emplace_front(fileName, std::move(info));
+    if(reports.size() > reports_Max)
+        reports.pop_back();
+    return reports.front().second.get();
+}
+
+QByteArray ColumnsServer::columns(FileInformation& info)
+{
+    QJsonArray streams;
+    for(size_t index = 0; index < info.Stats.size(); ++index)
+    {
+        auto stat = info.Stats[index];
+        if(!stat)
+            continue;
+
+        const struct stream_info& streamInfo = PerStreamType[stat->Type_Get()];
+        QJsonArray names;
+        for(size_t item = 0; item < streamInfo.CountOfItems; ++item)
+            if(streamInfo.PerItem[item].FFmpeg_Name)
+                names.append(QString(streamInfo.PerItem[item].FFmpeg_Name));
+
+        streams.append(QJsonObject {
+            {"stream", (qint64)index},
+            {"type", stat->Type_Get() == Type_Video ? "video" : "audio"},
+            {"frames", (qint64)stat->x_Current},
+            {"columns", names},
+        });
+    }
+    return QJsonDocument(QJsonObject {{"streams", streams}}).toJson(QJsonDocument::Compact);
+}
+
+bool ColumnsServer::slice(FileInformation& info, const QUrlQuery& query, QByteArray& body, headers& extra, QString& error)
+{
+    bool ok = true;
+    auto number = [&](const QString& key, qint64 defaultValue) {
+        if(!query.hasQueryItem(key))
+            return defaultValue;
+        bool isNumber = false;
+        auto value = query.queryItemValue(key).toLongLong(&isNumber);
+        if(!isNumber || value < 0)
+        {
+            error = key + " must be a count above or equal to 0";
+            ok = false;
+        }
+        return value;
+    };
+    auto index = number("stream", 0);
+    auto start = number("start", 0);
+    auto end = number("end", std::numeric_limits<qint64>::max());
+    auto points = number("points", defaultPoints);
+    if(!ok)
+        return false;
+
+    CommonStats* stat = (size_t)index < info.Stats.size() ? info.Stats[index] : nullptr;
+    if(!stat)
+    {
+        error = QString("no stream %1 in the report").arg(index);
+        return false;
+    }
+
+    // Items by name, in the order of the request
+    const struct stream_info& streamInfo = PerStreamType[stat->Type_Get()];
+    std::vector<size_t> items;
+    for(const auto& name : query.queryItemValue("columns", QUrl::FullyDecoded).split(','))
+    {
+        if(name.isEmpty())
+            continue;
+        size_t item = 0;
+        while(item < streamInfo.CountOfItems && (!streamInfo.PerItem[item].FFmpeg_Name || name != QLatin1String(streamInfo.PerItem[item].FFmpeg_Name)))
+            ++item;
+        if(item == streamInfo.CountOfItems)
+        {
+            error = "no column " + name + " in stream " + QString::number(index);
+            return false;
+        }
+        items.push_back(item);
+    }
+    if(items.empty())
+    {
+        error = "no columns";
+        return false;
+    }
+
+    // At most one frame by bucket
+    size_t frames = stat->x_Current;
+    size_t first = std::min((size_t)start, frames);
+    size_t last = std::min((size_t)end, frames);
+    if(last < first)
+        last = first;
+    size_t buckets = std::min((size_t)points, last - first);
+
+    body.resize((int)(items.size() * buckets * 2 * sizeof(float)));
+    auto output = reinterpret_cast<uchar*>(body.data());
+    auto write = [&](double value) {
+        qToLittleEndian<float>(std::isfinite(value) ? (float)value : std::numeric_limits<float>::quiet_NaN(), output);
+        output += sizeof(float);
+    };
+    for(auto item : items)
+        for(size_t bucket = 0; bucket < buckets; ++bucket)
+        {
+            size_t bucketBegin = first + (last - first) * bucket / buckets;
+            size_t bucketEnd = first + (last - first) * (bucket + 1) / buckets;
+            auto range = stat->y_Range(item, bucketBegin, bucketEnd);
+            write(range.Min != DBL_MAX ? range.Min : NAN);
+            write(range.Max != -DBL_MAX ? range.Max : NAN);
+        }
+
+    extra.append({"X-QCTools-Start", QByteArray::number((qulonglong)first)});
+    extra.append({"X-QCTools-End", QByteArray::number((qulonglong)last)});
+    extra.append({"X-QCTools-Points", QByteArray::number((qulonglong)buckets)});
+    return true;
+}
@@ -0,0 +1,84 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef COLUMNSSERVER_H
+#define COLUMNSSERVER_H
+//---------------------------------------------------------------------------
+
+#include "Core/FileInformation.h"
+#include "Core/SignalServer.h"
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrlQuery>
+#include <functional>
+#include <list>
+#include <memory>
+
+//---------------------------------------------------------------------------
+// Values of reports over HTTP for the plots of the web dashboard (--serve
+// with --serve-http), only what is drawn: reports are opened once (mapped
+// from their columns cache, see StatsColumnsCache) and kept for the next
+// requests, the ranges are decimated to minimum and maximum by bucket.
+//
+// Reports are read from the root directory only, their paths are relative to
+// it (no absolute paths nor ".."). GET requests, one by connection:
+//   /columns?report=<path>
+//     JSON: {"streams": [{"stream": index, "type": "video" | "audio",
+//     "frames": count, "columns": ["YAVG", ...]}, ...]}
+//   /slice?report=<path>&stream=<index>&columns=<name,...>&start=<frame>
+//          &end=<frame>&points=<count>
+//     Binary, little endian float32: for each column in the order of the
+//     request, for each bucket its minimum then its maximum (NaN if the bucket
+//     has no value). Frames from start (default 0) to end (excluded, default
+//     all) in points buckets at most (default 1000, at most one frame by
+//     bucket); headers X-QCTools-Start, X-QCTools-End, X-QCTools-Points.
+//   /metrics
+//     OpenMetrics text of the counters of the jobs of the server (see
+//     Batch::metrics), for a Prometheus scraper.
+// Errors are a status 400 or 404 with a JSON {"error": "..."}. Other origins
+// (the dashboard served elsewhere) are allowed only if set, see setOrigin.
+class ColumnsServer : public QObject
+{
+    Q_OBJECT
+public:
+    ColumnsServer();
+    ~ColumnsServer();
+
+    // [<address>:]<port>, localhost if no address
+    bool listen(const QString& name);
+    // Directory of the reports, the current one by default
+    bool setRoot(const QString& path);
+    // Value of Access-Control-Allow-Origin ("*" or "https://host"), not sent if empty
+    void setOrigin(const QByteArray& origin) { this->origin = origin; }
+    // Body of /metrics, 404 if not set
+    void setMetrics(const std::function<QByteArray()>& metrics) { this->metrics = metrics; }
+
+private:
+    typedef QList<QPair<QByteArray, QByteArray>> headers;
+
+    void request(QTcpSocket* socket);
+    void reply(QTcpSocket* socket, int status, const QByteArray& contentType, const QByteArray& body, const headers& extra = headers());
+    void replyError(QTcpSocket* socket, int status, const QString& message);
+
+    QString inRoot(const QString& fileName) const;
+    FileInformation* report(const QString& fileName);
+    QByteArray columns(FileInformation& info);
+    bool slice(FileInformation& info, const QUrlQuery& query, QByteArray& body, headers& extra, QString& error);
+
+    QTcpServer                  server;
+    std::function<QByteArray()> metrics;
+    QString                     root; // Canonical
+    QByteArray                  origin;
+    SignalServer                signalServer; // Not used, reports are only read
+    std::list<std::pair<QString, std::unique_ptr<FileInformation>>> reports; // Most recent first
+    static const size_t         reports_Max = 8;
+};
+
+#endif // COLUMNSSERVER_H
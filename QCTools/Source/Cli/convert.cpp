@@ -0,0 +1,215 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "convert.h"
+#include "cli.h"
+#include "Core/CommonStats.h"
+#include "Core/FileInformation.h"
+#include "Core/StatsColumnsCache.h"
+#include "Core/StatsColumnsReport.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+//---------------------------------------------------------------------------
+// Stats owned by the conversion, deleted with it
+struct stats_list
+{
+    std::vector<CommonStats*>   items;
+    ~stats_list()
+    {
+        for(auto stat : items)
+            delete stat;
+    }
+};
+
+//---------------------------------------------------------------------------
+bool isClose(double x, double y)
+{
+    return x == y || std::abs(x - y) <= 1e-6 * std::max(1.0, std::abs(x));
+}
+
+//---------------------------------------------------------------------------
+// Empty if loaded has the streams and frames of stats (and with values the time stamps and the values of the items), else the first difference
+QString difference(const std::vector<CommonStats*>& stats, const std::vector<CommonStats*>& loaded, bool values)
+{
+    for(size_t index = 0; index < std::max(stats.size(), loaded.size()); ++index)
+    {
+        auto stat = index < stats.size() ? stats[index] : nullptr;
+        auto other = index < loaded.size() ? loaded[index] : nullptr;
+        if(!stat && !other)
+            continue;
+        if(!stat || !other || stat->Type_Get() != other->Type_Get())
+            return QString("stream %1 is missing").arg(index);
+        if(stat->x_Current != other->x_Current)
+            return QString("stream %1 has %2 frames instead of %3").arg(index).arg(other->x_Current).arg(stat->x_Current);
+        if(!values)
+            continue;
+
+        const struct stream_info& streamInfo = PerStreamType[stat->Type_Get()];
+        for(size_t x = 0; x < stat->x_Current; ++x)
+        {
+            if(!isClose(stat->x[1][x] + stat->FirstTimeStamp, other->x[1][x] + other->FirstTimeStamp))
+                return QString("stream %1 frame %2 has another time stamp").arg(index).arg(x);
+            for(size_t item = 0; item < streamInfo.CountOfItems; ++item)
+                if(stat->Item_IsUsed(item) && !isClose(stat->y[item][x], other->y[item][x]))
+                    return QString("stream %1 frame %2 has another %3").arg(index).arg(x).arg(streamInfo.PerItem[item].Name);
+        }
+    }
+    return QString();
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
+Convert::Convert(int jobs, bool force) : jobs(jobs > 0 ? jobs : std::max(1, QThread::idealThreadCount())), force(force)
+{
+}
+
+//---------------------------------------------------------------------------
+bool Convert::isReport(const QString& name)
+{
+    return name.endsWith(".qctools.xml.gz") || name.endsWith(".qctools.xml.zst") || name.endsWith(".qctools.xml");
+}
+
+//---------------------------------------------------------------------------
+// <media>.qctools.columns, whatever the compression of the XML report
+QString Convert::columnsFileName(const QString& report)
+{
+    return report.left(report.lastIndexOf(".qctools.xml")) + ".qctools.columns";
+}
+
+//---------------------------------------------------------------------------
+int Convert::exec(const QStringList& files)
+{
+    QStringList reports;
+    for(const auto& file : files)
+    {
+        QFileInfo info(file);
+        if(info.isDir())
+        {
+            QDirIterator it(info.absoluteFilePath(), QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+            while(it.hasNext())
+            {
+                auto path = it.next();
+                if(isReport(path))
+                    reports.append(path);
+            }
+        }
+        else if(info.isFile() && isReport(file))
+            reports.append(info.absoluteFilePath());
+        else
+        {
+            std::cout << file.toStdString() << " is not a folder nor an XML report." << std::endl;
+            return InvalidInput;
+        }
+    }
+    reports.sort();
+    reports.removeDuplicates();
+
+    std::cout << "converting " << reports.size() << (reports.size() > 1 ? " reports" : " report") << " with " << jobs << (jobs > 1 ? " jobs... " : " job... ") << std::endl;
+
+    // Each thread takes the next report
+    std::atomic<int> next(0);
+    std::atomic<int> counts[Failed + 1] = {};
+    std::vector<std::thread> workers;
+    for(int i = 0; i < std::min(jobs, (int)reports.size()); ++i)
+        workers.emplace_back([&]() {
+            for(int index; (index = next++) < reports.size();)
+            {
+                QString message;
+                auto result = convert(reports[index], message);
+                ++counts[result];
+
+                std::lock_guard<std::mutex> lock(output);
+                std::cout << "[" << ++done << "/" << reports.size() << "] " << reports[index].toStdString() << ": " << message.toStdString() << std::endl;
+            }
+        });
+    for(auto& worker : workers)
+        worker.join();
+
+    std::cout << "converting " << reports.size() << (reports.size() > 1 ? " reports" : " report") << "... done, " << counts[Converted] << " converted, "
+              << counts[UpToDate] << " up to date, " << counts[Failed] << " failed" << std::endl;
+    return counts[Failed] ? InvalidInput : Success;
+}
+
+//---------------------------------------------------------------------------
+Convert::result Convert::convert(const QString& report, QString& message) const
+{
+    QFileInfo reportInfo(report);
+    QString columns = columnsFileName(report);
+    QFileInfo columnsInfo(columns);
+    if(!force && StatsColumnsCache::IsUpToDate(report) && columnsInfo.exists() && columnsInfo.lastModified() >= reportInfo.lastModified())
+    {
+        message = "up to date";
+        return UpToDate;
+    }
+
+    stats_list stats;
+    std::string trailer;
+    if(!FileInformation::ReadReport(report, stats.items, trailer))
+    {
+        message = "not a QCTools report";
+        return Failed;
+    }
+
+    auto fail = [&](const QString& reason) {
+        QFile::remove(StatsColumnsCache::FileName(report));
+        QFile::remove(columns);
+        message = reason;
+        return Failed;
+    };
+
+    // Outputs, renamed once complete
+    if(!StatsColumnsCache::Save(report, stats.items, trailer))
+        return fail("columns cache " + StatsColumnsCache::FileName(report) + " can not be written");
+    {
+        QSaveFile file(columns);
+        if(!file.open(QIODevice::WriteOnly) || !StatsColumnsReport::Save(file, stats.items, activefilters().set(), trailer) || !file.commit())
+            return fail("columnar report " + columns + " can not be written");
+    }
+
+    // Verification, as the outputs are read when the report is opened
+    {
+        StatsColumnsCache cache;
+        stats_list cached; // Deleted before the columns are unmapped
+        std::string cachedTrailer;
+        if(!cache.Load(report, cached.items, cachedTrailer))
+            return fail("columns cache can not be read back");
+        auto error = cachedTrailer != trailer ? QString("streams and format are different") : difference(stats.items, cached.items, false);
+        if(!error.isEmpty())
+            return fail("columns cache differs, " + error);
+    }
+    {
+        QFile file(columns);
+        stats_list loaded;
+        std::string loadedTrailer;
+        if(!file.open(QIODevice::ReadOnly) || !StatsColumnsReport::Load(file, loaded.items, loadedTrailer))
+            return fail("columnar report can not be read back");
+        auto error = difference(stats.items, loaded.items, true);
+        if(!error.isEmpty())
+            return fail("columnar report differs, " + error);
+    }
+
+    size_t frames = 0;
+    for(auto stat : stats.items)
+        if(stat)
+            frames += stat->x_Current;
+    message = QString("converted, %1 frames").arg(frames);
+    return Converted;
+}
@@ -0,0 +1,56 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef CONVERT_H
+#define CONVERT_H
+//---------------------------------------------------------------------------
+
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <mutex>
+
+//---------------------------------------------------------------------------
+// Conversion of existing XML reports (qcli --convert <folder>), without their
+// media: the .qctools.xml.gz, .qctools.xml.zst and .qctools.xml reports of the
+// folders and of their subfolders are read by the jobs in parallel, one report
+// per thread with the streaming reader (see FileInformation::ReadReport),
+// then their columns cache (.qctools.cols, see StatsColumnsCache) and their
+// columnar report (.qctools.columns next to them, see StatsColumnsReport) are
+// written and read back to be verified against the parsed stats. Outputs of a
+// report failing the verification are removed, the other reports continue.
+//
+// A report is converted again only if it changed since (its cache is not up
+// to date or its columnar report is older than it), unless forced.
+class Convert
+{
+public:
+    // Jobs is the count of reports converted at the same time, 0 for one per core
+    Convert(int jobs, bool force);
+
+    // Files are reports or folders, returns the error of qcli (Success if all the reports are converted or up to date)
+    int exec(const QStringList& files);
+
+private:
+    enum result
+    {
+        Converted,
+        UpToDate,
+        Failed,
+    };
+
+    static bool isReport(const QString& name);
+    static QString columnsFileName(const QString& report);
+    result convert(const QString& report, QString& message) const;
+
+    int                         jobs;
+    bool                        force;
+    std::mutex                  output; // Lines of the threads
+    std::atomic<size_t>         done {0};
+};
+
+#endif // CONVERT_H
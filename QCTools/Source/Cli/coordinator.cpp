@@ -0,0 +1,339 @@
+#include "coordinator.h"
+#include "cli.h"
+#include "Core/CommonStats.h"
+#include "Core/FileInformation.h"
+#include "Core/StatsSegmentParser.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Workers which did not send their "ready" event in this time are not used
+static const int ReadyTimeout = 10000; // ms
+
+// A shard is sent again to an idle worker when it runs for this multiple of the median time of the shards done
+static const double StragglerFactor = 2;
+
+// Time stamps of the shots of the video of a previous report of the file, empty if none
+static std::vector<double> reportShots(const QString& report)
+{
+    std::vector<double> shots;
+    std::vector<CommonStats*> stats;
+    std::string trailer;
+    if(QFileInfo(report).isFile() && FileInformation::ReadReport(report, stats, trailer))
+    {
+        auto video = std::find_if(stats.begin(), stats.end(), [](CommonStats* stat) { return stat && stat->Type_Get() == Type_Video; });
+        if(video != stats.end())
+            for(auto start : (*video)->shots.Get())
+                shots.push_back((*video)->x[1][start] + (*video)->FirstTimeStamp);
+    }
+    for(auto stat : stats)
+        delete stat;
+    return shots;
+}
+
+Coordinator::Coordinator(const QString& input, const QString& output, const QStringList& names, const Options& options) :
+    input(input), output(output), options(options)
+{
+    for(const auto& name : names)
+    {
+        workers.emplace_back(new worker);
+        workers.back()->name = name;
+    }
+
+    readyTimer.setSingleShot(true);
+    connect(&readyTimer, &QTimer::timeout, this, &Coordinator::plan);
+    connect(&stragglersTimer, &QTimer::timeout, this, &Coordinator::dispatch);
+}
+
+Coordinator::~Coordinator()
+{
+    // Not lost when closed now
+    for(auto& Worker : workers)
+        if(Worker->socket)
+        {
+            Worker->socket->disconnect(this);
+            delete Worker->socket.data();
+        }
+}
+
+int Coordinator::exec(QStringList& reports)
+{
+    // From the loop, a local socket may fail while connecting
+    QTimer::singleShot(0, this, [this]() {
+        for(auto& Worker : workers)
+            connectWorker(*Worker);
+        if(!planned)
+            readyTimer.start(ReadyTimeout);
+    });
+    loop.exec();
+
+    // Attempts not kept, including the ones still running on a lost worker
+    for(const auto& report : attemptsReports)
+        if(std::none_of(shards.begin(), shards.end(), [&](const shard& Shard) { return Shard.report == report; }))
+            QFile::remove(report);
+
+    reports.clear();
+    if(error == Success)
+        for(const auto& Shard : shards)
+            reports.append(Shard.report);
+    return error;
+}
+
+void Coordinator::connectWorker(worker& Worker)
+{
+    // <host>:<port> else a local socket name
+    auto port = Worker.name.mid(Worker.name.lastIndexOf(':') + 1);
+    bool isTcp = false;
+    port.toUShort(&isTcp);
+    isTcp = isTcp && Worker.name.contains(':');
+
+    QIODevice* socket;
+    if(isTcp)
+    {
+        auto tcpSocket = new QTcpSocket(this);
+        // Not connected either after an error or after a disconnection
+        connect(tcpSocket, &QAbstractSocket::stateChanged, this, [this, &Worker](QAbstractSocket::SocketState state) {
+            if(state == QAbstractSocket::UnconnectedState)
+                lose(Worker);
+        });
+        connect(tcpSocket, &QTcpSocket::connected, this, [this, tcpSocket]() { authorize(tcpSocket); });
+        tcpSocket->connectToHost(Worker.name.left(Worker.name.length() - port.length() - 1), port.toUShort());
+        socket = tcpSocket;
+    }
+    else
+    {
+        auto localSocket = new QLocalSocket(this);
+        connect(localSocket, &QLocalSocket::stateChanged, this, [this, &Worker](QLocalSocket::LocalSocketState state) {
+            if(state == QLocalSocket::UnconnectedState)
+                lose(Worker);
+        });
+        connect(localSocket, &QLocalSocket::connected, this, [this, localSocket]() { authorize(localSocket); });
+        localSocket->connectToServer(Worker.name);
+        socket = localSocket;
+    }
+
+    Worker.socket = socket;
+    connect(socket, &QIODevice::readyRead, this, [this, &Worker, socket]() {
+        while(socket->canReadLine())
+            event(Worker, QJsonDocument::fromJson(socket->readLine()).object());
+    });
+}
+
+void Coordinator::authorize(QIODevice* socket)
+{
+    // The worker sends "ready" once the token is checked
+    if(!options.token.isEmpty())
+        socket->write(QJsonDocument(QJsonObject {{"token", options.token}}).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void Coordinator::event(worker& Worker, const QJsonObject& object)
+{
+    auto name = object.value("event").toString();
+    if(name == "ready")
+    {
+        Worker.ready = true;
+        Worker.pipelines = std::max(1, object.value("pipelines").toInt(1));
+
+        // Planned as soon as all the workers are known
+        if(std::all_of(workers.begin(), workers.end(), [](const std::unique_ptr<worker>& Item) { return Item->ready || Item->lost; }))
+            plan();
+        else
+            dispatch();
+        return;
+    }
+
+    // Id is "<shard>:<attempt>"
+    auto id = object.value("id").toString();
+    auto index = (size_t)id.section(':', 0, 0).toULongLong();
+    if(!Worker.jobs.count(id) || index >= shards.size())
+        return;
+    shard& Shard = shards[index];
+
+    if(name == "progress")
+    {
+        Shard.percent = std::max(Shard.percent, object.value("percent").toInt());
+        int total = 0;
+        for(const auto& Item : shards)
+            total += Item.done ? 100 : Item.percent;
+        Q_EMIT progress(total / (int)shards.size());
+        return;
+    }
+
+    if(name != "finished" && name != "error")
+        return;
+
+    Worker.jobs.erase(id);
+    Shard.running--;
+    int status = name == "error" ? InvalidInput : object.value("status").toInt(InvalidInput);
+    if(status == Success && !Shard.done)
+    {
+        Shard.done = true;
+        Shard.report = attemptReport(index, id.section(':', 1, 1).toInt());
+        durations.push_back(Shard.timer.elapsed());
+    }
+    else if(status != Success && !Shard.done)
+    {
+        lastError = status;
+        Q_EMIT warning(QString("shard %1 failed on %2: %3").arg(index).arg(Worker.name).arg(object.value("message").toString()));
+    }
+
+    dispatch();
+}
+
+void Coordinator::lose(worker& Worker)
+{
+    if(Worker.lost)
+        return;
+    Worker.lost = true;
+    Worker.ready = false;
+    Q_EMIT warning(QString("worker %1 is not available").arg(Worker.name));
+
+    // Running shards are sent again if they are not done by another worker
+    for(const auto& id : Worker.jobs)
+    {
+        auto index = (size_t)id.section(':', 0, 0).toULongLong();
+        if(index < shards.size())
+            shards[index].running--;
+    }
+    Worker.jobs.clear();
+
+    if(planned)
+        dispatch();
+    else if(std::all_of(workers.begin(), workers.end(), [](const std::unique_ptr<worker>& Item) { return Item->ready || Item->lost; }))
+        plan();
+}
+
+void Coordinator::plan()
+{
+    if(planned)
+        return;
+    planned = true;
+    readyTimer.stop();
+
+    int pipelines = 0;
+    for(const auto& Worker : workers)
+        if(Worker->ready)
+            pipelines += Worker->pipelines;
+    if(!pipelines)
+    {
+        Q_EMIT warning("no worker is available");
+        finish(InvalidInput);
+        return;
+    }
+
+    // Key frames from an index probe of the file, at the shots of a previous analysis if any, the whole file if it can not be split
+    auto boundaries = StatsSegmentParser::Boundaries(input, options.shards > 0 ? options.shards : pipelines * 2, reportShots(output));
+    double start = -std::numeric_limits<double>::infinity();
+    for(auto boundary : boundaries)
+    {
+        shards.emplace_back();
+        shards.back().start = start;
+        shards.back().end = boundary;
+        start = boundary;
+    }
+    shards.emplace_back();
+    shards.back().start = start;
+    shards.back().end = std::numeric_limits<double>::infinity();
+
+    stragglersTimer.start(1000);
+    dispatch();
+}
+
+void Coordinator::dispatch()
+{
+    if(!planned || error)
+        return;
+
+    if(std::all_of(shards.begin(), shards.end(), [](const shard& Shard) { return Shard.done; }))
+    {
+        finish(Success);
+        return;
+    }
+
+    for(size_t index = 0; index < shards.size(); ++index)
+    {
+        shard& Shard = shards[index];
+        if(!Shard.done && !Shard.running && Shard.attempts > options.retries)
+        {
+            Q_EMIT warning(QString("shard %1 failed %2 times").arg(index).arg(Shard.attempts));
+            finish(lastError ? lastError : InvalidInput);
+            return;
+        }
+    }
+
+    auto idle = [](const worker& Worker) {
+        return Worker.ready && !Worker.lost && (int)Worker.jobs.size() < Worker.pipelines;
+    };
+
+    // Shards not running, in order
+    for(size_t index = 0; index < shards.size(); ++index)
+    {
+        shard& Shard = shards[index];
+        if(Shard.done || Shard.running)
+            continue;
+        auto Worker = std::find_if(workers.begin(), workers.end(), [&](const std::unique_ptr<worker>& Item) { return idle(*Item); });
+        if(Worker == workers.end())
+            return;
+        send(**Worker, index);
+    }
+
+    // Stragglers, once there is nothing else to do, on a worker which is not already running them
+    if(durations.empty())
+        return;
+    auto sorted = durations;
+    std::sort(sorted.begin(), sorted.end());
+    auto median = sorted[sorted.size() / 2];
+    for(size_t index = 0; index < shards.size(); ++index)
+    {
+        shard& Shard = shards[index];
+        if(Shard.done || Shard.running != 1 || Shard.attempts > options.retries || Shard.timer.elapsed() < median * StragglerFactor)
+            continue;
+        auto Worker = std::find_if(workers.begin(), workers.end(), [&](const std::unique_ptr<worker>& Item) {
+            return idle(*Item) && std::none_of(Item->jobs.begin(), Item->jobs.end(), [&](const QString& id) { return id.section(':', 0, 0).toULongLong() == index; });
+        });
+        if(Worker == workers.end())
+            return;
+        Q_EMIT warning(QString("shard %1 is slow, sent again to %2").arg(index).arg((*Worker)->name));
+        send(**Worker, index);
+    }
+}
+
+void Coordinator::send(worker& Worker, size_t index)
+{
+    shard& Shard = shards[index];
+    if(!Shard.attempts)
+        Shard.timer.start();
+    auto attempt = ++Shard.attempts;
+    Shard.running++;
+
+    auto id = QString("%1:%2").arg(index).arg(attempt);
+    auto report = attemptReport(index, attempt);
+    attemptsReports.append(report);
+    Worker.jobs.insert(id);
+
+    QJsonObject job {{"id", id}, {"input", input}, {"output", report}, {"report", "xml.gz"}, {"force", true}, {"segments", 1}};
+    if(std::isfinite(Shard.start))
+        job.insert("start", Shard.start);
+    if(std::isfinite(Shard.end))
+        job.insert("end", Shard.end);
+    if(!options.filters.isEmpty())
+        job.insert("filters", options.filters);
+    Worker.socket->write(QJsonDocument(job).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void Coordinator::finish(int result)
+{
+    error = result;
+    stragglersTimer.stop();
+    loop.quit();
+}
+
+QString Coordinator::attemptReport(size_t index, int attempt) const
+{
+    return output + QString(".shard%1.%2.qctools.xml.gz").arg(index).arg(attempt);
+}
@@ -0,0 +1,106 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef COORDINATOR_H
+#define COORDINATOR_H
+//---------------------------------------------------------------------------
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+#include <memory>
+#include <set>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Analysis of one long file by several qcli --serve workers, possibly on
+// other hosts reading the same file (shared storage, or an URL read by
+// FFmpeg).
+//
+// The file is split at video key frames (see StatsSegmentParser::Boundaries),
+// at the cuts of the previous report of the output if any, and each shard is a job of a worker on this range ("start" and "end", see
+// Server). Its report is written next to the output, so on the storage shared
+// with the workers. A worker gets as many shards at a time as its pipelines.
+// Failed shards and shards of a disconnected worker are sent again to another
+// worker. Near the end, shards much slower than the others are also sent to
+// an idle worker, and the first report of a shard is kept.
+class Coordinator : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options
+    {
+        QString                 filters;                    // As in the -f option joined by '+', empty for the defaults of the workers
+        int                     shards {0};                 // 0 means 2 per pipeline of the workers
+        int                     retries {2};                // Per shard, after the first attempt
+        QString                 token;                      // Sent first to the workers if not empty, see Server
+    };
+
+    // Workers are "<host>:<port>" (see --serve tcp:<port>) or local socket names
+    Coordinator(const QString& input, const QString& output, const QStringList& workers, const Options& options);
+    ~Coordinator();
+
+    // Returns Success and the reports of the shards in time order, else the error of the last failed attempt
+    int exec(QStringList& reports);
+
+Q_SIGNALS:
+    void progress(int percent);
+    void warning(const QString& message);
+
+private:
+    struct shard
+    {
+        double                  start;
+        double                  end;
+        int                     attempts {0};
+        int                     running {0};
+        int                     percent {0};
+        bool                    done {false};
+        QString                 report;                     // Of the attempt kept
+        QElapsedTimer           timer;                      // Since the first attempt started
+    };
+
+    struct worker
+    {
+        QString                 name;
+        QPointer<QIODevice>     socket;
+        bool                    ready {false};
+        bool                    lost {false};
+        int                     pipelines {1};
+        std::set<QString>       jobs;                       // Ids of the attempts running
+    };
+
+    void connectWorker(worker& Worker);
+    void authorize(QIODevice* socket);
+    void event(worker& Worker, const QJsonObject& object);
+    void lose(worker& Worker);
+    void plan();
+    void dispatch();
+    void send(worker& Worker, size_t index);
+    void finish(int error);
+    QString attemptReport(size_t index, int attempt) const;
+
+    QString                     input;
+    QString                     output;
+    Options                     options;
+    std::vector<std::unique_ptr<worker>> workers;
+    std::vector<shard>          shards;
+    std::vector<qint64>         durations;                  // Of the shards done, in ms
+    QStringList                 attemptsReports;            // All the reports asked, the ones not kept are removed
+    QEventLoop                  loop;
+    QTimer                      readyTimer;
+    QTimer                      stragglersTimer;
+    bool                        planned {false};
+    int                         error {0};
+    int                         lastError {0};
+};
+
+#endif // COORDINATOR_H
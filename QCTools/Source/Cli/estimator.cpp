@@ -0,0 +1,233 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "estimator.h"
+#include "batch.h"
+#include "Core/CommonStats.h"
+#include "Core/FileInformation.h"
+#include "Core/StatsArrowReport.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+const double MB = 1024.0 * 1024.0;
+const double FramesInFlight = 16;   // Per pipeline: decoded ahead, in the filter graphs and in the thumbnails chain
+const double FrameColumnsBytes = 64; // Per frame: x, durations, pkt_pos, pkt_pts, pkt_size, key frame and picture type
+const double PanelCost = 0.25;      // Per panel, scale + crop + tile of each frame
+const double XmlRatio = 8;          // .xml from the .xml.gz size, about the ratio of gzip on the reports
+
+//---------------------------------------------------------------------------
+// Relative to the decoding of the frame, as Batch::budget()
+double cost(const activefilters& filters, int panels)
+{
+    double result = 1.0;
+    for(int filter = 0; filter < ActiveFilter_Max; ++filter)
+        if(filters.test(filter))
+            result += ActiveFilter_Cost((activefilter)filter);
+    return result + panels * PanelCost;
+}
+
+//---------------------------------------------------------------------------
+// Items of the stream type stored with these filters
+double items(int type, const activefilters& filters)
+{
+    const auto& info = PerStreamType[type];
+    size_t count = 0;
+    for(size_t j = 0; j < info.CountOfItems; ++j)
+    {
+        const auto& item = info.PerItem[j];
+        if(item.FFmpeg_Name && (item.Filter == activefilter(-1) || filters.test(item.Filter)))
+            ++count;
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------
+// Decoded yuv422p frame
+double frameBytes(double width, double height, int depth)
+{
+    return width * height * (depth > 8 ? 2 : 1) * 2;
+}
+
+//---------------------------------------------------------------------------
+double median(std::vector<double> values)
+{
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+}
+
+//***************************************************************************
+// Calibration
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Estimator::calibrate(const QString& fileName, QString* error)
+{
+    auto fail = [&](const QString& reason) {
+        if(error)
+            *error = reason;
+        return false;
+    };
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return fail("can not be read");
+    auto document = QJsonDocument::fromJson(file.readAll());
+    if(!document.isObject() || !document.object().value("results").isArray())
+        return fail("is not a result of qctools-bench");
+
+    // Exports of the same input are matched by their input
+    std::vector<double> rates, bases, reportRates, mkvRates;
+    std::map<QByteArray, std::pair<double, double>> xmlGzExports; // Bytes and video frames
+    std::vector<std::pair<QByteArray, double>> mkvExports;
+    for(const auto& item : document.object().value("results").toArray())
+    {
+        auto result = item.toObject();
+        if(result.contains("error"))
+            continue;
+
+        auto input = result.value("input").toObject();
+        auto key = QJsonDocument(input).toJson(QJsonDocument::Compact);
+        auto step = result.value("step").toString();
+        auto filters = Batch::parseFilters(result.value("filters").toString().split('+'), activefilters());
+        double seconds = result.value("seconds").toDouble();
+        double frames = result.value("frames").toDouble();
+        double bytes = result.value("bytes").toDouble();
+        double width = input.value("width").toDouble();
+        double height = input.value("height").toDouble();
+        if(frames <= 0)
+            continue;
+
+        if(step == "parse" && seconds > 0)
+        {
+            rates.push_back(frames * width * height / 1e6 * cost(filters, 0) / seconds);
+            double variable = frames * (items(Type_Video, filters) * sizeof(double) + FrameColumnsBytes) + FramesInFlight * frameBytes(width, height, input.value("depth").toInt());
+            bases.push_back(result.value("peak_rss_mb").toDouble() - variable / MB);
+        }
+        else if(step == "export_xml_gz" && items(Type_Video, filters))
+        {
+            reportRates.push_back(bytes / (frames * items(Type_Video, filters)));
+            xmlGzExports[key] = std::make_pair(bytes, frames);
+        }
+        else if(step == "make_mkv_report")
+            mkvExports.push_back(std::make_pair(key, bytes));
+    }
+    for(const auto& mkvExport : mkvExports)
+    {
+        auto xmlGzExport = xmlGzExports.find(mkvExport.first);
+        if(xmlGzExport != xmlGzExports.end() && mkvExport.second > xmlGzExport->second.first)
+            mkvRates.push_back((mkvExport.second - xmlGzExport->second.first) / xmlGzExport->second.second);
+    }
+
+    if(rates.empty())
+        return fail("has no parsing result");
+    pixelRate = median(rates);
+    baseMemory = std::max(0.0, median(bases));
+    if(!reportRates.empty())
+        reportBytesPerValue = median(reportRates);
+    if(!mkvRates.empty())
+        mkvBytesPerFrame = median(mkvRates);
+    calibrated = true;
+    return true;
+}
+
+//***************************************************************************
+// Estimate
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+QJsonObject Estimator::estimate(FileInformation& info, const Options& options) const
+{
+    // Frames expected from the probe (see CommonStats), else from the duration
+    double valueBytes = CommonStats::CompactStorage_Get() ? sizeof(float) : sizeof(double);
+    double megapixels = 0;
+    double audioSeconds = 0;
+    double videoFrames = 0;
+    double audioValues = 0;
+    double allValues = 0;
+    double statsBytes = 0;
+    double maxFrames = 0;
+    for(auto stat : info.Stats)
+    {
+        if(!stat)
+            continue;
+        int type = stat->Type_Get();
+        double frames = (double)stat->x_Current_Max;
+        if(!frames && type == Type_Video)
+            frames = info.duration() * info.averageFrameRate();
+        double count = items(type, options.filters);
+        allValues += frames * count;
+        statsBytes += frames * (count * valueBytes + FrameColumnsBytes);
+        maxFrames = std::max(maxFrames, frames);
+        if(type == Type_Video)
+        {
+            megapixels += frames * info.width() * info.height() / 1e6;
+            videoFrames += frames;
+        }
+        else
+        {
+            audioSeconds += info.duration();
+            audioValues += frames * count;
+        }
+    }
+    int pipelines = std::max(1, options.pipelines);
+
+    // Time
+    double seconds = (megapixels * cost(options.filters, options.panels) / pixelRate + audioSeconds * audioRate) / pipelines;
+
+    // Memory
+    bool mkvReport = options.output.endsWith(".qctools.mkv");
+    double memory = baseMemory * MB + statsBytes;
+    if(videoFrames)
+        memory += pipelines * FramesInFlight * frameBytes(info.width(), info.height(), info.BitsPerRawSample());
+    if(mkvReport)
+        memory += videoFrames * mkvBytesPerFrame;
+
+    // Output, the audio values of the video files are in the rate of the video values (as in the benchmark inputs)
+    double values = videoFrames ? videoFrames * items(Type_Video, options.filters) : audioValues;
+    double outputBytes = values * reportBytesPerValue;
+    if(options.output.endsWith(".qctools.columns") || StatsArrowReport::IsArrowReport(options.output))
+        outputBytes = allValues * valueBytes + maxFrames * FrameColumnsBytes;
+    else if(options.output.endsWith(".xml"))
+        outputBytes *= XmlRatio;
+    else if(mkvReport)
+        outputBytes += videoFrames * mkvBytesPerFrame;
+
+    QStringList filterNames;
+    for(int filter = 0; filter < ActiveFilter_Max; ++filter)
+        if(options.filters.test(filter))
+            filterNames.append(ActiveFilter_Name((activefilter)filter));
+
+    return QJsonObject {
+        {"input", info.fileName()},
+        {"calibrated", calibrated},
+        {"width", info.width()},
+        {"height", info.height()},
+        {"duration", info.duration()},
+        {"streams", info.streamCount},
+        {"bit_rate", info.bitRate},
+        {"video_frames", videoFrames},
+        {"filters", filterNames.join('+')},
+        {"panels", options.panels},
+        {"pipelines", pipelines},
+        {"wall_seconds", seconds},
+        {"peak_memory_mb", memory / MB},
+        {"output", QFileInfo(options.output).fileName()},
+        {"output_bytes", outputBytes},
+    };
+}
@@ -0,0 +1,57 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+//---------------------------------------------------------------------------
+
+#include "Core/Core.h"
+#include <QJsonObject>
+#include <QString>
+
+class FileInformation;
+
+//---------------------------------------------------------------------------
+// Wall time, peak memory and output size of the analysis of a file from its
+// probe only (qcli --estimate), so a scheduler places the job on a node able
+// to run it.
+//
+// Time is the megapixels of the video frames weighted by the cost of the
+// filters and panels (see ActiveFilter_Cost) over the rate of the machine,
+// split on the pipelines. Memory is a base plus the stats columns of all the
+// frames and the decoded frames in flight of each pipeline (plus the
+// thumbnails of a .qctools.mkv report). Output is the values of the report.
+// The rates and the base are from the results of qctools-bench run on this
+// machine (calibrate()), else defaults of a recent 8-core machine.
+class Estimator
+{
+public:
+    struct Options
+    {
+        activefilters           filters;
+        int                     panels {0};         // Panels computed
+        int                     pipelines {1};      // Segments parsed in parallel
+        QString                 output;             // Report file name, its extension selects the format
+    };
+
+    // Rates and base memory from the JSON results of qctools-bench, false and the reason if they can not be used
+    bool calibrate(const QString& fileName, QString* error = nullptr);
+    bool isCalibrated() const {return calibrated;}
+
+    // Estimate of a file opened but not parsed
+    QJsonObject estimate(FileInformation& info, const Options& options) const;
+
+private:
+    double                      pixelRate {60.0};           // Megapixels per second at cost 1, one pipeline
+    double                      audioRate {0.01};           // Seconds of parsing per second of audio stream
+    double                      baseMemory {150.0};         // MB, libraries and buffers of one file
+    double                      reportBytesPerValue {5.0};  // .qctools.xml.gz, per value of the video items
+    double                      mkvBytesPerFrame {600.0};   // .qctools.mkv, thumbnails and panels per video frame
+    bool                        calibrated {false};
+};
+
+#endif // ESTIMATOR_H
@@ -0,0 +1,128 @@
+#include "live.h"
+#include "cli.h"
+#include "Core/CommonStats.h"
+#include "Core/FileInformation.h"
+#include "Core/StatsThresholds.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Frames in the ring of the aggregates, per second of the window, for the highest frame rates (audio stats frames included)
+static const size_t FramesPerSecond = 120;
+
+// Items with a value in the frames of the bucket, by FFmpeg name
+static QJsonObject itemsJson(const struct stream_info& streamInfo, const StatsWindow::bucket& bucket)
+{
+    QJsonObject items;
+    for(size_t item = 0; item < bucket.Items.size(); ++item)
+    {
+        const auto& aggregate = bucket.Items[item];
+        if(!aggregate.Count || !streamInfo.PerItem[item].FFmpeg_Name)
+            continue;
+        items.insert(streamInfo.PerItem[item].FFmpeg_Name, QJsonObject {{"min", aggregate.Min}, {"max", aggregate.Max}, {"average", aggregate.Average()}});
+    }
+    return items;
+}
+
+size_t LiveMonitor::framesWindow(double window)
+{
+    // The other threads read half of the window, the parser may be far ahead between two updates
+    return std::max<size_t>(4096, (size_t)std::ceil(window * FramesPerSecond)) * 4;
+}
+
+LiveMonitor::LiveMonitor(const QString& input, const Options& options, std::ostream& output) :
+    input(input), options(options), output(output)
+{
+    connect(&timer, &QTimer::timeout, this, &LiveMonitor::update);
+}
+
+LiveMonitor::~LiveMonitor()
+{
+}
+
+int LiveMonitor::exec()
+{
+    // No panels and one segment, a live stream can not be split
+    info.reset(new FileInformation(&signalServer, input, options.filters, options.activeAllTracks, QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>>(), QString()));
+    info->setAutoCheckFileUploaded(false);
+    info->setAutoUpload(false);
+    if(!info->isValid())
+    {
+        std::cout << "invalid input, live analysis stopped.. " << std::endl;
+        return InvalidInput;
+    }
+    info->setParsingSegments(1);
+
+    connect(info.get(), &FileInformation::parsingCompleted, this, &LiveMonitor::finish);
+    info->startParse();
+    timer.start(options.interval);
+    loop.exec();
+    return error;
+}
+
+void LiveMonitor::update()
+{
+    if(windows.size() < info->Stats.size())
+        windows.resize(info->Stats.size());
+
+    for(size_t stream = 0; stream < info->Stats.size(); ++stream)
+    {
+        CommonStats* stat = info->Stats[stream];
+        if(!stat)
+            continue;
+        if(!windows[stream])
+            windows[stream].reset(new StatsWindow(framesWindow(options.window) / 4));
+        StatsWindow& window = *windows[stream];
+        window.Update(*stat);
+        if(!window.Frames())
+            continue;
+
+        const struct stream_info& streamInfo = PerStreamType[stat->Type_Get()];
+        auto bucket = window.Window(options.window);
+        send(QJsonObject {{"event", "window"}, {"time", bucket.Time_End}, {"stream", (int)stream}, {"frames", (double)bucket.Frames},
+                          {"dropped", (double)window.Dropped()}, {"items", itemsJson(streamInfo, bucket)}});
+    }
+
+    if(options.thresholds)
+    {
+        options.thresholds->Update(info->Stats);
+        for(const auto& line : options.thresholds->Alerts(info->Stats).split('\n'))
+        {
+            if(line.isEmpty())
+                continue;
+            QJsonObject event = QJsonDocument::fromJson(line).object();
+            event.insert("event", "alert");
+            send(event);
+        }
+    }
+}
+
+void LiveMonitor::finish(bool success)
+{
+    timer.stop();
+    update();
+
+    for(size_t stream = 0; stream < windows.size(); ++stream)
+    {
+        if(!windows[stream] || !info->Stats[stream])
+            continue;
+
+        const struct stream_info& streamInfo = PerStreamType[info->Stats[stream]->Type_Get()];
+        QJsonArray buckets;
+        for(const auto& bucket : windows[stream]->History())
+        {
+            buckets.append(QJsonObject {{"start", bucket.Time_Begin}, {"end", bucket.Time_End}, {"frames", (double)bucket.Frames}, {"items", itemsJson(streamInfo, bucket)}});
+        }
+        send(QJsonObject {{"event", "history"}, {"stream", (int)stream}, {"buckets", buckets}});
+    }
+
+    error = success ? Success : ParsingFailure;
+    loop.quit();
+}
+
+void LiveMonitor::send(QJsonObject event)
+{
+    output << QJsonDocument(event).toJson(QJsonDocument::Compact).constData() << std::endl;
+}
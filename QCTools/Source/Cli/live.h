@@ -0,0 +1,77 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef LIVE_H
+#define LIVE_H
+//---------------------------------------------------------------------------
+
+#include "Core/Core.h"
+#include "Core/SignalServer.h"
+#include "Core/StatsWindow.h"
+#include <QEventLoop>
+#include <QJsonObject>
+#include <QTimer>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+class FileInformation;
+class StatsThresholds;
+
+//---------------------------------------------------------------------------
+// Analysis of a live stream (--live), which may never end, in a bounded
+// memory: the parser keeps a window of the stats (see CommonStats::Window_Set)
+// and the aggregates are computed while parsing (see StatsWindow).
+//
+// One JSON object per line:
+//   {"event": "window", "time": seconds, "stream": index, "frames": count, "dropped": count,
+//    "items": {"<FFmpeg name>": {"min": v, "max": v, "average": v}, ...}} every interval,
+//    over the last window seconds
+//   {"event": "alert", ...} for each violation of the -thresholds started or closed
+//    (see StatsThresholds::Alerts), with "state": "started" or "closed"
+//   {"event": "history", "stream": index, "buckets": [{"start": s, "end": s, "frames": count,
+//    "items": {...}}, ...]} once the stream ended, the whole analysis at a decreasing resolution
+class LiveMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options
+    {
+        activefilters           filters;
+        activealltracks         activeAllTracks;
+        double                  window {10};                // Seconds of the aggregates
+        int                     interval {1000};            // Milliseconds between the aggregates
+        StatsThresholds*        thresholds {nullptr};       // Not owned
+    };
+
+    // Frames kept by the parser, to be set with CommonStats::Window_Set before the parsing, for a window in seconds
+    static size_t framesWindow(double window);
+
+    // Events are written in output
+    LiveMonitor(const QString& input, const Options& options, std::ostream& output);
+    ~LiveMonitor();
+
+    // Runs until the end of the stream, returns Success if it has been opened
+    int exec();
+
+private:
+    void update();
+    void finish(bool success);
+    void send(QJsonObject event);
+
+    QString                     input;
+    Options                     options;
+    std::ostream&               output;
+    SignalServer                signalServer;               // Not used
+    std::unique_ptr<FileInformation> info;
+    std::vector<std::unique_ptr<StatsWindow>> windows;      // By stream
+    QEventLoop                  loop;
+    QTimer                      timer;
+    int                         error {0};
+};
+
+#endif // LIVE_H
@@ -0,0 +1,425 @@
+#include "server.h"
+#include "cli.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <functional>
+#include <iostream>
+#include <string>
+
+//---------------------------------------------------------------------------
+// Lines of stdin, read by a thread because stdin can not be watched by the event loop on all platforms
+class StdinReader : public QThread
+{
+public:
+    explicit StdinReader(Server* server, const std::function<void(const QByteArray&)>& line, const std::function<void()>& end) :
+        server(server), line(line), end(end)
+    {
+    }
+
+protected:
+    void run() override
+    {
+        std::string text;
+        while(std::getline(std::cin, text))
+        {
+            QByteArray data = QByteArray::fromStdString(text);
+            QMetaObject::invokeMethod(server, [this, data]() { line(data); }, Qt::QueuedConnection);
+
+            // Nothing is read after a quit command, so the thread ends with the server
+            QJsonObject object = QJsonDocument::fromJson(data).object();
+            if(object.value("command").toString() == "quit")
+                return;
+        }
+
+        QMetaObject::invokeMethod(server, [this]() { end(); }, Qt::QueuedConnection);
+    }
+
+private:
+    Server* server;
+    std::function<void(const QByteArray&)> line;
+    std::function<void()> end;
+};
+
+// Polling of the reports followed, and bytes queued to a client after which the next ones wait
+static const int Report_Interval = 250;
+static const qint64 Report_Pending_Max = 0x400000;
+
+Server::Server(const Batch::Options& defaults, int jobs, bool numa, int lookahead) : defaults(defaults), batch(jobs, numa), root(QDir::current().canonicalPath())
+{
+    batch.setLookahead(lookahead);
+    reportTimer.setInterval(Report_Interval);
+    connect(&reportTimer, &QTimer::timeout, this, [this]() {
+        for(auto& item : clients)
+            if(item.second.reportStarted)
+                sendReport(item.first, false);
+    });
+    connect(&batch, &Batch::started, this, [this](const QString& key, const QString&, int segments) {
+        auto item = clients.find(key);
+        if(item != clients.end() && !item->second.report.isEmpty())
+        {
+            item->second.reportStarted = true;
+            reportTimer.start();
+        }
+        send(key, QJsonObject {{"event", "started"}, {"segments", segments}});
+    });
+    connect(&batch, &Batch::paused, this, [this](const QString& key) {
+        send(key, QJsonObject {{"event", "paused"}});
+    });
+    connect(&batch, &Batch::resumed, this, [this](const QString& key) {
+        send(key, QJsonObject {{"event", "resumed"}});
+    });
+    connect(&batch, &Batch::progress, this, [this](const QString& key, int percent) {
+        send(key, QJsonObject {{"event", "progress"}, {"percent", percent}});
+    });
+    connect(&batch, &Batch::warning, this, [this](const QString& key, const QString& message) {
+        send(key, QJsonObject {{"event", "warning"}, {"message", message}});
+    });
+    connect(&batch, &Batch::finished, this, [this](const QString& key, const QString& input, const QString& output, int error, const QString& message, qint64 waited, qint64 ran) {
+        // Only the rest of a report written by this job, a failed one may have written nothing or something else
+        auto item = clients.find(key);
+        if(item != clients.end() && !item->second.report.isEmpty())
+        {
+            if(!error && item->second.reportStarted)
+                sendReport(key, true);
+            QFile::remove(item->second.report);
+        }
+        send(key, QJsonObject {{"event", "finished"}, {"status", error}, {"message", message}, {"input", input}, {"output", output},
+                               {"wait_seconds", waited / 1000.0}, {"run_seconds", ran / 1000.0}});
+        clients.erase(key);
+        if(clients.empty())
+            reportTimer.stop();
+
+        if(quitting && clients.empty())
+            loop.quit();
+    });
+}
+
+Server::~Server()
+{
+    // The reader ends after a quit command or at the end of stdin, before exec() returns
+    if(stdinReader)
+    {
+        stdinReader->wait();
+        delete stdinReader;
+    }
+}
+
+bool Server::setRoot(const QString& path)
+{
+    auto canonical = QDir(path).canonicalPath();
+    if(canonical.isEmpty())
+        return false;
+    root = canonical;
+    return true;
+}
+
+bool Server::listen(const QString& name)
+{
+    if(name.startsWith("tcp:"))
+    {
+        // tcp:<port> on localhost, or tcp:<address>:<port>
+        auto address = name.mid(4);
+        auto port = address.mid(address.lastIndexOf(':') + 1);
+        address.chop(port.length());
+        address.chop(address.endsWith(':') ? 1 : 0);
+        bool ok = false;
+        auto portNumber = port.toUShort(&ok);
+        QHostAddress hostAddress = address.isEmpty() ? QHostAddress(QHostAddress::LocalHost) : QHostAddress(address);
+        if(!ok || hostAddress.isNull())
+        {
+            listenError = "invalid address or port";
+            return false;
+        }
+        if(!hostAddress.isLoopback() && token.isEmpty())
+        {
+            listenError = "a token is needed to listen on another address than a loopback one";
+            return false;
+        }
+        if(!tcpServer.listen(hostAddress, portNumber))
+        {
+            listenError = tcpServer.errorString();
+            return false;
+        }
+
+        connect(&tcpServer, &QTcpServer::newConnection, this, [this]() {
+            while(QTcpSocket* socket = tcpServer.nextPendingConnection())
+            {
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                accept(socket);
+            }
+        });
+        return true;
+    }
+
+    QLocalServer::removeServer(name); // Socket file left by a crashed instance
+    if(!localServer.listen(name))
+    {
+        listenError = localServer.errorString();
+        return false;
+    }
+
+    connect(&localServer, &QLocalServer::newConnection, this, [this]() {
+        while(QLocalSocket* socket = localServer.nextPendingConnection())
+        {
+            connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+            accept(socket);
+        }
+    });
+
+    return true;
+}
+
+void Server::accept(QIODevice* socket)
+{
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() {
+        while(socket->canReadLine())
+        {
+            QByteArray line = socket->readLine();
+            if(!token.isEmpty() && !socket->property("authorized").toBool())
+            {
+                if(!authorize(line, socket))
+                    return;
+                continue;
+            }
+            request(line, socket);
+        }
+    });
+    if(token.isEmpty())
+        send(socket, QJsonObject {{"event", "ready"}, {"pipelines", batch.pipelinesCount()}});
+}
+
+bool Server::authorize(const QByteArray& line, QIODevice* socket)
+{
+    // Same time whatever the first characters which differ
+    QByteArray expected = token.toUtf8();
+    QByteArray received = QJsonDocument::fromJson(line).object().value("token").toString().toUtf8();
+    int difference = expected.size() ^ received.size();
+    for(int i = 0; i < expected.size(); ++i)
+        difference |= expected[i] ^ (i < received.size() ? received[i] : 0);
+
+    if(difference)
+    {
+        send(socket, QJsonObject {{"event", "error"}, {"message", "invalid token"}});
+        if(auto localSocket = qobject_cast<QLocalSocket*>(socket))
+            localSocket->disconnectFromServer();
+        else if(auto tcpSocket = qobject_cast<QTcpSocket*>(socket))
+            tcpSocket->disconnectFromHost();
+        return false;
+    }
+
+    socket->setProperty("authorized", true);
+    send(socket, QJsonObject {{"event", "ready"}, {"pipelines", batch.pipelinesCount()}});
+    return true;
+}
+
+QString Server::inRoot(const QString& path, bool isOutput) const
+{
+    if(!isOutput && (path.startsWith("http://") || path.startsWith("https://")))
+        return path;
+    if(path.contains("://"))
+        return QString();
+
+    // Links resolved, an output may not exist yet but its directory must
+    QFileInfo info(QDir(root).absoluteFilePath(path));
+    QString canonical = isOutput ? QDir(info.absolutePath()).canonicalPath() : info.canonicalFilePath();
+    if(canonical.isEmpty())
+        return QString();
+    if(isOutput)
+        canonical += '/' + info.fileName();
+    if(!canonical.startsWith(root.endsWith('/') ? root : root + '/'))
+        return QString();
+    return canonical;
+}
+
+int Server::exec()
+{
+    if(!localServer.isListening() && !tcpServer.isListening())
+    {
+        stdinReader = new StdinReader(this, [this](const QByteArray& line) {
+            request(line, nullptr);
+        }, [this]() {
+            quit();
+        });
+        stdinReader->start();
+        send((QIODevice*)nullptr, QJsonObject {{"event", "ready"}, {"pipelines", batch.pipelinesCount()}});
+    }
+
+    loop.exec();
+    return Success;
+}
+
+void Server::request(const QByteArray& line, QIODevice* socket)
+{
+    if(line.trimmed().isEmpty())
+        return;
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if(!document.isObject())
+    {
+        send(socket, QJsonObject {{"event", "error"}, {"message", "invalid JSON: " + parseError.errorString()}});
+        return;
+    }
+
+    QJsonObject object = document.object();
+    if(object.value("command").toString() == "quit")
+    {
+        quit();
+        return;
+    }
+
+    QJsonValue id = object.value("id");
+    QString input = object.value("input").toString();
+    if(input.isEmpty())
+    {
+        send(socket, QJsonObject {{"id", id}, {"event", "error"}, {"message", "no input"}});
+        return;
+    }
+    if(quitting)
+    {
+        send(socket, QJsonObject {{"id", id}, {"event", "error"}, {"message", "server is quitting"}});
+        return;
+    }
+
+    // The clients of the sockets may be remote ones, stdin is the user
+    QString output = object.value("output").toString();
+    if(socket)
+    {
+        auto path = inRoot(input, false);
+        if(path.isEmpty())
+        {
+            send(socket, QJsonObject {{"id", id}, {"event", "error"}, {"message", "input not found in the root directory of the server"}});
+            return;
+        }
+        input = path;
+        if(!output.isEmpty())
+        {
+            path = inRoot(output, true);
+            if(path.isEmpty())
+            {
+                send(socket, QJsonObject {{"id", id}, {"event", "error"}, {"message", "output not in the root directory of the server"}});
+                return;
+            }
+            output = path;
+        }
+    }
+
+    // Members not set keep the command line options
+    Batch::Options options = defaults;
+    if(object.contains("filters"))
+        options.filters = Batch::parseFilters(object.value("filters").toString().split('+'), options.filters);
+    if(object.contains("report"))
+        options.createMkv = object.value("report").toString() == "mkv";
+    options.forceOutput = object.value("force").toBool(options.forceOutput);
+    options.streamExport = object.value("stream").toBool(options.streamExport);
+    options.segments = object.value("segments").toInt(options.segments);
+    options.start = object.value("start").toDouble(options.start);
+    options.end = object.value("end").toDouble(options.end);
+    if(object.contains("priority"))
+    {
+        options.priority = Batch::priorityFromName(object.value("priority").toString());
+        if(options.priority < 0)
+        {
+            send(socket, QJsonObject {{"id", id}, {"event", "error"}, {"message", "unknown priority " + object.value("priority").toString()}});
+            return;
+        }
+    }
+
+    // Ids of the clients may be anything or collide, the batch uses its own keys
+    QString key = QString::number(++jobsCount);
+
+    // Report streamed to the client, named by the server so only what the job writes is sent
+    bool sendReport = object.value("send").toBool(false);
+    if(sendReport)
+    {
+        if(!reportsDir.isValid())
+        {
+            send(socket, QJsonObject {{"id", id}, {"event", "error"}, {"message", "no directory for the reports sent"}});
+            return;
+        }
+        options.createMkv = false;
+        options.streamExport = true;
+        options.forceOutput = false;
+        output = reportsDir.filePath(key + ".qctools.xml.gz");
+    }
+
+    clients[key] = client {socket, socket == nullptr, id, sendReport ? output : QString()};
+    send(key, QJsonObject {{"event", "queued"}});
+    batch.add(input, options, output, key);
+}
+
+void Server::send(QIODevice* socket, QJsonObject event)
+{
+    QByteArray line = QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n';
+    if(socket)
+    {
+        socket->write(line);
+        if(auto localSocket = qobject_cast<QLocalSocket*>(socket))
+            localSocket->flush();
+        else if(auto tcpSocket = qobject_cast<QTcpSocket*>(socket))
+            tcpSocket->flush();
+    }
+    else
+    {
+        std::cout << line.constData() << std::flush;
+    }
+}
+
+void Server::send(const QString& key, QJsonObject event)
+{
+    auto item = clients.find(key);
+    if(item == clients.end())
+        return;
+
+    // Client disconnected, the job continues but events are dropped
+    if(item->second.socket.isNull() && !item->second.isStdin)
+        return;
+
+    event.insert("id", item->second.id);
+    send(item->second.socket.data(), event);
+}
+
+void Server::sendReport(const QString& key, bool isLast)
+{
+    auto item = clients.find(key);
+    if(item == clients.end() || item->second.report.isEmpty())
+        return;
+    client& Client = item->second;
+    if(Client.socket.isNull() && !Client.isStdin)
+        return;
+
+    // Not more than the socket can take, the rest at the next poll; all of it at the end
+    if(!isLast && Client.socket && Client.socket->bytesToWrite() > Report_Pending_Max)
+        return;
+
+    QFile file(Client.report);
+    if(!file.open(QIODevice::ReadOnly) || !file.seek(Client.reportSent))
+        return;
+    for(;;)
+    {
+        QByteArray data = file.read(Report_Pending_Max);
+        if(data.isEmpty())
+            break;
+        send(key, QJsonObject {{"event", "report"}, {"bytes", data.size()}});
+        if(Client.socket)
+            Client.socket->write(data);
+        else
+            std::cout.write(data.constData(), data.size()) << std::flush;
+        Client.reportSent += data.size();
+        if(!isLast)
+            break;
+    }
+}
+
+void Server::quit()
+{
+    quitting = true;
+    localServer.close();
+    tcpServer.close();
+
+    if(clients.empty())
+        loop.quit();
+}
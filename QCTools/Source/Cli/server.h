@@ -0,0 +1,113 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef SERVER_H
+#define SERVER_H
+//---------------------------------------------------------------------------
+
+#include "batch.h"
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <map>
+
+//---------------------------------------------------------------------------
+// Long running qcli (--serve), the process and the FFmpeg/Qt initialization
+// are reused by all the jobs.
+//
+// One JSON object per line, from stdin or from the clients of a local socket
+// or of a TCP port (name "tcp:<port>" on localhost, or "tcp:<address>:<port>"
+// for workers of other hosts, see Coordinator).
+// With a token (needed for an address other than a loopback one), the first
+// line of a client of a socket must be {"token": "..."}, else the client gets
+// an error and is disconnected; "ready" is sent once the token is checked.
+// Input and output paths of the clients of a socket must be inside the root
+// directory (relative ones are relative to it), URLs must be http(s) ones.
+//   {"id": any, "input": "file.mkv", "output": "...", "filters": "signalstats+cropdetect",
+//    "report": "mkv" or "xml.gz", "force": bool, "stream": bool, "segments": count,
+//    "start": seconds, "end": seconds (range parsed, see FileInformation::setParsingRange),
+//    "priority": "low" | "normal" | "high" (see Batch), "send": bool (see below)}
+//   {"command": "quit"} (running and queued jobs are finished before quitting)
+// Only "input" is needed, the other members default to the command line options.
+// Events are sent back the same way, to the client which sent the job:
+//   {"event": "ready", "pipelines": count}
+//   {"id": any, "event": "queued" | "started" (+ "segments") | "paused" | "resumed" | "progress" (+ "percent")
+//    | "warning" (+ "message") | "finished" (+ "status", "message", "input", "output", "wait_seconds", "run_seconds")}
+//   {"id": any if known, "event": "error", "message": "..."} for invalid jobs
+// With "send", the report is an xml.gz written while analyzing, in a directory
+// of the server ("output" is ignored, the report is removed once sent), and its
+// bytes are sent to the client as they are written, for a GUI which reads it
+// remotely (see RemoteReport): events
+//   {"id": any, "event": "report", "bytes": count} followed by count bytes of
+// the file, the last ones before "finished". Nothing more is sent if the job
+// fails.
+class Server : public QObject
+{
+    Q_OBJECT
+public:
+    // Lookahead is the count of the next files opened ahead, see Batch::setLookahead
+    Server(const Batch::Options& defaults, int jobs, bool numa = false, int lookahead = 2);
+    ~Server();
+
+    // Shared secret of the clients of the sockets, empty for none; call before listen()
+    void setToken(const QString& token) { this->token = token; }
+    // Directory the paths of the clients of the sockets are limited to, the current one by default
+    bool setRoot(const QString& path);
+
+    // Jobs from the clients of the local socket or of the TCP port, else from stdin
+    bool listen(const QString& name);
+    const QString& errorString() const { return listenError; }
+
+    // Runs until a quit command (or the end of stdin) and the end of all jobs
+    int exec();
+
+    // Counters of the jobs, see Batch::metrics
+    QByteArray metrics() const { return batch.metrics(); }
+
+private:
+    struct client
+    {
+        QPointer<QIODevice>     socket;
+        bool                    isStdin;
+        QJsonValue              id;
+        QString                 report; // Sent to the client, empty if not
+        qint64                  reportSent {0};
+        bool                    reportStarted {false}; // Written by the job, not a report of a previous run
+    };
+
+    void accept(QIODevice* socket);
+    bool authorize(const QByteArray& line, QIODevice* socket);
+    QString inRoot(const QString& path, bool isOutput) const;
+    void request(const QByteArray& line, QIODevice* socket);
+    void send(QIODevice* socket, QJsonObject event);
+    void send(const QString& key, QJsonObject event);
+    void sendReport(const QString& key, bool isLast);
+    void quit();
+
+    Batch::Options              defaults;
+    Batch                       batch;
+    QLocalServer                localServer;
+    QTcpServer                  tcpServer;
+    QThread*                    stdinReader {nullptr};
+    QTimer                      reportTimer; // Reports followed while written
+    QTemporaryDir               reportsDir; // Reports sent, named by the server only
+    QEventLoop                  loop;
+    std::map<QString, client>   clients; // By job key
+    quint64                     jobsCount {0};
+    QString                     token;
+    QString                     root; // Canonical
+    QString                     listenError;
+    bool                        quitting {false};
+};
+
+#endif // SERVER_H
@@ -0,0 +1,104 @@
+#include "watch.h"
+#include "cli.h"
+#include "Core/GrowingFileDevice.h"
+#include <QDir>
+#include <QFileInfo>
+#include <iostream>
+
+Watch::Watch(const Batch::Options& options, int jobs, bool numa, int lookahead) : options(options), batch(jobs, numa)
+{
+    batch.setLookahead(lookahead);
+
+    connect(&batch, &Batch::started, this, [](const QString&, const QString& input, int segments) {
+        std::cout << "analyzing input file... " << input.toStdString() << " (" << segments << (segments > 1 ? " segments)" : " segment)") << std::endl;
+    });
+    connect(&batch, &Batch::warning, this, [](const QString& id, const QString& message) {
+        std::cout << id.toStdString() << ": " << message.toStdString() << std::endl;
+    });
+    connect(&batch, &Batch::finished, this, [this](const QString&, const QString& input, const QString& output, int error, const QString& message, qint64 waited, qint64 ran) {
+        std::cout << "[" << ++filesDone << "/" << filesCount << "] " << input.toStdString() << ": " << message.toStdString();
+        if(error == Success && !output.isEmpty())
+            std::cout << ", in " << output.toStdString();
+        std::cout << " (waited " << waited / 1000.0 << " s, ran " << ran / 1000.0 << " s)" << std::endl;
+    });
+
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, this, &Watch::scan);
+    connect(&timer, &QTimer::timeout, this, &Watch::scan);
+}
+
+bool Watch::watch(const QString& folder_)
+{
+    folder = QDir(folder_).absolutePath();
+    if(!QFileInfo(folder).isDir() || !watcher.addPath(folder))
+        return false;
+
+    // Changes of the files are not always seen by the watcher (network storage), they are also polled
+    timer.start(1000);
+    return true;
+}
+
+int Watch::exec()
+{
+    std::cout << "watching " << folder.toStdString() << ", " << batch.pipelinesCount() << " parsing pipelines";
+    if(GrowingFileDevice::Enabled_Get())
+        std::cout << ", files followed while written";
+    std::cout << "... " << std::endl;
+
+    // Files already there are candidates too
+    scan();
+    loop.exec();
+    return Success;
+}
+
+bool Watch::isMedia(const QString& name) const
+{
+    if(name.startsWith('.') || name.contains(".qctools."))
+        return false;
+    if(name.endsWith(".part") || name.endsWith(".tmp"))
+        return false;
+    auto sentinel = GrowingFileDevice::Sentinel_Get();
+    return sentinel.isEmpty() || !name.endsWith(sentinel);
+}
+
+void Watch::scan()
+{
+    const bool follow = GrowingFileDevice::Enabled_Get();
+    const int idle = GrowingFileDevice::Idle_Get();
+
+    QSet<QString> present;
+    for(const auto& info : QDir(folder).entryInfoList(QDir::Files | QDir::NoDotAndDotDot, QDir::Name))
+    {
+        auto path = info.absoluteFilePath();
+        if(started.contains(path) || !isMedia(info.fileName()))
+            continue;
+        present.insert(path);
+
+        auto& file = candidates[path];
+        if(file.size != info.size() || file.modified != info.lastModified())
+        {
+            file.size = info.size();
+            file.modified = info.lastModified();
+            file.stable.start();
+        }
+
+        // Written enough for probing when followed, else done
+        bool ready = follow ? file.size > 0 : GrowingFileDevice::IsDone(path) || file.stable.elapsed() >= idle;
+        if(!ready)
+            continue;
+
+        candidates.erase(path);
+        started.insert(path);
+        ++filesCount;
+        std::cout << "queued " << path.toStdString() << std::endl;
+        batch.add(path, options, QString(), path);
+    }
+
+    // Removed before being started
+    for(auto file = candidates.begin(); file != candidates.end();)
+    {
+        if(present.contains(file->first))
+            ++file;
+        else
+            file = candidates.erase(file);
+    }
+}
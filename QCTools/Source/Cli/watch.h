@@ -0,0 +1,66 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef WATCH_H
+#define WATCH_H
+//---------------------------------------------------------------------------
+
+#include "batch.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTimer>
+#include <map>
+
+//---------------------------------------------------------------------------
+// Long running qcli (--watch <folder>), the media files landing in the folder
+// are analyzed by a Batch as they come, their report is written next to them.
+//
+// A file is started once its writer is done: its sentinel exists (see
+// GrowingFileDevice::Sentinel_Set) or it did not grow for the idle time. With
+// --follow, it is started as soon as it is not empty and parsed while still
+// being written, its report is ready a few seconds after the end of the
+// recording. Reports, sentinels, hidden and partial files (.part, .tmp) are
+// not analyzed, nor the files of the folder already having a report (unless
+// forced, see Batch::Options). Each file is analyzed once per run.
+class Watch : public QObject
+{
+    Q_OBJECT
+public:
+    // Lookahead is the count of the next files opened ahead, see Batch::setLookahead
+    Watch(const Batch::Options& options, int jobs, bool numa = false, int lookahead = 2);
+
+    bool watch(const QString& folder);
+
+    // Runs until the process is stopped
+    int exec();
+
+private:
+    struct candidate
+    {
+        qint64                  size {-1};
+        QDateTime               modified;
+        QElapsedTimer           stable; // Since the size or the date last changed
+    };
+
+    void scan();
+    bool isMedia(const QString& name) const;
+
+    Batch::Options              options;
+    Batch                       batch;
+    QString                     folder;
+    QFileSystemWatcher          watcher;
+    QTimer                      timer; // Idle times checked without change in the folder
+    QEventLoop                  loop;
+    std::map<QString, candidate> candidates; // Not started yet, by path
+    QSet<QString>               started;
+    int                         filesCount {0};
+    int                         filesDone {0};
+};
+
+#endif // WATCH_H
@@ -0,0 +1,121 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/AnalysisProfiles.h"
+#include "Core/VideoCore.h"
+
+#include <iterator>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+const char* const Profile_Names[AnalysisProfiles::Profile_Max]=
+{
+    "full",
+    "luma-only",
+    "broadcast-legal",
+};
+
+const size_t LumaOnly_Items[]=
+{
+    Item_YMIN,
+    Item_YLOW,
+    Item_YAVG,
+    Item_YHIGH,
+    Item_YMAX,
+    Item_YDIF,
+    Item_TOUT,
+    Item_VREP,
+    Item_YBITS,
+};
+
+const size_t BroadcastLegal_Items[]=
+{
+    Item_YMIN,
+    Item_YLOW,
+    Item_YHIGH,
+    Item_YMAX,
+    Item_UMIN,
+    Item_UMAX,
+    Item_VMIN,
+    Item_VMAX,
+    Item_SATMAX,
+    Item_BRNG,
+};
+
+}
+
+//***************************************************************************
+// Names
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const char* AnalysisProfiles::Name(profile Profile)
+{
+    return Profile<Profile_Max?Profile_Names[Profile]:"";
+}
+
+//---------------------------------------------------------------------------
+AnalysisProfiles::profile AnalysisProfiles::FromName(const QString& Name)
+{
+    int Profile=0;
+    while (Profile<Profile_Max && Name!=QLatin1String(Profile_Names[Profile]))
+        Profile++;
+    return (profile)Profile;
+}
+
+//***************************************************************************
+// Columns
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+activefilters AnalysisProfiles::Filters(profile Profile)
+{
+    activefilters Result;
+    switch (Profile)
+    {
+        case Profile_LumaOnly       :
+                                    Result.set(ActiveFilter_Video_signalstats);
+                                    Result.set(ActiveFilter_Video_blockdetect);
+                                    Result.set(ActiveFilter_Video_blurdetect);
+                                    Result.set(ActiveFilter_Video_blackdetect);
+                                    break;
+        case Profile_BroadcastLegal :
+                                    Result.set(ActiveFilter_Video_signalstats);
+                                    Result.set(ActiveFilter_Audio_astats);
+                                    Result.set(ActiveFilter_Audio_EbuR128);
+                                    break;
+        default                     :
+                                    Result.set();
+    }
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+// Only signalstats has items not in a profile, the other filters are kept whole or not run
+std::vector<bool> AnalysisProfiles::Items(profile Profile, int Type)
+{
+    if (Type!=Type_Video)
+        return std::vector<bool>();
+
+    const size_t* Begin;
+    const size_t* End;
+    switch (Profile)
+    {
+        case Profile_LumaOnly       : Begin=std::begin(LumaOnly_Items); End=std::end(LumaOnly_Items); break;
+        case Profile_BroadcastLegal : Begin=std::begin(BroadcastLegal_Items); End=std::end(BroadcastLegal_Items); break;
+        default                     : return std::vector<bool>();
+    }
+
+    std::vector<bool> Result(Item_VideoMax);
+    for (size_t j=0; j<Item_VideoMax; j++)
+        Result[j]=VideoPerItem[j].Filter!=ActiveFilter_Video_signalstats;
+    for (auto Item=Begin; Item<End; Item++)
+        Result[*Item]=true;
+    return Result;
+}
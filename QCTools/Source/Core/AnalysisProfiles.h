@@ -0,0 +1,47 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef AnalysisProfiles_H
+#define AnalysisProfiles_H
+
+#include "Core/Core.h"
+
+#include <QString>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Named sets of the columns to analyze (see FileInformation::AnalysisProfile_Set):
+// the filters of the profile only are run, and the items of these filters
+// not in the profile are not stored (see CommonStats::Items_Restrict).
+// - full: the filters selected, all of their items
+// - luma-only: luma of signalstats, without its chroma pass (see
+//   SignalStatsKernel), and the luma detectors
+// - broadcast-legal: the levels of signalstats (extremes, saturation and
+//   BRNG), astats and ebur128
+class AnalysisProfiles
+{
+public:
+    enum profile
+    {
+        Profile_Full,
+        Profile_LumaOnly,
+        Profile_BroadcastLegal,
+        Profile_Max
+    };
+
+    // Name of the profile in the options of qcli and in the preferences ("luma-only"...)
+    static const char*          Name                        (profile Profile);
+    // Profile of a name, Profile_Max if unknown
+    static profile              FromName                    (const QString& Name);
+
+    // Filters the profile may run, the other ones are removed from the filters selected
+    static activefilters        Filters                     (profile Profile);
+    // Items of the stream type (Type_Video...) stored by the profile, empty if all of them
+    static std::vector<bool>    Items                       (profile Profile, int Type);
+};
+
+#endif // AnalysisProfiles_H
@@ -0,0 +1,80 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef AnalyzerPlugin_H
+#define AnalyzerPlugin_H
+
+#include "Core/Core.h"
+
+#include <QtAVPlayer/qavaudioframe.h>
+#include <QtAVPlayer/qavstream.h>
+#include <QtAVPlayer/qavvideoframe.h>
+#include <QtPlugin>
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Interface of the analyzer plugins: detectors of their own (logo presence,
+// caption safe areas, dropouts...) run on the frames of the stats in the
+// decode pass of the file, their values are kept as additional stats of the
+// stream (in the report and the database, as the metadata of the filters).
+//
+// A plugin is a Qt plugin (QObject with Q_PLUGIN_METADATA and
+// Q_INTERFACES(AnalyzerPlugin)) loaded by AnalyzerPlugins::Load(). It
+// declares its columns by stream type and creates one analyzer per stream
+// when parsing starts; the analyzer receives the frames of its stream in
+// order, after the stats filters, from the thread of the stream.
+
+//---------------------------------------------------------------------------
+// One value by frame, keys are unique among the plugins (e.g. "lavfi.logo.presence")
+struct AnalyzerColumn
+{
+    QString                     Key;
+    additional_type             Type;
+};
+
+//---------------------------------------------------------------------------
+// Values of one frame, keys not set are 0 (empty for strings)
+class AnalyzerValues
+{
+public:
+    virtual ~AnalyzerValues() {}
+
+    virtual void                Set                         (const char* Key, int64_t Value) = 0;
+    virtual void                Set                         (const char* Key, double Value) = 0;
+    virtual void                Set                         (const char* Key, const char* Value) = 0;
+};
+
+//---------------------------------------------------------------------------
+// Analyzer of one stream, not shared between threads
+class AnalyzerStream
+{
+public:
+    virtual ~AnalyzerStream() {}
+
+    virtual void                Video                       (const QAVVideoFrame& Frame, AnalyzerValues& Values) {Q_UNUSED(Frame); Q_UNUSED(Values);}
+    virtual void                Audio                       (const QAVAudioFrame& Frame, AnalyzerValues& Values) {Q_UNUSED(Frame); Q_UNUSED(Values);}
+};
+
+//---------------------------------------------------------------------------
+class AnalyzerPlugin
+{
+public:
+    virtual ~AnalyzerPlugin() {}
+
+    virtual QString             Name                        () const = 0;
+    // Columns for a stream of Type (Type_Video, Type_Audio), none if the plugin does not analyze it
+    virtual std::vector<AnalyzerColumn> Columns             (int Type) const = 0;
+    // Called for the streams with columns, nullptr if the stream is not analyzed after all
+    virtual AnalyzerStream*     Create                      (const QAVStream& Stream, int Type) = 0;
+};
+
+#define AnalyzerPlugin_IID "org.bavc.qctools.AnalyzerPlugin/1.0"
+Q_DECLARE_INTERFACE(AnalyzerPlugin, AnalyzerPlugin_IID)
+
+#endif // AnalyzerPlugin_H
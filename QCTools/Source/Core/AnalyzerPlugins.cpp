@@ -0,0 +1,168 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/AnalyzerPlugins.h"
+#include "Core/CommonStats.h"
+
+extern "C"
+{
+#include <libavutil/dict.h>
+#include <libavutil/frame.h>
+}
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QLibrary>
+#include <QPluginLoader>
+#include <cinttypes>
+#include <cstdio>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+std::vector<AnalyzerPlugin*>& Plugins()
+{
+    static std::vector<AnalyzerPlugin*> List;
+    return List;
+}
+
+//---------------------------------------------------------------------------
+bool Load_File(const QString& FileName)
+{
+    // Not deleted, the instance of the plugin stays loaded
+    auto Loader=new QPluginLoader(FileName);
+    auto Plugin=qobject_cast<AnalyzerPlugin*>(Loader->instance());
+    if (!Plugin)
+    {
+        qWarning() << "analyzer plugin:" << FileName << "not loaded," << (Loader->isLoaded()?QString("not an analyzer plugin"):Loader->errorString());
+        Loader->unload();
+        delete Loader;
+        return false;
+    }
+
+    Plugins().push_back(Plugin);
+    qDebug() << "analyzer plugin:" << Plugin->Name() << "loaded from" << FileName;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void Load_Environment()
+{
+    static bool IsLoaded=false;
+    if (IsLoaded)
+        return;
+    IsLoaded=true;
+
+    auto Paths=qEnvironmentVariable("QCTOOLS_ANALYZER_PLUGINS");
+    for (const auto& Path : Paths.split(QDir::listSeparator()))
+        if (!Path.isEmpty())
+            AnalyzerPlugins::Load(Path);
+}
+
+//---------------------------------------------------------------------------
+// Values in the metadata of the frame, as the ones of the filters
+class MetadataValues : public AnalyzerValues
+{
+public:
+    explicit MetadataValues(AVFrame* Frame_) : Frame(Frame_) {}
+
+    void Set(const char* Key, int64_t Value) override
+    {
+        char Buffer[32];
+        snprintf(Buffer, sizeof(Buffer), "%" PRId64, Value);
+        Set(Key, Buffer);
+    }
+
+    void Set(const char* Key, double Value) override
+    {
+        char Buffer[32];
+        snprintf(Buffer, sizeof(Buffer), "%.17g", Value);
+        Set(Key, Buffer);
+    }
+
+    void Set(const char* Key, const char* Value) override
+    {
+        if (Frame && Key && Value)
+            av_dict_set(&Frame->metadata, Key, Value, 0);
+    }
+
+private:
+    AVFrame*                    Frame;
+};
+
+}
+
+//***************************************************************************
+// Plugins
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int AnalyzerPlugins::Load(const QString& Path)
+{
+    Load_Environment();
+
+    QFileInfo Info(Path);
+    if (!Info.isDir())
+        return Load_File(Path)?1:0;
+
+    int Count=0;
+    QDir Dir(Path);
+    for (const auto& Name : Dir.entryList(QDir::Files, QDir::Name))
+        if (QLibrary::isLibrary(Name) && Load_File(Dir.filePath(Name)))
+            Count++;
+    return Count;
+}
+
+//---------------------------------------------------------------------------
+const std::vector<AnalyzerPlugin*>& AnalyzerPlugins::Get()
+{
+    Load_Environment();
+    return Plugins();
+}
+
+//***************************************************************************
+// Analyzers
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+AnalyzerPlugins::analyzers AnalyzerPlugins::Create(CommonStats* Stat, const QAVStream& Stream)
+{
+    analyzers Analyzers;
+    int Type=Stat->Type_Get();
+    for (auto Plugin : Get())
+    {
+        auto Columns=Plugin->Columns(Type);
+        if (Columns.empty())
+            continue;
+        std::unique_ptr<AnalyzerStream> Analyzer(Plugin->Create(Stream, Type));
+        if (!Analyzer)
+            continue;
+
+        for (const auto& Column : Columns)
+            Stat->AdditionalStats_Declare(Column.Key.toUtf8().constData(), Column.Type);
+        Analyzers.push_back(std::move(Analyzer));
+    }
+    return Analyzers;
+}
+
+//---------------------------------------------------------------------------
+void AnalyzerPlugins::Run(analyzers& Analyzers, const QAVVideoFrame& Frame)
+{
+    MetadataValues Values(Frame.frame());
+    for (auto& Analyzer : Analyzers)
+        Analyzer->Video(Frame, Values);
+}
+
+//---------------------------------------------------------------------------
+void AnalyzerPlugins::Run(analyzers& Analyzers, const QAVAudioFrame& Frame)
+{
+    MetadataValues Values(Frame.frame());
+    for (auto& Analyzer : Analyzers)
+        Analyzer->Audio(Frame, Values);
+}
@@ -0,0 +1,41 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef AnalyzerPlugins_H
+#define AnalyzerPlugins_H
+
+#include "Core/AnalyzerPlugin.h"
+
+#include <QString>
+#include <memory>
+#include <vector>
+
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Analyzer plugins of the process (see AnalyzerPlugin.h), loaded before the
+// files are parsed: from the paths of the QCTOOLS_ANALYZER_PLUGINS
+// environment variable (separated as PATH) on first use, then by Load().
+// Plugins stay loaded until the process ends.
+class AnalyzerPlugins
+{
+public:
+    typedef std::vector<std::unique_ptr<AnalyzerStream>> analyzers;
+
+    // Plugin file, or the plugin files of a directory; count of plugins loaded, the other files are reported
+    static int                  Load                        (const QString& Path);
+    static const std::vector<AnalyzerPlugin*>& Get          ();
+
+    // Analyzers of the plugins for the stream of Stat, their columns declared in Stat before the first frame
+    static analyzers            Create                      (CommonStats* Stat, const QAVStream& Stream);
+
+    // Values of the analyzers in the metadata of the frame, before the frame is given to CommonStats::StatsFromFrame
+    static void                 Run                         (analyzers& Analyzers, const QAVVideoFrame& Frame);
+    static void                 Run                         (analyzers& Analyzers, const QAVAudioFrame& Frame);
+};
+
+#endif // AnalyzerPlugins_H
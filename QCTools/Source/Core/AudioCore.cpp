@@ -82,6 +82,15 @@ struct per_group AudioPerGroup [Group_AudioMax]=
         "audio frame and not per audio sample.",
         ActiveFilter_Audio_astats,
     },
+    //silence
+    {
+        Item_silence,               1,    "0",  nullptr,  3,  "Audio Silence",  false,
+        "For selected audio tracks this graph plots the duration in seconds of\n"
+        "the silence (silencedetect, all the channels below -60 dB) up to each\n"
+        "audio frame, 0 out of the silences. A silence is detected once it lasts\n"
+        "for 2 seconds, its duration starts from the first silent sample.",
+        ActiveFilter_Audio_silencedetect,
+    },
     //LRA
     //{
     //    Item_LRAL,       3,    0,    0,  3,  "LRA",  true,
@@ -109,6 +118,7 @@ const struct per_item AudioPerItem [Item_AudioMax]=
     { Group_astats_RMS,   Group_AudioMax, "Peak Level",                 "lavfi.astats.Overall.Peak_level",      6,   false,  DBL_MAX, DBL_MAX, ActiveFilter_Audio_astats, nullptr, -1  },
     { Group_astats_RMS,   Group_AudioMax, "RMS Peak",                   "lavfi.astats.Overall.RMS_peak",        6,   false,  DBL_MAX, DBL_MAX, ActiveFilter_Audio_astats, nullptr, -1  },
     { Group_astats_RMS,   Group_AudioMax, "RMS Trough",                 "lavfi.astats.Overall.RMS_trough",      6,   false,  DBL_MAX, DBL_MAX, ActiveFilter_Audio_astats, nullptr, -1  },
+    { Group_silence,      Group_AudioMax, "Silence Duration",           "qctools.silence_duration",             3,   false,  DBL_MAX, DBL_MAX, ActiveFilter_Audio_silencedetect, nullptr, -1  },
     //{ Group_R128,   Group_AudioMax,       "R128.S",         "lavfi.r128.S",             0,   false,  DBL_MAX, DBL_MAX },
     //{ Group_R128,   Group_AudioMax,       "R128.I",         "lavfi.r128.I",             0,   true,   DBL_MAX, DBL_MAX },
     //U
@@ -116,3 +126,10 @@ const struct per_item AudioPerItem [Item_AudioMax]=
     //{ Group_LRA,    Group_AudioMax,       "LRA",            "lavfi.r128.LRA",           0,   false,  DBL_MAX, DBL_MAX },
     //{ Group_LRA,    Group_AudioMax,       "LRAH",           "lavfi.r128.LRA.high",      0,   true,   DBL_MAX, DBL_MAX },
 };
+
+//---------------------------------------------------------------------------
+// Metadata of the active filters not in AudioPerItem, all are discovered during the parsing for the moment
+const struct additional_item AudioAdditionalItems [] =
+{
+    { nullptr,                                  Additional_Int,     (activefilter)-1 },
+};
@@ -39,6 +39,8 @@ enum AudioItem
     Item_Peak_level,
     Item_RMS_peak,
     Item_RMS_trough,
+    //silence events
+    Item_silence,
     //Internal
     Item_AudioMax
 };
@@ -53,11 +55,13 @@ enum AudioGroup
     Group_astats_zeros,
     Group_adif,
     Group_astats_RMS,
+    Group_silence,
     //Group_LRA,
     Group_AudioMax
 };
 
 extern struct per_group  AudioPerGroup    [Group_AudioMax];
 extern const struct per_item   AudioPerItem     [Item_AudioMax];
+extern const struct additional_item AudioAdditionalItems[];
 
 #endif // Core_H
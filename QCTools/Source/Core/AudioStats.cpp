@@ -7,6 +7,8 @@
 //---------------------------------------------------------------------------
 #include "Core/AudioStats.h"
 #include "Core/AudioCore.h"
+#include "Core/AudioStatsKernel.h"
+#include "Core/StatsNumbers.h"
 //---------------------------------------------------------------------------
 
 //---------------------------------------------------------------------------
@@ -17,14 +19,15 @@ extern "C"
 }
 #include <qavplayer.h>
 
-#include "tinyxml2.h"
+#include "Core/StatsXmlReader.h"
+#include "Core/StatsXmlWriter.h"
 #include <sstream>
 #include <iomanip>
 #include <cstdlib>
 #include <cfloat>
+#include <cstdio>
+#include <cstring>
 
-#include <tinyxml2.h>
-using namespace tinyxml2;
 //---------------------------------------------------------------------------
 
 //***************************************************************************
@@ -32,7 +35,7 @@ using namespace tinyxml2;
 //***************************************************************************
 
 //---------------------------------------------------------------------------
-AudioStats::AudioStats (size_t FrameCount, double Duration, QAVStream* stream)
+AudioStats::AudioStats (uint64_t FrameCount, double Duration, QAVStream* stream)
     :
     CommonStats(AudioPerItem, Type_Audio, Group_AudioMax, Item_AudioMax, FrameCount, Duration, stream)
 {
@@ -48,9 +51,9 @@ AudioStats::~AudioStats()
 {
 }
 
-void AudioStats::parseFrame(tinyxml2::XMLElement *Frame)
+void AudioStats::parseFrame(const StatsXmlFrame& Frame)
 {
-    bool statsMapInitialized = !statsValueInfoByKeys.empty();
+    bool statsMapInitialized = !statsValueInfoByKeys.Empty();
 
     if (x_Current >= Data_Reserved)
         Data_Reserve(x_Current);
@@ -59,32 +62,32 @@ void AudioStats::parseFrame(tinyxml2::XMLElement *Frame)
 
     x[0][x_Current]=x_Current;
 
-    Attribute=Frame->Attribute("pkt_duration_time");
+    Attribute=Frame.Attribute("pkt_duration_time");
     if (Attribute)
-        durations[x_Current]=std::atof(Attribute);
+        durations[x_Current]=Number_ToDouble(Attribute);
 
-    Attribute=Frame->Attribute("key_frame");
+    Attribute=Frame.Attribute("key_frame");
     if (Attribute)
-        key_frames[x_Current]=std::atof(Attribute)?true:false;
+        key_frames.Set(x_Current, Number_ToDouble(Attribute)?true:false);
 
-    Attribute = Frame->Attribute("pkt_pos");
+    Attribute = Frame.Attribute("pkt_pos");
     if(Attribute)
-        pkt_pos[x_Current] = std::atoll(Attribute);
+        pkt_pos[x_Current] = Number_ToInt64(Attribute);
 
-    Attribute = Frame->Attribute("pkt_size");
+    Attribute = Frame.Attribute("pkt_size");
     if (Attribute)
-        pkt_size[x_Current] = std::atoi(Attribute);
+        pkt_size[x_Current] = Number_ToInt(Attribute);
 
-    Attribute = Frame->Attribute("pkt_pts");
+    Attribute = Frame.Attribute("pkt_pts");
     if (Attribute)
-        pkt_pts[x_Current] = std::atoi(Attribute);
+        pkt_pts[x_Current] = Number_ToInt(Attribute);
 
-    Attribute=Frame->Attribute("pkt_pts_time");
+    Attribute=Frame.Attribute("pkt_pts_time");
     if (!Attribute || !strcmp(Attribute, "N/A"))
-        Attribute=Frame->Attribute("pkt_dts_time");
+        Attribute=Frame.Attribute("pkt_dts_time");
     if (Attribute && strcmp(Attribute, "N/A"))
     {
-        x[1][x_Current]=std::atof(Attribute);
+        x[1][x_Current]=Number_ToDouble(Attribute);
         if (FirstTimeStamp==DBL_MAX)
             FirstTimeStamp=x[1][x_Current];
         if (x[1][x_Current]<FirstTimeStamp)
@@ -102,58 +105,48 @@ void AudioStats::parseFrame(tinyxml2::XMLElement *Frame)
         x[3][x_Current]=x[2][x_Current]/60;
     }
 
-    auto Tag=Frame->FirstChildElement();
-    while (Tag)
+    for (const auto& Tag : Frame.tags)
     {
-        if (!strcmp(Tag->Value(), "tag"))
+        const char* key=Tag.first;
+        size_t j=ItemsIndex.Find(key, Item_AudioMax);
+
+        if (j!=Item_AudioMax)
         {
-            size_t j=Item_AudioMax;
-            const char* key=Tag->Attribute("key");
-            if (key)
-                for (size_t Plot_Pos=0; Plot_Pos<Item_AudioMax; Plot_Pos++)
-                    if (!strcmp(key, PerItem[Plot_Pos].FFmpeg_Name))
-                    {
-                        j=Plot_Pos;
-                        break;
-                    }
-
-            if (j!=Item_AudioMax)
+            if (PerItem[j].Filter!=activefilter(-1))
+                ReportFilters.set(PerItem[j].Filter);
+
+            double value;
+            Attribute=Tag.second;
+            if (Attribute)
+                value=Number_ToDouble(Attribute);
+            else
+                value=0;
+            y[j][x_Current]=value;
+
+            if (!std::isinf(value)) {
+                if (PerItem[j].Group1 != Group_AudioMax && y_Max[PerItem[j].Group1] < y[j][x_Current])
+                    y_Max[PerItem[j].Group1] = y[j][x_Current];
+                if (PerItem[j].Group2 != Group_AudioMax && y_Max[PerItem[j].Group2] < y[j][x_Current])
+                    y_Max[PerItem[j].Group2] = y[j][x_Current];
+                if (PerItem[j].Group1 != Group_AudioMax && y_Min[PerItem[j].Group1] > y[j][x_Current])
+                    y_Min[PerItem[j].Group1] = y[j][x_Current];
+                if (PerItem[j].Group2 != Group_AudioMax && y_Min[PerItem[j].Group2] > y[j][x_Current])
+                    y_Min[PerItem[j].Group2] = y[j][x_Current];
+            }
+
+            //AudioStats
+            Stats_Totals[j]+=y[j][x_Current];
+            if (PerItem[j].DefaultLimit!=DBL_MAX)
             {
-                double value;
-                Attribute=Tag->Attribute("value");
-                if (Attribute)
-                    value=std::atof(Attribute);
-                else
-                    value=0;
-                y[j][x_Current]=value;
-
-                if (!std::isinf(value)) {
-                    if (PerItem[j].Group1 != Group_AudioMax && y_Max[PerItem[j].Group1] < y[j][x_Current])
-                        y_Max[PerItem[j].Group1] = y[j][x_Current];
-                    if (PerItem[j].Group2 != Group_AudioMax && y_Max[PerItem[j].Group2] < y[j][x_Current])
-                        y_Max[PerItem[j].Group2] = y[j][x_Current];
-                    if (PerItem[j].Group1 != Group_AudioMax && y_Min[PerItem[j].Group1] > y[j][x_Current])
-                        y_Min[PerItem[j].Group1] = y[j][x_Current];
-                    if (PerItem[j].Group2 != Group_AudioMax && y_Min[PerItem[j].Group2] > y[j][x_Current])
-                        y_Min[PerItem[j].Group2] = y[j][x_Current];
-                }
-
-                //AudioStats
-                Stats_Totals[j]+=y[j][x_Current];
-                if (PerItem[j].DefaultLimit!=DBL_MAX)
-                {
-                    if (y[j][x_Current]>PerItem[j].DefaultLimit)
-                        Stats_Counts[j]++;
-                    if (PerItem[j].DefaultLimit2!=DBL_MAX && y[j][x_Current]>PerItem[j].DefaultLimit2)
-                        Stats_Counts2[j]++;
-                }
-            } else {
-                auto value = Tag->Attribute("value");
-                processAdditionalStats(key, value ? value : "", statsMapInitialized);
+                if (y[j][x_Current]>PerItem[j].DefaultLimit)
+                    Stats_Counts[j]++;
+                if (PerItem[j].DefaultLimit2!=DBL_MAX && y[j][x_Current]>PerItem[j].DefaultLimit2)
+                    Stats_Counts2[j]++;
             }
+        } else if (key) {
+            auto value = Tag.second;
+            processAdditionalStats(key, value ? value : "", statsMapInitialized);
         }
-
-        Tag=Tag->NextSiblingElement();
     }
 
     if(!statsMapInitialized) {
@@ -170,6 +163,7 @@ void AudioStats::parseFrame(tinyxml2::XMLElement *Frame)
     }
 
     x_Current++;
+    x_Current_Publish();
     if (x_Current_Max<=x_Current)
         x_Current_Max=x_Current;
 }
@@ -178,51 +172,94 @@ void AudioStats::parseFrame(tinyxml2::XMLElement *Frame)
 // External data
 //***************************************************************************
 
+//---------------------------------------------------------------------------
+void AudioStats::StatsFromItem (size_t j, double value)
+{
+    y[j][x_Current]=value;
+
+    if (!std::isinf(value)) {
+        if (PerItem[j].Group1 != Group_AudioMax && y_Max[PerItem[j].Group1] < y[j][x_Current])
+            y_Max[PerItem[j].Group1] = y[j][x_Current];
+        if (PerItem[j].Group2 != Group_AudioMax && y_Max[PerItem[j].Group2] < y[j][x_Current])
+            y_Max[PerItem[j].Group2] = y[j][x_Current];
+        if (PerItem[j].Group1 != Group_AudioMax && y_Min[PerItem[j].Group1] > y[j][x_Current])
+            y_Min[PerItem[j].Group1] = y[j][x_Current];
+        if (PerItem[j].Group2 != Group_AudioMax && y_Min[PerItem[j].Group2] > y[j][x_Current])
+            y_Min[PerItem[j].Group2] = y[j][x_Current];
+    }
+
+    //Stats
+    Stats_Totals[j]+=y[j][x_Current];
+    if (PerItem[j].DefaultLimit!=DBL_MAX)
+    {
+        if (y[j][x_Current]>PerItem[j].DefaultLimit)
+            Stats_Counts[j]++;
+        if (PerItem[j].DefaultLimit2!=DBL_MAX && y[j][x_Current]>PerItem[j].DefaultLimit2)
+            Stats_Counts2[j]++;
+    }
+}
+
+//---------------------------------------------------------------------------
+void AudioStats::KernelValues (const AudioStatsKernel& Kernel, kernel_values& Values)
+{
+    // Item of each value of the kernel
+    static const std::vector<size_t> Items=[]() {
+        std::vector<size_t> Result(AudioStatsKernel::Value_Max, Item_AudioMax);
+        for (size_t Value=0; Value<Result.size(); Value++)
+            for (size_t j=0; j<Item_AudioMax; j++)
+                if (!strcmp(AudioPerItem[j].FFmpeg_Name, AudioStatsKernel::Name((AudioStatsKernel::value)Value)))
+                    Result[Value]=j;
+        return Result;
+    }();
+
+    for (size_t Value=0; Value<Items.size(); Value++)
+    {
+        if (Items[Value]>=Item_AudioMax || !Kernel.Has((AudioStatsKernel::value)Value))
+            continue;
+
+        // Rounded as in the metadata of the filters
+        char Text[32];
+        snprintf(Text, sizeof(Text), "%f", Kernel.Get((AudioStatsKernel::value)Value));
+        Values.emplace_back(Items[Value], std::atof(Text));
+    }
+}
+
+//---------------------------------------------------------------------------
+void AudioStats::StatsFromKernel (const AudioStatsKernel& Kernel)
+{
+    kernel_values Values;
+    KernelValues(Kernel, Values);
+    StatsFromKernel(Values);
+}
+
+//---------------------------------------------------------------------------
+void AudioStats::StatsFromKernel (const kernel_values& Values)
+{
+    for (const auto& Value : Values)
+        StatsFromItem(Value.first, Value.second);
+}
+
 //---------------------------------------------------------------------------
 void AudioStats::StatsFromFrame (const QAVFrame& frame, int, int)
 {
     auto Frame = frame.frame();
     AVDictionary * m= Frame->metadata;
     AVDictionaryEntry* e=NULL;
-    bool statsMapInitialized = !statsValueInfoByKeys.empty();
+    bool statsMapInitialized = !statsValueInfoByKeys.Empty();
 
     for (;;)
     {
         e=av_dict_get     (m, "", e, AV_DICT_IGNORE_SUFFIX);
         if (!e)
             break;
-        size_t j=0;
-        for (; j<Item_AudioMax; j++)
-        {
-            if (strcmp(e->key, PerItem[j].FFmpeg_Name)==0)
-                break;
-        }
+        if (Silence.IsKey(e->key) || !strcmp(e->key, "lavfi.silence_duration"))
+            continue; // See below
+
+        size_t j=ItemsIndex.Find(e->key, Item_AudioMax);
 
         if (j<Item_AudioMax)
         {
-            double value = std::atof(e->value);
-            y[j][x_Current]=value;
-
-            if (!std::isinf(value)) {
-                if (PerItem[j].Group1 != Group_AudioMax && y_Max[PerItem[j].Group1] < y[j][x_Current])
-                    y_Max[PerItem[j].Group1] = y[j][x_Current];
-                if (PerItem[j].Group2 != Group_AudioMax && y_Max[PerItem[j].Group2] < y[j][x_Current])
-                    y_Max[PerItem[j].Group2] = y[j][x_Current];
-                if (PerItem[j].Group1 != Group_AudioMax && y_Min[PerItem[j].Group1] > y[j][x_Current])
-                    y_Min[PerItem[j].Group1] = y[j][x_Current];
-                if (PerItem[j].Group2 != Group_AudioMax && y_Min[PerItem[j].Group2] > y[j][x_Current])
-                    y_Min[PerItem[j].Group2] = y[j][x_Current];
-            }
-
-            //Stats
-            Stats_Totals[j]+=y[j][x_Current];
-            if (PerItem[j].DefaultLimit!=DBL_MAX)
-            {
-                if (y[j][x_Current]>PerItem[j].DefaultLimit)
-                    Stats_Counts[j]++;
-                if (PerItem[j].DefaultLimit2!=DBL_MAX && y[j][x_Current]>PerItem[j].DefaultLimit2)
-                    Stats_Counts2[j]++;
-            }
+            StatsFromItem(j, Number_ToDouble(e->value));
         } else {
 
             // not found among plot groups
@@ -237,7 +274,10 @@ void AudioStats::StatsFromFrame (const QAVFrame& frame, int, int)
         initializeAdditionalStats();
     }
 
-    key_frames[x_Current]=Frame->key_frame?true:false;
+    // Events, as a value per frame
+    StatsFromItem(Item_silence, Silence.FromFrame(m, x[1][x_Current]+FirstTimeStamp, durations[x_Current]));
+
+    key_frames.Set(x_Current, Frame->key_frame?true:false);
 
     pkt_pos[x_Current] = Frame->pkt_pos;
     pkt_size[x_Current] = Frame->pkt_size;
@@ -250,7 +290,9 @@ void AudioStats::StatsFromFrame (const QAVFrame& frame, int, int)
         x_Max[2]=x[2][x_Current];
         x_Max[3]=x[3][x_Current];
     }
+    Detectors_Run();
     x_Current++;
+    x_Current_Publish();
     if (x_Current_Max<=x_Current)
         x_Current_Max=x_Current;
 }
@@ -302,49 +344,31 @@ void AudioStats::TimeStampFromFrame (const QAVFrame& frame, size_t FramePos)
 
 //---------------------------------------------------------------------------
 
-std::string AudioStats::StatsToXML (const activefilters& filters)
+void AudioStats::StatsToXML (StatsXmlWriter& Writer, const activefilters& filters, size_t x_Begin, size_t x_End)
 {
-    std::stringstream Data;
+    Items_Load();
+
+    // Columns written, once
+    auto Columns=XmlColumns(filters);
+    auto AdditionalColumns=XmlAdditionalColumns();
 
     // Per frame (note: the XML header and footer are not created here)
-    for (size_t x_Pos=0; x_Pos<x_Current; ++x_Pos)
+    for (size_t x_Pos=x_Begin; x_Pos<x_End; ++x_Pos)
     {
-        std::stringstream pkt_pts_time; pkt_pts_time<<std::fixed<<std::setprecision(7)<<(x[1][x_Pos]+FirstTimeStamp);
-        std::stringstream pkt_duration_time; pkt_duration_time<<std::fixed<<std::setprecision(7)<<durations[x_Pos];
-        std::stringstream key_frame; key_frame<< (key_frames[x_Pos]? '1' : '0');
+        Writer.FrameBegin("audio", streamIndex);
+        Writer.Attribute("key_frame", key_frames[x_Pos]?"1":"0");
+        Writer.Attribute("pkt_pts", pkt_pts[x_Pos]);
+        Writer.AttributeFixed("pkt_pts_time", x[1][x_Pos]+FirstTimeStamp, 7);
+        Writer.AttributeFixed("pkt_duration_time", durations[x_Pos], 7);
+        Writer.Attribute("pkt_pos", pkt_pos[x_Pos]);
+        Writer.Attribute("pkt_size", (int64_t)pkt_size[x_Pos]);
+        Writer.FrameAttributesEnd();
 
-        Data<<"        <frame media_type=\"audio\"";
-        Data << " stream_index=\"" << streamIndex << "\"";
+        for (const auto& Column : Columns)
+            Writer.Tag(Column.Prefix, (double)y[Column.Index][x_Pos]);
 
-        Data<<" key_frame=\"" << key_frame.str() << "\"";
-        Data << " pkt_pts=\"" << pkt_pts[x_Pos] << "\"";
-        Data<<" pkt_pts_time=\"" << pkt_pts_time.str() << "\"";
-        if (pkt_duration_time)
-            Data<<" pkt_duration_time=\"" << pkt_duration_time.str() << "\"";
-        Data << " pkt_pos=\"" << pkt_pos[x_Pos] << "\"";
-        Data << " pkt_size=\"" << pkt_size[x_Pos] << "\"";
+        writeAdditionalStats(Writer, AdditionalColumns, x_Pos);
 
-        Data << ">\n";
-
-        for (size_t Plot_Pos=0; Plot_Pos<Item_AudioMax; Plot_Pos++)
-        {
-            const activefilter filter = PerItem[Plot_Pos].Filter;
-            if(filter == activefilter(-1))
-                continue;
-
-            if(!filters.test(filter))
-                continue;
-
-            const std::string& key = PerItem[Plot_Pos].FFmpeg_Name;
-            auto value = std::to_string(y[Plot_Pos][x_Pos]);
-
-            Data<<"            <tag key=\""+key+"\" value=\""+value+"\"/>\n";
-        }
-
-        writeAdditionalStats(Data, x_Pos);
-
-        Data<<"        </frame>\n";
+        Writer.FrameEnd();
     }
-
-    return Data.str();
 }
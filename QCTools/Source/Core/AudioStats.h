@@ -17,24 +17,33 @@
 
 struct AVFrame;
 class QAVStream;
+class AudioStatsKernel;
 
-namespace tinyxml2 {
-    class XMLElement;
-}
+struct StatsXmlFrame;
 
 class AudioStats : public CommonStats
 {
 public:
     // Constructor / Destructor
-    AudioStats(size_t FrameCount=0, double Duration=0, QAVStream* stream = NULL);
+    AudioStats(uint64_t FrameCount=0, double Duration=0, QAVStream* stream = NULL);
     AudioStats(int streamIndex);
     ~AudioStats();
 
     // External data
-    virtual void parseFrame(tinyxml2::XMLElement* frame);
+    virtual void parseFrame(const StatsXmlFrame& frame);
     void                        StatsFromFrame(const QAVFrame& Frame, int Width, int Height);
+    // Values of the kernel for the current frame (not in the metadata), before StatsFromFrame()
+    void                        StatsFromKernel(const AudioStatsKernel& Kernel);
+    void                        StatsFromKernel(const kernel_values& Values);
+    // Values of the kernel appended to Values, for a StatsFromKernel() by another thread (see StatsIngest)
+    static void                 KernelValues(const AudioStatsKernel& Kernel, kernel_values& Values);
     void                        TimeStampFromFrame(const QAVFrame& Frame, size_t FramePos);
-    std::string                      StatsToXML(const activefilters& filters);
+    void                             StatsToXML(StatsXmlWriter& Writer, const activefilters& filters, size_t x_Begin, size_t x_End);
+
+private:
+    void                        StatsFromItem(size_t j, double value);
+
+    StatsEvent                  Silence{"lavfi.silence_start", "lavfi.silence_end"};
 };
 
 #endif // Stats_H
@@ -0,0 +1,483 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/AudioStatsKernel.h"
+#include "Core/CpuFeatures.h"
+
+extern "C"
+{
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+#include <libavutil/version.h>
+}
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define AUDIOSTATS_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #define AUDIOSTATS_AVX2
+    #else
+        #define AUDIOSTATS_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define AUDIOSTATS_NEON
+    #include <arm_neon.h>
+#endif
+
+//---------------------------------------------------------------------------
+static const char* const Names[AudioStatsKernel::Value_Max]=
+{
+    "lavfi.r128.M",
+    "lavfi.aphasemeter.phase",
+    "lavfi.astats.Overall.DC_offset",
+    "lavfi.astats.Overall.Min_level",
+    "lavfi.astats.Overall.Max_level",
+    "lavfi.astats.2.Min_level",
+    "lavfi.astats.2.Max_level",
+    "lavfi.astats.1.Min_level",
+    "lavfi.astats.1.Max_level",
+    "lavfi.astats.2.Zero_crossings_rate",
+    "lavfi.astats.1.Zero_crossings_rate",
+    "lavfi.astats.Overall.Min_difference",
+    "lavfi.astats.Overall.Max_difference",
+    "lavfi.astats.Overall.Mean_difference",
+    "lavfi.astats.Overall.Peak_level",
+    "lavfi.astats.Overall.RMS_peak",
+    "lavfi.astats.Overall.RMS_trough",
+};
+
+static const double Pi=3.14159265358979323846;
+
+//***************************************************************************
+// Levels and differences
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+struct levels
+{
+    float                       Min {FLT_MAX};
+    float                       Max {-FLT_MAX};
+    double                      Sum {0};
+    float                       DiffMin {FLT_MAX};
+    float                       DiffMax {0};
+    double                      DiffSum {0};
+};
+
+//---------------------------------------------------------------------------
+// Samples From to Count-1, with the differences of each sample and the next one
+static void Levels_C(const float* x, int From, int Count, levels& Levels)
+{
+    for (int i=From; i<Count; i++)
+    {
+        Levels.Min=std::min(Levels.Min, x[i]);
+        Levels.Max=std::max(Levels.Max, x[i]);
+        Levels.Sum+=x[i];
+        if (i+1<Count)
+        {
+            float Diff=std::fabs(x[i+1]-x[i]);
+            Levels.DiffMin=std::min(Levels.DiffMin, Diff);
+            Levels.DiffMax=std::max(Levels.DiffMax, Diff);
+            Levels.DiffSum+=Diff;
+        }
+    }
+}
+
+#if defined(AUDIOSTATS_X86)
+//---------------------------------------------------------------------------
+static AUDIOSTATS_AVX2 void Levels_AVX2(const float* x, int Count, levels& Levels)
+{
+    if (Count<9)
+        return Levels_C(x, 0, Count, Levels);
+
+    const __m256 AbsMask=_mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 Min=_mm256_set1_ps(FLT_MAX), Max=_mm256_set1_ps(-FLT_MAX);
+    __m256 DiffMin=_mm256_set1_ps(FLT_MAX), DiffMax=_mm256_setzero_ps();
+    __m256d Sum=_mm256_setzero_pd(), DiffSum=_mm256_setzero_pd();
+    int i=0;
+    for (; i+9<=Count; i+=8)
+    {
+        __m256 a=_mm256_loadu_ps(x+i);
+        __m256 Diff=_mm256_and_ps(_mm256_sub_ps(_mm256_loadu_ps(x+i+1), a), AbsMask);
+        Min=_mm256_min_ps(Min, a);
+        Max=_mm256_max_ps(Max, a);
+        Sum=_mm256_add_pd(Sum, _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a)), _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1))));
+        DiffMin=_mm256_min_ps(DiffMin, Diff);
+        DiffMax=_mm256_max_ps(DiffMax, Diff);
+        DiffSum=_mm256_add_pd(DiffSum, _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(Diff)), _mm256_cvtps_pd(_mm256_extractf128_ps(Diff, 1))));
+    }
+
+    alignas(32) float Lanes[4][8];
+    alignas(32) double Sums[2][4];
+    _mm256_store_ps(Lanes[0], Min);
+    _mm256_store_ps(Lanes[1], Max);
+    _mm256_store_ps(Lanes[2], DiffMin);
+    _mm256_store_ps(Lanes[3], DiffMax);
+    _mm256_store_pd(Sums[0], Sum);
+    _mm256_store_pd(Sums[1], DiffSum);
+    for (int Lane=0; Lane<8; Lane++)
+    {
+        Levels.Min=std::min(Levels.Min, Lanes[0][Lane]);
+        Levels.Max=std::max(Levels.Max, Lanes[1][Lane]);
+        Levels.DiffMin=std::min(Levels.DiffMin, Lanes[2][Lane]);
+        Levels.DiffMax=std::max(Levels.DiffMax, Lanes[3][Lane]);
+    }
+    for (int Lane=0; Lane<4; Lane++)
+    {
+        Levels.Sum+=Sums[0][Lane];
+        Levels.DiffSum+=Sums[1][Lane];
+    }
+
+    Levels_C(x, i, Count, Levels);
+}
+
+//---------------------------------------------------------------------------
+static bool HasAvx2()
+{
+    return CpuFeatures::Uses(CpuFeatures::Level_AVX2);
+}
+#endif // AUDIOSTATS_X86
+
+#if defined(AUDIOSTATS_NEON)
+//---------------------------------------------------------------------------
+static void Levels_NEON(const float* x, int Count, levels& Levels)
+{
+    if (Count<5)
+        return Levels_C(x, 0, Count, Levels);
+
+    float32x4_t Min=vdupq_n_f32(FLT_MAX), Max=vdupq_n_f32(-FLT_MAX);
+    float32x4_t DiffMin=vdupq_n_f32(FLT_MAX), DiffMax=vdupq_n_f32(0);
+    float64x2_t Sum=vdupq_n_f64(0), DiffSum=vdupq_n_f64(0);
+    int i=0;
+    for (; i+5<=Count; i+=4)
+    {
+        float32x4_t a=vld1q_f32(x+i);
+        float32x4_t Diff=vabdq_f32(vld1q_f32(x+i+1), a);
+        Min=vminq_f32(Min, a);
+        Max=vmaxq_f32(Max, a);
+        Sum=vaddq_f64(Sum, vaddq_f64(vcvt_f64_f32(vget_low_f32(a)), vcvt_high_f64_f32(a)));
+        DiffMin=vminq_f32(DiffMin, Diff);
+        DiffMax=vmaxq_f32(DiffMax, Diff);
+        DiffSum=vaddq_f64(DiffSum, vaddq_f64(vcvt_f64_f32(vget_low_f32(Diff)), vcvt_high_f64_f32(Diff)));
+    }
+
+    Levels.Min=std::min(Levels.Min, vminvq_f32(Min));
+    Levels.Max=std::max(Levels.Max, vmaxvq_f32(Max));
+    Levels.Sum+=vaddvq_f64(Sum);
+    Levels.DiffMin=std::min(Levels.DiffMin, vminvq_f32(DiffMin));
+    Levels.DiffMax=std::max(Levels.DiffMax, vmaxvq_f32(DiffMax));
+    Levels.DiffSum+=vaddvq_f64(DiffSum);
+
+    Levels_C(x, i, Count, Levels);
+}
+#endif // AUDIOSTATS_NEON
+
+//---------------------------------------------------------------------------
+static inline void Levels_Compute(const float* x, int Count, levels& Levels)
+{
+#if defined(AUDIOSTATS_X86)
+    if (HasAvx2())
+        return Levels_AVX2(x, Count, Levels);
+#elif defined(AUDIOSTATS_NEON)
+    if (CpuFeatures::Uses(CpuFeatures::Level_NEON))
+        return Levels_NEON(x, Count, Levels);
+#endif
+    Levels_C(x, 0, Count, Levels);
+}
+
+//---------------------------------------------------------------------------
+static inline double LinearToDb(double Value)
+{
+    return 20*log10(Value);
+}
+
+//***************************************************************************
+// Kernel
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+AudioStatsKernel::AudioStatsKernel(bool Levels, bool Phase, bool Loudness, double Window) :
+    Levels(Levels),
+    Phase(Phase),
+    Loudness(Loudness),
+    Window(Window>0?Window:0.4)
+{
+    std::fill(std::begin(Values), std::end(Values), 0.0);
+    std::fill(std::begin(Valid), std::end(Valid), false);
+}
+
+//---------------------------------------------------------------------------
+const char* AudioStatsKernel::Name(value Value)
+{
+    return Value<Value_Max?Names[Value]:nullptr;
+}
+
+//---------------------------------------------------------------------------
+const char* AudioStatsKernel::Formats()
+{
+    return "fltp";
+}
+
+//---------------------------------------------------------------------------
+bool AudioStatsKernel::Has(value Value) const
+{
+    return Value<Value_Max && Valid[Value];
+}
+
+//---------------------------------------------------------------------------
+double AudioStatsKernel::Get(value Value) const
+{
+    return Value<Value_Max?Values[Value]:0;
+}
+
+//---------------------------------------------------------------------------
+// K-weighting filters and channel weights of ebur128, for any sample rate as the filters are not resampled to 48 kHz
+void AudioStatsKernel::Configure(const AVFrame* Frame)
+{
+#if LIBAVUTIL_VERSION_INT <= AV_VERSION_INT(57, 23, 0)
+    int FrameChannels=Frame->channels;
+#else
+    int FrameChannels=Frame->ch_layout.nb_channels;
+#endif
+    if (FrameChannels==Channels && Frame->sample_rate==SampleRate)
+        return;
+
+    Channels=FrameChannels;
+    SampleRate=Frame->sample_rate;
+
+    double f0=1681.974450955533;
+    double G=3.999843853973347;
+    double Q=0.7071752369554196;
+    double K=tan(Pi*f0/SampleRate);
+    double Vh=pow(10.0, G/20.0);
+    double Vb=pow(Vh, 0.4996667741545416);
+    double a0=1.0+K/Q+K*K;
+    PreB[0]=(Vh+Vb*K/Q+K*K)/a0;
+    PreB[1]=2.0*(K*K-Vh)/a0;
+    PreB[2]=(Vh-Vb*K/Q+K*K)/a0;
+    PreA[0]=2.0*(K*K-1.0)/a0;
+    PreA[1]=(1.0-K/Q+K*K)/a0;
+
+    f0=38.13547087602444;
+    Q=0.5003270373238773;
+    K=tan(Pi*f0/SampleRate);
+    RlbA[0]=2.0*(K*K-1.0)/(1.0+K/Q+K*K);
+    RlbA[1]=(1.0-K/Q+K*K)/(1.0+K/Q+K*K);
+
+    SquaresSize=std::max<size_t>(1, (size_t)std::lround(Window*SampleRate));
+    LoudnessSize=std::max<size_t>(1, (size_t)std::lround(0.4*SampleRate));
+    SquaresPos=0;
+    LoudnessPos=0;
+    Count=0;
+
+    static const uint64_t Surround=AV_CH_BACK_LEFT|AV_CH_BACK_CENTER|AV_CH_BACK_RIGHT|
+                                   AV_CH_TOP_BACK_LEFT|AV_CH_TOP_BACK_CENTER|AV_CH_TOP_BACK_RIGHT|
+                                   AV_CH_SIDE_LEFT|AV_CH_SIDE_RIGHT|
+                                   AV_CH_SURROUND_DIRECT_LEFT|AV_CH_SURROUND_DIRECT_RIGHT;
+    static const uint64_t Lfe=AV_CH_LOW_FREQUENCY|AV_CH_LOW_FREQUENCY_2;
+
+    Items.assign(Channels, channel());
+    for (int c=0; c<Channels; c++)
+    {
+#if LIBAVUTIL_VERSION_INT <= AV_VERSION_INT(57, 23, 0)
+        uint64_t Layout=Frame->channel_layout?Frame->channel_layout:av_get_default_channel_layout(Channels);
+        uint64_t Mask=av_channel_layout_extract_channel(Layout, c);
+#else
+        int Channel=av_channel_layout_channel_from_index(&Frame->ch_layout, c);
+        uint64_t Mask=Channel>=0 && Channel<64?1ULL<<Channel:0;
+#endif
+        auto& Item=Items[c];
+        Item.Weight=(Mask&Lfe)?0.0:(Mask&Surround)?1.41:1.0;
+        if (Levels)
+            Item.Squares.assign(SquaresSize, 0.0);
+        if (Loudness)
+            Item.Loudness.assign(LoudnessSize, 0.0);
+    }
+}
+
+//---------------------------------------------------------------------------
+bool AudioStatsKernel::Compute(const AVFrame* Frame)
+{
+    std::fill(std::begin(Valid), std::end(Valid), false);
+    if (!Frame || Frame->format!=AV_SAMPLE_FMT_FLTP || Frame->sample_rate<=0 || Frame->nb_samples<=0)
+        return false;
+
+    Configure(Frame);
+    if (!Channels)
+        return false;
+
+    const int Samples=Frame->nb_samples;
+    const float* const* Planes=reinterpret_cast<const float* const*>(Frame->extended_data);
+
+    levels Overall;
+    double SquaresMin=DBL_MAX, SquaresMax=-DBL_MAX;
+    double Energy=1e-12; // As ebur128, -120.7 LUFS for silence
+    int64_t DiffCount=0;
+    for (int c=0; c<Channels; c++)
+    {
+        const float* x=Planes[c];
+        auto& Item=Items[c];
+
+        if (Levels)
+        {
+            levels Channel;
+            Levels_Compute(x, Samples, Channel);
+            if (Item.HasLast)
+            {
+                // Difference with the last sample of the previous frame
+                float Diff=std::fabs(x[0]-Item.Last);
+                Channel.DiffMin=std::min(Channel.DiffMin, Diff);
+                Channel.DiffMax=std::max(Channel.DiffMax, Diff);
+                Channel.DiffSum+=Diff;
+                DiffCount++;
+            }
+            DiffCount+=Samples-1;
+            Item.Last=x[Samples-1];
+            Item.HasLast=true;
+
+            Overall.Min=std::min(Overall.Min, Channel.Min);
+            Overall.Max=std::max(Overall.Max, Channel.Max);
+            Overall.Sum+=Channel.Sum;
+            Overall.DiffMin=std::min(Overall.DiffMin, Channel.DiffMin);
+            Overall.DiffMax=std::max(Overall.DiffMax, Channel.DiffMax);
+            Overall.DiffSum+=Channel.DiffSum;
+
+            // RMS window, peak and trough once it is full
+            size_t Pos=SquaresPos;
+            int64_t Filled=Count;
+            int ZeroCrossings=0;
+            float LastNonZero=Item.LastNonZero;
+            double WindowMin=DBL_MAX, WindowMax=-DBL_MAX;
+            for (int i=0; i<Samples; i++)
+            {
+                double Square=(double)x[i]*x[i];
+                Item.SquaresSum+=Square-Item.Squares[Pos];
+                Item.Squares[Pos]=Square;
+                if (++Pos==SquaresSize)
+                {
+                    Pos=0;
+                    Item.SquaresSum=std::accumulate(Item.Squares.begin(), Item.Squares.end(), 0.0); // No drift of the running sum
+                }
+                if (++Filled>=(int64_t)SquaresSize)
+                {
+                    double Mean=std::max(0.0, Item.SquaresSum)/SquaresSize;
+                    WindowMin=std::min(WindowMin, Mean);
+                    WindowMax=std::max(WindowMax, Mean);
+                }
+
+                if (x[i]!=0)
+                {
+                    if (LastNonZero!=0 && (x[i]<0)!=(LastNonZero<0))
+                        ZeroCrossings++;
+                    LastNonZero=x[i];
+                }
+            }
+            Item.LastNonZero=LastNonZero;
+            if (WindowMax<0)
+            {
+                // First window not full yet, the samples so far
+                WindowMin=WindowMax=std::max(0.0, Item.SquaresSum)/std::min<int64_t>(Filled, SquaresSize);
+            }
+            SquaresMin=std::min(SquaresMin, WindowMin);
+            SquaresMax=std::max(SquaresMax, WindowMax);
+
+            if (c<2)
+            {
+                Values[c?Value_Min_level_2:Value_Min_level_1]=Channel.Min;
+                Values[c?Value_Max_level_2:Value_Max_level_1]=Channel.Max;
+                Values[c?Value_Zero_crossings_rate_2:Value_Zero_crossings_rate_1]=(double)ZeroCrossings/Samples;
+                Valid[c?Value_Min_level_2:Value_Min_level_1]=true;
+                Valid[c?Value_Max_level_2:Value_Max_level_1]=true;
+                Valid[c?Value_Zero_crossings_rate_2:Value_Zero_crossings_rate_1]=true;
+            }
+        }
+
+        if (Loudness && Item.Weight)
+        {
+            // K-weighting then the 400 ms window of the momentary loudness
+            size_t Pos=LoudnessPos;
+            double Pre1=Item.Pre[0], Pre2=Item.Pre[1];
+            double Rlb1=Item.Rlb[0], Rlb2=Item.Rlb[1];
+            for (int i=0; i<Samples; i++)
+            {
+                double Pre=x[i]-PreA[0]*Pre1-PreA[1]*Pre2;
+                double y=PreB[0]*Pre+PreB[1]*Pre1+PreB[2]*Pre2;
+                Pre2=Pre1;
+                Pre1=Pre;
+
+                double Rlb=y-RlbA[0]*Rlb1-RlbA[1]*Rlb2;
+                double z=Rlb-2.0*Rlb1+Rlb2;
+                Rlb2=Rlb1;
+                Rlb1=Rlb;
+
+                double Square=z*z;
+                Item.LoudnessSum+=Square-Item.Loudness[Pos];
+                Item.Loudness[Pos]=Square;
+                if (++Pos==LoudnessSize)
+                {
+                    Pos=0;
+                    Item.LoudnessSum=std::accumulate(Item.Loudness.begin(), Item.Loudness.end(), 0.0);
+                }
+            }
+            Item.Pre[0]=Pre1;
+            Item.Pre[1]=Pre2;
+            Item.Rlb[0]=Rlb1;
+            Item.Rlb[1]=Rlb2;
+
+            // Window not full yet is padded with silence, as the filter
+            Energy+=Item.Weight*std::max(0.0, Item.LoudnessSum)/LoudnessSize;
+        }
+    }
+
+    if (Levels)
+    {
+        Values[Value_DC_offset]=Overall.Sum/((double)Samples*Channels);
+        Values[Value_Min_level]=Overall.Min;
+        Values[Value_Max_level]=Overall.Max;
+        Values[Value_Min_difference]=DiffCount?Overall.DiffMin:0;
+        Values[Value_Max_difference]=DiffCount?Overall.DiffMax:0;
+        Values[Value_Mean_difference]=DiffCount?Overall.DiffSum/DiffCount:0;
+        Values[Value_Peak_level]=LinearToDb(std::max(-Overall.Min, Overall.Max));
+        Values[Value_RMS_peak]=LinearToDb(sqrt(SquaresMax));
+        Values[Value_RMS_trough]=LinearToDb(sqrt(SquaresMin));
+        for (auto Value : { Value_DC_offset, Value_Min_level, Value_Max_level, Value_Min_difference, Value_Max_difference, Value_Mean_difference, Value_Peak_level, Value_RMS_peak, Value_RMS_trough })
+            Valid[Value]=true;
+
+        SquaresPos=(SquaresPos+Samples)%SquaresSize;
+    }
+
+    if (Phase)
+    {
+        // As aphasemeter, silence is in phase
+        const float* Left=Planes[0];
+        const float* Right=Planes[Channels>1?1:0];
+        double Sum=0;
+        for (int i=0; i<Samples; i++)
+        {
+            float f=Left[i]*Right[i]/(Left[i]*Left[i]+Right[i]*Right[i])*2;
+            Sum+=std::isnan(f)?1:f;
+        }
+        Values[Value_Phase]=Sum/Samples;
+        Valid[Value_Phase]=true;
+    }
+
+    if (Loudness)
+    {
+        Values[Value_R128_M]=-0.691+10*log10(Energy);
+        Valid[Value_R128_M]=true;
+
+        LoudnessPos=(LoudnessPos+Samples)%LoudnessSize;
+    }
+
+    Count+=Samples;
+    return true;
+}
@@ -0,0 +1,112 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef AudioStatsKernel_H
+#define AudioStatsKernel_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct AVFrame;
+
+//---------------------------------------------------------------------------
+// Values of astats, aphasemeter and ebur128 for the AudioStats columns, computed
+// without the filters in one pass per channel of planar float frames: the
+// channels are not downmixed to stereo and the sample rate is not changed.
+//
+// Levels and differences use AVX2 (if the CPU has it) or NEON, the K-weighting
+// filters, the RMS window and the zero crossings depend on the previous sample
+// so they are in the same scalar loop. Values of all the channels take part in
+// the overall ones, phase is the one of the first 2 channels and loudness uses
+// the weights of BS.1770 by channel position, so values of files which are not
+// stereo differ from the ones of the filters after their stereo downmix.
+class AudioStatsKernel
+{
+public:
+    enum value
+    {
+        Value_R128_M,
+        Value_Phase,
+        Value_DC_offset,
+        Value_Min_level,
+        Value_Max_level,
+        Value_Min_level_2,
+        Value_Max_level_2,
+        Value_Min_level_1,
+        Value_Max_level_1,
+        Value_Zero_crossings_rate_2,
+        Value_Zero_crossings_rate_1,
+        Value_Min_difference,
+        Value_Max_difference,
+        Value_Mean_difference,
+        Value_Peak_level,
+        Value_RMS_peak,
+        Value_RMS_trough,
+        Value_Max
+    };
+
+    // Window is the length in seconds of the RMS peak and trough (length option of astats)
+                                AudioStatsKernel            (bool Levels, bool Phase, bool Loudness, double Window=0.4);
+                                AudioStatsKernel            (const AudioStatsKernel&) = delete;
+    AudioStatsKernel&           operator=                   (const AudioStatsKernel&) = delete;
+
+    // Key of the value in the metadata of the filters ("lavfi.astats.Overall.DC_offset"...)
+    static const char*          Name                        (value Value);
+
+    // Format of the frames, as the sample_fmts option of the aformat filter
+    static const char*          Formats                     ();
+
+    // Values of a frame, false if its format is not supported
+    // Windows and filters continue from the previous frame, as in the filters
+    bool                        Compute                     (const AVFrame* Frame);
+    bool                        Has                         (value Value) const;
+    double                      Get                         (value Value) const;
+
+private:
+    struct channel
+    {
+        // K-weighting (2 biquads, direct form II)
+        double                  Pre[2] {};
+        double                  Rlb[2] {};
+        double                  Weight {1.0};
+
+        // Windows of the squares of the samples, RMS and 400 ms of the K-weighted ones
+        std::vector<double>     Squares;
+        std::vector<double>     Loudness;
+        double                  SquaresSum {0};
+        double                  LoudnessSum {0};
+
+        float                   Last {0};
+        float                   LastNonZero {0};
+        bool                    HasLast {false};
+    };
+
+    void                        Configure                   (const AVFrame* Frame);
+
+    bool                        Levels;
+    bool                        Phase;
+    bool                        Loudness;
+    double                      Window;
+
+    int                         SampleRate {0};
+    int                         Channels {0};
+    double                      PreA[2];
+    double                      PreB[3];
+    double                      RlbA[2];
+    size_t                      SquaresSize {0};
+    size_t                      LoudnessSize {0};
+    size_t                      SquaresPos {0};             // In the windows, the same for all the channels
+    size_t                      LoudnessPos {0};
+    int64_t                     Count {0};                  // Samples since the start, for the first windows
+    std::vector<channel>        Items;
+
+    double                      Values[Value_Max];
+    bool                        Valid[Value_Max];
+};
+
+#endif // AudioStatsKernel_H
@@ -6,6 +6,7 @@
 
 //---------------------------------------------------------------------------
 #include "Core/AudioStreamStats.h"
+#include "Core/StatsNumbers.h"
 //---------------------------------------------------------------------------
 #include <qavplayer.h>
 #include <qavstream.h>
@@ -44,11 +45,11 @@ AudioStreamStats::AudioStreamStats(XMLElement *streamElement) : CommonStreamStat
 
     const char* sample_rate_value = streamElement->Attribute("sample_rate");
     if(sample_rate_value)
-        sample_rate = std::stoi(sample_rate_value);
+        sample_rate = Number_ToInt(sample_rate_value);
 
     const char* channels_value = streamElement->Attribute("channels");
     if(channels_value)
-        channels = std::stoi(channels_value);
+        channels = Number_ToInt(channels_value);
 
     const char* channel_layout_value = streamElement->Attribute("channel_layout");
     if(channel_layout_value)
@@ -56,7 +57,7 @@ AudioStreamStats::AudioStreamStats(XMLElement *streamElement) : CommonStreamStat
 
     const char* bits_per_sample_value = streamElement->Attribute("bits_per_sample");
     if(bits_per_sample_value)
-        bits_per_sample = std::stoi(bits_per_sample_value);
+        bits_per_sample = Number_ToInt(bits_per_sample_value);
 }
 
 AudioStreamStats::AudioStreamStats(QAVStream* stream, AVFormatContext *context) : CommonStreamStats(stream),
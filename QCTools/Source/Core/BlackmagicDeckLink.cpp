@@ -21,6 +21,7 @@
 #include <iostream>
 #include <iomanip>
 #include <bitset>
+#include <chrono>
 using namespace std;
 //---------------------------------------------------------------------------
 
@@ -210,8 +211,12 @@ CaptureHelper::CaptureHelper(size_t CardPos, BlackmagicDeckLink_Glue::config_in*
     , m_height(-1)
     , m_timeScale(0)
     , m_frameDuration(0)
+    , m_encoderStop(false)
+    , m_qcStop(false)
+    , m_qcActive(false)
     , m_FramePos(0)
     , Glue(NULL)
+    , QCGlue(NULL)
     , Config_In(Config_In_)
     , Config_Out(Config_Out_)
     , WantTimeCode(false)
@@ -231,6 +236,7 @@ CaptureHelper::CaptureHelper(size_t CardPos, BlackmagicDeckLink_Glue::config_in*
 CaptureHelper::~CaptureHelper()
 {
     finishCapture();
+    stopPipeline();
     cleanupControl();
     cleanupInput();
     cleanupCard();
@@ -571,6 +577,7 @@ void CaptureHelper::startCapture()
 
     if (!setupInput())
         return;
+    startPipeline();
 
     cout << "*** Start capture ***" << endl;
 
@@ -610,8 +617,12 @@ bool CaptureHelper::finishCapture()
     if (Config_Out->Status==BlackmagicDeckLink_Glue::finished)
         return false;
 
+    // Frames in the rings are sent before closing
+    stopPipeline();
     if (Glue && *Glue)
         (*Glue)->CloseOutput();
+    if (QCGlue && *QCGlue)
+        (*QCGlue)->CloseOutput();
 
     Config_Out->Status=BlackmagicDeckLink_Glue::finished;
     cout << "Capture finished" << endl ;
@@ -758,15 +769,22 @@ HRESULT CaptureHelper::VideoInputFrameArrived (IDeckLinkVideoInputFrame* arrived
 
     if (ShouldDecode)
     {
-        void* videoBuffer;
-        void* audioBuffer;
+        // Copied for the encoder thread, nothing here waits for it
+        void* videoBuffer=NULL;
+        void* audioBuffer=NULL;
+        size_t videoSize=0;
+        size_t audioSize=0;
         arrivedVideoFrame->GetBytes(&videoBuffer);
-        arrivedAudioFrame->GetBytes(&audioBuffer);
-        if (Glue && *Glue)
+        if (videoBuffer)
+            videoSize=arrivedVideoFrame->GetRowBytes()*arrivedVideoFrame->GetHeight();
+        if (arrivedAudioFrame)
         {
-            (*Glue)->OutputFrame((unsigned char*)videoBuffer, arrivedVideoFrame->GetRowBytes()*arrivedVideoFrame->GetHeight(), 0, m_FramePos);
-            (*Glue)->OutputFrame((unsigned char*)audioBuffer, arrivedAudioFrame->GetSampleFrameCount()*2*16 /*m_audioChannels*(m_audioSampleDepth*//8, 1, m_FramePos);
+            arrivedAudioFrame->GetBytes(&audioBuffer);
+            if (audioBuffer)
+                audioSize=arrivedAudioFrame->GetSampleFrameCount()*2*16 /*m_audioChannels*(m_audioSampleDepth*//8;
         }
+        if (!m_ring.Push(videoBuffer, videoSize, audioBuffer, audioSize, m_FramePos))
+            Config_Out->FramesDropped=(int)m_ring.Dropped_Get();
 
         m_FramePos++;
 
@@ -780,5 +798,124 @@ HRESULT CaptureHelper::VideoInputFrameArrived (IDeckLinkVideoInputFrame* arrived
     return S_OK;
 }
 
+//***************************************************************************
+// Pipeline
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Oldest frame of the ring, waited for; nullptr once stopped and the ring is empty, the last frames may come with the stop
+static const CaptureFrameRing::slot* Ring_Wait(const CaptureFrameRing& Ring, const std::atomic<bool>& Stop)
+{
+    for (;;)
+    {
+        if (const CaptureFrameRing::slot* Frame=Ring.Front())
+            return Frame;
+        if (Stop)
+            return Ring.Front();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+//---------------------------------------------------------------------------
+static void Glue_Output(FFmpeg_Glue** Glue, const CaptureFrameRing::slot& Frame)
+{
+    if (!Glue || !*Glue)
+        return;
+    if (Frame.Video_Size)
+        (*Glue)->OutputFrame((unsigned char*)Frame.Video.data(), Frame.Video_Size, 0, Frame.FramePos);
+    if (Frame.Audio_Size)
+        (*Glue)->OutputFrame((unsigned char*)Frame.Audio.data(), Frame.Audio_Size, 1, Frame.FramePos);
+}
+
+//---------------------------------------------------------------------------
+void CaptureHelper::startPipeline()
+{
+    stopPipeline();
+
+    // Largest frames of the mode: 10-bit rows of 48 pixels in 128 bytes, 32-bit audio samples, 2 frames of audio at 48 kHz
+    size_t videoMax=((m_width+47)/48)*128*m_height;
+    size_t audioMax=2*48000*m_frameDuration/(m_timeScale?m_timeScale:1)*Config_In->ChannelsCount*4;
+    m_ring.Init(Config_In->RingFrames>0?Config_In->RingFrames:1, videoMax, audioMax);
+    Config_Out->FramesDropped=0;
+    Config_Out->RingOccupancy=0;
+    Config_Out->RingPeak=0;
+    Config_Out->QCFramesSkipped=0;
+
+    // The QC ring is allocated only if there is a QC
+    m_qcActive=QCGlue && *QCGlue && Config_In->QCRingFrames>0;
+    if (m_qcActive)
+    {
+        m_qcRing.Init(Config_In->QCRingFrames, videoMax, audioMax);
+        m_qcStop=false;
+        m_qc=std::thread(&CaptureHelper::qc, this);
+    }
+
+    m_encoderStop=false;
+    m_encoder=std::thread(&CaptureHelper::encoder, this);
+}
+
+//---------------------------------------------------------------------------
+void CaptureHelper::stopPipeline()
+{
+    // The encoder first, the QC gets its last frames
+    if (m_encoder.joinable())
+    {
+        m_encoderStop=true;
+        m_encoder.join();
+        report();
+        if (m_ring.Dropped_Get())
+            cout << m_ring.Dropped_Get() << " frames dropped, the encoding was late" << endl;
+    }
+    if (m_qc.joinable())
+    {
+        m_qcStop=true;
+        m_qc.join();
+        if (m_qcRing.Dropped_Get())
+            cout << m_qcRing.Dropped_Get() << " frames not checked, the QC was late" << endl;
+    }
+}
+
+//---------------------------------------------------------------------------
+void CaptureHelper::encoder()
+{
+    auto Reported=std::chrono::steady_clock::now();
+    while (const CaptureFrameRing::slot* Frame=Ring_Wait(m_ring, m_encoderStop))
+    {
+        Glue_Output(Glue, *Frame);
+        if (m_qcActive && !m_qcRing.Push(Frame->Video.data(), Frame->Video_Size, Frame->Audio.data(), Frame->Audio_Size, Frame->FramePos))
+            Config_Out->QCFramesSkipped=(int)m_qcRing.Dropped_Get();
+        m_ring.Pop();
+
+        Config_Out->RingOccupancy=(int)m_ring.Occupancy();
+        Config_Out->RingPeak=(int)m_ring.Peak_Get();
+        auto Now=std::chrono::steady_clock::now();
+        if (Now-Reported>=std::chrono::seconds(1))
+        {
+            Reported=Now;
+            report();
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+void CaptureHelper::qc()
+{
+    while (const CaptureFrameRing::slot* Frame=Ring_Wait(m_qcRing, m_qcStop))
+    {
+        Glue_Output(QCGlue, *Frame);
+        m_qcRing.Pop();
+    }
+}
+
+//---------------------------------------------------------------------------
+void CaptureHelper::report()
+{
+    cout << "Ring " << m_ring.Occupancy() << "/" << m_ring.Capacity() << " frames (peak " << m_ring.Peak_Get() << "), "
+         << m_ring.Dropped_Get() << " dropped";
+    if (m_qcActive)
+        cout << ", QC ring " << m_qcRing.Occupancy() << "/" << m_qcRing.Capacity() << ", " << m_qcRing.Dropped_Get() << " not checked";
+    cout << endl;
+}
+
 #endif // defined(BLACKMAGICDECKLINK_YES)
 
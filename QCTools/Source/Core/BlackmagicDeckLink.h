@@ -19,6 +19,7 @@
 
 //---------------------------------------------------------------------------
 #include "Core/FFmpeg_Glue.h"
+#include "Core/CaptureFrameRing.h"
 #if defined(_WIN32) || defined(_WIN64)
     #include "Win/include/DeckLinkAPI.idl.h"
     typedef unsigned long bmdl_uint32_t;
@@ -29,11 +30,20 @@
     #include "Linux/include/DeckLinkAPI.h"
     typedef uint32_t bmdl_uint32_t;
 #endif
+#include <atomic>
 #include <string>
+#include <thread>
 #include <vector>
 //---------------------------------------------------------------------------
 
 //---------------------------------------------------------------------------
+// Frames are copied by the DeckLink callback in a ring of slots allocated
+// before the capture (dropped if it is full, see Config_Out->FramesDropped)
+// and sent to the encoding glue by the encoder thread, so the encoding never
+// blocks the card. With a QC glue, the encoder thread copies the frames it
+// encoded in a second ring for the QC thread, a late QC skips frames (see
+// Config_Out->QCFramesSkipped) and delays neither the card nor the encoding.
+// Occupancy of the ring is in Config_Out and printed every second.
 //---------------------------------------------------------------------------
 class CaptureHelper : public IDeckLinkDeckControlStatusCallback , public IDeckLinkInputCallback
 {
@@ -62,6 +72,20 @@ private:
 
     // Timecode
     void                        readTimeCode();
+
+    // Pipeline: encoder then QC
+    CaptureFrameRing            m_ring;
+    CaptureFrameRing            m_qcRing;
+    std::thread                 m_encoder;
+    std::thread                 m_qc;
+    std::atomic<bool>           m_encoderStop;
+    std::atomic<bool>           m_qcStop;
+    bool                        m_qcActive;
+    void                        startPipeline();
+    void                        stopPipeline();
+    void                        encoder();
+    void                        qc();
+    void                        report();
     
 public:
                                 CaptureHelper(size_t CardPos, BlackmagicDeckLink_Glue::config_in* Config_In, BlackmagicDeckLink_Glue::config_out* Config_Out);
@@ -91,6 +115,7 @@ public:
     BlackmagicDeckLink_Glue::config_in*     Config_In;
     BlackmagicDeckLink_Glue::config_out*    Config_Out;
     FFmpeg_Glue**               Glue;
+    FFmpeg_Glue**               QCGlue;
     int                         m_FramePos;
     bool                        WantTimeCode;
 };
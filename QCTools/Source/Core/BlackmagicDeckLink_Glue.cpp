@@ -36,10 +36,12 @@ struct Debug_Simulation
 BlackmagicDeckLink_Glue::BlackmagicDeckLink_Glue(size_t CardPos)
     : Handle(NULL)
     , Glue(NULL)
+    , QCGlue(NULL)
 {
     #if defined(BLACKMAGICDECKLINK_YES)
         CaptureHelper* helper=new CaptureHelper(CardPos, &Config_In, &Config_Out);
         helper->Glue=&Glue;
+        helper->QCGlue=&QCGlue;
 
         Handle=helper;
     #elif defined(_DEBUG) // Simulation
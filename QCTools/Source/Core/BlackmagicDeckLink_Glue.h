@@ -14,6 +14,7 @@
 #endif
 //---------------------------------------------------------------------------
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -34,7 +35,8 @@ public:
 
     void                        CurrentTimecode();
 
-    FFmpeg_Glue*                Glue;
+    FFmpeg_Glue*                Glue;                       // Encoding of the capture
+    FFmpeg_Glue*                QCGlue;                     // Optional QC on the side of the encoding (stats...), NULL for none
     enum status
     {
         instancied,
@@ -58,6 +60,8 @@ public:
         timecodeisavailable_callback* TimeCodeIsAvailable_Callback;
         void*                   TimeCodeIsAvailable_Private;
         int                     VideoInputConnection;
+        int                     RingFrames;                 // Frames waiting for the encoding, next ones are dropped
+        int                     QCRingFrames;               // Frames waiting for the QC, next ones are not checked (the encoding does not wait)
 
         config_in()
             : TC_in(-1)
@@ -74,6 +78,8 @@ public:
             , TimeCodeIsAvailable_Callback(NULL)
             , TimeCodeIsAvailable_Private(NULL)
             , VideoInputConnection(-1)
+            , RingFrames(32)
+            , QCRingFrames(8)
         {
         }
     };
@@ -82,11 +88,19 @@ public:
         int                     VideoInputConnections;
         status                  Status;
         int                     TC_current;
+        std::atomic<int>        FramesDropped;              // Encoding late, from any thread
+        std::atomic<int>        RingOccupancy;              // Frames waiting for the encoding, live
+        std::atomic<int>        RingPeak;                   // Highest RingOccupancy of the capture
+        std::atomic<int>        QCFramesSkipped;            // QC late, not checked
 
         config_out()
             : VideoInputConnections(-1)
             , Status(instancied)
             , TC_current(-1)
+            , FramesDropped(0)
+            , RingOccupancy(0)
+            , RingPeak(0)
+            , QCFramesSkipped(0)
         {
         }
     };
@@ -0,0 +1,171 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/CaptionsTimecode.h"
+#include "Core/CommonStats.h"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavutil/frame.h>
+}
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+static const char* const CC608_Key="qctools.cc.608";
+static const char* const CC708_Key="qctools.cc.708";
+static const char* const TimeCode_Key="qctools.timecode";
+static const char* const Discontinuity_Key="qctools.timecode.discontinuity";
+
+//---------------------------------------------------------------------------
+static int Bcd(uint32_t Value)
+{
+    return (Value>>4)*10+(Value&0xF);
+}
+
+//---------------------------------------------------------------------------
+// "01:00:00:00", drop frame with ';' or '.' before the frames
+static TimeCode FromString(const char* Value, int FramesPerSecond)
+{
+    int Hours, Minutes, Seconds, Frames;
+    char Separator;
+    if (!Value || std::sscanf(Value, "%d:%d:%d%c%d", &Hours, &Minutes, &Seconds, &Separator, &Frames)!=5
+     || Hours<0 || Minutes<0 || Minutes>59 || Seconds<0 || Seconds>59 || Frames<0 || Frames>=FramesPerSecond)
+        return TimeCode();
+    bool DropFrame=(Separator==';' || Separator=='.') && FramesPerSecond%30==0;
+    return TimeCode(Hours%24, Minutes, Seconds, Frames, FramesPerSecond, DropFrame);
+}
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+CaptionsTimecode::CaptionsTimecode(const AVStream* Stream, const AVFormatContext* Context)
+{
+    AVRational FrameRate=Stream->avg_frame_rate.num && Stream->avg_frame_rate.den?Stream->avg_frame_rate:Stream->r_frame_rate;
+    if (!FrameRate.num || !FrameRate.den)
+        return; // Timecode of each frame only, its rate is unknown
+    Rate=av_q2d(FrameRate);
+    FramesPerSecond=(int)std::ceil(Rate-0.01);
+    Rate_Above30=av_cmp_q(FrameRate, AVRational{30, 1})>0;
+    Rate_50=av_cmp_q(FrameRate, AVRational{50, 1})==0;
+
+    // Stream first (MOV tmcd track, MXF...), then the container
+    auto Entry=av_dict_get(Stream->metadata, "timecode", nullptr, 0);
+    if (!Entry && Context)
+        Entry=av_dict_get(Context->metadata, "timecode", nullptr, 0);
+    if (Entry)
+        Start=FromString(Entry->value, FramesPerSecond);
+    if (Stream->start_time!=AV_NOPTS_VALUE)
+    {
+        Start_Pts=Stream->start_time*av_q2d(Stream->time_base);
+        Start_Pts_IsSet=true;
+    }
+}
+
+//***************************************************************************
+// Stats
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void CaptionsTimecode::Declare(CommonStats* Stat)
+{
+    Stat->AdditionalStats_Declare(CC608_Key, Additional_Int);
+    Stat->AdditionalStats_Declare(CC708_Key, Additional_Int);
+    Stat->AdditionalStats_Declare(TimeCode_Key, Additional_String);
+    Stat->AdditionalStats_Declare(Discontinuity_Key, Additional_Int);
+}
+
+//---------------------------------------------------------------------------
+void CaptionsTimecode::FromFrame(AVFrame* Frame, double Pts)
+{
+    // cc_data() of CEA-708: cc_valid and cc_type in the first byte of each triplet, then the 2 bytes of the pair
+    // cc_type 0 and 1 are the fields of CEA-608 (0x80 0x80 is the padding, 0 with its parity bit), 2 and 3 DTVCC
+    int CC608=0, CC708=0;
+    if (auto SideData=av_frame_get_side_data(Frame, AV_FRAME_DATA_A53_CC))
+        for (size_t i=0; i+2<(size_t)SideData->size; i+=3)
+        {
+            const uint8_t* Triplet=SideData->data+i;
+            if (!(Triplet[0]&0x04))
+                continue;
+            if ((Triplet[0]&0x03)<2)
+            {
+                if ((Triplet[1]&0x7F) || (Triplet[2]&0x7F))
+                    CC608++;
+            }
+            else if (Triplet[1] || Triplet[2])
+                CC708++;
+        }
+    av_dict_set(&Frame->metadata, CC608_Key, std::to_string(CC608).c_str(), 0);
+    av_dict_set(&Frame->metadata, CC708_Key, std::to_string(CC708).c_str(), 0);
+
+    // First timecode of the frame (the others are the ones of the other fields or of the other views)
+    TimeCode Current;
+    auto SideData=av_frame_get_side_data(Frame, AV_FRAME_DATA_S12M_TIMECODE);
+    if (SideData && SideData->size>=(int)(2*sizeof(uint32_t)) && reinterpret_cast<const uint32_t*>(SideData->data)[0])
+        Current=FromSmpte(reinterpret_cast<const uint32_t*>(SideData->data)[1]);
+    else if (Start.IsValid())
+    {
+        if (!std::isnan(Pts) && !Start_Pts_IsSet)
+        {
+            Start_Pts=Pts;
+            Start_Pts_IsSet=true;
+        }
+        if (!std::isnan(Pts))
+        {
+            TimeCode Start_=Start;
+            Current=TimeCode(Start_.ToFrames()+(int)std::llround((Pts-Start_Pts)*Rate), FramesPerSecond, Start.DropFrame);
+        }
+        else if (Previous.IsValid())
+        {
+            Current=Previous;
+            ++Current;
+        }
+    }
+
+    // Not kept from the previous frame (duplicated frames have its metadata)
+    if (!Current.IsValid())
+    {
+        av_dict_set(&Frame->metadata, TimeCode_Key, nullptr, 0);
+        av_dict_set(&Frame->metadata, Discontinuity_Key, nullptr, 0);
+        Previous=Current;
+        return;
+    }
+    av_dict_set(&Frame->metadata, TimeCode_Key, Current.ToString().c_str(), 0);
+    bool Discontinuity=false;
+    if (Previous.IsValid())
+    {
+        TimeCode Next=Previous;
+        ++Next;
+        Discontinuity=Next!=Current;
+    }
+    av_dict_set(&Frame->metadata, Discontinuity_Key, Discontinuity?"1":"0", 0);
+    Previous=Current;
+}
+
+//---------------------------------------------------------------------------
+// Bits of SMPTE 12M as in av_timecode_make_smpte_tc_string2(): BCD hours, minutes, seconds and frames, drop frame flag;
+// above 30 fps the frames are counted by pairs and the field flag is the second frame of the pair
+TimeCode CaptionsTimecode::FromSmpte(uint32_t Value) const
+{
+    int FramesPerSecond_=FramesPerSecond?FramesPerSecond:30;
+    int Hours  =Bcd( Value     &0x3F);
+    int Minutes=Bcd((Value>> 8)&0x7F);
+    int Seconds=Bcd((Value>>16)&0x7F);
+    int Frames =Bcd((Value>>24)&0x3F);
+    bool DropFrame=(Value&(1<<30)) && FramesPerSecond_%30==0;
+    if (Rate_Above30)
+        Frames=Frames*2+((Value&(Rate_50?(1<<7):(1<<23)))?1:0);
+    if (Hours>23 || Minutes>59 || Seconds>59 || Frames>=FramesPerSecond_)
+        return TimeCode();
+    return TimeCode(Hours, Minutes, Seconds, Frames, FramesPerSecond_, DropFrame);
+}
@@ -0,0 +1,59 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef CaptionsTimecode_H
+#define CaptionsTimecode_H
+
+#include "Core/TimeCode.h"
+
+#include <cstdint>
+
+struct AVFrame;
+struct AVStream;
+struct AVFormatContext;
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Closed captions and timecode of the video frames, read from their side data
+// while they are analyzed (no other pass over the file) and kept as additional
+// stats of the stream:
+// - qctools.cc.608: CEA-608 byte pairs with data (not padding) in the A/53
+//   captions of the frame (both fields), 0 if none
+// - qctools.cc.708: DTVCC (CEA-708) byte pairs in the A/53 captions
+// - qctools.timecode: SMPTE 12M timecode of the frame, else the timecode of
+//   the stream (or of the container) plus the frames since the first one
+// - qctools.timecode.discontinuity: 1 if the timecode is not the one after
+//   the timecode of the previous frame
+class CaptionsTimecode
+{
+public:
+    // Stream is the video stream of the frames, Context its container
+                                CaptionsTimecode            (const AVStream* Stream, const AVFormatContext* Context);
+                                CaptionsTimecode            (const CaptionsTimecode&) = delete;
+    CaptionsTimecode&           operator=                   (const CaptionsTimecode&) = delete;
+
+    // Items of the frame set in its metadata, before its stats; Pts in seconds, NaN if unknown
+    // Frames are given in presentation order, as the stats
+    void                        FromFrame                   (AVFrame* Frame, double Pts);
+
+    // Columns in the stats of a stream, before the first frame
+    static void                 Declare                     (CommonStats* Stat);
+
+private:
+    TimeCode                    FromSmpte                   (uint32_t Value) const;
+
+    int                         FramesPerSecond=0;          // Of the timecode, rounded up (30 for 30000/1001)
+    bool                        Rate_Above30=false;         // Frames of the SMPTE 12M timecode are pairs, plus the field flag
+    bool                        Rate_50=false;
+    double                      Rate=0;
+    TimeCode                    Start;                      // Of the stream or of the container, invalid if none
+    double                      Start_Pts=0;
+    bool                        Start_Pts_IsSet=false;
+    TimeCode                    Previous;
+};
+
+#endif // CaptionsTimecode_H
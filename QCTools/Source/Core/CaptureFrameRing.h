@@ -0,0 +1,111 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef CaptureFrameRing_H
+#define CaptureFrameRing_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Frames of a capture card handed from its callback thread to the analysis
+// thread without lock nor allocation: a ring of slots allocated once, one
+// producer and one consumer. The callback copies a frame in the next free
+// slot or drops it if the analysis is late, so the card never waits.
+// Occupancy is readable from any thread, for the live reports.
+class CaptureFrameRing
+{
+public:
+    struct slot
+    {
+        std::vector<unsigned char> Video;                   // Capacity allocated by Init
+        std::vector<unsigned char> Audio;
+        size_t                  Video_Size=0;
+        size_t                  Audio_Size=0;
+        int                     FramePos=0;
+    };
+
+    // Before the capture, sizes are the maximum ones of a frame
+    void                        Init                        (size_t Slots, size_t Video_Max, size_t Audio_Max)
+    {
+        Items.resize(Slots+1);                              // One slot is always free, full and empty differ
+        for (auto& Item : Items)
+        {
+            Item.Video.resize(Video_Max);
+            Item.Audio.resize(Audio_Max);
+        }
+        Head.store(0, std::memory_order_relaxed);
+        Tail.store(0, std::memory_order_relaxed);
+        Dropped.store(0, std::memory_order_relaxed);
+        Peak.store(0, std::memory_order_relaxed);
+    }
+
+    // Producer: false if the frame is dropped (ring full or frame too big)
+    bool                        Push                        (const void* Video, size_t Video_Size, const void* Audio, size_t Audio_Size, int FramePos)
+    {
+        size_t Pos=Head.load(std::memory_order_relaxed);
+        size_t Next=Pos+1==Items.size()?0:Pos+1;
+        if (Items.empty() || Next==Tail.load(std::memory_order_acquire) || Video_Size>Items[Pos].Video.size() || Audio_Size>Items[Pos].Audio.size())
+        {
+            Dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slot& Item=Items[Pos];
+        if (Video_Size)
+            std::memcpy(Item.Video.data(), Video, Video_Size);
+        if (Audio_Size)
+            std::memcpy(Item.Audio.data(), Audio, Audio_Size);
+        Item.Video_Size=Video_Size;
+        Item.Audio_Size=Audio_Size;
+        Item.FramePos=FramePos;
+        Head.store(Next, std::memory_order_release);
+
+        // Only the producer writes it
+        size_t Count=Occupancy();
+        if (Count>Peak.load(std::memory_order_relaxed))
+            Peak.store(Count, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer: oldest frame or nullptr if none, valid until Pop
+    const slot*                 Front                       () const
+    {
+        size_t Pos=Tail.load(std::memory_order_relaxed);
+        if (Pos==Head.load(std::memory_order_acquire))
+            return nullptr;
+        return &Items[Pos];
+    }
+    void                        Pop                         ()
+    {
+        size_t Pos=Tail.load(std::memory_order_relaxed);
+        Tail.store(Pos+1==Items.size()?0:Pos+1, std::memory_order_release);
+    }
+
+    // Frames dropped since Init, from any thread
+    size_t                      Dropped_Get                 () const {return Dropped.load(std::memory_order_relaxed);}
+    // Frames waiting for the consumer, highest count since Init and count of slots, from any thread
+    size_t                      Occupancy                   () const
+    {
+        size_t Pos_Head=Head.load(std::memory_order_relaxed);
+        size_t Pos_Tail=Tail.load(std::memory_order_relaxed);
+        return Pos_Head>=Pos_Tail?Pos_Head-Pos_Tail:Pos_Head+Items.size()-Pos_Tail;
+    }
+    size_t                      Peak_Get                    () const {return Peak.load(std::memory_order_relaxed);}
+    size_t                      Capacity                    () const {return Items.empty()?0:Items.size()-1;}
+
+private:
+    std::vector<slot>           Items;
+    std::atomic<size_t>         Head{0};                    // Next slot written
+    std::atomic<size_t>         Tail{0};                    // Next slot read
+    std::atomic<size_t>         Dropped{0};
+    std::atomic<size_t>         Peak{0};
+};
+
+#endif // CaptureFrameRing_H
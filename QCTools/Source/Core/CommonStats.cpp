@@ -18,31 +18,183 @@ extern "C"
 #include <qavcodec_p.h>
 
 #include "Core/Core.h"
-#include "tinyxml2.h"
+#include "Core/StatsNumbers.h"
+#include "Core/StatsXmlReader.h"
+#include "Core/StatsXmlWriter.h"
 #include <QMutexLocker>
 #include <sstream>
 #include <iomanip>
 #include <cstdlib>
+#include <cmath>
 #include <cfloat>
-using namespace tinyxml2;
+#include <atomic>
+#include <charconv>
+#include <algorithm>
 //---------------------------------------------------------------------------
 
+//***************************************************************************
+// Events
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+double StatsEvent::FromFrame(const AVDictionary* Metadata, double Time, double Duration)
+{
+    if (Started && av_dict_get(Metadata, Key_End, NULL, 0))
+        Started=false;
+
+    // freezedetect and silencedetect detect the event once it lasts for their minimum duration, it started before this frame
+    if (AVDictionaryEntry* Entry=av_dict_get(Metadata, Key_Start, NULL, 0))
+    {
+        Started=true;
+        Start=std::min(Number_ToDouble(Entry->value), Time);
+    }
+
+    return Started?Time+Duration-Start:0;
+}
+
+//***************************************************************************
+// Compact storage
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static std::atomic<bool> CompactStorage(false);
+
+//---------------------------------------------------------------------------
+void CommonStats::CompactStorage_Set(bool Value)
+{
+    CompactStorage=Value;
+}
+
+//---------------------------------------------------------------------------
+bool CommonStats::CompactStorage_Get()
+{
+    return CompactStorage;
+}
+
+//***************************************************************************
+// Cold compression
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static std::atomic<bool> ColdCompression(false);
+
+//---------------------------------------------------------------------------
+void CommonStats::ColdCompression_Set(bool Value)
+{
+    ColdCompression=Value;
+}
+
+//---------------------------------------------------------------------------
+bool CommonStats::ColdCompression_Get()
+{
+    return ColdCompression;
+}
+
+//***************************************************************************
+// Window
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static std::atomic<size_t> Window(0);
+
+//---------------------------------------------------------------------------
+void CommonStats::Window_Set(size_t Frames)
+{
+    Window=Frames;
+}
+
+//---------------------------------------------------------------------------
+size_t CommonStats::Window_Get()
+{
+    return Window;
+}
+
+//---------------------------------------------------------------------------
+static StatsValueColumn::storage CompactStorage_ForItem(const struct per_item& Item)
+{
+    // Integral items (min/max/percentiles, bit depth, crop) are exact in int32,
+    // the others need less significant digits than float32 provides
+    if (!Item.DigitsAfterComma && Item.FFmpeg_Name && CommonStats::StatsValueInfo::typeFromKey(Item.FFmpeg_Name, "")==CommonStats::StatsValueInfo::Int)
+        return StatsValueColumn::Storage_Int32;
+    return StatsValueColumn::Storage_Float;
+}
+
+//***************************************************************************
+// Summaries
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+struct CommonStats::summary_state
+{
+    summary                     Summary{};
+    double                      M2=0;                       // Sum of the squared differences from the mean (Welford)
+    StatsSketch                 Sketch;
+
+    void                        Merge(const summary_state& Other);
+
+    // Texts, once frozen
+    std::string                 Average;
+    std::string                 Count;
+    std::string                 Count2;
+    std::string                 Percent;
+};
+
+//---------------------------------------------------------------------------
+void CommonStats::summary_state::Merge(const summary_state& Other)
+{
+    // Moments of the 2 parts (Chan et al.)
+    const summary& Part=Other.Summary;
+    if (Part.Frames)
+    {
+        if (!Summary.Frames || Summary.Min>Part.Min)
+            Summary.Min=Part.Min;
+        if (!Summary.Frames || Summary.Max<Part.Max)
+            Summary.Max=Part.Max;
+        double Frames=(double)Summary.Frames+Part.Frames;
+        double Delta=Part.Mean-Summary.Mean;
+        Summary.Mean+=Delta*Part.Frames/Frames;
+        M2+=Other.M2+Delta*Delta*Summary.Frames*Part.Frames/Frames;
+        Summary.Frames+=Part.Frames;
+    }
+    Sketch.Merge(Other.Sketch);
+}
+
 //***************************************************************************
 // Constructor / Destructor
 //***************************************************************************
 
 //---------------------------------------------------------------------------
-CommonStats::CommonStats (const struct per_item* PerItem_, int Type_, size_t CountOfGroups_, size_t CountOfItems_, size_t FrameCount, double Duration, QAVStream* stream)
+// Count of frames from the duration and the frame rate of the stream (audio: samples per frame), 0 if unknown
+static uint64_t FrameCount_FromDuration(double Duration, QAVStream* stream)
+{
+    if (!stream || !(Duration>0))
+        return 0;
+
+    const AVStream* Stream=stream->stream();
+    double Rate=0;
+    if (Stream->codecpar->codec_type==AVMEDIA_TYPE_AUDIO)
+    {
+        if (Stream->codecpar->frame_size>0)
+            Rate=((double)Stream->codecpar->sample_rate)/Stream->codecpar->frame_size;
+    }
+    else if (Stream->avg_frame_rate.num>0 && Stream->avg_frame_rate.den>0)
+        Rate=av_q2d(Stream->avg_frame_rate);
+    else if (Stream->r_frame_rate.num>0 && Stream->r_frame_rate.den>0)
+        Rate=av_q2d(Stream->r_frame_rate);
+    return Rate>0?(uint64_t)std::ceil(Duration*Rate):0;
+}
+
+//---------------------------------------------------------------------------
+CommonStats::CommonStats (const struct per_item* PerItem_, int Type_, size_t CountOfGroups_, size_t CountOfItems_, uint64_t FrameCount, double Duration, QAVStream* stream)
     :
     Frequency(stream ? (((double)stream->stream()->time_base.den) / stream->stream()->time_base.num) : 0),
     streamIndex(stream ? stream->stream()->index : -1),
+    Sampling(0),
     Type(Type_),
     PerItem(PerItem_),
     CountOfGroups(CountOfGroups_),
     CountOfItems(CountOfItems_),
-    additionalIntStats(nullptr),
-    additionalDoubleStats(nullptr),
-    additionalStringStats(nullptr)
+    ItemsIndex(Type_==Type_Audio ? StatsKeyIndex::Audio() : StatsKeyIndex::Video())
 {
 
     int sizeOfLastStatsIndex = sizeof lastStatsIndexByValueType;
@@ -52,17 +204,20 @@ CommonStats::CommonStats (const struct per_item* PerItem_, int Type_, size_t Cou
     IsComplete=false;
     FirstTimeStamp=DBL_MAX;
 
-    // Memory management
-    if (FrameCount<10*3600*30)
-    {
-        Data_Reserved=1;
-        while (Data_Reserved<FrameCount)
-            Data_Reserved<<=1;
-        if (Data_Reserved+128>=FrameCount)
-            Data_Reserved<<=1;
-    }
+    // Expected count of frames, the one of the container is not reliable if far above the one from the duration (e.g. it is the count of samples)
+    uint64_t FrameCount_Duration=FrameCount_FromDuration(Duration, stream);
+    uint64_t FrameCount_Expected=FrameCount;
+    if (FrameCount_Duration && (!FrameCount || FrameCount>FrameCount_Duration*4))
+        FrameCount_Expected=FrameCount_Duration;
+
+    // Memory management, growth is cheap (chunks, values are not moved) so only the expected count of frames is reserved,
+    // up to a limit as the chunks are allocated now
+    static const uint64_t Data_Reserved_Max=(uint64_t)1<<20;
+    if (!FrameCount_Expected)
+        Data_Reserved=1<<16; // Unknown, reserving only a default count of frames
     else
-        Data_Reserved=1<<16; //Frame count is not reliable (too huge, e.g. it is sample count instead of frame count), reserving only a default count of frames.
+        Data_Reserved=(size_t)std::min(FrameCount_Expected+128, Data_Reserved_Max);
+    Data_Reserved=((Data_Reserved+StatsColumn<double>::Chunk_Mask)>>StatsColumn<double>::Chunk_Shift)<<StatsColumn<double>::Chunk_Shift;
 
     // Data - Counts
     Stats_Totals = new double[CountOfItems];
@@ -73,47 +228,36 @@ CommonStats::CommonStats (const struct per_item* PerItem_, int Type_, size_t Cou
     memset(Stats_Counts2, 0x00, CountOfItems*sizeof(uint64_t));
 
     // Data - x and y
-    x = new double*[4];
+    x = new StatsColumn<double>[4];
     for (size_t j=0; j<4; ++j)
-    {
-        x[j]=new double[Data_Reserved];
-        memset(x[j], 0x00, Data_Reserved*sizeof(double));
-    }
-    y = new double*[CountOfItems];
+        x[j].Reserve(Data_Reserved);
+    y = new StatsValueColumn[CountOfItems]; // Chunks allocated on the first write, the items of the filters not run use no memory
     for (size_t j=0; j<CountOfItems; ++j)
     {
-        y[j]=new double[Data_Reserved];
-        memset(y[j], 0x00, Data_Reserved*sizeof(double));
+        if (CompactStorage)
+            y[j].SetStorage(CompactStorage_ForItem(PerItem[j]));
+        y[j].Reserve(Data_Reserved);
     }
+    y_Pyramids = new StatsPyramid[CountOfItems];
+    y_Ranges = new StatsRangeIndex[CountOfItems];
+    Summaries = new summary_state[CountOfItems];
+    Summaries_x=0;
+    Summaries_Kept=0;
+    Summaries_Frozen=false;
+    Detectors=StatsDetectors::Create(PerItem, CountOfItems, ItemsIndex);
 
     // Data - Extra
-    durations=new double[Data_Reserved];
-    memset(durations, 0x00, Data_Reserved*sizeof(double));
-
-    key_frames=new bool[Data_Reserved];
-    memset(key_frames, 0x00, Data_Reserved*sizeof(bool));
-
-    pkt_pos = new int64_t[Data_Reserved];
-    memset(pkt_pos, 0x00, Data_Reserved * sizeof(int64_t));
-
-    pkt_pts = new int64_t[Data_Reserved];
-    memset(pkt_pts, 0x00, Data_Reserved * sizeof(int64_t));
-
-    pkt_size = new int[Data_Reserved];
-    memset(pkt_size, 0x00, Data_Reserved * sizeof(int));
-
-    pix_fmt = new int[Data_Reserved];
-    memset(pix_fmt, 0x00, Data_Reserved * sizeof(int));
-
-    pict_type_char = new char[Data_Reserved];
-    memset(pict_type_char, 0x00, Data_Reserved * sizeof(char));
-
-    comments = new char*[Data_Reserved];
-    memset(comments, 0x00, Data_Reserved * sizeof(char*));
+    durations.Reserve(Data_Reserved);
+    key_frames.Reserve(Data_Reserved);
+    pkt_pos.Reserve(Data_Reserved);
+    pkt_pts.Reserve(Data_Reserved);
+    pkt_size.Reserve(Data_Reserved);
+    pict_type_char.Reserve(Data_Reserved);
 
     // Data - Maximums
     x_Current=0;
-    x_Current_Max=FrameCount;
+    x_Published=0;
+    x_Current_Max=(size_t)FrameCount_Expected;
     x_Max[0]=x_Current_Max;
     x_Max[1]=Duration;
     x_Max[2]=x_Max[1]/60;
@@ -136,56 +280,55 @@ CommonStats::~CommonStats()
     delete[] Stats_Counts2;
 
     // Data - x and y
-    for (size_t j=0; j<4; ++j)
-        delete[] x[j];
     delete[] x;
-
-    // Data - Extra
-    for (size_t j=0; j<CountOfItems; ++j)
-        delete[] y[j];
     delete[] y;
+    delete[] y_Pyramids;
+    delete[] y_Ranges;
+    delete[] Summaries;
 
     // Data - Maximums
-    delete[] durations;
-    delete[] key_frames;
     delete[] y_Min;
     delete[] y_Max;
 
-    delete[] pkt_pos;
-    delete[] pkt_pts;
-    delete[] pkt_size;
-    delete[] pix_fmt;
-    delete[] pict_type_char;
-
-    for (size_t j = 0; j < Data_Reserved; ++j)
-        free(comments[j]);
-
-    delete[] comments;
+}
 
-    auto numberOfIntValues = lastStatsIndexByValueType[StatsValueInfo::Int];
+static_assert((int)Additional_Int==(int)CommonStats::StatsValueInfo::Int && (int)Additional_Double==(int)CommonStats::StatsValueInfo::Double && (int)Additional_String==(int)CommonStats::StatsValueInfo::String, "additional_type is a StatsValueInfo::Type");
 
-    for (size_t j = 0; j < numberOfIntValues; ++j) {
-        delete[] additionalIntStats[j];
-    }
-    delete[] additionalIntStats;
+// Values which can not be parsed are 0, as the frames without the key
+static int AdditionalValue_Int(const char* Value)
+{
+    return Number_ToInt(Value);
+}
 
-    auto numberOfDoubleValues = lastStatsIndexByValueType[StatsValueInfo::Double];
+static double AdditionalValue_Double(const char* Value)
+{
+    return Number_ToDouble(Value);
+}
 
-    for (size_t j = 0; j < numberOfDoubleValues; ++j) {
-        delete[] additionalDoubleStats[j];
-    }
-    delete[] additionalDoubleStats;
+void CommonStats::AdditionalStats_Declare(const activefilters& Filters)
+{
+    for (auto Item=PerStreamType[Type].AdditionalItems; Item && Item->FFmpeg_Name; ++Item)
+        if (Filters[Item->Filter])
+            AdditionalStats_Declare(Item->FFmpeg_Name, Item->Type);
+}
 
-    auto numberOfStringValues = lastStatsIndexByValueType[StatsValueInfo::String];
+void CommonStats::AdditionalStats_Declare(const char* Key, additional_type Type_)
+{
+    // Lock data
+    QMutexLocker Lock(&Mutex);
 
-    for (size_t j = 0; j < numberOfStringValues; ++j) {
-        for(size_t i = 0; i < Data_Reserved; ++i) {
-            free(additionalStringStats[j][i]);
-        }
+    if (statsValueInfoByKeys.Find(Key)!=StatsKeyIndex::NotFound)
+        return;
 
-        delete[] additionalStringStats[j];
-    }
-    delete[] additionalStringStats;
+    auto type = (StatsValueInfo::Type)Type_;
+    auto oldSize = lastStatsIndexByValueType[type];
+    auto stats = StatsValueInfo {
+        lastStatsIndexByValueType[type]++, type, std::string()
+    };
+    statsValueInfoByKeys.Insert(Key, statsValueInfos.size());
+    statsValueInfos.push_back(stats);
+    statsKeysByIndexByValueType[type][stats.index] = Key;
+    updateAdditionalStats(type, oldSize, lastStatsIndexByValueType[type]);
 }
 
 void CommonStats::processAdditionalStats(const char* key, const char* value, bool statsMapInitialized)
@@ -196,123 +339,111 @@ void CommonStats::processAdditionalStats(const char* key, const char* value, boo
     // Lock data
     QMutexLocker Lock(&Mutex);
 
-    if(!statsMapInitialized) {
-        auto type = StatsValueInfo::typeFromKey(key, value);
-        auto stats = StatsValueInfo {
-            lastStatsIndexByValueType[type]++, type, value
-        };
-        statsValueInfoByKeys[key] = stats;
-        statsKeysByIndexByValueType[type][stats.index] = key;
-    } else if(statsValueInfoByKeys.find(key)==statsValueInfoByKeys.end()) {
+    size_t infoPos = statsValueInfoByKeys.Find(key);
+
+    if(infoPos == StatsKeyIndex::NotFound) {
         auto type = StatsValueInfo::typeFromKey(key, value);
         auto oldSize = lastStatsIndexByValueType[type];
 
         auto stats = StatsValueInfo {
             lastStatsIndexByValueType[type]++, type, value
         };
-        statsValueInfoByKeys[key] = stats;
+        infoPos = statsValueInfos.size();
+        statsValueInfoByKeys.Insert(key, infoPos);
+        statsValueInfos.push_back(stats);
         statsKeysByIndexByValueType[type][stats.index] = key;
 
+        // First frame: the columns are created with the values by initializeAdditionalStats()
+        if(!statsMapInitialized)
+            return;
+
+        // Key appearing later on, its column is created and the value of this frame kept
         auto size = lastStatsIndexByValueType[type];
         updateAdditionalStats(type, oldSize, size);
+    } else if(!statsMapInitialized) {
+        return; // Same key twice in the first frame, the first value is kept
+    }
+
+    const auto& stats = statsValueInfos[infoPos];
+    if(stats.type == StatsValueInfo::Int) {
+        additionalIntStats[stats.index][x_Current] = AdditionalValue_Int(value);
+    } else if(stats.type == StatsValueInfo::Double) {
+        additionalDoubleStats[stats.index][x_Current] = AdditionalValue_Double(value);
     } else {
-        auto stats = statsValueInfoByKeys[key];
-        if(stats.type == StatsValueInfo::Int) {
-            additionalIntStats[stats.index][x_Current] = std::stoi(value);
-        } else if(stats.type == StatsValueInfo::Double) {
-            additionalDoubleStats[stats.index][x_Current] = std::stod(value);
-        } else {
-            additionalStringStats[stats.index][x_Current] = strdup(value);
-        }
-        statsKeysByIndexByValueType[stats.type][stats.index] = key;
+        additionalStringStats[stats.index][x_Current] = Strings.Add(value);
     }
 }
 
-void CommonStats::writeAdditionalStats(std::stringstream &stream, size_t index)
+//---------------------------------------------------------------------------
+std::vector<CommonStats::xml_column> CommonStats::XmlAdditionalColumns()
 {
     // Lock data
     QMutexLocker Lock(&Mutex);
 
-    if(additionalIntStats) {
-        for(size_t i = 0; i < statsKeysByIndexByValueType[StatsValueInfo::Int].size(); ++i) {
-            auto key = statsKeysByIndexByValueType[StatsValueInfo::Int][i];
-            auto value = additionalIntStats[i][index];
+    // Keys are indexed from 0, in the order of the columns
+    const bool HasColumns[3]={!additionalIntStats.empty(), !additionalDoubleStats.empty(), !additionalStringStats.empty()};
+    std::vector<xml_column> Columns;
+    for (auto Type : {StatsValueInfo::Int, StatsValueInfo::Double, StatsValueInfo::String})
+        for(const auto& key : statsKeysByIndexByValueType[Type])
+            if (HasColumns[Type])
+                Columns.push_back({(size_t)key.first, Type, 0, StatsXmlWriter::TagPrefix(key.second.c_str())});
+    return Columns;
+}
 
-            stream<<"            <tag key=\"" << key << "\" value=\"" << value << "\"/>\n";
-        }
-    }
+//---------------------------------------------------------------------------
+void CommonStats::writeAdditionalStats(StatsXmlWriter& Writer, const std::vector<xml_column>& Columns, size_t index)
+{
+    if(Columns.empty())
+        return;
 
-    if(additionalDoubleStats) {
-        for(size_t i = 0; i < statsKeysByIndexByValueType[StatsValueInfo::Double].size(); ++i) {
-            auto key = statsKeysByIndexByValueType[StatsValueInfo::Double][i];
-            auto value = additionalDoubleStats[i][index];
+    // Lock data, columns may be added while parsing
+    QMutexLocker Lock(&Mutex);
 
-            stream<<"            <tag key=\"" << key << "\" value=\"" << std::to_string(value) << "\"/>\n";
+    for(const auto& Column : Columns) {
+        switch(Column.Type) {
+        case StatsValueInfo::Int:
+            Writer.Tag(Column.Prefix, additionalIntStats[Column.Index][index]);
+            break;
+        case StatsValueInfo::Double:
+            Writer.Tag(Column.Prefix, additionalDoubleStats[Column.Index][index]);
+            break;
+        case StatsValueInfo::String: {
+            auto value = additionalStringStats[Column.Index][index];
+            Writer.Tag(Column.Prefix, value != nullptr ? value : "N/A");
+            break;
         }
-    }
-
-    if(additionalStringStats) {
-        for(size_t i = 0; i < statsKeysByIndexByValueType[StatsValueInfo::String].size(); ++i) {
-            auto key = statsKeysByIndexByValueType[StatsValueInfo::String][i];
-            auto value = additionalStringStats[i][index];
-
-            stream<<"            <tag key=\"" << key << "\" value=\"" << (value != nullptr ? value : "N/A") << "\"/>\n";
         }
     }
 }
 
 void CommonStats::updateAdditionalStats(StatsValueInfo::Type type, size_t oldSize, size_t size)
 {
-    // Lock data
-    QMutexLocker Lock(&Mutex);
+    // Mutex is locked by the caller (processAdditionalStats, AdditionalStats_Declare)
 
+    // Existing columns are kept as is, only the new ones are created
     if (type==StatsValueInfo::Int)
     {
-        auto additionalIntStats_Old = additionalIntStats;
-        additionalIntStats = new int*[size];
-        for (size_t j = 0; j < size; ++j)
+        for (size_t j = oldSize; j < size; ++j)
         {
-            additionalIntStats[j] = new int[Data_Reserved];
-            memset(&additionalIntStats[j][0], 0x00, Data_Reserved * sizeof(int));
-            if (size < oldSize)
-            {
-                memcpy(additionalIntStats[j], additionalIntStats_Old[j], Data_Reserved * sizeof(int));
-                delete[] additionalIntStats_Old[j];
-            }
+            additionalIntStats.emplace_back();
+            additionalIntStats.back().Reserve(Data_Reserved);
         }
-        delete[] additionalIntStats_Old;
     }
     else if (type==StatsValueInfo::Double)
     {
-        auto additionalDoubleStats_Old = additionalDoubleStats;
-        additionalDoubleStats = new double*[size];
-        for (size_t j = 0; j < size; ++j)
+        for (size_t j = oldSize; j < size; ++j)
         {
-            additionalDoubleStats[j] = new double[Data_Reserved];
-            memset(&additionalDoubleStats[j][0], 0x00, Data_Reserved * sizeof(double));
-            if (size < oldSize)
-            {
-                memcpy(additionalDoubleStats[j], additionalDoubleStats_Old[j], Data_Reserved * sizeof(double));
-                delete[] additionalDoubleStats_Old[j];
-            }
+            additionalDoubleStats.emplace_back();
+            additionalDoubleStats.back().Reserve(Data_Reserved);
         }
-        delete[] additionalDoubleStats_Old;
     }
     else if (type==StatsValueInfo::String)
     {
-        auto additionalStringStats_Old = additionalStringStats;
-        additionalStringStats = new char**[size];
-        for (size_t j = 0; j < size; ++j)
+        for (size_t j = oldSize; j < size; ++j)
         {
-            additionalStringStats[j] = new char*[Data_Reserved];
-            memset(&additionalStringStats[j][0], 0x00, Data_Reserved * sizeof(char*));
-            if (size < oldSize)
-            {
-                memcpy(additionalStringStats[j], additionalStringStats_Old[j], Data_Reserved * sizeof(char*));
-                delete[] additionalStringStats_Old[j];
-            }
+            additionalStringStats.emplace_back();
+            additionalStringStats.back().Reserve(Data_Reserved);
         }
-        delete[] additionalStringStats_Old;
     }
 }
 
@@ -322,39 +453,178 @@ void CommonStats::initializeAdditionalStats()
     QMutexLocker Lock(&Mutex);
 
     auto numberOfIntValues = lastStatsIndexByValueType[StatsValueInfo::Int];
-    if(numberOfIntValues != 0) {
-        additionalIntStats = new int*[numberOfIntValues];
-        for(size_t i = 0; i < numberOfIntValues; ++i) {
-            additionalIntStats[i] = new int[Data_Reserved];
-        }
+    for(size_t i = 0; i < numberOfIntValues; ++i) {
+        additionalIntStats.emplace_back();
+        additionalIntStats.back().Reserve(Data_Reserved);
     }
     auto numberOfDoubleValues = lastStatsIndexByValueType[StatsValueInfo::Double];
-    if(numberOfDoubleValues != 0) {
-        additionalDoubleStats = new double*[numberOfDoubleValues];
-        for(size_t i = 0; i < numberOfDoubleValues; ++i) {
-            additionalDoubleStats[i] = new double[Data_Reserved];
-        }
+    for(size_t i = 0; i < numberOfDoubleValues; ++i) {
+        additionalDoubleStats.emplace_back();
+        additionalDoubleStats.back().Reserve(Data_Reserved);
     }
     auto numberOfStringValues = lastStatsIndexByValueType[StatsValueInfo::String];
-    if(numberOfStringValues != 0) {
-        additionalStringStats = new char**[numberOfStringValues];
-        for(size_t i = 0; i < numberOfStringValues; ++i) {
-            additionalStringStats[i] = new char*[Data_Reserved];
-            memset(additionalStringStats[i], 0, sizeof(char*) * Data_Reserved);
-        }
+    for(size_t i = 0; i < numberOfStringValues; ++i) {
+        additionalStringStats.emplace_back();
+        additionalStringStats.back().Reserve(Data_Reserved);
     }
 
-    for(auto entry : statsValueInfoByKeys) {
-        auto& stats = entry.second;
+    for(const auto& stats : statsValueInfos) {
         if(stats.type == StatsValueInfo::Int) {
-            additionalIntStats[stats.index][x_Current] = std::stoi(stats.initialValue);
+            additionalIntStats[stats.index][x_Current] = AdditionalValue_Int(stats.initialValue.c_str());
         } else if(stats.type == StatsValueInfo::Double) {
-            auto doubleValue = std::stod(stats.initialValue);
-            additionalDoubleStats[stats.index][x_Current] = doubleValue;
+            additionalDoubleStats[stats.index][x_Current] = AdditionalValue_Double(stats.initialValue.c_str());
         } else {
-            additionalStringStats[stats.index][x_Current] = strdup(stats.initialValue.c_str());
+            additionalStringStats[stats.index][x_Current] = Strings.Add(stats.initialValue);
+        }
+    }
+}
+
+void CommonStats::AdditionalStats_Map(const CommonStats& Other, std::vector<size_t> (&Map)[3], bool NewOnly)
+{
+    for (size_t type=0; type<3; type++)
+    {
+        Map[type].assign(Other.lastStatsIndexByValueType[type], (size_t)-1);
+        for (const auto& key : Other.statsKeysByIndexByValueType[type])
+        {
+            size_t infoPos = statsValueInfoByKeys.Find(key.second.c_str());
+            if (infoPos != StatsKeyIndex::NotFound && NewOnly)
+                continue;
+            if (infoPos == StatsKeyIndex::NotFound)
+            {
+                auto oldSize = lastStatsIndexByValueType[type];
+                auto stats = StatsValueInfo {
+                    lastStatsIndexByValueType[type]++, (StatsValueInfo::Type)type, std::string()
+                };
+                infoPos = statsValueInfos.size();
+                statsValueInfoByKeys.Insert(key.second.c_str(), infoPos);
+                statsValueInfos.push_back(stats);
+                statsKeysByIndexByValueType[type][stats.index] = key.second;
+                updateAdditionalStats((StatsValueInfo::Type)type, oldSize, lastStatsIndexByValueType[type]);
+            }
+
+            // Type is deduced from the first value, a key typed differently in Other is dropped
+            if (statsValueInfos[infoPos].type == type && (size_t)key.first < Map[type].size())
+                Map[type][key.first] = statsValueInfos[infoPos].index;
+        }
+    }
+}
+
+//***************************************************************************
+// Plots
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void CommonStats::y_PlotPositions(size_t Pos, size_t x_Begin, size_t x_End, size_t Buckets, std::vector<uint32_t>& Positions)
+{
+    Item_Require(Pos);
+    StatsPyramid& Pyramid=y_Pyramids[Pos];
+    Pyramid.Update(y[Pos], x_Current_Get());
+    Pyramid.Positions(x_Begin, x_End, Buckets, Positions);
+}
+
+//---------------------------------------------------------------------------
+StatsRangeIndex::range CommonStats::y_Range(size_t Pos, size_t x_Begin, size_t x_End)
+{
+    // Same limits as Stats_Counts and Stats_Counts2
+    double Limit=PerItem[Pos].DefaultLimit;
+    double Limit2=Limit!=DBL_MAX?PerItem[Pos].DefaultLimit2:DBL_MAX;
+
+    Item_Require(Pos);
+    StatsRangeIndex& Index=y_Ranges[Pos];
+    Index.Update(y[Pos], x_Current_Get(), Limit, Limit2);
+    return Index.Get(y[Pos], x_Begin, x_End);
+}
+
+//***************************************************************************
+// Items of a report
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void CommonStats::Item_Require(size_t Pos)
+{
+    if (!Items_IsPending() || Pos>=Items_Sources.size())
+        return;
+
+    QMutexLocker Lock(&Mutex);
+    if (Items_Sources[Pos].Data)
+        Item_Load(Pos);
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Items_Load(size_t Group)
+{
+    if (!Items_IsPending())
+        return;
+
+    QMutexLocker Lock(&Mutex);
+    for (size_t j=0; j<Items_Sources.size(); j++)
+        if (Items_Sources[j].Data && (PerItem[j].Group1==Group || PerItem[j].Group2==Group))
+            Item_Load(j);
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Items_Load()
+{
+    if (!Items_IsPending())
+        return;
+
+    QMutexLocker Lock(&Mutex);
+    for (size_t j=0; j<Items_Sources.size(); j++)
+        if (Items_Sources[j].Data)
+            Item_Load(j);
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Item_Load(size_t j)
+{
+    // Same as StatsFromItem() for all the frames, then the summary of the item is computed again
+    item_source& Source=Items_Sources[j];
+    for (size_t Pos=0; Pos<x_Current; Pos++)
+    {
+        const char* Data=Source.Data+Pos*Source.ElementSize;
+        double Value;
+        if (Source.ElementSize==8)
+            memcpy(&Value, Data, 8);
+        else
+        {
+            float Content;
+            memcpy(&Content, Data, 4);
+            Value=Content;
+        }
+        Value=Item_FromReport(j, Value);
+        y[j][Pos]=Value;
+
+        if (!std::isinf(Value))
+            for (size_t Group : {PerItem[j].Group1, PerItem[j].Group2})
+            {
+                if (Group==CountOfGroups)
+                    continue;
+                if (y_Max[Group]<Value)
+                    y_Max[Group]=Value;
+                if (y_Min[Group]>Value)
+                    y_Min[Group]=Value;
+            }
+
+        Stats_Totals[j]+=Value;
+        if (PerItem[j].DefaultLimit!=DBL_MAX)
+        {
+            if (Value>PerItem[j].DefaultLimit)
+                Stats_Counts[j]++;
+            if (PerItem[j].DefaultLimit2!=DBL_MAX && Value>PerItem[j].DefaultLimit2)
+                Stats_Counts2[j]++;
         }
     }
+    if (x_Current==1)
+        y[j][1]=y[j][0]; // As StatsFinish()
+
+    Summaries[j]=summary_state();
+    Summary_Extend(j, Summaries_Kept, x_Current);
+    std::vector<double> Values;
+    Summary_Freeze(j, Values);
+    Summaries_Averages.clear();
+
+    Source.Data=nullptr;
+    Items_Pending.fetch_sub(1, std::memory_order_release);
 }
 
 //***************************************************************************
@@ -373,13 +643,156 @@ double CommonStats::State_Get()
     if (IsComplete || x_Current_Max==0)
         return 1;
 
-    double Value=((double)x_Current)/x_Current_Max;
+    // Count of key frames is not known, the time is
+    size_t Count=x_Current_Get();
+    double Value;
+    if (Sampling<0 && Count && x_Max[1]>0)
+        Value=x[1][Count-1]/x_Max[1];
+    else
+        Value=((double)Count)/x_Current_Max;
     if (Value>=1)
         Value=0.99; // It is not yet complete, so not 100%
 
     return Value;
 }
 
+//---------------------------------------------------------------------------
+void CommonStats::Sampling_Set(int Every)
+{
+    // Lock data
+    QMutexLocker Lock(&Mutex);
+
+    Sampling=Every>1||Every<0?Every:0;
+    if (Sampling>1 && !x_Current)
+    {
+        x_Current_Max=(x_Current_Max+Sampling-1)/Sampling;
+        x_Max[0]=x_Current_Max;
+    }
+}
+
+//---------------------------------------------------------------------------
+int CommonStats::Sampling_Get() const
+{
+    return Sampling;
+}
+
+//---------------------------------------------------------------------------
+activefilters CommonStats::ReportFilters_Get()
+{
+    // Lock data
+    QMutexLocker Lock(&Mutex);
+
+    // Additional stats are kept by key, whatever the report format
+    activefilters Filters=ReportFilters;
+    for (auto Item=PerStreamType[Type].AdditionalItems; Item && Item->FFmpeg_Name; ++Item)
+        if (statsValueInfoByKeys.Find(Item->FFmpeg_Name)!=StatsKeyIndex::NotFound)
+            Filters.set(Item->Filter);
+    return Filters;
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Comment_Set(size_t Pos, const char* Comment)
+{
+    comments.Set(Pos, Comment && *Comment?Strings.Add(Comment):nullptr);
+}
+
+//---------------------------------------------------------------------------
+size_t CommonStats::Bytes()
+{
+    QMutexLocker Lock(&Mutex);
+
+    size_t Result=0;
+    for (size_t j=0; j<4; j++)
+        Result+=x[j].Bytes();
+    for (size_t j=0; j<CountOfItems; j++)
+        Result+=y[j].Bytes();
+    Result+=durations.Bytes()+pkt_pos.Bytes()+pkt_pts.Bytes()+pkt_size.Bytes()+pix_fmt.Bytes()+pict_type_char.Bytes()+key_frames.Bytes()+comments.Bytes();
+    for (const auto& Column : additionalIntStats)
+        Result+=Column.Bytes();
+    for (const auto& Column : additionalDoubleStats)
+        Result+=Column.Bytes();
+    for (const auto& Column : additionalStringStats)
+        Result+=Column.Bytes();
+    Result+=Strings.Bytes();
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Compress()
+{
+    QMutexLocker Lock(&Mutex);
+
+    for (size_t j=0; j<CountOfItems; j++)
+        y[j].Compress(x_Current);
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Items_Restrict(const std::vector<bool>& Used)
+{
+    QMutexLocker Lock(&Mutex);
+
+    Items_Used=Used;
+    for (size_t j=0; j<CountOfItems && j<Used.size(); j++)
+        if (!Used[j])
+            y[j].Drop();
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::StatsFromPacket(const packet& Packet)
+{
+    if (Frequency==0)
+        return; // Not supported
+
+    if (x_Current>=Data_Reserved)
+        Data_Reserve(x_Current+1);
+
+    // Same time stamps as from the frame, see TimeStampFromFrame()
+    x[0][x_Current]=x_Current;
+    int64_t ts=Packet.Pts;
+    if (ts==AV_NOPTS_VALUE && x_Current)
+        ts=(int64_t)((FirstTimeStamp+x[1][x_Current-1]+durations[x_Current-1])*Frequency); // If time stamp is not present, creating a fake one from last frame duration
+    if (ts!=AV_NOPTS_VALUE)
+    {
+        if (FirstTimeStamp==DBL_MAX)
+            FirstTimeStamp=ts/Frequency;
+        x[1][x_Current]=((double)ts)/Frequency;
+        if (x[1][x_Current]<FirstTimeStamp)
+        {
+            double Difference=FirstTimeStamp-x[1][x_Current];
+            for (size_t Pos=0; Pos<x_Current; Pos++)
+            {
+                x[1][Pos]+=Difference;
+                x[2][Pos]=x[1][Pos]/60;
+                x[3][Pos]=x[2][Pos]/60;
+            }
+            FirstTimeStamp=x[1][x_Current];
+        }
+        x[1][x_Current]-=FirstTimeStamp;
+        x[2][x_Current]=x[1][x_Current]/60;
+        x[3][x_Current]=x[2][x_Current]/60;
+    }
+    durations[x_Current]=Packet.Duration>0?((double)Packet.Duration)/Frequency:0;
+
+    key_frames.Set(x_Current, Packet.KeyFrame);
+    pkt_pos[x_Current]=Packet.Pos;
+    pkt_size[x_Current]=Packet.Size;
+    pkt_pts[x_Current]=Packet.Pts;
+    StatsFromPacket_Items(Packet);
+
+    if (x_Max[0]<=x[0][x_Current])
+    {
+        x_Max[0]=x[0][x_Current];
+        x_Max[1]=x[1][x_Current];
+        x_Max[2]=x[2][x_Current];
+        x_Max[3]=x[3][x_Current];
+    }
+    Detectors_Run();
+    x_Current++;
+    x_Current_Publish();
+    if (x_Current_Max<=x_Current)
+        x_Current_Max=x_Current;
+}
+
 //---------------------------------------------------------------------------
 void CommonStats::StatsFinish ()
 {
@@ -411,6 +824,229 @@ void CommonStats::StatsFinish ()
 
     x_Current_Max=x_Current;
     IsComplete=true;
+
+    // Summaries
+    Summaries_Extend(x_Current);
+    Summaries_Freeze();
+    Shots_Extend(x_Current);
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Append(CommonStats& Segment, size_t First, size_t Last)
+{
+    // Lock data
+    QMutexLocker Lock(&Mutex);
+    QMutexLocker Segment_Lock(&Segment.Mutex);
+
+    // Summaries are extended with these frames and frozen again by StatsFinish()
+    Summaries_Frozen=false;
+
+    if (Last>Segment.x_Current)
+        Last=Segment.x_Current;
+
+    // Summaries of a whole segment are merged instead of extended with its frames
+    bool Summaries_Merge=!First && Last==Segment.x_Current && Summaries_x==x_Current && Segment.Summaries_x==Segment.x_Current && !Window;
+
+    // Nothing parsed here yet, e.g. stats built from parts of other ones
+    if (!x_Current && streamIndex==-1)
+    {
+        streamIndex=Segment.streamIndex;
+        Frequency=Segment.Frequency;
+    }
+
+    // Additional stats of the segment are mapped by key
+    std::vector<size_t> AdditionalMap[3];
+    AdditionalStats_Map(Segment, AdditionalMap);
+
+    for (size_t Pos=First; Pos<Last; Pos++)
+    {
+        if (x_Current>=Data_Reserved)
+            Data_Reserve(x_Current);
+
+        // Time stamps are relative to the first frame of each part
+        x[0][x_Current]=x_Current;
+        if (Segment.FirstTimeStamp!=DBL_MAX)
+        {
+            double TimeStamp=Segment.x[1][Pos]+Segment.FirstTimeStamp;
+            if (FirstTimeStamp==DBL_MAX)
+                FirstTimeStamp=TimeStamp;
+            x[1][x_Current]=TimeStamp-FirstTimeStamp;
+            x[2][x_Current]=x[1][x_Current]/60;
+            x[3][x_Current]=x[2][x_Current]/60;
+        }
+
+        for (size_t j=0; j<CountOfItems; ++j)
+            if (Segment.y[j].IsAllocated()) // Items of the filters not run stay not allocated
+                y[j][x_Current]=(double)Segment.y[j][Pos];
+
+        durations[x_Current]=Segment.durations[Pos];
+        key_frames.Set(x_Current, Segment.key_frames[Pos]);
+        pkt_pos[x_Current]=Segment.pkt_pos[Pos];
+        pkt_pts[x_Current]=Segment.pkt_pts[Pos];
+        pkt_size[x_Current]=Segment.pkt_size[Pos];
+        pix_fmt.Set(x_Current, Segment.pix_fmt[Pos]);
+        pict_type_char.Set(x_Current, Segment.pict_type_char[Pos]);
+        if (auto Comment=Segment.comments[Pos])
+            comments.Set(x_Current, Strings.Add(Comment));
+
+        for (size_t i=0; i<AdditionalMap[StatsValueInfo::Int].size() && i<Segment.additionalIntStats.size(); i++)
+            if (AdditionalMap[StatsValueInfo::Int][i]!=(size_t)-1)
+                additionalIntStats[AdditionalMap[StatsValueInfo::Int][i]][x_Current]=Segment.additionalIntStats[i][Pos];
+        for (size_t i=0; i<AdditionalMap[StatsValueInfo::Double].size() && i<Segment.additionalDoubleStats.size(); i++)
+            if (AdditionalMap[StatsValueInfo::Double][i]!=(size_t)-1)
+                additionalDoubleStats[AdditionalMap[StatsValueInfo::Double][i]][x_Current]=Segment.additionalDoubleStats[i][Pos];
+        for (size_t i=0; i<AdditionalMap[StatsValueInfo::String].size() && i<Segment.additionalStringStats.size(); i++)
+            if (AdditionalMap[StatsValueInfo::String][i]!=(size_t)-1 && Segment.additionalStringStats[i][Pos])
+                additionalStringStats[AdditionalMap[StatsValueInfo::String][i]][x_Current]=Strings.Add(Segment.additionalStringStats[i][Pos]);
+
+        x_Current++;
+        x_Current_Publish();
+    }
+
+    if (Summaries_Merge)
+    {
+        for (size_t j=0; j<CountOfItems; ++j)
+            Summaries[j].Merge(Segment.Summaries[j]);
+        Summaries_x=x_Current;
+    }
+
+    // Totals and extremes, as if the frames were parsed here
+    if (!First && Last==Segment.x_Current)
+    {
+        for (size_t j=0; j<CountOfItems; ++j)
+        {
+            Stats_Totals[j]+=Segment.Stats_Totals[j];
+            Stats_Counts[j]+=Segment.Stats_Counts[j];
+            Stats_Counts2[j]+=Segment.Stats_Counts2[j];
+        }
+        for (size_t j=0; j<CountOfGroups; ++j)
+        {
+            if (y_Min[j]>Segment.y_Min[j])
+                y_Min[j]=Segment.y_Min[j];
+            if (y_Max[j]<Segment.y_Max[j])
+                y_Max[j]=Segment.y_Max[j];
+        }
+    }
+    else
+    {
+        // Same as StatsFromItem() for the frames appended only
+        for (size_t j=0; j<CountOfItems; ++j)
+            for (size_t Pos=First; Pos<Last; Pos++)
+            {
+                double Value=Segment.y[j][Pos];
+                if (!std::isinf(Value))
+                    for (size_t Group : {PerItem[j].Group1, PerItem[j].Group2})
+                    {
+                        if (Group==CountOfGroups)
+                            continue;
+                        if (y_Max[Group]<Value)
+                            y_Max[Group]=Value;
+                        if (y_Min[Group]>Value)
+                            y_Min[Group]=Value;
+                    }
+
+                Stats_Totals[j]+=Value;
+                if (PerItem[j].DefaultLimit!=DBL_MAX)
+                {
+                    if (Value>PerItem[j].DefaultLimit)
+                        Stats_Counts[j]++;
+                    if (PerItem[j].DefaultLimit2!=DBL_MAX && Value>PerItem[j].DefaultLimit2)
+                        Stats_Counts2[j]++;
+                }
+            }
+    }
+    if (x_Current && x_Max[0]<=x[0][x_Current-1])
+    {
+        x_Max[0]=x[0][x_Current-1];
+        x_Max[1]=x[1][x_Current-1];
+        x_Max[2]=x[2][x_Current-1];
+        x_Max[3]=x[3][x_Current-1];
+    }
+    if (x_Current_Max<=x_Current)
+        x_Current_Max=x_Current;
+    Shots_Extend(x_Current);
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Merge(CommonStats& Other, const activefilters& Filters)
+{
+    // Lock data
+    QMutexLocker Lock(&Mutex);
+    QMutexLocker Other_Lock(&Other.Mutex);
+
+    size_t Count=std::min(x_Current, Other.x_Current);
+
+    // Same as Item_Load() with the values of Other
+    std::vector<double> Values;
+    for (size_t j=0; j<CountOfItems; ++j)
+    {
+        const activefilter filter=PerItem[j].Filter;
+        if (filter==activefilter(-1) || !Filters.test(filter) || (j<Items_Sources.size() && Items_Sources[j].Data))
+            continue;
+
+        Stats_Totals[j]=0;
+        Stats_Counts[j]=0;
+        Stats_Counts2[j]=0;
+        for (size_t Pos=Summaries_Kept; Pos<x_Current; Pos++)
+        {
+            double Value=Pos<Count?(double)Other.y[j][Pos]:0;
+            y[j][Pos]=Value;
+
+            if (!std::isinf(Value))
+                for (size_t Group : {PerItem[j].Group1, PerItem[j].Group2})
+                {
+                    if (Group==CountOfGroups)
+                        continue;
+                    if (y_Max[Group]<Value)
+                        y_Max[Group]=Value;
+                    if (y_Min[Group]>Value)
+                        y_Min[Group]=Value;
+                }
+
+            Stats_Totals[j]+=Value;
+            if (PerItem[j].DefaultLimit!=DBL_MAX)
+            {
+                if (Value>PerItem[j].DefaultLimit)
+                    Stats_Counts[j]++;
+                if (PerItem[j].DefaultLimit2!=DBL_MAX && Value>PerItem[j].DefaultLimit2)
+                    Stats_Counts2[j]++;
+            }
+        }
+        if (x_Current==1)
+            y[j][1]=y[j][0]; // As StatsFinish()
+
+        y_Pyramids[j].Clear();
+        y_Ranges[j].Clear();
+        Summaries[j]=summary_state();
+        Summary_Extend(j, Summaries_Kept, Summaries_x);
+        if (Summaries_Frozen)
+            Summary_Freeze(j, Values);
+    }
+    Summaries_Averages.clear();
+    ReportFilters|=Filters;
+
+    // Differences of the frames may be new
+    if (!Summaries_Kept)
+    {
+        shots.Clear();
+        Shots_Extend(x_Current);
+    }
+
+    // New keys only, the values already here are the ones of the report
+    std::vector<size_t> AdditionalMap[3];
+    AdditionalStats_Map(Other, AdditionalMap, true);
+    for (size_t Pos=Summaries_Kept; Pos<Count; Pos++)
+    {
+        for (size_t i=0; i<AdditionalMap[StatsValueInfo::Int].size() && i<Other.additionalIntStats.size(); i++)
+            if (AdditionalMap[StatsValueInfo::Int][i]!=(size_t)-1)
+                additionalIntStats[AdditionalMap[StatsValueInfo::Int][i]][Pos]=Other.additionalIntStats[i][Pos];
+        for (size_t i=0; i<AdditionalMap[StatsValueInfo::Double].size() && i<Other.additionalDoubleStats.size(); i++)
+            if (AdditionalMap[StatsValueInfo::Double][i]!=(size_t)-1)
+                additionalDoubleStats[AdditionalMap[StatsValueInfo::Double][i]][Pos]=Other.additionalDoubleStats[i][Pos];
+        for (size_t i=0; i<AdditionalMap[StatsValueInfo::String].size() && i<Other.additionalStringStats.size(); i++)
+            if (AdditionalMap[StatsValueInfo::String][i]!=(size_t)-1 && Other.additionalStringStats[i][Pos])
+                additionalStringStats[AdditionalMap[StatsValueInfo::String][i]][Pos]=Strings.Add(Other.additionalStringStats[i][Pos]);
+    }
 }
 
 //***************************************************************************
@@ -420,11 +1056,20 @@ void CommonStats::StatsFinish ()
 //---------------------------------------------------------------------------
 std::string CommonStats::Average_Get(size_t Pos)
 {
-    if (x_Current == 0 || Pos >= CountOfItems) {
+    Item_Require(Pos);
+    if (Pos < CountOfItems && Summaries_Frozen)
+    {
+        QMutexLocker Lock(&Mutex);
+        if (Summaries_Frozen)
+            return Summaries[Pos].Average;
+    }
+
+    size_t Count = x_Current_Get();
+    if (Count == 0 || Pos >= CountOfItems) {
         return std::string();
     }
 
-    double Value = Stats_Totals[Pos] / x_Current;
+    double Value = Stats_Totals[Pos] / Count;
     std::stringstream str;
     str << std::fixed;
     str << std::setprecision(PerItem[Pos].DigitsAfterComma);
@@ -435,22 +1080,44 @@ std::string CommonStats::Average_Get(size_t Pos)
 //---------------------------------------------------------------------------
 std::string CommonStats::Average_Get(size_t Pos, size_t Pos2)
 {
-    if (x_Current == 0 || Pos >= CountOfItems) {
+    Item_Require(Pos);
+    Item_Require(Pos2);
+    size_t Count = x_Current_Get();
+    if (Count == 0 || Pos >= CountOfItems) {
         return std::string();
     }
 
-    double Value = (Stats_Totals[Pos] - Stats_Totals[Pos2]) / x_Current;
+    QMutexLocker Lock(&Mutex);
+    bool Frozen = Summaries_Frozen;
+    if (Frozen)
+    {
+        auto Cached = Summaries_Averages.find(std::make_pair(Pos, Pos2));
+        if (Cached != Summaries_Averages.end())
+            return Cached->second;
+    }
+
+    double Value = (Stats_Totals[Pos] - Stats_Totals[Pos2]) / Count;
     std::stringstream str;
     str << std::fixed;
     str << std::setprecision(PerItem[Pos].DigitsAfterComma);
     str << Value;
+    if (Frozen)
+        Summaries_Averages[std::make_pair(Pos, Pos2)] = str.str();
     return str.str();
 }
 
 //---------------------------------------------------------------------------
 std::string CommonStats::Count_Get(size_t Pos)
 {
-    if (x_Current==0)
+    Item_Require(Pos);
+    if (Pos<CountOfItems && Summaries_Frozen)
+    {
+        QMutexLocker Lock(&Mutex);
+        if (Summaries_Frozen)
+            return Summaries[Pos].Count;
+    }
+
+    if (!x_Current_Get())
         return std::string();
 
     std::stringstream str;
@@ -461,7 +1128,15 @@ std::string CommonStats::Count_Get(size_t Pos)
 //---------------------------------------------------------------------------
 std::string CommonStats::Count2_Get(size_t Pos)
 {
-    if (x_Current==0)
+    Item_Require(Pos);
+    if (Pos<CountOfItems && Summaries_Frozen)
+    {
+        QMutexLocker Lock(&Mutex);
+        if (Summaries_Frozen)
+            return Summaries[Pos].Count2;
+    }
+
+    if (!x_Current_Get())
         return std::string();
 
     std::stringstream str;
@@ -472,185 +1147,309 @@ std::string CommonStats::Count2_Get(size_t Pos)
 //---------------------------------------------------------------------------
 std::string CommonStats::Percent_Get(size_t Pos)
 {
-    if (x_Current==0)
+    Item_Require(Pos);
+    if (Pos<CountOfItems && Summaries_Frozen)
+    {
+        QMutexLocker Lock(&Mutex);
+        if (Summaries_Frozen)
+            return Summaries[Pos].Percent;
+    }
+
+    size_t Count=x_Current_Get();
+    if (!Count)
         return std::string();
 
-    double Value=((double)Stats_Counts[Pos])/x_Current;
+    double Value=((double)Stats_Counts[Pos])/Count;
     std::stringstream str;
     str<<Value*100<<"%";
     return str.str();
 }
 
-void CommonStats::statsFromExternalData(const char *Data, size_t Size, const std::function<CommonStats*(int, int)>& statsGetter)
+//---------------------------------------------------------------------------
+CommonStats::summary CommonStats::Summary_Get(size_t Pos)
 {
-    // AudioStats from external data
-    // XML input
-    XMLDocument Document;
-    if (Document.Parse(Data, Size))
-       return;
-
-    auto Root=Document.FirstChildElement("ffprobe:ffprobe");
-    if (Root)
-    {
-        auto Frames=Root->FirstChildElement("frames");
-        if (Frames)
-        {
-            auto Frame=Frames->FirstChildElement();
-            while (Frame)
-            {
-                if (!strcmp(Frame->Value(), "frame"))
-                {
-                    const char* media_type=Frame->Attribute("media_type");
-                    if (media_type)
-                    {
-                        const char* stream_index_value = Frame->Attribute("stream_index");
-                        if(stream_index_value)
-                        {
-                            auto streamIndex = std::stoi(stream_index_value);
-                            CommonStats* stats = nullptr;
-
-                            if(!strcmp(media_type, "video"))
-                            {
-                                stats = statsGetter(Type_Video, streamIndex);
-                            }
-                            else if(!strcmp(media_type, "audio"))
-                            {
-                                stats = statsGetter(Type_Audio, streamIndex);
-                            }
-
-                            stats->parseFrame(Frame);
-                        }
-                    }
-                }
+    Item_Require(Pos);
+    QMutexLocker Lock(&Mutex);
 
-                Frame=Frame->NextSiblingElement();
-            }
-        }
-    }
+    if (Pos>=CountOfItems || !Summaries_Frozen)
+        return summary{};
+    return Summaries[Pos].Summary;
 }
 
-//***************************************************************************
-// Memory management
-//***************************************************************************
-
 //---------------------------------------------------------------------------
-void CommonStats::Data_Reserve(size_t NewValue)
+StatsSketch CommonStats::Sketch_Get(size_t Pos)
 {
-    // Lock data
+    Item_Require(Pos);
     QMutexLocker Lock(&Mutex);
 
-    // Saving old data
-    size_t                      Data_Reserved_Old = Data_Reserved;
-    double**                    x_Old = x;
-    double**                    y_Old = y;
-    double*                     durations_Old = durations;
-    bool*                       key_frames_Old = key_frames;
-    int64_t*                    pkt_pos_Old = pkt_pos;
-    int64_t*                    pkt_pts_Old = pkt_pts;
-    int*                        pkt_size_Old = pkt_size;
-    int*                        pix_fmt_Old = pix_fmt;
-    char*                       pict_type_char_Old = pict_type_char;
-    char**                      comments_Old = comments;
-
-    auto                        additionalIntStats_Old = additionalIntStats;
-    auto                        additionalDoubleStats_Old = additionalDoubleStats;
-    auto                        additionalStringStats_Old = additionalStringStats;
-
-    // Computing new value
-    while (Data_Reserved < NewValue + (1 << 18)) //We reserve extra space, minimum 2^18 frames added
-        Data_Reserved <<= 1;
-
-    size_t diff = Data_Reserved - Data_Reserved_Old;
-
-    // Creating new data - x and y
-    x = new double*[4];
-    for (size_t j = 0; j < 4; ++j)
-    {
-        x[j] = new double[Data_Reserved];
-        memcpy(x[j], x_Old[j], Data_Reserved_Old * sizeof(double));
-        memset(&x[j][Data_Reserved_Old], 0x00, diff * sizeof(double));
-        delete[] x_Old[j];
-    }
+    if (Pos>=CountOfItems || !Summaries_Frozen)
+        return StatsSketch();
+    return Summaries[Pos].Sketch;
+}
 
-    y = new double*[CountOfItems];
-    for (size_t j = 0; j < CountOfItems; ++j)
+//---------------------------------------------------------------------------
+std::vector<CommonStats::xml_column> CommonStats::XmlColumns(const activefilters& Filters) const
+{
+    std::vector<xml_column> Columns;
+    for (size_t Pos=0; Pos<CountOfItems; Pos++)
     {
-        y[j] = new double[Data_Reserved];
-        memcpy(y[j], y_Old[j], Data_Reserved_Old * sizeof(double));
-        memset(&y[j][Data_Reserved_Old], 0x00, diff * sizeof(double));
-        delete[] y_Old[j];
+        const activefilter filter=PerItem[Pos].Filter;
+        if (filter==activefilter(-1) || !Filters.test(filter) || !PerItem[Pos].FFmpeg_Name || !Item_IsUsed(Pos))
+            continue;
+        Columns.push_back({Pos, StatsValueInfo::Double, Summary_Mirror(Pos), StatsXmlWriter::TagPrefix(PerItem[Pos].FFmpeg_Name)});
     }
+    return Columns;
+}
 
-    // Creating new data - Extra
-    durations = new double[Data_Reserved];
-    memcpy(durations, durations_Old, Data_Reserved_Old * sizeof(double));
-    memset(&durations[Data_Reserved_Old], 0x00, diff * sizeof(double));
+//---------------------------------------------------------------------------
+std::string CommonStats::SummariesToXML(const activefilters& filters)
+{
+    Items_Load();
+    QMutexLocker Lock(&Mutex);
 
-    key_frames = new bool[Data_Reserved];
-    memcpy(key_frames, key_frames_Old, Data_Reserved_Old * sizeof(bool));
-    memset(&key_frames[Data_Reserved_Old], 0x00, diff * sizeof(bool));
+    if (!Summaries_Frozen)
+        return std::string();
 
-    pkt_pos = new int64_t[Data_Reserved];
-    memcpy(pkt_pos, pkt_pos_Old, Data_Reserved_Old * sizeof(int64_t));
-    memset(&pkt_pos[Data_Reserved_Old], 0x00, diff * sizeof(int64_t));
+    std::stringstream Data;
+    for (const auto& Column : XmlColumns(filters))
+    {
+        size_t Pos=Column.Index;
+        const summary& Summary=Summaries[Pos].Summary;
+        double Mirror=Column.Mirror;
+        double Min=Mirror?(Mirror-Summary.Max):Summary.Min;
+        double Max=Mirror?(Mirror-Summary.Min):Summary.Max;
+        double Mean=Mirror?(Mirror-Summary.Mean):Summary.Mean;
+        double P5=Mirror?(Mirror-Summary.P95):Summary.P5;
+        double Median=Mirror?(Mirror-Summary.Median):Summary.Median;
+        double P95=Mirror?(Mirror-Summary.P5):Summary.P95;
+        const StatsSketch& Sketch=Summaries[Pos].Sketch;
+        double P99=Mirror?(Mirror-Sketch.Quantile(0.01)):Sketch.Quantile(0.99); // Estimated
+
+        Data<<std::fixed<<std::setprecision(PerItem[Pos].DigitsAfterComma);
+        Data<<"<!-- Summary: stream_index=\""<<streamIndex<<"\" key=\""<<PerItem[Pos].FFmpeg_Name<<"\" frames=\""<<Summary.Frames<<"\"";
+        Data<<" min=\""<<Min<<"\" max=\""<<Max<<"\" mean=\""<<Mean<<"\"";
+        Data<<std::setprecision(PerItem[Pos].DigitsAfterComma+2)<<" stddev=\""<<Summary.StdDev<<"\"";
+        Data<<std::setprecision(PerItem[Pos].DigitsAfterComma);
+        if (PerItem[Pos].DefaultLimit!=DBL_MAX)
+        {
+            Data<<" above=\""<<Summary.Above<<"\"";
+            if (PerItem[Pos].DefaultLimit2!=DBL_MAX)
+                Data<<" above2=\""<<Summary.Above2<<"\"";
+        }
+        Data<<" p5=\""<<P5<<"\" median=\""<<Median<<"\" p95=\""<<P95<<"\"";
+        if (Sketch.Count())
+            Data<<" p99=\""<<P99<<"\"";
+        Data<<" -->\n";
+    }
+    return Data.str();
+}
 
-    pkt_pts = new int64_t[Data_Reserved];
-    memcpy(pkt_pts, pkt_pts_Old, Data_Reserved_Old * sizeof(int64_t));
-    memset(&pkt_pts[Data_Reserved_Old], 0x00, diff * sizeof(int64_t));
+//---------------------------------------------------------------------------
+void CommonStats::Summaries_Extend(size_t x_End)
+{
+    if (x_End<=Summaries_x)
+        return;
 
-    pkt_size = new int[Data_Reserved];
-    memcpy(pkt_size, pkt_size_Old, Data_Reserved_Old * sizeof(int));
-    memset(&pkt_size[Data_Reserved_Old], 0x00, diff * sizeof(int));
+    for (size_t j=0; j<CountOfItems; ++j)
+        if (Item_IsUsed(j))
+            Summary_Extend(j, Summaries_x, x_End);
+    Summaries_x=x_End;
+}
 
-    pix_fmt = new int[Data_Reserved];
-    memcpy(pix_fmt, pix_fmt_Old, Data_Reserved_Old * sizeof(int));
-    memset(&pix_fmt[Data_Reserved_Old], 0x00, diff * sizeof(int));
+//---------------------------------------------------------------------------
+void CommonStats::Summary_Extend(size_t j, size_t x_Begin, size_t x_End)
+{
+    summary_state& State=Summaries[j];
+    summary& Summary=State.Summary;
+    for (size_t Pos=x_Begin; Pos<x_End; Pos++)
+    {
+        double Value=y[j][Pos];
+        if (!std::isfinite(Value))
+            continue;
+
+        if (!Summary.Frames || Summary.Min>Value)
+            Summary.Min=Value;
+        if (!Summary.Frames || Summary.Max<Value)
+            Summary.Max=Value;
+        Summary.Frames++;
+        double Delta=Value-Summary.Mean;
+        Summary.Mean+=Delta/Summary.Frames;
+        State.M2+=Delta*(Value-Summary.Mean);
+        State.Sketch.Add(Value, durations[Pos]);
+    }
+}
 
-    pict_type_char = new char[Data_Reserved];
-    memcpy(pict_type_char, pict_type_char_Old, Data_Reserved_Old * sizeof(char));
-    memset(&pict_type_char[Data_Reserved_Old], 0x00, diff * sizeof(char));
+//---------------------------------------------------------------------------
+void CommonStats::Summaries_Freeze()
+{
+    // Called with the data locked, by the parser thread
+    std::vector<double> Values;
+    for (size_t j=0; j<CountOfItems; ++j)
+        Summary_Freeze(j, Values);
 
-    comments = new char*[Data_Reserved];
-    memcpy(comments, comments_Old, Data_Reserved_Old * sizeof(char*));
-    memset(&comments[Data_Reserved_Old], 0x00, diff * sizeof(char*));
+    Summaries_Averages.clear();
+    Summaries_Frozen=true;
+}
 
-    auto numberOfIntValues = lastStatsIndexByValueType[StatsValueInfo::Int];
-    additionalIntStats = new int*[numberOfIntValues];
-    for (size_t j = 0; j < numberOfIntValues; ++j)
+//---------------------------------------------------------------------------
+void CommonStats::Summary_Freeze(size_t j, std::vector<double>& Values)
+{
+    summary_state& State=Summaries[j];
+    summary& Summary=State.Summary;
+    Summary.StdDev=Summary.Frames?std::sqrt(State.M2/Summary.Frames):0;
+    Summary.Above=Stats_Counts[j];
+    Summary.Above2=Stats_Counts2[j];
+
+    // Percentiles, nearest rank, each selection leaves the greater values after it
+    Values.clear();
+    for (size_t Pos=Summaries_Kept; Pos<x_Current; Pos++)
+    {
+        double Value=y[j][Pos];
+        if (std::isfinite(Value))
+            Values.push_back(Value);
+    }
+    auto Begin=Values.begin();
+    for (auto Percentile : {std::make_pair(&Summary.P5, 0.05), std::make_pair(&Summary.Median, 0.5), std::make_pair(&Summary.P95, 0.95)})
     {
-        additionalIntStats[j] = new int[Data_Reserved];
-        memcpy(additionalIntStats[j], additionalIntStats_Old[j], Data_Reserved_Old * sizeof(int));
-        memset(&additionalIntStats[j][Data_Reserved_Old], 0x00, diff * sizeof(int));
-        delete[] additionalIntStats_Old[j];
+        if (Values.empty())
+        {
+            *Percentile.first=0;
+            continue;
+        }
+        auto Nth=Values.begin()+(size_t)(Percentile.second*(Values.size()-1)+0.5);
+        std::nth_element(Begin, Nth, Values.end());
+        *Percentile.first=*Nth;
+        Begin=Nth;
     }
+    Summary.Frozen=true;
 
-    auto numberOfDoubleValues = lastStatsIndexByValueType[StatsValueInfo::Double];
-    additionalDoubleStats = new double*[numberOfDoubleValues];
-    for (size_t j = 0; j < numberOfDoubleValues; ++j)
+    // Texts, as computed on the fly before
+    if (!x_Current)
     {
-        additionalDoubleStats[j] = new double[Data_Reserved];
-        memcpy(additionalDoubleStats[j], additionalDoubleStats_Old[j], Data_Reserved_Old * sizeof(double));
-        memset(&additionalDoubleStats[j][Data_Reserved_Old], 0x00, diff * sizeof(double));
-        delete[] additionalDoubleStats_Old[j];
+        State.Average.clear();
+        State.Count.clear();
+        State.Count2.clear();
+        State.Percent.clear();
+        return;
     }
+    std::stringstream str;
+    str << std::fixed << std::setprecision(PerItem[j].DigitsAfterComma) << Stats_Totals[j] / x_Current;
+    State.Average=str.str();
+    State.Count=std::to_string(Stats_Counts[j]);
+    State.Count2=std::to_string(Stats_Counts2[j]);
+    std::stringstream Percent;
+    Percent<<((double)Stats_Counts[j])/x_Current*100<<"%";
+    State.Percent=Percent.str();
+}
 
-    auto numberOfStringValues = lastStatsIndexByValueType[StatsValueInfo::String];
-    additionalStringStats = new char**[numberOfStringValues];
-    for (size_t j = 0; j < numberOfStringValues; ++j)
-    {
-        additionalStringStats[j] = new char*[Data_Reserved];
-        memcpy(additionalStringStats[j], additionalStringStats_Old[j], Data_Reserved_Old * sizeof(char*));
-        memset(&additionalStringStats[j][Data_Reserved_Old], 0x00, diff * sizeof(char*));
-        delete[] additionalStringStats_Old[j];
-    }
-
-    delete[] x_Old;
-    delete[] y_Old;
-    delete[] durations_Old;
-    delete[] key_frames_Old;
-    delete[] pkt_pos_Old;
-    delete[] pkt_size_Old;
-    delete[] pix_fmt_Old;
-    delete[] pict_type_char_Old;
-    delete[] comments_Old;
+void CommonStats::statsFromExternalData(const char *Data, size_t Size, const std::function<CommonStats*(int, int)>& statsGetter)
+{
+    // AudioStats from external data
+    // XML input
+    StatsXmlReader Reader([&](const StatsXmlFrame& Frame) {
+        const char* media_type=Frame.Attribute("media_type");
+        const char* stream_index_value=Frame.Attribute("stream_index");
+        if (!media_type || !stream_index_value)
+            return;
+
+        auto streamIndex = Number_ToInt(stream_index_value);
+        CommonStats* stats = nullptr;
+
+        if(!strcmp(media_type, "video"))
+            stats = statsGetter(Type_Video, streamIndex);
+        else if(!strcmp(media_type, "audio"))
+            stats = statsGetter(Type_Audio, streamIndex);
+
+        if(stats)
+            stats->parseFrame(Frame);
+    });
+
+    Reader.Feed(Data, Size);
+    Reader.Finish();
+}
+
+//***************************************************************************
+// Memory management
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void CommonStats::Data_Reserve(size_t NewValue)
+{
+    // Computing new value, one more chunk
+    Data_Reserved = ((NewValue >> StatsColumn<double>::Chunk_Shift) + 1) << StatsColumn<double>::Chunk_Shift;
+
+    // Columns are chunked, existing values are not moved so readers are not blocked
+    for (size_t j = 0; j < 4; ++j)
+        x[j].Reserve(Data_Reserved);
+    for (size_t j = 0; j < CountOfItems; ++j)
+        y[j].Reserve(Data_Reserved);
+
+    durations.Reserve(Data_Reserved);
+    key_frames.Reserve(Data_Reserved);
+    pkt_pos.Reserve(Data_Reserved);
+    pkt_pts.Reserve(Data_Reserved);
+    pkt_size.Reserve(Data_Reserved);
+    pict_type_char.Reserve(Data_Reserved);
+
+    // Additional stats columns are only added by this (parser) thread
+    for (auto& column : additionalIntStats)
+        column.Reserve(Data_Reserved);
+    for (auto& column : additionalDoubleStats)
+        column.Reserve(Data_Reserved);
+    for (auto& column : additionalStringStats)
+        column.Reserve(Data_Reserved);
+
+    // Live analysis, the frames before the window are not kept
+    size_t Frames=Window;
+    if (Frames && NewValue>Frames)
+        Data_Discard(NewValue-Frames);
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Detectors_Run()
+{
+    if (!Detectors)
+        return;
+
+    auto Previous=comments[x_Current];
+    std::string Comment(Previous?Previous:"");
+    if (Detectors->Add(y, x_Current, streamIndex, x[1][x_Current]+FirstTimeStamp, Comment))
+        comments.Set(x_Current, Strings.Add(Comment.c_str()));
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Shots_Extend(size_t x_End)
+{
+    for (size_t Pos=shots.Scanned(); Pos<x_End; Pos++)
+        shots.Add(Pos, x[1][Pos], Shot_Difference(Pos));
+}
+
+//---------------------------------------------------------------------------
+void CommonStats::Data_Discard(size_t Before)
+{
+    // Summaries and shots are extended with the frames before they are freed
+    Summaries_Extend(Before);
+    Shots_Extend(Before);
+    if (Summaries_Kept<Before)
+        Summaries_Kept=Before;
+
+    for (size_t j = 0; j < 4; ++j)
+        x[j].Discard(Before);
+    for (size_t j = 0; j < CountOfItems; ++j)
+        y[j].Discard(Before);
+
+    durations.Discard(Before);
+    key_frames.Discard(Before);
+    pkt_pos.Discard(Before);
+    pkt_pts.Discard(Before);
+    pkt_size.Discard(Before);
+    pict_type_char.Discard(Before);
+    comments.Discard(Before);
+
+    for (auto& column : additionalIntStats)
+        column.Discard(Before);
+    for (auto& column : additionalDoubleStats)
+        column.Discard(Before);
+    for (auto& column : additionalStringStats)
+        column.Discard(Before);
 }
@@ -12,53 +12,146 @@
 #include <string.h>
 #include <vector>
 #include <map>
+#include <deque>
 #include <stdint.h>
 #include <algorithm>
 #include <cctype>
 #include <functional>
+#include <charconv>
+#include <cstdlib>
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <Core/Core.h>
+#include <Core/StatsKeyIndex.h>
+#include <Core/StatsNumbers.h>
+#include <Core/StatsColumn.h>
+#include <Core/StatsComments.h>
+#include <Core/StatsPyramid.h>
+#include <Core/StatsRangeIndex.h>
+#include <Core/StatsShots.h>
+#include <Core/StatsSketch.h>
+#include <Core/StatsDetectors.h>
+#include <Core/StatsStrings.h>
 #include <QMutex>
 #include <QtAVPlayer/qavplayer.h>
 
 struct AVFrame;
+struct AVDictionary;
 class QAVStream;
 struct per_item;
-class XMLElement;
-
-namespace tinyxml2 {
-    class XMLElement;
-}
+struct StatsXmlFrame;
+class StatsXmlWriter;
 
 class QAVFrame;
+
+//---------------------------------------------------------------------------
+// Events of the detectors which set metadata on the frame an event is detected
+// (with its start time as value) and on the first frame after it (blackdetect,
+// freezedetect, silencedetect), as a value per frame: the duration of the
+// event up to the end of the frame, 0 out of the events.
+struct StatsEvent
+{
+    const char*                 Key_Start;
+    const char*                 Key_End;
+    bool                        Started=false;
+    double                      Start=0;
+
+    bool                        IsKey                       (const char* Key) const {return !strcmp(Key, Key_Start) || !strcmp(Key, Key_End);}
+    double                      FromFrame                   (const AVDictionary* Metadata, double Time, double Duration); // Frame from Time, seconds
+};
+
 class CommonStats
 {
+    friend class StatsColumnsCache;
+    friend class StatsColumnsReport;
+
 public:
     // Constructor / Destructor
-    CommonStats(const struct per_item* PerItem, int Type, size_t CountOfGroups, size_t CountOfItems, size_t FrameCount=0, double Duration=0, QAVStream* stream = NULL);
+    CommonStats(const struct per_item* PerItem, int Type, size_t CountOfGroups, size_t CountOfItems, uint64_t FrameCount=0, double Duration=0, QAVStream* stream = NULL);
     virtual ~CommonStats();
 
     // Data
-    double**                    x;                          // Time information, per frame (0=frame number, 1=seconds, 2=minutes, 3=hours)
-    double**                    y;                          // Data (Group_xxxMax size)
-    double*                     durations;                  // Duration of a frame, per frame
-    int64_t*					pkt_pos;                    // Frame offsets
-    int64_t*                    pkt_pts;                    // pkt_pts
-    int*                        pkt_size;                   // Frame size
-    int*                        pix_fmt;                    //
-    char*                       pict_type_char;             //
-    bool*                       key_frames;                 // Key frame status, per frame
-    size_t                      x_Current;                  // Data is filled up to
+    StatsColumn<double>*        x;                          // Time information, per frame (0=frame number, 1=seconds, 2=minutes, 3=hours)
+    StatsValueColumn*           y;                          // Data (Group_xxxMax size)
+    StatsColumn<double>         durations;                  // Duration of a frame, per frame
+    StatsColumn<int64_t>        pkt_pos;                    // Frame offsets
+    StatsColumn<int64_t>        pkt_pts;                    // pkt_pts
+    StatsColumn<int>            pkt_size;                   // Frame size
+    StatsRunColumn<int>         pix_fmt;                    // Pixel format, per run of frames
+    StatsPictTypeColumn         pict_type_char;             // Picture type, per frame
+    StatsKeyFrameColumn         key_frames;                 // Key frame status, per frame
+    size_t                      x_Current;                  // Data is filled up to, by the thread filling the stats
     size_t                      x_Current_Max;              // Data will be filled up to
     double                      x_Max[4];                   // Maximum x by plot
     double*                     y_Min;                      // Minimum y by plot
     double*                     y_Max;                      // Maximum y by plot
     double                      FirstTimeStamp;             // Time stamp of the first frame
-    char**                      comments;                   // Comments per frame (utf-8)
+    StatsComments               comments;                   // Comments of the frames (utf-8, HTML escaped), in Strings
+    StatsShots                  shots;                      // Shot boundaries (video), extended before the frames are published
+
+    // Count of frames readable from other threads (plots, GUI) without locking: the columns never move (see StatsColumn) and
+    // the count is published once all the values of a frame are written, so frames before it are complete
+    size_t                      x_Current_Get() const {return x_Published.load(std::memory_order_acquire);}
+
+    // Comment of a frame (utf-8, HTML escaped), copied, NULL or empty removes it
+    void                        Comment_Set(size_t Pos, const char* Comment);
+
+    // Positions of the values of y[Pos] to plot from x_Begin to x_End (excluded) in Buckets buckets, see StatsPyramid
+    // The pyramid of the item is extended up to x_Current by the calling thread, the plots (GUI thread) only
+    void                        y_PlotPositions(size_t Pos, size_t x_Begin, size_t x_End, size_t Buckets, std::vector<uint32_t>& Positions);
+
+    // Minimum, maximum, sum and counts over the limits of the item of y[Pos] from x_Begin to x_End (excluded), see StatsRangeIndex
+    // The index of the item is extended up to x_Current by the calling thread, the GUI thread or after the parsing only
+    StatsRangeIndex::range      y_Range(size_t Pos, size_t x_Begin, size_t x_End);
+
+    // Compact storage of y (float32 / int32 depending on the item precision), for stats created afterwards
+    static void                 CompactStorage_Set(bool Value);
+    static bool                 CompactStorage_Get();
+
+    // Lossless compression of the full chunks of y when the file is released (see FileInformation::releaseMemory())
+    static void                 ColdCompression_Set(bool Value);
+    static bool                 ColdCompression_Get();
+
+    // Live analysis: only the last Frames frames are kept in memory, set before the parsing, 0 means all
+    // Other threads read the last Frames/2 frames only (up to x_Current_Get()), older ones may be freed while read
+    static void                 Window_Set(size_t Frames);
+    static size_t               Window_Get();
 
     // Status
     int                         Type_Get();
     double                      State_Get();
 
+    // Sparse stats, from a parsing of some frames of the stream only (see FileInformation::Sampling_Set): 0 all frames,
+    // N one frame of N, -1 key frames only. Positions (x[0]) are the ones of the frames parsed, times and durations are
+    // the ones of the stream so the gaps are where x[1] jumps over the duration of the previous frame, and the
+    // averages and percents are over the frames parsed. The estimated count of frames is reduced accordingly.
+    void                        Sampling_Set(int Every);
+    int                         Sampling_Get() const;
+
+    // Filters with values in the report the stats are read from (items and additional stats), none for stats parsed
+    activefilters               ReportFilters_Get();
+
+    // Memory allocated by the per-frame columns, not including the ones mapped (see StatsColumnsCache)
+    size_t                      Bytes();
+
+    // Full chunks of y compressed, read back by chunk when used, no thread must use the stats (see StatsValueColumn::Compress)
+    void                        Compress();
+
+    // Items stored, Used has one value per item (see AnalysisProfiles::Items), the values of the other ones are not stored
+    // then read as NaN (see StatsValueColumn::Storage_None) and they are not in the exports; before the first frame
+    void                        Items_Restrict(const std::vector<bool>& Used);
+    bool                        Item_IsUsed(size_t j) const {return j>=Items_Used.size() || Items_Used[j];}
+
+    // Items of a columns report read on their first use (see StatsColumnsReport::Load), the other values of the frames
+    // are read when the report is opened. An item is read with its group limits, counts and summary as if it was parsed,
+    // by the queries of the item (summary, plot positions, range...), by Item_Require() before reading y directly, by
+    // Items_Load() for the items of a group (plots) or for all of them (exports)
+    bool                        Items_IsPending() const {return Items_Pending.load(std::memory_order_acquire)!=0;}
+    void                        Item_Require(size_t Pos);
+    void                        Items_Load(size_t Group);
+    void                        Items_Load();
+
     // Stats
     std::string                      Average_Get(size_t Pos);
     std::string                      Average_Get(size_t Pos, size_t Pos2);
@@ -66,16 +159,65 @@ public:
     std::string                      Count2_Get(size_t Pos);
     std::string                      Percent_Get(size_t Pos);
 
+    // Whole stream summary of an item, extended while parsing and frozen by StatsFinish() (Frozen is false before and
+    // after an Append()). Values as stored (see StatsToXML() for the crop items), infinite and NaN values are not in the
+    // moments, percentiles are the ones of the frames kept in memory (the last Window_Get() ones in live analysis)
+    struct summary
+    {
+        bool                    Frozen;
+        size_t                  Frames;                     // With a finite value
+        double                  Min;
+        double                  Max;
+        double                  Mean;
+        double                  StdDev;
+        uint64_t                Above;                      // Same as Count_Get()
+        uint64_t                Above2;                     // Same as Count2_Get()
+        double                  P5;
+        double                  Median;
+        double                  P95;
+    };
+    summary                     Summary_Get(size_t Pos);
+
+    // Quantiles and histogram of an item (values as stored, durations of the frames), frozen as the summary, empty before
+    StatsSketch                 Sketch_Get(size_t Pos);
+
+    // Summaries of the items exported as XML comments (one per item, values as in the XML report), empty if not frozen
+    std::string                 SummariesToXML(const activefilters& filters);
+
     static void statsFromExternalData(const char* Data, size_t Size, const std::function<CommonStats*(int, int)>& statsGetter);
 
-    virtual void parseFrame(tinyxml2::XMLElement* frame) = 0;
+    virtual void parseFrame(const StatsXmlFrame& frame) = 0;
 
     // External data
             void                StatsFromExternalData_Finish() {Frequency=1; StatsFinish();}
     virtual void                StatsFromFrame(const QAVFrame& Frame, int Width, int Height) = 0;
     virtual void                TimeStampFromFrame(const QAVFrame& Frame, size_t FramePos) = 0;
+
+    // Values of the native kernels for the current frame (item, value rounded as in the metadata of the filters), before
+    // StatsFromFrame(); filled from the kernels by VideoStats::KernelValues() and AudioStats::KernelValues()
+    typedef std::vector<std::pair<size_t, double> > kernel_values;
+    virtual void                StatsFromKernel(const kernel_values& Values) = 0;
+
+    // Frame from its packet only, without decoding (see PacketStatsParser), no other value is filled
+    struct packet
+    {
+        int64_t                 Pts;                        // In the time base of the stream, DTS if not available, AV_NOPTS_VALUE if none
+        int64_t                 Duration;                   // In the time base of the stream, 0 if not known
+        int64_t                 Pos;
+        int                     Size;
+        bool                    KeyFrame;
+        char                    PictType;                   // As av_get_picture_type_char()
+        int                     Format;                     // Pixel or sample format of the stream
+    };
+            void                StatsFromPacket(const packet& Packet);
     virtual void                StatsFinish();
-    virtual std::string              StatsToXML(const activefilters& filters) = 0;
+
+    // Frames of the same stream parsed separately (segmented parsing), appended after the current ones, from the frame First of the segment up to Last (excluded)
+            void                Append(CommonStats& Segment, size_t First=0, size_t Last=(size_t)-1);
+    // Values of the items of Filters and additional stats not here yet from the same frames parsed again (incremental re-analysis, see
+    // FileInformation::Reanalysis_Set), frame by frame up to the shortest stats; other values and comments are kept, summaries of the items are computed again
+            void                Merge(CommonStats& Other, const activefilters& Filters);
+    virtual void                StatsToXML(StatsXmlWriter& Writer, const activefilters& filters, size_t x_Begin, size_t x_End) = 0; // Frames from x_Begin to x_End (excluded)
 
     struct StatsValueInfo {
         size_t index;
@@ -138,24 +280,16 @@ public:
                 return String;
             }
 
-            // try to deduce type..
+            // try to deduce type.., from the beginning of the value
             if(is_number(value)) {
                 if(strstr(value, ".") != nullptr) {
-                    try {
-                        std::stod(value);
+                    double doubleValue;
+                    if(Number_Parse(value, nullptr, doubleValue) != value)
                         return Double;
-                    }
-                    catch(const std::exception& ex) {
-
-                    }
                 } else {
-                    try {
-                        std::stoi(value);
+                    int intValue;
+                    if(std::from_chars(value, value + strlen(value), intValue).ec == std::errc())
                         return Int;
-                    }
-                    catch(const std::exception& ex) {
-
-                    }
                 }
             }
 
@@ -164,14 +298,35 @@ public:
     };
     typedef std::string StringStatsKey;
 
+    // Columns of the additional items of the active filters (see stream_info::AdditionalItems), before the first frame
+    // Metadata of these keys is then parsed without the type discovery of the first frame
+    void AdditionalStats_Declare(const activefilters& Filters);
+    // Column of one key (e.g. of an analyzer plugin, see AnalyzerPlugins::Create), kept if already declared
+    void AdditionalStats_Declare(const char* Key, additional_type Type);
+
     void initializeAdditionalStats();
     void updateAdditionalStats(StatsValueInfo::Type type, size_t oldSize, size_t size);
     void processAdditionalStats(const char* key, const char* value, bool statsMapInitialized);
-    void writeAdditionalStats(std::stringstream& stream, size_t index);
+
+    // Columns of an export (see StatsToXML()), built once per export so the frames are written by a loop over the columns
+    // written only, with the start of their tags formatted (see StatsXmlWriter::TagPrefix())
+    struct xml_column
+    {
+        size_t                  Index;                      // Item, or column of the additional stats of Type
+        StatsValueInfo::Type    Type;                       // Of the additional stats
+        double                  Mirror;                     // Of the items, see Summary_Mirror()
+        std::string             Prefix;
+    };
+    // Items of Filters stored, in item order
+    std::vector<xml_column>     XmlColumns(const activefilters& Filters) const;
+    // Additional stats, in the order of their columns per type (int, double, string)
+    std::vector<xml_column>     XmlAdditionalColumns();
+    void writeAdditionalStats(StatsXmlWriter& Writer, const std::vector<xml_column>& Columns, size_t index);
 
 protected:
     size_t lastStatsIndexByValueType[3];
-    std::map<StringStatsKey, StatsValueInfo> statsValueInfoByKeys;
+    StatsKeyIndex statsValueInfoByKeys; // key to position in statsValueInfos
+    std::vector<StatsValueInfo> statsValueInfos;
     std::map<int, StringStatsKey> statsKeysByIndexByValueType[3];
 
     // Status
@@ -185,20 +340,68 @@ protected:
     // Info
     double                      Frequency;
     int							streamIndex;
+    int                         Sampling;
+    activefilters               ReportFilters;              // Of the items of the report, see ReportFilters_Get()
 
     // Memory management
     size_t                      Data_Reserved; // Count of frames reserved in memory;
+    std::atomic<size_t>         x_Published;   // x_Current once the frame is complete
+    void                        x_Current_Publish() {x_Published.store(x_Current, std::memory_order_release);}
     void                        Data_Reserve(size_t NewValue); // Increase Data_Reserved
+    void                        Data_Discard(size_t Before);   // Frees the frames before Before
+
+    // Events detected in the frame x_Current, complete but not yet published, added to its comment (see StatsDetectors)
+    std::unique_ptr<StatsDetectors> Detectors;                 // nullptr if none
+    void                        Detectors_Run();
+
+    // Frames up to x_End (excluded) added to the shots, with the difference of each one with the previous one
+    void                        Shots_Extend(size_t x_End);
+    virtual double              Shot_Difference(size_t Pos) const {return std::numeric_limits<double>::quiet_NaN();} // Percent, NaN if not known
+
+    // Position here of the additional stats of Other per type and index in Other, columns are created here if needed
+    // (-1 for a key typed differently, or already here with NewOnly), with the data of both locked
+    void                        AdditionalStats_Map(const CommonStats& Other, std::vector<size_t> (&Map)[3], bool NewOnly=false);
+
+    // Values of the items of the stream type from the packet of the frame x_Current (see StatsFromPacket())
+    virtual void                StatsFromPacket_Items(const packet& Packet) {}
+
+    // Values of the items not read yet from the report, per item (Data is nullptr once read), see Item_Require()
+    struct item_source
+    {
+        const char*             Data=nullptr;               // One f32 or f64 value per frame
+        size_t                  ElementSize=0;
+    };
+    std::vector<item_source>    Items_Sources;
+    std::vector<bool>           Items_Used;                 // Empty if all the items are stored, see Items_Restrict()
+    std::shared_ptr<const void> Items_Memory;               // Report the sources point to
+    std::atomic<size_t>         Items_Pending {0};
+    void                        Item_Load(size_t j);        // With the data locked
+    virtual double              Item_FromReport(size_t j, double Value) const {return Value;} // Value as stored from the one of the report
 
     // Arrays
     int                         Type;
     const struct per_item*      PerItem;
     size_t                      CountOfGroups;
     size_t                      CountOfItems;
-
-    int**                       additionalIntStats;
-    double**                    additionalDoubleStats;
-    char***                     additionalStringStats;
+    StatsPyramid*               y_Pyramids;                 // Per item, built when plotted
+    StatsRangeIndex*            y_Ranges;                   // Per item, built when queried
+    struct summary_state;
+    summary_state*              Summaries;                  // Per item, extended by the parser thread only
+    size_t                      Summaries_x;                // Frames already in the summaries
+    size_t                      Summaries_Kept;             // First frame not discarded
+    std::atomic<bool>           Summaries_Frozen;
+    std::map<std::pair<size_t, size_t>, std::string> Summaries_Averages; // Average_Get(Pos, Pos2) once frozen
+    void                        Summaries_Extend(size_t x_End);
+    void                        Summaries_Freeze();
+    void                        Summary_Extend(size_t j, size_t x_Begin, size_t x_End);
+    void                        Summary_Freeze(size_t j, std::vector<double>& Values);
+    virtual double              Summary_Mirror(size_t Pos) const {return 0;} // Not 0: exported as the difference from it
+    const StatsKeyIndex&        ItemsIndex;                 // FFmpeg_Name to item
+
+    std::deque<StatsColumn<int>>    additionalIntStats;
+    std::deque<StatsColumn<double>> additionalDoubleStats;
+    std::deque<StatsColumn<const char*>> additionalStringStats; // In Strings
+    StatsStrings                Strings;
 
    // Thread synchronisation
    QMutex                       Mutex;
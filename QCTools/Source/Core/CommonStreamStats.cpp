@@ -6,6 +6,7 @@
 
 //---------------------------------------------------------------------------
 #include "Core/CommonStreamStats.h"
+#include "Core/StatsNumbers.h"
 //---------------------------------------------------------------------------
 #include <qavplayer.h>
 #include <qavstream.h>
@@ -49,7 +50,7 @@ CommonStreamStats::CommonStreamStats(XMLElement *streamElement) :
 {
     const char* stream_index_value = streamElement->Attribute("index");
     if(stream_index_value)
-        stream_index = std::stoi(stream_index_value);
+        stream_index = Number_ToInt(stream_index_value);
 
     const char* codec_name_value = streamElement->Attribute("codec_name");
     if(codec_name_value)
@@ -61,7 +62,7 @@ CommonStreamStats::CommonStreamStats(XMLElement *streamElement) :
 
     const char* codec_tag_value = streamElement->Attribute("codec_tag");
     if(codec_tag_value)
-        codec_tag = std::stoi(codec_tag_value, 0, 16);
+        codec_tag = (int)std::strtol(codec_tag_value, nullptr, 16);
 
     const char* r_frame_rate_value = streamElement->Attribute("r_frame_rate");
     if(r_frame_rate_value)
@@ -122,14 +123,14 @@ CommonStreamStats::CommonStreamStats(XMLElement *streamElement) :
         {
             const char* value = dispositionElement->Attribute(dispositionAttributes[i]);
             if(value) {
-                disposition |= (std::stoi(value) == 1 ? dispositionFlags[i] : 0);
+                disposition |= (Number_ToInt(value) == 1 ? dispositionFlags[i] : 0);
             }
         }
     }
 
     const char* bits_per_raw_sample_value = streamElement->Attribute("bits_per_raw_sample");
     if(bits_per_raw_sample_value) {
-        bits_per_raw_sample = atoi(bits_per_raw_sample_value);
+        bits_per_raw_sample = Number_ToInt(bits_per_raw_sample_value);
     }
 
     XMLElement* tag = streamElement->FirstChildElement("tag");
@@ -0,0 +1,500 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/ConditionExpression.h"
+#include "Core/StatsColumn.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Helpers
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+// Boolean value of a number in JavaScript
+inline bool Truthy(double Value)
+{
+    return Value!=0 && !std::isnan(Value);
+}
+
+enum function : uint8_t
+{
+    Function_Abs,
+    Function_Sqrt,
+    Function_Floor,
+    Function_Ceil,
+    Function_Round,
+    Function_Log,
+    Function_Exp,
+    Function_Pow2,
+    Function_Pow,
+    Function_Min,
+    Function_Max,
+};
+
+struct function_name
+{
+    const char*                 Name;
+    function                    Function;
+    size_t                      Arguments;
+};
+
+const function_name Functions[]=
+{
+    {"pow",         Function_Pow,   2},
+    {"pow2",        Function_Pow2,  1},
+    {"Math.abs",    Function_Abs,   1},
+    {"Math.sqrt",   Function_Sqrt,  1},
+    {"Math.floor",  Function_Floor, 1},
+    {"Math.ceil",   Function_Ceil,  1},
+    {"Math.round",  Function_Round, 1},
+    {"Math.log",    Function_Log,   1},
+    {"Math.exp",    Function_Exp,   1},
+    {"Math.pow",    Function_Pow,   2},
+    {"Math.min",    Function_Min,   2},
+    {"Math.max",    Function_Max,   2},
+};
+
+inline double Call(uint8_t Function, double A)
+{
+    switch (Function)
+    {
+        case Function_Abs           :   return std::fabs(A);
+        case Function_Sqrt          :   return std::sqrt(A);
+        case Function_Floor         :   return std::floor(A);
+        case Function_Ceil          :   return std::ceil(A);
+        case Function_Round         :   return std::floor(A+0.5); // Halves are rounded up, as JavaScript does
+        case Function_Log           :   return std::log(A);
+        case Function_Exp           :   return std::exp(A);
+        default                     :   return A*A; // Function_Pow2
+    }
+}
+
+inline double Call(uint8_t Function, double A, double B)
+{
+    switch (Function)
+    {
+        case Function_Min           :   return std::isnan(A) || std::isnan(B)?std::numeric_limits<double>::quiet_NaN():(A<B?A:B);
+        case Function_Max           :   return std::isnan(A) || std::isnan(B)?std::numeric_limits<double>::quiet_NaN():(A>B?A:B);
+        default                     :   return std::pow(A, B); // Function_Pow
+    }
+}
+
+} //Namespace
+
+//***************************************************************************
+// Parser
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Recursive descent, by precedence of the JavaScript operators; each level
+// appends its operands then its operator to the program
+class ConditionExpressionParser
+{
+public:
+    ConditionExpressionParser(const std::string& Text_, const ConditionExpression::constant_resolver& Constant_, ConditionExpression& Expression_) :
+        Text(Text_), Constant(Constant_), Expression(Expression_) {}
+
+    bool Parse()
+    {
+        if (!Conditional())
+            return false;
+        SkipSpaces();
+        if (Text[Pos]==';') // "return y > 3;" is accepted by the JavaScript function too
+            Pos++;
+        SkipSpaces();
+        return Pos==Text.size() && Depth_Max<=ConditionExpression::Stack_Max;
+    }
+
+private:
+    typedef ConditionExpression::instruction instruction;
+
+    const std::string&          Text;
+    const ConditionExpression::constant_resolver& Constant;
+    ConditionExpression&        Expression;
+    size_t                      Pos=0;
+    size_t                      Depth=0;                    // Of the stack when the program runs
+    size_t                      Depth_Max=0;
+    size_t                      Nesting=0;                  // Of the parser, so a pathological text does not overflow the native stack
+
+    void SkipSpaces()
+    {
+        while (Pos<Text.size() && std::isspace((unsigned char)Text[Pos]))
+            Pos++;
+    }
+
+    bool Accept(const char* Token)
+    {
+        SkipSpaces();
+        size_t Size=std::char_traits<char>::length(Token);
+        if (Text.compare(Pos, Size, Token))
+            return false;
+        Pos+=Size;
+        return true;
+    }
+
+    bool Peek(const char* Token)
+    {
+        SkipSpaces();
+        return !Text.compare(Pos, std::char_traits<char>::length(Token), Token);
+    }
+
+    // Same as Accept(), but the token is not the beginning of a longer one (e.g. "<" of "<=", "=" of "==")
+    bool AcceptOperator(const char* Token, const char* NotFollowedBy)
+    {
+        size_t Start=Pos;
+        if (!Accept(Token))
+            return false;
+        if (Pos<Text.size() && std::char_traits<char>::find(NotFollowedBy, std::char_traits<char>::length(NotFollowedBy), Text[Pos]))
+        {
+            Pos=Start;
+            return false;
+        }
+        return true;
+    }
+
+    void Emit(ConditionExpression::opcode Op, size_t Pops, double Value=0, uint8_t Function=0)
+    {
+        Expression.Program.push_back(instruction{Op, Function, Value});
+        Depth-=Pops;
+        Depth++;
+        if (Depth_Max<Depth)
+            Depth_Max=Depth;
+    }
+
+    // a ? b : c
+    bool Conditional()
+    {
+        if (++Nesting>ConditionExpression::Stack_Max*4)
+            return false;
+        bool Result=LogicalOr();
+        if (Result && Accept("?"))
+            Result=Conditional() && Accept(":") && Conditional() && (Emit(ConditionExpression::Op_Select, 3), true);
+        Nesting--;
+        return Result;
+    }
+
+    bool LogicalOr()
+    {
+        if (!LogicalAnd())
+            return false;
+        while (Accept("||"))
+        {
+            if (!LogicalAnd())
+                return false;
+            Emit(ConditionExpression::Op_Or, 2);
+        }
+        return true;
+    }
+
+    bool LogicalAnd()
+    {
+        if (!Equality())
+            return false;
+        while (Accept("&&"))
+        {
+            if (!Equality())
+                return false;
+            Emit(ConditionExpression::Op_And, 2);
+        }
+        return true;
+    }
+
+    bool Equality()
+    {
+        if (!Relational())
+            return false;
+        for (;;)
+        {
+            ConditionExpression::opcode Op;
+            if (Accept("===") || Accept("=="))
+                Op=ConditionExpression::Op_Equal;
+            else if (Accept("!==") || Accept("!="))
+                Op=ConditionExpression::Op_NotEqual;
+            else
+                return true;
+            if (!Relational())
+                return false;
+            Emit(Op, 2);
+        }
+    }
+
+    bool Relational()
+    {
+        if (!Additive())
+            return false;
+        for (;;)
+        {
+            ConditionExpression::opcode Op;
+            if (Accept("<="))
+                Op=ConditionExpression::Op_LessOrEqual;
+            else if (Accept(">="))
+                Op=ConditionExpression::Op_GreaterOrEqual;
+            else if (AcceptOperator("<", "<"))
+                Op=ConditionExpression::Op_Less;
+            else if (AcceptOperator(">", ">"))
+                Op=ConditionExpression::Op_Greater;
+            else
+                return true;
+            if (!Additive())
+                return false;
+            Emit(Op, 2);
+        }
+    }
+
+    bool Additive()
+    {
+        if (!Multiplicative())
+            return false;
+        for (;;)
+        {
+            ConditionExpression::opcode Op;
+            if (AcceptOperator("+", "+="))
+                Op=ConditionExpression::Op_Add;
+            else if (AcceptOperator("-", "-="))
+                Op=ConditionExpression::Op_Subtract;
+            else
+                return true;
+            if (!Multiplicative())
+                return false;
+            Emit(Op, 2);
+        }
+    }
+
+    bool Multiplicative()
+    {
+        if (!Unary())
+            return false;
+        for (;;)
+        {
+            ConditionExpression::opcode Op;
+            if (AcceptOperator("*", "*="))
+                Op=ConditionExpression::Op_Multiply;
+            else if (AcceptOperator("/", "/="))
+                Op=ConditionExpression::Op_Divide;
+            else if (AcceptOperator("%", "="))
+                Op=ConditionExpression::Op_Modulo;
+            else
+                return true;
+            if (!Unary())
+                return false;
+            Emit(Op, 2);
+        }
+    }
+
+    // -2 ** 2 is a syntax error in JavaScript, the operand of an unary operator is not an exponentiation
+    bool Unary(bool IsOperand=false)
+    {
+        if (++Nesting>ConditionExpression::Stack_Max*4)
+            return false;
+        bool Result;
+        if (AcceptOperator("-", "-"))
+            Result=Unary(true) && (Emit(ConditionExpression::Op_Negate, 1), true);
+        else if (AcceptOperator("+", "+"))
+            Result=Unary(true); // Numbers only, nothing to convert
+        else if (AcceptOperator("!", "="))
+            Result=Unary(true) && (Emit(ConditionExpression::Op_Not, 1), true);
+        else if (IsOperand)
+            Result=Primary() && !Peek("**");
+        else
+            Result=Exponent();
+        Nesting--;
+        return Result;
+    }
+
+    // a ** b ** c is a ** (b ** c)
+    bool Exponent()
+    {
+        if (!Primary())
+            return false;
+        if (AcceptOperator("**", "="))
+        {
+            if (!Unary())
+                return false;
+            Emit(ConditionExpression::Op_Power, 2);
+        }
+        return true;
+    }
+
+    bool Primary()
+    {
+        SkipSpaces();
+        if (Pos>=Text.size())
+            return false;
+
+        // Number
+        char C=Text[Pos];
+        if (std::isdigit((unsigned char)C) || (C=='.' && Pos+1<Text.size() && std::isdigit((unsigned char)Text[Pos+1])))
+        {
+            const char* Begin=Text.c_str()+Pos;
+            char* End;
+            double Value=std::strtod(Begin, &End);
+            if (End==Begin || (End-Begin>1 && (Begin[1]=='x' || Begin[1]=='X'))) // Hexadecimal values are not in conditions, strtod() does not read them as JavaScript does
+                return false;
+            Pos+=End-Begin;
+            if (Pos<Text.size() && (std::isalnum((unsigned char)Text[Pos]) || Text[Pos]=='_'))
+                return false;
+            Emit(ConditionExpression::Op_Constant, 0, Value);
+            return true;
+        }
+
+        // Parentheses
+        if (Accept("("))
+            return Conditional() && Accept(")");
+
+        // Name, with the property of Math
+        if (!std::isalpha((unsigned char)C) && C!='_' && C!='$')
+            return false;
+        size_t Begin=Pos;
+        while (Pos<Text.size() && (std::isalnum((unsigned char)Text[Pos]) || Text[Pos]=='_' || Text[Pos]=='$'))
+            Pos++;
+        if (!Text.compare(Begin, Pos-Begin, "Math") && Pos<Text.size() && Text[Pos]=='.')
+        {
+            Pos++;
+            while (Pos<Text.size() && (std::isalnum((unsigned char)Text[Pos]) || Text[Pos]=='_'))
+                Pos++;
+        }
+        std::string Name=Text.substr(Begin, Pos-Begin);
+
+        // Call
+        if (Accept("("))
+        {
+            for (const auto& Function : Functions)
+            {
+                if (Name!=Function.Name)
+                    continue;
+                for (size_t Argument=0; Argument<Function.Arguments; Argument++)
+                    if ((Argument && !Accept(",")) || !Conditional())
+                        return false;
+                if (!Accept(")"))
+                    return false;
+                Emit(Function.Arguments==1?ConditionExpression::Op_Function1:ConditionExpression::Op_Function2, Function.Arguments, 0, Function.Function);
+                return true;
+            }
+            return false;
+        }
+
+        // Value
+        if (Name=="y")
+        {
+            Emit(ConditionExpression::Op_Y, 0);
+            return true;
+        }
+        double Value;
+        if (Name=="Math.PI")
+            Value=3.141592653589793;
+        else if (Name=="Math.E")
+            Value=2.718281828459045;
+        else if (Name=="true")
+            Value=1;
+        else if (Name=="false")
+            Value=0;
+        else if (Name=="NaN")
+            Value=std::numeric_limits<double>::quiet_NaN();
+        else if (Name=="Infinity")
+            Value=std::numeric_limits<double>::infinity();
+        else if (!Constant || !Constant(Name, Value))
+            return false;
+        Emit(ConditionExpression::Op_Constant, 0, Value);
+        return true;
+    }
+};
+
+//***************************************************************************
+// Compile
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+std::shared_ptr<const ConditionExpression> ConditionExpression::Compile(const std::string& Text, const constant_resolver& Constant)
+{
+    auto Expression=std::make_shared<ConditionExpression>();
+    ConditionExpressionParser Parser(Text, Constant, *Expression);
+    if (!Parser.Parse())
+        return nullptr;
+    return Expression;
+}
+
+//***************************************************************************
+// Test
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+double ConditionExpression::Evaluate(double y) const
+{
+    double Stack[Stack_Max];
+    size_t Top=0; // First free item
+
+    for (const auto& Instruction : Program)
+    {
+        double* A=Stack+Top-1; // Last operand
+        switch (Instruction.Op)
+        {
+            case Op_Constant            :   Stack[Top++]=Instruction.Value; break;
+            case Op_Y                   :   Stack[Top++]=y; break;
+            case Op_Negate              :   *A=-*A; break;
+            case Op_Not                 :   *A=Truthy(*A)?0:1; break;
+            case Op_Function1           :   *A=Call(Instruction.Function, *A); break;
+            case Op_Select              :   A-=2; *A=Truthy(A[0])?A[1]:A[2]; Top-=2; break;
+            default                     :   // Binary operators
+                                            {
+                                            A--;
+                                            double L=A[0];
+                                            double R=A[1];
+                                            switch (Instruction.Op)
+                                            {
+                                                case Op_Add             :   *A=L+R; break;
+                                                case Op_Subtract        :   *A=L-R; break;
+                                                case Op_Multiply        :   *A=L*R; break;
+                                                case Op_Divide          :   *A=L/R; break;
+                                                case Op_Modulo          :   *A=std::fmod(L, R); break;
+                                                case Op_Power           :   *A=std::pow(L, R); break;
+                                                case Op_Less            :   *A=L<R; break;
+                                                case Op_LessOrEqual     :   *A=L<=R; break;
+                                                case Op_Greater         :   *A=L>R; break;
+                                                case Op_GreaterOrEqual  :   *A=L>=R; break;
+                                                case Op_Equal           :   *A=L==R; break;
+                                                case Op_NotEqual        :   *A=L!=R; break;
+                                                case Op_And             :   *A=Truthy(L)?R:L; break; // Operands have no side effect, both are always computed
+                                                case Op_Or              :   *A=Truthy(L)?L:R; break;
+                                                default                 :   *A=Call(Instruction.Function, L, R); // Op_Function2
+                                            }
+                                            Top--;
+                                            }
+        }
+    }
+
+    return Top?Stack[Top-1]:std::numeric_limits<double>::quiet_NaN();
+}
+
+//---------------------------------------------------------------------------
+bool ConditionExpression::Match(double y) const
+{
+    return Truthy(Evaluate(y));
+}
+
+//---------------------------------------------------------------------------
+void ConditionExpression::Match(const StatsValueColumn& Column, size_t Begin, size_t End, std::vector<uint64_t>& Bits) const
+{
+    if (Bits.size()*64<End)
+        Bits.resize((End+63)/64);
+
+    for (size_t Pos=Begin; Pos<End; Pos++)
+    {
+        uint64_t Mask=uint64_t(1)<<(Pos%64);
+        if (Match(Column[Pos]))
+            Bits[Pos/64]|=Mask;
+        else
+            Bits[Pos/64]&=~Mask;
+    }
+}
@@ -0,0 +1,83 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ConditionExpression_H
+#define ConditionExpression_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class StatsValueColumn;
+
+//---------------------------------------------------------------------------
+// Barchart condition (e.g. "y > broadcastmaxval", "(y>310 && y<=360) || y<=8")
+// compiled once to a postfix program, so testing a value does not call the
+// JavaScript engine.
+//
+// Supported is the subset of JavaScript the conditions use on numbers:
+// numbers, y, named constants, + - * / % ** (unary - + !), comparisons
+// (== != === !== < <= > >=), && || ?:, parentheses, pow(), pow2() and the
+// Math functions and constants. Results follow JavaScript (&& and || return
+// one of their operands, NaN is false).
+class ConditionExpression
+{
+public:
+    // Names other than y are resolved by Constant, which returns false if it does not know the name
+    // Returns nullptr if the text can not be compiled (syntax error or not supported), it is then for the JavaScript engine
+    typedef std::function<bool(const std::string& Name, double& Value)> constant_resolver;
+    static std::shared_ptr<const ConditionExpression> Compile(const std::string& Text, const constant_resolver& Constant);
+
+    // Test
+    double                      Evaluate                    (double y) const;
+    bool                        Match                       (double y) const;
+
+    // Bits of the values from Begin to End (excluded) set if the value matches, cleared else (Bits grows if needed)
+    void                        Match                       (const StatsValueColumn& Column, size_t Begin, size_t End, std::vector<uint64_t>& Bits) const;
+
+private:
+    enum opcode : uint8_t
+    {
+        Op_Constant,
+        Op_Y,
+        Op_Negate,
+        Op_Not,
+        Op_Add,
+        Op_Subtract,
+        Op_Multiply,
+        Op_Divide,
+        Op_Modulo,
+        Op_Power,
+        Op_Less,
+        Op_LessOrEqual,
+        Op_Greater,
+        Op_GreaterOrEqual,
+        Op_Equal,
+        Op_NotEqual,
+        Op_And,
+        Op_Or,
+        Op_Select,                                          // ?:
+        Op_Function1,
+        Op_Function2,
+    };
+    struct instruction
+    {
+        opcode                  Op;
+        uint8_t                 Function;                   // Op_Function1 and Op_Function2
+        double                  Value;                      // Op_Constant
+    };
+    static const size_t         Stack_Max=32;
+
+    std::vector<instruction>    Program;
+
+    friend class ConditionExpressionParser;
+};
+
+#endif // ConditionExpression_H
@@ -16,11 +16,61 @@ const char* Version="1.3";
 //---------------------------------------------------------------------------
 const struct stream_info PerStreamType    [Type_Max] =
 {
-    { Group_VideoMax, Item_VideoMax, VideoPerGroup, VideoPerItem, },
-    { Group_AudioMax, Item_AudioMax, AudioPerGroup, AudioPerItem, },
+    { Group_VideoMax, Item_VideoMax, VideoPerGroup, VideoPerItem, VideoAdditionalItems, },
+    { Group_AudioMax, Item_AudioMax, AudioPerGroup, AudioPerItem, AudioAdditionalItems, },
 };
 
 bool isNotAvailable(const char *value)
 {
     return strcmp(value, NOT_AVAILABLE) == 0;
 }
+
+//---------------------------------------------------------------------------
+// Relative to the decoding of the frame, measured on HD content
+double ActiveFilter_Cost(activefilter Filter)
+{
+    switch (Filter)
+    {
+        case ActiveFilter_Video_signalstats:    return 1.0;
+        case ActiveFilter_Video_cropdetect:     return 0.5;
+        case ActiveFilter_Video_Psnr:           return 1.0;
+        case ActiveFilter_Video_Ssim:           return 1.5;
+        case ActiveFilter_Video_Idet:           return 0.5;
+        case ActiveFilter_Video_Deflicker:      return 0.5;
+        case ActiveFilter_Video_Entropy:        return 0.5;
+        case ActiveFilter_Video_EntropyDiff:    return 0.5;
+        case ActiveFilter_Video_blockdetect:    return 1.0;
+        case ActiveFilter_Video_blurdetect:     return 1.0;
+        case ActiveFilter_Video_blackdetect:    return 0.5;
+        case ActiveFilter_Video_freezedetect:   return 0.5;
+        case ActiveFilter_Video_HdrLight:       return 0.5;
+        default:                                return 0.0;
+    }
+}
+
+//---------------------------------------------------------------------------
+// As in the -f option of qcli
+const char* ActiveFilter_Name(activefilter Filter)
+{
+    switch (Filter)
+    {
+        case ActiveFilter_Video_signalstats:    return "signalstats";
+        case ActiveFilter_Video_cropdetect:     return "cropdetect";
+        case ActiveFilter_Video_Psnr:           return "psnr";
+        case ActiveFilter_Audio_EbuR128:        return "ebur128";
+        case ActiveFilter_Audio_aphasemeter:    return "aphasemeter";
+        case ActiveFilter_Audio_astats:         return "astats";
+        case ActiveFilter_Video_Ssim:           return "ssim";
+        case ActiveFilter_Video_Idet:           return "idet";
+        case ActiveFilter_Video_Deflicker:      return "deflicker";
+        case ActiveFilter_Video_Entropy:        return "entropy";
+        case ActiveFilter_Video_EntropyDiff:    return "entropy-diff";
+        case ActiveFilter_Video_blockdetect:    return "blockdetect";
+        case ActiveFilter_Video_blurdetect:     return "blurdetect";
+        case ActiveFilter_Video_blackdetect:    return "blackdetect";
+        case ActiveFilter_Video_freezedetect:   return "freezedetect";
+        case ActiveFilter_Audio_silencedetect:  return "silencedetect";
+        case ActiveFilter_Video_HdrLight:       return "hdr";
+        default:                                return "";
+    }
+}
@@ -35,10 +35,19 @@ enum activefilter
     ActiveFilter_Video_EntropyDiff,
     ActiveFilter_Video_blockdetect,
     ActiveFilter_Video_blurdetect,
+    ActiveFilter_Video_blackdetect,
+    ActiveFilter_Video_freezedetect,
+    ActiveFilter_Audio_silencedetect,
+    ActiveFilter_Video_HdrLight,
     ActiveFilter_Max //Note: always add a new ActiveFilter element before ActiveFilter_Max, never before any other element, else preferences of people already having the tool will be shifted when preferences are read from the profile
 };
 typedef std::bitset<ActiveFilter_Max> activefilters;
 
+// Cost of a video filter relative to the decoding of the frame, 0 for audio filters
+double ActiveFilter_Cost(activefilter Filter);
+// Name of the filter in the options of qcli ("signalstats", "entropy-diff"...)
+const char* ActiveFilter_Name(activefilter Filter);
+
 struct per_group
 {
     const   std::size_t Start; //Item
@@ -69,12 +78,28 @@ struct per_item
     const   char*       fillInfo { nullptr };
 };
 
+// Metadata of the filters which is not plotted, kept as additional stats of the stream (see CommonStats::AdditionalStats_Declare)
+enum additional_type
+{
+    Additional_Int,
+    Additional_Double,
+    Additional_String,
+};
+
+struct additional_item
+{
+    const   char*           FFmpeg_Name;
+    const   additional_type Type;
+    const   activefilter    Filter;
+};
+
 struct stream_info
 {
     size_t                      CountOfGroups;
     size_t                      CountOfItems;
     const struct per_group*     PerGroup;
     const struct per_item*      PerItem;
+    const struct additional_item* AdditionalItems;          // Terminated by a NULL FFmpeg_Name
 
     struct per_group*           GetPerGroup(int group) const {
         return const_cast<struct per_group*> (PerGroup) + group;
@@ -0,0 +1,177 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/CpuFeatures.h"
+
+extern "C"
+{
+#include <libavutil/cpu.h>
+}
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define CPUFEATURES_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define CPUFEATURES_NEON
+#endif
+
+//---------------------------------------------------------------------------
+static const char* const Names[CpuFeatures::Level_Max]=
+{
+    "c",
+    "avx2",
+    "avx512",
+    "neon",
+};
+
+struct flag
+{
+    int                         Flag;
+    const char*                 Name;
+};
+
+static const flag Flags[]=
+{
+#if defined(CPUFEATURES_X86)
+    { AV_CPU_FLAG_MMX,          "mmx"       },
+    { AV_CPU_FLAG_SSE,          "sse"       },
+    { AV_CPU_FLAG_SSE2,         "sse2"      },
+    { AV_CPU_FLAG_SSE3,         "sse3"      },
+    { AV_CPU_FLAG_SSSE3,        "ssse3"     },
+    { AV_CPU_FLAG_SSE4,         "sse4.1"    },
+    { AV_CPU_FLAG_SSE42,        "sse4.2"    },
+    { AV_CPU_FLAG_AVX,          "avx"       },
+    { AV_CPU_FLAG_AVX2,         "avx2"      },
+    { AV_CPU_FLAG_FMA3,         "fma3"      },
+    { AV_CPU_FLAG_BMI2,         "bmi2"      },
+    #if defined(AV_CPU_FLAG_AVX512)
+    { AV_CPU_FLAG_AVX512,       "avx512"    },
+    #endif
+    #if defined(AV_CPU_FLAG_AVX512ICL)
+    { AV_CPU_FLAG_AVX512ICL,    "avx512icl" },
+    #endif
+#elif defined(CPUFEATURES_NEON)
+    { AV_CPU_FLAG_ARMV8,        "armv8"     },
+    { AV_CPU_FLAG_NEON,         "neon"      },
+    { AV_CPU_FLAG_VFP,          "vfp"       },
+    #if defined(AV_CPU_FLAG_DOTPROD)
+    { AV_CPU_FLAG_DOTPROD,      "dotprod"   },
+    #endif
+    #if defined(AV_CPU_FLAG_I8MM)
+    { AV_CPU_FLAG_I8MM,         "i8mm"      },
+    #endif
+#endif
+    { 0,                        nullptr     },
+};
+
+// Level_Max until the first Get()
+static std::atomic<int> Selected(CpuFeatures::Level_Max);
+
+//***************************************************************************
+// Levels
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const char* CpuFeatures::Name(level Level)
+{
+    return Level<Level_Max?Names[Level]:"";
+}
+
+//---------------------------------------------------------------------------
+CpuFeatures::level CpuFeatures::FromName(const std::string& Name)
+{
+    for (int Level=0; Level<Level_Max; Level++)
+        if (Name==Names[Level])
+            return (level)Level;
+    return Level_Max;
+}
+
+//---------------------------------------------------------------------------
+bool CpuFeatures::IsAvailable(level Level)
+{
+    int CpuFlags=av_get_cpu_flags();
+    switch (Level)
+    {
+        case Level_C        : return true;
+#if defined(CPUFEATURES_X86)
+        case Level_AVX2     : return (CpuFlags&AV_CPU_FLAG_AVX2)!=0;
+    #if defined(AV_CPU_FLAG_AVX512)
+        case Level_AVX512   : return (CpuFlags&AV_CPU_FLAG_AVX512)!=0;
+    #endif
+#elif defined(CPUFEATURES_NEON)
+        case Level_NEON     : return (CpuFlags&AV_CPU_FLAG_NEON)!=0;
+#endif
+        default             : return false;
+    }
+}
+
+//---------------------------------------------------------------------------
+CpuFeatures::level CpuFeatures::Best()
+{
+    for (int Level=Level_Max-1; Level>Level_C; Level--)
+        if (IsAvailable((level)Level))
+            return (level)Level;
+    return Level_C;
+}
+
+//---------------------------------------------------------------------------
+CpuFeatures::level CpuFeatures::Get()
+{
+    int Level=Selected.load(std::memory_order_relaxed);
+    if (Level==Level_Max)
+    {
+        Level=Best();
+        int Expected=Level_Max;
+        if (!Selected.compare_exchange_strong(Expected, Level, std::memory_order_relaxed))
+            Level=Expected; // Set meanwhile
+    }
+    return (level)Level;
+}
+
+//---------------------------------------------------------------------------
+bool CpuFeatures::Set(level Level)
+{
+    if (!IsAvailable(Level))
+        return false;
+    Selected.store(Level, std::memory_order_relaxed);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool CpuFeatures::Uses(level Level)
+{
+    level Current=Get();
+    switch (Level)
+    {
+        case Level_C        : return true;
+        case Level_AVX2     : return Current==Level_AVX2 || Current==Level_AVX512;
+        case Level_AVX512   : return Current==Level_AVX512;
+        case Level_NEON     : return Current==Level_NEON;
+        default             : return false;
+    }
+}
+
+//***************************************************************************
+// Info
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+std::string CpuFeatures::Features()
+{
+    int CpuFlags=av_get_cpu_flags();
+    std::string Result;
+    for (auto Item=Flags; Item->Name; Item++)
+    {
+        if (!(CpuFlags&Item->Flag))
+            continue;
+        if (!Result.empty())
+            Result+=' ';
+        Result+=Item->Name;
+    }
+    return Result;
+}
@@ -0,0 +1,55 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef CpuFeatures_H
+#define CpuFeatures_H
+
+#include <string>
+
+//---------------------------------------------------------------------------
+// Instruction set of the native kernels (SignalStatsKernel, FieldCompareKernel,
+// AudioStatsKernel...), selected at run time: the kernels are built with a
+// variant per level (target attributes, the rest of the file is built for the
+// baseline of the build) and call the one of the selected level.
+//
+// The features of the CPU come from av_get_cpu_flags(), CPUID and XGETBV on
+// x86 (so AVX-512 is not used if the OS does not save its registers) and the
+// hwcaps on Arm. The best level available is selected, unless another one is
+// set (qcli -cpu) to compare the variants or to reproduce the values of
+// another machine.
+class CpuFeatures
+{
+public:
+    enum level
+    {
+        Level_C,                    // Portable code
+        Level_AVX2,                 // x86-64 with AVX2
+        Level_AVX512,               // x86-64 with AVX-512 F, CD, BW, DQ and VL, AVX2 included
+        Level_NEON,                 // AArch64 (NEON is in its baseline)
+        Level_Max
+    };
+
+    // Name of the level ("c", "avx2", "avx512", "neon"), Level_Max for a name not known
+    static const char*          Name                        (level Level);
+    static level                FromName                    (const std::string& Name);
+
+    // Variants of the level built and supported by the CPU
+    static bool                 IsAvailable                 (level Level);
+    static level                Best                        ();
+
+    // Level used by the kernels, Best() unless set; false if not available
+    static level                Get                         ();
+    static bool                 Set                         (level Level);
+
+    // True if the selected level has the instructions of Level (AVX-512 has AVX2)
+    static bool                 Uses                        (level Level);
+
+    // Features of the CPU as flags of FFmpeg ("sse2 sse4.2 avx avx2 fma3 avx512"...)
+    static std::string          Features                    ();
+};
+
+#endif // CpuFeatures_H
@@ -0,0 +1,179 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/ExportQueue.h"
+#include "Core/FileInformation.h"
+
+#include <QThread>
+#include <algorithm>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+ExportQueue::ExportQueue(QObject* Parent)
+: QObject(Parent),
+  MaxRunning(DefaultRunning())
+{
+}
+
+//---------------------------------------------------------------------------
+// Running exports are not stopped, the files wait for their thread when deleted
+ExportQueue::~ExportQueue()
+{
+    for (auto& Job : Jobs)
+        for (auto& Connection : Job.Connections)
+            disconnect(Connection);
+}
+
+//***************************************************************************
+// Settings
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int ExportQueue::DefaultRunning()
+{
+    return std::max(1, std::min(QThread::idealThreadCount()/2, 4));
+}
+
+//---------------------------------------------------------------------------
+void ExportQueue::MaxRunning_Set(int Count)
+{
+    MaxRunning=std::max(1, Count);
+    Next();
+}
+
+//---------------------------------------------------------------------------
+void ExportQueue::Add(FileInformation* File, const QString& FileName, Format Format_, const activefilters& Filters)
+{
+    if (!File || std::any_of(Jobs.begin(), Jobs.end(), [File](const job& Job) { return Job.File==File; }))
+        return;
+
+    Jobs.emplace_back();
+    job& Job=Jobs.back();
+    Job.File=File;
+    Job.FileName=FileName;
+    Job.Format_=Format_;
+    Job.Filters=Filters;
+
+    Next();
+    Emit();
+}
+
+//---------------------------------------------------------------------------
+void ExportQueue::Current_Set(const FileInformation* File)
+{
+    Current=File;
+}
+
+//***************************************************************************
+// Info
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool ExportQueue::IsActive() const
+{
+    return !Jobs.empty();
+}
+
+//---------------------------------------------------------------------------
+int ExportQueue::Percent() const
+{
+    if (!Total())
+        return 100;
+    double Sum=DoneCount;
+    for (const auto& Job : Jobs)
+        Sum+=Job.Progress;
+    return (int)(Sum*100/Total());
+}
+
+//***************************************************************************
+// Internal
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ExportQueue::Next()
+{
+    int Running=(int)std::count_if(Jobs.begin(), Jobs.end(), [](const job& Job) { return Job.Running; });
+    for (auto Job=Jobs.begin(); Job!=Jobs.end() && Running<MaxRunning;)
+    {
+        auto Current_Job=Job++;
+        if (Current_Job->Running)
+            continue;
+
+        // Closed or busy with its own export (e.g. the auto upload), not exported
+        FileInformation* File=Current_Job->File;
+        if (!File || File->isRunning())
+        {
+            Jobs.erase(Current_Job);
+            DoneCount++;
+            continue;
+        }
+
+        // XML part of a .qctools.mkv report is the first half of its progress, the thumbnails and panels are the rest
+        double Scale=Current_Job->Format_==Format_Mkv?0.5:1;
+        Current_Job->Connections[0]=connect(File, &FileInformation::statsFileGenerationProgress, this, [this, Current_Job, Scale](quint64 Frames, quint64 Total) {
+            Current_Job->Progress=Total?Scale*Frames/Total:0;
+            Q_EMIT progressChanged(Current_Job->File, (int)(Current_Job->Progress*100));
+            Emit();
+        });
+        Current_Job->Connections[1]=connect(File, &FileInformation::exportCompleted, this, [this, Current_Job]() {
+            Completed(Current_Job);
+        });
+        Current_Job->Connections[2]=connect(File, &QObject::destroyed, this, [this, Current_Job]() {
+            Completed(Current_Job);
+        });
+
+        Current_Job->Running=true;
+        Running++;
+        File->setExportFilters(Current_Job->Filters);
+        if (Current_Job->Format_==Format_Mkv)
+            File->startMkvExport(Current_Job->FileName);
+        else
+            File->startExport(Current_Job->FileName);
+    }
+}
+
+//---------------------------------------------------------------------------
+void ExportQueue::Completed(std::list<job>::iterator Job)
+{
+    for (auto& Connection : Job->Connections)
+        disconnect(Connection);
+
+    FileInformation* File=Job->File;
+    QString FileName=Job->FileName;
+    bool WasRunning=Job->Running;
+    Jobs.erase(Job);
+    DoneCount++;
+
+    if (File && WasRunning)
+    {
+        // Signal sent just before the end of the thread of the file
+        File->wait();
+        if (File!=Current)
+            File->releaseMemory();
+        Q_EMIT progressChanged(File, 100);
+        Q_EMIT exported(File, FileName);
+    }
+
+    Next();
+    Emit();
+}
+
+//---------------------------------------------------------------------------
+// The counts restart once the queue is empty
+void ExportQueue::Emit()
+{
+    Q_EMIT queueProgressChanged((int)Done(), (int)Total(), Percent());
+    if (Jobs.empty() && DoneCount)
+    {
+        DoneCount=0;
+        Q_EMIT finished();
+    }
+}
@@ -0,0 +1,87 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ExportQueue_H
+#define ExportQueue_H
+
+#include "Core/Core.h"
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <list>
+
+class FileInformation;
+
+//---------------------------------------------------------------------------
+// Reports of several files written at the same time, each one by the thread
+// of its file (see FileInformation::startExport), a bounded count at a time.
+//
+// The gzip members of each report are already deflated by the global thread
+// pool (see StatsGzipMembers), so the default count is half of the cores, and
+// at most 4 reports are written at a time on the disk. The memory of a file
+// is released with its export (see FileInformation::releaseMemory), except
+// for the file displayed.
+// GUI thread only.
+class ExportQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format
+    {
+        Format_XmlGz,
+        Format_Mkv,
+    };
+
+    explicit                    ExportQueue                 (QObject* Parent=nullptr);
+                                ~ExportQueue                ();
+
+    static int                  DefaultRunning              ();
+    void                        MaxRunning_Set              (int Count);
+
+    // Started after the files added before, not added if the file is already queued or exporting
+    void                        Add                         (FileInformation* File, const QString& FileName, Format Format_, const activefilters& Filters);
+
+    // File kept in memory when its export is done
+    void                        Current_Set                 (const FileInformation* File);
+
+    // Since the queue was empty
+    bool                        IsActive                    () const;
+    size_t                      Done                        () const {return DoneCount;}
+    size_t                      Total                       () const {return DoneCount+Jobs.size();}
+    int                         Percent                     () const;
+
+Q_SIGNALS:
+    void                        progressChanged             (FileInformation* File, int Percent);
+    void                        queueProgressChanged        (int Done, int Total, int Percent);
+    void                        exported                    (FileInformation* File, const QString& FileName);
+    void                        finished                    ();
+
+private:
+    struct job
+    {
+        QPointer<FileInformation> File;
+        QString                 FileName;
+        Format                  Format_;
+        activefilters           Filters;
+        bool                    Running=false;
+        double                  Progress=0;                 // From 0 to 1
+        QMetaObject::Connection Connections[3];
+    };
+
+    void                        Next                        ();
+    void                        Completed                   (std::list<job>::iterator Job);
+    void                        Emit                        ();
+
+    std::list<job>              Jobs;                       // Queued and running
+    int                         MaxRunning;
+    size_t                      DoneCount=0;
+    const FileInformation*      Current=nullptr;
+};
+
+#endif // ExportQueue_H
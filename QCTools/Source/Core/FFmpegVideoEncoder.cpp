@@ -1,4 +1,5 @@
 #include "FFmpegVideoEncoder.h"
+#include "TraceEvents.h"
 
 extern "C"
 {
@@ -32,10 +33,16 @@ extern "C"
 }
 
 #include <cassert>
+#include <deque>
 #include <memory>
 #include <functional>
+#include <limits>
+#include <thread>
 #include <QDebug>
+#include <QFile>
 #include <QFileInfo>
+#include <QMutex>
+#include <QWaitCondition>
 
 FFmpegVideoEncoder::FFmpegVideoEncoder(QObject *parent) : QObject(parent)
 {
@@ -51,6 +58,136 @@ void FFmpegVideoEncoder::setMetadata(const Metadata &metadata)
     m_metadata = metadata;
 }
 
+FFmpegVideoEncoder::Codec FFmpegVideoEncoder::Codec::parse(const QString &text)
+{
+    Codec codec;
+    auto items = text.split(':');
+    if(!items.front().isEmpty())
+        codec.name = items.front();
+
+    for(auto i = 1; i < items.size(); ++i) {
+        auto equal = items[i].indexOf('=');
+        if(equal > 0)
+            codec.options[items[i].left(equal)] = items[i].mid(equal + 1);
+    }
+
+    return codec;
+}
+
+QString FFmpegVideoEncoder::Codec::toString() const
+{
+    QString text = name;
+    for(auto it = options.begin(); it != options.end(); ++it)
+        text += QString(":%1=%2").arg(it.key()).arg(it.value());
+
+    return text;
+}
+
+QString FFmpegVideoEncoder::Codec::check() const
+{
+    auto codec = encoder();
+    if(!codec)
+        return QString("no %1 encoder").arg(name);
+    if(codec->type != AVMEDIA_TYPE_VIDEO)
+        return QString("%1 is not a video encoder").arg(name);
+    // Each frame must give its packet, the encoders are not flushed
+    if(codec->capabilities & AV_CODEC_CAP_DELAY)
+        return QString("%1 encoder delays the frames, it is not supported").arg(name);
+    if(pixelFormat() == AV_PIX_FMT_NONE)
+        return QString("unknown pixel format %1").arg(options.value("pix_fmt"));
+
+    return QString();
+}
+
+const AVCodec *FFmpegVideoEncoder::Codec::encoder() const
+{
+    return avcodec_find_encoder_by_name(name.toUtf8().constData());
+}
+
+AVPixelFormat FFmpegVideoEncoder::Codec::pixelFormat() const
+{
+    if(options.contains("pix_fmt"))
+        return av_get_pix_fmt(options.value("pix_fmt").toUtf8().constData());
+
+    auto codec = encoder();
+    if(!codec)
+        return AV_PIX_FMT_YUVJ420P;
+
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+    const void* formats = nullptr;
+    int count = 0;
+    if(avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_PIX_FORMAT, 0, &formats, &count) < 0 || !formats || !count)
+        return AV_PIX_FMT_YUVJ420P;
+
+    return static_cast<const AVPixelFormat*>(formats)[0];
+#else
+    if(!codec->pix_fmts)
+        return AV_PIX_FMT_YUVJ420P;
+
+    return codec->pix_fmts[0];
+#endif //
+}
+
+AVDictionary *FFmpegVideoEncoder::Codec::dictionary() const
+{
+    AVDictionary* dictionary = nullptr;
+    for(auto it = options.begin(); it != options.end(); ++it) {
+        if(it.key() != "pix_fmt")
+            av_dict_set(&dictionary, it.key().toUtf8().constData(), it.value().toUtf8().constData(), 0);
+    }
+
+    return dictionary;
+}
+
+void FFmpegVideoEncoder::setParallel(bool parallel)
+{
+    m_parallel = parallel;
+}
+
+void FFmpegVideoEncoder::setProgress(const std::function<void()>& progress)
+{
+    m_progress = progress;
+}
+
+// Stream of the report, the last one of the file
+static bool addAttachment(AVFormatContext* oc, const QByteArray& attachment, const QString& attachmentName)
+{
+    AVStream* attachmentStream = avformat_new_stream(oc, NULL);
+    if (!attachmentStream) {
+        qDebug() << "Could not allocate attachment stream\n";
+        return false;
+    }
+
+    attachmentStream->id = oc->nb_streams-1;
+
+    AVCodecContext* attachementEncCtx = avcodec_alloc_context3(NULL);
+    if (!attachementEncCtx) {
+        qDebug() << "Error allocating the encoding context.\n";
+        return false;
+    }
+
+    attachementEncCtx->codec_type = AVMEDIA_TYPE_ATTACHMENT;
+    attachementEncCtx->codec_id = AV_CODEC_ID_BIN_DATA;
+    attachementEncCtx->extradata_size = attachment.size();
+    attachementEncCtx->extradata = static_cast<uint8_t*> (av_malloc(attachementEncCtx->extradata_size));
+    memcpy(attachementEncCtx->extradata, attachment.data(), attachementEncCtx->extradata_size);
+
+    /* copy the stream parameters to the muxer */
+    int ret = avcodec_parameters_from_context(attachmentStream->codecpar, attachementEncCtx);
+    avcodec_free_context(&attachementEncCtx);
+    if (ret < 0) {
+        qDebug() << "error on avcodec_parameters_from_context\n";
+        return false;
+    }
+
+    auto attachmentFileName = attachmentName.toStdString();
+    const char* p = strrchr(attachmentFileName.c_str(), '/');
+    av_dict_set(&attachmentStream->metadata, "filename", (p && *p) ? p + 1 : attachmentFileName.c_str(), AV_DICT_DONT_OVERWRITE);
+    // Columns reports are not compressed, so they can be mapped from the file
+    av_dict_set(&attachmentStream->metadata, "mimetype", attachmentName.endsWith(".gz") ? "application/x-gzip" : "application/octet-stream", AV_DICT_DONT_OVERWRITE);
+    return true;
+}
+
 void FFmpegVideoEncoder::makeVideo(const QString &video, const QVector<Source>& sources,
                                    const QByteArray& attachment, const QString& attachmentName)
 {
@@ -73,14 +210,13 @@ void FFmpegVideoEncoder::makeVideo(const QString &video, const QVector<Source>&
         avformat_alloc_output_context2(&oc, NULL, "mkv", filename.c_str());
     }
 
-    // Add the AV_CODEC_ID_MJPEG video stream
-    auto videoCodec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
-    if(!videoCodec) {
-        qDebug() << "Error resolving AV_CODEC_ID_MJPEG codec";
-        return;
-    }
-
     for(auto & source : sources) {
+        auto videoCodec = source.codec.encoder();
+        if(!videoCodec) {
+            qDebug() << "Error resolving" << source.codec.name << "encoder";
+            return;
+        }
+
         auto videoEncCtx = avcodec_alloc_context3(videoCodec);
         if (!videoEncCtx) {
             qDebug() << "Could not alloc an encoding context\n";
@@ -106,19 +242,12 @@ void FFmpegVideoEncoder::makeVideo(const QString &video, const QVector<Source>&
         videoEncCtx->time_base.den = source.den;
 
         videoEncCtx->gop_size      = 1; /* emit one intra frame every twelve frames at most */
-        videoEncCtx->pix_fmt       = AV_PIX_FMT_YUVJ422P;
+        videoEncCtx->pix_fmt       = source.codec.pixelFormat();
         videoEncCtx->max_b_frames  = 0;
 
-        if (videoEncCtx->codec_id == AV_CODEC_ID_MPEG2VIDEO) {
-            /* just for testing, we also add B-frames */
-            videoEncCtx->max_b_frames = 2;
-        }
-        if (videoEncCtx->codec_id == AV_CODEC_ID_MPEG1VIDEO) {
-            /* Needed to avoid using macroblocks in which some coeffs overflow.
-             * This does not happen with normal video, it just happens here as
-             * the motion of the chroma plane does not match the luma plane. */
-            videoEncCtx->mb_decision = 2;
-        }
+        /* Some formats want stream headers to be separate. */
+        if (oc->oformat->flags & AVFMT_GLOBALHEADER)
+            videoEncCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
         AVStream* videoStream = avformat_new_stream(oc, videoCodec);
         if (!videoStream) {
@@ -128,8 +257,18 @@ void FFmpegVideoEncoder::makeVideo(const QString &video, const QVector<Source>&
 
         videoStream->id = oc->nb_streams-1;
 
+        // Opened with the options of the encoder of the packets, so the extradata (FFV1, H.264...) is the same
+        AVDictionary* options = source.codec.dictionary();
+        int ret = avcodec_open2(videoEncCtx, videoCodec, &options);
+        av_dict_free(&options);
+        if(ret < 0) {
+            char errbuf[255];
+            qDebug() << "Could not open codec: " << av_make_error_string(errbuf, sizeof errbuf, ret) << "\n";
+            return;
+        }
+
         /* copy the stream parameters to the muxer */
-        int ret = avcodec_parameters_from_context(videoStream->codecpar, videoEncCtx);
+        ret = avcodec_parameters_from_context(videoStream->codecpar, videoEncCtx);
         if (ret < 0 ) {
             qDebug() << "error on avcodec_parameters_from_context\n";
             return;
@@ -138,58 +277,19 @@ void FFmpegVideoEncoder::makeVideo(const QString &video, const QVector<Source>&
         videoStream->avg_frame_rate.den = videoEncCtx->time_base.num;
         videoStream->avg_frame_rate.num = videoEncCtx->time_base.den;
 
-        ret = avcodec_open2(videoEncCtx, videoCodec, NULL);
-        if(ret < 0) {
-            char errbuf[255];
-            qDebug() << "Could not open codec: " << av_make_error_string(errbuf, sizeof errbuf, ret) << "\n";
-            return;
-        }
-
-        /* Some formats want stream headers to be separate. */
-        if (oc->oformat->flags & AVFMT_GLOBALHEADER)
-            videoEncCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
-
         streams.push_back(videoStream);
     }
 
     ///////////////////////////////
     /// attachements
 
-    AVStream* attachmentStream = avformat_new_stream(oc, NULL);
-    if (!attachmentStream) {
-        qDebug() << "Could not allocate attachment stream\n";
-        return;
-    }
-
-    attachmentStream->id = oc->nb_streams-1;
-
-    AVCodecContext* attachementEncCtx = avcodec_alloc_context3(NULL);
-    if (!attachementEncCtx) {
-        qDebug() << "Error allocating the encoding context.\n";
+    if (!addAttachment(oc, attachment, attachmentName))
         return;
-    }
-
-    std::unique_ptr<AVCodecContext, ContextDeleter> attachementEncCtxPtr(attachementEncCtx, ContextDeleter());
-    contexts.push_back(std::move(attachementEncCtxPtr));
-
-    attachementEncCtx->codec_type = AVMEDIA_TYPE_ATTACHMENT;
-    attachementEncCtx->codec_id = AV_CODEC_ID_BIN_DATA;
-    attachementEncCtx->extradata_size = attachment.size();
-    attachementEncCtx->extradata = static_cast<uint8_t*> (av_malloc(attachementEncCtx->extradata_size));
-    memcpy(attachementEncCtx->extradata, attachment.data(), attachementEncCtx->extradata_size);
-
-    /* copy the stream parameters to the muxer */
-    int ret = avcodec_parameters_from_context(attachmentStream->codecpar, attachementEncCtx);
-
-    auto attachmentFileName = attachmentName.toStdString();
-    const char* p = strrchr(attachmentFileName.c_str(), '/');
-    av_dict_set(&attachmentStream->metadata, "filename", (p && *p) ? p + 1 : attachmentFileName.c_str(), AV_DICT_DONT_OVERWRITE);
-    av_dict_set(&attachmentStream->metadata, "mimetype", "application/x-gzip", AV_DICT_DONT_OVERWRITE);
 
     av_dump_format(oc, 0, filename.c_str(), 1);
 
     /* open the output file, if needed */
-    ret = avio_open(&oc->pb, filename.c_str(), AVIO_FLAG_WRITE);
+    int ret = avio_open(&oc->pb, filename.c_str(), AVIO_FLAG_WRITE);
     if (ret < 0) {
         char errbuf[255];
         fprintf(stderr, "Could not open '%s': %s\n", filename.c_str(), av_make_error_string(errbuf, sizeof errbuf, ret));
@@ -216,33 +316,151 @@ void FFmpegVideoEncoder::makeVideo(const QString &video, const QVector<Source>&
     /* Write the stream header, if any. */
     ret = avformat_write_header(oc, NULL);
 
-    AVPacket newPacket;
-
-    for(auto i = 0; i < streams.length(); ++i)
-    {
-        auto source = sources[i];
+    auto writePacket = [&](int i, const std::shared_ptr<AVPacket>& packet) {
+        const auto& source = sources[i];
         auto stream = streams[i];
 
-        std::shared_ptr<AVPacket> packet;
-        while(source.getPacket && (packet = source.getPacket())) {
+        AVPacket newPacket;
+        av_init_packet(&newPacket);
+        av_packet_ref(&newPacket, packet.get());
 
-            av_init_packet(&newPacket);
-            av_packet_ref(&newPacket, packet.get());
+        newPacket.stream_index = stream->index;
 
-            newPacket.stream_index = stream->index;
+        AVRational src;
+        src.den = source.den;
+        src.num = source.num;
 
-            AVRational src;
-            src.den = source.den;
-            src.num = source.num;
+        // for some reasons ffmpeg changes time_base for stream (and it doesn't matter what was set before)
+        // so here we have too recalculate pts based on new stream's time_base value
+        av_packet_rescale_ts(&newPacket, src, stream->time_base);
 
-            // for some reasons ffmpeg changes time_base for stream (and it doesn't matter what was set before)
-            // so here we have too recalculate pts based on new stream's time_base value
-            av_packet_rescale_ts(&newPacket, src, stream->time_base);
+        TraceEvents::Scope Trace("encoder", "mux packet", newPacket.stream_index);
+        av_interleaved_write_frame(oc, &newPacket);
+        av_packet_unref(&newPacket);
+    };
 
-            av_interleaved_write_frame(oc, &newPacket);
-            av_packet_unref(&newPacket);
+    if(!m_parallel || streams.length() < 2)
+    {
+        for(auto i = 0; i < streams.length(); ++i)
+        {
+            const auto& source = sources[i];
+
+            std::shared_ptr<AVPacket> packet;
+            while(source.getPacket && (packet = source.getPacket())) {
+                writePacket(i, packet);
+                if(m_progress)
+                    m_progress();
+            }
         }
     }
+    else
+    {
+        // One encoding thread per source, packets are interleaved by timestamp here
+        struct queue {
+            QMutex mutex;
+            QWaitCondition condition;
+            std::deque<std::shared_ptr<AVPacket>> packets;
+            bool finished { false };
+        };
+        static const size_t queueMax = 16;
+
+        std::vector<std::unique_ptr<queue>> queues;
+        std::vector<std::thread> workers;
+        QMutex writerMutex;
+        QWaitCondition writerCondition;
+        quint64 events = 0; // Packets queued and sources finished, for not missing a wake up
+
+        for(auto i = 0; i < streams.length(); ++i)
+            queues.emplace_back(new queue);
+
+        for(auto i = 0; i < streams.length(); ++i)
+        {
+            auto getPacket = sources[i].getPacket;
+            auto Queue = queues[i].get();
+            workers.emplace_back([&, getPacket, Queue]() {
+                std::shared_ptr<AVPacket> packet;
+                while(getPacket && (packet = getPacket())) {
+                    QMutexLocker locker(&Queue->mutex);
+                    while(Queue->packets.size() >= queueMax)
+                        Queue->condition.wait(&Queue->mutex);
+                    Queue->packets.push_back(packet);
+                    locker.unlock();
+
+                    QMutexLocker writerLocker(&writerMutex);
+                    ++events;
+                    writerCondition.wakeOne();
+                }
+
+                QMutexLocker locker(&Queue->mutex);
+                Queue->finished = true;
+                locker.unlock();
+
+                QMutexLocker writerLocker(&writerMutex);
+                ++events;
+                writerCondition.wakeOne();
+            });
+        }
+
+        for(;;)
+        {
+            // The next packet is the first one in time of all the sources, once each running source has one
+            writerMutex.lock();
+            auto eventsSeen = events;
+            writerMutex.unlock();
+
+            int next = -1;
+            bool waiting = false;
+            std::shared_ptr<AVPacket> nextPacket;
+            for(auto i = 0; i < streams.length(); ++i)
+            {
+                auto& Queue = *queues[i];
+                QMutexLocker locker(&Queue.mutex);
+                if(Queue.packets.empty())
+                {
+                    if(!Queue.finished)
+                        waiting = true;
+                    continue;
+                }
+
+                const auto& packet = Queue.packets.front();
+                auto ts = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+                auto nextTs = nextPacket ? (nextPacket->dts != AV_NOPTS_VALUE ? nextPacket->dts : nextPacket->pts) : 0;
+                if(!nextPacket || av_compare_ts(ts, AVRational { sources[i].num, sources[i].den }, nextTs, AVRational { sources[next].num, sources[next].den }) < 0)
+                {
+                    next = i;
+                    nextPacket = packet;
+                }
+            }
+
+            if(waiting)
+            {
+                // Progress is also updated while waiting, encoding of a frame may be long
+                QMutexLocker writerLocker(&writerMutex);
+                if(events == eventsSeen)
+                    writerCondition.wait(&writerMutex, 100);
+                writerLocker.unlock();
+                if(m_progress)
+                    m_progress();
+                continue;
+            }
+
+            if(next == -1)
+                break;
+
+            {
+                auto& Queue = *queues[next];
+                QMutexLocker locker(&Queue.mutex);
+                Queue.packets.pop_front();
+                Queue.condition.wakeOne();
+            }
+            writePacket(next, nextPacket);
+            if(m_progress)
+                m_progress();
+        }
+
+        for(auto& worker : workers)
+            worker.join();
+    }
 
     //Write file trailer
     av_write_trailer(oc);
@@ -254,3 +472,113 @@ void FFmpegVideoEncoder::makeVideo(const QString &video, const QVector<Source>&
     avformat_free_context(oc);
 }
 
+
+bool FFmpegVideoEncoder::remuxVideo(const QString& video, const QString& source, const Codec& thumbnailsCodec, const Codec& panelsCodec,
+                                    const QByteArray& attachment, const QString& attachmentName,
+                                    const std::vector<std::pair<int64_t, int64_t>>& ranges)
+{
+    auto thumbnailsEncoder = thumbnailsCodec.encoder();
+    auto panelsEncoder = panelsCodec.encoder();
+    if (!thumbnailsEncoder || !panelsEncoder)
+        return false;
+
+    auto sourceName = source.toStdString();
+    AVFormatContext* ic = nullptr;
+    if (avformat_open_input(&ic, sourceName.c_str(), NULL, NULL) < 0)
+        return false;
+    std::unique_ptr<AVFormatContext, void(*)(AVFormatContext*)> icPtr(ic, [](AVFormatContext* context) { avformat_close_input(&context); });
+    if (avformat_find_stream_info(ic, NULL) < 0)
+        return false;
+
+    // Written next to the file then renamed, the source may be the file replaced
+    auto filename = (video + ".tmp").toStdString();
+    AVFormatContext* oc = nullptr;
+    avformat_alloc_output_context2(&oc, NULL, "matroska", filename.c_str());
+    if (!oc)
+        return false;
+    std::unique_ptr<AVFormatContext, void(*)(AVFormatContext*)> ocPtr(oc, [](AVFormatContext* context) {
+        if (context->pb)
+            avio_closep(&context->pb);
+        avformat_free_context(context);
+    });
+
+    // Same streams (thumbnails, panels), without the attachment of the old report
+    std::vector<int> streamMap(ic->nb_streams, -1);
+    std::vector<std::pair<int64_t, int64_t>> streamRanges(ic->nb_streams, { 0, std::numeric_limits<int64_t>::max() });
+    std::vector<int64_t> streamPackets(ic->nb_streams, 0);
+    size_t videoStreams = 0;
+    bool isThumbnails = true;
+    for (unsigned i = 0; i < ic->nb_streams; ++i) {
+        auto inStream = ic->streams[i];
+        if (inStream->codecpar->codec_type != AVMEDIA_TYPE_VIDEO)
+            continue;
+
+        // Encoded again if the encoder set is not the one of the report
+        if (inStream->codecpar->codec_id != (isThumbnails ? thumbnailsEncoder : panelsEncoder)->id)
+            return false;
+        isThumbnails = false;
+
+        AVStream* outStream = avformat_new_stream(oc, NULL);
+        if (!outStream || avcodec_parameters_copy(outStream->codecpar, inStream->codecpar) < 0)
+            return false;
+        outStream->codecpar->codec_tag = 0;
+        outStream->time_base = inStream->time_base;
+        outStream->avg_frame_rate = inStream->avg_frame_rate;
+        av_dict_copy(&outStream->metadata, inStream->metadata, 0);
+        streamMap[i] = outStream->index;
+        if (!ranges.empty())
+            streamRanges[i] = videoStreams < ranges.size() ? ranges[videoStreams] : std::pair<int64_t, int64_t>(0, 0);
+        ++videoStreams;
+    }
+
+    if (isThumbnails || !addAttachment(oc, attachment, attachmentName))
+        return false;
+
+    av_dict_copy(&oc->metadata, ic->metadata, 0);
+    for (auto & entry : m_metadata)
+        av_dict_set(&oc->metadata, entry.first.toStdString().c_str(), entry.second.toStdString().c_str(), 0);
+
+    if (avio_open(&oc->pb, filename.c_str(), AVIO_FLAG_WRITE) < 0 || avformat_write_header(oc, NULL) < 0)
+        return false;
+
+    std::unique_ptr<AVPacket, void(*)(AVPacket*)> packet(av_packet_alloc(), [](AVPacket* packet) { av_packet_free(&packet); });
+    bool ok = true;
+    auto rangesLeft = [&]() {
+        for (unsigned i = 0; i < ic->nb_streams; ++i)
+            if (streamMap[i] != -1 && streamPackets[i] < streamRanges[i].second)
+                return true;
+        return false;
+    };
+    while (ok && (ranges.empty() || rangesLeft()) && av_read_frame(ic, packet.get()) >= 0) {
+        int index = packet->stream_index;
+        bool inRange = false;
+        if (index >= 0 && (unsigned)index < streamMap.size() && streamMap[index] != -1) {
+            auto position = streamPackets[index]++;
+            inRange = position >= streamRanges[index].first && position < streamRanges[index].second;
+
+            // Not decodable alone, the range is encoded again
+            if (inRange && position == streamRanges[index].first && !(packet->flags & AV_PKT_FLAG_KEY))
+                ok = false;
+        }
+        if (ok && inRange) {
+            packet->stream_index = streamMap[index];
+            av_packet_rescale_ts(packet.get(), ic->streams[index]->time_base, oc->streams[streamMap[index]]->time_base);
+            packet->pos = -1;
+            ok = av_interleaved_write_frame(oc, packet.get()) >= 0;
+            if (m_progress)
+                m_progress();
+        }
+        av_packet_unref(packet.get());
+    }
+    if (!ok || av_write_trailer(oc) < 0) {
+        ocPtr.reset();
+        QFile::remove(video + ".tmp");
+        return false;
+    }
+    avio_closep(&oc->pb);
+    ocPtr.reset();
+    icPtr.reset();
+
+    QFile::remove(video);
+    return QFile::rename(video + ".tmp", video);
+}
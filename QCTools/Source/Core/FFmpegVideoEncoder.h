@@ -5,8 +5,11 @@
 #include <QPair>
 #include <QString>
 #include <QList>
+#include <QMap>
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 extern "C" {
 #include <libavcodec/codec_id.h>
@@ -32,25 +35,60 @@ public:
     typedef QPair<QString, QString> MetadataEntry;
     typedef QList<MetadataEntry> Metadata;
 
+    // Encoder of a source, as "name[:option=value...]" in the text form (e.g. "ffv1:slices=4:threads=2")
+    // Options are the AVCodecContext and private options of the encoder (threads, preset...), pix_fmt is
+    // the pixel format encoded, else the first one supported by the encoder
+    struct Codec {
+        QString name = { "mjpeg" };
+        QMap<QString, QString> options;
+
+        static Codec parse(const QString& text);
+        QString toString() const;
+
+        // Empty if the encoder is available, else the reason
+        QString check() const;
+
+        const AVCodec* encoder() const;
+        AVPixelFormat pixelFormat() const;
+        // Options for avcodec_open2(), without pix_fmt, to be freed by the caller
+        AVDictionary* dictionary() const;
+    };
+
     struct Source {
         int width;
         int height;
         int bitrate = { 0 };
         int num;
         int den;
+        Codec codec; // Must be the one of the packets
         Metadata metadata;
         std::function<std::shared_ptr<AVPacket>()> getPacket;
     };
 
     explicit FFmpegVideoEncoder(QObject *parent = nullptr);
     void setMetadata(const QList<MetadataEntry>& metadata);
+
+    // Sources are encoded by one thread each (by default) and interleaved by timestamp, getPacket must be thread safe
+    void setParallel(bool parallel);
+    // Called by the thread of makeVideo() while writing
+    void setProgress(const std::function<void()>& progress);
 signals:
 
 public slots:
     void makeVideo(const QString& video, const QVector<Source>& sources, const QByteArray& attachment, const QString& attachmentName);
+    // Thumbnails (first video stream) and panels of the .qctools.mkv report source copied without decoding, with this attachment
+    // instead of the one of the source, which may be the file replaced; false if not written (streams not of these codecs...),
+    // the file is not changed then. Progress is called for each packet.
+    // With ranges, only the packets from first to second (excluded) of each video stream, by index in the stream, are copied
+    // (a partial report), the first one of each stream must be a key frame; reading stops after the last one
+    bool remuxVideo(const QString& video, const QString& source, const Codec& thumbnailsCodec, const Codec& panelsCodec,
+                    const QByteArray& attachment, const QString& attachmentName,
+                    const std::vector<std::pair<int64_t, int64_t>>& ranges = {});
 
 private:
     Metadata m_metadata;
+    bool m_parallel { true };
+    std::function<void()> m_progress;
 };
 
 #endif // FFMPEGVIDEOENCODER_H
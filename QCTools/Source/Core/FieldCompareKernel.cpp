@@ -0,0 +1,461 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/FieldCompareKernel.h"
+#include "Core/CpuFeatures.h"
+
+extern "C"
+{
+#include <libavutil/common.h>
+#include <libavutil/dict.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define FIELDCOMPARE_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #define FIELDCOMPARE_AVX2
+    #else
+        #define FIELDCOMPARE_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define FIELDCOMPARE_NEON
+    #include <arm_neon.h>
+#endif
+
+//---------------------------------------------------------------------------
+static const char* const Names[FieldCompareKernel::Value_Max]=
+{
+    "lavfi.psnr.mse.v",
+    "lavfi.psnr.mse.u",
+    "lavfi.psnr.mse.y",
+    "lavfi.psnr.psnr.v",
+    "lavfi.psnr.psnr.u",
+    "lavfi.psnr.psnr.y",
+    "lavfi.ssim.All",
+    "lavfi.ssim.V",
+    "lavfi.ssim.U",
+    "lavfi.ssim.Y",
+};
+
+// Formats of both filters without RGB and alpha (the keys of their planes are not columns)
+static const char* const FormatNames=
+    "gray|gray9|gray10|gray12|gray14|gray16|"
+    "yuv444p|yuv422p|yuv420p|yuv411p|yuv410p|yuv440p|"
+    "yuvj411p|yuvj420p|yuvj422p|yuvj444p|yuvj440p|"
+    "yuv444p9|yuv422p9|yuv420p9|"
+    "yuv444p10|yuv422p10|yuv420p10|yuv440p10|"
+    "yuv444p12|yuv422p12|yuv420p12|yuv440p12|"
+    "yuv444p14|yuv422p14|yuv420p14|"
+    "yuv444p16|yuv422p16|yuv420p16";
+
+//***************************************************************************
+// Sums of squared differences
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+template<typename T>
+static uint64_t SquaredDiff_C(const T* a, const T* b, int Count)
+{
+    uint64_t Sum=0;
+    for (int i=0; i<Count; i++)
+    {
+        int64_t Diff=(int)a[i]-(int)b[i];
+        Sum+=(uint64_t)(Diff*Diff);
+    }
+    return Sum;
+}
+
+#if defined(FIELDCOMPARE_X86)
+//---------------------------------------------------------------------------
+// Count is a line, 32-bit lanes are enough up to 2^14 samples per lane
+static FIELDCOMPARE_AVX2 uint64_t SquaredDiff_AVX2(const uint8_t* a, const uint8_t* b, int Count)
+{
+    const __m256i Zero=_mm256_setzero_si256();
+    __m256i Sum=Zero;
+    int i=0;
+    for (; i+32<=Count; i+=32)
+    {
+        __m256i x=_mm256_loadu_si256((const __m256i*)(a+i));
+        __m256i y=_mm256_loadu_si256((const __m256i*)(b+i));
+        __m256i Lo=_mm256_sub_epi16(_mm256_unpacklo_epi8(x, Zero), _mm256_unpacklo_epi8(y, Zero));
+        __m256i Hi=_mm256_sub_epi16(_mm256_unpackhi_epi8(x, Zero), _mm256_unpackhi_epi8(y, Zero));
+        Sum=_mm256_add_epi32(Sum, _mm256_add_epi32(_mm256_madd_epi16(Lo, Lo), _mm256_madd_epi16(Hi, Hi)));
+    }
+
+    alignas(32) uint32_t Lanes[8];
+    _mm256_store_si256((__m256i*)Lanes, Sum);
+    uint64_t Result=0;
+    for (auto Lane : Lanes)
+        Result+=Lane;
+    return Result+SquaredDiff_C(a+i, b+i, Count-i);
+}
+
+//---------------------------------------------------------------------------
+// 4x4 sums of ssim_4x4xn_8bit() of FFmpeg, 4 blocks at once: sums of pairs of samples
+// in 32-bit lanes, then of the pairs of each block (blocks 0 and 1 in the low lane)
+static FIELDCOMPARE_AVX2 int Ssim4x4_AVX2(const uint8_t* a, ptrdiff_t a_Stride, const uint8_t* b, ptrdiff_t b_Stride, int64_t (*Sums)[4], int Blocks)
+{
+    const __m256i One=_mm256_set1_epi16(1);
+    int z=0;
+    for (; z+4<=Blocks; z+=4)
+    {
+        __m256i S1=_mm256_setzero_si256(), S2=S1, SS=S1, S12=S1;
+        for (int y=0; y<4; y++)
+        {
+            __m256i x=_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(a+y*a_Stride+z*4)));
+            __m256i r=_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(b+y*b_Stride+z*4)));
+            S1=_mm256_add_epi32(S1, _mm256_madd_epi16(x, One));
+            S2=_mm256_add_epi32(S2, _mm256_madd_epi16(r, One));
+            SS=_mm256_add_epi32(SS, _mm256_add_epi32(_mm256_madd_epi16(x, x), _mm256_madd_epi16(r, r)));
+            S12=_mm256_add_epi32(S12, _mm256_madd_epi16(x, r));
+        }
+
+        alignas(32) int32_t A[8], B[8];
+        _mm256_store_si256((__m256i*)A, _mm256_hadd_epi32(S1, S2));
+        _mm256_store_si256((__m256i*)B, _mm256_hadd_epi32(SS, S12));
+        for (int Lane=0; Lane<2; Lane++)
+            for (int k=0; k<2; k++)
+            {
+                auto& Sum=Sums[z+Lane*2+k];
+                Sum[0]=A[Lane*4+k];
+                Sum[1]=A[Lane*4+2+k];
+                Sum[2]=B[Lane*4+k];
+                Sum[3]=B[Lane*4+2+k];
+            }
+    }
+    return z;
+}
+
+//---------------------------------------------------------------------------
+static bool HasAvx2()
+{
+    return CpuFeatures::Uses(CpuFeatures::Level_AVX2);
+}
+#endif // FIELDCOMPARE_X86
+
+#if defined(FIELDCOMPARE_NEON)
+//---------------------------------------------------------------------------
+// Count is a line, 32-bit lanes are enough up to 2^14 samples per lane
+static uint64_t SquaredDiff_NEON(const uint8_t* a, const uint8_t* b, int Count)
+{
+    uint32x4_t Sum=vdupq_n_u32(0);
+    int i=0;
+    for (; i+16<=Count; i+=16)
+    {
+        uint8x16_t Diff=vabdq_u8(vld1q_u8(a+i), vld1q_u8(b+i));
+        Sum=vpadalq_u16(Sum, vmull_u8(vget_low_u8(Diff), vget_low_u8(Diff)));
+        Sum=vpadalq_u16(Sum, vmull_u8(vget_high_u8(Diff), vget_high_u8(Diff)));
+    }
+    return (uint64_t)vaddlvq_u32(Sum)+SquaredDiff_C(a+i, b+i, Count-i);
+}
+#endif // FIELDCOMPARE_NEON
+
+//---------------------------------------------------------------------------
+template<typename T>
+static inline uint64_t SquaredDiff(const T* a, const T* b, int Count)
+{
+    return SquaredDiff_C(a, b, Count);
+}
+
+template<>
+inline uint64_t SquaredDiff(const uint8_t* a, const uint8_t* b, int Count)
+{
+#if defined(FIELDCOMPARE_X86)
+    if (HasAvx2())
+        return SquaredDiff_AVX2(a, b, Count);
+#elif defined(FIELDCOMPARE_NEON)
+    if (CpuFeatures::Uses(CpuFeatures::Level_NEON))
+        return SquaredDiff_NEON(a, b, Count);
+#endif
+    return SquaredDiff_C(a, b, Count);
+}
+
+//***************************************************************************
+// SSIM
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// As ssim_4x4xn_8bit/16bit() of FFmpeg: sums of a, b, a*a+b*b, a*b of each 4x4 block of a line of blocks
+template<typename T>
+static void Ssim4x4_C(const T* a, ptrdiff_t a_Stride, const T* b, ptrdiff_t b_Stride, int64_t (*Sums)[4], int Begin, int Blocks)
+{
+    for (int z=Begin; z<Blocks; z++)
+    {
+        int64_t s1=0, s2=0, ss=0, s12=0;
+        for (int y=0; y<4; y++)
+            for (int x=0; x<4; x++)
+            {
+                int64_t i=a[y*a_Stride+z*4+x];
+                int64_t j=b[y*b_Stride+z*4+x];
+                s1+=i;
+                s2+=j;
+                ss+=i*i+j*j;
+                s12+=i*j;
+            }
+        Sums[z][0]=s1;
+        Sums[z][1]=s2;
+        Sums[z][2]=ss;
+        Sums[z][3]=s12;
+    }
+}
+
+template<typename T>
+static inline void Ssim4x4(const T* a, ptrdiff_t a_Stride, const T* b, ptrdiff_t b_Stride, int64_t (*Sums)[4], int Blocks)
+{
+    Ssim4x4_C(a, a_Stride, b, b_Stride, Sums, 0, Blocks);
+}
+
+template<>
+inline void Ssim4x4(const uint8_t* a, ptrdiff_t a_Stride, const uint8_t* b, ptrdiff_t b_Stride, int64_t (*Sums)[4], int Blocks)
+{
+    int Begin=0;
+#if defined(FIELDCOMPARE_X86)
+    if (HasAvx2())
+        Begin=Ssim4x4_AVX2(a, a_Stride, b, b_Stride, Sums, Blocks);
+#endif
+    Ssim4x4_C(a, a_Stride, b, b_Stride, Sums, Begin, Blocks);
+}
+
+//---------------------------------------------------------------------------
+// As ssim_end1() of FFmpeg for 8-bit, int and float operations
+static inline float SsimEnd1_8bit(int s1, int s2, int ss, int s12)
+{
+    static const int ssim_c1=(int)(.01*.01*255*255*64+.5);
+    static const int ssim_c2=(int)(.03*.03*255*255*64*63+.5);
+    int vars=ss*64-s1*s1-s2*s2;
+    int covar=s12*64-s1*s2;
+    return (float)(2*s1*s2+ssim_c1)*(float)(2*covar+ssim_c2)/((float)(s1*s1+s2*s2+ssim_c1)*(float)(vars+ssim_c2));
+}
+
+//---------------------------------------------------------------------------
+// As ssim_end1x() of FFmpeg for more than 8 bits, int64_t and double operations
+static inline double SsimEnd1_16bit(int64_t s1, int64_t s2, int64_t ss, int64_t s12, int Max)
+{
+    int64_t ssim_c1=(int64_t)(.01*.01*Max*Max*64+.5);
+    int64_t ssim_c2=(int64_t)(.03*.03*Max*Max*64*63+.5);
+    int64_t vars=ss*64-s1*s1-s2*s2;
+    int64_t covar=s12*64-s1*s2;
+    return (double)(2*s1*s2+ssim_c1)*(double)(2*covar+ssim_c2)/((double)(s1*s1+s2*s2+ssim_c1)*(double)(vars+ssim_c2));
+}
+
+//---------------------------------------------------------------------------
+// As ssim_endn_8bit/16bit(): the 8x8 windows of 2 lines of blocks, overlapped by 4 samples
+template<typename T>
+static double SsimEnd(const int64_t (*Sum0)[4], const int64_t (*Sum1)[4], int Width, int Max);
+
+template<>
+double SsimEnd<uint8_t>(const int64_t (*Sum0)[4], const int64_t (*Sum1)[4], int Width, int)
+{
+    float Ssim=0;
+    for (int i=0; i<Width; i++)
+        Ssim+=SsimEnd1_8bit((int)(Sum0[i][0]+Sum0[i+1][0]+Sum1[i][0]+Sum1[i+1][0]),
+                            (int)(Sum0[i][1]+Sum0[i+1][1]+Sum1[i][1]+Sum1[i+1][1]),
+                            (int)(Sum0[i][2]+Sum0[i+1][2]+Sum1[i][2]+Sum1[i+1][2]),
+                            (int)(Sum0[i][3]+Sum0[i+1][3]+Sum1[i][3]+Sum1[i+1][3]));
+    return Ssim;
+}
+
+template<>
+double SsimEnd<uint16_t>(const int64_t (*Sum0)[4], const int64_t (*Sum1)[4], int Width, int Max)
+{
+    double Ssim=0;
+    for (int i=0; i<Width; i++)
+        Ssim+=SsimEnd1_16bit(Sum0[i][0]+Sum0[i+1][0]+Sum1[i][0]+Sum1[i+1][0],
+                             Sum0[i][1]+Sum0[i+1][1]+Sum1[i][1]+Sum1[i+1][1],
+                             Sum0[i][2]+Sum0[i+1][2]+Sum1[i][2]+Sum1[i+1][2],
+                             Sum0[i][3]+Sum0[i+1][3]+Sum1[i][3]+Sum1[i+1][3], Max);
+    return Ssim;
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+FieldCompareKernel::FieldCompareKernel(bool Psnr_, bool Ssim_)
+    : Psnr(Psnr_)
+    , Ssim(Ssim_)
+{
+    std::fill(std::begin(Values), std::end(Values), 0.0);
+    std::fill(std::begin(Valid), std::end(Valid), false);
+}
+
+//***************************************************************************
+// Info
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const char* FieldCompareKernel::Name(value Value)
+{
+    return Value<Value_Max?Names[Value]:"";
+}
+
+//---------------------------------------------------------------------------
+const char* FieldCompareKernel::Formats()
+{
+    return FormatNames;
+}
+
+//---------------------------------------------------------------------------
+bool FieldCompareKernel::Supports(int Format)
+{
+    static const std::vector<int> List=[]() {
+        std::vector<int> Result;
+        std::string Text(FormatNames);
+        size_t Begin=0;
+        while (Begin<=Text.size())
+        {
+            size_t End=Text.find('|', Begin);
+            if (End==std::string::npos)
+                End=Text.size();
+            Result.push_back(av_get_pix_fmt(Text.substr(Begin, End-Begin).c_str()));
+            Begin=End+1;
+        }
+        return Result;
+    }();
+
+    return Format!=AV_PIX_FMT_NONE && std::find(List.begin(), List.end(), Format)!=List.end();
+}
+
+//***************************************************************************
+// Compute
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool FieldCompareKernel::Compute(const AVFrame* Frame)
+{
+    std::fill(std::begin(Valid), std::end(Valid), false);
+    if (!Frame || !Frame->data[0] || Frame->width<=0 || Frame->height<2 || !Supports(Frame->format))
+        return false;
+
+    const AVPixFmtDescriptor* Desc=av_pix_fmt_desc_get((AVPixelFormat)Frame->format);
+    if (Desc->comp[0].depth>8)
+        Compute<uint16_t>(Frame, Desc->comp[0].depth, Desc->log2_chroma_w, Desc->log2_chroma_h, Desc->nb_components);
+    else
+        Compute<uint8_t>(Frame, Desc->comp[0].depth, Desc->log2_chroma_w, Desc->log2_chroma_h, Desc->nb_components);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+void FieldCompareKernel::Compute(const AVFrame* Frame, int Depth, int HSub, int VSub, int Planes)
+{
+    // Planes of the fields as set by the field filter: the lines of one parity, with the chroma lines of the field height
+    const int Max=(1<<Depth)-1;
+    const int FieldHeight=Frame->height/2;
+    int Widths[3], Heights[3];
+    double Total=0;
+    for (int p=0; p<Planes; p++)
+    {
+        Widths[p]=p?AV_CEIL_RSHIFT(Frame->width, HSub):Frame->width;
+        Heights[p]=p?AV_CEIL_RSHIFT(FieldHeight, VSub):FieldHeight;
+        Total+=(double)Widths[p]*Heights[p];
+    }
+
+    double Ssim_All=0;
+    for (int p=0; p<Planes; p++)
+    {
+        const ptrdiff_t Stride=Frame->linesize[p]/(ptrdiff_t)sizeof(T)*2;
+        const T* Top=reinterpret_cast<const T*>(Frame->data[p]);
+        const T* Bottom=reinterpret_cast<const T*>(Frame->data[p]+Frame->linesize[p]);
+        const int Width=Widths[p];
+        const int Height=Heights[p];
+
+        // As do_psnr() of FFmpeg, the top field is the main input
+        if (Psnr)
+        {
+            uint64_t Sum=0;
+            for (int y=0; y<Height; y++)
+                Sum+=SquaredDiff(Top+y*Stride, Bottom+y*Stride, Width);
+            double Mse=Width && Height?Sum/((double)Width*Height):0;
+            Values[Value_MSE_Y-p]=Mse;
+            Values[Value_PSNR_Y-p]=10.0*log10((double)Max*Max/Mse);
+            Valid[Value_MSE_Y-p]=true;
+            Valid[Value_PSNR_Y-p]=true;
+        }
+
+        // As ssim_plane() of FFmpeg, one line of 4x4 blocks at a time
+        if (Ssim)
+        {
+            int Blocks=Width>>2;
+            int Lines=Height>>2;
+            double Ssim_Plane=0;
+            if (Blocks>1 && Lines>1)
+            {
+                Sums.resize((size_t)(Blocks+3)*2*4);
+                int64_t (*Sum0)[4]=reinterpret_cast<int64_t (*)[4]>(Sums.data());
+                int64_t (*Sum1)[4]=Sum0+Blocks+3;
+                int z=0;
+                for (int y=1; y<Lines; y++)
+                {
+                    for (; z<=y; z++)
+                    {
+                        std::swap(Sum0, Sum1);
+                        Ssim4x4(Top+(ptrdiff_t)4*z*Stride, Stride, Bottom+(ptrdiff_t)4*z*Stride, Stride, Sum0, Blocks);
+                    }
+                    Ssim_Plane+=SsimEnd<T>(Sum0, Sum1, Blocks-1, Max);
+                }
+                Ssim_Plane/=(double)(Lines-1)*(Blocks-1);
+            }
+            Values[Value_SSIM_Y-p]=Ssim_Plane;
+            Valid[Value_SSIM_Y-p]=true;
+            Ssim_All+=Ssim_Plane*Width*Height/Total;
+        }
+    }
+    if (Ssim)
+    {
+        Values[Value_SSIM_All]=Ssim_All;
+        Valid[Value_SSIM_All]=true;
+    }
+}
+
+//***************************************************************************
+// Values
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool FieldCompareKernel::Has(value Value) const
+{
+    return Value<Value_Max && Valid[Value];
+}
+
+//---------------------------------------------------------------------------
+double FieldCompareKernel::Get(value Value) const
+{
+    return Value<Value_Max?Values[Value]:0;
+}
+
+//---------------------------------------------------------------------------
+// Values are compared as set_meta() of the filters writes them, a float with 6 decimals
+std::string FieldCompareKernel::Check(const AVDictionary* Metadata) const
+{
+    std::string Result;
+    for (int i=0; i<Value_Max; i++)
+    {
+        const AVDictionaryEntry* Entry=av_dict_get(Metadata, Names[i], nullptr, 0);
+        if (!Entry || !Valid[i])
+            continue;
+
+        char Value[32];
+        snprintf(Value, sizeof(Value), "%f", (float)Values[i]);
+        if (!strcmp(Entry->value, Value))
+            continue;
+
+        if (!Result.empty())
+            Result+=", ";
+        Result+=std::string(Names[i]+strlen("lavfi."))+' '+Value+" != "+Entry->value;
+    }
+    return Result;
+}
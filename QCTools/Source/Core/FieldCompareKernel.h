@@ -0,0 +1,77 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef FieldCompareKernel_H
+#define FieldCompareKernel_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct AVFrame;
+struct AVDictionary;
+
+//---------------------------------------------------------------------------
+// Values of "split[a][b];[a]field=top[a1];[b]field=bottom[b1];[a1][b1]psnr"
+// and of the same graph with ssim, computed without the filters: the top
+// field (even lines) is compared with the bottom one (odd lines) in the
+// planes of the decoded frame, read with a stride of 2 lines, no field is
+// copied.
+//
+// Sums of squared differences and the 4x4 sums of SSIM use AVX2 (if the CPU
+// has it) for 8-bit, the sums of squared differences NEON. Formulas are the
+// ones of FFmpeg (the integer ones of ssim for 8-bit), so the values are the
+// same as the ones of the filters; fields of odd heights are compared on the
+// lines of the bottom field, the filters refuse them.
+class FieldCompareKernel
+{
+public:
+    enum value
+    {
+        Value_MSE_V,
+        Value_MSE_U,
+        Value_MSE_Y,
+        Value_PSNR_V,
+        Value_PSNR_U,
+        Value_PSNR_Y,
+        Value_SSIM_All,
+        Value_SSIM_V,
+        Value_SSIM_U,
+        Value_SSIM_Y,
+        Value_Max
+    };
+
+                                FieldCompareKernel          (bool Psnr, bool Ssim);
+
+    // Key of the value in the metadata of the filter ("lavfi.psnr.mse.v"...)
+    static const char*          Name                        (value Value);
+
+    // Formats of the filters, as the pix_fmts option of the format filter, so frames are converted as for the filters
+    static const char*          Formats                     ();
+    static bool                 Supports                    (int Format);
+
+    // Values of a frame, false if its format is not supported
+    bool                        Compute                     (const AVFrame* Frame);
+    // Value of the last frame computed, false for the values of a filter not replaced or a plane the frame does not have
+    bool                        Has                         (value Value) const;
+    double                      Get                         (value Value) const;
+
+    // Values different from the ones of the filters in Metadata ("PSNR Y 38.1 != 38.2"...), empty if all are the same
+    std::string                 Check                       (const AVDictionary* Metadata) const;
+
+private:
+    template<typename T>
+    void                        Compute                     (const AVFrame* Frame, int Depth, int HSub, int VSub, int Planes);
+
+    bool                        Psnr;
+    bool                        Ssim;
+    double                      Values[Value_Max];
+    bool                        Valid[Value_Max];
+    std::vector<int64_t>        Sums;                       // 2 lines of 4x4 blocks of SSIM, 4 sums per block
+};
+
+#endif // FieldCompareKernel_H
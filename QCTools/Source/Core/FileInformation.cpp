@@ -11,6 +11,46 @@
 #include "Core/AudioStats.h"
 #include "Core/FormatStats.h"
 #include "Core/StreamsStats.h"
+#include "Core/StatsXmlReader.h"
+#include "Core/StatsXmlWriter.h"
+#include "Core/StatsColumnsCache.h"
+#include "Core/StatsArrowReport.h"
+#include "Core/StatsColumnsReport.h"
+#include "Core/StatsCompression.h"
+#include "Core/TraceEvents.h"
+#include "Core/StatsGzipMembers.h"
+#include "Core/StatsNumbers.h"
+#include "Core/StatsReportStream.h"
+#include "Core/StatsSegmentParser.h"
+#include "Core/StatsProcessParser.h"
+#include "Core/StatsIngest.h"
+#include "Core/KeyFrameThumbnails.h"
+#include "Core/PacketStatsParser.h"
+#include "Core/StatsReanalysisParser.h"
+#include "Core/ParsingScheduler.h"
+#include "Core/FilterGraphPlan.h"
+#include "Core/FrameSnapshots.h"
+#include "Core/FrameFeed.h"
+#include "Core/ThumbnailSprites.h"
+#include "Core/MatroskaAttachment.h"
+#include "Core/NumaNodes.h"
+#include "Core/PanelBuilder.h"
+#include "Core/ImageSequenceReader.h"
+#include "Core/QCvaultIndex.h"
+#include "Core/GrowingFileDevice.h"
+#include "Core/PipeDevice.h"
+#include "Core/ReadaheadDevice.h"
+#include "Core/RemoteReport.h"
+#include "Core/ReportFrames.h"
+#include "Core/SignalStatsKernel.h"
+#include "Core/FieldCompareKernel.h"
+#include "Core/HdrLightKernel.h"
+#include "Core/AnalysisProfiles.h"
+#include "Core/AudioStatsKernel.h"
+#include "Core/AnalyzerPlugins.h"
+#include "Core/CaptionsTimecode.h"
+#include "Core/MemoryPressure.h"
+#include "Core/Tracing.h"
 
 #include "FFmpegVideoEncoder.h"
 
@@ -29,6 +69,9 @@ extern "C" {
 #include <libavutil/pixfmt.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/ffversion.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/hash.h>
 
 #ifndef WITH_SYSTEM_FFMPEG
 #include <config.h>
@@ -47,6 +90,12 @@ extern "C" {
 #include <QPair>
 #include <QDir>
 #include <QEventLoop>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QRegularExpression>
+#include <QtConcurrent/QtConcurrentRun>
 #include <zlib.h>
 #include <zconf.h>
 
@@ -57,8 +106,12 @@ extern "C" {
 #include <cassert>
 #include <QEventLoop>
 #include <algorithm>
+#include <atomic>
+#include <deque>
+#include <limits>
 #include <qavplayer.h>
 #include <qavcodec_p.h>
+#include <qavdemuxer_p.h>
 #include <float.h>
 
 // extracted from FFMpeg_Glue:
@@ -317,8 +370,65 @@ bool isUnsignedAudioSampleFormat(int audioFormat)
 //***************************************************************************
 // Simultaneous parsing
 //***************************************************************************
-static int ActiveParsing_Count=0;
+static std::atomic<int> ActiveParsing_Max(0); // Files started in order by ParsingScheduler
+static std::atomic<int> ParsingSegments(1);
+static std::atomic<FrameSnapshots*> Snapshots(nullptr);
+static std::atomic<FrameFeed*> Feed(nullptr);
+static std::atomic<ThumbnailSprites*> Sprites(nullptr);
+static std::atomic<int> DecoderThreads(0);
+static std::atomic<int> DecoderThreadType(0); // 0 both, 1 frame, 2 slice
+static std::atomic<int> DecoderPool(0);
+static std::atomic<int> FilterThreads(0);
+static std::atomic<int> DecodeAhead(4);
+static QMutex ReportCodecs_Mutex;
+static QString ThumbnailsCodec; // Empty means the default encoder
+static QString PanelsCodec;
+static std::atomic<bool> FilterGraphsCombined(true);
+static std::atomic<int> StatsBranches(0);
+static std::atomic<int> StatsKernel(FileInformation::StatsKernel_Off);
+static std::atomic<int> FieldKernel(FileInformation::StatsKernel_Off);
+static std::atomic<bool> AudioKernel(false);
+static std::atomic<double> AudioKernelWindow(0.4);
+static std::atomic<double> AudioRowsWindow(0);
+static std::atomic<int> AnalysisProfile(AnalysisProfiles::Profile_Full);
+static std::atomic<int> Sampling(0);
+static std::atomic<double> SamplingRate(0);
+static std::atomic<bool> Live(false);
+static std::atomic<bool> KeyFramePreview(false);
+static std::atomic<bool> LazyItems(false);
+static std::atomic<bool> ProgressiveReports(false);
+static const qint64 ProgressiveReports_Delay=250; // Milliseconds of reading before the report is shown
+static std::atomic<bool> PacketStats(false);
+static std::atomic<bool> AnalysisProcess(false);
+static std::atomic<bool> FastProbe(false);
+static std::atomic<int> NumaNode(-1);
+static std::atomic<bool> BackgroundParsing(false);
+static std::atomic<bool> MkvColumns(false);
+static std::atomic<int> Lowres(0);
+static std::atomic<bool> SkipNonRef(false);
+static std::atomic<bool> GpuFilters(false);
+static QMutex Compare_Mutex;
+static QString CompareReference;
+static QString CompareVmafLog;
+static QMutex RegionOfInterest_Mutex;
+static QRect RegionOfInterest;
+static std::atomic<bool> FrameMemoization(false);
+static QMutex HardwareDevice_Mutex;
+static QString HardwareDevice; // Empty means the default device of QT_AVPLAYER_HWDECODE
+static QMutex FrameHash_Mutex;
+static QString FrameHash; // Algorithm of av_hash, empty means none
+static std::atomic<bool> CaptionsTimecode_Enabled(false);
+static std::atomic<bool> Reanalysis(false);
+
+// Files opened asynchronously (see open()), reading their report
+static QThreadPool& OpenPool()
+{
+    static QThreadPool Pool;
+    return Pool;
+}
+
 QString panelOutputPrefix = QString("panel_");
+QString statsBranchPrefix = QString("stats_");
 
 void FileInformation::run()
 {
@@ -330,7 +440,19 @@ void FileInformation::run()
 
 void FileInformation::runExport()
 {
-    Export_XmlGz(m_exportFileName, m_exportFilters);
+    // Already written while parsing
+    if(m_streamExportFile && m_streamExportFileName == m_exportFileName)
+    {
+        Q_EMIT statsFileGenerated(m_streamExportFile, m_streamExportName);
+        Q_EMIT exportCompleted(m_exportFileName);
+        return;
+    }
+
+    if (m_exportMkv)
+        Export_QCTools_Mkv(m_exportFileName, m_exportFilters);
+    else
+        Export_XmlGz(m_exportFileName, m_exportFilters);
+    Q_EMIT exportCompleted(m_exportFileName);
 }
 
 //***************************************************************************
@@ -338,27 +460,63 @@ void FileInformation::runExport()
 //***************************************************************************
 
 //---------------------------------------------------------------------------
-void FileInformation::readStats(QIODevice& StatsFromExternalData_File, bool StatsFromExternalData_FileName_IsCompressed)
+// Stream of a frame of a report from its attributes, false if it is not a frame of a video or audio stream
+static bool ReportFrame_Stream(const StatsXmlFrame& Frame, int& Type, int& Index)
 {
-    m_hasStats = true;
+    const char* media_type=Frame.Attribute("media_type");
+    const char* stream_index_value=Frame.Attribute("stream_index");
+    if (!media_type || !stream_index_value)
+        return false;
+
+    if (!strcmp(media_type, "video"))
+        Type=Type_Video;
+    else if (!strcmp(media_type, "audio"))
+        Type=Type_Audio;
+    else
+        return false;
 
-    streamsStats = new StreamsStats();
-    formatStats = new FormatStats();
+    Index=Number_ToInt(stream_index_value);
+    return Index>=0;
+}
+
+//---------------------------------------------------------------------------
+// Stats of the stream in Streams, created with its first frame
+static CommonStats* ReportFrame_Stats(std::vector<CommonStats*>& Streams, int Type, int Index)
+{
+    if(Streams.size() <= (size_t)Index)
+        Streams.resize(Index + 1);
 
-    //XML init
-    const char*  Xml_HeaderFooter="</frames></ffprobe:ffprobe><ffprobe:ffprobe><frames>";
-    const size_t Xml_HeaderSize=25;
-    const size_t Xml_FooterSize=27;
-    const size_t Xml_MaxSize=0x1000000; //Blocks of 16 MiB, arbitrary chosen
-    char* Xml=new char[Xml_MaxSize+Xml_HeaderSize+Xml_FooterSize];
+    if(!Streams[Index])
+    {
+        if(Type == Type_Video)
+            Streams[Index] = new VideoStats(Index);
+        else
+            Streams[Index] = new AudioStats(Index);
+    }
+    return Streams[Index];
+}
+
+//---------------------------------------------------------------------------
+// XML of a report sent to Reader up to its end, gzip (IsCompressed, corrected from the content), zstd or uncompressed
+static void ReportXml_Read(QIODevice& File, bool& IsCompressed, const QString& ReportFileName, StatsXmlReader& Reader)
+{
+    const size_t Xml_BlockSize=0x100000; //Blocks of 1 MiB, arbitrary chosen
 
     //Read init
     const size_t Compressed_MaxSize=0x100000; //Blocks of 1 MiB, arbitrary chosen
     char* Compressed=new char[Compressed_MaxSize];
 
+    //Format of the content, the one of the file name is only a hint (zstd report renamed .gz, uncompressed XML...)
+    auto Format=StatsCompression::Format_Detect(File);
+    if (IsCompressed!=(Format==StatsCompression::Format_Gzip))
+        qDebug() << "stats:" << ReportFileName << "is" << StatsCompression::Name(Format) << "content";
+    IsCompressed=Format==StatsCompression::Format_Gzip;
+    if (Format==StatsCompression::Format_Zstd && !StatsCompression::Zstd_Decompress(File, [&](const char* Data, size_t Size) {Reader.Feed(Data, Size);}))
+        qDebug() << "stats: corrupted zstd report or zstd not available in this build," << StatsCompression::Check(Format) << ", stats after it are ignored";
+
     //Uncompress init
     z_stream strm;
-    if (StatsFromExternalData_FileName_IsCompressed)
+    if (IsCompressed)
     {
         strm.next_in = NULL;
         strm.avail_in = 0;
@@ -370,113 +528,172 @@ void FileInformation::readStats(QIODevice& StatsFromExternalData_File, bool Stat
         inflateInit2(&strm, 15 + 16); // 15 + 16 are magic values for gzip
     }
 
-    //Load and parse compressed data chunk by chunk
-    char* Xml_Pointer=Xml;
-    int inflate_Result;
-    int TEMP = 0;
+    //Independently decodable members (current exports) are inflated in parallel, the loop below then only sees the end of the file
+    if (IsCompressed && StatsGzipMembers::IsIndexed(File))
+    {
+        if (!StatsGzipMembers::Inflate(File, [&](const char* Data, size_t Size) {Reader.Feed(Data, Size);}))
+            qDebug() << "stats: corrupted gzip member, stats after it are ignored";
+    }
 
+    //Load and parse data chunk by chunk
     for (;;)
     {
         //Load
         qint64 ReadSize;
-        size_t avail_out=Xml_MaxSize-(Xml_Pointer-Xml);
-        if (StatsFromExternalData_FileName_IsCompressed)
-            ReadSize=StatsFromExternalData_File.read(Compressed, Compressed_MaxSize); //Load in an intermediate buffer for decompression
+        if (IsCompressed)
+            ReadSize=File.read(Compressed, Compressed_MaxSize); //Load in an intermediate buffer for decompression
         else
-            ReadSize=StatsFromExternalData_File.read(Xml_Pointer, avail_out); //Load directly in the XML buffer
-        if (!ReadSize)
+        {
+            ReadSize=File.read(Reader.WriteBuffer(Xml_BlockSize), Xml_BlockSize); //Load directly in the XML buffer
+            if (ReadSize>0)
+                Reader.Commit(ReadSize);
+        }
+        if (ReadSize<=0)
             break;
-        TEMP += ReadSize;
+        if (!IsCompressed)
+            continue;
 
-        //Parse compressed data, with handling of the case the output buffer is not big enough
+        //Inflate directly in the XML buffer, with handling of the case the output buffer is not big enough
         strm.next_in=(Bytef*)Compressed;
         strm.avail_in=ReadSize;
-        for (;;)
+        int inflate_Result;
+        do
         {
-            size_t Xml_Size=Xml_Pointer-Xml;
-            if (StatsFromExternalData_FileName_IsCompressed)
-            {
-                //inflate
-                strm.next_out=(Bytef*)Xml_Pointer;
-                strm.avail_out= (avail_out - Xml_Size);
-                if ((inflate_Result=inflate(&strm, Z_NO_FLUSH))<0)
-                    break;
-                Xml_Size+=(avail_out - Xml_Size) -strm.avail_out;
-            }
-            else
-                Xml_Size+=ReadSize;
-
-            //Cut the XML after the last XML frame footer, and keep the remaining data for the next turn
-            size_t Xml_SizeForParsing=Xml_Size;
-            //Look for XML frame footer
-            while (Xml_SizeForParsing>Xml_HeaderSize &&
-                    ( Xml[Xml_SizeForParsing-1]!='>' //"</frame>"
-                || Xml[Xml_SizeForParsing-2]!='e'
-                || Xml[Xml_SizeForParsing-3]!='m'
-                || Xml[Xml_SizeForParsing-4]!='a'
-                || Xml[Xml_SizeForParsing-5]!='r'
-                || Xml[Xml_SizeForParsing-6]!='f'
-                || Xml[Xml_SizeForParsing-7]!='/'
-                || Xml[Xml_SizeForParsing-8]!='<'))
-                Xml_SizeForParsing--;
-            if (Xml_SizeForParsing<=Xml_HeaderSize)
-            {
-                //The block does not contain any complete frame, looping in order to get more data from the file
-                Xml_Pointer=Xml+Xml_Size;
+            strm.next_out=(Bytef*)Reader.WriteBuffer(Xml_BlockSize);
+            strm.avail_out=Xml_BlockSize;
+            inflate_Result=inflate(&strm, Z_NO_FLUSH);
+            if (inflate_Result<0 && inflate_Result!=Z_BUF_ERROR)
                 break;
-            }
+            Reader.Commit(Xml_BlockSize-strm.avail_out);
 
-            //Insert Xml_HeaderFooter inside the XML content
-            memmove(Xml+Xml_SizeForParsing+Xml_HeaderSize+Xml_FooterSize, Xml+Xml_SizeForParsing, Xml_Size-Xml_SizeForParsing);
-            memcpy(Xml+Xml_SizeForParsing, Xml_HeaderFooter, Xml_HeaderSize+Xml_FooterSize);
-            Xml_Size+=Xml_HeaderSize+Xml_FooterSize;
-            Xml_SizeForParsing+=Xml_FooterSize;
+            //Concatenated gzip members are read as one stream
+            if (inflate_Result==Z_STREAM_END)
+                inflate_Result=inflateReset(&strm);
+        }
+        while ((!strm.avail_out || strm.avail_in) && inflate_Result==Z_OK);
 
-            CommonStats::statsFromExternalData(Xml, Xml_SizeForParsing, [&](int type, int index) -> CommonStats* {
-                if(Stats.size() <= index)
-                    Stats.resize(index + 1);
+        //Check if we need to stop
+        if (inflate_Result==Z_NEED_DICT || (inflate_Result<0 && inflate_Result!=Z_BUF_ERROR))
+            break;
+    }
+    Reader.Finish();
 
-                if(!Stats[index])
-                {
-                    if(type == Type_Video)
-                        Stats[index] = new VideoStats(index);
-                    else if(type == Type_Audio)
-                        Stats[index] = new AudioStats(index);
-                }
+    //Cleanup
+    if (IsCompressed)
+        inflateEnd(&strm);
+    delete[] Compressed;
+}
 
-                return Stats[index];
-            });
+//---------------------------------------------------------------------------
+bool FileInformation::ReadReport(const QString& ReportFileName, std::vector<CommonStats*>& Stats, std::string& Trailer)
+{
+    QFile File(ReportFileName);
+    if (!File.open(QIODevice::ReadOnly))
+        return false;
+
+    StatsXmlReader Reader([&](const StatsXmlFrame& Frame) {
+        int Type, Index;
+        if (ReportFrame_Stream(Frame, Type, Index))
+            ReportFrame_Stats(Stats, Type, Index)->parseFrame(Frame);
+    });
+    bool IsCompressed=!ReportFileName.endsWith(".xml");
+    ReportXml_Read(File, IsCompressed, ReportFileName, Reader);
+
+    for (auto Stat : Stats)
+        if (Stat)
+            Stat->StatsFromExternalData_Finish();
+    Trailer=Reader.trailer();
+    return Reader.framesCount() || !Trailer.empty();
+}
 
-            //Cut the parsed content
-            memmove(Xml, Xml+Xml_SizeForParsing, Xml_Size-Xml_SizeForParsing);
-            Xml_Pointer=Xml+Xml_Size-Xml_SizeForParsing;
+//---------------------------------------------------------------------------
+void FileInformation::readStats(QIODevice& StatsFromExternalData_File, bool StatsFromExternalData_FileName_IsCompressed, const QString& ReportFileName, qint64 ReportOffset, qint64 ReportSize)
+{
+    m_hasStats = true;
 
-            //Check if we need to stop
-            if (!StatsFromExternalData_FileName_IsCompressed || strm.avail_out || inflate_Result == Z_STREAM_END)
-                break;
-        }
+    streamsStats = new StreamsStats();
+    formatStats = new FormatStats();
 
-        //Coherency checks
-        if (Xml_Pointer>=Xml+Xml_MaxSize+Xml_HeaderSize)
-            break;
+    QElapsedTimer Timer;
+    Timer.start();
+
+    //Columnar report, values are directly available
+    std::string Trailer;
+    if (StatsColumnsReport::IsColumnsReport(ReportFileName))
+    {
+        if (!StatsColumnsReport::Load(StatsFromExternalData_File, Stats, Trailer, ReportOffset, ReportSize, LazyItems))
+            qDebug() << "stats: invalid columns report" << ReportFileName;
+        formatStats->readFromXML(Trailer.c_str(), Trailer.size());
+        streamsStats->readFromXML(Trailer.c_str(), Trailer.size());
+
+        qDebug() << "stats loaded from" << ReportFileName << "in" << Timer.elapsed() << "ms";
+        return;
+    }
+
+    //Columns cache, if up to date there is nothing to parse
+    if (!ReportFileName.isEmpty() && m_statsColumnsCache.Load(ReportFileName, Stats, Trailer))
+    {
+        formatStats->readFromXML(Trailer.c_str(), Trailer.size());
+        streamsStats->readFromXML(Trailer.c_str(), Trailer.size());
+
+        qDebug() << "stats mapped from" << StatsColumnsCache::FileName(ReportFileName) << "in" << Timer.elapsed() << "ms";
+        return;
     }
 
+    //Stats published once the first frames are read, then read by the GUI: streams first seen afterwards are kept aside (see ProgressiveReports_Set)
+    bool Progressive=ProgressiveReports && !Reanalysis && m_open && m_open->Async;
+    size_t FramesCount=0;
+    std::vector<CommonStats*> NoLateStats;
+    auto& LateStats=Progressive?m_open->LateStats:NoLateStats;
+
+    //XML init, frames are sent to the stats as soon as they are complete
+    StatsXmlReader Reader([&](const StatsXmlFrame& Frame) {
+        int Type, Index;
+        if (!ReportFrame_Stream(Frame, Type, Index))
+            return;
+
+        auto& Streams = m_reportLoading && (Stats.size() <= (size_t)Index || !Stats[Index]) ? LateStats : Stats;
+        ReportFrame_Stats(Streams, Type, Index)->parseFrame(Frame);
+
+        //Opening finished from the event loop while the other frames are read
+        if(Progressive && !m_reportLoading && !(++FramesCount & 0x3FF) && Timer.elapsed() >= ProgressiveReports_Delay)
+        {
+            m_reportLoading = true;
+            qDebug() << "stats published after" << FramesCount << "frames," << Timer.elapsed() << "ms";
+            QMetaObject::invokeMethod(this, [this]() {
+                openMedia();
+            }, Qt::QueuedConnection);
+        }
+    });
+    ReportXml_Read(StatsFromExternalData_File, StatsFromExternalData_FileName_IsCompressed, ReportFileName, Reader);
+
     //Inform the parser that parsing is finished
     for(auto stats : Stats)
         if(stats)
             stats->StatsFromExternalData_Finish();
+    for(auto stats : LateStats)
+        if(stats)
+            stats->StatsFromExternalData_Finish();
 
-    //Parse formats
-    formatStats->readFromXML(Xml, Xml_Pointer - Xml);
+    if (m_reportLoading)
+    {
+        //Formats and streams are read by the GUI, parsed with the end of the opening (see openStats_Finish)
+        m_open->Trailer=Reader.trailer();
+    }
+    else
+    {
+        //Parse formats
+        formatStats->readFromXML(Reader.trailer().c_str(), Reader.trailer().size());
 
-    //Parse streams
-    streamsStats->readFromXML(Xml, Xml_Pointer - Xml);
+        //Parse streams
+        streamsStats->readFromXML(Reader.trailer().c_str(), Reader.trailer().size());
+    }
 
-    //Cleanup
-    if (StatsFromExternalData_FileName_IsCompressed)
-        inflateEnd(&strm);
-    delete[] Compressed;
-    delete[] Xml;
+    //Columns cache for next opens, failure (e.g. read-only directory) is not an issue; not with the streams kept aside, they are not in the stats yet
+    if (!ReportFileName.isEmpty() && LateStats.empty() && !StatsColumnsCache::Save(ReportFileName, Stats, Reader.trailer()))
+        qDebug() << "stats columns cache" << StatsColumnsCache::FileName(ReportFileName) << "can not be written";
+
+    qDebug() << "stats loaded:" << Reader.framesCount() << "frames," << Reader.bytesCount() << "bytes in" << Timer.elapsed() << "ms";
 }
 
 QSize FileInformation::panelSize() const
@@ -496,45 +713,105 @@ const std::map<std::string, std::string> &FileInformation::getPanelOutputMetadat
 
 size_t FileInformation::getPanelFramesCount(size_t index) const
 {
+    if(m_reportFrames)
+        return m_reportFrames->Count((int)index + 1);
     if(m_panelFrames.size() <= index)
         return 0;
 
-    return m_panelFrames[index].size();
+    return m_panelFrames[index]->Count();
+}
+
+Thumbnail FileInformation::getPanelFrame(size_t index, size_t panelFrameIndex) const
+{
+    if(m_reportFrames)
+        return m_reportFrames->Get((int)index + 1, panelFrameIndex);
+    if(m_panelFrames.size() <= index)
+        return Thumbnail();
+
+    return m_panelFrames[index]->Get(panelFrameIndex);
+}
+
+size_t FileInformation::memoryBytes() const
+{
+    size_t bytes = m_thumbnails.Bytes();
+    if(m_reportFrames)
+        bytes += m_reportFrames->Bytes();
+    if(!parsed())
+        return bytes;
+
+    for(auto stat : Stats)
+        if(stat)
+            bytes += stat->Bytes();
+    for(const auto& panelFrames : m_panelFrames)
+        bytes += panelFrames->Bytes();
+    return bytes;
+}
+
+void FileInformation::releaseMemory()
+{
+    m_thumbnails.Release();
+    if(m_reportFrames)
+        m_reportFrames->Release();
+
+    // Not while the parser threads or an export may still use them
+    if(!parsed() || m_parsing || isRunning())
+        return;
+
+    for(auto& panelFrames : m_panelFrames)
+        panelFrames->Release();
+    m_statsColumnsCache.Spill(Stats);
+
+    // Columns not spilled (compact storage, no temporary file) are compressed
+    if(CommonStats::ColdCompression_Get())
+        for(auto stats : Stats)
+            if(stats)
+                stats->Compress();
 }
 
-QAVVideoFrame FileInformation::getPanelFrame(size_t index, size_t panelFrameIndex) const
+static QByteArray getAttachment(AVFormatContext* formatContext, QString& attachmentFileName)
 {
-    return m_panelFrames[index][panelFrameIndex];
+    QByteArray attachment;
+
+    for(auto i = 0; i < formatContext->nb_streams; ++i)
+    {
+        if(formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_ATTACHMENT) {
+            auto st = formatContext->streams[i];
+            if(st->codecpar->extradata_size != 0) {
+                attachment = QByteArray((const char*) st->codecpar->extradata, st->codecpar->extradata_size);
+                AVDictionaryEntry *e = av_dict_get(st->metadata, "filename", NULL, 0);
+                if(e) {
+                    attachmentFileName = e->value;
+                }
+                break;
+            }
+        }
+    }
+
+    return attachment;
 }
 
 QByteArray getAttachment(const QString &fileName, QString& attachmentFileName)
 {
+    // Matroska elements read directly, only the content of the attachment is read
+    QFile file(fileName);
+    MatroskaAttachment::item item;
+    if (file.open(QIODevice::ReadOnly) && MatroskaAttachment::Find(file, item) && file.seek(item.Offset))
+    {
+        attachmentFileName = item.FileName;
+        return file.read(item.Size);
+    }
+    file.close();
+
     QByteArray attachment;
 
-    // Open file
+    // Other containers: the attachments are in the header, the streams are not probed
     AVFormatContext* formatContext = nullptr;
     auto fileNameString = fileName.toStdString();
 
     auto result = avformat_open_input(&formatContext, fileNameString.c_str(), NULL, NULL);
     if (result >= 0)
     {
-        if (avformat_find_stream_info(formatContext, NULL)>=0)
-        {
-            for(auto i = 0; i < formatContext->nb_streams; ++i)
-            {
-                if(formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_ATTACHMENT) {
-                    auto st = formatContext->streams[i];
-                    if(st->codecpar->extradata_size != 0) {
-                        attachment = QByteArray((const char*) st->codecpar->extradata, st->codecpar->extradata_size);
-                        AVDictionaryEntry *e = av_dict_get(st->metadata, "filename", NULL, 0);
-                        if(e) {
-                            attachmentFileName = e->value;
-                        }
-                        break;
-                    }
-                }
-            }
-        }
+        attachment = getAttachment(formatContext, attachmentFileName);
     } else {
         char errbuf[255];
         qDebug() << "Could not open file: " << av_make_error_string(errbuf, sizeof errbuf, result) << "\n";
@@ -545,6 +822,14 @@ QByteArray getAttachment(const QString &fileName, QString& attachmentFileName)
     return attachment;
 }
 
+// Context opened by the player when it loaded the file, nullptr if there is no audio/video stream
+static AVFormatContext* getFormatContext(const QAVPlayer* player)
+{
+    auto streams = player->availableVideoStreams();
+    streams.append(player->availableAudioStreams());
+    return streams.empty() ? nullptr : streams.front().formatContext();
+}
+
 std::map<std::string, std::string> getStreamMetadata(AVStream* stream)
 {
     std::map<std::string, std::string> metadata;
@@ -613,11 +898,338 @@ QString adjustDpxFileName(QString mediaFileName, int& dpxOffset) {
 QString astats = "astats";
 QString stats = "stats";
 QString thumbnails = "thumbnails";
+QString snapshot = "snapshot";
+QString framefeed = "framefeed";
+QString duplicate = "duplicate"; // Decoded frames the stats graphs did not get, see QAVPlayer::setSkipDuplicateFrames()
+
+//---------------------------------------------------------------------------
+// Value of a filter option in a graph description, escaped for the option then for the graph
+static QString Filter_Escape(const QString& Value)
+{
+    QString Option;
+    for (auto Char : Value)
+    {
+        if (Char=='\\' || Char=='\'' || Char==':')
+            Option+='\\';
+        Option+=Char;
+    }
+    QString Graph;
+    for (auto Char : Option)
+    {
+        if (Char=='\\' || Char=='\'' || Char=='[' || Char==']' || Char==',' || Char==';')
+            Graph+='\\';
+        Graph+=Char;
+    }
+    return Graph;
+}
+
+//---------------------------------------------------------------------------
+// Scaler of the decoding device and software format of its frames, for the video chains of GpuFilters_Set
+// The scalers keep the format of the frames, 4:2:0 8 bit is NV12 and 10 bit is P010 on all these devices
+static bool GpuFilters_Resolve(const QList<QAVStream>& Streams, QString& Scale, QString& Download)
+{
+    static const char* const Scalers[][2]=
+    {
+        { "vaapi", "scale_vaapi" },
+        { "cuda", "scale_cuda" },
+        { "qsv", "scale_qsv" },
+        { "vulkan", "scale_vulkan" },
+        { "videotoolbox", "scale_vt" },
+    };
+
+    QByteArray Device=qgetenv("QT_AVPLAYER_HWDECODE");
+    AVHWDeviceType Type=av_hwdevice_find_type_by_name(Device.constData());
+    for (const auto& Scaler : Scalers)
+        if (Device==Scaler[0])
+            Scale=Scaler[1];
+    if (Streams.empty() || Type==AV_HWDEVICE_TYPE_NONE || Scale.isEmpty() || !avfilter_get_by_name(Scale.toUtf8().constData()) || !avfilter_get_by_name("hwdownload"))
+    {
+        Scale.clear();
+        return false;
+    }
+
+    // All the streams in the same format, decoded by the device
+    Download.clear();
+    for (const auto& Stream : Streams)
+    {
+        const AVCodecContext* Context=Stream.codec()?Stream.codec()->avctx():nullptr;
+        bool HasConfig=false;
+        for (int i=0; Context && Context->codec && !HasConfig; i++)
+        {
+            const AVCodecHWConfig* Config=avcodec_get_hw_config(Context->codec, i);
+            if (!Config)
+                break;
+            HasConfig=Config->device_type==Type && (Config->methods&AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX);
+        }
+        const AVPixFmtDescriptor* Desc=av_pix_fmt_desc_get((AVPixelFormat)Stream.stream()->codecpar->format);
+        QString Format;
+        if (Desc && Desc->nb_components>=3 && !(Desc->flags&AV_PIX_FMT_FLAG_RGB) && Desc->log2_chroma_w==1 && Desc->log2_chroma_h==1)
+            Format=Desc->comp[0].depth==8?"nv12":Desc->comp[0].depth==10?"p010le":"";
+        if (!HasConfig || !Context->hw_device_ctx || Format.isEmpty() || (!Download.isEmpty() && Format!=Download))
+        {
+            Scale.clear();
+            Download.clear();
+            return false;
+        }
+        Download=Format;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// The first filter of a chain on the device if it is a resize (e.g. "scale=72:72"), the rest after the download
+static QString GpuChain_Get(const QString& Chain, const QString& Scale, const QString& Download)
+{
+    QString Downloaded="hwdownload,format="+Download;
+    if (Chain.startsWith("scale="))
+    {
+        int End=Chain.indexOf(QRegularExpression("[,;\\[]"));
+        QString Args=Chain.mid(6, End==-1?-1:End-6);
+        // Width and height only, the device scalers have no flags of swscale
+        if (Args.count(':')==1 && !Args.contains('='))
+            return Scale+'='+Args+','+Downloaded+(End==-1?QString():Chain.mid(End));
+    }
+    return Downloaded+','+Chain;
+}
+
+//---------------------------------------------------------------------------
+// Reference of Compare_Set, as seen by the stats chain
+struct compare_chain
+{
+    QString                     Reference;
+    QString                     VmafLog;
+    int                         Width=0;
+    int                         Height=0;
+    double                      Start=0;                // Of the file, in seconds
+};
+
+//---------------------------------------------------------------------------
+// The frame is compared with the frame of the reference at the same time (framesync of the comparing filters),
+// psnr then ssim then libvmaf, each one passing the frame of the file with its metadata to the next one
+static QString CompareDetector_Get(const compare_chain& Compare, bool Psnr, bool Ssim)
+{
+    QStringList Filters;
+    if (Psnr)
+        Filters.append("psnr");
+    if (Ssim)
+        Filters.append("ssim");
+    if (!Compare.VmafLog.isEmpty())
+        Filters.append("libvmaf=log_fmt=json:log_path="+Filter_Escape(Compare.VmafLog));
+    if (Filters.empty())
+        return QString();
+
+    QString Result=QString("null[cmp_m0];movie=filename=%1,setpts=PTS-STARTPTS+%2/TB,scale=%3:%4")
+        .arg(Filter_Escape(Compare.Reference)).arg(Compare.Start, 0, 'f', 6).arg(Compare.Width).arg(Compare.Height);
+    if (Filters.size()>1)
+    {
+        Result+=QString(",split=%1").arg(Filters.size());
+        for (int i=0; i<Filters.size(); i++)
+            Result+=QString("[cmp_r%1]").arg(i);
+    }
+    else
+        Result+="[cmp_r0]";
+    for (int i=0; i<Filters.size(); i++)
+    {
+        Result+=QString(";[cmp_m%1][cmp_r%1]").arg(i)+Filters[i];
+        if (i+1<Filters.size())
+            Result+=QString("[cmp_m%1]").arg(i+1);
+    }
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+// Filters of the stats chain as run one after the other, and their cost
+// The fields of psnr and ssim are compared after one split of the frame, it is one detector
+// With a reference (see Compare_Set) they compare the frame with the reference instead, also one detector
+static QStringList StatsDetectors_Get(const activefilters& ActiveFilters, QList<double>& Costs, const compare_chain* Compare=nullptr)
+{
+    static const struct
+    {
+        activefilter            Filter;
+        const char*             Chain;
+    } Detectors[] =
+    {
+        { ActiveFilter_Video_signalstats,   "signalstats=stat=tout+vrep+brng" },
+        { ActiveFilter_Video_cropdetect,    "cropdetect=reset=1:round=1" },
+        { ActiveFilter_Video_Idet,          "idet=half_life=1" },
+        { ActiveFilter_Video_Deflicker,     "deflicker=bypass=1" },
+        { ActiveFilter_Video_Entropy,       "entropy=mode=normal" },
+        { ActiveFilter_Video_EntropyDiff,   "entropy=mode=diff" },
+        { ActiveFilter_Video_blockdetect,   "blockdetect" },
+        { ActiveFilter_Video_blurdetect,    "blurdetect" },
+        { ActiveFilter_Video_blackdetect,   "blackdetect" },
+        { ActiveFilter_Video_freezedetect,  "freezedetect" },
+    };
+
+    QStringList Result;
+    for (const auto& Detector : Detectors)
+    {
+        if (!ActiveFilters[Detector.Filter])
+            continue;
+        Result.append(Detector.Chain);
+        Costs.append(ActiveFilter_Cost(Detector.Filter));
+    }
+
+    if (Compare)
+    {
+        auto Chain=CompareDetector_Get(*Compare, ActiveFilters[ActiveFilter_Video_Psnr], ActiveFilters[ActiveFilter_Video_Ssim]);
+        if (!Chain.isEmpty())
+        {
+            // Decoding of the reference included
+            Result.append(Chain);
+            Costs.append(1.0+ActiveFilter_Cost(ActiveFilter_Video_Psnr)*ActiveFilters[ActiveFilter_Video_Psnr]+ActiveFilter_Cost(ActiveFilter_Video_Ssim)*ActiveFilters[ActiveFilter_Video_Ssim]+(Compare->VmafLog.isEmpty()?0:4.0));
+        }
+    }
+    else if (ActiveFilters[ActiveFilter_Video_Psnr] && ActiveFilters[ActiveFilter_Video_Ssim])
+    {
+        Result.append("split[a][b];[a]field=top[a1];[b]field=bottom,split[b1][b2];[a1][b1]psnr[c1];[c1][b2]ssim");
+        Costs.append(ActiveFilter_Cost(ActiveFilter_Video_Psnr)+ActiveFilter_Cost(ActiveFilter_Video_Ssim));
+    }
+    else if (ActiveFilters[ActiveFilter_Video_Psnr])
+    {
+        Result.append("split[a][b];[a]field=top[a1];[b]field=bottom[b1];[a1][b1]psnr");
+        Costs.append(ActiveFilter_Cost(ActiveFilter_Video_Psnr));
+    }
+    else if (ActiveFilters[ActiveFilter_Video_Ssim])
+    {
+        Result.append("split[a][b];[a]field=top[a1];[b]field=bottom[b1];[a1][b1]ssim");
+        Costs.append(ActiveFilter_Cost(ActiveFilter_Video_Ssim));
+    }
+
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+// Filters of the audio stats chain, on the channels of the stream before the stereo downmix
+static std::string AudioDetectors_Get(const activefilters& ActiveFilters)
+{
+    std::string Result;
+    if (ActiveFilters[ActiveFilter_Audio_silencedetect])
+        Result+=",silencedetect";
+    if (ActiveFilters[ActiveFilter_Audio_astats])
+        Result+=",aformat=sample_fmts=flt|fltp:channel_layouts=stereo,astats=metadata=1:reset=1:length="+QString::number(AudioKernelWindow.load()).toStdString();
+    if (ActiveFilters[ActiveFilter_Audio_aphasemeter])
+        Result+=",aphasemeter=video=0";
+    if (ActiveFilters[ActiveFilter_Audio_EbuR128])
+        Result+=",ebur128=metadata=1,aformat=sample_fmts=flt|fltp:channel_layouts=stereo";
+    Result.erase(0, 1); // remove first comma
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+// Filter regrouping the audio samples in frames of the rows window (see AudioRowsWindow_Set), with its separator, empty if none
+static std::string AudioRows_Get(const QList<QAVStream>& AudioStreams, const QList<QAVStream>& VideoStreams)
+{
+    double Window=AudioRowsWindow;
+    if (!Window || AudioStreams.empty() || AudioStreams.front().stream()->codecpar->sample_rate<=0)
+        return std::string();
+    if (Window<0)
+    {
+        if (VideoStreams.empty())
+            return std::string();
+        AVRational FrameRate=VideoStreams.front().stream()->avg_frame_rate;
+        if (FrameRate.num<=0 || FrameRate.den<=0)
+            FrameRate=VideoStreams.front().stream()->r_frame_rate;
+        if (FrameRate.num<=0 || FrameRate.den<=0)
+            return std::string();
+        Window=av_q2d(av_inv_q(FrameRate));
+    }
+
+    // Last frame not padded, its row is over the remaining samples
+    long long Samples=std::max(1LL, std::llround(Window*AudioStreams.front().stream()->codecpar->sample_rate));
+    return "asetnsamples=n="+std::to_string(Samples)+":p=0,";
+}
+
+//---------------------------------------------------------------------------
+// Detectors shared between Count chains of about the same cost (the costliest first, to the cheapest chain)
+// The detectors keep their order in each chain, the first chain has the first detector so its frames have the size of the source
+static QStringList StatsChains_Get(const QStringList& Detectors, const QList<double>& Costs, int Count)
+{
+    if (Detectors.empty())
+        return QStringList();
+    Count=std::max(1, std::min(Count, (int)Detectors.size()));
+
+    std::vector<int> Order(Detectors.size());
+    for (size_t i=0; i<Order.size(); i++)
+        Order[i]=(int)i;
+    std::stable_sort(Order.begin(), Order.end(), [&](int a, int b) { return Costs[a]>Costs[b]; });
+
+    std::vector<double> ChainCosts(Count, 0);
+    std::vector<int> ChainOf(Detectors.size(), 0);
+    for (auto Detector : Order)
+    {
+        auto Chain=std::min_element(ChainCosts.begin(), ChainCosts.end())-ChainCosts.begin();
+        ChainOf[Detector]=(int)Chain;
+        ChainCosts[Chain]+=Costs[Detector];
+    }
+
+    // Chains in the order of their first detector
+    std::vector<int> Renumber(Count, -1);
+    int Chains=0;
+    for (auto Chain : ChainOf)
+        if (Renumber[Chain]==-1)
+            Renumber[Chain]=Chains++;
+
+    QStringList Result;
+    for (int i=0; i<Chains; i++)
+        Result.append(QString());
+    for (int i=0; i<Detectors.size(); i++)
+    {
+        auto& Chain=Result[Renumber[ChainOf[i]]];
+        if (!Chain.isEmpty())
+            Chain+=',';
+        Chain+=Detectors[i];
+    }
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+// Count of stats chains run in parallel, at most one per detector
+static int StatsBranches_Apply(int Detectors)
+{
+    int Count=StatsBranches;
+    if (Count<=0)
+    {
+        // Half of the cores of the pipeline, the decoder uses the others
+        int Pipelines=std::max(1, ActiveParsing_Max.load());
+        Count=std::min(4, QThread::idealThreadCount()/Pipelines/2);
+    }
+    return std::max(1, std::min(Count, Detectors));
+}
+
+//---------------------------------------------------------------------------
+// Frames of the stats chains run in parallel, merged once each chain has its frame
+struct FileInformation::StatsBranchesFrames
+{
+    struct stream
+    {
+        std::vector<int64_t>    Received;               // By branch
+        std::deque<std::vector<QAVVideoFrame>> Frames;  // Oldest first, then by branch (empty until received)
+        int64_t                 First {0};              // Count of frames merged
+    };
+
+    int                         Count {1};
+    int                         Kernel {-1};            // Branch of the frames of the kernel, -1 if signalstats is a filter
+    bool                        Check {false};          // Kernel values compared with the ones of the filter, not used
+    bool                        LumaOnly {false};       // Kernel without the chroma planes, see AnalysisProfiles
+    int                         Mismatches {0};
+    int                         Fields {-1};            // Branch of the frames of the field kernel, -1 if psnr and ssim are filters
+    bool                        FieldsCheck {false};
+    bool                        FieldsPsnr {false};
+    bool                        FieldsSsim {false};
+    int                         FieldsMismatches {0};
+    int                         Hdr {-1};               // Branch of the frames of the light levels kernel, -1 if not active
+    std::map<int, stream>       Streams;                // By stream index
+    std::map<int, std::unique_ptr<SignalStatsKernel>> Kernels; // By stream index, previous frame of each stream
+    std::map<int, std::unique_ptr<FieldCompareKernel>> FieldKernels; // By stream index, values of the last frame of each stream
+    std::map<int, std::unique_ptr<HdrLightKernel>> HdrKernels; // By stream index, values of the last frame of each stream
+    QMutex                      Mutex;
+};
 
 FileInformation::FileInformation (SignalServer* signalServer, const QString &FileName_, activefilters ActiveFilters_, activealltracks ActiveAllTracks_,
-                                  QMap<QString, std::tuple<QString, QString, QString, QString, int>> activePanels,
+                                  QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>> activePanels,
                                   const QString &QCvaultFileNamePrefix,
-                                  int FrameCount) :
+                                  int FrameCount, bool Open) :
     FileName(FileName_),
     ActiveFilters(ActiveFilters_),
     ActiveAllTracks(ActiveAllTracks_),
@@ -629,7 +1241,13 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
     m_autoCheckFileUploaded(true),
     m_autoUpload(true),
     m_hasStats(false),
-    m_commentsUpdated(false)
+    m_commentsUpdated(false),
+    m_parsingSegments(ParsingSegments_Get()),
+    m_frameSnapshots(FrameSnapshots_Get()),
+    m_frameFeed(FrameFeed_Get()),
+    m_thumbnailSprites(ThumbnailSprites_Get()),
+    m_statsBranches(new StatsBranchesFrames),
+    m_open(new OpenState)
 {
     static struct RegisterMetatypes {
         RegisterMetatypes() {
@@ -639,20 +1257,62 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
 
     connect(this, SIGNAL(parsingCompleted(bool)), this, SLOT(parsingDone(bool)));
 
-    QString StatsFromExternalData_FileName;
-    bool StatsFromExternalData_FileName_IsCompressed=false;
+    m_open->ActivePanels=activePanels;
+    m_open->QCvaultFileNamePrefix=QCvaultFileNamePrefix;
+
+    // The parser is the only one opening the file (or the .qctools.mkv report), its streams and attachments are used by all the next steps
+    m_mediaParser = new QAVPlayer();
+
+    if (Open)
+        openStart(false);
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::open(bool Parse)
+{
+    if (m_open && !m_open->Started)
+        m_open->Parse=Parse;
+    openStart(true);
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::isOpened() const
+{
+    return m_opened;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::openStart(bool Async)
+{
+    if (!m_open || m_open->Started)
+        return;
+    m_open->Started=true;
+    m_open->Async=Async;
+
+    auto& StatsFromExternalData_FileName=m_open->StatsFromExternalData_FileName;
+    auto& StatsFromExternalData_FileName_IsCompressed=m_open->StatsFromExternalData_FileName_IsCompressed;
+    auto& attachmentFileName=m_open->AttachmentFileName;
+    auto& mediaOrMkvReportFileName=m_open->MediaOrMkvReportFileName;
+    const auto& QCvaultFileNamePrefix=m_open->QCvaultFileNamePrefix;
 
     // Finding the right file names (both media file and stats file)
 
     static const QString dotQctoolsDotXmlDotGz = ".qctools.xml.gz";
+    static const QString dotQctoolsDotXmlDotZst = ".qctools.xml.zst";
     static const QString dotQctoolsDotXml = ".qctools.xml";
     static const QString dotXmlDotGz = ".xml.gz";
     static const QString dotQctoolsDotMkv = ".qctools.mkv";
+    static const QString dotQctoolsDotColumns = ".qctools.columns";
 
-    QByteArray attachment;
-    auto mediaOrMkvReportFileName = FileName;
+    mediaOrMkvReportFileName = FileName;
 
-    if (FileName.endsWith(dotQctoolsDotXmlDotGz))
+    // Report written by a qcli of another host, the media is there
+    if (RemoteReport::IsRemote(FileName))
+    {
+        StatsFromExternalData_FileName=FileName;
+        StatsFromExternalData_FileName_IsCompressed=true;
+    }
+    else if (FileName.endsWith(dotQctoolsDotXmlDotGz))
     {
         StatsFromExternalData_FileName=FileName;
         FileName.resize(FileName.length() - dotQctoolsDotXmlDotGz.length());
@@ -662,6 +1322,14 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
 
         StatsFromExternalData_FileName_IsCompressed=true;
     }
+    else if (FileName.endsWith(dotQctoolsDotXmlDotZst))
+    {
+        StatsFromExternalData_FileName=FileName;
+        FileName.resize(FileName.length() - dotQctoolsDotXmlDotZst.length());
+        if(!QFile::exists(FileName)) {
+            FileName = FileName + dotQctoolsDotXmlDotZst;
+        }
+    }
     else if (FileName.endsWith(dotQctoolsDotXml))
     {
         StatsFromExternalData_FileName=FileName;
@@ -682,21 +1350,31 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
 
         StatsFromExternalData_FileName_IsCompressed=true;
     }
-    else if (FileName.endsWith(dotQctoolsDotMkv))
-    {        
-        attachment = getAttachment(FileName, StatsFromExternalData_FileName);
-        FileName.resize(FileName.length() - dotQctoolsDotMkv.length());
+    else if (FileName.endsWith(dotQctoolsDotColumns))
+    {
+        StatsFromExternalData_FileName=FileName;
+        FileName.resize(FileName.length() - dotQctoolsDotColumns.length());
+
+        if(!QFile::exists(FileName)) {
+            FileName = FileName + dotQctoolsDotColumns;
+        }
+    }
+    else if (FileName.endsWith(dotQctoolsDotMkv))
+    {        
+        attachmentFileName = FileName;
+        FileName.resize(FileName.length() - dotQctoolsDotMkv.length());
 
         if(!QFile::exists(FileName)) {
             FileName = FileName + dotQctoolsDotMkv;
         }
     }
 
-    if (StatsFromExternalData_FileName.size()==0)
+    // No report of a pipe, it is read once by the parser
+    if (StatsFromExternalData_FileName.size()==0 && attachmentFileName.isEmpty() && FileName != "-")
     {
         if (QFile::exists(FileName + dotQctoolsDotMkv))
         {
-            attachment = getAttachment(FileName + dotQctoolsDotMkv, StatsFromExternalData_FileName);
+            attachmentFileName = FileName + dotQctoolsDotMkv;
             mediaOrMkvReportFileName = mediaOrMkvReportFileName + dotQctoolsDotMkv;
         }
         else if (QFile::exists(FileName + dotQctoolsDotXmlDotGz))
@@ -704,6 +1382,14 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
             StatsFromExternalData_FileName=FileName + dotQctoolsDotXmlDotGz;
             StatsFromExternalData_FileName_IsCompressed=true;
         }
+        else if (QFile::exists(FileName + dotQctoolsDotXmlDotZst))
+        {
+            StatsFromExternalData_FileName=FileName + dotQctoolsDotXmlDotZst;
+        }
+        else if (QFile::exists(FileName + dotQctoolsDotColumns))
+        {
+            StatsFromExternalData_FileName=FileName + dotQctoolsDotColumns;
+        }
         else if (QFile::exists(FileName + dotQctoolsDotXml))
         {
             StatsFromExternalData_FileName=FileName + dotQctoolsDotXml;
@@ -718,20 +1404,36 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
             auto QCvaultFileName = QFileInfo(QCvaultFileNamePrefix).fileName();
             QDir QCvaultPath = QFileInfo(QCvaultFileNamePrefix).absolutePath();
             auto fileNameWithoutPath = QFileInfo(FileName).fileName();
-            while (QCvaultFileName.size() >= fileNameWithoutPath.size())
+
+            // Same content already analyzed, whatever its name
+            QString indexedFileName;
+            if (QCvaultIndex::Exists(QCvaultPath.absolutePath()))
+                indexedFileName = QCvaultIndex::Find(QCvaultPath.absolutePath(), QCvaultIndex::Fingerprint(FileName), ActiveFilters);
+            if (indexedFileName.endsWith(dotQctoolsDotMkv))
+            {
+                attachmentFileName = indexedFileName;
+                mediaOrMkvReportFileName = indexedFileName;
+            }
+            else if (indexedFileName.endsWith(dotQctoolsDotXmlDotGz))
+            {
+                StatsFromExternalData_FileName = indexedFileName;
+                StatsFromExternalData_FileName_IsCompressed = true;
+            }
+
+            while (attachmentFileName.isEmpty() && StatsFromExternalData_FileName.isEmpty() && QCvaultFileName.size() >= fileNameWithoutPath.size())
             {
                 // Is there compatible file names in QCvault path
-                auto list = QCvaultPath.entryList(QStringList(QCvaultFileName + "*" + dotQctoolsDotMkv), QDir::Files, QDir::Name);
+                auto list = QCvaultIndex::Names(QCvaultPath.absolutePath(), QCvaultFileName, dotQctoolsDotMkv);
                 if (list.size() == 1)
                 {
-                    attachment = getAttachment(QCvaultPath.absolutePath() + "/" + list[0], StatsFromExternalData_FileName);
+                    attachmentFileName = QCvaultPath.absolutePath() + "/" + list[0];
                     mediaOrMkvReportFileName = (QCvaultPath.absolutePath() + "/" + list[0]);
                     break;
                 }
-                list = QCvaultPath.entryList(QStringList(QCvaultFileName + "*" + dotQctoolsDotXmlDotGz), QDir::Files, QDir::Name);
+                list = QCvaultIndex::Names(QCvaultPath.absolutePath(), QCvaultFileName, dotQctoolsDotXmlDotGz);
                 if (list.size() == 1)
                 {
-                    StatsFromExternalData_FileName = QCvaultPath.absolutePath() + "/" + list[0] + dotQctoolsDotXmlDotGz;
+                    StatsFromExternalData_FileName = QCvaultPath.absolutePath() + "/" + list[0];
                     StatsFromExternalData_FileName_IsCompressed = true;
                     break;
                 }
@@ -752,117 +1454,330 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
         }
     }
 
-    QString shortFileName;
-    std::unique_ptr<QIODevice> StatsFromExternalData_File;
+    auto& parserSourceFileName=m_open->ParserSourceFileName;
+    auto& dpxOffset=m_open->DpxOffset;
+    parserSourceFileName = mediaOrMkvReportFileName;
+    if(mediaOrMkvReportFileName  == "-")
+        mediaOrMkvReportFileName  = "pipe:0";
+    else if(isDpx(mediaOrMkvReportFileName)) {
+        mediaOrMkvReportFileName = adjustDpxFileName(mediaOrMkvReportFileName, dpxOffset);
+        m_mediaParser->setInputOptions({ {"start_number", QString::number(dpxOffset) }, {"f", "image2"} });
 
-    if(attachment.isEmpty()) {
-        QFileInfo fileInfo(StatsFromExternalData_FileName);
-        shortFileName = fileInfo.fileName();
-        StatsFromExternalData_File.reset(new QFile(StatsFromExternalData_FileName));
-    } else {
-        shortFileName = StatsFromExternalData_FileName;
-        StatsFromExternalData_File.reset(new QBuffer(&attachment));
-        StatsFromExternalData_FileName_IsCompressed = true;
+        // Next images opened and read while the current one is decoded
+        if (auto Ahead=ImageSequenceReader::Ahead_Get())
+        {
+            auto Reader=std::make_shared<ImageSequenceReader>(mediaOrMkvReportFileName, Ahead, Ahead);
+            m_mediaParser->setFileReader([Reader](const QString& Url, QByteArray& Data) {
+                return Reader->Read(Url, Data);
+            });
+        }
     }
 
-    // External data optional input
-    bool StatsFromExternalData_IsOpen=StatsFromExternalData_File->open(QIODevice::ReadOnly);
+    ParsingThreads_Apply(m_mediaParser, 1);
+    m_mediaParser->setSynced(false);
+    openSource(m_mediaParser, mediaOrMkvReportFileName, &FileInformation::openStats);
+}
 
-    std::string Filters[Type_Max];
-    if (!StatsFromExternalData_IsOpen)
+//---------------------------------------------------------------------------
+// Media file parsed while still being written (see GrowingFileDevice), while opening
+bool FileInformation::isFollowed() const
+{
+    return GrowingFileDevice::Enabled_Get() && m_open->AttachmentFileName.isEmpty() && m_open->StatsFromExternalData_FileName.isEmpty()
+        && m_open->DpxOffset == -1 && m_open->ParserSourceFileName != "-";
+}
+
+//---------------------------------------------------------------------------
+// Connected before the source is set, the first status is the one after loading
+void FileInformation::openSource(QAVPlayer* Player, const QString& Source, void (FileInformation::*Next)())
+{
+    // Read ahead for the parser only, the player seeks too often
+    // The standard input in a bounded buffer, its only reader
+    // A media file still being written followed past its current end, not a report
+    QSharedPointer<QAVIODevice> Device;
+    if (Player==m_mediaParser)
     {
-        if (ActiveFilters[ActiveFilter_Video_signalstats])
-            Filters[0]+=",signalstats=stat=tout+vrep+brng";
-        if (ActiveFilters[ActiveFilter_Video_cropdetect])
-            Filters[0]+=",cropdetect=reset=1:round=1";
-        if (ActiveFilters[ActiveFilter_Video_Idet])
-            Filters[0]+=",idet=half_life=1";
-        if (ActiveFilters[ActiveFilter_Video_Deflicker])
-            Filters[0]+=",deflicker=bypass=1";
-        if (ActiveFilters[ActiveFilter_Video_Entropy])
-            Filters[0]+=",entropy=mode=normal";
-        if (ActiveFilters[ActiveFilter_Video_EntropyDiff])
-            Filters[0]+=",entropy=mode=diff";
-        if (ActiveFilters[ActiveFilter_Video_blockdetect])
-            Filters[0]+=",blockdetect";
-        if (ActiveFilters[ActiveFilter_Video_blurdetect])
-            Filters[0]+=",blurdetect";
-        if (ActiveFilters[ActiveFilter_Video_Psnr] && ActiveFilters[ActiveFilter_Video_Ssim])
-        {
-            Filters[0]+=",split[a][b];[a]field=top[a1];[b]field=bottom,split[b1][b2];[a1][b1]psnr[c1];[c1][b2]ssim";
-        }
+        if (Source=="pipe:0")
+            Device=PipeDevice::Create();
+        else if (isFollowed())
+            Device=GrowingFileDevice::Create(Source);
         else
-        {
-            if (ActiveFilters[ActiveFilter_Video_Psnr])
-                Filters[0]+=",split[a][b];[a]field=top[a1];[b]field=bottom[b1];[a1][b1]psnr";
-            if (ActiveFilters[ActiveFilter_Video_Ssim])
-                Filters[0]+=",split[a][b];[a]field=top[a1];[b]field=bottom[b1];[a1][b1]ssim";
-        }
-        Filters[0].erase(0, 1); // remove first comma
-        if (ActiveFilters[ActiveFilter_Audio_astats])
-            Filters[1]+=",aformat=sample_fmts=flt|fltp:channel_layouts=stereo,astats=metadata=1:reset=1:length=0.4";
-        if (ActiveFilters[ActiveFilter_Audio_aphasemeter])
-            Filters[1]+=",aphasemeter=video=0";
-        if (ActiveFilters[ActiveFilter_Audio_EbuR128])
-            Filters[1]+=",ebur128=metadata=1,aformat=sample_fmts=flt|fltp:channel_layouts=stereo";
-        Filters[1].erase(0, 1); // remove first comma
+            Device=ReadaheadDevice::Create(Source);
+    }
 
-        m_panelSize.setWidth(512);
+    auto Connection=std::make_shared<QMetaObject::Connection>();
+    if (m_open->Async)
+    {
+        *Connection=connect(Player, &QAVPlayer::mediaStatusChanged, this, [this, Player, Connection, Next]() {
+            qDebug() << "status after loading: " << Player->mediaStatus();
+            QObject::disconnect(*Connection);
+            (this->*Next)();
+        });
+        Player->setSource(Source, Device);
+        return;
     }
-    else
+
     {
-        readStats(*StatsFromExternalData_File, StatsFromExternalData_FileName_IsCompressed);
+        QEventLoop loop;
+        *Connection=connect(Player, &QAVPlayer::mediaStatusChanged, this, [&]() {
+            qDebug() << "status after loading: " << Player->mediaStatus();
+            QObject::disconnect(*Connection);
+            loop.exit();
+        });
+        Player->setSource(Source, Device);
+        loop.exec();
+    }
+    (this->*Next)();
+}
 
-        if(signalServer->enabled() && m_autoCheckFileUploaded)
+//---------------------------------------------------------------------------
+// The report (possibly attached to the .qctools.mkv report) is read by a thread of the pool when opened asynchronously
+void FileInformation::openStats()
+{
+    auto Read=[this]() {
+        auto& StatsFromExternalData_FileName=m_open->StatsFromExternalData_FileName;
+        auto& StatsFromExternalData_FileName_IsCompressed=m_open->StatsFromExternalData_FileName_IsCompressed;
+        auto& StatsFromExternalData_IsOpen=m_open->StatsFromExternalData_IsOpen;
+        auto& attachment=m_open->Attachment;
+        const auto& attachmentFileName=m_open->AttachmentFileName;
+        const auto& mediaOrMkvReportFileName=m_open->MediaOrMkvReportFileName;
+        const auto& parserSourceFileName=m_open->ParserSourceFileName;
+        auto& shortFileName=m_open->ShortFileName;
+
+        if (!attachmentFileName.isEmpty())
         {
-            checkFileUploaded(shortFileName);
+            // From the Matroska elements, without probing the report; a columns report is mapped from the file, not copied
+            QFile attachmentFile(attachmentFileName);
+            MatroskaAttachment::item attachmentItem;
+            bool isFound = attachmentFile.open(QIODevice::ReadOnly) && MatroskaAttachment::Find(attachmentFile, attachmentItem);
+            if (isFound && StatsColumnsReport::IsColumnsReport(attachmentItem.FileName))
+            {
+                StatsFromExternalData_FileName = attachmentItem.FileName;
+                shortFileName = attachmentItem.FileName;
+                StatsFromExternalData_IsOpen = true;
+                m_open->AttachmentIsMapped = true;
+                readStats(attachmentFile, false, attachmentItem.FileName, attachmentItem.Offset, attachmentItem.Size);
+                return;
+            }
+
+            auto parserFormatContext = attachmentFileName == parserSourceFileName ? getFormatContext(m_mediaParser) : nullptr;
+            if (isFound && attachmentFile.seek(attachmentItem.Offset))
+            {
+                StatsFromExternalData_FileName = attachmentItem.FileName;
+                attachment = attachmentFile.read(attachmentItem.Size);
+            }
+            else if (parserFormatContext)
+                attachment = getAttachment(parserFormatContext, StatsFromExternalData_FileName);
+            else
+                attachment = getAttachment(attachmentFileName, StatsFromExternalData_FileName);
+        }
+
+        std::unique_ptr<QIODevice> StatsFromExternalData_File;
+        QString ReportFileName = StatsFromExternalData_FileName;
+
+        if(RemoteReport::IsRemote(StatsFromExternalData_FileName)) {
+            // Received while the server analyzes the file, no columns cache
+            shortFileName = QFileInfo(StatsFromExternalData_FileName).fileName();
+            StatsFromExternalData_File.reset(new RemoteReport(StatsFromExternalData_FileName));
+            ReportFileName.clear();
+        } else if(attachment.isEmpty()) {
+            QFileInfo fileInfo(StatsFromExternalData_FileName);
+            shortFileName = fileInfo.fileName();
+            StatsFromExternalData_File.reset(new QFile(StatsFromExternalData_FileName));
+        } else {
+            shortFileName = StatsFromExternalData_FileName;
+            StatsFromExternalData_File.reset(new QBuffer(&attachment));
+            StatsFromExternalData_FileName_IsCompressed = true;
+            ReportFileName = mediaOrMkvReportFileName;
         }
 
-        m_mediaPlayer = new QAVPlayer();
+        // External data optional input
+        StatsFromExternalData_IsOpen=StatsFromExternalData_File->open(QIODevice::ReadOnly);
+
+        if (StatsFromExternalData_IsOpen)
+            readStats(*StatsFromExternalData_File, StatsFromExternalData_FileName_IsCompressed, ReportFileName);
+        else if (RemoteReport::IsRemote(StatsFromExternalData_FileName))
+            qDebug() << "remote report:" << StatsFromExternalData_FileName << StatsFromExternalData_File->errorString();
+    };
+
+    if (!m_open->Async)
+    {
+        Read();
+        openMedia();
+        return;
+    }
 
-        int dpxOffset = -1;
-        auto mediaFileName = FileName;
+    auto Watcher=new QFutureWatcher<void>(this);
+    connect(Watcher, &QFutureWatcher<void>::finished, this, [this, Watcher]() {
+        Watcher->deleteLater();
 
-        if(mediaFileName == "-")
-            mediaFileName = "pipe:0";
-        else if(isDpx(mediaFileName)) {
-            mediaFileName = adjustDpxFileName(mediaFileName, dpxOffset);
-            m_mediaPlayer->setInputOptions({ {"start_number", QString::number(dpxOffset) }, {"f", "image2"} });
+        // Already opened with the first frames, finished at once if opened else by openFinish()
+        if (m_reportLoading)
+        {
+            m_open->ReportRead=true;
+            if (m_opened)
+                openStats_Finish();
+            return;
         }
 
-        m_mediaPlayer->setSource(FileName);
+        openMedia();
+    });
+    m_openFuture=QtConcurrent::run(&OpenPool(), Read);
+    Watcher->setFuture(m_openFuture);
+}
 
-        QEventLoop loop;
-        QMetaObject::Connection c;
-        c = connect(m_mediaPlayer, &QAVPlayer::mediaStatusChanged, this, [&, this]() {
-            qDebug() << "m_mediaPlayer status after loading: " << m_mediaPlayer->mediaStatus();
-            loop.exit();
-            QObject::disconnect(c);
-        });
-        loop.exec();
-    }
+//---------------------------------------------------------------------------
+void FileInformation::openMedia()
+{
+    if (m_open->StatsFromExternalData_IsOpen)
+    {
+        if(signalServer->enabled() && m_autoCheckFileUploaded)
+        {
+            checkFileUploaded(m_open->ShortFileName);
+        }
 
-    m_mediaParser = new QAVPlayer();
+        // Media info from the media file when the parser has the .qctools.mkv report, else from the parser
+        if (FileName != m_open->ParserSourceFileName)
+        {
+            m_mediaPlayer = new QAVPlayer();
+            m_mediaPlayer->setFastProbe(FastProbe);
 
-    int dpxOffset = -1;
-    if(mediaOrMkvReportFileName  == "-")
-        mediaOrMkvReportFileName  = "pipe:0";
-    else if(isDpx(mediaOrMkvReportFileName)) {
-        mediaOrMkvReportFileName = adjustDpxFileName(mediaOrMkvReportFileName, dpxOffset);
-        m_mediaParser->setInputOptions({ {"start_number", QString::number(dpxOffset) }, {"f", "image2"} });
+            int dpxOffset = -1;
+            auto mediaFileName = FileName;
+
+            if(mediaFileName == "-")
+                mediaFileName = "pipe:0";
+            else if(isDpx(mediaFileName)) {
+                mediaFileName = adjustDpxFileName(mediaFileName, dpxOffset);
+                m_mediaPlayer->setInputOptions({ {"start_number", QString::number(dpxOffset) }, {"f", "image2"} });
+            }
+
+            openSource(m_mediaPlayer, FileName, &FileInformation::openFinish);
+            return;
+        }
     }
 
-    m_mediaParser->setSource(mediaOrMkvReportFileName);
-    m_mediaParser->setSynced(false);
+    openFinish();
+}
 
-    QEventLoop loop;
-    QMetaObject::Connection c;
-    c = connect(m_mediaParser, &QAVPlayer::mediaStatusChanged, this, [&, this]() {
-        qDebug() << "m_mediaParser status after loading: " << m_mediaParser->mediaStatus();
-        loop.exit();
-        QObject::disconnect(c);
-    });
-    loop.exec();
+//---------------------------------------------------------------------------
+void FileInformation::openFinish()
+{
+    bool StatsFromExternalData_IsOpen=m_open->StatsFromExternalData_IsOpen;
+    bool hasAttachment=!m_open->Attachment.isEmpty() || m_open->AttachmentIsMapped;
+    const auto& mediaOrMkvReportFileName=m_open->MediaOrMkvReportFileName;
+    int dpxOffset=m_open->DpxOffset;
+    const auto& activePanels=m_open->ActivePanels;
+
+    // Stats from the packets only, no filters are run, see PacketStats_Set
+    bool PacketsOnly=PacketStats && !Live && !isFollowed() && !StatsFromExternalData_IsOpen && !hasAttachment && dpxOffset == -1 && mediaOrMkvReportFileName != "pipe:0";
+    if (PacketsOnly)
+        ActiveFilters.reset();
+    const auto Profile=(AnalysisProfiles::profile)AnalysisProfile.load();
+    if (!StatsFromExternalData_IsOpen)
+        ActiveFilters&=AnalysisProfiles::Filters(Profile);
+
+    std::string Filters[Type_Max];
+    QStringList StatsChains; // Stats chain split in branches run in parallel, the first one has the "stats" output
+    int StatsKernelBranch=-1; // Branch of the frames of SignalStatsKernel
+    int StatsFieldsBranch=-1; // Branch of the frames of FieldCompareKernel
+    int StatsHdrBranch=-1; // Branch of the frames of HdrLightKernel
+    QString AudioChain; // Chain of the "astats" output
+    bool AudioKernelUsed=false;
+    if (!StatsFromExternalData_IsOpen)
+    {
+        // Reference at the size and the start time of the first video stream
+        compare_chain Compare;
+        {
+            QMutexLocker Locker(&Compare_Mutex);
+            Compare.Reference=CompareReference;
+            Compare.VmafLog=CompareVmafLog;
+        }
+        bool Comparing=!Compare.Reference.isEmpty() && !m_mediaParser->currentVideoStreams().empty();
+        if (Comparing)
+        {
+            const AVStream* Stream=m_mediaParser->currentVideoStreams()[0].stream();
+            Compare.Width=decodedVideoSize().width();
+            Compare.Height=decodedVideoSize().height();
+            Compare.Start=Stream->start_time!=AV_NOPTS_VALUE?Stream->start_time*av_q2d(Stream->time_base):0;
+        }
+
+        QList<double> StatsCosts;
+        QStringList StatsDetectors=StatsDetectors_Get(ActiveFilters, StatsCosts, Comparing?&Compare:nullptr);
+        Filters[0]=StatsDetectors.join(',').toStdString();
+
+        // The kernel replaces signalstats (the first detector) in a branch of its own, segmented parsing keeps the filter
+        // Luma only is a mode of the kernel only, the filter computes all the planes
+        int KernelMode=StatsKernel;
+        if (Profile==AnalysisProfiles::Profile_LumaOnly && KernelMode==StatsKernel_Off)
+            KernelMode=StatsKernel_On;
+        bool Kernel=KernelMode!=StatsKernel_Off && ActiveFilters[ActiveFilter_Video_signalstats];
+        if (Kernel && KernelMode==StatsKernel_On)
+        {
+            StatsDetectors.removeFirst();
+            StatsCosts.removeFirst();
+        }
+
+        // Same for the comparison of the fields (the last detector), the comparison with a reference keeps the filters
+        bool Fields=FieldKernel!=StatsKernel_Off && !Comparing && (ActiveFilters[ActiveFilter_Video_Psnr] || ActiveFilters[ActiveFilter_Video_Ssim]);
+        if (Fields && FieldKernel==StatsKernel_On)
+        {
+            StatsDetectors.removeLast();
+            StatsCosts.removeLast();
+        }
+        StatsChains=StatsChains_Get(StatsDetectors, StatsCosts, StatsBranches_Apply(StatsDetectors.size()));
+        if (Kernel)
+        {
+            StatsKernelBranch=StatsChains.size();
+            StatsChains.append(QString("format=pix_fmts=%1").arg(SignalStatsKernel::Formats()));
+        }
+        if (Fields)
+        {
+            StatsFieldsBranch=StatsChains.size();
+            StatsChains.append(QString("format=pix_fmts=%1").arg(FieldCompareKernel::Formats()));
+        }
+
+        // The light levels have no filter, the kernel only
+        if (ActiveFilters[ActiveFilter_Video_HdrLight])
+        {
+            StatsHdrBranch=StatsChains.size();
+            StatsChains.append(QString("format=pix_fmts=%1").arg(HdrLightKernel::Formats()));
+        }
+
+        // Detectors on the region only, the frames are decoded and shown whole
+        auto RegionOfInterest=RegionOfInterest_Get();
+        if (!RegionOfInterest.isEmpty() && !StatsChains.empty() && !m_mediaParser->currentVideoStreams().empty())
+        {
+            auto Region=RegionOfInterest.intersected(QRect(QPoint(0, 0), decodedVideoSize()));
+            if (Comparing)
+                qWarning() << "region of interest: not applied when comparing with a reference";
+            else if (Region.isEmpty())
+                qWarning() << "region of interest:" << RegionOfInterest << "is out of the frame" << decodedVideoSize();
+            else
+            {
+                auto Crop=QString("crop=%1:%2:%3:%4").arg(Region.width()).arg(Region.height()).arg(Region.x()).arg(Region.y());
+                for (auto& Chain : StatsChains)
+                    Chain=Crop+','+Chain;
+                if (!Filters[0].empty())
+                    Filters[0]=Crop.toStdString()+','+Filters[0];
+                qDebug() << "region of interest:" << Region;
+            }
+        }
+        Filters[1]=AudioDetectors_Get(ActiveFilters);
+        auto AudioRows=AudioRows_Get(m_mediaParser->availableAudioStreams(), m_mediaParser->availableVideoStreams());
+        if (!Filters[1].empty() && !AudioRows.empty())
+        {
+            Filters[1]=AudioRows+Filters[1];
+            qDebug() << "audio rows:" << AudioRows.c_str();
+        }
+
+        // The kernel replaces the 3 filters and their conversions by one, segmented parsing keeps the filters
+        AudioChain=QString::fromStdString(Filters[1]);
+        AudioKernelUsed=AudioKernel && (ActiveFilters[ActiveFilter_Audio_astats] || ActiveFilters[ActiveFilter_Audio_aphasemeter] || ActiveFilters[ActiveFilter_Audio_EbuR128]);
+        if (AudioKernelUsed)
+            AudioChain=QString("%1%2aformat=sample_fmts=%3").arg(QString::fromStdString(AudioRows)).arg(ActiveFilters[ActiveFilter_Audio_silencedetect]?"silencedetect,":"").arg(AudioStatsKernel::Formats());
+
+        m_panelSize.setWidth(512);
+    }
 
     if(!streamsStats && !formatStats)
     {
@@ -875,115 +1790,165 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
         if(allAudioTracks)
             m_mediaParser->setAudioStreams(m_mediaParser->availableAudioStreams());
 
+        // Other tracks are decoded and filtered by threads of their own instead of one after the other with the first ones
+        m_mediaParser->setStreamThreads(m_mediaParser->currentVideoStreams().size() > 1 || m_mediaParser->currentAudioStreams().size() > 1);
+
         qDebug() << "m_mediaParser->currentVideoStreams(): " << m_mediaParser->currentVideoStreams().size();
         qDebug() << "m_mediaParser->currentAudioStreams(): " << m_mediaParser->currentAudioStreams().size();
 
         auto streams = m_mediaParser->availableVideoStreams();
         streams.append(m_mediaParser->availableAudioStreams());
 
-        AVFormatContext* FormatContext = nullptr;
-        auto stdMediaFileName = mediaOrMkvReportFileName.toStdString();
-        AVDictionary* options = nullptr;
-        if (dpxOffset != -1) {
-            auto dpxOffsetString = std::to_string(dpxOffset);
-            av_dict_set(&options, "f", "image2", 0);
-            av_dict_set(&options, "start_number", dpxOffsetString.c_str(), 0);
-        }
-        if (avformat_open_input(&FormatContext, stdMediaFileName.c_str(), nullptr, &options)>=0)
+        // Same context as the parser, it is already probed
+        AVFormatContext* FormatContext = streams.empty() ? nullptr : streams.front().formatContext();
+        if (FormatContext)
         {
             QVector<QAVStream*> orderedStreams;
-            if (avformat_find_stream_info(FormatContext, NULL)>=0) {
 
-                containerFormat = FormatContext->iformat->long_name;
-                streamCount = FormatContext->nb_streams;
-                bitRate = FormatContext->bit_rate;
+            containerFormat = FormatContext->iformat->long_name;
+            streamCount = FormatContext->nb_streams;
+            bitRate = FormatContext->bit_rate;
 
-                size_t VideoPos=0;
-                size_t AudioPos=0;
+            size_t VideoPos=0;
+            size_t AudioPos=0;
 
-                for(auto i = 0; i < FormatContext->nb_streams; ++i) {
-                    auto codec_type = FormatContext->streams[i]->codecpar->codec_type;
-                    if(codec_type != AVMEDIA_TYPE_VIDEO && codec_type != AVMEDIA_TYPE_AUDIO)
-                        continue;
+            for(auto i = 0; i < FormatContext->nb_streams; ++i) {
+                auto codec_type = FormatContext->streams[i]->codecpar->codec_type;
+                if(codec_type != AVMEDIA_TYPE_VIDEO && codec_type != AVMEDIA_TYPE_AUDIO)
+                    continue;
 
-                    auto streamIt = std::find_if(streams.begin(), streams.end(), [i](QAVStream& stream) {
-                        return stream.stream()->index == i;
-                    });
+                auto streamIt = std::find_if(streams.begin(), streams.end(), [i](QAVStream& stream) {
+                    return stream.stream()->index == i;
+                });
 
-                    if(streamIt == streams.end()) {
-                        qDebug() << "error: it should never happen";
-                        assert(false);
-                        continue;
-                    }
+                if(streamIt == streams.end()) {
+                    qDebug() << "error: it should never happen";
+                    assert(false);
+                    continue;
+                }
 
-                    if(streamIt->codec()->codec() == nullptr) {
-                        qDebug() << "error: codec is null for stream" << i << "... skipping";
-                        continue;
-                    }
-                    orderedStreams.append(&*streamIt);
-
-                    auto Duration = 0;
-                    auto FrameCount = streamIt->stream()->nb_frames;
-                    if (streamIt->stream()->duration != AV_NOPTS_VALUE)
-                        Duration= ((double)streamIt->stream()->duration)*streamIt->stream()->time_base.num/streamIt->stream()->time_base.den;
-
-                    // If duration is not known, estimating it
-                    if (Duration==0 && FormatContext->duration!=AV_NOPTS_VALUE)
-                        Duration=((double)FormatContext->duration)/AV_TIME_BASE;
-
-                    // If frame count is not known, estimating it
-                    if (FrameCount==0 && streamIt->stream()->avg_frame_rate.num && streamIt->stream()->avg_frame_rate.den && Duration)
-                        FrameCount=Duration*streamIt->stream()->avg_frame_rate.num/streamIt->stream()->avg_frame_rate.den;
-                    if (FrameCount==0
-                        && ((streamIt->stream()->time_base.num==1 && streamIt->stream()->time_base.den>=24 && streamIt->stream()->time_base.den<=60)
-                            || (streamIt->stream()->time_base.num==1001 && streamIt->stream()->time_base.den>=24000 && streamIt->stream()->time_base.den<=60000)))
-                        FrameCount=streamIt->stream()->duration;
-
-                    CommonStats* Stat = nullptr;
-
-                    if(streamIt->stream()->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-                        if (!VideoPos || ActiveAllTracks[Type_Video])
-                            Stat = new VideoStats(FrameCount, Duration, &*streamIt);
-                        ++VideoPos;
-                    } else if(streamIt->stream()->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
-                        if (!AudioPos || ActiveAllTracks[Type_Audio])
-                            Stat = new AudioStats(FrameCount, Duration, &*streamIt);
-                        ++AudioPos;
-                    }
+                if(streamIt->codec()->codec() == nullptr) {
+                    qDebug() << "error: codec is null for stream" << i << "... skipping";
+                    continue;
+                }
+                orderedStreams.append(&*streamIt);
+
+                double Duration = 0;
+                auto FrameCount = streamIt->stream()->nb_frames;
+                if (streamIt->stream()->duration != AV_NOPTS_VALUE)
+                    Duration= ((double)streamIt->stream()->duration)*streamIt->stream()->time_base.num/streamIt->stream()->time_base.den;
+
+                // If duration is not known, estimating it
+                if (Duration==0 && FormatContext->duration!=AV_NOPTS_VALUE)
+                    Duration=((double)FormatContext->duration)/AV_TIME_BASE;
+
+                // If frame count is not known, estimating it
+                if (FrameCount==0 && streamIt->stream()->avg_frame_rate.num && streamIt->stream()->avg_frame_rate.den && Duration)
+                    FrameCount=Duration*streamIt->stream()->avg_frame_rate.num/streamIt->stream()->avg_frame_rate.den;
+                if (FrameCount==0
+                    && ((streamIt->stream()->time_base.num==1 && streamIt->stream()->time_base.den>=24 && streamIt->stream()->time_base.den<=60)
+                        || (streamIt->stream()->time_base.num==1001 && streamIt->stream()->time_base.den>=24000 && streamIt->stream()->time_base.den<=60000)))
+                    FrameCount=streamIt->stream()->duration;
+
+                CommonStats* Stat = nullptr;
+
+                if(streamIt->stream()->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+                    if (!VideoPos || ActiveAllTracks[Type_Video])
+                        Stat = new VideoStats(FrameCount, Duration, &*streamIt);
+                    ++VideoPos;
+                } else if(streamIt->stream()->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+                    if (!AudioPos || ActiveAllTracks[Type_Audio])
+                        Stat = new AudioStats(FrameCount, Duration, &*streamIt);
+                    ++AudioPos;
+                }
 
-                    if (Stat)
-                        Stats.push_back(Stat);
+                if (Stat)
+                {
+                    auto Items=AnalysisProfiles::Items(Profile, Stat->Type_Get());
+                    if (!Items.empty())
+                        Stat->Items_Restrict(Items);
+                    Stat->AdditionalStats_Declare(ActiveFilters);
+                    FrameHash_Declare(Stat);
+                    Stats.push_back(Stat);
                 }
+            }
+
+            streamsStats = new StreamsStats(orderedStreams, FormatContext);
+            formatStats = new FormatStats(FormatContext);
+        }
+    }
 
-                streamsStats = new StreamsStats(orderedStreams, FormatContext);
-                formatStats = new FormatStats(FormatContext);
+    if(PacketsOnly) {
+        // No thumbnails and no panels, the parser replaces the main parser
+        m_packetParser.reset(new PacketStatsParser(mediaOrMkvReportFileName, Stats, [this](bool isOk) {
+            if(isOk) {
+                finishParse();
+                return;
             }
 
-            avformat_close_input(&FormatContext);
+            m_parsed = true;
+            Q_EMIT parsingCompleted(false);
+        }));
+
+    } else if(!hasAttachment) {
+
+        // Video frames parsed, the stats of the video streams are sparse
+        if(!StatsFromExternalData_IsOpen && !m_mediaParser->currentVideoStreams().empty()) {
+            m_sampling = Sampling;
+            auto frameRate = m_mediaParser->currentVideoStreams()[0].stream()->avg_frame_rate;
+            if(SamplingRate > 0 && frameRate.num > 0 && frameRate.den > 0)
+                m_sampling = std::max(1, (int)std::lround(av_q2d(frameRate) / SamplingRate));
+            if(m_sampling == 1)
+                m_sampling = 0;
+
+            m_mediaParser->setVideoSampling(m_sampling);
+            for(auto stat : Stats)
+                if(stat && stat->Type_Get() == AVMEDIA_TYPE_VIDEO)
+                    stat->Sampling_Set(m_sampling);
         }
-        if (options) {
-            av_dict_free(&options);
+
+        // Video chains on the frames of the decoding device, the frames are kept on it from now on, see GpuFilters_Set
+        QString gpuScale, gpuDownload;
+        if(GpuFilters && !StatsFromExternalData_IsOpen && GpuFilters_Resolve(m_mediaParser->currentVideoStreams(), gpuScale, gpuDownload)) {
+            qDebug() << "video filters on the device with" << gpuScale << "then" << gpuDownload;
+            m_mediaParser->setHardwareFrames(true);
+            for(auto& chain : StatsChains)
+                chain = GpuChain_Get(chain, gpuScale, gpuDownload);
         }
-    }
+        auto videoChain = [&](const QString& chain) {
+            return gpuScale.isEmpty() ? chain : GpuChain_Get(chain, gpuScale, gpuDownload);
+        };
 
-    if(attachment.isEmpty()) {
+        // Chains of the same stream type are combined in one graph, see FilterGraphPlan
+        FilterGraphPlan videoPlan("split");
+        FilterGraphPlan audioPlan("asplit");
 
-        QList<QString> filters;
+        // The stats chains are graphs of their own, skipped by the duplicated frames, see FrameMemoization_Set
+        bool memoization = FrameMemoization && !StatsFromExternalData_IsOpen && !StatsChains.empty() && !m_mediaParser->currentVideoStreams().empty()
+            && Compare_Get().isEmpty() && AnalyzerPlugins::Get().empty()
+            && !ActiveFilters[ActiveFilter_Video_Idet] && !ActiveFilters[ActiveFilter_Video_Deflicker] && !ActiveFilters[ActiveFilter_Video_EntropyDiff]
+            && !ActiveFilters[ActiveFilter_Video_blackdetect] && !ActiveFilters[ActiveFilter_Video_freezedetect];
 
-        if(!Filters[0].empty() && !m_mediaParser->currentVideoStreams().empty())
-            filters.append(QString("%1 [%2]").arg(QString::fromStdString(Filters[0])).arg(stats));
+        if(!StatsChains.empty() && !m_mediaParser->currentVideoStreams().empty() && !memoization)
+            videoPlan.Add(StatsChains.front(), stats);
 
-        if(!Filters[1].empty() && !m_mediaParser->currentAudioStreams().empty())
-            filters.append(QString("%1 [%2]").arg(QString::fromStdString(Filters[1])).arg(astats));
+        if(!AudioChain.isEmpty() && !m_mediaParser->currentAudioStreams().empty())
+            audioPlan.Add(AudioChain, astats);
 
-        if(!m_mediaParser->currentVideoStreams().empty())
-            filters.append(QString("scale=72:72,format=rgb24 [%1]").arg(thumbnails));
+        if(!m_mediaParser->currentVideoStreams().empty() && !Live)
+            videoPlan.Add(videoChain(QString("scale=%1:%1,format=rgb24").arg(ThumbnailStore::Size_Parser())), thumbnails);
+
+        if(m_frameSnapshots && !StatsFromExternalData_IsOpen && !m_mediaParser->currentVideoStreams().empty())
+            videoPlan.Add(videoChain("null"), snapshot);
+
+        if(m_frameFeed && !StatsFromExternalData_IsOpen && !m_mediaParser->currentVideoStreams().empty())
+            videoPlan.Add(videoChain(m_frameFeed->Chain()), framefeed);
 
         if(!StatsFromExternalData_IsOpen) {
             // only do panels if no legacy report was opened
 
             if(!m_mediaParser->currentVideoStreams().empty()) {
-                auto codecHeight = m_mediaParser->currentVideoStreams()[0].stream()->codecpar->height;
+                auto codecHeight = decodedVideoSize().height();
                 qDebug() << "codec height: " << codecHeight;
                 m_panelSize.setHeight(codecHeight);
             }
@@ -1023,9 +1988,25 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
                     auto yaxis = std::get<2>(activePanels[panelTitle]);
                     auto legend = std::get<3>(activePanels[panelTitle]);
 
-                    auto f = filter + QString(" [panel_%1]").arg(m_panelMetadata.size());
-                    qDebug() << "f: " << f;
-                    filters.append(f);
+                    auto output = QString("%1%2").arg(panelOutputPrefix).arg(m_panelMetadata.size());
+                    qDebug() << "f: " << filter << output;
+
+                    // Built from the decoded frames, the filter chain is kept in the metadata as what the panel is
+                    int binsX = 0, binsY = 0;
+                    auto nativeMode = PanelBuilder::Mode_Get(std::get<5>(activePanels[panelTitle]), &binsX, &binsY);
+                    if(panelType == AVMEDIA_TYPE_VIDEO && nativeMode != PanelBuilder::Mode_Max && !PanelBuilder::Mode_IsAudio(nativeMode)) {
+                        videoPlan.Add(videoChain("null"), output);
+                        m_panelBuilders[m_panelMetadata.size()].reset(new PanelBuilder(nativeMode, m_panelSize.width(), binsX, binsY));
+                    }
+                    else if(panelType == AVMEDIA_TYPE_AUDIO && PanelBuilder::Mode_IsAudio(nativeMode)) {
+                        // The samples of the channels of the filter chains of the audio panels
+                        audioPlan.Add("aformat=sample_fmts=fltp:channel_layouts=stereo", output);
+                        m_panelBuilders[m_panelMetadata.size()].reset(new PanelBuilder(nativeMode, m_panelSize.width(), binsX, binsY));
+                    }
+                    else if(panelType == AVMEDIA_TYPE_VIDEO)
+                        videoPlan.Add(videoChain(filter), output);
+                    else
+                        audioPlan.Add(filter, output);
 
                     std::map<std::string, std::string> metadata;
                     metadata["filter"] = filter.toStdString();
@@ -1052,49 +2033,279 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
             }
         }
 
+        // Thumbnails of the key frames until the parser gets to the frames
+        if(KeyFramePreview && !Live && !isFollowed() && !StatsFromExternalData_IsOpen && dpxOffset == -1 && mediaOrMkvReportFileName != "pipe:0" && !m_mediaParser->currentVideoStreams().empty())
+        {
+            m_keyFrameThumbnails.reset(new KeyFrameThumbnails(mediaOrMkvReportFileName, m_mediaParser->currentVideoStreams().first().index()));
+            m_keyFrameThumbnails->Start();
+        }
+
+        // Segmented parsing replaces the main parser, it runs the stats filters only
+        // ebur128 integrated loudness and range are computed from the start of the stream, they can not be split
+        // The segment parser is created when parsing starts, the count of segments may be changed until then
+        // The reference of Compare_Set is read from its start
+        // Analyzer plugins receive the frames of a stream in order, from its start
+        // The end of a file still being written is not known, segments are split from its duration
+        // The light levels are computed by the kernel of the main parser only
+        if(!StatsFromExternalData_IsOpen && !isFollowed() && dpxOffset == -1 && mediaOrMkvReportFileName != "pipe:0" && !ActiveFilters[ActiveFilter_Audio_EbuR128] && !ActiveFilters[ActiveFilter_Video_HdrLight] && Compare_Get().isEmpty() && AnalyzerPlugins::Get().empty())
+        {
+            QVector<int> videoStreams;
+            for(const auto& stream : m_mediaParser->currentVideoStreams())
+                videoStreams.append(stream.index());
+            QVector<int> audioStreams;
+            for(const auto& stream : m_mediaParser->currentAudioStreams())
+                audioStreams.append(stream.index());
+            QString videoFilter = QString::fromStdString(Filters[0]);
+            QString audioFilter = QString::fromStdString(Filters[1]);
+            double duration = m_mediaParser->duration() / 1000.0;
+
+            m_segmentParserFactory = [this, mediaOrMkvReportFileName, videoStreams, audioStreams, videoFilter, audioFilter, duration](int count) {
+                return new StatsSegmentParser(mediaOrMkvReportFileName, Stats, videoStreams, audioStreams, videoFilter, audioFilter, duration, count, [this](bool isOk) {
+                    if(isOk) {
+                        for (size_t Pos=0; Pos<Stats.size(); Pos++)
+                            if (Stats[Pos])
+                                Stats[Pos]->StatsFinish();
+
+                        finishStreamExport();
+                    }
+
+                    m_parsed = true;
+                    Q_EMIT parsingCompleted(isOk);
+                });
+            };
+        }
+
+        // Same analysis in a helper process, the stats and the thumbnails are read from its shared memory
+        if(AnalysisProcess && !StatsFromExternalData_IsOpen && !isFollowed() && !Live && dpxOffset == -1 && mediaOrMkvReportFileName != "pipe:0"
+            && !m_frameSnapshots && !m_frameFeed && !m_thumbnailSprites && !m_sampling)
+        {
+            m_processParser.reset(new StatsProcessParser(mediaOrMkvReportFileName, ActiveFilters, ActiveAllTracks, Stats, &m_thumbnails, [this](bool isOk) {
+                for (size_t Pos=0; Pos<Stats.size(); Pos++)
+                    if (Stats[Pos])
+                        Stats[Pos]->StatsFinish();
+
+                finishStreamExport();
+
+                m_parsed = true;
+                Q_EMIT parsingCompleted(isOk);
+            }));
+        }
+
+        QList<QString> filters;
+        for(const auto* plan : { &videoPlan, &audioPlan }) {
+            if(plan->Empty())
+                continue;
+            if(FilterGraphsCombined)
+                filters.append(plan->Combined());
+            else
+                filters.append(plan->Separated());
+        }
+
+        // Stats graph then its branches, see FrameMemoization_Set
+        int statsGraph = filters.size();
+        if(memoization)
+            filters.append(QString("%1 [%2]").arg(StatsChains.front()).arg(stats));
+
+        // Other branches are graphs of their own, so they are written by other threads
+        m_statsBranches->Count=m_mediaParser->currentVideoStreams().empty()?1:std::max(1, (int)StatsChains.size());
+        for(int i = 1; i < m_statsBranches->Count; ++i)
+            filters.append(QString("%1 [%2%3]").arg(StatsChains[i]).arg(statsBranchPrefix).arg(i));
+        QList<bool> skipDuplicates;
+        if(memoization) {
+            for(int i = 0; i < filters.size(); ++i)
+                skipDuplicates.append(i >= statsGraph);
+            for(const auto& stream : m_mediaParser->currentVideoStreams())
+                if(stream.index() < Stats.size() && Stats[stream.index()]) {
+                    Stats[stream.index()]->AdditionalStats_Declare("qctools.duplicate", Additional_Int);
+                    m_lastStatsFrames[stream.index()] = QAVVideoFrame();
+                }
+            qDebug() << "duplicated frames not filtered by the stats graphs";
+        }
+        m_mediaParser->setSkipDuplicateFrames(skipDuplicates);
+        m_statsBranches->Kernel=m_mediaParser->currentVideoStreams().empty()?-1:StatsKernelBranch;
+        m_statsBranches->Check=StatsKernel==StatsKernel_Check;
+        m_statsBranches->LumaOnly=Profile==AnalysisProfiles::Profile_LumaOnly;
+        m_statsBranches->Fields=m_mediaParser->currentVideoStreams().empty()?-1:StatsFieldsBranch;
+        m_statsBranches->FieldsCheck=FieldKernel==StatsKernel_Check;
+        m_statsBranches->FieldsPsnr=ActiveFilters[ActiveFilter_Video_Psnr];
+        m_statsBranches->FieldsSsim=ActiveFilters[ActiveFilter_Video_Ssim];
+        m_statsBranches->Hdr=m_mediaParser->currentVideoStreams().empty()?-1:StatsHdrBranch;
+        // Graphs of the same media type run together (separated outputs and stats branches), one graph of each type only costs this thread
+        m_mediaParser->setParallelFilters(filters.size() > 1);
+
+        if(AudioKernelUsed)
+            for(const auto& stream : m_mediaParser->currentAudioStreams())
+                m_audioKernels[stream.index()].reset(new AudioStatsKernel(ActiveFilters[ActiveFilter_Audio_astats], ActiveFilters[ActiveFilter_Audio_aphasemeter], ActiveFilters[ActiveFilter_Audio_EbuR128], AudioKernelWindow));
+
+        // Columns are declared before the first frame, on the frames of the stats
+        if(CaptionsTimecode_Enabled)
+            for(const auto& stream : m_mediaParser->currentVideoStreams())
+                if(stream.index() < Stats.size() && Stats[stream.index()]) {
+                    CaptionsTimecode::Declare(Stats[stream.index()]);
+                    m_captionsTimecodes[stream.index()].reset(new CaptionsTimecode(stream.stream(), stream.formatContext()));
+                }
+        if(!AnalyzerPlugins::Get().empty()) {
+            auto streams = m_mediaParser->currentVideoStreams();
+            streams.append(m_mediaParser->currentAudioStreams());
+            for(const auto& stream : streams) {
+                if(stream.index() >= Stats.size() || !Stats[stream.index()])
+                    continue;
+                auto analyzers = AnalyzerPlugins::Create(Stats[stream.index()], stream);
+                if(!analyzers.empty())
+                    m_analyzers[stream.index()] = std::move(analyzers);
+            }
+        }
+
         for(auto& filter : filters) {
             qDebug() << "applying filters: " << filter;
         }
         m_mediaParser->setFilters(filters);
+        m_memoryStatsBytes.reset(new std::atomic<size_t>[Stats.size()]());
+
+        // The player threads compute what needs the pixels or the samples then go on decoding, the columns are written by
+        // the thread of the stats, except for the snapshots and the sprites which need the stats of the frame with its pixels
+        if(!m_frameSnapshots && !m_thumbnailSprites) {
+            m_statsIngest.reset(new StatsIngest(Stats.size(), [this](size_t index, StatsIngest::item& item) {
+                TraceEvents::Scope Trace("stats", "stats ingest", index);
+                auto stat = Stats[index];
+                stat->TimeStampFromFrame(item.Frame, stat->x_Current);
+                if(!item.Values.empty())
+                    stat->StatsFromKernel(item.Values);
+                stat->StatsFromFrame(item.Frame, item.Width, item.Height);
+                memoryPressure(stat, index);
+            }));
+            m_statsIngest->Start();
+        }
+
+        // Outputs of the graphs routed by their identifier (see QAVFrame::filterOutputId()), not by their name
+        // Identifiers are small integers of the process, the table has one handler per identifier up to the last one used here
+        typedef std::function<void(const QAVVideoFrame&)> videoHandler;
+        std::vector<videoHandler> videoHandlers;
+        auto addVideoHandler = [&videoHandlers](const QString& output, videoHandler handler) {
+            auto id = QAVFrame::filterOutputId(output);
+            if(videoHandlers.size() <= (size_t) id)
+                videoHandlers.resize(id + 1);
+            videoHandlers[id] = std::move(handler);
+        };
+        addVideoHandler(stats, [this](const QAVVideoFrame &frame) {
+            if(frame.stream().index() >= Stats.size())
+                return;
+            if(m_statsBranches->Count > 1 || m_statsBranches->Kernel >= 0 || m_statsBranches->Fields >= 0 || m_statsBranches->Hdr >= 0)
+                statsFromBranch(frame, 0);
+            else
+                statsFromFrame(frame);
+        });
+        for(int i = 1; i < m_statsBranches->Count; ++i)
+            addVideoHandler(QString("%1%2").arg(statsBranchPrefix).arg(i), [this, i](const QAVVideoFrame &frame) {
+                if(frame.stream().index() < Stats.size())
+                    statsFromBranch(frame, i);
+            });
+        addVideoHandler(duplicate, [this](const QAVVideoFrame &frame) {
+            if(frame.stream().index() < Stats.size())
+                statsFromDuplicate(frame);
+        });
+        for(int index = 0; index < (int) m_panelMetadata.size(); ++index)
+            addVideoHandler(QString("%1%2").arg(panelOutputPrefix).arg(index), [this, index](const QAVVideoFrame &frame) {
+                QMutexLocker locker(&m_panelFramesMutex); // Video tracks have threads of their own
+                if(m_memoryDropped)
+                    return;
+                while(m_panelFrames.size() <= (size_t) index)
+                    m_panelFrames.emplace_back(new PanelFrameStore);
+
+                auto builder = m_panelBuilders.find(index);
+                if(builder == m_panelBuilders.end())
+                    m_panelFrames[index]->Push(frame.frame());
+                else if(auto panel = builder->second->Push(frame.frame()))
+                    m_panelFrames[index]->Push(panel);
+
+                QCTOOLS_TRACE(Category_Panels, "panel {} frame {}, pts {}", index, m_panelFrames[index]->Count(), frame.frame()->pts);
+            });
+        addVideoHandler(thumbnails, [this](const QAVVideoFrame &frame) {
+            m_thumbnails.Push(frame.frame());
+            if(m_thumbnailSprites && Stats[frame.stream().index()])
+                m_thumbnailSprites->Push(m_thumbnails, *Stats[frame.stream().index()]);
+        });
+        addVideoHandler(snapshot, [this](const QAVVideoFrame &frame) {
+            m_frameSnapshots->FromDecodedFrame(frame);
+        });
+        addVideoHandler(framefeed, [this](const QAVVideoFrame &frame) {
+            m_frameFeed->Write(frame);
+        });
+        const int astatsOutput = QAVFrame::filterOutputId(astats);
+
+        // Panels built from the samples, panel output index by filter output identifier (-1 if none)
+        std::vector<int> audioPanels;
+        for(const auto& builder : m_panelBuilders) {
+            const auto& metadata = m_panelMetadata.at(builder.first);
+            auto type = metadata.find("panel_type");
+            if(type == metadata.end() || type->second != "audio")
+                continue;
+            auto id = QAVFrame::filterOutputId(QString("%1%2").arg(panelOutputPrefix).arg(builder.first));
+            if(audioPanels.size() <= (size_t) id)
+                audioPanels.resize(id + 1, -1);
+            audioPanels[id] = builder.first;
+        }
 
-        QObject::connect(m_mediaParser, &QAVPlayer::audioFrame, m_mediaParser, [this](const QAVAudioFrame &frame) {
-                qDebug() << "audio frame came from: " << frame.filterName() << frame.stream() << frame.stream().index();
+        QObject::connect(m_mediaParser, &QAVPlayer::audioFrame, m_mediaParser, [this, astatsOutput, audioPanels](const QAVAudioFrame &frame) {
+                QCTOOLS_TRACE(Category_Frames, "audio frame came from: {}, stream {}, pts {}", frame.filterName().toStdString(), frame.stream().index(), frame.frame()->pts);
+                if(!inParsingRange(frame))
+                    return;
+
+                auto output = frame.filterOutput();
+                if(output >= 0 && (size_t) output < audioPanels.size() && audioPanels[output] >= 0) {
+                    QMutexLocker locker(&m_panelFramesMutex);
+                    if(m_memoryDropped)
+                        return;
+                    auto index = audioPanels[output];
+                    while(m_panelFrames.size() <= (size_t) index)
+                        m_panelFrames.emplace_back(new PanelFrameStore);
+                    m_panelBuilders[index]->Push(frame.frame(), [this, index](const AVFrame* panel) {
+                        m_panelFrames[index]->Push(panel);
+                        QCTOOLS_TRACE(Category_Panels, "panel {} frame {}, pts {}", index, m_panelFrames[index]->Count(), panel->pts);
+                    });
+                    return;
+                }
 
-                if (frame.filterName() == astats && frame.stream().index() < Stats.size()) {
+                if (frame.filterOutput() == astatsOutput && frame.stream().index() < Stats.size()) {
+                    TraceEvents::Scope Trace("stats", "audio stats ingest", frame.stream().index());
                     auto stat = Stats[frame.stream().index()];
 
+                    // Samples used here only, the stats of the frame are written by the thread of the stats
+                    if(m_statsIngest) {
+                        auto& item = m_statsIngest->Next(frame.stream().index());
+                        auto kernel = m_audioKernels.find(frame.stream().index());
+                        if(kernel != m_audioKernels.end() && kernel->second->Compute(frame.frame()))
+                            AudioStats::KernelValues(*kernel->second, item.Values);
+                        auto analyzers = m_analyzers.find(frame.stream().index());
+                        if(analyzers != m_analyzers.end())
+                            AnalyzerPlugins::Run(analyzers->second, frame);
+                        m_statsIngest->Push(frame.stream().index(), frame);
+                        return;
+                    }
+
                     stat->TimeStampFromFrame(frame, stat->x_Current);
+                    auto kernel = m_audioKernels.find(frame.stream().index());
+                    if(kernel != m_audioKernels.end() && kernel->second->Compute(frame.frame()))
+                        static_cast<AudioStats*>(stat)->StatsFromKernel(*kernel->second);
+                    auto analyzers = m_analyzers.find(frame.stream().index());
+                    if(analyzers != m_analyzers.end())
+                        AnalyzerPlugins::Run(analyzers->second, frame);
                     stat->StatsFromFrame(frame, 0, 0);
+                    memoryPressure(stat, frame.stream().index());
                 }
             },
             // Qt::QueuedConnection
             Qt::DirectConnection
             );
 
-        QObject::connect(m_mediaParser, &QAVPlayer::videoFrame, m_mediaParser, [this](const QAVVideoFrame &frame) {
-                qDebug() << "video frame came from: " << frame.filterName() << frame.stream() << frame.stream().index();
-
-                if(frame.filterName() == stats && frame.stream().index() < Stats.size()) {
-                    auto stat = Stats[frame.stream().index()];
-
-                    stat->TimeStampFromFrame(frame, stat->x_Current);
-                    stat->StatsFromFrame(frame, frame.size().width(), frame.size().height());
-
-                } else if(frame.filterName().startsWith(panelOutputPrefix)) {
-                    auto indexString = frame.filterName().mid(panelOutputPrefix.length());
-                    auto index = indexString.toInt();
-                    while(m_panelFrames.size() <= index)
-                        m_panelFrames.append(QVector<QAVVideoFrame>());
-
-                    m_panelFrames[index].append(frame);
+        QObject::connect(m_mediaParser, &QAVPlayer::videoFrame, m_mediaParser, [this, videoHandlers](const QAVVideoFrame &frame) {
+                QCTOOLS_TRACE(Category_Frames, "video frame came from: {}, stream {}, pts {}", frame.filterName().toStdString(), frame.stream().index(), frame.frame()->pts);
+                if(!inParsingRange(frame))
+                    return;
 
-                    qDebug() << "panel frame pts: " << frame.frame()->pts;
-                    qDebug() << "m_panelFrames[index]: " << m_panelFrames[index].size() << index << indexString;
-                }
-                else if(frame.filterName() == thumbnails)
-                {
-                    m_thumbnails_frames.push_back(frame);
-                }
+                auto output = frame.filterOutput();
+                if(output >= 0 && (size_t) output < videoHandlers.size() && videoHandlers[output])
+                    videoHandlers[output](frame);
             },
             //Qt::QueuedConnection
             Qt::DirectConnection
@@ -1104,13 +2315,10 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
             qDebug() << "m_mediaParser => mediaStatusChanged: " << status;
 
             if(status == QAVPlayer::EndOfMedia) {
+                if(m_hasParsingRange && m_parsingRangeEnded.exchange(true))
+                    return; // Already finished at the end of the range
 
-                for (size_t Pos=0; Pos<Stats.size(); Pos++)
-                    if (Stats[Pos])
-                        Stats[Pos]->StatsFinish();
-
-                m_parsed = true;
-                Q_EMIT parsingCompleted(true);
+                finishParse();
             }
             else if(status == QAVPlayer::InvalidMedia)
             {
@@ -1119,17 +2327,12 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
             }
         });
 
-        QObject::connect(m_mediaParser, &QAVPlayer::stateChanged, [this](QAVPlayer::State state) {
-            if(state == QAVPlayer::PlayingState) {
-                ++ActiveParsing_Count;
-            } else if(state == QAVPlayer::StoppedState) {
-                --ActiveParsing_Count;
-            }
-        });
-
     } else {
+        // Frames of the report decoded on demand around the ones displayed instead of all of them, see ReportFrames
+        bool onDemand = !isFollowed() && dpxOffset == -1 && mediaOrMkvReportFileName != "pipe:0";
         auto availableVideoStreams = m_mediaParser->availableVideoStreams();
-        m_mediaParser->setVideoStreams(availableVideoStreams);
+        if(!onDemand)
+            m_mediaParser->setVideoStreams(availableVideoStreams);
 
         for(auto i = 0; i < availableVideoStreams.count(); ++i) {
             if(i == 0)
@@ -1148,132 +2351,1982 @@ FileInformation::FileInformation (SignalServer* signalServer, const QString &Fil
             }
         }
 
-        QObject::connect(m_mediaParser, &QAVPlayer::videoFrame, m_mediaParser, [this](const QAVVideoFrame &frame) {
-                qDebug() << "video frame came from: " << frame.filterName() << frame.stream() << "Frames_Pos = " << Frames_Pos;
+        if(onDemand) {
+            m_reportFrames.reset(new ReportFrames(mediaOrMkvReportFileName, [this](bool isOk) {
+                // The parsing is the one of the re-analysis
+                if(m_reanalysisParser)
+                    return;
+
+                for (size_t Pos=0; Pos<Stats.size(); Pos++)
+                    if (Stats[Pos])
+                        Stats[Pos]->StatsFinish();
+
+                m_parsed = true;
+                Q_EMIT parsingCompleted(isOk);
+            }));
+        } else {
+            QObject::connect(m_mediaParser, &QAVPlayer::videoFrame, m_mediaParser, [this](const QAVVideoFrame &frame) {
+                    QCTOOLS_TRACE(Category_Frames, "video frame came from: {}, stream {}, Frames_Pos {}", frame.filterName().toStdString(), frame.stream().index(), Frames_Pos);
+
+                    if(frame.stream().index() == 0) {
+                        m_thumbnails.Push(frame.frame());
+
+                    } else {
+                        int index = frame.stream().index();
+
+                        while(m_panelFrames.size() < (size_t) index)
+                            m_panelFrames.emplace_back(new PanelFrameStore);
+
+                        auto panelStreamIndex = index - 1;
+                        m_panelFrames[panelStreamIndex]->Push(frame.frame());
+
+                        QCTOOLS_TRACE(Category_Panels, "panel {} frame {}", panelStreamIndex, m_panelFrames[panelStreamIndex]->Count());
+                    }
+                },
+                //Qt::QueuedConnection
+                Qt::DirectConnection
+                );
+
+            QObject::connect(m_mediaParser, &QAVPlayer::mediaStatusChanged, [this](QAVPlayer::MediaStatus status) {
+                qDebug() << "m_mediaParser => mediaStatusChanged: " << status;
+
+                if(status == QAVPlayer::EndOfMedia) {
+
+                    for (size_t Pos=0; Pos<Stats.size(); Pos++)
+                        if (Stats[Pos])
+                            Stats[Pos]->StatsFinish();
+
+                    m_parsed = true;
+                    Q_EMIT parsingCompleted(true);
+                }
+                else if(status == QAVPlayer::InvalidMedia)
+                {
+                    m_parsed = true;
+                    Q_EMIT parsingCompleted(false);
+                }
+            });
+        }
+    }
+
+    // Thumbnails and panels are the ones of the report from now on
+    if (hasAttachment)
+        m_mkvReportFileName = m_open->AttachmentFileName;
+
+    // Only the filters missing from the report are run on the media, see Reanalysis_Set
+    if (StatsFromExternalData_IsOpen && Reanalysis && dpxOffset == -1 && FileName != m_open->StatsFromExternalData_FileName && FileName != m_open->AttachmentFileName && QFile::exists(FileName))
+    {
+        auto Missing = ActiveFilters & ~reportFilters();
+        Missing.reset(ActiveFilter_Video_HdrLight); // Kernel of the analysis only, no filter to run
+        QList<double> Costs;
+        auto VideoFilter = StatsDetectors_Get(Missing, Costs).join(',');
+        auto AudioFilter = QString::fromStdString(AudioDetectors_Get(Missing));
+        if (VideoFilter.isEmpty() && AudioFilter.isEmpty())
+            qDebug() << "re-analysis: the report has all the filters";
+        else
+        {
+            m_reanalysisParser.reset(new StatsReanalysisParser(FileName, Stats, Missing, VideoFilter, AudioFilter, [this](bool isOk) {
+                finishStreamExport();
+
+                m_parsed = true;
+                Q_EMIT parsingCompleted(isOk);
+            }));
+            if (!m_reanalysisParser->IsValid())
+                m_reanalysisParser.reset();
+        }
+    }
+
+    // Looking for the reference stream (video or audio)
+    ReferenceStream_Pos=0;
+    for (; ReferenceStream_Pos<Stats.size(); ReferenceStream_Pos++)
+        if (Stats[ReferenceStream_Pos] && Stats[ReferenceStream_Pos]->Type_Get()==0)
+            break;
+    if (ReferenceStream_Pos>=Stats.size())
+    {
+        ReferenceStream_Pos = 0;
+        for (; ReferenceStream_Pos<Stats.size(); ReferenceStream_Pos++)
+            if (Stats[ReferenceStream_Pos] && Stats[ReferenceStream_Pos]->Type_Get()==1) //Audio
+                break;
+        if (ReferenceStream_Pos>=Stats.size())
+            Stats.clear(); //Removing all, as we can not sync with video or audio
+    }
+
+    // Report still read, parsing is started with its end
+    if (m_reportLoading)
+    {
+        m_opened=true;
+        if (m_open->ReportRead)
+            openStats_Finish();
+        Q_EMIT opened(isValid() || hasStats());
+        return;
+    }
+
+    bool Parse=m_open->Parse;
+    m_open.reset();
+    m_opened=true;
+    if (Parse)
+        startParse();
+    Q_EMIT opened(isValid() || hasStats());
+}
+
+//---------------------------------------------------------------------------
+// End of a report read progressively, from the event loop once opened and read
+void FileInformation::openStats_Finish()
+{
+    formatStats->readFromXML(m_open->Trailer.c_str(), m_open->Trailer.size());
+    streamsStats->readFromXML(m_open->Trailer.c_str(), m_open->Trailer.size());
+
+    for (size_t Pos=0; Pos<m_open->LateStats.size(); Pos++)
+    {
+        if (!m_open->LateStats[Pos])
+            continue;
+        if (Stats.size()<=Pos)
+            Stats.resize(Pos+1);
+        Stats[Pos]=m_open->LateStats[Pos];
+        qDebug() << "stats: stream" << Pos << "first seen after the publication of the report";
+    }
+
+    bool Parse=m_open->Parse;
+    m_open.reset();
+    m_reportLoading=false;
+    if (Parse)
+        startParse();
+}
+
+//---------------------------------------------------------------------------
+FileInformation::~FileInformation ()
+{
+    // Still reading the report if opened asynchronously
+    m_openFuture.waitForFinished();
+
+    endParse();
+    ParsingScheduler::Forget(this);
+
+    if(m_mediaParser->state() == QAVPlayer::PlayingState) {
+        m_mediaParser->stop();
+        delete m_mediaParser;
+    }
+
+    // Export while parsing not finished, it uses the stats
+    m_statsIngest.reset();
+    m_streamExport.reset();
+    m_segmentParser.reset();
+    m_packetParser.reset();
+    m_processParser.reset();
+    m_reanalysisParser.reset();
+    m_keyFrameThumbnails.reset();
+    m_reportFrames.reset();
+
+    if(m_mediaPlayer) {
+        m_mediaPlayer->stop();
+        delete m_mediaPlayer;
+    }
+
+    bool result = wait();
+    assert(result);
+
+	delete streamsStats;
+    delete formatStats;
+
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
+        delete Stats[Pos];
+}
+
+//***************************************************************************
+// Parsing
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void FileInformation::startParse ()
+{
+    m_jobType = Parsing;
+
+    // Report still read, started with its end (see openStats_Finish)
+    if (m_reportLoading && m_open)
+    {
+        m_open->Parse=true;
+        return;
+    }
+
+    // Started once opened
+    if (!m_opened || m_parsed || m_parsing || ParsingScheduler::IsPending(this))
+        return;
+
+    ParsingScheduler::Request(this);
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::startParse_Now()
+{
+    m_parsing = true;
+    m_parsingTimer.start();
+
+    if (m_packetParser)
+    {
+        if (m_hasParsingRange)
+            m_packetParser->Range_Set(m_parsingRangeStart, m_parsingRangeEnd);
+        m_packetParser->Start();
+        return;
+    }
+
+    // Packets of the report indexed, its frames are decoded when displayed
+    if (m_reportFrames)
+    {
+        m_reportFrames->Start();
+        if (!m_reanalysisParser)
+            return;
+    }
+
+    // Frames are matched by position, the whole file is parsed
+    if (m_reanalysisParser)
+    {
+        m_reanalysisParser->Start();
+        return;
+    }
+
+    // The helper parses the whole file
+    if (m_processParser && !m_hasParsingRange)
+    {
+        m_processParser->Start();
+        return;
+    }
+
+    if (m_parsingSegments > 1 && m_segmentParserFactory && !m_frameSnapshots && !m_frameFeed && !m_thumbnailSprites && !m_hasParsingRange && !m_sampling)
+    {
+        m_segmentParser.reset(m_segmentParserFactory(m_parsingSegments));
+        if (m_segmentParser->Count() < 2)
+            m_segmentParser.reset();
+    }
+
+    if (m_segmentParser)
+        m_segmentParser->Start();
+    else
+    {
+        // Positions are time stamps, as frame time stamps
+        if (m_hasParsingRange && m_parsingRangeStart > StatsSegmentParser::Warmup)
+            m_mediaParser->seek((qint64)((m_parsingRangeStart - StatsSegmentParser::Warmup) * 1000));
+        m_mediaParser->play();
+    }
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::finishParse()
+{
+    statsFromBranches_Flush();
+    if (m_statsIngest)
+        m_statsIngest->Flush();
+    panelBuilders_Flush();
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
+        if (Stats[Pos])
+            Stats[Pos]->StatsFinish();
+
+    finishStreamExport();
+
+    m_parsed = true;
+    Q_EMIT parsingCompleted(true);
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::setParsingRange(double Start, double End, bool InFrames)
+{
+    if (InFrames)
+    {
+        // Half a frame before the frame, for time stamps not exactly on the frame rate
+        if (m_mediaParser->currentVideoStreams().empty())
+            return false;
+        auto Stream = m_mediaParser->currentVideoStreams()[0].stream();
+        double Rate = av_q2d(Stream->avg_frame_rate);
+        if (!Rate)
+            return false;
+        double First = Stream->start_time != AV_NOPTS_VALUE ? Stream->start_time * av_q2d(Stream->time_base) : 0;
+        Start = std::isfinite(Start) ? First + (Start - 0.5) / Rate : Start;
+        End = std::isfinite(End) ? First + (End - 0.5) / Rate : End;
+    }
+
+    m_hasParsingRange = true;
+    m_parsingRangeStart = Start;
+    m_parsingRangeEnd = End;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Player threads, frames of the warm-up and after the range are dropped (frames without time stamp are kept)
+bool FileInformation::inParsingRange(const QAVFrame& frame)
+{
+    if (!m_hasParsingRange)
+        return true;
+
+    double TimeStamp = frame.pts();
+    if (TimeStamp < m_parsingRangeStart)
+        return false;
+    if (!(TimeStamp >= m_parsingRangeEnd))
+        return !m_parsingRangeEnded;
+
+    QMutexLocker Lock(&m_parsingRangeMutex);
+    if (m_parsingRangeEnded)
+        return false;
+
+    size_t Index = frame.stream().index();
+    if (m_parsingRangeEndedStreams.size() < Stats.size())
+        m_parsingRangeEndedStreams.resize(Stats.size());
+    if (Index < m_parsingRangeEndedStreams.size())
+        m_parsingRangeEndedStreams[Index] = true;
+
+    // A stream shorter than the others (e.g. audio) must not make the parsing continue until the end of the file
+    bool IsEnd = TimeStamp >= m_parsingRangeEnd + StatsSegmentParser::Warmup;
+    if (!IsEnd)
+    {
+        IsEnd = true;
+        for (size_t Pos = 0; Pos < Stats.size(); Pos++)
+            if (Stats[Pos] && !m_parsingRangeEndedStreams[Pos])
+                IsEnd = false;
+    }
+    if (IsEnd && !m_parsingRangeEnded.exchange(true))
+    {
+        // The player is stopped by the thread of this object, not from a player callback
+        QMetaObject::invokeMethod(this, "parsingRangeEnded", Qt::QueuedConnection);
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::parsingRangeEnded()
+{
+    m_mediaParser->stop();
+    finishParse();
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::endParse()
+{
+    if (ParsingScheduler::Cancel(this) || !m_parsing)
+        return;
+
+    m_parsing = false;
+    m_parsingTime = m_parsingTimer.elapsed();
+    ParsingScheduler::Finished(this);
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::parsingPriority_Set(QThread::Priority Priority)
+{
+    m_mediaParser->setThreadPriority(Priority);
+    if (m_segmentParser)
+        m_segmentParser->ThreadPriority_Set(Priority);
+    if (m_reanalysisParser)
+        m_reanalysisParser->ThreadPriority_Set(Priority);
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::setParsingSegments(int Count)
+{
+    m_parsingSegments = Count;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::parsingSegments() const
+{
+    return m_segmentParser ? (int)m_segmentParser->Count() : 1;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::setParsingPaused(bool Paused)
+{
+    if (Paused == m_parsingPaused || !parsingPausable(Paused))
+        return;
+
+    m_parsingPaused = Paused;
+    if (!m_parsingThrottled)
+        parsingPlayers_Pause(Paused);
+    ParsingScheduler::Paused_Set(this, Paused);
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::parsingPausable(bool Paused) const
+{
+    // A player paused at the end of the media would seek to the start
+    if (!m_parsing || m_parsed || m_packetParser || (m_processParser && m_processParser->isRunning()) || (m_reportFrames && !m_reanalysisParser))
+        return false;
+    return !Paused || m_segmentParser || m_reanalysisParser || m_mediaParser->mediaStatus() != QAVPlayer::EndOfMedia;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::parsingPlayers_Pause(bool Paused)
+{
+    if (m_segmentParser)
+        m_segmentParser->Paused_Set(Paused);
+    else if (m_reanalysisParser)
+        m_reanalysisParser->Paused_Set(Paused);
+    else if (Paused)
+        m_mediaParser->pause();
+    else
+        m_mediaParser->play();
+}
+
+//---------------------------------------------------------------------------
+// Same as a pause for the players, the scheduler still counts the file as running
+void FileInformation::parsingThrottled_Set(bool Throttled)
+{
+    if (Throttled == m_parsingThrottled || !parsingPausable(Throttled))
+        return;
+
+    m_parsingThrottled = Throttled;
+    if (!m_parsingPaused)
+        parsingPlayers_Pause(Throttled);
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::parsingPaused() const
+{
+    return m_parsingPaused;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::sampling() const
+{
+    return m_sampling;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ParsingMax_Set(int Count)
+{
+    ActiveParsing_Max=Count;
+    ParsingScheduler::Max_Set(Count);
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::ParsingMax_Get()
+{
+    return ParsingScheduler::Max_Get();
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ParsingCurrent_Set(FileInformation* File)
+{
+    ParsingScheduler::Current_Set(File);
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::BackgroundParsing_Set(bool Value)
+{
+    BackgroundParsing=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::BackgroundParsing_Get()
+{
+    return BackgroundParsing;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ParsingInteractionCores_Set(int Cores)
+{
+    ParsingScheduler::InteractionCores_Set(Cores);
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ParsingInteraction()
+{
+    ParsingScheduler::Interaction();
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ParsingSegments_Set(int Count)
+{
+    ParsingSegments=Count;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::ParsingSegments_Get()
+{
+    return ParsingSegments;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::FrameSnapshots_Set(FrameSnapshots* Snapshots_)
+{
+    Snapshots=Snapshots_;
+}
+
+//---------------------------------------------------------------------------
+FrameSnapshots* FileInformation::FrameSnapshots_Get()
+{
+    return Snapshots;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::FrameFeed_Set(FrameFeed* Feed_)
+{
+    Feed=Feed_;
+}
+
+//---------------------------------------------------------------------------
+FrameFeed* FileInformation::FrameFeed_Get()
+{
+    return Feed;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ThumbnailSprites_Set(ThumbnailSprites* Sprites_)
+{
+    Sprites=Sprites_;
+}
+
+//---------------------------------------------------------------------------
+ThumbnailSprites* FileInformation::ThumbnailSprites_Get()
+{
+    return Sprites;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::DecoderThreads_Set(int Count)
+{
+    DecoderThreads=Count;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::DecoderThreads_Get()
+{
+    return DecoderThreads;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::FilterThreads_Set(int Count)
+{
+    FilterThreads=Count;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::FilterThreads_Get()
+{
+    return FilterThreads;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::DecodeAhead_Set(int Count)
+{
+    DecodeAhead=Count;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::DecodeAhead_Get()
+{
+    return DecodeAhead;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::DecoderThreadType_Set(const QString& Type)
+{
+    if (Type=="frame")
+        DecoderThreadType=1;
+    else if (Type=="slice")
+        DecoderThreadType=2;
+    else
+        DecoderThreadType=0;
+}
+
+//---------------------------------------------------------------------------
+QString FileInformation::DecoderThreadType_Get()
+{
+    switch (DecoderThreadType)
+    {
+        case 1: return "frame";
+        case 2: return "slice";
+        default: return QString();
+    }
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::DecoderPool_Set(int Count)
+{
+    DecoderPool=Count;
+    QAVPlayer::setDecoderPoolSize(Count);
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::DecoderPool_Get()
+{
+    return DecoderPool;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::FilterGraphsCombined_Set(bool Combined)
+{
+    FilterGraphsCombined=Combined;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::FilterGraphsCombined_Get()
+{
+    return FilterGraphsCombined;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::StatsBranches_Set(int Count)
+{
+    StatsBranches=Count;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::StatsBranches_Get()
+{
+    return StatsBranches;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::StatsKernel_Set(int Mode)
+{
+    StatsKernel=Mode;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::StatsKernel_Get()
+{
+    return StatsKernel;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::FieldKernel_Set(int Mode)
+{
+    FieldKernel=Mode;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::FieldKernel_Get()
+{
+    return FieldKernel;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::AudioKernel_Set(bool Enabled)
+{
+    AudioKernel=Enabled;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::AudioKernel_Get()
+{
+    return AudioKernel;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::AudioKernelWindow_Set(double Window)
+{
+    AudioKernelWindow=Window>0?Window:0.4;
+}
+
+//---------------------------------------------------------------------------
+double FileInformation::AudioKernelWindow_Get()
+{
+    return AudioKernelWindow;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::AudioRowsWindow_Set(double Window)
+{
+    AudioRowsWindow=Window<0?-1:Window;
+}
+
+//---------------------------------------------------------------------------
+double FileInformation::AudioRowsWindow_Get()
+{
+    return AudioRowsWindow;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::AnalysisProfile_Set(int Profile)
+{
+    AnalysisProfile=Profile>=0 && Profile<AnalysisProfiles::Profile_Max?Profile:AnalysisProfiles::Profile_Full;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::AnalysisProfile_Get()
+{
+    return AnalysisProfile;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::Sampling_Set(int Every)
+{
+    Sampling=Every;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::Sampling_Get()
+{
+    return Sampling;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::SamplingRate_Set(double Rate)
+{
+    SamplingRate=Rate;
+}
+
+//---------------------------------------------------------------------------
+double FileInformation::SamplingRate_Get()
+{
+    return SamplingRate;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::Live_Set(bool Value)
+{
+    Live=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::Live_Get()
+{
+    return Live;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::KeyFramePreview_Set(bool Value)
+{
+    KeyFramePreview=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::KeyFramePreview_Get()
+{
+    return KeyFramePreview;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::LazyItems_Set(bool Value)
+{
+    LazyItems=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::LazyItems_Get()
+{
+    return LazyItems;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ProgressiveReports_Set(bool Value)
+{
+    ProgressiveReports=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::ProgressiveReports_Get()
+{
+    return ProgressiveReports;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::FastProbe_Set(bool Value)
+{
+    FastProbe=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::FastProbe_Get()
+{
+    return FastProbe;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::NumaNode_Set(int Node)
+{
+    NumaNode=Node;
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::NumaNode_Get()
+{
+    return NumaNode;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::HardwareDevice_Set(const QString& Device)
+{
+    QMutexLocker Locker(&HardwareDevice_Mutex);
+    HardwareDevice=Device;
+}
+
+//---------------------------------------------------------------------------
+QString FileInformation::HardwareDevice_Get()
+{
+    QMutexLocker Locker(&HardwareDevice_Mutex);
+    return HardwareDevice;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::PacketStats_Set(bool Value)
+{
+    PacketStats=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::PacketStats_Get()
+{
+    return PacketStats;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::AnalysisProcess_Set(bool Value)
+{
+    AnalysisProcess=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::AnalysisProcess_Get()
+{
+    return AnalysisProcess;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::Lowres_Set(int Value)
+{
+    Lowres=std::max(0, std::min(Value, 3));
+}
+
+//---------------------------------------------------------------------------
+int FileInformation::Lowres_Get()
+{
+    return Lowres;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::SkipNonRef_Set(bool Value)
+{
+    SkipNonRef=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::SkipNonRef_Get()
+{
+    return SkipNonRef;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::GpuFilters_Set(bool Value)
+{
+    GpuFilters=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::GpuFilters_Get()
+{
+    return GpuFilters;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::Compare_Set(const QString& Reference, const QString& VmafLog)
+{
+    QMutexLocker Locker(&Compare_Mutex);
+    CompareReference=Reference;
+    CompareVmafLog=VmafLog;
+}
+
+//---------------------------------------------------------------------------
+QString FileInformation::Compare_Get()
+{
+    QMutexLocker Locker(&Compare_Mutex);
+    return CompareReference;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::RegionOfInterest_Set(const QRect& Rect)
+{
+    QMutexLocker Locker(&RegionOfInterest_Mutex);
+    RegionOfInterest=Rect;
+}
+
+//---------------------------------------------------------------------------
+QRect FileInformation::RegionOfInterest_Get()
+{
+    QMutexLocker Locker(&RegionOfInterest_Mutex);
+    return RegionOfInterest;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::FrameMemoization_Set(bool Value)
+{
+    FrameMemoization=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::FrameMemoization_Get()
+{
+    return FrameMemoization;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::FrameHash_Set(const QString& Algorithm)
+{
+    AVHashContext* Context=nullptr;
+    if (!Algorithm.isEmpty() && av_hash_alloc(&Context, Algorithm.toUtf8().constData())<0)
+        return false;
+    av_hash_freep(&Context);
+
+    QMutexLocker Locker(&FrameHash_Mutex);
+    FrameHash=Algorithm;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+QString FileInformation::FrameHash_Get()
+{
+    QMutexLocker Locker(&FrameHash_Mutex);
+    return FrameHash;
+}
+
+//---------------------------------------------------------------------------
+// A string, the type would be found from the first value else (only digits in a CRC32...)
+void FileInformation::FrameHash_Declare(CommonStats* Stat)
+{
+    auto Algorithm=FrameHash_Get();
+    if (!Algorithm.isEmpty())
+        Stat->AdditionalStats_Declare(QString("framehash.%1").arg(Algorithm.toLower()).toUtf8().constData(), Additional_String);
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::CaptionsTimecode_Set(bool Value)
+{
+    CaptionsTimecode_Enabled=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::CaptionsTimecode_Get()
+{
+    return CaptionsTimecode_Enabled;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::Reanalysis_Set(bool Value)
+{
+    Reanalysis=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::Reanalysis_Get()
+{
+    return Reanalysis;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::statsFromFrame(const QAVVideoFrame& frame, const SignalStatsKernel* kernel, const FieldCompareKernel* fields, const HdrLightKernel* hdr)
+{
+    TraceEvents::Scope Trace("stats", "video stats ingest", frame.stream().index());
+    auto stat = Stats[frame.stream().index()];
+
+    // Pixels used here only, the stats of the frame are written by the thread of the stats
+    if (m_statsIngest)
+    {
+        auto& Item = m_statsIngest->Next(frame.stream().index());
+        if (kernel)
+            VideoStats::KernelValues(*kernel, Item.Values);
+        if (fields)
+            VideoStats::KernelValues(*fields, Item.Values);
+        if (hdr)
+            VideoStats::KernelValues(*hdr, Item.Values);
+        auto analyzers = m_analyzers.find(frame.stream().index());
+        if (analyzers != m_analyzers.end())
+            AnalyzerPlugins::Run(analyzers->second, frame);
+        auto captions = m_captionsTimecodes.find(frame.stream().index());
+        if (captions != m_captionsTimecodes.end())
+            captions->second->FromFrame(frame.frame(), frame.pts());
+        m_statsIngest->Push(frame.stream().index(), frame, frame.size().width(), frame.size().height());
+
+        auto last = m_lastStatsFrames.find(frame.stream().index());
+        if (last != m_lastStatsFrames.end())
+            last->second = frame;
+        return;
+    }
+
+    stat->TimeStampFromFrame(frame, stat->x_Current);
+    if (kernel)
+        static_cast<VideoStats*>(stat)->StatsFromKernel(*kernel);
+    if (fields)
+        static_cast<VideoStats*>(stat)->StatsFromKernel(*fields);
+    if (hdr)
+        static_cast<VideoStats*>(stat)->StatsFromKernel(*hdr);
+    auto analyzers = m_analyzers.find(frame.stream().index());
+    if (analyzers != m_analyzers.end())
+        AnalyzerPlugins::Run(analyzers->second, frame);
+    auto captions = m_captionsTimecodes.find(frame.stream().index());
+    if (captions != m_captionsTimecodes.end())
+        captions->second->FromFrame(frame.frame(), frame.pts());
+    stat->StatsFromFrame(frame, frame.size().width(), frame.size().height());
+    if (m_frameSnapshots)
+        m_frameSnapshots->FromStats(frame, *stat, frame.stream().index());
+    if (m_thumbnailSprites)
+        m_thumbnailSprites->Push(m_thumbnails, *stat);
+
+    // Created for the streams of the stats graphs skipping the duplicated frames only, see FrameMemoization_Set
+    auto last = m_lastStatsFrames.find(frame.stream().index());
+    if (last != m_lastStatsFrames.end())
+        last->second = frame;
+
+    memoryPressure(stat, frame.stream().index());
+}
+
+//---------------------------------------------------------------------------
+// Each branch outputs one frame per decoded frame and in order, the nth frame of every branch is the same source frame
+void FileInformation::statsFromBranch(const QAVVideoFrame& frame, int branch)
+{
+    QMutexLocker Locker(&m_statsBranches->Mutex);
+    if (branch < 0 || branch >= m_statsBranches->Count)
+        return;
+
+    auto& Stream = m_statsBranches->Streams[frame.stream().index()];
+    Stream.Received.resize(m_statsBranches->Count, 0);
+    auto Pos = Stream.Received[branch]++ - Stream.First;
+    while ((int64_t)Stream.Frames.size() <= Pos)
+        Stream.Frames.emplace_back(m_statsBranches->Count);
+    Stream.Frames[Pos][branch] = frame;
+
+    while (!Stream.Frames.empty() && std::all_of(Stream.Frames.front().begin(), Stream.Frames.front().end(), [](const QAVVideoFrame& Frame) { return bool(Frame); }))
+    {
+        statsFromBranches(Stream.Frames.front());
+        Stream.Frames.pop_front();
+        ++Stream.First;
+    }
+}
+
+//---------------------------------------------------------------------------
+// Metadata of all branches in the frame of the first one, as if the detectors were run one after the other
+void FileInformation::statsFromBranches(std::vector<QAVVideoFrame>& frames)
+{
+    const int Kernel = m_statsBranches->Kernel;
+    QAVVideoFrame* KernelFrame = Kernel >= 0 && Kernel < (int)frames.size() && frames[Kernel] ? &frames[Kernel] : nullptr;
+    const int Fields = m_statsBranches->Fields;
+    QAVVideoFrame* FieldsFrame = Fields >= 0 && Fields < (int)frames.size() && frames[Fields] ? &frames[Fields] : nullptr;
+    const int Hdr = m_statsBranches->Hdr;
+    QAVVideoFrame* HdrFrame = Hdr >= 0 && Hdr < (int)frames.size() && frames[Hdr] ? &frames[Hdr] : nullptr;
+
+    QAVVideoFrame* Frame = nullptr;
+    for (int i = 0; i < (int)frames.size() && !Frame; ++i)
+        if (frames[i] && i != Kernel && i != Fields && i != Hdr)
+            Frame = &frames[i];
+    if (!Frame)
+        Frame = KernelFrame ? KernelFrame : FieldsFrame ? FieldsFrame : HdrFrame;
+    if (!Frame)
+        return;
+
+    for (auto& Other : frames)
+        if (&Other != Frame && Other)
+            av_dict_copy(&Frame->frame()->metadata, Other.frame()->metadata, AV_DICT_DONT_OVERWRITE);
+
+    const SignalStatsKernel* Values = nullptr;
+    if (KernelFrame)
+    {
+        auto& Item = m_statsBranches->Kernels[Frame->stream().index()];
+        if (!Item)
+            Item.reset(new SignalStatsKernel(m_statsBranches->LumaOnly));
+        if (Item->Compute(KernelFrame->frame()))
+            Values = Item.get();
+    }
+
+    // Only compared, the values of the filter are kept
+    if (Values && m_statsBranches->Check)
+    {
+        auto Differences = Values->Check(Frame->frame()->metadata);
+        if (!Differences.empty() && m_statsBranches->Mismatches++ < 10)
+            qWarning() << "signalstats kernel: frame" << Stats[Frame->stream().index()]->x_Current_Get() << "differs," << Differences.c_str();
+        Values = nullptr;
+    }
+
+    const FieldCompareKernel* FieldsValues = nullptr;
+    if (FieldsFrame)
+    {
+        auto& Item = m_statsBranches->FieldKernels[Frame->stream().index()];
+        if (!Item)
+            Item.reset(new FieldCompareKernel(m_statsBranches->FieldsPsnr, m_statsBranches->FieldsSsim));
+        if (Item->Compute(FieldsFrame->frame()))
+            FieldsValues = Item.get();
+    }
+    if (FieldsValues && m_statsBranches->FieldsCheck)
+    {
+        auto Differences = FieldsValues->Check(Frame->frame()->metadata);
+        if (!Differences.empty() && m_statsBranches->FieldsMismatches++ < 10)
+            qWarning() << "field kernel: frame" << Stats[Frame->stream().index()]->x_Current_Get() << "differs," << Differences.c_str();
+        FieldsValues = nullptr;
+    }
+
+    const HdrLightKernel* HdrValues = nullptr;
+    if (HdrFrame)
+    {
+        auto& Item = m_statsBranches->HdrKernels[Frame->stream().index()];
+        if (!Item)
+            Item.reset(new HdrLightKernel);
+        if (Item->Compute(HdrFrame->frame()))
+            HdrValues = Item.get();
+    }
+
+    statsFromFrame(*Frame, Values, FieldsValues, HdrValues);
+}
+
+//---------------------------------------------------------------------------
+// Frames some branches did not output (e.g. end of a field comparison), with the detectors which did
+void FileInformation::statsFromBranches_Flush()
+{
+    QMutexLocker Locker(&m_statsBranches->Mutex);
+    for (auto& Stream : m_statsBranches->Streams)
+    {
+        for (auto& Frames : Stream.second.Frames)
+            statsFromBranches(Frames);
+        Stream.second.Frames.clear();
+    }
+    m_statsBranches->Streams.clear();
+    m_statsBranches->Kernels.clear();
+    m_statsBranches->FieldKernels.clear();
+    m_statsBranches->HdrKernels.clear();
+
+    if (m_statsBranches->Check && m_statsBranches->Kernel >= 0)
+        qWarning() << "signalstats kernel:" << m_statsBranches->Mismatches << "frames different from the filter";
+    if (m_statsBranches->FieldsCheck && m_statsBranches->Fields >= 0)
+        qWarning() << "field kernel:" << m_statsBranches->FieldsMismatches << "frames different from the filters";
+}
+
+//---------------------------------------------------------------------------
+// Decoded frame with the pixels of the previous one, not filtered by the stats graphs: the stats of the previous frame
+// with no differences, the detectors are not temporal (see FrameMemoization_Set) and output it before this one
+void FileInformation::statsFromDuplicate(const QAVVideoFrame& frame)
+{
+    auto last = m_lastStatsFrames.find(frame.stream().index());
+    if (last == m_lastStatsFrames.end() || !last->second)
+        return;
+    const QAVVideoFrame& Last = last->second;
+
+    QAVVideoFrame Frame = frame;
+    av_dict_free(&Frame.frame()->metadata);
+    av_dict_copy(&Frame.frame()->metadata, Last.frame()->metadata, 0);
+    for (auto Key : { "lavfi.signalstats.YDIF", "lavfi.signalstats.UDIF", "lavfi.signalstats.VDIF" })
+        if (av_dict_get(Frame.frame()->metadata, Key, nullptr, 0))
+            av_dict_set(&Frame.frame()->metadata, Key, "0", 0);
+    av_dict_set(&Frame.frame()->metadata, "qctools.duplicate", "1", 0);
+    auto captions = m_captionsTimecodes.find(frame.stream().index());
+    if (captions != m_captionsTimecodes.end())
+        captions->second->FromFrame(Frame.frame(), Frame.pts());
+
+    // The kernel keeps the frame it computed last, it is the same
+    const SignalStatsKernel* Values = nullptr;
+    if (m_statsBranches->Kernel >= 0 && !m_statsBranches->Check)
+    {
+        QMutexLocker Locker(&m_statsBranches->Mutex);
+        auto Item = m_statsBranches->Kernels.find(frame.stream().index());
+        if (Item != m_statsBranches->Kernels.end() && Item->second->Repeat())
+            Values = Item->second.get();
+    }
+    // The fields and the light levels are the ones of the last frame
+    const FieldCompareKernel* FieldsValues = nullptr;
+    if (m_statsBranches->Fields >= 0 && !m_statsBranches->FieldsCheck)
+    {
+        QMutexLocker Locker(&m_statsBranches->Mutex);
+        auto Item = m_statsBranches->FieldKernels.find(frame.stream().index());
+        if (Item != m_statsBranches->FieldKernels.end())
+            FieldsValues = Item->second.get();
+    }
+    const HdrLightKernel* HdrValues = nullptr;
+    if (m_statsBranches->Hdr >= 0)
+    {
+        QMutexLocker Locker(&m_statsBranches->Mutex);
+        auto Item = m_statsBranches->HdrKernels.find(frame.stream().index());
+        if (Item != m_statsBranches->HdrKernels.end())
+            HdrValues = Item->second.get();
+    }
+
+    // Same ring as the frames of the branches, pushed by their threads with the lock
+    if (m_statsIngest)
+    {
+        QMutexLocker Locker(&m_statsBranches->Mutex);
+        auto& Item = m_statsIngest->Next(frame.stream().index());
+        if (Values)
+            VideoStats::KernelValues(*Values, Item.Values);
+        if (FieldsValues)
+            VideoStats::KernelValues(*FieldsValues, Item.Values);
+        if (HdrValues)
+            VideoStats::KernelValues(*HdrValues, Item.Values);
+        m_statsIngest->Push(frame.stream().index(), Frame, Last.size().width(), Last.size().height());
+        return;
+    }
+
+    auto stat = Stats[frame.stream().index()];
+    stat->TimeStampFromFrame(Frame, stat->x_Current);
+    if (Values)
+        static_cast<VideoStats*>(stat)->StatsFromKernel(*Values);
+    if (FieldsValues)
+        static_cast<VideoStats*>(stat)->StatsFromKernel(*FieldsValues);
+    if (HdrValues)
+        static_cast<VideoStats*>(stat)->StatsFromKernel(*HdrValues);
+    stat->StatsFromFrame(Frame, Last.size().width(), Last.size().height());
+    if (m_frameSnapshots)
+        m_frameSnapshots->FromStats(Frame, *stat, frame.stream().index());
+    if (m_thumbnailSprites)
+        m_thumbnailSprites->Push(m_thumbnails, *stat);
+
+    memoryPressure(stat, frame.stream().index());
+}
+
+//---------------------------------------------------------------------------
+// Last panels, not complete, as tile outputs them at the end of the stream
+void FileInformation::panelBuilders_Flush()
+{
+    QMutexLocker locker(&m_panelFramesMutex);
+    if (m_memoryDropped)
+        return;
+    for (auto& Builder : m_panelBuilders)
+    {
+        auto Panel = Builder.second->Flush();
+        if (!Panel)
+            continue;
+        while (m_panelFrames.size() <= (size_t)Builder.first)
+            m_panelFrames.emplace_back(new PanelFrameStore);
+        m_panelFrames[Builder.first]->Push(Panel);
+    }
+}
+
+//---------------------------------------------------------------------------
+// Thread of the stream of the stats, after each frame; the footprint is checked every 256 frames of a stream, the
+// columns are measured and compacted by their writer only (except for live streams, read while parsed)
+void FileInformation::memoryPressure(CommonStats* stat, size_t index)
+{
+    if (!stat->x_Current || stat->x_Current % 256 || !m_memoryStatsBytes || index >= Stats.size())
+        return;
+
+    // Measured for memoryUsage() even without a limit
+    const bool IsEnabled = MemoryPressure::IsEnabled();
+    if (IsEnabled && m_memoryStage >= MemoryPressure::Stage_CompactColumns && !Live)
+    {
+        TraceEvents::Scope Trace("stats", "columns compress", index);
+        stat->Compress();
+    }
+    m_memoryStatsBytes[index] = stat->Bytes();
+
+    if (!IsEnabled || !m_memoryMutex.tryLock())
+        return;
+
+    size_t Bytes = memoryUsage().Total();
+
+    // Stages reached stay, the thumbnails are decimated again while the usage is high
+    auto Stage = MemoryPressure::Stage(Bytes);
+    if (Stage > m_memoryStage)
+    {
+        qWarning() << "memory pressure:" << fileName() << "uses" << Bytes / (1024 * 1024) << "MB," << MemoryPressure::Name(Stage);
+        m_memoryStage = Stage;
+    }
+    if (m_memoryStage >= MemoryPressure::Stage_SpillPanels)
+    {
+        QMutexLocker Locker(&m_panelFramesMutex);
+        for (auto& PanelFrames : m_panelFrames)
+            PanelFrames->Release();
+    }
+    if (Stage >= MemoryPressure::Stage_DecimateThumbnails)
+    {
+        m_thumbnails.Decimate();
+        m_thumbnails.Release();
+    }
+    if (Stage >= MemoryPressure::Stage_DropOutputs && !m_memoryDropped)
+    {
+        {
+            QMutexLocker Locker(&m_panelFramesMutex);
+            m_memoryDropped = true;
+        }
+        while (m_thumbnails.Decimate())
+            ;
+
+        // Kept in the report, on the last frame parsed of this stream
+        static const char Warning[] = "memory pressure: panels dropped and thumbnails decimated from this frame";
+        size_t Pos = stat->x_Current - 1;
+        std::string Comment(stat->comments[Pos] ? stat->comments[Pos] : "");
+        if (!Comment.empty())
+            Comment += "; ";
+        Comment += Warning;
+        stat->Comment_Set(Pos, Comment.c_str());
+        qWarning() << "memory pressure:" << fileName() << Warning << Pos;
+    }
+
+    m_memoryMutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+QMap<QString, qint64> FileInformation::filterTimes() const
+{
+    QMap<QString, qint64> Result;
+    if (!m_mediaParser)
+        return Result;
+
+    auto Times=m_mediaParser->filterTimes();
+    for (auto Time=Times.begin(); Time!=Times.end(); ++Time)
+        Result[FilterGraphPlan::Outputs(Time.key()).join('+')]+=Time.value();
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+FileInformation::MemoryUsage FileInformation::memoryUsage() const
+{
+    MemoryUsage Result;
+    Result.Thumbnails=m_thumbnails.Bytes();
+    for (size_t Pos=0; Pos<Stats.size(); ++Pos)
+    {
+        if (!Stats[Pos])
+            continue;
+        if (parsed())
+            Result.Stats+=Stats[Pos]->Bytes();
+        else if (m_memoryStatsBytes)
+            Result.Stats+=m_memoryStatsBytes[Pos];
+    }
+    {
+        QMutexLocker Locker(&m_panelFramesMutex);
+        for (const auto& PanelFrames : m_panelFrames)
+            Result.Panels+=PanelFrames->Bytes();
+    }
+    if (m_mediaParser)
+    {
+        auto Counters=m_mediaParser->counters();
+        Result.PacketQueues=Counters.videoQueueBytes+Counters.audioQueueBytes;
+        Result.DecodedFrames=Counters.videoFramesBytes+Counters.audioFramesBytes;
+    }
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+QString FileInformation::MemoryUsage::Line() const
+{
+    auto MB=[](size_t Bytes) { return QString::number(Bytes/(1024.0*1024), 'f', 1)+" MB"; };
+    return QString("stats %1, thumbnails %2, panels %3, packet queues %4, decoded frames %5, total %6")
+        .arg(MB(Stats)).arg(MB(Thumbnails)).arg(MB(Panels)).arg(MB(PacketQueues)).arg(MB(DecodedFrames)).arg(MB(Total()));
+}
+
+//---------------------------------------------------------------------------
+FileInformation::ParsingCounters FileInformation::parsingCounters() const
+{
+    ParsingCounters Result;
+    Result.Memory=memoryUsage();
+    if (m_parsing)
+        Result.Elapsed=m_parsingTimer.elapsed();
+    else
+        Result.Elapsed=m_parsingTime;
+    for (size_t Pos=0; Pos<Stats.size(); ++Pos)
+        if (Stats[Pos])
+            Result.Streams.push_back({ (int)Pos, Stats[Pos]->Type_Get(), Stats[Pos]->x_Current_Get() });
+    if (!m_mediaParser)
+        return Result;
+
+    auto Player=m_mediaParser->counters();
+    Result.DemuxedBytes=Player.demuxedBytes;
+    Result.DemuxedPackets=Player.demuxedPackets;
+    Result.VideoFrames=Player.videoFrames;
+    Result.VideoDecodeTime=Player.videoDecodeTime;
+    Result.AudioFrames=Player.audioFrames;
+    Result.AudioDecodeTime=Player.audioDecodeTime;
+    Result.VideoQueuePackets=Player.videoQueuePackets;
+    Result.VideoQueueBytes=Player.videoQueueBytes;
+    Result.AudioQueuePackets=Player.audioQueuePackets;
+    Result.AudioQueueBytes=Player.audioQueueBytes;
+    Result.DemuxerStallTime=m_mediaParser->demuxerStallTime();
+    Result.DecoderStallTime=m_mediaParser->decoderStallTime();
+    Result.FilterWaits=Player.filterWaits;
+    Result.ProbeTime=Player.probeTime;
+    Result.FilterTimes=filterTimes();
+    auto Allocations=QAVPlayer::allocations();
+    Result.FrameBuffers=Allocations.frameBuffers;
+    Result.FrameBuffersReused=Allocations.frameBuffersReused;
+    Result.FrameBuffersBytes=Allocations.frameBuffersBytes;
+    Result.FrameBuffersHugePagesBytes=Allocations.frameBuffersHugePagesBytes;
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+QStringList FileInformation::ParsingCounters::Lines(const ParsingCounters* Previous) const
+{
+    static const ParsingCounters Start;
+    const ParsingCounters& From=Previous?*Previous:Start;
+    double Seconds=(Elapsed-From.Elapsed)/1000.0;
+    auto PerSecond=[&](double Value) { return QString::number(Seconds>0?Value/Seconds:0, 'f', 1); };
+    auto Share=[&](qint64 Time) { return QString::number(Seconds>0?100*Time/1000.0/Seconds:0, 'f', 0)+'%'; };
+    auto MB=[](double Bytes) { return QString::number(Bytes/(1024*1024), 'f', 1)+" MB"; };
+
+    QStringList Result;
+    Result.append(QString("elapsed: %1 s").arg(Elapsed/1000.0, 0, 'f', 1));
+    Result.append(QString("probing: %1 ms").arg(ProbeTime));
+    Result.append(QString("reading: %1 MB/s, %2 packets/s").arg(PerSecond((DemuxedBytes-From.DemuxedBytes)/(1024.0*1024))).arg(PerSecond(DemuxedPackets-From.DemuxedPackets)));
+    Result.append(QString("decoding: video %1 frames/s (%2 busy), audio %3 frames/s (%4 busy)")
+                  .arg(PerSecond(VideoFrames-From.VideoFrames)).arg(Share(VideoDecodeTime-From.VideoDecodeTime))
+                  .arg(PerSecond(AudioFrames-From.AudioFrames)).arg(Share(AudioDecodeTime-From.AudioDecodeTime)));
+
+    QStringList StreamRates;
+    for (const auto& Stream : Streams)
+    {
+        size_t Frames=Stream.Frames;
+        for (const auto& Item : From.Streams)
+            if (Item.Index==Stream.Index)
+                Frames-=Item.Frames;
+        StreamRates.append(QString("stream %1 (%2) %3 frames/s").arg(Stream.Index).arg(Stream.Type==0?"video":"audio").arg(PerSecond(Frames)));
+    }
+    if (!StreamRates.isEmpty())
+        Result.append("stats: "+StreamRates.join(", "));
+
+    Result.append(QString("queues: video %1 packets (%2), audio %3 packets (%4)")
+                  .arg(VideoQueuePackets).arg(MB(VideoQueueBytes)).arg(AudioQueuePackets).arg(MB(AudioQueueBytes)));
+    qint64 DemuxerStall=DemuxerStallTime-From.DemuxerStallTime;
+    qint64 DecoderStall=DecoderStallTime-From.DecoderStallTime;
+    Result.append(QString("waiting: demuxer on full queues %1, decoders on packets %2, filters on another thread %3 times")
+                  .arg(Share(DemuxerStall)).arg(Share(DecoderStall)).arg(FilterWaits-From.FilterWaits));
+    Result.append("memory: "+Memory.Line());
+    quint64 Buffers=FrameBuffers-std::min(FrameBuffers, From.FrameBuffers);
+    quint64 BuffersReused=FrameBuffersReused-std::min(FrameBuffersReused, From.FrameBuffersReused);
+    Result.append(QString("frame buffers: %1 reused, %2 allocated, %3 (%4 on huge pages)")
+                  .arg(Buffers+BuffersReused?QString::number(100.0*BuffersReused/(Buffers+BuffersReused), 'f', 1)+'%':QString("-"))
+                  .arg(Buffers).arg(MB(FrameBuffersBytes)).arg(MB(FrameBuffersHugePagesBytes)));
+
+    qint64 FilterTime=0;
+    for (auto Time=FilterTimes.begin(); Time!=FilterTimes.end(); ++Time)
+    {
+        qint64 Value=Time.value()-From.FilterTimes.value(Time.key());
+        FilterTime+=Value;
+        Result.append(QString("filter graph %1: %2 busy").arg(Time.key()).arg(Share(Value)));
+    }
+
+    // Decoders waiting more than the demuxer means reading is slower than the consumers
+    const char* Bound;
+    if (DecoderStall>DemuxerStall)
+        Bound="reading";
+    else if (VideoDecodeTime-From.VideoDecodeTime+AudioDecodeTime-From.AudioDecodeTime>FilterTime)
+        Bound="decoding";
+    else
+        Bound="filtering";
+    Result.append(QString("likely bound by: %1").arg(Bound));
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ThumbnailsCodec_Set(const QString& Codec)
+{
+    QMutexLocker Locker(&ReportCodecs_Mutex);
+    ThumbnailsCodec=Codec;
+}
+
+//---------------------------------------------------------------------------
+QString FileInformation::ThumbnailsCodec_Get()
+{
+    QMutexLocker Locker(&ReportCodecs_Mutex);
+    return ThumbnailsCodec;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::PanelsCodec_Set(const QString& Codec)
+{
+    QMutexLocker Locker(&ReportCodecs_Mutex);
+    PanelsCodec=Codec;
+}
+
+//---------------------------------------------------------------------------
+QString FileInformation::PanelsCodec_Get()
+{
+    QMutexLocker Locker(&ReportCodecs_Mutex);
+    return PanelsCodec;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::MkvColumns_Set(bool Value)
+{
+    MkvColumns=Value;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::MkvColumns_Get()
+{
+    return MkvColumns;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::ParsingThreads_Apply(QAVPlayer* Player, int Pipelines)
+{
+    // The pool of a batch is shared by all files, else only the pipelines of this file run at the same time
+    int Shared=ActiveParsing_Max;
+    int Cores=QThread::idealThreadCount();
+    auto Cpus=NumaNodes::Cpus(NumaNode);
+    if (!Cpus.empty())
+    {
+        // The pool is split between the nodes
+        int Nodes=(int)NumaNodes::Get().size();
+        Cores=(int)Cpus.size();
+        Shared=(Shared+Nodes-1)/Nodes;
+    }
+
+    // Threads bound and lowered before the decoders and the filter graphs create theirs
+    bool Background=BackgroundParsing;
+    if (!Cpus.empty() || Background)
+        Player->setThreadInit([Cpus, Background]() {
+            if (!Cpus.empty())
+                NumaNodes::Bind(Cpus);
+            if (Background)
+                ParsingScheduler::Background_Apply();
+        });
+    if (Shared>Pipelines)
+        Pipelines=Shared;
+    int Auto=std::max(1, Cores/std::max(1, Pipelines));
+
+    int Decoder=DecoderThreads>0?DecoderThreads.load():Auto;
+    QString Type=DecoderThreadType_Get();
+    QMap<QString, QString> Options { {"threads", QString::number(Decoder)}, {"thread_type", Type.isEmpty()?QString("frame+slice"):Type} };
+    // Generic options of the decoders, limited by each decoder (see decodedVideoSize)
+    if (Lowres)
+        Options["lowres"]=QString::number(Lowres);
+    if (SkipNonRef)
+        Options["skip_frame"]="nonref";
+    Player->setDecoderOptions(Options);
+    Player->setFilterThreads(FilterThreads>0?FilterThreads.load():Auto);
+    Player->setDecodeAhead(std::max(0, DecodeAhead.load()));
+    Player->setFastProbe(FastProbe);
+    Player->setFrameHash(FrameHash_Get());
+    Player->setHardwareDevice(HardwareDevice_Get());
+}
+
+void FileInformation::startExport(const QString &exportFileName)
+{
+    m_jobType = Exporting;
+    m_exportFileName = exportFileName;
+    m_exportMkv = false;
+
+    if (!isRunning())
+    {
+        start();
+    }
+}
+
+void FileInformation::startMkvExport(const QString &exportFileName)
+{
+    m_jobType = Exporting;
+    m_exportFileName = exportFileName;
+    m_exportMkv = true;
+
+    if (!isRunning())
+    {
+        start();
+    }
+}
+
+//***************************************************************************
+// Actions
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Frames of the XML of one stream serialized by one task of the export, a multiple of the chunks of the columns
+static const size_t Export_ChunkFrames = StatsColumn<double>::Chunk_Size * 4;
+
+static QThreadPool& ExportPool()
+{
+    static QThreadPool Pool;
+    return Pool;
+}
+
+// XML of the frames from Begin to End (excluded) of a stream
+static std::string Export_XmlChunk(CommonStats* Stat, const activefilters& filters, size_t Begin, size_t End)
+{
+    std::string Xml;
+    StatsXmlWriter Writer([&Xml](const char* Data, size_t Size) {
+        Xml.append(Data, Size);
+        return true;
+    });
+    Stat->StatsToXML(Writer, filters, Begin, End);
+    Writer.Finish();
+    return Xml;
+}
+
+//---------------------------------------------------------------------------
+// First of the Count frames of the stream with a time stamp at or after Time (a millisecond before, for the rounding)
+static size_t Export_FirstFrame(CommonStats* Stat, size_t Count, double Time)
+{
+    size_t Begin=0;
+    while (Count)
+    {
+        size_t Half=Count/2;
+        if (Stat->x[1][Begin+Half]+Stat->FirstTimeStamp<Time-0.001)
+        {
+            Begin+=Half+1;
+            Count-=Half+1;
+        }
+        else
+            Count=Half;
+    }
+    return Begin;
+}
+
+//---------------------------------------------------------------------------
+bool FileInformation::setExportRange(double Start, double End, bool InFrames)
+{
+    m_hasExportRange=false;
+    if (!std::isfinite(Start) && !std::isfinite(End))
+        return true;
+
+    CommonStats* Stat=ReferenceStat();
+    size_t Count=Stat && Stat->FirstTimeStamp!=DBL_MAX?Stat->x_Current:0;
+    auto Frame=[&](double Value) -> size_t {
+        if (Value==-std::numeric_limits<double>::infinity())
+            return 0;
+        if (Value==std::numeric_limits<double>::infinity())
+            return Count;
+        if (InFrames)
+            return (size_t)std::min((double)Count, std::ceil(std::max(Value, 0.0)));
+        return Export_FirstFrame(Stat, Count, Value);
+    };
+    size_t Begin=Frame(Start);
+    size_t End_=Frame(End);
+
+    // Panels of the video are by PANEL_WIDTH frames, the report starts with a whole one
+    bool VideoPanels=false;
+    for (const auto& Metadata : m_panelMetadata)
+    {
+        auto Type=Metadata.find("panel_type");
+        VideoPanels=VideoPanels || Type==Metadata.end() || Type->second=="video";
+    }
+    if (VideoPanels && (!m_panelFrames.empty() || (m_reportFrames && !m_panelMetadata.empty())) && m_panelSize.width()>0)
+        Begin-=Begin%m_panelSize.width();
+
+    if (Begin>=End_)
+        return false;
+    m_hasExportRange=true;
+    m_exportRangeBegin=Begin;
+    m_exportRangeEnd=End_;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::exportFrames(size_t Pos, size_t& Begin, size_t& End) const
+{
+    CommonStats* Stat=Pos<Stats.size()?Stats[Pos]:nullptr;
+    Begin=0;
+    End=Stat?Stat->x_Current:0;
+    CommonStats* Reference=ReferenceStat();
+    if (!m_hasExportRange || !Stat || !Reference)
+        return;
+    if (Stat==Reference)
+    {
+        Begin=std::min(m_exportRangeBegin, End);
+        End=std::min(m_exportRangeEnd, End);
+        return;
+    }
+
+    // Same time range as the frames of the reference stream
+    if (Stat->FirstTimeStamp==DBL_MAX || m_exportRangeBegin>=Reference->x_Current)
+    {
+        End=0;
+        return;
+    }
+    size_t Count=End;
+    Begin=Export_FirstFrame(Stat, Count, Reference->x[1][m_exportRangeBegin]+Reference->FirstTimeStamp);
+    if (m_exportRangeEnd<Reference->x_Current)
+        End=Export_FirstFrame(Stat, Count, Reference->x[1][m_exportRangeEnd]+Reference->FirstTimeStamp);
+}
+
+//---------------------------------------------------------------------------
+std::vector<std::pair<int64_t, int64_t>> FileInformation::exportPanelFrames() const
+{
+    std::vector<std::pair<int64_t, int64_t>> Ranges;
+    size_t Begin, End;
+    exportFrames(ReferenceStream_Pos, Begin, End);
+    int64_t Thumbnails=(int64_t)(m_reportFrames?m_reportFrames->Count(0):m_thumbnails.Count());
+    Ranges.emplace_back(m_hasExportRange?std::min((int64_t)Begin, Thumbnails):0, m_hasExportRange?std::min((int64_t)End, Thumbnails):Thumbnails);
+
+    // A panel of the video has PANEL_WIDTH frames, the panels of the audio are spread over the frames of the video
+    CommonStats* Reference=ReferenceStat();
+    int64_t Frames=Reference?(int64_t)Reference->x_Current:0;
+    int64_t Width=std::max(1, m_panelSize.width());
+    size_t Outputs=m_reportFrames?(size_t)m_panelMetadata.size():m_panelFrames.size();
+    for (size_t Pos=0; Pos<Outputs; Pos++)
+    {
+        int64_t Count=(int64_t)getPanelFramesCount(Pos);
+        if (!m_hasExportRange || !Frames)
+        {
+            Ranges.emplace_back(0, Count);
+            continue;
+        }
+        bool IsAudio=false;
+        if (Pos<(size_t)m_panelMetadata.size())
+        {
+            auto Type=m_panelMetadata[(int)Pos].find("panel_type");
+            IsAudio=Type!=m_panelMetadata[(int)Pos].end() && Type->second!="video";
+        }
+        int64_t First=IsAudio?(int64_t)Begin*Count/Frames:(int64_t)Begin/Width;
+        int64_t Last=IsAudio?((int64_t)End*Count+Frames-1)/Frames:((int64_t)End+Width-1)/Width;
+        Ranges.emplace_back(std::min(First, Count), std::min(Last, Count));
+    }
+    return Ranges;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::Export_XmlGz (const QString &ExportFileName, const activefilters& filters)
+{
+    SharedFile file;
+    QString name;
+    createExportFile(ExportFileName, file, name);
+
+    if(StatsColumnsReport::IsColumnsReport(name) || StatsArrowReport::IsArrowReport(name))
+    {
+        if(file->isOpen() || file->open(QIODevice::ReadWrite))
+        {
+            // Same values as the XML report, streams and formats are kept as XML
+            Export_FrameSizes();
+            Q_EMIT statsFileGenerationProgress(0, 1);
+            std::string Trailer = "<ffprobe:ffprobe>" + Export_XmlStreamsAndFormats() + "\n\n</ffprobe:ffprobe>";
+            bool IsOk = StatsArrowReport::IsArrowReport(name) ? StatsArrowReport::Save(*file, Stats, filters, Trailer) : StatsColumnsReport::Save(*file, Stats, filters, Trailer);
+            if (!IsOk)
+                qDebug() << "stats file" << name << "can not be written";
+            Q_EMIT statsFileGenerationProgress(1, 1);
+
+            file->flush();
+            file->seek(0);
+        }
+    }
+    else if(file->isOpen() || file->open(QIODevice::ReadWrite))
+    {
+        // Progress is in frames, the count of bytes is not known before the end
+        quint64 framesTotal = 0;
+        for (size_t Pos=0; Pos<Stats.size(); Pos++)
+        {
+            size_t Begin, End;
+            exportFrames(Pos, Begin, End);
+            framesTotal += End>Begin?End-Begin:0;
+        }
+
+        // The XML is generated block by block, sent to the file compressed as its name tells (see StatsCompression), never fully in memory
+        quint64 framesDone = 0;
+        StatsCompressionWriter Compression(*file, StatsCompression::Format_FromFileName(name));
+        StatsXmlWriter Writer([&](const char* Data, size_t Size) {
+            bool IsOk = Compression.Append(Data, Size);
+            Q_EMIT statsFileGenerationProgress(framesDone, framesTotal);
+            return IsOk;
+        });
+
+        // Summaries are the ones of the whole file, not of a range
+        Writer.Text(Export_XmlHeader(m_hasExportRange ? nullptr : &filters));
+
+        // From stats: chunks of frames of each stream serialized by the threads of the pool into buffers of their own,
+        // appended in the order of the streams and of the frames by this thread, which compresses them meanwhile
+        // Chunks in flight are limited, so the XML is still not fully in memory
+        struct chunk
+        {
+            CommonStats* Stat;
+            size_t Begin;
+            size_t End;
+        };
+        std::vector<chunk> Chunks;
+        for (size_t Pos=0; Pos<Stats.size(); Pos++)
+        {
+            CommonStats* Stat=Stats[Pos];
+            if (!Stat)
+                continue;
+            Stat->Items_Load(); // Once, before the threads
+            size_t First, Last;
+            exportFrames(Pos, First, Last);
+            for (size_t Begin=First; Begin<Last; Begin+=Export_ChunkFrames)
+                Chunks.push_back({Stat, Begin, std::min(Begin+Export_ChunkFrames, Last)});
+        }
 
-                if(frame.stream().index() == 0) {
-                    m_thumbnails_frames.push_back(frame);
+        size_t InFlight_Max=std::max(2, ExportPool().maxThreadCount()*2);
+        std::deque<QFuture<std::string>> InFlight;
+        size_t Next=0;
+        for (size_t Pos=0; Pos<Chunks.size(); Pos++)
+        {
+            while (Next<Chunks.size() && InFlight.size()<InFlight_Max)
+            {
+                chunk Chunk=Chunks[Next++];
+                InFlight.push_back(QtConcurrent::run(&ExportPool(), [Chunk, &filters]() {
+                    return Export_XmlChunk(Chunk.Stat, filters, Chunk.Begin, Chunk.End);
+                }));
+            }
 
-                } else {
-                    int index = frame.stream().index();
+            std::string Xml=InFlight.front().result();
+            InFlight.pop_front();
+            Writer.Text(Xml);
+            framesDone+=Chunks[Pos].End-Chunks[Pos].Begin;
+        }
 
-                    while(m_panelFrames.size() < index)
-                        m_panelFrames.append(QVector<QAVVideoFrame>());
+        Writer.Text(Export_XmlFooter());
 
-                    auto panelStreamIndex = index - 1;
-                    m_panelFrames[panelStreamIndex].push_back(frame);
+        if (!Writer.Finish() || !Compression.Finish())
+            qDebug() << "stats file" << name << "can not be written";
+        Q_EMIT statsFileGenerationProgress(framesTotal, framesTotal);
 
-                    qDebug() << "m_panelFrames[panelStreamIndex]: " << panelStreamIndex << m_panelFrames[panelStreamIndex].size();
-                }
-            },
-            //Qt::QueuedConnection
-            Qt::DirectConnection
-            );
+        file->flush();
+        file->seek(0);
+    }
 
-        QObject::connect(m_mediaParser, &QAVPlayer::mediaStatusChanged, [this](QAVPlayer::MediaStatus status) {
-            qDebug() << "m_mediaParser => mediaStatusChanged: " << status;
+    Q_EMIT statsFileGenerated(file, name);
+    if (!m_hasExportRange)
+        m_commentsUpdated = false; // Else the comments out of the range are not saved
+}
 
-            if(status == QAVPlayer::EndOfMedia) {
+//---------------------------------------------------------------------------
+bool FileInformation::IsStdoutExport(const QString &ExportFileName)
+{
+    return ExportFileName == "-" || ExportFileName == "-.xml";
+}
 
-                for (size_t Pos=0; Pos<Stats.size(); Pos++)
-                    if (Stats[Pos])
-                        Stats[Pos]->StatsFinish();
+//---------------------------------------------------------------------------
+// Same streams, by stream index
+static bool SameStreams(const std::vector<CommonStats*>& Stats, const std::vector<CommonStats*>& PartStats, QString* Error)
+{
+    bool IsSame = PartStats.size() == Stats.size();
+    for (size_t Pos = 0; IsSame && Pos < Stats.size(); Pos++)
+        if ((Stats[Pos] == nullptr) != (PartStats[Pos] == nullptr) || (Stats[Pos] && Stats[Pos]->Type_Get() != PartStats[Pos]->Type_Get()))
+            IsSame = false;
+    if (!IsSame && Error)
+        *Error = "streams are not the same";
+    return IsSame;
+}
 
-                m_parsed = true;
-                Q_EMIT parsingCompleted(true);
-            }
-            else if(status == QAVPlayer::InvalidMedia)
-            {
-                m_parsed = true;
-                Q_EMIT parsingCompleted(false);
-            }
-        });
-    }
+//---------------------------------------------------------------------------
+bool FileInformation::appendStats(FileInformation& Part, QString* Error)
+{
+    if (!SameStreams(Stats, Part.Stats, Error))
+        return false;
 
-    // Looking for the reference stream (video or audio)
-    ReferenceStream_Pos=0;
-    for (; ReferenceStream_Pos<Stats.size(); ReferenceStream_Pos++)
-        if (Stats[ReferenceStream_Pos] && Stats[ReferenceStream_Pos]->Type_Get()==0)
-            break;
-    if (ReferenceStream_Pos>=Stats.size())
+    for (size_t Pos = 0; Pos < Stats.size(); Pos++)
     {
-        ReferenceStream_Pos = 0;
-        for (; ReferenceStream_Pos<Stats.size(); ReferenceStream_Pos++)
-            if (Stats[ReferenceStream_Pos] && Stats[ReferenceStream_Pos]->Type_Get()==1) //Audio
-                break;
-        if (ReferenceStream_Pos>=Stats.size())
-            Stats.clear(); //Removing all, as we can not sync with video or audio
+        CommonStats* Stat = Stats[Pos];
+        CommonStats* PartStat = Part.Stats[Pos];
+        if (!Stat)
+            continue;
+
+        // Overlapping frames, e.g. ranges cut at a time stamp between two frames of another stream
+        size_t First = 0;
+        if (Stat->x_Current && Stat->FirstTimeStamp != DBL_MAX && PartStat->FirstTimeStamp != DBL_MAX)
+        {
+            double Last = Stat->x[1][Stat->x_Current - 1] + Stat->FirstTimeStamp;
+            while (First < PartStat->x_Current && PartStat->x[1][First] + PartStat->FirstTimeStamp <= Last)
+                First++;
+        }
+
+        Stat->Append(*PartStat, First);
+        Stat->StatsFinish();
     }
 
-    startParse();
+    return true;
 }
 
 //---------------------------------------------------------------------------
-FileInformation::~FileInformation ()
+bool FileInformation::spliceStats(FileInformation& Part, QString* Error)
 {
-    if(m_mediaParser->state() == QAVPlayer::PlayingState) {
-        m_mediaParser->stop();
-        delete m_mediaParser;
-    }
+    if (!SameStreams(Stats, Part.Stats, Error))
+        return false;
 
-    if(m_mediaPlayer) {
-        m_mediaPlayer->stop();
-        delete m_mediaPlayer;
+    for (size_t Pos = 0; Pos < Stats.size(); Pos++)
+    {
+        CommonStats* Stat = Stats[Pos];
+        CommonStats* PartStat = Part.Stats[Pos];
+        if (!Stat || !Stat->Sampling_Get() || !PartStat->x_Current || PartStat->FirstTimeStamp == DBL_MAX || Stat->FirstTimeStamp == DBL_MAX)
+            continue;
+
+        // Sampled frames in the range of the part are replaced by all the frames of the part
+        double Begin = PartStat->x[1][0] + PartStat->FirstTimeStamp;
+        double End = PartStat->x[1][PartStat->x_Current - 1] + PartStat->FirstTimeStamp;
+        size_t First = 0;
+        while (First < Stat->x_Current && Stat->x[1][First] + Stat->FirstTimeStamp < Begin)
+            First++;
+        size_t Last = First;
+        while (Last < Stat->x_Current && Stat->x[1][Last] + Stat->FirstTimeStamp <= End)
+            Last++;
+
+        CommonStats* Result;
+        if (Stat->Type_Get() == Type_Video)
+        {
+            auto videoStats = new VideoStats();
+            videoStats->setWidth(static_cast<VideoStats*>(Stat)->getWidth());
+            videoStats->setHeight(static_cast<VideoStats*>(Stat)->getHeight());
+            Result = videoStats;
+        }
+        else
+            Result = new AudioStats();
+        Result->Sampling_Set(Stat->Sampling_Get());
+        Result->Append(*Stat, 0, First);
+        Result->Append(*PartStat);
+        Result->Append(*Stat, Last);
+        Result->StatsFinish();
+
+        delete Stat;
+        Stats[Pos] = Result;
     }
 
-    bool result = wait();
-    assert(result);
-
-	delete streamsStats;
-    delete formatStats;
-
-    for (size_t Pos=0; Pos<Stats.size(); Pos++)
-        delete Stats[Pos];
+    return true;
 }
 
-//***************************************************************************
-// Parsing
-//***************************************************************************
-
 //---------------------------------------------------------------------------
-void FileInformation::startParse ()
+void FileInformation::createExportFile(const QString &ExportFileName, SharedFile& file, QString& name)
 {
-    m_jobType = Parsing;
-
-    int Max=QThread::idealThreadCount();
-    if (Max>2)
-        Max-=2;
-    else
-        Max=1;
-    if (ActiveParsing_Count<Max)
+    if(ExportFileName.isEmpty())
     {
-        m_mediaParser->play();
+        // Attached to a .qctools.mkv report, see MkvColumns_Set
+        file = SharedFile(new QTemporaryFile());
+        QFileInfo info(fileName() + (MkvColumns ? ".qctools.columns" : ".qctools.xml.gz"));
+        name = info.fileName();
+    } else if(IsStdoutExport(ExportFileName)) {
+        // Already open, write only: the report is sent as it is generated and can not be read back
+        file = SharedFile(new QFile());
+        file->open(stdout, QIODevice::WriteOnly, QFileDevice::DontCloseHandle);
+        QFileInfo info(fileName() + (ExportFileName.endsWith(".xml") ? ".qctools.xml" : ".qctools.xml.gz"));
+        name = info.fileName();
+    } else {
+        file = SharedFile(new QFile(ExportFileName));
+        QFileInfo info(ExportFileName);
+        name = info.fileName();
     }
 }
 
-void FileInformation::startExport(const QString &exportFileName)
+//---------------------------------------------------------------------------
+// The decoder applies its own maximum of lowres when it is opened, as the width and the height of the frames
+QSize FileInformation::decodedVideoSize() const
 {
-    m_jobType = Exporting;
-    m_exportFileName = exportFileName;
+    auto Streams=m_mediaParser->availableVideoStreams();
+    if (Streams.empty())
+        return QSize();
+    const AVCodecParameters* Parameters=Streams[0].stream()->codecpar;
+    int Shift=Streams[0].codec() && Streams[0].codec()->avctx()?Streams[0].codec()->avctx()->lowres:0;
+    return QSize(AV_CEIL_RSHIFT(Parameters->width, Shift), AV_CEIL_RSHIFT(Parameters->height, Shift));
+}
 
-    if (!isRunning())
+//---------------------------------------------------------------------------
+void FileInformation::Export_FrameSizes()
+{
+    // Frame sizes are from the container, divided as the decoded ones with Lowres_Set
+    QSize Size=decodedVideoSize();
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
     {
-        start();
+        if(Stats[Pos] && Stats[Pos]->Type_Get() == Type_Video && !Size.isEmpty())
+        {
+            auto videoStats = static_cast<VideoStats*>(Stats[Pos]);
+            videoStats->setWidth(Size.width());
+            videoStats->setHeight(Size.height());
+        }
     }
 }
 
-//***************************************************************************
-// Actions
-//***************************************************************************
-
 //---------------------------------------------------------------------------
-void FileInformation::Export_XmlGz (const QString &ExportFileName, const activefilters& filters)
+std::string FileInformation::Export_XmlHeader(const activefilters* Filters)
 {
-    std::stringstream Data;
+    Export_FrameSizes();
 
-    // Header
+    std::stringstream Data;
     Data<<"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
     Data<<"<!-- Created by QCTools " << Version << " -->\n";
+    if (m_sampling<0)
+        Data<<"<!-- Sampled: video key frames only -->\n";
+    else if (m_sampling>1)
+        Data<<"<!-- Sampled: one video frame of " << m_sampling << " -->\n";
+    if (!m_mediaParser->availableVideoStreams().empty())
+    {
+        // Reduced decoding, the values of the filters depending on the size are not the ones of the full size
+        const AVStream* Stream=m_mediaParser->availableVideoStreams()[0].stream();
+        QSize Size=decodedVideoSize();
+        if (Size.width()!=Stream->codecpar->width || Size.height()!=Stream->codecpar->height)
+            Data<<"<!-- Reduced resolution: video decoded at " << Size.width() << "x" << Size.height() << " instead of " << Stream->codecpar->width << "x" << Stream->codecpar->height << " -->\n";
+        if (SkipNonRef)
+            Data<<"<!-- Sampled: video frames not used as reference skipped by the decoder -->\n";
+    }
+    if (Filters)
+    {
+        // Frozen at the end of the parsing, so the report has the whole stream summaries without a scan of the frames
+        for (auto Stat : Stats)
+            if (Stat)
+                Data<<Stat->SummariesToXML(*Filters);
+    }
     Data<<"<ffprobe:ffprobe xmlns:xsi='http://www.w3.org/2001/XMLSchema-instance' xmlns:ffprobe='http://www.ffmpeg.org/schema/ffprobe' xsi:schemaLocation='http://www.ffmpeg.org/schema/ffprobe ffprobe.xsd'>\n";
     Data<<"    <program_version version=\"" << FFmpeg_Version() << "\" copyright=\"Copyright (c) 2007-" << FFmpeg_Year() << " the FFmpeg developers\" build_date=\"" __DATE__ "\" build_time=\"" __TIME__ "\" compiler_ident=\"" << FFmpeg_Compiler() << "\" configuration=\"" << FFmpeg_Configuration() << "\"/>\n";
     Data<<"\n";
@@ -1283,24 +4336,18 @@ void FileInformation::Export_XmlGz (const QString &ExportFileName, const activef
 
     Data<<"    <frames>\n";
 
-    // From stats
-    for (size_t Pos=0; Pos<Stats.size(); Pos++)
-    {
-        if (Stats[Pos])
-        {
-            if(Stats[Pos]->Type_Get() == Type_Video && !m_mediaParser->availableVideoStreams().empty())
-            {
-                auto videoStats = static_cast<VideoStats*>(Stats[Pos]);
-                videoStats->setWidth(m_mediaParser->availableVideoStreams()[0].stream()->codecpar->width);
-                videoStats->setHeight(m_mediaParser->availableVideoStreams()[0].stream()->codecpar->height);
-            }
-            Data<<Stats[Pos]->StatsToXML(filters);
-        }
-    }
+    return Data.str();
+}
 
-    // Footer
-    Data<<"    </frames>";
+//---------------------------------------------------------------------------
+std::string FileInformation::Export_XmlFooter()
+{
+    return "    </frames>" + Export_XmlStreamsAndFormats() + "\n\n</ffprobe:ffprobe>";
+}
 
+//---------------------------------------------------------------------------
+std::string FileInformation::Export_XmlStreamsAndFormats()
+{
     QString streamsAndFormats;
     QXmlStreamWriter writer(&streamsAndFormats);
     writer.setAutoFormatting(true);
@@ -1318,84 +4365,158 @@ void FileInformation::Export_XmlGz (const QString &ExportFileName, const activef
         splitted[i] = QString(qAbs(writer.autoFormattingIndent()), writer.autoFormattingIndent() > 0 ? ' ' : '\t') + splitted[i];
     streamsAndFormats = splitted.join("\n");
 
-    Data<<streamsAndFormats.toStdString() << "\n\n";
-
-    Data<<"</ffprobe:ffprobe>";
+    return streamsAndFormats.toStdString();
+}
 
-    SharedFile file;
-    QString name;
+//---------------------------------------------------------------------------
+double FileInformation::writeCheckpoint(const QString &ExportFileName, const activefilters& filters)
+{
+    // Time reached by all the streams having frames, the last frame of a stream may be the one not written
+    auto frameTime = [](CommonStats* Stat, size_t Pos) { return Stat->x[1][Pos] + Stat->FirstTimeStamp; };
+    std::vector<size_t> Ends(Stats.size(), 0);
+    m_checkpointDone.resize(Stats.size(), 0);
+    double Time = DBL_MAX;
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
+    {
+        auto Stat = Stats[Pos];
+        size_t End = Stat && Stat->FirstTimeStamp != DBL_MAX ? Stat->x_Current_Get() : 0;
+        Ends[Pos] = End;
+        if (End)
+            Time = std::min(Time, frameTime(Stat, End-1));
+    }
+    if (Time == DBL_MAX)
+        return std::numeric_limits<double>::quiet_NaN();
 
-    if(ExportFileName.isEmpty())
+    // Up to the last shot of the video since the previous checkpoint, so the parsing is resumed at a cut
+    double Shot = -DBL_MAX;
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
     {
-        file = SharedFile(new QTemporaryFile());
-        QFileInfo info(fileName() + ".qctools.xml.gz");
-        name = info.fileName();
-    } else {
-        file = SharedFile(new QFile(ExportFileName));
-        QFileInfo info(ExportFileName);
-        name = info.fileName();
+        auto Stat = Stats[Pos];
+        if (!Ends[Pos] || Stat->Type_Get() != Type_Video)
+            continue;
+        auto Starts = Stat->shots.Get();
+        for (auto Start = Starts.rbegin(); Start != Starts.rend() && *Start > m_checkpointDone[Pos]; ++Start)
+            if (*Start < Ends[Pos] && frameTime(Stat, *Start) < Time)
+            {
+                Shot = std::max(Shot, frameTime(Stat, *Start));
+                break;
+            }
     }
+    if (Shot != -DBL_MAX)
+        Time = Shot;
 
-    std::string DataS=Data.str();
-    uLongf Buffer_Size=65536;
+    bool HasFrames = false;
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
+    {
+        auto Stat = Stats[Pos];
+        while (Ends[Pos] > m_checkpointDone[Pos] && frameTime(Stat, Ends[Pos]-1) >= Time)
+            Ends[Pos]--;
+        Ends[Pos] = std::max(Ends[Pos], m_checkpointDone[Pos]);
+        HasFrames = HasFrames || Ends[Pos] > m_checkpointDone[Pos];
+    }
+    if (!HasFrames)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    QFile File(ExportFileName);
+    if (!File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return std::numeric_limits<double>::quiet_NaN();
+    StatsCompressionWriter Compression(File, StatsCompression::Format_FromFileName(ExportFileName));
+    StatsXmlWriter Writer([&](const char* Data, size_t Size) {
+        return Compression.Append(Data, Size);
+    });
 
-    if(file->open(QIODevice::ReadWrite))
+    Writer.Text(Export_XmlHeader());
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
+        if (Stats[Pos] && Ends[Pos] > m_checkpointDone[Pos])
+            Stats[Pos]->StatsToXML(Writer, filters, m_checkpointDone[Pos], Ends[Pos]);
+    Writer.Text(Export_XmlFooter());
+    if (!Writer.Finish() || !Compression.Finish() || !File.flush())
     {
-        if (name.endsWith(".qctools.xml"))
-        {
-            auto bytesLeft = Data.str().size();
-            auto writePtr = DataS.c_str();
-            auto totalBytesWritten = 0;
+        File.remove();
+        return std::numeric_limits<double>::quiet_NaN();
+    }
 
-            while (bytesLeft) {
-                auto bytesToWrite = std::min(size_t(Buffer_Size), bytesLeft);
-                auto bytesWritten = file->write(writePtr, bytesToWrite);
-                totalBytesWritten += bytesWritten;
+    m_checkpointDone = Ends;
+    return Time;
+}
 
-                Q_EMIT statsFileGenerationProgress(totalBytesWritten, DataS.size());
+//---------------------------------------------------------------------------
+bool FileInformation::setStreamExport(const QString &ExportFileName, const activefilters& filters)
+{
+    QMutexLocker Lock(&m_streamExportMutex);
 
-                writePtr += bytesToWrite;
-                bytesLeft -= bytesWritten;
+    // Too late, the usual export will be used; columnar and Arrow reports are written at the end
+    if(StatsColumnsReport::IsColumnsReport(ExportFileName) || StatsArrowReport::IsArrowReport(ExportFileName) || m_parsed || m_streamExportClosed || m_streamExport)
+        return false;
 
-                if (bytesWritten != bytesToWrite)
-                    break;
-            }
-        }
-        else if (name.endsWith(".xml"))
-        {
-            file->write(DataS.c_str(), DataS.length());
-        } else {
-            char* Buffer=new char[Buffer_Size];
-            z_stream strm;
-            strm.next_in = (Bytef *) DataS.c_str();
-            strm.avail_in = DataS.size() ;
-            strm.total_out = 0;
-            strm.zalloc = Z_NULL;
-            strm.zfree = Z_NULL;
-            if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY)>=0) // 15 + 16 are magic values for gzip
-            {
-                do
-                {
-                    strm.next_out = (unsigned char*) Buffer;
-                    strm.avail_out = Buffer_Size;
-                    if (deflate(&strm, Z_FINISH)<0)
-                        break;
-                    file->write(Buffer, Buffer_Size-strm.avail_out);
+    createExportFile(ExportFileName, m_streamExportFileOpened, m_streamExportName);
+    if(!m_streamExportFileOpened->isOpen() && !m_streamExportFileOpened->open(QIODevice::ReadWrite))
+    {
+        m_streamExportFileOpened.reset();
+        return false;
+    }
+    m_streamExportFileName = ExportFileName;
 
-                    Q_EMIT statsFileGenerationProgress((char*) strm.next_in - DataS.c_str(), DataS.size());
-                }
-                while (strm.avail_out == 0);
-                deflateEnd (&strm);
-            }
-            delete[] Buffer;
-        }
+    // Frames already parsed are exported first
+    m_streamExport.reset(new StatsReportStream(*m_streamExportFileOpened, !m_streamExportName.endsWith(".xml"), Stats, filters));
+    m_streamExport->Start(Export_XmlHeader());
+    return true;
+}
 
-        file->flush();
-        file->seek(0);
+//---------------------------------------------------------------------------
+bool FileInformation::uploadStreamExport(const QString &fileName)
+{
+    {
+        QMutexLocker Lock(&m_streamExportMutex);
+        if(!m_streamExport || m_streamExportFileName.isEmpty() || IsStdoutExport(m_streamExportFileName))
+            return false;
     }
 
-    Q_EMIT statsFileGenerated(file, name);
-    m_commentsUpdated = false;
+    // Own handle, the report is written by the parser thread
+    SharedFile file = SharedFile(new QFile(m_streamExportFileName));
+    if(!file->open(QIODevice::ReadOnly))
+        return false;
+
+    m_streamExportUpload = signalServer->uploadGrowingFile(fileName, file);
+    uploadOperation = m_streamExportUpload;
+    connect(uploadOperation.data(), SIGNAL(finished()), this, SLOT(uploadDone()));
+    connect(uploadOperation.data(), SIGNAL(uploadProgress(qint64, qint64)), this, SIGNAL(signalServerUploadProgressChanged(qint64, qint64)));
+
+    Q_EMIT signalServerUploadStatusChanged();
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void FileInformation::finishStreamExport()
+{
+    QMutexLocker Lock(&m_streamExportMutex);
+
+    m_streamExportClosed = true;
+    if(!m_streamExport)
+        return;
+
+    qint64 finalSize = -1;
+    if(m_streamExport->Finish(Export_XmlFooter()))
+    {
+        m_streamExportFileOpened->flush();
+        finalSize = m_streamExportFileOpened->size();
+        m_streamExportFileOpened->seek(0);
+        m_streamExportFile = m_streamExportFileOpened;
+        qDebug() << "stats file" << m_streamExportName << "written while parsing," << m_streamExport->framesCount() << "frames";
+    }
+    else
+        qDebug() << "stats file" << m_streamExportName << "can not be written while parsing";
+    m_streamExport.reset();
+
+    // The upload is in the thread of this object
+    QMetaObject::invokeMethod(this, [this, finalSize]() {
+        if(!m_streamExportUpload)
+            return;
+        if(finalSize >= 0)
+            m_streamExportUpload->setFinalSize(finalSize);
+        else
+            m_streamExportUpload->cancel();
+    }, Qt::QueuedConnection);
 }
 
 struct Output {
@@ -1421,7 +4542,7 @@ struct Output {
 
     int Scale_OutputPixelFormat = { AV_PIX_FMT_YUVJ420P };
     int Output_PixelFormat = { AV_PIX_FMT_YUVJ420P };
-    int Output_CodecID = { AV_CODEC_ID_MJPEG };
+    FFmpegVideoEncoder::Codec Output_Codec;
     int Width = { 0 };
     int Height = { 0 };
     int timeBaseNum = { 0 };
@@ -1443,6 +4564,11 @@ struct Output {
             avfilter_graph_free(&FilterGraph);
     }
 
+    void setCodec(const FFmpegVideoEncoder::Codec& codec) {
+        Output_Codec = codec;
+        Output_PixelFormat = Scale_OutputPixelFormat = codec.pixelFormat();
+    }
+
     bool Scale_Init(AVFrame* frame) {
         if (!frame)
             return false;
@@ -1464,24 +4590,33 @@ struct Output {
             return true;
 
         //
-        auto *Output_Codec=avcodec_find_encoder((AVCodecID) Output_CodecID);
-        if (!Output_Codec)
+        auto *Output_Encoder=Output_Codec.encoder();
+        if (!Output_Encoder)
             return false;
-        Output_CodecContext=avcodec_alloc_context3 (Output_Codec);
+        Output_CodecContext=avcodec_alloc_context3 (Output_Encoder);
         if (!Output_CodecContext)
             return false;
-        Output_CodecContext->qmin          = 8;
-        Output_CodecContext->qmax          = 12;
+        if (Output_Encoder->id == AV_CODEC_ID_MJPEG)
+        {
+            Output_CodecContext->qmin      = 8;
+            Output_CodecContext->qmax      = 12;
+        }
+        Output_CodecContext->gop_size      = 1;
+        Output_CodecContext->max_b_frames  = 0;
         Output_CodecContext->width         = size.width();
         Output_CodecContext->height        = size.height();
         Output_CodecContext->pix_fmt       = (AVPixelFormat) Output_PixelFormat;
         Output_CodecContext->time_base.num = timeBaseNum;
         Output_CodecContext->time_base.den = timeBaseDen;
 
-        qDebug() << "initEncoder: " << Output_CodecID << Output_CodecContext->width << Output_CodecContext->height <<
+        qDebug() << "initEncoder: " << Output_Codec.toString() << Output_CodecContext->width << Output_CodecContext->height <<
             Output_CodecContext->pix_fmt << Output_CodecContext->time_base.num << Output_CodecContext->time_base.den;
 
-        if (avcodec_open2(Output_CodecContext, Output_Codec, NULL) < 0)
+        // Same options as the stream of the muxer, see FFmpegVideoEncoder::makeVideo()
+        AVDictionary* options = Output_Codec.dictionary();
+        int result = avcodec_open2(Output_CodecContext, Output_Encoder, &options);
+        av_dict_free(&options);
+        if (result < 0)
             return false;
 
         // All is OK
@@ -1548,6 +4683,7 @@ struct Output {
             return outPacket;
         }
 
+        TraceEvents::Scope Trace("encoder", "encode frame");
         int got_packet=0;
         int result = avcodec_send_frame(Output_CodecContext, Frame.get());
         if (result < 0)
@@ -1596,11 +4732,30 @@ void FileInformation::Export_QCTools_Mkv(const QString &ExportFileName, const ac
     disconnect(connection);
 }
 
-void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachment, QString attachmentFileName, const std::function<void(int, int)>& thumbnailsCallback, const std::function<void(int, int)>& panelsCallback)
+// Default encoder if the one set can not be used, the report is written anyway
+static FFmpegVideoEncoder::Codec reportCodec(const QString& text)
+{
+    auto codec = FFmpegVideoEncoder::Codec::parse(text);
+    auto issue = codec.check();
+    if(issue.isEmpty())
+        return codec;
+
+    qWarning() << "report encoder" << text << "can not be used (" << issue << "), mjpeg is used instead";
+    return FFmpegVideoEncoder::Codec();
+}
+
+void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachment, QString attachmentFileName, const std::function<void(int, int)>& progressCallback)
 {
     FFmpegVideoEncoder encoder;
-    int thumbnailsCount = m_thumbnails_frames.size();
-    int thumbnailIndex = 0;
+
+    // Thumbnails and panels of the export range, all of them by default
+    auto ranges = exportPanelFrames();
+    int thumbnailsCount = (int)ranges[0].second;
+    int thumbnailIndex = (int)ranges[0].first;
+
+    // Thumbnails and panels are encoded by different threads, progress is reported by the thread of the encoder
+    std::atomic<int> encodedCount { 0 };
+    int encodedTotal = thumbnailsCount - thumbnailIndex;
 
     FFmpegVideoEncoder::Metadata metadata;
     metadata << FFmpegVideoEncoder::MetadataEntry(QString("title"), QString("QCTools Report for %1").arg(QFileInfo(fileName()).fileName()));
@@ -1608,6 +4763,29 @@ void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachmen
 
     encoder.setMetadata(metadata);
 
+    // Opened from a report, only the stats and the comments may have changed: its thumbnails and panels are copied, only
+    // the packets of the range if it starts with a key frame of each stream
+    if(!m_mkvReportFileName.isEmpty())
+    {
+        for(size_t i = 1; i < ranges.size(); ++i)
+            encodedTotal += (int)(ranges[i].second - ranges[i].first);
+        if(progressCallback)
+        {
+            progressCallback(0, encodedTotal);
+            encoder.setProgress([&]() {
+                progressCallback(std::min(++encodedCount, encodedTotal), encodedTotal);
+            });
+        }
+        if(encoder.remuxVideo(exportFileName, m_mkvReportFileName, reportCodec(ThumbnailsCodec_Get()), reportCodec(PanelsCodec_Get()), attachment, attachmentFileName,
+                              m_hasExportRange ? ranges : decltype(ranges)()))
+            return;
+
+        qWarning() << "thumbnails and panels of" << m_mkvReportFileName << "can not be copied, they are encoded again";
+        encoder.setProgress({});
+        encodedCount = 0;
+        encodedTotal = thumbnailsCount - thumbnailIndex;
+    }
+
     FFmpegVideoEncoder::Source source;
 
     FFmpegVideoEncoder::Metadata streamMetadata;
@@ -1624,8 +4802,9 @@ void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachmen
     int codecDen = codecTimeBaseSplitted[1].toInt();
 
     source.metadata = streamMetadata;
-    source.width = m_thumbnails_frames.empty() ? 0 : m_thumbnails_frames[0].size().width();
-    source.height = m_thumbnails_frames.empty() ? 0 : m_thumbnails_frames[0].size().height();
+    source.codec = reportCodec(ThumbnailsCodec_Get());
+    source.width = m_reportFrames ? ThumbnailStore::Size : m_thumbnails.Width();
+    source.height = m_reportFrames ? ThumbnailStore::Size : m_thumbnails.Height();
 
     source.num = num;
     source.den = den;
@@ -1634,27 +4813,30 @@ void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachmen
 
     std::shared_ptr<Output> thumbnailsOutput = std::make_shared<Output>();
     thumbnailsOutput->scaleBeforeEncoding = true;
+    thumbnailsOutput->setCodec(source.codec);
     outputs.push_back(thumbnailsOutput);
 
-    source.getPacket = [&]() -> std::shared_ptr<AVPacket> {
-        if(thumbnailsCallback)
-            thumbnailsCallback(thumbnailIndex, thumbnailsCount);
+    // One frame reused for all thumbnails, dropped ones by the decimation are repeated so the track keeps one per frame
+    std::shared_ptr<AVFrame> thumbnailFrame(av_frame_alloc(), [](AVFrame* frame) { av_frame_free(&frame); });
 
+    source.getPacket = [&]() -> std::shared_ptr<AVPacket> {
         bool hasNext = thumbnailIndex < thumbnailsCount;
 
         if(!hasNext)
             return nullptr;
 
-        auto frame = m_thumbnails_frames[thumbnailIndex];
+        if(m_reportFrames ? !m_reportFrames->Get(0, thumbnailIndex, thumbnailFrame.get()) : !m_thumbnails.Get(thumbnailIndex, thumbnailFrame.get()))
+            return nullptr;
 
         thumbnailsOutput->timeBaseDen = codecDen;
         thumbnailsOutput->timeBaseNum = codecNum;
-        thumbnailsOutput->Width = frame.frame()->width;
-        thumbnailsOutput->Height = frame.frame()->height;
+        thumbnailsOutput->Width = thumbnailFrame->width;
+        thumbnailsOutput->Height = thumbnailFrame->height;
 
-        auto packet = thumbnailsOutput->encodeFrame(frame.frame());
+        auto packet = thumbnailsOutput->encodeFrame(thumbnailFrame.get());
 
         ++thumbnailIndex;
+        ++encodedCount;
 
         return packet;
     };
@@ -1662,6 +4844,8 @@ void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachmen
     QVector<FFmpegVideoEncoder::Source> sources;
     sources.push_back(source);
 
+    auto panelsCodec = reportCodec(PanelsCodec_Get());
+
     for(auto& panelTitle : panelOutputsByTitle().keys())
     {
         qDebug() << "encoding panel... panelTitle: " << QString::fromStdString(panelTitle);
@@ -1672,21 +4856,16 @@ void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachmen
             if(panelFramesCount == 0)
                 continue;
 
-            auto panelsCount = getPanelFramesCount(panelOutputIndex);
-            auto panelIndex = 0;
+            auto panelsCount = (size_t)ranges[panelOutputIndex + 1].second;
+            auto panelIndex = (size_t)ranges[panelOutputIndex + 1].first;
+            encodedTotal += (int)(panelsCount - panelIndex);
 
             FFmpegVideoEncoder::Metadata streamMetadata;
             streamMetadata << FFmpegVideoEncoder::MetadataEntry(QString("title"), QString::fromStdString(panelTitle));
 
-            QString filterChain;
-            QString filterOutputName = QString(" [%1%2]").arg(panelOutputPrefix).arg(panelOutputIndex);
-            for(auto i = 0; i < m_mediaParser->filters().size(); ++i) {
-                auto filter = m_mediaParser->filters().at(i);
-                if(filter.endsWith(filterOutputName)) {
-                    filterChain = filter.remove(filterOutputName);
-                    break;
-                }
-            }
+            // Filters of the parser may be combined in one graph, the chain of the panel is kept with it
+            auto filterIt = m_panelMetadata[panelOutputIndex].find("filter");
+            QString filterChain = filterIt != m_panelMetadata[panelOutputIndex].end() ? QString::fromStdString(filterIt->second) : QString();
             streamMetadata << FFmpegVideoEncoder::MetadataEntry(QString("filterchain"), filterChain);
 
             auto outputMetadata = m_panelMetadata[panelOutputIndex];
@@ -1707,6 +4886,7 @@ void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachmen
 
             FFmpegVideoEncoder::Source panelSource;
             panelSource.metadata = streamMetadata;
+            panelSource.codec = panelsCodec;
             panelSource.width = panelSize().width();
             panelSource.height = panelSize().height();
 
@@ -1723,32 +4903,35 @@ void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachmen
 
             std::shared_ptr<Output> output = std::make_shared<Output>();
             output->scaleBeforeEncoding = true;
+            output->setCodec(panelsCodec);
             outputs.push_back(output);
 
             panelSource.num = num;
             panelSource.den = den;
-            panelSource.getPacket = [output, codecNum, codecDen, panelIndex, panelsCount, panelOutputIndex, panelsCallback, panelSource, this]() mutable -> std::shared_ptr<AVPacket> {
-                if(panelsCallback)
-                    panelsCallback(panelIndex, panelsCount);
+            // Frames are read back one at a time from the store, in one frame reused for the panel
+            std::shared_ptr<AVFrame> panelFrame(av_frame_alloc(), [](AVFrame* frame) { av_frame_free(&frame); });
 
+            panelSource.getPacket = [output, codecNum, codecDen, panelIndex, panelsCount, panelOutputIndex, panelSource, panelFrame, &encodedCount, this]() mutable -> std::shared_ptr<AVPacket> {
                 bool hasNext = panelIndex < panelsCount;
 
                 if(!hasNext) {
                     return nullptr;
                 }
 
-                auto frame = getPanelFrame(panelOutputIndex, panelIndex);
+                if(m_reportFrames ? !m_reportFrames->Get(panelOutputIndex + 1, panelIndex, panelFrame.get()) : !m_panelFrames[panelOutputIndex]->Get(panelIndex, panelFrame.get()))
+                    return nullptr;
 
                 output->timeBaseDen = codecDen;
                 output->timeBaseNum = codecNum;
-                output->Width = frame.frame()->width;
-                output->Height = panelSource.height; // frame.frame()->height;
+                output->Width = panelFrame->width;
+                output->Height = panelSource.height; // panelFrame->height;
 
-                qDebug() << "getPacket => panelIndex: " << panelIndex << ", timeBaseNum = " << codecNum << ", timeBaseDen = " << codecDen << ", width = " << output->Width << ", height = " << output->Height;
+                QCTOOLS_TRACE(Category_Panels, "getPacket => panelIndex: {}, timeBaseNum = {}, timeBaseDen = {}, width = {}, height = {}", panelIndex, codecNum, codecDen, output->Width, output->Height);
 
-                auto packet = output->encodeFrame(frame.frame());
+                auto packet = output->encodeFrame(panelFrame.get());
 
                 ++panelIndex;
+                ++encodedCount;
 
                 return packet;
             };
@@ -1761,11 +4944,20 @@ void FileInformation::makeMkvReport(QString exportFileName, QByteArray attachmen
         }
     }
 
+    if(progressCallback)
+    {
+        progressCallback(0, encodedTotal);
+        encoder.setProgress([&]() {
+            progressCallback(encodedCount, encodedTotal);
+        });
+    }
     encoder.makeVideo(exportFileName, sources, attachment, attachmentFileName);
 }
 
 size_t FileInformation::thumbnailsCount() {
-    return m_thumbnails_frames.size();
+    if(m_reportFrames)
+        return m_reportFrames->Count(0);
+    return m_thumbnails.Count();
 }
 
 //***************************************************************************
@@ -1774,12 +4966,25 @@ size_t FileInformation::thumbnailsCount() {
 
 //---------------------------------------------------------------------------
 
-QAVVideoFrame FileInformation::getThumbnail(size_t pos)
+Thumbnail FileInformation::getThumbnail(size_t pos, int minSize)
+{
+    Thumbnail result;
+    if (pos<ReferenceStat()->x_Current_Get())
+        result = m_reportFrames ? m_reportFrames->Get(0, pos) : m_thumbnails.Get(pos, minSize);
+
+    // Not parsed yet: key frame before it, at the time the player seeks to
+    if (result.Rgb.isEmpty() && m_keyFrameThumbnails && Frames_Count_Get() > 0)
+        result = m_keyFrameThumbnails->Get(pos * duration() / Frames_Count_Get());
+
+    return result;
+}
+
+QVector<QPair<double, qint64>> FileInformation::previewKeyFrames() const
 {
-    if (pos>=ReferenceStat()->x_Current || pos>= m_thumbnails_frames.size())
-        return QAVVideoFrame();
+    if (!m_keyFrameThumbnails)
+        return {};
 
-    return m_thumbnails_frames[pos];
+    return m_keyFrameThumbnails->KeyFrames();
 }
 
 QString FileInformation::fileName() const
@@ -1805,6 +5010,15 @@ int FileInformation::height() const
     return videoStreams[0].stream()->codecpar->height;
 }
 
+QString FileInformation::videoCodec() const
+{
+    auto videoStreams = m_mediaPlayer ? m_mediaPlayer->availableVideoStreams() : m_mediaParser->availableVideoStreams();
+    if(videoStreams.empty())
+        return QString();
+
+    return QString::fromLatin1(avcodec_get_name(videoStreams[0].stream()->codecpar->codec_id));
+}
+
 int FileInformation::bitsPerRawSample() const
 {
     auto videoStreams = m_mediaPlayer ? m_mediaPlayer->availableVideoStreams() : m_mediaParser->availableVideoStreams();
@@ -2180,7 +5394,7 @@ bool FileInformation::hasAudioStreams() const
 }
 
 //---------------------------------------------------------------------------
-int FileInformation::Frames_Count_Get (size_t Stats_Pos) const
+int64_t FileInformation::Frames_Count_Get (size_t Stats_Pos) const
 {
     if (Stats_Pos==(size_t)-1)
         Stats_Pos=ReferenceStream_Pos_Get();
@@ -2191,7 +5405,7 @@ int FileInformation::Frames_Count_Get (size_t Stats_Pos) const
 }
 
 //---------------------------------------------------------------------------
-int FileInformation::Frames_Pos_Get (size_t Stats_Pos)
+int64_t FileInformation::Frames_Pos_Get (size_t Stats_Pos)
 {
     // Looking for the first video stream
     if (Stats_Pos==(size_t)-1)
@@ -2199,14 +5413,14 @@ int FileInformation::Frames_Pos_Get (size_t Stats_Pos)
     if (Stats_Pos>=Stats.size())
         return -1;
 
-    int Pos;
+    int64_t Pos;
 
     if (Stats_Pos!=ReferenceStream_Pos_Get())
     {
         // Computing frame pos based on the first stream
         double TimeStamp=ReferenceStat()->x[1][Frames_Pos];
         Pos=0;
-        for (; Pos<Stats[Stats_Pos]->x_Current_Max; Pos++)
+        for (; Pos<(int64_t)Stats[Stats_Pos]->x_Current_Max; Pos++)
         {
             if (Stats[Stats_Pos]->x[1][Pos]>=TimeStamp)
             {
@@ -2238,7 +5452,7 @@ QString FileInformation::Frame_Type_Get(size_t Stats_Pos, size_t frameIndex) con
         {
             // Computing frame pos based on the first stream
             double TimeStamp=ReferenceStat()->x[1][Frames_Pos];
-            int Pos=0;
+            size_t Pos=0;
             for (; Pos<Stats[Stats_Pos]->x_Current_Max; Pos++)
             {
                 if (Stats[Stats_Pos]->x[1][Pos]>=TimeStamp)
@@ -2262,7 +5476,7 @@ QString FileInformation::Frame_Type_Get(size_t Stats_Pos, size_t frameIndex) con
 }
 
 //---------------------------------------------------------------------------
-void FileInformation::Frames_Pos_Set (int Pos, size_t Stats_Pos)
+void FileInformation::Frames_Pos_Set (int64_t Pos, size_t Stats_Pos)
 {
     // Looking for the first video stream
     if (Stats_Pos==(size_t)-1)
@@ -2275,7 +5489,7 @@ void FileInformation::Frames_Pos_Set (int Pos, size_t Stats_Pos)
         // Computing frame pos based on the first stream
         double TimeStamp=Stats[Stats_Pos]->x[1][Pos];
         Pos=0;
-        for (; Pos<ReferenceStat()->x_Current_Max; Pos++)
+        for (; Pos<(int64_t)ReferenceStat()->x_Current_Max; Pos++)
             if (ReferenceStat()->x[1][Pos]>=TimeStamp)
             {
                 if (Pos && ReferenceStat()->x[1][Pos]!=TimeStamp)
@@ -2286,8 +5500,8 @@ void FileInformation::Frames_Pos_Set (int Pos, size_t Stats_Pos)
     
     if (Pos<0)
         Pos=0;
-    if (Pos>=ReferenceStat()->x_Current_Max)
-        Pos=ReferenceStat()->x_Current_Max-1;
+    if (Pos>=(int64_t)ReferenceStat()->x_Current_Max)
+        Pos=(int64_t)ReferenceStat()->x_Current_Max-1;
 
     if (Frames_Pos==Pos)
         return;
@@ -2315,7 +5529,7 @@ bool FileInformation::Frames_Pos_Plus ()
 {
     qDebug() << "Frames_Pos_Plus..";
 
-    if (Frames_Pos+1>=ReferenceStat()->x_Current_Max)
+    if (Frames_Pos+1>=(int64_t)ReferenceStat()->x_Current_Max)
         return false;;
 
     Frames_Pos++;
@@ -2328,7 +5542,7 @@ bool FileInformation::Frames_Pos_Plus ()
 bool FileInformation::Frames_Pos_AtEnd()
 {
     auto maxX = ReferenceStat()->x_Current_Max;
-    bool atEnd = (Frames_Pos + 1) == maxX;
+    bool atEnd = (Frames_Pos + 1) == (int64_t)maxX;
     return atEnd;
 }
 
@@ -2391,7 +5605,7 @@ int FileInformation::BitsPerRawSample(int streamType) const
             return m_mediaParser->availableVideoStreams()[0].stream()->codecpar->bits_per_raw_sample;
 
         if(ReferenceStat()) {
-            auto guessedBitsPerRawSample = guessBitsPerRawSampleFromFormat(*ReferenceStat()->pix_fmt);
+            auto guessedBitsPerRawSample = guessBitsPerRawSampleFromFormat(ReferenceStat()->pix_fmt[0]);
             if(guessedBitsPerRawSample != 0)
                 return guessedBitsPerRawSample;
         }
@@ -2527,6 +5741,20 @@ bool FileInformation::hasStats() const
     return m_hasStats;
 }
 
+activefilters FileInformation::reportFilters() const
+{
+    activefilters Filters;
+    for (auto Stat : Stats)
+        if (Stat)
+            Filters |= Stat->ReportFilters_Get();
+    return Filters;
+}
+
+bool FileInformation::hasReanalysis() const
+{
+    return m_reanalysisParser != nullptr;
+}
+
 void FileInformation::setAutoCheckFileUploaded(bool enable)
 {
     m_autoCheckFileUploaded = enable;
@@ -2583,6 +5811,20 @@ void FileInformation::checkFileUploadedDone()
 
 void FileInformation::upload(const QFileInfo& fileInfo)
 {
+    // Already uploaded while exported, continued if it failed after the export
+    if(m_streamExportUpload && m_streamExportUpload->fileName() == fileInfo.fileName() && m_streamExportUpload->state() != UploadFileOperation::Error)
+    {
+        if(m_streamExportUpload->state() == UploadFileOperation::Uploaded)
+            QTimer::singleShot(0, this, SLOT(uploadDone()));
+        return;
+    }
+    if(m_streamExportUpload && m_streamExportUpload->fileName() == fileInfo.fileName() && m_streamExportUpload->finalSizeIsSet())
+    {
+        m_streamExportUpload->resume();
+        Q_EMIT signalServerUploadStatusChanged();
+        return;
+    }
+
     QString fullName = fileInfo.filePath();
     QSharedPointer<QFile> file = QSharedPointer<QFile>::create(fullName);
     if(file->open(QIODevice::ReadOnly))
@@ -2593,7 +5835,10 @@ void FileInformation::upload(const QFileInfo& fileInfo)
 
 void FileInformation::upload(SharedFile file, const QString &fileName)
 {
-    uploadOperation = signalServer->uploadFile(fileName, file);
+    // Report already on the server (e.g. exported again after comments are added), only its changed chunks are sent
+    bool isOnServer = signalServerCheckUploadedStatus() == SignalServerCheckUploadedStatus::Uploaded
+                   || (uploadOperation && uploadOperation->fileName() == fileName && uploadOperation->state() == UploadFileOperation::Uploaded);
+    uploadOperation = isOnServer ? signalServer->uploadFileChanges(fileName, file) : signalServer->uploadFile(fileName, file);
     connect(uploadOperation.data(), SIGNAL(finished()), this, SLOT(uploadDone()));
     connect(uploadOperation.data(), SIGNAL(uploadProgress(qint64, qint64)), this, SIGNAL(signalServerUploadProgressChanged(qint64, qint64)));
 
@@ -2619,6 +5864,8 @@ void FileInformation::uploadDone()
 
 void FileInformation::parsingDone(bool success)
 {
+    endParse();
+
     if(m_autoUpload && signalServerCheckUploadedStatus() == SignalServerCheckUploadedStatus::NotUploaded)
     {
         qDebug() << "parsing done: " << success;
@@ -12,19 +12,51 @@
 //---------------------------------------------------------------------------
 #include "Core/Core.h"
 #include "Core/SignalServer.h"
+#include "Core/StatsColumnsCache.h"
+#include "Core/PanelFrameStore.h"
+#include "Core/ThumbnailStore.h"
 
 #include <string>
 
 #include <QThread>
 #include <QFile>
+#include <QMutex>
 #include <QSharedPointer>
 #include <QFileInfo>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QMap>
+#include <QStringList>
+#include <QRect>
 #include <QSize>
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
+class QAVFrame;
 class QAVVideoFrame;
+class SignalStatsKernel;
+class FieldCompareKernel;
+class HdrLightKernel;
+class AudioStatsKernel;
+class AnalyzerStream;
+class CaptionsTimecode;
+class PanelBuilder;
 class CommonStats;
+class FrameSnapshots;
+class FrameFeed;
+class ThumbnailSprites;
+class StatsReportStream;
+class StatsSegmentParser;
+class KeyFrameThumbnails;
+class ReportFrames;
+class PacketStatsParser;
+class StatsProcessParser;
+class StatsReanalysisParser;
+class StatsIngest;
 class StreamsStats;
 class FormatStats;
 
@@ -58,30 +90,347 @@ public:
     JobTypes jobType() const;
 
     // Constructor/Destructor
+    // Files are opened and parsing is started by the constructor, else only once open() is called
                                 FileInformation             (SignalServer* signalServer, const QString &fileName,
                                                              activefilters ActiveFilters, activealltracks ActiveAllTracks,
-                                                             QMap<QString, std::tuple<QString, QString, QString, QString, int>> activePanels,
+                                                             QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>> activePanels,
                                                              const QString &cacheFileNamePrefix,
-                                                             int FrameCount=0);
+                                                             int FrameCount=0, bool Open=true);
                                 ~FileInformation            ();
 
+    // Opening without blocking: returns at once, the media is probed by the parser and the report is read by a
+    // thread of a pool, then opened() is emitted and parsing is started, if Parse, else by startParse() (e.g. files
+    // opened ahead by Batch). Nothing else may be used until then
+    void open(bool Parse = true);
+    bool isOpened() const;
+
     // Parsing
     void startParse();
+
+    // Count of segments parsed in parallel for files created afterwards (stats only, no thumbnails nor panels), 1 means no split
+    static void ParsingSegments_Set(int Count);
+    static int ParsingSegments_Get();
+
+    // Stills of the frames written during the parsing of the files created afterwards (parsed in one segment), not owned
+    static void FrameSnapshots_Set(FrameSnapshots* Snapshots);
+    static FrameSnapshots* FrameSnapshots_Get();
+
+    // Sampled grayscale frames written during the parsing of the files created afterwards (parsed in one segment), not owned
+    static void FrameFeed_Set(FrameFeed* Feed);
+    static FrameFeed* FrameFeed_Get();
+
+    // Sprite sheets of the thumbnails written during the parsing of the files created afterwards, not owned
+    static void ThumbnailSprites_Set(ThumbnailSprites* Sprites);
+    static ThumbnailSprites* ThumbnailSprites_Get();
+
+    // Same for this file only, before startParse()
+    void setParsingSegments(int Count);
+
+    // Time stamps in seconds (or frame numbers of the first video stream, from 0) of the first frame parsed and of the first frame not parsed, before startParse()
+    // The parser seeks a warm-up before Start (see StatsSegmentParser::Warmup) and drops the frames out of the range, in one segment
+    // Returns false if the frames can not be converted to time stamps
+    bool setParsingRange(double Start, double End, bool InFrames = false);
+    // Count of segments really used, after startParse()
+    int parsingSegments() const;
+    // Threads of the players paused at a frame boundary, the stats stay in memory, until the parsing is resumed
+    // (e.g. for a job of a higher priority, see Batch); not for the packet statistics only, nor once the media ended
+    void setParsingPaused(bool Paused);
+    bool parsingPaused() const;
+    // Video frames parsed (see Sampling_Set), 0 for all of them, -1 key frames only, N one frame of N
+    int sampling() const;
+
+    // Count of files parsed at the same time, next ones wait for the end of a parsing (see ParsingScheduler),
+    // 0 means adaptive from the measured work done, at most the cores count minus 2
+    static void ParsingMax_Set(int Count);
+    static int ParsingMax_Get();
+    // File the user looks at, parsed first and before the others (see ParsingScheduler), nullptr if none
+    static void ParsingCurrent_Set(FileInformation* File);
+    // Threads of the parsers created afterwards at a background priority of the system, with the threads of their decoders
+    // and filters where the system passes it on (see ParsingScheduler::Background_Apply), so the GUI thread comes first
+    static void BackgroundParsing_Set(bool Value);
+    static bool BackgroundParsing_Get();
+    // While the user interacts (see ParsingInteraction), the parsers use Cores cores: the files beyond are held at a frame
+    // boundary until the user is idle again, the file the user looks at goes on (see ParsingScheduler); 0 (default) for no cap
+    static void ParsingInteractionCores_Set(int Cores);
+    // The user interacts with the GUI, from its thread
+    static void ParsingInteraction();
+
+    // Threads of the decoder and of the filter graphs of each parsing pipeline, for files created afterwards
+    // 0 means the cores count divided by the pipelines parsed at the same time, so one file alone uses all the cores
+    static void DecoderThreads_Set(int Count);
+    static int DecoderThreads_Get();
+    static void FilterThreads_Set(int Count);
+    static int FilterThreads_Get();
+    // Frames decoded ahead of the filters by a thread of their own for each stream, so decoding and filtering
+    // overlap (default 4); 0 decodes in the thread of the filters
+    static void DecodeAhead_Set(int Count);
+    static int DecodeAhead_Get();
+    // "frame", "slice" or empty for both (frame threading delays each frame by one frame per thread)
+    static void DecoderThreadType_Set(const QString& Type);
+    static QString DecoderThreadType_Get();
+    // Decoders of the files parsed kept once their parsing ended, reused by the next files with streams of the same
+    // format and decoder options instead of opening new ones (see QAVPlayer::setDecoderPoolSize()); 0 (default) for none
+    static void DecoderPool_Set(int Count);
+    static int DecoderPool_Get();
+    // Parameters of the streams of the files created afterwards from the headers when the container has all of them
+    // (MXF, MOV...), else from packets read in a capped size and duration, fully probed only if some are still missing,
+    // see QAVPlayer::setFastProbe(); for the parsers, the player and the other readers of the file
+    static void FastProbe_Set(bool Value);
+    static bool FastProbe_Get();
+    // NUMA node (see NumaNodes) the threads of the parsers created afterwards are bound to, with the threads of their
+    // decoders and filters and so the memory of their frames; the cores of the node are the cores of the threads above
+    // and the pipelines parsed at the same time are split between the nodes; -1 (default) for no binding
+    static void NumaNode_Set(int Node);
+    static int NumaNode_Get();
+    // Device the parsers created afterwards decode on with QT_AVPLAYER_HWDECODE (e.g. /dev/dri/renderD129, a CUDA index),
+    // see QAVPlayer::setHardwareDevice(); empty (default) for the default device of the type, "none" for software decoding
+    static void HardwareDevice_Set(const QString& Device);
+    static QString HardwareDevice_Get();
+    // Threads above, the fast probe, the frame hash and the hardware device applied to a parser which is one of Pipelines parsing a file, before its source is set
+    static void ParsingThreads_Apply(QAVPlayer* Player, int Pipelines);
+    // Stats, thumbnails and panels chains of each stream type in one filter graph (default), else one graph per output, the
+    // graphs of a frame then run in parallel (more panels cost cores rather than time)
+    static void FilterGraphsCombined_Set(bool Combined);
+    static bool FilterGraphsCombined_Get();
+    // Count of filter graphs the stats filters are split in, run by several threads (signalstats, cropdetect... in one, psnr and ssim in another)
+    // 0 means half of the cores of each parsing pipeline, at most 4, 1 means all the stats filters in one chain
+    static void StatsBranches_Set(int Count);
+    static int StatsBranches_Get();
+    // signalstats computed by SignalStatsKernel instead of the filter (not with segmented parsing),
+    // or both with the values of the kernel compared with the ones of the filter (warnings) but not used
+    enum StatsKernelMode { StatsKernel_Off, StatsKernel_On, StatsKernel_Check };
+    static void StatsKernel_Set(int Mode);
+    static int StatsKernel_Get();
+    // psnr and ssim of the fields computed by FieldCompareKernel instead of the split and field graph (not with segmented parsing
+    // nor with a reference, see Compare_Set), same modes
+    static void FieldKernel_Set(int Mode);
+    static int FieldKernel_Get();
+    // astats, aphasemeter and ebur128 computed by AudioStatsKernel in one pass over the source channels
+    // instead of the filters (not with segmented parsing), Window is the length of the RMS window in seconds
+    static void AudioKernel_Set(bool Enabled);
+    static bool AudioKernel_Get();
+    static void AudioKernelWindow_Set(double Window);
+    static double AudioKernelWindow_Get();
+    // Audio frames regrouped before the stats, one row per Window seconds instead of one per decoded frame:
+    // 0 (default) keeps the decoded frames, -1 is one row per frame of the first video stream. The count of
+    // samples is from the sample rate of the first audio stream; not applied to the re-analysis of a report
+    static void AudioRowsWindow_Set(double Window);
+    static double AudioRowsWindow_Get();
+    // Columns analyzed (AnalysisProfiles::profile), for files created afterwards: the filters selected not in the profile
+    // are not run and the items not in the profile not stored; luma-only computes signalstats by the kernel in luma only
+    static void AnalysisProfile_Set(int Profile);
+    static int AnalysisProfile_Get();
+    // Video frames parsed, for a preview report much faster than the full parsing, for files created afterwards:
+    // 0 all of them (default), -1 key frames only, N one frame of N, or Rate frames per second (when not 0, from the
+    // frame rate of the first video stream); not with segmented parsing, audio is fully parsed, see CommonStats::Sampling_Set
+    static void Sampling_Set(int Every);
+    static int Sampling_Get();
+    static void SamplingRate_Set(double Rate);
+    static double SamplingRate_Get();
+    // Live streams (e.g. SRT, UDP or RTMP URLs) never ending, for files created afterwards: no thumbnails, the stats
+    // are kept in a window (see CommonStats::Window_Set) and read while parsed (see StatsWindow)
+    static void Live_Set(bool Value);
+    static bool Live_Get();
+    // Coarse thumbnails of the key frames (see KeyFrameThumbnails) decoded in the background while the files created
+    // afterwards are not parsed: getThumbnail() of the frames not parsed yet is the one of the key frame before them,
+    // and previewKeyFrames() is an approximate seek index; not for live streams, pipes and image sequences
+    static void KeyFramePreview_Set(bool Value);
+    static bool KeyFramePreview_Get();
+    // Items of the columns reports opened afterwards read on their first use (the plots of their group, a summary, an
+    // export...) instead of when the report is opened, the other values of the frames are read at once, see
+    // CommonStats::Item_Require
+    static void LazyItems_Set(bool Value);
+    static bool LazyItems_Get();
+    // XML reports of the files opened asynchronously afterwards (see open()) shown while they are read: opened() is
+    // emitted once the frames of the first quarter of a second of reading are in the stats, the thread of the pool
+    // then reads the other frames of the report into the stats as a parsing does, parsed() is false and parsing is
+    // not started until the end of the report; streams first seen afterwards are added at the end; not with Reanalysis
+    static void ProgressiveReports_Set(bool Value);
+    static bool ProgressiveReports_Get();
+    // Stats of an XML report (gzip, zstd or uncompressed) read as when it is opened, without a FileInformation (no
+    // media, thumbnails nor panels, no columns cache used nor written), from any thread; Trailer is the XML after
+    // </frames>, the stats are owned by the caller. False if the file can not be read or has no frame nor trailer
+    static bool ReadReport(const QString& ReportFileName, std::vector<CommonStats*>& Stats, std::string& Trailer);
+    // Stats of the files created afterwards from their packets only, without decoding (see PacketStatsParser), at the
+    // speed of the disk: time stamps, durations, positions, sizes, key frames and picture types, no filters, no
+    // thumbnails and no panels; not for live streams, pipes and image sequences
+    static void PacketStats_Set(bool Value);
+    static bool PacketStats_Get();
+    // Files created afterwards parsed by a helper process (see StatsProcessParser), a crash of the decoding ends the helper
+    // only and the stats read so far are kept; the stats and the thumbnails are read from its shared memory, no panels;
+    // not for live streams, pipes, image sequences, sampling and the frame snapshots, feed and sprites
+    static void AnalysisProcess_Set(bool Value);
+    static bool AnalysisProcess_Get();
+    // Reduced decoding for a preview analysis, for files created afterwards: the video is decoded with its width and
+    // height divided by 2^Lowres by the decoders supporting it (JPEG 2000, MJPEG...; at most their own maximum, others
+    // decode the full size), and SkipNonRef drops the frames no other frame refers to (B frames of most codecs) in the
+    // decoder; the sizes of the report are the decoded ones, the reduction is in a comment of the XML header
+    static void Lowres_Set(int Lowres);
+    static int Lowres_Get();
+    static void SkipNonRef_Set(bool Value);
+    static bool SkipNonRef_Get();
+    // Video chains of the files created afterwards run on the frames of the decoding device of QT_AVPLAYER_HWDECODE (see
+    // qcli -hwdec): the first scale of the thumbnails and of the panels is done by the scaler of the device (scale_vaapi,
+    // scale_cuda, scale_qsv, scale_vulkan or scale_vt), the frames are downloaded after it, and once for the stats and
+    // the other chains; chains downloaded by the decoder if the device, the codec or the pixel format is not supported
+    static void GpuFilters_Set(bool Value);
+    static bool GpuFilters_Get();
+    // Source the files created afterwards are compared with (e.g. the mezzanine of a transcode): psnr and ssim compare
+    // each frame with the frame of the reference at the same time instead of the fields; the reference is decoded in
+    // the stats graph, scaled to the size of the file, and its time stamps start with the ones of the file; not with
+    // segmented parsing; VmafLog (if not empty) is the per-frame log of libvmaf, written as JSON at the end
+    static void Compare_Set(const QString& Reference, const QString& VmafLog=QString());
+    static QString Compare_Get();
+    // Rectangle of the frames the video detectors of the files created afterwards analyze (e.g. the picture of letterboxed
+    // content, a burn-in area), in pixels of the decoded frames; cropped at the head of the stats chains, so the kernel and
+    // each branch get the region only, and clipped to the frame; empty for the whole frame; not when comparing
+    static void RegionOfInterest_Set(const QRect& Rect);
+    static QRect RegionOfInterest_Get();
+    // Video frames of the files created afterwards with the same pixels as the previous frame of their stream (freeze
+    // frames, slates, animation on twos...) are not filtered by the stats chains: they get the stats of the previous
+    // frame with no differences (YDIF, UDIF and VDIF are 0) and 1 in the qctools.duplicate item; thumbnails and panels
+    // still get every frame; not with the temporal detectors (idet, deflicker, entropy diff, blackdetect, freezedetect),
+    // when comparing or with the analyzer plugins; the segments of a segmented parsing filter all their frames
+    static void FrameMemoization_Set(bool Value);
+    static bool FrameMemoization_Get();
+    // Fixity of the files created afterwards: each decoded video and audio frame has the hash of its data (as framemd5 or
+    // framehash for the raw format of the frame) in the framehash.<algorithm> item of the report, computed by the decoder
+    // threads (see QAVPlayer::setFrameHash); Algorithm is one of av_hash (MD5, murmur3, CRC32...), empty (default) for none,
+    // false if it is not known; FrameHash_Declare declares its column in the stats of a stream, before the first frame
+    static bool FrameHash_Set(const QString& Algorithm);
+    static QString FrameHash_Get();
+    static void FrameHash_Declare(CommonStats* Stat);
+    // Closed captions and timecode of the video frames of the files created afterwards, read from their side data during
+    // the analysis (qctools.cc.608, qctools.cc.708, qctools.timecode and qctools.timecode.discontinuity items, see
+    // CaptionsTimecode); not with the segmented parsing, the timecode continues from the previous frame of the stream
+    static void CaptionsTimecode_Set(bool Value);
+    static bool CaptionsTimecode_Get();
+    // Incremental re-analysis of the files created afterwards with a report: the media is decoded again and only the
+    // active filters the report does not have are run (no thumbnails, no panels), their values are merged in the stats
+    // of the report (see CommonStats::Merge) before parsingCompleted(), frames matched by position so the report must
+    // have all the frames of its streams (not sampled, no parsing range); nothing is parsed if the report has all of them
+    static void Reanalysis_Set(bool Value);
+    static bool Reanalysis_Get();
+    // Milliseconds spent in each filter graph of the parser, by outputs of the graph ("stats+thumbnails+panel_0"...)
+    QMap<QString, qint64> filterTimes() const;
+    // Memory of each part of the file in bytes: stats columns (while parsed, as measured by the thread of each stream
+    // every 256 frames), thumbnails, panel frames, packets queued and buffers of the frames decoded and not filtered
+    // yet (see QAVPlayer::Counters); not the internal buffers of the decoders and of the filters
+    struct MemoryUsage
+    {
+        size_t                  Stats=0;
+        size_t                  Thumbnails=0;
+        size_t                  Panels=0;
+        size_t                  PacketQueues=0;
+        size_t                  DecodedFrames=0;
+
+        size_t                  Total() const {return Stats+Thumbnails+Panels+PacketQueues+DecodedFrames;}
+        // Human readable, in MB
+        QString                 Line() const;
+    };
+    MemoryUsage memoryUsage() const;
+    // Counters of the main parser (not of the segments parsed in parallel), for finding if the parsing is bound
+    // by reading, decoding or filtering; times are in milliseconds
+    struct ParsingCounters
+    {
+        struct Stream
+        {
+            int                 Index;
+            int                 Type;                   // 0 video, 1 audio
+            size_t              Frames;                 // With stats
+        };
+
+        qint64                  Elapsed=0;              // Since the parsing started
+        qint64                  DemuxedBytes=0;
+        quint64                 DemuxedPackets=0;
+        quint64                 VideoFrames=0;          // Decoded
+        qint64                  VideoDecodeTime=0;
+        quint64                 AudioFrames=0;
+        qint64                  AudioDecodeTime=0;
+        int                     VideoQueuePackets=0;
+        qint64                  VideoQueueBytes=0;
+        int                     AudioQueuePackets=0;
+        qint64                  AudioQueueBytes=0;
+        qint64                  DemuxerStallTime=0;     // Waiting for room in full queues (backpressure)
+        qint64                  DecoderStallTime=0;     // Waiting for packets
+        quint64                 FilterWaits=0;          // Filters waiting for another thread, see QAVPlayer::Counters
+        qint64                  ProbeTime=0;            // Finding the parameters of the streams, see FastProbe_Set
+        QMap<QString, qint64>   FilterTimes;            // See filterTimes()
+        quint64                 FrameBuffers=0;         // Planes of the video decoders of all files, see QAVPlayer::Allocations
+        quint64                 FrameBuffersReused=0;
+        qint64                  FrameBuffersBytes=0;
+        qint64                  FrameBuffersHugePagesBytes=0;
+        std::vector<Stream>     Streams;
+        MemoryUsage             Memory;
+
+        // Human readable, rates are since Previous if any, else since the parsing started
+        QStringList             Lines(const ParsingCounters* Previous=nullptr) const;
+    };
+    ParsingCounters parsingCounters() const;
+    // Encoders of the thumbnails and of the panels of the .qctools.mkv reports, see FFmpegVideoEncoder::Codec (empty means MJPEG)
+    static void ThumbnailsCodec_Set(const QString& Codec);
+    static QString ThumbnailsCodec_Get();
+    static void PanelsCodec_Set(const QString& Codec);
+    static QString PanelsCodec_Get();
+    // Stats of the .qctools.mkv reports written afterwards as a columns report (see StatsColumnsReport) instead of the
+    // .qctools.xml.gz one, stored as it is so it is memory mapped from the .qctools.mkv file when opened
+    static void MkvColumns_Set(bool Value);
+    static bool MkvColumns_Get();
+    // "-" writes the .qctools.xml.gz report to the standard output, "-.xml" the uncompressed XML
     void startExport(const QString& exportFileName = QString());
+    // Same with a .qctools.mkv report (see Export_QCTools_Mkv), exportCompleted() is emitted by both when the file is written
+    void startMkvExport(const QString& exportFileName);
+    static bool IsStdoutExport(const QString& exportFileName);
+
+    // Report written while parsing, then startExport() with the same file name only sends it
+    // Returns false if parsing is already finished
+    bool setStreamExport(const QString& exportFileName, const activefilters& filters);
+    // After setStreamExport, uploads the report in chunks while it is written, upload() of this name then waits for its end
+    bool uploadStreamExport(const QString& fileName);
+
+    // While parsing (one segment), frames parsed since the previous checkpoint with a time stamp before the one reached by
+    // all the streams, written as a report of this range (see appendStats) so a parsing stopped can be resumed from there
+    // The range ends before the last shot of the video started since the previous checkpoint, if any (see StatsShots)
+    // Returns the time stamp of the first frame not written, NaN if nothing is written
+    double writeCheckpoint(const QString& exportFileName, const activefilters& filters);
+
+    // Size of the decoded frames of the first video stream, see Lowres_Set, empty if there is no video stream
+    QSize decodedVideoSize() const;
+
+    // Stats of a report of the same media on a later range (see setParsingRange), appended after the current ones
+    // Frames up to the last time stamp of the current ones are skipped, streams and formats are the current ones
+    bool appendStats(FileInformation& Part, QString* Error = nullptr);
+
+    // Stats of a report of the same media on a range, fully parsed, replacing the frames of the sampled streams
+    // (see Sampling_Set) in this range, the streams not sampled are kept
+    bool spliceStats(FileInformation& Part, QString* Error = nullptr);
+
+    // Range of the next dumps below, e.g. a report of the problem part of a file only: frames of the reference stream from
+    // Start to End (excluded), as time stamps in seconds or frame numbers from 0, the frames of the other streams being the
+    // ones in the same time range; with panels, Start is moved back to the first frame of its panel, panels are not split
+    // Infinite Start and End (default) for the whole file. XML reports only, columnar and Arrow reports are written whole.
+    // Returns false if there is no frame in the range
+    bool setExportRange(double Start, double End, bool InFrames = false);
 
     // Dumps
     void                        Export_XmlGz                (const QString &ExportFileName, const activefilters& filters);
     void                        Export_QCTools_Mkv          (const QString &ExportFileName, const activefilters& filters);
-    void makeMkvReport(QString exportFileName, QByteArray attachment, QString attachmentFileName, const std::function<void(int, int)>& thumbnailsCallback = {}, const std::function<void(int, int)>& panelsCallback = {});
+    // Progress is called with the count of thumbnails and panel frames encoded and the total count
+    void makeMkvReport(QString exportFileName, QByteArray attachment, QString attachmentFileName, const std::function<void(int, int)>& progressCallback = {});
 
     size_t thumbnailsCount();
     // Infos
-    QAVVideoFrame getThumbnail(size_t pos);
+    // Level of the thumbnails of minSize pixels or more if any (see ThumbnailStore::Mipmap_Set), else the largest one
+    Thumbnail getThumbnail(size_t pos, int minSize = ThumbnailStore::Size);
+    // Key frames found by the preview (seconds from the start, byte offset or -1) by increasing time, see KeyFramePreview_Set()
+    QVector<QPair<double, qint64>> previewKeyFrames() const;
     QString	fileName() const;
 
     // extracted from FFMpeg_Glue
     int width() const;
     int height() const;
+    // Name of the decoder of the first video stream ("prores", "h264"...), empty if none
+    QString videoCodec() const;
     int bitsPerRawSample() const;
     double dar() const;
     std::string pixFormatName() const;
@@ -130,10 +479,10 @@ public:
     activealltracks             ActiveAllTracks;
 
     size_t                      ReferenceStream_Pos_Get     () const {return ReferenceStream_Pos;}
-    int                         Frames_Count_Get            (size_t Stats_Pos=(size_t)-1) const;
-    int                         Frames_Pos_Get              (size_t Stats_Pos=(size_t)-1);
+    int64_t                     Frames_Count_Get            (size_t Stats_Pos=(size_t)-1) const;
+    int64_t                     Frames_Pos_Get              (size_t Stats_Pos=(size_t)-1);
     QString                     Frame_Type_Get              (size_t Stats_Pos=(size_t)-1, size_t frameIndex = (size_t)-1) const;
-    void                        Frames_Pos_Set              (int Frames_Pos, size_t Stats_Pos=(size_t)-1);
+    void                        Frames_Pos_Set              (int64_t Frames_Pos, size_t Stats_Pos=(size_t)-1);
     void                        Frames_Pos_Minus            ();
     bool                        Frames_Pos_Plus             ();
     bool                        Frames_Pos_AtEnd            ();
@@ -184,6 +533,10 @@ public:
     QString signalServerUploadStatusErrorString() const;
 
     bool hasStats() const;
+    // Filters with values in the report opened, including the ones of its re-analysis once parsed (see Reanalysis_Set)
+    activefilters reportFilters() const;
+    // The stats of the report opened are completed by the parsing, see Reanalysis_Set
+    bool hasReanalysis() const;
 
     void setAutoCheckFileUploaded(bool enable);
     void setAutoUpload(bool enable);
@@ -196,13 +549,19 @@ public:
     void setExportFilters(const activefilters& exportFilters);
     bool commentsUpdated() const;
 
-    void readStats(QIODevice& StatsFromExternalData_FileName, bool StatsFromExternalData_FileName_IsCompressed);
+    // A columns report may be a part of the file, from ReportOffset and of ReportSize bytes (see StatsColumnsReport::Load)
+    void readStats(QIODevice& StatsFromExternalData_FileName, bool StatsFromExternalData_FileName_IsCompressed, const QString& ReportFileName = QString(), qint64 ReportOffset = 0, qint64 ReportSize = -1);
 
     QSize panelSize() const;
     const QMap<std::string, QVector<int>>& panelOutputsByTitle() const;
     const std::map<std::string, std::string> & getPanelOutputMetadata(size_t index) const;
     size_t getPanelFramesCount(size_t index) const;
-    QAVVideoFrame getPanelFrame(size_t index, size_t panelFrameIndex) const;
+    Thumbnail getPanelFrame(size_t index, size_t panelFrameIndex) const;
+
+    // Memory used by the stats, thumbnails and panel frames (only the thumbnails during the parsing), see MemoryBudget
+    size_t memoryBytes() const;
+    // Compresses the thumbnails, spills the panel frames and, once parsed, the stats columns to temporary files mapped back when read
+    void releaseMemory();
         
 public Q_SLOTS:
 
@@ -216,9 +575,11 @@ Q_SIGNALS:
     void positionChanged();
     void statsFileGenerated(SharedFile statsFile, const QString& name);
     void statsFileGenerationProgress(quint64 bytesWritten, quint64 totalBytes);
+    void exportCompleted(const QString& exportFileName);
 
     void statsFileLoaded(SharedFile statsFile);
     void parsingCompleted(bool success);
+    void opened(bool isValid);
 
     void signalServerCheckUploadedStatusChanged();
     void signalServerUploadProgressChanged(qint64, qint64);
@@ -230,38 +591,156 @@ private Q_SLOTS:
     void uploadDone();
     void parsingDone(bool success);
     void handleAutoUpload();
+    void parsingRangeEnded();
 
 private:
+    void createExportFile(const QString& ExportFileName, SharedFile& file, QString& name);
+    std::string Export_XmlHeader(const activefilters* Filters=nullptr); // With Filters, summaries of the items if the parsing is complete
+    std::string Export_XmlFooter();
+    std::string Export_XmlStreamsAndFormats();
+    void Export_FrameSizes();
+    // Frames of the stream Pos in the export range, all of them if there is none
+    void exportFrames(size_t Pos, size_t& Begin, size_t& End) const;
+    // Frames of the thumbnails then of each panel output in the export range, from first to second (excluded)
+    std::vector<std::pair<int64_t, int64_t>> exportPanelFrames() const;
+    void finishStreamExport();
+    void statsFromFrame(const QAVVideoFrame& frame, const SignalStatsKernel* kernel = nullptr, const FieldCompareKernel* fields = nullptr, const HdrLightKernel* hdr = nullptr);
+    void statsFromBranch(const QAVVideoFrame& frame, int branch);
+    void statsFromBranches(std::vector<QAVVideoFrame>& frames);
+    void statsFromBranches_Flush();
+    void statsFromDuplicate(const QAVVideoFrame& frame);
+    void panelBuilders_Flush();
+    void memoryPressure(CommonStats* stat, size_t index);
+    friend class ParsingScheduler;
+    void startParse_Now();
+    void endParse();
+    void parsingPriority_Set(QThread::Priority Priority);
+    bool parsingPausable(bool Paused) const;
+    void parsingPlayers_Pause(bool Paused);
+    void parsingThrottled_Set(bool Throttled);
+    void finishParse();
+    bool inParsingRange(const QAVFrame& frame);
+    void openStart(bool Async);
+    void openSource(QAVPlayer* Player, const QString& Source, void (FileInformation::*Next)());
+    void openStats();
+    void openStats_Finish();
+    void openMedia();
+    void openFinish();
+    bool isFollowed() const;
+
     JobTypes m_jobType;
 
     QString                     FileName;
     size_t                      ReferenceStream_Pos {0};
-    int                         Frames_Pos {0};
+    int64_t                     Frames_Pos {0};
 
     SignalServer* signalServer;
     QSharedPointer<CheckFileUploadedOperation> checkFileUploadedOperation;
     QSharedPointer<UploadFileOperation> uploadOperation;
+    QSharedPointer<ChunkedUploadFileOperation> m_streamExportUpload; // Final size set by finishStreamExport
 
     int m_index;
     QString m_exportFileName;
+    bool m_exportMkv { false };
     std::atomic<bool> m_parsed;
 
     bool m_autoCheckFileUploaded;
     bool m_autoUpload;
     bool m_hasStats;
+    StatsColumnsCache m_statsColumnsCache; // Memory used by Stats when loaded from the columns cache
     bool m_commentsUpdated;
     QSize m_panelSize;
 
     activefilters m_exportFilters;
 
+    QMutex m_streamExportMutex;
+    std::unique_ptr<StatsReportStream> m_streamExport;
+    bool m_streamExportClosed { false };
+    SharedFile m_streamExportFileOpened;
+    SharedFile m_streamExportFile; // Set once complete
+    QString m_streamExportFileName;
+    QString m_streamExportName;
+    std::vector<size_t> m_checkpointDone; // Per stream, count of frames in the checkpoints
+
+    std::unique_ptr<StatsSegmentParser> m_segmentParser;
+    std::function<StatsSegmentParser*(int Count)> m_segmentParserFactory; // Not set if the file can not be split
+    std::unique_ptr<PacketStatsParser> m_packetParser; // Set if the stats are from the packets only
+    std::unique_ptr<StatsProcessParser> m_processParser; // Set if the file is parsed by a helper process, see AnalysisProcess_Set
+    std::unique_ptr<StatsReanalysisParser> m_reanalysisParser; // Set if the stats of the report are completed, see Reanalysis_Set
+    int m_parsingSegments;
+    FrameSnapshots* m_frameSnapshots;
+    FrameFeed* m_frameFeed;
+    ThumbnailSprites* m_thumbnailSprites;
+    int m_sampling { 0 };
+    bool m_hasExportRange { false };
+    size_t m_exportRangeBegin { 0 }; // Frames of the reference stream
+    size_t m_exportRangeEnd { 0 };
+    bool m_hasParsingRange { false };
+    double m_parsingRangeStart { 0 };
+    double m_parsingRangeEnd { 0 };
+    QMutex m_parsingRangeMutex;
+    std::vector<bool> m_parsingRangeEndedStreams; // By stream index, a frame after the range came
+    std::atomic<bool> m_parsingRangeEnded { false };
+    bool m_parsing { false };
+    bool m_parsingPaused { false };
+    bool m_parsingThrottled { false }; // Held by ParsingScheduler while the user interacts, as a pause
+    QElapsedTimer m_parsingTimer;
+    qint64 m_parsingTime { 0 }; // Once finished
+
     QMap<std::string, QVector<int>> m_panelOutputsByTitle;
     QVector<std::map<std::string, std::string>> m_panelMetadata;
-    QVector<QVector<QAVVideoFrame>> m_panelFrames;
-
-    std::vector<QAVVideoFrame> m_thumbnails_frames;
+    std::vector<std::unique_ptr<PanelFrameStore>> m_panelFrames;
+    mutable QMutex m_panelFramesMutex;
+    std::map<int, std::unique_ptr<PanelBuilder>> m_panelBuilders; // By panel output index, for the panels built without their filter chain
+
+    // Load shed when the memory is short during the parsing, see MemoryPressure
+    std::unique_ptr<std::atomic<size_t>[]> m_memoryStatsBytes; // By stream index, from the thread of each stream, created with the filters
+    std::atomic<int> m_memoryStage { 0 }; // Highest stage reached
+    std::atomic<bool> m_memoryDropped { false }; // Panels not kept anymore
+    QMutex m_memoryMutex; // Footprint checked by one thread at a time
+
+    struct StatsBranchesFrames;
+    std::unique_ptr<StatsBranchesFrames> m_statsBranches;
+    std::map<int, std::unique_ptr<AudioStatsKernel>> m_audioKernels; // By stream index, created with the filters
+    std::map<int, std::vector<std::unique_ptr<AnalyzerStream>>> m_analyzers; // Of the analyzer plugins, by stream index, created with the filters
+    std::map<int, std::unique_ptr<CaptionsTimecode>> m_captionsTimecodes; // By stream index, created with the filters, see CaptionsTimecode_Set
+    std::map<int, QAVVideoFrame> m_lastStatsFrames; // Last frame of the stats not duplicated, by stream index, created with the filters, see FrameMemoization_Set
+    std::unique_ptr<StatsIngest> m_statsIngest; // Set if the stats are written by a thread of their own instead of the player threads, created with the filters
+
+    QString m_mkvReportFileName; // Set if opened from a .qctools.mkv report, its thumbnails and panels are copied by makeMkvReport
+    ThumbnailStore m_thumbnails;
+    std::unique_ptr<KeyFrameThumbnails> m_keyFrameThumbnails;
+    std::unique_ptr<ReportFrames> m_reportFrames; // Set if opened from a .qctools.mkv report, its thumbnails and panels are decoded on demand instead of m_thumbnails and m_panelFrames
 
     QAVPlayer* m_mediaParser { nullptr };
     QAVPlayer* m_mediaPlayer { nullptr };
+
+    // From the constructor to the end of the opening, the steps may be run from the event loop
+    struct OpenState
+    {
+        QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>> ActivePanels;
+        QString                 QCvaultFileNamePrefix;
+        bool                    Started { false };
+        bool                    Async { false };
+        bool                    Parse { true }; // Started once opened
+        QString                 StatsFromExternalData_FileName;
+        bool                    StatsFromExternalData_FileName_IsCompressed { false };
+        bool                    StatsFromExternalData_IsOpen { false };
+        QByteArray              Attachment;
+        bool                    AttachmentIsMapped { false }; // Columns report attached, read from the .qctools.mkv report directly
+        QString                 AttachmentFileName; // .qctools.mkv report, the attachment is read when the parser has opened it
+        QString                 MediaOrMkvReportFileName;
+        QString                 ParserSourceFileName;
+        QString                 ShortFileName;
+        int                     DpxOffset { -1 };
+        std::string             Trailer; // Of the report read progressively, parsed with its end
+        std::vector<CommonStats*> LateStats; // Streams of the report first seen once published, by stream index
+        bool                    ReportRead { false }; // Report read progressively, its end is not processed yet
+    };
+    std::unique_ptr<OpenState> m_open;
+    std::atomic<bool> m_opened { false };
+    std::atomic<bool> m_reportLoading { false }; // Report read progressively, from its publication to its end, see ProgressiveReports_Set
+    QFuture<void> m_openFuture;
 };
 
 #endif // GUI_FileInformation_H
@@ -0,0 +1,217 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/FilterGraphPlan.h"
+
+#include <QMap>
+
+//---------------------------------------------------------------------------
+// Splits the shareable start of a chain in filters and renames the link labels of the rest with Prefix
+static void Parse(const QString& Chain, const QString& Prefix, QStringList& Filters, QString& Rest)
+{
+    QString Current;
+    QString Label;
+    bool InQuotes=false;
+    bool InLabel=false;
+    bool Shareable=true;
+    for (int Pos=0; Pos<Chain.size(); Pos++)
+    {
+        QChar C=Chain[Pos];
+        if (C=='\\' && Pos+1<Chain.size())
+        {
+            (InLabel?Label:Current)+=C;
+            (InLabel?Label:Current)+=Chain[++Pos];
+            continue;
+        }
+        if (InLabel)
+        {
+            if (C==']')
+            {
+                Current+='['+Prefix+Label+']';
+                Label.clear();
+                InLabel=false;
+            }
+            else
+                Label+=C;
+            continue;
+        }
+        if (C=='\'')
+            InQuotes=!InQuotes;
+        else if (!InQuotes && C=='[')
+        {
+            Shareable=false;
+            InLabel=true;
+            continue;
+        }
+        else if (!InQuotes && C==';')
+            Shareable=false;
+        else if (!InQuotes && C==',' && Shareable)
+        {
+            if (!Current.trimmed().isEmpty())
+                Filters.append(Current.trimmed());
+            Current.clear();
+            continue;
+        }
+        Current+=C;
+    }
+
+    if (Shareable)
+    {
+        if (!Current.trimmed().isEmpty())
+            Filters.append(Current.trimmed());
+        Rest.clear();
+    }
+    else
+        Rest=Current.trimmed();
+}
+
+//---------------------------------------------------------------------------
+FilterGraphPlan::FilterGraphPlan(const QString& Split_) :
+    Split(Split_)
+{
+}
+
+//---------------------------------------------------------------------------
+FilterGraphPlan::~FilterGraphPlan()
+{
+}
+
+//---------------------------------------------------------------------------
+void FilterGraphPlan::Add(const QString& Chain, const QString& Output)
+{
+    QStringList Filters;
+    QString Rest;
+    Parse(Chain, QString("c%1_").arg(Chains.size()), Filters, Rest);
+    Chains.append(std::make_pair(Chain, Output));
+
+    node* Node=&Root;
+    for (const auto& Filter : Filters)
+    {
+        node* Next=nullptr;
+        for (const auto& Child : Node->Children)
+            if (Child->Filter==Filter)
+            {
+                Next=Child.get();
+                break;
+            }
+        if (!Next)
+        {
+            Node->Children.emplace_back(new node);
+            Next=Node->Children.back().get();
+            Next->Filter=Filter;
+        }
+        Node=Next;
+    }
+    Node->Ends.emplace_back(Rest, Output);
+}
+
+//---------------------------------------------------------------------------
+bool FilterGraphPlan::Empty() const
+{
+    return Chains.empty();
+}
+
+//---------------------------------------------------------------------------
+QString FilterGraphPlan::Combined() const
+{
+    if (Chains.size()<2)
+        return Separated().value(0);
+
+    QStringList Statements;
+    int Links=0;
+    Emit(Root, QString(), Statements, Links);
+    return Statements.join(';');
+}
+
+//---------------------------------------------------------------------------
+QList<QString> FilterGraphPlan::Separated() const
+{
+    QList<QString> Result;
+    for (const auto& Chain : Chains)
+        Result.append(QString("%1 [%2]").arg(Chain.first).arg(Chain.second));
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+// Filter added to a statement ending with a filter, or with a link label or nothing
+static QString Append(const QString& Statement, const QString& Filter)
+{
+    if (Statement.isEmpty() || Statement.endsWith(']'))
+        return Statement+Filter;
+    return Statement+','+Filter;
+}
+
+//---------------------------------------------------------------------------
+void FilterGraphPlan::Emit(const node& Node, const QString& Statement, QStringList& Statements, int& Links) const
+{
+    QString Null=Split=="asplit"?"anull":"null";
+
+    // A node with one child or end continues the statement, else the statement ends with a split feeding each of them
+    size_t Count=Node.Children.size()+Node.Ends.size();
+    if (Count==1)
+    {
+        if (!Node.Children.empty())
+            Emit(*Node.Children.front(), Append(Statement, Node.Children.front()->Filter), Statements, Links);
+        else
+        {
+            const auto& End=Node.Ends.front();
+            QString Rest=End.first.isEmpty() && (Statement.isEmpty() || Statement.endsWith(']'))?Null:End.first;
+            Statements.append(QString("%1 [%2]").arg(Rest.isEmpty()?Statement:Append(Statement, Rest)).arg(End.second));
+        }
+        return;
+    }
+
+    QString SplitStatement=Append(Statement, QString("%1=%2").arg(Split).arg(Count));
+    QStringList Inputs;
+    for (size_t Pos=0; Pos<Count; Pos++)
+    {
+        QString Link=QString("[s%1]").arg(Links++);
+        SplitStatement+=Link;
+        Inputs.append(Link);
+    }
+    Statements.append(SplitStatement);
+
+    int Pos=0;
+    for (const auto& Child : Node.Children)
+        Emit(*Child, Append(Inputs[Pos++], Child->Filter), Statements, Links);
+    for (const auto& End : Node.Ends)
+        Statements.append(QString("%1 [%2]").arg(Append(Inputs[Pos++], End.first.isEmpty()?Null:End.first)).arg(End.second));
+}
+
+//---------------------------------------------------------------------------
+QStringList FilterGraphPlan::Outputs(const QString& Desc)
+{
+    // Labels of the descriptions built here are not used as inputs, a label seen once is an output
+    QMap<QString, int> Counts;
+    QStringList Order;
+    bool InQuotes=false;
+    for (int Pos=0; Pos<Desc.size(); Pos++)
+    {
+        QChar C=Desc[Pos];
+        if (C=='\\')
+            Pos++;
+        else if (C=='\'')
+            InQuotes=!InQuotes;
+        else if (!InQuotes && C=='[')
+        {
+            int End=Desc.indexOf(']', Pos);
+            if (End<0)
+                break;
+            QString Label=Desc.mid(Pos+1, End-Pos-1);
+            if (!Counts.contains(Label))
+                Order.append(Label);
+            Counts[Label]++;
+            Pos=End;
+        }
+    }
+
+    QStringList Result;
+    for (const auto& Label : Order)
+        if (Counts[Label]==1)
+            Result.append(Label);
+    return Result;
+}
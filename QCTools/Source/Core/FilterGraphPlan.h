@@ -0,0 +1,60 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef FilterGraphPlan_H
+#define FilterGraphPlan_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Filter chains fed by the same decoded frames (stats, thumbnails, panels),
+// combined in one lavfi graph: the frame is sent once to the graph and the
+// filters at the start of several chains (e.g. "scale,format=rgb24" of the
+// tiled panels) are run once, their output is split to the rest of each
+// chain.
+//
+// Only the filters before the first link label or ";" of a chain are shared,
+// the link labels of each chain are renamed so the chains do not collide.
+class FilterGraphPlan
+{
+public:
+    // Split is "split" for video chains, "asplit" for audio chains
+    explicit                    FilterGraphPlan             (const QString& Split="split");
+                                ~FilterGraphPlan            ();
+
+    // Chain without its output label, Output is the name of the buffer sink (filterName() of the frames)
+    void                        Add                         (const QString& Chain, const QString& Output);
+    bool                        Empty                       () const;
+
+    // One graph with all the outputs, or the chains alone if there is only one
+    QString                     Combined                    () const;
+    // One graph per output, "chain [output]"
+    QList<QString>              Separated                   () const;
+
+    // Outputs of a graph description, as in Add()
+    static QStringList          Outputs                     (const QString& Desc);
+
+private:
+    struct node
+    {
+        QString                 Filter;
+        std::vector<std::unique_ptr<node>> Children;
+        std::vector<std::pair<QString, QString>> Ends;      // Rest of chain, output
+    };
+
+    void                        Emit                        (const node& Node, const QString& Statement, QStringList& Statements, int& Links) const;
+
+    QString                     Split;
+    node                        Root;
+    QList<std::pair<QString, QString>> Chains;              // As added, chain and output
+};
+
+#endif // FilterGraphPlan_H
@@ -1,5 +1,6 @@
 #include "Core/Core.h"
 #include "Core/FormatStats.h"
+#include "Core/StatsNumbers.h"
 
 extern "C"
 {
@@ -208,11 +209,11 @@ bool FormatStats::readFromXML(const char *Data, size_t Size)
 
             const char* nb_streams = format->Attribute("nb_streams");
             if(nb_streams)
-                setNb_streams(std::stoi(nb_streams));
+                setNb_streams(Number_ToInt(nb_streams));
 
             const char* nb_programs = format->Attribute("nb_programs");
             if(nb_programs)
-                setNb_programs(std::stoi(nb_programs));
+                setNb_programs(Number_ToInt(nb_programs));
 
             const char* format_name = format->Attribute("format_name");
             if(format_name)
@@ -232,15 +233,15 @@ bool FormatStats::readFromXML(const char *Data, size_t Size)
 
             const char* size = format->Attribute("size");
             if(size && !isNotAvailable(size))
-                setSize(std::stoi(size));
+                setSize(Number_ToInt(size));
 
             const char* bit_rate = format->Attribute("bit_rate");
             if(bit_rate && !isNotAvailable(bit_rate))
-                setBit_rate(std::stoi(bit_rate));
+                setBit_rate(Number_ToInt(bit_rate));
 
             const char* probe_score = format->Attribute("probe_score");
             if(probe_score)
-                setProbe_score(std::stoi(probe_score));
+                setProbe_score(Number_ToInt(probe_score));
 
             XMLElement* Tag=format->FirstChildElement();
             while (Tag)
@@ -0,0 +1,89 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/FrameFeed.h"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+FrameFeed::FrameFeed(const QString& Directory_, double Interval_, int Width_)
+: Directory(Directory_),
+  Interval(Interval_>0?Interval_:1),
+  Width(Width_>0?Width_:640)
+{
+    QDir().mkpath(Directory);
+}
+
+//***************************************************************************
+// Info
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// First frame, then the first one at least Interval after the last one selected; not upscaled
+QString FrameFeed::Chain() const
+{
+    return QString("select='isnan(prev_selected_t)+gte(t-prev_selected_t,%1)',scale=w='min(%2,iw)':h=-2,format=gray")
+        .arg(Interval, 0, 'g', 17)
+        .arg(Width);
+}
+
+//---------------------------------------------------------------------------
+size_t FrameFeed::Count() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Written;
+}
+
+//***************************************************************************
+// Output
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool FrameFeed::Write(const QAVVideoFrame& Frame)
+{
+    const AVFrame* Data=Frame.frame();
+    if (!Data || Data->format!=AV_PIX_FMT_GRAY8 || Data->width<=0 || Data->height<=0)
+        return false;
+
+    double Time=Frame.pts();
+    QString Name=Directory+QString("/s%1_t%2.pgm").arg(Frame.stream().index()).arg((qint64)std::llround(std::max(Time, 0.0)*1000), 10, 10, QChar('0'));
+    QByteArray Header=QString("P5\n# pts %1\n%2 %3\n255\n").arg(Time, 0, 'f', 6).arg(Data->width).arg(Data->height).toLatin1();
+
+    QFile File(Name+".tmp");
+    bool Result=File.open(QIODevice::WriteOnly) && File.write(Header)==Header.size();
+    for (int y=0; Result && y<Data->height; y++)
+        Result=File.write((const char*)Data->data[0]+(ptrdiff_t)y*Data->linesize[0], Data->width)==Data->width;
+    File.close();
+    if (Result)
+    {
+        QFile::remove(Name);
+        Result=File.rename(Name);
+    }
+    if (!Result)
+    {
+        File.remove();
+        return false;
+    }
+
+    QMutexLocker Locker(&Mutex);
+    Written++;
+    return true;
+}
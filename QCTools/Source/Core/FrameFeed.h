@@ -0,0 +1,50 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef FrameFeed_H
+#define FrameFeed_H
+
+#include <QtAVPlayer/qavvideoframe.h>
+
+#include <QMutex>
+#include <QString>
+#include <cstddef>
+
+//---------------------------------------------------------------------------
+// Downscaled grayscale frames written during the parsing, one by interval of
+// time of each video stream, for the tools working on sampled frames (e.g.
+// text detection by OCR) without decoding the file again.
+//
+// The frames come from an output of the graph of the stats, selected and
+// scaled by the filters. Each one is a binary PGM file
+// "<directory>/s<stream>_t<milliseconds>.pgm", the time stamp of the frame
+// also in a "# pts <seconds>" comment of the header; files are written under
+// another name then renamed, a file with the final name is complete.
+class FrameFeed
+{
+public:
+    // Interval in seconds between two frames of a stream, Width the maximum width (height keeps the ratio)
+                                FrameFeed                   (const QString& Directory, double Interval, int Width);
+
+    // Filter chain of the output of the graph
+    QString                     Chain                       () const;
+
+    // From the parser threads, frame of Chain()
+    bool                        Write                       (const QAVVideoFrame& Frame);
+
+    size_t                      Count                       () const;
+
+private:
+    QString                     Directory;
+    double                      Interval;
+    int                         Width;
+
+    mutable QMutex              Mutex;
+    size_t                      Written=0;
+};
+
+#endif // FrameFeed_H
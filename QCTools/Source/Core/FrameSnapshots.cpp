@@ -0,0 +1,216 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/FrameSnapshots.h"
+#include "Core/CommonStats.h"
+#include "Core/Core.h"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+FrameSnapshots::FrameSnapshots(const QString& Directory_, const QString& Format_)
+: Directory(Directory_),
+  Format(Format_.toLower()=="png"?"png":"jpg")
+{
+    QDir().mkpath(Directory);
+}
+
+//---------------------------------------------------------------------------
+void FrameSnapshots::AddTime(double Time)
+{
+    Times.insert(std::upper_bound(Times.begin(), Times.end(), Time), Time);
+}
+
+//---------------------------------------------------------------------------
+void FrameSnapshots::AddTrigger(const std::string& Key, bool HasMin, double Min, bool HasMax, double Max)
+{
+    if (HasMin || HasMax)
+        Triggers.push_back({Key, HasMin, Min, HasMax, Max});
+}
+
+//***************************************************************************
+// Info
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+QString FrameSnapshots::FileName(size_t Stream, size_t Frame) const
+{
+    return Directory+QString("/s%1_f%2.").arg(Stream).arg(Frame)+Format;
+}
+
+//---------------------------------------------------------------------------
+size_t FrameSnapshots::Count() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Written;
+}
+
+//***************************************************************************
+// Parsing
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void FrameSnapshots::FromDecodedFrame(const QAVVideoFrame& Frame)
+{
+    size_t Stream=Frame.stream().index();
+    double Time=Frame.pts();
+    size_t FramePos=(size_t)-1;
+    {
+        QMutexLocker Locker(&Mutex);
+        auto& State=Streams[Stream];
+
+        // Stills asked before this frame came, older ones will never come (not the same time stamps)
+        auto Pending=State.Pending.find(Time);
+        if (Pending!=State.Pending.end())
+            FramePos=Pending->second;
+        State.Pending.erase(State.Pending.begin(), State.Pending.upper_bound(Time));
+
+        State.Decoded.push_back(Frame);
+        if (State.Decoded.size()>Decoded_Max)
+            State.Decoded.pop_front();
+    }
+
+    if (FramePos!=(size_t)-1)
+        Write(Frame, Stream, FramePos);
+}
+
+//---------------------------------------------------------------------------
+void FrameSnapshots::FromStats(const QAVVideoFrame& StatsFrame, CommonStats& Stats, size_t Stream)
+{
+    if (!Stats.x_Current)
+        return;
+    size_t FramePos=Stats.x_Current-1;
+    double Time=StatsFrame.pts();
+    double Duration=Stats.durations[FramePos];
+
+    QAVVideoFrame Frame;
+    {
+        QMutexLocker Locker(&Mutex);
+        auto& State=Streams[Stream];
+
+        if (!State.Items_Set)
+        {
+            const struct stream_info& StreamInfo=PerStreamType[Stats.Type_Get()];
+            State.Items.assign(Triggers.size(), (size_t)-1);
+            State.Outside.assign(Triggers.size(), false);
+            for (size_t Pos=0; Pos<Triggers.size(); ++Pos)
+                for (size_t Item=0; Item<StreamInfo.CountOfItems; ++Item)
+                    if (StreamInfo.PerItem[Item].FFmpeg_Name && Triggers[Pos].Key==StreamInfo.PerItem[Item].FFmpeg_Name)
+                    {
+                        State.Items[Pos]=Item;
+                        break;
+                    }
+            State.Items_Set=true;
+        }
+
+        // Times up to the end of this frame, the ones before the first frame are for the first frame
+        bool Needed=false;
+        while (State.Times_Next<Times.size() && Times[State.Times_Next]<Time+Duration)
+        {
+            State.Times_Next++;
+            Needed=true;
+        }
+
+        // First frame of a range out of the bounds, same rules as StatsThresholds
+        for (size_t Pos=0; Pos<Triggers.size(); ++Pos)
+        {
+            if (State.Items[Pos]==(size_t)-1)
+                continue;
+            double Value=Stats.y[State.Items[Pos]][FramePos];
+            if (!std::isfinite(Value))
+                continue;
+
+            const trigger& Trigger=Triggers[Pos];
+            bool Outside=(Trigger.HasMin && Value<Trigger.Min) || (Trigger.HasMax && Value>Trigger.Max);
+            if (Outside && !State.Outside[Pos])
+                Needed=true;
+            State.Outside[Pos]=Outside;
+        }
+
+        if (!Needed)
+            return;
+
+        auto Decoded=std::find_if(State.Decoded.begin(), State.Decoded.end(), [&](const QAVVideoFrame& Item) { return Item.pts()==Time; });
+        if (Decoded!=State.Decoded.end())
+            Frame=*Decoded;
+        else
+            State.Pending[Time]=FramePos;
+    }
+
+    if (Frame)
+        Write(Frame, Stream, FramePos);
+}
+
+//***************************************************************************
+// Output
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Encoded with FFmpeg, the library has no image encoder of its own
+bool FrameSnapshots::Write(const QAVVideoFrame& Frame, size_t Stream, size_t FramePos)
+{
+    bool IsPng=Format=="png";
+    AVPixelFormat PixelFormat=IsPng?AV_PIX_FMT_RGB24:AV_PIX_FMT_YUVJ420P;
+    QAVVideoFrame Converted=Frame.format()==PixelFormat?Frame:Frame.convertTo(PixelFormat);
+    if (!Converted)
+        return false;
+
+    const AVCodec* Codec=avcodec_find_encoder(IsPng?AV_CODEC_ID_PNG:AV_CODEC_ID_MJPEG);
+    if (!Codec)
+        return false;
+    AVCodecContext* Context=avcodec_alloc_context3(Codec);
+    if (!Context)
+        return false;
+    Context->width=Converted.size().width();
+    Context->height=Converted.size().height();
+    Context->pix_fmt=PixelFormat;
+    Context->time_base={1, 25};
+    if (!IsPng)
+    {
+        // Fixed quality, as "ffmpeg -q:v 2"
+        Context->flags|=AV_CODEC_FLAG_QSCALE;
+        Context->global_quality=FF_QP2LAMBDA*2;
+        Converted.frame()->quality=Context->global_quality;
+        Context->color_range=AVCOL_RANGE_JPEG;
+    }
+
+    bool Result=false;
+    AVPacket* Packet=av_packet_alloc();
+    if (Packet
+     && avcodec_open2(Context, Codec, nullptr)>=0
+     && avcodec_send_frame(Context, Converted.frame())>=0
+     && avcodec_send_frame(Context, nullptr)>=0
+     && avcodec_receive_packet(Context, Packet)>=0)
+    {
+        QFile File(FileName(Stream, FramePos));
+        Result=File.open(QIODevice::WriteOnly) && File.write((const char*)Packet->data, Packet->size)==Packet->size;
+    }
+    av_packet_free(&Packet);
+    avcodec_free_context(&Context);
+
+    if (Result)
+    {
+        QMutexLocker Locker(&Mutex);
+        Written++;
+    }
+    return Result;
+}
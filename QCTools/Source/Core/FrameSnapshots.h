@@ -0,0 +1,85 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef FrameSnapshots_H
+#define FrameSnapshots_H
+
+#include <QtAVPlayer/qavvideoframe.h>
+
+#include <QMutex>
+#include <QString>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Full resolution stills written during the parsing, of the frames at some
+// times and of the first frame of each range of frames out of the bounds of
+// a metric, so issues don't need a second decoding for their screenshot.
+//
+// The stats frames may be scaled or split by the filters, so the decoded
+// frames come from their own output of the graph and the last ones of each
+// stream are kept in a ring, matched by their time stamp with the frames of
+// the stats. A frame asked before its decoded frame came is written when it
+// comes.
+class FrameSnapshots
+{
+public:
+    // Format is "jpg" or "png"
+                                FrameSnapshots              (const QString& Directory, const QString& Format);
+
+    // Before the parsing
+    void                        AddTime                     (double Time);  // Presentation time in seconds, as in the reports
+    void                        AddTrigger                  (const std::string& Key, bool HasMin, double Min, bool HasMax, double Max);
+
+    // Name of the still of a frame, "<directory>/s<stream>_f<frame>.<format>", it exists only if written
+    QString                     FileName                    (size_t Stream, size_t Frame) const;
+    size_t                      Count                       () const;
+
+    // From the parser threads
+    void                        FromDecodedFrame            (const QAVVideoFrame& Frame);
+    void                        FromStats                   (const QAVVideoFrame& StatsFrame, CommonStats& Stats, size_t Stream);
+
+private:
+    struct trigger
+    {
+        std::string             Key;
+        bool                    HasMin;
+        double                  Min;
+        bool                    HasMax;
+        double                  Max;
+    };
+
+    struct stream_state
+    {
+        std::deque<QAVVideoFrame> Decoded;                  // Last ones
+        std::map<double, size_t> Pending;                   // By time stamp, frame of the still
+        size_t                  Times_Next=0;
+        std::vector<size_t>     Items;                      // By trigger, (size_t)-1 if not found
+        std::vector<bool>       Outside;                    // By trigger
+        bool                    Items_Set=false;
+    };
+
+    bool                        Write                       (const QAVVideoFrame& Frame, size_t Stream, size_t FramePos);
+
+    static const size_t         Decoded_Max=8;
+
+    QString                     Directory;
+    QString                     Format;
+    std::vector<double>         Times;                      // Sorted
+    std::vector<trigger>        Triggers;
+
+    mutable QMutex              Mutex;
+    std::map<size_t, stream_state> Streams;
+    size_t                      Written=0;
+};
+
+#endif // FrameSnapshots_H
@@ -0,0 +1,226 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/GrowingFileDevice.h"
+
+#include <QtAVPlayer/qaviodevice.h>
+#include <QMetaObject>
+#include <QMutex>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Defaults
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static std::atomic<bool> Enabled(false);
+static std::atomic<int> Default_Idle(30000);
+static QMutex Sentinel_Mutex;
+static QString Sentinel(".done");
+
+// Interval of the size checks while waiting
+static const int Poll_Interval=250;
+
+//---------------------------------------------------------------------------
+void GrowingFileDevice::Enabled_Set(bool Value)
+{
+    Enabled=Value;
+}
+
+//---------------------------------------------------------------------------
+bool GrowingFileDevice::Enabled_Get()
+{
+    return Enabled;
+}
+
+//---------------------------------------------------------------------------
+void GrowingFileDevice::Idle_Set(int Idle)
+{
+    Default_Idle=std::max(Idle, Poll_Interval);
+}
+
+//---------------------------------------------------------------------------
+int GrowingFileDevice::Idle_Get()
+{
+    return Default_Idle;
+}
+
+//---------------------------------------------------------------------------
+void GrowingFileDevice::Sentinel_Set(const QString& Suffix)
+{
+    QMutexLocker Locker(&Sentinel_Mutex);
+    Sentinel=Suffix;
+}
+
+//---------------------------------------------------------------------------
+QString GrowingFileDevice::Sentinel_Get()
+{
+    QMutexLocker Locker(&Sentinel_Mutex);
+    return Sentinel;
+}
+
+//---------------------------------------------------------------------------
+bool GrowingFileDevice::IsDone(const QString& FileName)
+{
+    auto Suffix=Sentinel_Get();
+    return !Suffix.isEmpty() && QFile::exists(FileName+Suffix);
+}
+
+//---------------------------------------------------------------------------
+// Thread of the devices, for the life of the process
+struct follow_thread
+{
+    QThread Thread;
+
+    follow_thread()
+    {
+        Thread.setObjectName("follow");
+        Thread.start();
+    }
+    ~follow_thread()
+    {
+        Thread.quit();
+        Thread.wait();
+    }
+};
+
+//---------------------------------------------------------------------------
+QSharedPointer<QAVIODevice> GrowingFileDevice::Create(const QString& FileName)
+{
+    QSharedPointer<GrowingFileDevice> Device(new GrowingFileDevice(FileName), &QObject::deleteLater);
+    if (!Device->open(QIODevice::ReadOnly))
+        return {};
+
+    static follow_thread Thread;
+    QSharedPointer<QAVIODevice> IODevice(new QAVIODevice(Device), &QObject::deleteLater);
+    Device->moveToThread(&Thread.Thread);
+    IODevice->moveToThread(&Thread.Thread);
+    return IODevice;
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+GrowingFileDevice::GrowingFileDevice(const QString& FileName_)
+: FileName(FileName_),
+  File(FileName_),
+  Timer(this),
+  Idle(Default_Idle)
+{
+    Timer.setSingleShot(true);
+    Timer.setInterval(Poll_Interval);
+    connect(&Timer, &QTimer::timeout, this, &GrowingFileDevice::Poll);
+}
+
+//---------------------------------------------------------------------------
+GrowingFileDevice::~GrowingFileDevice()
+{
+    close();
+}
+
+//***************************************************************************
+// QIODevice
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool GrowingFileDevice::open(OpenMode Mode)
+{
+    if (isOpen() || (Mode&WriteOnly))
+        return false;
+
+    if (!File.open(QIODevice::ReadOnly|QIODevice::Unbuffered))
+    {
+        setErrorString(File.errorString());
+        return false;
+    }
+    Grown_Size=File.size();
+    Grown.start();
+    Done=IsDone(FileName);
+
+    // Not buffered again by QIODevice
+    return QIODevice::open(Mode|Unbuffered);
+}
+
+//---------------------------------------------------------------------------
+void GrowingFileDevice::close()
+{
+    Timer.stop();
+    File.close();
+    QIODevice::close();
+}
+
+//---------------------------------------------------------------------------
+qint64 GrowingFileDevice::size() const
+{
+    // Written so far
+    return File.size();
+}
+
+//---------------------------------------------------------------------------
+bool GrowingFileDevice::seek(qint64 Pos)
+{
+    if (Pos<0 || Pos>File.size())
+        return false;
+    return QIODevice::seek(Pos);
+}
+
+//---------------------------------------------------------------------------
+bool GrowingFileDevice::atEnd() const
+{
+    return Done && pos()>=File.size();
+}
+
+//---------------------------------------------------------------------------
+qint64 GrowingFileDevice::readData(char* Data, qint64 MaxSize)
+{
+    if (!File.seek(pos()))
+        return -1;
+    qint64 Read=File.read(Data, MaxSize);
+    if (Read)
+        return Read;
+
+    // QAVIODevice waits for more bytes when nothing is read, they are polled
+    if (Done)
+        QMetaObject::invokeMethod(this, [this]() {Q_EMIT readyRead();}, Qt::QueuedConnection);
+    else if (!Timer.isActive())
+        Timer.start();
+    return 0;
+}
+
+//***************************************************************************
+// Polling
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void GrowingFileDevice::Poll()
+{
+    if (!isOpen())
+        return;
+
+    // The sentinel is checked before the size, the last bytes are written before it
+    bool Sentinel=IsDone(FileName);
+    qint64 Size=File.size();
+    if (Sentinel)
+        Done=true;
+    else if (Size!=Grown_Size)
+    {
+        Grown_Size=Size;
+        Grown.start();
+    }
+    else if (Grown.elapsed()>=Idle)
+        Done=true;
+
+    if (Done || pos()<Size)
+        Q_EMIT readyRead();
+    else
+        Timer.start();
+}
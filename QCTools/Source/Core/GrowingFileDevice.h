@@ -0,0 +1,80 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef GrowingFileDevice_H
+#define GrowingFileDevice_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QIODevice>
+#include <QSharedPointer>
+#include <QString>
+#include <QTimer>
+
+class QAVIODevice;
+
+//---------------------------------------------------------------------------
+// File still being written (a feed recorded by an ingest server, qcli
+// --follow), read by the parser past its current end: once the bytes
+// written so far are read, the reader waits for more, polling the size of
+// the file, and the end is the one of the file when the writer is done.
+//
+// The writer is done when the sentinel file (the name of the file followed by
+// the sentinel suffix, ".done" by default) exists, or when the file did not
+// grow for the idle time (30 s by default). Seeks keep working within the
+// bytes already written, not after them (index or footer at the end of the
+// file, read once the file is done if the demuxer needs them).
+//
+// The waits do not block: nothing is read, and readyRead is emitted once the
+// file grew, so QAVIODevice and the stop of the parser are not held.
+class GrowingFileDevice : public QIODevice
+{
+public:
+                                GrowingFileDevice           (const QString& FileName);
+                                ~GrowingFileDevice          ();
+
+    // Parsers of the files opened afterwards follow them (see FileInformation)
+    static void                 Enabled_Set                 (bool Value);
+    static bool                 Enabled_Get                 ();
+    // Milliseconds without growing after which the writer is done
+    static void                 Idle_Set                    (int Idle);
+    static int                  Idle_Get                    ();
+    // Suffix of the sentinel file
+    static void                 Sentinel_Set                (const QString& Suffix);
+    static QString              Sentinel_Get                ();
+    // Sentinel of FileName exists
+    static bool                 IsDone                      (const QString& FileName);
+
+    // Device for the parser of a local file, null if it can not be opened
+    // QAVIODevice reads in the thread of its object, so the devices live in a thread of their own, as ReadaheadDevice
+    static QSharedPointer<QAVIODevice> Create               (const QString& FileName);
+
+    // QIODevice
+    bool                        open                        (OpenMode Mode) override;
+    void                        close                       () override;
+    bool                        isSequential                () const override {return false;}
+    qint64                      size                        () const override;
+    bool                        seek                        (qint64 Pos) override;
+    bool                        atEnd                       () const override;
+
+protected:
+    qint64                      readData                    (char* Data, qint64 MaxSize) override;
+    qint64                      writeData                   (const char*, qint64) override {return -1;}
+
+private:
+    void                        Poll                        ();
+
+    QString                     FileName;
+    QFile                       File;
+    QTimer                      Timer;
+    QElapsedTimer               Grown;                      // Since the file last grew
+    qint64                      Grown_Size=0;
+    int                         Idle;
+    bool                        Done=false;
+};
+
+#endif // GrowingFileDevice_H
@@ -0,0 +1,285 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/HdrLightKernel.h"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+#include <libavutil/mastering_display_metadata.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
+#include <cmath>
+
+//---------------------------------------------------------------------------
+static const char* const Names[HdrLightKernel::Value_Max]=
+{
+    "qctools.hdr.max_light",
+    "qctools.hdr.avg_light",
+    "qctools.hdr.over_peak",
+};
+
+// Planar formats up to 12-bit, the others are converted by the format filter
+static const char* const FormatNames=
+    "gray|gray10|gray12|"
+    "yuv444p|yuv422p|yuv420p|yuv440p|"
+    "yuvj444p|yuvj422p|yuvj420p|yuvj440p|"
+    "yuv444p10|yuv422p10|yuv420p10|"
+    "yuv444p12|yuv422p12|yuv420p12";
+
+static const AVPixelFormat Formats_List[]=
+{
+    AV_PIX_FMT_GRAY8, AV_PIX_FMT_GRAY10, AV_PIX_FMT_GRAY12,
+    AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV440P,
+    AV_PIX_FMT_YUVJ444P, AV_PIX_FMT_YUVJ422P, AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_YUVJ440P,
+    AV_PIX_FMT_YUV444P10, AV_PIX_FMT_YUV422P10, AV_PIX_FMT_YUV420P10,
+    AV_PIX_FMT_YUV444P12, AV_PIX_FMT_YUV422P12, AV_PIX_FMT_YUV420P12,
+};
+
+// Entries of the transfer tables, interpolated between them
+static const int Light_Size=4096;
+
+enum transfer
+{
+    Transfer_SDR,
+    Transfer_PQ,
+    Transfer_HLG,
+};
+
+//***************************************************************************
+// Transfers
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// SMPTE ST 2084 EOTF, nits
+static double PQ_EOTF(double V)
+{
+    static const double m1=2610.0/16384;
+    static const double m2=2523.0/4096*128;
+    static const double c1=3424.0/4096;
+    static const double c2=2413.0/4096*32;
+    static const double c3=2392.0/4096*32;
+
+    double P=std::pow(V, 1/m2);
+    return 10000*std::pow(std::max(P-c1, 0.0)/(c2-c3*P), 1/m1);
+}
+
+//---------------------------------------------------------------------------
+// ARIB STD-B67 inverse OETF, normalized scene light
+static double HLG_InverseOETF(double V)
+{
+    static const double a=0.17883277;
+    static const double b=0.28466892;
+    static const double c=0.55991073;
+
+    if (V<=0.5)
+        return V*V/3;
+    return (std::exp((V-c)/a)+b)/12;
+}
+
+//---------------------------------------------------------------------------
+static inline float Lookup(const std::vector<float>& Table, float Value)
+{
+    Value=std::min(std::max(Value, 0.0f), 1.0f)*Light_Size;
+    int i=(int)Value;
+    if (i>=Light_Size)
+        return Table[Light_Size];
+    return Table[i]+(Table[i+1]-Table[i])*(Value-i);
+}
+
+//***************************************************************************
+// Info
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const char* HdrLightKernel::Name(value Value)
+{
+    return Value<Value_Max?Names[Value]:"";
+}
+
+//---------------------------------------------------------------------------
+const char* HdrLightKernel::Formats()
+{
+    return FormatNames;
+}
+
+//---------------------------------------------------------------------------
+bool HdrLightKernel::Supports(int Format)
+{
+    return std::find(std::begin(Formats_List), std::end(Formats_List), (AVPixelFormat)Format)!=std::end(Formats_List);
+}
+
+//---------------------------------------------------------------------------
+double HdrLightKernel::Get(value Value) const
+{
+    return Value<Value_Max?Values[Value]:0;
+}
+
+//***************************************************************************
+// Compute
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool HdrLightKernel::Compute(const AVFrame* Frame)
+{
+    if (!Frame || !Supports(Frame->format) || Frame->width<=0 || Frame->height<=0)
+        return false;
+    auto Desc=av_pix_fmt_desc_get((AVPixelFormat)Frame->format);
+    if (!Desc)
+        return false;
+
+    int Depth=Desc->comp[0].depth;
+    bool Full=Frame->color_range==AVCOL_RANGE_JPEG
+        || Frame->format==AV_PIX_FMT_YUVJ420P || Frame->format==AV_PIX_FMT_YUVJ422P || Frame->format==AV_PIX_FMT_YUVJ444P || Frame->format==AV_PIX_FMT_YUVJ440P;
+    Tables(Frame, Depth, Full);
+
+    bool Gray=Desc->nb_components==1;
+    if (Depth>8)
+        Compute<uint16_t>(Frame, Desc->log2_chroma_w, Desc->log2_chroma_h, Gray);
+    else
+        Compute<uint8_t>(Frame, Desc->log2_chroma_w, Desc->log2_chroma_h, Gray);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void HdrLightKernel::Tables(const AVFrame* Frame, int Depth, bool Full)
+{
+    int Transfer;
+    switch (Frame->color_trc)
+    {
+        case AVCOL_TRC_SMPTE2084    : Transfer=Transfer_PQ; break;
+        case AVCOL_TRC_ARIB_STD_B67 : Transfer=Transfer_HLG; break;
+        default                     : Transfer=Transfer_SDR;
+    }
+
+    // Matrix of BT.2020 for HDR without one, of the size of the frame else
+    int Matrix=Frame->colorspace;
+    if (Matrix==AVCOL_SPC_BT2020_CL)
+        Matrix=AVCOL_SPC_BT2020_NCL;
+    if (Matrix==AVCOL_SPC_SMPTE170M)
+        Matrix=AVCOL_SPC_BT470BG;
+    if (Matrix!=AVCOL_SPC_BT2020_NCL && Matrix!=AVCOL_SPC_BT709 && Matrix!=AVCOL_SPC_BT470BG && Matrix!=AVCOL_SPC_SMPTE240M)
+        Matrix=Transfer!=Transfer_SDR?AVCOL_SPC_BT2020_NCL:(Frame->height>576?AVCOL_SPC_BT709:AVCOL_SPC_BT470BG);
+
+    if (Transfer!=Tables_Transfer)
+    {
+        Light.resize(Light_Size+1);
+        for (int i=0; i<=Light_Size; i++)
+        {
+            double V=(double)i/Light_Size;
+            switch (Transfer)
+            {
+                case Transfer_PQ    : Light[i]=(float)PQ_EOTF(V); break;
+                case Transfer_HLG   : Light[i]=(float)HLG_InverseOETF(V); break;
+                default             : Light[i]=(float)(100*std::pow(V, 2.4));
+            }
+        }
+        Hlg=Transfer==Transfer_HLG;
+        Tables_Transfer=Transfer;
+    }
+
+    if (Depth==Tables_Depth && Matrix==Tables_Matrix && Full==Tables_Full)
+        return;
+
+    switch (Matrix)
+    {
+        case AVCOL_SPC_BT2020_NCL   : Kr=0.2627f; Kb=0.0593f; break;
+        case AVCOL_SPC_BT709        : Kr=0.2126f; Kb=0.0722f; break;
+        case AVCOL_SPC_SMPTE240M    : Kr=0.212f;  Kb=0.087f;  break;
+        default                     : Kr=0.299f;  Kb=0.114f;
+    }
+    float Kg=1-Kr-Kb;
+
+    int Size=1<<Depth;
+    int Shift=Depth-8;
+    float Y_Offset=Full?0:(float)(16<<Shift);
+    float Y_Range=Full?(float)(Size-1):(float)(219<<Shift);
+    float C_Offset=(float)(Size/2);
+    float C_Range=Full?(float)(Size-1):(float)(224<<Shift);
+    Luma.resize(Size);
+    Cr_R.resize(Size);
+    Cr_G.resize(Size);
+    Cb_G.resize(Size);
+    Cb_B.resize(Size);
+    for (int i=0; i<Size; i++)
+    {
+        float Y=(i-Y_Offset)/Y_Range;
+        float C=(i-C_Offset)/C_Range;
+        Luma[i]=Y;
+        Cr_R[i]=2*(1-Kr)*C;
+        Cb_B[i]=2*(1-Kb)*C;
+        Cr_G[i]=2*(1-Kr)*Kr/Kg*C;
+        Cb_G[i]=2*(1-Kb)*Kb/Kg*C;
+    }
+    Tables_Depth=Depth;
+    Tables_Matrix=Matrix;
+    Tables_Full=Full;
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+void HdrLightKernel::Compute(const AVFrame* Frame, int HSub, int VSub, bool Gray)
+{
+    double Peak=Tables_Transfer==Transfer_SDR?100:1000;
+    if (auto SideData=av_frame_get_side_data(Frame, AV_FRAME_DATA_MASTERING_DISPLAY_METADATA))
+    {
+        auto Mastering=(const AVMasteringDisplayMetadata*)SideData->data;
+        if (Mastering->has_luminance && Mastering->max_luminance.den && av_q2d(Mastering->max_luminance)>0)
+            Peak=av_q2d(Mastering->max_luminance);
+    }
+
+    const int Mask=(int)Luma.size()-1;
+    const float Peak_Light=(float)Peak;
+    const float Kg=1-Kr-Kb;
+    float Max=0;
+    double Sum=0;
+    uint64_t Over=0;
+    for (int y=0; y<Frame->height; y++)
+    {
+        const T* Y_Line=(const T*)(Frame->data[0]+y*Frame->linesize[0]);
+        const T* Cb_Line=Gray?nullptr:(const T*)(Frame->data[1]+(y>>VSub)*Frame->linesize[1]);
+        const T* Cr_Line=Gray?nullptr:(const T*)(Frame->data[2]+(y>>VSub)*Frame->linesize[2]);
+        double Line_Sum=0;
+        for (int x=0; x<Frame->width; x++)
+        {
+            float Y=Luma[Y_Line[x]&Mask];
+            float R=Y, G=Y, B=Y;
+            if (!Gray)
+            {
+                int Cb=Cb_Line[x>>HSub]&Mask;
+                int Cr=Cr_Line[x>>HSub]&Mask;
+                R=Y+Cr_R[Cr];
+                G=Y-Cb_G[Cb]-Cr_G[Cr];
+                B=Y+Cb_B[Cb];
+            }
+
+            float Value;
+            if (Hlg)
+            {
+                // Scene light to the 1000 nits display, OOTF with a system gamma of 1.2
+                float Rs=Lookup(Light, R), Gs=Lookup(Light, G), Bs=Lookup(Light, B);
+                float Ys=Kr*Rs+Kg*Gs+Kb*Bs;
+                Value=Ys>0?1000*std::pow(Ys, 0.2f)*std::max(Rs, std::max(Gs, Bs)):0;
+            }
+            else
+                Value=Lookup(Light, std::max(R, std::max(G, B)));
+
+            Max=std::max(Max, Value);
+            Line_Sum+=Value;
+            if (Value>Peak_Light)
+                Over++;
+        }
+        Sum+=Line_Sum;
+    }
+
+    double Count=(double)Frame->width*Frame->height;
+    Values[Value_MaxLight]=Max;
+    Values[Value_AvgLight]=Sum/Count;
+    Values[Value_OverPeak]=Over*100/Count;
+}
@@ -0,0 +1,76 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef HdrLightKernel_H
+#define HdrLightKernel_H
+
+#include <cstdint>
+#include <vector>
+
+struct AVFrame;
+
+//---------------------------------------------------------------------------
+// Light levels of the decoded frame in cd/m2 (nits), no filter has them: the
+// max of R, G and B of each pixel converted to display light with the
+// transfer of the frame, PQ (SMPTE ST 2084), HLG (ARIB STD-B67, 1000 nits
+// display) or else BT.1886 (100 nits display).
+//
+// The max of the light of the pixels of the frames is the MaxCLL of the
+// stream and the max of their average the MaxFALL (CTA-861.3), so both are
+// the max of the summary of their item. Pixels above the peak are brighter
+// than the max luminance of the mastering display of the frame, 1000 nits
+// for PQ and HLG without it, and than 100 nits for SDR.
+//
+// Codes are converted with tables built for the format, matrix and range of
+// the frame, and the transfer with a table of the non linear values
+// interpolated between its entries. All of them are gathers, plain C.
+class HdrLightKernel
+{
+public:
+    enum value
+    {
+        Value_MaxLight,
+        Value_AvgLight,
+        Value_OverPeak,
+        Value_Max
+    };
+
+    // Key of the value in the stats ("qctools.hdr.max_light"...)
+    static const char*          Name                        (value Value);
+
+    // Formats of the kernel, as the pix_fmts option of the format filter
+    static const char*          Formats                     ();
+    static bool                 Supports                    (int Format);
+
+    // Values of a frame, false if its format is not supported
+    bool                        Compute                     (const AVFrame* Frame);
+    double                      Get                         (value Value) const;
+
+private:
+    template<typename T>
+    void                        Compute                     (const AVFrame* Frame, int HSub, int VSub, bool Gray);
+    void                        Tables                      (const AVFrame* Frame, int Depth, bool Full);
+
+    double                      Values[Value_Max] {};
+
+    // Tables of the last frame, built again if one of these changes
+    int                         Tables_Depth=0;
+    int                         Tables_Transfer=-1;
+    int                         Tables_Matrix=-1;
+    bool                        Tables_Full=false;
+    std::vector<float>          Luma;                       // By Y code, normalized
+    std::vector<float>          Cr_R;                       // By Cr code, added to Y for R'
+    std::vector<float>          Cr_G;                       // By Cr code, subtracted from Y for G'
+    std::vector<float>          Cb_G;                       // By Cb code, subtracted from Y for G'
+    std::vector<float>          Cb_B;                       // By Cb code, added to Y for B'
+    std::vector<float>          Light;                      // Display light of the max of R'G'B' (or of E' for HLG), Light_Size+1 entries
+    float                       Kr=0;
+    float                       Kb=0;
+    bool                        Hlg=false;
+};
+
+#endif // HdrLightKernel_H
@@ -0,0 +1,305 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/ImageSequenceReader.h"
+#include "Core/UringQueue.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <algorithm>
+#include <atomic>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Defaults
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static std::atomic<size_t> Default_Ahead(4);
+
+//---------------------------------------------------------------------------
+void ImageSequenceReader::Ahead_Set(size_t Files)
+{
+    Default_Ahead=Files;
+}
+
+//---------------------------------------------------------------------------
+size_t ImageSequenceReader::Ahead_Get()
+{
+    return Default_Ahead;
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+ImageSequenceReader::ImageSequenceReader(const QString& Pattern, size_t Ahead_, size_t Threads_)
+: Ahead(std::max(Ahead_, (size_t)1))
+{
+    // "%0Nd" or "%d", as in the adjusted DPX file names
+    auto Match=QRegularExpression("%0?(\\d*)d").match(Pattern);
+    if (Match.hasMatch())
+    {
+        Prefix=QDir::fromNativeSeparators(Pattern.left(Match.capturedStart()));
+        Suffix=Pattern.mid(Match.capturedEnd());
+        Digits=std::max(1, Match.captured(1).toInt());
+    }
+
+    if (UringQueue::Enabled_Get())
+        Threads.emplace_back(&ImageSequenceReader::Load_Uring, this);
+    else
+        for (size_t Pos=0; Pos<std::max(Threads_, (size_t)1); ++Pos)
+            Threads.emplace_back(&ImageSequenceReader::Load, this);
+}
+
+//---------------------------------------------------------------------------
+ImageSequenceReader::~ImageSequenceReader()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stop=true;
+    }
+    Wanted.notify_all();
+    for (auto& Thread : Threads)
+        Thread.join();
+}
+
+//***************************************************************************
+// Names
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool ImageSequenceReader::Index(const QString& Name_, int& Number) const
+{
+    auto Name=QDir::fromNativeSeparators(Name_);
+    if (!Digits || Name.size()<Prefix.size()+Suffix.size()+Digits || !Name.startsWith(Prefix) || !Name.endsWith(Suffix))
+        return false;
+
+    bool IsNumber=false;
+    Number=Name.mid(Prefix.size(), Name.size()-Prefix.size()-Suffix.size()).toInt(&IsNumber);
+    return IsNumber && Number>=0;
+}
+
+//---------------------------------------------------------------------------
+QString ImageSequenceReader::FileName(int Number) const
+{
+    return Prefix+QString("%1").arg(Number, Digits, 10, QChar('0'))+Suffix;
+}
+
+//***************************************************************************
+// Reading
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool ImageSequenceReader::Read(const QString& Name, QByteArray& Data)
+{
+    int Number;
+    if (!Index(Name, Number))
+        return false;
+
+    std::unique_lock<std::mutex> Lock(Mutex);
+
+    // Window from this file, the files before it are not needed anymore
+    Files.erase(Files.begin(), Files.lower_bound(Number));
+    for (int Pos=Number; Pos<Number+(int)Ahead && (Last==-1 || Pos<Last); ++Pos)
+        Files.emplace(Pos, file());
+    Files.erase(Files.lower_bound(Number+(int)Ahead), Files.end());
+    auto Item=Files.find(Number);
+    if (Item==Files.end())
+        return false; // After the end of the sequence
+    Wanted.notify_all();
+
+    Loaded.wait(Lock, [&]() {return Stop || Item->second.Loaded;});
+    if (Stop || !Item->second.Valid)
+        return false;
+    Data=std::move(Item->second.Data);
+    Files.erase(Item);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void ImageSequenceReader::Load()
+{
+    std::unique_lock<std::mutex> Lock(Mutex);
+    for (;;)
+    {
+        // First file of the window not loaded yet
+        auto Item=std::find_if(Files.begin(), Files.end(), [](const std::pair<const int, file>& Entry) {return !Entry.second.Loading;});
+        if (Item==Files.end())
+        {
+            if (Stop)
+                return;
+            Wanted.wait(Lock);
+            continue;
+        }
+        if (Stop)
+            return;
+
+        int Number=Item->first;
+        Item->second.Loading=true;
+        Lock.unlock();
+
+        // One read of the whole file, the demuxer asks for small blocks
+        QFile File(FileName(Number));
+        QByteArray Data;
+        bool Valid=File.open(QIODevice::ReadOnly|QIODevice::Unbuffered);
+        if (Valid)
+        {
+            Data.resize((int)File.size());
+            Valid=File.read(Data.data(), Data.size())==Data.size();
+        }
+
+        Lock.lock();
+        Loaded_Set(Number, Valid, !Valid && !File.exists(), std::move(Data));
+    }
+}
+
+//---------------------------------------------------------------------------
+// Locked
+void ImageSequenceReader::Loaded_Set(int Number, bool Valid, bool Missing, QByteArray&& Data)
+{
+    if (Missing && (Last==-1 || Number<Last))
+        Last=Number;
+
+    // The window may have moved meanwhile
+    auto Item=Files.find(Number);
+    if (Item!=Files.end() && Item->second.Loading && !Item->second.Loaded)
+    {
+        Item->second.Loaded=true;
+        Item->second.Valid=Valid;
+        Item->second.Data=std::move(Data);
+        Loaded.notify_all();
+    }
+}
+
+//---------------------------------------------------------------------------
+void ImageSequenceReader::Load_Uring()
+{
+#ifdef __linux__
+    // One request of each file in flight: open, reads until the whole file is read, close
+    enum step : uint64_t {Step_Open, Step_Read, Step_Close};
+    struct request
+    {
+        int                     Fd=-1;
+        bool                    Valid=false;
+        bool                    Missing=false;
+        qint64                  Read=0;
+        QByteArray              Data;
+    };
+    std::map<int, request> Requests;
+    auto UserData=[](int Number, step Step) {return ((uint64_t)Number<<2)|Step;};
+
+    UringQueue Queue((unsigned)Ahead);
+    if (!Queue.IsOpen())
+    {
+        Load();
+        return;
+    }
+
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (!Stop)
+    {
+        // All the files of the window not loading yet
+        for (auto& Entry : Files)
+        {
+            if (Entry.second.Loading)
+                continue;
+            if (!Queue.Open(QFile::encodeName(FileName(Entry.first)).toStdString(), UserData(Entry.first, Step_Open)))
+                break;
+            Entry.second.Loading=true;
+            Requests[Entry.first]=request();
+        }
+        if (!Queue.Pending())
+        {
+            Wanted.wait(Lock);
+            continue;
+        }
+
+        Lock.unlock();
+        bool IsOk=Queue.Submit(1);
+        std::vector<int> Done;
+        uint64_t Data;
+        int Result;
+        while (IsOk && Queue.Complete(Data, Result))
+        {
+            int Number=(int)(Data>>2);
+            auto& Request=Requests[Number];
+            switch ((step)(Data&3))
+            {
+                case Step_Open:
+                    {
+                    struct stat Stat;
+                    if (Result<0 || fstat(Result, &Stat))
+                    {
+                        Request.Missing=Result==-ENOENT;
+                        if (Result>=0)
+                            close(Result);
+                        Done.push_back(Number);
+                        continue;
+                    }
+                    Request.Fd=Result;
+                    Request.Data.resize((int)Stat.st_size);
+                    }
+                    break;
+                case Step_Read:
+                    if (Result<=0)
+                    {
+                        Request.Data.clear(); // Read error or file shorter than when opened
+                        Request.Read=-1;
+                    }
+                    else
+                        Request.Read+=Result;
+                    break;
+                default:
+                    Done.push_back(Number);
+                    continue;
+            }
+
+            // Next read, or close once the whole file is read
+            if (Request.Read>=0 && Request.Read<Request.Data.size())
+                Queue.Read(Request.Fd, Request.Data.data()+Request.Read, (size_t)(Request.Data.size()-Request.Read), Request.Read, UserData(Number, Step_Read));
+            else
+            {
+                Request.Valid=Request.Read>=0;
+                Queue.Close(Request.Fd, UserData(Number, Step_Close));
+                Request.Fd=-1;
+            }
+        }
+        if (IsOk)
+            IsOk=Queue.Submit();
+        Lock.lock();
+
+        for (int Number : Done)
+        {
+            auto Request=Requests.find(Number);
+            Loaded_Set(Number, Request->second.Valid, Request->second.Missing, std::move(Request->second.Data));
+            Requests.erase(Request);
+        }
+        if (!IsOk)
+        {
+            // The reads waiting and the next ones fail
+            Stop=true;
+            Loaded.notify_all();
+        }
+    }
+
+    // The files still open are closed with the loading stopped, the queue waits for the requests in flight
+    for (const auto& Request : Requests)
+        if (Request.second.Fd>=0)
+            close(Request.second.Fd);
+#else
+    Load();
+#endif
+}
@@ -0,0 +1,74 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ImageSequenceReader_H
+#define ImageSequenceReader_H
+
+#include <QByteArray>
+#include <QString>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Images of a sequence (DPX scans...) read by a pool of threads ahead of the
+// image2 demuxer (see QAVPlayer::setFileReader), so the open latency of the
+// storage is paid for several files at a time instead of one after the other.
+//
+// The demuxer still asks for the files in order and gets each one whole from
+// memory, the decoding keeps the order of the frames. A file asked out of the
+// window (after a seek) is read at once and the window restarts after it.
+//
+// With io_uring (see UringQueue), one thread opens, reads and closes all the
+// files of the window at the same time instead of the pool of threads.
+class ImageSequenceReader
+{
+public:
+    // Pattern is the one of image2 ("name%06d.dpx"), Ahead the count of files read ahead
+                                ImageSequenceReader         (const QString& Pattern, size_t Ahead, size_t Threads);
+                                ~ImageSequenceReader        ();
+
+    // Count of files read ahead by the parsers of the sequences opened afterwards, 0 means none
+    static void                 Ahead_Set                   (size_t Files);
+    static size_t               Ahead_Get                   ();
+
+    // From the demuxer thread, false if FileName is not a file of the sequence or can not be read
+    bool                        Read                        (const QString& FileName, QByteArray& Data);
+
+private:
+    struct file
+    {
+        bool                    Loading=false;
+        bool                    Loaded=false;
+        bool                    Valid=false;
+        QByteArray              Data;
+    };
+
+    bool                        Index                       (const QString& FileName, int& Number) const;
+    QString                     FileName                    (int Number) const;
+    void                        Load                        ();
+    void                        Load_Uring                  ();
+    void                        Loaded_Set                  (int Number, bool Valid, bool Missing, QByteArray&& Data);
+
+    QString                     Prefix;
+    QString                     Suffix;
+    int                         Digits=0;                   // 0 if the pattern has no number
+    size_t                      Ahead;
+
+    std::mutex                  Mutex;
+    std::condition_variable     Wanted;                     // Files to load
+    std::condition_variable     Loaded;
+    std::map<int, file>         Files;                      // By number, the window
+    int                         Last=-1;                    // First file missing (end of the sequence), -1 if unknown
+    bool                        Stop=false;
+    std::vector<std::thread>    Threads;
+};
+
+#endif // ImageSequenceReader_H
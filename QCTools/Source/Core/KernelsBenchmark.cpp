@@ -0,0 +1,224 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/KernelsBenchmark.h"
+#include "Core/AudioStatsKernel.h"
+#include "Core/FieldCompareKernel.h"
+#include "Core/SignalStatsKernel.h"
+
+extern "C"
+{
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/samplefmt.h>
+#include <libavutil/version.h>
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+struct frame_deleter
+{
+    void operator()(AVFrame* Frame) const { av_frame_free(&Frame); }
+};
+typedef std::unique_ptr<AVFrame, frame_deleter> frame_ptr;
+
+// Values of a kernel after its last frame
+typedef std::vector<double> values;
+
+//---------------------------------------------------------------------------
+// Same values for the same seed
+uint32_t Noise(uint32_t& Seed)
+{
+    Seed=Seed*1664525+1013904223;
+    return Seed>>16;
+}
+
+//---------------------------------------------------------------------------
+frame_ptr Video(int Format, int Width, int Height, uint32_t Seed)
+{
+    frame_ptr Frame(av_frame_alloc());
+    if (!Frame)
+        return nullptr;
+    Frame->format=Format;
+    Frame->width=Width;
+    Frame->height=Height;
+    if (av_frame_get_buffer(Frame.get(), 0)<0)
+        return nullptr;
+
+    const AVPixFmtDescriptor* Desc=av_pix_fmt_desc_get((AVPixelFormat)Format);
+    const int Depth=Desc->comp[0].depth;
+    const int Max=(1<<Depth)-1;
+    for (int Plane=0; Plane<Desc->nb_components; Plane++)
+    {
+        int PlaneWidth=Plane?AV_CEIL_RSHIFT(Width, Desc->log2_chroma_w):Width;
+        int PlaneHeight=Plane?AV_CEIL_RSHIFT(Height, Desc->log2_chroma_h):Height;
+        for (int y=0; y<PlaneHeight; y++)
+        {
+            uint8_t* Line=Frame->data[Plane]+y*Frame->linesize[Plane];
+            for (int x=0; x<PlaneWidth; x++)
+            {
+                int Value=(x+y)*Max/(PlaneWidth+PlaneHeight)+(int)(Noise(Seed)%(Max/16+1))-Max/32;
+                Value=Value<0?0:(Value>Max?Max:Value);
+                if (Depth>8)
+                    ((uint16_t*)Line)[x]=(uint16_t)Value;
+                else
+                    Line[x]=(uint8_t)Value;
+            }
+        }
+    }
+    return Frame;
+}
+
+//---------------------------------------------------------------------------
+frame_ptr Audio(int Samples, uint32_t Seed)
+{
+    frame_ptr Frame(av_frame_alloc());
+    if (!Frame)
+        return nullptr;
+    Frame->format=AV_SAMPLE_FMT_FLTP;
+    Frame->sample_rate=48000;
+    Frame->nb_samples=Samples;
+#if LIBAVUTIL_VERSION_INT <= AV_VERSION_INT(57, 23, 0)
+    Frame->channels=2;
+    Frame->channel_layout=AV_CH_LAYOUT_STEREO;
+#else
+    av_channel_layout_default(&Frame->ch_layout, 2);
+#endif
+    if (av_frame_get_buffer(Frame.get(), 0)<0)
+        return nullptr;
+
+    for (int c=0; c<2; c++)
+    {
+        float* x=(float*)Frame->extended_data[c];
+        for (int i=0; i<Samples; i++)
+            x[i]=0.5f*(float)std::sin(2*3.14159265358979*(440+c*110)*i/48000)+((int)(Noise(Seed)%2001)-1000)/20000.0f;
+    }
+    return Frame;
+}
+
+//---------------------------------------------------------------------------
+bool IsClose(const values& a, const values& b)
+{
+    if (a.size()!=b.size())
+        return false;
+    for (size_t i=0; i<a.size(); i++)
+        if (!(a[i]==b[i] || std::abs(a[i]-b[i])<=1e-9*std::max(1.0, std::abs(a[i])) || (std::isnan(a[i]) && std::isnan(b[i]))))
+            return false;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Computes the frames alternated Count times with a new kernel, returns the frames per second and the values of the last frame
+typedef std::function<bool(const AVFrame*, values&)> compute;
+typedef std::function<compute()> kernel;
+
+double Time(const kernel& Kernel, const frame_ptr Frames[2], int Count, values& Values)
+{
+    compute Compute=Kernel();
+    auto Start=std::chrono::steady_clock::now();
+    for (int i=0; i<Count; i++)
+        if (!Compute(Frames[i%2].get(), Values))
+            return 0;
+    std::chrono::duration<double> Duration=std::chrono::steady_clock::now()-Start;
+    return Duration.count()>0?Count/Duration.count():0;
+}
+
+} // namespace
+
+//***************************************************************************
+// Run
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+std::vector<KernelsBenchmark::result> KernelsBenchmark::Run(int Width, int Height, int Frames)
+{
+    struct item
+    {
+        const char*             Name;
+        frame_ptr               Frames[2];
+        kernel                  Kernel;
+    };
+    std::vector<item> Items;
+    auto Add=[&Items](const char* Name, frame_ptr First, frame_ptr Second, kernel Kernel) {
+        if (!First || !Second)
+            return;
+        Items.emplace_back();
+        Items.back().Name=Name;
+        Items.back().Frames[0]=std::move(First);
+        Items.back().Frames[1]=std::move(Second);
+        Items.back().Kernel=Kernel;
+    };
+
+    auto SignalStats=[]() -> compute {
+        auto Kernel=std::make_shared<SignalStatsKernel>();
+        return [Kernel](const AVFrame* Frame, values& Values) {
+            if (!Kernel->Compute(Frame))
+                return false;
+            Values.resize(SignalStatsKernel::Value_Max);
+            for (int Value=0; Value<SignalStatsKernel::Value_Max; Value++)
+                Values[Value]=Kernel->Get((SignalStatsKernel::value)Value);
+            return true;
+        };
+    };
+    auto FieldCompare=[]() -> compute {
+        auto Kernel=std::make_shared<FieldCompareKernel>(true, true);
+        return [Kernel](const AVFrame* Frame, values& Values) {
+            if (!Kernel->Compute(Frame))
+                return false;
+            Values.resize(FieldCompareKernel::Value_Max);
+            for (int Value=0; Value<FieldCompareKernel::Value_Max; Value++)
+                Values[Value]=Kernel->Has((FieldCompareKernel::value)Value)?Kernel->Get((FieldCompareKernel::value)Value):0;
+            return true;
+        };
+    };
+    auto AudioStats=[]() -> compute {
+        auto Kernel=std::make_shared<AudioStatsKernel>(true, true, true);
+        return [Kernel](const AVFrame* Frame, values& Values) {
+            if (!Kernel->Compute(Frame))
+                return false;
+            Values.resize(AudioStatsKernel::Value_Max);
+            for (int Value=0; Value<AudioStatsKernel::Value_Max; Value++)
+                Values[Value]=Kernel->Has((AudioStatsKernel::value)Value)?Kernel->Get((AudioStatsKernel::value)Value):0;
+            return true;
+        };
+    };
+
+    Add("signalstats 8-bit", Video(AV_PIX_FMT_YUV422P, Width, Height, 1), Video(AV_PIX_FMT_YUV422P, Width, Height, 2), SignalStats);
+    Add("signalstats 10-bit", Video(AV_PIX_FMT_YUV422P10, Width, Height, 1), Video(AV_PIX_FMT_YUV422P10, Width, Height, 2), SignalStats);
+    Add("field psnr+ssim 8-bit", Video(AV_PIX_FMT_YUV420P, Width, Height, 1), Video(AV_PIX_FMT_YUV420P, Width, Height, 2), FieldCompare);
+    Add("audio stats", Audio(1920, 1), Audio(1920, 2), AudioStats);
+
+    std::vector<result> Results;
+    CpuFeatures::level Selected=CpuFeatures::Get();
+    for (const auto& Item : Items)
+    {
+        values Reference;
+        for (int Level=CpuFeatures::Level_C; Level<CpuFeatures::Level_Max; Level++)
+        {
+            if (!CpuFeatures::Set((CpuFeatures::level)Level))
+                continue;
+
+            values Values;
+            double FramesPerSecond=Time(Item.Kernel, Item.Frames, Frames, Values);
+            if (Level==CpuFeatures::Level_C)
+                Reference=Values;
+            Results.push_back({ Item.Name, (CpuFeatures::level)Level, FramesPerSecond, FramesPerSecond>0 && IsClose(Reference, Values) });
+        }
+    }
+    CpuFeatures::Set(Selected);
+
+    return Results;
+}
@@ -0,0 +1,37 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef KernelsBenchmark_H
+#define KernelsBenchmark_H
+
+#include "Core/CpuFeatures.h"
+
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Speed of the variants of the native kernels (qcli --cpu-features): each
+// kernel computes the same synthetic frames (noise on gradients, 2 frames
+// alternated so the differences with the previous frame are not 0) with each
+// level available, and its values are compared with the ones of the C
+// variant. The level selected before is selected again at the end.
+class KernelsBenchmark
+{
+public:
+    struct result
+    {
+        std::string             Kernel;                     // "signalstats 8-bit"...
+        CpuFeatures::level      Level;
+        double                  FramesPerSecond;
+        bool                    IsSame;                     // Values of the C variant
+    };
+
+    // Video frames of Width x Height, audio frames of 1920 samples per channel of 48 kHz stereo
+    static std::vector<result>  Run                         (int Width, int Height, int Frames);
+};
+
+#endif // KernelsBenchmark_H
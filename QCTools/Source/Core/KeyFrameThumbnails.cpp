@@ -0,0 +1,207 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/KeyFrameThumbnails.h"
+#include "Core/FileInformation.h"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+#include <qavdemuxer_p.h>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+//---------------------------------------------------------------------------
+// Same size as the thumbnails of the parser
+static const int Thumbnail_Width=72;
+static const int Thumbnail_Height=72;
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+KeyFrameThumbnails::KeyFrameThumbnails(const QString& FileName_, int VideoStream_, int Count_) :
+    FileName(FileName_),
+    VideoStream(VideoStream_),
+    Count(Count_)
+{
+}
+
+//---------------------------------------------------------------------------
+KeyFrameThumbnails::~KeyFrameThumbnails()
+{
+    Cancel();
+}
+
+//***************************************************************************
+// Control
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void KeyFrameThumbnails::Start()
+{
+    // After the parser and the display
+    start(QThread::LowestPriority);
+}
+
+//---------------------------------------------------------------------------
+void KeyFrameThumbnails::Cancel()
+{
+    IsCancelled=true;
+    wait();
+}
+
+//***************************************************************************
+// Queries
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+Thumbnail KeyFrameThumbnails::Get(double Time) const
+{
+    QMutexLocker Locker(&Mutex);
+
+    Thumbnail Result;
+    auto Item=std::upper_bound(Items.begin(), Items.end(), Time, [](double Value, const item& Item_) {return Value<Item_.Time;});
+    if (Item==Items.begin())
+        return Result;
+    --Item;
+
+    Result.Width=Thumbnail_Width;
+    Result.Height=Thumbnail_Height;
+    Result.Rgb=Item->Rgb;
+    Result.IsApproximate=true;
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+QVector<QPair<double, qint64>> KeyFrameThumbnails::KeyFrames() const
+{
+    QMutexLocker Locker(&Mutex);
+
+    QVector<QPair<double, qint64>> Result;
+    Result.reserve((int)Items.size());
+    for (const auto& Item : Items)
+        Result.append({Item.Time, Item.Pos});
+    return Result;
+}
+
+//***************************************************************************
+// Thread
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void KeyFrameThumbnails::run()
+{
+    AVFormatContext* FormatContext=nullptr;
+    auto FileName_String=FileName.toStdString();
+    if (avformat_open_input(&FormatContext, FileName_String.c_str(), nullptr, nullptr)<0)
+        return;
+
+    AVCodecContext* CodecContext=nullptr;
+    if (QAVDemuxer::findStreamInfo(FormatContext, FileInformation::FastProbe_Get())>=0 && VideoStream>=0 && VideoStream<(int)FormatContext->nb_streams)
+    {
+        AVStream* Stream=FormatContext->streams[VideoStream];
+        const AVCodec* Codec=avcodec_find_decoder(Stream->codecpar->codec_id);
+        CodecContext=Codec?avcodec_alloc_context3(Codec):nullptr;
+        if (CodecContext)
+        {
+            // One thread, so the frame of the key frame is not delayed by the frame threads
+            CodecContext->thread_count=1;
+            CodecContext->skip_frame=AVDISCARD_NONKEY;
+            if (avcodec_parameters_to_context(CodecContext, Stream->codecpar)<0 || avcodec_open2(CodecContext, Codec, nullptr)<0)
+                avcodec_free_context(&CodecContext);
+        }
+    }
+    if (!CodecContext)
+    {
+        avformat_close_input(&FormatContext);
+        return;
+    }
+
+    AVStream* Stream=FormatContext->streams[VideoStream];
+    double TimeBase=av_q2d(Stream->time_base);
+    double Start=Stream->start_time!=AV_NOPTS_VALUE?Stream->start_time*TimeBase:0;
+    double Duration=0;
+    if (Stream->duration!=AV_NOPTS_VALUE)
+        Duration=Stream->duration*TimeBase;
+    else if (FormatContext->duration!=AV_NOPTS_VALUE)
+        Duration=(double)FormatContext->duration/AV_TIME_BASE;
+
+    AVPacket* Packet=av_packet_alloc();
+    AVFrame* Frame=av_frame_alloc();
+    SwsContext* ScaleContext=nullptr;
+    int64_t Previous=AV_NOPTS_VALUE;
+
+    for (int Pos=0; Pos<Count && Duration>0 && !IsCancelled; Pos++)
+    {
+        double Target=Start+Duration*Pos/Count;
+        if (av_seek_frame(FormatContext, VideoStream, (int64_t)(Target/TimeBase), AVSEEK_FLAG_BACKWARD)<0)
+            break;
+        avcodec_flush_buffers(CodecContext);
+
+        // First key frame from the seek point, decoded alone: the decoder is drained so it does not wait for the next frames
+        int64_t KeyFrame_Pos=-1;
+        bool IsDecoded=false;
+        bool IsSent=false;
+        while (!IsSent && !IsCancelled && av_read_frame(FormatContext, Packet)>=0)
+        {
+            if (Packet->stream_index==VideoStream && (Packet->flags&AV_PKT_FLAG_KEY))
+            {
+                KeyFrame_Pos=Packet->pos;
+                IsSent=avcodec_send_packet(CodecContext, Packet)>=0;
+            }
+            av_packet_unref(Packet);
+        }
+        if (IsSent && avcodec_send_packet(CodecContext, nullptr)>=0)
+            IsDecoded=avcodec_receive_frame(CodecContext, Frame)>=0;
+        if (!IsDecoded)
+        {
+            if (!IsSent)
+                break; // End of the file
+            continue;
+        }
+
+        // Sparse key frames may lead to the same one for several targets
+        int64_t Pts=Frame->best_effort_timestamp;
+        if (Pts==AV_NOPTS_VALUE || Pts==Previous)
+        {
+            av_frame_unref(Frame);
+            continue;
+        }
+        Previous=Pts;
+
+        item Item;
+        Item.Time=Pts*TimeBase-Start;
+        Item.Pos=KeyFrame_Pos;
+        Item.Rgb.resize(Thumbnail_Width*3*Thumbnail_Height);
+        ScaleContext=sws_getCachedContext(ScaleContext, Frame->width, Frame->height, (AVPixelFormat)Frame->format, Thumbnail_Width, Thumbnail_Height, AV_PIX_FMT_RGB24, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+        uint8_t* DestData[4]={(uint8_t*)Item.Rgb.data(), nullptr, nullptr, nullptr};
+        int DestLineSize[4]={Thumbnail_Width*3, 0, 0, 0};
+        bool IsScaled=ScaleContext && sws_scale(ScaleContext, Frame->data, Frame->linesize, 0, Frame->height, DestData, DestLineSize)>=0;
+        av_frame_unref(Frame);
+        if (!IsScaled)
+            continue;
+
+        QMutexLocker Locker(&Mutex);
+        auto Next=std::upper_bound(Items.begin(), Items.end(), Item.Time, [](double Value, const item& Item_) {return Value<Item_.Time;});
+        Items.insert(Next, std::move(Item));
+    }
+
+    qDebug() << "key frame thumbnails:" << KeyFrames().size() << "key frames";
+
+    sws_freeContext(ScaleContext);
+    av_frame_free(&Frame);
+    av_packet_free(&Packet);
+    avcodec_free_context(&CodecContext);
+    avformat_close_input(&FormatContext);
+}
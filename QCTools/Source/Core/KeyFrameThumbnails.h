@@ -0,0 +1,69 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef KeyFrameThumbnails_H
+#define KeyFrameThumbnails_H
+
+#include "Core/ThumbnailStore.h"
+
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Coarse thumbnails of a file not parsed yet, for the display until the
+// parser gets to the frames.
+//
+// A low priority thread opens the file again and seeks to Count positions
+// uniformly spaced over the duration, only the video key frame after each
+// of them is decoded (skip_frame=nonkey) and scaled to 72x72 rgb24 as the
+// thumbnails of the parser. Their time and byte offset are an approximate
+// seek index. Items are available as soon as they are decoded.
+class KeyFrameThumbnails : public QThread
+{
+public:
+    static const int            Count_Default=200;
+
+                                KeyFrameThumbnails          (const QString& FileName, int VideoStream, int Count=Count_Default);
+                                ~KeyFrameThumbnails         ();
+
+    void                        Start                       ();
+    // No more items, returns once the thread is done
+    void                        Cancel                      ();
+
+    // Thumbnail of the last key frame at or before Time (seconds from the start of the stream), empty if none found yet
+    Thumbnail                   Get                         (double Time) const;
+
+    // Key frames found so far (seconds from the start of the stream, byte offset of their packet or -1) by increasing time
+    QVector<QPair<double, qint64>> KeyFrames                () const;
+
+protected:
+    void                        run                         ();
+
+private:
+    struct item
+    {
+        double                  Time;
+        int64_t                 Pos;
+        QByteArray              Rgb;
+    };
+
+    QString                     FileName;
+    int                         VideoStream;
+    int                         Count;
+
+    mutable QMutex              Mutex;
+    std::vector<item>           Items;                      // By increasing time
+    std::atomic<bool>           IsCancelled {false};
+};
+
+#endif // KeyFrameThumbnails_H
@@ -0,0 +1,247 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/MatroskaAttachment.h"
+
+#include <QIODevice>
+#include <cstdint>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+//***************************************************************************
+// EBML
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// IDs, with their length marker
+const uint32_t Id_EBML=0x1A45DFA3;
+const uint32_t Id_Segment=0x18538067;
+const uint32_t Id_SeekHead=0x114D9B74;
+const uint32_t Id_Seek=0x4DBB;
+const uint32_t Id_SeekID=0x53AB;
+const uint32_t Id_SeekPosition=0x53AC;
+const uint32_t Id_Attachments=0x1941A469;
+const uint32_t Id_AttachedFile=0x61A7;
+const uint32_t Id_FileName=0x466E;
+const uint32_t Id_FileMimeType=0x4660;
+const uint32_t Id_FileData=0x465C;
+
+// Names and MIME types longer than this are not read
+const qint64 String_MaxSize=4096;
+
+//---------------------------------------------------------------------------
+struct element
+{
+    uint32_t                    Id;
+    qint64                      Start;                      // Of the content
+    qint64                      Size;                       // -1 if unknown (live files)
+};
+
+//---------------------------------------------------------------------------
+// Variable size integer, the length marker is kept for the IDs
+bool VInt_Read(QIODevice& File, int MaxLength, bool IsId, uint64_t& Value, bool& IsUnknown)
+{
+    char Byte;
+    if (!File.getChar(&Byte))
+        return false;
+    int Length=1;
+    while (Length<=MaxLength && !((uint8_t)Byte&(0x80>>(Length-1))))
+        Length++;
+    if (Length>MaxLength)
+        return false;
+
+    Value=IsId?(uint8_t)Byte:((uint8_t)Byte&(0xFF>>Length));
+    for (int Pos=1; Pos<Length; Pos++)
+    {
+        if (!File.getChar(&Byte))
+            return false;
+        Value=(Value<<8)|(uint8_t)Byte;
+    }
+
+    // All value bits set
+    IsUnknown=!IsId && Value==(1ULL<<(7*Length))-1;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Header of the element at the current position, its content must end before End
+bool Element_Read(QIODevice& File, qint64 End, element& Element)
+{
+    if (File.pos()>=End)
+        return false;
+
+    uint64_t Id, Size;
+    bool IsUnknown;
+    if (!VInt_Read(File, 4, true, Id, IsUnknown) || !VInt_Read(File, 8, false, Size, IsUnknown))
+        return false;
+    Element.Id=(uint32_t)Id;
+    Element.Start=File.pos();
+    if (IsUnknown)
+    {
+        Element.Size=-1;
+        return true;
+    }
+    if (Size>(uint64_t)(End-Element.Start))
+        return false;
+    Element.Size=(qint64)Size;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool UInt_Read(QIODevice& File, const element& Element, uint64_t& Value)
+{
+    if (Element.Size>8)
+        return false;
+    Value=0;
+    for (qint64 Pos=0; Pos<Element.Size; Pos++)
+    {
+        char Byte;
+        if (!File.getChar(&Byte))
+            return false;
+        Value=(Value<<8)|(uint8_t)Byte;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Without the trailing zeros of the padded strings
+QString String_Read(QIODevice& File, const element& Element)
+{
+    if (Element.Size>String_MaxSize)
+        return QString();
+    QByteArray Content=File.read(Element.Size);
+    while (Content.endsWith('\0'))
+        Content.chop(1);
+    return QString::fromUtf8(Content);
+}
+
+//***************************************************************************
+// Matroska
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Position of the Attachments element from the start of the file, -1 if not in the SeekHead
+qint64 SeekHead_Parse(QIODevice& File, const element& SeekHead, qint64 Segment_Start)
+{
+    qint64 End=SeekHead.Start+SeekHead.Size;
+    element Seek;
+    while (Element_Read(File, End, Seek) && Seek.Size>=0)
+    {
+        qint64 Next=Seek.Start+Seek.Size;
+        if (Seek.Id==Id_Seek)
+        {
+            uint64_t SeekID=0, SeekPosition=0;
+            bool HasPosition=false;
+            element Child;
+            while (Element_Read(File, Next, Child) && Child.Size>=0)
+            {
+                if (Child.Id==Id_SeekID && !UInt_Read(File, Child, SeekID))
+                    return -1;
+                if (Child.Id==Id_SeekPosition)
+                {
+                    if (!UInt_Read(File, Child, SeekPosition))
+                        return -1;
+                    HasPosition=true;
+                }
+                if (!File.seek(Child.Start+Child.Size))
+                    return -1;
+            }
+            if (SeekID==Id_Attachments && HasPosition && SeekPosition<(uint64_t)File.size())
+                return Segment_Start+(qint64)SeekPosition;
+        }
+        if (!File.seek(Next))
+            return -1;
+    }
+    return -1;
+}
+
+//---------------------------------------------------------------------------
+bool Attachments_Parse(QIODevice& File, const element& Attachments, MatroskaAttachment::item& Item)
+{
+    if (Attachments.Size<0)
+        return false;
+
+    qint64 End=Attachments.Start+Attachments.Size;
+    element AttachedFile;
+    while (Element_Read(File, End, AttachedFile) && AttachedFile.Size>=0)
+    {
+        qint64 Next=AttachedFile.Start+AttachedFile.Size;
+        if (AttachedFile.Id==Id_AttachedFile)
+        {
+            MatroskaAttachment::item Current;
+            element Child;
+            while (Element_Read(File, Next, Child) && Child.Size>=0)
+            {
+                switch (Child.Id)
+                {
+                    case Id_FileName:       Current.FileName=String_Read(File, Child); break;
+                    case Id_FileMimeType:   Current.MimeType=String_Read(File, Child); break;
+                    case Id_FileData:       Current.Offset=Child.Start; Current.Size=Child.Size; break;
+                    default:;
+                }
+                if (!File.seek(Child.Start+Child.Size))
+                    return false;
+            }
+            if (Current.Offset>=0 && Current.Size>0)
+            {
+                Item=Current;
+                return true;
+            }
+        }
+        if (!File.seek(Next))
+            return false;
+    }
+    return false;
+}
+
+}
+
+//***************************************************************************
+// Find
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool MatroskaAttachment::Find(QIODevice& File, item& Item)
+{
+    if (File.isSequential() || !File.seek(0))
+        return false;
+
+    // EBML header then the segment
+    qint64 File_Size=File.size();
+    element Element;
+    if (!Element_Read(File, File_Size, Element) || Element.Id!=Id_EBML || Element.Size<0 || !File.seek(Element.Start+Element.Size))
+        return false;
+    if (!Element_Read(File, File_Size, Element) || Element.Id!=Id_Segment)
+        return false;
+    qint64 Segment_Start=Element.Start;
+    qint64 Segment_End=Element.Size<0?File_Size:Element.Start+Element.Size;
+
+    // Top level elements, the clusters are skipped if the SeekHead does not have the attachments
+    bool IsSeekHeadParsed=false;
+    while (Element_Read(File, Segment_End, Element))
+    {
+        if (Element.Id==Id_Attachments)
+            return Attachments_Parse(File, Element, Item);
+        if (Element.Size<0)
+            return false; // Clusters of a live file
+        qint64 Next=Element.Start+Element.Size;
+
+        if (Element.Id==Id_SeekHead && !IsSeekHeadParsed)
+        {
+            IsSeekHeadParsed=true;
+            qint64 Attachments_Pos=SeekHead_Parse(File, Element, Segment_Start);
+            element Attachments;
+            if (Attachments_Pos>=0 && File.seek(Attachments_Pos) && Element_Read(File, Segment_End, Attachments) && Attachments.Id==Id_Attachments)
+                return Attachments_Parse(File, Attachments, Item);
+        }
+        if (!File.seek(Next))
+            return false;
+    }
+    return false;
+}
@@ -0,0 +1,39 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef MatroskaAttachment_H
+#define MatroskaAttachment_H
+
+#include <QString>
+
+class QIODevice;
+
+//---------------------------------------------------------------------------
+// Attached file of a Matroska file (the stats of a .qctools.mkv report),
+// found from the EBML elements only: no demuxer is opened and no stream is
+// probed.
+//
+// The top level elements of the segment are skipped by their size, the
+// SeekHead gives the position of the Attachments element if there is one.
+// Only the position and the size of the FileData are returned, the content
+// can be read or memory mapped from the file as it is.
+class MatroskaAttachment
+{
+public:
+    struct item
+    {
+        QString                 FileName;
+        QString                 MimeType;
+        qint64                  Offset=-1;                  // Of the content, from the start of the file
+        qint64                  Size=0;
+    };
+
+    // First attached file with content, false if the file is not a Matroska file or has none
+    static bool                 Find                        (QIODevice& File, item& Item);
+};
+
+#endif // MatroskaAttachment_H
@@ -0,0 +1,71 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/MemoryBudget.h"
+#include "Core/FileInformation.h"
+
+#include <QDebug>
+#include <algorithm>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+void MemoryBudget::Limit_Set(size_t Bytes)
+{
+    Limit=Bytes;
+}
+
+//---------------------------------------------------------------------------
+size_t MemoryBudget::Limit_Get() const
+{
+    return Limit;
+}
+
+//---------------------------------------------------------------------------
+void MemoryBudget::Use(const FileInformation* File)
+{
+    if (!File)
+        return;
+    Used.remove(File);
+    Used.push_front(File);
+}
+
+//---------------------------------------------------------------------------
+void MemoryBudget::Apply(const std::vector<FileInformation*>& Files, const FileInformation* Current)
+{
+    // Closed files are forgotten, the ones never displayed are the first candidates
+    Used.remove_if([&](const FileInformation* File) {
+        return std::find(Files.begin(), Files.end(), File)==Files.end();
+    });
+    if (!Limit)
+        return;
+
+    std::vector<FileInformation*> Candidates;
+    for (auto File : Files)
+        if (File!=Current && std::find(Used.begin(), Used.end(), File)==Used.end())
+            Candidates.push_back(File);
+    for (auto Item=Used.rbegin(); Item!=Used.rend(); ++Item)
+        if (*Item!=Current)
+            Candidates.push_back(const_cast<FileInformation*>(*Item));
+
+    size_t Total=0;
+    for (auto File : Files)
+        Total+=File->memoryBytes();
+
+    for (auto File : Candidates)
+    {
+        if (Total<=Limit)
+            break;
+        size_t Before=File->memoryBytes();
+        File->releaseMemory();
+        size_t After=File->memoryBytes();
+        if (After<Before)
+        {
+            Total-=Before-After;
+            qDebug() << "memory budget:" << File->fileName() << "released" << (Before-After)/(1024*1024) << "MB";
+        }
+    }
+}
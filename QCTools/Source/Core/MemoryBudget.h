@@ -0,0 +1,44 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef MemoryBudget_H
+#define MemoryBudget_H
+
+#include <cstddef>
+#include <list>
+#include <vector>
+
+class FileInformation;
+
+//---------------------------------------------------------------------------
+// Limit of the memory used by all the open files of the GUI.
+//
+// Files are ordered by their last display. When the total of their memory
+// (see FileInformation::memoryBytes) is above the limit, the files not
+// displayed for the longest time are released one after the other (see
+// FileInformation::releaseMemory): their data stays available, read back
+// from temporary files or decompressed when displayed again.
+// GUI thread only.
+class MemoryBudget
+{
+public:
+    // In bytes, 0 means no limit
+    void                        Limit_Set                   (size_t Bytes);
+    size_t                      Limit_Get                   () const;
+
+    // File displayed now
+    void                        Use                         (const FileInformation* File);
+
+    // Releases the files in Files, except Current, until the total is below the limit
+    void                        Apply                       (const std::vector<FileInformation*>& Files, const FileInformation* Current);
+
+private:
+    size_t                      Limit = 0;
+    std::list<const FileInformation*> Used;                 // Most recent first
+};
+
+#endif // MemoryBudget_H
@@ -0,0 +1,190 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/MemoryPressure.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <algorithm>
+#include <atomic>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+std::atomic<size_t> MemoryPressure_Limit(0);
+std::atomic<bool> MemoryPressure_Cgroup(false);
+
+// Part of the limit used from which each stage starts
+const double Stage_Ratios[MemoryPressure::Stage_Max]=
+{
+    0.00,
+    0.70,
+    0.80,
+    0.90,
+    0.95,
+};
+
+const char* const Stage_Names[MemoryPressure::Stage_Max]=
+{
+    "none",
+    "panels spilled",
+    "thumbnails decimated",
+    "stats columns compacted",
+    "panels dropped",
+};
+
+// cgroup v2, then v1 (the namespace of a container is its root)
+const char* const Limit_Files[]=
+{
+    "/sys/fs/cgroup/memory.max",
+    "/sys/fs/cgroup/memory/memory.limit_in_bytes",
+};
+const char* const Usage_Files[]=
+{
+    "/sys/fs/cgroup/memory.current",
+    "/sys/fs/cgroup/memory/memory.usage_in_bytes",
+};
+const char* const Stat_Files[]=
+{
+    "/sys/fs/cgroup/memory.stat",
+    "/sys/fs/cgroup/memory/memory.stat",
+};
+const char* const Inactive_Keys[]=
+{
+    "inactive_file",
+    "total_inactive_file",
+};
+
+//---------------------------------------------------------------------------
+QByteArray Read(const char* FileName)
+{
+    QFile File(QString::fromLatin1(FileName));
+    if (!File.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return File.readAll().trimmed();
+}
+
+//---------------------------------------------------------------------------
+// 0 if not a count of bytes ("max", or the page-rounded max of v1 meaning no limit)
+size_t Bytes(const QByteArray& Value)
+{
+    bool IsOk;
+    auto Result=Value.toULongLong(&IsOk);
+    if (!IsOk || Result>=(1ULL<<60))
+        return 0;
+    return (size_t)Result;
+}
+
+//---------------------------------------------------------------------------
+// Version of the cgroup files found, -1 if none
+int Version()
+{
+    static const int Result=[]() {
+        for (int Pos=0; Pos<2; Pos++)
+            if (QFile::exists(QString::fromLatin1(Limit_Files[Pos])))
+                return Pos;
+        return -1;
+    }();
+    return Result;
+}
+
+}
+
+//***************************************************************************
+// Settings
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void MemoryPressure::Limit_Set(size_t Bytes)
+{
+    MemoryPressure_Limit=Bytes;
+}
+
+//---------------------------------------------------------------------------
+size_t MemoryPressure::Limit_Get()
+{
+    return MemoryPressure_Limit;
+}
+
+//---------------------------------------------------------------------------
+void MemoryPressure::Cgroup_Set(bool Use)
+{
+    MemoryPressure_Cgroup=Use;
+}
+
+//---------------------------------------------------------------------------
+bool MemoryPressure::Cgroup_Get()
+{
+    return MemoryPressure_Cgroup;
+}
+
+//---------------------------------------------------------------------------
+bool MemoryPressure::IsEnabled()
+{
+    return Limit_Get() || (Cgroup_Get() && CgroupLimit());
+}
+
+//***************************************************************************
+// cgroup
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// The limit of a container does not change while it runs
+size_t MemoryPressure::CgroupLimit()
+{
+    static const size_t Result=Version()<0?0:Bytes(Read(Limit_Files[Version()]));
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+// The file cache of the input is reclaimed before the cgroup is out of memory, only the active part is counted
+size_t MemoryPressure::CgroupUsage()
+{
+    if (Version()<0)
+        return 0;
+    size_t Usage=Bytes(Read(Usage_Files[Version()]));
+    if (!Usage)
+        return 0;
+
+    QByteArray Key=QByteArray(Inactive_Keys[Version()])+' ';
+    for (const auto& Line : Read(Stat_Files[Version()]).split('\n'))
+        if (Line.startsWith(Key))
+        {
+            size_t Inactive=Bytes(Line.mid(Key.size()));
+            return Usage>Inactive?Usage-Inactive:0;
+        }
+    return Usage;
+}
+
+//***************************************************************************
+// Stages
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+MemoryPressure::stage MemoryPressure::Stage(size_t Bytes)
+{
+    double Ratio=0;
+    if (size_t Limit=Limit_Get())
+        Ratio=(double)Bytes/Limit;
+    if (Cgroup_Get())
+        if (size_t Limit=CgroupLimit())
+            Ratio=std::max(Ratio, (double)CgroupUsage()/Limit);
+
+    int Stage=Stage_Max-1;
+    while (Stage>Stage_None && Ratio<Stage_Ratios[Stage])
+        Stage--;
+    return (stage)Stage;
+}
+
+//---------------------------------------------------------------------------
+const char* MemoryPressure::Name(stage Stage)
+{
+    return Stage<Stage_Max?Stage_Names[Stage]:"";
+}
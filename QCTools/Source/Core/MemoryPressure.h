@@ -0,0 +1,58 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef MemoryPressure_H
+#define MemoryPressure_H
+
+#include <cstddef>
+
+//---------------------------------------------------------------------------
+// Limit of the memory of a file being parsed (qcli), so a job near the limit
+// of its container finishes with less extras instead of being killed.
+//
+// The footprint of the file (stats columns, thumbnails, panel frames and
+// packet queues, see FileInformation::memoryPressure) is compared to the
+// limit set and the usage of the cgroup of the process to its limit. Load
+// is shed in stages as the usage grows, each one keeping the previous ones:
+// - 70%: panel frames spilled to temporary files
+// - 80%: thumbnails decimated, one out of 2 more each time (see ThumbnailStore::Decimate)
+// - 90%: full chunks of the stats columns compressed (see CommonStats::Compress)
+// - 95%: panels dropped and thumbnails decimated to the maximum, with a comment in the report
+class MemoryPressure
+{
+public:
+    enum stage
+    {
+        Stage_None,
+        Stage_SpillPanels,
+        Stage_DecimateThumbnails,
+        Stage_CompactColumns,
+        Stage_DropOutputs,
+        Stage_Max
+    };
+
+    // In bytes, 0 means no limit (default)
+    static void                 Limit_Set                   (size_t Bytes);
+    static size_t               Limit_Get                   ();
+    // The limit of the cgroup of the process is used too (default off, on in qcli)
+    static void                 Cgroup_Set                  (bool Use);
+    static bool                 Cgroup_Get                  ();
+    // A limit is set or the cgroup one is used and found
+    static bool                 IsEnabled                   ();
+
+    // Limit of the cgroup (v2 or v1), 0 if none or not readable
+    static size_t               CgroupLimit                 ();
+    // Memory used by the cgroup without the inactive file cache, 0 if not readable
+    static size_t               CgroupUsage                 ();
+
+    // Stage of a file using Bytes
+    static stage                Stage                       (size_t Bytes);
+    // Description of the stage in the messages ("panels spilled"...)
+    static const char*          Name                        (stage Stage);
+};
+
+#endif // MemoryPressure_H
@@ -0,0 +1,124 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/NumaNodes.h"
+
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+//---------------------------------------------------------------------------
+// "0-15,32-47"
+std::vector<int> CpuList_Parse(const QString& List)
+{
+    std::vector<int> Cpus;
+    for (const auto& Range : List.trimmed().split(','))
+    {
+        if (Range.isEmpty())
+            continue;
+        auto Bounds=Range.split('-');
+        bool IsOk=false, IsOk2=true;
+        int First=Bounds[0].toInt(&IsOk);
+        int Last=Bounds.size()>1?Bounds[1].toInt(&IsOk2):First;
+        if (!IsOk || !IsOk2 || Last<First)
+            return std::vector<int>();
+        for (int Cpu=First; Cpu<=Last; Cpu++)
+            Cpus.push_back(Cpu);
+    }
+    return Cpus;
+}
+
+//---------------------------------------------------------------------------
+std::vector<std::vector<int>> Nodes_Read()
+{
+    std::vector<std::vector<int>> Nodes;
+
+#ifdef __linux__
+    QDir Dir("/sys/devices/system/node");
+    std::vector<int> Indexes;
+    for (const auto& Name : Dir.entryList(QStringList("node*"), QDir::Dirs))
+    {
+        bool IsOk=false;
+        int Index=Name.mid(4).toInt(&IsOk);
+        if (IsOk)
+            Indexes.push_back(Index);
+    }
+    std::sort(Indexes.begin(), Indexes.end());
+    for (auto Index : Indexes)
+    {
+        QFile File(Dir.filePath(QString("node%1/cpulist").arg(Index)));
+        if (!File.open(QIODevice::ReadOnly))
+            continue;
+        auto Cpus=CpuList_Parse(QString::fromLatin1(File.readAll()));
+        if (!Cpus.empty()) // Nodes of memory only
+            Nodes.push_back(Cpus);
+    }
+#endif
+
+    if (Nodes.empty())
+    {
+        std::vector<int> Cpus;
+        for (int Cpu=0; Cpu<QThread::idealThreadCount(); Cpu++)
+            Cpus.push_back(Cpu);
+        Nodes.push_back(Cpus);
+    }
+    return Nodes;
+}
+
+}
+
+//***************************************************************************
+// Nodes
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const std::vector<std::vector<int>>& NumaNodes::Get()
+{
+    static const std::vector<std::vector<int>> Nodes=Nodes_Read();
+    return Nodes;
+}
+
+//---------------------------------------------------------------------------
+std::vector<int> NumaNodes::Cpus(int Node)
+{
+    const auto& Nodes=Get();
+    if (Node<0 || Node>=(int)Nodes.size())
+        return std::vector<int>();
+    return Nodes[Node];
+}
+
+//***************************************************************************
+// Binding
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool NumaNodes::Bind(const std::vector<int>& Cpus)
+{
+#ifdef __linux__
+    if (Cpus.empty())
+        return false;
+    cpu_set_t Set;
+    CPU_ZERO(&Set);
+    for (auto Cpu : Cpus)
+        if (Cpu>=0 && Cpu<CPU_SETSIZE)
+            CPU_SET(Cpu, &Set);
+    return !pthread_setaffinity_np(pthread_self(), sizeof(Set), &Set);
+#else
+    Q_UNUSED(Cpus);
+    return false;
+#endif
+}
@@ -0,0 +1,34 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef NumaNodes_H
+#define NumaNodes_H
+
+#include <vector>
+
+//---------------------------------------------------------------------------
+// NUMA nodes of the system (sockets of a many-core server), for keeping the
+// threads of a parser and the memory of its frames on one node.
+//
+// Threads are bound to the cores of a node, the frames they allocate are
+// then on the memory of the node (first touch), and the threads created by
+// a bound thread (FFmpeg decoder and filter threads) are bound the same way.
+// Nodes are read from /sys on Linux; elsewhere, or without NUMA, there is
+// one node with all the cores and binding does nothing.
+class NumaNodes
+{
+public:
+    // Cores of each node
+    static const std::vector<std::vector<int>>& Get();
+    // Cores of Node, empty if it is not a node
+    static std::vector<int> Cpus(int Node);
+
+    // Calling thread on Cpus only, false if not supported
+    static bool Bind(const std::vector<int>& Cpus);
+};
+
+#endif // NumaNodes_H
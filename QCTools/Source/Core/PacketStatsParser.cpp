@@ -0,0 +1,240 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/PacketStatsParser.h"
+#include "Core/CommonStats.h"
+#include "Core/FileInformation.h"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+#include <qavdemuxer_p.h>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+struct stream
+{
+    CommonStats*                Stat=nullptr;
+    AVCodecParserContext*       Parser=nullptr;             // Video streams with a parser only
+    AVCodecContext*             CodecContext=nullptr;       // Of the parser, not opened
+    bool                        IsIntraOnly=false;
+    size_t                      Reorder=0;                  // Packets kept until their frame is filled
+    double                      TimeBase=0;
+    std::deque<CommonStats::packet> Packets;                // By increasing time stamp
+    bool                        IsEnded=false;              // Out of the range
+};
+
+//---------------------------------------------------------------------------
+char PictType_Get(stream& Stream, AVPacket* Packet)
+{
+    // Complete frames, so the parser returns the frame of the packet at once
+    if (Stream.Parser)
+    {
+        uint8_t* Data=nullptr;
+        int Size=0;
+        Stream.Parser->pict_type=AV_PICTURE_TYPE_NONE;
+        av_parser_parse2(Stream.Parser, Stream.CodecContext, &Data, &Size, Packet->data, Packet->size, Packet->pts, Packet->dts, Packet->pos);
+        if (Stream.Parser->pict_type!=AV_PICTURE_TYPE_NONE)
+            return av_get_picture_type_char((AVPictureType)Stream.Parser->pict_type);
+    }
+    if (Stream.IsIntraOnly)
+        return 'I';
+    return av_get_picture_type_char(AV_PICTURE_TYPE_NONE);
+}
+
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+PacketStatsParser::PacketStatsParser(const QString& FileName_, const std::vector<CommonStats*>& Stats_, const FinishedHandler& Finished_) :
+    FileName(FileName_),
+    Stats(Stats_),
+    Finished(Finished_),
+    Range_Start(-std::numeric_limits<double>::infinity()),
+    Range_End(std::numeric_limits<double>::infinity())
+{
+}
+
+//---------------------------------------------------------------------------
+PacketStatsParser::~PacketStatsParser()
+{
+    Cancel();
+}
+
+//***************************************************************************
+// Control
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void PacketStatsParser::Range_Set(double Start, double End)
+{
+    Range_Start=Start;
+    Range_End=End;
+}
+
+//---------------------------------------------------------------------------
+void PacketStatsParser::Start()
+{
+    start();
+}
+
+//---------------------------------------------------------------------------
+void PacketStatsParser::Cancel()
+{
+    IsCancelled=true;
+    wait();
+}
+
+//***************************************************************************
+// Thread
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void PacketStatsParser::run()
+{
+    AVFormatContext* FormatContext=nullptr;
+    auto FileName_String=FileName.toStdString();
+    if (avformat_open_input(&FormatContext, FileName_String.c_str(), nullptr, nullptr)<0)
+    {
+        Finished(false);
+        return;
+    }
+    if (QAVDemuxer::findStreamInfo(FormatContext, FileInformation::FastProbe_Get())<0)
+    {
+        avformat_close_input(&FormatContext);
+        Finished(false);
+        return;
+    }
+
+    // Streams without stats are not read
+    std::vector<stream> Streams(FormatContext->nb_streams);
+    size_t Streams_Count=0;
+    for (unsigned Pos=0; Pos<FormatContext->nb_streams; Pos++)
+    {
+        AVStream* Stream=FormatContext->streams[Pos];
+        if (Pos>=Stats.size() || !Stats[Pos])
+        {
+            Stream->discard=AVDISCARD_ALL;
+            continue;
+        }
+
+        stream& Item=Streams[Pos];
+        Item.Stat=Stats[Pos];
+        Item.TimeBase=av_q2d(Stream->time_base);
+        Streams_Count++;
+        if (Stream->codecpar->codec_type!=AVMEDIA_TYPE_VIDEO)
+            continue;
+
+        const AVCodecDescriptor* Descriptor=avcodec_descriptor_get(Stream->codecpar->codec_id);
+        Item.IsIntraOnly=Descriptor && (Descriptor->props&AV_CODEC_PROP_INTRA_ONLY);
+        Item.Reorder=Reorder_Max;
+        Item.Parser=av_parser_init(Stream->codecpar->codec_id);
+        if (Item.Parser)
+        {
+            Item.Parser->flags|=PARSER_FLAG_COMPLETE_FRAMES;
+            Item.CodecContext=avcodec_alloc_context3(nullptr);
+            if (!Item.CodecContext || avcodec_parameters_to_context(Item.CodecContext, Stream->codecpar)<0)
+            {
+                av_parser_close(Item.Parser);
+                Item.Parser=nullptr;
+            }
+        }
+    }
+
+    // Positions are time stamps, as frame time stamps
+    if (Range_Start>0)
+        av_seek_frame(FormatContext, -1, (int64_t)(Range_Start*AV_TIME_BASE), AVSEEK_FLAG_BACKWARD);
+
+    QElapsedTimer Timer;
+    Timer.start();
+    size_t Packets_Count=0;
+
+    // Frames of the range only, the video ones once reordered
+    size_t Streams_Ended=0;
+    auto Fill=[&](stream& Stream, const CommonStats::packet& Packet) {
+        double Time=Packet.Pts==AV_NOPTS_VALUE?std::numeric_limits<double>::quiet_NaN():Packet.Pts*Stream.TimeBase;
+        if (Stream.IsEnded || Time<Range_Start)
+            return;
+        if (Time>=Range_End)
+        {
+            Stream.IsEnded=true;
+            Streams_Ended++;
+            return;
+        }
+        Stream.Stat->StatsFromPacket(Packet);
+    };
+
+    // Read errors end the parsing as the end of the file
+    AVPacket* Packet=av_packet_alloc();
+    while (!IsCancelled && Streams_Ended<Streams_Count && av_read_frame(FormatContext, Packet)>=0)
+    {
+        if ((size_t)Packet->stream_index>=Streams.size() || !Streams[Packet->stream_index].Stat || (Packet->flags&AV_PKT_FLAG_DISCARD))
+        {
+            av_packet_unref(Packet);
+            continue;
+        }
+        stream& Stream=Streams[Packet->stream_index];
+
+        CommonStats::packet Item;
+        Item.Pts=Packet->pts!=AV_NOPTS_VALUE?Packet->pts:Packet->dts;
+        Item.Duration=Packet->duration;
+        Item.Pos=Packet->pos;
+        Item.Size=Packet->size;
+        Item.KeyFrame=Packet->flags&AV_PKT_FLAG_KEY;
+        Item.PictType=PictType_Get(Stream, Packet);
+        Item.Format=FormatContext->streams[Packet->stream_index]->codecpar->format;
+        av_packet_unref(Packet);
+        Packets_Count++;
+
+        // Without a time stamp, the order is kept
+        if (Item.Pts==AV_NOPTS_VALUE)
+        {
+            for (const auto& Previous : Stream.Packets)
+                Fill(Stream, Previous);
+            Stream.Packets.clear();
+            Fill(Stream, Item);
+            continue;
+        }
+        auto Next=std::upper_bound(Stream.Packets.begin(), Stream.Packets.end(), Item.Pts, [](int64_t Value, const CommonStats::packet& Packet_) {return Value<Packet_.Pts;});
+        Stream.Packets.insert(Next, Item);
+        while (Stream.Packets.size()>Stream.Reorder)
+        {
+            Fill(Stream, Stream.Packets.front());
+            Stream.Packets.pop_front();
+        }
+    }
+    for (auto& Stream : Streams)
+    {
+        while (!IsCancelled && !Stream.Packets.empty())
+        {
+            Fill(Stream, Stream.Packets.front());
+            Stream.Packets.pop_front();
+        }
+        av_parser_close(Stream.Parser);
+        avcodec_free_context(&Stream.CodecContext);
+    }
+    av_packet_free(&Packet);
+    avformat_close_input(&FormatContext);
+
+    qDebug() << "packet stats:" << Packets_Count << "packets in" << Timer.elapsed() << "ms";
+
+    if (!IsCancelled)
+        Finished(true);
+}
@@ -0,0 +1,60 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef PacketStatsParser_H
+#define PacketStatsParser_H
+
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Parsing of the packets of a file without decoding, for bitrate and GOP
+// analysis at the speed of the disk.
+//
+// A thread opens the file again and reads the packets of the streams with
+// stats, the time stamps, duration, position, size and key frame flag of each
+// frame are the ones of its packet; the picture type is found by the parser
+// of the codec in the bitstream (I for intra-only codecs, ? if not known).
+// Video packets are reordered by presentation time in a small window, so the
+// frames are in the order of the decoded frames. No other value is filled.
+class PacketStatsParser : public QThread
+{
+public:
+    typedef std::function<void(bool IsOk)> FinishedHandler;
+
+    // Stats is indexed by stream index, Finished is called by the thread at the end of the parsing
+                                PacketStatsParser           (const QString& FileName, const std::vector<CommonStats*>& Stats, const FinishedHandler& Finished);
+                                ~PacketStatsParser          ();
+
+    // Time stamps in seconds of the first frame parsed and of the first frame not parsed, before Start()
+    void                        Range_Set                   (double Start, double End);
+
+    void                        Start                       ();
+    // No more frames, returns once the thread is done
+    void                        Cancel                      ();
+
+    // Packets reordered before their frame is filled
+    static const size_t         Reorder_Max=16;
+
+protected:
+    void                        run                         ();
+
+private:
+    QString                     FileName;
+    std::vector<CommonStats*>   Stats;
+    FinishedHandler             Finished;
+    double                      Range_Start;
+    double                      Range_End;
+    std::atomic<bool>           IsCancelled {false};
+};
+
+#endif // PacketStatsParser_H
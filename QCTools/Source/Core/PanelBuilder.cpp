@@ -0,0 +1,634 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/PanelBuilder.h"
+
+extern "C"
+{
+#include <libavutil/common.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/samplefmt.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+const char* const Mode_Names[PanelBuilder::Mode_Max]=
+{
+    "center_column",
+    "center_row",
+    "center_column_fields",
+    "waveform",
+    "vectorscope",
+    "audio_waveform",
+    "audio_waveform_log",
+    "spectrogram",
+};
+
+bool IsHistogram(PanelBuilder::mode Mode)
+{
+    return Mode==PanelBuilder::Mode_Waveform || Mode==PanelBuilder::Mode_Vectorscope;
+}
+
+// Count of a bin on the log scale of the histograms, 1 sample is visible
+uint8_t LogScale(uint32_t Value, double Scale)
+{
+    return Value?(uint8_t)std::min(255L, std::lround(std::max(1.0, Scale*std::log2(1.0+Value)))):0;
+}
+
+//---------------------------------------------------------------------------
+// From the components of one frame to rgb24
+struct conversion
+{
+    enum kind
+    {
+        Kind_None,                                          // Black (hardware, palette, float, bayer...)
+        Kind_Rgb,
+        Kind_Gray,
+        Kind_Yuv,
+    };
+
+    const AVPixFmtDescriptor*   Desc=nullptr;
+    kind                        Kind=Kind_None;
+    double                      Max[3]={};                  // Of each component
+    double                      Luma_Offset=0;
+    double                      Luma_Range=1;
+    double                      Chroma_Offset=0;
+    double                      Chroma_Range=1;
+    double                      Kr=0.299;
+    double                      Kb=0.114;
+
+    explicit conversion(const AVFrame* Frame)
+    {
+        Desc=av_pix_fmt_desc_get((AVPixelFormat)Frame->format);
+        if (!Desc || (Desc->flags&(AV_PIX_FMT_FLAG_HWACCEL|AV_PIX_FMT_FLAG_BITSTREAM|AV_PIX_FMT_FLAG_PAL|AV_PIX_FMT_FLAG_FLOAT|AV_PIX_FMT_FLAG_BAYER)) || !strncmp(Desc->name, "xyz", 3))
+            return;
+        for (int c=0; c<3 && c<Desc->nb_components; c++)
+            Max[c]=(1<<Desc->comp[c].depth)-1;
+
+        if (Desc->flags&AV_PIX_FMT_FLAG_RGB)
+        {
+            if (Desc->nb_components>=3)
+                Kind=Kind_Rgb;
+            return;
+        }
+        Kind=Desc->nb_components<=2?Kind_Gray:Kind_Yuv;
+
+        // Unspecified range is limited for YUV, full for gray and the yuvj formats, as swscale
+        bool IsFull=Frame->color_range==AVCOL_RANGE_JPEG || (Frame->color_range!=AVCOL_RANGE_MPEG && (Kind==Kind_Gray || !strncmp(Desc->name, "yuvj", 4)));
+        double Scale=(double)(1<<Desc->comp[0].depth)/256;
+        Luma_Offset=IsFull?0:16*Scale;
+        Luma_Range=IsFull?Max[0]:219*Scale;
+        Chroma_Offset=(double)(1<<(Desc->comp[0].depth-1));
+        Chroma_Range=IsFull?Max[0]:224*Scale;
+
+        switch (Frame->colorspace)
+        {
+            case AVCOL_SPC_BT709        : Kr=0.2126; Kb=0.0722; break;
+            case AVCOL_SPC_BT2020_NCL   :
+            case AVCOL_SPC_BT2020_CL    : Kr=0.2627; Kb=0.0593; break;
+            default                     : ;
+        }
+    }
+
+    uint32_t Sample(const AVFrame* Frame, int c, int x, int y) const
+    {
+        if (c && Kind==Kind_Yuv)
+        {
+            x>>=Desc->log2_chroma_w;
+            y>>=Desc->log2_chroma_h;
+        }
+        uint32_t Value=0;
+        av_read_image_line2(&Value, (const uint8_t**)Frame->data, Frame->linesize, Desc, x, y, c, 1, 0, sizeof(Value));
+        return Value;
+    }
+
+    static uint8_t Byte(double Value)
+    {
+        return (uint8_t)std::lround(std::min(std::max(Value, 0.0), 1.0)*255);
+    }
+
+    void Pixel(const AVFrame* Frame, int x, int y, uint8_t* Rgb) const
+    {
+        switch (Kind)
+        {
+            case Kind_Rgb:
+                for (int c=0; c<3; c++)
+                    Rgb[c]=Byte(Sample(Frame, c, x, y)/Max[c]);
+                break;
+            case Kind_Gray:
+                Rgb[0]=Rgb[1]=Rgb[2]=Byte((Sample(Frame, 0, x, y)-Luma_Offset)/Luma_Range);
+                break;
+            case Kind_Yuv:
+            {
+                double Y=(Sample(Frame, 0, x, y)-Luma_Offset)/Luma_Range;
+                double Cb=(Sample(Frame, 1, x, y)-Chroma_Offset)/Chroma_Range;
+                double Cr=(Sample(Frame, 2, x, y)-Chroma_Offset)/Chroma_Range;
+                double Kg=1-Kr-Kb;
+                Rgb[0]=Byte(Y+2*(1-Kr)*Cr);
+                Rgb[1]=Byte(Y-(2*Kb*(1-Kb)*Cb+2*Kr*(1-Kr)*Cr)/Kg);
+                Rgb[2]=Byte(Y+2*(1-Kb)*Cb);
+                break;
+            }
+            default:
+                Rgb[0]=Rgb[1]=Rgb[2]=0;
+        }
+    }
+};
+
+}
+
+//---------------------------------------------------------------------------
+// Radix-2 complex FFT of one size, tables computed once; the windowing and the butterflies are plain loops over contiguous arrays
+struct PanelBuilder::fft
+{
+    int                         Size;
+    std::vector<float>          Window;                     // Hann
+    double                      Reference;                  // Power of a full scale sine through the window
+    std::vector<std::complex<float>> Twiddles;
+    std::vector<int>            Reversed;
+    std::vector<std::complex<float>> Data;
+
+    explicit fft(int Size_)
+        : Size(Size_)
+        , Window((size_t)Size_)
+        , Twiddles((size_t)Size_/2)
+        , Reversed((size_t)Size_)
+        , Data((size_t)Size_)
+    {
+        const double Pi=3.14159265358979323846;
+        double Sum=0;
+        for (int i=0; i<Size; i++)
+        {
+            Window[i]=(float)(0.5-0.5*std::cos(2*Pi*i/Size));
+            Sum+=Window[i];
+        }
+        Reference=(Sum/2)*(Sum/2);
+        for (int i=0; i<Size/2; i++)
+            Twiddles[i]=std::polar(1.0f, (float)(-2*Pi*i/Size));
+        int Bits=0;
+        while ((1<<Bits)<Size)
+            Bits++;
+        for (int i=0; i<Size; i++)
+        {
+            int j=0;
+            for (int b=0; b<Bits; b++)
+                j|=((i>>b)&1)<<(Bits-1-b);
+            Reversed[i]=j;
+        }
+    }
+
+    // Windowed A in the real part and B (if any) in the imaginary part, both Length samples at most, zero padded
+    void Load(const float* A, const float* B, int Length)
+    {
+        Length=std::min(Length, Size);
+        for (int i=0; i<Length; i++)
+            Data[Reversed[i]]=std::complex<float>(A[i]*Window[i], B?B[i]*Window[i]:0);
+        for (int i=Length; i<Size; i++)
+            Data[Reversed[i]]=0;
+    }
+
+    void Transform()
+    {
+        for (int Half=1; Half<Size; Half*=2)
+        {
+            int Step=Size/(Half*2);
+            for (int i=0; i<Size; i+=Half*2)
+                for (int j=0; j<Half; j++)
+                {
+                    auto u=Data[i+j];
+                    auto v=Data[i+j+Half]*Twiddles[(size_t)j*Step];
+                    Data[i+j]=u+v;
+                    Data[i+j+Half]=u-v;
+                }
+        }
+    }
+
+    // Power of the bins 0 to Size/2 of both windows added to Power
+    void Accumulate(float* Power, bool HasB) const
+    {
+        for (int k=0; k<=Size/2; k++)
+        {
+            auto z=Data[k];
+            auto n=std::conj(Data[(Size-k)%Size]);
+            Power[k]+=std::norm(z+n)/4;
+            if (HasB)
+                Power[k]+=std::norm(z-n)/4;
+        }
+    }
+};
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+PanelBuilder::mode PanelBuilder::Mode_Get(const QString& Name, int* Bins_X, int* Bins_Y)
+{
+    // "waveform=16x64", "vectorscope=32" (32x32), "spectrogram=128"
+    auto Base=Name.section('=', 0, 0);
+    auto Bins=Name.section('=', 1);
+    int Mode=0;
+    while (Mode<Mode_Max && Base!=QLatin1String(Mode_Names[Mode]))
+        Mode++;
+
+    int X=0, Y=0;
+    if (Mode==Mode_Waveform)
+        X=16, Y=64;
+    else if (Mode==Mode_Vectorscope)
+        X=32, Y=32;
+    else if (Mode==Mode_AudioWaveform || Mode==Mode_AudioWaveformLog)
+        X=1, Y=64;
+    else if (Mode==Mode_Spectrogram)
+        X=1, Y=128;
+    if (Mode_IsAudio((mode)Mode) && !Bins.isEmpty())
+    {
+        bool IsOk=false;
+        int New_Y=Bins.toInt(&IsOk);
+        if (IsOk && New_Y>0 && New_Y<=1024)
+            Y=New_Y;
+    }
+    else if (X && !Bins.isEmpty())
+    {
+        bool IsOk_X=false, IsOk_Y=false;
+        int New_X=Bins.section('x', 0, 0).toInt(&IsOk_X);
+        int New_Y=Bins.contains('x')?Bins.section('x', 1).toInt(&IsOk_Y):New_X;
+        if (IsOk_X && (IsOk_Y || !Bins.contains('x')) && New_X>0 && New_X<=1024 && New_Y>0 && New_Y<=1024)
+            X=New_X, Y=New_Y;
+    }
+    if (Bins_X)
+        *Bins_X=X;
+    if (Bins_Y)
+        *Bins_Y=Y;
+    return (mode)Mode;
+}
+
+//---------------------------------------------------------------------------
+bool PanelBuilder::Mode_IsAudio(mode Mode)
+{
+    return Mode==Mode_AudioWaveform || Mode==Mode_AudioWaveformLog || Mode==Mode_Spectrogram;
+}
+
+//---------------------------------------------------------------------------
+PanelBuilder::PanelBuilder(mode Mode_, int Width_, int Bins_X_, int Bins_Y_)
+    : Mode(Mode_)
+    , Width(Width_)
+    , Bins_X(IsHistogram(Mode_)?std::max(Bins_X_, 1):1)
+    , Bins_Y(IsHistogram(Mode_) || Mode_IsAudio(Mode_)?std::max(Bins_Y_, 1):0)
+{
+}
+
+//---------------------------------------------------------------------------
+PanelBuilder::~PanelBuilder()
+{
+    av_frame_free(&Panel);
+}
+
+//***************************************************************************
+// Panels
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const AVFrame* PanelBuilder::Push(const AVFrame* Frame)
+{
+    int Length=IsHistogram(Mode)?Bins_Y:Mode==Mode_CenterRow?Frame->width:Frame->height;
+    if (Width<=0 || Mode_IsAudio(Mode) || Frame->width<=0 || Frame->height<=0 || !Panel_Allocate(Length, Frame->pts))
+        return nullptr;
+
+    if (IsHistogram(Mode))
+        Histogram_Convert(Frame, Count);
+    else
+        Line_Convert(Frame, Count);
+    if (++Count<Width)
+        return nullptr;
+
+    Count=0;
+    return Panel;
+}
+
+//---------------------------------------------------------------------------
+const AVFrame* PanelBuilder::Flush()
+{
+    // Last column with the samples received, as showwaves outputs it
+    if (Mode_IsAudio(Mode) && !Pending.empty() && !Pending[0].empty())
+        if (auto Complete=Column_Push())
+            return Complete;
+    if (!Count)
+        return nullptr;
+
+    Count=0;
+    return Panel;
+}
+
+//---------------------------------------------------------------------------
+// Black for its first line, with the time stamp of its first frame as tile does
+bool PanelBuilder::Panel_Allocate(int Length, int64_t Pts)
+{
+    // A frame size change starts a new panel, the lines of the old size are dropped
+    if (!Panel || Panel->height!=Length)
+    {
+        av_frame_free(&Panel);
+        Panel=av_frame_alloc();
+        if (!Panel)
+            return false;
+        Panel->format=IsHistogram(Mode) || Mode_IsAudio(Mode)?AV_PIX_FMT_GRAY8:AV_PIX_FMT_RGB24;
+        Panel->width=Width*Bins_X;
+        Panel->height=Length;
+        Panel->sample_aspect_ratio={1, 1};
+        if (av_frame_get_buffer(Panel, 0)<0)
+        {
+            av_frame_free(&Panel);
+            return false;
+        }
+        Count=0;
+    }
+
+    if (!Count)
+    {
+        if (av_frame_make_writable(Panel)<0)
+            return false;
+        for (int y=0; y<Panel->height; y++)
+            memset(Panel->data[0]+(ptrdiff_t)y*Panel->linesize[0], 0, (size_t)Panel->width*(Panel->format==AV_PIX_FMT_RGB24?3:1));
+        Panel->pts=Pts;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Column Pos of the panel from the line of the frame, pixels read one by one (the line of a frame is not contiguous in every plane)
+void PanelBuilder::Line_Convert(const AVFrame* Frame, int Pos)
+{
+    conversion Conversion(Frame);
+    int Length=Panel->height;
+    int w=Frame->width;
+    int h=Frame->height;
+    int Half=(h+1)/2;
+    uint8_t* Rgb=Panel->data[0]+Pos*3;
+    for (int i=0; i<Length; i++, Rgb+=Panel->linesize[0])
+    {
+        int x, y;
+        switch (Mode)
+        {
+            case Mode_CenterRow             : x=w-1-i; y=h/2; break; // Counterclockwise, the right of the frame on top
+            case Mode_CenterColumnFields    : x=w/2; y=i<Half?i*2:(i-Half)*2+1; break; // Top field above the bottom one
+            default                         : x=w/2; y=i;
+        }
+        Conversion.Pixel(Frame, x, y, Rgb);
+    }
+}
+
+//---------------------------------------------------------------------------
+// Block Pos of the panel from the 2D histogram of the frame, a line of each component read at once
+void PanelBuilder::Histogram_Convert(const AVFrame* Frame, int Pos)
+{
+    conversion Conversion(Frame);
+    Counts.assign((size_t)Bins_X*Bins_Y, 0);
+    int w=Frame->width;
+    int h=Frame->height;
+    uint64_t Total=0;                                       // Samples of the bin receiving the most, at most
+
+    auto Read=[&](int c, int y, int Length) {
+        auto& Line=Samples[c];
+        Line.resize((size_t)Length);
+        av_read_image_line2(Line.data(), (const uint8_t**)Frame->data, Frame->linesize, Conversion.Desc, 0, y, c, Length, 0, sizeof(uint32_t));
+        return Line.data();
+    };
+    auto Bin=[](double Value, int Bins) {
+        return std::min(std::max((int)(Value*Bins), 0), Bins-1);
+    };
+    auto Add=[&](int x, int y) {
+        Counts[(size_t)(Bins_Y-1-y)*Bins_X+x]++;            // Bottom to top
+    };
+
+    if (Mode==Mode_Waveform && Conversion.Kind!=conversion::Kind_None)
+    {
+        // Luma by column, from the code values (RGB weighted as the matrix of the frame)
+        std::vector<int> Columns((size_t)w);
+        for (int x=0; x<w; x++)
+            Columns[x]=std::min((int)((int64_t)x*Bins_X/w), Bins_X-1);
+        double Kg=1-Conversion.Kr-Conversion.Kb;
+        for (int y=0; y<h; y++)
+        {
+            if (Conversion.Kind==conversion::Kind_Rgb)
+            {
+                const uint32_t* R=Read(0, y, w);
+                const uint32_t* G=Read(1, y, w);
+                const uint32_t* B=Read(2, y, w);
+                for (int x=0; x<w; x++)
+                    Add(Columns[x], Bin(Conversion.Kr*R[x]/(Conversion.Max[0]+1)+Kg*G[x]/(Conversion.Max[1]+1)+Conversion.Kb*B[x]/(Conversion.Max[2]+1), Bins_Y));
+            }
+            else
+            {
+                const uint32_t* Y=Read(0, y, w);
+                for (int x=0; x<w; x++)
+                    Add(Columns[x], (int)((uint64_t)Y[x]*Bins_Y/((uint64_t)Conversion.Max[0]+1)));
+            }
+        }
+        Total=(uint64_t)h*((w+Bins_X-1)/Bins_X);
+    }
+    else if (Mode==Mode_Vectorscope && Conversion.Kind!=conversion::Kind_None)
+    {
+        // U by V, each chroma sample once (RGB converted with the matrix of the frame, full range)
+        int cw=w, ch=h;
+        if (Conversion.Kind==conversion::Kind_Yuv)
+        {
+            cw=AV_CEIL_RSHIFT(w, Conversion.Desc->log2_chroma_w);
+            ch=AV_CEIL_RSHIFT(h, Conversion.Desc->log2_chroma_h);
+        }
+        for (int y=0; y<ch; y++)
+        {
+            switch (Conversion.Kind)
+            {
+                case conversion::Kind_Yuv:
+                {
+                    const uint32_t* U=Read(1, y, cw);
+                    const uint32_t* V=Read(2, y, cw);
+                    for (int x=0; x<cw; x++)
+                        Add((int)((uint64_t)U[x]*Bins_X/((uint64_t)Conversion.Max[1]+1)), (int)((uint64_t)V[x]*Bins_Y/((uint64_t)Conversion.Max[2]+1)));
+                    break;
+                }
+                case conversion::Kind_Rgb:
+                {
+                    const uint32_t* R=Read(0, y, cw);
+                    const uint32_t* G=Read(1, y, cw);
+                    const uint32_t* B=Read(2, y, cw);
+                    double Kr=Conversion.Kr, Kb=Conversion.Kb;
+                    for (int x=0; x<cw; x++)
+                    {
+                        double r=R[x]/Conversion.Max[0], g=G[x]/Conversion.Max[1], b=B[x]/Conversion.Max[2];
+                        double l=Kr*r+(1-Kr-Kb)*g+Kb*b;
+                        Add(Bin((b-l)/(2*(1-Kb))+0.5, Bins_X), Bin((r-l)/(2*(1-Kr))+0.5, Bins_Y));
+                    }
+                    break;
+                }
+                default:
+                    // Gray, no chroma
+                    for (int x=0; x<cw; x++)
+                        Add(Bins_X/2, Bins_Y/2);
+            }
+        }
+        Total=(uint64_t)cw*ch;
+    }
+
+    // Log scale, 1 sample is visible
+    double Scale=Total?255/std::log2(1.0+Total):0;
+    uint8_t* Block=Panel->data[0]+(ptrdiff_t)Pos*Bins_X;
+    for (int y=0; y<Bins_Y; y++, Block+=Panel->linesize[0])
+        for (int x=0; x<Bins_X; x++)
+            Block[x]=LogScale(Counts[(size_t)y*Bins_X+x], Scale);
+}
+
+//***************************************************************************
+// Audio panels
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void PanelBuilder::Push(const AVFrame* Frame, const std::function<void(const AVFrame*)>& Output)
+{
+#if LIBAVUTIL_VERSION_INT <= AV_VERSION_INT(57, 23, 0)
+    int FrameChannels=Frame->channels;
+#else
+    int FrameChannels=Frame->ch_layout.nb_channels;
+#endif
+    if (Width<=0 || !Mode_IsAudio(Mode) || Frame->format!=AV_SAMPLE_FMT_FLTP || FrameChannels<=0 || Frame->sample_rate<Audio_Rate)
+        return;
+
+    // A format change starts a new panel, the samples of the old format are dropped
+    if (FrameChannels!=Channels || Frame->sample_rate!=SampleRate)
+    {
+        Channels=FrameChannels;
+        SampleRate=Frame->sample_rate;
+        Columns=0;
+        Count=0;
+        Pending.assign((size_t)Channels, std::vector<float>());
+        Fft.reset();
+        if (Mode==Mode_Spectrogram)
+        {
+            // The largest window in a column, at least 2 FFT bins per row
+            int Size=2;
+            while (Size<2*Bins_Y)
+                Size*=2;
+            while (Size*2<=SampleRate/Audio_Rate && Size<(1<<15))
+                Size*=2;
+            Fft.reset(new fft(Size));
+            Power.resize((size_t)Size/2+1);
+        }
+    }
+
+    int Offset=0;
+    while (Offset<Frame->nb_samples)
+    {
+        if (Pending[0].empty())
+            Pending_Pts=Frame->pts;
+        int Length=std::min(Column_Length()-(int)Pending[0].size(), Frame->nb_samples-Offset);
+        for (int c=0; c<Channels; c++)
+        {
+            auto Samples=reinterpret_cast<const float*>(Frame->extended_data[c])+Offset;
+            Pending[c].insert(Pending[c].end(), Samples, Samples+Length);
+        }
+        Offset+=Length;
+        if ((int)Pending[0].size()<Column_Length())
+            break;
+        if (auto Complete=Column_Push())
+            Output(Complete);
+    }
+}
+
+//---------------------------------------------------------------------------
+// Samples from Columns/Audio_Rate to (Columns+1)/Audio_Rate second, the fraction of a sample is not lost between columns
+int PanelBuilder::Column_Length() const
+{
+    return (int)((Columns+1)*SampleRate/Audio_Rate-Columns*SampleRate/Audio_Rate);
+}
+
+//---------------------------------------------------------------------------
+const AVFrame* PanelBuilder::Column_Push()
+{
+    bool IsOk=Panel_Allocate(Channels*Bins_Y, Pending_Pts);
+    if (IsOk)
+    {
+        if (Mode==Mode_Spectrogram)
+            Spectrum_Convert(Count);
+        else
+            Samples_Convert(Count);
+    }
+    for (auto& Samples : Pending)
+        Samples.clear();
+    Columns++;
+    if (!IsOk || ++Count<Width)
+        return nullptr;
+
+    Count=0;
+    return Panel;
+}
+
+//---------------------------------------------------------------------------
+// Column Pos of the panel from the histogram of the sample values of each channel
+void PanelBuilder::Samples_Convert(int Pos)
+{
+    for (int c=0; c<Channels; c++)
+    {
+        const auto& Samples=Pending[c];
+        Counts.assign((size_t)Bins_Y, 0);
+        for (float Sample : Samples)
+        {
+            double Value=std::min(std::max((double)Sample, -1.0), 1.0);
+            if (Mode==Mode_AudioWaveformLog)
+                Value=std::copysign(std::log10(1+9*std::fabs(Value)), Value);
+            Counts[std::min(std::max((int)((Value+1)/2*Bins_Y), 0), Bins_Y-1)]++;
+        }
+
+        double Scale=Samples.empty()?0:255/std::log2(1.0+Samples.size());
+        uint8_t* Pixel=Panel->data[0]+(ptrdiff_t)c*Bins_Y*Panel->linesize[0]+Pos;
+        for (int y=0; y<Bins_Y; y++, Pixel+=Panel->linesize[0])
+            *Pixel=LogScale(Counts[(size_t)Bins_Y-1-y], Scale); // Bottom to top
+    }
+}
+
+//---------------------------------------------------------------------------
+// Column Pos of the panel from the spectrum of each channel, windows of a channel transformed by pairs
+void PanelBuilder::Spectrum_Convert(int Pos)
+{
+    int Size=Fft->Size;
+    int Half=Size/2;
+    for (int c=0; c<Channels; c++)
+    {
+        const auto& Samples=Pending[c];
+        int Length=(int)Samples.size();
+        int Windows=Length>Size?1+(Length-Size)/Half:1;
+        std::fill(Power.begin(), Power.end(), 0.0f);
+        for (int w=0; w<Windows; w+=2)
+        {
+            bool HasB=w+1<Windows;
+            const float* A=Samples.data()+(size_t)w*Half;
+            Fft->Load(A, HasB?A+Half:nullptr, Length-w*Half);
+            Fft->Transform();
+            Fft->Accumulate(Power.data(), HasB);
+        }
+
+        double Reference=Fft->Reference*Windows;
+        uint8_t* Pixel=Panel->data[0]+(ptrdiff_t)c*Bins_Y*Panel->linesize[0]+Pos;
+        for (int y=0; y<Bins_Y; y++, Pixel+=Panel->linesize[0])
+        {
+            // Bottom to top, the peak of the bins of the row
+            int Row=Bins_Y-1-y;
+            int Begin=(int)((int64_t)Row*Half/Bins_Y);
+            int End=std::max(Begin+1, (int)((int64_t)(Row+1)*Half/Bins_Y));
+            float Peak=*std::max_element(Power.begin()+Begin, Power.begin()+End);
+            double Level=Peak>0?10*std::log10(Peak/Reference):-Spectrum_Range;
+            *Pixel=(uint8_t)std::lround(std::min(std::max((Level+Spectrum_Range)/Spectrum_Range, 0.0), 1.0)*255);
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef PanelBuilder_H
+#define PanelBuilder_H
+
+#include <QString>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct AVFrame;
+struct AVPixFmtDescriptor;
+
+//---------------------------------------------------------------------------
+// Panels of one line of each frame (panels.json entries with "native"),
+// built from the decoded frames instead of their filter chain: the line is
+// read from the planes of the frame and only its pixels are converted to
+// rgb24, in a panel image allocated once, instead of converting the whole
+// frame then cropping and tiling it.
+//
+// The panel is the one of the filter chain of the entry: Width frames from
+// left to right, each one a column of the panel (transposed for the center
+// row). Chroma is not interpolated, values are the ones of the nearest
+// chroma sample, so colors may differ a bit from swscale.
+//
+// Waveform and vectorscope panels are the 2D histograms of each frame, in
+// gray: a block of X by Y bins per frame instead of a column, the count of
+// each bin on a log scale (white when all the samples of the bin column, or
+// of the frame for the vectorscope, are in it). Waveform: the columns of the
+// frame by luma (bottom to top), vectorscope: U (left to right) by V (bottom
+// to top), from the full code range so out of range values are seen. Only
+// the bins are stored, the display scales them at any zoom.
+//
+// Audio panels are built the same way from the samples (fltp), a column per
+// 1/Audio_Rate second and a band of Y bins per channel, top to bottom: the
+// sample values (linear or log amplitude, bottom to top) on the log scale of
+// the histograms, or the spectrum of the column (0 to Nyquist, bottom to
+// top) from Hann windows of a power of 2 overlapped by half, 2 real windows
+// in each complex FFT, the peak of the bins of each row in dB below full
+// scale over Spectrum_Range. The image of showwaves or showspectrum is not
+// drawn, the bins are scaled when displayed or exported.
+class PanelBuilder
+{
+public:
+    enum mode
+    {
+        Mode_CenterColumn,                                  // scale,format=rgb24,crop=1:ih:iw/2:0,tile=layout=Wx1
+        Mode_CenterRow,                                     // scale,format=rgb24,transpose=2,crop=1:ih:iw/2:0,tile=layout=Wx1
+        Mode_CenterColumnFields,                            // scale,il=l=d:c=d,format=rgb24,crop=1:ih:iw/2:0,tile=layout=Wx1
+        Mode_Waveform,                                      // "waveform[=XxY]", 16x64 bins by default
+        Mode_Vectorscope,                                   // "vectorscope[=XxY]", 32x32 bins by default
+        Mode_AudioWaveform,                                 // "audio_waveform[=Y]", 64 bins per channel by default
+        Mode_AudioWaveformLog,                              // "audio_waveform_log[=Y]", 64 bins per channel by default
+        Mode_Spectrogram,                                   // "spectrogram[=Y]", 128 bins per channel by default
+        Mode_Max
+    };
+
+    // Columns per second of the audio panels, ${AUDIO_FRAME_RATE} of the filter chains
+    static const int            Audio_Rate=32;
+    // dB below full scale of the darkest bin of the spectrogram
+    static const int            Spectrum_Range=120;
+
+    // Mode of a "native" name of panels.json, Mode_Max if unknown or empty
+    // Bins of the histogram modes from the name, else the defaults (0 for the other modes)
+    static mode                 Mode_Get                    (const QString& Name, int* Bins_X=nullptr, int* Bins_Y=nullptr);
+    // Mode built from audio frames
+    static bool                 Mode_IsAudio                (mode Mode);
+
+                                PanelBuilder                (mode Mode, int Width, int Bins_X=0, int Bins_Y=0);
+                                ~PanelBuilder               ();
+
+    // Line of Frame added to the panel, returns the panel once it has Width lines (valid until the next call) else nullptr
+    const AVFrame*              Push                        (const AVFrame* Frame);
+    // Samples of Frame added to the panel (audio modes), Output is called with each panel completed (valid during the call)
+    void                        Push                        (const AVFrame* Frame, const std::function<void(const AVFrame*)>& Output);
+    // Panel not complete at the end of the stream, the other lines are black; nullptr if none
+    const AVFrame*              Flush                       ();
+
+private:
+    // Panel of the length of the line, cleared for its first line, false if it can not be allocated
+    bool                        Panel_Allocate              (int Length, int64_t Pts);
+    void                        Line_Convert                (const AVFrame* Frame, int Pos);
+    void                        Histogram_Convert           (const AVFrame* Frame, int Pos);
+    // Audio column from the pending samples, returns the panel if complete
+    const AVFrame*              Column_Push                 ();
+    int                         Column_Length               () const;
+    void                        Samples_Convert             (int Pos);
+    void                        Spectrum_Convert            (int Pos);
+
+    struct fft;
+
+    mode                        Mode;
+    int                         Width;
+    int                         Bins_X;
+    int                         Bins_Y;
+    int                         Count = 0;                  // Lines (or blocks) in the panel
+    AVFrame*                    Panel = nullptr;
+    std::vector<uint32_t>       Counts;                     // Bins of the current frame
+    std::vector<uint32_t>       Samples[3];                 // Line of each component
+
+    // Audio
+    int                         Channels = 0;
+    int                         SampleRate = 0;
+    int64_t                     Columns = 0;                // Since the start or the last format change
+    int64_t                     Pending_Pts = 0;            // Of the frame of the first pending sample
+    std::vector<std::vector<float>> Pending;                // Samples of the current column, by channel
+    std::vector<float>          Power;                      // Spectrum of the current column
+    std::unique_ptr<fft>        Fft;
+};
+
+#endif // PanelBuilder_H
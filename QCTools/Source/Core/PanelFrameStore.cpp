@@ -0,0 +1,251 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/PanelFrameStore.h"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+#include <QDebug>
+#include <QDir>
+#include <QMutexLocker>
+#include <atomic>
+
+static std::atomic<bool> PanelFrameStore_Spill(true);
+
+//---------------------------------------------------------------------------
+void PanelFrameStore::Spill_Set(bool Spill)
+{
+    PanelFrameStore_Spill=Spill;
+}
+
+//---------------------------------------------------------------------------
+bool PanelFrameStore::Spill_Get()
+{
+    return PanelFrameStore_Spill;
+}
+
+//---------------------------------------------------------------------------
+PanelFrameStore::PanelFrameStore() :
+    File(QDir::tempPath() + "/qctools-panel-XXXXXX"),
+    Spill(Spill_Get())
+{
+}
+
+//---------------------------------------------------------------------------
+PanelFrameStore::~PanelFrameStore()
+{
+    sws_freeContext(ScaleContext);
+}
+
+//---------------------------------------------------------------------------
+void PanelFrameStore::Push(const AVFrame* Frame)
+{
+    QMutexLocker Locker(&Mutex);
+
+    entry Entry;
+    Entry.Format=Frame->format;
+    Entry.Width=Frame->width;
+    Entry.Height=Frame->height;
+    Entry.Pts=Frame->pts;
+
+    // Frames which can not be packed (hardware...) are kept empty so positions do not change
+    int Size=av_image_get_buffer_size((AVPixelFormat)Frame->format, Frame->width, Frame->height, 1);
+    if (Size<=0)
+    {
+        Entry.Format=-1;
+        Entries.push_back(Entry);
+        return;
+    }
+
+    QByteArray Data(Size, Qt::Uninitialized);
+    if (av_image_copy_to_buffer((uint8_t*)Data.data(), Size, Frame->data, Frame->linesize, (AVPixelFormat)Frame->format, Frame->width, Frame->height, 1)<0)
+    {
+        Entry.Format=-1;
+        Entries.push_back(Entry);
+        return;
+    }
+    Entry.Size=Size;
+
+    if (Spill && !File.isOpen() && !File.open())
+    {
+        qWarning() << "panel frames can not be written to a temporary file, they are kept in memory:" << File.errorString();
+        Spill=false;
+    }
+
+    if (Spill)
+    {
+        // Reads do not move the position but a failed map may have been replaced by a read
+        Entry.Offset=File.size();
+        if (File.seek(Entry.Offset) && File.write(Data)==Size)
+        {
+            Flushed=false;
+            Entries.push_back(Entry);
+            return;
+        }
+
+        qWarning() << "panel frames can not be written to" << File.fileName() << ", next ones are kept in memory:" << File.errorString();
+        Spill=false;
+    }
+
+    Entry.Offset=-1;
+    Entry.Data=Data;
+    Entries.push_back(Entry);
+}
+
+//---------------------------------------------------------------------------
+size_t PanelFrameStore::Count() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Entries.size();
+}
+
+//---------------------------------------------------------------------------
+Thumbnail PanelFrameStore::Get(size_t Pos) const
+{
+    QMutexLocker Locker(&Mutex);
+
+    Thumbnail Result;
+    if (Pos>=Entries.size())
+        return Result;
+    const entry& Entry=Entries[Pos];
+    if (Entry.Format<0)
+        return Result;
+
+    const unsigned char* Pixels=Map(Entry);
+    if (!Pixels)
+        return Result;
+
+    uint8_t* SourceData[4];
+    int SourceLineSize[4];
+    av_image_fill_arrays(SourceData, SourceLineSize, Pixels, (AVPixelFormat)Entry.Format, Entry.Width, Entry.Height, 1);
+
+    Result.Rgb=QByteArray(Entry.Width*3*Entry.Height, Qt::Uninitialized);
+    uint8_t* DestData[4]={(uint8_t*)Result.Rgb.data(), nullptr, nullptr, nullptr};
+    int DestLineSize[4]={Entry.Width*3, 0, 0, 0};
+    ScaleContext=sws_getCachedContext(ScaleContext, Entry.Width, Entry.Height, (AVPixelFormat)Entry.Format, Entry.Width, Entry.Height, AV_PIX_FMT_RGB24, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    bool Converted=ScaleContext && sws_scale(ScaleContext, SourceData, SourceLineSize, 0, Entry.Height, DestData, DestLineSize)>=0;
+    Unmap(Entry, Pixels);
+
+    if (!Converted)
+        return Thumbnail();
+    Result.Width=Entry.Width;
+    Result.Height=Entry.Height;
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+bool PanelFrameStore::Get(size_t Pos, AVFrame* Frame) const
+{
+    QMutexLocker Locker(&Mutex);
+
+    if (Pos>=Entries.size())
+        return false;
+    const entry& Entry=Entries[Pos];
+    if (Entry.Format<0)
+        return false;
+
+    // The previous content may still be referenced by an encoder, and the panels may change of size
+    if (!Frame->buf[0] || Frame->format!=Entry.Format || Frame->width!=Entry.Width || Frame->height!=Entry.Height)
+    {
+        av_frame_unref(Frame);
+        Frame->format=Entry.Format;
+        Frame->width=Entry.Width;
+        Frame->height=Entry.Height;
+        if (av_frame_get_buffer(Frame, 0)<0)
+            return false;
+    }
+    else if (av_frame_make_writable(Frame)<0)
+        return false;
+
+    const unsigned char* Pixels=Map(Entry);
+    if (!Pixels)
+        return false;
+
+    uint8_t* SourceData[4];
+    int SourceLineSize[4];
+    av_image_fill_arrays(SourceData, SourceLineSize, Pixels, (AVPixelFormat)Entry.Format, Entry.Width, Entry.Height, 1);
+    av_image_copy(Frame->data, Frame->linesize, (const uint8_t**)SourceData, SourceLineSize, (AVPixelFormat)Entry.Format, Entry.Width, Entry.Height);
+    Unmap(Entry, Pixels);
+
+    Frame->pts=Entry.Pts;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+size_t PanelFrameStore::Bytes() const
+{
+    QMutexLocker Locker(&Mutex);
+
+    size_t Result=Entries.capacity()*sizeof(entry);
+    for (const auto& Entry : Entries)
+        Result+=Entry.Data.size();
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+void PanelFrameStore::Release()
+{
+    QMutexLocker Locker(&Mutex);
+
+    for (auto& Entry : Entries)
+    {
+        if (Entry.Offset>=0 || Entry.Data.isEmpty())
+            continue;
+        if (!File.isOpen() && !File.open())
+            return;
+
+        qint64 Offset=File.size();
+        if (!File.seek(Offset) || File.write(Entry.Data)!=Entry.Size)
+            return;
+        Flushed=false;
+        Entry.Offset=Offset;
+        Entry.Data=QByteArray();
+    }
+}
+
+//---------------------------------------------------------------------------
+const unsigned char* PanelFrameStore::Map(const entry& Entry) const
+{
+    if (Entry.Offset<0)
+        return (const unsigned char*)Entry.Data.constData();
+
+    // Written data must be in the file before being mapped
+    if (!Flushed)
+    {
+        File.flush();
+        Flushed=true;
+    }
+
+    const unsigned char* Pixels=File.map(Entry.Offset, Entry.Size);
+    if (Pixels)
+        return Pixels;
+
+    // Not mappable (some network file systems), read instead
+    unsigned char* Buffer=new unsigned char[Entry.Size];
+    if (!File.seek(Entry.Offset) || File.read((char*)Buffer, Entry.Size)!=Entry.Size)
+    {
+        delete[] Buffer;
+        return nullptr;
+    }
+    return Buffer;
+}
+
+//---------------------------------------------------------------------------
+void PanelFrameStore::Unmap(const entry& Entry, const unsigned char* Pixels) const
+{
+    if (Entry.Offset<0)
+        return;
+
+    if (!File.unmap((uchar*)Pixels))
+        delete[] Pixels;
+}
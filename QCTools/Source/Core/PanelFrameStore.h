@@ -0,0 +1,78 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef PanelFrameStore_H
+#define PanelFrameStore_H
+
+#include "Core/ThumbnailStore.h"
+#include <QByteArray>
+#include <QMutex>
+#include <QTemporaryFile>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct AVFrame;
+struct SwsContext;
+
+//---------------------------------------------------------------------------
+// Frames of one panel output (panels.json), kept until the .qctools.mkv
+// report is written and for the display.
+//
+// Pixels are packed in the format of the filter output, without the decoded
+// frames and their buffers. By default they are spilled to a temporary file
+// and mapped back when read, only the position of each frame is kept in
+// memory so memory does not grow with the duration of the file.
+class PanelFrameStore
+{
+public:
+    // Settings for the stores created afterwards
+    static void                 Spill_Set                   (bool Spill);
+    static bool                 Spill_Get                   ();
+
+                                PanelFrameStore             ();
+                                ~PanelFrameStore            ();
+
+    void                        Push                        (const AVFrame* Frame);
+
+    size_t                      Count                       () const;
+
+    // Frame Pos converted to rgb24, empty if Pos is not available
+    Thumbnail                   Get                         (size_t Pos) const;
+    // Frame Pos in its format, size and timestamp, returns false if Pos is not available
+    bool                        Get                         (size_t Pos, AVFrame* Frame) const;
+
+    // Memory used, not including the temporary file
+    size_t                      Bytes                       () const;
+    // Writes the frames kept in memory to the temporary file, even if spilling is disabled, for files not displayed
+    void                        Release                     ();
+
+private:
+    struct entry
+    {
+        qint64                  Offset = 0;                 // In the temporary file
+        int                     Size = 0;
+        int                     Format = -1;
+        int                     Width = 0;
+        int                     Height = 0;
+        int64_t                 Pts = 0;
+        QByteArray              Data;                       // If not spilled
+    };
+
+    // Pixels of the entry, mapped from the temporary file if spilled, Unmap() must be called after use
+    const unsigned char*        Map                         (const entry& Entry) const;
+    void                        Unmap                       (const entry& Entry, const unsigned char* Pixels) const;
+
+    mutable QMutex              Mutex;
+    std::vector<entry>          Entries;
+    mutable QTemporaryFile      File;
+    mutable bool                Flushed = true;
+    mutable SwsContext*         ScaleContext = nullptr;
+    bool                        Spill;
+};
+
+#endif // PanelFrameStore_H
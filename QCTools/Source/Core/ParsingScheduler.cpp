@@ -0,0 +1,356 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/ParsingScheduler.h"
+#include "Core/FileInformation.h"
+#include "Core/CommonStats.h"
+#include "Core/VideoStats.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <sys/qos.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+// Milliseconds between two measures of the work done
+const int Period=3000;
+// Relative change of the work done by second below which the count does not help
+const double Gain_Min=0.05;
+// Milliseconds after the last interaction when the user is idle again
+const int Interaction_Idle=1000;
+// Of the threads at a background priority, Linux
+const int Background_Nice=10;
+
+struct running
+{
+    FileInformation*            File;
+    quint64                     Work;                       // At the last measure
+    bool                        Paused;
+    bool                        Throttled;                  // Held while the user interacts
+};
+
+std::vector<running>            Running;                    // In start order
+QList<FileInformation*>         Pending;                    // In request order
+FileInformation*                Current=nullptr;
+int                             Max_Fixed=0;
+int                             Limit=0;                    // Adaptive count, 0 until used
+int                             Direction=1;                // Of the last change of Limit
+double                          Rate_Previous=-1;           // Work by second with the current Limit, -1 if not measured
+QTimer*                         Timer=nullptr;
+QElapsedTimer                   Elapsed;
+int                             Interaction_Cores=0;
+bool                            Interacting=false;
+QTimer*                         Interaction_Timer=nullptr;  // Until the user is idle
+
+//---------------------------------------------------------------------------
+int Limit_Default()
+{
+    int Max=QThread::idealThreadCount();
+    return Max>2?Max-2:1;
+}
+
+//---------------------------------------------------------------------------
+int Limit_Get()
+{
+    if (Max_Fixed>0)
+        return Max_Fixed;
+    if (!Limit)
+        Limit=Limit_Default();
+    return Limit;
+}
+
+//---------------------------------------------------------------------------
+// Pixels of the video frames parsed, frames for the other stats
+quint64 Work_Get(const FileInformation* File)
+{
+    quint64 Work=0;
+    for (auto Stat : File->Stats)
+    {
+        if (!Stat)
+            continue;
+        quint64 Frames=Stat->x_Current_Get();
+        auto Video=dynamic_cast<const VideoStats*>(Stat);
+        Work+=Video?Frames*std::max(1, Video->getWidth()*Video->getHeight()):Frames;
+    }
+    return Work;
+}
+
+//---------------------------------------------------------------------------
+// Running files counted in the limit, the one the user looks at is parsed in addition, the paused ones do not parse
+int Others()
+{
+    int Count=(int)Running.size();
+    for (const auto& Item : Running)
+        if (Item.File==Current || Item.Paused)
+            Count--;
+    return Count;
+}
+
+//---------------------------------------------------------------------------
+void Running_Remove(FileInformation* File)
+{
+    Running.erase(std::remove_if(Running.begin(), Running.end(), [File](const running& Item) {return Item.File==File;}), Running.end());
+}
+
+}
+
+//***************************************************************************
+// Scheduling
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Priorities_Apply()
+{
+    bool IsCurrentRunning=std::any_of(Running.begin(), Running.end(), [](const running& Item) {return Item.File==Current;});
+    for (const auto& Item : Running)
+        Item.File->parsingPriority_Set(!IsCurrentRunning?QThread::InheritPriority:(Item.File==Current?QThread::NormalPriority:QThread::LowPriority));
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Throttle_Apply()
+{
+    // Running files share the cores, so a share of them fits in the cores of the cap
+    int Active=(int)std::count_if(Running.begin(), Running.end(), [](const running& Item) {return !Item.Paused;});
+    int Cores=std::max(1, QThread::idealThreadCount());
+    int Allowed=Interacting?std::max(1, Active*std::min(Interaction_Cores, Cores)/Cores):Active;
+
+    // The file the user looks at first, then in start order
+    int Kept=0;
+    auto Apply=[&](running& Item) {
+        bool Throttled=!Item.Paused && Kept++>=Allowed;
+        if (Throttled==Item.Throttled)
+            return;
+        Item.Throttled=Throttled;
+        Item.File->parsingThrottled_Set(Throttled);
+    };
+    for (auto& Item : Running)
+        if (Item.File==Current)
+            Apply(Item);
+    for (auto& Item : Running)
+        if (Item.File!=Current)
+            Apply(Item);
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Measure()
+{
+    // Finished files since the last measure are not counted, the rate is a bit lower for one measure
+    qint64 Milliseconds=Elapsed.restart();
+    quint64 Work=0;
+    for (auto& Item : Running)
+    {
+        quint64 Item_Work=Work_Get(Item.File);
+        Work+=Item_Work>Item.Work?Item_Work-Item.Work:0;
+        Item.Work=Item_Work;
+    }
+    if (Max_Fixed>0 || Pending.isEmpty() || Others()!=Limit_Get() || Milliseconds<=0 || !Work || Interacting)
+    {
+        // Not applicable, or the limit is not reached (files still ending after a decrease), or files are held
+        Rate_Previous=-1;
+        return;
+    }
+    double Rate=Work*1000.0/Milliseconds;
+
+    // More files while they give more work done, fewer when they do not
+    if (Rate_Previous>=0)
+    {
+        if (Rate<Rate_Previous*(1-Gain_Min))
+            Direction=-Direction;
+        else if (Rate<=Rate_Previous*(1+Gain_Min))
+            Direction=-1;
+    }
+    Rate_Previous=Rate;
+    int Limit_New=std::max(1, std::min(Limit+Direction, Limit_Default()));
+    if (Limit_New==Limit)
+        return;
+    qDebug() << "parsing scheduler:" << Limit << "->" << Limit_New << "files at the same time," << (qint64)Rate << "work by second";
+    Limit=Limit_New;
+    Schedule();
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Start(FileInformation* File)
+{
+    // Before the parsing starts, it may end at once
+    Running.push_back({File, Work_Get(File), false, false});
+    File->startParse_Now();
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Schedule()
+{
+    if (Current && Pending.removeAll(Current))
+        Start(Current);
+    while (!Pending.isEmpty() && Others()<Limit_Get())
+        Start(Pending.takeFirst());
+    Priorities_Apply();
+    Throttle_Apply();
+
+    if (!Timer)
+    {
+        Timer=new QTimer(QCoreApplication::instance());
+        Timer->setInterval(Period);
+        QObject::connect(Timer, &QTimer::timeout, Timer, &Measure);
+    }
+    if (Running.empty())
+        Timer->stop();
+    else if (!Timer->isActive())
+    {
+        Elapsed.start();
+        Timer->start();
+    }
+}
+
+//***************************************************************************
+// Requests
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Request(FileInformation* File)
+{
+    if (Pending.contains(File))
+        return;
+    Pending.append(File);
+    Schedule();
+}
+
+//---------------------------------------------------------------------------
+bool ParsingScheduler::Cancel(FileInformation* File)
+{
+    return Pending.removeAll(File);
+}
+
+//---------------------------------------------------------------------------
+bool ParsingScheduler::IsPending(const FileInformation* File)
+{
+    return Pending.contains(const_cast<FileInformation*>(File));
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Finished(FileInformation* File)
+{
+    Running_Remove(File);
+    Schedule();
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Forget(FileInformation* File)
+{
+    Pending.removeAll(File);
+    Running_Remove(File);
+    if (Current==File)
+        Current=nullptr;
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Paused_Set(FileInformation* File, bool Paused)
+{
+    for (auto& Item : Running)
+        if (Item.File==File)
+            Item.Paused=Paused;
+    Schedule();
+}
+
+//***************************************************************************
+// Configuration
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Current_Set(FileInformation* File)
+{
+    if (Current==File)
+        return;
+    Current=File;
+    Schedule();
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Max_Set(int Count)
+{
+    Max_Fixed=Count;
+    Limit=0;
+    Direction=1;
+    Rate_Previous=-1;
+}
+
+//---------------------------------------------------------------------------
+int ParsingScheduler::Max_Get()
+{
+    return Limit_Get();
+}
+
+//***************************************************************************
+// Interactions
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Interaction()
+{
+    if (!Interaction_Cores || Running.empty())
+        return;
+
+    if (!Interaction_Timer)
+    {
+        Interaction_Timer=new QTimer(QCoreApplication::instance());
+        Interaction_Timer->setSingleShot(true);
+        Interaction_Timer->setInterval(Interaction_Idle);
+        QObject::connect(Interaction_Timer, &QTimer::timeout, Interaction_Timer, []() {
+            Interacting=false;
+            Throttle_Apply();
+        });
+    }
+    Interaction_Timer->start();
+    if (Interacting)
+        return;
+    Interacting=true;
+    Throttle_Apply();
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::InteractionCores_Set(int Cores)
+{
+    Interaction_Cores=std::max(0, Cores);
+    if (!Interaction_Cores && Interacting)
+    {
+        Interacting=false;
+        Throttle_Apply();
+    }
+}
+
+//---------------------------------------------------------------------------
+void ParsingScheduler::Background_Apply()
+{
+    // Inherited by the threads created afterwards by this one on Linux and macOS, not on Windows
+#if defined(_WIN32)
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#elif defined(__linux__)
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), Background_Nice);
+#endif
+}
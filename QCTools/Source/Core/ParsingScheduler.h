@@ -0,0 +1,77 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ParsingScheduler_H
+#define ParsingScheduler_H
+
+class FileInformation;
+
+//---------------------------------------------------------------------------
+// Files parsed at the same time by the process (GUI, batch of qcli).
+//
+// Parsing requests beyond the count of files parsed at the same time wait
+// and are started in order when a parsing ends, the file the user looks at
+// first: it is started at once even if the count is reached, and while it
+// is parsed the threads of the other parsers get a lower priority (see
+// QAVPlayer::setThreadPriority), so they use the cores it does not use.
+//
+// With an adaptive count (the default), the work done by all the parsers
+// (pixels of the video frames of each file, else frames) is measured every
+// few seconds while files are waiting: the count is raised while more files
+// give more work done, and lowered when they do not (cores or disk already
+// busy), between 1 and the cores count minus 2. Running parsers are never
+// stopped, the count is reached again when they end. Paused parsers (see
+// FileInformation::setParsingPaused) are not counted until they run again.
+// The threads of the decoder and of the filters of each parser are set
+// when the file is opened (see FileInformation::ParsingThreads_Apply).
+//
+// While the user interacts with the GUI (and for a second after), the
+// parsers can be capped to a count of cores: as many running files as fit
+// in them go on, the file the user looks at first, the others are held at a
+// frame boundary (not a pause, they stay counted) until the user is idle.
+// Main thread only.
+class ParsingScheduler
+{
+public:
+    // Started now or when the count allows it
+    static void                 Request                     (FileInformation* File);
+    // Not started yet, false if it was not waiting
+    static bool                 Cancel                      (FileInformation* File);
+    static bool                 IsPending                   (const FileInformation* File);
+    // Parsing ended, the next files are started
+    static void                 Finished                    (FileInformation* File);
+    // Deleted file
+    static void                 Forget                      (FileInformation* File);
+    // Running file paused (see FileInformation::setParsingPaused), not counted until it runs again
+    static void                 Paused_Set                  (FileInformation* File, bool Paused);
+
+    // File the user looks at, nullptr if none
+    static void                 Current_Set                 (FileInformation* File);
+
+    // Count of files parsed at the same time, 0 is adaptive
+    static void                 Max_Set                     (int Count);
+    // Current count
+    static int                  Max_Get                     ();
+
+    // The user interacts with the GUI (plots, player...)
+    static void                 Interaction                 ();
+    // Cores used by the parsers while the user interacts, 0 (default) for no cap
+    static void                 InteractionCores_Set        (int Cores);
+
+    // Calling thread (of a parser, before it creates the threads of its decoders and filters) at a background
+    // priority of the system: nice 10 on Linux, utility QoS class on macOS, background mode on Windows
+    static void                 Background_Apply            ();
+
+private:
+    static void                 Schedule                    ();
+    static void                 Start                       (FileInformation* File);
+    static void                 Priorities_Apply            ();
+    static void                 Throttle_Apply              ();
+    static void                 Measure                     ();
+};
+
+#endif // ParsingScheduler_H
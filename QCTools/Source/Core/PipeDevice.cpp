@@ -0,0 +1,211 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/PipeDevice.h"
+
+#include <QtAVPlayer/qaviodevice.h>
+#include <QFile>
+#include <QMetaObject>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Defaults
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static std::atomic<size_t> Default_Buffer_Size(64*1024*1024);
+
+// Read at once from the pipe, small enough for a live input
+static const size_t Chunk_Size=256*1024;
+
+//---------------------------------------------------------------------------
+void PipeDevice::Buffer_Size_Set(size_t Size)
+{
+    Default_Buffer_Size=std::max(Size, Chunk_Size);
+}
+
+//---------------------------------------------------------------------------
+size_t PipeDevice::Buffer_Size_Get()
+{
+    return Default_Buffer_Size;
+}
+
+//---------------------------------------------------------------------------
+// Thread of the devices, for the life of the process
+struct pipe_thread
+{
+    QThread Thread;
+
+    pipe_thread()
+    {
+        Thread.setObjectName("pipe");
+        Thread.start();
+    }
+    ~pipe_thread()
+    {
+        Thread.quit();
+        Thread.wait();
+    }
+};
+
+//---------------------------------------------------------------------------
+QSharedPointer<QAVIODevice> PipeDevice::Create()
+{
+    QSharedPointer<PipeDevice> Device(new PipeDevice(Default_Buffer_Size), &QObject::deleteLater);
+    if (!Device->open(QIODevice::ReadOnly))
+        return {};
+
+    static pipe_thread Thread;
+    QSharedPointer<QAVIODevice> IODevice(new QAVIODevice(Device), &QObject::deleteLater);
+    Device->moveToThread(&Thread.Thread);
+    IODevice->moveToThread(&Thread.Thread);
+    return IODevice;
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+PipeDevice::PipeDevice(size_t Buffer_Size_)
+: Buffer_Size(std::max(Buffer_Size_, Chunk_Size))
+{
+}
+
+//---------------------------------------------------------------------------
+PipeDevice::~PipeDevice()
+{
+    close();
+}
+
+//***************************************************************************
+// QIODevice
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool PipeDevice::open(OpenMode Mode)
+{
+    if (isOpen() || Buffer || (Mode&WriteOnly))
+        return false;
+
+    Buffer=std::make_shared<buffer>();
+    Buffer->Size=Buffer_Size;
+    std::thread(&PipeDevice::Load, Buffer).detach();
+
+    // Not buffered again by QIODevice
+    return QIODevice::open(Mode|Unbuffered);
+}
+
+//---------------------------------------------------------------------------
+void PipeDevice::close()
+{
+    if (Buffer)
+    {
+        // A thread waiting for the writer ends with the next bytes or the end of the pipe
+        {
+            std::lock_guard<std::mutex> Lock(Buffer->Mutex);
+            Buffer->Stop=true;
+        }
+        Buffer->Freed.notify_all();
+    }
+    QIODevice::close();
+}
+
+//---------------------------------------------------------------------------
+bool PipeDevice::atEnd() const
+{
+    if (!Buffer)
+        return true;
+    std::lock_guard<std::mutex> Lock(Buffer->Mutex);
+    return Buffer->Ended && !Buffer->Buffered;
+}
+
+//---------------------------------------------------------------------------
+qint64 PipeDevice::bytesAvailable() const
+{
+    if (!Buffer)
+        return 0;
+    std::lock_guard<std::mutex> Lock(Buffer->Mutex);
+    return (qint64)Buffer->Buffered;
+}
+
+//---------------------------------------------------------------------------
+qint64 PipeDevice::readData(char* Data, qint64 MaxSize)
+{
+    if (!Buffer)
+        return -1;
+
+    auto& B=*Buffer;
+    std::unique_lock<std::mutex> Lock(B.Mutex);
+    B.Loaded.wait(Lock, [&]() {return B.Buffered || B.Ended;});
+    if (!B.Buffered)
+    {
+        // QAVIODevice waits for more bytes when nothing is read, it sees the end once told
+        QMetaObject::invokeMethod(this, [this]() {Q_EMIT readyRead();}, Qt::QueuedConnection);
+        return 0;
+    }
+
+    qint64 Read=0;
+    while (Read<MaxSize && !B.Chunks.empty())
+    {
+        auto& Chunk=B.Chunks.front();
+        size_t Size=std::min((size_t)(MaxSize-Read), (size_t)Chunk.size()-B.Chunk_Offset);
+        std::memcpy(Data+Read, Chunk.constData()+B.Chunk_Offset, Size);
+        Read+=Size;
+        B.Chunk_Offset+=Size;
+        if (B.Chunk_Offset==(size_t)Chunk.size())
+        {
+            B.Chunks.pop_front();
+            B.Chunk_Offset=0;
+        }
+    }
+    B.Buffered-=(size_t)Read;
+    Lock.unlock();
+    B.Freed.notify_all();
+    return Read;
+}
+
+//***************************************************************************
+// Thread
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void PipeDevice::Load(std::shared_ptr<buffer> Buffer)
+{
+    QFile File;
+    bool IsOpen=File.open(stdin, QIODevice::ReadOnly|QIODevice::Unbuffered);
+
+    auto& B=*Buffer;
+    std::unique_lock<std::mutex> Lock(B.Mutex);
+    while (IsOpen && !B.Stop)
+    {
+        // The writer waits for room once the buffer is full
+        B.Freed.wait(Lock, [&]() {return B.Stop || B.Buffered+Chunk_Size<=B.Size;});
+        if (B.Stop)
+            break;
+
+        Lock.unlock();
+        QByteArray Chunk((int)Chunk_Size, Qt::Uninitialized);
+        qint64 Size=File.read(Chunk.data(), Chunk.size());
+        Lock.lock();
+        if (Size<=0)
+            break;
+        Chunk.resize((int)Size);
+        B.Chunks.push_back(std::move(Chunk));
+        B.Buffered+=(size_t)Size;
+        B.Loaded.notify_all();
+    }
+
+    B.Ended=true;
+    B.Loaded.notify_all();
+}
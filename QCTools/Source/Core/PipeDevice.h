@@ -0,0 +1,77 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef PipeDevice_H
+#define PipeDevice_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QSharedPointer>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+class QAVIODevice;
+
+//---------------------------------------------------------------------------
+// Standard input of the parser (-i -, e.g. the output of a transcoder) read
+// by a thread into a bounded buffer: the writer is not blocked while the
+// frames are decoded, and the memory does not grow when the analysis is the
+// slower one, the writer waits for room instead.
+//
+// A pipe can be read once, so this device is its only reader: the demuxer of
+// the parser probes the streams from the head of the buffer, and its context
+// gives the format and streams stats. There is no report lookup, no media
+// player, no second pass (packets, key frames, segments) for a pipe.
+class PipeDevice : public QIODevice
+{
+public:
+                                PipeDevice                  (size_t Buffer_Size);
+                                ~PipeDevice                 ();
+
+    // Bytes buffered at most by the parsers of a pipe opened afterwards (64 MiB by default)
+    static void                 Buffer_Size_Set             (size_t Size);
+    static size_t               Buffer_Size_Get             ();
+
+    // Device for the parser of the standard input, null if it can not be opened
+    // QAVIODevice reads in the thread of its object, so the device lives in a thread of its own, as ReadaheadDevice
+    static QSharedPointer<QAVIODevice> Create               ();
+
+    // QIODevice
+    bool                        open                        (OpenMode Mode) override;
+    void                        close                       () override;
+    bool                        isSequential                () const override {return true;}
+    bool                        atEnd                       () const override;
+    qint64                      bytesAvailable              () const override;
+
+protected:
+    qint64                      readData                    (char* Data, qint64 MaxSize) override;
+    qint64                      writeData                   (const char*, qint64) override {return -1;}
+
+private:
+    // Shared with the thread, kept by a thread still waiting for the writer once the device is closed
+    struct buffer
+    {
+        size_t                  Size;
+        std::mutex              Mutex;
+        std::condition_variable Loaded;                     // Bytes added or end of the input
+        std::condition_variable Freed;                      // Bytes read
+        std::deque<QByteArray>  Chunks;
+        size_t                  Chunk_Offset=0;             // Read in the first chunk
+        size_t                  Buffered=0;
+        bool                    Ended=false;
+        bool                    Stop=false;
+    };
+    static void                 Load                        (std::shared_ptr<buffer> Buffer);
+
+    size_t                      Buffer_Size;
+    std::shared_ptr<buffer>     Buffer;
+};
+
+#endif // PipeDevice_H
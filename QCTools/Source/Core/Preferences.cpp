@@ -17,6 +17,7 @@
 #include <QJsonArray>
 #include <QStandardPaths>
 #include <QFileInfo>
+#include <QThread>
 
 #include "qblowfish.h"
 
@@ -34,6 +35,21 @@ QString KeySignalServerPassword = "SignalServerPassword";
 
 QString KeyActiveFilters = "ActiveFilters";
 QString KeyActiveAllTracks = "ActiveAllTracks";
+QString KeyDecoderThreads = "DecoderThreads";
+QString KeyDecoderThreadType = "DecoderThreadType";
+QString KeyFilterThreads = "FilterThreads";
+QString KeyThumbnailsCodec = "ThumbnailsCodec";
+QString KeyPanelsCodec = "PanelsCodec";
+QString KeyReportCompression = "ReportCompression";
+QString KeyReportCompressionLevel = "ReportCompressionLevel";
+QString KeyPlotsOpenGL = "PlotsOpenGL";
+QString KeySampling = "Sampling";
+QString KeyMemoryBudget = "MemoryBudget";
+QString KeyStatsColdCompression = "StatsColdCompression";
+QString KeyAnalysisProfile = "AnalysisProfile";
+QString KeyBackgroundAnalysis = "BackgroundAnalysis";
+QString KeyAnalysisProcess = "AnalysisProcess";
+QString KeyBackgroundAnalysisCores = "BackgroundAnalysisCores";
 QString KeyActivePanels = "ActivePanels";
 QString KeyFilterSelectorsOrder = "filterSelectorsOrder";
 
@@ -79,13 +95,195 @@ void Preferences::setActiveAllTracks(const activealltracks &alltracks)
     settings.setValue(KeyActiveAllTracks, (uint) alltracks.to_ulong());
 }
 
-QMap<QString, std::tuple<QString, QString, QString, QString, int>> Preferences::getActivePanels() const
+int Preferences::decoderThreads() const
 {
-    auto activePanelsMap = QMap<QString, std::tuple<QString, QString, QString, QString, int>>();
-    for(auto panelInfo : availablePanels())
+    QSettings settings;
+    return settings.value(KeyDecoderThreads, 0).toInt();
+}
+
+void Preferences::setDecoderThreads(int count)
+{
+    QSettings settings;
+    settings.setValue(KeyDecoderThreads, count);
+}
+
+QString Preferences::decoderThreadType() const
+{
+    QSettings settings;
+    return settings.value(KeyDecoderThreadType).toString();
+}
+
+void Preferences::setDecoderThreadType(const QString &type)
+{
+    QSettings settings;
+    settings.setValue(KeyDecoderThreadType, type);
+}
+
+int Preferences::filterThreads() const
+{
+    QSettings settings;
+    return settings.value(KeyFilterThreads, 0).toInt();
+}
+
+void Preferences::setFilterThreads(int count)
+{
+    QSettings settings;
+    settings.setValue(KeyFilterThreads, count);
+}
+
+QString Preferences::thumbnailsCodec() const
+{
+    QSettings settings;
+    return settings.value(KeyThumbnailsCodec).toString();
+}
+
+void Preferences::setThumbnailsCodec(const QString &codec)
+{
+    QSettings settings;
+    settings.setValue(KeyThumbnailsCodec, codec);
+}
+
+QString Preferences::panelsCodec() const
+{
+    QSettings settings;
+    return settings.value(KeyPanelsCodec).toString();
+}
+
+void Preferences::setPanelsCodec(const QString &codec)
+{
+    QSettings settings;
+    settings.setValue(KeyPanelsCodec, codec);
+}
+
+QString Preferences::reportCompression() const
+{
+    QSettings settings;
+    return settings.value(KeyReportCompression, "gzip").toString();
+}
+
+void Preferences::setReportCompression(const QString &format)
+{
+    QSettings settings;
+    settings.setValue(KeyReportCompression, format);
+}
+
+int Preferences::reportCompressionLevel() const
+{
+    QSettings settings;
+    return settings.value(KeyReportCompressionLevel, -1).toInt();
+}
+
+void Preferences::setReportCompressionLevel(int level)
+{
+    QSettings settings;
+    settings.setValue(KeyReportCompressionLevel, level);
+}
+
+bool Preferences::plotsOpenGL() const
+{
+    QSettings settings;
+    return settings.value(KeyPlotsOpenGL, false).toBool();
+}
+
+void Preferences::setPlotsOpenGL(bool enabled)
+{
+    QSettings settings;
+    settings.setValue(KeyPlotsOpenGL, enabled);
+}
+
+int Preferences::sampling() const
+{
+    QSettings settings;
+    return settings.value(KeySampling, 0).toInt();
+}
+
+void Preferences::setSampling(int every)
+{
+    QSettings settings;
+    settings.setValue(KeySampling, every);
+}
+
+int Preferences::memoryBudget() const
+{
+    QSettings settings;
+    return settings.value(KeyMemoryBudget, 0).toInt();
+}
+
+void Preferences::setMemoryBudget(int megabytes)
+{
+    QSettings settings;
+    settings.setValue(KeyMemoryBudget, megabytes);
+}
+
+bool Preferences::statsColdCompression() const
+{
+    QSettings settings;
+    return settings.value(KeyStatsColdCompression, false).toBool();
+}
+
+void Preferences::setStatsColdCompression(bool enabled)
+{
+    QSettings settings;
+    settings.setValue(KeyStatsColdCompression, enabled);
+}
+
+QString Preferences::analysisProfile() const
+{
+    QSettings settings;
+    return settings.value(KeyAnalysisProfile, "full").toString();
+}
+
+void Preferences::setAnalysisProfile(const QString& name)
+{
+    QSettings settings;
+    settings.setValue(KeyAnalysisProfile, name);
+}
+
+bool Preferences::backgroundAnalysis() const
+{
+    QSettings settings;
+    return settings.value(KeyBackgroundAnalysis, false).toBool();
+}
+
+void Preferences::setBackgroundAnalysis(bool enabled)
+{
+    QSettings settings;
+    settings.setValue(KeyBackgroundAnalysis, enabled);
+}
+
+bool Preferences::analysisProcess() const
+{
+    QSettings settings;
+    return settings.value(KeyAnalysisProcess, false).toBool();
+}
+
+void Preferences::setAnalysisProcess(bool enabled)
+{
+    QSettings settings;
+    settings.setValue(KeyAnalysisProcess, enabled);
+}
+
+int Preferences::backgroundAnalysisCores() const
+{
+    // A quarter of the cores by default
+    QSettings settings;
+    return settings.value(KeyBackgroundAnalysisCores, qMax(1, QThread::idealThreadCount() / 4)).toInt();
+}
+
+void Preferences::setBackgroundAnalysisCores(int count)
+{
+    QSettings settings;
+    settings.setValue(KeyBackgroundAnalysisCores, count);
+}
+
+QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>> Preferences::getActivePanels() const
+{
+    auto activePanelsMap = QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>>();
+    auto active = activePanels();
+    for(const auto& panelInfo : availablePanels())
     {
-        if(activePanels().contains(panelInfo.name))
-            activePanelsMap[panelInfo.name] = std::tuple<QString, QString, QString, QString, int>(panelInfo.filterchain, panelInfo.version, panelInfo.yaxis, panelInfo.legend, panelInfo.panelType);
+        if(active.contains(panelInfo.name))
+            activePanelsMap[panelInfo.name] = std::tuple<QString, QString, QString, QString, int, QString>(panelInfo.filterchain, panelInfo.version, panelInfo.yaxis, panelInfo.legend, panelInfo.panelType, panelInfo.native);
     }
     return activePanelsMap;
 }
@@ -139,6 +337,13 @@ void Preferences::setActivePanels(const QSet<QString> &activePanels)
 }
 
 QList<PanelInfo> Preferences::availablePanels() const
+{
+    // The resource does not change, it is parsed on the first call only
+    static const QList<PanelInfo> panels = loadAvailablePanels();
+    return panels;
+}
+
+QList<PanelInfo> Preferences::loadAvailablePanels()
 {
     QList<PanelInfo> panels;
 
@@ -158,8 +363,9 @@ QList<PanelInfo> Preferences::availablePanels() const
                 auto panelType = panel.value("panel_type").toString() == "audio" ?
                             1 /* AVMEDIA_TYPE_AUDIO */ : 0 /* AVMEDIA_TYPE_VIDEO */;
                 auto legend = panel.value("legend").toString();
+                auto native = panel.value("native").toString();
 
-                PanelInfo panelInfo { panelName, panelYAxis, panelFilterchain, panelVersion, legend, panelType };
+                PanelInfo panelInfo { panelName, panelYAxis, panelFilterchain, panelVersion, legend, panelType, native };
                 panels.append(panelInfo);
 
             }
@@ -25,6 +25,7 @@ struct PanelInfo {
     QString version;
     QString legend;
     int panelType; // AVMEDIA_TYPE_VIDEO / AVMEDIA_TYPE_AUDIO
+    QString native; // Built without the filter chain, see PanelBuilder::Mode_Get (empty for the filter chain)
 };
 
 class Preferences : public QObject
@@ -38,11 +39,68 @@ public:
     activealltracks activeAllTracks() const;
     void setActiveAllTracks(const activealltracks& alltracks);
 
-    QMap<QString, std::tuple<QString, QString, QString, QString, int>> getActivePanels() const;
+    // Threads of the stats parser, see FileInformation::DecoderThreads_Set() (0 means depending on the cores count)
+    int decoderThreads() const;
+    void setDecoderThreads(int count);
+
+    QString decoderThreadType() const;
+    void setDecoderThreadType(const QString& type);
+
+    int filterThreads() const;
+    void setFilterThreads(int count);
+
+    // Encoders of the .qctools.mkv reports, see FileInformation::ThumbnailsCodec_Set() (empty means MJPEG)
+    QString thumbnailsCodec() const;
+    void setThumbnailsCodec(const QString& codec);
+
+    QString panelsCodec() const;
+    void setPanelsCodec(const QString& codec);
+
+    // Compression of the reports named by default and level of the exports, see StatsCompression::Format_Set() (empty means gzip, -1 the default level)
+    QString reportCompression() const;
+    void setReportCompression(const QString& format);
+
+    int reportCompressionLevel() const;
+    void setReportCompressionLevel(int level);
+
+    // Canvas of the plots painted by OpenGL, see Plot::setOpenGLCanvas()
+    bool plotsOpenGL() const;
+    void setPlotsOpenGL(bool enabled);
+
+    // Video frames parsed for a preview, see FileInformation::Sampling_Set() (0 means all of them)
+    int sampling() const;
+    void setSampling(int every);
+
+    // Memory of all the open files in MB before the files not displayed are released, see MemoryBudget (0 means no limit)
+    int memoryBudget() const;
+    void setMemoryBudget(int megabytes);
+
+    // Stats of the files released compressed in memory, see CommonStats::ColdCompression_Set()
+    bool statsColdCompression() const;
+    void setStatsColdCompression(bool enabled);
+
+    // Columns analyzed ("full", "luma-only" or "broadcast-legal"), see AnalysisProfiles
+    QString analysisProfile() const;
+    void setAnalysisProfile(const QString& name);
+
+    // Parsers at a background priority of the system, capped while the user interacts, see FileInformation::BackgroundParsing_Set()
+    bool backgroundAnalysis() const;
+    void setBackgroundAnalysis(bool enabled);
+
+    // Files parsed by a helper process, see FileInformation::AnalysisProcess_Set()
+    bool analysisProcess() const;
+    void setAnalysisProcess(bool enabled);
+
+    // Cores of the parsers while the user interacts with background analysis, see FileInformation::ParsingInteractionCores_Set()
+    int backgroundAnalysisCores() const;
+    void setBackgroundAnalysisCores(int count);
+
+    QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>> getActivePanels() const;
 
     QSet<QString> activePanels() const;
     void setActivePanels(const QSet<QString>& activePanels);
 
+    // Panels of the resources, parsed once
     QList<PanelInfo> availablePanels() const;
 
     FilterSelectorsOrder loadFilterSelectorsOrder();
@@ -76,6 +134,9 @@ public:
 
     void sync();
     void resetSettings();
+
+private:
+    static QList<PanelInfo> loadAvailablePanels();
 };
 
 Q_DECLARE_METATYPE(GroupAndType)
@@ -0,0 +1,192 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/QCvaultIndex.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <vector>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+static const char       Index_FileName[]="qcvault.index";
+static const int        Fingerprint_Blocks=16;
+static const qint64     Fingerprint_BlockSize=64*1024;
+
+namespace
+{
+//---------------------------------------------------------------------------
+struct entry
+{
+    activefilters           Filters;
+    QString                 ReportFileName;             // Relative to the directory
+};
+
+//---------------------------------------------------------------------------
+struct directory
+{
+    QHash<QByteArray, std::vector<entry>> Entries;     // By fingerprint, in the order of the file
+    qint64                  Read=0;                     // Bytes of the index file already read
+    QStringList             Names;                      // Sorted
+    QDateTime               Names_Modified;             // Of the directory when listed
+};
+
+QMutex                      Directories_Mutex;
+QHash<QString, directory>   Directories;
+
+//---------------------------------------------------------------------------
+QByteArray Filters_Text(const activefilters& Filters)
+{
+    QByteArray Text(ActiveFilter_Max, '0');
+    for (size_t Pos=0; Pos<ActiveFilter_Max; Pos++)
+        if (Filters[Pos])
+            Text[(int)Pos]='1';
+    return Text;
+}
+
+//---------------------------------------------------------------------------
+// Lines appended since the last call, the last incomplete line is read next time
+void Directory_Update(const QString& Directory, directory& Index)
+{
+    QFile File(Directory+'/'+Index_FileName);
+    if (!File.open(QIODevice::ReadOnly))
+        return;
+    if (File.size()<Index.Read)
+    {
+        // Replaced
+        Index.Entries.clear();
+        Index.Read=0;
+    }
+    if (File.size()==Index.Read || !File.seek(Index.Read))
+        return;
+
+    QByteArray Content=File.readAll();
+    int Begin=0;
+    for (int End; (End=Content.indexOf('\n', Begin))>=0; Begin=End+1)
+    {
+        auto Fields=Content.mid(Begin, End-Begin).split('\t');
+        if (Fields.size()!=3 || Fields[0].isEmpty() || Fields[2].isEmpty())
+            continue;
+
+        // Filters unknown by this version are ignored
+        entry Entry;
+        for (int Pos=0; Pos<Fields[1].size() && Pos<ActiveFilter_Max; Pos++)
+            Entry.Filters[Pos]=Fields[1][Pos]=='1';
+        Entry.ReportFileName=QString::fromUtf8(Fields[2]);
+        Index.Entries[Fields[0]].push_back(Entry);
+    }
+    Index.Read+=Begin;
+}
+}
+
+//***************************************************************************
+// Fingerprint
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+QByteArray QCvaultIndex::Fingerprint(const QString& FileName)
+{
+    QFile File(FileName);
+    if (!QFileInfo(FileName).isFile() || !File.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    // Blocks evenly spaced from the beginning to the end, the whole file if small
+    qint64 Size=File.size();
+    QCryptographicHash Hash(QCryptographicHash::Md5);
+    if (Size<=Fingerprint_Blocks*Fingerprint_BlockSize)
+        Hash.addData(File.readAll());
+    else
+        for (int Block=0; Block<Fingerprint_Blocks; Block++)
+        {
+            if (!File.seek((Size-Fingerprint_BlockSize)/(Fingerprint_Blocks-1)*Block))
+                return QByteArray();
+            Hash.addData(File.read(Fingerprint_BlockSize));
+        }
+
+    return QByteArray::number(Size, 16)+'-'+Hash.result().toHex();
+}
+
+//***************************************************************************
+// Index
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool QCvaultIndex::Exists(const QString& Directory)
+{
+    return !Directory.isEmpty() && QFileInfo(QDir(Directory).absolutePath()+'/'+Index_FileName).isFile();
+}
+
+//---------------------------------------------------------------------------
+QString QCvaultIndex::Find(const QString& Directory, const QByteArray& Fingerprint, const activefilters& Filters)
+{
+    if (Directory.isEmpty() || Fingerprint.isEmpty())
+        return QString();
+
+    QString Path=QDir(Directory).absolutePath();
+    QMutexLocker Lock(&Directories_Mutex);
+    auto& Index=Directories[Path];
+    Directory_Update(Path, Index);
+
+    auto Entries=Index.Entries.find(Fingerprint);
+    if (Entries==Index.Entries.end())
+        return QString();
+    for (auto Entry=Entries->rbegin(); Entry!=Entries->rend(); ++Entry)
+    {
+        if ((Entry->Filters&Filters)!=Filters)
+            continue;
+        QString ReportFileName=Path+'/'+Entry->ReportFileName;
+        if (QFile::exists(ReportFileName))
+            return ReportFileName;
+    }
+    return QString();
+}
+
+//---------------------------------------------------------------------------
+bool QCvaultIndex::Add(const QString& Directory, const QByteArray& Fingerprint, const activefilters& Filters, const QString& ReportFileName)
+{
+    if (Directory.isEmpty() || Fingerprint.isEmpty())
+        return false;
+
+    // One write per line, lines of concurrent processes are not mixed
+    QString Path=QDir(Directory).absolutePath();
+    QByteArray Line=Fingerprint+'\t'+Filters_Text(Filters)+'\t'+QDir(Path).relativeFilePath(ReportFileName).toUtf8()+'\n';
+    QMutexLocker Lock(&Directories_Mutex);
+    QFile File(Path+'/'+Index_FileName);
+    return File.open(QIODevice::WriteOnly|QIODevice::Append) && File.write(Line)==Line.size();
+}
+
+//***************************************************************************
+// Listing
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+QStringList QCvaultIndex::Names(const QString& Directory, const QString& Prefix, const QString& Suffix)
+{
+    QString Path=QDir(Directory).absolutePath();
+    QDateTime Modified=QFileInfo(Path).lastModified();
+    QMutexLocker Lock(&Directories_Mutex);
+    auto& Index=Directories[Path];
+    if (!Index.Names_Modified.isValid() || Index.Names_Modified!=Modified)
+    {
+        Index.Names=QDir(Path).entryList(QDir::Files);
+        std::sort(Index.Names.begin(), Index.Names.end());
+        Index.Names_Modified=Modified;
+    }
+
+    QStringList List;
+    for (auto Name=std::lower_bound(Index.Names.cbegin(), Index.Names.cend(), Prefix); Name!=Index.Names.cend() && Name->startsWith(Prefix); ++Name)
+        if (Name->endsWith(Suffix) && Name->size()>=Prefix.size()+Suffix.size())
+            List.append(*Name);
+    return List;
+}
@@ -0,0 +1,49 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef QCvaultIndex_H
+#define QCvaultIndex_H
+
+#include "Core/Core.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+//---------------------------------------------------------------------------
+// Index of the reports of a QCvault directory by the content of their media,
+// so finding the report of a file does not scan the directory and a copy or a
+// renamed file finds the report of the original.
+//
+// The index is "qcvault.index" in the QCvault directory, one line per report
+// appended when it is written: fingerprint, filters (bit 0 first) and file
+// name of the report relative to the directory. It is read once per process
+// then only what was appended since. A report is found for a set of filters
+// if it has at least these filters, the last one added wins.
+//
+// Reports written before the index are found by their name: the listing of
+// the directory is kept and read again only when the directory changed.
+class QCvaultIndex
+{
+public:
+    // Size and hash of sampled blocks of the media, empty if it can not be read
+    static QByteArray           Fingerprint                 (const QString& FileName);
+
+    // If Directory has an index
+    static bool                 Exists                      (const QString& Directory);
+
+    // Absolute file name of an existing report, empty if none
+    static QString              Find                        (const QString& Directory, const QByteArray& Fingerprint, const activefilters& Filters);
+
+    // Report written in Directory
+    static bool                 Add                         (const QString& Directory, const QByteArray& Fingerprint, const activefilters& Filters, const QString& ReportFileName);
+
+    // File names in Directory starting with Prefix and ending with Suffix
+    static QStringList          Names                       (const QString& Directory, const QString& Prefix, const QString& Suffix);
+};
+
+#endif // QCvaultIndex_H
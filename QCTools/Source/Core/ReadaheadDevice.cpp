@@ -0,0 +1,376 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/ReadaheadDevice.h"
+#include "Core/UringQueue.h"
+
+#include <QtAVPlayer/qaviodevice.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Defaults
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static std::atomic<size_t> Default_Block(4*1024*1024);
+static std::atomic<size_t> Default_Blocks(0);
+
+//---------------------------------------------------------------------------
+void ReadaheadDevice::Default_Set(size_t Block_Size, size_t Depth)
+{
+    Default_Block=std::max(Block_Size, (size_t)64*1024);
+    Default_Blocks=Depth;
+}
+
+//---------------------------------------------------------------------------
+size_t ReadaheadDevice::Default_Block_Size()
+{
+    return Default_Block;
+}
+
+//---------------------------------------------------------------------------
+size_t ReadaheadDevice::Default_Depth()
+{
+    return Default_Blocks;
+}
+
+//---------------------------------------------------------------------------
+// Thread of the devices, for the life of the process
+struct readahead_thread
+{
+    QThread Thread;
+
+    readahead_thread()
+    {
+        Thread.setObjectName("readahead");
+        Thread.start();
+    }
+    ~readahead_thread()
+    {
+        Thread.quit();
+        Thread.wait();
+    }
+};
+
+//---------------------------------------------------------------------------
+QSharedPointer<QAVIODevice> ReadaheadDevice::Create(const QString& FileName)
+{
+    size_t Depth=Default_Blocks?Default_Blocks:(UringQueue::Enabled_Get()?8:0);
+    if (!Depth || !QFileInfo(FileName).isFile())
+        return {};
+
+    QSharedPointer<ReadaheadDevice> Device(new ReadaheadDevice(FileName, Default_Block, Depth), &QObject::deleteLater);
+    if (!Device->open(QIODevice::ReadOnly))
+        return {};
+
+    static readahead_thread Thread;
+    QSharedPointer<QAVIODevice> IODevice(new QAVIODevice(Device), &QObject::deleteLater);
+    Device->moveToThread(&Thread.Thread);
+    IODevice->moveToThread(&Thread.Thread);
+    return IODevice;
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+ReadaheadDevice::ReadaheadDevice(const QString& FileName_, size_t Block_Size_, size_t Depth_)
+: FileName(FileName_),
+  Block_Size(std::max(Block_Size_, (size_t)64*1024)),
+  Depth(std::max(Depth_, (size_t)1)),
+  Uring(UringQueue::Enabled_Get())
+{
+}
+
+//---------------------------------------------------------------------------
+ReadaheadDevice::~ReadaheadDevice()
+{
+    close();
+}
+
+//***************************************************************************
+// QIODevice
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool ReadaheadDevice::open(OpenMode Mode)
+{
+    if (isOpen() || (Mode&WriteOnly))
+        return false;
+
+    QFile File(FileName);
+    if (!File.open(QIODevice::ReadOnly))
+    {
+        setErrorString(File.errorString());
+        return false;
+    }
+    File_Size=File.size();
+    File.close();
+
+    Stop=false;
+    Current=0;
+    Blocks.clear();
+    Thread=std::thread(Uring?&ReadaheadDevice::Load_Uring:&ReadaheadDevice::Load, this);
+
+    // Not buffered again by QIODevice
+    return QIODevice::open(Mode|Unbuffered);
+}
+
+//---------------------------------------------------------------------------
+void ReadaheadDevice::close()
+{
+    if (Thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Stop=true;
+        }
+        Wanted.notify_all();
+        Thread.join();
+    }
+    Blocks.clear();
+    QIODevice::close();
+}
+
+//---------------------------------------------------------------------------
+bool ReadaheadDevice::seek(qint64 Pos)
+{
+    if (Pos<0 || Pos>File_Size || !QIODevice::seek(Pos))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Current=(size_t)Pos/Block_Size;
+    }
+    Wanted.notify_all();
+    return true;
+}
+
+//---------------------------------------------------------------------------
+qint64 ReadaheadDevice::readData(char* Data, qint64 MaxSize)
+{
+    qint64 Pos=pos();
+    qint64 Read=0;
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (Read<MaxSize && Pos+Read<File_Size)
+    {
+        size_t Index=(size_t)(Pos+Read)/Block_Size;
+        if (Current!=Index)
+        {
+            Current=Index;
+            Wanted.notify_all();
+        }
+
+        auto Block=Blocks.find(Index);
+        if (Block==Blocks.end())
+        {
+            // The data already copied is returned first
+            if (Read)
+                break;
+            Loaded.wait(Lock, [&]() {return Stop || Blocks.count(Index);});
+            if (Stop)
+                return -1;
+            continue;
+        }
+        if (Block->second.isEmpty())
+        {
+            if (Read)
+                break;
+            setErrorString("read error");
+            return -1;
+        }
+
+        size_t Offset=(size_t)(Pos+Read)-Index*Block_Size;
+        if (Offset>=(size_t)Block->second.size())
+            break; // File shorter than when opened
+        size_t Size=std::min((size_t)(MaxSize-Read), (size_t)Block->second.size()-Offset);
+        std::memcpy(Data+Read, Block->second.constData()+Offset, Size);
+        Read+=Size;
+    }
+    return Read;
+}
+
+//***************************************************************************
+// Thread
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ReadaheadDevice::Load()
+{
+    QFile File(FileName);
+    bool IsOpen=File.open(QIODevice::ReadOnly|QIODevice::Unbuffered);
+    size_t Blocks_Count=(size_t)((File_Size+Block_Size-1)/Block_Size);
+
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (!Stop)
+    {
+        // Blocks out of the window are freed, the first missing one is loaded
+        size_t First=Current?Current-1:0;
+        size_t Last=std::min(Current+Depth, Blocks_Count);
+        for (auto Block=Blocks.begin(); Block!=Blocks.end();)
+        {
+            if (Block->first<First || Block->first>=Last)
+                Block=Blocks.erase(Block);
+            else
+                ++Block;
+        }
+        size_t Index=Current;
+        while (Index<Last && Blocks.count(Index))
+            Index++;
+        if (Index>=Last)
+        {
+            if (Current && !Blocks.count(Current-1) && Current-1<Blocks_Count)
+                Index=Current-1;
+            else
+            {
+                Wanted.wait(Lock);
+                continue;
+            }
+        }
+
+        Lock.unlock();
+        QByteArray Data;
+        if (IsOpen && File.seek((qint64)Index*Block_Size))
+        {
+            Data.resize((int)std::min((qint64)Block_Size, File_Size-(qint64)Index*Block_Size));
+            qint64 Size=File.read(Data.data(), Data.size());
+            Data.resize(Size>0?(int)Size:0);
+        }
+        Lock.lock();
+
+        Blocks[Index]=Data;
+        Loaded.notify_all();
+    }
+
+    Loaded.notify_all();
+}
+
+//---------------------------------------------------------------------------
+void ReadaheadDevice::Load_Uring()
+{
+    struct slot
+    {
+        QByteArray              Data;
+        qint64                  Block=-1;                   // Loaded or being read in Data, -1 if free
+        bool                    Reading=false;
+    };
+
+    // The window and the block before it, registered once
+    std::vector<slot> Slots(Depth+1);
+    UringQueue Queue((unsigned)Slots.size());
+    if (!Queue.IsOpen())
+    {
+        Load();
+        return;
+    }
+    std::vector<std::pair<void*, size_t>> Buffers;
+    for (auto& Slot : Slots)
+    {
+        Slot.Data.resize((int)Block_Size);
+        Buffers.emplace_back(Slot.Data.data(), Block_Size);
+    }
+
+    QFile File(FileName);
+    bool IsOpen=File.open(QIODevice::ReadOnly|QIODevice::Unbuffered);
+    size_t Blocks_Count=(size_t)((File_Size+Block_Size-1)/Block_Size);
+    if (IsOpen)
+        Queue.Buffers_Register(Buffers);
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        auto InWindow=[&](qint64 Index) {
+            return Index>=(qint64)(Current?Current-1:0) && Index<(qint64)std::min(Current+Depth, Blocks_Count);
+        };
+        while (!Stop)
+        {
+            size_t First=Current?Current-1:0;
+            size_t Last=std::min(Current+Depth, Blocks_Count);
+            for (auto Block=Blocks.begin(); Block!=Blocks.end();)
+            {
+                if (!InWindow(Block->first))
+                    Block=Blocks.erase(Block);
+                else
+                    ++Block;
+            }
+            for (auto& Slot : Slots)
+                if (!Slot.Reading && !InWindow(Slot.Block))
+                    Slot.Block=-1;
+
+            // All the missing blocks of the window at once, from the current one
+            for (size_t Pos=0; Pos<Last-First; ++Pos)
+            {
+                size_t Index=Pos+Current>=Last?First:Current+Pos;
+                if (Blocks.count(Index) || std::any_of(Slots.begin(), Slots.end(), [&](const slot& Slot) {return Slot.Block==(qint64)Index;}))
+                    continue;
+                auto Slot=std::find_if(Slots.begin(), Slots.end(), [](const slot& Slot) {return Slot.Block==-1;});
+                if (Slot==Slots.end())
+                    break;
+                size_t Size=(size_t)std::min((qint64)Block_Size, File_Size-(qint64)Index*Block_Size);
+                if (!IsOpen || !Queue.Read(File.handle(), Slot->Data.data(), Size, (qint64)Index*Block_Size, Slot-Slots.begin(), Slot-Slots.begin()))
+                {
+                    Blocks[Index]=QByteArray(); // Read error
+                    Loaded.notify_all();
+                    continue;
+                }
+                Slot->Block=Index;
+                Slot->Reading=true;
+            }
+            if (!Queue.Pending())
+            {
+                Wanted.wait(Lock);
+                continue;
+            }
+
+            Lock.unlock();
+            bool IsOk=Queue.Submit(1);
+            std::vector<std::pair<uint64_t, int>> Results;
+            uint64_t Slot_Index;
+            int Result;
+            while (Queue.Complete(Slot_Index, Result))
+                Results.emplace_back(Slot_Index, Result);
+            for (auto& Item : Results)
+            {
+                // Short read, the rest is read at once
+                auto& Slot=Slots[Item.first];
+                qint64 Size=std::min((qint64)Block_Size, File_Size-Slot.Block*(qint64)Block_Size);
+                if (Item.second>0 && Item.second<Size && File.seek(Slot.Block*(qint64)Block_Size+Item.second))
+                {
+                    qint64 Rest=File.read(Slot.Data.data()+Item.second, Size-Item.second);
+                    Item.second+=Rest>0?(int)Rest:0;
+                }
+            }
+            Lock.lock();
+
+            for (const auto& Item : Results)
+            {
+                auto& Slot=Slots[Item.first];
+                Slot.Reading=false;
+                if (InWindow(Slot.Block))
+                {
+                    // Shares the buffer of the slot, freed once out of the window
+                    Blocks[(size_t)Slot.Block]=Item.second>0?QByteArray::fromRawData(Slot.Data.constData(), Item.second):QByteArray();
+                    Loaded.notify_all();
+                }
+                else
+                    Slot.Block=-1;
+            }
+            if (!IsOk)
+                Stop=true; // The reads waiting fail
+        }
+
+        // The blocks are views of the slots, the queue is destroyed first once the reads in flight are done
+        Blocks.clear();
+    }
+
+    Loaded.notify_all();
+}
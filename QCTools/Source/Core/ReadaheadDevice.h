@@ -0,0 +1,84 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ReadaheadDevice_H
+#define ReadaheadDevice_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QSharedPointer>
+#include <QString>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <thread>
+
+class QAVIODevice;
+
+//---------------------------------------------------------------------------
+// File read ahead by a thread in large blocks, for the QAVIODevice of a
+// parser on network storage (NFS, object storage mounted with FUSE) where the
+// small synchronous reads of the demuxer wait for the network one at a time.
+//
+// The Depth blocks from the one read are kept loaded, the thread loads the
+// next missing one as soon as the reader moves forward. Seeks keep working,
+// the blocks around the new position are loaded first. The block before the
+// one read is kept for the demuxers reading a little backwards.
+//
+// With io_uring (see UringQueue), the missing blocks of the window are read
+// at the same time in registered buffers, the blocks are these buffers.
+class ReadaheadDevice : public QIODevice
+{
+public:
+                                ReadaheadDevice             (const QString& FileName, size_t Block_Size, size_t Depth);
+                                ~ReadaheadDevice            ();
+
+    // Blocks and depth of the files opened afterwards by the parser (see FileInformation), 0 depth means no readahead
+    // (8 blocks with io_uring)
+    static void                 Default_Set                 (size_t Block_Size, size_t Depth);
+    static size_t               Default_Block_Size          ();
+    static size_t               Default_Depth               ();
+
+    // Device for the parser of a local file, with the defaults, null if there is no readahead or if it can not be opened
+    // QAVIODevice reads in the thread of its object, so the devices live in a thread of their own, not in the one of
+    // the caller which may wait for the parser
+    static QSharedPointer<QAVIODevice> Create               (const QString& FileName);
+
+    // QIODevice
+    bool                        open                        (OpenMode Mode) override;
+    void                        close                       () override;
+    bool                        isSequential                () const override {return false;}
+    qint64                      size                        () const override {return File_Size;}
+    bool                        seek                        (qint64 Pos) override;
+    bool                        atEnd                       () const override {return pos()>=File_Size;}
+
+protected:
+    qint64                      readData                    (char* Data, qint64 MaxSize) override;
+    qint64                      writeData                   (const char*, qint64) override {return -1;}
+
+private:
+    void                        Load                        ();
+    void                        Load_Uring                  ();
+
+    QString                     FileName;
+    size_t                      Block_Size;
+    size_t                      Depth;
+    qint64                      File_Size=0;
+    bool                        Uring;
+
+    // Shared with the thread
+    std::mutex                  Mutex;
+    std::condition_variable     Loaded;                     // A block is loaded
+    std::condition_variable     Wanted;                     // Current block changed
+    std::map<size_t, QByteArray> Blocks;                    // By index, an empty block is a read error
+    size_t                      Current=0;                  // Block read
+    bool                        Stop=false;
+    std::thread                 Thread;
+};
+
+#endif // ReadaheadDevice_H
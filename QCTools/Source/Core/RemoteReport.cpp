@@ -0,0 +1,212 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/RemoteReport.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpSocket>
+#include <QUrl>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Defaults
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static const char* const Scheme="qcli";
+static std::atomic<int> Default_Idle(60000);
+
+// Received bytes kept before the ones already read are dropped
+static const int Buffer_Compact=0x100000;
+
+//---------------------------------------------------------------------------
+bool RemoteReport::IsRemote(const QString& Name)
+{
+    return Name.startsWith(QLatin1String(Scheme)+"://");
+}
+
+//---------------------------------------------------------------------------
+void RemoteReport::Idle_Set(int Idle)
+{
+    Default_Idle=std::max(Idle, 1000);
+}
+
+//---------------------------------------------------------------------------
+int RemoteReport::Idle_Get()
+{
+    return Default_Idle;
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+RemoteReport::RemoteReport(const QString& Name)
+{
+    QUrl Url(Name);
+    if (!Url.isValid() || Url.scheme()!=Scheme)
+        return;
+    Host=Url.host();
+    Port=Url.port(-1);
+
+    // qcli://host:port/C:/media/file.mkv for a Windows server
+    Input=Url.path();
+    if (Input.size()>=3 && Input[0]=='/' && Input[2]==':')
+        Input.remove(0, 1);
+}
+
+//---------------------------------------------------------------------------
+RemoteReport::~RemoteReport()
+{
+    close();
+}
+
+//***************************************************************************
+// QIODevice
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool RemoteReport::open(OpenMode Mode)
+{
+    if (isOpen() || (Mode&WriteOnly))
+        return false;
+    if (Host.isEmpty() || Port<=0 || Input.isEmpty())
+    {
+        setErrorString("invalid name, qcli://<host>:<port>/<path> is expected");
+        return false;
+    }
+
+    // Blocking calls only, the device is used by a thread without event loop
+    Socket.reset(new QTcpSocket);
+    Socket->connectToHost(Host, (quint16)Port);
+    if (!Socket->waitForConnected(Default_Idle))
+    {
+        setErrorString(Socket->errorString());
+        Socket.reset();
+        return false;
+    }
+    // Shared token of the server if any, see qcli --serve-token
+    QString Token=qEnvironmentVariable("QCTOOLS_SERVE_TOKEN");
+    if (!Token.isEmpty())
+        Socket->write(QJsonDocument(QJsonObject {{"token", Token}}).toJson(QJsonDocument::Compact)+'\n');
+    Socket->write(QJsonDocument(QJsonObject {{"id", 1}, {"input", Input}, {"send", true}}).toJson(QJsonDocument::Compact)+'\n');
+    Socket->flush();
+
+    Buffer.clear();
+    Buffer_Pos=0;
+    Report_Left=0;
+    Done=false;
+    Job_Status=-1;
+    Job_Message.clear();
+
+    // Not buffered again by QIODevice
+    return QIODevice::open(Mode|Unbuffered);
+}
+
+//---------------------------------------------------------------------------
+void RemoteReport::close()
+{
+    // The job continues on the server, its events are dropped
+    Socket.reset();
+    QIODevice::close();
+}
+
+//---------------------------------------------------------------------------
+qint64 RemoteReport::bytesAvailable() const
+{
+    return Buffer.size()-Buffer_Pos+QIODevice::bytesAvailable();
+}
+
+//---------------------------------------------------------------------------
+bool RemoteReport::atEnd() const
+{
+    return Done && Buffer_Pos>=Buffer.size() && QIODevice::atEnd();
+}
+
+//---------------------------------------------------------------------------
+qint64 RemoteReport::readData(char* Data, qint64 MaxSize)
+{
+    // All the bytes asked for, the readers of the report expect complete gzip headers and members
+    while (Buffer.size()-Buffer_Pos<MaxSize && !Done && Receive())
+        ;
+
+    qint64 Size=std::min(MaxSize, (qint64)(Buffer.size()-Buffer_Pos));
+    std::memcpy(Data, Buffer.constData()+Buffer_Pos, Size);
+    Buffer_Pos+=(int)Size;
+    if (Buffer_Pos>=Buffer_Compact || Buffer_Pos==Buffer.size())
+    {
+        Buffer.remove(0, Buffer_Pos);
+        Buffer_Pos=0;
+    }
+    return Size;
+}
+
+//***************************************************************************
+// Events
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Next bytes of the report appended to Buffer, false at the end of the job
+bool RemoteReport::Receive()
+{
+    while (Socket)
+    {
+        // Bytes of the current report event
+        if (Report_Left)
+        {
+            if (!Socket->bytesAvailable() && !Socket->waitForReadyRead(Default_Idle))
+                return Fail("connection lost, "+Socket->errorString());
+            QByteArray Data=Socket->read(Report_Left);
+            Report_Left-=Data.size();
+            Buffer.append(Data);
+            return true;
+        }
+
+        if (!Socket->canReadLine())
+        {
+            if (!Socket->waitForReadyRead(Default_Idle))
+                return Fail("connection lost, "+Socket->errorString());
+            continue;
+        }
+
+        // Other events (ready, queued, progress...) are only the proof the job is running
+        QJsonObject Event=QJsonDocument::fromJson(Socket->readLine()).object();
+        QString Name=Event.value("event").toString();
+        if (Name=="report")
+            Report_Left=std::max((qint64)0, (qint64)Event.value("bytes").toDouble());
+        else if (Name=="warning")
+            qDebug() << "remote report:" << Input << Event.value("message").toString();
+        else if (Name=="finished")
+        {
+            Job_Status=Event.value("status").toInt(-1);
+            Job_Message=Event.value("message").toString();
+            if (Job_Status)
+                qDebug() << "remote report:" << Input << Job_Message;
+            Done=true;
+            return false;
+        }
+        else if (Name=="error")
+            return Fail(Event.value("message").toString());
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------
+bool RemoteReport::Fail(const QString& Message)
+{
+    qDebug() << "remote report:" << Input << Message;
+    Job_Message=Message;
+    setErrorString(Message);
+    Done=true;
+    return false;
+}
@@ -0,0 +1,73 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef RemoteReport_H
+#define RemoteReport_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <memory>
+
+class QTcpSocket;
+
+//---------------------------------------------------------------------------
+// Report of a file analyzed by a qcli --serve tcp:<port> instance of another
+// host, next to the storage, named qcli://<host>:<port>/<path on the server>:
+// the file is sent as a job with "send" (see Server, with the token of the
+// QCTOOLS_SERVE_TOKEN environment variable if set), and the bytes of its
+// xml.gz report are read as the server writes them, so the stats are read
+// (and shown, see FileInformation::ProgressiveReports_Set) while the file is
+// analyzed, without the media being copied.
+//
+// The device is sequential and reads block until the bytes asked for are
+// received or the job is finished, from the thread which reads the report.
+// The media is not available locally, there is no player.
+class RemoteReport : public QIODevice
+{
+public:
+    explicit                    RemoteReport                (const QString& Name);
+                                ~RemoteReport               ();
+
+    // Name is a qcli:// one
+    static bool                 IsRemote                    (const QString& Name);
+    // Milliseconds without anything from the server after which the job is considered lost
+    static void                 Idle_Set                    (int Idle);
+    static int                  Idle_Get                    ();
+
+    // Status and message of the job once finished, or why the report is not complete
+    int                         Status                      () const {return Job_Status;}
+    const QString&              Message                     () const {return Job_Message;}
+
+    // QIODevice
+    bool                        open                        (OpenMode Mode) override;
+    void                        close                       () override;
+    bool                        isSequential                () const override {return true;}
+    qint64                      bytesAvailable              () const override;
+    bool                        atEnd                       () const override;
+
+protected:
+    qint64                      readData                    (char* Data, qint64 MaxSize) override;
+    qint64                      writeData                   (const char*, qint64) override {return -1;}
+
+private:
+    bool                        Receive                     ();
+    bool                        Fail                        (const QString& Message);
+
+    QString                     Host;
+    int                         Port=-1;
+    QString                     Input;                      // Path on the server
+    std::unique_ptr<QTcpSocket> Socket;
+    QByteArray                  Buffer;                     // Received, not read yet from Buffer_Pos
+    int                         Buffer_Pos=0;
+    qint64                      Report_Left=0;              // Bytes of the current report event not received yet
+    bool                        Done=false;
+    int                         Job_Status=-1;
+    QString                     Job_Message;
+};
+
+#endif // RemoteReport_H
@@ -0,0 +1,369 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/ReportFrames.h"
+#include "Core/FileInformation.h"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+#include <qavdemuxer_p.h>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <utility>
+
+//---------------------------------------------------------------------------
+static AVFormatContext* Open(const QString& FileName)
+{
+    AVFormatContext* FormatContext=nullptr;
+    auto FileName_String=FileName.toStdString();
+    if (avformat_open_input(&FormatContext, FileName_String.c_str(), nullptr, nullptr)<0)
+        return nullptr;
+    if (QAVDemuxer::findStreamInfo(FormatContext, FileInformation::FastProbe_Get())<0)
+        avformat_close_input(&FormatContext);
+    return FormatContext;
+}
+
+//---------------------------------------------------------------------------
+static int64_t Timestamp(int64_t Pts, int64_t Dts)
+{
+    return Pts!=AV_NOPTS_VALUE?Pts:Dts;
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+ReportFrames::ReportFrames(const QString& FileName_, const FinishedHandler& Finished_) :
+    FileName(FileName_),
+    Finished(Finished_)
+{
+}
+
+//---------------------------------------------------------------------------
+ReportFrames::~ReportFrames()
+{
+    Cancel();
+
+    Release();
+    for (auto& Decoder : Decoders)
+        avcodec_free_context(&Decoder.second);
+    avformat_close_input(&Decoder_Format);
+    sws_freeContext(ScaleContext);
+}
+
+//***************************************************************************
+// Control
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ReportFrames::Start()
+{
+    // After the parser and the display
+    start(QThread::LowestPriority);
+}
+
+//---------------------------------------------------------------------------
+void ReportFrames::Cancel()
+{
+    IsCancelled=true;
+    wait();
+}
+
+//***************************************************************************
+// Queries
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+size_t ReportFrames::Count(int Stream) const
+{
+    QMutexLocker Locker(&Mutex);
+    auto Item=Pts.find(Stream);
+    return Item!=Pts.end()?Item->second.size():0;
+}
+
+//---------------------------------------------------------------------------
+Thumbnail ReportFrames::Get(int Stream, size_t Pos) const
+{
+    QMutexLocker Locker(&Decoder_Mutex);
+
+    Thumbnail Result;
+    const AVFrame* Source=Frame(Stream, Pos);
+    if (!Source)
+        return Result;
+
+    Result.Rgb=QByteArray(Source->width*3*Source->height, Qt::Uninitialized);
+    uint8_t* DestData[4]={(uint8_t*)Result.Rgb.data(), nullptr, nullptr, nullptr};
+    int DestLineSize[4]={Source->width*3, 0, 0, 0};
+    ScaleContext=sws_getCachedContext(ScaleContext, Source->width, Source->height, (AVPixelFormat)Source->format, Source->width, Source->height, AV_PIX_FMT_RGB24, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    if (!ScaleContext || sws_scale(ScaleContext, Source->data, Source->linesize, 0, Source->height, DestData, DestLineSize)<0)
+        return Thumbnail();
+    Result.Width=Source->width;
+    Result.Height=Source->height;
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+bool ReportFrames::Get(int Stream, size_t Pos, AVFrame* Frame_) const
+{
+    QMutexLocker Locker(&Decoder_Mutex);
+
+    const AVFrame* Source=Frame(Stream, Pos);
+    if (!Source)
+        return false;
+
+    // The previous content may still be referenced by an encoder, it keeps its own reference
+    av_frame_unref(Frame_);
+    return av_frame_ref(Frame_, Source)>=0;
+}
+
+//***************************************************************************
+// Memory management
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+size_t ReportFrames::Bytes() const
+{
+    size_t Result;
+    {
+        QMutexLocker Locker(&Decoder_Mutex);
+        Result=Blocks_Bytes;
+    }
+
+    QMutexLocker Locker(&Mutex);
+    for (const auto& Item : Pts)
+        Result+=Item.second.capacity()*sizeof(int64_t);
+    for (const auto& Item : Keys)
+        Result+=Item.second.capacity()*sizeof(size_t);
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+void ReportFrames::Release()
+{
+    QMutexLocker Locker(&Decoder_Mutex);
+    for (auto& Block : Blocks)
+        Free(Block);
+    Blocks.clear();
+    Blocks_Bytes=0;
+}
+
+//***************************************************************************
+// Decoding
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const AVFrame* ReportFrames::Frame(int Stream, size_t Pos) const
+{
+    size_t First=Pos-Pos%Block_Size;
+    for (auto Block=Blocks.begin(); Block!=Blocks.end(); ++Block)
+    {
+        if (Block->Stream!=Stream || Block->First!=First)
+            continue;
+
+        // Decoded while the end of the block was not indexed yet
+        if (Pos-First>=Block->Frames.size() && Pos<Count(Stream))
+        {
+            Blocks_Bytes-=Block->Bytes;
+            Free(*Block);
+            Blocks.erase(Block);
+            break;
+        }
+
+        Blocks.splice(Blocks.begin(), Blocks, Block);
+        return Pos-First<Blocks.front().Frames.size()?Blocks.front().Frames[Pos-First]:nullptr;
+    }
+
+    if (Pos>=Count(Stream))
+        return nullptr;
+
+    // Failed blocks are kept too, so they are not decoded again for each display
+    block Block;
+    Block.Stream=Stream;
+    Block.First=First;
+    if (!Decode(Block))
+        qDebug() << "report frames:" << FileName << "stream" << Stream << "frames" << First << "can not be decoded";
+    Blocks_Bytes+=Block.Bytes;
+    Blocks.push_front(std::move(Block));
+
+    while (Blocks_Bytes>Cache_Max && Blocks.size()>1)
+    {
+        Blocks_Bytes-=Blocks.back().Bytes;
+        Free(Blocks.back());
+        Blocks.pop_back();
+    }
+
+    return Pos-First<Blocks.front().Frames.size()?Blocks.front().Frames[Pos-First]:nullptr;
+}
+
+//---------------------------------------------------------------------------
+bool ReportFrames::Decode(block& Block) const
+{
+    // Frames of the block by time stamp, and the key frame the decoding starts from
+    std::vector<std::pair<int64_t, size_t>> Block_Pts;
+    int64_t Start;
+    {
+        QMutexLocker Locker(&Mutex);
+        const auto& Stream_Pts=Pts.at(Block.Stream);
+        const auto& Stream_Keys=Keys.at(Block.Stream);
+        size_t Last=std::min(Block.First+Block_Size, Stream_Pts.size());
+        for (size_t Pos=Block.First; Pos<Last; Pos++)
+            Block_Pts.emplace_back(Stream_Pts[Pos], Pos-Block.First);
+        auto Key=std::upper_bound(Stream_Keys.begin(), Stream_Keys.end(), Block.First);
+        Start=Stream_Pts[Key!=Stream_Keys.begin()?*(Key-1):Block.First];
+    }
+    std::sort(Block_Pts.begin(), Block_Pts.end());
+    Block.Frames.assign(Block_Pts.size(), nullptr);
+
+    if (!Decoder_Format && !Decoder_Failed)
+    {
+        Decoder_Format=Open(FileName);
+        Decoder_Failed=!Decoder_Format;
+    }
+    if (!Decoder_Format || Block.Stream<0 || Block.Stream>=(int)Decoder_Format->nb_streams)
+        return false;
+
+    AVStream* Stream=Decoder_Format->streams[Block.Stream];
+    auto& Decoder=Decoders[Block.Stream];
+    if (!Decoder)
+    {
+        const AVCodec* Codec=avcodec_find_decoder(Stream->codecpar->codec_id);
+        Decoder=Codec?avcodec_alloc_context3(Codec):nullptr;
+        if (!Decoder)
+            return false;
+
+        // One thread, so the frames are not delayed by the frame threads
+        Decoder->thread_count=1;
+        if (avcodec_parameters_to_context(Decoder, Stream->codecpar)<0 || avcodec_open2(Decoder, Codec, nullptr)<0)
+        {
+            avcodec_free_context(&Decoder);
+            return false;
+        }
+    }
+
+    // Only the packets of the stream are read
+    for (unsigned Pos=0; Pos<Decoder_Format->nb_streams; Pos++)
+        Decoder_Format->streams[Pos]->discard=(int)Pos==Block.Stream?AVDISCARD_DEFAULT:AVDISCARD_ALL;
+    if (av_seek_frame(Decoder_Format, Block.Stream, Start, AVSEEK_FLAG_BACKWARD)<0)
+        return false;
+    avcodec_flush_buffers(Decoder);
+
+    AVPacket* Packet=av_packet_alloc();
+    AVFrame* Decoded=av_frame_alloc();
+    size_t Left=Block_Pts.size();
+    int64_t Last=Block_Pts.back().first;
+    size_t After=0; // Packets after the block, for the frames delayed by the decoder
+    auto Receive=[&]() {
+        while (Left && avcodec_receive_frame(Decoder, Decoded)>=0)
+        {
+            int64_t Ts=Timestamp(Decoded->best_effort_timestamp, Decoded->pts);
+            auto Item=std::lower_bound(Block_Pts.begin(), Block_Pts.end(), std::make_pair(Ts, (size_t)0));
+            if (Item!=Block_Pts.end() && Item->first==Ts && !Block.Frames[Item->second])
+            {
+                Block.Frames[Item->second]=av_frame_clone(Decoded);
+                int Size=av_image_get_buffer_size((AVPixelFormat)Decoded->format, Decoded->width, Decoded->height, 1);
+                Block.Bytes+=Size>0?(size_t)Size:0;
+                --Left;
+            }
+            av_frame_unref(Decoded);
+        }
+    };
+    while (Left && After<=Block_Size)
+    {
+        if (av_read_frame(Decoder_Format, Packet)<0)
+            break;
+        if (Packet->stream_index==Block.Stream)
+        {
+            if (Timestamp(Packet->pts, Packet->dts)>Last)
+                ++After;
+            if (avcodec_send_packet(Decoder, Packet)>=0)
+                Receive();
+        }
+        av_packet_unref(Packet);
+    }
+
+    // Frames still delayed by the decoder, it is flushed before the next block
+    if (Left && avcodec_send_packet(Decoder, nullptr)>=0)
+        Receive();
+
+    av_frame_free(&Decoded);
+    av_packet_free(&Packet);
+    return Left<Block_Pts.size();
+}
+
+//---------------------------------------------------------------------------
+void ReportFrames::Free(block& Block) const
+{
+    for (auto& Frame_ : Block.Frames)
+        av_frame_free(&Frame_);
+}
+
+//***************************************************************************
+// Thread
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ReportFrames::run()
+{
+    AVFormatContext* FormatContext=Open(FileName);
+    if (!FormatContext)
+    {
+        if (Finished)
+            Finished(false);
+        return;
+    }
+
+    // Packets of the other streams are not read
+    for (unsigned Pos=0; Pos<FormatContext->nb_streams; Pos++)
+    {
+        if (FormatContext->streams[Pos]->codecpar->codec_type!=AVMEDIA_TYPE_VIDEO)
+        {
+            FormatContext->streams[Pos]->discard=AVDISCARD_ALL;
+            continue;
+        }
+        QMutexLocker Locker(&Mutex);
+        Pts[(int)Pos];
+        Keys[(int)Pos];
+    }
+
+    AVPacket* Packet=av_packet_alloc();
+    bool IsOk=true;
+    while (!IsCancelled)
+    {
+        int Result=av_read_frame(FormatContext, Packet);
+        if (Result<0)
+        {
+            IsOk=Result==AVERROR_EOF;
+            break;
+        }
+
+        if (Packet->stream_index>=0 && (unsigned)Packet->stream_index<FormatContext->nb_streams && FormatContext->streams[Packet->stream_index]->codecpar->codec_type==AVMEDIA_TYPE_VIDEO)
+        {
+            QMutexLocker Locker(&Mutex);
+            auto& Stream_Pts=Pts[Packet->stream_index];
+            if (Packet->flags&AV_PKT_FLAG_KEY)
+                Keys[Packet->stream_index].push_back(Stream_Pts.size());
+            Stream_Pts.push_back(Timestamp(Packet->pts, Packet->dts));
+        }
+        av_packet_unref(Packet);
+    }
+
+    qDebug() << "report frames:" << FileName << Count(0) << "thumbnails indexed";
+
+    av_packet_free(&Packet);
+    avformat_close_input(&FormatContext);
+
+    if (!IsCancelled && Finished)
+        Finished(IsOk);
+}
@@ -0,0 +1,107 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ReportFrames_H
+#define ReportFrames_H
+
+#include "Core/ThumbnailStore.h"
+
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <vector>
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct SwsContext;
+
+//---------------------------------------------------------------------------
+// Thumbnails and panels of a .qctools.mkv report, decoded on demand instead
+// of all of them when the report is opened.
+//
+// A low priority thread reads the packets of the video streams of the report
+// without decoding them, their time stamps and key frame flags are the index
+// of the frames (one packet per frame, in presentation order as in the
+// reports). Frames are available as soon as they are indexed.
+//
+// A frame not in the cache is decoded with the ones of its block (the next
+// frames around the one shown by the display, one seek and one read for all
+// of them) by a second context, from the thread asking for it. Decoded
+// blocks are kept up to Cache_Max bytes, the least recently used ones are
+// dropped.
+class ReportFrames : public QThread
+{
+public:
+    typedef std::function<void(bool IsOk)> FinishedHandler;
+
+    // Frames decoded together, and bytes of the decoded frames kept
+    static const size_t         Block_Size=32;
+    static const size_t         Cache_Max=64*1024*1024;
+
+    // Finished is called by the thread at the end of the indexing
+                                ReportFrames                (const QString& FileName, const FinishedHandler& Finished);
+                                ~ReportFrames               ();
+
+    void                        Start                       ();
+    // No more frames indexed, returns once the thread is done
+    void                        Cancel                      ();
+
+    // Streams are the video streams of the report by stream index, 0 for the thumbnails
+    size_t                      Count                       (int Stream) const;
+    // Frame Pos converted to rgb24, empty if Pos is not available
+    Thumbnail                   Get                         (int Stream, size_t Pos) const;
+    // Frame Pos in its decoded format, size and timestamp, returns false if Pos is not available
+    bool                        Get                         (int Stream, size_t Pos, AVFrame* Frame) const;
+
+    // Memory used by the index and the decoded frames
+    size_t                      Bytes                       () const;
+    // Drops the decoded frames, for files not displayed
+    void                        Release                     ();
+
+protected:
+    void                        run                         ();
+
+private:
+    struct block
+    {
+        int                     Stream;
+        size_t                  First;
+        std::vector<AVFrame*>   Frames;                     // nullptr if not decoded
+        size_t                  Bytes=0;
+    };
+
+    // Decoded frame Pos (referenced by the cache), nullptr if not available; called with Decoder_Mutex locked
+    const AVFrame*              Frame                       (int Stream, size_t Pos) const;
+    bool                        Decode                      (block& Block) const;
+    void                        Free                        (block& Block) const;
+
+    QString                     FileName;
+    FinishedHandler             Finished;
+    std::atomic<bool>           IsCancelled {false};
+
+    // Index, filled by the thread
+    mutable QMutex              Mutex;
+    std::map<int, std::vector<int64_t>> Pts;                // By stream index, of each packet
+    std::map<int, std::vector<size_t>> Keys;                // By stream index, position of the key frames
+
+    // Decoding, the asking threads one after the other
+    mutable QMutex              Decoder_Mutex;
+    mutable AVFormatContext*    Decoder_Format=nullptr;
+    mutable bool                Decoder_Failed=false;
+    mutable std::map<int, AVCodecContext*> Decoders;        // By stream index
+    mutable std::list<block>    Blocks;                     // Most recent first
+    mutable size_t              Blocks_Bytes=0;
+    mutable SwsContext*         ScaleContext=nullptr;
+};
+
+#endif // ReportFrames_H
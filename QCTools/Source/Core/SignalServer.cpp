@@ -1,8 +1,19 @@
 #include "SignalServer.h"
 
-SignalServer::SignalServer(QObject *parent) : QObject(parent), m_autoUpload(false)
-{
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <limits>
 
+SignalServer::SignalServer(QObject *parent) : QObject(parent), m_autoUpload(false), m_chunkSize(0), m_parallelChunks(4), m_bulkCheck(BulkCheckUnknown), m_deltaUploadUnsupported(false), m_rangedUploadUnsupported(false)
+{
+    // Files of a list are opened within a few ms of each other
+    m_checksTimer.setSingleShot(true);
+    m_checksTimer.setInterval(100);
+    connect(&m_checksTimer, &QTimer::timeout, this, &SignalServer::sendChecks);
 }
 
 QUrl SignalServer::url() const
@@ -50,30 +61,311 @@ bool SignalServer::autoUpload() const
     return m_autoUpload;
 }
 
+void SignalServer::setChunkSize(qint64 bytes, int parallel)
+{
+    m_chunkSize = std::max<qint64>(bytes, 0);
+    m_parallelChunks = std::max(parallel, 1);
+}
+
+qint64 SignalServer::chunkSize() const
+{
+    return m_chunkSize;
+}
+
 QSharedPointer<CheckFileUploadedOperation> SignalServer::checkFileUploaded(const QString &fileName)
 {
-    QUrl checkFileUploadedUrl = QUrl(m_url.toString() + "/fileuploads/check_exist/" + QUrl::toPercentEncoding(fileName));
-    QSharedPointer<QNetworkReply> reply = get(checkFileUploadedUrl);
+    QSharedPointer<CheckFileUploadedOperation> operation = QSharedPointer<CheckFileUploadedOperation>::create(fileName, QSharedPointer<QNetworkReply>());
+    if(m_bulkCheck == BulkCheckUnsupported)
+    {
+        checkOneByOne(operation);
+        return operation;
+    }
+
+    m_checksPending.append(operation.toWeakRef());
+    if(!m_checksTimer.isActive())
+        m_checksTimer.start();
 
-    return QSharedPointer<CheckFileUploadedOperation>::create(fileName, reply);
+    return operation;
+}
+
+void SignalServer::sendChecks()
+{
+    static const int MaxFilesPerRequest = 100;
+
+    while(!m_checksPending.isEmpty())
+    {
+        QList<QWeakPointer<CheckFileUploadedOperation>> operations;
+        QJsonArray fileNames;
+        while(!m_checksPending.isEmpty() && operations.size() < MaxFilesPerRequest)
+        {
+            QWeakPointer<CheckFileUploadedOperation> operation = m_checksPending.takeFirst();
+            QSharedPointer<CheckFileUploadedOperation> strongOperation = operation.toStrongRef();
+            if(!strongOperation)
+                continue;
+            if(m_bulkCheck == BulkCheckUnsupported)
+            {
+                checkOneByOne(strongOperation);
+                continue;
+            }
+            operations.append(operation);
+            fileNames.append(strongOperation->fileName());
+        }
+        if(operations.isEmpty())
+            continue;
+
+        QUrl checkFilesUploadedUrl = QUrl(m_url.toString() + "/fileuploads/check_exist");
+        QSharedPointer<QNetworkReply> reply = post(checkFilesUploadedUrl, QJsonDocument(QJsonObject{{"filenames", fileNames}}).toJson(QJsonDocument::Compact));
+        QNetworkReply* replyData = reply.data();
+        m_checksRunning.insert(replyData, reply);
+        connect(replyData, &QNetworkReply::finished, this, [this, operations, replyData]() { checksFinished(operations, replyData); });
+    }
+}
+
+void SignalServer::checksFinished(QList<QWeakPointer<CheckFileUploadedOperation>> operations, QNetworkReply *reply)
+{
+    QSharedPointer<QNetworkReply> keep = m_checksRunning.take(reply);
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    // Server without the bulk check, it is not asked again
+    if(m_bulkCheck != BulkCheckSupported && (statusCode == 404 || statusCode == 405 || statusCode == 501))
+    {
+        m_bulkCheck = BulkCheckUnsupported;
+        for(const auto& operation : operations)
+            if(QSharedPointer<CheckFileUploadedOperation> strongOperation = operation.toStrongRef())
+                checkOneByOne(strongOperation);
+        return;
+    }
+
+    QJsonObject uploaded;
+    QString errorString;
+    if(reply->error() != QNetworkReply::NoError)
+        errorString = reply->errorString();
+    else if(statusCode != 200)
+        errorString = QString("Failure: statusCode = %1").arg(statusCode);
+    else
+    {
+        // {"<file name>": true or false, ...}
+        QJsonDocument document = QJsonDocument::fromJson(reply->readAll());
+        if(!document.isObject())
+            errorString = "Failure: invalid reply";
+        uploaded = document.object();
+        m_bulkCheck = BulkCheckSupported;
+    }
+
+    for(const auto& operation : operations)
+    {
+        QSharedPointer<CheckFileUploadedOperation> strongOperation = operation.toStrongRef();
+        if(!strongOperation)
+            continue;
+        QJsonValue value = uploaded.value(strongOperation->fileName());
+        if(!errorString.isEmpty())
+            strongOperation->finish(CheckFileUploadedOperation::Error, errorString);
+        else if(!value.isBool())
+            strongOperation->finish(CheckFileUploadedOperation::Error, "Failure: file not in the reply");
+        else
+            strongOperation->finish(value.toBool() ? CheckFileUploadedOperation::Uploaded : CheckFileUploadedOperation::NotUploaded, QString());
+    }
+}
+
+void SignalServer::checkOneByOne(QSharedPointer<CheckFileUploadedOperation> operation)
+{
+    QUrl checkFileUploadedUrl = QUrl(m_url.toString() + "/fileuploads/check_exist/" + QUrl::toPercentEncoding(operation->fileName()));
+    operation->setReply(get(checkFileUploadedUrl));
 }
 
 QSharedPointer<UploadFileOperation> SignalServer::uploadFile(const QString &fileName, QSharedPointer<QIODevice> data)
 {
-    QUrl uploadFileUrl = QUrl(m_url.toString() + "/fileuploads/upload/" + QUrl::toPercentEncoding(fileName));
-    QSharedPointer<QNetworkReply> reply = put(uploadFileUrl, data.data());
+    if(m_chunkSize && !m_rangedUploadUnsupported)
+        return QSharedPointer<ChunkedUploadFileOperation>::create(fileName, data, this, uploadUrl(fileName), m_chunkSize, m_parallelChunks, data->size());
+
+    return uploadWholeFile(fileName, data);
+}
+
+QSharedPointer<UploadFileOperation> SignalServer::uploadWholeFile(const QString &fileName, QSharedPointer<QIODevice> data)
+{
+    QSharedPointer<QNetworkReply> reply = put(uploadUrl(fileName), data.data());
 
     return QSharedPointer<UploadFileOperation>::create(fileName, data, reply);
 }
 
-QSharedPointer<QNetworkReply> SignalServer::get(const QUrl& url)
+QSharedPointer<ChunkedUploadFileOperation> SignalServer::uploadGrowingFile(const QString &fileName, QSharedPointer<QIODevice> data)
+{
+    static const qint64 DefaultChunkSize = 8 * 1024 * 1024;
+
+    return QSharedPointer<ChunkedUploadFileOperation>::create(fileName, data, this, uploadUrl(fileName), m_chunkSize ? m_chunkSize : DefaultChunkSize, m_parallelChunks, -1);
+}
+
+QSharedPointer<UploadFileOperation> SignalServer::uploadFileChanges(const QString &fileName, QSharedPointer<QIODevice> data)
+{
+    if(m_deltaUploadUnsupported)
+        return uploadFile(fileName, data);
+
+    return QSharedPointer<DeltaUploadFileOperation>::create(fileName, data, this, m_parallelChunks);
+}
+
+QSharedPointer<CheckFileUploadedOperation> SignalServer::checkFileChunks(const QString &fileName, qint64 size, const QStringList &hashes)
+{
+    QSharedPointer<CheckFileUploadedOperation> operation = QSharedPointer<CheckFileUploadedOperation>::create(fileName, QSharedPointer<QNetworkReply>());
+
+    QUrl checkChunksUrl = QUrl(m_url.toString() + "/fileuploads/check_chunks");
+    QJsonObject query {{"filename", fileName}, {"size", size}, {"chunks", QJsonArray::fromStringList(hashes)}};
+    QSharedPointer<QNetworkReply> reply = post(checkChunksUrl, QJsonDocument(query).toJson(QJsonDocument::Compact));
+    QNetworkReply* replyData = reply.data();
+    m_checksRunning.insert(replyData, reply);
+    QWeakPointer<CheckFileUploadedOperation> weakOperation = operation.toWeakRef();
+    connect(replyData, &QNetworkReply::finished, this, [this, weakOperation, replyData]() {
+        QSharedPointer<CheckFileUploadedOperation> strongOperation = weakOperation.toStrongRef();
+        if(strongOperation)
+            checkChunksFinished(strongOperation, replyData);
+        else
+            m_checksRunning.remove(replyData);
+    });
+
+    return operation;
+}
+
+void SignalServer::checkChunksFinished(QSharedPointer<CheckFileUploadedOperation> operation, QNetworkReply *reply)
+{
+    QSharedPointer<QNetworkReply> keep = m_checksRunning.take(reply);
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    // Server without the chunks store, the files are uploaded whole
+    if(statusCode == 404 || statusCode == 405 || statusCode == 501)
+    {
+        m_deltaUploadUnsupported = true;
+        operation->finish(CheckFileUploadedOperation::Error, "Failure: chunks are not supported");
+        return;
+    }
+
+    if(reply->error() != QNetworkReply::NoError)
+    {
+        operation->finish(CheckFileUploadedOperation::Error, reply->errorString());
+        return;
+    }
+    if(statusCode != 200)
+    {
+        operation->finish(CheckFileUploadedOperation::Error, QString("Failure: statusCode = %1").arg(statusCode));
+        return;
+    }
+
+    // {"uploaded": true or false, "missing": ["<hash>", ...]}
+    QJsonDocument document = QJsonDocument::fromJson(reply->readAll());
+    QJsonValue uploaded = document.object().value("uploaded");
+    QJsonValue missing = document.object().value("missing");
+    if(!document.isObject() || !uploaded.isBool() || (!uploaded.toBool() && !missing.isArray()))
+    {
+        operation->finish(CheckFileUploadedOperation::Error, "Failure: invalid reply");
+        return;
+    }
+
+    operation->m_missingChunks.clear();
+    for(const auto& hash : missing.toArray())
+        operation->m_missingChunks.append(hash.toString());
+    operation->finish(uploaded.toBool() ? CheckFileUploadedOperation::Uploaded : CheckFileUploadedOperation::NotUploaded, QString());
+}
+
+bool SignalServer::deltaUploadUnsupported() const
+{
+    return m_deltaUploadUnsupported;
+}
+
+QSharedPointer<QNetworkReply> SignalServer::checkUploadedSize(const QString &fileName)
+{
+    QUrl checkSizeUrl = QUrl(m_url.toString() + "/fileuploads/check_size");
+
+    return post(checkSizeUrl, QJsonDocument(QJsonObject{{"filename", fileName}}).toJson(QJsonDocument::Compact));
+}
+
+qint64 SignalServer::sizeChecked(QNetworkReply *reply, QString &errorString)
+{
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    // Server without the ranged PUTs, the files are uploaded whole
+    if(statusCode == 404 || statusCode == 405 || statusCode == 501)
+    {
+        m_rangedUploadUnsupported = true;
+        errorString = "Failure: ranged uploads are not supported";
+        return -1;
+    }
+
+    if(reply->error() != QNetworkReply::NoError)
+    {
+        errorString = reply->errorString();
+        return -1;
+    }
+    if(statusCode != 200)
+    {
+        errorString = QString("Failure: statusCode = %1").arg(statusCode);
+        return -1;
+    }
+
+    // {"size": bytes, 0 if the file is not on the server}
+    QJsonValue size = QJsonDocument::fromJson(reply->readAll()).object().value("size");
+    if(!size.isDouble() || size.toDouble() < 0)
+    {
+        errorString = "Failure: invalid reply";
+        return -1;
+    }
+
+    errorString.clear();
+    return (qint64)size.toDouble();
+}
+
+bool SignalServer::rangedUploadUnsupported() const
+{
+    return m_rangedUploadUnsupported;
+}
+
+QSharedPointer<QNetworkReply> SignalServer::putChunkData(const QString &hash, const QByteArray &data)
+{
+    QUrl chunkUrl = QUrl(m_url.toString() + "/fileuploads/chunks/" + hash);
+    QSharedPointer<QNetworkReply> reply(m_manager.put(request(chunkUrl), data), &QObject::deleteLater);
+    reply->setParent(0); // ensure QNetworkAccessManager doesn't owns QNetworkReply anymore to avoid possible double-deletion
+
+    return reply;
+}
+
+QSharedPointer<QNetworkReply> SignalServer::assembleFile(const QString &fileName, qint64 size, const QStringList &hashes)
+{
+    QUrl assembleUrl = QUrl(m_url.toString() + "/fileuploads/assemble/" + QUrl::toPercentEncoding(fileName));
+    QJsonObject file {{"size", size}, {"chunks", QJsonArray::fromStringList(hashes)}};
+
+    return post(assembleUrl, QJsonDocument(file).toJson(QJsonDocument::Compact));
+}
+
+QUrl SignalServer::uploadUrl(const QString &fileName) const
+{
+    return QUrl(m_url.toString() + "/fileuploads/upload/" + QUrl::toPercentEncoding(fileName));
+}
+
+QNetworkRequest SignalServer::request(const QUrl &url) const
 {
     QNetworkRequest request(url);
     request.setRawHeader("Authorization", "Basic " + QByteArray(QString("%1:%2")
                                                                 .arg(m_login)
                                                                 .arg(m_password).toLocal8Bit().toBase64()));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    // All the requests in one connection with an HTTPS server supporting it
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+#endif
+
+    return request;
+}
+
+QSharedPointer<QNetworkReply> SignalServer::get(const QUrl& url)
+{
+    QSharedPointer<QNetworkReply> reply(m_manager.get(request(url)), &QObject::deleteLater);
+    reply->setParent(0); // ensure QNetworkAccessManager doesn't owns QNetworkReply anymore to avoid possible double-deletion
+
+    return reply;
+}
 
-    QSharedPointer<QNetworkReply> reply(m_manager.get(request), &QObject::deleteLater);
+QSharedPointer<QNetworkReply> SignalServer::post(const QUrl &url, const QByteArray &data)
+{
+    QNetworkRequest postRequest = request(url);
+    postRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+    QSharedPointer<QNetworkReply> reply(m_manager.post(postRequest, data), &QObject::deleteLater);
     reply->setParent(0); // ensure QNetworkAccessManager doesn't owns QNetworkReply anymore to avoid possible double-deletion
 
     return reply;
@@ -81,19 +373,38 @@ QSharedPointer<QNetworkReply> SignalServer::get(const QUrl& url)
 
 QSharedPointer<QNetworkReply> SignalServer::put(const QUrl &url, QIODevice* device)
 {
-    QNetworkRequest request(url);
-    request.setRawHeader("Authorization", "Basic " + QByteArray(QString("%1:%2")
-                                                                .arg(m_login)
-                                                                .arg(m_password).toLocal8Bit().toBase64()));
+    QSharedPointer<QNetworkReply> reply(m_manager.put(request(url), device), &QObject::deleteLater);
+    reply->setParent(0); // ensure QNetworkAccessManager doesn't owns QNetworkReply anymore to avoid possible double-deletion
+
+    return reply;
+}
 
-    QSharedPointer<QNetworkReply> reply(m_manager.put(request, device), &QObject::deleteLater);
+QSharedPointer<QNetworkReply> SignalServer::putChunk(const QUrl &url, const QByteArray &data, qint64 start, qint64 totalSize)
+{
+    QNetworkRequest chunkRequest = request(url);
+    // An empty file has no range
+    if(!data.isEmpty())
+        chunkRequest.setRawHeader("Content-Range", QString("bytes %1-%2/%3")
+                                              .arg(start)
+                                              .arg(start + data.size() - 1)
+                                              .arg(totalSize < 0 ? QString("*") : QString::number(totalSize)).toLatin1());
+
+    QSharedPointer<QNetworkReply> reply(m_manager.put(chunkRequest, data), &QObject::deleteLater);
     reply->setParent(0); // ensure QNetworkAccessManager doesn't owns QNetworkReply anymore to avoid possible double-deletion
 
     return reply;
 }
 
-SignalServerOperation::SignalServerOperation(const QString &fileName, QSharedPointer<QNetworkReply> reply) : m_fileName(fileName), m_reply(reply)
+SignalServerOperation::SignalServerOperation(const QString &fileName, QSharedPointer<QNetworkReply> reply) : m_fileName(fileName)
+{
+    // No reply for the operations with several requests or sent later
+    if(reply)
+        setReply(reply);
+}
+
+void SignalServerOperation::setReply(QSharedPointer<QNetworkReply> reply)
 {
+    m_reply = reply;
     connect(reply.data(), SIGNAL(finished()), this, SLOT(onFinished()));
 }
 
@@ -122,6 +433,11 @@ CheckFileUploadedOperation::State CheckFileUploadedOperation::state() const
     return m_state;
 }
 
+QStringList CheckFileUploadedOperation::missingChunks() const
+{
+    return m_missingChunks;
+}
+
 void CheckFileUploadedOperation::onFinished()
 {
     if(m_reply->error() == QNetworkReply::NoError)
@@ -146,10 +462,19 @@ void CheckFileUploadedOperation::onFinished()
     Q_EMIT finished();
 }
 
+void CheckFileUploadedOperation::finish(State state, const QString &errorString)
+{
+    m_state = state;
+    m_errorString = errorString;
+
+    Q_EMIT finished();
+}
+
 UploadFileOperation::UploadFileOperation(const QString &fileName, QSharedPointer<QIODevice> data, QSharedPointer<QNetworkReply> reply)
     : SignalServerOperation(fileName, reply), m_data(data), m_state(Uploading)
 {
-    connect(reply.data(), SIGNAL(uploadProgress(qint64, qint64)), this, SIGNAL(uploadProgress(qint64, qint64)));
+    if(reply)
+        connect(reply.data(), SIGNAL(uploadProgress(qint64, qint64)), this, SIGNAL(uploadProgress(qint64, qint64)));
 }
 
 UploadFileOperation::State UploadFileOperation::state() const
@@ -181,3 +506,527 @@ void UploadFileOperation::onFinished()
 
     Q_EMIT finished();
 }
+
+ChunkedUploadFileOperation::ChunkedUploadFileOperation(const QString &fileName, QSharedPointer<QIODevice> data, SignalServer *server, const QUrl &url, qint64 chunkSize, int parallel, qint64 finalSize)
+    : UploadFileOperation(fileName, data, QSharedPointer<QNetworkReply>()), m_server(server), m_url(url), m_chunkSize(std::max<qint64>(chunkSize, 1)), m_parallel(std::max(parallel, 1)), m_finalSize(finalSize)
+{
+    // Size of the data checked until the final size is known
+    m_growing.setInterval(500);
+    connect(&m_growing, &QTimer::timeout, this, &ChunkedUploadFileOperation::send);
+    if(m_finalSize < 0)
+        m_growing.start();
+
+    checkSize();
+}
+
+void ChunkedUploadFileOperation::setFinalSize(qint64 size)
+{
+    if(m_finalSize >= 0)
+        return;
+
+    m_finalSize = size;
+    m_growing.stop();
+    if(m_wholeWaiting)
+        uploadWhole();
+    else
+        send();
+}
+
+bool ChunkedUploadFileOperation::finalSizeIsSet() const
+{
+    return m_finalSize >= 0;
+}
+
+qint64 ChunkedUploadFileOperation::acknowledged() const
+{
+    return m_acknowledged;
+}
+
+void ChunkedUploadFileOperation::cancel()
+{
+    if(m_whole)
+        m_whole->cancel();
+    else if(m_state == Uploading)
+        fail("Operation canceled");
+}
+
+void ChunkedUploadFileOperation::resume()
+{
+    if(m_state != Error)
+        return;
+
+    // Without the ranged PUTs, the whole file again
+    if(m_whole)
+    {
+        m_whole.reset();
+        m_state = Uploading;
+        m_errorString.clear();
+        uploadWhole();
+        return;
+    }
+
+    // Chunks already acknowledged are kept, the others are sent again
+    m_state = Uploading;
+    m_errorString.clear();
+    m_attempts.clear();
+    m_retry.clear();
+    for(qint64 start = m_acknowledged; start < m_next; start += m_chunkSize)
+        if(!m_done.count(start))
+            m_retry.insert(start);
+    if(m_finalSize < 0)
+        m_growing.start();
+
+    // Support not known yet, or the check of the final size failed
+    if(!m_checked || (m_next && m_acknowledged == m_finalSize && m_running.empty()))
+        checkSize();
+    else
+        send();
+}
+
+void ChunkedUploadFileOperation::checkSize()
+{
+    m_sizeCheck = m_server->checkUploadedSize(m_fileName);
+    connect(m_sizeCheck.data(), &QNetworkReply::finished, this, &ChunkedUploadFileOperation::sizeChecked);
+}
+
+void ChunkedUploadFileOperation::sizeChecked()
+{
+    QSharedPointer<QNetworkReply> reply = std::move(m_sizeCheck);
+    if(m_state != Uploading)
+        return;
+
+    QString errorString;
+    qint64 size = m_server->sizeChecked(reply.data(), errorString);
+    if(size < 0)
+    {
+        if(!m_checked && m_server->rangedUploadUnsupported())
+        {
+            m_growing.stop();
+            if(m_finalSize >= 0)
+                uploadWhole();
+            else
+                m_wholeWaiting = true;
+            return;
+        }
+        fail(errorString);
+        return;
+    }
+
+    // Before the first chunk
+    if(!m_checked)
+    {
+        m_checked = true;
+        send();
+        return;
+    }
+
+    // Once all the chunks are acknowledged, all of them again if the server does not have the final size
+    if(size != m_finalSize)
+    {
+        m_acknowledged = 0;
+        m_next = 0;
+        m_done.clear();
+        fail(QString("Failure: the server has %1 bytes instead of %2").arg(size).arg(m_finalSize));
+        return;
+    }
+    m_state = Uploaded;
+    m_errorString.clear();
+    Q_EMIT finished();
+}
+
+void ChunkedUploadFileOperation::send()
+{
+    if(m_state != Uploading || !m_checked)
+        return;
+
+    qint64 available = m_finalSize >= 0 ? m_finalSize : m_data->size();
+    while((int)m_running.size() < m_parallel)
+    {
+        qint64 start;
+        if(!m_retry.empty())
+        {
+            start = *m_retry.begin();
+            m_retry.erase(m_retry.begin());
+        }
+        else
+        {
+            start = m_next;
+            bool isLast = m_finalSize >= 0 && start + m_chunkSize >= m_finalSize;
+            if(m_finalSize < 0 && start + m_chunkSize > available)
+                break; // Waiting for a complete chunk
+            if(m_finalSize >= 0 && start >= m_finalSize && (start || m_finalSize))
+                break; // All sent
+            if(isLast && (m_acknowledged < start || !m_running.empty()))
+                break; // The server completes the file with the last chunk
+            m_next = isLast ? std::max(m_finalSize, start + 1) : start + m_chunkSize;
+        }
+
+        qint64 size = std::min(m_chunkSize, available - start);
+        QByteArray data;
+        if(size > 0 && m_data->seek(start))
+            data = m_data->read(size);
+        if(data.size() != std::max<qint64>(size, 0))
+        {
+            fail(QString("Failure: can not read the data at %1").arg(start));
+            return;
+        }
+
+        QSharedPointer<QNetworkReply> reply = m_server->putChunk(m_url, data, start, m_finalSize);
+        QNetworkReply* replyData = reply.data();
+        m_running[start] = reply;
+        connect(replyData, &QNetworkReply::finished, this, [this, start, replyData]() { chunkFinished(start, replyData); });
+    }
+}
+
+void ChunkedUploadFileOperation::chunkFinished(qint64 start, QNetworkReply *reply)
+{
+    auto running = m_running.find(start);
+    if(running == m_running.end() || running->second.data() != reply)
+        return;
+    QSharedPointer<QNetworkReply> keep = running->second;
+    m_running.erase(running);
+
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool isAcknowledged = reply->error() == QNetworkReply::NoError && (statusCode == 200 || statusCode == 201 || statusCode == 204 || statusCode == 308);
+    if(!isAcknowledged)
+    {
+        if(++m_attempts[start] > Retries)
+        {
+            fail(reply->error() == QNetworkReply::NoError ? QString("Failure: statusCode = %1").arg(statusCode) : reply->errorString());
+            return;
+        }
+        m_retry.insert(start);
+        send();
+        return;
+    }
+
+    // Contiguous part from the start
+    qint64 end = m_finalSize >= 0 ? m_finalSize : std::numeric_limits<qint64>::max();
+    m_done.insert(start);
+    while(m_done.erase(m_acknowledged))
+        m_acknowledged = std::min(m_acknowledged + m_chunkSize, end);
+    Q_EMIT uploadProgress(m_acknowledged, m_finalSize >= 0 ? m_finalSize : m_data->size());
+
+    // Done once the server confirms the final size
+    if(m_acknowledged == m_finalSize && m_running.empty())
+    {
+        checkSize();
+        return;
+    }
+
+    send();
+}
+
+void ChunkedUploadFileOperation::uploadWhole()
+{
+    m_wholeWaiting = false;
+    if(!m_data->seek(0))
+    {
+        fail("Failure: can not read the data");
+        return;
+    }
+
+    m_whole = m_server->uploadWholeFile(m_fileName, m_data);
+    connect(m_whole.data(), &UploadFileOperation::uploadProgress, this, &UploadFileOperation::uploadProgress);
+    connect(m_whole.data(), &SignalServerOperation::finished, this, [this]() {
+        m_state = m_whole->state();
+        m_errorString = m_whole->errorString();
+        Q_EMIT finished();
+    });
+}
+
+void ChunkedUploadFileOperation::fail(const QString &errorString)
+{
+    m_state = Error;
+    m_errorString = errorString;
+    m_growing.stop();
+    m_wholeWaiting = false;
+    if(m_sizeCheck)
+    {
+        m_sizeCheck->disconnect(this);
+        m_sizeCheck->abort();
+        m_sizeCheck.reset();
+    }
+
+    // Chunks not acknowledged are sent again by resume()
+    auto running = std::move(m_running);
+    m_running.clear();
+    for(auto& item : running)
+    {
+        item.second->disconnect(this);
+        item.second->abort();
+    }
+
+    Q_EMIT finished();
+}
+
+namespace
+{
+const qint64 ChunkMin = 16 * 1024;
+const qint64 ChunkMax = 256 * 1024;
+const quint64 ChunkMask = 0xFFFFull << 48; // Boundary once the upper 16 bits are 0, about every 64 KiB after ChunkMin
+const qint64 SplitBlockSize = 1024 * 1024;
+
+// Random values per byte, the same in all the versions so the boundaries are the same as on the server
+const quint64* gearTable()
+{
+    static quint64 table[256];
+    static bool isSet = []() {
+        quint64 state = 0;
+        for(auto& value : table)
+        {
+            // splitmix64
+            quint64 z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            value = z ^ (z >> 31);
+        }
+        return true;
+    }();
+    Q_UNUSED(isSet);
+
+    return table;
+}
+}
+
+DeltaUploadFileOperation::DeltaUploadFileOperation(const QString &fileName, QSharedPointer<QIODevice> data, SignalServer *server, int parallel)
+    : UploadFileOperation(fileName, data, QSharedPointer<QNetworkReply>()), m_server(server), m_parallel(std::max(parallel, 1))
+{
+    // The whole data is read and hashed, out of the thread of the GUI
+    connect(&m_split, &QFutureWatcher<bool>::finished, this, &DeltaUploadFileOperation::splitFinished);
+    QIODevice* device = m_data.data();
+    m_split.setFuture(QtConcurrent::run([this, device]() { return split(*device, m_chunks, m_canceled); }));
+}
+
+DeltaUploadFileOperation::~DeltaUploadFileOperation()
+{
+    m_canceled = true;
+    m_split.waitForFinished();
+}
+
+bool DeltaUploadFileOperation::split(QIODevice &data, std::vector<chunk> &chunks, const std::atomic<bool> &canceled)
+{
+    const quint64* gear = gearTable();
+    chunks.clear();
+    if(!data.seek(0))
+        return false;
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    qint64 start = 0;
+    qint64 size = 0;
+    quint64 rolling = 0;
+    for(;;)
+    {
+        if(canceled)
+            return false;
+        QByteArray block = data.read(SplitBlockSize);
+        if(block.isEmpty())
+        {
+            if(!data.atEnd())
+                return false;
+            break;
+        }
+
+        const uchar* bytes = (const uchar*)block.constData();
+        int hashed = 0;
+        for(int i = 0; i < block.size(); ++i)
+        {
+            rolling = (rolling << 1) + gear[bytes[i]];
+            if(++size < ChunkMin || (size < ChunkMax && (rolling & ChunkMask)))
+                continue;
+
+            hash.addData(QByteArray::fromRawData(block.constData() + hashed, i + 1 - hashed));
+            hashed = i + 1;
+            chunks.push_back({ QString::fromLatin1(hash.result().toHex()), start, size });
+            hash.reset();
+            start += size;
+            size = 0;
+        }
+        hash.addData(QByteArray::fromRawData(block.constData() + hashed, block.size() - hashed));
+    }
+    if(size)
+        chunks.push_back({ QString::fromLatin1(hash.result().toHex()), start, size });
+
+    return true;
+}
+
+void DeltaUploadFileOperation::cancel()
+{
+    m_canceled = true;
+    if(m_whole)
+        m_whole->cancel();
+    else if(m_state == Uploading)
+        fail("Operation canceled");
+}
+
+void DeltaUploadFileOperation::splitFinished()
+{
+    if(m_state != Uploading)
+        return;
+    if(!m_split.result())
+    {
+        fail("Failure: can not read the data");
+        return;
+    }
+
+    QStringList hashes;
+    for(const auto& item : m_chunks)
+        hashes.append(item.hash);
+    m_check = m_server->checkFileChunks(m_fileName, m_data->size(), hashes);
+    connect(m_check.data(), &CheckFileUploadedOperation::finished, this, &DeltaUploadFileOperation::chunksChecked);
+}
+
+void DeltaUploadFileOperation::chunksChecked()
+{
+    if(m_state != Uploading)
+        return;
+
+    switch(m_check->state())
+    {
+    case CheckFileUploadedOperation::Uploaded:
+        done();
+        return;
+    case CheckFileUploadedOperation::NotUploaded:
+        break;
+    default:
+        if(m_server->deltaUploadUnsupported())
+            uploadWhole();
+        else
+            fail(m_check->errorString());
+        return;
+    }
+
+    // Once per hash, a chunk repeated in the file is stored once
+    QStringList missingChunks = m_check->missingChunks();
+    std::set<QString> missing(missingChunks.begin(), missingChunks.end());
+    for(size_t index = 0; index < m_chunks.size(); ++index)
+        if(missing.erase(m_chunks[index].hash))
+        {
+            m_missing.push_back(index);
+            m_total += m_chunks[index].size;
+        }
+    Q_EMIT uploadProgress(0, m_total);
+
+    if(m_missing.empty())
+        assemble();
+    else
+        send();
+}
+
+void DeltaUploadFileOperation::send()
+{
+    while(m_state == Uploading && (int)m_running.size() < m_parallel && m_next < m_missing.size())
+    {
+        size_t index = m_missing[m_next++];
+        sendChunk(index);
+    }
+}
+
+void DeltaUploadFileOperation::sendChunk(size_t index)
+{
+    const chunk& item = m_chunks[index];
+    QByteArray data;
+    if(m_data->seek(item.start))
+        data = m_data->read(item.size);
+    if(data.size() != item.size)
+    {
+        fail(QString("Failure: can not read the data at %1").arg(item.start));
+        return;
+    }
+
+    QSharedPointer<QNetworkReply> reply = m_server->putChunkData(item.hash, data);
+    QNetworkReply* replyData = reply.data();
+    m_running[index] = reply;
+    connect(replyData, &QNetworkReply::finished, this, [this, index, replyData]() { chunkFinished(index, replyData); });
+}
+
+void DeltaUploadFileOperation::chunkFinished(size_t index, QNetworkReply *reply)
+{
+    auto running = m_running.find(index);
+    if(running == m_running.end() || running->second.data() != reply)
+        return;
+    QSharedPointer<QNetworkReply> keep = running->second;
+    m_running.erase(running);
+
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if(reply->error() != QNetworkReply::NoError || (statusCode != 200 && statusCode != 201 && statusCode != 204))
+    {
+        if(++m_attempts[index] > Retries)
+        {
+            fail(reply->error() == QNetworkReply::NoError ? QString("Failure: statusCode = %1").arg(statusCode) : reply->errorString());
+            return;
+        }
+        sendChunk(index);
+        return;
+    }
+
+    m_sent += m_chunks[index].size;
+    Q_EMIT uploadProgress(m_sent, m_total);
+
+    if(m_next == m_missing.size() && m_running.empty())
+        assemble();
+    else
+        send();
+}
+
+void DeltaUploadFileOperation::assemble()
+{
+    QStringList hashes;
+    for(const auto& item : m_chunks)
+        hashes.append(item.hash);
+    m_assemble = m_server->assembleFile(m_fileName, m_data->size(), hashes);
+    connect(m_assemble.data(), &QNetworkReply::finished, this, &DeltaUploadFileOperation::assembled);
+}
+
+void DeltaUploadFileOperation::assembled()
+{
+    if(m_state != Uploading)
+        return;
+
+    int statusCode = m_assemble->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if(m_assemble->error() != QNetworkReply::NoError)
+        fail(m_assemble->errorString());
+    else if(statusCode != 200 && statusCode != 201 && statusCode != 204)
+        fail(QString("Failure: statusCode = %1").arg(statusCode));
+    else
+        done();
+}
+
+void DeltaUploadFileOperation::uploadWhole()
+{
+    m_whole = m_server->uploadFile(m_fileName, m_data);
+    connect(m_whole.data(), &UploadFileOperation::uploadProgress, this, &UploadFileOperation::uploadProgress);
+    connect(m_whole.data(), &SignalServerOperation::finished, this, [this]() {
+        m_state = m_whole->state();
+        m_errorString = m_whole->errorString();
+        Q_EMIT finished();
+    });
+}
+
+void DeltaUploadFileOperation::fail(const QString &errorString)
+{
+    m_state = Error;
+    m_errorString = errorString;
+
+    auto running = std::move(m_running);
+    m_running.clear();
+    for(auto& item : running)
+    {
+        item.second->disconnect(this);
+        item.second->abort();
+    }
+    if(m_assemble)
+    {
+        m_assemble->disconnect(this);
+        m_assemble->abort();
+    }
+
+    Q_EMIT finished();
+}
+
+void DeltaUploadFileOperation::done()
+{
+    m_state = Uploaded;
+    m_errorString.clear();
+    Q_EMIT finished();
+}
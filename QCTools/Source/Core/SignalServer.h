@@ -5,6 +5,16 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QStringList>
+#include <QTimer>
+#include <atomic>
+#include <map>
+#include <set>
+#include <vector>
+
+class SignalServer;
 
 class SignalServerOperation : public QObject
 {
@@ -19,12 +29,15 @@ Q_SIGNALS:
     void finished();
 
 public Q_SLOTS:
-    void cancel();
+    virtual void cancel();
 
 protected Q_SLOTS:
     virtual void onFinished() = 0;
 
 protected:
+    // For the operations created before their request
+    void setReply(QSharedPointer<QNetworkReply> reply);
+
     QString m_errorString;
     QString m_fileName;
     QSharedPointer<QNetworkReply> m_reply;
@@ -43,13 +56,21 @@ public:
 
     State state() const;
 
+    // Of a check of the chunks of a file (see SignalServer::checkFileChunks), the ones the server does not have once NotUploaded
+    QStringList missingChunks() const;
+
     CheckFileUploadedOperation(const QString& fileName, QSharedPointer<QNetworkReply> reply);
 
 protected:
     virtual void onFinished();
 
 private:
+    friend class SignalServer;
+
+    void finish(State state, const QString& errorString);
+
     State m_state;
+    QStringList m_missingChunks;
 };
 
 class UploadFileOperation : public SignalServerOperation
@@ -74,11 +95,124 @@ Q_SIGNALS:
 protected:
     virtual void onFinished();
 
-private:
     QSharedPointer<QIODevice> m_data;
     State m_state;
 };
 
+// Upload in chunks (PUT with a Content-Range header, several at a time), a failed chunk is sent again without
+// restarting the file and resume() continues after an error from the first chunk not acknowledged.
+// The data may still be written (e.g. a report exported while parsing), until setFinalSize() only the chunks
+// already complete are sent, the last one is sent once all the others are acknowledged.
+// The server is asked first for the size it has of the file (see SignalServer::checkUploadedSize), servers
+// without the ranged PUTs get the whole file as with SignalServer::uploadFile() once its final size is known.
+// It is asked again once all the chunks are acknowledged, the upload is done only if it has the final size.
+class ChunkedUploadFileOperation : public UploadFileOperation
+{
+    Q_OBJECT
+
+public:
+    // finalSize is -1 if the data is still written
+    ChunkedUploadFileOperation(const QString& fileName, QSharedPointer<QIODevice> data, SignalServer* server, const QUrl& url, qint64 chunkSize, int parallel, qint64 finalSize);
+
+    void setFinalSize(qint64 size);
+    bool finalSizeIsSet() const;
+
+    // Bytes from the start acknowledged by the server
+    qint64 acknowledged() const;
+
+public Q_SLOTS:
+    virtual void cancel();
+    void resume();
+
+protected:
+    virtual void onFinished() {}
+
+private:
+    void checkSize();
+    void sizeChecked();
+    void send();
+    void chunkFinished(qint64 start, QNetworkReply* reply);
+    void uploadWhole();
+    void fail(const QString& errorString);
+
+    static const int Retries = 3;
+
+    SignalServer* m_server;
+    QUrl m_url;
+    qint64 m_chunkSize;
+    int m_parallel;
+    qint64 m_finalSize;
+    qint64 m_next { 0 }; // First byte not sent
+    std::set<qint64> m_done; // Starts of the chunks acknowledged after the first one not acknowledged
+    qint64 m_acknowledged { 0 };
+    std::map<qint64, QSharedPointer<QNetworkReply>> m_running; // By start
+    std::map<qint64, int> m_attempts; // By start, of the chunks which failed
+    std::set<qint64> m_retry; // Starts of the chunks to send again
+    QTimer m_growing; // Waiting for the data
+    bool m_checked { false }; // Ranged PUTs supported
+    bool m_wholeWaiting { false }; // Without the ranged PUTs, for the final size
+    QSharedPointer<QNetworkReply> m_sizeCheck;
+    QSharedPointer<UploadFileOperation> m_whole; // Without the ranged PUTs
+};
+
+// Upload of the changes of a file (e.g. a report exported again after comments are added): the data is split at
+// content-defined boundaries (gear rolling hash, 16 KiB to 256 KiB, about 80 KiB on average) so a change only changes
+// the chunks around it, and each chunk is named by its SHA-256. The server tells which chunks it does not have (see
+// SignalServer::checkFileChunks), only these are sent, then it assembles the file from the list of its chunks.
+// Servers without the chunks store get the whole file as with SignalServer::uploadFile().
+class DeltaUploadFileOperation : public UploadFileOperation
+{
+    Q_OBJECT
+
+public:
+    DeltaUploadFileOperation(const QString& fileName, QSharedPointer<QIODevice> data, SignalServer* server, int parallel);
+    ~DeltaUploadFileOperation();
+
+    struct chunk
+    {
+        QString hash; // SHA-256, lower case hexadecimal
+        qint64 start;
+        qint64 size;
+    };
+    // Chunks of all the data, read from its start; false if the data can not be read or canceled is set
+    static bool split(QIODevice& data, std::vector<chunk>& chunks, const std::atomic<bool>& canceled);
+
+public Q_SLOTS:
+    virtual void cancel();
+
+protected:
+    virtual void onFinished() {}
+
+private:
+    void splitFinished();
+    void chunksChecked();
+    void send();
+    void sendChunk(size_t index);
+    void chunkFinished(size_t index, QNetworkReply* reply);
+    void assemble();
+    void assembled();
+    void uploadWhole();
+    void fail(const QString& errorString);
+    void done();
+
+    static const int Retries = 3;
+
+    SignalServer* m_server;
+    int m_parallel;
+    std::vector<chunk> m_chunks;
+    std::atomic<bool> m_canceled { false };
+    QFutureWatcher<bool> m_split;
+    QSharedPointer<CheckFileUploadedOperation> m_check;
+    std::vector<size_t> m_missing; // Indexes of the chunks to send, one per hash
+    size_t m_next { 0 }; // In m_missing
+    qint64 m_sent { 0 };
+    qint64 m_total { 0 }; // Of the chunks to send
+    std::map<size_t, QSharedPointer<QNetworkReply>> m_running; // By index in m_chunks
+    std::map<size_t, int> m_attempts;
+    QSharedPointer<QNetworkReply> m_assemble;
+    QSharedPointer<UploadFileOperation> m_whole; // Without the chunks store
+};
+
 class SignalServer : public QObject
 {
     Q_OBJECT
@@ -99,18 +233,69 @@ public:
     void setAutoUpload(bool enable);
     bool autoUpload() const;
 
+    // Size of the chunks of the uploads and count of chunks sent at a time, 0 means the whole file in one request
+    void setChunkSize(qint64 bytes, int parallel = 4);
+    qint64 chunkSize() const;
+
+    // Checks asked at about the same time are sent in one request, see sendChecks()
     QSharedPointer<CheckFileUploadedOperation> checkFileUploaded(const QString& fileName);
+    // Chunked if a chunk size is set
     QSharedPointer<UploadFileOperation> uploadFile(const QString& fileName, QSharedPointer<QIODevice> data);
+    // Data still written, chunked even without chunk size, see ChunkedUploadFileOperation::setFinalSize
+    QSharedPointer<ChunkedUploadFileOperation> uploadGrowingFile(const QString& fileName, QSharedPointer<QIODevice> data);
+    // Another version of a file already uploaded, the chunks not on the server only, see DeltaUploadFileOperation
+    QSharedPointer<UploadFileOperation> uploadFileChanges(const QString& fileName, QSharedPointer<QIODevice> data);
 
 private:
+    friend class ChunkedUploadFileOperation;
+    friend class DeltaUploadFileOperation;
+
+    // Chunks (in file order) the server does not have, Uploaded if it has the file made of them, Error with
+    // deltaUploadUnsupported() on servers without the chunks store
+    QSharedPointer<CheckFileUploadedOperation> checkFileChunks(const QString& fileName, qint64 size, const QStringList& hashes);
+    void checkChunksFinished(QSharedPointer<CheckFileUploadedOperation> operation, QNetworkReply* reply);
+    bool deltaUploadUnsupported() const;
+    // Bytes of a file the server has from ranged PUTs; sizeChecked() is -1 with errorString set if not known,
+    // with rangedUploadUnsupported() on servers without the ranged PUTs
+    QSharedPointer<QNetworkReply> checkUploadedSize(const QString& fileName);
+    qint64 sizeChecked(QNetworkReply* reply, QString& errorString);
+    bool rangedUploadUnsupported() const;
+    QSharedPointer<UploadFileOperation> uploadWholeFile(const QString& fileName, QSharedPointer<QIODevice> data);
+    QSharedPointer<QNetworkReply> putChunkData(const QString& hash, const QByteArray& data);
+    QSharedPointer<QNetworkReply> assembleFile(const QString& fileName, qint64 size, const QStringList& hashes);
+
+    void sendChecks();
+    void checksFinished(QList<QWeakPointer<CheckFileUploadedOperation>> operations, QNetworkReply* reply);
+    void checkOneByOne(QSharedPointer<CheckFileUploadedOperation> operation);
+
+    QUrl uploadUrl(const QString& fileName) const;
+    QNetworkRequest request(const QUrl& url) const;
     QSharedPointer<QNetworkReply> get(const QUrl& request);
+    QSharedPointer<QNetworkReply> post(const QUrl& request, const QByteArray& data);
     QSharedPointer<QNetworkReply> put(const QUrl& request, QIODevice* device);
+    // totalSize is -1 if not known yet
+    QSharedPointer<QNetworkReply> putChunk(const QUrl& request, const QByteArray& data, qint64 start, qint64 totalSize);
 
 private:
     QUrl m_url;
     QString m_login;
     QString m_password;
     bool m_autoUpload;
+    qint64 m_chunkSize;
+    int m_parallelChunks;
+
+    // Checks not sent yet, the ones of the files closed meanwhile are skipped
+    QList<QWeakPointer<CheckFileUploadedOperation>> m_checksPending;
+    QTimer m_checksTimer;
+    QHash<QNetworkReply*, QSharedPointer<QNetworkReply>> m_checksRunning;
+    enum BulkCheck
+    {
+        BulkCheckUnknown,
+        BulkCheckSupported,
+        BulkCheckUnsupported // Older servers, one request per file
+    } m_bulkCheck;
+    bool m_deltaUploadUnsupported;
+    bool m_rangedUploadUnsupported;
 
     QNetworkAccessManager m_manager;
 };
@@ -0,0 +1,760 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/SignalStatsKernel.h"
+#include "Core/CpuFeatures.h"
+
+extern "C"
+{
+#include <libavutil/dict.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <math.h>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define SIGNALSTATS_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #define SIGNALSTATS_AVX2
+        #define SIGNALSTATS_AVX512
+    #else
+        #define SIGNALSTATS_AVX2 __attribute__((target("avx2")))
+        #define SIGNALSTATS_AVX512 __attribute__((target("avx512f,avx512bw")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define SIGNALSTATS_NEON
+    #include <arm_neon.h>
+#endif
+
+//---------------------------------------------------------------------------
+static const char* const Names[SignalStatsKernel::Value_Max]=
+{
+    "lavfi.signalstats.YMIN",
+    "lavfi.signalstats.YLOW",
+    "lavfi.signalstats.YAVG",
+    "lavfi.signalstats.YHIGH",
+    "lavfi.signalstats.YMAX",
+    "lavfi.signalstats.UMIN",
+    "lavfi.signalstats.ULOW",
+    "lavfi.signalstats.UAVG",
+    "lavfi.signalstats.UHIGH",
+    "lavfi.signalstats.UMAX",
+    "lavfi.signalstats.VMIN",
+    "lavfi.signalstats.VLOW",
+    "lavfi.signalstats.VAVG",
+    "lavfi.signalstats.VHIGH",
+    "lavfi.signalstats.VMAX",
+    "lavfi.signalstats.SATMIN",
+    "lavfi.signalstats.SATLOW",
+    "lavfi.signalstats.SATAVG",
+    "lavfi.signalstats.SATHIGH",
+    "lavfi.signalstats.SATMAX",
+    "lavfi.signalstats.HUEMED",
+    "lavfi.signalstats.HUEAVG",
+    "lavfi.signalstats.YDIF",
+    "lavfi.signalstats.UDIF",
+    "lavfi.signalstats.VDIF",
+    "lavfi.signalstats.YBITDEPTH",
+    "lavfi.signalstats.UBITDEPTH",
+    "lavfi.signalstats.VBITDEPTH",
+    "lavfi.signalstats.TOUT",
+    "lavfi.signalstats.VREP",
+    "lavfi.signalstats.BRNG",
+};
+
+// Same list as the filter
+static const char* const FormatNames=
+    "yuv444p|yuv422p|yuv420p|yuv411p|yuv410p|yuv440p|"
+    "yuvj411p|yuvj420p|yuvj422p|yuvj444p|yuvj440p|"
+    "yuv444p9|yuv422p9|yuv420p9|"
+    "yuv444p10|yuv422p10|yuv420p10|yuv440p10|"
+    "yuv444p12|yuv422p12|yuv420p12|yuv440p12|"
+    "yuv444p14|yuv422p14|yuv420p14|"
+    "yuv444p16|yuv422p16|yuv420p16";
+
+static const double Pi=3.14159265358979323846;
+
+//***************************************************************************
+// Lines
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+template<typename T>
+static inline const T* Line(const AVFrame* Frame, int Plane, int y)
+{
+    return reinterpret_cast<const T*>(Frame->data[Plane]+(ptrdiff_t)y*Frame->linesize[Plane]);
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+static int64_t SumAbsDiff_C(const T* a, const T* b, int Count)
+{
+    int64_t Sum=0;
+    for (int i=0; i<Count; i++)
+        Sum+=std::abs((int)a[i]-(int)b[i]);
+    return Sum;
+}
+
+//---------------------------------------------------------------------------
+// As filter_tout_outlier() of FFmpeg, which has 8-bit parameters: only the low 8 bits of deeper samples are compared
+static inline bool ToutOutlier(uint8_t x, uint8_t y, uint8_t z)
+{
+    return ((std::abs(x-y)+std::abs(z-y))/2)-std::abs(z-x)>4;
+}
+
+//---------------------------------------------------------------------------
+// Temporal outliers of the samples Begin to End of the line Rows[2], compared with the lines 1 (and 2 if Far) above and below
+template<typename T>
+static int Tout_C(const T* const Rows[5], int Begin, int End, bool Far)
+{
+    int Score=0;
+    for (int x=Begin; x<End; x++)
+    {
+        bool Filt=true;
+        for (int i=-1; i<=1 && Filt; i++)
+        {
+            Filt=ToutOutlier(Rows[1][x+i], Rows[2][x+i], Rows[3][x+i]);
+            if (Filt && Far)
+                Filt=ToutOutlier(Rows[0][x+i], Rows[2][x+i], Rows[4][x+i]);
+        }
+        Score+=Filt;
+    }
+    return Score;
+}
+
+#if defined(SIGNALSTATS_X86)
+//---------------------------------------------------------------------------
+static SIGNALSTATS_AVX2 int64_t SumAbsDiff_AVX2(const uint8_t* a, const uint8_t* b, int Count)
+{
+    __m256i Sum=_mm256_setzero_si256();
+    int i=0;
+    for (; i+32<=Count; i+=32)
+        Sum=_mm256_add_epi64(Sum, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)(a+i)), _mm256_loadu_si256((const __m256i*)(b+i))));
+
+    alignas(32) int64_t Lanes[4];
+    _mm256_store_si256((__m256i*)Lanes, Sum);
+    return Lanes[0]+Lanes[1]+Lanes[2]+Lanes[3]+SumAbsDiff_C(a+i, b+i, Count-i);
+}
+
+//---------------------------------------------------------------------------
+// Count is a line, 32-bit lanes are enough up to 2^18 samples
+static SIGNALSTATS_AVX2 int64_t SumAbsDiff_AVX2(const uint16_t* a, const uint16_t* b, int Count)
+{
+    const __m256i Zero=_mm256_setzero_si256();
+    __m256i Sum=Zero;
+    int i=0;
+    for (; i+16<=Count; i+=16)
+    {
+        __m256i x=_mm256_loadu_si256((const __m256i*)(a+i));
+        __m256i y=_mm256_loadu_si256((const __m256i*)(b+i));
+        __m256i Diff=_mm256_or_si256(_mm256_subs_epu16(x, y), _mm256_subs_epu16(y, x));
+        Sum=_mm256_add_epi32(Sum, _mm256_add_epi32(_mm256_unpacklo_epi16(Diff, Zero), _mm256_unpackhi_epi16(Diff, Zero)));
+    }
+
+    alignas(32) uint32_t Lanes[8];
+    _mm256_store_si256((__m256i*)Lanes, Sum);
+    int64_t Result=0;
+    for (auto Lane : Lanes)
+        Result+=Lane;
+    return Result+SumAbsDiff_C(a+i, b+i, Count-i);
+}
+
+//---------------------------------------------------------------------------
+static SIGNALSTATS_AVX512 int64_t SumAbsDiff_AVX512(const uint8_t* a, const uint8_t* b, int Count)
+{
+    __m512i Sum=_mm512_setzero_si512();
+    int i=0;
+    for (; i+64<=Count; i+=64)
+        Sum=_mm512_add_epi64(Sum, _mm512_sad_epu8(_mm512_loadu_si512((const void*)(a+i)), _mm512_loadu_si512((const void*)(b+i))));
+
+    alignas(64) int64_t Lanes[8];
+    _mm512_store_si512((void*)Lanes, Sum);
+    int64_t Result=0;
+    for (auto Lane : Lanes)
+        Result+=Lane;
+    return Result+SumAbsDiff_C(a+i, b+i, Count-i);
+}
+
+//---------------------------------------------------------------------------
+// Count is a line, 32-bit lanes are enough up to 2^20 samples
+static SIGNALSTATS_AVX512 int64_t SumAbsDiff_AVX512(const uint16_t* a, const uint16_t* b, int Count)
+{
+    const __m512i Zero=_mm512_setzero_si512();
+    __m512i Sum=Zero;
+    int i=0;
+    for (; i+32<=Count; i+=32)
+    {
+        __m512i x=_mm512_loadu_si512((const void*)(a+i));
+        __m512i y=_mm512_loadu_si512((const void*)(b+i));
+        __m512i Diff=_mm512_or_si512(_mm512_subs_epu16(x, y), _mm512_subs_epu16(y, x));
+        Sum=_mm512_add_epi32(Sum, _mm512_add_epi32(_mm512_unpacklo_epi16(Diff, Zero), _mm512_unpackhi_epi16(Diff, Zero)));
+    }
+
+    alignas(64) uint32_t Lanes[16];
+    _mm512_store_si512((void*)Lanes, Sum);
+    int64_t Result=0;
+    for (auto Lane : Lanes)
+        Result+=Lane;
+    return Result+SumAbsDiff_C(a+i, b+i, Count-i);
+}
+
+//---------------------------------------------------------------------------
+// 16 samples in 16-bit lanes, low 8 bits only (see ToutOutlier)
+static SIGNALSTATS_AVX2 __m256i ToutLoad_AVX2(const uint8_t* p)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)p));
+}
+
+static SIGNALSTATS_AVX2 __m256i ToutLoad_AVX2(const uint16_t* p)
+{
+    return _mm256_and_si256(_mm256_loadu_si256((const __m256i*)p), _mm256_set1_epi16(0xFF));
+}
+
+static SIGNALSTATS_AVX2 __m256i ToutOutlier_AVX2(__m256i x, __m256i y, __m256i z)
+{
+    __m256i xy=_mm256_abs_epi16(_mm256_sub_epi16(x, y));
+    __m256i zy=_mm256_abs_epi16(_mm256_sub_epi16(z, y));
+    __m256i zx=_mm256_abs_epi16(_mm256_sub_epi16(z, x));
+    return _mm256_cmpgt_epi16(_mm256_sub_epi16(_mm256_srli_epi16(_mm256_add_epi16(xy, zy), 1), zx), _mm256_set1_epi16(4));
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+static SIGNALSTATS_AVX2 int Tout_AVX2(const T* const Rows[5], int Width, bool Far)
+{
+    __m256i Count=_mm256_setzero_si256();
+    int x=1;
+    for (; x+16<=Width-1; x+=16)
+    {
+        __m256i Filt=_mm256_set1_epi16(-1);
+        for (int i=-1; i<=1; i++)
+        {
+            __m256i Center=ToutLoad_AVX2(Rows[2]+x+i);
+            Filt=_mm256_and_si256(Filt, ToutOutlier_AVX2(ToutLoad_AVX2(Rows[1]+x+i), Center, ToutLoad_AVX2(Rows[3]+x+i)));
+            if (Far)
+                Filt=_mm256_and_si256(Filt, ToutOutlier_AVX2(ToutLoad_AVX2(Rows[0]+x+i), Center, ToutLoad_AVX2(Rows[4]+x+i)));
+        }
+        Count=_mm256_sub_epi16(Count, Filt); // -1 for each outlier
+    }
+
+    alignas(32) int32_t Lanes[8];
+    _mm256_store_si256((__m256i*)Lanes, _mm256_madd_epi16(Count, _mm256_set1_epi16(1)));
+    int Score=0;
+    for (auto Lane : Lanes)
+        Score+=Lane;
+    return Score+Tout_C(Rows, x, Width-1, Far);
+}
+
+//---------------------------------------------------------------------------
+static bool HasAvx2()
+{
+    return CpuFeatures::Uses(CpuFeatures::Level_AVX2);
+}
+
+static bool HasAvx512()
+{
+    return CpuFeatures::Uses(CpuFeatures::Level_AVX512);
+}
+#endif // SIGNALSTATS_X86
+
+#if defined(SIGNALSTATS_NEON)
+//---------------------------------------------------------------------------
+static int64_t SumAbsDiff_NEON(const uint8_t* a, const uint8_t* b, int Count)
+{
+    uint32x4_t Sum=vdupq_n_u32(0);
+    int i=0;
+    for (; i+16<=Count; i+=16)
+        Sum=vpadalq_u16(Sum, vpaddlq_u8(vabdq_u8(vld1q_u8(a+i), vld1q_u8(b+i))));
+    return (int64_t)vaddlvq_u32(Sum)+SumAbsDiff_C(a+i, b+i, Count-i);
+}
+
+//---------------------------------------------------------------------------
+// Count is a line, 32-bit lanes are enough up to 2^17 samples
+static int64_t SumAbsDiff_NEON(const uint16_t* a, const uint16_t* b, int Count)
+{
+    uint32x4_t Sum=vdupq_n_u32(0);
+    int i=0;
+    for (; i+8<=Count; i+=8)
+        Sum=vpadalq_u16(Sum, vabdq_u16(vld1q_u16(a+i), vld1q_u16(b+i)));
+    return (int64_t)vaddlvq_u32(Sum)+SumAbsDiff_C(a+i, b+i, Count-i);
+}
+
+//---------------------------------------------------------------------------
+// 8 samples in 16-bit lanes, low 8 bits only (see ToutOutlier)
+static inline int16x8_t ToutLoad_NEON(const uint8_t* p)
+{
+    return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)));
+}
+
+static inline int16x8_t ToutLoad_NEON(const uint16_t* p)
+{
+    return vreinterpretq_s16_u16(vandq_u16(vld1q_u16(p), vdupq_n_u16(0xFF)));
+}
+
+static inline uint16x8_t ToutOutlier_NEON(int16x8_t x, int16x8_t y, int16x8_t z)
+{
+    int16x8_t Value=vsubq_s16(vshrq_n_s16(vaddq_s16(vabdq_s16(x, y), vabdq_s16(z, y)), 1), vabdq_s16(z, x));
+    return vcgtq_s16(Value, vdupq_n_s16(4));
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+static int Tout_NEON(const T* const Rows[5], int Width, bool Far)
+{
+    uint16x8_t Count=vdupq_n_u16(0);
+    int x=1;
+    for (; x+8<=Width-1; x+=8)
+    {
+        uint16x8_t Filt=vdupq_n_u16(0xFFFF);
+        for (int i=-1; i<=1; i++)
+        {
+            int16x8_t Center=ToutLoad_NEON(Rows[2]+x+i);
+            Filt=vandq_u16(Filt, ToutOutlier_NEON(ToutLoad_NEON(Rows[1]+x+i), Center, ToutLoad_NEON(Rows[3]+x+i)));
+            if (Far)
+                Filt=vandq_u16(Filt, ToutOutlier_NEON(ToutLoad_NEON(Rows[0]+x+i), Center, ToutLoad_NEON(Rows[4]+x+i)));
+        }
+        Count=vsubq_u16(Count, Filt); // 0xFFFF for each outlier
+    }
+    return (int)vaddlvq_u16(Count)+Tout_C(Rows, x, Width-1, Far);
+}
+#endif // SIGNALSTATS_NEON
+
+//---------------------------------------------------------------------------
+template<typename T>
+static inline int64_t SumAbsDiff(const T* a, const T* b, int Count)
+{
+#if defined(SIGNALSTATS_X86)
+    if (HasAvx512())
+        return SumAbsDiff_AVX512(a, b, Count);
+    if (HasAvx2())
+        return SumAbsDiff_AVX2(a, b, Count);
+#elif defined(SIGNALSTATS_NEON)
+    if (CpuFeatures::Uses(CpuFeatures::Level_NEON))
+        return SumAbsDiff_NEON(a, b, Count);
+#endif
+    return SumAbsDiff_C(a, b, Count);
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+static inline int Tout(const T* const Rows[5], int Width, bool Far)
+{
+#if defined(SIGNALSTATS_X86)
+    if (HasAvx2())
+        return Tout_AVX2(Rows, Width, Far);
+#elif defined(SIGNALSTATS_NEON)
+    if (CpuFeatures::Uses(CpuFeatures::Level_NEON))
+        return Tout_NEON(Rows, Width, Far);
+#endif
+    return Tout_C(Rows, 1, Width-1, Far);
+}
+
+//***************************************************************************
+// Saturation and hue
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// As compute_sat_hue_metrics8/16() of FFmpeg, with the same float and double operations
+static inline void SatHue(int U, int V, int Mid, uint16_t& Sat, int16_t& Hue)
+{
+    Sat=(uint16_t)hypotf((float)(U-Mid), (float)(V-Mid));
+    Hue=(int16_t)fmodf(floorf((float)((180/Pi)*atan2f((float)(U-Mid), (float)(V-Mid))+180)), 360.f);
+}
+
+//---------------------------------------------------------------------------
+// By (U << Depth) | V, 4 MiB for 10-bit
+struct SatHueTable
+{
+    std::vector<uint16_t>       Sat;
+    std::vector<int16_t>        Hue;
+};
+static const int SatHueTable_Depth_Max=10;
+
+static const SatHueTable& SatHueTable_Get(int Depth)
+{
+    static SatHueTable Tables[SatHueTable_Depth_Max+1];
+    static std::once_flag Flags[SatHueTable_Depth_Max+1];
+
+    std::call_once(Flags[Depth], [Depth]() {
+        auto& Table=Tables[Depth];
+        const int Size=1<<Depth;
+        const int Mid=1<<(Depth-1);
+        Table.Sat.resize((size_t)Size*Size);
+        Table.Hue.resize((size_t)Size*Size);
+        for (int U=0; U<Size; U++)
+            for (int V=0; V<Size; V++)
+                SatHue(U, V, Mid, Table.Sat[((size_t)U<<Depth)|V], Table.Hue[((size_t)U<<Depth)|V]);
+    });
+    return Tables[Depth];
+}
+
+//---------------------------------------------------------------------------
+static int Popcount(unsigned Value)
+{
+    int Count=0;
+    for (; Value; Value&=Value-1)
+        Count++;
+    return Count;
+}
+
+//***************************************************************************
+// SignalStatsKernel
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+SignalStatsKernel::SignalStatsKernel(bool LumaOnly_) :
+    Previous(av_frame_alloc()),
+    LumaOnly(LumaOnly_)
+{
+    std::fill(std::begin(Values), std::end(Values), 0.0);
+}
+
+//---------------------------------------------------------------------------
+SignalStatsKernel::~SignalStatsKernel()
+{
+    av_frame_free(&Previous);
+}
+
+//---------------------------------------------------------------------------
+const char* SignalStatsKernel::Name(value Value)
+{
+    return Value<Value_Max?Names[Value]:"";
+}
+
+//---------------------------------------------------------------------------
+const char* SignalStatsKernel::Formats()
+{
+    return FormatNames;
+}
+
+//---------------------------------------------------------------------------
+bool SignalStatsKernel::Supports(int Format)
+{
+    static const std::vector<int> List=[]() {
+        std::vector<int> Result;
+        std::string Text(FormatNames);
+        size_t Begin=0;
+        while (Begin<=Text.size())
+        {
+            size_t End=Text.find('|', Begin);
+            if (End==std::string::npos)
+                End=Text.size();
+            Result.push_back(av_get_pix_fmt(Text.substr(Begin, End-Begin).c_str()));
+            Begin=End+1;
+        }
+        return Result;
+    }();
+
+    return Format!=AV_PIX_FMT_NONE && std::find(List.begin(), List.end(), Format)!=List.end();
+}
+
+//---------------------------------------------------------------------------
+bool SignalStatsKernel::IsLuma(value Value)
+{
+    switch (Value)
+    {
+        case Value_YMIN         :
+        case Value_YLOW         :
+        case Value_YAVG         :
+        case Value_YHIGH        :
+        case Value_YMAX         :
+        case Value_YDIF         :
+        case Value_YBITDEPTH    :
+        case Value_TOUT         :
+        case Value_VREP         :
+                                    return true;
+        default                 :   return false;
+    }
+}
+
+//---------------------------------------------------------------------------
+double SignalStatsKernel::Get(value Value) const
+{
+    return Value<Value_Max?Values[Value]:0.0;
+}
+
+//---------------------------------------------------------------------------
+bool SignalStatsKernel::Compute(const AVFrame* Frame)
+{
+    if (!Frame || !Frame->data[0] || Frame->width<=0 || Frame->height<=0 || !Supports(Frame->format))
+        return false;
+
+    const AVPixFmtDescriptor* Desc=av_pix_fmt_desc_get((AVPixelFormat)Frame->format);
+    const int Depth=Desc->comp[0].depth;
+
+    // First frame or new size, compared with itself as when the filter is configured again
+    const AVFrame* Prev=Frame;
+    if (Previous->data[0] && Previous->format==Frame->format && Previous->width==Frame->width && Previous->height==Frame->height)
+        Prev=Previous;
+
+    if (Depth>8)
+        Compute<uint16_t>(Frame, Prev, Depth, Desc->log2_chroma_w, Desc->log2_chroma_h);
+    else
+        Compute<uint8_t>(Frame, Prev, Depth, Desc->log2_chroma_w, Desc->log2_chroma_h);
+
+    av_frame_unref(Previous);
+    av_frame_ref(Previous, Frame);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool SignalStatsKernel::Repeat()
+{
+    if (!Previous->data[0])
+        return false;
+
+    Values[Value_YDIF]=0;
+    Values[Value_UDIF]=0;
+    Values[Value_VDIF]=0;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+void SignalStatsKernel::Compute(const AVFrame* Frame, const AVFrame* Prev, int Depth, int HSub, int VSub)
+{
+    const int Width=Frame->width;
+    const int Height=Frame->height;
+    const int ChromaWidth=-((-Width)>>HSub);
+    const int ChromaHeight=-((-Height)>>VSub);
+    const int64_t Fs=(int64_t)Width*Height;
+    const int64_t ChromaFs=(int64_t)ChromaWidth*ChromaHeight;
+    const int Size=1<<Depth;
+    const unsigned Mask=Size-1; // Samples out of the depth are not valid, they must not be out of the histograms
+    const int Mid=1<<(Depth-1);
+
+    for (auto& Histogram : Histograms)
+        Histogram.assign(Size, 0);
+    uint32_t* HistY=Histograms[0].data();
+    uint32_t* HistU=Histograms[1].data();
+    uint32_t* HistV=Histograms[2].data();
+    uint32_t* HistSat=Histograms[3].data();
+    uint32_t HistHue[360]={};
+
+    // Luma
+    unsigned MaskY=0;
+    int64_t DifY=0;
+    for (int y=0; y<Height; y++)
+    {
+        const T* p=Line<T>(Frame, 0, y);
+        for (int x=0; x<Width; x++)
+        {
+            MaskY|=p[x];
+            HistY[p[x]&Mask]++;
+        }
+        DifY+=SumAbsDiff(p, Line<T>(Prev, 0, y), Width);
+    }
+
+    // Chroma, saturation and hue
+    const SatHueTable* Table=Depth<=SatHueTable_Depth_Max?&SatHueTable_Get(Depth):nullptr;
+    unsigned MaskU=0, MaskV=0;
+    int64_t DifU=0, DifV=0;
+    for (int y=0; y<ChromaHeight && !LumaOnly; y++)
+    {
+        const T* u=Line<T>(Frame, 1, y);
+        const T* v=Line<T>(Frame, 2, y);
+        for (int x=0; x<ChromaWidth; x++)
+        {
+            MaskU|=u[x];
+            MaskV|=v[x];
+            const unsigned U=u[x]&Mask;
+            const unsigned V=v[x]&Mask;
+            HistU[U]++;
+            HistV[V]++;
+
+            uint16_t Sat;
+            int16_t Hue;
+            if (Table)
+            {
+                const size_t Pos=((size_t)U<<Depth)|V;
+                Sat=Table->Sat[Pos];
+                Hue=Table->Hue[Pos];
+            }
+            else
+                SatHue(U, V, Mid, Sat, Hue);
+            HistSat[Sat]++;
+            HistHue[Hue]++;
+        }
+        DifU+=SumAbsDiff(u, Line<T>(Prev, 1, y), ChromaWidth);
+        DifV+=SumAbsDiff(v, Line<T>(Prev, 2, y), ChromaWidth);
+    }
+
+    // TOUT, the lines 2 above and below are used when they exist (interlaced content)
+    int64_t Tout_Score=0;
+    for (int y=1; y+1<Height; y++)
+    {
+        const bool Far=y>=2 && y+2<Height;
+        const T* const Rows[5]=
+        {
+            Far?Line<T>(Frame, 0, y-2):nullptr,
+            Line<T>(Frame, 0, y-1),
+            Line<T>(Frame, 0, y),
+            Line<T>(Frame, 0, y+1),
+            Far?Line<T>(Frame, 0, y+2):nullptr,
+        };
+        Tout_Score+=Tout(Rows, Width, Far);
+    }
+
+    // VREP, lines repeated from the 4th line above, all of their samples count
+    int64_t Vrep_Score=0;
+    for (int y=4; y<Height; y++)
+        if (SumAbsDiff(Line<T>(Frame, 0, y-4), Line<T>(Frame, 0, y), Width)<Width)
+            Vrep_Score+=Width;
+
+    // BRNG, out of the broadcast range
+    const int Mult=1<<(Depth-8);
+    const int Luma_Min=16*Mult, Luma_Max=235*Mult, Chroma_Min=16*Mult, Chroma_Max=240*Mult;
+    int64_t Brng_Score=0;
+    for (int y=0; y<Height && !LumaOnly; y++)
+    {
+        const T* p=Line<T>(Frame, 0, y);
+        const T* u=Line<T>(Frame, 1, y>>VSub);
+        const T* v=Line<T>(Frame, 2, y>>VSub);
+        for (int x=0; x<Width; x++)
+        {
+            const int Luma=p[x];
+            const int U=u[x>>HSub];
+            const int V=v[x>>HSub];
+            Brng_Score+=Luma<Luma_Min || Luma>Luma_Max || U<Chroma_Min || U>Chroma_Max || V<Chroma_Min || V>Chroma_Max;
+        }
+    }
+
+    // Percentiles from the histograms
+    const int64_t Low=lrint(Fs*10/100.);
+    const int64_t High=lrint(Fs*90/100.);
+    const int64_t ChromaLow=lrint(ChromaFs*10/100.);
+    const int64_t ChromaHigh=lrint(ChromaFs*90/100.);
+    int MinY=-1, MinU=-1, MinV=-1, MinSat=-1;
+    int MaxY=-1, MaxU=-1, MaxV=-1, MaxSat=-1;
+    int LowY=-1, LowU=-1, LowV=-1, LowSat=-1;
+    int HighY=-1, HighU=-1, HighV=-1, HighSat=-1;
+    int64_t TotY=0, TotU=0, TotV=0, TotSat=0;
+    int64_t AccY=0, AccU=0, AccV=0, AccSat=0;
+    for (int i=0; i<Size; i++)
+    {
+        if (MinY<0 && HistY[i])
+            MinY=i;
+        if (MinU<0 && HistU[i])
+            MinU=i;
+        if (MinV<0 && HistV[i])
+            MinV=i;
+        if (MinSat<0 && HistSat[i])
+            MinSat=i;
+
+        if (HistY[i])
+            MaxY=i;
+        if (HistU[i])
+            MaxU=i;
+        if (HistV[i])
+            MaxV=i;
+        if (HistSat[i])
+            MaxSat=i;
+
+        TotY+=(int64_t)HistY[i]*i;
+        TotU+=(int64_t)HistU[i]*i;
+        TotV+=(int64_t)HistV[i]*i;
+        TotSat+=(int64_t)HistSat[i]*i;
+
+        AccY+=HistY[i];
+        AccU+=HistU[i];
+        AccV+=HistV[i];
+        AccSat+=HistSat[i];
+
+        if (LowY==-1 && AccY>=Low)
+            LowY=i;
+        if (LowU==-1 && AccU>=ChromaLow)
+            LowU=i;
+        if (LowV==-1 && AccV>=ChromaLow)
+            LowV=i;
+        if (LowSat==-1 && AccSat>=ChromaLow)
+            LowSat=i;
+
+        if (HighY==-1 && AccY>=High)
+            HighY=i;
+        if (HighU==-1 && AccU>=ChromaHigh)
+            HighU=i;
+        if (HighV==-1 && AccV>=ChromaHigh)
+            HighV=i;
+        if (HighSat==-1 && AccSat>=ChromaHigh)
+            HighSat=i;
+    }
+
+    int MedHue=-1;
+    int64_t TotHue=0, AccHue=0;
+    for (int i=0; i<360; i++)
+    {
+        TotHue+=(int64_t)HistHue[i]*i;
+        AccHue+=HistHue[i];
+        if (MedHue==-1 && AccHue>ChromaFs/2)
+            MedHue=i;
+    }
+
+    Values[Value_YMIN]=MinY;
+    Values[Value_YLOW]=LowY;
+    Values[Value_YAVG]=1.0*TotY/Fs;
+    Values[Value_YHIGH]=HighY;
+    Values[Value_YMAX]=MaxY;
+    Values[Value_UMIN]=MinU;
+    Values[Value_ULOW]=LowU;
+    Values[Value_UAVG]=1.0*TotU/ChromaFs;
+    Values[Value_UHIGH]=HighU;
+    Values[Value_UMAX]=MaxU;
+    Values[Value_VMIN]=MinV;
+    Values[Value_VLOW]=LowV;
+    Values[Value_VAVG]=1.0*TotV/ChromaFs;
+    Values[Value_VHIGH]=HighV;
+    Values[Value_VMAX]=MaxV;
+    Values[Value_SATMIN]=MinSat;
+    Values[Value_SATLOW]=LowSat;
+    Values[Value_SATAVG]=1.0*TotSat/ChromaFs;
+    Values[Value_SATHIGH]=HighSat;
+    Values[Value_SATMAX]=MaxSat;
+    Values[Value_HUEMED]=MedHue;
+    Values[Value_HUEAVG]=1.0*TotHue/ChromaFs;
+    Values[Value_YDIF]=1.0*DifY/Fs;
+    Values[Value_UDIF]=1.0*DifU/ChromaFs;
+    Values[Value_VDIF]=1.0*DifV/ChromaFs;
+    Values[Value_YBITDEPTH]=Popcount(MaskY&0xFFFF);
+    Values[Value_UBITDEPTH]=Popcount(MaskU&0xFFFF);
+    Values[Value_VBITDEPTH]=Popcount(MaskV&0xFFFF);
+    Values[Value_TOUT]=1.0*Tout_Score/Fs;
+    Values[Value_VREP]=1.0*Vrep_Score/Fs;
+    Values[Value_BRNG]=1.0*Brng_Score/Fs;
+}
+
+//---------------------------------------------------------------------------
+std::string SignalStatsKernel::Check(const AVDictionary* Metadata) const
+{
+    static const size_t Prefix=strlen("lavfi.signalstats.");
+
+    std::string Result;
+    for (int i=0; i<Value_Max; i++)
+    {
+        // Values not in the metadata are not computed by this version of the filter
+        const AVDictionaryEntry* Entry=av_dict_get(Metadata, Names[i], nullptr, 0);
+        if (!Entry || (LumaOnly && !IsLuma((value)i)))
+            continue;
+
+        char Value[32];
+        snprintf(Value, sizeof(Value), "%g", Values[i]);
+        if (!strcmp(Entry->value, Value))
+            continue;
+
+        if (!Result.empty())
+            Result+=", ";
+        Result+=std::string(Names[i]+Prefix)+' '+Value+" != "+Entry->value;
+    }
+    return Result;
+}
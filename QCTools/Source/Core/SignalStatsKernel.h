@@ -0,0 +1,105 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef SignalStatsKernel_H
+#define SignalStatsKernel_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct AVFrame;
+struct AVDictionary;
+
+//---------------------------------------------------------------------------
+// Values of "signalstats=stat=tout+vrep+brng" computed without the filter,
+// in one pass per plane: the histograms and the masks of the planes, the
+// differences with the previous frame, TOUT, VREP and BRNG.
+//
+// Differences use AVX-512 or AVX2 and TOUT AVX2 (the level of CpuFeatures) or
+// NEON, saturation and hue come from a table of the chroma pairs up to 10-bit.
+// Formulas and their rounding are the ones of FFmpeg, so the values are the
+// same as the ones of the filter for the same frames.
+//
+// Luma only (see AnalysisProfiles), the chroma planes are not read: the
+// values of the chroma, saturation, hue and BRNG are not meaningful and
+// not checked.
+class SignalStatsKernel
+{
+public:
+    enum value
+    {
+        Value_YMIN,
+        Value_YLOW,
+        Value_YAVG,
+        Value_YHIGH,
+        Value_YMAX,
+        Value_UMIN,
+        Value_ULOW,
+        Value_UAVG,
+        Value_UHIGH,
+        Value_UMAX,
+        Value_VMIN,
+        Value_VLOW,
+        Value_VAVG,
+        Value_VHIGH,
+        Value_VMAX,
+        Value_SATMIN,
+        Value_SATLOW,
+        Value_SATAVG,
+        Value_SATHIGH,
+        Value_SATMAX,
+        Value_HUEMED,
+        Value_HUEAVG,
+        Value_YDIF,
+        Value_UDIF,
+        Value_VDIF,
+        Value_YBITDEPTH,
+        Value_UBITDEPTH,
+        Value_VBITDEPTH,
+        Value_TOUT,
+        Value_VREP,
+        Value_BRNG,
+        Value_Max
+    };
+
+    explicit                    SignalStatsKernel           (bool LumaOnly=false);
+                                ~SignalStatsKernel          ();
+                                SignalStatsKernel           (const SignalStatsKernel&) = delete;
+    SignalStatsKernel&          operator=                   (const SignalStatsKernel&) = delete;
+
+    // Key of the value in the metadata of the filter ("lavfi.signalstats.YMIN"...)
+    static const char*          Name                        (value Value);
+
+    // Formats of the filter, as the pix_fmts option of the format filter, so frames are converted as for the filter
+    static const char*          Formats                     ();
+    static bool                 Supports                    (int Format);
+
+    // Values of a frame, false if its format is not supported
+    // The frame is kept for the differences with the next one, as the filter does
+    bool                        Compute                     (const AVFrame* Frame);
+    // Values of a frame with the pixels of the last one computed, not computed again: the differences are 0; false if there is none
+    bool                        Repeat                      ();
+    double                      Get                         (value Value) const;
+
+    // Values computed in luma only mode
+    static bool                 IsLuma                      (value Value);
+
+    // Values different from the ones of the filter in Metadata ("YAVG 16.5 != 16.4"...), empty if all are the same
+    std::string                 Check                       (const AVDictionary* Metadata) const;
+
+private:
+    template<typename T>
+    void                        Compute                     (const AVFrame* Frame, const AVFrame* Previous, int Depth, int HSub, int VSub);
+
+    double                      Values[Value_Max];
+    bool                        LumaOnly;
+    AVFrame*                    Previous;
+    std::vector<uint32_t>       Histograms[4];              // Y, U, V, saturation
+};
+
+#endif // SignalStatsKernel_H
@@ -0,0 +1,724 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsArrowReport.h"
+#include "Core/CommonStats.h"
+#include "Core/VideoStats.h"
+#include "Core/VideoCore.h"
+#include "Core/FileInformation.h"
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+extern "C"
+{
+#include <libavutil/pixdesc.h>
+}
+
+#include <QIODevice>
+#include <QMutexLocker>
+#include <QSysInfo>
+#include <QDebug>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <numeric>
+
+//---------------------------------------------------------------------------
+static const char       Arrow_Magic[8]={'A', 'R', 'R', 'O', 'W', '1', '\0', '\0'};
+static const int16_t    Arrow_MetadataVersion=4;    // V5
+static const uint32_t   Arrow_Continuation=0xFFFFFFFF;
+static std::atomic<size_t> BatchFrames(65536);
+
+// MessageHeader union of Message.fbs
+enum arrow_header : uint8_t
+{
+    Header_Schema           =1,
+    Header_DictionaryBatch  =2,
+    Header_RecordBatch      =3,
+};
+
+// Type union of Schema.fbs
+enum arrow_type : uint8_t
+{
+    ArrowType_Int           =2,
+    ArrowType_FloatingPoint =3,
+    ArrowType_Utf8          =5,
+    ArrowType_Bool          =6,
+};
+
+//***************************************************************************
+// Helpers
+//***************************************************************************
+
+namespace
+{
+//---------------------------------------------------------------------------
+// Flatbuffer (metadata of the Arrow messages), written front to back: the
+// vtable, then the table, then the objects the table refers to, as offsets
+// point forward
+class fb_table
+{
+public:
+    template<typename T>
+    fb_table& Scalar(int Slot, T Value)
+    {
+        field Field;
+        Field.Slot=Slot;
+        Field.Scalar.assign((const char*)&Value, sizeof(T));
+        Fields.push_back(std::move(Field));
+        return *this;
+    }
+
+    fb_table& Table(int Slot, const fb_table& Value)
+    {
+        Child(Slot, Object_Table).Tables.push_back(Value);
+        return *this;
+    }
+
+    fb_table& String(int Slot, const std::string& Value)
+    {
+        Child(Slot, Object_String).Bytes=Value;
+        return *this;
+    }
+
+    fb_table& Tables(int Slot, const std::vector<fb_table>& Values)
+    {
+        Child(Slot, Object_Tables).Tables=Values;
+        return *this;
+    }
+
+    // Vector of structs of Size bytes, aligned on Align bytes
+    fb_table& Structs(int Slot, const std::string& Values, size_t Size, size_t Align)
+    {
+        object& Object=Child(Slot, Object_Structs);
+        Object.Bytes=Values;
+        Object.Count=Values.size()/Size;
+        Object.Align=Align;
+        return *this;
+    }
+
+    // Buffer with this table as root
+    std::string Finish() const
+    {
+        std::string Out(4, '\0');
+        Patch(Out, 0, Write(Out));
+        return Out;
+    }
+
+private:
+    enum object_kind
+    {
+        Object_Table,
+        Object_String,
+        Object_Tables,
+        Object_Structs,
+    };
+
+    struct object
+    {
+        object_kind             Kind;
+        std::vector<fb_table>   Tables;
+        std::string             Bytes;
+        size_t                  Count=0;
+        size_t                  Align=4;
+    };
+
+    struct field
+    {
+        int                     Slot;
+        std::string             Scalar;                     // Empty for an offset to Object
+        std::shared_ptr<object> Object;
+
+        size_t Size() const {return Object?4:Scalar.size();}
+    };
+
+    object& Child(int Slot, object_kind Kind)
+    {
+        field Field;
+        Field.Slot=Slot;
+        Field.Object=std::make_shared<object>();
+        Field.Object->Kind=Kind;
+        Fields.push_back(std::move(Field));
+        return *Fields.back().Object;
+    }
+
+    static void Pad(std::string& Out, size_t Align)
+    {
+        Out.append((Align-Out.size()%Align)%Align, '\0');
+    }
+
+    // uoffset at At pointing to Target
+    static void Patch(std::string& Out, size_t At, size_t Target)
+    {
+        uint32_t Value=(uint32_t)(Target-At);
+        memcpy(&Out[At], &Value, 4);
+    }
+
+    size_t Write(std::string& Out) const
+    {
+        // Fields by decreasing size, after the soffset to the vtable, so they are aligned
+        std::vector<size_t> Order(Fields.size());
+        std::iota(Order.begin(), Order.end(), 0);
+        std::stable_sort(Order.begin(), Order.end(), [this](size_t A, size_t B) {return Fields[A].Size()>Fields[B].Size();});
+        int Slots=0;
+        for (const auto& Field : Fields)
+            Slots=std::max(Slots, Field.Slot+1);
+        std::vector<uint16_t> Offsets(Slots, 0);
+        size_t Table_Size=4;
+        size_t Align=4;
+        for (auto Pos : Order)
+        {
+            size_t Size=Fields[Pos].Size();
+            Table_Size=(Table_Size+Size-1)/Size*Size;
+            Offsets[Fields[Pos].Slot]=(uint16_t)Table_Size;
+            Table_Size+=Size;
+            Align=std::max(Align, Size);
+        }
+
+        // VTable
+        Pad(Out, 2);
+        size_t VTable=Out.size();
+        uint16_t VTable_Header[2]={(uint16_t)(4+2*Slots), (uint16_t)Table_Size};
+        Out.append((const char*)VTable_Header, sizeof(VTable_Header));
+        Out.append((const char*)Offsets.data(), 2*Slots);
+
+        // Table
+        Pad(Out, Align);
+        size_t Table=Out.size();
+        Out.append(Table_Size, '\0');
+        int32_t VTable_Offset=(int32_t)(Table-VTable);
+        memcpy(&Out[Table], &VTable_Offset, 4);
+        for (const auto& Field : Fields)
+            if (!Field.Object)
+                memcpy(&Out[Table+Offsets[Field.Slot]], Field.Scalar.data(), Field.Scalar.size());
+
+        // Objects
+        for (const auto& Field : Fields)
+            if (Field.Object)
+                Patch(Out, Table+Offsets[Field.Slot], WriteObject(*Field.Object, Out));
+
+        return Table;
+    }
+
+    static size_t WriteObject(const object& Object, std::string& Out)
+    {
+        if (Object.Kind==Object_Table)
+            return Object.Tables[0].Write(Out);
+
+        // Vectors and strings start with their count, elements are aligned
+        if (Object.Kind==Object_Structs)
+            while ((Out.size()+4)%std::max(Object.Align, (size_t)4))
+                Out.push_back('\0');
+        else
+            Pad(Out, 4);
+        size_t Pos=Out.size();
+        uint32_t Count=(uint32_t)(Object.Kind==Object_String?Object.Bytes.size():Object.Kind==Object_Tables?Object.Tables.size():Object.Count);
+        Out.append((const char*)&Count, 4);
+        switch (Object.Kind)
+        {
+            case Object_String  :   Out.append(Object.Bytes); Out.push_back('\0'); break;
+            case Object_Structs :   Out.append(Object.Bytes); break;
+            default             :
+                                    Out.append(4*Count, '\0');
+                                    for (size_t i=0; i<Count; i++)
+                                        Patch(Out, Pos+4+4*i, Object.Tables[i].Write(Out));
+        }
+        return Pos;
+    }
+
+    std::vector<field>          Fields;
+};
+
+//---------------------------------------------------------------------------
+fb_table Type_Int(int BitWidth)
+{
+    return fb_table().Scalar<int32_t>(0, BitWidth).Scalar<uint8_t>(1, 1);
+}
+
+//---------------------------------------------------------------------------
+// Body of a record batch, with its nodes and buffers as in RecordBatch of Message.fbs
+struct batch
+{
+    std::string                 Data;
+    std::string                 Nodes;                      // FieldNode structs
+    std::string                 Buffers;                    // Buffer structs
+    int64_t                     Length;
+
+    void Node(int64_t NullCount)
+    {
+        int64_t Node[2]={Length, NullCount};
+        Nodes.append((const char*)Node, sizeof(Node));
+    }
+
+    void Buffer(const void* Bytes, size_t Size)
+    {
+        int64_t Buffer_[2]={(int64_t)Data.size(), (int64_t)Size};
+        Buffers.append((const char*)Buffer_, sizeof(Buffer_));
+        Data.append((const char*)Bytes, Size);
+        Data.append((8-Data.size()%8)%8, '\0');
+    }
+
+    fb_table RecordBatch() const
+    {
+        return fb_table().Scalar<int64_t>(0, Length).Structs(1, Nodes, 16, 8).Structs(2, Buffers, 16, 8);
+    }
+};
+
+//---------------------------------------------------------------------------
+enum column_type
+{
+    Type_Int32,
+    Type_Int64,
+    Type_Float,
+    Type_Double,
+    Type_Bool,
+    Type_Utf8,
+    Type_Dictionary,
+};
+
+//---------------------------------------------------------------------------
+// Values from the frames of one stream, none for the columns not in the stream (nulls)
+struct column_source
+{
+    std::function<int64_t(size_t)>      Int;
+    std::function<double(size_t)>       Double;
+    std::function<const char*(size_t)>  Text;           // NULL is null
+
+    bool IsSet() const {return Int || Double || Text;}
+    int64_t Int_Get(size_t Pos) const {return Int?Int(Pos):(int64_t)Double(Pos);}
+    double Double_Get(size_t Pos) const {return Double?Double(Pos):(double)Int(Pos);}
+};
+
+//---------------------------------------------------------------------------
+struct column
+{
+    std::string                 Name;
+    column_type                 Type;
+    std::vector<column_source>  Sources;                    // By stream
+    bool                        IsNullable=false;
+
+    // Dictionaries
+    int64_t                     Dictionary_Id=-1;
+    std::map<std::string, int32_t> Ids;
+    std::vector<const std::string*> Values;                 // By id
+    int                         IndexBits=8;
+};
+
+//---------------------------------------------------------------------------
+class columns
+{
+public:
+    explicit columns(size_t Streams_) : Streams(Streams_) {}
+
+    // Numeric types are widened if the streams have different ones, values of incompatible types are nulls
+    void Add(size_t Stream, const std::string& Name, column_type Type, column_source Source)
+    {
+        auto Found=ByName.find(Name);
+        if (Found==ByName.end())
+        {
+            Found=ByName.emplace(Name, List.size()).first;
+            List.emplace_back();
+            List.back().Name=Name;
+            List.back().Type=Type;
+            List.back().Sources.resize(Streams);
+        }
+        column& Column=List[Found->second];
+        if (Column.Type!=Type)
+        {
+            bool IsText=Type==Type_Utf8 || Type==Type_Dictionary;
+            bool IsColumnText=Column.Type==Type_Utf8 || Column.Type==Type_Dictionary;
+            if (IsText || IsColumnText || Type==Type_Bool || Column.Type==Type_Bool)
+            {
+                qDebug() << "Arrow report: type of" << QString::fromStdString(Name) << "differs between streams, values of stream" << Stream << "skipped";
+                return;
+            }
+            bool IsInt=(Type==Type_Int32 || Type==Type_Int64) && (Column.Type==Type_Int32 || Column.Type==Type_Int64);
+            Column.Type=IsInt?Type_Int64:Type_Double;
+        }
+        Column.Sources[Stream]=std::move(Source);
+    }
+
+    std::vector<column>         List;
+
+private:
+    size_t                      Streams;
+    std::map<std::string, size_t> ByName;
+};
+
+//---------------------------------------------------------------------------
+const char* PictType_Text(char Value)
+{
+    static const char Chars[]="?IPBSipb";
+    static const char Texts[][2]={"?", "I", "P", "B", "S", "i", "p", "b"};
+    const char* Found=Value?strchr(Chars, Value):nullptr;
+    return Found?Texts[Found-Chars]:nullptr;
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+void Batch_Fixed(batch& Batch, size_t Begin, const std::function<T(size_t)>& Value)
+{
+    std::vector<T> Values(Batch.Length);
+    if (Value)
+        for (int64_t Pos=0; Pos<Batch.Length; Pos++)
+            Values[Pos]=Value(Begin+Pos);
+    Batch.Buffer(Values.data(), Values.size()*sizeof(T));
+}
+
+//---------------------------------------------------------------------------
+void Batch_Strings(batch& Batch, const std::vector<const std::string*>& Values)
+{
+    std::vector<int32_t> Offsets(1, 0);
+    std::string Data;
+    for (auto Value : Values)
+    {
+        if (Value)
+            Data+=*Value;
+        Offsets.push_back((int32_t)Data.size());
+    }
+    Batch.Buffer(Offsets.data(), Offsets.size()*sizeof(int32_t));
+    Batch.Buffer(Data.data(), Data.size());
+}
+
+//---------------------------------------------------------------------------
+// Values of the frames from Begin, Batch.Length frames
+void Batch_Column(batch& Batch, const column& Column, const column_source& Source, size_t Begin)
+{
+    // Validity
+    std::vector<uint8_t> Validity((Batch.Length+7)/8, 0);
+    int64_t NullCount=0;
+    for (int64_t Pos=0; Pos<Batch.Length; Pos++)
+    {
+        bool IsValid=Source.IsSet() && (!Source.Text || Source.Text(Begin+Pos));
+        if (IsValid)
+            Validity[Pos/8]|=1<<(Pos%8);
+        else
+            NullCount++;
+    }
+    Batch.Node(NullCount);
+    Batch.Buffer(Validity.data(), NullCount?Validity.size():0);
+
+    // Values
+    bool IsSet=Source.IsSet();
+    switch (Column.Type)
+    {
+        case Type_Int32     :   Batch_Fixed<int32_t>(Batch, Begin, IsSet?std::function<int32_t(size_t)>([&Source](size_t Pos) {return (int32_t)Source.Int_Get(Pos);}):nullptr); break;
+        case Type_Int64     :   Batch_Fixed<int64_t>(Batch, Begin, IsSet?std::function<int64_t(size_t)>([&Source](size_t Pos) {return Source.Int_Get(Pos);}):nullptr); break;
+        case Type_Float     :   Batch_Fixed<float>(Batch, Begin, IsSet?std::function<float(size_t)>([&Source](size_t Pos) {return (float)Source.Double_Get(Pos);}):nullptr); break;
+        case Type_Double    :   Batch_Fixed<double>(Batch, Begin, IsSet?std::function<double(size_t)>([&Source](size_t Pos) {return Source.Double_Get(Pos);}):nullptr); break;
+        case Type_Bool      :
+                                {
+                                std::vector<uint8_t> Bits((Batch.Length+7)/8, 0);
+                                if (IsSet)
+                                    for (int64_t Pos=0; Pos<Batch.Length; Pos++)
+                                        if (Source.Int_Get(Begin+Pos))
+                                            Bits[Pos/8]|=1<<(Pos%8);
+                                Batch.Buffer(Bits.data(), Bits.size());
+                                }
+                                break;
+        case Type_Utf8      :
+                                {
+                                std::vector<std::string> Texts(Batch.Length);
+                                std::vector<const std::string*> Values(Batch.Length, nullptr);
+                                if (Source.Text)
+                                    for (int64_t Pos=0; Pos<Batch.Length; Pos++)
+                                        if (const char* Text=Source.Text(Begin+Pos))
+                                        {
+                                            Texts[Pos]=Text;
+                                            Values[Pos]=&Texts[Pos];
+                                        }
+                                Batch_Strings(Batch, Values);
+                                }
+                                break;
+        case Type_Dictionary:
+                                {
+                                auto Index=[&](size_t Pos) -> int32_t {
+                                    const char* Text=Source.Text?Source.Text(Pos):nullptr;
+                                    return Text?Column.Ids.find(Text)->second:0;
+                                };
+                                switch (Column.IndexBits)
+                                {
+                                    case 8  :   Batch_Fixed<int8_t>(Batch, Begin, [&](size_t Pos) {return (int8_t)Index(Pos);}); break;
+                                    case 16 :   Batch_Fixed<int16_t>(Batch, Begin, [&](size_t Pos) {return (int16_t)Index(Pos);}); break;
+                                    default :   Batch_Fixed<int32_t>(Batch, Begin, Index);
+                                }
+                                }
+                                break;
+    }
+}
+
+//---------------------------------------------------------------------------
+fb_table Schema_Field(const column& Column)
+{
+    fb_table Field;
+    Field.String(0, Column.Name);
+    Field.Scalar<uint8_t>(1, Column.IsNullable?1:0);
+    switch (Column.Type)
+    {
+        case Type_Int32     :   Field.Scalar<uint8_t>(2, ArrowType_Int).Table(3, Type_Int(32)); break;
+        case Type_Int64     :   Field.Scalar<uint8_t>(2, ArrowType_Int).Table(3, Type_Int(64)); break;
+        case Type_Float     :   Field.Scalar<uint8_t>(2, ArrowType_FloatingPoint).Table(3, fb_table().Scalar<int16_t>(0, 1)); break;
+        case Type_Double    :   Field.Scalar<uint8_t>(2, ArrowType_FloatingPoint).Table(3, fb_table().Scalar<int16_t>(0, 2)); break;
+        case Type_Bool      :   Field.Scalar<uint8_t>(2, ArrowType_Bool).Table(3, fb_table()); break;
+        case Type_Utf8      :   Field.Scalar<uint8_t>(2, ArrowType_Utf8).Table(3, fb_table()); break;
+        case Type_Dictionary:   Field.Scalar<uint8_t>(2, ArrowType_Utf8).Table(3, fb_table());
+                                Field.Table(4, fb_table().Scalar<int64_t>(0, Column.Dictionary_Id).Table(1, Type_Int(Column.IndexBits)).Scalar<uint8_t>(2, 0));
+                                break;
+    }
+    Field.Tables(5, {});
+    return Field;
+}
+
+//---------------------------------------------------------------------------
+fb_table KeyValue(const std::string& Key, const std::string& Value)
+{
+    return fb_table().String(0, Key).String(1, Value);
+}
+}
+
+//***************************************************************************
+// File name
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsArrowReport::IsArrowReport(const QString& FileName)
+{
+    return FileName.endsWith(".arrow", Qt::CaseInsensitive) || FileName.endsWith(".feather", Qt::CaseInsensitive);
+}
+
+//***************************************************************************
+// Settings
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsArrowReport::BatchFrames_Set(size_t Frames)
+{
+    BatchFrames=Frames?Frames:1;
+}
+
+//---------------------------------------------------------------------------
+size_t StatsArrowReport::BatchFrames_Get()
+{
+    return BatchFrames;
+}
+
+//***************************************************************************
+// Save
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsArrowReport::Save(QIODevice& Output, const std::vector<CommonStats*>& Stats_, const activefilters& Filters, const std::string& Trailer)
+{
+    // Values are written as they are in memory
+    if (QSysInfo::ByteOrder!=QSysInfo::LittleEndian)
+        return false;
+
+    std::vector<CommonStats*> Stats;
+    for (auto Stat : Stats_)
+        if (Stat)
+            Stats.push_back(Stat);
+
+    // Columns, the union of the ones of the streams
+    columns Columns(Stats.size());
+    std::vector<size_t> FramesCounts;
+    for (size_t Stream=0; Stream<Stats.size(); Stream++)
+    {
+        CommonStats* Stat=Stats[Stream];
+        CommonStats& S=*Stat;
+        S.Items_Load();
+        QMutexLocker Lock(&S.Mutex);
+
+        FramesCounts.push_back(S.x_Current);
+        auto Video=dynamic_cast<VideoStats*>(Stat);
+        int Width=Video?Video->getWidth():0;
+        int Height=Video?Video->getHeight():0;
+        int StreamIndex=S.streamIndex;
+        const char* MediaType=Video?"video":"audio";
+
+        // Frame information
+        Columns.Add(Stream, "stream_index", Type_Int32, {[StreamIndex](size_t) {return (int64_t)StreamIndex;}, nullptr, nullptr});
+        Columns.Add(Stream, "media_type", Type_Dictionary, {nullptr, nullptr, [MediaType](size_t) {return MediaType;}});
+        Columns.Add(Stream, "frame", Type_Int64, {[Stat](size_t Pos) {return (int64_t)Stat->x[0][Pos];}, nullptr, nullptr});
+        Columns.Add(Stream, "pkt_pts_time", Type_Double, {nullptr, [Stat](size_t Pos) {return Stat->x[1][Pos]+Stat->FirstTimeStamp;}, nullptr});
+        Columns.Add(Stream, "pkt_duration_time", Type_Double, {nullptr, [Stat](size_t Pos) {return (double)Stat->durations[Pos];}, nullptr});
+        Columns.Add(Stream, "pkt_pts", Type_Int64, {[Stat](size_t Pos) {return (int64_t)Stat->pkt_pts[Pos];}, nullptr, nullptr});
+        Columns.Add(Stream, "pkt_pos", Type_Int64, {[Stat](size_t Pos) {return (int64_t)Stat->pkt_pos[Pos];}, nullptr, nullptr});
+        Columns.Add(Stream, "pkt_size", Type_Int32, {[Stat](size_t Pos) {return (int64_t)Stat->pkt_size[Pos];}, nullptr, nullptr});
+        Columns.Add(Stream, "key_frame", Type_Bool, {[Stat](size_t Pos) {return (int64_t)(Stat->key_frames[Pos]?1:0);}, nullptr, nullptr});
+        if (Video)
+        {
+            Columns.Add(Stream, "pict_type", Type_Dictionary, {nullptr, nullptr, [Stat](size_t Pos) {return PictType_Text(Stat->pict_type_char[Pos]);}});
+            Columns.Add(Stream, "pix_fmt", Type_Dictionary, {nullptr, nullptr, [Stat](size_t Pos) {return av_get_pix_fmt_name((AVPixelFormat)Stat->pix_fmt[Pos]);}});
+        }
+
+        // Items, as in the XML report
+        for (size_t Plot_Pos=0; Plot_Pos<S.CountOfItems; Plot_Pos++)
+        {
+            const activefilter filter=S.PerItem[Plot_Pos].Filter;
+            if (filter==activefilter(-1) || !Filters.test(filter) || !S.Item_IsUsed(Plot_Pos))
+                continue;
+
+            const StatsValueColumn* Values=&S.y[Plot_Pos];
+            bool IsCropWidth=Video && (Plot_Pos==Item_Crop_x2 || Plot_Pos==Item_Crop_w);
+            bool IsCropHeight=Video && (Plot_Pos==Item_Crop_y2 || Plot_Pos==Item_Crop_h);
+            if (IsCropWidth || IsCropHeight)
+            {
+                // Special case, values are from width or height
+                int Size=IsCropWidth?Width:Height;
+                Columns.Add(Stream, S.PerItem[Plot_Pos].FFmpeg_Name, Type_Double, {nullptr, [Values, Size](size_t Pos) {return Size-(*Values)[Pos];}, nullptr});
+            }
+            else
+                Columns.Add(Stream, S.PerItem[Plot_Pos].FFmpeg_Name, Values->GetStorage()==StatsValueColumn::Storage_Float?Type_Float:Type_Double, {nullptr, [Values](size_t Pos) {return (double)(*Values)[Pos];}, nullptr});
+        }
+
+        // Additional stats
+        for (const auto& Key : S.statsKeysByIndexByValueType[CommonStats::StatsValueInfo::Int])
+            if ((size_t)Key.first<S.additionalIntStats.size())
+            {
+                const StatsColumn<int>* Values=&S.additionalIntStats[Key.first];
+                Columns.Add(Stream, Key.second, Type_Int32, {[Values](size_t Pos) {return (int64_t)(*Values)[Pos];}, nullptr, nullptr});
+            }
+        for (const auto& Key : S.statsKeysByIndexByValueType[CommonStats::StatsValueInfo::Double])
+            if ((size_t)Key.first<S.additionalDoubleStats.size())
+            {
+                const StatsColumn<double>* Values=&S.additionalDoubleStats[Key.first];
+                Columns.Add(Stream, Key.second, Type_Double, {nullptr, [Values](size_t Pos) {return (*Values)[Pos];}, nullptr});
+            }
+        for (const auto& Key : S.statsKeysByIndexByValueType[CommonStats::StatsValueInfo::String])
+            if ((size_t)Key.first<S.additionalStringStats.size())
+            {
+                const StatsColumn<const char*>* Values=&S.additionalStringStats[Key.first];
+                Columns.Add(Stream, Key.second, Type_Utf8, {nullptr, nullptr, [Values](size_t Pos) {return (*Values)[Pos];}});
+            }
+
+        // Comments
+        Columns.Add(Stream, "comment", Type_Dictionary, {nullptr, nullptr, [Stat](size_t Pos) {return Stat->comments[Pos];}});
+    }
+
+    // Dictionaries, from all the frames, so the index width is known by the schema
+    int64_t Dictionary_Id=0;
+    for (auto& Column : Columns.List)
+    {
+        for (size_t Stream=0; Stream<Stats.size(); Stream++)
+        {
+            const column_source& Source=Column.Sources[Stream];
+            if (!Source.IsSet())
+            {
+                if (FramesCounts[Stream])
+                    Column.IsNullable=true;
+                continue;
+            }
+            if (!Source.Text)
+                continue;
+            QMutexLocker Lock(&Stats[Stream]->Mutex);
+            for (size_t Pos=0; Pos<FramesCounts[Stream]; Pos++)
+            {
+                const char* Text=Source.Text(Pos);
+                if (!Text)
+                {
+                    Column.IsNullable=true;
+                    continue;
+                }
+                if (Column.Type!=Type_Dictionary)
+                    continue;
+                auto Inserted=Column.Ids.emplace(Text, (int32_t)Column.Values.size());
+                if (Inserted.second)
+                    Column.Values.push_back(&Inserted.first->first);
+            }
+        }
+        if (Column.Type==Type_Dictionary)
+        {
+            Column.Dictionary_Id=Dictionary_Id++;
+            Column.IndexBits=Column.Values.size()<=0x80?8:Column.Values.size()<=0x8000?16:32;
+        }
+    }
+
+    // Schema
+    std::vector<fb_table> Fields;
+    for (const auto& Column : Columns.List)
+        Fields.push_back(Schema_Field(Column));
+    std::vector<fb_table> KeyValues;
+    KeyValues.push_back(KeyValue("qctools.creator", std::string("QCTools ")+Version));
+    KeyValues.push_back(KeyValue("qctools.ffmpeg_version", FFmpeg_Version()));
+    KeyValues.push_back(KeyValue("qctools.streams_and_format", Trailer));
+    fb_table Schema=fb_table().Scalar<int16_t>(0, 0).Tables(1, Fields).Tables(2, KeyValues);
+
+    // Messages, as in the Arrow IPC file format: continuation, size of the metadata, metadata padded to 8 bytes, body
+    bool IsOk=true;
+    int64_t Offset=0;
+    auto Write=[&](const void* Data, size_t Size) {
+        if (IsOk && Size && Output.write((const char*)Data, Size)!=(qint64)Size)
+            IsOk=false;
+        Offset+=Size;
+    };
+    auto Message=[&](arrow_header Type, const fb_table& Header, const std::string& Body, std::string* Blocks) {
+        std::string Metadata=fb_table().Scalar<int16_t>(0, Arrow_MetadataVersion).Scalar<uint8_t>(1, Type).Table(2, Header).Scalar<int64_t>(3, Body.size()).Finish();
+        Metadata.append((8-Metadata.size()%8)%8, '\0');
+        if (Blocks)
+        {
+            // Block struct of File.fbs
+            int64_t Block_Offset=Offset;
+            int32_t Block_MetaDataLength[2]={(int32_t)(8+Metadata.size()), 0};
+            int64_t Block_BodyLength=Body.size();
+            Blocks->append((const char*)&Block_Offset, 8);
+            Blocks->append((const char*)Block_MetaDataLength, 8);
+            Blocks->append((const char*)&Block_BodyLength, 8);
+        }
+        int32_t Metadata_Size=(int32_t)Metadata.size();
+        Write(&Arrow_Continuation, 4);
+        Write(&Metadata_Size, 4);
+        Write(Metadata.data(), Metadata.size());
+        Write(Body.data(), Body.size());
+    };
+
+    Write(Arrow_Magic, sizeof(Arrow_Magic));
+    Message(Header_Schema, Schema, std::string(), nullptr);
+
+    // Dictionaries
+    std::string Dictionaries;
+    for (const auto& Column : Columns.List)
+    {
+        if (Column.Type!=Type_Dictionary)
+            continue;
+        batch Batch;
+        Batch.Length=Column.Values.size();
+        Batch.Node(0);
+        Batch.Buffer(nullptr, 0);
+        Batch_Strings(Batch, Column.Values);
+        Message(Header_DictionaryBatch, fb_table().Scalar<int64_t>(0, Column.Dictionary_Id).Table(1, Batch.RecordBatch()), Batch.Data, &Dictionaries);
+    }
+
+    // Record batches, stream after stream
+    std::string RecordBatches;
+    size_t Batch_Frames=BatchFrames_Get();
+    for (size_t Stream=0; Stream<Stats.size() && IsOk; Stream++)
+    {
+        QMutexLocker Lock(&Stats[Stream]->Mutex);
+        for (size_t Begin=0; Begin<FramesCounts[Stream] && IsOk; Begin+=Batch_Frames)
+        {
+            batch Batch;
+            Batch.Length=std::min(Batch_Frames, FramesCounts[Stream]-Begin);
+            for (const auto& Column : Columns.List)
+                Batch_Column(Batch, Column, Column.Sources[Stream], Begin);
+            Message(Header_RecordBatch, Batch.RecordBatch(), Batch.Data, &RecordBatches);
+        }
+    }
+
+    // End of stream, then footer
+    static const uint32_t EndOfStream[2]={Arrow_Continuation, 0};
+    Write(EndOfStream, sizeof(EndOfStream));
+    std::string Footer=fb_table().Scalar<int16_t>(0, Arrow_MetadataVersion).Table(1, Schema).Structs(2, Dictionaries, 24, 8).Structs(3, RecordBatches, 24, 8).Finish();
+    int32_t Footer_Size=(int32_t)Footer.size();
+    Write(Footer.data(), Footer.size());
+    Write(&Footer_Size, 4);
+    Write(Arrow_Magic, 6);
+
+    return IsOk;
+}
@@ -0,0 +1,52 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsArrowReport_H
+#define StatsArrowReport_H
+
+#include "Core/Core.h"
+
+#include <QString>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class QIODevice;
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Table of the values of all the frames in the Arrow IPC file format (.arrow,
+// also known as Feather V2), read directly by pyarrow, polars, DuckDB or
+// Spark and written to Parquet by them, for the analytics of many reports.
+//
+// One row per frame, the frames of each stream after the ones of the
+// previous stream, in record batches of BatchFrames frames at most:
+// - stream_index (int32), media_type (dictionary: video, audio), frame
+//   (int64, number of the frame in the stream as x[0])
+// - pkt_pts_time, pkt_duration_time (double), pkt_pts, pkt_pos (int64),
+//   pkt_size (int32), key_frame (bool), pict_type and pix_fmt (dictionaries,
+//   video)
+// - one column per exported item (FFmpeg_Name, float or double as stored,
+//   value as in the XML report) and per additional stat (int32, double or
+//   utf8), null in the rows of other streams
+// - comment (dictionary, HTML escaped as in the XML report), null if none
+// The schema metadata has "qctools.creator", "qctools.ffmpeg_version" and
+// "qctools.streams_and_format" (the XML part after </frames> in the XML
+// report). Values are little endian as in memory, not compressed.
+class StatsArrowReport
+{
+public:
+    static bool                 IsArrowReport               (const QString& FileName);
+
+    static bool                 Save                        (QIODevice& Output, const std::vector<CommonStats*>& Stats, const activefilters& Filters, const std::string& Trailer);
+
+    // Rows of a record batch, for the reports written afterwards
+    static void                 BatchFrames_Set             (size_t Frames);
+    static size_t               BatchFrames_Get             ();
+};
+
+#endif // StatsArrowReport_H
@@ -0,0 +1,335 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsColdChunks.h"
+
+#include <algorithm>
+#include <cstring>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+// Integers are packed by blocks of this count of values
+const size_t Block_Size=128;
+
+//---------------------------------------------------------------------------
+// Most significant bits first
+class bit_writer
+{
+public:
+    explicit bit_writer(std::vector<uint8_t>& Output_) : Output(Output_) {}
+
+    void Put(uint64_t Value, unsigned Bits)
+    {
+        if (Bits>32)
+        {
+            Put(Value>>32, Bits-32);
+            Value&=0xFFFFFFFF;
+            Bits=32;
+        }
+        if (!Bits)
+            return;
+        Accumulator=(Accumulator<<Bits)|(Value&((((uint64_t)1)<<Bits)-1));
+        Count+=Bits;
+        while (Count>=8)
+        {
+            Count-=8;
+            Output.push_back((uint8_t)(Accumulator>>Count));
+        }
+    }
+
+    void Flush()
+    {
+        if (Count)
+            Output.push_back((uint8_t)(Accumulator<<(8-Count)));
+        Count=0;
+    }
+
+private:
+    std::vector<uint8_t>&       Output;
+    uint64_t                    Accumulator=0;
+    unsigned                    Count=0;
+};
+
+//---------------------------------------------------------------------------
+class bit_reader
+{
+public:
+    explicit bit_reader(const std::vector<uint8_t>& Input_) : Input(Input_) {}
+
+    uint64_t Get(unsigned Bits)
+    {
+        uint64_t Value=0;
+        while (Bits)
+        {
+            size_t Byte=Pos>>3;
+            unsigned Available=8-(unsigned)(Pos&7);
+            unsigned Taken=std::min(Available, Bits);
+            unsigned Data=Byte<Input.size()?Input[Byte]:0;
+            Value=(Value<<Taken)|((Data>>(Available-Taken))&((1u<<Taken)-1));
+            Pos+=Taken;
+            Bits-=Taken;
+        }
+        return Value;
+    }
+
+private:
+    const std::vector<uint8_t>& Input;
+    size_t                      Pos=0;                      // In bits
+};
+
+//---------------------------------------------------------------------------
+unsigned Leading(uint64_t Value, unsigned Width)
+{
+    unsigned Count=0;
+    for (uint64_t Mask=((uint64_t)1)<<(Width-1); Mask && !(Value&Mask); Mask>>=1)
+        Count++;
+    return Count;
+}
+
+unsigned Trailing(uint64_t Value, unsigned Width)
+{
+    unsigned Count=0;
+    while (Count<Width && !(Value&1))
+    {
+        Value>>=1;
+        Count++;
+    }
+    return Count;
+}
+
+//---------------------------------------------------------------------------
+// Gorilla: first value raw, then 0 for the same value, 10 and the meaningful bits in the window of the previous
+// value, 11 and the count of leading zeros, the count of meaningful bits minus one and the meaningful bits
+void Xor_Encode(bit_writer& Writer, const uint64_t* Values, size_t Count, unsigned Width)
+{
+    const unsigned Bits_Leading=Width==64?6:5;
+    const unsigned Bits_Length=Width==64?6:5;
+    uint64_t Previous=Values[0];
+    Writer.Put(Previous, Width);
+    bool HasWindow=false;
+    unsigned Window_Leading=0, Window_Trailing=0;
+    for (size_t Pos=1; Pos<Count; Pos++)
+    {
+        uint64_t Xor=Values[Pos]^Previous;
+        Previous=Values[Pos];
+        if (!Xor)
+        {
+            Writer.Put(0, 1);
+            continue;
+        }
+
+        unsigned Lead=Leading(Xor, Width);
+        unsigned Trail=Trailing(Xor, Width);
+        if (HasWindow && Lead>=Window_Leading && Trail>=Window_Trailing)
+        {
+            Writer.Put(2, 2);
+            Writer.Put(Xor>>Window_Trailing, Width-Window_Leading-Window_Trailing);
+            continue;
+        }
+
+        unsigned Length=Width-Lead-Trail;
+        Writer.Put(3, 2);
+        Writer.Put(Lead, Bits_Leading);
+        Writer.Put(Length-1, Bits_Length);
+        Writer.Put(Xor>>Trail, Length);
+        HasWindow=true;
+        Window_Leading=Lead;
+        Window_Trailing=Trail;
+    }
+}
+
+void Xor_Decode(bit_reader& Reader, uint64_t* Values, size_t Count, unsigned Width)
+{
+    const unsigned Bits_Leading=Width==64?6:5;
+    const unsigned Bits_Length=Width==64?6:5;
+    uint64_t Previous=Reader.Get(Width);
+    Values[0]=Previous;
+    unsigned Window_Leading=0, Window_Trailing=0;
+    for (size_t Pos=1; Pos<Count; Pos++)
+    {
+        if (Reader.Get(1))
+        {
+            if (Reader.Get(1))
+            {
+                Window_Leading=(unsigned)Reader.Get(Bits_Leading);
+                Window_Trailing=Width-Window_Leading-((unsigned)Reader.Get(Bits_Length)+1);
+            }
+            Previous^=Reader.Get(Width-Window_Leading-Window_Trailing)<<Window_Trailing;
+        }
+        Values[Pos]=Previous;
+    }
+}
+
+//---------------------------------------------------------------------------
+// Zigzag of the difference with the previous value, bit width (6 bits) then the values of each block
+void Delta_Encode(bit_writer& Writer, const uint64_t* Values, size_t Count)
+{
+    uint32_t Previous=0;
+    uint32_t Codes[Block_Size];
+    for (size_t Begin=0; Begin<Count; Begin+=Block_Size)
+    {
+        size_t Size=std::min(Block_Size, Count-Begin);
+        uint32_t Max=0;
+        for (size_t Pos=0; Pos<Size; Pos++)
+        {
+            int32_t Delta=(int32_t)((uint32_t)Values[Begin+Pos]-Previous);
+            Previous=(uint32_t)Values[Begin+Pos];
+            Codes[Pos]=((uint32_t)Delta<<1)^(uint32_t)(Delta>>31);
+            Max|=Codes[Pos];
+        }
+        unsigned Width=32-Leading(Max, 32);
+        Writer.Put(Width, 6);
+        for (size_t Pos=0; Pos<Size; Pos++)
+            Writer.Put(Codes[Pos], Width);
+    }
+}
+
+void Delta_Decode(bit_reader& Reader, uint64_t* Values, size_t Count)
+{
+    uint32_t Previous=0;
+    for (size_t Begin=0; Begin<Count; Begin+=Block_Size)
+    {
+        size_t Size=std::min(Block_Size, Count-Begin);
+        unsigned Width=(unsigned)Reader.Get(6);
+        for (size_t Pos=0; Pos<Size; Pos++)
+        {
+            uint32_t Code=(uint32_t)Reader.Get(Width);
+            Previous+=(Code>>1)^(0u-(Code&1));
+            Values[Begin+Pos]=Previous;
+        }
+    }
+}
+
+}
+
+//***************************************************************************
+// Constructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsColdChunks::StatsColdChunks(kind Kind_, size_t ChunkSize_)
+    : Kind(Kind_)
+    , ChunkSize(ChunkSize_)
+{
+}
+
+//***************************************************************************
+// Chunks
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsColdChunks::Add(size_t Index, const void* Values)
+{
+    std::vector<uint64_t> Raw(ChunkSize);
+    for (size_t Pos=0; Pos<ChunkSize; Pos++)
+        switch (Kind)
+        {
+            case Kind_Float64   : memcpy(&Raw[Pos], (const char*)Values+Pos*8, 8); break;
+            default             : {
+                                    uint32_t Value;
+                                    memcpy(&Value, (const char*)Values+Pos*4, 4);
+                                    Raw[Pos]=Value;
+                                  }
+        }
+
+    if (Chunks.size()<=Index)
+        Chunks.resize(Index+1);
+    std::vector<uint8_t>& Output=Chunks[Index];
+    Output.clear();
+    bit_writer Writer(Output);
+    switch (Kind)
+    {
+        case Kind_Float64   : Xor_Encode(Writer, Raw.data(), ChunkSize, 64); break;
+        case Kind_Float32   : Xor_Encode(Writer, Raw.data(), ChunkSize, 32); break;
+        case Kind_Int32     : Delta_Encode(Writer, Raw.data(), ChunkSize); break;
+    }
+    Writer.Flush();
+    Output.shrink_to_fit();
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Decoded.remove_if([&](const std::pair<size_t, std::vector<uint8_t>>& Item) {return Item.first==Index;});
+}
+
+//---------------------------------------------------------------------------
+void StatsColdChunks::Remove(size_t Index)
+{
+    if (Index<Chunks.size())
+        std::vector<uint8_t>().swap(Chunks[Index]);
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Decoded.remove_if([&](const std::pair<size_t, std::vector<uint8_t>>& Item) {return Item.first==Index;});
+}
+
+//---------------------------------------------------------------------------
+void StatsColdChunks::Decode(size_t Index, void* Values) const
+{
+    std::vector<uint64_t> Raw(ChunkSize);
+    bit_reader Reader(Chunks[Index]);
+    switch (Kind)
+    {
+        case Kind_Float64   : Xor_Decode(Reader, Raw.data(), ChunkSize, 64); break;
+        case Kind_Float32   : Xor_Decode(Reader, Raw.data(), ChunkSize, 32); break;
+        case Kind_Int32     : Delta_Decode(Reader, Raw.data(), ChunkSize); break;
+    }
+
+    for (size_t Pos=0; Pos<ChunkSize; Pos++)
+        switch (Kind)
+        {
+            case Kind_Float64   : memcpy((char*)Values+Pos*8, &Raw[Pos], 8); break;
+            default             : {
+                                    uint32_t Value=(uint32_t)Raw[Pos];
+                                    memcpy((char*)Values+Pos*4, &Value, 4);
+                                  }
+        }
+}
+
+//---------------------------------------------------------------------------
+uint64_t StatsColdChunks::Bits(size_t Index, size_t Offset) const
+{
+    size_t Size=Kind==Kind_Float64?8:4;
+    uint64_t Value;
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto Item=Decoded.begin();
+    while (Item!=Decoded.end() && Item->first!=Index)
+        ++Item;
+    if (Item==Decoded.end())
+    {
+        std::vector<uint8_t> Values(ChunkSize*Size);
+        Decode(Index, Values.data());
+        Decoded.emplace_front(Index, std::move(Values));
+        if (Decoded.size()>Decoded_Max)
+            Decoded.pop_back();
+    }
+    else if (Item!=Decoded.begin())
+        Decoded.splice(Decoded.begin(), Decoded, Item);
+    const uint8_t* Data=Decoded.front().second.data()+Offset*Size;
+    if (Size==8)
+        memcpy(&Value, Data, 8);
+    else
+    {
+        uint32_t Value32;
+        memcpy(&Value32, Data, 4);
+        Value=Value32;
+    }
+    return Value;
+}
+
+//---------------------------------------------------------------------------
+size_t StatsColdChunks::Bytes() const
+{
+    size_t Result=0;
+    for (const auto& Chunk : Chunks)
+        Result+=Chunk.capacity();
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (const auto& Item : Decoded)
+        Result+=Item.second.size();
+    return Result;
+}
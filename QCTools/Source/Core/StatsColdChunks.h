@@ -0,0 +1,61 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsColdChunks_H
+#define StatsColdChunks_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Chunks of a column of values kept compressed, lossless, for the files not
+// displayed (see StatsValueColumn::Compress).
+//
+// Float values are XOR encoded as Gorilla does (same value in 1 bit, else
+// the bits changed from the previous value in its window of meaningful bits),
+// integer values are delta and zigzag encoded then bit packed by blocks of
+// 128 values. Reads decode the whole chunk, the last decoded chunks are kept
+// for the next reads which are mostly in the same chunks (plots, exports).
+class StatsColdChunks
+{
+public:
+    enum kind
+    {
+        Kind_Float64,
+        Kind_Float32,
+        Kind_Int32,
+    };
+
+                                StatsColdChunks             (kind Kind, size_t ChunkSize);
+
+    // By the only thread using the column: Values of the chunk Index (ChunkSize values of the kind) compressed, or forgotten
+    void                        Add                         (size_t Index, const void* Values);
+    void                        Remove                      (size_t Index);
+
+    bool                        Has                         (size_t Index) const {return Index<Chunks.size() && !Chunks[Index].empty();}
+
+    // Decoded values of the chunk, ChunkSize values of the kind
+    void                        Decode                      (size_t Index, void* Values) const;
+    // Bits of a value of the chunk (the 32 lower bits for the 32-bit kinds), from the decoded chunks kept
+    uint64_t                    Bits                        (size_t Index, size_t Offset) const;
+
+    size_t                      Bytes                       () const;
+
+private:
+    static const size_t         Decoded_Max=2;
+
+    kind                        Kind;
+    size_t                      ChunkSize;
+    std::vector<std::vector<uint8_t>> Chunks;               // Empty if not compressed
+    mutable std::mutex          Mutex;
+    mutable std::list<std::pair<size_t, std::vector<uint8_t>>> Decoded; // Most recent first
+};
+
+#endif // StatsColdChunks_H
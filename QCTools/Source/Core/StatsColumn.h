@@ -0,0 +1,548 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsColumn_H
+#define StatsColumn_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "Core/StatsColdChunks.h"
+
+//---------------------------------------------------------------------------
+// Per-frame column of stats values, stored as fixed-size chunks.
+//
+// Growing only allocates the missing chunks: existing values are never moved,
+// so references stay valid and readers (plots, exports) never wait for the
+// parser thread. One writer (the thread calling Reserve()) is supported,
+// concurrently with any count of readers of already reserved positions.
+// New values are zero-initialized.
+template<typename T>
+class StatsColumn
+{
+public:
+    static const size_t         Chunk_Shift=12;
+    static const size_t         Chunk_Size=(size_t)1<<Chunk_Shift;
+    static const size_t         Chunk_Mask=Chunk_Size-1;
+
+    // Constructor / Destructor
+                                StatsColumn                 () : Chunks(nullptr), Chunks_Count(0), Chunks_Capacity(0), Chunks_Mapped(0), Chunks_Discarded(0), Chunks_Freed(0) {}
+                                StatsColumn                 (const StatsColumn&) = delete;
+    StatsColumn&                operator=                   (const StatsColumn&) = delete;
+                                ~StatsColumn                ()
+    {
+        T** Directory=Chunks.load(std::memory_order_relaxed);
+        for (size_t Pos=Chunks_Mapped; Pos<Chunks_Count; Pos++)
+            delete[] Directory[Pos];
+        delete[] Directory;
+        for (auto Retired_Directory : Retired)
+            delete[] Retired_Directory;
+    }
+
+    // Access
+    T&                          operator[]                  (size_t Pos)       {return Chunks.load(std::memory_order_acquire)[Pos>>Chunk_Shift][Pos&Chunk_Mask];}
+    const T&                    operator[]                  (size_t Pos) const {return Chunks.load(std::memory_order_acquire)[Pos>>Chunk_Shift][Pos&Chunk_Mask];}
+    size_t                      Reserved                    () const {return Chunks_Count<<Chunk_Shift;}
+    const T*                    Chunk                       (size_t Index) const {return Chunks.load(std::memory_order_acquire)[Index];}
+    size_t                      Bytes                       () const {return ((Chunks_Count-std::max(Chunks_Mapped, Chunks_Discarded)-Chunks_Freed)<<Chunk_Shift)*sizeof(T);} // Allocated chunks, not the external memory
+
+    // Memory management, O(1) per chunk, no copy of the existing values
+    void                        Reserve                     (size_t Size)
+    {
+        size_t Chunks_Needed=(Size+Chunk_Mask)>>Chunk_Shift;
+        if (Chunks_Needed<=Chunks_Count)
+            return;
+
+        T** Directory=Chunks.load(std::memory_order_relaxed);
+        if (Chunks_Needed>Chunks_Capacity)
+        {
+            // Only the directory (one pointer per chunk) is copied, the old one is kept alive for readers still using it
+            size_t Capacity=Chunks_Capacity?Chunks_Capacity:16;
+            while (Capacity<Chunks_Needed)
+                Capacity<<=1;
+            T** Directory_New=new T*[Capacity];
+            for (size_t Pos=0; Pos<Chunks_Count; Pos++)
+                Directory_New[Pos]=Directory[Pos];
+            if (Directory)
+                Retired.push_back(Directory);
+            Directory=Directory_New;
+            Chunks_Capacity=Capacity;
+        }
+
+        for (; Chunks_Count<Chunks_Needed; Chunks_Count++)
+            Directory[Chunks_Count]=new T[Chunk_Size]();
+        Chunks.store(Directory, std::memory_order_release);
+    }
+
+    // Frees the chunks entirely before Before (e.g. live analysis), by the writer thread
+    // Readers must not use these positions anymore
+    void                        Discard                     (size_t Before)
+    {
+        T** Directory=Chunks.load(std::memory_order_relaxed);
+        size_t Chunks_Before=std::min(Before>>Chunk_Shift, Chunks_Count);
+        for (size_t Pos=std::max(Chunks_Mapped, Chunks_Discarded); Pos<Chunks_Before; Pos++)
+        {
+            if (!Directory[Pos])
+                Chunks_Freed--;
+            delete[] Directory[Pos];
+            Directory[Pos]=nullptr;
+        }
+        Chunks_Discarded=std::max(Chunks_Discarded, Chunks_Before);
+    }
+
+    // Frees one allocated chunk (its values are kept elsewhere, e.g. compressed), by the writer thread
+    // Readers must not use this chunk until Restore()
+    bool                        Owned                       (size_t Index) const {return Index>=std::max(Chunks_Mapped, Chunks_Discarded) && Index<Chunks_Count && Chunks.load(std::memory_order_relaxed)[Index];}
+    void                        Free                        (size_t Index)
+    {
+        if (!Owned(Index))
+            return;
+        T** Directory=Chunks.load(std::memory_order_relaxed);
+        delete[] Directory[Index];
+        Directory[Index]=nullptr;
+        Chunks_Freed++;
+    }
+    // Chunk freed by Free() allocated again, zero-initialized
+    T*                          Restore                     (size_t Index)
+    {
+        T** Directory=Chunks.load(std::memory_order_relaxed);
+        if (!Directory[Index])
+        {
+            Directory[Index]=new T[Chunk_Size]();
+            Chunks_Freed--;
+        }
+        return Directory[Index];
+    }
+
+    // Use external memory (e.g. a memory mapped file) instead of allocated chunks, Count must be a multiple of Chunk_Size
+    // The column must not be in use by readers yet, and Data must outlive the column
+    void                        Map                         (T* Data, size_t Count)
+    {
+        T** Directory=Chunks.load(std::memory_order_relaxed);
+        for (size_t Pos=Chunks_Mapped; Pos<Chunks_Count; Pos++)
+            delete[] Directory[Pos];
+        Chunks_Count=0;
+        Chunks_Discarded=0;
+        Chunks_Freed=0;
+
+        Chunks_Mapped=Count>>Chunk_Shift;
+        if (Chunks_Mapped>Chunks_Capacity)
+        {
+            delete[] Directory;
+            Chunks_Capacity=Chunks_Mapped;
+            Directory=new T*[Chunks_Capacity];
+        }
+        for (; Chunks_Count<Chunks_Mapped; Chunks_Count++)
+            Directory[Chunks_Count]=Data+(Chunks_Count<<Chunk_Shift);
+        Chunks.store(Directory, std::memory_order_release);
+    }
+
+private:
+    std::atomic<T**>            Chunks;
+    size_t                      Chunks_Count;
+    size_t                      Chunks_Capacity;
+    size_t                      Chunks_Mapped;              // First chunks are external memory, not owned
+    size_t                      Chunks_Discarded;           // First chunks are freed
+    size_t                      Chunks_Freed;               // Other chunks freed by Free()
+    std::vector<T**>            Retired;
+};
+
+//---------------------------------------------------------------------------
+// Column of plotted values (CommonStats::y), stored as double by default or,
+// in compact mode, as float32 or int32 depending on the precision the item
+// needs. Values are widened to double on read.
+//
+// Full chunks of a column no more written may be compressed (Compress()),
+// lossless, reads of these chunks decode them (see StatsColdChunks) and a
+// write decompresses its chunk again.
+//
+// Chunks are allocated on the first write only: Reserve() keeps the size,
+// a column never written (e.g. the items of the filters not run) allocates
+// nothing and its values are read as zero.
+class StatsValueColumn
+{
+public:
+    enum storage
+    {
+        Storage_Double,
+        Storage_Float,
+        Storage_Int32,                                      // Integral values, +/-inf and NaN are kept as reserved values
+        Storage_None,                                       // Item not analyzed (see CommonStats::Items_Restrict), values are NaN and not stored
+    };
+
+    // Proxy for writes, y[j][x_Current]=Value
+    class reference
+    {
+    public:
+                                reference                   (StatsValueColumn& Column_, size_t Pos_) : Column(Column_), Pos(Pos_) {}
+                                operator double             () const {return Column.Get(Pos);}
+        reference&              operator=                   (double Value) {Column.Set(Pos, Value); return *this;}
+        reference&              operator=                   (const reference& Value) {Column.Set(Pos, Value); return *this;}
+
+    private:
+        StatsValueColumn&       Column;
+        size_t                  Pos;
+    };
+
+    // Constructor
+                                StatsValueColumn            () : Storage(Storage_Double), Reserved(0), Allocated(false) {}
+
+    // Must be called before the first Reserve()
+    void                        SetStorage                  (storage Storage_) {Storage=Storage_;}
+    storage                     GetStorage                  () const {return Storage;}
+    // False until the first write, values are then zero
+    bool                        IsAllocated                 () const {return Allocated.load(std::memory_order_acquire);}
+    // Values not stored anymore, the chunks already reserved are freed
+    void                        Drop                        ()
+    {
+        Storage=Storage_None;
+        Allocated.store(false, std::memory_order_release);
+        Cold.reset();
+        Doubles.Discard(Doubles.Reserved());
+        Floats.Discard(Floats.Reserved());
+        Int32s.Discard(Int32s.Reserved());
+    }
+
+    // Access
+    double                      operator[]                  (size_t Pos) const {return Get(Pos);}
+    reference                   operator[]                  (size_t Pos) {return reference(*this, Pos);}
+    double                      Get                         (size_t Pos) const
+    {
+        if (!Allocated.load(std::memory_order_acquire))
+            return Storage==Storage_None?std::numeric_limits<double>::quiet_NaN():0;
+        if (Cold && Cold->Has(Pos>>StatsColumn<double>::Chunk_Shift))
+            return Cold_Get(Pos);
+
+        switch (Storage)
+        {
+            case Storage_Float      :   return Floats[Pos];
+            case Storage_Int32      :   return Int32_Widen(Int32s[Pos]);
+            default                 :   return Doubles[Pos];
+        }
+    }
+    void                        Set                         (size_t Pos, double Value)
+    {
+        if (!Allocated.load(std::memory_order_relaxed))
+        {
+            if (Storage==Storage_None)
+                return;
+            Allocate(std::max(Reserved, Pos+1));
+        }
+        if (Cold && Cold->Has(Pos>>StatsColumn<double>::Chunk_Shift))
+            Thaw(Pos>>StatsColumn<double>::Chunk_Shift);
+
+        switch (Storage)
+        {
+            case Storage_Float      :   Floats[Pos]=(float)Value; break;
+            case Storage_Int32      :   {
+                                        int32_t Stored;
+                                        if (std::isnan(Value))
+                                            Stored=Int32_NaN;
+                                        else if (Value>=Int32_PlusInf)
+                                            Stored=Value==std::numeric_limits<double>::infinity()?Int32_PlusInf:Int32_PlusInf-1;
+                                        else if (Value<=Int32_NaN)
+                                            Stored=Value==-std::numeric_limits<double>::infinity()?Int32_MinusInf:Int32_NaN+1;
+                                        else
+                                            Stored=(int32_t)std::lround(Value);
+                                        Int32s[Pos]=Stored;
+                                        }
+                                        break;
+            default                 :   Doubles[Pos]=Value;
+        }
+    }
+
+    // Raw chunk of double values, NULL if values are stored in another format
+    const double*               DoubleChunk                 (size_t Index) const {return Storage==Storage_Double && Allocated.load(std::memory_order_acquire)?Doubles.Chunk(Index):nullptr;} // NULL too if compressed or not allocated
+    size_t                      Bytes                       () const {return Doubles.Bytes()+Floats.Bytes()+Int32s.Bytes()+(Cold?Cold->Bytes():0);}
+
+    // Memory management
+    StatsColumn<double>*        MappableColumn              () {return Storage==Storage_Double?&Doubles:nullptr;} // NULL if values can not be mapped without a conversion
+    void                        Map                         (double* Data, size_t Count)
+    {
+        Cold.reset();
+        if (Storage==Storage_Double)
+        {
+            Doubles.Map(Data, Count);
+            Allocated.store(true, std::memory_order_release);
+            return;
+        }
+
+        // Compact storage, values are converted
+        Reserve(Count);
+        for (size_t Pos=0; Pos<Count; Pos++)
+            Set(Pos, Data[Pos]);
+    }
+    void                        Reserve                     (size_t Size)
+    {
+        Reserved=std::max(Reserved, Size);
+        if (!Allocated.load(std::memory_order_relaxed))
+            return;
+
+        switch (Storage)
+        {
+            case Storage_Float      :   Floats.Reserve(Size); break;
+            case Storage_Int32      :   Int32s.Reserve(Size); break;
+            default                 :   Doubles.Reserve(Size);
+        }
+    }
+    void                        Discard                     (size_t Before)
+    {
+        if (Cold)
+            for (size_t Index=0; Index<(Before>>StatsColumn<double>::Chunk_Shift); Index++)
+                Cold->Remove(Index);
+        Doubles.Discard(Before);
+        Floats.Discard(Before);
+        Int32s.Discard(Before);
+    }
+
+    // Compresses the full chunks before Count (the chunk of the next value stays as is), by the writer thread
+    // The column must not be in use by readers, as for Map(); mapped chunks are not compressed
+    void                        Compress                    (size_t Count)
+    {
+        if (Storage==Storage_None || !Allocated.load(std::memory_order_relaxed))
+            return;
+        for (size_t Index=0; Index<(Count>>StatsColumn<double>::Chunk_Shift); Index++)
+        {
+            if (Cold && Cold->Has(Index))
+                continue;
+            if (!Cold)
+                Cold.reset(new StatsColdChunks(Storage==Storage_Float?StatsColdChunks::Kind_Float32:Storage==Storage_Int32?StatsColdChunks::Kind_Int32:StatsColdChunks::Kind_Float64, StatsColumn<double>::Chunk_Size));
+            switch (Storage)
+            {
+                case Storage_Float  :   Compress(Floats, Index); break;
+                case Storage_Int32  :   Compress(Int32s, Index); break;
+                default             :   Compress(Doubles, Index);
+            }
+        }
+    }
+
+private:
+    // First write, the values are readable once the chunks are allocated
+    void                        Allocate                    (size_t Size)
+    {
+        Reserved=Size;
+        switch (Storage)
+        {
+            case Storage_Float      :   Floats.Reserve(Size); break;
+            case Storage_Int32      :   Int32s.Reserve(Size); break;
+            default                 :   Doubles.Reserve(Size);
+        }
+        Allocated.store(true, std::memory_order_release);
+    }
+    static double               Int32_Widen                 (int32_t Value)
+    {
+        if (Value==Int32_PlusInf)
+            return std::numeric_limits<double>::infinity();
+        if (Value==Int32_MinusInf)
+            return -std::numeric_limits<double>::infinity();
+        if (Value==Int32_NaN)
+            return std::numeric_limits<double>::quiet_NaN();
+        return Value;
+    }
+    double                      Cold_Get                    (size_t Pos) const
+    {
+        uint64_t Bits=Cold->Bits(Pos>>StatsColumn<double>::Chunk_Shift, Pos&StatsColumn<double>::Chunk_Mask);
+        switch (Storage)
+        {
+            case Storage_Float      :   {
+                                        uint32_t Bits32=(uint32_t)Bits;
+                                        float Value;
+                                        memcpy(&Value, &Bits32, sizeof(Value));
+                                        return Value;
+                                        }
+            case Storage_Int32      :   return Int32_Widen((int32_t)(uint32_t)Bits);
+            default                 :   {
+                                        double Value;
+                                        memcpy(&Value, &Bits, sizeof(Value));
+                                        return Value;
+                                        }
+        }
+    }
+    template<typename T>
+    void                        Compress                    (StatsColumn<T>& Column, size_t Index)
+    {
+        if (!Column.Owned(Index))
+            return;
+        Cold->Add(Index, Column.Chunk(Index));
+        Column.Free(Index);
+    }
+    void                        Thaw                        (size_t Index)
+    {
+        switch (Storage)
+        {
+            case Storage_Float      :   Cold->Decode(Index, Floats.Restore(Index)); break;
+            case Storage_Int32      :   Cold->Decode(Index, Int32s.Restore(Index)); break;
+            default                 :   Cold->Decode(Index, Doubles.Restore(Index));
+        }
+        Cold->Remove(Index);
+    }
+
+    static const int32_t        Int32_PlusInf=INT32_MAX;
+    static const int32_t        Int32_MinusInf=INT32_MIN;
+    static const int32_t        Int32_NaN=INT32_MIN+1;
+
+    storage                     Storage;
+    size_t                      Reserved;                   // Size to allocate on the first write
+    std::atomic<bool>           Allocated;                  // By the writer thread
+    StatsColumn<double>         Doubles;
+    StatsColumn<float>          Floats;
+    StatsColumn<int32_t>        Int32s;
+    std::unique_ptr<StatsColdChunks> Cold;                  // Compressed chunks, NULL if none
+};
+
+//---------------------------------------------------------------------------
+// Column of small codes (1, 2 or 4 bits per frame), packed in bytes. Bytes
+// are atomic as the writer updates the byte of the next frame while readers
+// use the previous frames of the same byte. New values are zero.
+template<unsigned Bits>
+class StatsPackedColumn
+{
+public:
+    static_assert(Bits==1 || Bits==2 || Bits==4, "codes must not cross bytes");
+    static const unsigned       Code_Max=(1u<<Bits)-1;
+    static const size_t         PerByte=8/Bits;
+
+    // Access
+    unsigned                    Code                        (size_t Pos) const {return (Data[Pos/PerByte].load(std::memory_order_relaxed)>>((Pos%PerByte)*Bits))&Code_Max;}
+    void                        Code_Set                    (size_t Pos, unsigned Value)
+    {
+        std::atomic<uint8_t>& Byte=Data[Pos/PerByte];
+        unsigned Shift=(Pos%PerByte)*Bits;
+        Byte.store((uint8_t)((Byte.load(std::memory_order_relaxed)&~(Code_Max<<Shift))|((Value&Code_Max)<<Shift)), std::memory_order_relaxed);
+    }
+    size_t                      Bytes                       () const {return Data.Bytes();}
+
+    // Memory management
+    void                        Reserve                     (size_t Size) {Data.Reserve((Size+PerByte-1)/PerByte);}
+    void                        Discard                     (size_t Before) {Data.Discard(Before/PerByte);}
+
+private:
+    StatsColumn<std::atomic<uint8_t>> Data;
+};
+
+//---------------------------------------------------------------------------
+// Key frame status, 1 bit per frame
+class StatsKeyFrameColumn
+{
+public:
+    // Access
+    bool                        operator[]                  (size_t Pos) const {return Packed.Code(Pos)!=0;}
+    void                        Set                         (size_t Pos, bool Value) {Packed.Code_Set(Pos, Value?1:0);}
+    size_t                      Bytes                       () const {return Packed.Bytes();}
+
+    // Memory management
+    void                        Reserve                     (size_t Size) {Packed.Reserve(Size);}
+    void                        Discard                     (size_t Before) {Packed.Discard(Before);}
+
+private:
+    StatsPackedColumn<1>        Packed;
+};
+
+//---------------------------------------------------------------------------
+// Picture type, as av_get_picture_type_char(), 4 bits per frame
+// The 8 types of FFmpeg and "not set" don't fit in 2 bits, other characters
+// (e.g. from a report of another tool) are read as '?'.
+class StatsPictTypeColumn
+{
+public:
+    // Access
+    char                        operator[]                  (size_t Pos) const {return Char(Packed.Code(Pos));}
+    void                        Set                         (size_t Pos, char Value) {Packed.Code_Set(Pos, Code(Value));}
+    size_t                      Bytes                       () const {return Packed.Bytes();}
+
+    // Memory management
+    void                        Reserve                     (size_t Size) {Packed.Reserve(Size);}
+    void                        Discard                     (size_t Before) {Packed.Discard(Before);}
+
+    // Codes, 0 is not set
+    static const unsigned       Code_Bits=4;
+    static char                 Char                        (unsigned Code) {return !Code?'\0':Code<=8?Chars()[Code-1]:'?';}
+    static unsigned             Code                        (char Value)
+    {
+        if (!Value)
+            return 0;
+        for (unsigned Pos=0; Pos<8; Pos++)
+            if (Chars()[Pos]==Value)
+                return Pos+1;
+        return 1;
+    }
+
+private:
+    static const char*          Chars                       () {return "?IPBSipb";}
+
+    StatsPackedColumn<Code_Bits> Packed;
+};
+
+//---------------------------------------------------------------------------
+// Column of values rarely changing (e.g. the pixel format), stored as runs.
+// Positions must be set in increasing order (the same position may be set
+// again), positions before the first run are T().
+template<typename T>
+class StatsRunColumn
+{
+public:
+    // Constructor
+                                StatsRunColumn              () : Runs_Count(0) {}
+
+    // Access, O(log(runs))
+    T                           operator[]                  (size_t Pos) const
+    {
+        size_t Count=Runs_Count.load(std::memory_order_acquire);
+        if (!Count || Pos<Starts[0])
+            return T();
+
+        // Last run starting before or at Pos
+        size_t Begin=0, End=Count;
+        while (End-Begin>1)
+        {
+            size_t Middle=Begin+(End-Begin)/2;
+            if (Starts[Middle]<=Pos)
+                Begin=Middle;
+            else
+                End=Middle;
+        }
+        return Values[Begin];
+    }
+    void                        Set                         (size_t Pos, T Value)
+    {
+        size_t Count=Runs_Count.load(std::memory_order_relaxed);
+        if (Count && Starts[Count-1]==Pos)
+        {
+            // Not yet readable
+            Values[Count-1]=Value;
+            return;
+        }
+        if (Count && Values[Count-1]==Value)
+            return;
+
+        Starts.Reserve(Count+1);
+        Values.Reserve(Count+1);
+        Starts[Count]=Pos;
+        Values[Count]=Value;
+        Runs_Count.store(Count+1, std::memory_order_release);
+    }
+    size_t                      Bytes                       () const {return Starts.Bytes()+Values.Bytes();}
+
+    // Runs
+    size_t                      Runs                        () const {return Runs_Count.load(std::memory_order_acquire);}
+    size_t                      Run_Start                   (size_t Run) const {return Starts[Run];}
+    T                           Run_Value                   (size_t Run) const {return Values[Run];}
+
+private:
+    StatsColumn<size_t>         Starts;
+    StatsColumn<T>              Values;
+    std::atomic<size_t>         Runs_Count;
+};
+
+#endif // StatsColumn_H
@@ -0,0 +1,752 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsColumnsCache.h"
+#include "Core/CommonStats.h"
+#include "Core/VideoStats.h"
+#include "Core/AudioStats.h"
+#include "Core/FileInformation.h"
+//---------------------------------------------------------------------------
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QDir>
+#include <QMutexLocker>
+#include <QDebug>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+//---------------------------------------------------------------------------
+// File layout, native byte order, every block aligned on 8 bytes:
+// - header: magic, version, byte order, report size and modification time, FFmpeg version, streams/format XML
+// - per stream: identification, per_item names, min/max/totals, filters of the report, then each column as ColumnSize values
+//   (x[4], y[CountOfItems], durations, pkt_size), key_frames (1 bit per frame), pict_type_char (4 bits
+//   per frame), pix_fmt runs, pkt_pos and pkt_pts (delta+varint), sparse comments, additional stats
+//   (int and double as columns, strings as sparse lists)
+// Columns are mapped, the compact ones are decoded at load.
+static const char       Cache_Magic[8]={'Q', 'C', 'T', 'C', 'O', 'L', 'S', '\0'};
+static const uint32_t   Cache_Version=3;
+static const uint32_t   Cache_ByteOrder=0x01020304;
+static const size_t     Cache_ChunkSize=StatsColumn<double>::Chunk_Size;
+
+//***************************************************************************
+// Helpers
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+class StatsColumnsCache_Writer
+{
+public:
+    explicit StatsColumnsCache_Writer(QIODevice& Device_) : Device(Device_) {}
+
+    void Raw(const void* Data, size_t Size)
+    {
+        if (Size && Device.write((const char*)Data, Size)!=(qint64)Size)
+            Failed=true;
+        Pos+=Size;
+    }
+    template<typename T> void Value(const T& Data) {Raw(&Data, sizeof(T));}
+    template<typename T> void Array(const T* Data, size_t Count) {Raw(Data, Count*sizeof(T));}
+    void String(const std::string& Data)
+    {
+        Value((uint32_t)Data.size());
+        Raw(Data.data(), Data.size());
+        Align();
+    }
+    void Align()
+    {
+        static const char Zeros[8]={};
+        if (Pos&7)
+            Raw(Zeros, 8-(Pos&7));
+    }
+    template<typename T> void Column(const StatsColumn<T>& Data, size_t ColumnSize)
+    {
+        for (size_t Chunk_Pos=0; Chunk_Pos<ColumnSize/Cache_ChunkSize; Chunk_Pos++)
+            Array(Data.Chunk(Chunk_Pos), Cache_ChunkSize);
+    }
+    void Column(const StatsValueColumn& Data, size_t ColumnSize)
+    {
+        std::vector<double> Buffer;
+        for (size_t Chunk_Pos=0; Chunk_Pos<ColumnSize/Cache_ChunkSize; Chunk_Pos++)
+        {
+            const double* Chunk=Data.DoubleChunk(Chunk_Pos);
+            if (!Chunk)
+            {
+                // Compact storage, widening
+                Buffer.resize(Cache_ChunkSize);
+                for (size_t Pos=0; Pos<Cache_ChunkSize; Pos++)
+                    Buffer[Pos]=Data[Chunk_Pos*Cache_ChunkSize+Pos];
+                Chunk=Buffer.data();
+            }
+            Array(Chunk, Cache_ChunkSize);
+        }
+    }
+    template<typename Code_Get> void Packed(size_t Count, unsigned Bits, Code_Get Code)
+    {
+        // Codes of Bits bits, first frames in the low bits
+        size_t PerByte=8/Bits;
+        std::vector<uint8_t> Buffer((Count+PerByte-1)/PerByte);
+        for (size_t Pos=0; Pos<Count; Pos++)
+            Buffer[Pos/PerByte]|=(uint8_t)(Code(Pos)<<((Pos%PerByte)*Bits));
+        Array(Buffer.data(), Buffer.size());
+        Align();
+    }
+    void Runs(const StatsRunColumn<int>& Data, size_t Count)
+    {
+        size_t Runs_Count=0;
+        while (Runs_Count<Data.Runs() && Data.Run_Start(Runs_Count)<Count)
+            Runs_Count++;
+        Value((uint64_t)Runs_Count);
+        for (size_t Run=0; Run<Runs_Count; Run++)
+        {
+            Value((uint64_t)Data.Run_Start(Run));
+            Value((int64_t)Data.Run_Value(Run));
+        }
+    }
+    void Deltas(const StatsColumn<int64_t>& Data, size_t Count)
+    {
+        // Difference with the previous value, zigzag then 7 bits per byte: values are mostly increasing by small steps
+        std::vector<uint8_t> Buffer;
+        uint64_t Previous=0;
+        for (size_t Pos=0; Pos<Count; Pos++)
+        {
+            uint64_t Current=(uint64_t)Data[Pos];
+            int64_t Delta=(int64_t)(Current-Previous);
+            uint64_t ZigZag=((uint64_t)Delta<<1)^(uint64_t)(Delta>>63);
+            Previous=Current;
+            while (ZigZag>=0x80)
+            {
+                Buffer.push_back((uint8_t)(ZigZag|0x80));
+                ZigZag>>=7;
+            }
+            Buffer.push_back((uint8_t)ZigZag);
+        }
+        Value((uint64_t)Buffer.size());
+        Array(Buffer.data(), Buffer.size());
+        Align();
+    }
+
+    bool                        Failed {false};
+
+private:
+    QIODevice&                  Device;
+    size_t                      Pos {0};
+};
+
+//---------------------------------------------------------------------------
+class StatsColumnsCache_Reader
+{
+public:
+    StatsColumnsCache_Reader(uchar* Base_, size_t Size_) : Base(Base_), Size(Size_) {}
+
+    template<typename T> T* Array(size_t Count)
+    {
+        if (Failed || Count>(Size-Pos)/sizeof(T))
+        {
+            Failed=true;
+            return nullptr;
+        }
+        T* Data=(T*)(Base+Pos);
+        Pos+=Count*sizeof(T);
+        return Data;
+    }
+    template<typename T> T Value()
+    {
+        T Data=T();
+        if (const T* Source=Array<T>(1))
+            memcpy(&Data, Source, sizeof(T));
+        return Data;
+    }
+    bool String(std::string& Data)
+    {
+        uint32_t Length=Value<uint32_t>();
+        const char* Source=Array<char>(Length);
+        if (!Source)
+            return false;
+        Data.assign(Source, Length);
+        Align();
+        return !Failed;
+    }
+    void Align()
+    {
+        if (Pos&7)
+            Array<char>(8-(Pos&7));
+    }
+    template<typename Code_Set> bool Packed(size_t Count, unsigned Bits, Code_Set Code)
+    {
+        size_t PerByte=8/Bits;
+        const uint8_t* Data=Array<uint8_t>((Count+PerByte-1)/PerByte);
+        if (!Data)
+            return false;
+        for (size_t Pos=0; Pos<Count; Pos++)
+            Code(Pos, (Data[Pos/PerByte]>>((Pos%PerByte)*Bits))&((1u<<Bits)-1));
+        Align();
+        return !Failed;
+    }
+    bool Runs(StatsRunColumn<int>& Data, size_t Count)
+    {
+        uint64_t Runs_Count=Value<uint64_t>();
+        uint64_t Previous=0;
+        for (uint64_t Run=0; Run<Runs_Count && !Failed; Run++)
+        {
+            uint64_t Start=Value<uint64_t>();
+            int64_t Run_Value=Value<int64_t>();
+            if (Start>=Count || (Run && Start<=Previous))
+                Failed=true;
+            else
+                Data.Set(Start, (int)Run_Value);
+            Previous=Start;
+        }
+        return !Failed;
+    }
+    bool Deltas(StatsColumn<int64_t>& Data, size_t Count)
+    {
+        uint64_t Size=Value<uint64_t>();
+        const uint8_t* Source=Array<uint8_t>(Size);
+        if (!Source)
+            return false;
+        const uint8_t* Source_End=Source+Size;
+        uint64_t Previous=0;
+        for (size_t Pos=0; Pos<Count; Pos++)
+        {
+            uint64_t ZigZag=0;
+            for (unsigned Shift=0;; Shift+=7)
+            {
+                if (Source>=Source_End || Shift>63)
+                {
+                    Failed=true;
+                    return false;
+                }
+                uint8_t Byte=*Source++;
+                ZigZag|=(uint64_t)(Byte&0x7F)<<Shift;
+                if (!(Byte&0x80))
+                    break;
+            }
+            Previous+=(ZigZag>>1)^(0-(ZigZag&1));
+            Data[Pos]=(int64_t)Previous;
+        }
+        Align();
+        return !Failed;
+    }
+
+    bool                        Failed {false};
+
+private:
+    uchar*                      Base;
+    size_t                      Size;
+    size_t                      Pos {0};
+};
+
+//***************************************************************************
+// File name
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+QString StatsColumnsCache::FileName(const QString& ReportFileName)
+{
+    static const char* Suffixes[]=
+    {
+        ".qctools.xml.gz",
+        ".qctools.xml.zst",
+        ".qctools.xml",
+        ".qctools.mkv",
+        ".xml.gz",
+    };
+
+    for (auto Suffix : Suffixes)
+        if (ReportFileName.endsWith(Suffix))
+            return ReportFileName.left(ReportFileName.size()-(int)strlen(Suffix))+".qctools.cols";
+
+    return ReportFileName+".qctools.cols";
+}
+
+//***************************************************************************
+// Load
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Header up to the FFmpeg version, the cache matches the report, this format and this FFmpeg
+static bool Header_IsValid(StatsColumnsCache_Reader& Reader, const QFileInfo& Report)
+{
+    const char* Magic=Reader.Array<char>(sizeof(Cache_Magic));
+    uint32_t Version=Reader.Value<uint32_t>();
+    uint32_t ByteOrder=Reader.Value<uint32_t>();
+    uint64_t ReportSize=Reader.Value<uint64_t>();
+    int64_t ReportModified=Reader.Value<int64_t>();
+    std::string Version_FFmpeg;
+    return Magic && !memcmp(Magic, Cache_Magic, sizeof(Cache_Magic)) && Version==Cache_Version && ByteOrder==Cache_ByteOrder
+        && ReportSize==(uint64_t)Report.size() && ReportModified==Report.lastModified().toMSecsSinceEpoch()
+        && Reader.String(Version_FFmpeg) && Version_FFmpeg==FFmpeg_Version();
+}
+
+//---------------------------------------------------------------------------
+bool StatsColumnsCache::IsUpToDate(const QString& ReportFileName)
+{
+    QFileInfo Report(ReportFileName);
+    QFile Cache(FileName(ReportFileName));
+    if (!Report.exists() || !Cache.open(QIODevice::ReadOnly))
+        return false;
+
+    // The FFmpeg version is a short string, the header is in the first KiB
+    QByteArray Header=Cache.read(0x400);
+    StatsColumnsCache_Reader Reader((uchar*)Header.data(), Header.size());
+    return Header_IsValid(Reader, Report);
+}
+
+//---------------------------------------------------------------------------
+bool StatsColumnsCache::Load(const QString& ReportFileName, std::vector<CommonStats*>& Stats, std::string& Trailer)
+{
+    QFileInfo Report(ReportFileName);
+    File.setFileName(FileName(ReportFileName));
+    if (!Report.exists() || !File.exists() || !File.open(QIODevice::ReadOnly))
+        return false;
+
+    // Copy-on-write mapping, columns may be adapted afterwards (e.g. StatsFinish) without touching the file
+    qint64 File_Size=File.size();
+    uchar* Base=File_Size>0?File.map(0, File_Size, QFileDevice::MapPrivateOption):nullptr;
+    if (!Base)
+    {
+        File.close();
+        return false;
+    }
+
+    StatsColumnsCache_Reader Reader(Base, File_Size);
+    std::vector<CommonStats*> Loaded;
+    bool IsValid=true;
+
+    // Header
+    if (!Header_IsValid(Reader, Report) || !Reader.String(Trailer))
+        IsValid=false;
+
+    // Streams
+    uint32_t StreamsCount=IsValid?Reader.Value<uint32_t>():0;
+    Reader.Align();
+    for (uint32_t Stream_Pos=0; IsValid && Stream_Pos<StreamsCount; Stream_Pos++)
+    {
+        int StreamIndex;
+        CommonStats* Stat=ReadStats(Reader, StreamIndex);
+        if (!Stat)
+        {
+            IsValid=false;
+            break;
+        }
+
+        if (Loaded.size()<=(size_t)StreamIndex)
+            Loaded.resize(StreamIndex+1);
+        if (Loaded[StreamIndex])
+        {
+            delete Stat;
+            IsValid=false;
+            break;
+        }
+        Loaded[StreamIndex]=Stat;
+    }
+
+    if (!IsValid || Reader.Failed)
+    {
+        for (auto Stat : Loaded)
+            delete Stat;
+        Trailer.clear();
+        File.unmap(Base);
+        File.close();
+        qDebug() << "stats columns cache" << File.fileName() << "is outdated or invalid, ignored";
+        return false;
+    }
+
+    Stats=Loaded;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+CommonStats* StatsColumnsCache::ReadStats(StatsColumnsCache_Reader& Reader, int& StreamIndex)
+{
+    int32_t Type=Reader.Value<int32_t>();
+    StreamIndex=Reader.Value<int32_t>();
+    uint64_t FramesCount=Reader.Value<uint64_t>();
+    uint64_t ColumnSize=Reader.Value<uint64_t>();
+    int32_t Width=Reader.Value<int32_t>();
+    int32_t Height=Reader.Value<int32_t>();
+    const double* Times=Reader.Array<double>(5); // x_Max[4], FirstTimeStamp
+    uint32_t CountOfItems=Reader.Value<uint32_t>();
+    uint32_t CountOfGroups=Reader.Value<uint32_t>();
+    if (Reader.Failed || StreamIndex<0 || !ColumnSize || ColumnSize%Cache_ChunkSize || FramesCount>ColumnSize)
+        return nullptr;
+
+    std::unique_ptr<CommonStats> Stats;
+    if (Type==Type_Video)
+        Stats.reset(new VideoStats(StreamIndex));
+    else if (Type==Type_Audio)
+        Stats.reset(new AudioStats(StreamIndex));
+    else
+        return nullptr;
+
+    // Items must be the ones of this build
+    if (CountOfItems!=Stats->CountOfItems || CountOfGroups!=Stats->CountOfGroups)
+        return nullptr;
+    for (size_t j=0; j<CountOfItems; j++)
+    {
+        std::string Name;
+        if (!Reader.String(Name) || Name!=(Stats->PerItem[j].FFmpeg_Name?Stats->PerItem[j].FFmpeg_Name:""))
+            return nullptr;
+    }
+
+    // Min/max/totals
+    const double* y_Min=Reader.Array<double>(CountOfGroups);
+    const double* y_Max=Reader.Array<double>(CountOfGroups);
+    const double* Stats_Totals=Reader.Array<double>(CountOfItems);
+    const uint64_t* Stats_Counts=Reader.Array<uint64_t>(CountOfItems);
+    const uint64_t* Stats_Counts2=Reader.Array<uint64_t>(CountOfItems);
+    uint64_t ReportFilters=Reader.Value<uint64_t>();
+    if (Reader.Failed)
+        return nullptr;
+    memcpy(Stats->y_Min, y_Min, CountOfGroups*sizeof(double));
+    memcpy(Stats->y_Max, y_Max, CountOfGroups*sizeof(double));
+    memcpy(Stats->Stats_Totals, Stats_Totals, CountOfItems*sizeof(double));
+    memcpy(Stats->Stats_Counts, Stats_Counts, CountOfItems*sizeof(uint64_t));
+    memcpy(Stats->Stats_Counts2, Stats_Counts2, CountOfItems*sizeof(uint64_t));
+    Stats->ReportFilters=activefilters(ReportFilters);
+
+    // Columns, mapped
+    double* Columns_Double[4];
+    for (size_t j=0; j<4; j++)
+        Columns_Double[j]=Reader.Array<double>(ColumnSize);
+    std::vector<double*> Columns_y(CountOfItems);
+    for (size_t j=0; j<CountOfItems; j++)
+        Columns_y[j]=Reader.Array<double>(ColumnSize);
+    double* durations=Reader.Array<double>(ColumnSize);
+    int* pkt_size=Reader.Array<int>(ColumnSize);
+    if (Reader.Failed)
+        return nullptr;
+    for (size_t j=0; j<4; j++)
+        Stats->x[j].Map(Columns_Double[j], ColumnSize);
+    for (size_t j=0; j<CountOfItems; j++)
+        Stats->y[j].Map(Columns_y[j], ColumnSize);
+    Stats->durations.Map(durations, ColumnSize);
+    Stats->pkt_size.Map(pkt_size, ColumnSize);
+
+    // Columns, decoded
+    Stats->key_frames.Reserve(ColumnSize);
+    Stats->pict_type_char.Reserve(ColumnSize);
+    Stats->pkt_pos.Reserve(ColumnSize);
+    Stats->pkt_pts.Reserve(ColumnSize);
+    StatsKeyFrameColumn& key_frames=Stats->key_frames;
+    StatsPictTypeColumn& pict_type_char=Stats->pict_type_char;
+    if (!Reader.Packed(FramesCount, 1, [&](size_t Pos, unsigned Code) {key_frames.Set(Pos, Code!=0);})
+     || !Reader.Packed(FramesCount, StatsPictTypeColumn::Code_Bits, [&](size_t Pos, unsigned Code) {pict_type_char.Set(Pos, StatsPictTypeColumn::Char(Code));})
+     || !Reader.Runs(Stats->pix_fmt, FramesCount)
+     || !Reader.Deltas(Stats->pkt_pos, FramesCount)
+     || !Reader.Deltas(Stats->pkt_pts, FramesCount))
+        return nullptr;
+    Stats->Data_Reserved=ColumnSize;
+
+    // Comments
+    uint32_t CommentsCount=Reader.Value<uint32_t>();
+    Reader.Align();
+    for (uint32_t Pos=0; Pos<CommentsCount; Pos++)
+    {
+        uint64_t Frame=Reader.Value<uint64_t>();
+        std::string Comment;
+        if (!Reader.String(Comment) || Frame>=FramesCount)
+            return nullptr;
+        Stats->comments.Set(Frame, Stats->Strings.Add(Comment));
+    }
+
+    // Additional stats
+    for (int Type_Pos=CommonStats::StatsValueInfo::Int; Type_Pos<=CommonStats::StatsValueInfo::String; Type_Pos++)
+    {
+        auto ValueType=(CommonStats::StatsValueInfo::Type)Type_Pos;
+        uint32_t Count=Reader.Value<uint32_t>();
+        Reader.Align();
+        for (uint32_t Index=0; Index<Count; Index++)
+        {
+            std::string Key, InitialValue;
+            if (!Reader.String(Key) || !Reader.String(InitialValue) || Stats->statsValueInfoByKeys.Find(Key.c_str())!=StatsKeyIndex::NotFound)
+                return nullptr;
+            Stats->statsValueInfoByKeys.Insert(Key.c_str(), Stats->statsValueInfos.size());
+            Stats->statsValueInfos.push_back(CommonStats::StatsValueInfo {Index, ValueType, InitialValue});
+            Stats->statsKeysByIndexByValueType[ValueType][Index]=Key;
+            Stats->lastStatsIndexByValueType[ValueType]=Index+1;
+
+            if (ValueType==CommonStats::StatsValueInfo::Int)
+            {
+                int* Data=Reader.Array<int>(ColumnSize);
+                if (!Data)
+                    return nullptr;
+                Stats->additionalIntStats.emplace_back();
+                Stats->additionalIntStats.back().Map(Data, ColumnSize);
+            }
+            else if (ValueType==CommonStats::StatsValueInfo::Double)
+            {
+                double* Data=Reader.Array<double>(ColumnSize);
+                if (!Data)
+                    return nullptr;
+                Stats->additionalDoubleStats.emplace_back();
+                Stats->additionalDoubleStats.back().Map(Data, ColumnSize);
+            }
+            else
+            {
+                Stats->additionalStringStats.emplace_back();
+                auto& Column=Stats->additionalStringStats.back();
+                Column.Reserve(ColumnSize);
+                uint32_t ValuesCount=Reader.Value<uint32_t>();
+                Reader.Align();
+                for (uint32_t Pos=0; Pos<ValuesCount; Pos++)
+                {
+                    uint64_t Frame=Reader.Value<uint64_t>();
+                    std::string Value;
+                    if (!Reader.String(Value) || Frame>=FramesCount)
+                        return nullptr;
+                    Column[Frame]=Stats->Strings.Add(Value);
+                }
+            }
+        }
+    }
+    if (Reader.Failed)
+        return nullptr;
+
+    // Status
+    Stats->x_Current=FramesCount;
+    Stats->x_Current_Publish();
+    Stats->x_Current_Max=FramesCount;
+    memcpy(Stats->x_Max, Times, 4*sizeof(double));
+    Stats->FirstTimeStamp=Times[4];
+    if (auto Video=dynamic_cast<VideoStats*>(Stats.get()))
+    {
+        Video->setWidth(Width);
+        Video->setHeight(Height);
+    }
+    Stats->StatsFromExternalData_Finish();
+
+    return Stats.release();
+}
+
+//***************************************************************************
+// Save
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsColumnsCache::Save(const QString& ReportFileName, const std::vector<CommonStats*>& Stats, const std::string& Trailer)
+{
+    QFileInfo Report(ReportFileName);
+    if (!Report.exists())
+        return false;
+
+    // Written in a temporary file then renamed, readers never see a partial file
+    QSaveFile Output(FileName(ReportFileName));
+    if (!Output.open(QIODevice::WriteOnly))
+        return false;
+
+    StatsColumnsCache_Writer Writer(Output);
+    Writer.Array(Cache_Magic, sizeof(Cache_Magic));
+    Writer.Value(Cache_Version);
+    Writer.Value(Cache_ByteOrder);
+    Writer.Value((uint64_t)Report.size());
+    Writer.Value((int64_t)Report.lastModified().toMSecsSinceEpoch());
+    Writer.String(FFmpeg_Version());
+    Writer.String(Trailer);
+
+    uint32_t StreamsCount=0;
+    for (auto Stat : Stats)
+        if (Stat)
+            StreamsCount++;
+    Writer.Value(StreamsCount);
+    Writer.Align();
+    for (auto Stat : Stats)
+        if (Stat)
+        {
+            Stat->Items_Load();
+            WriteStats(Writer, *Stat);
+        }
+
+    if (Writer.Failed)
+    {
+        Output.cancelWriting();
+        return false;
+    }
+
+    return Output.commit();
+}
+
+//---------------------------------------------------------------------------
+void StatsColumnsCache::WriteStats(StatsColumnsCache_Writer& Writer, CommonStats& Stats)
+{
+    // Lock data
+    QMutexLocker Lock(&Stats.Mutex);
+
+    size_t FramesCount=Stats.x_Current;
+    size_t ColumnSize=(FramesCount+Cache_ChunkSize-1)/Cache_ChunkSize*Cache_ChunkSize;
+    if (!ColumnSize)
+        ColumnSize=Cache_ChunkSize;
+    if (ColumnSize>Stats.Data_Reserved)
+    {
+        Writer.Failed=true;
+        return;
+    }
+
+    auto Video=dynamic_cast<VideoStats*>(&Stats);
+    Writer.Value((int32_t)Stats.Type);
+    Writer.Value((int32_t)Stats.streamIndex);
+    Writer.Value((uint64_t)FramesCount);
+    Writer.Value((uint64_t)ColumnSize);
+    Writer.Value((int32_t)(Video?Video->getWidth():0));
+    Writer.Value((int32_t)(Video?Video->getHeight():0));
+    Writer.Array(Stats.x_Max, 4);
+    Writer.Value(Stats.FirstTimeStamp);
+    Writer.Value((uint32_t)Stats.CountOfItems);
+    Writer.Value((uint32_t)Stats.CountOfGroups);
+    for (size_t j=0; j<Stats.CountOfItems; j++)
+        Writer.String(Stats.PerItem[j].FFmpeg_Name?Stats.PerItem[j].FFmpeg_Name:"");
+
+    // Min/max/totals
+    Writer.Array(Stats.y_Min, Stats.CountOfGroups);
+    Writer.Array(Stats.y_Max, Stats.CountOfGroups);
+    Writer.Array(Stats.Stats_Totals, Stats.CountOfItems);
+    Writer.Array(Stats.Stats_Counts, Stats.CountOfItems);
+    Writer.Array(Stats.Stats_Counts2, Stats.CountOfItems);
+    Writer.Value((uint64_t)Stats.ReportFilters.to_ullong());
+
+    // Columns
+    for (size_t j=0; j<4; j++)
+        Writer.Column(Stats.x[j], ColumnSize);
+    for (size_t j=0; j<Stats.CountOfItems; j++)
+        Writer.Column(Stats.y[j], ColumnSize);
+    Writer.Column(Stats.durations, ColumnSize);
+    Writer.Column(Stats.pkt_size, ColumnSize);
+    Writer.Packed(FramesCount, 1, [&Stats](size_t Pos) {return Stats.key_frames[Pos]?1u:0u;});
+    Writer.Packed(FramesCount, StatsPictTypeColumn::Code_Bits, [&Stats](size_t Pos) {return StatsPictTypeColumn::Code(Stats.pict_type_char[Pos]);});
+    Writer.Runs(Stats.pix_fmt, FramesCount);
+    Writer.Deltas(Stats.pkt_pos, FramesCount);
+    Writer.Deltas(Stats.pkt_pts, FramesCount);
+
+    // Comments
+    auto Comments=Stats.comments.Range(0, FramesCount);
+    Writer.Value((uint32_t)Comments.size());
+    Writer.Align();
+    for (const auto& Comment : Comments)
+    {
+        Writer.Value((uint64_t)Comment.first);
+        Writer.String(Comment.second);
+    }
+
+    // Additional stats
+    for (int Type_Pos=CommonStats::StatsValueInfo::Int; Type_Pos<=CommonStats::StatsValueInfo::String; Type_Pos++)
+    {
+        auto ValueType=(CommonStats::StatsValueInfo::Type)Type_Pos;
+        size_t Count=Stats.lastStatsIndexByValueType[ValueType];
+        const auto& Keys=Stats.statsKeysByIndexByValueType[ValueType];
+        Writer.Value((uint32_t)Count);
+        Writer.Align();
+        for (size_t Index=0; Index<Count; Index++)
+        {
+            auto Key=Keys.find((int)Index);
+            size_t InfoPos=Key!=Keys.end()?Stats.statsValueInfoByKeys.Find(Key->second.c_str()):StatsKeyIndex::NotFound;
+            if (InfoPos==StatsKeyIndex::NotFound)
+            {
+                Writer.Failed=true;
+                return;
+            }
+            Writer.String(Key->second);
+            Writer.String(Stats.statsValueInfos[InfoPos].initialValue);
+
+            if (ValueType==CommonStats::StatsValueInfo::Int)
+                Writer.Column(Stats.additionalIntStats[Index], ColumnSize);
+            else if (ValueType==CommonStats::StatsValueInfo::Double)
+                Writer.Column(Stats.additionalDoubleStats[Index], ColumnSize);
+            else
+            {
+                const auto& Column=Stats.additionalStringStats[Index];
+                uint32_t ValuesCount=0;
+                for (size_t Frame=0; Frame<FramesCount; Frame++)
+                    if (Column[Frame])
+                        ValuesCount++;
+                Writer.Value(ValuesCount);
+                Writer.Align();
+                for (size_t Frame=0; Frame<FramesCount; Frame++)
+                    if (Column[Frame])
+                    {
+                        Writer.Value((uint64_t)Frame);
+                        Writer.String(Column[Frame]);
+                    }
+            }
+        }
+    }
+}
+
+//***************************************************************************
+// Spill
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+template<typename T>
+static void SpillColumn(StatsColumnsCache_Writer& Writer, StatsColumn<T>* Data, size_t& Offset, std::vector<std::function<void(uchar* Base)>>& Maps)
+{
+    // Empty or already mapped
+    size_t Count=Data?Data->Reserved():0;
+    if (!Count || Data->Bytes()!=Count*sizeof(T))
+        return;
+
+    Writer.Column(*Data, Count);
+    size_t Column_Offset=Offset;
+    Offset+=Count*sizeof(T);
+    Maps.push_back([=](uchar* Base) {
+        Data->Map((T*)(Base+Column_Offset), Count);
+    });
+}
+
+//---------------------------------------------------------------------------
+bool StatsColumnsCache::Spill(const std::vector<CommonStats*>& Stats)
+{
+    if (File.isOpen() || Spilled.isOpen())
+        return false;
+
+    Spilled.setFileTemplate(QDir::tempPath()+"/qctools-cols-XXXXXX");
+    if (!Spilled.open())
+        return false;
+
+    // Columns are written as they are in memory, then pointed to the mapping once everything is in the file
+    StatsColumnsCache_Writer Writer(Spilled);
+    size_t Offset=0;
+    std::vector<std::function<void(uchar* Base)>> Maps;
+    for (auto Stat : Stats)
+    {
+        if (!Stat)
+            continue;
+        QMutexLocker Lock(&Stat->Mutex);
+        for (size_t j=0; j<4; j++)
+            SpillColumn(Writer, &Stat->x[j], Offset, Maps);
+        for (size_t j=0; j<Stat->CountOfItems; j++)
+            SpillColumn(Writer, Stat->y[j].MappableColumn(), Offset, Maps);
+        SpillColumn(Writer, &Stat->durations, Offset, Maps);
+        SpillColumn(Writer, &Stat->pkt_pos, Offset, Maps);
+        SpillColumn(Writer, &Stat->pkt_pts, Offset, Maps);
+        SpillColumn(Writer, &Stat->pkt_size, Offset, Maps);
+        for (auto& Data : Stat->additionalIntStats)
+            SpillColumn(Writer, &Data, Offset, Maps);
+        for (auto& Data : Stat->additionalDoubleStats)
+            SpillColumn(Writer, &Data, Offset, Maps);
+    }
+
+    uchar* Base=!Writer.Failed && Offset && Spilled.flush()?Spilled.map(0, Offset):nullptr;
+    if (!Base)
+    {
+        Spilled.remove();
+        Spilled.close();
+        return false;
+    }
+
+    for (auto Stat : Stats)
+        if (Stat)
+            Stat->Mutex.lock();
+    for (const auto& Map : Maps)
+        Map(Base);
+    for (auto Stat : Stats)
+        if (Stat)
+            Stat->Mutex.unlock();
+    return true;
+}
@@ -0,0 +1,54 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsColumnsCache_H
+#define StatsColumnsCache_H
+
+#include <QFile>
+#include <QString>
+#include <QTemporaryFile>
+#include <string>
+#include <vector>
+
+class CommonStats;
+class StatsColumnsCache_Reader;
+class StatsColumnsCache_Writer;
+
+//---------------------------------------------------------------------------
+// Binary columnar sidecar of a stats report (<media>.qctools.cols).
+//
+// Written after a report is parsed once, it holds every per-frame column as a
+// contiguous array (padded to StatsColumn chunks) plus a header with the
+// per_item names and the FFmpeg version. Later opens memory map the file
+// (copy-on-write) and point the columns of the stats into it, so nothing is
+// parsed nor copied and the OS page cache is shared across processes.
+// The sidecar is ignored as soon as the report, the item tables or FFmpeg
+// changed.
+class StatsColumnsCache
+{
+public:
+    static QString              FileName                    (const QString& ReportFileName);
+    // The sidecar exists and Load() would use it, only its header is read
+    static bool                 IsUpToDate                  (const QString& ReportFileName);
+
+    // Stats must be empty, on success they use the mapped memory until this object is destroyed
+    bool                        Load                        (const QString& ReportFileName, std::vector<CommonStats*>& Stats, std::string& Trailer);
+    static bool                 Save                        (const QString& ReportFileName, const std::vector<CommonStats*>& Stats, const std::string& Trailer);
+
+    // Moves the columns of parsed stats to a mapped temporary file, the OS reloads them when read (files not displayed)
+    // Only once, stats loaded from the sidecar are already mapped, compact y columns are kept. No thread must use the stats.
+    bool                        Spill                       (const std::vector<CommonStats*>& Stats);
+
+private:
+    static CommonStats*         ReadStats                   (StatsColumnsCache_Reader& Reader, int& StreamIndex);
+    static void                 WriteStats                  (StatsColumnsCache_Writer& Writer, CommonStats& Stats);
+
+    QFile                       File;
+    QTemporaryFile              Spilled;
+};
+
+#endif // StatsColumnsCache_H
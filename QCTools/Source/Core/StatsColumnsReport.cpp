@@ -0,0 +1,632 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsColumnsReport.h"
+#include "Core/CommonStats.h"
+#include "Core/VideoStats.h"
+#include "Core/AudioStats.h"
+#include "Core/VideoCore.h"
+#include "Core/StatsXmlReader.h"
+#include "Core/FileInformation.h"
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+extern "C"
+{
+#include <libavutil/pixdesc.h>
+}
+
+#include <QIODevice>
+#include <QFile>
+#include <QFileDevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QSysInfo>
+#include <QDebug>
+#ifndef FMT_HEADER_ONLY
+#define FMT_HEADER_ONLY // Same configuration as spdlog, no fmt library to link
+#endif
+#include "ThirdParty/spdlog/fmt/bundled/format.h"
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+
+//---------------------------------------------------------------------------
+static const char       Report_Magic[8]={'Q', 'C', 'T', 'C', 'O', 'L', 'R', '\0'};
+static const uint32_t   Report_Version=1;
+static const uint32_t   Report_ByteOrder=0x01020304;
+static const size_t     Report_HeaderSize=24;
+static const size_t     Report_ChunkSize=StatsColumn<double>::Chunk_Size;
+static const char       Report_Extension[]=".qctools.columns";
+
+//***************************************************************************
+// Helpers
+//***************************************************************************
+
+namespace
+{
+//---------------------------------------------------------------------------
+// One column to write, Fill() writes the values from Begin to End
+struct column
+{
+    std::string         Name;
+    const char*         Type;
+    size_t              ElementSize;
+    std::function<void(size_t Begin, size_t End, char* Out)> Fill;
+    const char*         Kind;                           // frame (attribute), item or additional (tag)
+    size_t              Offset;
+};
+
+//---------------------------------------------------------------------------
+template<typename T>
+column Column_Raw(const char* Name, const char* Type, const StatsColumn<T>& Data)
+{
+    // Ranges are chunk aligned
+    return column {Name, Type, sizeof(T), [&Data](size_t Begin, size_t End, char* Out) {
+        memcpy(Out, Data.Chunk(Begin/Report_ChunkSize), (End-Begin)*sizeof(T));
+    }, "frame", 0};
+}
+
+//---------------------------------------------------------------------------
+template<typename T>
+column Column_Values(const std::string& Name, const char* Type, const std::function<T(size_t)>& Value)
+{
+    return column {Name, Type, sizeof(T), [Value](size_t Begin, size_t End, char* Out) {
+        T* Values=(T*)Out;
+        for (size_t Pos=Begin; Pos<End; Pos++)
+            *Values++=Value(Pos);
+    }, "frame", 0};
+}
+
+//---------------------------------------------------------------------------
+size_t TypeSize(const QString& Type)
+{
+    if (Type=="f64" || Type=="i64")
+        return 8;
+    if (Type=="f32" || Type=="i32")
+        return 4;
+    if (Type=="u8")
+        return 1;
+    return 0;
+}
+
+//---------------------------------------------------------------------------
+// Column in a loaded file
+struct column_value
+{
+    std::string         Name;
+    const char*         Data;
+    size_t              ElementSize;
+    bool                IsFloat;
+    int                 Precision;                      // Digits after the decimal point, or -1 for the shortest text
+
+    double Double(size_t Pos) const
+    {
+        const char* Value=Data+Pos*ElementSize;
+        if (ElementSize==8)
+        {
+            double Content;
+            memcpy(&Content, Value, 8);
+            return Content;
+        }
+        float Content;
+        memcpy(&Content, Value, 4);
+        return Content;
+    }
+
+    int64_t Int(size_t Pos) const
+    {
+        const char* Value=Data+Pos*ElementSize;
+        switch (ElementSize)
+        {
+            case 8  :   {int64_t Content; memcpy(&Content, Value, 8); return Content;}
+            case 4  :   {int32_t Content; memcpy(&Content, Value, 4); return Content;}
+            default :   return (unsigned char)*Value;
+        }
+    }
+};
+
+//---------------------------------------------------------------------------
+// Rebuilds the frames as the XML reader provides them, so the stats are filled by the usual parseFrame()
+class frame_builder
+{
+public:
+    void Clear()
+    {
+        Text.clear();
+        Attributes.clear();
+        Tags.clear();
+    }
+
+    void Attribute(const char* Name, const char* Value) {Attributes.emplace_back(Add(Name), Add(Value));}
+    void Attribute(const char* Name, const column_value& Column, size_t Pos) {Attributes.emplace_back(Add(Name), Add(Column, Pos));}
+    void Tag(const char* Key, const column_value& Column, size_t Pos) {Tags.emplace_back(Add(Key), Add(Column, Pos));}
+    void Tag(const char* Key, const char* Value) {Tags.emplace_back(Add(Key), Add(Value));}
+
+    // Pointers are valid until the next Clear()
+    void Build(StatsXmlFrame& Frame) const
+    {
+        Frame.attributes.clear();
+        Frame.tags.clear();
+        const char* Base=Text.data();
+        for (const auto& Attribute : Attributes)
+            Frame.attributes.emplace_back(Base+Attribute.first, Base+Attribute.second);
+        for (const auto& Tag : Tags)
+            Frame.tags.emplace_back(Base+Tag.first, Base+Tag.second);
+    }
+
+private:
+    size_t Add(const char* Value)
+    {
+        size_t Pos=Text.size();
+        Text.append(Value);
+        Text.push_back('\0');
+        return Pos;
+    }
+
+    // Shortest text giving back the same value, except for additional stats which are typed from the text as in the XML report
+    size_t Add(const column_value& Column, size_t Pos)
+    {
+        size_t Begin=Text.size();
+        if (Column.IsFloat)
+        {
+            char Buffer[32];
+            size_t Size;
+            if (Column.Precision>=0)
+                Size=fmt::format_to_n(Buffer, sizeof(Buffer), "{:.{}f}", Column.Double(Pos), Column.Precision).size;
+            else if (Column.ElementSize==8)
+                Size=fmt::format_to_n(Buffer, sizeof(Buffer), "{}", Column.Double(Pos)).size;
+            else
+                Size=fmt::format_to_n(Buffer, sizeof(Buffer), "{}", (float)Column.Double(Pos)).size;
+            Text.append(Buffer, std::min(Size, sizeof(Buffer)));
+        }
+        else
+        {
+            fmt::format_int Value(Column.Int(Pos));
+            Text.append(Value.data(), Value.size());
+        }
+        Text.push_back('\0');
+        return Begin;
+    }
+
+    std::string Text;
+    std::vector<std::pair<size_t, size_t>> Attributes;
+    std::vector<std::pair<size_t, size_t>> Tags;
+};
+
+//---------------------------------------------------------------------------
+// Mapping of a report, kept by its stats while some items are not read
+struct mapping
+{
+    QFile                       File;
+    uchar*                      Data=nullptr;
+
+    ~mapping()
+    {
+        if (Data)
+            File.unmap(Data);
+    }
+};
+}
+
+//***************************************************************************
+// File name
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsColumnsReport::IsColumnsReport(const QString& FileName)
+{
+    return FileName.endsWith(Report_Extension);
+}
+
+//***************************************************************************
+// Save
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsColumnsReport::Save(QIODevice& Output, const std::vector<CommonStats*>& Stats, const activefilters& Filters, const std::string& Trailer)
+{
+    // Values are written as they are in memory
+    if (QSysInfo::ByteOrder!=QSysInfo::LittleEndian)
+        return false;
+
+    // Schema, with the columns to write
+    QJsonObject Root;
+    Root["format"]="qctools-columns";
+    Root["version"]=(int)Report_Version;
+    Root["creator"]=QString("QCTools ")+Version;
+    Root["ffmpeg_version"]=QString::fromStdString(FFmpeg_Version());
+    Root["streams_and_format"]=QString::fromStdString(Trailer);
+
+    QJsonArray Streams_Json;
+    std::vector<std::pair<CommonStats*, std::vector<column>>> Streams;
+    size_t Data_Size=0;
+    for (auto Stat : Stats)
+    {
+        if (!Stat)
+            continue;
+        CommonStats& S=*Stat;
+        S.Items_Load();
+        QMutexLocker Lock(&S.Mutex);
+
+        size_t FramesCount=S.x_Current;
+        auto Video=dynamic_cast<VideoStats*>(Stat);
+        int Width=Video?Video->getWidth():0;
+        int Height=Video?Video->getHeight():0;
+
+        QJsonObject Stream_Json;
+        Stream_Json["stream_index"]=S.streamIndex;
+        Stream_Json["media_type"]=Video?"video":"audio";
+        Stream_Json["frames"]=(double)FramesCount;
+        if (Video)
+        {
+            Stream_Json["width"]=Width;
+            Stream_Json["height"]=Height;
+        }
+
+        // Frame information
+        std::vector<column> Columns;
+        Columns.push_back(Column_Values<double>("pkt_pts_time", "f64", [Stat](size_t Pos) {return Stat->x[1][Pos]+Stat->FirstTimeStamp;}));
+        Columns.push_back(Column_Raw("pkt_duration_time", "f64", S.durations));
+        Columns.push_back(Column_Raw("pkt_pts", "i64", S.pkt_pts));
+        Columns.push_back(Column_Raw("pkt_pos", "i64", S.pkt_pos));
+        Columns.push_back(Column_Raw("pkt_size", "i32", S.pkt_size));
+        Columns.push_back(Column_Values<uint8_t>("key_frame", "u8", [Stat](size_t Pos) {return Stat->key_frames[Pos]?1:0;}));
+        if (Video)
+        {
+            Columns.push_back(Column_Values<uint8_t>("pict_type", "u8", [Stat](size_t Pos) {return (uint8_t)Stat->pict_type_char[Pos];}));
+            Columns.push_back(Column_Values<int32_t>("pix_fmt", "i32", [Stat](size_t Pos) {return Stat->pix_fmt[Pos];}));
+
+            QJsonObject Names;
+            if (FramesCount && (!S.pix_fmt.Runs() || S.pix_fmt.Run_Start(0)))
+                Names["0"]=av_get_pix_fmt_name((AVPixelFormat)0); // Frames before the first run
+            for (size_t Run=0; Run<S.pix_fmt.Runs() && S.pix_fmt.Run_Start(Run)<FramesCount; Run++)
+            {
+                int Value=S.pix_fmt.Run_Value(Run);
+                const char* Name=av_get_pix_fmt_name((AVPixelFormat)Value);
+                if (Name)
+                    Names[QString::number(Value)]=Name;
+            }
+            Stream_Json["pix_fmt_names"]=Names;
+        }
+
+        // Items, as in the XML report
+        for (size_t Plot_Pos=0; Plot_Pos<S.CountOfItems; Plot_Pos++)
+        {
+            const activefilter filter=S.PerItem[Plot_Pos].Filter;
+            if (filter==activefilter(-1) || !Filters.test(filter) || !S.Item_IsUsed(Plot_Pos))
+                continue;
+
+            const StatsValueColumn& Values=S.y[Plot_Pos];
+            bool IsCropWidth=Video && (Plot_Pos==Item_Crop_x2 || Plot_Pos==Item_Crop_w);
+            bool IsCropHeight=Video && (Plot_Pos==Item_Crop_y2 || Plot_Pos==Item_Crop_h);
+            if (IsCropWidth || IsCropHeight)
+            {
+                // Special case, values are from width or height
+                int Size=IsCropWidth?Width:Height;
+                Columns.push_back(Column_Values<double>(S.PerItem[Plot_Pos].FFmpeg_Name, "f64", [&Values, Size](size_t Pos) {return Size-Values[Pos];}));
+            }
+            else if (Values.GetStorage()==StatsValueColumn::Storage_Float)
+                Columns.push_back(Column_Values<float>(S.PerItem[Plot_Pos].FFmpeg_Name, "f32", [&Values](size_t Pos) {return (float)Values[Pos];}));
+            else
+                Columns.push_back(Column_Values<double>(S.PerItem[Plot_Pos].FFmpeg_Name, "f64", [&Values](size_t Pos) {return Values[Pos];}));
+            Columns.back().Kind="item";
+        }
+
+        // Additional stats, string ones are in the schema
+        for (const auto& Key : S.statsKeysByIndexByValueType[CommonStats::StatsValueInfo::Int])
+            if ((size_t)Key.first<S.additionalIntStats.size())
+            {
+                Columns.push_back(Column_Raw(Key.second.c_str(), "i32", S.additionalIntStats[Key.first]));
+                Columns.back().Kind="additional";
+            }
+        for (const auto& Key : S.statsKeysByIndexByValueType[CommonStats::StatsValueInfo::Double])
+            if ((size_t)Key.first<S.additionalDoubleStats.size())
+            {
+                Columns.push_back(Column_Raw(Key.second.c_str(), "f64", S.additionalDoubleStats[Key.first]));
+                Columns.back().Kind="additional";
+            }
+        QJsonObject Strings;
+        for (const auto& Key : S.statsKeysByIndexByValueType[CommonStats::StatsValueInfo::String])
+        {
+            if ((size_t)Key.first>=S.additionalStringStats.size())
+                continue;
+            QJsonArray Values;
+            for (size_t Pos=0; Pos<FramesCount; Pos++)
+            {
+                const char* Value=S.additionalStringStats[Key.first][Pos];
+                Values.append(Value?QJsonValue(QString::fromUtf8(Value)):QJsonValue());
+            }
+            Strings[QString::fromStdString(Key.second)]=Values;
+        }
+        Stream_Json["strings"]=Strings;
+
+        // Comments, sparse
+        QJsonObject Comments;
+        for (const auto& Comment : S.comments.Range(0, FramesCount))
+            Comments[QString::number(Comment.first)]=QString::fromUtf8(Comment.second);
+        Stream_Json["comments"]=Comments;
+
+        // Offsets
+        QJsonArray Columns_Json;
+        for (auto& Column : Columns)
+        {
+            Column.Offset=Data_Size;
+            Data_Size+=(FramesCount*Column.ElementSize+7)/8*8;
+
+            QJsonObject Column_Json;
+            Column_Json["name"]=QString::fromStdString(Column.Name);
+            Column_Json["type"]=Column.Type;
+            Column_Json["kind"]=Column.Kind;
+            Column_Json["offset"]=(double)Column.Offset;
+            Columns_Json.append(Column_Json);
+        }
+        Stream_Json["columns"]=Columns_Json;
+
+        Streams_Json.append(Stream_Json);
+        Streams.emplace_back(Stat, std::move(Columns));
+    }
+    Root["streams"]=Streams_Json;
+
+    QByteArray Schema=QJsonDocument(Root).toJson(QJsonDocument::Compact);
+    while ((Report_HeaderSize+Schema.size())%8)
+        Schema.append(' ');
+
+    // Header
+    bool IsOk=true;
+    auto Write=[&](const void* Data, size_t Size) {
+        if (IsOk && Size && Output.write((const char*)Data, Size)!=(qint64)Size)
+            IsOk=false;
+    };
+    uint64_t Schema_Size=Schema.size();
+    Write(Report_Magic, sizeof(Report_Magic));
+    Write(&Report_Version, sizeof(Report_Version));
+    Write(&Report_ByteOrder, sizeof(Report_ByteOrder));
+    Write(&Schema_Size, sizeof(Schema_Size));
+    Write(Schema.constData(), Schema.size());
+
+    // Columns, chunk by chunk
+    static const char Zeros[8]={};
+    std::vector<char> Buffer;
+    for (auto& Stream : Streams)
+    {
+        QMutexLocker Lock(&Stream.first->Mutex);
+        size_t FramesCount=Stream.first->x_Current;
+        for (const auto& Column : Stream.second)
+        {
+            Buffer.resize(Report_ChunkSize*Column.ElementSize);
+            for (size_t Begin=0; Begin<FramesCount; Begin+=Report_ChunkSize)
+            {
+                size_t End=std::min(Begin+Report_ChunkSize, FramesCount);
+                Column.Fill(Begin, End, Buffer.data());
+                Write(Buffer.data(), (End-Begin)*Column.ElementSize);
+            }
+            size_t Size=FramesCount*Column.ElementSize;
+            if (Size%8)
+                Write(Zeros, 8-Size%8);
+        }
+    }
+
+    return IsOk;
+}
+
+//***************************************************************************
+// Load
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsColumnsReport::Load(QIODevice& Input, std::vector<CommonStats*>& Stats, std::string& Trailer, qint64 Offset, qint64 Size, bool Lazy)
+{
+    // Values are read as they are in memory
+    if (QSysInfo::ByteOrder!=QSysInfo::LittleEndian)
+        return false;
+
+    // Mapped if possible, only the pages of the columns are read
+    QFileDevice* File=qobject_cast<QFileDevice*>(&Input);
+    if (File && !Input.isSequential())
+    {
+        if (Size<0)
+            Size=File->size()-Offset;
+
+        // Mapped by a file of its own, the input may be closed before the items are read
+        if (Lazy && Size>0 && !File->fileName().isEmpty())
+        {
+            auto Mapping=std::make_shared<mapping>();
+            Mapping->File.setFileName(File->fileName());
+            if (Mapping->File.open(QIODevice::ReadOnly))
+                Mapping->Data=Mapping->File.map(Offset, Size);
+            if (Mapping->Data)
+                return Parse((const char*)Mapping->Data, Size, Stats, Trailer, Mapping);
+        }
+
+        uchar* Data=Size>0?File->map(Offset, Size):nullptr;
+        if (Data)
+        {
+            bool IsOk=Parse((const char*)Data, Size, Stats, Trailer);
+            File->unmap(Data);
+            return IsOk;
+        }
+    }
+
+    if (Offset && !Input.seek(Offset))
+        return false;
+    QByteArray Content=Size<0?Input.readAll():Input.read(Size);
+    if (Lazy)
+    {
+        auto Memory=std::make_shared<QByteArray>(std::move(Content));
+        return Parse(Memory->constData(), Memory->size(), Stats, Trailer, Memory);
+    }
+    return Parse(Content.constData(), Content.size(), Stats, Trailer);
+}
+
+//---------------------------------------------------------------------------
+bool StatsColumnsReport::Parse(const char* Data, size_t Size, std::vector<CommonStats*>& Stats, std::string& Trailer, const std::shared_ptr<const void>& Memory)
+{
+    // Header
+    if (Size<Report_HeaderSize || memcmp(Data, Report_Magic, sizeof(Report_Magic)))
+        return false;
+    uint32_t File_Version, File_ByteOrder;
+    uint64_t Schema_Size;
+    memcpy(&File_Version, Data+8, sizeof(File_Version));
+    memcpy(&File_ByteOrder, Data+12, sizeof(File_ByteOrder));
+    memcpy(&Schema_Size, Data+16, sizeof(Schema_Size));
+    if (File_Version!=Report_Version || File_ByteOrder!=Report_ByteOrder || Schema_Size>Size-Report_HeaderSize)
+    {
+        qDebug() << "columns report: unsupported version or byte order";
+        return false;
+    }
+
+    // Schema
+    QJsonParseError Error;
+    QJsonDocument Schema=QJsonDocument::fromJson(QByteArray::fromRawData(Data+Report_HeaderSize, Schema_Size), &Error);
+    if (Error.error!=QJsonParseError::NoError || !Schema.isObject())
+    {
+        qDebug() << "columns report: invalid schema" << Error.errorString();
+        return false;
+    }
+    QJsonObject Root=Schema.object();
+    if (Root.value("format").toString()!="qctools-columns")
+        return false;
+    Trailer=Root.value("streams_and_format").toString().toStdString();
+
+    const char* Columns_Data=Data+Report_HeaderSize+Schema_Size;
+    size_t Columns_Size=Size-Report_HeaderSize-Schema_Size;
+
+    frame_builder Builder;
+    StatsXmlFrame Frame;
+    for (const QJsonValue& Stream_Value : Root.value("streams").toArray())
+    {
+        QJsonObject Stream=Stream_Value.toObject();
+        int Index=Stream.value("stream_index").toInt(-1);
+        QString MediaType=Stream.value("media_type").toString();
+        bool IsVideo=MediaType=="video";
+        if (Index<0 || (!IsVideo && MediaType!="audio") || ((size_t)Index<Stats.size() && Stats[Index]))
+            return false;
+        double FramesCount_Value=Stream.value("frames").toDouble();
+        if (FramesCount_Value<0 || FramesCount_Value>Columns_Size)
+            return false;
+        size_t FramesCount=(size_t)FramesCount_Value;
+
+        // Columns
+        std::vector<column_value> Attributes;
+        std::vector<column_value> Tags;
+        std::vector<column_value> Items; // Read later
+        const StatsKeyIndex& ItemsIndex=IsVideo?StatsKeyIndex::Video():StatsKeyIndex::Audio();
+        for (const QJsonValue& Column_Value : Stream.value("columns").toArray())
+        {
+            QJsonObject Column=Column_Value.toObject();
+            QString Type=Column.value("type").toString();
+            QString Kind=Column.value("kind").toString();
+            size_t ElementSize=TypeSize(Type);
+            double Offset=Column.value("offset").toDouble(-1);
+            if (!ElementSize || Offset<0 || Offset>Columns_Size || FramesCount*ElementSize>Columns_Size-(size_t)Offset)
+                return false;
+
+            column_value Value {Column.value("name").toString().toStdString(), Columns_Data+(size_t)Offset, ElementSize, Type.startsWith('f'), -1};
+            if (Kind=="frame")
+                Attributes.push_back(Value);
+            else if (Kind=="item" && Value.IsFloat && Memory && ItemsIndex.Find(Value.Name.c_str())!=StatsKeyIndex::NotFound)
+                Items.push_back(Value);
+            else
+            {
+                if (Kind=="additional" && Value.IsFloat)
+                    Value.Precision=6; // As in the XML report
+                Tags.push_back(Value);
+            }
+        }
+
+        std::map<int64_t, std::string> PixFmtNames;
+        QJsonObject PixFmtNames_Json=Stream.value("pix_fmt_names").toObject();
+        for (auto Name=PixFmtNames_Json.begin(); Name!=PixFmtNames_Json.end(); ++Name)
+            PixFmtNames[Name.key().toLongLong()]=Name.value().toString().toStdString();
+
+        std::vector<std::pair<std::string, QJsonArray>> Strings;
+        QJsonObject Strings_Json=Stream.value("strings").toObject();
+        for (auto String=Strings_Json.begin(); String!=Strings_Json.end(); ++String)
+            Strings.emplace_back(String.key().toStdString(), String.value().toArray());
+
+        QJsonObject Comments=Stream.value("comments").toObject();
+        std::string Width=std::to_string(Stream.value("width").toInt());
+        std::string Height=std::to_string(Stream.value("height").toInt());
+
+        // Stats
+        if (Stats.size()<=(size_t)Index)
+            Stats.resize(Index+1);
+        CommonStats* S;
+        if (IsVideo)
+            S=new VideoStats(Index);
+        else
+            S=new AudioStats(Index);
+        Stats[Index]=S;
+
+        // Values of the frames and of the additional stats are read now, the items on their first use
+        if (!Items.empty())
+        {
+            S->Items_Sources.resize(S->CountOfItems);
+            for (const auto& Column : Items)
+            {
+                size_t j=ItemsIndex.Find(Column.Name.c_str(), S->CountOfItems);
+                if (j>=S->CountOfItems || S->Items_Sources[j].Data)
+                    continue;
+                S->Items_Sources[j]=CommonStats::item_source{Column.Data, Column.ElementSize};
+                S->Items_Pending++;
+                if (S->PerItem[j].Filter!=activefilter(-1))
+                    S->ReportFilters.set(S->PerItem[j].Filter);
+            }
+            S->Items_Memory=Memory;
+        }
+
+        for (size_t Pos=0; Pos<FramesCount; Pos++)
+        {
+            Builder.Clear();
+            Builder.Attribute("media_type", IsVideo?"video":"audio");
+            for (const auto& Column : Attributes)
+            {
+                if (Column.Name=="pix_fmt")
+                {
+                    auto Name=PixFmtNames.find(Column.Int(Pos));
+                    if (Name!=PixFmtNames.end())
+                        Builder.Attribute("pix_fmt", Name->second.c_str());
+                }
+                else if (Column.Name=="pict_type")
+                {
+                    char PictType[2]={(char)Column.Int(Pos), '\0'};
+                    Builder.Attribute("pict_type", PictType);
+                }
+                else
+                    Builder.Attribute(Column.Name.c_str(), Column, Pos);
+            }
+            if (IsVideo)
+            {
+                Builder.Attribute("width", Width.c_str());
+                Builder.Attribute("height", Height.c_str());
+            }
+            for (const auto& Column : Tags)
+                Builder.Tag(Column.Name.c_str(), Column, Pos);
+            for (const auto& String : Strings)
+            {
+                QJsonValue Value=Pos<(size_t)String.second.size()?String.second.at((int)Pos):QJsonValue();
+                Builder.Tag(String.first.c_str(), Value.isString()?Value.toString().toUtf8().constData():"N/A");
+            }
+            Builder.Build(Frame);
+            S->parseFrame(Frame);
+
+            // Comments are stored as they are in memory (escaped)
+            QJsonValue Comment=Comments.value(QString::number(Pos));
+            if (Comment.isString())
+                S->Comment_Set(Pos, Comment.toString().toUtf8().constData());
+        }
+
+        S->StatsFromExternalData_Finish();
+    }
+
+    return true;
+}
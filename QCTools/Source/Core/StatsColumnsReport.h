@@ -0,0 +1,56 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsColumnsReport_H
+#define StatsColumnsReport_H
+
+#include "Core/Core.h"
+
+#include <QString>
+#include <memory>
+#include <string>
+#include <vector>
+
+class QIODevice;
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Columnar report (.qctools.columns), an alternative to the XML report for
+// tools which only need some values: no tokenizing, each column can be read
+// (or memory mapped) directly.
+//
+// Layout, little endian:
+// - "QCTCOLR\0", uint32 version (1), uint32 0x01020304, uint64 schema size
+// - schema (UTF-8 JSON, padded with spaces to a multiple of 8 bytes): creator
+//   and FFmpeg versions, "streams_and_format" (the XML part after </frames>
+//   in the XML report), per stream its stream_index, media_type, frames count,
+//   width/height, pix_fmt_names, comments, string stats, and
+//   "columns": [{"name", "type" (f64, f32, i64, i32, u8), "kind" (frame,
+//   item, additional), "offset"}, ...]
+// - data: each column has one value per frame, offsets start from the end of
+//   the schema and are multiple of 8
+// Columns are pkt_pts_time, pkt_duration_time, pkt_pts, pkt_pos, pkt_size,
+// key_frame, pict_type and pix_fmt (video), then one per exported item
+// (FFmpeg_Name, value as in the XML report) and one per additional stat.
+class StatsColumnsReport
+{
+public:
+    static bool                 IsColumnsReport             (const QString& FileName);
+
+    static bool                 Save                        (QIODevice& Output, const std::vector<CommonStats*>& Stats, const activefilters& Filters, const std::string& Trailer);
+
+    // Stats are created as when an XML report is parsed, Trailer is the XML after </frames>
+    // The report may be a part of the input (an attachment of a .qctools.mkv report), from Offset and of Size bytes (-1 for up to the end)
+    // With Lazy, the item columns are read on their first use (see CommonStats::Item_Require), the report stays mapped until then
+    static bool                 Load                        (QIODevice& Input, std::vector<CommonStats*>& Stats, std::string& Trailer, qint64 Offset=0, qint64 Size=-1, bool Lazy=false);
+
+private:
+    // Memory is the owner of Data if the items are read later, else nullptr
+    static bool                 Parse                       (const char* Data, size_t Size, std::vector<CommonStats*>& Stats, std::string& Trailer, const std::shared_ptr<const void>& Memory=nullptr);
+};
+
+#endif // StatsColumnsReport_H
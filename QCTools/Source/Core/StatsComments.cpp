@@ -0,0 +1,108 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsComments.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+std::vector<StatsComments::item>::const_iterator StatsComments::Find(size_t Pos) const
+{
+    return std::lower_bound(Items.begin(), Items.end(), Pos, [](const item& Item, size_t Value) {return Item.first<Value;});
+}
+
+//***************************************************************************
+// Access
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const char* StatsComments::operator[](size_t Pos) const
+{
+    QMutexLocker Locker(&Mutex);
+    auto Item=Find(Pos);
+    return Item!=Items.end() && Item->first==Pos?Item->second:nullptr;
+}
+
+//---------------------------------------------------------------------------
+void StatsComments::Set(size_t Pos, const char* Comment)
+{
+    QMutexLocker Locker(&Mutex);
+    bool Remove=!Comment || !*Comment;
+
+    // Frames of the parsing come in order
+    if (Items.empty() || Items.back().first<Pos)
+    {
+        if (!Remove)
+            Items.emplace_back(Pos, Comment);
+        return;
+    }
+
+    auto Item=Items.begin()+(Find(Pos)-Items.cbegin());
+    if (Item!=Items.end() && Item->first==Pos)
+    {
+        if (Remove)
+            Items.erase(Item);
+        else
+            Item->second=Comment;
+    }
+    else if (!Remove)
+        Items.emplace(Item, Pos, Comment);
+}
+
+//---------------------------------------------------------------------------
+size_t StatsComments::Count() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Items.size();
+}
+
+//---------------------------------------------------------------------------
+std::vector<StatsComments::item> StatsComments::Range(size_t Begin, size_t End) const
+{
+    QMutexLocker Locker(&Mutex);
+    if (Begin>=End)
+        return {};
+    return std::vector<item>(Find(Begin), Find(End));
+}
+
+//---------------------------------------------------------------------------
+size_t StatsComments::Next(size_t Pos) const
+{
+    QMutexLocker Locker(&Mutex);
+    if (Pos==None)
+        return None;
+    auto Item=Find(Pos+1);
+    return Item!=Items.end()?Item->first:None;
+}
+
+//---------------------------------------------------------------------------
+size_t StatsComments::Previous(size_t Pos) const
+{
+    QMutexLocker Locker(&Mutex);
+    auto Item=Find(Pos);
+    return Item!=Items.begin()?(Item-1)->first:None;
+}
+
+//***************************************************************************
+// Memory management
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsComments::Discard(size_t Before)
+{
+    QMutexLocker Locker(&Mutex);
+    Items.erase(Items.cbegin(), Find(Before));
+}
+
+//---------------------------------------------------------------------------
+size_t StatsComments::Bytes() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Items.capacity()*sizeof(item);
+}
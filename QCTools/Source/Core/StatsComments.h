@@ -0,0 +1,57 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsComments_H
+#define StatsComments_H
+
+#include <QMutex>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Comments of the frames of a stream (and the events of the detectors, see
+// StatsDetectors), sorted by frame: a file has a few of them, so they are
+// not a column of one pointer per frame and the comments track, the exports
+// and the navigation only walk the frames which have one.
+//
+// Lookups and range queries are binary searches, comments are mostly added
+// in frame order (parsing, reports) so an add is an append. Strings are not
+// copied, they are the ones of the StatsStrings of the stats. Readers of
+// other threads (GUI) lock for the time of the lookup.
+class StatsComments
+{
+public:
+    typedef std::pair<size_t, const char*> item;
+    static const size_t         None=(size_t)-1;
+
+    // Comment of the frame Pos, NULL if none
+    const char*                 operator[]                  (size_t Pos) const;
+    // Comment of the frame Pos, NULL or empty removes it
+    void                        Set                         (size_t Pos, const char* Comment);
+
+    // Count of frames with a comment
+    size_t                      Count                       () const;
+    // Comments of the frames from Begin to End (excluded), by frame
+    std::vector<item>           Range                       (size_t Begin, size_t End=None) const;
+    // First frame with a comment after Pos, last one before Pos, None if none
+    size_t                      Next                        (size_t Pos) const;
+    size_t                      Previous                    (size_t Pos) const;
+
+    // Comments of the frames before Before are removed (e.g. live analysis)
+    void                        Discard                     (size_t Before);
+    // Memory of the index, not the strings
+    size_t                      Bytes                       () const;
+
+private:
+    std::vector<item>::const_iterator Find                  (size_t Pos) const;
+
+    mutable QMutex              Mutex;
+    std::vector<item>           Items;                      // By frame
+};
+
+#endif // StatsComments_H
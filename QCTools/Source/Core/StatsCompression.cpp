@@ -0,0 +1,270 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsCompression.h"
+#include "Core/StatsGzipMembers.h"
+#include "Core/TraceEvents.h"
+//---------------------------------------------------------------------------
+
+#include <QIODevice>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#ifdef QCTOOLS_ZSTD
+#include <zstd.h>
+#endif
+
+//---------------------------------------------------------------------------
+static std::atomic<int> StatsCompression_Format(StatsCompression::Format_Gzip);
+static std::atomic<int> StatsCompression_Level(-1);
+
+static const char* const Format_Names[StatsCompression::Format_Max]=
+{
+    "none",
+    "gzip",
+    "zstd",
+};
+
+static const char* const Format_Extensions[StatsCompression::Format_Max]=
+{
+    ".qctools.xml",
+    ".qctools.xml.gz",
+    ".qctools.xml.zst",
+};
+
+//***************************************************************************
+// Formats
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsCompression::format StatsCompression::Format_FromName(const QString& Name)
+{
+    int Format=0;
+    while (Format<Format_Max && Name!=QLatin1String(Format_Names[Format]))
+        Format++;
+    return (format)Format;
+}
+
+//---------------------------------------------------------------------------
+const char* StatsCompression::Name(format Format)
+{
+    return Format<Format_Max?Format_Names[Format]:"";
+}
+
+//---------------------------------------------------------------------------
+QString StatsCompression::Extension(format Format)
+{
+    return QString::fromLatin1(Format_Extensions[Format<Format_Max?Format:Format_Gzip]);
+}
+
+//---------------------------------------------------------------------------
+StatsCompression::format StatsCompression::Format_FromFileName(const QString& FileName)
+{
+    if (FileName.endsWith(".zst"))
+        return Format_Zstd;
+    if (FileName.endsWith(".xml"))
+        return Format_None;
+    return Format_Gzip;
+}
+
+//---------------------------------------------------------------------------
+StatsCompression::format StatsCompression::Format_Detect(QIODevice& Input)
+{
+    QByteArray Magic=Input.peek(4);
+    const unsigned char* Bytes=(const unsigned char*)Magic.constData();
+    if (Magic.size()>=2 && Bytes[0]==0x1F && Bytes[1]==0x8B)
+        return Format_Gzip;
+    if (Magic.size()>=4 && Bytes[0]==0x28 && Bytes[1]==0xB5 && Bytes[2]==0x2F && Bytes[3]==0xFD)
+        return Format_Zstd;
+    return Format_None;
+}
+
+//---------------------------------------------------------------------------
+QString StatsCompression::Check(format Format)
+{
+    if (Format>=Format_Max)
+        return "unknown format, none, gzip or zstd are accepted";
+#ifndef QCTOOLS_ZSTD
+    if (Format==Format_Zstd)
+        return "zstd is not available in this build";
+#endif
+    return QString();
+}
+
+//***************************************************************************
+// Options
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsCompression::Format_Set(format Format)
+{
+    StatsCompression_Format=Format;
+}
+
+//---------------------------------------------------------------------------
+StatsCompression::format StatsCompression::Format_Get()
+{
+    return (format)StatsCompression_Format.load();
+}
+
+//---------------------------------------------------------------------------
+void StatsCompression::Level_Set(int Level)
+{
+    StatsCompression_Level=Level;
+}
+
+//---------------------------------------------------------------------------
+int StatsCompression::Level_Get()
+{
+    return StatsCompression_Level;
+}
+
+//***************************************************************************
+// Read
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsCompression::Zstd_Decompress(QIODevice& Input, const OutputHandler& Output)
+{
+#ifdef QCTOOLS_ZSTD
+    std::unique_ptr<ZSTD_DCtx, size_t(*)(ZSTD_DCtx*)> Context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+    if (!Context)
+        return false;
+    ZSTD_DCtx_setParameter(Context.get(), ZSTD_d_windowLogMax, 31); // Long distance matching of the exports may use a window above the default limit
+
+    std::string In(ZSTD_DStreamInSize(), '\0');
+    std::string Out(ZSTD_DStreamOutSize(), '\0');
+    size_t Result=0;
+    for (;;)
+    {
+        qint64 ReadSize=Input.read(&In[0], In.size());
+        if (ReadSize<0)
+            return false;
+        if (!ReadSize)
+            break;
+
+        ZSTD_inBuffer InBuffer={In.data(), (size_t)ReadSize, 0};
+        while (InBuffer.pos<InBuffer.size)
+        {
+            ZSTD_outBuffer OutBuffer={&Out[0], Out.size(), 0};
+            Result=ZSTD_decompressStream(Context.get(), &OutBuffer, &InBuffer);
+            if (ZSTD_isError(Result))
+                return false;
+            if (OutBuffer.pos)
+                Output(Out.data(), OutBuffer.pos);
+        }
+    }
+
+    // Data still in the context and frame not complete (truncated file)
+    for (;;)
+    {
+        ZSTD_inBuffer InBuffer={nullptr, 0, 0};
+        ZSTD_outBuffer OutBuffer={&Out[0], Out.size(), 0};
+        Result=ZSTD_decompressStream(Context.get(), &OutBuffer, &InBuffer);
+        if (ZSTD_isError(Result))
+            return false;
+        if (!OutBuffer.pos)
+            break;
+        Output(Out.data(), OutBuffer.pos);
+    }
+    return !Result;
+#else
+    Q_UNUSED(Input)
+    Q_UNUSED(Output)
+    return false;
+#endif
+}
+
+//***************************************************************************
+// Write
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsCompressionWriter::StatsCompressionWriter(QIODevice& Output_, StatsCompression::format Format) :
+    Output(Output_)
+{
+    int Level=StatsCompression::Level_Get();
+    switch (Format)
+    {
+        case StatsCompression::Format_None:
+            break;
+#ifdef QCTOOLS_ZSTD
+        case StatsCompression::Format_Zstd:
+            Zstd=ZSTD_createCCtx();
+            if (!Zstd)
+            {
+                IsOk=false;
+                break;
+            }
+            ZSTD_CCtx_setParameter(Zstd, ZSTD_c_compressionLevel, Level<0?ZSTD_CLEVEL_DEFAULT:std::min(std::max(Level, 1), ZSTD_maxCLevel()));
+            ZSTD_CCtx_setParameter(Zstd, ZSTD_c_enableLongDistanceMatching, 1);
+            ZSTD_CCtx_setParameter(Zstd, ZSTD_c_nbWorkers, QThread::idealThreadCount()); // Ignored if the library is not multithreaded
+            Zstd_Buffer.resize(ZSTD_CStreamOutSize());
+            break;
+#endif
+        default:
+            // zstd not available is reported before the export, gzip is written then
+            Gzip.reset(new StatsGzipMembersWriter(Output, Level));
+    }
+}
+
+//---------------------------------------------------------------------------
+StatsCompressionWriter::~StatsCompressionWriter()
+{
+#ifdef QCTOOLS_ZSTD
+    ZSTD_freeCCtx(Zstd);
+#endif
+}
+
+//---------------------------------------------------------------------------
+bool StatsCompressionWriter::Append(const char* Data, size_t Size)
+{
+    if (!IsOk)
+        return false;
+    TraceEvents::Scope Trace("export", "report chunk", Size);
+    if (Gzip)
+        return IsOk=Gzip->Append(Data, Size);
+    if (Zstd)
+        return IsOk=Zstd_Compress(Data, Size, false);
+    return IsOk=Output.write(Data, Size)==(qint64)Size;
+}
+
+//---------------------------------------------------------------------------
+bool StatsCompressionWriter::Finish()
+{
+    if (!IsOk)
+        return false;
+    if (Gzip)
+        return IsOk=Gzip->Finish();
+    if (Zstd)
+        return IsOk=Zstd_Compress(nullptr, 0, true);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool StatsCompressionWriter::Zstd_Compress(const char* Data, size_t Size, bool IsEnd)
+{
+#ifdef QCTOOLS_ZSTD
+    ZSTD_inBuffer InBuffer={Data, Size, 0};
+    for (;;)
+    {
+        ZSTD_outBuffer OutBuffer={&Zstd_Buffer[0], Zstd_Buffer.size(), 0};
+        size_t Remaining=ZSTD_compressStream2(Zstd, &OutBuffer, &InBuffer, IsEnd?ZSTD_e_end:ZSTD_e_continue);
+        if (ZSTD_isError(Remaining))
+            return false;
+        if (OutBuffer.pos && Output.write(Zstd_Buffer.data(), OutBuffer.pos)!=(qint64)OutBuffer.pos)
+            return false;
+        if (IsEnd?!Remaining:InBuffer.pos==InBuffer.size)
+            return true;
+    }
+#else
+    Q_UNUSED(Data)
+    Q_UNUSED(Size)
+    Q_UNUSED(IsEnd)
+    return false;
+#endif
+}
@@ -0,0 +1,86 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsCompression_H
+#define StatsCompression_H
+
+#include <QString>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+class QIODevice;
+class StatsGzipMembersWriter;
+struct ZSTD_CCtx_s;
+
+//---------------------------------------------------------------------------
+// Compression of the XML reports. On export the format is the one of the
+// file name (.xml.zst, .xml, else gzip), on load the one of the first bytes
+// of the file, whatever its name.
+// - gzip: independently decodable members, see StatsGzipMembers
+// - zstd (qmake CONFIG+=zstd): one stream with long distance matching, the
+//   frame elements of a report are much alike all along the file
+// - none: the XML as it is
+class StatsCompression
+{
+public:
+    enum format
+    {
+        Format_None,
+        Format_Gzip,
+        Format_Zstd,
+        Format_Max
+    };
+
+    typedef std::function<void(const char* Data, size_t Size)> OutputHandler;
+
+    // "none", "gzip" or "zstd"; Format_Max if unknown
+    static format               Format_FromName             (const QString& Name);
+    static const char*          Name                        (format Format);
+    // Report extension, e.g. ".qctools.xml.zst"
+    static QString              Extension                   (format Format);
+    static format               Format_FromFileName         (const QString& FileName);
+    // From the magic bytes, the device is not moved
+    static format               Format_Detect               (QIODevice& Input);
+    // Empty if the format can be written and read by this build, else the reason
+    static QString              Check                       (format Format);
+
+    // Format of the reports named by default (<file>.qctools.xml.gz...) and level of the exports,
+    // -1 for the default of the format else clamped to its levels (gzip 0 to 9, zstd 1 to 22)
+    static void                 Format_Set                  (format Format);
+    static format               Format_Get                  ();
+    static void                 Level_Set                   (int Level);
+    static int                  Level_Get                   ();
+
+    // zstd frames from the current position, uncompressed data is sent to Output in file order
+    static bool                 Zstd_Decompress             (QIODevice& Input, const OutputHandler& Output);
+};
+
+//---------------------------------------------------------------------------
+// Write side, XML is appended as it is generated and written compressed with
+// the level set, see StatsCompression::Level_Set
+class StatsCompressionWriter
+{
+public:
+                                StatsCompressionWriter      (QIODevice& Output, StatsCompression::format Format);
+                                ~StatsCompressionWriter     ();
+
+    bool                        Append                      (const char* Data, size_t Size);
+    bool                        Finish                      ();
+
+private:
+    bool                        Zstd_Compress               (const char* Data, size_t Size, bool IsEnd);
+
+    QIODevice&                  Output;
+    std::unique_ptr<StatsGzipMembersWriter> Gzip;
+    ZSTD_CCtx_s*                Zstd {nullptr};
+    std::string                 Zstd_Buffer;
+    bool                        IsOk {true};
+};
+
+#endif // StatsCompression_H
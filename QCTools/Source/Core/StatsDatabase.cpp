@@ -0,0 +1,503 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsDatabase.h"
+#include "Core/CommonStats.h"
+#include "Core/VideoStats.h"
+#include "Core/VideoCore.h"
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QVariant>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <string>
+
+//---------------------------------------------------------------------------
+static const int        Database_Version=1;
+static const int        Run_Seconds[]={1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 15, 20, 30, 45, 60, 90, 120, 180, 300, 600, 900, 1200, 1800, 2700, 3600};
+static std::atomic<int> Connections(0);
+
+static const char* const Database_Schema[]=
+{
+    "CREATE TABLE IF NOT EXISTS info (name TEXT PRIMARY KEY, value TEXT)",
+    "CREATE TABLE IF NOT EXISTS reports (id INTEGER PRIMARY KEY, report TEXT UNIQUE NOT NULL, media TEXT, duration REAL, indexed TEXT)",
+    "CREATE TABLE IF NOT EXISTS keys (key TEXT PRIMARY KEY)",
+    "CREATE TABLE IF NOT EXISTS metrics (report_id INTEGER NOT NULL, stream_index INTEGER, media_type TEXT, key TEXT NOT NULL, frames INTEGER, min REAL, max REAL, mean REAL)",
+    "CREATE INDEX IF NOT EXISTS metrics_report ON metrics (report_id)",
+    "CREATE INDEX IF NOT EXISTS metrics_max ON metrics (key, max)",
+    "CREATE INDEX IF NOT EXISTS metrics_min ON metrics (key, min)",
+    "CREATE TABLE IF NOT EXISTS runs (report_id INTEGER NOT NULL, stream_index INTEGER, key TEXT NOT NULL, seconds INTEGER, above REAL, below REAL)",
+    "CREATE INDEX IF NOT EXISTS runs_report ON runs (report_id)",
+    "CREATE INDEX IF NOT EXISTS runs_above ON runs (key, seconds, above)",
+    "CREATE INDEX IF NOT EXISTS runs_below ON runs (key, seconds, below)",
+    "CREATE TABLE IF NOT EXISTS violations (report_id INTEGER NOT NULL, stream_index INTEGER, filter TEXT, key TEXT, reason TEXT, start_time REAL, end_time REAL, duration REAL, peak REAL)",
+    "CREATE INDEX IF NOT EXISTS violations_report ON violations (report_id)",
+    "CREATE INDEX IF NOT EXISTS violations_key ON violations (key, duration)",
+};
+
+//***************************************************************************
+// Helpers
+//***************************************************************************
+
+namespace
+{
+//---------------------------------------------------------------------------
+bool Fail(QString* Error, const QString& Text)
+{
+    if (Error)
+        *Error=Text;
+    return false;
+}
+
+//---------------------------------------------------------------------------
+// Values of one second of the time line
+struct window
+{
+    int64_t                     Index;
+    double                      Min;
+    double                      Max;
+};
+
+//---------------------------------------------------------------------------
+struct metric
+{
+    std::string                 Key;
+    size_t                      Frames=0;
+    double                      Min=0;
+    double                      Max=0;
+    double                      Sum=0;
+    std::vector<window>         Windows;                    // In time order
+
+    void Add(double Time, double Value)
+    {
+        // Frames without a finite value are skipped, as by the thresholds
+        if (!std::isfinite(Value) || !std::isfinite(Time))
+            return;
+        if (!Frames || Value<Min)
+            Min=Value;
+        if (!Frames || Value>Max)
+            Max=Value;
+        Sum+=Value;
+        Frames++;
+
+        int64_t Index=(int64_t)std::floor(Time);
+        if (Windows.empty() || Windows.back().Index!=Index)
+            Windows.push_back({Index, Value, Value});
+        else
+        {
+            Windows.back().Min=std::min(Windows.back().Min, Value);
+            Windows.back().Max=std::max(Windows.back().Max, Value);
+        }
+    }
+};
+
+//---------------------------------------------------------------------------
+// Highest minimum (Above) or lowest maximum of Length consecutive windows, false if no run is that long
+bool Run_Bound(const std::vector<window>& Windows, size_t Length, bool Above, double& Bound)
+{
+    auto Value=[&](size_t Pos) {return Above?Windows[Pos].Min:Windows[Pos].Max;};
+    auto IsWorse=[&](double A, double B) {return Above?A<=B:A>=B;};
+
+    // Positions of the worst values of the last Length windows, the worst first
+    std::deque<size_t> Candidates;
+    size_t Begin=0;
+    bool Found=false;
+    for (size_t Pos=0; Pos<Windows.size(); Pos++)
+    {
+        // Gaps (frames not analyzed) stop the runs
+        if (Pos && Windows[Pos].Index!=Windows[Pos-1].Index+1)
+        {
+            Begin=Pos;
+            Candidates.clear();
+        }
+        while (!Candidates.empty() && IsWorse(Value(Pos), Value(Candidates.back())))
+            Candidates.pop_back();
+        Candidates.push_back(Pos);
+        if (Candidates.front()+Length<=Pos)
+            Candidates.pop_front();
+
+        if (Pos+1-Begin>=Length)
+        {
+            double Worst=Value(Candidates.front());
+            if (!Found || !IsWorse(Worst, Bound))
+                Bound=Worst;
+            Found=true;
+        }
+    }
+    return Found;
+}
+
+//---------------------------------------------------------------------------
+QString Like_Escape(const QString& Value)
+{
+    QString Escaped=Value;
+    Escaped.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    return Escaped;
+}
+}
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsDatabase::StatsDatabase()
+{
+}
+
+//---------------------------------------------------------------------------
+StatsDatabase::~StatsDatabase()
+{
+    if (Connection.isEmpty())
+        return;
+    {
+        QSqlDatabase Database=QSqlDatabase::database(Connection, false);
+        Database.close();
+    }
+    QSqlDatabase::removeDatabase(Connection);
+}
+
+//***************************************************************************
+// Open
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsDatabase::Open(const QString& FileName, QString* Error)
+{
+    if (!Connection.isEmpty())
+        return Fail(Error, "database already open");
+    Connection=QString("StatsDatabase%1").arg(Connections++);
+    QSqlDatabase Database=QSqlDatabase::addDatabase("QSQLITE", Connection);
+    if (!Database.isValid())
+        return Fail(Error, "the SQLite driver of Qt is not available");
+
+    // Other processes may write at the same time
+    Database.setDatabaseName(FileName);
+    Database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=60000");
+    if (!Database.open())
+        return Fail(Error, Database.lastError().text());
+
+    QSqlQuery Query(Database);
+    Query.exec("PRAGMA journal_mode=WAL");
+    Query.exec("PRAGMA synchronous=NORMAL");
+    for (auto Statement : Database_Schema)
+        if (!Query.exec(Statement))
+            return Fail(Error, Query.lastError().text());
+
+    // Databases of later versions are not modified
+    Query.exec(QString("INSERT OR IGNORE INTO info (name, value) VALUES ('version', '%1')").arg(Database_Version));
+    if (!Query.exec("SELECT value FROM info WHERE name='version'") || !Query.next())
+        return Fail(Error, Query.lastError().text());
+    if (Query.value(0).toInt()>Database_Version)
+        return Fail(Error, "the database is from a later version");
+
+    return true;
+}
+
+//***************************************************************************
+// Add
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsDatabase::Add(const QString& ReportFileName, const QString& MediaFileName, const std::vector<CommonStats*>& Stats, const activefilters& Filters, const QByteArray& Violations, QString* Error)
+{
+    QSqlDatabase Database=QSqlDatabase::database(Connection, false);
+    if (!Database.isOpen())
+        return Fail(Error, "database not open");
+
+    // Summaries of all the streams first, not while the database is locked
+    struct stream_metrics
+    {
+        int                     StreamIndex;
+        const char*             MediaType;
+        std::vector<metric>     Metrics;
+    };
+    std::vector<stream_metrics> Streams;
+    double Duration=0;
+    for (auto Stat : Stats)
+    {
+        if (!Stat)
+            continue;
+        CommonStats& S=*Stat;
+        S.Items_Load();
+        QMutexLocker Lock(&S.Mutex);
+
+        auto Video=dynamic_cast<VideoStats*>(Stat);
+        int Width=Video?Video->getWidth():0;
+        int Height=Video?Video->getHeight():0;
+        size_t FramesCount=S.x_Current;
+        if (FramesCount)
+            Duration=std::max(Duration, S.x[1][FramesCount-1]+S.durations[FramesCount-1]);
+
+        Streams.push_back({S.streamIndex, Video?"video":"audio", {}});
+        auto& Metrics=Streams.back().Metrics;
+
+        // Items, as in the XML report
+        for (size_t Plot_Pos=0; Plot_Pos<S.CountOfItems; Plot_Pos++)
+        {
+            const activefilter filter=S.PerItem[Plot_Pos].Filter;
+            if (filter==activefilter(-1) || !Filters.test(filter) || !S.Item_IsUsed(Plot_Pos))
+                continue;
+
+            const StatsValueColumn& Values=S.y[Plot_Pos];
+            bool IsCropWidth=Video && (Plot_Pos==Item_Crop_x2 || Plot_Pos==Item_Crop_w);
+            bool IsCropHeight=Video && (Plot_Pos==Item_Crop_y2 || Plot_Pos==Item_Crop_h);
+            double Size=IsCropWidth?Width:Height;
+            Metrics.emplace_back();
+            Metrics.back().Key=S.PerItem[Plot_Pos].FFmpeg_Name;
+            for (size_t Pos=0; Pos<FramesCount; Pos++)
+                Metrics.back().Add(S.x[1][Pos], (IsCropWidth || IsCropHeight)?Size-Values[Pos]:Values[Pos]);
+        }
+
+        // Additional stats
+        for (const auto& Key : S.statsKeysByIndexByValueType[CommonStats::StatsValueInfo::Int])
+            if ((size_t)Key.first<S.additionalIntStats.size())
+            {
+                Metrics.emplace_back();
+                Metrics.back().Key=Key.second;
+                for (size_t Pos=0; Pos<FramesCount; Pos++)
+                    Metrics.back().Add(S.x[1][Pos], S.additionalIntStats[Key.first][Pos]);
+            }
+        for (const auto& Key : S.statsKeysByIndexByValueType[CommonStats::StatsValueInfo::Double])
+            if ((size_t)Key.first<S.additionalDoubleStats.size())
+            {
+                Metrics.emplace_back();
+                Metrics.back().Key=Key.second;
+                for (size_t Pos=0; Pos<FramesCount; Pos++)
+                    Metrics.back().Add(S.x[1][Pos], S.additionalDoubleStats[Key.first][Pos]);
+            }
+    }
+
+    // One transaction per report, the previous rows of the report are replaced
+    if (!Database.transaction())
+        return Fail(Error, Database.lastError().text());
+    QSqlQuery Query(Database);
+    auto Exec=[&](QSqlQuery& Statement) {
+        if (Statement.exec())
+            return true;
+        Fail(Error, Statement.lastError().text());
+        Database.rollback();
+        return false;
+    };
+
+    Query.prepare("SELECT id FROM reports WHERE report=?");
+    Query.addBindValue(ReportFileName);
+    if (!Exec(Query))
+        return false;
+    if (Query.next())
+    {
+        QVariant Id=Query.value(0);
+        for (auto Table : {"metrics", "runs", "violations"})
+        {
+            Query.prepare(QString("DELETE FROM %1 WHERE report_id=?").arg(Table));
+            Query.addBindValue(Id);
+            if (!Exec(Query))
+                return false;
+        }
+        Query.prepare("DELETE FROM reports WHERE id=?");
+        Query.addBindValue(Id);
+        if (!Exec(Query))
+            return false;
+    }
+
+    Query.prepare("INSERT INTO reports (report, media, duration, indexed) VALUES (?, ?, ?, ?)");
+    Query.addBindValue(ReportFileName);
+    Query.addBindValue(MediaFileName);
+    Query.addBindValue(Duration);
+    Query.addBindValue(QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    if (!Exec(Query))
+        return false;
+    QVariant Report_Id=Query.lastInsertId();
+
+    QSqlQuery Keys(Database);
+    Keys.prepare("INSERT OR IGNORE INTO keys (key) VALUES (?)");
+    QSqlQuery Metrics(Database);
+    Metrics.prepare("INSERT INTO metrics (report_id, stream_index, media_type, key, frames, min, max, mean) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    QSqlQuery Runs(Database);
+    Runs.prepare("INSERT INTO runs (report_id, stream_index, key, seconds, above, below) VALUES (?, ?, ?, ?, ?, ?)");
+    for (const auto& Stream : Streams)
+        for (const auto& Metric : Stream.Metrics)
+        {
+            if (!Metric.Frames)
+                continue;
+            QString Key=QString::fromStdString(Metric.Key);
+
+            Keys.addBindValue(Key);
+            if (!Exec(Keys))
+                return false;
+
+            Metrics.addBindValue(Report_Id);
+            Metrics.addBindValue(Stream.StreamIndex);
+            Metrics.addBindValue(Stream.MediaType);
+            Metrics.addBindValue(Key);
+            Metrics.addBindValue((qulonglong)Metric.Frames);
+            Metrics.addBindValue(Metric.Min);
+            Metrics.addBindValue(Metric.Max);
+            Metrics.addBindValue(Metric.Sum/Metric.Frames);
+            if (!Exec(Metrics))
+                return false;
+
+            for (auto Seconds : Run_Seconds)
+            {
+                double Above, Below;
+                if (!Run_Bound(Metric.Windows, Seconds, true, Above) || !Run_Bound(Metric.Windows, Seconds, false, Below))
+                    break;
+                Runs.addBindValue(Report_Id);
+                Runs.addBindValue(Stream.StreamIndex);
+                Runs.addBindValue(Key);
+                Runs.addBindValue(Seconds);
+                Runs.addBindValue(Above);
+                Runs.addBindValue(Below);
+                if (!Exec(Runs))
+                    return false;
+            }
+        }
+
+    // Violations, streams are the positions in the stats
+    if (!Violations.isEmpty())
+    {
+        QSqlQuery Insert(Database);
+        Insert.prepare("INSERT INTO violations (report_id, stream_index, filter, key, reason, start_time, end_time, duration, peak) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        const auto List=QJsonDocument::fromJson(Violations).object().value("violations").toArray();
+        for (const auto& Item : List)
+        {
+            auto Violation=Item.toObject();
+            size_t Stream=(size_t)Violation.value("stream").toInt();
+            Insert.addBindValue(Report_Id);
+            Insert.addBindValue(Stream<Stats.size() && Stats[Stream]?QVariant(Stats[Stream]->streamIndex):QVariant());
+            Insert.addBindValue(Violation.value("filter").toString());
+            Insert.addBindValue(Violation.value("metric_key").toString());
+            Insert.addBindValue(Violation.value("reason").toString());
+            Insert.addBindValue(Violation.value("start_time").toDouble());
+            Insert.addBindValue(Violation.value("end_time").toDouble());
+            Insert.addBindValue(Violation.value("duration").toDouble());
+            Insert.addBindValue(Violation.value("peak").toDouble());
+            if (!Exec(Insert))
+                return false;
+        }
+    }
+
+    if (!Database.commit())
+    {
+        Fail(Error, Database.lastError().text());
+        Database.rollback();
+        return false;
+    }
+    return true;
+}
+
+//***************************************************************************
+// Query
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsDatabase::Query(const QString& Expression, std::vector<match>& Matches, QString* Error)
+{
+    QSqlDatabase Database=QSqlDatabase::database(Connection, false);
+    if (!Database.isOpen())
+        return Fail(Error, "database not open");
+
+    static const QRegularExpression Syntax("^\\s*(\\S+?)\\s*(>=|<=|>|<)\\s*(\\S+)(?:\\s+for\\s+(\\S+?)s?)?\\s*$", QRegularExpression::CaseInsensitiveOption);
+    auto Parts=Syntax.match(Expression);
+    bool IsOk=Parts.hasMatch();
+    double Value=IsOk?Parts.captured(3).toDouble(&IsOk):0;
+    if (!IsOk)
+        return Fail(Error, "the query must be <metric> <op> <value> [for <seconds>]");
+    QString Name=Parts.captured(1);
+    QString Operator=Parts.captured(2);
+    bool Above=Operator.startsWith('>');
+
+    // Shortest run indexed at least as long as the one requested
+    int Seconds=0;
+    if (!Parts.captured(4).isEmpty())
+    {
+        double Requested=Parts.captured(4).toDouble(&IsOk);
+        if (!IsOk || Requested<=0)
+            return Fail(Error, "the duration must be a count of seconds");
+        for (auto Run : Run_Seconds)
+            if (Run>=Requested)
+            {
+                Seconds=Run;
+                break;
+            }
+        if (!Seconds)
+            return Fail(Error, QString("runs longer than %1 seconds are not indexed").arg(Run_Seconds[sizeof(Run_Seconds)/sizeof(*Run_Seconds)-1]));
+    }
+
+    // Metrics named Name or ending with .Name
+    QSqlQuery Query(Database);
+    Query.prepare("SELECT key FROM keys WHERE key=? OR key LIKE ? ESCAPE '\\'");
+    Query.addBindValue(Name);
+    Query.addBindValue("%."+Like_Escape(Name));
+    if (!Query.exec())
+        return Fail(Error, Query.lastError().text());
+    QStringList Keys;
+    while (Query.next())
+        Keys.append(Query.value(0).toString());
+
+    // Any frame if no duration, else the bounds of the runs
+    QString Column=Seconds?(Above?"runs.above":"runs.below"):(Above?"metrics.max":"metrics.min");
+    QString Table=Seconds?"runs":"metrics";
+    for (const auto& Key : Keys)
+    {
+        Query.prepare("SELECT reports.report, reports.media, "+Table+".stream_index, "+Column+" FROM "+Table+" JOIN reports ON reports.id="+Table+".report_id"
+                      " WHERE "+Table+".key=?"+(Seconds?" AND runs.seconds=?":"")+" AND "+Column+Operator+"?"
+                      " ORDER BY "+Column+(Above?" DESC":" ASC"));
+        Query.addBindValue(Key);
+        if (Seconds)
+            Query.addBindValue(Seconds);
+        Query.addBindValue(Value);
+        if (!Query.exec())
+            return Fail(Error, Query.lastError().text());
+        while (Query.next())
+            Matches.push_back({Query.value(0).toString(), Query.value(1).toString(), Query.value(2).toInt(), Key, Query.value(3).toDouble()});
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+bool StatsDatabase::Sql(const QString& Statement, const std::function<void(const QStringList& Values)>& Row, QString* Error)
+{
+    QSqlDatabase Database=QSqlDatabase::database(Connection, false);
+    if (!Database.isOpen())
+        return Fail(Error, "database not open");
+
+    QSqlQuery Query(Database);
+    Query.setForwardOnly(true);
+    if (!Query.exec(Statement))
+        return Fail(Error, Query.lastError().text());
+    if (!Query.isSelect())
+        return true;
+
+    QSqlRecord Record=Query.record();
+    QStringList Names;
+    for (int Pos=0; Pos<Record.count(); Pos++)
+        Names.append(Record.fieldName(Pos));
+    Row(Names);
+    while (Query.next())
+    {
+        QStringList Values;
+        for (int Pos=0; Pos<Record.count(); Pos++)
+            Values.append(Query.value(Pos).toString());
+        Row(Values);
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsDatabase_H
+#define StatsDatabase_H
+
+#include "Core/Core.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <vector>
+
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// SQLite database of the summaries of many reports, for finding the files
+// matching a condition without opening their reports.
+//
+// Per report and metric (FFmpeg name of an item or additional stat, value as
+// in the XML report): frames, minimum, maximum and mean ("metrics"), and the
+// bounds of the longest runs ("runs"): for a count of seconds, the highest
+// value all the frames of that many consecutive seconds of the time line are
+// above ("above") and the lowest one they are below ("below"), so
+// "BRNG > 0.1 for 10" is one indexed lookup. Run lengths are rounded up to
+// 1 to 10, 15, 20, 30, 45 seconds, then 1, 1.5, 2, 3, 5, 10, 15, 20, 30, 45
+// and 60 minutes. Violations of a thresholds preset (see StatsThresholds)
+// are in "violations".
+//
+// Several processes may add reports at the same time (write-ahead log).
+// One thread per instance.
+class StatsDatabase
+{
+public:
+                                StatsDatabase               ();
+                                ~StatsDatabase              ();
+
+    // Created if it does not exist
+    bool                        Open                        (const QString& FileName, QString* Error=nullptr);
+
+    // Summaries of the stats of a report, the previous ones of the report are replaced
+    // Violations is the JSON of StatsThresholds::Json, none if empty
+    bool                        Add                         (const QString& ReportFileName, const QString& MediaFileName, const std::vector<CommonStats*>& Stats, const activefilters& Filters, const QByteArray& Violations=QByteArray(), QString* Error=nullptr);
+
+    // "<metric> <op> <value> [for <seconds>]", op is >, >=, < or <=, metric is its FFmpeg name or its last part
+    // (BRNG), without seconds any frame matches
+    struct match
+    {
+        QString                 ReportFileName;
+        QString                 MediaFileName;
+        int                     StreamIndex;
+        QString                 Key;
+        double                  Value;                      // Peak, or bound of the run
+    };
+    bool                        Query                       (const QString& Expression, std::vector<match>& Matches, QString* Error=nullptr);
+
+    // Other queries, first row is the names of the columns
+    bool                        Sql                         (const QString& Statement, const std::function<void(const QStringList& Values)>& Row, QString* Error=nullptr);
+
+private:
+    QString                     Connection;
+};
+
+#endif // StatsDatabase_H
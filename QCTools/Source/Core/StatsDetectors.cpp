@@ -0,0 +1,401 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsDetectors.h"
+#include "Core/Core.h"
+#include "Core/StatsColumn.h"
+#include "Core/StatsKeyIndex.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <sstream>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+//***************************************************************************
+// Parameters
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Parameters_Check(const StatsDetectors::parameters& Parameters, std::initializer_list<const char*> Names, QString* Error)
+{
+    for (const auto& Parameter : Parameters)
+    {
+        bool IsKnown=false;
+        for (auto Name : Names)
+            if (Parameter.first==Name)
+                IsKnown=true;
+        if (!IsKnown)
+        {
+            if (Error)
+                *Error=QString("unknown parameter %1").arg(QString::fromStdString(Parameter.first));
+            return false;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+double Parameter(const StatsDetectors::parameters& Parameters, const char* Name, double Default)
+{
+    auto Parameter=Parameters.find(Name);
+    return Parameter==Parameters.end()?Default:Parameter->second;
+}
+
+//***************************************************************************
+// Methods
+//***************************************************************************
+
+const double NoEvent=std::numeric_limits<double>::quiet_NaN();
+
+//---------------------------------------------------------------------------
+// Exponentially weighted mean and variance
+struct ewma
+{
+    double                      Alpha;
+    size_t                      Warmup;
+    double                      Mean=0;
+    double                      Variance=0;
+    size_t                      Count=0;
+
+    bool                        IsReady() const {return Count>=Warmup;}
+
+    // Distance to the mean in standard deviations, before Update()
+    double                      Score(double Value) const
+    {
+        double Deviation=std::sqrt(Variance);
+        if (Deviation>0)
+            return (Value-Mean)/Deviation;
+        return Value==Mean?0:(Value>Mean?std::numeric_limits<double>::infinity():-std::numeric_limits<double>::infinity());
+    }
+
+    void                        Update(double Value)
+    {
+        if (!Count)
+            Mean=Value;
+        double Delta=Value-Mean;
+        Mean+=Alpha*Delta;
+        Variance=(1-Alpha)*(Variance+Alpha*Delta*Delta);
+        Count++;
+    }
+};
+
+//---------------------------------------------------------------------------
+class zscore : public StatsDetector
+{
+public:
+    zscore(double Alpha, size_t Warmup, double K_) : Baseline{Alpha, Warmup}, K(K_) {}
+
+    double Add(double Value) override
+    {
+        double Result=NoEvent;
+        if (Baseline.IsReady())
+        {
+            double Score=Baseline.Score(Value);
+            bool IsOut=std::fabs(Score)>K;
+            if (IsOut && !InEvent)
+                Result=Score;
+            InEvent=IsOut;
+        }
+        Baseline.Update(Value);
+        return Result;
+    }
+
+private:
+    ewma                        Baseline;
+    double                      K;
+    bool                        InEvent=false;
+};
+
+//---------------------------------------------------------------------------
+class cusum : public StatsDetector
+{
+public:
+    cusum(double Alpha, size_t Warmup, double Slack_, double H_) : Baseline{Alpha, Warmup}, Slack(Slack_), H(H_) {}
+
+    double Add(double Value) override
+    {
+        double Result=NoEvent;
+        if (Baseline.IsReady())
+        {
+            // Infinite scores (constant values until now) count as a full threshold
+            double Score=Baseline.Score(Value);
+            if (std::isinf(Score))
+                Score=Score>0?H+Slack:-H-Slack;
+            High=std::max(0.0, High+Score-Slack);
+            Low=std::max(0.0, Low-Score-Slack);
+            if (High>H || Low>H)
+            {
+                Result=High>H?High:-Low;
+                High=0;
+                Low=0;
+            }
+        }
+        Baseline.Update(Value);
+        return Result;
+    }
+
+private:
+    ewma                        Baseline;
+    double                      Slack;
+    double                      H;
+    double                      High=0;
+    double                      Low=0;
+};
+
+//---------------------------------------------------------------------------
+class jump : public StatsDetector
+{
+public:
+    jump(double Delta_) : Delta(Delta_) {}
+
+    double Add(double Value) override
+    {
+        double Result=NoEvent;
+        if (HasPrevious && std::fabs(Value-Previous)>Delta)
+            Result=Value-Previous;
+        Previous=Value;
+        HasPrevious=true;
+        return Result;
+    }
+
+private:
+    double                      Delta;
+    double                      Previous=0;
+    bool                        HasPrevious=false;
+};
+
+//---------------------------------------------------------------------------
+class flip : public StatsDetector
+{
+public:
+    flip(double Level_) : Level(Level_) {}
+
+    double Add(double Value) override
+    {
+        int NewSign=Value>Level?1:(Value<-Level?-1:Sign);
+        double Result=(Sign && NewSign && NewSign!=Sign)?Value:NoEvent;
+        Sign=NewSign;
+        return Result;
+    }
+
+private:
+    double                      Level;
+    int                         Sign=0;                     // Side of the last value out of -Level to Level
+};
+
+//***************************************************************************
+// Registry
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+struct spec
+{
+    std::string                 Key;
+    std::string                 Method;
+    StatsDetectors::parameters  Parameters;
+};
+
+struct registry
+{
+    QMutex                      Mutex;
+    std::map<std::string, StatsDetectors::factory> Factories;
+    std::vector<spec>           Specs;
+
+    // Events
+    std::deque<StatsDetectors::event> Events;
+    size_t                      Dropped=0;
+
+    registry()
+    {
+        Factories["zscore"]=[](const StatsDetectors::parameters& Parameters, QString* Error) -> StatsDetector* {
+            if (!Parameters_Check(Parameters, {"k", "alpha", "warmup"}, Error))
+                return nullptr;
+            return new zscore(Parameter(Parameters, "alpha", 0.05), (size_t)Parameter(Parameters, "warmup", 30), Parameter(Parameters, "k", 4));
+        };
+        Factories["cusum"]=[](const StatsDetectors::parameters& Parameters, QString* Error) -> StatsDetector* {
+            if (!Parameters_Check(Parameters, {"h", "slack", "alpha", "warmup"}, Error))
+                return nullptr;
+            return new cusum(Parameter(Parameters, "alpha", 0.05), (size_t)Parameter(Parameters, "warmup", 30), Parameter(Parameters, "slack", 0.5), Parameter(Parameters, "h", 8));
+        };
+        Factories["jump"]=[](const StatsDetectors::parameters& Parameters, QString* Error) -> StatsDetector* {
+            if (!Parameters_Check(Parameters, {"delta"}, Error))
+                return nullptr;
+            if (!Parameters.count("delta"))
+            {
+                if (Error)
+                    *Error="jump needs delta";
+                return nullptr;
+            }
+            return new jump(Parameter(Parameters, "delta", 0));
+        };
+        Factories["flip"]=[](const StatsDetectors::parameters& Parameters, QString* Error) -> StatsDetector* {
+            if (!Parameters_Check(Parameters, {"level"}, Error))
+                return nullptr;
+            return new flip(Parameter(Parameters, "level", 0.5));
+        };
+    }
+};
+
+registry& Registry()
+{
+    static registry Result;
+    return Result;
+}
+
+}
+
+//***************************************************************************
+// Configuration
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsDetectors::Register(const std::string& Method, const factory& Factory)
+{
+    registry& R=Registry();
+    QMutexLocker Lock(&R.Mutex);
+    R.Factories[Method]=Factory;
+}
+
+//---------------------------------------------------------------------------
+bool StatsDetectors::Set(const QStringList& Specs, QString* Error)
+{
+    registry& R=Registry();
+    QMutexLocker Lock(&R.Mutex);
+
+    std::vector<spec> Result;
+    for (const auto& Text : Specs)
+    {
+        auto Parts=Text.split(':');
+        if (Parts.size()<2)
+        {
+            if (Error)
+                *Error=QString("%1: <FFmpeg name>:<method>[:<name>=<value>...] expected").arg(Text);
+            return false;
+        }
+
+        spec Spec;
+        Spec.Key=Parts[0].toStdString();
+        Spec.Method=Parts[1].toStdString();
+        if (StatsKeyIndex::Video().Find(Spec.Key.c_str())==StatsKeyIndex::NotFound && StatsKeyIndex::Audio().Find(Spec.Key.c_str())==StatsKeyIndex::NotFound)
+        {
+            if (Error)
+                *Error=QString("%1: unknown value %2").arg(Text).arg(Parts[0]);
+            return false;
+        }
+        for (int Pos=2; Pos<Parts.size(); Pos++)
+        {
+            auto Parameter=Parts[Pos].split('=');
+            bool IsOk=Parameter.size()==2;
+            double Value=IsOk?Parameter[1].toDouble(&IsOk):0;
+            if (!IsOk)
+            {
+                if (Error)
+                    *Error=QString("%1: %2 is not <name>=<value>").arg(Text).arg(Parts[Pos]);
+                return false;
+            }
+            Spec.Parameters[Parameter[0].toStdString()]=Value;
+        }
+
+        // Checked by the factory once
+        auto Factory=R.Factories.find(Spec.Method);
+        QString FactoryError;
+        std::unique_ptr<StatsDetector> Detector(Factory==R.Factories.end()?nullptr:Factory->second(Spec.Parameters, &FactoryError));
+        if (!Detector)
+        {
+            if (Error)
+                *Error=QString("%1: %2").arg(Text).arg(Factory==R.Factories.end()?QString("unknown method %1").arg(Parts[1]):FactoryError);
+            return false;
+        }
+        Result.push_back(Spec);
+    }
+
+    R.Specs=Result;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+std::unique_ptr<StatsDetectors> StatsDetectors::Create(const struct per_item* PerItem, size_t CountOfItems, const StatsKeyIndex& ItemsIndex)
+{
+    registry& R=Registry();
+    QMutexLocker Lock(&R.Mutex);
+
+    std::unique_ptr<StatsDetectors> Result;
+    for (const auto& Spec : R.Specs)
+    {
+        size_t Item=ItemsIndex.Find(Spec.Key.c_str());
+        if (Item>=CountOfItems)
+            continue; // Item of the other stream type
+
+        if (!Result)
+        {
+            Result.reset(new StatsDetectors);
+            Result->PerItem=PerItem;
+        }
+        Result->Detectors.push_back(detector{Item, Spec.Method, std::unique_ptr<StatsDetector>(R.Factories[Spec.Method](Spec.Parameters, nullptr))});
+    }
+    return Result;
+}
+
+//***************************************************************************
+// Detection
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsDetectors::Add(const StatsValueColumn* y, size_t Pos, int StreamIndex, double Time, std::string& Comment)
+{
+    std::vector<event> Events;
+    for (auto& Detector : Detectors)
+    {
+        double Value=y[Detector.Item][Pos];
+        if (!std::isfinite(Value))
+            continue;
+        double Score=Detector.Detector->Add(Value);
+        if (std::isnan(Score))
+            continue;
+
+        const char* Key=PerItem[Detector.Item].FFmpeg_Name;
+        std::stringstream Text;
+        Text<<"Detected "<<Detector.Method<<" on "<<PerItem[Detector.Item].Name<<" ("<<Key<<"): value "<<Value<<", score "<<Score;
+        if (!Comment.empty())
+            Comment+="; ";
+        Comment+=Text.str();
+        Events.push_back(event{StreamIndex, Pos, Time, Key, Detector.Method, Value, Score});
+    }
+    if (Events.empty())
+        return false;
+
+    registry& R=Registry();
+    QMutexLocker Lock(&R.Mutex);
+    for (auto& Event : Events)
+        R.Events.push_back(std::move(Event));
+    while (R.Events.size()>Events_Max)
+    {
+        R.Events.pop_front();
+        R.Dropped++;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+std::vector<StatsDetectors::event> StatsDetectors::Events_Take(size_t* Dropped)
+{
+    registry& R=Registry();
+    QMutexLocker Lock(&R.Mutex);
+
+    std::vector<event> Result(std::make_move_iterator(R.Events.begin()), std::make_move_iterator(R.Events.end()));
+    R.Events.clear();
+    if (Dropped)
+        *Dropped=R.Dropped;
+    R.Dropped=0;
+    return Result;
+}
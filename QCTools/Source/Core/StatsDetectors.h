@@ -0,0 +1,98 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsDetectors_H
+#define StatsDetectors_H
+
+#include <QString>
+#include <QStringList>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct per_item;
+class StatsKeyIndex;
+class StatsValueColumn;
+
+//---------------------------------------------------------------------------
+// Detector of sudden changes of the values of an item, fed with the value of
+// each frame while it is parsed, in constant memory. Add() returns the score
+// of the event starting at this frame, NaN if none (an event lasting several
+// frames is reported once).
+class StatsDetector
+{
+public:
+    virtual                     ~StatsDetector              () {}
+
+    virtual double              Add                         (double Value) = 0;
+};
+
+//---------------------------------------------------------------------------
+// Detectors of the items of a stream, beyond the fixed thresholds (dropouts,
+// luma jumps, audio phase flips, loudness spikes), run by CommonStats on the
+// frames parsed from the media (not on the frames of a report).
+//
+// They are set before the parsing as "<FFmpeg name>:<method>[:<name>=<value>...]":
+// - zscore: value more than k (4) standard deviations from the exponentially
+//   weighted mean and variance (weight alpha, 0.05), after warmup (30) frames
+// - cusum: two-sided CUSUM of the values standardized as with zscore, slack
+//   (0.5) and threshold h (8), restarted after each event
+// - jump: difference with the value of the previous frame more than delta
+// - flip: value going from more than level (0.5) to less than -level, or the
+//   reverse
+// Other methods may be registered. Infinite and NaN values are skipped.
+//
+// Events mark the comment of their frame, so they are in the comments track
+// and in the reports, and are queued for live reporting.
+class StatsDetectors
+{
+public:
+    typedef std::map<std::string, double> parameters;
+    typedef std::function<StatsDetector*(const parameters& Parameters, QString* Error)> factory;
+
+    // Method available in the specs afterwards, Error set by the factory if the parameters are invalid
+    static void                 Register                    (const std::string& Method, const factory& Factory);
+
+    // Detectors of the stats created afterwards, none if empty; Error is set if a spec is invalid
+    static bool                 Set                         (const QStringList& Specs, QString* Error=nullptr);
+
+    // Detectors of the items of a stream set by Set(), nullptr if none of them
+    static std::unique_ptr<StatsDetectors> Create           (const struct per_item* PerItem, size_t CountOfItems, const StatsKeyIndex& ItemsIndex);
+
+    // Values of the frame Pos, Comment is extended with the events of the frame (if any)
+    // Time is the time stamp as in the reports, for the queue
+    bool                        Add                         (const StatsValueColumn* y, size_t Pos, int StreamIndex, double Time, std::string& Comment);
+
+    // Events of all the streams since the previous call, the oldest ones are dropped (and counted) beyond Events_Max
+    struct event
+    {
+        int                     StreamIndex;
+        size_t                  Frame;
+        double                  Time;
+        std::string             Key;
+        std::string             Method;
+        double                  Value;
+        double                  Score;
+    };
+    static const size_t         Events_Max=1024;
+    static std::vector<event>   Events_Take                 (size_t* Dropped=nullptr);
+
+private:
+    struct detector
+    {
+        size_t                  Item;
+        std::string             Method;
+        std::unique_ptr<StatsDetector> Detector;
+    };
+    std::vector<detector>       Detectors;
+    const struct per_item*      PerItem=nullptr;
+};
+
+#endif // StatsDetectors_H
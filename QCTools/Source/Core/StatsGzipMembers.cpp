@@ -0,0 +1,330 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsGzipMembers.h"
+//---------------------------------------------------------------------------
+
+#include <QIODevice>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QFuture>
+#include <zlib.h>
+#ifdef QCTOOLS_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+//---------------------------------------------------------------------------
+// Member header: gzip header with FEXTRA, one "QC" subfield holding the total
+// member size (header, raw deflate data and gzip trailer) in little endian
+static const size_t     Header_Size=20;
+static const size_t     Trailer_Size=8;
+static const char       Frame_End[]="</frame>\n";
+
+struct StatsGzipMembers_Member
+{
+    std::string         Compressed;
+    std::string         Uncompressed;
+    int                 Level=Z_DEFAULT_COMPRESSION;
+    bool                IsOk=false;
+    QFuture<void>       Done;
+};
+typedef StatsGzipMembers_Member member;
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+uint32_t Get_L4(const char* Data)
+{
+    const unsigned char* Bytes=(const unsigned char*)Data;
+    return ((uint32_t)Bytes[0])|((uint32_t)Bytes[1]<<8)|((uint32_t)Bytes[2]<<16)|((uint32_t)Bytes[3]<<24);
+}
+
+//---------------------------------------------------------------------------
+void Put_L4(char* Data, uint32_t Value)
+{
+    Data[0]=(char)(Value    );
+    Data[1]=(char)(Value>> 8);
+    Data[2]=(char)(Value>>16);
+    Data[3]=(char)(Value>>24);
+}
+
+//---------------------------------------------------------------------------
+bool IsMemberHeader(const char* Data)
+{
+    return (unsigned char)Data[0]==0x1F
+        && (unsigned char)Data[1]==0x8B
+        && Data[2]==8                       // deflate
+        && (Data[3]&0x04)                   // FEXTRA
+        && Data[10]==8 && Data[11]==0       // XLEN
+        && Data[12]=='Q' && Data[13]=='C'
+        && Data[14]==4 && Data[15]==0;      // LEN
+}
+
+//---------------------------------------------------------------------------
+bool ReadFull(QIODevice& Input, char* Data, size_t Size)
+{
+    while (Size)
+    {
+        qint64 ReadSize=Input.read(Data, Size);
+        if (ReadSize<=0)
+            return false;
+        Data+=ReadSize;
+        Size-=ReadSize;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Worker thread
+void InflateMember(member& Member)
+{
+    const std::string& In=Member.Compressed;
+    uint32_t Crc=Get_L4(In.data()+In.size()-Trailer_Size);
+    uint32_t Size=Get_L4(In.data()+In.size()-Trailer_Size+4);
+    Member.Uncompressed.resize(Size);
+
+#ifdef QCTOOLS_LIBDEFLATE
+    // Whole member in one call, faster than zlib for the same output
+    static thread_local std::unique_ptr<libdeflate_decompressor, void(*)(libdeflate_decompressor*)> Decompressor(libdeflate_alloc_decompressor(), libdeflate_free_decompressor);
+    size_t Decompressed_Size=0;
+    Member.IsOk=Decompressor
+             && libdeflate_deflate_decompress(Decompressor.get(), In.data()+Header_Size, In.size()-Header_Size-Trailer_Size, &Member.Uncompressed[0], Size, &Decompressed_Size)==LIBDEFLATE_SUCCESS
+             && Decompressed_Size==Size
+             && libdeflate_crc32(0, Member.Uncompressed.data(), Size)==Crc;
+#else
+    z_stream strm;
+    strm.next_in=(Bytef*)In.data()+Header_Size;
+    strm.avail_in=In.size()-Header_Size-Trailer_Size;
+    strm.next_out=(Bytef*)&Member.Uncompressed[0];
+    strm.avail_out=Size;
+    strm.zalloc=Z_NULL;
+    strm.zfree=Z_NULL;
+    strm.opaque=Z_NULL;
+    if (inflateInit2(&strm, -15)!=Z_OK) // Raw deflate, header and trailer are handled here
+        return;
+    int inflate_Result=inflate(&strm, Z_FINISH);
+    inflateEnd(&strm);
+
+    Member.IsOk=inflate_Result==Z_STREAM_END
+             && !strm.avail_out
+             && crc32(crc32(0, Z_NULL, 0), (const Bytef*)Member.Uncompressed.data(), Size)==Crc;
+#endif
+}
+
+//---------------------------------------------------------------------------
+// Worker thread
+void DeflateMember(member& Member)
+{
+    const std::string& In=Member.Uncompressed;
+    std::string& Out=Member.Compressed;
+#ifdef QCTOOLS_LIBDEFLATE
+    // Compressor of the level per thread, allocation is costly at high levels
+    static thread_local int Compressor_Level=-2;
+    static thread_local std::unique_ptr<libdeflate_compressor, void(*)(libdeflate_compressor*)> Compressor(nullptr, libdeflate_free_compressor);
+    if (Compressor_Level!=Member.Level)
+    {
+        Compressor.reset(libdeflate_alloc_compressor(Member.Level==Z_DEFAULT_COMPRESSION?6:Member.Level));
+        Compressor_Level=Member.Level;
+    }
+    if (!Compressor)
+        return;
+    Out.resize(Header_Size+libdeflate_deflate_compress_bound(Compressor.get(), In.size())+Trailer_Size);
+    size_t Compressed_Size=libdeflate_deflate_compress(Compressor.get(), In.data(), In.size(), &Out[Header_Size], Out.size()-Header_Size-Trailer_Size);
+    if (!Compressed_Size)
+        return;
+    size_t Out_Size=Header_Size+Compressed_Size+Trailer_Size;
+    uint32_t Crc=libdeflate_crc32(0, In.data(), In.size());
+#else
+    z_stream strm;
+    strm.next_in=(Bytef*)In.data();
+    strm.avail_in=In.size();
+    strm.zalloc=Z_NULL;
+    strm.zfree=Z_NULL;
+    strm.opaque=Z_NULL;
+    if (deflateInit2(&strm, Member.Level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY)!=Z_OK) // Raw deflate, header and trailer are handled here
+        return;
+
+    Out.resize(Header_Size+deflateBound(&strm, In.size())+Trailer_Size);
+    strm.next_out=(Bytef*)&Out[Header_Size];
+    strm.avail_out=Out.size()-Header_Size-Trailer_Size;
+    int deflate_Result=deflate(&strm, Z_FINISH);
+    size_t Out_Size=Header_Size+strm.total_out+Trailer_Size;
+    deflateEnd(&strm);
+    if (deflate_Result!=Z_STREAM_END)
+        return;
+    uint32_t Crc=crc32(crc32(0, Z_NULL, 0), (const Bytef*)In.data(), In.size());
+#endif
+    Out.resize(Out_Size);
+
+    static const char Header[Header_Size-4]={'\x1F', '\x8B', 8, 4, 0, 0, 0, 0, 0, '\xFF', 8, 0, 'Q', 'C', 4, 0};
+    std::copy(Header, Header+sizeof(Header), &Out[0]);
+    Put_L4(&Out[Header_Size-4], (uint32_t)Out_Size);
+    Put_L4(&Out[Out_Size-Trailer_Size], Crc);
+    Put_L4(&Out[Out_Size-Trailer_Size+4], (uint32_t)In.size());
+    Member.IsOk=true;
+
+    // Uncompressed data is no more needed
+    std::string().swap(Member.Uncompressed);
+}
+
+//---------------------------------------------------------------------------
+size_t InFlight_Max()
+{
+    return std::max(2, QThreadPool::globalInstance()->maxThreadCount()*2);
+}
+}
+
+//***************************************************************************
+// Read
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsGzipMembers::IsIndexed(QIODevice& Input)
+{
+    QByteArray Header=Input.peek(Header_Size);
+    return Header.size()==(int)Header_Size && IsMemberHeader(Header.constData());
+}
+
+//---------------------------------------------------------------------------
+bool StatsGzipMembers::Inflate(QIODevice& Input, const OutputHandler& Output)
+{
+    // Members are read in order, inflated by the thread pool, and sent in order, with a bounded count in flight
+    std::deque<std::unique_ptr<member>> Members;
+    size_t InFlight=InFlight_Max();
+    bool IsOk=true;
+    bool IsEnd=false;
+    while (!IsEnd || !Members.empty())
+    {
+        // A sequential device (remote report) may wait for the next bytes, the members already received are sent first
+        bool IsWaiting=Input.isSequential() && !Members.empty() && Input.bytesAvailable()<(qint64)Header_Size;
+        if (!IsEnd && Members.size()<InFlight && !IsWaiting)
+        {
+            char Header[Header_Size];
+            qint64 ReadSize=Input.read(Header, Header_Size);
+            if (!ReadSize)
+            {
+                IsEnd=true;
+                continue;
+            }
+            uint32_t Member_Size=ReadSize==(qint64)Header_Size && IsMemberHeader(Header)?Get_L4(Header+Header_Size-4):0;
+            if (Member_Size<Header_Size+Trailer_Size)
+            {
+                IsOk=false;
+                IsEnd=true;
+                continue;
+            }
+
+            std::unique_ptr<member> Member(new member);
+            Member->Compressed.resize(Member_Size);
+            std::copy(Header, Header+Header_Size, &Member->Compressed[0]);
+            if (!ReadFull(Input, &Member->Compressed[Header_Size], Member_Size-Header_Size))
+            {
+                IsOk=false;
+                IsEnd=true;
+                continue;
+            }
+            member* Member_Ptr=Member.get();
+            Member->Done=QtConcurrent::run([Member_Ptr]() {InflateMember(*Member_Ptr);});
+            Members.push_back(std::move(Member));
+            continue;
+        }
+
+        // Oldest member
+        member& Member=*Members.front();
+        Member.Done.waitForFinished();
+        if (IsOk && Member.IsOk)
+            Output(Member.Uncompressed.data(), Member.Uncompressed.size());
+        else
+            IsOk=false; // Next members are waited for but dropped, data after a corrupted member is not usable
+        Members.pop_front();
+    }
+
+    return IsOk;
+}
+
+//***************************************************************************
+// Write
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsGzipMembersWriter::StatsGzipMembersWriter(QIODevice& Output_, int Level_) :
+    Output(Output_),
+    InFlight(InFlight_Max()),
+    Level(Level_<0?Z_DEFAULT_COMPRESSION:std::min(Level_, (int)StatsGzipMembers::Level_Max))
+{
+}
+
+//---------------------------------------------------------------------------
+StatsGzipMembersWriter::~StatsGzipMembersWriter()
+{
+    // Workers use the members
+    for (auto& Member : Members)
+        Member->Done.waitForFinished();
+}
+
+//---------------------------------------------------------------------------
+bool StatsGzipMembersWriter::Append(const char* Data, size_t Size)
+{
+    Pending.append(Data, Size);
+
+    // Split just after a frame
+    while (Pending.size()>StatsGzipMembers::Member_Size)
+    {
+        size_t End=Pending.find(Frame_End, StatsGzipMembers::Member_Size-(sizeof(Frame_End)-1));
+        if (End==std::string::npos)
+            break;
+        Deflate(End+sizeof(Frame_End)-1);
+    }
+
+    return IsOk;
+}
+
+//---------------------------------------------------------------------------
+bool StatsGzipMembersWriter::Finish()
+{
+    if (!Pending.empty())
+        Deflate(Pending.size());
+    while (!Members.empty())
+        WriteOldest();
+
+    return IsOk;
+}
+
+//---------------------------------------------------------------------------
+void StatsGzipMembersWriter::Deflate(size_t Size)
+{
+    while (Members.size()>=InFlight)
+        WriteOldest();
+
+    std::unique_ptr<member> Member(new member);
+    if (Size==Pending.size())
+        Member->Uncompressed.swap(Pending);
+    else
+    {
+        Member->Uncompressed.assign(Pending, 0, Size);
+        Pending.erase(0, Size);
+    }
+    Member->Level=Level;
+    member* Member_Ptr=Member.get();
+    Member->Done=QtConcurrent::run([Member_Ptr]() {DeflateMember(*Member_Ptr);});
+    Members.push_back(std::move(Member));
+}
+
+//---------------------------------------------------------------------------
+void StatsGzipMembersWriter::WriteOldest()
+{
+    member& Member=*Members.front();
+    Member.Done.waitForFinished();
+    if (IsOk && (!Member.IsOk || Output.write(Member.Compressed.data(), Member.Compressed.size())!=(qint64)Member.Compressed.size()))
+        IsOk=false;
+    Members.pop_front();
+}
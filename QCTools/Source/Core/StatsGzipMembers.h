@@ -0,0 +1,71 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsGzipMembers_H
+#define StatsGzipMembers_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+class QIODevice;
+struct StatsGzipMembers_Member;
+
+//---------------------------------------------------------------------------
+// .qctools.xml.gz written as a concatenation of independently decodable gzip
+// members, split at frame boundaries.
+//
+// Each member header carries (in a "QC" extra subfield) the total size of the
+// member, so the members can be located from their headers only and inflated
+// in parallel. The file is still a valid gzip file for any other tool.
+// Files without this subfield (older exports, gzip) must use the sequential
+// path. Members are deflated by libdeflate if built with it (qmake
+// CONFIG+=libdeflate), else by zlib.
+class StatsGzipMembers
+{
+public:
+    typedef std::function<void(const char* Data, size_t Size)> OutputHandler;
+
+    // Read side, the device is not moved
+    static bool                 IsIndexed                   (QIODevice& Input);
+
+    // Uncompressed data is sent to Output in file order, from the calling thread
+    static bool                 Inflate                     (QIODevice& Input, const OutputHandler& Output);
+
+    static const size_t         Member_Size=0x400000;       // 4 MiB of XML per member, arbitrary chosen
+    static const int            Level_Max=9;                // Of zlib, libdeflate levels above are not used for compatibility of the settings
+};
+
+//---------------------------------------------------------------------------
+// Write side, XML is appended as it is generated and cut into members just
+// after a </frame>. Members are deflated by the thread pool and written in
+// order, only a bounded count of members is in memory.
+class StatsGzipMembersWriter
+{
+public:
+    // Level 0 (stored) to Level_Max, -1 for the default of the library
+    explicit                    StatsGzipMembersWriter      (QIODevice& Output, int Level=-1);
+                                ~StatsGzipMembersWriter     ();
+
+    bool                        Append                      (const char* Data, size_t Size);
+    bool                        Finish                      ();
+
+private:
+    void                        Deflate                     (size_t Size);
+    void                        WriteOldest                 ();
+
+    QIODevice&                  Output;
+    std::string                 Pending;
+    std::deque<std::unique_ptr<StatsGzipMembers_Member>> Members;
+    size_t                      InFlight;
+    int                         Level;
+    bool                        IsOk {true};
+};
+
+#endif // StatsGzipMembers_H
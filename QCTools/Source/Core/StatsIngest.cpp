@@ -0,0 +1,169 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsIngest.h"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+//---------------------------------------------------------------------------
+// One slot is always free, full and empty differ (see CaptureFrameRing)
+struct StatsIngest::ring
+{
+    std::vector<item>           Items;
+    std::atomic<size_t>         Head {0};                   // Next slot written
+    std::atomic<size_t>         Tail {0};                   // Next slot read
+    AVFrame*                    Scratch;                    // Properties of the frame pushed, producer only
+    size_t                      Pending=0;                  // Frames since the last wake-up, producer only
+
+                                ring                        () : Items(Slots+1), Scratch(av_frame_alloc()) {}
+                                ~ring                       () {av_frame_free(&Scratch);}
+
+    size_t                      After                       (size_t Pos) const {return Pos+1==Items.size()?0:Pos+1;}
+};
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsIngest::StatsIngest(size_t Streams, const IngestHandler& Ingest_) :
+    Ingest(Ingest_)
+{
+    Rings.reserve(Streams);
+    for (size_t Stream=0; Stream<Streams; Stream++)
+        Rings.emplace_back(new ring);
+}
+
+//---------------------------------------------------------------------------
+// Frames not ingested yet are dropped, the decoding threads are stopped before
+StatsIngest::~StatsIngest()
+{
+    IsCancelled=true;
+    Wake.release();
+    wait();
+}
+
+//***************************************************************************
+// Control
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsIngest::Start()
+{
+    setObjectName("stats ingest");
+    start();
+}
+
+//---------------------------------------------------------------------------
+void StatsIngest::Flush()
+{
+    size_t Target=Pushed.load(std::memory_order_acquire);
+    Wake.release();
+
+    QMutexLocker Locker(&Flush_Mutex);
+    while (Ingested.load(std::memory_order_acquire)<Target && isRunning())
+        Flush_Condition.wait(&Flush_Mutex, Interval);
+}
+
+//***************************************************************************
+// Producers
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsIngest::item& StatsIngest::Next(size_t Stream)
+{
+    ring& Ring=*Rings[Stream];
+    size_t Pos=Ring.Head.load(std::memory_order_relaxed);
+
+    // Backpressure, the stats are late
+    while (Ring.After(Pos)==Ring.Tail.load(std::memory_order_acquire) && !IsCancelled)
+    {
+        Wake.release();
+        QThread::usleep(200);
+    }
+
+    item& Item=Ring.Items[Pos];
+    Item.Values.clear();
+    return Item;
+}
+
+//---------------------------------------------------------------------------
+void StatsIngest::Push(size_t Stream, const QAVFrame& Frame, int Width, int Height)
+{
+    ring& Ring=*Rings[Stream];
+    size_t Pos=Ring.Head.load(std::memory_order_relaxed);
+    size_t Pos_Next=Ring.After(Pos);
+    if (Pos_Next==Ring.Tail.load(std::memory_order_acquire))
+        return; // Cancelled while full
+
+    // Stream, time base and output of the frame, then its properties without its buffers
+    item& Item=Ring.Items[Pos];
+    Item.Frame=Frame;
+    AVFrame* Props=Item.Frame.frame();
+    av_frame_copy_props(Ring.Scratch, Props);
+    Ring.Scratch->format=Props->format;
+    Ring.Scratch->width=Props->width;
+    Ring.Scratch->height=Props->height;
+    Ring.Scratch->nb_samples=Props->nb_samples;
+    Ring.Scratch->pts=Frame.frame()->pts; // Not the one of the previous frame of the slot if negative, see QAVFrame::operator=
+    av_frame_unref(Props);
+    av_frame_move_ref(Props, Ring.Scratch);
+    Item.Width=Width;
+    Item.Height=Height;
+
+    Ring.Head.store(Pos_Next, std::memory_order_release);
+    Pushed.fetch_add(1, std::memory_order_release);
+    if (++Ring.Pending>=Batch)
+    {
+        Ring.Pending=0;
+        Wake.release();
+    }
+}
+
+//***************************************************************************
+// Thread
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsIngest::run()
+{
+    while (!IsCancelled)
+    {
+        // Wake-ups of the other streams in the meantime are for the same pass
+        Wake.tryAcquire(1, Interval);
+        Wake.tryAcquire(Wake.available());
+
+        size_t Count=0;
+        for (size_t Stream=0; Stream<Rings.size() && !IsCancelled; Stream++)
+        {
+            ring& Ring=*Rings[Stream];
+            size_t Pos=Ring.Tail.load(std::memory_order_relaxed);
+            size_t End=Ring.Head.load(std::memory_order_acquire);
+            while (Pos!=End)
+            {
+                item& Item=Ring.Items[Pos];
+                Ingest(Stream, Item);
+                av_frame_unref(Item.Frame.frame());
+
+                // Slot by slot, a producer waiting goes on at once
+                Pos=Ring.After(Pos);
+                Ring.Tail.store(Pos, std::memory_order_release);
+                Count++;
+            }
+        }
+
+        if (Count)
+        {
+            Ingested.fetch_add(Count, std::memory_order_release);
+            QMutexLocker Locker(&Flush_Mutex);
+            Flush_Condition.wakeAll();
+        }
+    }
+}
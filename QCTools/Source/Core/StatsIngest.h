@@ -0,0 +1,81 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsIngest_H
+#define StatsIngest_H
+
+#include "Core/CommonStats.h"
+
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtAVPlayer/qavframe.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Stats of the frames written by a thread of their own instead of the
+// decoding threads of the player: each decoding thread does what needs the
+// pixels or the samples (kernels, analyzers) then hands the frame over and
+// goes on decoding, the thread of the stats writes the time stamps, the items
+// and the columns of all the streams (see CommonStats::StatsFromFrame).
+//
+// A stream has a ring of slots allocated once, one producer (the decoding
+// thread of the stream) and one consumer, without lock. A slot keeps the
+// properties and the metadata of the frame but not its buffers, so the frames
+// of the decoders are released at once. The consumer is woken every Batch
+// frames of a stream, or after Interval milliseconds, and ingests all the
+// frames of all the rings at once; a producer waits if its ring is full.
+class StatsIngest : public QThread
+{
+public:
+    struct item
+    {
+        QAVFrame                Frame;                      // Properties and metadata, no buffers
+        int                     Width=0;
+        int                     Height=0;
+        CommonStats::kernel_values Values;                  // Cleared by Next(), capacity kept
+    };
+    typedef std::function<void(size_t Stream, item& Item)> IngestHandler;
+
+    // Streams is the count of stream indexes, Ingest is called by the thread, in order of the frames of each stream
+                                StatsIngest                 (size_t Streams, const IngestHandler& Ingest);
+                                ~StatsIngest                ();
+
+    void                        Start                       ();
+
+    // Decoding thread of the stream: slot of the next frame, its values are set then the frame is committed by Push()
+    item&                       Next                        (size_t Stream);
+    void                        Push                        (size_t Stream, const QAVFrame& Frame, int Width=0, int Height=0);
+
+    // From another thread, returns once all the frames pushed before are ingested
+    void                        Flush                       ();
+
+    // Slots per stream, frames of a stream between two wake-ups, and milliseconds between two wake-ups at most
+    static const size_t         Slots=512;
+    static const size_t         Batch=32;
+    static const int            Interval=20;
+
+protected:
+    void                        run                         ();
+
+private:
+    struct ring;
+    std::vector<std::unique_ptr<ring> > Rings;
+    IngestHandler               Ingest;
+    QSemaphore                  Wake;
+    QMutex                      Flush_Mutex;
+    QWaitCondition              Flush_Condition;
+    std::atomic<size_t>         Pushed {0};
+    std::atomic<size_t>         Ingested {0};
+    std::atomic<bool>           IsCancelled {false};
+};
+
+#endif // StatsIngest_H
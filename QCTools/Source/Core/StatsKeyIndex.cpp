@@ -0,0 +1,135 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsKeyIndex.h"
+#include "Core/VideoCore.h"
+#include "Core/AudioCore.h"
+//---------------------------------------------------------------------------
+
+#include <cstring>
+
+//***************************************************************************
+// Constructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsKeyIndex::StatsKeyIndex() :
+    Used(0)
+{
+}
+
+//---------------------------------------------------------------------------
+StatsKeyIndex::StatsKeyIndex(const struct per_item* PerItem, size_t CountOfItems) :
+    Used(0)
+{
+    for (size_t Pos=0; Pos<CountOfItems; Pos++)
+        if (PerItem[Pos].FFmpeg_Name && Find(PerItem[Pos].FFmpeg_Name)==NotFound) // First item wins, as with the previous linear scans
+            Insert(PerItem[Pos].FFmpeg_Name, Pos);
+}
+
+//***************************************************************************
+// Lookup
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+size_t StatsKeyIndex::Find(const char* Key, size_t Default) const
+{
+    if (!Used || !Key)
+        return Default;
+
+    uint32_t KeyHash=Hash(Key);
+    size_t Mask=Entries.size()-1;
+    for (size_t Pos=KeyHash&Mask;; Pos=(Pos+1)&Mask)
+    {
+        const entry& Entry=Entries[Pos];
+        if (Entry.Value==NotFound)
+            return Default;
+        if (Entry.Hash==KeyHash && !strcmp(Entry.Key.c_str(), Key))
+            return Entry.Value;
+    }
+}
+
+//---------------------------------------------------------------------------
+void StatsKeyIndex::Insert(const char* Key, size_t Value)
+{
+    // Load factor kept under 1/2
+    if ((Used+1)*2>Entries.size())
+        Grow();
+
+    uint32_t KeyHash=Hash(Key);
+    size_t Mask=Entries.size()-1;
+    for (size_t Pos=KeyHash&Mask;; Pos=(Pos+1)&Mask)
+    {
+        entry& Entry=Entries[Pos];
+        if (Entry.Value==NotFound)
+        {
+            Entry.Hash=KeyHash;
+            Entry.Value=Value;
+            Entry.Key=Key;
+            Used++;
+            return;
+        }
+        if (Entry.Hash==KeyHash && Entry.Key==Key)
+        {
+            Entry.Value=Value;
+            return;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+const StatsKeyIndex& StatsKeyIndex::Video()
+{
+    static const StatsKeyIndex Index(VideoPerItem, Item_VideoMax);
+    return Index;
+}
+
+//---------------------------------------------------------------------------
+const StatsKeyIndex& StatsKeyIndex::Audio()
+{
+    static const StatsKeyIndex Index(AudioPerItem, Item_AudioMax);
+    return Index;
+}
+
+//***************************************************************************
+// Internal
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+uint32_t StatsKeyIndex::Hash(const char* Key)
+{
+    uint32_t Value=2166136261u;
+    for (; *Key; Key++)
+    {
+        Value^=(unsigned char)*Key;
+        Value*=16777619u;
+    }
+    return Value;
+}
+
+//---------------------------------------------------------------------------
+void StatsKeyIndex::Grow()
+{
+    std::vector<entry> Old;
+    Old.swap(Entries);
+    Entries.resize(Old.empty()?64:Old.size()*2);
+    for (auto& Entry : Entries)
+        Entry.Value=NotFound;
+
+    size_t Mask=Entries.size()-1;
+    for (auto& Entry : Old)
+    {
+        if (Entry.Value==NotFound)
+            continue;
+        size_t Pos=Entry.Hash&Mask;
+        while (Entries[Pos].Value!=NotFound)
+            Pos=(Pos+1)&Mask;
+        Entries[Pos].Hash=Entry.Hash;
+        Entries[Pos].Value=Entry.Value;
+        Entries[Pos].Key.swap(Entry.Key);
+    }
+}
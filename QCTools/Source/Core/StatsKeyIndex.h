@@ -0,0 +1,57 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsKeyIndex_H
+#define StatsKeyIndex_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct per_item;
+
+//---------------------------------------------------------------------------
+// Key (lavfi metadata name) to index lookup, open addressing on a FNV-1a hash.
+// A lookup hashes the key once and does a single strcmp on hash match, so
+// per-frame ingest does a constant amount of work per metadata entry instead
+// of scanning the whole per_item table.
+class StatsKeyIndex
+{
+public:
+    static const size_t         NotFound=(size_t)-1;
+
+    // Constructor
+                                StatsKeyIndex               ();
+                                StatsKeyIndex               (const struct per_item* PerItem, size_t CountOfItems);
+
+    // Lookup
+    size_t                      Find                        (const char* Key, size_t Default=NotFound) const;
+    void                        Insert                      (const char* Key, size_t Value);
+    size_t                      Size                        () const {return Used;}
+    bool                        Empty                       () const {return !Used;}
+
+    // Shared instances, built once from VideoPerItem / AudioPerItem
+    static const StatsKeyIndex& Video                       ();
+    static const StatsKeyIndex& Audio                       ();
+
+private:
+    struct entry
+    {
+        uint32_t                Hash;
+        size_t                  Value;
+        std::string             Key;
+    };
+
+    static uint32_t             Hash                        (const char* Key);
+    void                        Grow                        ();
+
+    std::vector<entry>          Entries;                    // Power of 2 size, Value==NotFound means empty slot
+    size_t                      Used;
+};
+
+#endif // StatsKeyIndex_H
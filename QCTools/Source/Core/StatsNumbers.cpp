@@ -0,0 +1,239 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsNumbers.h"
+
+#include <charconv>
+#include <climits>
+#include <limits>
+#if !defined(__cpp_lib_to_chars)
+#include <locale>
+#include <sstream>
+#include <string>
+#endif
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+// Powers of 10 exact in a double
+static const double Pow10[]=
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+static const int Pow10_Max=22;
+static const uint64_t Mantissa_Exact=(uint64_t)1<<53;
+static const int Digits_Max=19; // Of an uint64_t
+
+//---------------------------------------------------------------------------
+static inline bool More(const char* Current, const char* End)
+{
+    return Current!=End && *Current;
+}
+
+static inline bool IsDigit(char Value)
+{
+    return (unsigned char)(Value-'0')<10;
+}
+
+static inline char Lower(char Value)
+{
+    return Value>='A' && Value<='Z'?Value-'A'+'a':Value;
+}
+
+// Word (lower case) at Current, its end if any, else Current
+static const char* Word(const char* Current, const char* End, const char* Value)
+{
+    const char* Begin=Current;
+    for (; *Value; ++Current, ++Value)
+        if (!More(Current, End) || Lower(*Current)!=*Value)
+            return Begin;
+    return Current;
+}
+
+// Leading white space and sign
+static const char* Sign(const char* Current, const char* End, bool& Negative)
+{
+    while (More(Current, End) && (*Current==' ' || (*Current>='\t' && *Current<='\r')))
+        ++Current;
+    Negative=false;
+    if (More(Current, End) && (*Current=='-' || *Current=='+'))
+        Negative=*Current++=='-';
+    return Current;
+}
+
+//---------------------------------------------------------------------------
+// Slow path, as exact as strtod() but in the "C" format
+static double Exact(const char* Begin, const char* End)
+{
+    double Value=0;
+    #if defined(__cpp_lib_to_chars)
+        std::from_chars(Begin, End, Value);
+    #else
+        std::istringstream Stream(std::string(Begin, End));
+        Stream.imbue(std::locale::classic());
+        Stream>>Value;
+    #endif
+    return Value;
+}
+
+//***************************************************************************
+// Parsing
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const char* Number_Parse(const char* Begin, const char* End, double& Value)
+{
+    bool Negative;
+    const char* Current=Sign(Begin, End, Negative);
+    const char* Number=Current;
+
+    // Special values
+    if (More(Current, End) && !IsDigit(*Current) && *Current!='.')
+    {
+        const char* Next;
+        if ((Next=Word(Current, End, "inf"))!=Current)
+        {
+            const char* Long=Word(Next, End, "inity");
+            Value=Negative?-std::numeric_limits<double>::infinity():std::numeric_limits<double>::infinity();
+            return Long;
+        }
+        if ((Next=Word(Current, End, "nan"))!=Current)
+        {
+            Value=std::numeric_limits<double>::quiet_NaN();
+            return Next;
+        }
+        return Begin;
+    }
+
+    // Significant digits in an integer, the other ones change the exponent
+    uint64_t Mantissa=0;
+    int Digits=0;
+    int Exponent=0;
+    bool Truncated=false;
+    bool Any=false;
+    for (; More(Current, End) && IsDigit(*Current); ++Current, Any=true)
+    {
+        if (Digits<Digits_Max)
+        {
+            Mantissa=Mantissa*10+(*Current-'0');
+            if (Mantissa)
+                ++Digits;
+        }
+        else
+        {
+            ++Exponent;
+            Truncated|=*Current!='0';
+        }
+    }
+    if (More(Current, End) && *Current=='.')
+    {
+        const char* Fraction=++Current;
+        for (; More(Current, End) && IsDigit(*Current); ++Current)
+        {
+            if (Digits<Digits_Max)
+            {
+                Mantissa=Mantissa*10+(*Current-'0');
+                if (Mantissa)
+                    ++Digits;
+                --Exponent;
+            }
+            else
+                Truncated|=*Current!='0';
+        }
+        Any|=Current!=Fraction;
+        if (!Any)
+            return Begin; // "." alone
+    }
+    if (!Any)
+        return Begin;
+
+    // Exponent, if at least one digit
+    if (More(Current, End) && (*Current=='e' || *Current=='E'))
+    {
+        const char* Next=Current+1;
+        bool Exponent_Negative=false;
+        if (More(Next, End) && (*Next=='-' || *Next=='+'))
+            Exponent_Negative=*Next++=='-';
+        if (More(Next, End) && IsDigit(*Next))
+        {
+            int Value=0;
+            for (; More(Next, End) && IsDigit(*Next); ++Next)
+                if (Value<100000)
+                    Value=Value*10+(*Next-'0');
+            Exponent+=Exponent_Negative?-Value:Value;
+            Current=Next;
+        }
+    }
+
+    if (!Mantissa)
+        Value=0;
+    else if (!Truncated && Mantissa<=Mantissa_Exact && Exponent>=-Pow10_Max && Exponent<=Pow10_Max)
+        Value=Exponent<0?(double)Mantissa/Pow10[-Exponent]:(double)Mantissa*Pow10[Exponent];
+    else
+        Value=Exact(Number, Current);
+    if (Negative)
+        Value=-Value;
+    return Current;
+}
+
+//---------------------------------------------------------------------------
+const char* Number_Parse(const char* Begin, const char* End, int64_t& Value)
+{
+    bool Negative;
+    const char* Current=Sign(Begin, End, Negative);
+    if (!More(Current, End) || !IsDigit(*Current))
+        return Begin;
+
+    // Accumulated as a negative number, the range of int64_t is larger on this side
+    int64_t Result=0;
+    bool Overflow=false;
+    for (; More(Current, End) && IsDigit(*Current); ++Current)
+    {
+        int Digit=*Current-'0';
+        if (Result<(INT64_MIN+Digit)/10)
+            Overflow=true;
+        else
+            Result=Result*10-Digit;
+    }
+
+    if (Overflow)
+        Value=Negative?INT64_MIN:INT64_MAX;
+    else if (Negative)
+        Value=Result;
+    else
+        Value=Result==INT64_MIN?INT64_MAX:-Result;
+    return Current;
+}
+
+//---------------------------------------------------------------------------
+double Number_ToDouble(const char* Value)
+{
+    double Result=0;
+    if (Value)
+        Number_Parse(Value, nullptr, Result);
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+int64_t Number_ToInt64(const char* Value)
+{
+    int64_t Result=0;
+    if (Value)
+        Number_Parse(Value, nullptr, Result);
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+int Number_ToInt(const char* Value)
+{
+    int64_t Result=Number_ToInt64(Value);
+    if (Result>INT_MAX)
+        return INT_MAX;
+    if (Result<INT_MIN)
+        return INT_MIN;
+    return (int)Result;
+}
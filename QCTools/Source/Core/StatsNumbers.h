@@ -0,0 +1,37 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsNumbers_H
+#define StatsNumbers_H
+
+#include <cstdint>
+
+//---------------------------------------------------------------------------
+// Numbers of the metadata of the filters and of the attributes of the
+// reports, in the "C" format whatever the locale of the process (the reports
+// are written with '.', a locale with ',' would have strtod() and atof() stop
+// there) and without exceptions (std::stoi() and std::stod() throw on the
+// "N/A" or the out of range values of some files).
+//
+// Decimal numbers of up to 19 significant digits with an exponent of 22 at
+// most (all the ones of the filters and of the reports) are an integer
+// product or quotient, exact as strtod(); other ones go to the exact
+// parsing of the standard library. Leading white space and a sign are
+// skipped, "inf", "infinity" and "nan" (any case) are read, hexadecimal
+// numbers are not.
+
+// Number at the beginning of Begin (to End, NULL for a null-terminated string), its end is returned, Begin if none
+// Value is not changed if none; integers out of range are the largest ones
+const char*                     Number_Parse                (const char* Begin, const char* End, double& Value);
+const char*                     Number_Parse                (const char* Begin, const char* End, int64_t& Value);
+
+// As atof(), atoll() and atoi(): 0 if Value is NULL or not a number, the largest integers if out of range
+double                          Number_ToDouble             (const char* Value);
+int64_t                         Number_ToInt64              (const char* Value);
+int                             Number_ToInt                (const char* Value);
+
+#endif // StatsNumbers_H
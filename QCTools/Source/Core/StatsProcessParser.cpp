@@ -0,0 +1,652 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsProcessParser.h"
+#include "Core/AudioStats.h"
+#include "Core/CommonStats.h"
+#include "Core/FileInformation.h"
+#include "Core/SignalServer.h"
+#include "Core/ThumbnailStore.h"
+#include "Core/VideoStats.h"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEventLoop>
+#include <QFile>
+#include <QProcess>
+#include <QSharedMemory>
+#include <QTimer>
+#include <QUuid>
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <new>
+
+//---------------------------------------------------------------------------
+const char* const StatsProcessParser::Worker_Option="--analysis-worker";
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+const uint32_t                  Magic=0x51435350;           // "QCSP"
+const size_t                    Streams_Max=64;
+const size_t                    Items_Max=512;
+const size_t                    Block_Frames=StatsColumn<double>::Chunk_Size; // One chunk of the columns per block
+const int                       Exit_Timeout=5000;          // Milliseconds of the helper to end once its input is closed
+
+// Mapped by both processes, the counts are read without lock
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free, "shared counts must be lock-free");
+
+enum state : uint32_t
+{
+    State_Opening,
+    State_Parsing,
+    State_Done,
+    State_Failed,
+};
+
+struct shared_stream
+{
+    int32_t                     Type;                       // -1 if the stream has no stats
+    uint32_t                    Items;
+    std::atomic<uint8_t>        Items_Allocated[Items_Max]; // Set before the first frame with a value of the item is published
+    std::atomic<uint64_t>       Frames;                     // Published, all their values are written
+};
+
+// Other values are written before the state (streams) or the first count (thumbnails) published
+struct shared_header
+{
+    uint32_t                    Magic;
+    uint32_t                    Streams;
+    std::atomic<uint32_t>       State;
+    int32_t                     Thumbnails_Width;
+    int32_t                     Thumbnails_Height;
+    std::atomic<uint64_t>       Thumbnails;
+    shared_stream               Stream[Streams_Max];
+};
+
+//---------------------------------------------------------------------------
+// Offsets of the columns in a block of Block_Frames frames of a stream
+struct block_layout
+{
+    size_t                      x, y, durations, pkt_pos, pkt_pts, pkt_size, pix_fmt, key_frames, pict_type, Size;
+
+    explicit block_layout(size_t Items)
+    {
+        x=0;
+        y=x+Block_Frames*sizeof(double);
+        durations=y+Items*Block_Frames*sizeof(double);
+        pkt_pos=durations+Block_Frames*sizeof(double);
+        pkt_pts=pkt_pos+Block_Frames*sizeof(int64_t);
+        pkt_size=pkt_pts+Block_Frames*sizeof(int64_t);
+        pix_fmt=pkt_size+Block_Frames*sizeof(int);
+        key_frames=pix_fmt+Block_Frames*sizeof(int);
+        pict_type=key_frames+Block_Frames;
+        Size=pict_type+Block_Frames;
+    }
+};
+
+// Time stamps of the thumbnails of a block, then their pixels
+size_t ThumbnailsBlock_Size(size_t Bytes)
+{
+    return StatsProcessParser::Thumbnails_Block*(sizeof(int64_t)+Bytes);
+}
+
+//---------------------------------------------------------------------------
+// Stream -1 for the thumbnails
+QString Segment_Name(const QString& Key, int Stream, size_t Block)
+{
+    if (Stream<0)
+        return QString("%1-t-%2").arg(Key).arg(Block);
+    return QString("%1-%2-%3").arg(Key).arg(Stream).arg(Block);
+}
+
+//***************************************************************************
+// Helper
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Segments created by the helper, kept until its end
+class publisher
+{
+public:
+    explicit                    publisher                   (const QString& Key_) : Key(Key_) {}
+
+    bool                        Open                        (const std::vector<CommonStats*>& Stats);
+    bool                        IsOpen                      () const {return Header!=nullptr;}
+    void                        Publish                     (FileInformation& Info);
+    void                        Finish                      (FileInformation& Info, bool IsOk);
+
+private:
+    uchar*                      Block                       (int Stream, size_t Index, size_t Size);
+    void                        Publish_Thumbnails          (FileInformation& Info);
+
+    QString                     Key;
+    QSharedMemory               Header_Memory;
+    shared_header*              Header=nullptr;
+    std::map<std::pair<int, size_t>, std::unique_ptr<QSharedMemory>> Blocks;
+    std::vector<size_t>         Published;
+    size_t                      Thumbnails_Published=0;
+    bool                        Failed=false;
+};
+
+//---------------------------------------------------------------------------
+bool publisher::Open(const std::vector<CommonStats*>& Stats)
+{
+    if (Stats.size()>Streams_Max)
+        return false;
+    for (auto Stat : Stats)
+        if (Stat && PerStreamType[Stat->Type_Get()].CountOfItems>Items_Max)
+            return false;
+
+    Header_Memory.setKey(Key);
+    if (!Header_Memory.create(sizeof(shared_header)))
+    {
+        qDebug() << "analysis worker:" << Header_Memory.errorString();
+        return false;
+    }
+    Header=new (Header_Memory.data()) shared_header();
+    Header->Magic=Magic;
+    Header->Streams=(uint32_t)Stats.size();
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
+    {
+        Header->Stream[Pos].Type=Stats[Pos]?Stats[Pos]->Type_Get():-1;
+        Header->Stream[Pos].Items=Stats[Pos]?(uint32_t)PerStreamType[Stats[Pos]->Type_Get()].CountOfItems:0;
+    }
+    Published.resize(Stats.size());
+    Header->State.store(State_Parsing, std::memory_order_release);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+uchar* publisher::Block(int Stream, size_t Index, size_t Size)
+{
+    auto& Memory=Blocks[std::make_pair(Stream, Index)];
+    if (!Memory)
+    {
+        Memory.reset(new QSharedMemory(Segment_Name(Key, Stream, Index)));
+        if (!Memory->create((int)Size))
+        {
+            qDebug() << "analysis worker:" << Memory->errorString();
+            Memory.reset();
+            return nullptr;
+        }
+        memset(Memory->data(), 0, Size);
+    }
+    return (uchar*)Memory->data();
+}
+
+//---------------------------------------------------------------------------
+// Frames parsed since the last call, read as the other readers of the stats of a parsing do
+void publisher::Publish(FileInformation& Info)
+{
+    if (!Header || Failed)
+        return;
+
+    for (size_t Stream=0; Stream<Published.size() && Stream<Info.Stats.size(); Stream++)
+    {
+        CommonStats* Stat=Info.Stats[Stream];
+        if (!Stat)
+            continue;
+        shared_stream& Shared=Header->Stream[Stream];
+        size_t Frames=Stat->x_Current_Get();
+        if (Frames<=Published[Stream])
+            continue;
+
+        for (size_t j=0; j<Shared.Items; j++)
+            if (!Shared.Items_Allocated[j].load(std::memory_order_relaxed) && Stat->y[j].IsAllocated())
+                Shared.Items_Allocated[j].store(1, std::memory_order_release);
+
+        block_layout Layout(Shared.Items);
+        for (size_t Pos=Published[Stream]; Pos<Frames; Pos++)
+        {
+            uchar* Data=Block((int)Stream, Pos/Block_Frames, Layout.Size);
+            if (!Data)
+            {
+                Failed=true;
+                return;
+            }
+            size_t i=Pos%Block_Frames;
+
+            ((double*)(Data+Layout.x))[i]=Stat->FirstTimeStamp==DBL_MAX?Stat->x[1][Pos]:Stat->x[1][Pos]+Stat->FirstTimeStamp;
+            for (size_t j=0; j<Shared.Items; j++)
+                if (Shared.Items_Allocated[j].load(std::memory_order_relaxed))
+                    ((double*)(Data+Layout.y))[j*Block_Frames+i]=Stat->y[j][Pos];
+            ((double*)(Data+Layout.durations))[i]=Stat->durations[Pos];
+            ((int64_t*)(Data+Layout.pkt_pos))[i]=Stat->pkt_pos[Pos];
+            ((int64_t*)(Data+Layout.pkt_pts))[i]=Stat->pkt_pts[Pos];
+            ((int*)(Data+Layout.pkt_size))[i]=Stat->pkt_size[Pos];
+            ((int*)(Data+Layout.pix_fmt))[i]=Stat->pix_fmt[Pos];
+            Data[Layout.key_frames+i]=Stat->key_frames[Pos]?1:0;
+            Data[Layout.pict_type+i]=(uchar)Stat->pict_type_char[Pos];
+        }
+
+        Published[Stream]=Frames;
+        Shared.Frames.store(Frames, std::memory_order_release);
+    }
+
+    Publish_Thumbnails(Info);
+}
+
+//---------------------------------------------------------------------------
+// Thumbnails of the frames published, with the time stamp of their frame
+void publisher::Publish_Thumbnails(FileInformation& Info)
+{
+    CommonStats* Reference=Info.ReferenceStat();
+    if (!Reference)
+        return;
+    size_t Count=std::min(Info.thumbnailsCount(), Reference->x_Current_Get());
+
+    size_t Pos=Thumbnails_Published;
+    for (; Pos<Count; Pos++)
+    {
+        auto Thumbnail=Info.getThumbnail(Pos);
+        if (Thumbnail.Rgb.isEmpty())
+            break;
+        if (!Header->Thumbnails_Width)
+        {
+            Header->Thumbnails_Width=Thumbnail.Width;
+            Header->Thumbnails_Height=Thumbnail.Height;
+        }
+        else if (Thumbnail.Width!=Header->Thumbnails_Width || Thumbnail.Height!=Header->Thumbnails_Height)
+            break;
+
+        size_t Bytes=(size_t)Thumbnail.Width*Thumbnail.Height*3;
+        uchar* Data=Block(-1, Pos/StatsProcessParser::Thumbnails_Block, ThumbnailsBlock_Size(Bytes));
+        if (!Data)
+            break;
+        size_t i=Pos%StatsProcessParser::Thumbnails_Block;
+        ((int64_t*)Data)[i]=Reference->pkt_pts[Pos];
+        memcpy(Data+StatsProcessParser::Thumbnails_Block*sizeof(int64_t)+i*Bytes, Thumbnail.Rgb.constData(), Bytes);
+    }
+
+    if (Pos>Thumbnails_Published)
+    {
+        Thumbnails_Published=Pos;
+        Header->Thumbnails.store(Pos, std::memory_order_release);
+    }
+}
+
+//---------------------------------------------------------------------------
+void publisher::Finish(FileInformation& Info, bool IsOk)
+{
+    if (!Header)
+        return;
+
+    Publish(Info);
+    Header->State.store(IsOk && !Failed?State_Done:State_Failed, std::memory_order_release);
+}
+
+//***************************************************************************
+// Parser
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Segments mapped read-only by the thread of the parser
+class reader
+{
+public:
+                                reader                      (const QString& Key_, const std::vector<CommonStats*>& Stats_, ThumbnailStore* Thumbnails_) :
+                                    Key(Key_), Stats(Stats_), Thumbnails(Thumbnails_), Streams(Stats_.size()) {}
+                                ~reader                     ();
+
+    // The frames published since the last call are appended, returns the state of the helper
+    uint32_t                    Read                        ();
+
+private:
+    struct stream
+    {
+        std::unique_ptr<QSharedMemory> Memory;              // Of the block being read
+        size_t                  Block=(size_t)-1;
+        CommonStats*            Mirror=nullptr;             // Stats of the block, its columns are the ones of the segment
+        std::vector<bool>       Mapped;                     // Items of the mirror with a column
+        size_t                  Frames=0;                   // Appended
+    };
+
+    bool                        Read                        (size_t Pos);
+    void                        Read_Thumbnails             ();
+    static const uchar*         Attach                      (std::unique_ptr<QSharedMemory>& Memory, const QString& Name, size_t Size);
+
+    QString                     Key;
+    std::vector<CommonStats*>   Stats;
+    ThumbnailStore*             Thumbnails;
+    QSharedMemory               Header_Memory;
+    const shared_header*        Header=nullptr;
+    std::vector<stream>         Streams;
+    std::unique_ptr<QSharedMemory> Thumbnails_Memory;
+    size_t                      Thumbnails_BlockIndex=(size_t)-1;
+    size_t                      Thumbnails_Read=0;
+    bool                        Failed=false;
+};
+
+//---------------------------------------------------------------------------
+reader::~reader()
+{
+    // Before their columns are unmapped
+    for (auto& Stream : Streams)
+        delete Stream.Mirror;
+}
+
+//---------------------------------------------------------------------------
+const uchar* reader::Attach(std::unique_ptr<QSharedMemory>& Memory, const QString& Name, size_t Size)
+{
+    Memory.reset(new QSharedMemory(Name));
+    if (!Memory->attach(QSharedMemory::ReadOnly) || Memory->size()<(qint64)Size)
+    {
+        qDebug() << "analysis process:" << Name << Memory->errorString();
+        Memory.reset();
+        return nullptr;
+    }
+    return (const uchar*)Memory->constData();
+}
+
+//---------------------------------------------------------------------------
+uint32_t reader::Read()
+{
+    if (Failed)
+        return State_Failed;
+
+    if (!Header)
+    {
+        // Created by the helper once the file is opened
+        Header_Memory.setKey(Key);
+        if (!Header_Memory.attach(QSharedMemory::ReadOnly))
+            return State_Opening;
+        Header=(const shared_header*)Header_Memory.constData();
+        if (Header_Memory.size()<(qint64)sizeof(shared_header) || Header->Magic!=Magic)
+        {
+            Failed=true;
+            return State_Failed;
+        }
+    }
+
+    // Frames published before the end are all read after it
+    uint32_t State=Header->State.load(std::memory_order_acquire);
+    if (State==State_Opening)
+        return State;
+
+    if (Header->Streams!=Stats.size())
+    {
+        qDebug() << "analysis process:" << Header->Streams << "streams instead of" << Stats.size();
+        Failed=true;
+        return State_Failed;
+    }
+
+    for (size_t Pos=0; Pos<Streams.size(); Pos++)
+        if (!Read(Pos))
+        {
+            Failed=true;
+            return State_Failed;
+        }
+    Read_Thumbnails();
+
+    return State;
+}
+
+//---------------------------------------------------------------------------
+bool reader::Read(size_t Pos)
+{
+    CommonStats* Stat=Stats[Pos];
+    const shared_stream& Shared=Header->Stream[Pos];
+    if (!Stat)
+        return Shared.Type==-1;
+    size_t Items=PerStreamType[Stat->Type_Get()].CountOfItems;
+    if (Shared.Type!=Stat->Type_Get() || Shared.Items!=Items)
+        return false;
+
+    stream& Stream=Streams[Pos];
+    block_layout Layout(Items);
+    size_t Published=Shared.Frames.load(std::memory_order_acquire);
+    while (Stream.Frames<Published)
+    {
+        size_t Block=Stream.Frames/Block_Frames;
+        if (Block!=Stream.Block)
+        {
+            delete Stream.Mirror;
+            Stream.Mirror=nullptr;
+            auto Data=Attach(Stream.Memory, Segment_Name(Key, (int)Pos, Block), Layout.Size);
+            if (!Data)
+                return false;
+            Stream.Block=Block;
+
+            // Read only, the mirror is the source of Append() which does not write its columns
+            auto Columns=const_cast<uchar*>(Data);
+            Stream.Mirror=Stat->Type_Get()==Type_Video?(CommonStats*)new VideoStats((int)Pos):(CommonStats*)new AudioStats((int)Pos);
+            Stream.Mirror->FirstTimeStamp=0;
+            Stream.Mirror->x[1].Map((double*)(Columns+Layout.x), Block_Frames);
+            Stream.Mirror->durations.Map((double*)(Columns+Layout.durations), Block_Frames);
+            Stream.Mirror->pkt_pos.Map((int64_t*)(Columns+Layout.pkt_pos), Block_Frames);
+            Stream.Mirror->pkt_pts.Map((int64_t*)(Columns+Layout.pkt_pts), Block_Frames);
+            Stream.Mirror->pkt_size.Map((int*)(Columns+Layout.pkt_size), Block_Frames);
+            Stream.Mirror->key_frames.Reserve(Block_Frames);
+            Stream.Mirror->pict_type_char.Reserve(Block_Frames);
+            Stream.Mapped.assign(Items, false);
+        }
+
+        // Items with values since the last read, not allocated in the stats else
+        auto Data=(const uchar*)Stream.Memory->constData();
+        for (size_t j=0; j<Items; j++)
+            if (!Stream.Mapped[j] && Shared.Items_Allocated[j].load(std::memory_order_acquire))
+            {
+                Stream.Mirror->y[j].SetStorage(StatsValueColumn::Storage_Double);
+                Stream.Mirror->y[j].Map((double*)const_cast<uchar*>(Data+Layout.y)+j*Block_Frames, Block_Frames);
+                Stream.Mapped[j]=true;
+            }
+
+        size_t First=Stream.Frames-Block*Block_Frames;
+        size_t Last=std::min(Published-Block*Block_Frames, Block_Frames);
+        for (size_t i=First; i<Last; i++)
+        {
+            Stream.Mirror->key_frames.Set(i, Data[Layout.key_frames+i]!=0);
+            Stream.Mirror->pict_type_char.Set(i, (char)Data[Layout.pict_type+i]);
+            Stream.Mirror->pix_fmt.Set(i, ((const int*)(Data+Layout.pix_fmt))[i]);
+        }
+
+        // One more than the frames read: Append() takes the totals of a whole segment from it, the mirror has none
+        Stream.Mirror->x_Current=Last+1;
+        Stat->Append(*Stream.Mirror, First, Last);
+        Stream.Frames=Block*Block_Frames+Last;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+void reader::Read_Thumbnails()
+{
+    if (!Thumbnails)
+        return;
+
+    size_t Published=Header->Thumbnails.load(std::memory_order_acquire);
+    if (Thumbnails_Read>=Published)
+        return;
+    int Width=Header->Thumbnails_Width;
+    int Height=Header->Thumbnails_Height;
+    size_t Bytes=(size_t)Width*Height*3;
+
+    AVFrame* Frame=av_frame_alloc();
+    Frame->format=AV_PIX_FMT_RGB24;
+    Frame->width=Width;
+    Frame->height=Height;
+    Frame->linesize[0]=Width*3;
+    for (; Thumbnails_Read<Published; Thumbnails_Read++)
+    {
+        size_t Block=Thumbnails_Read/StatsProcessParser::Thumbnails_Block;
+        if (Block!=Thumbnails_BlockIndex && !Attach(Thumbnails_Memory, Segment_Name(Key, -1, Block), ThumbnailsBlock_Size(Bytes)))
+            break;
+        Thumbnails_BlockIndex=Block;
+
+        auto Data=(const uchar*)Thumbnails_Memory->constData();
+        size_t i=Thumbnails_Read%StatsProcessParser::Thumbnails_Block;
+        Frame->pts=((const int64_t*)Data)[i];
+        Frame->data[0]=const_cast<uchar*>(Data+StatsProcessParser::Thumbnails_Block*sizeof(int64_t)+i*Bytes);
+        Thumbnails->Push(Frame);
+    }
+    Frame->data[0]=nullptr;
+    av_frame_free(&Frame);
+}
+
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsProcessParser::StatsProcessParser(const QString& FileName_, activefilters Filters_, activealltracks AllTracks_,
+                                       const std::vector<CommonStats*>& Stats_, ThumbnailStore* Thumbnails_,
+                                       const FinishedHandler& Finished_) :
+    FileName(FileName_),
+    Filters(Filters_),
+    AllTracks(AllTracks_),
+    Stats(Stats_),
+    Thumbnails(Thumbnails_),
+    Finished(Finished_)
+{
+}
+
+//---------------------------------------------------------------------------
+StatsProcessParser::~StatsProcessParser()
+{
+    Cancel();
+}
+
+//***************************************************************************
+// Control
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsProcessParser::Start()
+{
+    start();
+}
+
+//---------------------------------------------------------------------------
+void StatsProcessParser::Cancel()
+{
+    IsCancelled=true;
+    wait();
+}
+
+//***************************************************************************
+// Thread
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsProcessParser::run()
+{
+    const QString Key=QString("qctools-%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+
+    QProcess Process;
+    Process.setProgram(QCoreApplication::applicationFilePath());
+    Process.setArguments({Worker_Option, FileName, Key, QString::fromStdString(Filters.to_string()), QString::fromStdString(AllTracks.to_string())});
+    Process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    Process.setStandardOutputFile(QProcess::nullDevice());
+    Process.start();
+    if (!Process.waitForStarted())
+    {
+        qDebug() << "analysis process:" << Process.errorString();
+        Finished(false);
+        return;
+    }
+
+    uint32_t State=State_Opening;
+    {
+        reader Reader(Key, Stats, Thumbnails);
+        while (!IsCancelled)
+        {
+            bool IsExited=Process.waitForFinished(Interval) || Process.state()==QProcess::NotRunning;
+            State=Reader.Read();
+            if (State==State_Done || State==State_Failed || IsExited)
+                break;
+        }
+    }
+
+    // The helper keeps its segments until its input is closed
+    Process.closeWriteChannel();
+    if (IsCancelled || !Process.waitForFinished(Exit_Timeout))
+    {
+        Process.kill();
+        Process.waitForFinished();
+    }
+    if (IsCancelled)
+        return;
+
+    bool IsOk=State==State_Done && Process.exitStatus()==QProcess::NormalExit && !Process.exitCode();
+    if (!IsOk)
+        qDebug() << "analysis process:" << FileName << "ended" << (Process.exitStatus()==QProcess::CrashExit?"by a crash":"with an error") << "after the frames read";
+    Finished(IsOk);
+}
+
+//***************************************************************************
+// Helper
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+int StatsProcessParser::Worker(const QStringList& Arguments)
+{
+    if (Arguments.size()<4)
+    {
+        qDebug() << "analysis worker: file name, segments name, filters and tracks expected";
+        return 1;
+    }
+    const QString& FileName=Arguments[0];
+    activefilters Filters(Arguments[2].toStdString());
+    activealltracks AllTracks(Arguments[3].toStdString());
+
+    SignalServer signalServer;
+    FileInformation Info(&signalServer, FileName, Filters, AllTracks, QMap<QString, std::tuple<QString, QString, QString, QString, int, QString>>(), QString(), 0, false);
+    Info.setAutoCheckFileUploaded(false);
+    Info.setAutoUpload(false);
+
+    publisher Publisher(Arguments[1]);
+    QEventLoop Loop;
+    QTimer Timer;
+    Timer.setInterval(Interval);
+    bool IsOk=false;
+    QObject::connect(&Timer, &QTimer::timeout, &Loop, [&]() {
+        Publisher.Publish(Info);
+    });
+    QObject::connect(&Info, &FileInformation::opened, &Loop, [&](bool isValid) {
+        if (!isValid || !Publisher.Open(Info.Stats))
+        {
+            Loop.quit();
+            return;
+        }
+        Timer.start();
+    }, Qt::QueuedConnection);
+    QObject::connect(&Info, &FileInformation::parsingCompleted, &Loop, [&](bool success) {
+        IsOk=success;
+        Loop.quit();
+    }, Qt::QueuedConnection);
+
+    Info.open(true);
+    Loop.exec();
+    Timer.stop();
+    Publisher.Finish(Info, IsOk);
+
+    // Segments are removed with their last mapping, so only once the parser read them all
+    QFile Input;
+    if (Publisher.IsOpen() && Input.open(stdin, QIODevice::ReadOnly))
+    {
+        char Buffer[256];
+        while (Input.read(Buffer, sizeof(Buffer))>0)
+            ;
+    }
+
+    return IsOk?0:1;
+}
@@ -0,0 +1,80 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsProcessParser_H
+#define StatsProcessParser_H
+
+#include "Core/Core.h"
+
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+class CommonStats;
+class ThumbnailStore;
+
+//---------------------------------------------------------------------------
+// Parsing of a file by a helper process, the same executable started with
+// Worker_Option: a crash of a decoder or of a filter ends the helper only,
+// and the decoders and filters do not share the memory nor the locks of the
+// process of the GUI.
+//
+// The helper parses the file with a FileInformation of its own and copies
+// the frames parsed to shared memory segments (QSharedMemory): a header with
+// the count of frames published per stream, then blocks of one StatsColumn
+// chunk of frames per stream (time stamps, items, durations, packets, key
+// frames, picture types and pixel formats) and blocks of thumbnails. All the
+// values of a frame are written before its count is published, as for
+// CommonStats::x_Current_Get(), so the frames up to the count read are
+// complete and no lock is shared by the processes.
+//
+// The thread of the parser maps the segments read-only and appends their
+// frames to the stats (see CommonStats::Append) and their thumbnails to the
+// thumbnails of the file. The additional stats, the comments and the panels
+// are not in the segments; the helper uses the filters and tracks of the file
+// and its own defaults for the other settings.
+class StatsProcessParser : public QThread
+{
+public:
+    typedef std::function<void(bool IsOk)> FinishedHandler;
+
+    // Stats is indexed by stream index as in the helper, Finished is called by the thread at the end of the parsing
+                                StatsProcessParser          (const QString& FileName, activefilters Filters, activealltracks AllTracks,
+                                                             const std::vector<CommonStats*>& Stats, ThumbnailStore* Thumbnails,
+                                                             const FinishedHandler& Finished);
+                                ~StatsProcessParser         ();
+
+    void                        Start                       ();
+    // No more frames, the helper is ended, returns once the thread is done
+    void                        Cancel                      ();
+
+    // First argument of the helper, followed by the file name, the segments name, the filters and the tracks
+    static const char* const    Worker_Option;
+    // Helper side, from main() with the arguments after Worker_Option and a Q(Core)Application; returns the exit code
+    static int                  Worker                      (const QStringList& Arguments);
+
+    // Frames per block of thumbnails, and milliseconds between two copies of the frames parsed (helper) or reads (parser)
+    static const size_t         Thumbnails_Block=256;
+    static const int            Interval=50;
+
+protected:
+    void                        run                         ();
+
+private:
+    QString                     FileName;
+    activefilters               Filters;
+    activealltracks             AllTracks;
+    std::vector<CommonStats*>   Stats;
+    ThumbnailStore*             Thumbnails;
+    FinishedHandler             Finished;
+    std::atomic<bool>           IsCancelled {false};
+};
+
+#endif // StatsProcessParser_H
@@ -0,0 +1,132 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsPyramid.h"
+#include "Core/StatsColumn.h"
+#include <algorithm>
+#include <cmath>
+
+//---------------------------------------------------------------------------
+// Position of the smallest (Max=false) or the biggest value, a NaN value loses
+static uint32_t Select(const StatsValueColumn& Column, uint32_t A, uint32_t B, bool Max)
+{
+    double ValueA=Column[A];
+    double ValueB=Column[B];
+    if (std::isnan(ValueA))
+        return B;
+    if (std::isnan(ValueB))
+        return A;
+    if (Max)
+        return ValueB>ValueA?B:A;
+    return ValueB<ValueA?B:A;
+}
+
+//***************************************************************************
+// Build
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsPyramid::Update(const StatsValueColumn& Column, size_t Count)
+{
+    if (Count<Values_Count)
+        Clear();
+    if (Count==Values_Count)
+        return;
+
+    // Level 0, from the bucket of the first new value (it may be the last one, not complete)
+    size_t Begin=Values_Count/2;
+    size_t End=(Count+1)/2;
+    if (Levels.empty())
+        Levels.emplace_back();
+    Levels[0].resize(End);
+    for (size_t Pos=Begin; Pos<End; Pos++)
+    {
+        uint32_t First=(uint32_t)(Pos*2);
+        uint32_t Second=First+1<Count?First+1:First;
+        Levels[0][Pos].Min=Select(Column, First, Second, false);
+        Levels[0][Pos].Max=Select(Column, First, Second, true);
+    }
+
+    // Next levels merge 2 buckets of the previous one, while there are more than one
+    for (size_t Level=1; Levels[Level-1].size()>1; Level++)
+    {
+        if (Level==Levels.size())
+            Levels.emplace_back();
+        const std::vector<bucket>& Previous=Levels[Level-1];
+        std::vector<bucket>& Current=Levels[Level];
+        Begin/=2;
+        End=(Previous.size()+1)/2;
+        Current.resize(End);
+        for (size_t Pos=Begin; Pos<End; Pos++)
+        {
+            const bucket& First=Previous[Pos*2];
+            const bucket& Second=Pos*2+1<Previous.size()?Previous[Pos*2+1]:First;
+            Current[Pos].Min=Select(Column, First.Min, Second.Min, false);
+            Current[Pos].Max=Select(Column, First.Max, Second.Max, true);
+        }
+    }
+
+    Values_Count=Count;
+}
+
+//---------------------------------------------------------------------------
+void StatsPyramid::Clear()
+{
+    Levels.clear();
+    Values_Count=0;
+}
+
+//***************************************************************************
+// Query
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsPyramid::Positions(size_t Begin, size_t End, size_t Buckets, std::vector<uint32_t>& Result) const
+{
+    Result.clear();
+    End=std::min(End, Values_Count);
+    if (Begin>=End)
+        return;
+
+    size_t Size=End-Begin;
+    if (!Buckets || Size<=Buckets*2 || Levels.empty())
+    {
+        Result.reserve(Size);
+        for (size_t Pos=Begin; Pos<End; Pos++)
+            Result.push_back((uint32_t)Pos);
+        return;
+    }
+
+    // Biggest level with buckets not larger than the ones requested
+    size_t Level=0;
+    while (Level+1<Levels.size() && ((size_t)4<<Level)*Buckets<=Size)
+        Level++;
+    size_t Shift=Level+1;
+
+    // Buckets at the edges may contain values outside of the range, kept so the lines continue outside of the canvas
+    const std::vector<bucket>& Current=Levels[Level];
+    size_t First=Begin>>Shift;
+    size_t Last=std::min((End-1)>>Shift, Current.size()-1);
+    Result.reserve((Last-First+1)*2);
+    for (size_t Pos=First; Pos<=Last; Pos++)
+    {
+        uint32_t Min=Current[Pos].Min;
+        uint32_t Max=Current[Pos].Max;
+        if (Min==Max)
+            Result.push_back(Min);
+        else if (Min<Max)
+        {
+            Result.push_back(Min);
+            Result.push_back(Max);
+        }
+        else
+        {
+            Result.push_back(Max);
+            Result.push_back(Min);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsPyramid_H
+#define StatsPyramid_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class StatsValueColumn;
+
+//---------------------------------------------------------------------------
+// Min/max decimation of a column of plotted values.
+//
+// Level L keeps, for each bucket of 2^(L+1) values, the positions of its
+// minimum and of its maximum (NaN values are ignored), so a plot of any count
+// of frames needs about 2 positions per pixel and a spike of one frame is
+// always one of them. Levels are extended with the new values only, values
+// already summarized must not change.
+class StatsPyramid
+{
+public:
+    // Summarizes the values up to Count (excluded), from the first bucket not complete
+    void                        Update                      (const StatsValueColumn& Column, size_t Count);
+    void                        Clear                       ();
+    size_t                      Count                       () const {return Values_Count;}
+
+    // Positions of the values from Begin to End (excluded) to plot in Buckets buckets, in increasing order:
+    // all of them if there are less than 2 per bucket, else the minimum and the maximum of each bucket
+    void                        Positions                   (size_t Begin, size_t End, size_t Buckets, std::vector<uint32_t>& Result) const;
+
+private:
+    struct bucket
+    {
+        uint32_t                Min;
+        uint32_t                Max;
+    };
+    std::vector<std::vector<bucket>> Levels;
+    size_t                      Values_Count=0;
+};
+
+#endif // StatsPyramid_H
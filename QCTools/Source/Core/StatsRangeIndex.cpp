@@ -0,0 +1,143 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsRangeIndex.h"
+#include "Core/StatsColumn.h"
+#include <algorithm>
+#include <cmath>
+
+//***************************************************************************
+// Aggregate
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsRangeIndex::range::Add(const range& Other)
+{
+    if (Other.Min<Min)
+        Min=Other.Min;
+    if (Other.Max>Max)
+        Max=Other.Max;
+    Sum+=Other.Sum;
+    Count+=Other.Count;
+    Above+=Other.Above;
+    Above2+=Other.Above2;
+}
+
+//---------------------------------------------------------------------------
+void StatsRangeIndex::Add(range& Result, const StatsValueColumn& Column, size_t Begin, size_t End) const
+{
+    for (size_t Pos=Begin; Pos<End; Pos++)
+    {
+        double Value=Column[Pos];
+        if (std::isnan(Value))
+            continue;
+        if (!std::isinf(Value))
+        {
+            if (Value<Result.Min)
+                Result.Min=Value;
+            if (Value>Result.Max)
+                Result.Max=Value;
+        }
+        Result.Sum+=Value;
+        Result.Count++;
+        if (Value>Limit)
+            Result.Above++;
+        if (Value>Limit2)
+            Result.Above2++;
+    }
+}
+
+//***************************************************************************
+// Build
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsRangeIndex::Update(const StatsValueColumn& Column, size_t Count, double Limit_, double Limit2_)
+{
+    if (Count<Values_Count || Limit_!=Limit || Limit2_!=Limit2)
+    {
+        Clear();
+        Limit=Limit_;
+        Limit2=Limit2_;
+    }
+    if (Count==Values_Count)
+        return;
+
+    // Level 0, the complete blocks only, the last values are read from the column by Get()
+    if (Levels.empty())
+        Levels.emplace_back();
+    size_t Begin=Levels[0].size();
+    size_t End=Count>>Block_Shift;
+    Levels[0].resize(End);
+    for (size_t Pos=Begin; Pos<End; Pos++)
+        Add(Levels[0][Pos], Column, Pos<<Block_Shift, (Pos+1)<<Block_Shift);
+
+    // Next levels merge 2 blocks of the previous one, complete pairs only
+    for (size_t Level=1; Levels[Level-1].size()>1; Level++)
+    {
+        if (Level==Levels.size())
+            Levels.emplace_back();
+        const std::vector<range>& Previous=Levels[Level-1];
+        std::vector<range>& Current=Levels[Level];
+        Begin=Current.size();
+        End=Previous.size()/2;
+        Current.resize(End);
+        for (size_t Pos=Begin; Pos<End; Pos++)
+        {
+            Current[Pos]=Previous[Pos*2];
+            Current[Pos].Add(Previous[Pos*2+1]);
+        }
+    }
+
+    Values_Count=Count;
+}
+
+//---------------------------------------------------------------------------
+void StatsRangeIndex::Clear()
+{
+    Levels.clear();
+    Values_Count=0;
+}
+
+//***************************************************************************
+// Query
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsRangeIndex::range StatsRangeIndex::Get(const StatsValueColumn& Column, size_t Begin, size_t End) const
+{
+    range Result;
+    End=std::min(End, Values_Count);
+    if (Begin>=End)
+        return Result;
+
+    // Complete blocks of the range
+    size_t Block_Size=(size_t)1<<Block_Shift;
+    size_t First=(Begin+Block_Size-1)>>Block_Shift;
+    size_t Last=End>>Block_Shift;
+    if (First>=Last)
+    {
+        Add(Result, Column, Begin, End);
+        return Result;
+    }
+    Add(Result, Column, Begin, First<<Block_Shift);
+    Add(Result, Column, Last<<Block_Shift, End);
+
+    // At most 2 blocks per level, the parent of 2 blocks of the range is taken instead of them
+    for (size_t Level=0; First<Last; Level++)
+    {
+        const std::vector<range>& Current=Levels[Level];
+        if (First&1)
+            Result.Add(Current[First++]);
+        if (Last&1)
+            Result.Add(Current[--Last]);
+        First>>=1;
+        Last>>=1;
+    }
+
+    return Result;
+}
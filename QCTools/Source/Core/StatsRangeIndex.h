@@ -0,0 +1,62 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsRangeIndex_H
+#define StatsRangeIndex_H
+
+#include <cfloat>
+#include <cstddef>
+#include <vector>
+
+class StatsValueColumn;
+
+//---------------------------------------------------------------------------
+// Aggregates (minimum, maximum, sum, counts over the limits of the item) of
+// any range of a column of values.
+//
+// Level L keeps the aggregate of each block of 64<<L values (NaN values are
+// ignored). A range is the values before its first complete block and after
+// its last one, read from the column, plus at most 2 blocks per level, so a
+// query reads less than 128 values and 2 blocks per level whatever its
+// length. Levels are extended with the new values only, values already
+// summarized must not change.
+class StatsRangeIndex
+{
+public:
+    struct range
+    {
+        double                  Min=DBL_MAX;                // Infinite values excepted, DBL_MAX if none
+        double                  Max=-DBL_MAX;               // Infinite values excepted, -DBL_MAX if none
+        double                  Sum=0;
+        size_t                  Count=0;                    // Values not NaN
+        size_t                  Above=0;                    // Values greater than Limit
+        size_t                  Above2=0;                   // Values greater than Limit2
+
+        double                  Mean                        () const {return Count?Sum/Count:0;}
+        void                    Add                         (const range& Other);
+    };
+
+    // Summarizes the values up to Count (excluded), from the first block not complete
+    // Values are counted in Above if greater than Limit, in Above2 if greater than Limit2 (DBL_MAX for none)
+    void                        Update                      (const StatsValueColumn& Column, size_t Count, double Limit=DBL_MAX, double Limit2=DBL_MAX);
+    void                        Clear                       ();
+    size_t                      Count                       () const {return Values_Count;}
+
+    // Aggregate of the values from Begin to End (excluded), End is limited to Count()
+    range                       Get                         (const StatsValueColumn& Column, size_t Begin, size_t End) const;
+
+private:
+    void                        Add                         (range& Result, const StatsValueColumn& Column, size_t Begin, size_t End) const;
+
+    static const size_t         Block_Shift=6;
+    std::vector<std::vector<range>> Levels;
+    size_t                      Values_Count=0;
+    double                      Limit=DBL_MAX;
+    double                      Limit2=DBL_MAX;
+};
+
+#endif // StatsRangeIndex_H
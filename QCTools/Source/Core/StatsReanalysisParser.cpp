@@ -0,0 +1,223 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsReanalysisParser.h"
+#include "Core/FileInformation.h"
+#include "Core/CommonStats.h"
+#include "Core/VideoStats.h"
+#include "Core/AudioStats.h"
+#include "Core/ReadaheadDevice.h"
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include <qavplayer.h>
+#include <qavvideoframe.h>
+#include <qavaudioframe.h>
+#include <QEventLoop>
+#include <QDebug>
+
+//---------------------------------------------------------------------------
+static const char Video_Output[]="stats";
+static const char Audio_Output[]="astats";
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsReanalysisParser::StatsReanalysisParser(const QString& FileName, const std::vector<CommonStats*>& Stats_, const activefilters& Filters_,
+                                             const QString& VideoFilter, const QString& AudioFilter, const FinishedHandler& Finished_) :
+    Stats(Stats_),
+    Filters(Filters_),
+    Finished(Finished_)
+{
+    Player.reset(new QAVPlayer());
+    FileInformation::ParsingThreads_Apply(Player.get(), 1);
+    if (!Load(FileName, VideoFilter, AudioFilter))
+    {
+        // Not usable, the report is kept as is
+        qDebug() << "re-analysis:" << FileName << "can not be loaded with the streams of the report";
+        Player.reset();
+        Parsed.clear();
+    }
+}
+
+//---------------------------------------------------------------------------
+StatsReanalysisParser::~StatsReanalysisParser()
+{
+    // The player uses the stats
+    Player.reset();
+}
+
+//***************************************************************************
+// Control
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsReanalysisParser::Start()
+{
+    if (IsStarted || !Player)
+        return;
+    IsStarted=true;
+
+    Player->play();
+}
+
+//---------------------------------------------------------------------------
+void StatsReanalysisParser::ThreadPriority_Set(QThread::Priority Priority)
+{
+    if (Player)
+        Player->setThreadPriority(Priority);
+}
+
+//---------------------------------------------------------------------------
+void StatsReanalysisParser::Paused_Set(bool Paused)
+{
+    // A player paused at the end of the media would seek to the start
+    if (!IsStarted || !Player || IsEnded || Player->mediaStatus()==QAVPlayer::EndOfMedia)
+        return;
+    if (Paused)
+        Player->pause();
+    else
+        Player->play();
+}
+
+//***************************************************************************
+// Helpers
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsReanalysisParser::Load(const QString& FileName, const QString& VideoFilter, const QString& AudioFilter)
+{
+    QEventLoop loop;
+    QMetaObject::Connection c;
+    c = connect(Player.get(), &QAVPlayer::mediaStatusChanged, this, [&]() {
+        loop.exit();
+        QObject::disconnect(c);
+    });
+    Player->setSource(FileName, ReadaheadDevice::Create(FileName));
+    Player->setSynced(false);
+    loop.exec();
+    if (Player->mediaStatus()!=QAVPlayer::LoadedMedia)
+        return false;
+
+    // Same streams as the report for the types with filters, the frames are matched by position
+    Parsed.resize(Stats.size());
+    QList<QAVStream> Video;
+    for (auto& Stream : Player->availableVideoStreams())
+    {
+        size_t Index=Stream.index();
+        if (VideoFilter.isEmpty() || Index>=Stats.size() || !Stats[Index] || Stats[Index]->Type_Get()!=Type_Video)
+            continue;
+        Video.append(Stream);
+        Parsed[Index].reset(new VideoStats(Stats[Index]->x_Current, 0, &Stream));
+    }
+    QList<QAVStream> Audio;
+    for (auto& Stream : Player->availableAudioStreams())
+    {
+        size_t Index=Stream.index();
+        if (AudioFilter.isEmpty() || Index>=Stats.size() || !Stats[Index] || Stats[Index]->Type_Get()!=Type_Audio)
+            continue;
+        Audio.append(Stream);
+        Parsed[Index].reset(new AudioStats(Stats[Index]->x_Current, 0, &Stream));
+    }
+    for (size_t Index=0; Index<Stats.size(); Index++)
+        if (Stats[Index] && !Parsed[Index] && !(Stats[Index]->Type_Get()==Type_Video?VideoFilter:AudioFilter).isEmpty())
+            return false;
+    if (Video.empty() && Audio.empty())
+        return false;
+    Player->setVideoStreams(Video);
+    Player->setAudioStreams(Audio);
+    Player->setStreamThreads(Video.size()>1 || Audio.size()>1);
+
+    QList<QString> Graphs;
+    if (!Video.empty())
+        Graphs.append(QString("%1 [%2]").arg(VideoFilter).arg(Video_Output));
+    if (!Audio.empty())
+        Graphs.append(QString("%1 [%2]").arg(AudioFilter).arg(Audio_Output));
+    Player->setFilters(Graphs);
+
+    for (auto& Stat : Parsed)
+        if (Stat)
+        {
+            Stat->AdditionalStats_Declare(Filters);
+            FileInformation::FrameHash_Declare(Stat.get());
+        }
+
+    // Frames are handled by the player threads
+    connect(Player.get(), &QAVPlayer::videoFrame, Player.get(), [this](const QAVVideoFrame& frame) {
+            if (frame.filterName()==QLatin1String(Video_Output))
+                Frame(frame, frame.size().width(), frame.size().height());
+        },
+        Qt::DirectConnection
+        );
+    connect(Player.get(), &QAVPlayer::audioFrame, Player.get(), [this](const QAVAudioFrame& frame) {
+            if (frame.filterName()==QLatin1String(Audio_Output))
+                Frame(frame, 0, 0);
+        },
+        Qt::DirectConnection
+        );
+    connect(Player.get(), &QAVPlayer::mediaStatusChanged, Player.get(), [this](QAVPlayer::MediaStatus status) {
+            if (status==QAVPlayer::EndOfMedia)
+                End(true);
+            else if (status==QAVPlayer::InvalidMedia)
+                End(false);
+        },
+        Qt::DirectConnection
+        );
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Player threads, each stream has stats of its own
+void StatsReanalysisParser::Frame(const QAVFrame& Frame, int Width, int Height)
+{
+    size_t Index=Frame.stream().index();
+    if (IsEnded || Index>=Parsed.size() || !Parsed[Index])
+        return;
+
+    CommonStats* Stat=Parsed[Index].get();
+    Stat->TimeStampFromFrame(Frame, Stat->x_Current);
+    Stat->StatsFromFrame(Frame, Width, Height);
+}
+
+//---------------------------------------------------------------------------
+// Player thread
+void StatsReanalysisParser::End(bool IsOk)
+{
+    if (IsEnded.exchange(true))
+        return;
+
+    // Player is stopped and stats merged by the thread of this object, not from a player callback
+    QMetaObject::invokeMethod(this, "parsed", Qt::QueuedConnection, Q_ARG(bool, IsOk));
+}
+
+//---------------------------------------------------------------------------
+void StatsReanalysisParser::parsed(bool IsOk)
+{
+    if (Player)
+        Player->stop();
+
+    if (IsOk)
+    {
+        for (size_t Pos=0; Pos<Stats.size() && Pos<Parsed.size(); Pos++)
+        {
+            if (!Stats[Pos] || !Parsed[Pos])
+                continue;
+            if (Parsed[Pos]->x_Current!=Stats[Pos]->x_Current)
+                qWarning() << "re-analysis: stream" << Pos << "has" << Parsed[Pos]->x_Current << "frames, the report" << Stats[Pos]->x_Current << ", values merged up to the shortest";
+            Stats[Pos]->Merge(*Parsed[Pos], Filters);
+        }
+    }
+    else
+        qDebug() << "re-analysis: parsing failed, the report is kept as is";
+
+    Player.reset();
+    Parsed.clear();
+    Finished(IsOk);
+}
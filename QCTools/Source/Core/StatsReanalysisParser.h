@@ -0,0 +1,72 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsReanalysisParser_H
+#define StatsReanalysisParser_H
+
+#include "Core/Core.h"
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QAVPlayer;
+class QAVFrame;
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Parsing of the media of a report with the filters the report does not
+// have only (incremental re-analysis, see FileInformation::Reanalysis_Set).
+//
+// The streams of the report of the types with filters to run are decoded
+// again by one player, without thumbnails and panels, in stats of their own. Once the file is parsed,
+// the values of the filters and the new additional stats are merged frame by
+// frame in the stats of the report (see CommonStats::Merge), so the cost is
+// the one of the decoding and of the filters added.
+class StatsReanalysisParser : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(bool IsOk)> FinishedHandler;
+
+    // Stats are the ones of the report, indexed by stream index; Filters are the ones run by the video and audio filters
+                                StatsReanalysisParser       (const QString& FileName, const std::vector<CommonStats*>& Stats, const activefilters& Filters,
+                                                             const QString& VideoFilter, const QString& AudioFilter, const FinishedHandler& Finished);
+                                ~StatsReanalysisParser      ();
+
+    // The media is loaded with the streams of the report
+    bool                        IsValid                     () const {return Player!=nullptr;}
+
+    void                        Start                       ();
+    // Of the threads of the player, see QAVPlayer::setThreadPriority()
+    void                        ThreadPriority_Set          (QThread::Priority Priority);
+    // Player paused at a frame boundary or played again, see FileInformation::setParsingPaused()
+    void                        Paused_Set                  (bool Paused);
+
+private Q_SLOTS:
+    void                        parsed                      (bool IsOk);
+
+private:
+    bool                        Load                        (const QString& FileName, const QString& VideoFilter, const QString& AudioFilter);
+    void                        Frame                       (const QAVFrame& Frame, int Width, int Height);
+    void                        End                         (bool IsOk);
+
+    std::unique_ptr<QAVPlayer>  Player;
+    std::vector<CommonStats*>   Stats;
+    std::vector<std::unique_ptr<CommonStats>> Parsed;       // Per stream index, as Stats
+    activefilters               Filters;
+    FinishedHandler             Finished;
+    std::atomic<bool>           IsEnded {false};
+    bool                        IsStarted {false};
+};
+
+#endif // StatsReanalysisParser_H
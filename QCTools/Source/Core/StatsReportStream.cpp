@@ -0,0 +1,122 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsReportStream.h"
+#include "Core/StatsGzipMembers.h"
+#include "Core/CommonStats.h"
+//---------------------------------------------------------------------------
+
+#include <QIODevice>
+#include <QMutexLocker>
+#include <algorithm>
+
+//---------------------------------------------------------------------------
+static const size_t  Batch_Size=1024; //Frames, arbitrary chosen
+static const unsigned long Poll_Interval=100; //Milliseconds, arbitrary chosen
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsReportStream::StatsReportStream(QIODevice& Output_, bool IsCompressed, const std::vector<CommonStats*>& Stats_, const activefilters& Filters_) :
+    Gzip(IsCompressed?new StatsGzipMembersWriter(Output_):nullptr),
+    Output(Output_),
+    Writer([this](const char* Data, size_t Size) {
+        return Gzip?Gzip->Append(Data, Size):Output.write(Data, Size)==(qint64)Size;
+    }),
+    Stats(Stats_),
+    Stats_Done(Stats_.size()),
+    Filters(Filters_)
+{
+}
+
+//---------------------------------------------------------------------------
+StatsReportStream::~StatsReportStream()
+{
+    // Parsing stopped before the end, the report is not usable and the stats may be deleted soon
+    {
+        QMutexLocker Lock(&Mutex);
+        IsFinishing=true;
+        IsCancelled=true;
+        Condition.wakeAll();
+    }
+    wait();
+}
+
+//***************************************************************************
+// Control
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsReportStream::Start(const std::string& Header)
+{
+    Writer.Text(Header);
+    start();
+}
+
+//---------------------------------------------------------------------------
+bool StatsReportStream::Finish(const std::string& Footer)
+{
+    {
+        QMutexLocker Lock(&Mutex);
+        IsFinishing=true;
+        Condition.wakeAll();
+    }
+    wait();
+
+    Writer.Text(Footer);
+    bool IsOk=Writer.Finish();
+    if (Gzip && !Gzip->Finish())
+        IsOk=false;
+    return IsOk;
+}
+
+//***************************************************************************
+// Thread
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsReportStream::run()
+{
+    for (;;)
+    {
+        bool IsLast;
+        {
+            QMutexLocker Lock(&Mutex);
+            if (!IsFinishing)
+                Condition.wait(&Mutex, Poll_Interval);
+            if (IsCancelled)
+                break;
+            IsLast=IsFinishing;
+        }
+
+        Export(IsLast);
+        if (IsLast)
+            break;
+    }
+}
+
+//---------------------------------------------------------------------------
+void StatsReportStream::Export(bool IsLast)
+{
+    for (size_t Pos=0; Pos<Stats.size(); Pos++)
+    {
+        if (!Stats[Pos])
+            continue;
+
+        // Only full batches while parsing, so the frames of a stream stay mostly contiguous
+        size_t& Done=Stats_Done[Pos];
+        size_t End=Stats[Pos]->x_Current;
+        while (End-Done>=Batch_Size || (IsLast && Done<End))
+        {
+            size_t Batch_End=std::min(Done+Batch_Size, End);
+            Stats[Pos]->StatsToXML(Writer, Filters, Done, Batch_End);
+            Done=Batch_End;
+        }
+    }
+}
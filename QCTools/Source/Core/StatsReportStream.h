@@ -0,0 +1,69 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsReportStream_H
+#define StatsReportStream_H
+
+#include "Core/Core.h"
+#include "Core/StatsXmlWriter.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <memory>
+#include <string>
+#include <vector>
+
+class QIODevice;
+class CommonStats;
+class StatsGzipMembersWriter;
+
+//---------------------------------------------------------------------------
+// Report export running while the media is parsed.
+//
+// The thread polls the stats and serializes the frames already complete in
+// batches (per stream, so <frame> elements of different streams are
+// interleaved by batch), writing the XML directly or through gzip members.
+// When parsing is finished, Finish() serializes the last frames and appends
+// the streams/format part, so nearly nothing is left to do after the last
+// frame and the XML text is never in memory.
+// Frames are read while the parser thread adds the next ones, as the plots
+// do (StatsColumn allows it).
+class StatsReportStream : public QThread
+{
+public:
+                                StatsReportStream           (QIODevice& Output, bool IsCompressed, const std::vector<CommonStats*>& Stats, const activefilters& Filters);
+                                ~StatsReportStream          ();
+
+    // Header is the XML up to <frames>
+    void                        Start                       (const std::string& Header);
+
+    // Stats must be complete, Footer is the XML from </frames>
+    bool                        Finish                      (const std::string& Footer);
+
+    uint64_t                    framesCount                 () const {return Writer.framesCount();}
+
+protected:
+    void                        run                         ();
+
+private:
+    void                        Export                      (bool IsLast);
+
+    std::unique_ptr<StatsGzipMembersWriter> Gzip;
+    QIODevice&                  Output;
+    StatsXmlWriter              Writer;
+    std::vector<CommonStats*>   Stats;
+    std::vector<size_t>         Stats_Done;                 // Per stream, count of frames already serialized
+    activefilters               Filters;
+
+    QMutex                      Mutex;
+    QWaitCondition              Condition;
+    bool                        IsFinishing {false};
+    bool                        IsCancelled {false};
+};
+
+#endif // StatsReportStream_H
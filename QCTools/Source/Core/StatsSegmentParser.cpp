@@ -0,0 +1,442 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsSegmentParser.h"
+#include "Core/FileInformation.h"
+#include "Core/CommonStats.h"
+#include "Core/VideoStats.h"
+#include "Core/AudioStats.h"
+#include "Core/ReadaheadDevice.h"
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+}
+
+#include <qavplayer.h>
+#include <qavvideoframe.h>
+#include <qavaudioframe.h>
+#include <qavdemuxer_p.h>
+#include <QEventLoop>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//---------------------------------------------------------------------------
+const double StatsSegmentParser::Warmup=5; // Seconds, covers the windows of the stats filters (deflicker, idet, astats...)
+
+static const char Video_Output[]="stats";
+static const char Audio_Output[]="astats";
+
+//---------------------------------------------------------------------------
+struct StatsSegmentParser::segment
+{
+    int                         Index;
+    double                      Begin;                      // Time stamp of the first frame, frames before are warm-up
+    double                      End;                        // Time stamp of the first frame of the next segment
+    std::unique_ptr<QAVPlayer>  Player;
+    std::vector<CommonStats*>   Stats;                      // Per stream index, owned except for the first segment
+    std::vector<bool>           Streams_Ended;
+    size_t                      Streams_Count {0};
+    size_t                      Streams_EndedCount {0};
+    QMutex                      Mutex;
+    bool                        IsEnded {false};
+    bool                        IsOk {true};
+
+    void Release()
+    {
+        Player.reset();
+        if (Index)
+            for (auto Stat : Stats)
+                delete Stat;
+        Stats.clear();
+    }
+};
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsSegmentParser::StatsSegmentParser(const QString& FileName, const std::vector<CommonStats*>& Stats_,
+                                       const QVector<int>& VideoStreams, const QVector<int>& AudioStreams,
+                                       const QString& VideoFilter, const QString& AudioFilter,
+                                       double Duration, int Count_, const FinishedHandler& Finished_) :
+    Stats(Stats_),
+    Finished(Finished_)
+{
+    // Segments must be long enough to be worth the warm-up
+    int Count_Max=(int)(Duration/(Warmup*4));
+    if (Count_>Count_Max)
+        Count_=Count_Max;
+    if (Count_<2 || VideoStreams.empty())
+        return;
+
+    // Boundaries are video key frames, so a segment does not need data before it except for the warm-up
+    std::vector<double> Boundaries=KeyFrames(FileName, VideoStreams.front(), Duration, Count_, std::vector<double>());
+    if (Boundaries.empty())
+        return;
+
+    for (size_t Pos=0; Pos<=Boundaries.size(); Pos++)
+    {
+        std::unique_ptr<segment> Segment(new segment);
+        Segment->Index=Pos;
+        Segment->Begin=Pos?Boundaries[Pos-1]:-std::numeric_limits<double>::infinity();
+        Segment->End=Pos<Boundaries.size()?Boundaries[Pos]:std::numeric_limits<double>::infinity();
+        Segment->Player.reset(new QAVPlayer());
+        Segments.push_back(std::move(Segment));
+    }
+
+    for (auto& Segment : Segments)
+    {
+        FileInformation::ParsingThreads_Apply(Segment->Player.get(), (int)Segments.size());
+        if (!Load(*Segment, FileName, VideoStreams, AudioStreams, VideoFilter, AudioFilter))
+        {
+            // Not usable, the usual parsing is used
+            qDebug() << "segmented parsing: segment" << Segment->Index << "can not be loaded";
+            for (auto& Segment_ToRelease : Segments)
+                Segment_ToRelease->Release();
+            Segments.clear();
+            return;
+        }
+    }
+
+    qDebug() << "segmented parsing:" << Segments.size() << "segments";
+}
+
+//---------------------------------------------------------------------------
+StatsSegmentParser::~StatsSegmentParser()
+{
+    // Players use the stats
+    for (auto& Segment : Segments)
+        Segment->Release();
+}
+
+//***************************************************************************
+// Control
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsSegmentParser::Start()
+{
+    if (IsStarted || Segments.empty())
+        return;
+    IsStarted=true;
+
+    for (auto& Segment : Segments)
+    {
+        // Positions are time stamps, as frame time stamps (a negative value would be from the end)
+        if (Segment->Index && Segment->Begin>Warmup)
+            Segment->Player->seek((qint64)((Segment->Begin-Warmup)*1000));
+        Segment->Player->play();
+    }
+}
+
+//---------------------------------------------------------------------------
+void StatsSegmentParser::ThreadPriority_Set(QThread::Priority Priority)
+{
+    // Ended segments have no player
+    for (auto& Segment : Segments)
+        if (Segment->Player)
+            Segment->Player->setThreadPriority(Priority);
+}
+
+//---------------------------------------------------------------------------
+void StatsSegmentParser::Paused_Set(bool Paused)
+{
+    // A player paused at the end of the media would seek to the start
+    for (auto& Segment : Segments)
+    {
+        {
+            // Not locked while the player waits for its threads, they lock it for each frame
+            QMutexLocker Lock(&Segment->Mutex);
+            if (Segment->IsEnded)
+                continue;
+        }
+        if (!Segment->Player || Segment->Player->mediaStatus()==QAVPlayer::EndOfMedia)
+            continue;
+        if (Paused)
+            Segment->Player->pause();
+        else
+            Segment->Player->play();
+    }
+}
+
+//***************************************************************************
+// Helpers
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+std::vector<double> StatsSegmentParser::Boundaries(const QString& FileName, int Count, const std::vector<double>& Shots)
+{
+    AVFormatContext* FormatContext=nullptr;
+    auto FileName_String=FileName.toStdString();
+    if (avformat_open_input(&FormatContext, FileName_String.c_str(), nullptr, nullptr)<0)
+        return std::vector<double>();
+
+    int VideoStream=-1;
+    double Duration=0;
+    if (QAVDemuxer::findStreamInfo(FormatContext, FileInformation::FastProbe_Get())>=0)
+    {
+        VideoStream=av_find_best_stream(FormatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (FormatContext->duration!=AV_NOPTS_VALUE)
+            Duration=(double)FormatContext->duration/AV_TIME_BASE;
+    }
+    avformat_close_input(&FormatContext);
+
+    // Same limit as the segments, parts must be long enough to be worth the warm-up
+    Count=std::min(Count, (int)(Duration/(Warmup*4)));
+    if (VideoStream<0 || Count<2)
+        return std::vector<double>();
+    return KeyFrames(FileName, VideoStream, Duration, Count, Shots);
+}
+
+//---------------------------------------------------------------------------
+std::vector<double> StatsSegmentParser::KeyFrames(const QString& FileName, int VideoStream, double Duration, int Count, const std::vector<double>& Shots)
+{
+    std::vector<double> Boundaries;
+
+    AVFormatContext* FormatContext=nullptr;
+    auto FileName_String=FileName.toStdString();
+    if (avformat_open_input(&FormatContext, FileName_String.c_str(), nullptr, nullptr)<0)
+        return Boundaries;
+
+    if (QAVDemuxer::findStreamInfo(FormatContext, FileInformation::FastProbe_Get())>=0 && VideoStream>=0 && VideoStream<(int)FormatContext->nb_streams)
+    {
+        AVStream* Stream=FormatContext->streams[VideoStream];
+        double TimeBase=av_q2d(Stream->time_base);
+        double Start=Stream->start_time!=AV_NOPTS_VALUE?Stream->start_time*TimeBase:0;
+        double Previous=Start;
+        AVPacket* Packet=av_packet_alloc();
+
+        for (int Pos=1; Pos<Count; Pos++)
+        {
+            double Target=Start+Duration*Pos/Count;
+
+            // Nearest shot within a quarter of a part
+            auto Shot=std::lower_bound(Shots.begin(), Shots.end(), Target);
+            double Nearest=Shot!=Shots.end()?*Shot:NAN;
+            if (Shot!=Shots.begin() && !(Nearest-Target<Target-*(Shot-1)))
+                Nearest=*(Shot-1);
+            if (std::abs(Nearest-Target)<=Duration/Count/4)
+                Target=Nearest;
+
+            if (av_seek_frame(FormatContext, VideoStream, (int64_t)(Target/TimeBase), AVSEEK_FLAG_BACKWARD)<0)
+                break;
+
+            // First key frame from the seek point
+            double KeyFrame=NAN;
+            while (std::isnan(KeyFrame) && av_read_frame(FormatContext, Packet)>=0)
+            {
+                if (Packet->stream_index==VideoStream && (Packet->flags&AV_PKT_FLAG_KEY) && Packet->pts!=AV_NOPTS_VALUE)
+                    KeyFrame=Packet->pts*TimeBase;
+                av_packet_unref(Packet);
+            }
+            if (std::isnan(KeyFrame))
+                break;
+
+            // Sparse key frames may lead to the same one for several targets
+            if (KeyFrame-Previous<Warmup*2)
+                continue;
+            Boundaries.push_back(KeyFrame);
+            Previous=KeyFrame;
+        }
+
+        av_packet_free(&Packet);
+    }
+
+    avformat_close_input(&FormatContext);
+    return Boundaries;
+}
+
+//---------------------------------------------------------------------------
+bool StatsSegmentParser::Load(segment& Segment, const QString& FileName, const QVector<int>& VideoStreams, const QVector<int>& AudioStreams, const QString& VideoFilter, const QString& AudioFilter)
+{
+    QAVPlayer* Player=Segment.Player.get();
+
+    QEventLoop loop;
+    QMetaObject::Connection c;
+    c = connect(Player, &QAVPlayer::mediaStatusChanged, this, [&]() {
+        loop.exit();
+        QObject::disconnect(c);
+    });
+    Player->setSource(FileName, ReadaheadDevice::Create(FileName));
+    Player->setSynced(false);
+    loop.exec();
+    if (Player->mediaStatus()!=QAVPlayer::LoadedMedia)
+        return false;
+
+    // Same streams as the main parser
+    QList<QAVStream> Video;
+    for (const auto& Stream : Player->availableVideoStreams())
+        if (VideoStreams.contains(Stream.index()))
+            Video.append(Stream);
+    QList<QAVStream> Audio;
+    for (const auto& Stream : Player->availableAudioStreams())
+        if (AudioStreams.contains(Stream.index()))
+            Audio.append(Stream);
+    if (Video.size()!=VideoStreams.size() || Audio.size()!=AudioStreams.size())
+        return false;
+    Player->setVideoStreams(Video);
+    Player->setAudioStreams(Audio);
+
+    QList<QString> Filters;
+    if (!VideoFilter.isEmpty() && !Video.empty())
+        Filters.append(QString("%1 [%2]").arg(VideoFilter).arg(Video_Output));
+    if (!AudioFilter.isEmpty() && !Audio.empty())
+        Filters.append(QString("%1 [%2]").arg(AudioFilter).arg(Audio_Output));
+    Player->setFilters(Filters);
+
+    // Stats, the first segment uses the final ones
+    if (!Segment.Index)
+        Segment.Stats=Stats;
+    else
+    {
+        Segment.Stats.resize(Stats.size());
+        for (auto& Stream : Video)
+            if ((size_t)Stream.index()<Stats.size() && Stats[Stream.index()])
+                Segment.Stats[Stream.index()]=new VideoStats(0, 0, &Stream);
+        for (auto& Stream : Audio)
+            if ((size_t)Stream.index()<Stats.size() && Stats[Stream.index()])
+                Segment.Stats[Stream.index()]=new AudioStats(0, 0, &Stream);
+        for (auto Stat : Segment.Stats)
+            if (Stat)
+                FileInformation::FrameHash_Declare(Stat);
+    }
+    Segment.Streams_Ended.resize(Segment.Stats.size());
+    for (auto Stat : Segment.Stats)
+        if (Stat)
+            Segment.Streams_Count++;
+
+    // Frames are handled by the player threads
+    segment* Segment_Ptr=&Segment;
+    connect(Player, &QAVPlayer::videoFrame, Player, [this, Segment_Ptr](const QAVVideoFrame& frame) {
+            if (frame.filterName()==QLatin1String(Video_Output))
+                Frame(*Segment_Ptr, frame, frame.pts(), frame.size().width(), frame.size().height());
+        },
+        Qt::DirectConnection
+        );
+    connect(Player, &QAVPlayer::audioFrame, Player, [this, Segment_Ptr](const QAVAudioFrame& frame) {
+            if (frame.filterName()==QLatin1String(Audio_Output))
+                Frame(*Segment_Ptr, frame, frame.pts(), 0, 0);
+        },
+        Qt::DirectConnection
+        );
+    connect(Player, &QAVPlayer::mediaStatusChanged, Player, [this, Segment_Ptr](QAVPlayer::MediaStatus status) {
+            if (status==QAVPlayer::EndOfMedia)
+                End(*Segment_Ptr, true);
+            else if (status==QAVPlayer::InvalidMedia)
+                End(*Segment_Ptr, false);
+        },
+        Qt::DirectConnection
+        );
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Player thread
+void StatsSegmentParser::Frame(segment& Segment, const QAVFrame& Frame, double TimeStamp, int Width, int Height)
+{
+    bool IsEnd=false;
+    {
+        QMutexLocker Lock(&Segment.Mutex);
+
+        int Index=Frame.stream().index();
+        if (Segment.IsEnded || Index<0 || (size_t)Index>=Segment.Stats.size() || !Segment.Stats[Index] || Segment.Streams_Ended[Index])
+            return;
+
+        // Warm-up, dropped (frames without time stamp are kept)
+        if (TimeStamp<Segment.Begin)
+            return;
+
+        if (TimeStamp>=Segment.End)
+        {
+            Segment.Streams_Ended[Index]=true;
+            Segment.Streams_EndedCount++;
+
+            // A stream shorter than the others (e.g. audio) must not make the segment parse until the end of the file
+            IsEnd=Segment.Streams_EndedCount==Segment.Streams_Count || TimeStamp>=Segment.End+Warmup;
+        }
+        else
+        {
+            CommonStats* Stat=Segment.Stats[Index];
+            Stat->TimeStampFromFrame(Frame, Stat->x_Current);
+            Stat->StatsFromFrame(Frame, Width, Height);
+        }
+    }
+
+    if (IsEnd)
+        End(Segment, true);
+}
+
+//---------------------------------------------------------------------------
+// Player thread
+void StatsSegmentParser::End(segment& Segment, bool IsOk)
+{
+    {
+        QMutexLocker Lock(&Segment.Mutex);
+        if (Segment.IsEnded)
+            return;
+        Segment.IsEnded=true;
+        Segment.IsOk=IsOk;
+    }
+
+    // Players are stopped and stats appended by the thread of this object, not from a player callback
+    QMetaObject::invokeMethod(this, "segmentEnded", Qt::QueuedConnection, Q_ARG(int, Segment.Index));
+}
+
+//---------------------------------------------------------------------------
+void StatsSegmentParser::segmentEnded(int Index)
+{
+    if (IsFinished)
+        return;
+
+    bool IsOk;
+    {
+        QMutexLocker Lock(&Segments[Index]->Mutex);
+        IsOk=Segments[Index]->IsOk;
+    }
+    if (Segments[Index]->Player)
+        Segments[Index]->Player->stop();
+
+    // Appended in frame order, as soon as all the previous segments are ended
+    while (IsOk && Segments_Appended<Segments.size())
+    {
+        segment& Segment=*Segments[Segments_Appended];
+        {
+            QMutexLocker Lock(&Segment.Mutex);
+            if (!Segment.IsEnded)
+                break;
+            IsOk=Segment.IsOk;
+        }
+        if (!IsOk)
+            break;
+
+        if (Segment.Index)
+            for (size_t Pos=0; Pos<Stats.size() && Pos<Segment.Stats.size(); Pos++)
+                if (Stats[Pos] && Segment.Stats[Pos])
+                    Stats[Pos]->Append(*Segment.Stats[Pos]);
+        Segment.Release();
+        Segments_Appended++;
+    }
+
+    if (!IsOk || Segments_Appended==Segments.size())
+    {
+        IsFinished=true;
+        for (auto& Segment : Segments)
+            Segment->Release();
+        if (!IsOk)
+            qDebug() << "segmented parsing: segment" << Index << "failed";
+        Finished(IsOk);
+    }
+}
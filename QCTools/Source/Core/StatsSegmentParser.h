@@ -0,0 +1,84 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsSegmentParser_H
+#define StatsSegmentParser_H
+
+#include <QObject>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QAVPlayer;
+class QAVFrame;
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Parsing of one file by several pipelines (demux, decode, stats filters),
+// each one on a time segment starting at a video key frame.
+//
+// The first segment fills the stats directly, the next ones fill their own
+// stats which are appended in frame order as soon as all the previous
+// segments are done. Stateful filters (entropy=mode=diff, idet, deflicker...)
+// get a warm-up: a segment starts decoding some seconds before its first
+// frame and the frames before it are dropped.
+// Only the stats filters are run, thumbnails and panels are not created.
+class StatsSegmentParser : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(bool IsOk)> FinishedHandler;
+
+    // Filters are the video and audio stats filter graphs, Stats is indexed by stream index
+                                StatsSegmentParser          (const QString& FileName, const std::vector<CommonStats*>& Stats,
+                                                             const QVector<int>& VideoStreams, const QVector<int>& AudioStreams,
+                                                             const QString& VideoFilter, const QString& AudioFilter,
+                                                             double Duration, int Count, const FinishedHandler& Finished);
+                                ~StatsSegmentParser         ();
+
+    // Count of segments really used, 1 means that splitting is not possible (short file, key frames not found...)
+    size_t                      Count                       () const {return Segments.size();}
+
+    void                        Start                       ();
+    // Of the threads of the players, see QAVPlayer::setThreadPriority()
+    void                        ThreadPriority_Set          (QThread::Priority Priority);
+    // Players of the segments not ended paused at a frame boundary or played again, see FileInformation::setParsingPaused()
+    void                        Paused_Set                  (bool Paused);
+
+    // Seconds of media parsed and dropped before each segment
+    static const double         Warmup;
+
+    // Time stamps of the video key frames splitting the file in up to Count parts (e.g. parsed by other hosts), empty if not possible
+    // Shots are the time stamps of the first frames of shots of the video (e.g. from a previous report, see StatsShots), in order:
+    // a part ends at the shot nearest to its end if it is close enough, as encoders usually put a key frame at the cuts
+    static std::vector<double>  Boundaries                  (const QString& FileName, int Count, const std::vector<double>& Shots=std::vector<double>());
+
+private Q_SLOTS:
+    void                        segmentEnded                (int Index);
+
+private:
+    struct segment;
+
+    static std::vector<double>  KeyFrames                   (const QString& FileName, int VideoStream, double Duration, int Count, const std::vector<double>& Shots);
+    bool                        Load                        (segment& Segment, const QString& FileName, const QVector<int>& VideoStreams, const QVector<int>& AudioStreams, const QString& VideoFilter, const QString& AudioFilter);
+    void                        Frame                       (segment& Segment, const QAVFrame& Frame, double TimeStamp, int Width, int Height);
+    void                        End                         (segment& Segment, bool IsOk);
+
+    std::vector<std::unique_ptr<segment>> Segments;
+    std::vector<CommonStats*>   Stats;
+    size_t                      Segments_Appended {0};
+    FinishedHandler             Finished;
+    bool                        IsStarted {false};
+    bool                        IsFinished {false};
+};
+
+#endif // StatsSegmentParser_H
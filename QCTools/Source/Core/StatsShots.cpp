@@ -0,0 +1,90 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsShots.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+
+//---------------------------------------------------------------------------
+// Default threshold of scdet
+const double StatsShots::Threshold=10;
+const double StatsShots::MinDuration=0.5;
+
+//***************************************************************************
+// Parsing
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsShots::Add(size_t Pos, double Time, double Difference)
+{
+    QMutexLocker Locker(&Mutex);
+    if (Pos!=Frames)
+        return;
+    Frames++;
+
+    if (std::isnan(Start_Time))
+        Start_Time=Time;
+    double Score=std::isnan(Previous)?NAN:std::min(Difference, std::abs(Difference-Previous));
+    Previous=Difference;
+    if (!(Score>=Threshold) || Time-Start_Time<MinDuration)
+        return;
+
+    Starts.push_back(Pos);
+    Start_Time=Time;
+}
+
+//---------------------------------------------------------------------------
+void StatsShots::Clear()
+{
+    QMutexLocker Locker(&Mutex);
+    Starts.clear();
+    Frames=0;
+    Previous=NAN;
+    Start_Time=NAN;
+}
+
+//***************************************************************************
+// Info
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+size_t StatsShots::Scanned() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Frames;
+}
+
+//---------------------------------------------------------------------------
+size_t StatsShots::Count() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Starts.size();
+}
+
+//---------------------------------------------------------------------------
+std::vector<size_t> StatsShots::Get() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Starts;
+}
+
+//---------------------------------------------------------------------------
+size_t StatsShots::Next(size_t Pos) const
+{
+    QMutexLocker Locker(&Mutex);
+    auto Start=std::lower_bound(Starts.begin(), Starts.end(), Pos);
+    return Start!=Starts.end()?*Start:(size_t)-1;
+}
+
+//---------------------------------------------------------------------------
+size_t StatsShots::Start(size_t Pos) const
+{
+    QMutexLocker Locker(&Mutex);
+    auto Start=std::upper_bound(Starts.begin(), Starts.end(), Pos);
+    return Start!=Starts.begin()?*(Start-1):0;
+}
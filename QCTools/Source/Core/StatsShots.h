@@ -0,0 +1,58 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsShots_H
+#define StatsShots_H
+
+#include <QMutex>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Shot boundaries of a video stream, the first frame of each shot after the
+// first one, found while the frames are added in frame order.
+//
+// The score of a frame is the one of the FFmpeg scdet filter: the minimum of
+// its difference with the previous frame (mean absolute difference of the
+// luma, in percent of the range of the samples) and of the change of this
+// difference from the one of the previous frame, so a steady motion is not a
+// cut. A frame with a score of Threshold or more starts a shot if the previous
+// shot lasts MinDuration or more. Frames without a difference (first frame,
+// filter not run) are not cuts.
+//
+// Read by any thread, the shots up to Scanned() are final.
+class StatsShots
+{
+public:
+    static const double         Threshold;
+    static const double         MinDuration;                // Seconds
+
+    // Frame Pos, at Time (seconds), with its difference in percent or NaN; Pos is Scanned()
+    void                        Add                         (size_t Pos, double Time, double Difference);
+    void                        Clear                       ();
+
+    // Count of frames added
+    size_t                      Scanned                     () const;
+    // Count of shots, the first one excluded
+    size_t                      Count                       () const;
+    // First frames of the shots after the first one, in frame order
+    std::vector<size_t>         Get                         () const;
+    // First frame of a shot from Pos, (size_t)-1 if none (yet)
+    size_t                      Next                        (size_t Pos) const;
+    // First frame of the shot of the frame Pos, 0 for the first shot
+    size_t                      Start                       (size_t Pos) const;
+
+private:
+    mutable QMutex              Mutex;
+    std::vector<size_t>         Starts;
+    size_t                      Frames=0;
+    double                      Previous=std::numeric_limits<double>::quiet_NaN(); // Difference of the previous frame
+    double                      Start_Time=std::numeric_limits<double>::quiet_NaN(); // Of the current shot, NaN before the first frame
+};
+
+#endif // StatsShots_H
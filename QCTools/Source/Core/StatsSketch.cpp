@@ -0,0 +1,286 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsSketch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+//***************************************************************************
+// Scale function (k1)
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const double Pi=3.14159265358979323846;
+
+double K(double Q)
+{
+    return StatsSketch::Compression/(2*Pi)*std::asin(2*Q-1);
+}
+
+double K_Inverse(double Value)
+{
+    return (std::sin(Value*2*Pi/StatsSketch::Compression)+1)/2;
+}
+
+// Values buffered before they are merged in the centroids
+const size_t Buffer_Max=5*StatsSketch::Compression;
+
+// Smallest width of the bins, 2^-16
+const double Width_Min=1.0/65536;
+
+}
+
+//***************************************************************************
+// Build
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsSketch::Add(double Value, double Duration)
+{
+    if (!std::isfinite(Value))
+        return;
+
+    // t-digest
+    if (!Values_Count || Value<Values_Min)
+        Values_Min=Value;
+    if (!Values_Count || Value>Values_Max)
+        Values_Max=Value;
+    Values_Count++;
+    Buffer.push_back(centroid{Value, 1});
+    if (Buffer.size()>=Buffer_Max)
+    {
+        Buffer.insert(Buffer.end(), Digest.begin(), Digest.end());
+        Compress(Buffer, Digest);
+        Buffer.clear();
+    }
+
+    // Histogram
+    if (!Width)
+    {
+        Width=Width_Min;
+        Origin=std::floor(Value/Width)*Width;
+        Histogram.assign(BinsCount, bin());
+    }
+    Fit(Value);
+    size_t Pos=std::min((size_t)((Value-Origin)/Width), BinsCount-1);
+    Histogram[Pos].Count++;
+    Histogram[Pos].Duration+=Duration;
+}
+
+//---------------------------------------------------------------------------
+void StatsSketch::Merge(const StatsSketch& Other)
+{
+    if (!Other.Values_Count)
+        return;
+    if (!Values_Count)
+    {
+        *this=Other;
+        return;
+    }
+
+    // t-digest
+    Values_Min=std::min(Values_Min, Other.Values_Min);
+    Values_Max=std::max(Values_Max, Other.Values_Max);
+    Values_Count+=Other.Values_Count;
+    Buffer.insert(Buffer.end(), Digest.begin(), Digest.end());
+    Buffer.insert(Buffer.end(), Other.Digest.begin(), Other.Digest.end());
+    Buffer.insert(Buffer.end(), Other.Buffer.begin(), Other.Buffer.end());
+    Compress(Buffer, Digest);
+    Buffer.clear();
+
+    // Histogram, the bins are aligned so a bin of the other one is in one bin once this one is as wide
+    while (Width<Other.Width)
+        Widen();
+    for (size_t Pos=0; Pos<BinsCount; Pos++)
+    {
+        const bin& Bin=Other.Histogram[Pos];
+        if (!Bin.Count)
+            continue;
+        double Center=Other.Origin+(Pos+0.5)*Other.Width;
+        Fit(Center);
+        bin& Target=Histogram[std::min((size_t)((Center-Origin)/Width), BinsCount-1)];
+        Target.Count+=Bin.Count;
+        Target.Duration+=Bin.Duration;
+    }
+}
+
+//---------------------------------------------------------------------------
+void StatsSketch::Clear()
+{
+    *this=StatsSketch();
+}
+
+//---------------------------------------------------------------------------
+void StatsSketch::Compress(std::vector<centroid>& Values, std::vector<centroid>& Result)
+{
+    std::sort(Values.begin(), Values.end(), [](const centroid& A, const centroid& B) {return A.Mean<B.Mean;});
+    double Total=0;
+    for (const auto& Value : Values)
+        Total+=Value.Weight;
+
+    // Neighbours are merged while the centroid stays within one unit of the scale function
+    Result.clear();
+    if (Values.empty())
+        return;
+    centroid Current=Values[0];
+    double Weight_Before=0;
+    double Q_Limit=K_Inverse(K(0)+1);
+    for (size_t Pos=1; Pos<Values.size(); Pos++)
+    {
+        const centroid& Value=Values[Pos];
+        if ((Weight_Before+Current.Weight+Value.Weight)/Total<=Q_Limit)
+        {
+            Current.Weight+=Value.Weight;
+            Current.Mean+=(Value.Mean-Current.Mean)*Value.Weight/Current.Weight;
+        }
+        else
+        {
+            Result.push_back(Current);
+            Weight_Before+=Current.Weight;
+            Q_Limit=K_Inverse(K(Weight_Before/Total)+1);
+            Current=Value;
+        }
+    }
+    Result.push_back(Current);
+}
+
+//---------------------------------------------------------------------------
+void StatsSketch::Fit(double Value)
+{
+    while (Value<Origin || Value>=Origin+BinsCount*Width)
+    {
+        // Bins are moved if the value and the bins not empty are in BinsCount bins, else widened
+        size_t First=0;
+        while (First<BinsCount && !Histogram[First].Count)
+            First++;
+        size_t Last=BinsCount;
+        while (Last>First && !Histogram[Last-1].Count)
+            Last--;
+        double Value_Begin=std::floor(Value/Width)*Width;
+        if (First==Last)
+        {
+            Origin=Value_Begin;
+            return;
+        }
+        double Begin=std::min(Origin+First*Width, Value_Begin);
+        double End=std::max(Origin+Last*Width, Value_Begin+Width);
+        if (End-Begin>BinsCount*Width)
+        {
+            Widen();
+            continue;
+        }
+        double NewOrigin=Value<Origin?Begin:(End-BinsCount*Width);
+        std::vector<bin> NewHistogram(BinsCount);
+        long long Shift=std::llround((Origin-NewOrigin)/Width);
+        for (size_t Pos=First; Pos<Last; Pos++)
+            NewHistogram[(size_t)((long long)Pos+Shift)]=Histogram[Pos];
+        Histogram.swap(NewHistogram);
+        Origin=NewOrigin;
+    }
+}
+
+//---------------------------------------------------------------------------
+void StatsSketch::Widen()
+{
+    // Origin stays a multiple of the width, exact as both are powers of 2 multiples
+    double NewWidth=Width*2;
+    double NewOrigin=std::floor(Origin/NewWidth)*NewWidth;
+    size_t Offset=(size_t)std::llround((Origin-NewOrigin)/Width); // 0 or 1
+    std::vector<bin> NewHistogram(BinsCount);
+    for (size_t Pos=0; Pos<BinsCount; Pos++)
+    {
+        bin& Bin=NewHistogram[(Pos+Offset)/2];
+        Bin.Count+=Histogram[Pos].Count;
+        Bin.Duration+=Histogram[Pos].Duration;
+    }
+    Histogram.swap(NewHistogram);
+    Origin=NewOrigin;
+    Width=NewWidth;
+}
+
+//***************************************************************************
+// Queries
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+std::vector<StatsSketch::centroid> StatsSketch::Centroids() const
+{
+    if (Buffer.empty())
+        return Digest;
+
+    std::vector<centroid> Values(Buffer);
+    Values.insert(Values.end(), Digest.begin(), Digest.end());
+    std::vector<centroid> Result;
+    Compress(Values, Result);
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+double StatsSketch::Quantile(double Q) const
+{
+    if (!Values_Count)
+        return std::numeric_limits<double>::quiet_NaN();
+    if (Q<=0)
+        return Values_Min;
+    if (Q>=1)
+        return Values_Max;
+
+    // Linear between the centers of the centroids, and between the extremes and the first and last centers
+    auto Values=Centroids();
+    double Index=Q*Values_Count;
+    const centroid& First=Values.front();
+    const centroid& Last=Values.back();
+    if (Index<First.Weight/2)
+        return Values_Min+(First.Mean-Values_Min)*Index/(First.Weight/2);
+    if (Index>Values_Count-Last.Weight/2)
+        return Values_Max-(Values_Max-Last.Mean)*(Values_Count-Index)/(Last.Weight/2);
+    double Weight_Before=First.Weight/2;
+    for (size_t Pos=0; Pos+1<Values.size(); Pos++)
+    {
+        double Delta=(Values[Pos].Weight+Values[Pos+1].Weight)/2;
+        if (Weight_Before+Delta>Index)
+            return Values[Pos].Mean+(Values[Pos+1].Mean-Values[Pos].Mean)*(Index-Weight_Before)/Delta;
+        Weight_Before+=Delta;
+    }
+    return Last.Mean;
+}
+
+//---------------------------------------------------------------------------
+template<typename Get>
+double StatsSketch::Above(double Threshold, Get Value) const
+{
+    if (!Width)
+        return 0;
+
+    double Result=0;
+    for (size_t Pos=0; Pos<BinsCount; Pos++)
+    {
+        double Begin=Origin+Pos*Width;
+        if (Begin>Threshold)
+            Result+=Value(Histogram[Pos]);
+        else if (Begin+Width>Threshold)
+            Result+=Value(Histogram[Pos])*(Begin+Width-Threshold)/Width;
+    }
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+double StatsSketch::CountAbove(double Threshold) const
+{
+    return Above(Threshold, [](const bin& Bin) {return (double)Bin.Count;});
+}
+
+//---------------------------------------------------------------------------
+double StatsSketch::DurationAbove(double Threshold) const
+{
+    return Above(Threshold, [](const bin& Bin) {return Bin.Duration;});
+}
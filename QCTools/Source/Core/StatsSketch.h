@@ -0,0 +1,85 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsSketch_H
+#define StatsSketch_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Distribution of a column of values, built in one pass and mergeable, for
+// the percentiles and the time spent above a value without reading the
+// frames again (infinite and NaN values are ignored):
+// - a t-digest (merging variant, k1 scale function) of about Compression
+//   centroids, more accurate at the tails (99th percentile) than at the median
+// - a histogram of BinsCount bins of the same width, a power of 2, starting at
+//   a multiple of it, with the count and the duration of the values of each
+//   bin. The bins are moved when a value is out of them, or the width doubled
+//   if they can not hold all the values, so the bins are exact for integers up
+//   to BinsCount values wide.
+// Sketches of parts of the values (segments, shards of a file) are merged in
+// the sketch of all of them.
+class StatsSketch
+{
+public:
+    static const size_t         Compression=100;
+    static const size_t         BinsCount=256;
+
+    void                        Add                         (double Value, double Duration=0);
+    void                        Merge                       (const StatsSketch& Other);
+    void                        Clear                       ();
+
+    uint64_t                    Count                       () const {return Values_Count;}
+    double                      Min                         () const {return Values_Min;}
+    double                      Max                         () const {return Values_Max;}
+
+    // Value with a proportion Q (0 to 1) of the values lower, NaN if empty
+    double                      Quantile                    (double Q) const;
+
+    // Count and duration of the values greater than Threshold, the bin of Threshold is counted in proportion of its part above it
+    double                      CountAbove                  (double Threshold) const;
+    double                      DurationAbove               (double Threshold) const;
+
+    // Content, for writing
+    struct centroid
+    {
+        double                  Mean;
+        double                  Weight;
+    };
+    std::vector<centroid>       Centroids                   () const;
+    struct bin
+    {
+        uint64_t                Count=0;
+        double                  Duration=0;
+    };
+    double                      Bins_Origin                 () const {return Origin;}
+    double                      Bins_Width                  () const {return Width;}    // 0 if empty
+    const std::vector<bin>&     Bins                        () const {return Histogram;}
+
+private:
+    static void                 Compress                    (std::vector<centroid>& Values, std::vector<centroid>& Result); // Values are sorted
+    void                        Fit                         (double Value);             // Bins moved or widened until Value is in them
+    void                        Widen                       ();
+    template<typename Get>
+    double                      Above                       (double Threshold, Get Value) const;
+
+    // t-digest, values not yet merged are in Buffer
+    std::vector<centroid>       Digest;
+    std::vector<centroid>       Buffer;
+    uint64_t                    Values_Count=0;
+    double                      Values_Min=0;
+    double                      Values_Max=0;
+
+    // Histogram
+    std::vector<bin>            Histogram;
+    double                      Origin=0;
+    double                      Width=0;
+};
+
+#endif // StatsSketch_H
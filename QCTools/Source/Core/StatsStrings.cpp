@@ -0,0 +1,65 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsStrings.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstring>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+const char* StatsStrings::Add(const char* Value)
+{
+    if (!Value)
+        return nullptr;
+    return Add(std::string_view(Value));
+}
+
+//---------------------------------------------------------------------------
+const char* StatsStrings::Add(std::string_view Value)
+{
+    QMutexLocker Locker(&Mutex);
+
+    auto Interned=Values.find(Value);
+    if (Interned!=Values.end())
+        return Interned->data();
+
+    // Long strings get a block of their own, the current block is kept for the next ones
+    size_t Size=Value.size()+1;
+    char* Data;
+    if (Size>Block_Size/4)
+    {
+        Large.emplace_back(new char[Size]);
+        Data=Large.back().get();
+        Total+=Size;
+    }
+    else
+    {
+        if (Blocks.empty() || Block_Used+Size>Block_Size)
+        {
+            Blocks.emplace_back(new char[Block_Size]);
+            Block_Used=0;
+            Total+=Block_Size;
+        }
+        Data=Blocks.back().get()+Block_Used;
+        Block_Used+=Size;
+    }
+
+    if (!Value.empty())
+        std::memcpy(Data, Value.data(), Value.size());
+    Data[Value.size()]='\0';
+    Values.insert(std::string_view(Data, Value.size()));
+    return Data;
+}
+
+//---------------------------------------------------------------------------
+size_t StatsStrings::Bytes() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Total+Values.size()*sizeof(std::string_view)*2;
+}
@@ -0,0 +1,48 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsStrings_H
+#define StatsStrings_H
+
+#include <QMutex>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Storage of the strings of the stats (comments, string values of the
+// additional stats), instead of one heap allocation per frame.
+//
+// Strings are appended to blocks which are never moved nor freed before the
+// destruction, so the columns only keep pointers and readers of other
+// threads never see a string change. Values are interned: a value already
+// stored (e.g. the few values of lavfi.idet.*) is not stored again and the
+// same pointer is returned.
+class StatsStrings
+{
+public:
+    // Null terminated copy of Value, valid until this object is destroyed, NULL if Value is NULL
+    const char*                 Add                         (const char* Value);
+    const char*                 Add                         (std::string_view Value);
+
+    // Memory used by the blocks
+    size_t                      Bytes                       () const;
+
+private:
+    static const size_t         Block_Size=(size_t)1<<16;
+
+    mutable QMutex              Mutex;
+    std::vector<std::unique_ptr<char[]>> Blocks;
+    std::vector<std::unique_ptr<char[]>> Large;             // One per string longer than a quarter of a block
+    size_t                      Block_Used=0;               // In the last block
+    size_t                      Total=0;
+    std::unordered_set<std::string_view> Values;            // Views of the blocks
+};
+
+#endif // StatsStrings_H
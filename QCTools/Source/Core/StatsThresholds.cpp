@@ -0,0 +1,373 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsThresholds.h"
+#include "Core/CommonStats.h"
+#include "Core/Core.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Preset
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool StatsThresholds::Load(const QByteArray& Json, QString* Error)
+{
+    Rules.clear();
+    Filters_Enabled.clear();
+    States.clear();
+    Violations.clear();
+
+    QJsonParseError ParseError;
+    auto Document=QJsonDocument::fromJson(Json, &ParseError);
+    if (Document.isNull() || !Document.isObject() || !Document.object().value("filters").isArray())
+    {
+        if (Error)
+            *Error=Document.isNull()?ParseError.errorString():QString("no filters array");
+        return false;
+    }
+
+    const auto Filters_Json=Document.object().value("filters").toArray();
+    for (const auto& Filter_Value : Filters_Json)
+    {
+        auto Filter=Filter_Value.toObject();
+        auto Id=Filter.value("id").toString().toStdString();
+        if (Id.empty() || !Filter.value("enabled").toBool(true))
+            continue;
+        Filters_Enabled.push_back(Id);
+
+        const auto Metrics=Filter.value("metrics").toObject();
+        for (auto Metric=Metrics.begin(); Metric!=Metrics.end(); ++Metric)
+        {
+            // {"threshold": {...}, "severity": ...} or the bounds directly
+            auto Bounds=Metric.value().toObject();
+            if (Bounds.contains("threshold"))
+                Bounds=Bounds.value("threshold").toObject();
+
+            rule Rule;
+            Rule.Filter=Id;
+            Rule.Key=Metric.key().toStdString();
+            if (Bounds.value("min").isDouble())
+            {
+                Rule.HasMin=true;
+                Rule.Min=Bounds.value("min").toDouble();
+            }
+            if (Bounds.value("max").isDouble())
+            {
+                Rule.HasMax=true;
+                Rule.Max=Bounds.value("max").toDouble();
+            }
+            Rules.push_back(Rule);
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------
+QStringList StatsThresholds::Filters() const
+{
+    QStringList List;
+    for (const auto& Filter : Filters_Enabled)
+        List.append(QString::fromStdString(Filter));
+    return List;
+}
+
+//---------------------------------------------------------------------------
+std::vector<StatsThresholds::bounds> StatsThresholds::Bounds() const
+{
+    std::vector<bounds> List;
+    for (const auto& Rule : Rules)
+        List.push_back({Rule.Key, Rule.HasMin, Rule.Min, Rule.HasMax, Rule.Max});
+    return List;
+}
+
+//***************************************************************************
+// Evaluation
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsThresholds::Update(const std::vector<CommonStats*>& Stats)
+{
+    if (States.size()<Stats.size())
+        States.resize(Stats.size());
+
+    for (size_t Stream=0; Stream<Stats.size(); ++Stream)
+    {
+        CommonStats* Stat=Stats[Stream];
+        if (!Stat)
+            continue;
+
+        auto& Stream_States=States[Stream];
+        if (Stream_States.size()!=Rules.size())
+        {
+            // Items of the rules in this stream
+            Stream_States.resize(Rules.size());
+            const struct stream_info& StreamInfo=PerStreamType[Stat->Type_Get()];
+            for (size_t Pos=0; Pos<Rules.size(); ++Pos)
+                for (size_t Item=0; Item<StreamInfo.CountOfItems; ++Item)
+                    if (StreamInfo.PerItem[Item].FFmpeg_Name && Rules[Pos].Key==StreamInfo.PerItem[Item].FFmpeg_Name)
+                    {
+                        Stream_States[Pos].Item=Item;
+                        Rules[Pos].Supported=true;
+                        break;
+                    }
+        }
+
+        size_t End=Stat->x_Current_Get();
+        size_t Window=CommonStats::Window_Get();
+        size_t Kept=Window && End>Window/2?End-Window/2:0;
+        for (size_t Pos=0; Pos<Rules.size(); ++Pos)
+        {
+            stream_state& State=Stream_States[Pos];
+            if (State.Item==(size_t)-1)
+            {
+                State.Evaluated=End;
+                continue;
+            }
+
+            rule& Rule=Rules[Pos];
+            Stat->Item_Require(State.Item);
+            const StatsValueColumn& Column=Stat->y[State.Item];
+            for (size_t x=std::max(State.Evaluated, Kept); x<End; ++x)
+            {
+                double Value=Column[x];
+                if (!std::isfinite(Value))
+                    continue;
+
+                if (!Rule.Value_Count || Value<Rule.Value_Min)
+                    Rule.Value_Min=Value;
+                if (!Rule.Value_Count || Value>Rule.Value_Max)
+                    Rule.Value_Max=Value;
+                Rule.Value_Sum+=Value;
+                Rule.Value_Count++;
+
+                bool BelowMin=Rule.HasMin && Value<Rule.Min;
+                bool AboveMax=!BelowMin && Rule.HasMax && Value>Rule.Max;
+                if (BelowMin || AboveMax)
+                {
+                    if (!State.InViolation)
+                    {
+                        State.Current={Pos, Stream, x, x, Stat->x[1][x], Stat->x[1][x], AboveMax, Value, Stat->durations[x]};
+                        State.InViolation=true;
+                    }
+                    else
+                    {
+                        // The peak follows the reason of the first frame
+                        State.Current.Last=x;
+                        State.Current.Time_Last=Stat->x[1][x];
+                        State.Current.Duration+=Stat->durations[x];
+                        if (AboveMax==State.Current.AboveMax && (AboveMax?Value>State.Current.Peak:Value<State.Current.Peak))
+                            State.Current.Peak=Value;
+                    }
+                }
+                else if (State.InViolation)
+                {
+                    Violations.push_back(State.Current);
+                    State.InViolation=false;
+                }
+            }
+            State.Evaluated=End;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+std::vector<std::pair<double, double>> StatsThresholds::Regions(const std::vector<CommonStats*>& Stats, double Tolerance, double Margin) const
+{
+    std::vector<std::pair<double, double>> List;
+    for (CommonStats* Stat : Stats)
+    {
+        if (!Stat || !Stat->x_Current || Stat->FirstTimeStamp==DBL_MAX)
+            continue;
+
+        const struct stream_info& StreamInfo=PerStreamType[Stat->Type_Get()];
+        auto Time=[&](size_t Pos) {
+            return Stat->x[1][Pos]+Stat->FirstTimeStamp;
+        };
+
+        for (const auto& Rule : Rules)
+        {
+            size_t Item=(size_t)-1;
+            for (size_t j=0; j<StreamInfo.CountOfItems; ++j)
+                if (StreamInfo.PerItem[j].FFmpeg_Name && Rule.Key==StreamInfo.PerItem[j].FFmpeg_Name)
+                {
+                    Item=j;
+                    break;
+                }
+            if (Item==(size_t)-1)
+                continue;
+
+            double Max=Rule.Max-Tolerance*std::fabs(Rule.Max);
+            double Min=Rule.Min+Tolerance*std::fabs(Rule.Min);
+            Stat->Item_Require(Item);
+            const StatsValueColumn& Column=Stat->y[Item];
+            for (size_t x=0; x<Stat->x_Current; ++x)
+            {
+                double Value=Column[x];
+                if (!std::isfinite(Value) || !((Rule.HasMax && Value>=Max) || (Rule.HasMin && Value<=Min)))
+                    continue;
+
+                // The frames between the ones parsed may be out of the bounds too
+                size_t Begin=x, End=x;
+                if (Stat->Sampling_Get())
+                {
+                    if (Begin)
+                        Begin--;
+                    if (End+1<Stat->x_Current)
+                        End++;
+                }
+                List.emplace_back(Time(Begin)-Margin, Time(End)+Stat->durations[End]+Margin);
+            }
+        }
+    }
+
+    std::sort(List.begin(), List.end());
+    std::vector<std::pair<double, double>> Merged;
+    for (const auto& Region : List)
+    {
+        if (!Merged.empty() && Region.first<=Merged.back().second)
+            Merged.back().second=std::max(Merged.back().second, Region.second);
+        else
+            Merged.push_back(Region);
+    }
+    return Merged;
+}
+
+//***************************************************************************
+// Output
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static QJsonObject Bounds_Json(bool HasMin, double Min, bool HasMax, double Max)
+{
+    QJsonObject Bounds;
+    if (HasMin)
+        Bounds.insert("min", Min);
+    if (HasMax)
+        Bounds.insert("max", Max);
+    return Bounds;
+}
+
+//---------------------------------------------------------------------------
+QJsonObject StatsThresholds::Violation_ToJson(const violation& Violation, double FirstTimeStamp) const
+{
+    const rule& Rule=Rules[Violation.Rule];
+    QJsonObject Violation_Json;
+    Violation_Json.insert("filter", QString::fromStdString(Rule.Filter));
+    Violation_Json.insert("metric_key", QString::fromStdString(Rule.Key));
+    Violation_Json.insert("stream", int(Violation.Stream));
+    Violation_Json.insert("reason", Violation.AboveMax?"above_max":"below_min");
+    Violation_Json.insert("start_time", Violation.Time_First+FirstTimeStamp);
+    Violation_Json.insert("end_time", Violation.Time_Last+FirstTimeStamp);
+    Violation_Json.insert("duration", Violation.Duration);
+    Violation_Json.insert("first_frame", double(Violation.First));
+    Violation_Json.insert("last_frame", double(Violation.Last));
+    Violation_Json.insert("peak", Violation.Peak);
+    Violation_Json.insert("threshold", Bounds_Json(Rule.HasMin, Rule.Min, Rule.HasMax, Rule.Max));
+    return Violation_Json;
+}
+
+//---------------------------------------------------------------------------
+QByteArray StatsThresholds::Alerts(const std::vector<CommonStats*>& Stats)
+{
+    QByteArray Lines;
+    auto Add=[&](violation& Violation, const char* State) {
+        auto Violation_Json=Violation_ToJson(Violation, Stats[Violation.Stream]->FirstTimeStamp);
+        Violation_Json.insert("state", State);
+        Lines+=QJsonDocument(Violation_Json).toJson(QJsonDocument::Compact)+'\n';
+        Violation.Alerted=true;
+    };
+
+    for (auto& Violation : Violations)
+        Add(Violation, "closed");
+    Violations.clear();
+
+    for (auto& Stream_States : States)
+        for (auto& State : Stream_States)
+            if (State.InViolation && !State.Current.Alerted)
+                Add(State.Current, "started");
+
+    return Lines;
+}
+
+//---------------------------------------------------------------------------
+QByteArray StatsThresholds::Json(const std::vector<CommonStats*>& Stats, const std::function<QString(size_t Stream, size_t Frame)>& Snapshot) const
+{
+    // Violations not closed yet are reported as ending at the last frame evaluated
+    auto All=Violations;
+    for (const auto& Stream_States : States)
+        for (const auto& State : Stream_States)
+            if (State.InViolation)
+                All.push_back(State.Current);
+
+    // Times are computed now, the time stamp of the first frame may have changed during the parsing
+    std::stable_sort(All.begin(), All.end(), [&](const violation& A, const violation& B) {
+        return A.Time_First+Stats[A.Stream]->FirstTimeStamp<B.Time_First+Stats[B.Stream]->FirstTimeStamp;
+    });
+
+    QJsonArray Violations_Json;
+    for (const auto& Violation : All)
+    {
+        auto Violation_Json=Violation_ToJson(Violation, Stats[Violation.Stream]->FirstTimeStamp);
+        if (Snapshot)
+        {
+            auto FileName=Snapshot(Violation.Stream, Violation.First);
+            if (!FileName.isEmpty())
+                Violation_Json.insert("snapshot", FileName);
+        }
+        Violations_Json.append(Violation_Json);
+    }
+
+    QJsonArray Filters_Json;
+    for (const auto& Filter : Filters_Enabled)
+    {
+        QJsonArray Metrics_Json;
+        for (const auto& Rule : Rules)
+        {
+            if (Rule.Filter!=Filter)
+                continue;
+
+            QJsonObject Metric_Json;
+            Metric_Json.insert("key", QString::fromStdString(Rule.Key));
+            Metric_Json.insert("supported", Rule.Supported);
+            Metric_Json.insert("count", double(Rule.Value_Count));
+            Metric_Json.insert("min", Rule.Value_Count?QJsonValue(Rule.Value_Min):QJsonValue());
+            Metric_Json.insert("max", Rule.Value_Count?QJsonValue(Rule.Value_Max):QJsonValue());
+            Metric_Json.insert("average", Rule.Value_Count?QJsonValue(Rule.Value_Sum/Rule.Value_Count):QJsonValue());
+            Metric_Json.insert("threshold", Bounds_Json(Rule.HasMin, Rule.Min, Rule.HasMax, Rule.Max));
+            Metrics_Json.append(Metric_Json);
+        }
+
+        QJsonObject Filter_Json;
+        Filter_Json.insert("id", QString::fromStdString(Filter));
+        Filter_Json.insert("metrics", Metrics_Json);
+        Filters_Json.append(Filter_Json);
+    }
+
+    double Frames=0;
+    for (const auto& Stat : Stats)
+        if (Stat)
+            Frames+=Stat->x_Current;
+
+    QJsonObject Statistics;
+    Statistics.insert("frames", Frames);
+    Statistics.insert("filters_run", QJsonArray::fromStringList(Filters()));
+
+    QJsonObject Root;
+    Root.insert("filters", Filters_Json);
+    Root.insert("violations", Violations_Json);
+    Root.insert("statistics", Statistics);
+    return QJsonDocument(Root).toJson(QJsonDocument::Indented);
+}
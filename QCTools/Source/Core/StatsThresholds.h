@@ -0,0 +1,118 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsThresholds_H
+#define StatsThresholds_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Thresholds of a preset evaluated on the stats while they are parsed, so
+// only the aggregates and the violations (consecutive frames outside the
+// bounds of a metric) are reported instead of every frame.
+//
+// The preset is JSON, as the normalized QCTools presets of the backend:
+// {"filters": [{"id": "signalstats", "enabled": true, "metrics": {
+//     "lavfi.signalstats.YMAX": {"threshold": {"max": 235}}, ...}}, ...]}
+// (a metric may also be the bounds directly, {"max": 235}). Metrics are the
+// FFmpeg names of the items, frames without a finite value are skipped.
+class StatsThresholds
+{
+public:
+    // Error is set if the preset can not be read
+    bool                        Load                        (const QByteArray& Json, QString* Error=nullptr);
+
+    // Ids of the enabled filters, for selecting the filters to run
+    QStringList                 Filters                     () const;
+
+    // Bounds of the rules, for acting on the same violations while parsing
+    struct bounds
+    {
+        std::string             Key;
+        bool                    HasMin;
+        double                  Min;
+        bool                    HasMax;
+        double                  Max;
+    };
+    std::vector<bounds>         Bounds                      () const;
+
+    // Evaluates the frames added to the stats since the previous call (up to x_Current_Get()), in a window of the
+    // stats (see CommonStats::Window_Set) the frames already freed are skipped
+    void                        Update                      (const std::vector<CommonStats*>& Stats);
+
+    // Violations started or closed since the previous call, one compact JSON object per line, for live alerts
+    // The closed violations are taken, Json does not report them
+    QByteArray                  Alerts                      (const std::vector<CommonStats*>& Stats);
+
+    // Aggregates by metric and violations sorted by start time, with the times of the current stats
+    // Snapshot returns the file name of the still of a frame of a stream, empty if none
+    QByteArray                  Json                        (const std::vector<CommonStats*>& Stats, const std::function<QString(size_t Stream, size_t Frame)>& Snapshot=nullptr) const;
+
+    // Time ranges (seconds, as in the reports) of the frames out of the bounds or near them (within Tolerance times
+    // the bound), from the previous frame to the end of the next one for sparse stats, extended by Margin and merged,
+    // for parsing them again more precisely
+    std::vector<std::pair<double, double>> Regions          (const std::vector<CommonStats*>& Stats, double Tolerance, double Margin) const;
+
+private:
+    struct rule
+    {
+        std::string             Filter;
+        std::string             Key;
+        bool                    HasMin=false;
+        bool                    HasMax=false;
+        double                  Min=0;
+        double                  Max=0;
+
+        // Aggregate of all the streams
+        double                  Value_Min=0;
+        double                  Value_Max=0;
+        double                  Value_Sum=0;
+        size_t                  Value_Count=0;
+        bool                    Supported=false;            // Item found in at least one stream
+    };
+
+    struct violation
+    {
+        size_t                  Rule;
+        size_t                  Stream;
+        size_t                  First;                      // Frame positions, included
+        size_t                  Last;
+        double                  Time_First;                 // Without the time stamp of the first frame
+        double                  Time_Last;
+        bool                    AboveMax;                   // Else below minimum
+        double                  Peak;
+        double                  Duration;                   // Sum of the frame durations
+        bool                    Alerted=false;              // Start reported by Alerts
+    };
+
+    struct stream_state
+    {
+        size_t                  Item=(size_t)-1;            // Not found
+        size_t                  Evaluated=0;
+        bool                    InViolation=false;
+        violation               Current;
+    };
+
+    QJsonObject                 Violation_ToJson            (const violation& Violation, double FirstTimeStamp) const;
+
+    std::vector<rule>           Rules;
+    std::vector<std::string>    Filters_Enabled;
+    std::vector<std::vector<stream_state>> States;          // By stream then by rule
+    std::vector<violation>      Violations;                 // Closed ones
+};
+
+#endif // StatsThresholds_H
@@ -0,0 +1,162 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsWindow.h"
+#include "Core/CommonStats.h"
+#include "Core/Core.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Aggregate
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsWindow::aggregate::Add(double Value)
+{
+    if (!std::isfinite(Value))
+        return;
+    if (!Count || Value<Min)
+        Min=Value;
+    if (!Count || Value>Max)
+        Max=Value;
+    Sum+=Value;
+    Count++;
+}
+
+//---------------------------------------------------------------------------
+void StatsWindow::aggregate::Add(const aggregate& Other)
+{
+    if (!Other.Count)
+        return;
+    if (!Count || Other.Min<Min)
+        Min=Other.Min;
+    if (!Count || Other.Max>Max)
+        Max=Other.Max;
+    Sum+=Other.Sum;
+    Count+=Other.Count;
+}
+
+//***************************************************************************
+// Constructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsWindow::StatsWindow(size_t Capacity_, size_t History_Max_)
+: Capacity(std::max(Capacity_, (size_t)1)),
+  History_Max(std::max(History_Max_&~(size_t)1, (size_t)2))
+{
+}
+
+//***************************************************************************
+// Update
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsWindow::Update(CommonStats& Stats)
+{
+    if (!Items)
+    {
+        Items=PerStreamType[Stats.Type_Get()].CountOfItems;
+        Values.resize(Capacity*Items);
+        Times.resize(Capacity);
+        Durations.resize(Capacity);
+    }
+
+    // Only the recent frames are safe to read when the stats are in a window
+    size_t End=Stats.x_Current_Get();
+    size_t Window=CommonStats::Window_Get();
+    size_t First=Next;
+    if (Window && End>Window/2 && First<End-Window/2)
+        First=End-Window/2;
+    Dropped_Count+=First-Next;
+
+    double FirstTimeStamp=Stats.FirstTimeStamp==DBL_MAX?0:Stats.FirstTimeStamp;
+    for (size_t Pos=First; Pos<End; Pos++)
+    {
+        double* Frame_Values=&Values[Ring_Next*Items];
+        for (size_t j=0; j<Items; j++)
+            Frame_Values[j]=Stats.y[j][Pos];
+        Times[Ring_Next]=Stats.x[1][Pos]+FirstTimeStamp;
+        Durations[Ring_Next]=Stats.durations[Pos];
+        History_Add(Times[Ring_Next], Durations[Ring_Next], Frame_Values);
+
+        Ring_Next=(Ring_Next+1)%Capacity;
+        if (Ring_Count<Capacity)
+            Ring_Count++;
+    }
+    Next=End;
+}
+
+//---------------------------------------------------------------------------
+void StatsWindow::History_Add(double Time, double Duration, const double* Frame_Values)
+{
+    if (History_Buckets.empty() || History_Buckets.back().Frames>=History_Frames)
+    {
+        if (History_Buckets.size()==History_Max)
+        {
+            // Decimation, the history keeps covering everything
+            std::deque<bucket> Merged;
+            for (size_t Pos=0; Pos+1<History_Buckets.size(); Pos+=2)
+            {
+                bucket Bucket=History_Buckets[Pos];
+                const bucket& Other=History_Buckets[Pos+1];
+                Bucket.Time_End=Other.Time_End;
+                Bucket.Frames+=Other.Frames;
+                for (size_t j=0; j<Items; j++)
+                    Bucket.Items[j].Add(Other.Items[j]);
+                Merged.push_back(std::move(Bucket));
+            }
+            History_Buckets.swap(Merged);
+            History_Frames*=2;
+        }
+
+        if (History_Buckets.empty() || History_Buckets.back().Frames>=History_Frames)
+        {
+            History_Buckets.emplace_back();
+            History_Buckets.back().Time_Begin=Time;
+            History_Buckets.back().Items.resize(Items);
+        }
+    }
+
+    bucket& Bucket=History_Buckets.back();
+    Bucket.Time_End=Time+Duration;
+    Bucket.Frames++;
+    for (size_t j=0; j<Items; j++)
+        Bucket.Items[j].Add(Frame_Values[j]);
+}
+
+//***************************************************************************
+// Window
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsWindow::bucket StatsWindow::Window(double Seconds) const
+{
+    bucket Bucket;
+    Bucket.Items.resize(Items);
+    if (!Ring_Count)
+        return Bucket;
+
+    // From the most recent frame backwards
+    size_t Last=(Ring_Next+Capacity-1)%Capacity;
+    Bucket.Time_End=Times[Last]+Durations[Last];
+    for (size_t Count=0; Count<Ring_Count; Count++)
+    {
+        size_t Pos=(Last+Capacity-Count)%Capacity;
+        if (Count && Times[Pos]<Bucket.Time_End-Seconds)
+            break;
+        Bucket.Time_Begin=Times[Pos];
+        Bucket.Frames++;
+        for (size_t j=0; j<Items; j++)
+            Bucket.Items[j].Add(Values[Pos*Items+j]);
+    }
+    return Bucket;
+}
@@ -0,0 +1,86 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsWindow_H
+#define StatsWindow_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+class CommonStats;
+
+//---------------------------------------------------------------------------
+// Rolling aggregates of the items of one stream of a live analysis (see
+// FileInformation::Live_Set), in a memory bounded whatever the duration.
+//
+// The values of the last frames are kept in a ring of a fixed capacity, for
+// the aggregates over the last seconds. All the frames are also summed in a
+// long-term history of at most History_Max buckets: when it is full, pairs
+// of buckets are merged and the next buckets cover twice more frames, so the
+// history always covers the whole analysis with a decreasing resolution.
+// Thread reading the stats only.
+class StatsWindow
+{
+public:
+    struct aggregate
+    {
+        double                  Min=0;
+        double                  Max=0;
+        double                  Sum=0;
+        size_t                  Count=0;                    // Frames with a finite value
+
+        void                    Add                         (double Value);
+        void                    Add                         (const aggregate& Other);
+        double                  Average                     () const {return Count?Sum/Count:0;}
+    };
+
+    struct bucket
+    {
+        double                  Time_Begin=0;               // Seconds, as in the reports
+        double                  Time_End=0;                 // End of the last frame
+        size_t                  Frames=0;
+        std::vector<aggregate>  Items;
+    };
+
+    // Capacity in frames of the ring
+                                StatsWindow                 (size_t Capacity, size_t History_Max=1024);
+
+    // Frames added to Stats since the previous call, the frames already freed (see CommonStats::Window_Set) are counted as dropped
+    void                        Update                      (CommonStats& Stats);
+
+    // Over the frames of the ring ending in the last Seconds
+    bucket                      Window                      (double Seconds) const;
+
+    const std::deque<bucket>&   History                     () const {return History_Buckets;}
+    size_t                      Frames                      () const {return Next-Dropped_Count;}
+    size_t                      Dropped                     () const {return Dropped_Count;}
+    size_t                      CountOfItems                () const {return Items;}
+
+private:
+    void                        History_Add                 (double Time, double Duration, const double* Values);
+
+    size_t                      Capacity;
+    size_t                      History_Max;
+    size_t                      Items=0;
+
+    // Ring
+    std::vector<double>         Values;                     // Capacity x Items
+    std::vector<double>         Times;
+    std::vector<double>         Durations;
+    size_t                      Ring_Count=0;
+    size_t                      Ring_Next=0;
+
+    // History
+    std::deque<bucket>          History_Buckets;
+    size_t                      History_Frames=1;           // Per bucket
+
+    size_t                      Next=0;                     // Frame of the stats
+    size_t                      Dropped_Count=0;
+};
+
+#endif // StatsWindow_H
@@ -0,0 +1,401 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsXmlReader.h"
+//---------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstring>
+
+//---------------------------------------------------------------------------
+static inline bool IsSpace(char c)
+{
+    return c==' ' || c=='\n' || c=='\r' || c=='\t';
+}
+
+static const size_t Npos=(size_t)-1;
+
+//***************************************************************************
+// StatsXmlFrame
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+const char* StatsXmlFrame::Attribute(const char* name) const
+{
+    for (const auto& attribute : attributes)
+        if (!strcmp(attribute.first, name))
+            return attribute.second;
+
+    return nullptr;
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsXmlReader::StatsXmlReader(const FrameHandler& handler) :
+    Handler(handler)
+{
+}
+
+//***************************************************************************
+// Input
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+char* StatsXmlReader::WriteBuffer(size_t MinSize)
+{
+    // +1 for the terminating null character put after the data
+    if (Buffer.size()<Buffer_End+MinSize+1)
+    {
+        // Only the incomplete trailing element is carried over
+        if (Buffer_Begin)
+        {
+            size_t Remaining=Buffer_End-Buffer_Begin;
+            if (Remaining)
+                memmove(Buffer.data(), Buffer.data()+Buffer_Begin, Remaining);
+            Buffer_Begin=0;
+            Buffer_End=Remaining;
+        }
+
+        if (Buffer.size()<Buffer_End+MinSize+1)
+            Buffer.resize(Buffer_End+MinSize+1);
+    }
+
+    return Buffer.data()+Buffer_End;
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlReader::Commit(size_t Size)
+{
+    Buffer_End+=Size;
+    BytesCount+=Size;
+    Buffer[Buffer_End]='\0';
+
+    Parse();
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlReader::Feed(const char* Data, size_t Size)
+{
+    memcpy(WriteBuffer(Size), Data, Size);
+    Commit(Size);
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlReader::Finish()
+{
+    // Incomplete data at the end of the stream (truncated file) is ignored
+    Buffer.clear();
+    Buffer.shrink_to_fit();
+    Buffer_Begin=0;
+    Buffer_End=0;
+}
+
+//***************************************************************************
+// Parsing
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsXmlReader::Parse()
+{
+    char* Base=Buffer.data();
+
+    for (;;)
+    {
+        if (State==State_Trailer)
+        {
+            Trailer.append(Base+Buffer_Begin, Buffer_End-Buffer_Begin);
+            Buffer_Begin=Buffer_End;
+            return;
+        }
+
+        // Text content between elements is not used
+        size_t Pos=Buffer_Begin;
+        while (Pos<Buffer_End && Base[Pos]!='<')
+            Pos++;
+        Buffer_Begin=Pos;
+        if (Pos+1>=Buffer_End)
+            return; // Need more data
+
+        // Comments, processing instructions
+        if (Base[Pos+1]=='!' || Base[Pos+1]=='?')
+        {
+            const char* Terminator=(Base[Pos+1]=='!' && Buffer_End-Pos>=4 && !memcmp(Base+Pos, "<!--", 4))?"-->":">";
+            const char* End=strstr(Base+Pos+2, Terminator);
+            if (!End)
+                return; // Need more data
+            Buffer_Begin=(End-Base)+strlen(Terminator);
+            continue;
+        }
+
+        // Element name
+        bool IsClosing=Base[Pos+1]=='/';
+        size_t Name=Pos+(IsClosing?2:1);
+        size_t Name_End=Name;
+        while (Name_End<Buffer_End && !IsSpace(Base[Name_End]) && Base[Name_End]!='/' && Base[Name_End]!='>')
+            Name_End++;
+        if (Name_End>=Buffer_End)
+            return; // Need more data
+        size_t Name_Size=Name_End-Name;
+
+        if (State==State_Frames && !IsClosing && Name_Size==5 && !memcmp(Base+Name, "frame", 5))
+        {
+            size_t End=FindElementEnd(Pos, true);
+            if (End==Npos)
+                return; // Need more data
+            ParseFrame(Base+Pos, Base+End);
+            Buffer_Begin=End;
+            continue;
+        }
+
+        size_t End=FindElementEnd(Pos, false);
+        if (End==Npos)
+            return; // Need more data
+        Buffer_Begin=End;
+
+        if (Name_Size==6 && !memcmp(Base+Name, "frames", 6))
+        {
+            bool IsSelfClosed=Base[End-2]=='/';
+            if (IsClosing || IsSelfClosed)
+            {
+                // Streams and format are parsed later as a standalone document
+                State=State_Trailer;
+                Trailer="<ffprobe:ffprobe>";
+            }
+            else
+                State=State_Frames;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+size_t StatsXmlReader::FindElementEnd(size_t Pos, bool Recursive) const
+{
+    const char* Base=Buffer.data();
+    int Depth=0;
+
+    for (;;)
+    {
+        // Buffer[Pos] is '<', looking for the end of the tag (attribute values may contain '>')
+        size_t Tag_End=Pos+1;
+        char Quote='\0';
+        for (; Tag_End<Buffer_End; Tag_End++)
+        {
+            char c=Base[Tag_End];
+            if (Quote)
+            {
+                if (c==Quote)
+                    Quote='\0';
+            }
+            else if (c=='"' || c=='\'')
+                Quote=c;
+            else if (c=='>')
+                break;
+        }
+        if (Tag_End>=Buffer_End)
+            return Npos;
+
+        char Kind=Base[Pos+1];
+        if (Kind=='/')
+            Depth--;
+        else if (Kind!='!' && Kind!='?' && Base[Tag_End-1]!='/')
+            Depth++;
+
+        Pos=Tag_End+1;
+        if (!Recursive || Depth<=0)
+            return Pos;
+
+        while (Pos<Buffer_End && Base[Pos]!='<')
+            Pos++;
+        if (Pos>=Buffer_End)
+            return Npos;
+    }
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlReader::ParseFrame(char* Begin, char* End)
+{
+    Frame.attributes.clear();
+    Frame.tags.clear();
+
+    bool IsSelfClosed=false;
+    char* Pos=ParseAttributes(Begin+6, End, Frame.attributes, IsSelfClosed); // 6 = strlen("<frame")
+
+    // Children, only <tag> elements directly in <frame> are used
+    std::vector<StatsXmlFrame::Entry> Attributes;
+    int Depth=0;
+    while (!IsSelfClosed && Pos<End)
+    {
+        while (Pos<End && *Pos!='<')
+            Pos++;
+        if (Pos>=End)
+            break;
+
+        if (Pos[1]=='/' || Pos[1]=='!' || Pos[1]=='?')
+        {
+            if (Pos[1]=='/' && !Depth)
+                break; // </frame>
+            if (Pos[1]=='/')
+                Depth--;
+            while (Pos<End && *Pos!='>')
+                Pos++;
+            continue;
+        }
+
+        char* Name=Pos+1;
+        char* Name_End=Name;
+        while (Name_End<End && !IsSpace(*Name_End) && *Name_End!='/' && *Name_End!='>')
+            Name_End++;
+
+        bool IsChildSelfClosed=false;
+        Attributes.clear();
+        Pos=ParseAttributes(Name_End, End, Attributes, IsChildSelfClosed);
+
+        if (!Depth && Name_End-Name==3 && !memcmp(Name, "tag", 3))
+        {
+            const char* Key=nullptr;
+            const char* Value=nullptr;
+            for (const auto& Attribute : Attributes)
+            {
+                if (!strcmp(Attribute.first, "key"))
+                    Key=Attribute.second;
+                else if (!strcmp(Attribute.first, "value"))
+                    Value=Attribute.second;
+            }
+            Frame.tags.emplace_back(Key, Value);
+        }
+
+        if (!IsChildSelfClosed)
+            Depth++;
+    }
+
+    FramesCount++;
+    Handler(Frame);
+}
+
+//---------------------------------------------------------------------------
+char* StatsXmlReader::ParseAttributes(char* Pos, char* End, std::vector<StatsXmlFrame::Entry>& Attributes, bool& IsSelfClosed)
+{
+    for (;;)
+    {
+        while (Pos<End && IsSpace(*Pos))
+            Pos++;
+        if (Pos>=End)
+            return End;
+        if (*Pos=='>')
+            return Pos+1;
+        if (*Pos=='/')
+        {
+            IsSelfClosed=true;
+            Pos++;
+            continue;
+        }
+
+        char* Name=Pos;
+        while (Pos<End && *Pos!='=' && !IsSpace(*Pos) && *Pos!='>' && *Pos!='/')
+            Pos++;
+        char* Name_End=Pos;
+        if (Name_End==Name)
+        {
+            Pos++; // Malformed, skipping the character
+            continue;
+        }
+
+        while (Pos<End && IsSpace(*Pos))
+            Pos++;
+        if (Pos>=End || *Pos!='=')
+            continue; // Attribute without value, ignored
+        Pos++;
+        while (Pos<End && IsSpace(*Pos))
+            Pos++;
+        if (Pos>=End || (*Pos!='"' && *Pos!='\''))
+            continue;
+
+        char Quote=*Pos++;
+        char* Value=Pos;
+        while (Pos<End && *Pos!=Quote)
+            Pos++;
+        if (Pos>=End)
+            return End;
+
+        *Name_End='\0';
+        *Pos++='\0';
+        Unescape(Value);
+        Attributes.emplace_back(Name, Value);
+    }
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlReader::Unescape(char* Value)
+{
+    char* Read=strchr(Value, '&');
+    if (!Read)
+        return;
+
+    char* Write=Read;
+    while (*Read)
+    {
+        if (*Read=='&')
+        {
+            const char* Semicolon=strchr(Read, ';');
+            if (Semicolon && Semicolon-Read<=10)
+            {
+                const char* Entity=Read+1;
+                size_t Entity_Size=Semicolon-Entity;
+                char Replacement='\0';
+                if (Entity_Size==2 && !memcmp(Entity, "lt", 2))
+                    Replacement='<';
+                else if (Entity_Size==2 && !memcmp(Entity, "gt", 2))
+                    Replacement='>';
+                else if (Entity_Size==3 && !memcmp(Entity, "amp", 3))
+                    Replacement='&';
+                else if (Entity_Size==4 && !memcmp(Entity, "quot", 4))
+                    Replacement='"';
+                else if (Entity_Size==4 && !memcmp(Entity, "apos", 4))
+                    Replacement='\'';
+                else if (Entity_Size>=2 && Entity[0]=='#')
+                {
+                    unsigned long CodePoint=(Entity[1]=='x' || Entity[1]=='X')?strtoul(Entity+2, nullptr, 16):strtoul(Entity+1, nullptr, 10);
+                    if (CodePoint<0x80)
+                        *Write++=(char)CodePoint;
+                    else if (CodePoint<0x800)
+                    {
+                        *Write++=(char)(0xC0|(CodePoint>>6));
+                        *Write++=(char)(0x80|(CodePoint&0x3F));
+                    }
+                    else if (CodePoint<0x10000)
+                    {
+                        *Write++=(char)(0xE0|(CodePoint>>12));
+                        *Write++=(char)(0x80|((CodePoint>>6)&0x3F));
+                        *Write++=(char)(0x80|(CodePoint&0x3F));
+                    }
+                    else
+                    {
+                        *Write++=(char)(0xF0|((CodePoint>>18)&0x07));
+                        *Write++=(char)(0x80|((CodePoint>>12)&0x3F));
+                        *Write++=(char)(0x80|((CodePoint>>6)&0x3F));
+                        *Write++=(char)(0x80|(CodePoint&0x3F));
+                    }
+                    Read=(char*)Semicolon+1;
+                    continue;
+                }
+
+                if (Replacement)
+                {
+                    *Write++=Replacement;
+                    Read=(char*)Semicolon+1;
+                    continue;
+                }
+            }
+        }
+
+        *Write++=*Read++;
+    }
+    *Write='\0';
+}
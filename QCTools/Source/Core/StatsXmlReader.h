@@ -0,0 +1,84 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsXmlReader_H
+#define StatsXmlReader_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// One <frame> element of a QCTools/ffprobe report, as seen by the stats
+// parsers. Pointers are only valid during the FrameHandler call.
+struct StatsXmlFrame
+{
+    typedef std::pair<const char*, const char*> Entry;
+
+    std::vector<Entry>          attributes;                 // name, value
+    std::vector<Entry>          tags;                       // <tag key=... value=.../>, key may be NULL
+
+    const char*                 Attribute                   (const char* name) const;
+};
+
+//---------------------------------------------------------------------------
+// Forward-only tokenizer for QCTools reports.
+//
+// Data is pushed in arbitrary sized blocks (typically straight from inflate),
+// every complete <frame> is handed to the FrameHandler without building a DOM,
+// and only the trailing incomplete element is carried over to the next block.
+// Everything after </frames> (streams, format) is kept as a small standalone
+// document available from trailer() once finish() is called.
+class StatsXmlReader
+{
+public:
+    typedef std::function<void(const StatsXmlFrame&)> FrameHandler;
+
+    explicit                    StatsXmlReader              (const FrameHandler& handler);
+
+    // Zero-copy feeding: get a buffer of at least MinSize bytes, fill it, commit the count of written bytes
+    char*                       WriteBuffer                 (size_t MinSize);
+    void                        Commit                      (size_t Size);
+
+    // Copying feeding
+    void                        Feed                        (const char* Data, size_t Size);
+
+    void                        Finish                      ();
+
+    const std::string&          trailer                     () const {return Trailer;}
+    uint64_t                    framesCount                 () const {return FramesCount;}
+    uint64_t                    bytesCount                  () const {return BytesCount;}
+
+private:
+    enum state
+    {
+        State_Prolog,
+        State_Frames,
+        State_Trailer,
+    };
+
+    void                        Parse                       ();
+    size_t                      FindElementEnd              (size_t Pos, bool Recursive) const;
+    void                        ParseFrame                  (char* Begin, char* End);
+    static char*                ParseAttributes             (char* Pos, char* End, std::vector<StatsXmlFrame::Entry>& Attributes, bool& SelfClosed);
+    static void                 Unescape                    (char* Value);
+
+    FrameHandler                Handler;
+    std::vector<char>           Buffer;
+    size_t                      Buffer_Begin {0};           // First byte not parsed yet
+    size_t                      Buffer_End {0};             // First byte not filled yet
+    state                       State {State_Prolog};
+    std::string                 Trailer;
+    StatsXmlFrame               Frame;
+    uint64_t                    FramesCount {0};
+    uint64_t                    BytesCount {0};
+};
+
+#endif // StatsXmlReader_H
@@ -0,0 +1,237 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/StatsXmlWriter.h"
+//---------------------------------------------------------------------------
+
+#ifndef FMT_HEADER_ONLY
+#define FMT_HEADER_ONLY // Same configuration as spdlog, no fmt library to link
+#endif
+#include "ThirdParty/spdlog/fmt/bundled/format.h"
+#include <cstring>
+
+//---------------------------------------------------------------------------
+static const size_t Block_Size=0x100000; //Blocks of 1 MiB, arbitrary chosen
+static const size_t Number_MaxSize=400; //%f of DBL_MAX is 316 characters
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+StatsXmlWriter::StatsXmlWriter(const OutputHandler& Output_) :
+    Output(Output_),
+    Buffer(Block_Size)
+{
+}
+
+//***************************************************************************
+// Output
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+char* StatsXmlWriter::Reserve(size_t Size)
+{
+    if (Buffer_End+Size>Buffer.size())
+    {
+        Flush();
+        if (Size>Buffer.size())
+            Buffer.resize(Size);
+    }
+    return Buffer.data()+Buffer_End;
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Flush()
+{
+    if (IsOk && Buffer_End && !Output(Buffer.data(), Buffer_End))
+        IsOk=false;
+    BytesCount+=Buffer_End;
+    Buffer_End=0;
+}
+
+//---------------------------------------------------------------------------
+bool StatsXmlWriter::Finish()
+{
+    Flush();
+    return IsOk;
+}
+
+//***************************************************************************
+// Text
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Text(const char* Value)
+{
+    Text(Value, strlen(Value));
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Text(const char* Value, size_t Size)
+{
+    // Big blocks (e.g. the streams and formats part) are sent as is
+    if (Size>=Buffer.size())
+    {
+        Flush();
+        if (IsOk && !Output(Value, Size))
+            IsOk=false;
+        BytesCount+=Size;
+        return;
+    }
+
+    memcpy(Reserve(Size), Value, Size);
+    Buffer_End+=Size;
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Fixed(double Value, int Precision)
+{
+    char* Begin=Reserve(Number_MaxSize);
+    Buffer_End+=fmt::format_to_n(Begin, Number_MaxSize, "{:.{}f}", Value, Precision).out-Begin;
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Integer(int64_t Value)
+{
+    fmt::format_int Formatted(Value);
+    Text(Formatted.data(), Formatted.size());
+}
+
+//***************************************************************************
+// Frames
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::FrameBegin(const char* MediaType, int StreamIndex)
+{
+    Text("        <frame media_type=\"");
+    Text(MediaType);
+    Text("\" stream_index=\"");
+    Integer(StreamIndex);
+    Text("\"", 1);
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Attribute(const char* Name, const char* Value)
+{
+    Text(" ", 1);
+    Text(Name);
+    Text("=\"", 2);
+    Text(Value);
+    Text("\"", 1);
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Attribute(const char* Name, int64_t Value)
+{
+    Text(" ", 1);
+    Text(Name);
+    Text("=\"", 2);
+    Integer(Value);
+    Text("\"", 1);
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Attribute(const char* Name, char Value)
+{
+    Text(" ", 1);
+    Text(Name);
+    Text("=\"", 2);
+    Text(&Value, 1);
+    Text("\"", 1);
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::AttributeFixed(const char* Name, double Value, int Precision)
+{
+    Text(" ", 1);
+    Text(Name);
+    Text("=\"", 2);
+    Fixed(Value, Precision);
+    Text("\"", 1);
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::FrameAttributesEnd()
+{
+    Text(">\n", 2);
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::FrameEnd()
+{
+    Text("        </frame>\n");
+    FramesCount++;
+}
+
+//***************************************************************************
+// Tags
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Tag(const char* Key, double Value)
+{
+    Text("            <tag key=\"");
+    Text(Key);
+    Text("\" value=\"");
+    Fixed(Value, 6); // As std::to_string()
+    Text("\"/>\n");
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Tag(const char* Key, int Value)
+{
+    Text("            <tag key=\"");
+    Text(Key);
+    Text("\" value=\"");
+    Integer(Value);
+    Text("\"/>\n");
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Tag(const char* Key, const char* Value)
+{
+    Text("            <tag key=\"");
+    Text(Key);
+    Text("\" value=\"");
+    Text(Value);
+    Text("\"/>\n");
+}
+
+//---------------------------------------------------------------------------
+std::string StatsXmlWriter::TagPrefix(const char* Key)
+{
+    return std::string("            <tag key=\"")+Key+"\" value=\"";
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Tag(const std::string& Prefix, double Value)
+{
+    // One reservation for the whole tag
+    char* Begin=Reserve(Prefix.size()+Number_MaxSize+4);
+    memcpy(Begin, Prefix.data(), Prefix.size());
+    char* End=fmt::format_to_n(Begin+Prefix.size(), Number_MaxSize, "{:.6f}", Value).out; // As Tag(Key, Value)
+    memcpy(End, "\"/>\n", 4);
+    Buffer_End+=End+4-Begin;
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Tag(const std::string& Prefix, int Value)
+{
+    Text(Prefix);
+    Integer(Value);
+    Text("\"/>\n", 4);
+}
+
+//---------------------------------------------------------------------------
+void StatsXmlWriter::Tag(const std::string& Prefix, const char* Value)
+{
+    Text(Prefix);
+    Text(Value);
+    Text("\"/>\n", 4);
+}
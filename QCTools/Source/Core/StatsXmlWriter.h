@@ -0,0 +1,79 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef StatsXmlWriter_H
+#define StatsXmlWriter_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Buffered writer for QCTools reports, counterpart of StatsXmlReader.
+//
+// Text and numbers are formatted (with fmt) straight into one reusable block,
+// which is sent to the OutputHandler (file, deflate) each time it is full, so
+// the whole report never exists in memory and nothing is allocated per frame.
+// Numbers are formatted as the previous std::stringstream/std::to_string code
+// did: integers in decimal, values with 6 digits after the comma, timestamps
+// with 7 digits after the comma.
+class StatsXmlWriter
+{
+public:
+    // Returns false on error, nothing is sent after a failure
+    typedef std::function<bool(const char* Data, size_t Size)> OutputHandler;
+
+    explicit                    StatsXmlWriter              (const OutputHandler& Output);
+
+    // Raw text
+    void                        Text                        (const char* Value);
+    void                        Text                        (const char* Value, size_t Size);
+    void                        Text                        (const std::string& Value) {Text(Value.data(), Value.size());}
+
+    // <frame ...>, attributes are written until FrameAttributesEnd()
+    void                        FrameBegin                  (const char* MediaType, int StreamIndex);
+    void                        Attribute                   (const char* Name, const char* Value);
+    void                        Attribute                   (const char* Name, int64_t Value);
+    void                        Attribute                   (const char* Name, char Value);
+    void                        AttributeFixed              (const char* Name, double Value, int Precision);
+    void                        FrameAttributesEnd          ();
+    void                        FrameEnd                    ();
+
+    // <tag key=... value=.../>
+    void                        Tag                         (const char* Key, double Value);
+    void                        Tag                         (const char* Key, int Value);
+    void                        Tag                         (const char* Key, const char* Value);
+
+    // Same with the start of the tags of a key, formatted once per export for the tags of all the frames
+    static std::string          TagPrefix                   (const char* Key);
+    void                        Tag                         (const std::string& Prefix, double Value);
+    void                        Tag                         (const std::string& Prefix, int Value);
+    void                        Tag                         (const std::string& Prefix, const char* Value);
+
+    // Sends the remaining data
+    bool                        Finish                      ();
+
+    uint64_t                    framesCount                 () const {return FramesCount;}
+    uint64_t                    bytesCount                  () const {return BytesCount;}
+
+private:
+    char*                       Reserve                     (size_t Size);
+    void                        Flush                       ();
+    void                        Fixed                       (double Value, int Precision);
+    void                        Integer                     (int64_t Value);
+
+    OutputHandler               Output;
+    std::vector<char>           Buffer;
+    size_t                      Buffer_End {0};
+    bool                        IsOk {true};
+    uint64_t                    FramesCount {0};
+    uint64_t                    BytesCount {0};
+};
+
+#endif // StatsXmlWriter_H
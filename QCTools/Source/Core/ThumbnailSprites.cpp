@@ -0,0 +1,231 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/ThumbnailSprites.h"
+#include "Core/CommonStats.h"
+#include "Core/ThumbnailStore.h"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstring>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+ThumbnailSprites::ThumbnailSprites(const QString& Directory_, int PerMinute, const QString& Format_, int Columns_, int Rows_)
+: Directory(Directory_),
+  Interval(60.0/(PerMinute>0?PerMinute:60)),
+  Format(Format_.toLower()=="webp"?"webp":"jpg"),
+  Columns(Columns_>0?Columns_:10),
+  Rows(Rows_>0?Rows_:10)
+{
+    QDir().mkpath(Directory);
+}
+
+//---------------------------------------------------------------------------
+ThumbnailSprites::~ThumbnailSprites()
+{
+    av_frame_free(&Sheet);
+}
+
+//***************************************************************************
+// Info
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+size_t ThumbnailSprites::Count() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Written;
+}
+
+//***************************************************************************
+// Parsing
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ThumbnailSprites::Push(const ThumbnailStore& Thumbnails, CommonStats& Stats_)
+{
+    QMutexLocker Locker(&Mutex);
+    if (!Stats)
+    {
+        // The first call with thumbnails tells the stream
+        if (!Thumbnails.Count())
+            return;
+        Stats=&Stats_;
+    }
+    if (&Stats_!=Stats)
+        return;
+
+    // Frames with their thumbnail, their time stamp and their shot
+    size_t End=std::min(std::min(Thumbnails.Count(), Stats->x_Current_Get()), Stats->shots.Scanned());
+    for (; Frames<End; Frames++)
+    {
+        // First frame, then first frame of each shot, else first frame of each interval
+        double Time=Stats->x[1][Frames]+Stats->FirstTimeStamp;
+        bool IsShot=Frames && Stats->shots.Start(Frames)==Frames;
+        if (HasLast && !(IsShot && Time>=Last+Interval/2) && Time<Last+Interval)
+            continue;
+
+        auto Pixels=Thumbnails.Get(Frames, ThumbnailStore::Size_Parser());
+        if (Pixels.Rgb.isEmpty() || !Sheet_Allocate(Pixels.Width, Pixels.Height))
+            continue;
+        HasLast=true;
+        Last=Time;
+
+        int x=(Tiles%Columns)*TileWidth;
+        int y=(Tiles/Columns)*TileHeight;
+        for (int Line=0; Line<TileHeight; Line++)
+            memcpy(Sheet->data[0]+(ptrdiff_t)(y+Line)*Sheet->linesize[0]+x*3, Pixels.Rgb.constData()+(ptrdiff_t)Line*TileWidth*3, (size_t)TileWidth*3);
+
+        QJsonObject Item;
+        Item["time"]=Time;
+        Item["frame"]=(qint64)Frames;
+        Item["shot"]=IsShot;
+        Item["sheet"]=(qint64)Sheets;
+        Item["x"]=x;
+        Item["y"]=y;
+        Index.append(Item);
+        Written++;
+
+        if (++Tiles==Columns*Rows && !Sheet_Write())
+            HasError=true;
+    }
+}
+
+//---------------------------------------------------------------------------
+bool ThumbnailSprites::Finish()
+{
+    QMutexLocker Locker(&Mutex);
+    if (Tiles && !Sheet_Write())
+        HasError=true;
+
+    QJsonObject Root;
+    Root["format"]=Format;
+    Root["interval"]=Interval;
+    Root["tile_width"]=TileWidth;
+    Root["tile_height"]=TileHeight;
+    Root["columns"]=Columns;
+    Root["rows"]=Rows;
+    QJsonArray Files;
+    for (size_t Pos=0; Pos<Sheets; Pos++)
+        Files.append(QString("sprites_%1.").arg(Pos)+Format);
+    Root["sheets"]=Files;
+    Root["thumbnails"]=Index;
+
+    QFile File(Directory+"/sprites.json");
+    QByteArray Json=QJsonDocument(Root).toJson(QJsonDocument::Compact);
+    return File.open(QIODevice::WriteOnly) && File.write(Json)==Json.size() && !HasError;
+}
+
+//***************************************************************************
+// Output
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// Black sheet of the size of the tiles of the first thumbnail, thumbnails of another size are not kept
+bool ThumbnailSprites::Sheet_Allocate(int Width, int Height)
+{
+    if (!TileWidth)
+    {
+        TileWidth=Width;
+        TileHeight=Height;
+    }
+    if (Width!=TileWidth || Height!=TileHeight || TileWidth<=0 || TileHeight<=0)
+        return false;
+    if (Sheet && Tiles)
+        return true;
+
+    if (!Sheet)
+    {
+        Sheet=av_frame_alloc();
+        if (!Sheet)
+            return false;
+        Sheet->format=AV_PIX_FMT_RGB24;
+        Sheet->width=TileWidth*Columns;
+        Sheet->height=TileHeight*Rows;
+        if (av_frame_get_buffer(Sheet, 0)<0)
+        {
+            av_frame_free(&Sheet);
+            return false;
+        }
+    }
+    for (int y=0; y<Sheet->height; y++)
+        memset(Sheet->data[0]+(ptrdiff_t)y*Sheet->linesize[0], 0, (size_t)Sheet->width*3);
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Encoded with FFmpeg as FrameSnapshots, in the YUV 4:2:0 the encoder takes
+bool ThumbnailSprites::Sheet_Write()
+{
+    bool IsWebp=Format=="webp";
+    AVPixelFormat PixelFormat=IsWebp?AV_PIX_FMT_YUV420P:AV_PIX_FMT_YUVJ420P;
+    QString FileName=Directory+QString("/sprites_%1.").arg(Sheets)+Format;
+    Sheets++;
+    Tiles=0;
+
+    const AVCodec* Codec=avcodec_find_encoder(IsWebp?AV_CODEC_ID_WEBP:AV_CODEC_ID_MJPEG);
+    if (!Codec)
+        return false;
+
+    AVFrame* Converted=av_frame_alloc();
+    SwsContext* ScaleContext=sws_getContext(Sheet->width, Sheet->height, AV_PIX_FMT_RGB24, Sheet->width, Sheet->height, PixelFormat, SWS_BICUBIC, nullptr, nullptr, nullptr);
+    AVCodecContext* Context=avcodec_alloc_context3(Codec);
+    AVPacket* Packet=av_packet_alloc();
+    bool Result=false;
+    if (Converted && ScaleContext && Context && Packet)
+    {
+        Converted->format=PixelFormat;
+        Converted->width=Sheet->width;
+        Converted->height=Sheet->height;
+        Context->width=Sheet->width;
+        Context->height=Sheet->height;
+        Context->pix_fmt=PixelFormat;
+        Context->time_base={1, 25};
+        // Fixed quality, as "ffmpeg -q:v 3" for JPEG, the default of the encoder for WebP
+        if (!IsWebp)
+        {
+            Context->flags|=AV_CODEC_FLAG_QSCALE;
+            Context->global_quality=FF_QP2LAMBDA*3;
+            Context->color_range=AVCOL_RANGE_JPEG;
+        }
+
+        if (av_frame_get_buffer(Converted, 0)>=0
+         && sws_scale(ScaleContext, Sheet->data, Sheet->linesize, 0, Sheet->height, Converted->data, Converted->linesize)>=0
+         && avcodec_open2(Context, Codec, nullptr)>=0)
+        {
+            Converted->quality=Context->global_quality;
+            if (avcodec_send_frame(Context, Converted)>=0
+             && avcodec_send_frame(Context, nullptr)>=0
+             && avcodec_receive_packet(Context, Packet)>=0)
+            {
+                QFile File(FileName);
+                Result=File.open(QIODevice::WriteOnly) && File.write((const char*)Packet->data, Packet->size)==Packet->size;
+            }
+        }
+    }
+    av_packet_free(&Packet);
+    avcodec_free_context(&Context);
+    sws_freeContext(ScaleContext);
+    av_frame_free(&Converted);
+    return Result;
+}
@@ -0,0 +1,74 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ThumbnailSprites_H
+#define ThumbnailSprites_H
+
+#include <QJsonArray>
+#include <QMutex>
+#include <QString>
+#include <cstddef>
+
+struct AVFrame;
+class CommonStats;
+class ThumbnailStore;
+
+//---------------------------------------------------------------------------
+// Sprite sheets of the thumbnails of a file, for the timelines of the web
+// dashboard and of the reports without reading the media: the thumbnails
+// of the parsing (72x72, 144x144 with ThumbnailStore::Mipmap_Set) of the
+// first frame of each shot (see StatsShots), and of one frame by interval
+// of 1/PerMinute minute in the longer shots, tiled left to right then top to
+// bottom in sheets of Columns x Rows tiles. Shots starting less than half an
+// interval after the previous thumbnail are skipped.
+//
+// Sheets are written during the parsing once full, "sprites_<n>.<format>"
+// in the directory, the last one by Finish() with "sprites.json", the index:
+// size of the tiles and of the sheets, then each thumbnail with its time
+// stamp, its frame, if it starts a shot, its sheet and its position in the
+// sheet.
+class ThumbnailSprites
+{
+public:
+    // Format is "jpg" or "webp"
+                                ThumbnailSprites            (const QString& Directory, int PerMinute, const QString& Format, int Columns=10, int Rows=10);
+                                ~ThumbnailSprites           ();
+
+    // From the parser threads, once a thumbnail is added to Thumbnails and once a frame is added to Stats (the stats of the
+    // video stream of the thumbnails, given with the thumbnails): the frames having both are tiled or skipped in order
+    void                        Push                        (const ThumbnailStore& Thumbnails, CommonStats& Stats);
+    // After the parsing, false if a sheet or the index could not be written
+    bool                        Finish                      ();
+
+    size_t                      Count                       () const;
+
+private:
+    bool                        Sheet_Allocate              (int Width, int Height);
+    bool                        Sheet_Write                 ();
+
+    QString                     Directory;
+    double                      Interval;                   // Seconds between two thumbnails
+    QString                     Format;
+    int                         Columns;
+    int                         Rows;
+
+    mutable QMutex              Mutex;
+    AVFrame*                    Sheet=nullptr;
+    int                         Tiles=0;                    // In the current sheet
+    int                         TileWidth=0;
+    int                         TileHeight=0;
+    CommonStats*                Stats=nullptr;              // Of the thumbnails, from the first Push() with thumbnails
+    size_t                      Frames=0;                   // Tiled or skipped
+    double                      Last=0;                     // Time of the last thumbnail kept
+    bool                        HasLast=false;
+    size_t                      Sheets=0;                   // Written
+    size_t                      Written=0;                  // Thumbnails
+    bool                        HasError=false;
+    QJsonArray                  Index;
+};
+
+#endif // ThumbnailSprites_H
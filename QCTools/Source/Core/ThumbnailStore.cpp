@@ -0,0 +1,389 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/ThumbnailStore.h"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+
+#include <QMutexLocker>
+#include <atomic>
+#include <cstring>
+#include <zlib.h>
+
+//---------------------------------------------------------------------------
+// 256 thumbnails of 72x72 are about 4 MiB (about 21 MiB with mipmaps)
+static const size_t ChunkSize=256;
+// Levels with mipmaps, 144x144 to 36x36
+static const int Mipmap_Levels=3;
+// Decompressed chunks kept, enough for the thumbnails displayed around the current frame
+static const size_t Decompressed_Max=4;
+// Of Decimate(), one thumbnail per about 10 s of 25 fps
+static const int Decimation_Max=256;
+
+static std::atomic<int> ThumbnailStore_Decimation(1);
+static std::atomic<bool> ThumbnailStore_Compression(true);
+static std::atomic<bool> ThumbnailStore_Mipmap(false);
+
+//---------------------------------------------------------------------------
+void ThumbnailStore::Decimation_Set(int Count)
+{
+    ThumbnailStore_Decimation=Count>1?Count:1;
+}
+
+//---------------------------------------------------------------------------
+int ThumbnailStore::Decimation_Get()
+{
+    return ThumbnailStore_Decimation;
+}
+
+//---------------------------------------------------------------------------
+void ThumbnailStore::Compression_Set(bool Compress)
+{
+    ThumbnailStore_Compression=Compress;
+}
+
+//---------------------------------------------------------------------------
+bool ThumbnailStore::Compression_Get()
+{
+    return ThumbnailStore_Compression;
+}
+
+//---------------------------------------------------------------------------
+void ThumbnailStore::Mipmap_Set(bool Value)
+{
+    ThumbnailStore_Mipmap=Value;
+}
+
+//---------------------------------------------------------------------------
+bool ThumbnailStore::Mipmap_Get()
+{
+    return ThumbnailStore_Mipmap;
+}
+
+//---------------------------------------------------------------------------
+int ThumbnailStore::Size_Parser()
+{
+    return Mipmap_Get()?Size*2:Size;
+}
+
+//---------------------------------------------------------------------------
+// 2x2 box filter of rgb24, the last line or column of an odd size is dropped
+static void Halve(const unsigned char* Source, int Width, int Height, unsigned char* Dest, int Dest_Width, int Dest_Height)
+{
+    size_t LineSize=(size_t)Width*3;
+    for (int y=0; y<Dest_Height; y++)
+    {
+        const unsigned char* Line0=Source+std::min(y*2, Height-1)*LineSize;
+        const unsigned char* Line1=Source+std::min(y*2+1, Height-1)*LineSize;
+        for (int x=0; x<Dest_Width; x++)
+        {
+            size_t x0=(size_t)std::min(x*2, Width-1)*3;
+            size_t x1=(size_t)std::min(x*2+1, Width-1)*3;
+            for (int c=0; c<3; c++)
+                *Dest++=(unsigned char)((Line0[x0+c]+Line0[x1+c]+Line1[x0+c]+Line1[x1+c]+2)>>2);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------
+ThumbnailStore::ThumbnailStore() :
+    Levels_(Mipmap_Get()?Mipmap_Levels:1),
+    Decimation(Decimation_Get()),
+    Compression(Compression_Get())
+{
+}
+
+//---------------------------------------------------------------------------
+ThumbnailStore::~ThumbnailStore()
+{
+    sws_freeContext(ScaleContext);
+}
+
+//---------------------------------------------------------------------------
+void ThumbnailStore::Push(const AVFrame* Frame)
+{
+    QMutexLocker Locker(&Mutex);
+
+    size_t Pos=Frames++;
+    Pts.push_back(Frame->pts);
+    if (Pos%Decimation)
+        return;
+
+    if (!Stored)
+    {
+        Width_=Frame->width;
+        Height_=Frame->height;
+
+        // Thumbnails of a report are 72x72 already, their levels are smaller
+        Base=0;
+        while (Base+1<Levels_ && std::max(Level_Width(Base), Level_Height(Base))>Size)
+            Base++;
+    }
+    size_t LineSize=(size_t)Width_*3;
+
+    unsigned char* Dest=Append();
+    if (Frame->format==AV_PIX_FMT_RGB24 && Frame->width==Width_ && Frame->height==Height_)
+    {
+        for (int Line=0; Line<Height_; Line++)
+            std::memcpy(Dest+Line*LineSize, Frame->data[0]+Line*Frame->linesize[0], LineSize);
+    }
+    else
+    {
+        // Thumbnails read from a .qctools.mkv report are not rgb24, frames which can not be converted are kept black so positions do not change
+        ScaleContext=sws_getCachedContext(ScaleContext, Frame->width, Frame->height, (AVPixelFormat)Frame->format, Width_, Height_, AV_PIX_FMT_RGB24, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+        uint8_t* DestData[4]={Dest, nullptr, nullptr, nullptr};
+        int DestLineSize[4]={(int)LineSize, 0, 0, 0};
+        if (!ScaleContext || sws_scale(ScaleContext, Frame->data, Frame->linesize, 0, Frame->height, DestData, DestLineSize)<0)
+            std::memset(Dest, 0, LineSize*Height_);
+    }
+
+    for (int Level=1; Level<Levels_; Level++)
+        Halve(Dest+Level_Offset(Level-1), Level_Width(Level-1), Level_Height(Level-1), Dest+Level_Offset(Level), Level_Width(Level), Level_Height(Level));
+}
+
+//---------------------------------------------------------------------------
+size_t ThumbnailStore::Count() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Frames;
+}
+
+//---------------------------------------------------------------------------
+int ThumbnailStore::Width() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Level_Width(Base);
+}
+
+//---------------------------------------------------------------------------
+int ThumbnailStore::Height() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Level_Height(Base);
+}
+
+//---------------------------------------------------------------------------
+int ThumbnailStore::Levels() const
+{
+    QMutexLocker Locker(&Mutex);
+    return Levels_;
+}
+
+//---------------------------------------------------------------------------
+Thumbnail ThumbnailStore::Get(size_t Pos) const
+{
+    QMutexLocker Locker(&Mutex);
+    return Get_Level(Pos, Base);
+}
+
+//---------------------------------------------------------------------------
+Thumbnail ThumbnailStore::Get(size_t Pos, int MinSize) const
+{
+    QMutexLocker Locker(&Mutex);
+
+    int Level=Levels_-1;
+    while (Level && std::max(Level_Width(Level), Level_Height(Level))<MinSize)
+        Level--;
+    return Get_Level(Pos, Level);
+}
+
+//---------------------------------------------------------------------------
+Thumbnail ThumbnailStore::Get_Level(size_t Pos, int Level) const
+{
+    Thumbnail Result;
+    const unsigned char* Source=Pixels(Pos);
+    if (!Source)
+        return Result;
+
+    Result.Width=Level_Width(Level);
+    Result.Height=Level_Height(Level);
+    Result.Rgb=QByteArray((const char*)Source+Level_Offset(Level), Result.Width*3*Result.Height);
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+bool ThumbnailStore::Get(size_t Pos, AVFrame* Frame) const
+{
+    QMutexLocker Locker(&Mutex);
+
+    const unsigned char* Source=Pixels(Pos);
+    if (!Source)
+        return false;
+    Source+=Level_Offset(Base);
+    int Width=Level_Width(Base);
+    int Height=Level_Height(Base);
+
+    // The previous content may still be referenced by an encoder
+    if (!Frame->buf[0])
+    {
+        Frame->format=AV_PIX_FMT_RGB24;
+        Frame->width=Width;
+        Frame->height=Height;
+        if (av_frame_get_buffer(Frame, 0)<0)
+            return false;
+    }
+    else if (av_frame_make_writable(Frame)<0)
+        return false;
+
+    size_t LineSize=(size_t)Width*3;
+    for (int Line=0; Line<Height; Line++)
+        std::memcpy(Frame->data[0]+Line*Frame->linesize[0], Source+Line*LineSize, LineSize);
+    Frame->pts=Pts[Pos];
+    return true;
+}
+
+//---------------------------------------------------------------------------
+size_t ThumbnailStore::Bytes() const
+{
+    QMutexLocker Locker(&Mutex);
+
+    size_t Result=0;
+    for (const auto& Chunk : Chunks)
+        Result+=Chunk->Raw.capacity()+Chunk->Compressed.size();
+    Result+=Pts.capacity()*sizeof(int64_t);
+    for (const auto& Item : Decompressed)
+        Result+=Item.second.size();
+    return Result;
+}
+
+//---------------------------------------------------------------------------
+void ThumbnailStore::Release()
+{
+    QMutexLocker Locker(&Mutex);
+    for (auto& Chunk : Chunks)
+        if (Chunk->Count==ChunkSize && !Chunk->Raw.empty())
+            Compress(*Chunk);
+    Decompressed.clear();
+}
+
+//---------------------------------------------------------------------------
+bool ThumbnailStore::Decimate()
+{
+    QMutexLocker Locker(&Mutex);
+    if (Decimation>=Decimation_Max)
+        return false;
+
+    // The thumbnails of the even indexes are kept, Pos/Decimation is still their index
+    size_t Size=Bytes_Thumbnail();
+    std::vector<std::unique_ptr<chunk>> Old;
+    Old.swap(Chunks);
+    Decompressed.clear();
+    Stored=0;
+    for (auto& Chunk : Old)
+    {
+        std::vector<unsigned char> Raw;
+        Raw.swap(Chunk->Raw);
+        if (Raw.empty())
+        {
+            // Not decompressed thumbnails are kept black so positions do not change
+            Raw.resize(Size*Chunk->Count);
+            uLongf RawSize=(uLongf)Raw.size();
+            if (uncompress(Raw.data(), &RawSize, (const Bytef*)Chunk->Compressed.constData(), (uLong)Chunk->Compressed.size())!=Z_OK || RawSize!=Raw.size())
+                std::memset(Raw.data(), 0, Raw.size());
+        }
+        for (size_t InChunk=0; InChunk<Chunk->Count; InChunk+=2)
+            std::memcpy(Append(), Raw.data()+InChunk*Size, Size);
+        Chunk.reset();
+    }
+
+    Decimation*=2;
+    return true;
+}
+
+//---------------------------------------------------------------------------
+unsigned char* ThumbnailStore::Append()
+{
+    size_t Size=Bytes_Thumbnail();
+    if (Chunks.empty() || Chunks.back()->Count==ChunkSize)
+    {
+        if (!Chunks.empty() && Compression)
+            Compress(*Chunks.back());
+        Chunks.emplace_back(new chunk);
+        Chunks.back()->Raw.reserve(Size*ChunkSize);
+    }
+
+    chunk& Chunk=*Chunks.back();
+    size_t Offset=Chunk.Raw.size();
+    Chunk.Raw.resize(Offset+Size);
+    Chunk.Count++;
+    Stored++;
+    return Chunk.Raw.data()+Offset;
+}
+
+//---------------------------------------------------------------------------
+const unsigned char* ThumbnailStore::Pixels(size_t Pos) const
+{
+    if (Pos>=Frames)
+        return nullptr;
+
+    size_t Index=Pos/Decimation;
+    size_t ChunkIndex=Index/ChunkSize;
+    if (ChunkIndex>=Chunks.size())
+        return nullptr;
+    const chunk& Chunk=*Chunks[ChunkIndex];
+    size_t InChunk=Index%ChunkSize;
+    if (InChunk>=Chunk.Count)
+        return nullptr;
+    size_t Offset=InChunk*Bytes_Thumbnail();
+
+    if (!Chunk.Raw.empty())
+        return Chunk.Raw.data()+Offset;
+
+    for (auto Item=Decompressed.begin(); Item!=Decompressed.end(); ++Item)
+        if (Item->first==ChunkIndex)
+        {
+            Decompressed.splice(Decompressed.begin(), Decompressed, Item);
+            return Decompressed.front().second.data()+Offset;
+        }
+
+    std::vector<unsigned char> Raw(Bytes_Thumbnail()*Chunk.Count);
+    uLongf RawSize=(uLongf)Raw.size();
+    if (uncompress(Raw.data(), &RawSize, (const Bytef*)Chunk.Compressed.constData(), (uLong)Chunk.Compressed.size())!=Z_OK || RawSize!=Raw.size())
+        return nullptr;
+
+    Decompressed.emplace_front(ChunkIndex, std::move(Raw));
+    if (Decompressed.size()>Decompressed_Max)
+        Decompressed.pop_back();
+    return Decompressed.front().second.data()+Offset;
+}
+
+//---------------------------------------------------------------------------
+size_t ThumbnailStore::Level_Offset(int Level) const
+{
+    size_t Offset=0;
+    for (int Previous=0; Previous<Level; Previous++)
+        Offset+=(size_t)Level_Width(Previous)*3*Level_Height(Previous);
+    return Offset;
+}
+
+//---------------------------------------------------------------------------
+size_t ThumbnailStore::Bytes_Thumbnail() const
+{
+    return Level_Offset(Levels_);
+}
+
+//---------------------------------------------------------------------------
+void ThumbnailStore::Compress(chunk& Chunk)
+{
+    uLongf CompressedSize=compressBound((uLong)Chunk.Raw.size());
+    Chunk.Compressed.resize((int)CompressedSize);
+    if (compress2((Bytef*)Chunk.Compressed.data(), &CompressedSize, Chunk.Raw.data(), (uLong)Chunk.Raw.size(), Z_BEST_SPEED)!=Z_OK)
+    {
+        // Kept as is
+        Chunk.Compressed.clear();
+        return;
+    }
+
+    Chunk.Compressed.resize((int)CompressedSize);
+    Chunk.Compressed.squeeze();
+    std::vector<unsigned char>().swap(Chunk.Raw);
+}
@@ -0,0 +1,124 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ThumbnailStore_H
+#define ThumbnailStore_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+struct AVFrame;
+struct SwsContext;
+
+//---------------------------------------------------------------------------
+// Pixels of an rgb24 thumbnail, Width*3 bytes per line
+struct Thumbnail
+{
+    int                         Width = 0;
+    int                         Height = 0;
+    QByteArray                  Rgb;
+    bool                        IsApproximate = false;      // Of another frame, until the frame is parsed (see KeyFrameThumbnails)
+};
+
+//---------------------------------------------------------------------------
+// Thumbnails of a file (72x72 rgb24, one per frame), packed without the
+// decoded frames and their buffers.
+//
+// Pixels are appended to chunks of contiguous memory. Full chunks may be
+// deflated (zlib, lossless), the last decompressed chunks are kept for the
+// reads of the display which are mostly around the current frame.
+// With a decimation factor only one thumbnail out of Decimation is kept, the
+// others are read as the kept one before them.
+//
+// With mipmaps, the parser outputs 144x144 thumbnails and each one is kept
+// with its 72x72 and 36x36 reductions (2x2 box filter) next to it: one
+// downscale of the decoded frame for all the sizes, each consumer reads the
+// level of its size instead of rescaling. The 72x72 level is the one of the
+// reports and of Get(Pos).
+class ThumbnailStore
+{
+public:
+    // Settings for the stores created afterwards
+    static void                 Decimation_Set              (int Count);
+    static int                  Decimation_Get              ();
+    static void                 Compression_Set             (bool Compress);
+    static bool                 Compression_Get             ();
+    static void                 Mipmap_Set                  (bool Value);
+    static bool                 Mipmap_Get                  ();
+
+    // Size of the thumbnails of the reports, and of the thumbnails of the parser (twice with mipmaps)
+    static const int            Size=72;
+    static int                  Size_Parser                 ();
+
+                                ThumbnailStore              ();
+                                ~ThumbnailStore             ();
+
+    // Frames are converted to rgb24 of the size of the first one if needed, the first one is the largest level
+    void                        Push                        (const AVFrame* Frame);
+
+    // Count of frames pushed, including the ones dropped by the decimation
+    size_t                      Count                       () const;
+    // Of the 72x72 level, else the largest one smaller
+    int                         Width                       () const;
+    int                         Height                      () const;
+    // Sizes kept, largest first
+    int                         Levels                      () const;
+
+    // Empty if Pos is not available, of the 72x72 level
+    Thumbnail                   Get                         (size_t Pos) const;
+    // Smallest level of MinSize pixels or more on its largest side, else the largest level
+    Thumbnail                   Get                         (size_t Pos, int MinSize) const;
+    // Same as Get(Pos) in an rgb24 frame of the size of the thumbnails, with the timestamp of the frame Pos, returns false if Pos is not available
+    bool                        Get                         (size_t Pos, AVFrame* Frame) const;
+
+    // Memory used by the pixels
+    size_t                      Bytes                       () const;
+    // Compresses the full chunks even if the compression is disabled and drops the decompressed ones, for files not displayed
+    void                        Release                     ();
+    // Doubles the decimation, of the thumbnails kept too, returns false if it is already the maximum (see MemoryPressure)
+    bool                        Decimate                    ();
+
+private:
+    struct chunk
+    {
+        std::vector<unsigned char> Raw;                     // Empty if compressed
+        QByteArray              Compressed;
+        size_t                  Count = 0;
+    };
+
+    const unsigned char*        Pixels                      (size_t Pos) const;
+    // Of all the levels of a thumbnail, the levels are one after the other
+    size_t                      Bytes_Thumbnail             () const;
+    int                         Level_Width                 (int Level) const {return std::max(Width_>>Level, Width_?1:0);}
+    int                         Level_Height                (int Level) const {return std::max(Height_>>Level, Height_?1:0);}
+    size_t                      Level_Offset                (int Level) const;
+    Thumbnail                   Get_Level                   (size_t Pos, int Level) const;
+    // Room for one more thumbnail at the end of the chunks
+    unsigned char*              Append                      ();
+    void                        Compress                    (chunk& Chunk);
+
+    mutable QMutex              Mutex;
+    std::vector<std::unique_ptr<chunk>> Chunks;
+    std::vector<int64_t>        Pts;                        // Of all frames
+    mutable std::list<std::pair<size_t, std::vector<unsigned char>>> Decompressed; // Most recent first
+    size_t                      Frames = 0;
+    size_t                      Stored = 0;
+    int                         Width_ = 0;
+    int                         Height_ = 0;
+    int                         Levels_ = 1;
+    int                         Base = 0;                   // Level of Get(Pos)
+    SwsContext*                 ScaleContext = nullptr;
+    int                         Decimation;
+    bool                        Compression;
+};
+
+#endif // ThumbnailStore_H
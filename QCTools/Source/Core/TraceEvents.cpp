@@ -0,0 +1,191 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/TraceEvents.h"
+
+#include <qavplayer.h>
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <chrono>
+#include <memory>
+#include <vector>
+//---------------------------------------------------------------------------
+
+std::atomic<bool> TraceEvents::Enabled(false);
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+struct Event
+{
+    const char*                 Category;
+    const char*                 Name;
+    qint64                      Begin;
+    qint64                      End;
+    qint64                      Arg;
+};
+
+// Events of one thread, kept once the thread ended
+struct Buffer
+{
+    QMutex                      Mutex;
+    std::vector<Event>          Events;
+    size_t                      Dropped=0;
+    size_t                      Thread=0;
+    QByteArray                  ThreadName;
+};
+
+QMutex Buffers_Mutex;
+std::vector<std::shared_ptr<Buffer>> Buffers;
+std::atomic<qint64> Started(0);
+
+//---------------------------------------------------------------------------
+Buffer& Local()
+{
+    thread_local std::shared_ptr<Buffer> Current;
+    if (!Current)
+    {
+        Current=std::make_shared<Buffer>();
+        Current->ThreadName=QThread::currentThread()->objectName().toUtf8();
+        QMutexLocker Locker(&Buffers_Mutex);
+        Current->Thread=Buffers.size()+1;
+        if (Current->ThreadName.isEmpty())
+            Current->ThreadName="thread "+QByteArray::number((qulonglong)Current->Thread);
+        Buffers.push_back(Current);
+    }
+    return *Current;
+}
+
+//---------------------------------------------------------------------------
+void Player_Record(const char* Name, qint64 Begin, qint64 End, qint64 Arg)
+{
+    TraceEvents::Record("player", Name, Begin, End, Arg);
+}
+
+//---------------------------------------------------------------------------
+// Names are static strings without quotes, the thread names are escaped
+QByteArray Escaped(const QByteArray& Value)
+{
+    QByteArray Result;
+    for (char Char : Value)
+    {
+        if (Char=='"' || Char=='\\')
+            Result+='\\';
+        if ((unsigned char)Char>=0x20)
+            Result+=Char;
+    }
+    return Result;
+}
+
+}
+
+//***************************************************************************
+// Recording
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void TraceEvents::Start()
+{
+    {
+        QMutexLocker Locker(&Buffers_Mutex);
+        for (const auto& Item : Buffers)
+        {
+            QMutexLocker BufferLocker(&Item->Mutex);
+            Item->Events.clear();
+            Item->Dropped=0;
+        }
+    }
+    Started=Now();
+    Enabled=true;
+    QAVPlayer::setTraceFunction(Player_Record);
+}
+
+//---------------------------------------------------------------------------
+qint64 TraceEvents::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//---------------------------------------------------------------------------
+void TraceEvents::Record(const char* Category, const char* Name, qint64 Begin, qint64 End, qint64 Arg)
+{
+    if (!IsEnabled() || Begin<Started.load(std::memory_order_relaxed))
+        return;
+
+    auto& Current=Local();
+    QMutexLocker Locker(&Current.Mutex);
+    if (Current.Events.size()>=Thread_MaxEvents)
+    {
+        Current.Dropped++;
+        return;
+    }
+    if (Current.Events.capacity()==Current.Events.size())
+        Current.Events.reserve(Current.Events.empty()?4096:Current.Events.size()*2);
+    Current.Events.push_back(Event{Category, Name, Begin, End, Arg});
+}
+
+//***************************************************************************
+// Output
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool TraceEvents::Stop(const QString& FileName)
+{
+    Enabled=false;
+    QAVPlayer::setTraceFunction(nullptr);
+
+    QFile File(FileName);
+    if (!File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    // Microseconds since the start of the recording
+    const qint64 Origin=Started;
+    QByteArray Data;
+    bool IsOk=true;
+    auto Flush=[&](bool Force) {
+        if (IsOk && (Force || Data.size()>=0x100000))
+        {
+            IsOk=File.write(Data)==Data.size();
+            Data.clear();
+        }
+    };
+
+    Data+="{\"traceEvents\":[\n";
+    Data+="{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"qctools\"}}";
+    size_t Dropped=0;
+    QMutexLocker Locker(&Buffers_Mutex);
+    for (const auto& Item : Buffers)
+    {
+        QMutexLocker BufferLocker(&Item->Mutex);
+        if (Item->Events.empty())
+            continue;
+        Dropped+=Item->Dropped;
+        const QByteArray Thread=QByteArray::number((qulonglong)Item->Thread);
+        Data+=",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"+Thread+",\"args\":{\"name\":\""+Escaped(Item->ThreadName)+"\"}}";
+        for (const auto& Current : Item->Events)
+        {
+            Data+=",\n{\"name\":\"";
+            Data+=Current.Name;
+            Data+="\",\"cat\":\"";
+            Data+=Current.Category;
+            Data+="\",\"ph\":\"X\",\"pid\":1,\"tid\":"+Thread;
+            Data+=",\"ts\":"+QByteArray::number((Current.Begin-Origin)/1000.0, 'f', 3);
+            Data+=",\"dur\":"+QByteArray::number((Current.End-Current.Begin)/1000.0, 'f', 3);
+            if (Current.Arg>=0)
+                Data+=",\"args\":{\"arg\":"+QByteArray::number(Current.Arg)+"}";
+            Data+='}';
+            Flush(false);
+        }
+    }
+    Data+="\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":"+QByteArray::number((qulonglong)Dropped)+"}}\n";
+    Flush(true);
+    return IsOk && File.flush();
+}
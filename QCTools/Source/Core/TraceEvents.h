@@ -0,0 +1,64 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef TraceEvents_H
+#define TraceEvents_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+//---------------------------------------------------------------------------
+// Timeline of the analysis pipeline (qcli --trace-events, or the Record
+// trace action of the GUI), written in the Chrome trace event format
+// (chrome://tracing, ui.perfetto.dev) for finding the stalls.
+//
+// Steps are recorded with their begin, duration and thread: demux reads,
+// decode of each stream, writes and reads of each filter graph and queue
+// waits (see QAVPlayer::setTraceFunction), stats ingest, compression of the
+// report chunks and encoder calls. Each thread appends to a buffer of its
+// own, its lock is taken by another thread only when writing the trace, so
+// recording does not serialize the threads. When not recording, a step costs
+// one relaxed load.
+class TraceEvents
+{
+public:
+    // Recording from now, the events of a previous recording are dropped
+    static void Start();
+    // Recording stopped and events written to FileName, false if it can not be written
+    static bool Stop(const QString& FileName);
+    static bool IsEnabled() {return Enabled.load(std::memory_order_relaxed);}
+
+    // Events kept by thread, the next ones are dropped and counted in the metadata of the trace
+    static const size_t Thread_MaxEvents=1<<20;
+
+    // Nanoseconds of std::chrono::steady_clock, as QAVPlayer
+    static qint64 Now();
+    // Name and Category must be static strings, Arg is the stream, the graph or the size of the step (-1 if none)
+    static void Record(const char* Category, const char* Name, qint64 Begin, qint64 End, qint64 Arg=-1);
+
+    // Step of the current scope
+    class Scope
+    {
+    public:
+        Scope(const char* Category, const char* Name, qint64 Arg=-1)
+            : Category(Category), Name(Name), Arg(Arg), Begin(IsEnabled()?Now():-1) {}
+        ~Scope() {if (Begin>=0) Record(Category, Name, Begin, Now(), Arg);}
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        const char* const Category;
+        const char* const Name;
+        const qint64 Arg;
+        const qint64 Begin;
+    };
+
+private:
+    static std::atomic<bool> Enabled;
+};
+
+#endif // TraceEvents_H
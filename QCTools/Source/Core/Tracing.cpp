@@ -0,0 +1,126 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/Tracing.h"
+
+#include "ThirdParty/spdlog/spdlog.h"
+#include "ThirdParty/spdlog/async.h"
+#include "ThirdParty/spdlog/sinks/stdout_sinks.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringList>
+#include <atomic>
+#include <mutex>
+
+//---------------------------------------------------------------------------
+static const struct
+{
+    const char*                 Name;
+    Tracing::category           Category;
+} CategoryNames[]=
+{
+    { "frames",                 Tracing::Category_Frames },
+    { "panels",                 Tracing::Category_Panels },
+    { "startup",                Tracing::Category_Startup },
+    { "all",                    Tracing::Category_All },
+};
+
+//---------------------------------------------------------------------------
+static unsigned Categories_Parse(const QString& Names, bool* IsOk=nullptr)
+{
+    unsigned Result=0;
+    bool Ok=true;
+    for (const auto& Name : Names.split(','))
+    {
+        if (Name.trimmed().isEmpty())
+            continue;
+        bool Found=false;
+        for (const auto& Item : CategoryNames)
+            if (Name.trimmed()==QLatin1String(Item.Name))
+            {
+                Result|=Item.Category;
+                Found=true;
+            }
+        Ok&=Found;
+    }
+    if (IsOk)
+        *IsOk=Ok;
+    return Result;
+}
+
+static std::atomic<unsigned> Categories(Categories_Parse(qEnvironmentVariable("QCTOOLS_TRACE")));
+static QMutex Sinks_Mutex;
+static QElapsedTimer Started=[] { QElapsedTimer Result; Result.start(); return Result; }();
+static std::vector<std::shared_ptr<spdlog::sinks::sink>> Sinks;
+
+//***************************************************************************
+// Categories
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool Tracing::enable(const QString& Names)
+{
+    bool IsOk;
+    enable(Categories_Parse(Names, &IsOk));
+    return IsOk;
+}
+
+//---------------------------------------------------------------------------
+void Tracing::enable(unsigned Value)
+{
+    Categories|=Value;
+}
+
+//---------------------------------------------------------------------------
+bool Tracing::isEnabled(category Category)
+{
+    return (Categories.load(std::memory_order_relaxed)&Category)!=0;
+}
+
+//---------------------------------------------------------------------------
+qint64 Tracing::elapsed()
+{
+    return Started.elapsed();
+}
+
+//***************************************************************************
+// Logger
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void Tracing::setSinks(const std::vector<std::shared_ptr<spdlog::sinks::sink>>& Value)
+{
+    QMutexLocker Locker(&Sinks_Mutex);
+    Sinks=Value;
+}
+
+//---------------------------------------------------------------------------
+spdlog::logger* Tracing::logger()
+{
+    // A thread of its own, not the global pool of spdlog
+    static std::shared_ptr<spdlog::details::thread_pool> ThreadPool;
+    static std::shared_ptr<spdlog::logger> Logger;
+    static std::once_flag Once;
+    std::call_once(Once, []() {
+        QMutexLocker Locker(&Sinks_Mutex);
+        if (Sinks.empty())
+        {
+            auto Sink=std::make_shared<spdlog::sinks::stderr_sink_mt>();
+            Sink->set_pattern("[%H:%M:%S.%e] [trace] [thread %t] %v");
+            Sinks.push_back(Sink);
+        }
+
+        // Sinks of --log keep their pattern, flushed with the default logger (flush_every)
+        ThreadPool=std::make_shared<spdlog::details::thread_pool>(8192, 1);
+        Logger=std::make_shared<spdlog::async_logger>("trace", Sinks.begin(), Sinks.end(), ThreadPool, spdlog::async_overflow_policy::overrun_oldest);
+        Logger->set_level(spdlog::level::debug);
+        spdlog::register_logger(Logger);
+    });
+
+    return Logger.get();
+}
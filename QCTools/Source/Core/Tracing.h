@@ -0,0 +1,64 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef Tracing_H
+#define Tracing_H
+
+#include <QString>
+#include <memory>
+#include <vector>
+
+#ifdef QCTOOLS_TRACING
+    #include "ThirdParty/spdlog/spdlog.h"
+#endif
+
+namespace spdlog { class logger; namespace sinks { class sink; } }
+
+//---------------------------------------------------------------------------
+// Messages of the hot paths (one per frame or packet), too many for qDebug(),
+// and of the steps of the startup for timing it.
+//
+// They are compiled only with CONFIG+=tracing (QCTOOLS_TRACING), and written
+// only for the categories enabled at runtime (QCTOOLS_TRACE environment
+// variable or --trace, e.g. "frames,panels" or "all"), so the arguments are
+// not even evaluated otherwise. Messages are queued to an async logger, to
+// the sinks of --log if enabled else to stderr, and dropped if the queue is
+// full: the parser never waits for the log.
+class Tracing
+{
+public:
+    enum category
+    {
+        Category_Frames     = 1 << 0,   // Frames of the filters of the parser
+        Category_Panels     = 1 << 1,   // Panels stored and encoded
+        Category_Startup    = 1 << 2,   // Steps of the startup, with the time since the start of the program
+        Category_All        = 0xFFFF
+    };
+
+    // Comma separated names of the categories, false if one is unknown
+    static bool enable(const QString& Categories);
+    static void enable(unsigned Categories);
+    static bool isEnabled(category Category);
+
+    // Sinks of the default logger, before the first message
+    static void setSinks(const std::vector<std::shared_ptr<spdlog::sinks::sink>>& Sinks);
+
+    static spdlog::logger* logger();
+
+    // Milliseconds since the start of the program (static initialization), for Category_Startup
+    static qint64 elapsed();
+};
+
+#ifdef QCTOOLS_TRACING
+    #define QCTOOLS_TRACE(Category, ...) \
+        do { if (Tracing::isEnabled(Tracing::Category)) Tracing::logger()->debug(__VA_ARGS__); } while (0)
+#else
+    #define QCTOOLS_TRACE(Category, ...) \
+        do {} while (0)
+#endif
+
+#endif // Tracing_H
@@ -0,0 +1,352 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/UringQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+// Headers of Linux 5.6 and later (IORING_OP_OPENAT, IORING_OP_READ)
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #include <linux/io_uring.h>
+        #if defined(IORING_FEAT_RW_CUR_POS)
+            #define QCTOOLS_URING 1
+        #endif
+    #endif
+#endif
+
+#ifdef QCTOOLS_URING
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef __NR_io_uring_setup
+    #define __NR_io_uring_setup 425
+    #define __NR_io_uring_enter 426
+    #define __NR_io_uring_register 427
+#endif
+#endif
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Defaults
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+static std::atomic<bool> Enabled(false);
+
+//---------------------------------------------------------------------------
+void UringQueue::Enabled_Set(bool Value)
+{
+    Enabled=Value;
+}
+
+//---------------------------------------------------------------------------
+bool UringQueue::Enabled_Get()
+{
+    return Enabled && IsAvailable();
+}
+
+//---------------------------------------------------------------------------
+#ifdef QCTOOLS_URING
+static bool Probe()
+{
+    io_uring_params Params;
+    std::memset(&Params, 0, sizeof(Params));
+    int Fd=(int)syscall(__NR_io_uring_setup, 1, &Params);
+    if (Fd<0)
+        return false; // Not supported, or disabled (kernel.io_uring_disabled)
+
+    // Opcodes used by the readers
+    const size_t Size=sizeof(io_uring_probe)+256*sizeof(io_uring_probe_op);
+    std::vector<char> Buffer(Size, 0);
+    auto Ops=reinterpret_cast<io_uring_probe*>(Buffer.data());
+    bool IsOk=syscall(__NR_io_uring_register, Fd, IORING_REGISTER_PROBE, Ops, 256)>=0;
+    for (int Op : {IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_OPENAT, IORING_OP_CLOSE})
+        IsOk=IsOk && Op<=Ops->last_op && (Ops->ops[Op].flags&IO_URING_OP_SUPPORTED);
+    close(Fd);
+    return IsOk;
+}
+#endif
+
+//---------------------------------------------------------------------------
+bool UringQueue::IsAvailable()
+{
+#ifdef QCTOOLS_URING
+    static const bool Available=Probe();
+    return Available;
+#else
+    return false;
+#endif
+}
+
+//***************************************************************************
+// Constructor / Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+UringQueue::UringQueue(unsigned Entries_)
+{
+#ifdef QCTOOLS_URING
+    if (!IsAvailable())
+        return;
+
+    io_uring_params Params;
+    std::memset(&Params, 0, sizeof(Params));
+    int Fd=(int)syscall(__NR_io_uring_setup, Entries_?Entries_:1, &Params);
+    if (Fd<0)
+        return;
+
+    Sq_Ring_Size=Params.sq_off.array+Params.sq_entries*sizeof(unsigned);
+    Cq_Ring_Size=Params.cq_off.cqes+Params.cq_entries*sizeof(io_uring_cqe);
+    bool Single=Params.features&IORING_FEAT_SINGLE_MMAP;
+    if (Single)
+        Sq_Ring_Size=Cq_Ring_Size=std::max(Sq_Ring_Size, Cq_Ring_Size);
+    Sqes_Size=Params.sq_entries*sizeof(io_uring_sqe);
+
+    auto Map=[&](size_t Size, off_t Offset) {
+        void* Data=mmap(nullptr, Size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, Fd, Offset);
+        return Data==MAP_FAILED?nullptr:Data;
+    };
+    Sq_Ring=Map(Sq_Ring_Size, IORING_OFF_SQ_RING);
+    Cq_Ring=Single?Sq_Ring:Map(Cq_Ring_Size, IORING_OFF_CQ_RING);
+    Sqes=Map(Sqes_Size, IORING_OFF_SQES);
+    Ring_Fd=Fd;
+    if (!Sq_Ring || !Cq_Ring || !Sqes)
+    {
+        Release();
+        return;
+    }
+
+    auto Sq=static_cast<char*>(Sq_Ring);
+    Sq_Head=reinterpret_cast<unsigned*>(Sq+Params.sq_off.head);
+    Sq_Tail=reinterpret_cast<unsigned*>(Sq+Params.sq_off.tail);
+    Sq_Mask=reinterpret_cast<unsigned*>(Sq+Params.sq_off.ring_mask);
+    Sq_Array=reinterpret_cast<unsigned*>(Sq+Params.sq_off.array);
+    auto Cq=static_cast<char*>(Cq_Ring);
+    Cq_Head=reinterpret_cast<unsigned*>(Cq+Params.cq_off.head);
+    Cq_Tail=reinterpret_cast<unsigned*>(Cq+Params.cq_off.tail);
+    Cq_Mask=reinterpret_cast<unsigned*>(Cq+Params.cq_off.ring_mask);
+    Cqes=Cq+Params.cq_off.cqes;
+    Sq_Entries=Params.sq_entries;
+#else
+    (void)Entries_;
+#endif
+}
+
+//---------------------------------------------------------------------------
+UringQueue::~UringQueue()
+{
+#ifdef QCTOOLS_URING
+    if (Ring_Fd<0)
+        return;
+
+    // Requests in flight are completed first, their buffers are freed by the caller afterwards
+    while (InFlight && Submit(1))
+    {
+        uint64_t UserData;
+        int Result;
+        bool Opened;
+        while (Pop(UserData, Result, Opened))
+            if (Opened && Result>=0)
+                close(Result);
+    }
+    Release();
+#endif
+}
+
+//---------------------------------------------------------------------------
+void UringQueue::Release()
+{
+#ifdef QCTOOLS_URING
+    if (Sqes)
+        munmap(Sqes, Sqes_Size);
+    if (Cq_Ring && Cq_Ring!=Sq_Ring)
+        munmap(Cq_Ring, Cq_Ring_Size);
+    if (Sq_Ring)
+        munmap(Sq_Ring, Sq_Ring_Size);
+    close(Ring_Fd);
+    Ring_Fd=-1;
+    Sq_Ring=Cq_Ring=Sqes=nullptr;
+#endif
+}
+
+//***************************************************************************
+// Requests
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+bool UringQueue::Buffers_Register(const std::vector<std::pair<void*, size_t>>& Buffers)
+{
+#ifdef QCTOOLS_URING
+    if (!IsOpen() || Registered || InFlight)
+        return false;
+
+    std::vector<iovec> Vectors;
+    for (const auto& Buffer : Buffers)
+        Vectors.push_back(iovec{Buffer.first, Buffer.second});
+    Registered=syscall(__NR_io_uring_register, Ring_Fd, IORING_REGISTER_BUFFERS, Vectors.data(), (unsigned)Vectors.size())>=0;
+    return Registered;
+#else
+    (void)Buffers;
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------
+void* UringQueue::Entry()
+{
+#ifdef QCTOOLS_URING
+    if (!IsOpen() || InFlight>=Sq_Entries)
+        return nullptr;
+
+    // The kernel moves the head once the entries are consumed, at submission
+    unsigned Tail=*Sq_Tail;
+    if (Tail-__atomic_load_n(Sq_Head, __ATOMIC_ACQUIRE)>=Sq_Entries)
+        return nullptr;
+    unsigned Index=Tail&*Sq_Mask;
+    auto Sqe=static_cast<io_uring_sqe*>(Sqes)+Index;
+    std::memset(Sqe, 0, sizeof(*Sqe));
+    Sq_Array[Index]=Index;
+    __atomic_store_n(Sq_Tail, Tail+1, __ATOMIC_RELEASE);
+    Queued++;
+    InFlight++;
+    return Sqe;
+#else
+    return nullptr;
+#endif
+}
+
+//---------------------------------------------------------------------------
+bool UringQueue::Read(int Fd, void* Data, size_t Size, int64_t Offset, uint64_t UserData, int Buffer)
+{
+#ifdef QCTOOLS_URING
+    auto Sqe=static_cast<io_uring_sqe*>(Entry());
+    if (!Sqe)
+        return false;
+
+    // Filled before the kernel sees the entry, at submission
+    bool Fixed=Registered && Buffer>=0;
+    Sqe->opcode=Fixed?IORING_OP_READ_FIXED:IORING_OP_READ;
+    Sqe->fd=Fd;
+    Sqe->off=(uint64_t)Offset;
+    Sqe->addr=(uint64_t)(uintptr_t)Data;
+    Sqe->len=(uint32_t)Size;
+    if (Fixed)
+        Sqe->buf_index=(uint16_t)Buffer;
+    Sqe->user_data=UserData;
+    return true;
+#else
+    (void)Fd; (void)Data; (void)Size; (void)Offset; (void)UserData; (void)Buffer;
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------
+bool UringQueue::Open(const std::string& FileName, uint64_t UserData)
+{
+#ifdef QCTOOLS_URING
+    auto Sqe=static_cast<io_uring_sqe*>(Entry());
+    if (!Sqe)
+        return false;
+
+    // Kept until completed
+    const auto& Path=Paths[UserData]=FileName;
+    Sqe->opcode=IORING_OP_OPENAT;
+    Sqe->fd=AT_FDCWD;
+    Sqe->addr=(uint64_t)(uintptr_t)Path.c_str();
+    Sqe->open_flags=O_RDONLY|O_CLOEXEC;
+    Sqe->user_data=UserData;
+    return true;
+#else
+    (void)FileName; (void)UserData;
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------
+bool UringQueue::Close(int Fd, uint64_t UserData)
+{
+#ifdef QCTOOLS_URING
+    auto Sqe=static_cast<io_uring_sqe*>(Entry());
+    if (!Sqe)
+        return false;
+
+    Sqe->opcode=IORING_OP_CLOSE;
+    Sqe->fd=Fd;
+    Sqe->user_data=UserData;
+    return true;
+#else
+    (void)Fd; (void)UserData;
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------
+bool UringQueue::Submit(unsigned Wait_Min)
+{
+#ifdef QCTOOLS_URING
+    if (!IsOpen())
+        return false;
+
+    Wait_Min=std::min(Wait_Min, InFlight);
+    for (;;)
+    {
+        // Completions already there are not waited for again
+        if (Wait_Min && __atomic_load_n(Cq_Tail, __ATOMIC_ACQUIRE)-*Cq_Head>=Wait_Min && !Queued)
+            return true;
+        long Result=syscall(__NR_io_uring_enter, Ring_Fd, Queued, Wait_Min, Wait_Min?IORING_ENTER_GETEVENTS:0, nullptr, 0);
+        if (Result>=0)
+        {
+            Queued-=std::min((unsigned)Result, Queued);
+            if (!Queued || !Wait_Min)
+                return true;
+            continue;
+        }
+        if (errno!=EINTR && errno!=EAGAIN && errno!=EBUSY)
+            return false;
+    }
+#else
+    (void)Wait_Min;
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------
+bool UringQueue::Complete(uint64_t& UserData, int& Result)
+{
+    bool Opened;
+    return Pop(UserData, Result, Opened);
+}
+
+//---------------------------------------------------------------------------
+bool UringQueue::Pop(uint64_t& UserData, int& Result, bool& Opened)
+{
+#ifdef QCTOOLS_URING
+    if (!IsOpen())
+        return false;
+
+    unsigned Head=*Cq_Head;
+    if (Head==__atomic_load_n(Cq_Tail, __ATOMIC_ACQUIRE))
+        return false;
+    auto Cqe=static_cast<io_uring_cqe*>(Cqes)+(Head&*Cq_Mask);
+    UserData=Cqe->user_data;
+    Result=Cqe->res;
+    __atomic_store_n(Cq_Head, Head+1, __ATOMIC_RELEASE);
+    InFlight--;
+    Opened=Paths.erase(UserData);
+    return true;
+#else
+    (void)UserData; (void)Result; (void)Opened;
+    return false;
+#endif
+}
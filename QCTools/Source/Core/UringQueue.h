@@ -0,0 +1,90 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef UringQueue_H
+#define UringQueue_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Reads of local files given to the kernel with io_uring (Linux 5.6 and
+// later), for the readers of the parsers on NVMe storage (qcli --io uring):
+// the reads, opens and closes are queued then submitted in one system call,
+// several of them in flight, instead of one blocking call after the other.
+//
+// One thread owns a queue, it queues the requests, submits them and pops the
+// completions. Buffers can be registered once so the kernel does not map
+// them again for each read (Read with their index). Elsewhere, or if the
+// kernel does not support it, the queue is not open and the readers keep
+// their blocking reads.
+class UringQueue
+{
+public:
+    // Queue of Entries requests in flight at most
+    explicit                    UringQueue                  (unsigned Entries);
+                                ~UringQueue                 ();
+
+    // Readers of the files opened afterwards, if available
+    static void                 Enabled_Set                 (bool Value);
+    static bool                 Enabled_Get                 ();
+    // Kernel and build support, probed once
+    static bool                 IsAvailable                 ();
+
+    bool                        IsOpen                      () const {return Ring_Fd>=0;}
+    unsigned                    Entries                     () const {return Sq_Entries;}
+
+    // Before any request, false if they can not be registered (memory lock limit), the reads are then not fixed
+    bool                        Buffers_Register            (const std::vector<std::pair<void*, size_t>>& Buffers);
+    bool                        Buffers_Registered          () const {return Registered;}
+
+    // Queued, false if Entries requests are already queued or in flight, UserData is unique among the ones in flight
+    // Buffer is the index of a registered buffer Data is in, -1 if none
+    bool                        Read                        (int Fd, void* Data, size_t Size, int64_t Offset, uint64_t UserData, int Buffer=-1);
+    bool                        Open                        (const std::string& FileName, uint64_t UserData);
+    bool                        Close                       (int Fd, uint64_t UserData);
+
+    // Queued requests given to the kernel, then waits for Wait_Min completions at least
+    bool                        Submit                      (unsigned Wait_Min=0);
+    // Next completion if any, Result is the count of bytes read, the file descriptor or -errno
+    bool                        Complete                    (uint64_t& UserData, int& Result);
+    // Queued or in flight
+    unsigned                    Pending                     () const {return InFlight;}
+
+private:
+    void*                       Entry                       ();
+    bool                        Pop                         (uint64_t& UserData, int& Result, bool& Opened);
+    void                        Release                     ();
+
+    int                         Ring_Fd=-1;
+    unsigned                    Sq_Entries=0;
+    void*                       Sq_Ring=nullptr;
+    size_t                      Sq_Ring_Size=0;
+    void*                       Cq_Ring=nullptr;
+    size_t                      Cq_Ring_Size=0;
+    void*                       Sqes=nullptr;
+    size_t                      Sqes_Size=0;
+    unsigned*                   Sq_Head=nullptr;
+    unsigned*                   Sq_Tail=nullptr;
+    unsigned*                   Sq_Mask=nullptr;
+    unsigned*                   Sq_Array=nullptr;
+    unsigned*                   Cq_Head=nullptr;
+    unsigned*                   Cq_Tail=nullptr;
+    unsigned*                   Cq_Mask=nullptr;
+    void*                       Cqes=nullptr;
+    unsigned                    Queued=0;                   // Not submitted yet
+    unsigned                    InFlight=0;
+    bool                        Registered=false;
+    std::map<uint64_t, std::string> Paths;                  // Of the opens in flight, by UserData
+};
+
+#endif // UringQueue_H
@@ -271,6 +271,43 @@ struct per_group VideoPerGroup [Group_VideoMax]=
         ActiveFilter_Video_blurdetect,
         "MinMaxOfThePlot"
     },
+    //Item_black
+    {
+        Item_black,        1,    "0",  nullptr,  4,  "Black", false,
+        "Plots the duration in seconds of the black frames (blackdetect) up to\n"
+        "each frame, 0 if the frame is not black.",
+        ActiveFilter_Video_blackdetect,
+        "MinMaxOfThePlot"
+    },
+    //Item_freeze
+    {
+        Item_freeze,       1,    "0",  nullptr,  4,  "Freeze", false,
+        "Plots the duration in seconds of the frozen video (freezedetect) up to\n"
+        "each frame, 0 if the video is not frozen. A freeze is detected once it\n"
+        "lasts for 2 seconds, its duration starts from the first frozen frame.",
+        ActiveFilter_Video_freezedetect,
+        "MinMaxOfThePlot"
+    },
+    //Item_HDR_AVGL
+    {
+        Item_HDR_AVGL,     2,    "0",  nullptr,  4,  "Light Level", false,
+        "Plots the average and the max of the light of the pixels of each frame\n"
+        "in cd/m2 (nits), the max of R, G and B in display light: PQ, HLG on a\n"
+        "1000 nits display or else BT.1886 on a 100 nits display. The max of\n"
+        "the max light is the MaxCLL of the stream, the max of the average\n"
+        "light its MaxFALL.",
+        ActiveFilter_Video_HdrLight,
+        "MinMaxOfThePlot"
+    },
+    //Item_HDR_OVER
+    {
+        Item_HDR_OVER,     1,    "0",  nullptr,  4,  "Over Peak", false,
+        "Plots the percentage of the pixels of each frame brighter than the\n"
+        "max luminance of the mastering display, 1000 nits for PQ and HLG\n"
+        "without mastering display metadata and 100 nits for SDR.",
+        ActiveFilter_Video_HdrLight,
+        "MinMaxOfThePlot"
+    },
 
     //const   std::size_t Start; //Item
     //const   std::size_t Count;
@@ -374,6 +411,13 @@ const struct per_item VideoPerItem [Item_VideoMax]=
     // block and blur detections
     { Group_blockdetect, Group_VideoMax,     "blockiness",     "lavfi.block",            6,  false,   DBL_MAX, DBL_MAX, ActiveFilter_Video_blockdetect, "black",     1, "0;plum;0.6" },
     { Group_blurdetect,  Group_VideoMax,     "blurriness",     "lavfi.blur",             6,  false,   DBL_MAX, DBL_MAX, ActiveFilter_Video_blurdetect,  "black",     1, "0;powderblue;0.6" },
+    // black and freeze events, see StatsEvent
+    { Group_black,       Group_VideoMax,     "black duration", "qctools.black_duration", 3,  false,   DBL_MAX, DBL_MAX, ActiveFilter_Video_blackdetect, "black",     1, "0;dimgray;0.6" },
+    { Group_freeze,      Group_VideoMax,     "freeze duration","qctools.freeze_duration",3,  false,   DBL_MAX, DBL_MAX, ActiveFilter_Video_freezedetect,"black",     1, "0;steelblue;0.6" },
+    // HDR light levels, see HdrLightKernel
+    { Group_HdrLight,    Group_VideoMax,     "avg light",      "qctools.hdr.avg_light",  2,  false,   DBL_MAX, DBL_MAX, ActiveFilter_Video_HdrLight,    "black",     1, "0;orange;0.6" },
+    { Group_HdrLight,    Group_VideoMax,     "max light",      "qctools.hdr.max_light",  2,  true,    DBL_MAX, DBL_MAX, ActiveFilter_Video_HdrLight,    "darkorange",1, "avg light;orange;0.2" },
+    { Group_HdrOver,     Group_VideoMax,     "over peak",      "qctools.hdr.over_peak",  3,  false,   DBL_MAX, DBL_MAX, ActiveFilter_Video_HdrLight,    "black",     1, "0;crimson;0.6" },
 
     //    const   std::size_t Group1; //Group
     //    const   std::size_t Group2; //Group
@@ -384,3 +428,15 @@ const struct per_item VideoPerItem [Item_VideoMax]=
     //    const   double      DefaultLimit;
     //    const   double      DefaultLimit2;
 };
+
+//---------------------------------------------------------------------------
+// Metadata of the active filters not in VideoPerItem, others are discovered during the parsing
+const struct additional_item VideoAdditionalItems [] =
+{
+    { "lavfi.cropdetect.x",                     Additional_Int,     ActiveFilter_Video_cropdetect },
+    { "lavfi.cropdetect.y",                     Additional_Int,     ActiveFilter_Video_cropdetect },
+    { "lavfi.idet.single.current_frame",        Additional_String,  ActiveFilter_Video_Idet },
+    { "lavfi.idet.multiple.current_frame",      Additional_String,  ActiveFilter_Video_Idet },
+    { "lavfi.idet.repeated.current_frame",      Additional_String,  ActiveFilter_Video_Idet },
+    { nullptr,                                  Additional_Int,     (activefilter)-1 },
+};
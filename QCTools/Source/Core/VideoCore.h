@@ -106,6 +106,13 @@ enum VideoItem
     // block and blur
     Item_blockdetect,
     Item_blurdetect,
+    // black and freeze events
+    Item_black,
+    Item_freeze,
+    // HDR light levels, see HdrLightKernel
+    Item_HDR_AVGL,
+    Item_HDR_MAXL,
+    Item_HDR_OVER,
     //Internal
     Item_VideoMax
 };
@@ -143,10 +150,15 @@ enum VideoGroup
     Group_pkt_size,
     Group_blockdetect,
     Group_blurdetect,
+    Group_black,
+    Group_freeze,
+    Group_HdrLight,
+    Group_HdrOver,
     Group_VideoMax
 };
 
 extern struct per_group  VideoPerGroup    [Group_VideoMax];
 extern const struct per_item   VideoPerItem     [Item_VideoMax];
+extern const struct additional_item VideoAdditionalItems[];
 
 #endif // Core_H
@@ -7,6 +7,10 @@
 //---------------------------------------------------------------------------
 #include "Core/VideoStats.h"
 #include "Core/VideoCore.h"
+#include "Core/SignalStatsKernel.h"
+#include "Core/FieldCompareKernel.h"
+#include "Core/HdrLightKernel.h"
+#include "Core/StatsNumbers.h"
 //---------------------------------------------------------------------------
 
 //---------------------------------------------------------------------------
@@ -17,21 +21,44 @@ extern "C"
 }
 #include <qavplayer.h>
 
-#include "tinyxml2.h"
+#include "Core/StatsXmlReader.h"
+#include "Core/StatsXmlWriter.h"
 #include <sstream>
 #include <iomanip>
 #include <cstdlib>
 #include <cfloat>
-#include <QString>
-using namespace tinyxml2;
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
 //---------------------------------------------------------------------------
 
+//---------------------------------------------------------------------------
+// Same escaping as QString::toHtmlEscaped(), without the conversions, Value is returned as is if nothing is escaped
+static const char* HtmlEscaped(const char* Value, std::string& Buffer)
+{
+    if (!strpbrk(Value, "<>&\""))
+        return Value;
+
+    Buffer.clear();
+    for (const char* Pos=Value; *Pos; Pos++)
+        switch (*Pos)
+        {
+            case '<'    : Buffer+="&lt;"; break;
+            case '>'    : Buffer+="&gt;"; break;
+            case '&'    : Buffer+="&amp;"; break;
+            case '"'    : Buffer+="&quot;"; break;
+            default     : Buffer+=*Pos;
+        }
+    return Buffer.c_str();
+}
+
 //***************************************************************************
 // Constructor / Destructor
 //***************************************************************************
 
 //---------------------------------------------------------------------------
-VideoStats::VideoStats (size_t FrameCount, double Duration, QAVStream* stream)
+VideoStats::VideoStats (uint64_t FrameCount, double Duration, QAVStream* stream)
     :
     CommonStats(VideoPerItem, Type_Video, Group_VideoMax, Item_VideoMax, FrameCount, Duration, stream)
 {
@@ -47,9 +74,9 @@ VideoStats::~VideoStats()
 {
 }
 
-void VideoStats::parseFrame(tinyxml2::XMLElement *Frame)
+void VideoStats::parseFrame(const StatsXmlFrame& Frame)
 {
-    bool statsMapInitialized = !statsValueInfoByKeys.empty();
+    bool statsMapInitialized = !statsValueInfoByKeys.Empty();
 
     if (x_Current>=Data_Reserved)
         Data_Reserve(x_Current);
@@ -58,10 +85,10 @@ void VideoStats::parseFrame(tinyxml2::XMLElement *Frame)
 
     x[0][x_Current]=x_Current;
 
-    Attribute=Frame->Attribute("pkt_duration_time");
+    Attribute=Frame.Attribute("pkt_duration_time");
     if (Attribute)
     {
-        durations[x_Current]=std::atof(Attribute);
+        durations[x_Current]=Number_ToDouble(Attribute);
         y[Item_pkt_duration_time][x_Current] = durations[x_Current];
 
         {
@@ -76,18 +103,18 @@ void VideoStats::parseFrame(tinyxml2::XMLElement *Frame)
         }
     }
 
-    Attribute=Frame->Attribute("key_frame");
+    Attribute=Frame.Attribute("key_frame");
     if (Attribute)
-        key_frames[x_Current]=std::atof(Attribute)?true:false;
+        key_frames.Set(x_Current, Number_ToDouble(Attribute)?true:false);
 
-    Attribute = Frame->Attribute("pkt_pos");
+    Attribute = Frame.Attribute("pkt_pos");
     if(Attribute)
-        pkt_pos[x_Current] = std::atoll(Attribute);
+        pkt_pos[x_Current] = Number_ToInt64(Attribute);
 
-    Attribute = Frame->Attribute("pkt_size");
+    Attribute = Frame.Attribute("pkt_size");
     if (Attribute)
     {
-        pkt_size[x_Current] = std::atoi(Attribute);
+        pkt_size[x_Current] = Number_ToInt(Attribute);
         y[Item_pkt_size][x_Current] = pkt_size[x_Current];
 
         {
@@ -102,24 +129,24 @@ void VideoStats::parseFrame(tinyxml2::XMLElement *Frame)
         }
     }
 
-    Attribute = Frame->Attribute("pkt_pts");
+    Attribute = Frame.Attribute("pkt_pts");
     if (Attribute)
-        pkt_pts[x_Current] = std::atoi(Attribute);
+        pkt_pts[x_Current] = Number_ToInt(Attribute);
 
-    Attribute = Frame->Attribute("pix_fmt");
+    Attribute = Frame.Attribute("pix_fmt");
     if (Attribute)
-        pix_fmt[x_Current] = av_get_pix_fmt(Attribute);
+        pix_fmt.Set(x_Current, av_get_pix_fmt(Attribute));
 
-    Attribute = Frame->Attribute("pict_type");
+    Attribute = Frame.Attribute("pict_type");
     if (Attribute)
-        pict_type_char[x_Current] = *Attribute;
+        pict_type_char.Set(x_Current, *Attribute);
 
-    Attribute=Frame->Attribute("pkt_pts_time");
+    Attribute=Frame.Attribute("pkt_pts_time");
     if (!Attribute || !strcmp(Attribute, "N/A"))
-        Attribute=Frame->Attribute("pkt_dts_time");
+        Attribute=Frame.Attribute("pkt_dts_time");
     if (Attribute && strcmp(Attribute, "N/A"))
     {
-        x[1][x_Current]=std::atof(Attribute);
+        x[1][x_Current]=Number_ToDouble(Attribute);
         if (FirstTimeStamp==DBL_MAX)
             FirstTimeStamp=x[1][x_Current];
         if (x[1][x_Current]<FirstTimeStamp)
@@ -138,99 +165,90 @@ void VideoStats::parseFrame(tinyxml2::XMLElement *Frame)
     }
 
     int Width;
-    Attribute=Frame->Attribute("width");
+    Attribute=Frame.Attribute("width");
     if (Attribute)
-        Width=std::atoi(Attribute);
+        Width=Number_ToInt(Attribute);
     else
         Width=0;
 
     setWidth(Width);
 
     int Height;
-    Attribute=Frame->Attribute("height");
+    Attribute=Frame.Attribute("height");
     if (Attribute)
-        Height=std::atoi(Attribute);
+        Height=Number_ToInt(Attribute);
     else
         Height=0;
 
     setHeight(Height);
 
-    auto Tag=Frame->FirstChildElement();
-    while (Tag)
+    for (const auto& Tag : Frame.tags)
     {
-        if (!strcmp(Tag->Value(), "tag"))
+        size_t j=Item_VideoMax;
+        const char* key=Tag.first;
+        if (key)
         {
-            size_t j=Item_VideoMax;
-            const char* key=Tag->Attribute("key");
-            if (key)
+            if(strcmp(key, "qctools.comment") == 0)
             {
-                if(strcmp(key, "qctools.comment") == 0)
+                const char* value = Tag.second;
+                if(value)
                 {
-                    const char* value = Tag->Attribute("value");
-                    if(value)
-                    {
-                        comments[x_Current] = strdup(QString::fromUtf8(value).toHtmlEscaped().toUtf8().data());
-                    }
-                }
-                else
-                {
-                    for (size_t Plot_Pos=0; Plot_Pos<Item_VideoMax; Plot_Pos++)
-                        if (!strcmp(key, PerItem[Plot_Pos].FFmpeg_Name))
-                        {
-                            j=Plot_Pos;
-                            break;
-                        }
+                    std::string escaped;
+                    comments.Set(x_Current, Strings.Add(HtmlEscaped(value, escaped)));
                 }
             }
+            else
+                j=ItemsIndex.Find(key, Item_VideoMax);
+        }
 
-            if (j!=Item_VideoMax)
-            {
-                double value;
-                Attribute=Tag->Attribute("value");
-                if (Attribute)
-                    value=std::atof(Attribute);
-                else
-                    value=0;
-
-                // Special cases: crop: x2, y2
-                if (Width && !strcmp(key, "lavfi.cropdetect.x2"))
-                    y[j][x_Current]=Width-value;
-                else if (Height && !strcmp(key, "lavfi.cropdetect.y2"))
-                    y[j][x_Current]=Height-value;
-                else if (Width && !strcmp(key, "lavfi.cropdetect.w"))
-                    y[j][x_Current]=Width-value;
-                else if (Height && !strcmp(key, "lavfi.cropdetect.h"))
-                    y[j][x_Current]=Height-value;
-                else
-                    y[j][x_Current]=value;
-
-                if (!std::isinf(value)) {
-                    if (PerItem[j].Group1 != Group_VideoMax && y_Max[PerItem[j].Group1] < y[j][x_Current])
-                        y_Max[PerItem[j].Group1] = y[j][x_Current];
-                    if (PerItem[j].Group2 != Group_VideoMax && y_Max[PerItem[j].Group2] < y[j][x_Current])
-                        y_Max[PerItem[j].Group2] = y[j][x_Current];
-                    if (PerItem[j].Group1 != Group_VideoMax && y_Min[PerItem[j].Group1] > y[j][x_Current])
-                        y_Min[PerItem[j].Group1] = y[j][x_Current];
-                    if (PerItem[j].Group2 != Group_VideoMax && y_Min[PerItem[j].Group2] > y[j][x_Current])
-                        y_Min[PerItem[j].Group2] = y[j][x_Current];
-                }
+        if (j!=Item_VideoMax)
+        {
+            if (PerItem[j].Filter!=activefilter(-1))
+                ReportFilters.set(PerItem[j].Filter);
 
-                //VideoStats
-                Stats_Totals[j]+=y[j][x_Current];
-                if (PerItem[j].DefaultLimit!=DBL_MAX)
-                {
-                    if (y[j][x_Current]>PerItem[j].DefaultLimit)
-                        Stats_Counts[j]++;
-                    if (PerItem[j].DefaultLimit2!=DBL_MAX && y[j][x_Current]>PerItem[j].DefaultLimit2)
-                        Stats_Counts2[j]++;
-                }
-            } else {
-                auto value = Tag->Attribute("value");
-                processAdditionalStats(key, value ? value : "", statsMapInitialized);
+            double value;
+            Attribute=Tag.second;
+            if (Attribute)
+                value=Number_ToDouble(Attribute);
+            else
+                value=0;
+
+            // Special cases: crop: x2, y2
+            if (Width && j==Item_Crop_x2)
+                y[j][x_Current]=Width-value;
+            else if (Height && j==Item_Crop_y2)
+                y[j][x_Current]=Height-value;
+            else if (Width && j==Item_Crop_w)
+                y[j][x_Current]=Width-value;
+            else if (Height && j==Item_Crop_h)
+                y[j][x_Current]=Height-value;
+            else
+                y[j][x_Current]=value;
+
+            if (!std::isinf(value)) {
+                if (PerItem[j].Group1 != Group_VideoMax && y_Max[PerItem[j].Group1] < y[j][x_Current])
+                    y_Max[PerItem[j].Group1] = y[j][x_Current];
+                if (PerItem[j].Group2 != Group_VideoMax && y_Max[PerItem[j].Group2] < y[j][x_Current])
+                    y_Max[PerItem[j].Group2] = y[j][x_Current];
+                if (PerItem[j].Group1 != Group_VideoMax && y_Min[PerItem[j].Group1] > y[j][x_Current])
+                    y_Min[PerItem[j].Group1] = y[j][x_Current];
+                if (PerItem[j].Group2 != Group_VideoMax && y_Min[PerItem[j].Group2] > y[j][x_Current])
+                    y_Min[PerItem[j].Group2] = y[j][x_Current];
             }
-        }
 
-        Tag=Tag->NextSiblingElement();
+            //VideoStats
+            Stats_Totals[j]+=y[j][x_Current];
+            if (PerItem[j].DefaultLimit!=DBL_MAX)
+            {
+                if (y[j][x_Current]>PerItem[j].DefaultLimit)
+                    Stats_Counts[j]++;
+                if (PerItem[j].DefaultLimit2!=DBL_MAX && y[j][x_Current]>PerItem[j].DefaultLimit2)
+                    Stats_Counts2[j]++;
+            }
+        } else if (key) {
+            auto value = Tag.second;
+            processAdditionalStats(key, value ? value : "", statsMapInitialized);
+        }
     }
 
     if(!statsMapInitialized) {
@@ -247,6 +265,7 @@ void VideoStats::parseFrame(tinyxml2::XMLElement *Frame)
     }
 
     x_Current++;
+    x_Current_Publish();
     if (x_Current_Max<=x_Current)
         x_Current_Max=x_Current;
 }
@@ -257,61 +276,172 @@ void VideoStats::parseFrame(tinyxml2::XMLElement *Frame)
 
 //---------------------------------------------------------------------------
 
+void VideoStats::StatsFromItem (size_t j, double value)
+{
+    if (!Item_IsUsed(j))
+        return;
+
+    y[j][x_Current]=value;
+
+    if (!std::isinf(value)) {
+        if (PerItem[j].Group1 != Group_VideoMax && y_Max[PerItem[j].Group1] < y[j][x_Current])
+            y_Max[PerItem[j].Group1] = y[j][x_Current];
+        if (PerItem[j].Group2 != Group_VideoMax && y_Max[PerItem[j].Group2] < y[j][x_Current])
+            y_Max[PerItem[j].Group2] = y[j][x_Current];
+        if (PerItem[j].Group1 != Group_VideoMax && y_Min[PerItem[j].Group1] > y[j][x_Current])
+            y_Min[PerItem[j].Group1] = y[j][x_Current];
+        if (PerItem[j].Group2 != Group_VideoMax && y_Min[PerItem[j].Group2] > y[j][x_Current])
+            y_Min[PerItem[j].Group2] = y[j][x_Current];
+    }
+
+    //Stats
+    Stats_Totals[j]+=y[j][x_Current];
+    if (PerItem[j].DefaultLimit!=DBL_MAX)
+    {
+        if (y[j][x_Current]>PerItem[j].DefaultLimit)
+            Stats_Counts[j]++;
+        if (PerItem[j].DefaultLimit2!=DBL_MAX && y[j][x_Current]>PerItem[j].DefaultLimit2)
+            Stats_Counts2[j]++;
+    }
+}
+
+//---------------------------------------------------------------------------
+void VideoStats::KernelValues (const SignalStatsKernel& Kernel, kernel_values& Values)
+{
+    // Item of each value of the kernel
+    static const std::vector<size_t> Items=[]() {
+        std::vector<size_t> Result(SignalStatsKernel::Value_Max, Item_VideoMax);
+        for (size_t Value=0; Value<Result.size(); Value++)
+            for (size_t j=0; j<Item_VideoMax; j++)
+                if (!strcmp(VideoPerItem[j].FFmpeg_Name, SignalStatsKernel::Name((SignalStatsKernel::value)Value)))
+                    Result[Value]=j;
+        return Result;
+    }();
+
+    for (size_t Value=0; Value<Items.size(); Value++)
+    {
+        if (Items[Value]>=Item_VideoMax)
+            continue;
+
+        // Rounded as in the metadata of the filter, so the stats are the same with the filter or the kernel
+        char Text[32];
+        snprintf(Text, sizeof(Text), "%g", Kernel.Get((SignalStatsKernel::value)Value));
+        Values.emplace_back(Items[Value], std::atof(Text));
+    }
+}
+
+//---------------------------------------------------------------------------
+void VideoStats::StatsFromKernel (const SignalStatsKernel& Kernel)
+{
+    kernel_values Values;
+    KernelValues(Kernel, Values);
+    StatsFromKernel(Values);
+}
+
+//---------------------------------------------------------------------------
+void VideoStats::KernelValues (const FieldCompareKernel& Kernel, kernel_values& Values)
+{
+    static const std::vector<size_t> Items=[]() {
+        std::vector<size_t> Result(FieldCompareKernel::Value_Max, Item_VideoMax);
+        for (size_t Value=0; Value<Result.size(); Value++)
+            for (size_t j=0; j<Item_VideoMax; j++)
+                if (!strcmp(VideoPerItem[j].FFmpeg_Name, FieldCompareKernel::Name((FieldCompareKernel::value)Value)))
+                    Result[Value]=j;
+        return Result;
+    }();
+
+    for (size_t Value=0; Value<Items.size(); Value++)
+    {
+        if (Items[Value]>=Item_VideoMax || !Kernel.Has((FieldCompareKernel::value)Value))
+            continue;
+
+        // Rounded as set_meta() of psnr and ssim, a float with 6 decimals
+        char Text[32];
+        snprintf(Text, sizeof(Text), "%f", (float)Kernel.Get((FieldCompareKernel::value)Value));
+        Values.emplace_back(Items[Value], std::atof(Text));
+    }
+}
+
+//---------------------------------------------------------------------------
+void VideoStats::StatsFromKernel (const FieldCompareKernel& Kernel)
+{
+    kernel_values Values;
+    KernelValues(Kernel, Values);
+    StatsFromKernel(Values);
+}
+
+//---------------------------------------------------------------------------
+void VideoStats::KernelValues (const HdrLightKernel& Kernel, kernel_values& Values)
+{
+    static const std::vector<size_t> Items=[]() {
+        std::vector<size_t> Result(HdrLightKernel::Value_Max, Item_VideoMax);
+        for (size_t Value=0; Value<Result.size(); Value++)
+            for (size_t j=0; j<Item_VideoMax; j++)
+                if (!strcmp(VideoPerItem[j].FFmpeg_Name, HdrLightKernel::Name((HdrLightKernel::value)Value)))
+                    Result[Value]=j;
+        return Result;
+    }();
+
+    for (size_t Value=0; Value<Items.size(); Value++)
+    {
+        if (Items[Value]>=Item_VideoMax)
+            continue;
+
+        // Rounded as the values read back from the XML report
+        char Text[32];
+        snprintf(Text, sizeof(Text), "%f", Kernel.Get((HdrLightKernel::value)Value));
+        Values.emplace_back(Items[Value], std::atof(Text));
+    }
+}
+
+//---------------------------------------------------------------------------
+void VideoStats::StatsFromKernel (const HdrLightKernel& Kernel)
+{
+    kernel_values Values;
+    KernelValues(Kernel, Values);
+    StatsFromKernel(Values);
+}
+
+//---------------------------------------------------------------------------
+void VideoStats::StatsFromKernel (const kernel_values& Values)
+{
+    for (const auto& Value : Values)
+        StatsFromItem(Value.first, Value.second);
+}
+
+//---------------------------------------------------------------------------
 void VideoStats::StatsFromFrame (const QAVFrame& frame, int Width, int Height)
 {
     auto Frame = frame.frame();
     AVDictionary * m= Frame->metadata;
     AVDictionaryEntry* e=NULL;
-    bool statsMapInitialized = !statsValueInfoByKeys.empty();
+    bool statsMapInitialized = !statsValueInfoByKeys.Empty();
 
     for (;;)
     {
         e=av_dict_get     (m, "", e, AV_DICT_IGNORE_SUFFIX);
         if (!e)
             break;
-        size_t j=0;
-        for (; j<Item_VideoMax; j++)
-        {
-            if (strcmp(e->key, PerItem[j].FFmpeg_Name)==0)
-                break;
-        }
+        if (Black.IsKey(e->key) || Freeze.IsKey(e->key) || !strncmp(e->key, "lavfi.freezedetect.", 19))
+            continue; // See below
+
+        size_t j=ItemsIndex.Find(e->key, Item_VideoMax);
 
         if (j<Item_VideoMax)
         {
-            double value=std::atof(e->value);
+            double value=Number_ToDouble(e->value);
 
             // Special cases: crop: x2, y2
-            if (std::string(e->key)=="lavfi.cropdetect.x2")
-                y[j][x_Current]=Width-value;
-            else if (std::string(e->key)=="lavfi.cropdetect.y2")
-                y[j][x_Current]=Height-value;
-            else if (std::string(e->key)=="lavfi.cropdetect.w")
-                y[j][x_Current]=Width-value;
-            else if (std::string(e->key)=="lavfi.cropdetect.h")
-                y[j][x_Current]=Height-value;
+            if (j==Item_Crop_x2)
+                StatsFromItem(j, Width-value);
+            else if (j==Item_Crop_y2)
+                StatsFromItem(j, Height-value);
+            else if (j==Item_Crop_w)
+                StatsFromItem(j, Width-value);
+            else if (j==Item_Crop_h)
+                StatsFromItem(j, Height-value);
             else
-                y[j][x_Current]=value;
-
-            if (!std::isinf(value)) {
-                if (PerItem[j].Group1 != Group_VideoMax && y_Max[PerItem[j].Group1] < y[j][x_Current])
-                    y_Max[PerItem[j].Group1] = y[j][x_Current];
-                if (PerItem[j].Group2 != Group_VideoMax && y_Max[PerItem[j].Group2] < y[j][x_Current])
-                    y_Max[PerItem[j].Group2] = y[j][x_Current];
-                if (PerItem[j].Group1 != Group_VideoMax && y_Min[PerItem[j].Group1] > y[j][x_Current])
-                    y_Min[PerItem[j].Group1] = y[j][x_Current];
-                if (PerItem[j].Group2 != Group_VideoMax && y_Min[PerItem[j].Group2] > y[j][x_Current])
-                    y_Min[PerItem[j].Group2] = y[j][x_Current];
-            }
-
-            //Stats
-            Stats_Totals[j]+=y[j][x_Current];
-            if (PerItem[j].DefaultLimit!=DBL_MAX)
-            {
-                if (y[j][x_Current]>PerItem[j].DefaultLimit)
-                    Stats_Counts[j]++;
-                if (PerItem[j].DefaultLimit2!=DBL_MAX && y[j][x_Current]>PerItem[j].DefaultLimit2)
-                    Stats_Counts2[j]++;
-            }
+                StatsFromItem(j, value);
         } else {
 
             // not found among plot groups
@@ -326,6 +456,11 @@ void VideoStats::StatsFromFrame (const QAVFrame& frame, int Width, int Height)
         initializeAdditionalStats();
     }
 
+    // Events, as a value per frame
+    double Time=x[1][x_Current]+FirstTimeStamp;
+    StatsFromItem(Item_black, Black.FromFrame(m, Time, durations[x_Current]));
+    StatsFromItem(Item_freeze, Freeze.FromFrame(m, Time, durations[x_Current]));
+
     y[Item_pkt_duration_time][x_Current] = durations[x_Current];
 
     {
@@ -339,7 +474,7 @@ void VideoStats::StatsFromFrame (const QAVFrame& frame, int Width, int Height)
             group1Min = current;
     }
 
-    key_frames[x_Current]=Frame->key_frame?true:false;
+    key_frames.Set(x_Current, Frame->key_frame?true:false);
 
     pkt_pos[x_Current] = Frame->pkt_pos;
     pkt_size[x_Current] = Frame->pkt_size;
@@ -357,8 +492,8 @@ void VideoStats::StatsFromFrame (const QAVFrame& frame, int Width, int Height)
         if(group1Min > current)
             group1Min = current;
     }
-    pix_fmt[x_Current] = Frame->format;
-    pict_type_char[x_Current] = av_get_picture_type_char(Frame->pict_type);
+    pix_fmt.Set(x_Current, Frame->format);
+    pict_type_char.Set(x_Current, av_get_picture_type_char(Frame->pict_type));
 
     if (x_Max[0]<=x[0][x_Current])
     {
@@ -367,7 +502,10 @@ void VideoStats::StatsFromFrame (const QAVFrame& frame, int Width, int Height)
         x_Max[2]=x[2][x_Current];
         x_Max[3]=x[3][x_Current];
     }
+    Detectors_Run();
+    Shots_Extend(x_Current+1);
     x_Current++;
+    x_Current_Publish();
     if (x_Current_Max<=x_Current)
         x_Current_Max=x_Current;
 }
@@ -415,6 +553,27 @@ void VideoStats::TimeStampFromFrame (const QAVFrame& frame, size_t FramePos)
         durations[FramePos]=((double)Frame->pkt_duration)/Frequency;
 }
 
+//---------------------------------------------------------------------------
+void VideoStats::StatsFromPacket_Items(const packet& Packet)
+{
+    // Same as StatsFromFrame()
+    for (size_t j : {(size_t)Item_pkt_duration_time, (size_t)Item_pkt_size})
+    {
+        double current = j==Item_pkt_size ? pkt_size[x_Current] : durations[x_Current];
+        y[j][x_Current] = current;
+
+        double& group1Max = y_Max[PerItem[j].Group1];
+        double& group1Min = y_Min[PerItem[j].Group1];
+
+        if(group1Max < current)
+            group1Max = current;
+        if(group1Min > current)
+            group1Min = current;
+    }
+    pix_fmt.Set(x_Current, Packet.Format);
+    pict_type_char.Set(x_Current, Packet.PictType);
+}
+
 //---------------------------------------------------------------------------
 int VideoStats::getWidth() const
 {
@@ -437,72 +596,87 @@ void VideoStats::setHeight(int height)
 }
 
 //---------------------------------------------------------------------------
-std::string VideoStats::StatsToXML (const activefilters& filters)
+double VideoStats::Summary_Mirror(size_t Pos) const
 {
-    std::stringstream Data;
-
-    // Per frame (note: the XML header and footer are not created here)
-    std::stringstream widthStream; widthStream<<width; // Note: we use the same value for all frame, we should later use the right value per frame
-    std::stringstream heightStream; heightStream<<height; // Note: we use the same value for all frame, we should later use the right value per frame
-    for (size_t x_Pos=0; x_Pos<x_Current; ++x_Pos)
+    // Same as StatsToXML()
+    switch (Pos)
     {
-        std::stringstream pkt_pts_time; pkt_pts_time<<std::fixed<<std::setprecision(7)<<(x[1][x_Pos]+FirstTimeStamp);
-        std::stringstream pkt_duration_time; pkt_duration_time<<std::fixed<<std::setprecision(7)<<durations[x_Pos];
-        std::stringstream key_frame; key_frame<<key_frames[x_Pos]?'1':'0';
-        Data<<"        <frame media_type=\"video\"";
-        Data << " stream_index=\"" << streamIndex << "\"";
-
-        Data<<" key_frame=\"" << key_frame.str() << "\"";
-        Data << " pkt_pts=\"" << pkt_pts[x_Pos] << "\"";
-        Data<<" pkt_pts_time=\"" << pkt_pts_time.str() << "\"";
-        if (pkt_duration_time)
-            Data<<" pkt_duration_time=\"" << pkt_duration_time.str() << "\"";
-        Data << " pkt_pos=\"" << pkt_pos[x_Pos] << "\"";
-        Data << " pkt_size=\"" << pkt_size[x_Pos] << "\"";
-        Data<<" width=\"" << widthStream.str() << "\" height=\"" << heightStream.str() <<"\"";
-        Data << " pix_fmt=\"" << av_get_pix_fmt_name((AVPixelFormat) pix_fmt[x_Pos]) << "\"";
-        Data << " pict_type=\"" << pict_type_char[x_Pos] << "\"";
-
-        Data << ">\n";
-
-        for (size_t Plot_Pos=0; Plot_Pos<Item_VideoMax; Plot_Pos++)
-        {
-            const activefilter filter = PerItem[Plot_Pos].Filter;
-            if(filter == activefilter(-1))
-                continue;
+        case Item_Crop_x2 :
+        case Item_Crop_w :
+            return width;
+        case Item_Crop_y2 :
+        case Item_Crop_h :
+            return height;
+        default:
+            return 0;
+    }
+}
 
-            if(!filters.test(filter))
-                continue;
+//---------------------------------------------------------------------------
+double VideoStats::Item_FromReport(size_t j, double Value) const
+{
+    // Same as parseFrame()
+    if (width && (j==Item_Crop_x2 || j==Item_Crop_w))
+        return width-Value;
+    if (height && (j==Item_Crop_y2 || j==Item_Crop_h))
+        return height-Value;
+    return Value;
+}
 
-            const std::string& key = PerItem[Plot_Pos].FFmpeg_Name;
-            std::string value;
+//---------------------------------------------------------------------------
+double VideoStats::Shot_Difference(size_t Pos) const
+{
+    // YDIF of signalstats, in percent of the range of the samples; not with the frames of sparse stats, not consecutive
+    if (Sampling || !Item_IsUsed(Item_YDIF) || !y[Item_YDIF].IsAllocated() || (Item_YDIF<Items_Sources.size() && Items_Sources[Item_YDIF].Data))
+        return NAN;
+    auto Desc=av_pix_fmt_desc_get((AVPixelFormat)pix_fmt[Pos]);
+    int Depth=Desc && Desc->comp[0].depth?Desc->comp[0].depth:8;
+    return (double)y[Item_YDIF][Pos]*100/((1<<Depth)-1);
+}
 
-            switch (Plot_Pos)
-            {
-            case Item_Crop_x2 :
-            case Item_Crop_w :
-                // Special case, values are from width
-                value = std::to_string(width-y[Plot_Pos][x_Pos]);
-                break;
-            case Item_Crop_y2 :
-            case Item_Crop_h :
-                // Special case, values are from height
-                value = std::to_string(height-y[Plot_Pos][x_Pos]);
-                break;
-            default:
-                value = std::to_string(y[Plot_Pos][x_Pos]);
-            }
+//---------------------------------------------------------------------------
+void VideoStats::StatsToXML (StatsXmlWriter& Writer, const activefilters& filters, size_t x_Begin, size_t x_End)
+{
+    Items_Load();
+
+    // Comments of the range looked up once, then by frame in order
+    auto Comments=comments.Range(x_Begin, x_End);
+    auto Comment=Comments.begin();
+
+    // Columns written, once
+    auto Columns=XmlColumns(filters);
+    auto AdditionalColumns=XmlAdditionalColumns();
 
-            Data<<"            <tag key=\""+key+"\" value=\""+value+"\"/>\n";
+    // Per frame (note: the XML header and footer are not created here)
+    for (size_t x_Pos=x_Begin; x_Pos<x_End; ++x_Pos)
+    {
+        const char* pix_fmt_name=av_get_pix_fmt_name((AVPixelFormat) pix_fmt[x_Pos]);
+
+        Writer.FrameBegin("video", streamIndex);
+        Writer.Attribute("key_frame", key_frames[x_Pos]?"1":"0");
+        Writer.Attribute("pkt_pts", pkt_pts[x_Pos]);
+        Writer.AttributeFixed("pkt_pts_time", x[1][x_Pos]+FirstTimeStamp, 7);
+        Writer.AttributeFixed("pkt_duration_time", durations[x_Pos], 7);
+        Writer.Attribute("pkt_pos", pkt_pos[x_Pos]);
+        Writer.Attribute("pkt_size", (int64_t)pkt_size[x_Pos]);
+        Writer.Attribute("width", (int64_t)width); // Note: we use the same value for all frame, we should later use the right value per frame
+        Writer.Attribute("height", (int64_t)height); // Note: we use the same value for all frame, we should later use the right value per frame
+        Writer.Attribute("pix_fmt", pix_fmt_name?pix_fmt_name:"");
+        Writer.Attribute("pict_type", pict_type_char[x_Pos]);
+        Writer.FrameAttributesEnd();
+
+        for (const auto& Column : Columns)
+        {
+            // Special cases, crop values are from width or height
+            double Value=y[Column.Index][x_Pos];
+            Writer.Tag(Column.Prefix, Column.Mirror?Column.Mirror-Value:Value);
         }
 
-        writeAdditionalStats(Data, x_Pos);
+        writeAdditionalStats(Writer, AdditionalColumns, x_Pos);
 
-        if(comments[x_Pos])
-            Data<<"            <tag key=\"qctools.comment\" value=\"" << comments[x_Pos] << "\"/>\n";
+        if(Comment!=Comments.end() && Comment->first==x_Pos)
+            Writer.Tag("qctools.comment", (Comment++)->second);
 
-        Data<<"        </frame>\n";
+        Writer.FrameEnd();
     }
-
-    return Data.str();
 }
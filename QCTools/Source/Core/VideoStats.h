@@ -19,23 +19,35 @@ struct AVFrame;
 class QAVStream;
 struct AVFormatContext;
 
-namespace tinyxml2 {
-    class XMLElement;
-}
+struct StatsXmlFrame;
+class SignalStatsKernel;
+class FieldCompareKernel;
+class HdrLightKernel;
 
 class VideoStats : public CommonStats
 {
 public:
     // Constructor / Destructor
-    VideoStats(size_t FrameCount=0, double Duration=0, QAVStream* stream = NULL);
+    VideoStats(uint64_t FrameCount=0, double Duration=0, QAVStream* stream = NULL);
     VideoStats(int streamIndex);
     ~VideoStats();
 
     // External data
-    virtual void parseFrame(tinyxml2::XMLElement* frame);
+    virtual void parseFrame(const StatsXmlFrame& frame);
     void                        StatsFromFrame(const QAVFrame& Frame, int Width, int Height);
+    // Values of the kernel for the current frame, before StatsFromFrame() of the same frame (which has no signalstats metadata)
+    void                        StatsFromKernel(const SignalStatsKernel& Kernel);
+    // Same for the psnr and ssim of the fields
+    void                        StatsFromKernel(const FieldCompareKernel& Kernel);
+    // Same for the light levels
+    void                        StatsFromKernel(const HdrLightKernel& Kernel);
+    void                        StatsFromKernel(const kernel_values& Values);
+    // Values of a kernel appended to Values, for a StatsFromKernel() by another thread (see StatsIngest)
+    static void                 KernelValues(const SignalStatsKernel& Kernel, kernel_values& Values);
+    static void                 KernelValues(const FieldCompareKernel& Kernel, kernel_values& Values);
+    static void                 KernelValues(const HdrLightKernel& Kernel, kernel_values& Values);
     void                        TimeStampFromFrame(const QAVFrame& Frame, size_t FramePos);
-    std::string                      StatsToXML(const activefilters& filters);
+    void                             StatsToXML(StatsXmlWriter& Writer, const activefilters& filters, size_t x_Begin, size_t x_End);
 
     int getWidth() const;
     void setWidth(int getWidth);
@@ -43,7 +55,17 @@ public:
     int getHeight() const;
     void setHeight(int getHeight);
 
+protected:
+    double                      Summary_Mirror(size_t Pos) const;
+    double                      Item_FromReport(size_t j, double Value) const;
+    double                      Shot_Difference(size_t Pos) const;
+    void                        StatsFromPacket_Items(const packet& Packet);
+
 private:
+    void                        StatsFromItem(size_t j, double value);
+
+    StatsEvent                  Black{"lavfi.black_start", "lavfi.black_end"};
+    StatsEvent                  Freeze{"lavfi.freezedetect.freeze_start", "lavfi.freezedetect.freeze_end"};
 
     int width;
     int height;
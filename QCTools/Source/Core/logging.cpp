@@ -1,4 +1,5 @@
 #include "logging.h"
+#include "Core/Tracing.h"
 
 #include <QDebug>
 #include <QDir>
@@ -59,7 +60,7 @@ Logging::~Logging()
         qInstallMessageHandler(prevMessageHandler);
 }
 
-void Logging::enable()
+void Logging::enable(bool consoleToStderr)
 {
     std::vector<spdlog::sink_ptr> sinks;
 
@@ -67,9 +68,17 @@ void Logging::enable()
     // use console sink on WARN level for desktop platforms
     {
         #ifdef Q_OS_WIN
-            auto console_sink = std::make_shared<spdlog::sinks::wincolor_stdout_sink_mt>();
+            spdlog::sink_ptr console_sink;
+            if(consoleToStderr)
+                console_sink = std::make_shared<spdlog::sinks::wincolor_stderr_sink_mt>();
+            else
+                console_sink = std::make_shared<spdlog::sinks::wincolor_stdout_sink_mt>();
         #else //
-            auto console_sink = std::make_shared<spdlog::sinks::ansicolor_stdout_sink_mt>();
+            spdlog::sink_ptr console_sink;
+            if(consoleToStderr)
+                console_sink = std::make_shared<spdlog::sinks::ansicolor_stderr_sink_mt>();
+            else
+                console_sink = std::make_shared<spdlog::sinks::ansicolor_stdout_sink_mt>();
         #endif //
 
         console_sink->set_level(spdlog::level::warn);
@@ -108,6 +117,9 @@ void Logging::enable()
 
     }
 
+    // Traces of the hot paths are written by their own async logger
+    Tracing::setSinks(sinks);
+
     auto logger = std::make_shared<spdlog::logger>("", sinks.begin(), sinks.end());
     logger->set_level(spdlog::level::debug);
 
@@ -12,7 +12,8 @@ public:
     Logging();
     ~Logging();
 
-    void enable();
+    // Warnings are shown on stdout, or on stderr when stdout is used for data
+    void enable(bool consoleToStderr = false);
 
 private:
     QtMessageHandler prevMessageHandler;
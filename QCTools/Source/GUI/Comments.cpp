@@ -14,6 +14,8 @@
 #include <qwt_plot_grid.h>
 #include <QTextDocument>
 
+#include <algorithm>
+
 constexpr int plotHeight = 30;
 
 static inline void qwtDrawRhombSymbols( QPainter *painter,
@@ -143,15 +145,17 @@ protected:
         const QRectF clipRect = qwtIntersectedClipRect( canvasRect, painter );
         mapper.setBoundingRect( clipRect );
 
-        for ( int i = from; i <= to; ++i )
+        // Frames in view only, then the few of them with a comment
+        if ( from < 0 || to < from )
+            return;
+        from = std::max( from, indexLower( xMap.s1(), *data() ) );
+        to = std::min( to, indexLower( xMap.s2(), *data() ) + 1 );
+        for ( const auto& comment : static_cast<const CommentsSeriesData*>( data() )->comments( from, to + 1 ) )
         {
-            if(!qFuzzyIsNull(data()->sample(i).ry()))
-            {
-                const QPolygonF points = mapper.toPointsF(xMap, yMap,
-                        data(), i, i);
+            const QPolygonF points = mapper.toPointsF(xMap, yMap,
+                    data(), comment.first, comment.first);
 
-                symbol.drawSymbols( painter, points );
-            }
+            symbol.drawSymbols( painter, points );
         }
     }
 private:
@@ -190,7 +194,7 @@ CommentsPlot::CommentsPlot(FileInformation* fileInfo, CommonStats* stats, const
 
     QwtPlotCurve *curve = new CommentsPlotCurve();
     curve->setTitle("Comments");
-    curve->setStyle(QwtPlotCurve::Dots);
+    curve->setStyle(QwtPlotCurve::NoCurve);
     curve->setPen( Qt::red, 0);
     curve->setRenderHint( QwtPlotItem::RenderAntialiased, true );
 
@@ -253,7 +257,7 @@ CommentsPlot::~CommentsPlot()
     delete m_legend;
 }
 
-int CommentsPlot::frameAt(double x) const
+qint64 CommentsPlot::frameAt(double x) const
 {
     const QwtPlotCurve* curve = this->curve(0);
     if ( curve == NULL )
@@ -290,7 +294,7 @@ const QwtPlotCurve *CommentsPlot::curve(int index) const
 
 void CommentsPlot::onPickerMoved(const QPointF & pos)
 {
-    const int idx = frameAt( pos.x() );
+    const qint64 idx = frameAt( pos.x() );
     if ( idx >= 0 )
         Q_EMIT cursorMoved( idx );
 }
@@ -361,8 +365,8 @@ QwtText CommentsPlotPicker::trackerTextF(const QPointF &pos) const
 
 QString CommentsPlotPicker::infoText(int index) const
 {
-    if(stats->comments && stats->comments[index])
-        return QString::fromUtf8(stats->comments[index]);
+    if(auto comment = stats->comments[index])
+        return QString::fromUtf8(comment);
 
     return "";
 }
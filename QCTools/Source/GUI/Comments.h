@@ -37,11 +37,15 @@ public:
     }
 
     size_t size() const {
-        return stats ? stats->x_Current : 0;
+        return stats ? stats->x_Current_Get() : 0;
     }
+    // Positions of the frames, the markers are drawn at the frames with a comment only (see CommentsPlotCurve)
     QPointF sample(size_t i) const {
         int dataTypeIndex = pDataTypeIndex ? *pDataTypeIndex : 0;
-        return (stats->comments[i] != nullptr) ? QPointF(stats->x[dataTypeIndex][i], 1) : QPointF(stats->x[dataTypeIndex][i], 0);
+        return QPointF(stats->x[dataTypeIndex][i], 1);
+    }
+    std::vector<StatsComments::item> comments(size_t from, size_t to) const {
+        return stats ? stats->comments.Range(from, to) : std::vector<StatsComments::item>();
     }
 
 private:
@@ -70,7 +74,7 @@ public:
     CommentsPlot(FileInformation* fileInfo, CommonStats* stats, const int* dataTypeIndex = nullptr);
     virtual ~CommentsPlot();
 
-    int frameAt( double x ) const;
+    qint64 frameAt( double x ) const;
     void setCursorPos( double x );
     void restorePlotHeight();
 
@@ -79,7 +83,7 @@ public:
     void setLegend(QWidget* item) { m_legend = item; }
 
 Q_SIGNALS:
-    void cursorMoved(int index);
+    void cursorMoved(qint64 index);
 
 private Q_SLOTS:
     void onPickerMoved(const QPointF& );
@@ -14,13 +14,16 @@
 #include "Core/CommonStats.h"
 #include "Core/VideoCore.h"
 #include "Core/AudioCore.h"
+#include <QAbstractTableModel>
 #include <QFileInfo>
+#include <QHash>
 #include <QHeaderView>
 #include <QMenu>
 #include <QDir>
 #include <QContextMenuEvent>
-#include <sstream>
+#include <algorithm>
 #include <cassert>
+#include <vector>
 #include <QDesktopServices>
 //---------------------------------------------------------------------------
 
@@ -125,115 +128,314 @@ percolumn PerColumn[Col_Max]=
     { StatsType_None,       Item_AudioMax,          Item_AudioMax,          "Audio Bit depth",  NULL, },
 };
 
-// purely for sorting purpose
-class TableWidgetItem : public QTableWidgetItem {
-public:
-	TableWidgetItem(QString value) : QTableWidgetItem(value) {
-	}
-	TableWidgetItem() : QTableWidgetItem() {
-	}
-
-	virtual bool operator<(const QTableWidgetItem & other) const {
-
-		// check if both are integers
-		{
-			bool ok = false;
-			auto intValue = text().toInt(&ok);
-			if (ok)
-			{
-				auto otherIntValue = other.text().toInt(&ok);
-				if (ok) {
-					return intValue < otherIntValue;
-				}
-			}
-		}
-
-		// check if both are doubles
-		{
-			bool ok = false;
-			auto doubleValue = text().toDouble(&ok);
-			if (ok)
-			{
-				auto otherDoubleValue = other.text().toDouble(&ok);
-				if (ok) {
-					return doubleValue < otherDoubleValue;
-				}
-			}
-		}
-
-		// otherwise compare as strings
-		return this->text() < other.text();
-	}
-private:
-
-};
 //***************************************************************************
-// Constructor / Desructor
+// Model
 //***************************************************************************
 
 //---------------------------------------------------------------------------
-FilesList::FilesList(MainWindow* Main_) :
-    QTableWidget(Main_),
-    Main(Main_)
+// Numbers are sorted as numbers
+static bool lessThan(const QString& Value, const QString& Other)
 {
-    setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
-    verticalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+    // check if both are integers
+    {
+        bool ok = false;
+        auto intValue = Value.toInt(&ok);
+        if (ok)
+        {
+            auto otherIntValue = Other.toInt(&ok);
+            if (ok) {
+                return intValue < otherIntValue;
+            }
+        }
+    }
 
-    connect(verticalHeader(), SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(on_verticalHeaderContextMenuRequested(const QPoint&)));
+    // check if both are doubles
+    {
+        bool ok = false;
+        auto doubleValue = Value.toDouble(&ok);
+        if (ok)
+        {
+            auto otherDoubleValue = Other.toDouble(&ok);
+            if (ok) {
+                return doubleValue < otherDoubleValue;
+            }
+        }
+    }
 
-    setSortingEnabled(true);
+    // otherwise compare as strings
+    return Value < Other;
 }
 
 //---------------------------------------------------------------------------
-FilesList::~FilesList()
+// One row per file then per file still opening, cells formatted when first shown
+// and kept until the row is invalidated
+class FilesListModel : public QAbstractTableModel
 {
-}
+public:
+    FilesListModel(MainWindow* Main_, QObject* Parent) :
+        QAbstractTableModel(Parent),
+        Main(Main_),
+        SortColumn(-1),
+        SortOrder(Qt::AscendingOrder),
+        ProcessedHeader(PerColumn[Col_Processed].HeaderName)
+    {
+        #ifdef _WIN32
+        #else //_WIN32
+            Font.setPointSize(Font.pointSize()*3/4);
+        #endif //_WIN32
+    }
 
-//***************************************************************************
-// Events
-//***************************************************************************
+    // Rows of Main, the cells of the files already listed are kept
+    void Reset()
+    {
+        beginResetModel();
 
-//---------------------------------------------------------------------------
-void FilesList::showEvent(QShowEvent * Event)
-{
-    connect(this, SIGNAL(itemClicked(QTableWidgetItem*)), this, SLOT(on_itemClicked(QTableWidgetItem*)));
-    connect(this, SIGNAL(itemDoubleClicked(QTableWidgetItem*)), this, SLOT(on_itemDoubleClicked(QTableWidgetItem*)));
-    setSelectionBehavior(QAbstractItemView::SelectRows);
-    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+        QHash<FileInformation*, size_t> Previous;
+        for (size_t Pos=0; Pos<Rows.size(); Pos++)
+            Previous.insert(Rows[Pos].File, Pos);
+
+        std::vector<row> NewRows(Main->Files.size()+Main->FilesOpening.size());
+        for (size_t Pos=0; Pos<NewRows.size(); Pos++)
+        {
+            bool Opening=Pos>=Main->Files.size();
+            FileInformation* File=Opening?Main->FilesOpening[Pos-Main->Files.size()]:Main->Files[Pos];
+
+            auto Old=Previous.constFind(File);
+            if (Old!=Previous.constEnd() && Rows[*Old].Opening==Opening)
+                NewRows[Pos]=std::move(Rows[*Old]);
+            else
+            {
+                NewRows[Pos].File=File;
+                NewRows[Pos].Opening=Opening;
+            }
+        }
+        Rows=std::move(NewRows);
+
+        Sort();
 
-    setColumnCount(Col_Max);
-    for (size_t Col=0; Col<Col_Max; Col++)
+        endResetModel();
+
+        Invalidated.clear();
+    }
+
+    // Stats of the file formatted again when shown, false if they will not change
+    bool Invalidate(size_t File_Pos)
     {
-        QTableWidgetItem* Item=new QTableWidgetItem(PerColumn[Col].HeaderName);
-        if (PerColumn[Col].ToolTip)
-            Item->setToolTip(PerColumn[Col].ToolTip);
-        setHorizontalHeaderItem(Col, Item);
+        row& Row=Rows[File_Pos];
+        if (Row.Stats_Final || Row.Processed_Kept)
+            return false;
+        if (!Row.Stats_Dirty)
+        {
+            Row.Stats_Dirty=true;
+            Invalidated.push_back(OrderPos[File_Pos]);
+        }
+        return true;
     }
 
-    UpdateAll();
-}
+    // Views are notified of the rows invalidated since the last call, contiguous rows together
+    bool Flush()
+    {
+        if (Invalidated.empty())
+            return false;
 
-//***************************************************************************
-// Update
-//***************************************************************************
+        std::sort(Invalidated.begin(), Invalidated.end());
+        size_t Begin=0;
+        for (size_t Pos=1; Pos<=Invalidated.size(); Pos++)
+            if (Pos==Invalidated.size() || Invalidated[Pos]!=Invalidated[Pos-1]+1)
+            {
+                Q_EMIT dataChanged(index(Invalidated[Begin], Col_Processed), index(Invalidated[Pos-1], Col_MSEfY));
+                Begin=Pos;
+            }
+        Invalidated.clear();
 
-//---------------------------------------------------------------------------
-void FilesList::UpdateAll()
-{
-    QFont Font=QFont();
-    #ifdef _WIN32
-    #else //_WIN32
-        Font.setPointSize(Font.pointSize()*3/4);
-    #endif //_WIN32
+        return true;
+    }
 
-    setRowCount(Main->Files.size());
-    for (size_t Files_Pos=0; Files_Pos<Main->Files.size(); Files_Pos++)
+    // Kept until the list is reset
+    void SetProcessed(size_t File_Pos, const QString& Text)
     {
-        FileInformation* file = Main->Files[Files_Pos];
-        connect(file, SIGNAL(signalServerCheckUploadedStatusChanged()), this, SLOT(updateSignalServerCheckUploadedStatus()), Qt::UniqueConnection);
-        connect(file, SIGNAL(signalServerUploadStatusChanged()), this, SLOT(updateSignalServerUploadStatus()), Qt::UniqueConnection);
-        connect(file, SIGNAL(signalServerUploadProgressChanged(qint64, qint64)), this, SLOT(updateSignalServerUploadProgress(qint64, qint64)), Qt::UniqueConnection);
+        if (File_Pos>=Rows.size())
+            return;
+        Format(File_Pos);
+        Rows[File_Pos].Cells[Col_Processed]=Text;
+        Rows[File_Pos].Processed_Kept=true;
+        auto Index=index(OrderPos[File_Pos], Col_Processed);
+        Q_EMIT dataChanged(Index, Index);
+    }
+
+    void SetSignalServer(size_t File_Pos, const QString& Text)
+    {
+        if (File_Pos>=Rows.size())
+            return;
+        Rows[File_Pos].Cells[Col_SignalServer]=Text;
+        auto Index=index(OrderPos[File_Pos], Col_SignalServer);
+        Q_EMIT dataChanged(Index, Index);
+    }
+
+    void SetProcessedHeader(const QString& Text)
+    {
+        ProcessedHeader=Text;
+        Q_EMIT headerDataChanged(Qt::Horizontal, Col_Processed, Col_Processed);
+    }
+
+    // Position in Main of the file of a row of the view
+    size_t FilePos(int Row) const
+    {
+        return Order[Row];
+    }
+
+    // QAbstractTableModel
+    int rowCount(const QModelIndex& Parent=QModelIndex()) const override
+    {
+        return Parent.isValid()?0:(int)Rows.size();
+    }
+
+    int columnCount(const QModelIndex& Parent=QModelIndex()) const override
+    {
+        return Parent.isValid()?0:Col_Max;
+    }
+
+    QVariant data(const QModelIndex& Index, int Role=Qt::DisplayRole) const override
+    {
+        if (!Index.isValid())
+            return QVariant();
+
+        switch (Role)
+        {
+            case Qt::DisplayRole :
+                                    {
+                                    size_t File_Pos=Order[Index.row()];
+                                    Format(File_Pos);
+                                    return Rows[File_Pos].Cells[Index.column()];
+                                    }
+            case Qt::FontRole :
+                                    return Font;
+            default:
+                                    return QVariant();
+        }
+    }
+
+    QVariant headerData(int Section, Qt::Orientation Orientation, int Role=Qt::DisplayRole) const override
+    {
+        if (Orientation==Qt::Horizontal)
+        {
+            if (Section<0 || Section>=Col_Max)
+                return QVariant();
+            switch (Role)
+            {
+                case Qt::DisplayRole :
+                                        return Section==Col_Processed?ProcessedHeader:QString(PerColumn[Section].HeaderName);
+                case Qt::ToolTipRole :
+                                        return PerColumn[Section].ToolTip?QString(PerColumn[Section].ToolTip):QVariant();
+                default:
+                                        return QVariant();
+            }
+        }
+
+        if (Section<0 || Section>=(int)Rows.size())
+            return QVariant();
+        const QString& FileName=Rows[Order[Section]].File->fileName();
+        switch (Role)
+        {
+            case Qt::DisplayRole :
+                                    return QFileInfo(FileName).fileName();
+            case Qt::ToolTipRole :
+                                    return FileName;
+            case Qt::UserRole :
+                                    return QFileInfo(FileName).filePath();
+            default:
+                                    return QVariant();
+        }
+    }
+
+    Qt::ItemFlags flags(const QModelIndex& Index) const override
+    {
+        return Index.isValid()?Qt::ItemIsEnabled:Qt::NoItemFlags;
+    }
+
+    // Values shown afterwards are not sorted again
+    void sort(int Column, Qt::SortOrder Order_) override
+    {
+        Q_EMIT layoutAboutToBeChanged();
+        auto Persistent=persistentIndexList();
+        std::vector<size_t> PersistentFiles;
+        for (const auto& Index : Persistent)
+            PersistentFiles.push_back(Order[Index.row()]);
+
+        SortColumn=Column;
+        SortOrder=Order_;
+        Sort();
+
+        QModelIndexList NewPersistent;
+        for (size_t Pos=0; Pos<PersistentFiles.size(); Pos++)
+            NewPersistent.append(index(OrderPos[PersistentFiles[Pos]], Persistent[Pos].column()));
+        changePersistentIndexList(Persistent, NewPersistent);
+        Q_EMIT layoutChanged();
+    }
+
+private:
+    struct row
+    {
+        FileInformation*        File=nullptr;
+        bool                    Opening=false;
+        bool                    Info_Dirty=true;            // Cells of the file
+        bool                    Stats_Dirty=true;           // Cells of the processed and stats columns
+        bool                    Stats_Final=false;          // Parsing is finished
+        bool                    Processed_Kept=false;       // Export status in the processed column
+        QString                 Cells[Col_Max];
+    };
+
+    // In the order of Main if no column
+    void Sort()
+    {
+        Order.resize(Rows.size());
+        for (size_t Pos=0; Pos<Order.size(); Pos++)
+            Order[Pos]=Pos;
+
+        if (SortColumn>=0 && SortColumn<Col_Max)
+        {
+            for (size_t Pos=0; Pos<Rows.size(); Pos++)
+                Format(Pos);
+            std::stable_sort(Order.begin(), Order.end(), [this](size_t A, size_t B) {
+                const QString& Value=Rows[A].Cells[SortColumn];
+                const QString& Other=Rows[B].Cells[SortColumn];
+                return SortOrder==Qt::AscendingOrder?lessThan(Value, Other):lessThan(Other, Value);
+            });
+        }
+
+        OrderPos.resize(Order.size());
+        for (size_t Pos=0; Pos<Order.size(); Pos++)
+            OrderPos[Order[Pos]]=(int)Pos;
+    }
+
+    void Format(size_t File_Pos) const
+    {
+        row& Row=Rows[File_Pos];
+        if (Row.Opening)
+        {
+            if (Row.Info_Dirty)
+                Row.Cells[Col_Processed]="Opening...";
+            Row.Info_Dirty=false;
+            Row.Stats_Dirty=false;
+            return;
+        }
+
+        if (Row.Info_Dirty)
+        {
+            FormatInfo(Row);
+            Row.Info_Dirty=false;
+        }
+        if (Row.Stats_Dirty)
+        {
+            if (!Row.Processed_Kept)
+                FormatStats(Row);
+            Row.Stats_Dirty=false;
+        }
+    }
+
+    static void FormatInfo(row& Row)
+    {
+        FileInformation* File=Row.File;
 
         QString     Format;
         QString     StreamCount;
@@ -242,7 +444,6 @@ void FilesList::UpdateAll()
         QString     RFrameRate;
         QString     AvgFrameRate;
         std::string      Duration;
-        QString     ShortFileName;
         QString     FileSize;
         QString     VideoFormat;
         QString     Width;
@@ -259,32 +460,30 @@ void FilesList::UpdateAll()
         QString     ChannelLayout;
         QString     ABitDepth_String;
 
-        QFileInfo   FileInfo(Main->Files[Files_Pos]->fileName());
-
-        if (Main->Files[Files_Pos]->isValid())
+        if (File->isValid())
         {
             // Data from FFmpeg
-            Format=                             Main->Files[Files_Pos]->containerFormat.c_str();
-            StreamCount=QString::number(        Main->Files[Files_Pos]->streamCount );
-            BitRate=QString::number(            Main->Files[Files_Pos]->bitRate );
-            int Milliseconds=(int)(             Main->Files[Files_Pos]->duration()*1000 );
-            VideoFormat=                        Main->Files[Files_Pos]->videoFormat().c_str();
-            Width=QString::number(              Main->Files[Files_Pos]->width());
-            Height=QString::number(             Main->Files[Files_Pos]->height());
-            FieldOrder=                         Main->Files[Files_Pos]->fieldOrder().c_str();
-            double DAR=                         Main->Files[Files_Pos]->dar();
-            SAR=                                Main->Files[Files_Pos]->sar().c_str();
-            double FramesDivDurationd=          Main->Files[Files_Pos]->framesDivDuration();
-            RFrameRate=                         Main->Files[Files_Pos]->rvideoFrameRate().c_str();
-            AvgFrameRate=                       Main->Files[Files_Pos]->avgVideoFrameRate().c_str();
-            PixFormatName=                      Main->Files[Files_Pos]->pixFormatName().c_str();
-            ColorSpace=                         Main->Files[Files_Pos]->colorSpace().c_str();
-            ColorRange=                         Main->Files[Files_Pos]->colorRange().c_str();
-            AudioFormat=                        Main->Files[Files_Pos]->audioFormat().c_str();
-            SampleFormat=                       Main->Files[Files_Pos]->sampleFormat().c_str();
-            double SamplingRate=                Main->Files[Files_Pos]->samplingRate();
-            ChannelLayout=                      Main->Files[Files_Pos]->channelLayout().c_str();
-            double ABitDepth=                   Main->Files[Files_Pos]->abitDepth();
+            Format=                             File->containerFormat.c_str();
+            StreamCount=QString::number(        File->streamCount );
+            BitRate=QString::number(            File->bitRate );
+            int Milliseconds=(int)(             File->duration()*1000 );
+            VideoFormat=                        File->videoFormat().c_str();
+            Width=QString::number(              File->width());
+            Height=QString::number(             File->height());
+            FieldOrder=                         File->fieldOrder().c_str();
+            double DAR=                         File->dar();
+            SAR=                                File->sar().c_str();
+            double FramesDivDurationd=          File->framesDivDuration();
+            RFrameRate=                         File->rvideoFrameRate().c_str();
+            AvgFrameRate=                       File->avgVideoFrameRate().c_str();
+            PixFormatName=                      File->pixFormatName().c_str();
+            ColorSpace=                         File->colorSpace().c_str();
+            ColorRange=                         File->colorRange().c_str();
+            AudioFormat=                        File->audioFormat().c_str();
+            SampleFormat=                       File->sampleFormat().c_str();
+            double SamplingRate=                File->samplingRate();
+            ChannelLayout=                      File->channelLayout().c_str();
+            double ABitDepth=                   File->abitDepth();
 
             // Parsing
             FramesDivDuration=QString::number(FramesDivDurationd, 'f', 3);
@@ -320,54 +519,146 @@ void FilesList::UpdateAll()
             if (ABitDepth)
                 ABitDepth_String=QString::number(ABitDepth);
 
-            FileSize=QString::number(FileInfo.size());
+            FileSize=QString::number(QFileInfo(File->fileName()).size());
         }
 
+        Row.Cells[Col_Format]=              Format;
+        Row.Cells[Col_StreamCount]=         StreamCount;
+        Row.Cells[Col_BitRate]=             BitRate;
+        Row.Cells[Col_Duration]=            Duration.c_str();
+        Row.Cells[Col_FileSize]=            FileSize;
+      //Row.Cells[Col_Encoder]=             "(TODO)";
+        Row.Cells[Col_VideoFormat]=         VideoFormat;
+        Row.Cells[Col_Width]=               Width;
+        Row.Cells[Col_Height]=              Height;
+        Row.Cells[Col_FieldOrder]=          FieldOrder;
+        Row.Cells[Col_DAR]=                 DAR_String;
+        Row.Cells[Col_SAR]=                 SAR;
+        Row.Cells[Col_PixFormatName]=       PixFormatName;
+        Row.Cells[Col_ColorSpace]=          ColorSpace;
+        Row.Cells[Col_ColorRange]=          ColorRange;
+        Row.Cells[Col_FramesDivDuration]=   FramesDivDuration;
+        Row.Cells[Col_RFrameRate]=          RFrameRate;
+        Row.Cells[Col_AvgFrameRate]=        AvgFrameRate;
+        Row.Cells[Col_AudioFormat]=         AudioFormat;
+      //Row.Cells[Col_SampleFormat]=        SampleFormat;
+        Row.Cells[Col_SamplingRate]=        SamplingRate_String;
+        Row.Cells[Col_ChannelLayout]=       ChannelLayout;
+        Row.Cells[Col_ABitDepth]=           ABitDepth_String;
+    }
 
-        QTableWidgetItem* VerticalHeaderItem=new QTableWidgetItem(FileInfo.fileName());
-        VerticalHeaderItem->setToolTip(Main->Files[Files_Pos]->fileName());
-        VerticalHeaderItem->setData(Qt::UserRole, FileInfo.filePath());
-        setVerticalHeaderItem((int)Files_Pos, VerticalHeaderItem);
-
-        setItem((int)Files_Pos, Col_SignalServer,   new TableWidgetItem());
-        setItem((int)Files_Pos, Col_Format,         new TableWidgetItem(Format));
-        setItem((int)Files_Pos, Col_StreamCount,    new TableWidgetItem(StreamCount));
-        setItem((int)Files_Pos, Col_BitRate,        new TableWidgetItem(BitRate));
-        setItem((int)Files_Pos, Col_Duration,       new TableWidgetItem(Duration.c_str()));
-        setItem((int)Files_Pos, Col_FileSize,       new TableWidgetItem(FileSize));
-      //setItem((int)Files_Pos, Col_Encoder,        new TableWidgetItem("(TODO)"));
-        setItem((int)Files_Pos, Col_VideoFormat,    new TableWidgetItem(VideoFormat));
-        setItem((int)Files_Pos, Col_Width,          new TableWidgetItem(Width));
-        setItem((int)Files_Pos, Col_Height,         new TableWidgetItem(Height));
-        setItem((int)Files_Pos, Col_FieldOrder,     new TableWidgetItem(FieldOrder));
-        setItem((int)Files_Pos, Col_DAR,            new TableWidgetItem(DAR_String));
-        setItem((int)Files_Pos, Col_SAR,            new TableWidgetItem(SAR));
-        setItem((int)Files_Pos, Col_PixFormatName,  new TableWidgetItem(PixFormatName));
-        setItem((int)Files_Pos, Col_ColorSpace,     new TableWidgetItem(ColorSpace));
-        setItem((int)Files_Pos, Col_ColorRange,     new TableWidgetItem(ColorRange));
-        setItem((int)Files_Pos, Col_FramesDivDuration, new TableWidgetItem(FramesDivDuration));
-        setItem((int)Files_Pos, Col_RFrameRate,     new TableWidgetItem(RFrameRate));
-        setItem((int)Files_Pos, Col_AvgFrameRate,   new TableWidgetItem(AvgFrameRate));
-        setItem((int)Files_Pos, Col_AudioFormat,    new TableWidgetItem(AudioFormat));
-      //setItem((int)Files_Pos, Col_SampleFormat,   new TableWidgetItem(SampleFormat));
-        setItem((int)Files_Pos, Col_SamplingRate,   new TableWidgetItem(SamplingRate_String));
-        setItem((int)Files_Pos, Col_ChannelLayout,  new TableWidgetItem(ChannelLayout));
-        setItem((int)Files_Pos, Col_ABitDepth,      new TableWidgetItem(ABitDepth_String));
-
-        for (int Pos=0; Pos<Col_Max; Pos++)
+    static void FormatStats(row& Row)
+    {
+        CommonStats* Stats=Row.File->ReferenceStat();
+        if (!Stats)
         {
-            QTableWidgetItem* Item=item((int)Files_Pos, Pos);
-            if (Item)
+            Row.Cells[Col_Processed]="N/A";
+            return;
+        }
+
+        double State=Stats->State_Get();
+        Row.Cells[Col_Processed]=QString::number((int)(State*100))+'%';
+        Row.Stats_Final=State>=1;
+
+        // Stats
+        for (size_t Col=0; Col<Col_Max; Col++)
+            switch (PerColumn[Col].Stats_Type)
             {
-                Item->setFlags(Item->flags()&(~Qt::ItemIsSelectable & ~Qt::ItemIsEditable));
-                Item->setFont(Font);
+                case StatsType_Average :
+                                            if (PerColumn[Col].Stats_Item2==Item_VideoMax)
+                                                Row.Cells[Col]=Stats->Average_Get(PerColumn[Col].Stats_Item).c_str();
+                                            else
+                                                Row.Cells[Col]=Stats->Average_Get(PerColumn[Col].Stats_Item, PerColumn[Col].Stats_Item2).c_str();
+                                            break;
+                case StatsType_Count :
+                                            Row.Cells[Col]=Stats->Count_Get(PerColumn[Col].Stats_Item).c_str();
+                                            break;
+                case StatsType_Count2 :
+                                            Row.Cells[Col]=Stats->Count2_Get(PerColumn[Col].Stats_Item).c_str();
+                                            break;
+                case StatsType_Percent :
+                                            Row.Cells[Col]=Stats->Percent_Get(PerColumn[Col].Stats_Item).c_str();
+                                            break;
+                default:    ;
             }
-        }
+    }
+
+    MainWindow*                 Main;
+    mutable std::vector<row>    Rows;                       // Per position in Main
+    std::vector<size_t>         Order;                      // Position in Main per row of the view
+    std::vector<int>            OrderPos;                   // Row of the view per position in Main
+    std::vector<int>            Invalidated;                // Rows of the view to notify
+    int                         SortColumn;
+    Qt::SortOrder               SortOrder;
+    QString                     ProcessedHeader;
+    QFont                       Font;
+};
+
+//***************************************************************************
+// Constructor / Desructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+FilesList::FilesList(MainWindow* Main_) :
+    QTableView(Main_),
+    Main(Main_),
+    Model(new FilesListModel(Main_, this))
+{
+    setModel(Model);
+    setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
+    setSelectionBehavior(QAbstractItemView::SelectRows);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    verticalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+
+    connect(this, SIGNAL(clicked(const QModelIndex&)), this, SLOT(on_itemClicked(const QModelIndex&)));
+    connect(this, SIGNAL(doubleClicked(const QModelIndex&)), this, SLOT(on_itemDoubleClicked(const QModelIndex&)));
+    connect(verticalHeader(), SIGNAL(sectionDoubleClicked(int)), this, SLOT(on_verticalHeaderDoubleClicked(int)));
+    connect(verticalHeader(), SIGNAL(sectionClicked(int)), this, SLOT(on_verticalHeaderClicked(int)));
+    connect(verticalHeader(), SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(on_verticalHeaderContextMenuRequested(const QPoint&)));
+
+    // Not sorted until a column is clicked, sorting formats all the rows
+    horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    setSortingEnabled(true);
+
+    checkUploadedTimer.setSingleShot(true);
+    checkUploadedTimer.setInterval(250);
+    connect(&checkUploadedTimer, SIGNAL(timeout()), this, SLOT(showSignalServerCheckUploadedStatus()));
+}
 
-        connect(verticalHeader(), SIGNAL(sectionDoubleClicked(int)), this, SLOT(on_verticalHeaderDoubleClicked(int)));
-        connect(verticalHeader(), SIGNAL(sectionClicked(int)), this, SLOT(on_verticalHeaderClicked(int)));
+//---------------------------------------------------------------------------
+FilesList::~FilesList()
+{
+}
+
+//***************************************************************************
+// Events
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void FilesList::showEvent(QShowEvent * Event)
+{
+    UpdateAll();
+}
+
+//***************************************************************************
+// Update
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void FilesList::UpdateAll()
+{
+    for (size_t Files_Pos=0; Files_Pos<Main->Files.size(); Files_Pos++)
+    {
+        FileInformation* file = Main->Files[Files_Pos];
+        connect(file, SIGNAL(signalServerCheckUploadedStatusChanged()), this, SLOT(updateSignalServerCheckUploadedStatus()), Qt::UniqueConnection);
+        connect(file, SIGNAL(signalServerUploadStatusChanged()), this, SLOT(updateSignalServerUploadStatus()), Qt::UniqueConnection);
+        connect(file, SIGNAL(signalServerUploadProgressChanged(qint64, qint64)), this, SLOT(updateSignalServerUploadProgress(qint64, qint64)), Qt::UniqueConnection);
     }
 
+    // Files still opening are after the other ones, filled once opened
+    Model->Reset();
+
     Update();
 }
 
@@ -375,56 +666,18 @@ void FilesList::UpdateAll()
 void FilesList::Update()
 {
     for (size_t Files_Pos=0; Files_Pos<Main->Files.size(); Files_Pos++)
-    {
-        QTableWidgetItem* Item=item((int)Files_Pos, 0);
-        if (!Item || Item->text()!="100%")
-            Update(Files_Pos);
-    }
+        Model->Invalidate(Files_Pos);
 
-    resizeColumnsToContents();
+    // Rows not shown are not formatted
+    if (Model->Flush())
+        resizeColumnsToContents();
 }
 
 //---------------------------------------------------------------------------
 void FilesList::Update(size_t Files_Pos)
 {
-    CommonStats* Stats=Main->Files[Files_Pos]->ReferenceStat();
-    if (!Stats)
-    {
-        setItem((int)Files_Pos, Col_Processed, new QTableWidgetItem("N/A"));
-        return;
-    }
-
-    std::stringstream Message;
-    Message<<(int)(Stats->State_Get()*100)<<"%";
-    setItem((int)Files_Pos, Col_Processed, new QTableWidgetItem(QString::fromStdString(Message.str())));
-    
-    // Stats
-    for (size_t Col=0; Col<Col_Max; Col++)
-        if (PerColumn[Col].Stats_Type!=StatsType_None)
-        {
-            QTableWidgetItem* Item=new TableWidgetItem();
-            switch (PerColumn[Col].Stats_Type)
-            {
-                case StatsType_Average : 
-                                            if (PerColumn[Col].Stats_Item2==Item_VideoMax)
-                                                Item->setText(Stats->Average_Get(PerColumn[Col].Stats_Item).c_str());
-                                            else
-                                                Item->setText(Stats->Average_Get(PerColumn[Col].Stats_Item, PerColumn[Col].Stats_Item2).c_str());
-                                            break;
-                case StatsType_Count : 
-                                            Item->setText(Stats->Count_Get(PerColumn[Col].Stats_Item).c_str());
-                                            break;
-                case StatsType_Count2 :
-                                            Item->setText(Stats->Count2_Get(PerColumn[Col].Stats_Item).c_str());
-                                            break;
-                case StatsType_Percent : 
-                                            Item->setText(Stats->Percent_Get(PerColumn[Col].Stats_Item).c_str());
-                                            break;
-                default:    ;
-            }
-            Item->setFlags(Item->flags()&(~Qt::ItemIsSelectable & ~Qt::ItemIsEditable));
-            setItem((int)Files_Pos, Col, Item);
-        }
+    Model->Invalidate(Files_Pos);
+    Model->Flush();
 }
 
 //***************************************************************************
@@ -435,11 +688,11 @@ void FilesList::Update(size_t Files_Pos)
 void FilesList::contextMenuEvent (QContextMenuEvent* Event)
 {
     //Retrieving data
-    QTableWidgetItem* Item=itemAt(Event->pos());
-    if (Item==NULL)
+    QModelIndex Index=indexAt(viewport()->mapFromGlobal(Event->globalPos()));
+    if (!Index.isValid() || Model->FilePos(Index.row())>=Main->Files.size())
         return;
 
-    contextMenu(Event->globalPos(), Item->row());
+    contextMenu(Event->globalPos(), (int)Model->FilePos(Index.row()));
 }
 
 //---------------------------------------------------------------------------
@@ -484,7 +737,7 @@ void FilesList::contextMenu(const QPoint& pos, const int& row)
     }
     if(Text == "Reveal file location")
     {
-        QString fileName = verticalHeaderItem(row)->data(Qt::UserRole).toString();
+        QString fileName = Main->Files[row]->fileName();
         QFileInfo fileInfo(fileName);
         QDesktopServices::openUrl(QUrl::fromLocalFile(fileInfo.absoluteDir().path()));
     }
@@ -495,27 +748,37 @@ void FilesList::contextMenu(const QPoint& pos, const int& row)
 //***************************************************************************
 
 //---------------------------------------------------------------------------
-void FilesList::on_itemClicked(QTableWidgetItem * item)
+void FilesList::on_itemClicked(const QModelIndex& index)
 {
-    Main->selectFile(item->row());
+    size_t File_Pos=Model->FilePos(index.row());
+    if (File_Pos>=Main->Files.size())
+        return;
+    Main->selectFile((int)File_Pos);
 }
 
 //---------------------------------------------------------------------------
-void FilesList::on_itemDoubleClicked(QTableWidgetItem * item)
+void FilesList::on_itemDoubleClicked(const QModelIndex& index)
 {
-    Main->selectDisplayFile(item->row());
+    size_t File_Pos=Model->FilePos(index.row());
+    if (File_Pos>=Main->Files.size())
+        return;
+    Main->selectDisplayFile((int)File_Pos);
 }
 
 //---------------------------------------------------------------------------
 void FilesList::on_verticalHeaderClicked(int logicalIndex)
 {
-    Main->selectFile(logicalIndex);
+    if (logicalIndex<0 || Model->FilePos(logicalIndex)>=Main->Files.size())
+        return;
+    Main->selectFile((int)Model->FilePos(logicalIndex));
 }
 
 //---------------------------------------------------------------------------
 void FilesList::on_verticalHeaderDoubleClicked(int logicalIndex)
 {
-    Main->selectDisplayFile(logicalIndex);
+    if (logicalIndex<0 || Model->FilePos(logicalIndex)>=Main->Files.size())
+        return;
+    Main->selectDisplayFile((int)Model->FilePos(logicalIndex));
 }
 
 //---------------------------------------------------------------------------
@@ -523,12 +786,12 @@ void FilesList::on_verticalHeaderContextMenuRequested(const QPoint& pos)
 {
     //Retrieving data
     int index = verticalHeader()->logicalIndexAt(pos);
-    if (index<0 || index>=rowCount())
+    if (index<0 || Model->FilePos(index)>=Main->Files.size())
         return;
 
     selectRow(index);
-    Main->selectFile(index);
-    contextMenu(verticalHeader()->mapToGlobal(pos), index);
+    Main->selectFile((int)Model->FilePos(index));
+    contextMenu(verticalHeader()->mapToGlobal(pos), (int)Model->FilePos(index));
 }
 
 //---------------------------------------------------------------------------
@@ -537,7 +800,20 @@ void FilesList::updateSignalServerCheckUploadedStatus()
     FileInformation* file = qobject_cast<FileInformation*>(sender());
     assert(file);
 
-    item(file->index(), Col_SignalServer)->setText(file->signalServerCheckUploadedStatusString());
+    if(!checkUploadedPending.contains(file))
+        checkUploadedPending.append(file);
+    if(!checkUploadedTimer.isActive())
+        checkUploadedTimer.start();
+}
+
+void FilesList::showSignalServerCheckUploadedStatus()
+{
+    setUpdatesEnabled(false);
+    for(const auto& file : checkUploadedPending)
+        if(file)
+            Model->SetSignalServer(file->index(), file->signalServerCheckUploadedStatusString());
+    checkUploadedPending.clear();
+    setUpdatesEnabled(true);
 }
 
 void FilesList::updateSignalServerUploadStatus()
@@ -545,7 +821,7 @@ void FilesList::updateSignalServerUploadStatus()
     FileInformation* file = qobject_cast<FileInformation*>(sender());
     assert(file);
 
-    item(file->index(), Col_SignalServer)->setText(file->signalServerUploadStatusString());
+    Model->SetSignalServer(file->index(), file->signalServerUploadStatusString());
 }
 
 void FilesList::updateSignalServerUploadProgress(qint64 value, qint64 total)
@@ -553,5 +829,19 @@ void FilesList::updateSignalServerUploadProgress(qint64 value, qint64 total)
     FileInformation* file = qobject_cast<FileInformation*>(sender());
     assert(file);
 
-    item(file->index(), Col_SignalServer)->setText(QString("Uploading: %1 / %2").arg(value).arg(total));
+    Model->SetSignalServer(file->index(), QString("Uploading: %1 / %2").arg(value).arg(total));
+}
+
+void FilesList::updateExportProgress(FileInformation* file, int percent)
+{
+    // Placed in the processed column, kept by Update()
+    Model->SetProcessed(file->index(), percent < 100 ? QString("Exporting %1%").arg(percent) : QString("Exported"));
+}
+
+void FilesList::updateExportQueueProgress(int done, int total, int percent)
+{
+    if(done < total)
+        Model->SetProcessedHeader(QString("%1 (export %2/%3, %4%)").arg(PerColumn[Col_Processed].HeaderName).arg(done).arg(total).arg(percent));
+    else
+        Model->SetProcessedHeader(PerColumn[Col_Processed].HeaderName);
 }
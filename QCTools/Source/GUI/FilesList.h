@@ -8,13 +8,19 @@
 #ifndef GraphLayout_H
 #define GraphLayout_H
 
-#include <QTableWidget>
+#include <QPointer>
+#include <QTableView>
+#include <QTimer>
 
 #include "Core/Core.h"
 
+class FileInformation;
+class FilesListModel;
 class MainWindow;
 
-class FilesList : public QTableWidget
+// Cells are formatted when shown, only the rows of the files still parsed are
+// formatted again by Update()
+class FilesList : public QTableView
 {
     Q_OBJECT
 
@@ -36,18 +42,30 @@ protected:
 
 private Q_SLOTS:
 
-    void on_itemClicked(QTableWidgetItem * item);
-    void on_itemDoubleClicked(QTableWidgetItem * item);
+    void on_itemClicked(const QModelIndex& index);
+    void on_itemDoubleClicked(const QModelIndex& index);
     void on_verticalHeaderClicked(int logicalIndex);
     void on_verticalHeaderDoubleClicked(int logicalIndex);
     void on_verticalHeaderContextMenuRequested(const QPoint& pos);
 
     void updateSignalServerCheckUploadedStatus();
+    void showSignalServerCheckUploadedStatus();
     void updateSignalServerUploadStatus();
     void updateSignalServerUploadProgress(qint64, qint64);
 
+public Q_SLOTS:
+    // See ExportQueue
+    void updateExportProgress(FileInformation* file, int percent);
+    void updateExportQueueProgress(int done, int total, int percent);
+
 private:
     void contextMenu(const QPoint& pos, const int& row);
+
+    FilesListModel* Model;
+
+    // Checks of a large list of files end at about the same time, shown together
+    QList<QPointer<FileInformation>> checkUploadedPending;
+    QTimer checkUploadedTimer;
 };
 
 #endif // GraphLayout_H
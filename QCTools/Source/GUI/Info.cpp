@@ -68,6 +68,8 @@ Info::Info(QWidget *parent, const struct per_group* plotGroup, const struct per_
 
     // Info
     Frames_Pos=-1;
+    Range_Begin=0;
+    Range_End=0;
     ShouldUpate=false;
 }
 
@@ -81,6 +83,26 @@ Info::~Info()
 //
 //***************************************************************************
 
+//---------------------------------------------------------------------------
+static QString ToString(double Value, int DigitsAfterComma)
+{
+    if (DigitsAfterComma==0)
+        return QString::number((int)Value);
+
+    QString Result=QString::number(Value, 'f', DigitsAfterComma);
+    int Point=Result.indexOf('.');
+    if (Point==-1)
+    {
+        Result+='.';
+        Point=Result.size();
+    }
+    else
+        Point++;
+    while (Result.size()-Point<DigitsAfterComma)
+        Result+='0'; //Adding precision information
+    return Result;
+}
+
 //---------------------------------------------------------------------------
 void Info::Update()
 {
@@ -90,26 +112,21 @@ void Info::Update()
     Frames_Pos=FileInfoData->Frames_Pos_Get();
     ShouldUpate=false;
 
-    if (Frames_Pos<FileInfoData->ReferenceStat()->x_Current)
+    CommonStats* Stats=FileInfoData->ReferenceStat();
+    if (Frames_Pos<Stats->x_Current_Get())
         for (size_t Pos=0; Pos<CountOfItems; Pos++)
         {
-            if (m_plotItem[Pos].DigitsAfterComma==0)
-                Values[Pos]->setText(m_plotItem[Pos].Name+QString("= ")+QString::number((int)FileInfoData->ReferenceStat()->y[Pos][Frames_Pos]));
-            else
+            Stats->Item_Require(Pos);
+            QString Text=m_plotItem[Pos].Name+QString("= ")+ToString(Stats->y[Pos][Frames_Pos], m_plotItem[Pos].DigitsAfterComma);
+            if (Range_Begin<Range_End)
             {
-                QString Value=QString::number(FileInfoData->ReferenceStat()->y[Pos][Frames_Pos], 'f', m_plotItem[Pos].DigitsAfterComma);
-                int Point=Value.indexOf('.');
-                if (Point==-1)
-                {
-                    Value+='.';
-                    Point=Value.size();
-                }
-                else
-                    Point++;
-                while (Value.size()-Point<m_plotItem[Pos].DigitsAfterComma)
-                    Value+='0'; //Adding precision information
-                Values[Pos]->setText(m_plotItem[Pos].Name+QString("= ")+Value);
+                // From the range index of the item, the cost does not depend on the count of frames
+                StatsRangeIndex::range Range=Stats->y_Range(Pos, Range_Begin, Range_End);
+                if (Range.Count && Range.Min<=Range.Max)
+                    Text+=QString(" (")+ToString(Range.Min, m_plotItem[Pos].DigitsAfterComma)+QString("..")+ToString(Range.Max, m_plotItem[Pos].DigitsAfterComma)
+                         +QString(", avg ")+QString::number(Range.Mean(), 'f', m_plotItem[Pos].DigitsAfterComma+1)+QString(")");
             }
+            Values[Pos]->setText(Text);
         }
     else
     {
@@ -118,3 +135,12 @@ void Info::Update()
         ShouldUpate=true;
     }
 }
+
+//---------------------------------------------------------------------------
+void Info::SetRange(int Begin, int End)
+{
+    Range_Begin=Begin<0?0:Begin;
+    Range_End=End;
+    ShouldUpate=true;
+    Update();
+}
@@ -39,12 +39,15 @@ public:
 public Q_SLOT:
 	// Commands
 	void                        Update();
+	void                        SetRange(int Begin, int End); // Minimum, maximum and average of the frames from Begin to End (excluded) after the value of the current frame, none if End<=Begin
 
 protected:
     // File information
     FileInformation*                   FileInfoData;
     bool                        ShouldUpate;
-    int                         Frames_Pos;
+    int64_t                     Frames_Pos;
+    int                         Range_Begin;
+    int                         Range_End;
 
     // Widgets
     QLabel**                    Values;
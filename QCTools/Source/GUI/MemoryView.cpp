@@ -0,0 +1,98 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "GUI/MemoryView.h"
+#include "GUI/PanelTileCache.h"
+#include "GUI/Plots.h"
+#include "GUI/panelsview.h"
+#include <QDialogButtonBox>
+#include <QFontDatabase>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <qwt_plot_canvas.h>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+static QString MB(qint64 Bytes)
+{
+    return QString::number(Bytes/(1024.0*1024), 'f', 1)+" MB";
+}
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+MemoryView::MemoryView(const std::function<std::vector<FileInformation*>()>& files, const std::function<Plots*()>& plots, QWidget * parent)
+: QDialog(parent)
+, Files(files)
+, CurrentPlots(plots)
+{
+    setWindowFlags(windowFlags()& ~Qt::WindowContextHelpButtonHint);
+    setWindowTitle("Memory usage");
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(720, 320);
+
+    Text=new QPlainTextEdit(this);
+    Text->setReadOnly(true);
+    Text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    QPushButton* Close=new QPushButton("&Close");
+    Close->setDefault(true);
+    QDialogButtonBox* Dialog=new QDialogButtonBox();
+    Dialog->addButton(Close, QDialogButtonBox::AcceptRole);
+    connect(Dialog, SIGNAL(accepted()), this, SLOT(close()));
+
+    QVBoxLayout* L=new QVBoxLayout();
+    L->addWidget(Text);
+    L->addWidget(Dialog);
+    setLayout(L);
+
+    connect(&Timer, SIGNAL(timeout()), this, SLOT(refresh()));
+    Timer.start(1000);
+    refresh();
+}
+
+//***************************************************************************
+// Actions
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void MemoryView::refresh()
+{
+    QStringList Lines;
+    qint64 Total=0;
+    for (auto File : Files())
+    {
+        auto Usage=File->memoryUsage();
+        Lines.append(File->fileName());
+        Lines.append("    "+Usage.Line());
+        Total+=Usage.Total();
+    }
+    if (Lines.isEmpty())
+        Lines.append("No file opened.");
+
+    // Caches of the views of the current file, drawn again when dropped
+    qint64 Tiles=PanelTileCache::instance().bytes();
+    qint64 Canvases=0;
+    qint64 Panels=0;
+    if (auto Current=CurrentPlots())
+    {
+        for (auto Canvas : Current->findChildren<QwtPlotCanvas*>())
+            if (auto Store=Canvas->backingStore())
+                Canvases+=qint64(Store->width())*Store->height()*Store->depth()/8;
+        for (size_t Pos=0; Pos<Current->panelsCount(); ++Pos)
+            Panels+=Current->panelsView(Pos)->pixmapBytes();
+    }
+    Lines.append("views");
+    Lines.append(QString("    panel tiles %1, panels %2, plot canvases %3").arg(MB(Tiles)).arg(MB(Panels)).arg(MB(Canvases)));
+    Total+=Tiles+Panels+Canvases;
+
+    Lines.append(QString("total %1").arg(MB(Total)));
+    Text->setPlainText(Lines.join('\n'));
+}
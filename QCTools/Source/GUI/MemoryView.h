@@ -0,0 +1,48 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef MemoryViewH
+#define MemoryViewH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "Core/FileInformation.h"
+#include <QDialog>
+#include <QTimer>
+#include <functional>
+#include <vector>
+
+class Plots;
+class QPlainTextEdit;
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Memory of each open file (see FileInformation::memoryUsage) and of the
+// caches of the views, refreshed every second
+//***************************************************************************
+
+class MemoryView : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // Constructor/Destructor
+    MemoryView (const std::function<std::vector<FileInformation*>()>& files, const std::function<Plots*()>& plots, QWidget * parent);
+
+private Q_SLOTS:
+    void refresh();
+
+private:
+    std::function<std::vector<FileInformation*>()> Files;
+    std::function<Plots*()> CurrentPlots;
+
+    //GUI
+    QPlainTextEdit* Text;
+    QTimer          Timer;
+};
+
+#endif
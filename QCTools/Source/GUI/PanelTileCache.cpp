@@ -0,0 +1,62 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "GUI/PanelTileCache.h"
+#include <QMutexLocker>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+PanelTileCache::PanelTileCache()
+: m_tiles(budgetKiB)
+{
+}
+
+//---------------------------------------------------------------------------
+PanelTileCache& PanelTileCache::instance()
+{
+    static PanelTileCache cache;
+    return cache;
+}
+
+//***************************************************************************
+// Access
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+QImage PanelTileCache::find(const Key& key) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // object() moves the tile to the front, the cache is logically const
+    auto tile = const_cast<QCache<Key, QImage>&>(m_tiles).object(key);
+    return tile ? *tile : QImage();
+}
+
+//---------------------------------------------------------------------------
+bool PanelTileCache::contains(const Key& key) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_tiles.contains(key);
+}
+
+//---------------------------------------------------------------------------
+void PanelTileCache::insert(const Key& key, const QImage& tile)
+{
+    QMutexLocker locker(&m_mutex);
+    m_tiles.insert(key, new QImage(tile), int(qMax<qint64>(1, tile.sizeInBytes() / 1024)));
+}
+
+//---------------------------------------------------------------------------
+qint64 PanelTileCache::bytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return qint64(m_tiles.totalCost()) * 1024;
+}
@@ -0,0 +1,63 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef PanelTileCacheH
+#define PanelTileCacheH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Panel images scaled to their size on screen, shared by all the panels
+//***************************************************************************
+
+// Least recently used tiles are dropped when the memory budget is reached.
+// Tiles are made by the GUI thread and by the prefetch of PanelsView, so
+// the cache is locked.
+class PanelTileCache
+{
+public:
+    struct Key
+    {
+        quint64 panel;  // See PanelsView::m_tilesId
+        int index;      // Panel image
+        qint64 scale;   // Pixels per frame, fixed point
+        int height;
+
+        bool operator==(const Key& other) const {
+            return panel == other.panel && index == other.index && scale == other.scale && height == other.height;
+        }
+    };
+
+    static PanelTileCache& instance();
+
+    QImage find(const Key& key) const;
+    bool contains(const Key& key) const;
+    void insert(const Key& key, const QImage& tile);
+    // Memory of the tiles kept, at most the budget
+    qint64 bytes() const;
+
+private:
+    PanelTileCache();
+
+    static const int budgetKiB = 128 * 1024;
+
+    mutable QMutex m_mutex;
+    QCache<Key, QImage> m_tiles; // Cost in KiB
+};
+
+inline uint qHash(const PanelTileCache::Key& key, uint seed = 0)
+{
+    return qHash(key.panel, seed) ^ qHash(key.index) ^ qHash(key.scale) ^ qHash(key.height);
+}
+
+#endif // PanelTileCacheH
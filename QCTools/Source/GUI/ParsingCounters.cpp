@@ -0,0 +1,76 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "GUI/ParsingCounters.h"
+#include <QDialogButtonBox>
+#include <QFontDatabase>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QVBoxLayout>
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+ParsingCounters::ParsingCounters(const std::function<FileInformation*()>& currentFile, QWidget * parent)
+: QDialog(parent)
+, CurrentFile(currentFile)
+{
+    setWindowFlags(windowFlags()& ~Qt::WindowContextHelpButtonHint);
+    setWindowTitle("Analysis counters");
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(640, 320);
+
+    Text=new QPlainTextEdit(this);
+    Text->setReadOnly(true);
+    Text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    QPushButton* Close=new QPushButton("&Close");
+    Close->setDefault(true);
+    QDialogButtonBox* Dialog=new QDialogButtonBox();
+    Dialog->addButton(Close, QDialogButtonBox::AcceptRole);
+    connect(Dialog, SIGNAL(accepted()), this, SLOT(close()));
+
+    QVBoxLayout* L=new QVBoxLayout();
+    L->addWidget(Text);
+    L->addWidget(Dialog);
+    setLayout(L);
+
+    connect(&Timer, SIGNAL(timeout()), this, SLOT(refresh()));
+    Timer.start(1000);
+    refresh();
+}
+
+//***************************************************************************
+// Actions
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void ParsingCounters::refresh()
+{
+    // Rates of the last second, since the start once the file is selected or analyzed
+    FileInformation* Current=CurrentFile();
+    if (Current!=File)
+    {
+        File=Current;
+        Previous.reset();
+    }
+    if (!File)
+    {
+        Text->setPlainText("No file selected.");
+        return;
+    }
+
+    auto Counters=File->parsingCounters();
+    QStringList Lines;
+    Lines.append(File->fileName());
+    Lines.append(Counters.Lines(File->parsed()?nullptr:Previous.get()));
+    Text->setPlainText(Lines.join('\n'));
+    Previous.reset(new FileInformation::ParsingCounters(Counters));
+}
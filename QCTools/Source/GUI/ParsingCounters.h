@@ -0,0 +1,48 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef ParsingCountersH
+#define ParsingCountersH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include "Core/FileInformation.h"
+#include <QDialog>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+#include <memory>
+
+class QPlainTextEdit;
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Counters of the analysis of the current file, refreshed every second
+//***************************************************************************
+
+class ParsingCounters : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // Constructor/Destructor
+    ParsingCounters (const std::function<FileInformation*()>& currentFile, QWidget * parent);
+
+private Q_SLOTS:
+    void refresh();
+
+private:
+    std::function<FileInformation*()> CurrentFile;
+    QPointer<FileInformation> File;
+    std::unique_ptr<FileInformation::ParsingCounters> Previous;
+
+    //GUI
+    QPlainTextEdit* Text;
+    QTimer          Timer;
+};
+
+#endif
@@ -15,6 +15,10 @@
 #include <qwt_widget_overlay.h>
 #include <qwt_scale_widget.h>
 #include <qwt_plot_canvas.h>
+#include <qwt_plot_directpainter.h>
+#ifdef QCTOOLS_QWT_OPENGL
+#include <qwt_plot_opengl_canvas.h>
+#endif
 #include <qwt_plot_marker.h>
 #include <qwt_plot_magnifier.h>
 #include <qwt_plot_panner.h>
@@ -27,11 +31,84 @@
 #include <qwt_clipper.h>
 
 #include "Core/FileInformation.h"
+#include "Core/ConditionExpression.h"
+#include <QGuiApplication>
+#include <QHash>
 #include <QMetaEnum>
+#include <QRegularExpression>
+#include <QScreen>
+#include <QSet>
 #include <QSettings>
+#include <QTimer>
 #include <cassert>
+#include <cfloat>
+#include <cmath>
 #include <optional>
 
+static bool s_openGLCanvas = false;
+
+QJSEngine& PlotSeriesData::scriptEngine()
+{
+    static QJSEngine* engine = nullptr;
+    if(!engine)
+    {
+        engine = new QJSEngine;
+        engine->globalObject().setProperty("pow2", engine->evaluate("(function(value) { return Math.pow(value, 2); })"));
+        engine->globalObject().setProperty("pow", engine->evaluate("(function(base, exponent) { return Math.pow(base, exponent); })"));
+    }
+
+    return *engine;
+}
+
+QJSValue PlotSeriesData::makeConditionFunction(const Constants& constants, const QString& condition)
+{
+    QString variables;
+    for(const auto& constant : constants)
+        variables += QString("var %1 = %2; ").arg(QString::fromStdString(constant.first), QString::number(constant.second, 'g', 17));
+
+    return scriptEngine().evaluate(QString("(function(y) { %1return %2; })").arg(variables, condition));
+}
+
+// Value of a MinFormula or MaxFormula of a group, a number or "(function() { return <expression>; })",
+// NaN if none or not a number. Same results for all the plots of the same bit depth (or audio range)
+static double evaluateFormula(const char* formula, const PlotSeriesData::Constants& constants)
+{
+    if(formula == nullptr || !*formula)
+        return NAN;
+
+    QString key = formula;
+    for(const auto& constant : constants)
+        key += QString(";%1=%2").arg(QString::fromStdString(constant.first), QString::number(constant.second, 'g', 17));
+
+    static QHash<QString, double> cache;
+    auto cached = cache.constFind(key);
+    if(cached != cache.constEnd())
+        return *cached;
+
+    static const QRegularExpression function("^\\s*\\(\\s*function\\s*\\(\\s*\\)\\s*\\{\\s*return\\s+(.*?);?\\s*\\}\\s*\\)\\s*$");
+    auto functionMatch = function.match(formula);
+    auto expression = functionMatch.hasMatch() ? functionMatch.captured(1) : QString(formula);
+
+    double value;
+    auto compiled = ConditionExpression::Compile(expression.toStdString(), [&](const std::string& name, double& constantValue) {
+        auto constant = constants.find(name);
+        if(constant == constants.end())
+            return false;
+        constantValue = constant->second;
+        return true;
+    });
+    if(compiled)
+        value = compiled->Evaluate(0);
+    else
+    {
+        auto result = PlotSeriesData::makeConditionFunction(constants, expression);
+        value = result.isCallable() ? result.call().toNumber() : NAN;
+    }
+
+    cache.insert(key, value);
+    return value;
+}
+
 static double stepSize( double distance, int numSteps )
 {
     const double s = distance / numSteps;
@@ -79,7 +156,7 @@ public:
 
         QwtText text;
 
-        const int idx = dynamic_cast<const Plot*>( plot() )->frameAt( pos.x() );
+        const qint64 idx = dynamic_cast<const Plot*>( plot() )->frameAt( pos.x() );
         if ( idx >= 0 )
         {
             text = QwtText(infoText( text.font(), idx ), QwtText::RichText);
@@ -103,7 +180,7 @@ public:
     }
 
 protected:
-    virtual QString infoText(const QFont& font, int index ) const
+    virtual QString infoText(const QFont& font, qint64 index ) const
     {
         QFontMetrics metrics(font);
         auto fontHeight = metrics.height();
@@ -128,7 +205,7 @@ protected:
             for( unsigned i = 0; i < m_streamInfo->PerGroup[m_group].Count; ++i )
             {
                 auto curve = (*m_curves)[i];
-                auto sample = static_cast<PlotSeriesData*>(curve->data())->sample(index);
+                auto sample = static_cast<PlotSeriesData*>(curve->data())->frameSample(index);
                 Q_UNUSED(sample);
 
                 const per_item &itemInfo = m_streamInfo->PerItem[m_streamInfo->PerGroup[m_group].Start + i];
@@ -262,11 +339,32 @@ public:
         m_fillBaseline = value;
     }
 
+    bool isFilled() const {
+        return m_fillBaseline || m_fillCurve;
+    }
+
+    // Samples of the visible range only, about 2 per pixel, the same ones for the fill curve
+    void updateView(const QwtScaleMap& xMap, const QRectF& canvasRect) const {
+        auto setView = [&](const QwtPlotCurve* curve) {
+            auto seriesData = static_cast<PlotSeriesData*>(const_cast<QwtSeriesData<QPointF>*>(curve->data()));
+            seriesData->setView(qMin(xMap.s1(), xMap.s2()), qMax(xMap.s1(), xMap.s2()), int(canvasRect.width()));
+        };
+        setView(this);
+        if(m_fillCurve)
+            setView(m_fillCurve);
+    }
+
     void setFillBrush(QBrush brush) {
         m_fillBrush = brush;
     }
 
 protected:
+    virtual void drawSeries( QPainter* painter, const QwtScaleMap& xMap, const QwtScaleMap& yMap, const QRectF& canvasRect, int from, int to ) const {
+        updateView(xMap, canvasRect);
+
+        QwtPlotCurve::drawSeries(painter, xMap, yMap, canvasRect, from, to);
+    }
+
     virtual void drawCurve( QPainter* painter , int style, const QwtScaleMap& xMap, const QwtScaleMap& yMap, const QRectF& canvasRect, int from, int to ) const {
         QwtPlotCurve::drawCurve(painter, style, xMap, yMap, canvasRect, from, to);
 
@@ -297,7 +395,7 @@ protected:
             QPolygonF polygon = mapper.toPolygonF( xMap, yMap, data(), from, to);
             QPolygonF baselinePolygon;
             if(m_fillCurve)
-                baselinePolygon = mapper.toPolygonF( xMap, yMap, m_fillCurve->data(), from, to);
+                baselinePolygon = mapper.toPolygonF( xMap, yMap, m_fillCurve->data(), 0, int(m_fillCurve->dataSize()) - 1);
             else if(m_fillBaseline) {
                 const PlotSeriesData* plotSeriesData = static_cast<const PlotSeriesData*>(data());
                 auto fromSample = plotSeriesData->sample(from);
@@ -422,9 +520,89 @@ void Plot::setVisible(bool visible)
     {
         QWidget::setVisible(visible);
         Q_EMIT visibilityChanged(visible);
+
+        // Not replotted while hidden
+        if(visible)
+            replot();
     }
 }
 
+void Plot::replot()
+{
+    QwtPlot::replot();
+
+    m_painted = true;
+    m_paintedFrames = stats()->x_Current_Get();
+    m_paintedXScaleDiv = axisScaleDiv( QwtPlot::xBottom );
+    m_paintedYScaleDiv = axisScaleDiv( QwtPlot::yLeft );
+    m_paintedCanvasSize = canvas()->size();
+}
+
+void Plot::replotNewFrames()
+{
+    // Painted from scratch when on screen again
+    if(!isVisible() || canvas()->visibleRegion().isEmpty())
+    {
+        if(m_painted)
+        {
+            m_painted = false;
+            if(auto plotCanvas = qobject_cast<QwtPlotCanvas*>( canvas() ))
+                plotCanvas->invalidateBackingStore();
+#ifdef QCTOOLS_QWT_OPENGL
+            else if(auto glCanvas = qobject_cast<QwtPlotOpenGLCanvas*>( canvas() ))
+                glCanvas->invalidateBackingStore();
+#endif
+        }
+        return;
+    }
+
+    // The OpenGL canvas is painted from scratch, without the cost of the raster engine
+    const size_t count = stats()->x_Current_Get();
+    if(!m_painted || m_barchart || count < m_paintedFrames || !qobject_cast<QwtPlotCanvas*>( canvas() )
+        || axisScaleDiv( QwtPlot::xBottom ) != m_paintedXScaleDiv || axisScaleDiv( QwtPlot::yLeft ) != m_paintedYScaleDiv
+        || canvas()->size() != m_paintedCanvasSize)
+    {
+        replot();
+        return;
+    }
+    if(count == m_paintedFrames)
+        return;
+
+    // Only if the samples already painted stay the same
+    const QwtScaleMap xMap = canvasMap( QwtPlot::xBottom );
+    const QRectF canvasRect = canvas()->contentsRect();
+    for(auto curve : m_curves)
+    {
+        auto plotCurve = static_cast<PlotCurve*>(curve);
+        plotCurve->updateView(xMap, canvasRect);
+        if(plotCurve->isFilled() || static_cast<const PlotSeriesData*>(plotCurve->data())->isDecimated())
+        {
+            replot();
+            return;
+        }
+    }
+
+    // From the last frame painted, so the lines are joined, up to the right of the canvas
+    const size_t first = m_paintedFrames ? m_paintedFrames - 1 : 0;
+    for(auto curve : m_curves)
+    {
+        if(!curve->isVisible())
+            continue;
+
+        auto seriesData = static_cast<const PlotSeriesData*>(curve->data());
+        int from = int(seriesData->sampleOfFrame(first));
+        int to = int(seriesData->size()) - 1;
+        if(from >= to)
+            continue;
+
+        const int left = int( xMap.transform( seriesData->sample(from).x() ) ) - 4; // Width of the pen
+        m_directPainter->setClipRegion( QRect( QPoint( qMax( 0, left ), 0 ), canvas()->size() ) );
+        m_directPainter->drawSeries( curve, from, to );
+    }
+
+    m_paintedFrames = count;
+}
+
 void Plot::initYAxis()
 {
     if(m_barchart)
@@ -450,15 +628,11 @@ void Plot::initYAxis()
 
         if(m_yminMaxMode == Formula)
         {
-            if(m_minValue.isNumber())
-                yMin = m_minValue.toNumber();
-            else if(m_minValue.isCallable())
-                yMin = m_minValue.call().toNumber();
-
-            if(m_maxValue.isNumber())
-                yMax = m_maxValue.toNumber();
-            else if(m_maxValue.isCallable())
-                yMax = m_maxValue.call().toNumber();
+            if(m_hasMinMaxFormula)
+            {
+                yMin = m_minValue;
+                yMax = m_maxValue;
+            }
         }
         else if(m_yminMaxMode == MinMaxOfThePlot)
         {
@@ -469,6 +643,36 @@ void Plot::initYAxis()
             yMin = m_customYMin;
             yMax = m_customYMax;
         }
+        else if(m_yminMaxMode == MinMaxOfTheVisibleFrames)
+        {
+            // The plot of the whole file until the curves have data and if no frame is visible
+            yMin = stat->y_Min[plotGroup];
+            yMax = stat->y_Max[plotGroup];
+
+            const PlotSeriesData* data = m_curves.empty() ? nullptr : dynamic_cast<const PlotSeriesData*>(m_curves[0]->data());
+            if(data)
+            {
+                // The scale set by the zoom is divided by the next replot only
+                updateAxes();
+                const QwtScaleDiv& xScaleDiv = axisScaleDiv(QwtPlot::xBottom);
+                size_t begin, end;
+                data->framesBetween(xScaleDiv.lowerBound(), xScaleDiv.upperBound(), begin, end);
+
+                auto visibleMin = DBL_MAX;
+                auto visibleMax = -DBL_MAX;
+                for(size_t j = 0; j < group.Count; ++j)
+                {
+                    StatsRangeIndex::range range = stat->y_Range(group.Start + j, begin, end);
+                    visibleMin = qMin(visibleMin, range.Min);
+                    visibleMax = qMax(visibleMax, range.Max);
+                }
+                if(visibleMin <= visibleMax)
+                {
+                    yMin = visibleMin;
+                    yMax = visibleMax;
+                }
+            }
+        }
 
         setYAxis( yMin, yMax, group.StepsCount );
     }
@@ -577,6 +781,9 @@ void Plot::setYAxisMinMaxMode(YMinMaxMode mode)
     case Custom:
         color = QColor(85, 0, 127);
         break;
+    case MinMaxOfTheVisibleFrames:
+        color = "darkgreen";
+        break;
     }
 
     setYAxisColor(color);
@@ -602,15 +809,7 @@ void Plot::getYAxisCustomMinMax(double &min, double &max)
 
 bool Plot::hasMinMaxFormula() const
 {
-    if(m_minValue.isNull() || m_minValue.isError() || m_minValue.isUndefined()) {
-        return false;
-    }
-
-    if(m_maxValue.isNull() || m_maxValue.isError() || m_maxValue.isUndefined()) {
-        return false;
-    }
-
-    return true;
+    return m_hasMinMaxFormula;
 }
 
 const CommonStats *Plot::getStats() const
@@ -648,23 +847,39 @@ Plot::Plot( size_t streamPos, size_t Type, size_t Group, const FileInformation*
     const struct per_group& group = PerStreamType[m_type].PerGroup[m_group];
     auto bitsPerRawSample = m_fileInformation->BitsPerRawSample(type());
 
-    m_engine.globalObject().setProperty("bitsPerRawSample", bitsPerRawSample);
-    m_engine.globalObject().setProperty("two_pow_bitsPerRawSample_minus_one", (1 << bitsPerRawSample) - 1);
-    m_engine.globalObject().setProperty("sqrt_pow_bitsPerRawSample_2", sqrt(2) * (1 << bitsPerRawSample) / 2);
+    // Formulas are evaluated once per bit depth (or audio range) for all the plots, natively if possible
+    PlotSeriesData::Constants constants;
+    constants["bitsPerRawSample"] = bitsPerRawSample;
+    constants["two_pow_bitsPerRawSample_minus_one"] = (1 << bitsPerRawSample) - 1;
+    constants["sqrt_pow_bitsPerRawSample_2"] = sqrt(2) * (1 << bitsPerRawSample) / 2;
 
     if(m_type == Type_Audio) {
         auto ranges = m_fileInformation->audioRanges();
-        m_engine.globalObject().setProperty("audio_min", ranges.first);
-        m_engine.globalObject().setProperty("audio_max", ranges.second);
+        constants["audio_min"] = ranges.first;
+        constants["audio_max"] = ranges.second;
     }
 
-    m_minValue = m_engine.evaluate(group.MinFormula == nullptr ? "" : group.MinFormula);
-    m_maxValue = m_engine.evaluate(group.MaxFormula == nullptr ? "" : group.MaxFormula);
+    m_minValue = evaluateFormula(group.MinFormula, constants);
+    m_maxValue = evaluateFormula(group.MaxFormula, constants);
+    m_hasMinMaxFormula = !std::isnan(m_minValue) && !std::isnan(m_maxValue);
 
     m_barchartBackground = QColor::fromHsv(h + 60, s, v);
 
     setAutoReplot( false );
 
+#ifdef QCTOOLS_QWT_OPENGL
+    if ( s_openGLCanvas )
+    {
+        // The curves are kept in the frame buffer of the canvas, the cursor and the picker overlays are drawn over it
+        QwtPlotOpenGLCanvas* glCanvas = new QwtPlotOpenGLCanvas();
+        glCanvas->setPaintAttribute( QwtPlotAbstractGLCanvas::BackingStore, true );
+        glCanvas->setFrameStyle( QFrame::Plain | QFrame::Panel );
+        glCanvas->setLineWidth( 1 );
+        glCanvas->setPalette(m_charBackground);
+        setCanvas( glCanvas );
+    }
+#endif
+
     QwtPlotCanvas* canvas = dynamic_cast<QwtPlotCanvas*>( this->canvas() );
     if ( canvas )
     {
@@ -691,9 +906,14 @@ Plot::Plot( size_t streamPos, size_t Type, size_t Group, const FileInformation*
     grid->setMinorPen( Qt::gray, 0 , Qt::DotLine );
     grid->attach( this );
 
-    m_cursor = new PlotCursor( canvas );
+    m_cursor = new PlotCursor( this->canvas() );
     m_cursor->setPosition( 0 );
 
+    // New frames are painted on the backing store, then the changed part of it is copied to the canvas
+    m_directPainter = new QwtPlotDirectPainter( this );
+    m_directPainter->setAttribute( QwtPlotDirectPainter::CopyBackingStore, true );
+    m_directPainter->setClipping( true );
+
     // curves
     m_curves.reserve(PerStreamType[m_type].PerGroup[m_group].Count);
     QMap<QString, PlotCurve*> curvesByName;
@@ -859,6 +1079,11 @@ Plot::~Plot()
     delete m_legend;
 }
 
+void Plot::setOpenGLCanvas(bool enable)
+{
+    s_openGLCanvas = enable;
+}
+
 const CommonStats *Plot::stats(size_t statsPos) const {
     if ( statsPos == (size_t)-1 )
         return m_fileInformation->ReferenceStat();
@@ -879,7 +1104,13 @@ QSize Plot::sizeHint() const
 
     const int fh = axisWidget( QwtPlot::yLeft )->fontMetrics().height();
     const int spacing = 0;
-    const int fw = dynamic_cast<const QwtPlotCanvas*>( canvas() )->frameWidth();
+    int fw = 0;
+    if ( const QwtPlotCanvas* plotCanvas = qobject_cast<const QwtPlotCanvas*>( canvas() ) )
+        fw = plotCanvas->frameWidth();
+#ifdef QCTOOLS_QWT_OPENGL
+    else if ( const QwtPlotOpenGLCanvas* glCanvas = qobject_cast<const QwtPlotOpenGLCanvas*>( canvas() ) )
+        fw = glCanvas->frameWidth();
+#endif
 
     // 4 tick labels 
     return QSize( hint.width(), 4 * fh + 3 * spacing + 2 * fw );
@@ -914,6 +1145,38 @@ void Plot::setYAxis( double min, double max, int numSteps )
     setAxisScale( QwtPlot::yLeft, min, max, ::stepSize( max - min, numSteps ) );
 }
 
+//---------------------------------------------------------------------------
+// Cursors moved since the last update of the overlays
+static QSet<PlotCursor*> PlotCursor_Moved;
+
+static void PlotCursor_Update()
+{
+    auto Moved = std::move( PlotCursor_Moved );
+    PlotCursor_Moved.clear();
+    for ( auto Cursor : Moved )
+        Cursor->updateOverlay();
+}
+
+PlotCursor::~PlotCursor()
+{
+    PlotCursor_Moved.remove( this );
+}
+
+void PlotCursor::setPosition( double pos )
+{
+    if ( m_pos == pos )
+        return;
+    m_pos = pos;
+
+    if ( PlotCursor_Moved.isEmpty() )
+    {
+        auto Screen = QGuiApplication::primaryScreen();
+        const qreal RefreshRate = Screen && Screen->refreshRate() > 0 ? Screen->refreshRate() : 60;
+        QTimer::singleShot( qMax( 1, qRound( 1000 / RefreshRate ) ), Qt::PreciseTimer, &PlotCursor_Update );
+    }
+    PlotCursor_Moved.insert( this );
+}
+
 void Plot::setCursorPos( double x )
 {
     m_cursor->setPosition( x );
@@ -1056,44 +1319,20 @@ QColor Plot::curveColor( int index ) const
 
 void Plot::onPickerMoved( const QPointF& pos )
 {
-    const int idx = frameAt( pos.x() );
+    const qint64 idx = frameAt( pos.x() );
     if ( idx >= 0 )
         Q_EMIT cursorMoved(pos, idx);
 }
 
-static int indexLower( double x, const QwtSeriesData<QPointF> &data )
-{
-    int index = qwtUpperSampleIndex<QPointF>( data, x, compareX() );
-    if ( index == -1 )
-        index = data.size();
-
-    return index - 1;
-}
-
-int Plot::frameAt( double x ) const
+qint64 Plot::frameAt( double x ) const
 {
     const QwtPlotCurve* curve = this->curve(0);
     if ( curve == NULL )
         return -1;
 
-    const QwtSeriesData<QPointF> &data = *curve->data();
-
-    int idx = ::indexLower( x, data );
-    if ( idx < 0 )
-    {
-        idx = 0;
-    }
-    else if ( idx < data.size() - 1 )
-    {
-        // index, where x is closer
-        const double x1 = data.sample( idx ).x();
-        const double x2 = data.sample( idx + 1 ).x();
-
-        if ( qAbs( x - x2 ) < qAbs( x - x1 ) )
-            idx++;
-    }
-
-    return idx;
+    // Samples of the curve are the ones of the view, the frames are searched
+    const qint64 idx = static_cast<const PlotSeriesData*>( curve->data() )->frameAt( x );
+    return idx < 0 ? 0 : idx;
 }
 
 void Plot::onXScaleChanged()
@@ -11,6 +11,7 @@
 
 #include <Core/CommonStats.h>
 #include <Core/Core.h>
+#include "Core/ConditionExpression.h"
 #include "Core/VideoCore.h"
 #include <QDebug>
 #include <QEvent>
@@ -21,13 +22,18 @@
 #include <qwt_series_data.h>
 #include <qwt_widget_overlay.h>
 #include <qwt_scale_map.h>
+#include <qwt_scale_div.h>
 #include <math.h>
+#include <map>
+#include <string>
 #include <cassert>
+#include <algorithm>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QPainter>
 
 class QwtPlotCurve;
+class QwtPlotDirectPainter;
 class PlotCursor;
 class PlotLegend;
 class FileInformation;
@@ -37,6 +43,8 @@ class QCheckBox;
 // Class
 //***************************************************************************
 
+// Vertical line of the current frame, drawn on its own overlay widget over the canvas: moving it repaints
+// the old and the new line only, the curves are copied from the backing store of the canvas
 class PlotCursor: public QwtWidgetOverlay
 {
 public:
@@ -45,15 +53,10 @@ public:
         m_pos( 0.0 )
     {
     }
+    ~PlotCursor();
 
-    void setPosition( double pos )
-    {
-        if ( m_pos != pos )
-        {
-            m_pos = pos;
-            updateOverlay();
-        }
-    }
+    // The overlays of the cursors moved are updated together, once per frame of the display
+    void setPosition( double pos );
 
     virtual void drawOverlay( QPainter *painter ) const
     {
@@ -120,6 +123,16 @@ class PlotSeriesData : public QObject, public QwtPointSeriesData
     // QwtSeriesData interface
     Q_OBJECT
 public:
+    // Named constants of the conditions and of the formulas of the y axis (bit depth...)
+    typedef std::map<std::string, double> Constants;
+
+    // Engine of the conditions and formulas the native evaluator does not support (see ConditionExpression), one for
+    // all the plots, created when first needed. GUI thread only.
+    static QJSEngine& scriptEngine();
+
+    // Function of y testing the condition in scriptEngine(), with the constants as local variables
+    static QJSValue makeConditionFunction(const Constants& constants, const QString& condition);
+
     PlotSeriesData(CommonStats* stats, const QString& title, int bitDepth, const int& xDataIndex, const size_t yDataIndex, size_t plotGroup, size_t curveIndex, size_t curvesCount)
         : m_barchart(false), m_conditions(stats, this, plotGroup, title, curveIndex, bitDepth), m_lastCondition(nullptr),
           m_stats(stats), m_xDataIndex(xDataIndex), m_yDataIndex(yDataIndex), m_plotGroup(plotGroup), m_curveIndex(curveIndex),
@@ -128,13 +141,76 @@ public:
 
     }
 
+    // Samples of the view if one is set, else of each frame
     size_t size() const {
-        return m_stats->x_Current;
+        return m_view ? m_positions.size() : m_stats->x_Current_Get();
     }
     QPointF sample(size_t i) const {
+        return frameSample(m_view ? m_positions[i] : i);
+    }
+
+    // Only the frames with the minimum and the maximum value of each of width buckets between xMin and xMax are samples,
+    // so the cost of a repaint does not depend on the count of frames; not in barchart mode, each frame is tested
+    void setView(double xMin, double xMax, int width) {
+        m_view = !m_barchart && width > 0;
+        if(!m_view)
+            return;
+
+        // One more frame on each side, so the lines reach the edges of the canvas
+        size_t count = m_stats->x_Current_Get();
+        size_t begin = lowerFrame(xMin, count);
+        size_t end = lowerFrame(xMax, count) + 2;
+        if(begin)
+            --begin;
+        if(end > count)
+            end = count;
+
+        if(begin == m_viewBegin && end == m_viewEnd && size_t(width) == m_viewWidth && count == m_viewCount && m_xDataIndex == m_viewXDataIndex)
+            return;
+        m_viewXDataIndex = m_xDataIndex;
+        m_viewBegin = begin;
+        m_viewEnd = end;
+        m_viewWidth = width;
+        m_viewCount = count;
+        m_stats->y_PlotPositions(m_yDataIndex, begin, end, width, m_positions);
+    }
 
-        auto xData = m_stats->x[m_xDataIndex];
-        auto yData = m_stats->y[m_yDataIndex];
+    // True if the view has less samples than frames, the samples of the frames already plotted may then change with new frames
+    bool isDecimated() const {
+        return m_view && m_positions.size() < m_viewEnd - m_viewBegin;
+    }
+
+    // Sample of the frame, or of the first frame after it if the frame is not in the view
+    size_t sampleOfFrame(size_t frame) const {
+        if(!m_view)
+            return frame;
+        return std::lower_bound(m_positions.begin(), m_positions.end(), frame) - m_positions.begin();
+    }
+
+    // Frames from the first one with x not lower than xMin to the first one with x not lower than xMax (included)
+    void framesBetween(double xMin, double xMax, size_t& begin, size_t& end) const {
+        size_t count = m_stats->x_Current_Get();
+        begin = lowerFrame(xMin, count);
+        end = count ? lowerFrame(xMax, count) + 1 : 0;
+    }
+
+    // Frame with the closest x, -1 if there is no frame
+    qint64 frameAt(double x) const {
+        size_t count = m_stats->x_Current_Get();
+        if(!count)
+            return -1;
+
+        const auto& xData = m_stats->x[m_xDataIndex];
+        size_t idx = lowerFrame(x, count);
+        if(idx && xData[idx] > x && qAbs(x - xData[idx - 1]) <= qAbs(x - xData[idx]))
+            --idx;
+        return qint64(idx);
+    }
+
+    QPointF frameSample(size_t i) const {
+
+        const auto& xData = m_stats->x[m_xDataIndex];
+        const auto& yData = m_stats->y[m_yDataIndex];
         auto xVal = xData[i];
         auto yVal = yData[i];
 
@@ -150,25 +226,21 @@ public:
 
     QPointF originalSample(size_t i) const {
 
-        auto xData = m_stats->x[m_xDataIndex];
-        auto yData = m_stats->y[m_yDataIndex];
+        const auto& xData = m_stats->x[m_xDataIndex];
+        const auto& yData = m_stats->y[m_yDataIndex];
 
         return QPointF(xData[i], yData[i]);
     }
 
-    double toBarchart(double* yData, int index) const {
+    double toBarchart(const StatsValueColumn& yData, size_t index) const {
 
-        auto y = yData[index];
         for(auto i = 0; i < m_conditions.m_items.size(); ++i) {
             const auto& condition = m_conditions.m_items[i];
 
-            if(condition.match(y)) {
+            if(condition.match(yData, index)) {
                 if(condition.m_eliminateSpikes) {
-                    auto left = index - 1;
-                    auto right = index + 1;
-
-                    bool leftMatched = left >= 0 && condition.match(yData[left]);
-                    bool rightMatched = right < int(size()) && condition.match(yData[right]);
+                    bool leftMatched = index > 0 && condition.match(yData, index - 1);
+                    bool rightMatched = index + 1 < m_stats->x_Current_Get() && condition.match(yData, index + 1);
 
                     if(!leftMatched && !rightMatched)
                         continue;
@@ -182,7 +254,7 @@ public:
         return 0.0;
     }
 
-    double toBarchart(double* yData, int index, double globalMax) const {
+    double toBarchart(const StatsValueColumn& yData, size_t index, double globalMax) const {
         auto value = toBarchart(yData, index);
 
         auto min = globalMax * (m_curveIndex) / m_curvesCount;
@@ -195,17 +267,17 @@ public:
 
     struct Condition
     {
-        Condition() : m_engine(nullptr), m_eliminateSpikes(false) {
+        Condition() : m_constants(nullptr), m_stats(nullptr), m_eliminateSpikes(false) {
         }
 
-        Condition(QJSEngine* engine, CommonStats* stats, size_t plotGroup) : m_engine(engine), m_stats(stats), m_plotGroup(plotGroup), m_eliminateSpikes(false) {
+        Condition(const Constants* constants, CommonStats* stats, size_t plotGroup) : m_constants(constants), m_stats(stats), m_plotGroup(plotGroup), m_eliminateSpikes(false) {
         }
 
         Condition(const Condition& other) = default;
         Condition(Condition&& other) = default;
         Condition& operator=(const Condition&) = default;
 
-        QJSEngine* m_engine;
+        const Constants* m_constants;
 
         CommonStats* m_stats;
         size_t m_plotGroup;
@@ -216,20 +288,42 @@ public:
         bool m_eliminateSpikes;
         mutable QJSValue m_conditionFunction;
 
+        // Native version of the condition, the JavaScript function is used only if the condition is not supported by it
+        std::shared_ptr<const ConditionExpression> m_expression;
+
+        // Results of the condition for the frames of the column, extended with the frames parsed since the last call
+        mutable const StatsValueColumn* m_matchesColumn = nullptr;
+        mutable std::vector<uint64_t> m_matches;
+        mutable size_t m_matchesCount = 0;
+
         bool match(double y) const {
 
+            if(m_expression)
+                return m_expression->Match(y);
+
             if(m_conditionFunction.isCallable() && m_conditionFunction.call(QJSValueList() << y).toBool())
                 return true;
 
             return false;
         }
 
-        static QJSValue makeConditionFunction(QJSEngine* engine, const QString& condition) {
-            return engine->evaluate(QString("(function(y) { return %1; })").arg(condition));
-        }
+        bool match(const StatsValueColumn& yData, size_t index) const {
+
+            // Values of the frame being parsed may still change
+            size_t count = m_stats ? m_stats->x_Current_Get() : 0;
+            if(!m_expression || index >= count)
+                return match(yData[index]);
 
-        QJSValue makeConditionFunction(const QString& condition) const {
-            return makeConditionFunction(m_engine, condition);
+            if(m_matchesColumn != &yData || m_matchesCount > count) {
+                m_matchesColumn = &yData;
+                m_matchesCount = 0;
+            }
+            if(index >= m_matchesCount) {
+                m_expression->Match(yData, m_matchesCount, count, m_matches);
+                m_matchesCount = count;
+            }
+
+            return (m_matches[index / 64] >> (index % 64)) & 1;
         }
 
         void update(const QString& conditionString, const QColor& color, const QString& label, bool eliminateSpikes) {
@@ -244,10 +338,25 @@ public:
 
         void update()
         {
+            m_matchesColumn = nullptr;
+            m_matches.clear();
+            m_matchesCount = 0;
+
+            // Constants are the current ones of the conditions, updateAll() calls update() when they change
+            m_expression.reset();
+            m_conditionFunction = QJSValue();
             if(m_conditionString.isEmpty())
-                m_conditionFunction = QJSValue();
-            else
-                m_conditionFunction = makeConditionFunction(m_conditionString);
+                return;
+
+            m_expression = ConditionExpression::Compile(m_conditionString.toStdString(), [this](const std::string& name, double& value) {
+                auto constant = m_constants->find(name);
+                if(constant == m_constants->end())
+                    return false;
+                value = constant->second;
+                return true;
+            });
+            if(!m_expression)
+                m_conditionFunction = makeConditionFunction(*m_constants, m_conditionString);
         }
     };
 
@@ -258,6 +367,10 @@ public:
 
         }
 
+        // Conditions point to the constants
+        Conditions(const Conditions&) = delete;
+        Conditions& operator=(const Conditions&) = delete;
+
         QJsonObject toJson() const {
             QJsonObject jsonObject;
             jsonObject.insert("chartTitle", m_chartTitle);
@@ -283,12 +396,12 @@ public:
         }
 
         void add(const QString& value, const QColor& color, const QString& label, bool eliminateSpikes) {
-            m_items.append(Condition(&m_engine, m_stats, m_plotGroup));
+            m_items.append(Condition(&m_constants, m_stats, m_plotGroup));
             m_items.back().update(value, color, label, eliminateSpikes);
         }
 
         void add() {
-            m_items.append(Condition(&m_engine, m_stats, m_plotGroup));
+            m_items.append(Condition(&m_constants, m_stats, m_plotGroup));
         }
 
         void remove() {
@@ -306,18 +419,14 @@ public:
             QList<QPair<QString, QString>> autocomplete;
             autocomplete << QPair<QString, QString>("y", "y value of chart");
 
-            auto & engine = m_engine;
+            auto & constants = m_constants;
             auto plotGroup = m_plotGroup;
+            constants.clear();
 
-            engine.globalObject().setProperty("yHalf", (::pow(2, bitdepth)) / 2);
-            autocomplete << QPair<QString, QString>("yHalf", QString("2^(bitdepth) / 2 (Current value = %1)").arg(engine.globalObject().property("yHalf").toInt()));
+            constants["yHalf"] = (::pow(2, bitdepth)) / 2;
+            autocomplete << QPair<QString, QString>("yHalf", QString("2^(bitdepth) / 2 (Current value = %1)").arg((int)constants["yHalf"]));
 
-            auto pow2 = engine.evaluate("(function(value) { return Math.pow(value, 2); })");
-            engine.globalObject().setProperty("pow2", pow2);
             autocomplete << QPair<QString, QString>("pow2", "pow2(exponent)");
-
-            auto pow = engine.evaluate("(function(base, exponent) { return Math.pow(base, exponent); })");
-            engine.globalObject().setProperty("pow", pow);
             autocomplete << QPair<QString, QString>("pow", "pow(base, exponent)");
 
             if(bitdepth == 0)
@@ -330,40 +439,40 @@ public:
 
             if(plotGroup == Group_Y || plotGroup == Group_U || plotGroup == Group_V || plotGroup == Group_YDiff || plotGroup == Group_UDiff || plotGroup == Group_VDiff)
             {
-                engine.globalObject().setProperty("maxval", ::pow(2, bitdepth));
-                autocomplete << QPair<QString, QString>("maxval", QString("2^bitdepth (Current value = %1)").arg(engine.globalObject().property("maxval").toInt()));
+                constants["maxval"] = ::pow(2, bitdepth);
+                autocomplete << QPair<QString, QString>("maxval", QString("2^bitdepth (Current value = %1)").arg((int)constants["maxval"]));
 
-                engine.globalObject().setProperty("minval", 0);
+                constants["minval"] = 0;
                 autocomplete << QPair<QString, QString>("minval", QString("0"));
 
                 if(plotGroup == Group_Y || plotGroup == Group_YDiff)
                 {
-                    engine.globalObject().setProperty("broadcastmaxval", 235 * (::pow(2, bitdepth - 8)));
-                    autocomplete << QPair<QString, QString>("broadcastmaxval", QString("235 * (2^(bitdepth - 8)) (Current value = %1)").arg(engine.globalObject().property("broadcastmaxval").toInt()));
+                    constants["broadcastmaxval"] = 235 * (::pow(2, bitdepth - 8));
+                    autocomplete << QPair<QString, QString>("broadcastmaxval", QString("235 * (2^(bitdepth - 8)) (Current value = %1)").arg((int)constants["broadcastmaxval"]));
 
                 } else if(plotGroup == Group_U || plotGroup == Group_UDiff || plotGroup == Group_V || plotGroup == Group_VDiff)
                 {
-                    engine.globalObject().setProperty("broadcastmaxval", 240 * (::pow(2, bitdepth - 8)));
-                    autocomplete << QPair<QString, QString>("broadcastmaxval", QString("240 * (2^(bitdepth - 8)) (Current value = %1)").arg(engine.globalObject().property("broadcastmaxval").toInt()));
+                    constants["broadcastmaxval"] = 240 * (::pow(2, bitdepth - 8));
+                    autocomplete << QPair<QString, QString>("broadcastmaxval", QString("240 * (2^(bitdepth - 8)) (Current value = %1)").arg((int)constants["broadcastmaxval"]));
                 }
 
-                engine.globalObject().setProperty("broadcastminval", 16 * (::pow(2, bitdepth - 8)));
-                autocomplete << QPair<QString, QString>("broadcastminval", QString("16 * (2^(bitdepth - 8)) (Current value = %1)").arg(engine.globalObject().property("broadcastminval").toInt()));
+                constants["broadcastminval"] = 16 * (::pow(2, bitdepth - 8));
+                autocomplete << QPair<QString, QString>("broadcastminval", QString("16 * (2^(bitdepth - 8)) (Current value = %1)").arg((int)constants["broadcastminval"]));
             } else if(plotGroup == Group_Sat)
             {
-                engine.globalObject().setProperty("satmax", sqrt(2 * ::pow(::pow(2, bitdepth)/2,2)   ));
-                autocomplete << QPair<QString, QString>("satmax", QString("sqrt(2*((2^bitdepth)/2)^2) (Current value = %1)").arg(engine.globalObject().property("satmax").toInt()));
+                constants["satmax"] = sqrt(2 * ::pow(::pow(2, bitdepth)/2,2)   );
+                autocomplete << QPair<QString, QString>("satmax", QString("sqrt(2*((2^bitdepth)/2)^2) (Current value = %1)").arg((int)constants["satmax"]));
 
                 /* use the hypotenuse of green plotted in Cb/Cr based on ITU BT.601 values as the satyuvmax */
-                engine.globalObject().setProperty("satyuvmax", sqrt(::pow(-74.203,2)+::pow(93.786,2)) * (::pow(2, bitdepth - 8)));
-                autocomplete << QPair<QString, QString>("satyuvmax", QString("sqrt(-74.203^2+93.786^2) * (2^(bitdepth - 8)) (Current value = %1)").arg(engine.globalObject().property("satyuvmax").toInt()));
+                constants["satyuvmax"] = sqrt(::pow(-74.203,2)+::pow(93.786,2)) * (::pow(2, bitdepth - 8));
+                autocomplete << QPair<QString, QString>("satyuvmax", QString("sqrt(-74.203^2+93.786^2) * (2^(bitdepth - 8)) (Current value = %1)").arg((int)constants["satyuvmax"]));
 
                 /* 75% of satyuvmax as satbroadcastmax */
-                engine.globalObject().setProperty("satbroadcastmax", sqrt(::pow(-74.203,2)+::pow(93.786,2)) * (::pow(2, bitdepth - 8)) * 0.75);
-                autocomplete << QPair<QString, QString>("satbroadcastmax", QString("sqrt(-74.203^2+93.786^2) * (2^(bitdepth - 8)) * 0.75 (Current value = %1)").arg(engine.globalObject().property("satbroadcastmax").toInt()));
+                constants["satbroadcastmax"] = sqrt(::pow(-74.203,2)+::pow(93.786,2)) * (::pow(2, bitdepth - 8)) * 0.75;
+                autocomplete << QPair<QString, QString>("satbroadcastmax", QString("sqrt(-74.203^2+93.786^2) * (2^(bitdepth - 8)) * 0.75 (Current value = %1)").arg((int)constants["satbroadcastmax"]));
             }
 
-            engine.setProperty("autocomplete", QVariant::fromValue(autocomplete));
+            m_autocomplete = autocomplete;
 
             for(auto & condition : m_items)
             {
@@ -386,7 +495,8 @@ public:
             return true;
         }
 
-        mutable QJSEngine m_engine;
+        Constants m_constants;
+        QList<QPair<QString, QString>> m_autocomplete;     // Names known by the conditions, with their description
         QVector<Condition> m_items;
 
         CommonStats* m_stats;
@@ -414,6 +524,8 @@ public Q_SLOTS:
     void setBarchart(bool enable) {
         qDebug() << "barchart mode: " << enable;
         m_barchart = enable;
+        m_view = false;
+        m_viewCount = 0;
         m_conditions.updateAll(m_conditions.m_bitdepth);
     }
 
@@ -430,6 +542,30 @@ private:
     size_t m_plotGroup;
     size_t m_curveIndex;
     size_t m_curvesCount;
+
+    // See setView()
+    bool m_view { false };
+    std::vector<uint32_t> m_positions;
+    size_t m_viewBegin { 0 };
+    size_t m_viewEnd { 0 };
+    size_t m_viewWidth { 0 };
+    size_t m_viewCount { 0 };
+    int m_viewXDataIndex { -1 };
+
+    // First frame with x not lower than this one, the last frame if none
+    size_t lowerFrame(double x, size_t count) const {
+        const auto& xData = m_stats->x[m_xDataIndex];
+        size_t first = 0;
+        size_t last = count;
+        while(first < last) {
+            size_t middle = first + (last - first) / 2;
+            if(xData[middle] < x)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return first < count ? first : (count ? count - 1 : 0);
+    }
 };
 
 class Plot : public QwtPlot
@@ -440,7 +576,8 @@ public:
     enum YMinMaxMode {
         MinMaxOfThePlot,
         Formula,
-        Custom
+        Custom,
+        MinMaxOfTheVisibleFrames
     };
     Q_ENUM(YMinMaxMode);
 
@@ -472,11 +609,15 @@ public:
     QWidget* legend() { return m_legend; }
     void setLegend(QWidget* item) { m_legend = item; }
 
-    int frameAt( double x ) const;
+    qint64 frameAt( double x ) const;
 
     void addGuidelines(int bitsPerRawSample);
     virtual void setVisible(bool visible) override;
 
+    // While parsing, draws the frames parsed since the last paint only, on the backing store of the canvas;
+    // the whole plot is replotted if anything else changed, nothing is painted if the plot is not on screen
+    void replotNewFrames();
+
     void updateSymbols();
     bool isBarchart() const;
 
@@ -489,11 +630,15 @@ public:
     bool hasMinMaxFormula() const;
 
     const CommonStats* getStats() const;
+
+    // Canvas of the plots created next painted by OpenGL instead of the raster engine, if Qwt is built with it
+    static void setOpenGLCanvas(bool enable);
 Q_SIGNALS:
-    void cursorMoved(const QPointF& point, int index);
+    void cursorMoved(const QPointF& point, qint64 index);
     void visibilityChanged(bool visible);
 
 public Q_SLOTS:
+    virtual void replot() override;
     void initYAxis();
     void setBarchart(bool value);
     void loadYAxisMinMaxMode(); // default or from settings
@@ -509,14 +654,22 @@ private:
     YMinMaxMode             m_yminMaxMode { MinMaxOfThePlot };
     double                  m_customYMin { 0.0 };
     double                  m_customYMax { 0.0 };
-    QJSValue                m_maxValue;
-    QJSValue                m_minValue;
-    QJSEngine               m_engine;
+    double                  m_maxValue { 0.0 };         // Axis bounds from the formulas of the group, if m_hasMinMaxFormula
+    double                  m_minValue { 0.0 };
+    bool                    m_hasMinMaxFormula { false };
     const size_t            m_streamPos;
     const size_t            m_type;
     const size_t            m_group;
     QVector<QwtPlotCurve*>  m_curves;
     PlotCursor*             m_cursor;
+    QwtPlotDirectPainter*   m_directPainter;
+
+    // What the canvas shows since the last replot(), see replotNewFrames()
+    bool                    m_painted { false };
+    size_t                  m_paintedFrames { 0 };
+    QwtScaleDiv             m_paintedXScaleDiv;
+    QwtScaleDiv             m_paintedYScaleDiv;
+    QSize                   m_paintedCanvasSize;
     QCheckBox*              m_barchartPlotCheckbox;
 
     PlotLegend*             m_plotLegend;
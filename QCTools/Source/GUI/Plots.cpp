@@ -31,7 +31,7 @@
 #include <QPushButton>
 #include <QCheckBox>
 #include <QToolButton>
-#include <QVideoFrame>
+#include <QImage>
 #include <qwt_plot_curve.h>
 #include <QMessageBox>
 #include <QSettings>
@@ -54,6 +54,47 @@ public:
     }
 };
 
+//---------------------------------------------------------------------------
+// Rows of a plot not created yet, hidden
+class PlotPlaceholder: public QWidget
+{
+public:
+    PlotPlaceholder( size_t streamPos, size_t type, size_t group, QWidget* parent ):
+        QWidget( parent ),
+        m_legend( new QWidget( parent ) ),
+        m_streamPos( streamPos ),
+        m_type( type ),
+        m_group( group )
+    {
+        setObjectName( QString( "Placeholder of plot for stream: %1 of type %2, group %3" ).arg( streamPos ).arg( type ).arg( group ) );
+        m_legend->setObjectName( QString( "Legend for %1" ).arg( objectName() ) );
+
+        setVisible( false );
+        m_legend->setVisible( false );
+    }
+
+    QWidget* legend() const { return m_legend; }
+    size_t streamPos() const { return m_streamPos; }
+    size_t type() const { return m_type; }
+    size_t group() const { return m_group; }
+
+private:
+    QWidget* m_legend;
+    size_t m_streamPos;
+    size_t m_type;
+    size_t m_group;
+};
+
+//---------------------------------------------------------------------------
+// Copied, the pixels of the panel frame are released with it
+static QImage toImage(const Thumbnail& panelFrame)
+{
+    if (panelFrame.Rgb.isEmpty())
+        return QImage();
+
+    return QImage((const uchar*) panelFrame.Rgb.constData(), panelFrame.Width, panelFrame.Height, panelFrame.Width * 3, QImage::Format_RGB888).copy();
+}
+
 //---------------------------------------------------------------------------
 void Plots::showEditBarchartProfileDialog(const size_t plotGroup, Plot* plot, const stream_info& streamInfo)
 {
@@ -155,6 +196,7 @@ Plots::Plots( QWidget *parent, FileInformation* fileInformation ) :
 
     // plots and legends
     m_plots = new Plot**[m_fileInfoData->Stats.size()];
+    m_placeholders = new PlotPlaceholder**[m_fileInfoData->Stats.size()];
     m_plotsCount = 0;
     
     for ( size_t streamPos = 0; streamPos < m_fileInfoData->Stats.size(); streamPos++ )
@@ -165,184 +207,33 @@ Plots::Plots( QWidget *parent, FileInformation* fileInformation ) :
             size_t countOfGroups = PerStreamType[type].CountOfGroups;
         
             m_plots[streamPos] = new Plot*[countOfGroups + 1]; //+1 for axix
+            m_placeholders[streamPos] = new PlotPlaceholder*[countOfGroups + 1];
     
             for ( size_t group = 0; group < countOfGroups; group++ )
             {
                 if (m_fileInfoData->ActiveFilters[PerStreamType[type].PerGroup[group].ActiveFilterGroup])
                 {
-                    Plot* plot = new Plot( streamPos, type, group, m_fileInfoData, this );
-                    plot->setObjectName(QString("Plot for stream: %1 of type %2, group %3").arg(streamPos).arg(type).arg(group));
-
-                    connect(plot, &Plot::visibilityChanged, [plot](bool visible) {
-                        qDebug() << "Plot::visibilityChanged for " << plot << "visible: " << visible;
-                    });
-
-                    connect(this, &Plots::reloadYAxisMinMaxMode, plot, &Plot::loadYAxisMinMaxMode);
-
-                    const size_t plotType = plot->type();
-                    const size_t plotGroup = plot->group();
-                    const CommonStats* stat = stats( plot->streamPos() );
-
-                    auto streamInfo = PerStreamType[plotType];
-
-                    plot->addGuidelines(m_fileInfoData->BitsPerRawSample());
-
-                    // we allow to shrink the plot below height of the size hint
-                    plot->plotLayout()->setAlignCanvasToScales(false);
-                    plot->setSizePolicy( QSizePolicy::MinimumExpanding, QSizePolicy::Expanding );
-                    plot->setAxisScaleDiv( QwtPlot::xBottom, m_scaleWidget->scaleDiv() );
-                    plot->initYAxis();
-
-                    updateSamples( plot );
-
-                    connect(plot, &Plot::cursorMoved, [this, plot](const QPointF& point, int framePos) {
-
-                        // search for video plot
-                        Plot* videoPlot = nullptr;
-                        if(plot->type() == Type_Audio) {
-                            for ( size_t streamPos = 0; streamPos < m_fileInfoData->Stats.size(); streamPos++ )
-                            {
-                                if (m_fileInfoData->Stats[streamPos] && m_fileInfoData->Stats[streamPos]->Type_Get() == Type_Video);
-                                {
-                                    size_t type = m_fileInfoData->Stats[streamPos]->Type_Get();
-                                    size_t countOfGroups = PerStreamType[type].CountOfGroups;
-                                    for ( size_t group = 0; group < countOfGroups; group++ )
-                                    {
-                                        if (m_fileInfoData->ActiveFilters[PerStreamType[type].PerGroup[group].ActiveFilterGroup]) {
-                                            videoPlot = m_plots[streamPos][group];
-                                            break;
-                                        }
-                                    }
-                                    break;
-                                }
-                            }
-
-                            if(videoPlot)
-                                framePos = videoPlot->frameAt(point.x());
-                        }
-
-                        onCursorMoved(framePos);
-
-                    });
-
-                    plot->canvas()->installEventFilter( this );
-
-                    layout->addWidget( plot, m_plotsCount, 0 );
-                    QVBoxLayout* legendLayout = new QVBoxLayout();
-                    legendLayout->setContentsMargins(5, 0, 5, 0);
-                    legendLayout->setSpacing(10);
-                    legendLayout->setAlignment(Qt::AlignVCenter);
-
-                    QToolButton* barchartConfigButton = new QToolButton();
-                    connect(plot, SIGNAL(visibilityChanged(bool)), barchartConfigButton, SLOT(setVisible(bool)));
-                    connect(barchartConfigButton, &QToolButton::clicked, [=]() {
-                        showEditBarchartProfileDialog(plotGroup, plot, streamInfo);
-                    });
-
-                    QToolButton* barchartPlotSwitch = new QToolButton();
-                    barchartPlotSwitch->setIcon(QIcon(":/icon/bar_chart.png"));
-                    barchartPlotSwitch->setCheckable(true);
+                    // The plot is created when the group is first shown, the placeholders keep its rows
+                    PlotPlaceholder* placeholder = new PlotPlaceholder( streamPos, type, group, this );
+                    layout->addWidget( placeholder, m_plotsCount, 0 );
+                    layout->addWidget( placeholder->legend(), m_plotsCount, 1 );
 
-                    connect(plot, SIGNAL(visibilityChanged(bool)), barchartPlotSwitch, SLOT(setVisible(bool)));
-
-                    QVector<PlotSeriesData*> series;
-                    series.reserve(streamInfo.PerGroup[plotGroup].Count);
-
-                    for(size_t j = 0; j < streamInfo.PerGroup[plotGroup].Count; ++j)
-                    {
-                        size_t yIndex = streamInfo.PerGroup[plotGroup].Start + j;
-
-                        auto seriesData = new PlotSeriesData(stats(plot->streamPos()), plot->getCurve(j)->title().text(), m_fileInfoData->BitsPerRawSample(),
-                                                             m_dataTypeIndex, yIndex, plotGroup, j, streamInfo.PerGroup[plotGroup].Count);
-                        series.append(seriesData);
-                        plot->setData(j, seriesData);
-                    }
-
-                    connect(barchartPlotSwitch, &QToolButton::toggled, [=](bool toggled) {
-
-                        bool switchToBarcharts = toggled;
-                        if(switchToBarcharts) {
-                            bool empty = true;
-                            for(PlotSeriesData* seriesData : series) {
-                                if(!seriesData->conditions().isEmpty()) {
-                                    empty = false;
-                                    break;
-                                }
-                            }
-
-                            if(empty) {
-                                switchToBarcharts = false;
-                                showEditBarchartProfileDialog(plotGroup, plot, streamInfo);
-
-                                for(PlotSeriesData* seriesData : series) {
-                                    if(!seriesData->conditions().isEmpty()) {
-                                        switchToBarcharts = true;
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-
-                        if(switchToBarcharts != toggled) {
-                            barchartPlotSwitch->blockSignals(true);
-                            barchartPlotSwitch->setChecked(switchToBarcharts);
-                            barchartPlotSwitch->blockSignals(false);
-                        }
-
-                        for(auto& seriesData : series) {
-                            seriesData->setBarchart(switchToBarcharts);
-                        }
-
-                        plot->setBarchart(switchToBarcharts);
-                        barchartPlotSwitch->setIcon(switchToBarcharts ? QIcon(":/icon/chart_chart.png") : QIcon(":/icon/bar_chart.png"));
-                    });
-
-                    QToolButton* yMinMaxConfigButton = new QToolButton();
-                    yMinMaxConfigButton->setIcon(QIcon(":/icon/signalserver_upload.png"));
-                    connect(plot, SIGNAL(visibilityChanged(bool)), yMinMaxConfigButton, SLOT(setVisible(bool)));
-                    connect(yMinMaxConfigButton, &QToolButton::clicked, [=]() {
-                        showYMinMaxConfigDialog(plotGroup, plot, streamInfo, yMinMaxConfigButton);
-                    });
-
-                    QHBoxLayout* barchartAndConfigurationLayout = new QHBoxLayout();
-                    barchartAndConfigurationLayout->setAlignment(Qt::AlignLeft);
-                    barchartAndConfigurationLayout->setSpacing(5);
-                    barchartAndConfigurationLayout->addWidget(barchartPlotSwitch);
-                    barchartAndConfigurationLayout->addWidget(barchartConfigButton);
-                    barchartAndConfigurationLayout->addWidget(yMinMaxConfigButton);
-
-                    legendLayout->addItem(barchartAndConfigurationLayout);
-                    legendLayout->addWidget(plot->plotLegend());
-
-                    QWidget* legendContainer = new QFrame();
-                    plot->plotLegend()->setParent(legendContainer);
-                    legendContainer->setContentsMargins(0, 0, 0, 0);
-                    legendContainer->setLayout(legendLayout);
-
-                    layout->addWidget(legendContainer, m_plotsCount, 1);
-
-                    int height = barchartPlotSwitch->sizeHint().height();
-                    barchartConfigButton->setIcon(QIcon(":/icon/settings.png"));
-                    barchartConfigButton->setMaximumSize(QSize(height, height));
-
-                    plot->setLegend(legendContainer);
-                    plot->legend()->setObjectName(QString("Legend for %1").arg(plot->objectName()));
-
-                    m_plots[streamPos][group] = plot;
+                    m_placeholders[streamPos][group] = placeholder;
+                    m_plots[streamPos][group] = NULL;
 
                     m_plotsCount++;
-
-                    qDebug() << "created plot with group: " << plot->group() << ", type: " << plot->type() << ", m_plotsCount: " << m_plotsCount;
                 }
                 else
                 {
                     m_plots[streamPos][group] = NULL;
+                    m_placeholders[streamPos][group] = NULL;
                 }
             }
         }
         else
         {
             m_plots[streamPos]=NULL;
+            m_placeholders[streamPos]=NULL;
         }
     }
 
@@ -352,7 +243,7 @@ Plots::Plots( QWidget *parent, FileInformation* fileInformation ) :
     m_commentsPlot->setSizePolicy( QSizePolicy::MinimumExpanding, QSizePolicy::Expanding );
     m_commentsPlot->setAxisScaleDiv( QwtPlot::xBottom, m_scaleWidget->scaleDiv() );
 
-    connect( m_commentsPlot, SIGNAL( cursorMoved( int ) ), SLOT( onCursorMoved( int ) ) );
+    connect( m_commentsPlot, SIGNAL( cursorMoved( qint64 ) ), SLOT( onCursorMoved( qint64 ) ) );
     m_commentsPlot->canvas()->installEventFilter( this );
 
     if(m_commentsPlot)
@@ -451,7 +342,7 @@ Plots::Plots( QWidget *parent, FileInformation* fileInformation ) :
             m_PanelsView->setVisible(false);
             m_PanelsView->legend()->setVisible(false);
 
-            connect(m_PanelsView, SIGNAL( cursorMoved( int ) ), SLOT( onCursorMoved( int ) ) );
+            connect(m_PanelsView, SIGNAL( cursorMoved( qint64 ) ), SLOT( onCursorMoved( qint64 ) ) );
             connect(this, &Plots::visibleFramesChanged, m_PanelsView, &PanelsView::setVisibleFrames);
 
             if(isAudioPanel) {
@@ -459,14 +350,7 @@ Plots::Plots( QWidget *parent, FileInformation* fileInformation ) :
                     auto panelsCount = m_fileInfoData->getPanelFramesCount(panelOutputIndex);
                     return panelsCount;
                 }, [&, panelOutputIndex](int index) -> QImage {
-                    auto frame = m_fileInfoData->getPanelFrame(panelOutputIndex, index);
-                    QVideoFrame videoFrame = frame;
-
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-                    auto panelImage = videoFrame.image();
-#else
-                    auto panelImage = videoFrame.toImage();
-#endif //
+                    auto panelImage = toImage(m_fileInfoData->getPanelFrame(panelOutputIndex, index));
 
                     auto frameRate = m_fileInfoData->getAvgVideoFrameRate();
                     if(frameRate.isValid()) {
@@ -480,16 +364,7 @@ Plots::Plots( QWidget *parent, FileInformation* fileInformation ) :
                     auto panelsCount = m_fileInfoData->getPanelFramesCount(panelOutputIndex);
                     return panelsCount;
                 }, [&, panelOutputIndex](int index) -> QImage {
-                    auto frame = m_fileInfoData->getPanelFrame(panelOutputIndex, index);
-
-                    QVideoFrame videoFrame = frame;
-
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-                    auto panelImage = videoFrame.image();
-#else
-                    auto panelImage = videoFrame.toImage();
-#endif //
-                    return panelImage;
+                    return toImage(m_fileInfoData->getPanelFrame(panelOutputIndex, index));
                 });
             }
             m_PanelsView->setVisibleFrames(0, numFrames() - 1);
@@ -524,6 +399,195 @@ Plots::Plots( QWidget *parent, FileInformation* fileInformation ) :
     m_yMinMaxSelector->setWindowFlag(Qt::Popup);
 }
 
+//---------------------------------------------------------------------------
+Plot* Plots::createPlot( size_t streamPos, size_t group )
+{
+    PlotPlaceholder* placeholder = m_placeholders[streamPos][group];
+    size_t type = m_fileInfoData->Stats[streamPos]->Type_Get();
+
+    // Items of a report read when their group is first shown, see FileInformation::LazyItems_Set
+    m_fileInfoData->Stats[streamPos]->Items_Load( group );
+
+    Plot* plot = new Plot( streamPos, type, group, m_fileInfoData, this );
+    plot->setObjectName(QString("Plot for stream: %1 of type %2, group %3").arg(streamPos).arg(type).arg(group));
+
+    connect(plot, &Plot::visibilityChanged, [plot](bool visible) {
+        qDebug() << "Plot::visibilityChanged for " << plot << "visible: " << visible;
+    });
+
+    connect(this, &Plots::reloadYAxisMinMaxMode, plot, &Plot::loadYAxisMinMaxMode);
+
+    const size_t plotType = plot->type();
+    const size_t plotGroup = plot->group();
+    const CommonStats* stat = stats( plot->streamPos() );
+
+    auto streamInfo = PerStreamType[plotType];
+
+    plot->addGuidelines(m_fileInfoData->BitsPerRawSample());
+
+    // we allow to shrink the plot below height of the size hint
+    plot->plotLayout()->setAlignCanvasToScales(false);
+    plot->setSizePolicy( QSizePolicy::MinimumExpanding, QSizePolicy::Expanding );
+    plot->setAxisScaleDiv( QwtPlot::xBottom, m_scaleWidget->scaleDiv() );
+    plot->initYAxis();
+
+    updateSamples( plot );
+
+    connect(plot, &Plot::cursorMoved, [this, plot](const QPointF& point, qint64 framePos) {
+
+        // search for video plot
+        Plot* videoPlot = nullptr;
+        if(plot->type() == Type_Audio) {
+            for ( size_t streamPos = 0; streamPos < m_fileInfoData->Stats.size(); streamPos++ )
+            {
+                if (m_fileInfoData->Stats[streamPos] && m_fileInfoData->Stats[streamPos]->Type_Get() == Type_Video);
+                {
+                    size_t type = m_fileInfoData->Stats[streamPos]->Type_Get();
+                    size_t countOfGroups = PerStreamType[type].CountOfGroups;
+                    for ( size_t group = 0; group < countOfGroups; group++ )
+                    {
+                        if (m_plots[streamPos][group]) {
+                            videoPlot = m_plots[streamPos][group];
+                            break;
+                        }
+                    }
+                    break;
+                }
+            }
+
+            if(videoPlot)
+                framePos = videoPlot->frameAt(point.x());
+        }
+
+        onCursorMoved(framePos);
+
+    });
+
+    plot->canvas()->installEventFilter( this );
+
+    layout()->replaceWidget( placeholder, plot );
+    QVBoxLayout* legendLayout = new QVBoxLayout();
+    legendLayout->setContentsMargins(5, 0, 5, 0);
+    legendLayout->setSpacing(10);
+    legendLayout->setAlignment(Qt::AlignVCenter);
+
+    QToolButton* barchartConfigButton = new QToolButton();
+    connect(plot, SIGNAL(visibilityChanged(bool)), barchartConfigButton, SLOT(setVisible(bool)));
+    connect(barchartConfigButton, &QToolButton::clicked, [=]() {
+        showEditBarchartProfileDialog(plotGroup, plot, streamInfo);
+    });
+
+    QToolButton* barchartPlotSwitch = new QToolButton();
+    barchartPlotSwitch->setIcon(QIcon(":/icon/bar_chart.png"));
+    barchartPlotSwitch->setCheckable(true);
+
+    connect(plot, SIGNAL(visibilityChanged(bool)), barchartPlotSwitch, SLOT(setVisible(bool)));
+
+    QVector<PlotSeriesData*> series;
+    series.reserve(streamInfo.PerGroup[plotGroup].Count);
+
+    for(size_t j = 0; j < streamInfo.PerGroup[plotGroup].Count; ++j)
+    {
+        size_t yIndex = streamInfo.PerGroup[plotGroup].Start + j;
+
+        auto seriesData = new PlotSeriesData(stats(plot->streamPos()), plot->getCurve(j)->title().text(), m_fileInfoData->BitsPerRawSample(),
+                                             m_dataTypeIndex, yIndex, plotGroup, j, streamInfo.PerGroup[plotGroup].Count);
+        series.append(seriesData);
+        plot->setData(j, seriesData);
+    }
+
+    connect(barchartPlotSwitch, &QToolButton::toggled, [=](bool toggled) {
+
+        bool switchToBarcharts = toggled;
+        if(switchToBarcharts) {
+            bool empty = true;
+            for(PlotSeriesData* seriesData : series) {
+                if(!seriesData->conditions().isEmpty()) {
+                    empty = false;
+                    break;
+                }
+            }
+
+            if(empty) {
+                switchToBarcharts = false;
+                showEditBarchartProfileDialog(plotGroup, plot, streamInfo);
+
+                for(PlotSeriesData* seriesData : series) {
+                    if(!seriesData->conditions().isEmpty()) {
+                        switchToBarcharts = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if(switchToBarcharts != toggled) {
+            barchartPlotSwitch->blockSignals(true);
+            barchartPlotSwitch->setChecked(switchToBarcharts);
+            barchartPlotSwitch->blockSignals(false);
+        }
+
+        for(auto& seriesData : series) {
+            seriesData->setBarchart(switchToBarcharts);
+        }
+
+        plot->setBarchart(switchToBarcharts);
+        barchartPlotSwitch->setIcon(switchToBarcharts ? QIcon(":/icon/chart_chart.png") : QIcon(":/icon/bar_chart.png"));
+    });
+
+    QToolButton* yMinMaxConfigButton = new QToolButton();
+    yMinMaxConfigButton->setIcon(QIcon(":/icon/signalserver_upload.png"));
+    connect(plot, SIGNAL(visibilityChanged(bool)), yMinMaxConfigButton, SLOT(setVisible(bool)));
+    connect(yMinMaxConfigButton, &QToolButton::clicked, [=]() {
+        showYMinMaxConfigDialog(plotGroup, plot, streamInfo, yMinMaxConfigButton);
+    });
+
+    QHBoxLayout* barchartAndConfigurationLayout = new QHBoxLayout();
+    barchartAndConfigurationLayout->setAlignment(Qt::AlignLeft);
+    barchartAndConfigurationLayout->setSpacing(5);
+    barchartAndConfigurationLayout->addWidget(barchartPlotSwitch);
+    barchartAndConfigurationLayout->addWidget(barchartConfigButton);
+    barchartAndConfigurationLayout->addWidget(yMinMaxConfigButton);
+
+    legendLayout->addItem(barchartAndConfigurationLayout);
+    legendLayout->addWidget(plot->plotLegend());
+
+    QWidget* legendContainer = new QFrame();
+    plot->plotLegend()->setParent(legendContainer);
+    legendContainer->setContentsMargins(0, 0, 0, 0);
+    legendContainer->setLayout(legendLayout);
+
+    layout()->replaceWidget( placeholder->legend(), legendContainer );
+
+    int height = barchartPlotSwitch->sizeHint().height();
+    barchartConfigButton->setIcon(QIcon(":/icon/settings.png"));
+    barchartConfigButton->setMaximumSize(QSize(height, height));
+
+    plot->setLegend(legendContainer);
+    plot->legend()->setObjectName(QString("Legend for %1").arg(plot->objectName()));
+
+    m_plots[streamPos][group] = plot;
+    m_placeholders[streamPos][group] = NULL;
+    delete placeholder->legend();
+    delete placeholder;
+
+    // State of the other plots
+    plot->setAxisScale( QwtPlot::xBottom, m_timeInterval.from, m_timeInterval.to );
+    plot->setCursorPos( stats( streamPos )->x[m_dataTypeIndex][framePos( streamPos )] );
+    plot->updateSymbols();
+
+    auto profileFormulas = m_barchartsProfile.value("profileFormulas").toArray();
+    for(auto condition : profileFormulas) {
+        auto conditionObject = condition.toObject();
+        if(conditionObject.value("streamPos").toInt() == streamPos && conditionObject.value("plotType").toInt() == type && conditionObject.value("plotGroup").toInt() == group)
+            loadBarchartsProfile(plot, conditionObject.value("plotFormulas").toArray());
+    }
+
+    qDebug() << "created plot with group: " << plot->group() << ", type: " << plot->type();
+
+    return plot;
+}
+
 //---------------------------------------------------------------------------
 Plots::~Plots()
 {
@@ -551,29 +615,25 @@ void Plots::refresh()
             size_t type = m_fileInfoData->Stats[streamPos]->Type_Get();
             for ( int i = 0; i < PerStreamType[type].CountOfGroups; i++ )
                 if (m_plots[streamPos][i] && m_plots[streamPos][i]->isVisible())
-            {
-                m_plots[streamPos][i]->initYAxis();
-                updateSamples( m_plots[streamPos][i] );
-            }
+                    m_plots[streamPos][i]->initYAxis();
         }
 
     for(auto m_PanelsView : m_PanelsViews)
         m_PanelsView->refresh();
 
-    setCursorPos( framePos() );
-    replotAll();
-
+    moveCursor( framePos() );
+    replotNewFrames();
 }
 
 //---------------------------------------------------------------------------
-void Plots::setVisibleFrames( int from, int to , bool force)
+void Plots::setVisibleFrames( qint64 from, qint64 to , bool force)
 {
     if ( from != m_frameInterval.from || to != m_frameInterval.to || force)
     {
         m_frameInterval.from = from;
         m_frameInterval.to = to;
 
-        const double* x = stats()->x[m_dataTypeIndex];
+        const StatsColumn<double>& x = stats()->x[m_dataTypeIndex];
         m_timeInterval.from = x[from];
         m_timeInterval.to = x[to];
 
@@ -600,10 +660,10 @@ void Plots::onCurrentFrameChanged()
 
     if ( isZoomed() )
     {
-        const int n = m_frameInterval.count();
+        const qint64 n = m_frameInterval.count();
 
-        const int from = qBound( 0, framePos() - n / 2, numFrames() - n );
-        const int to = from + n - 1;
+        const qint64 from = qBound<qint64>( 0, framePos() - n / 2, numFrames() - n );
+        const qint64 to = from + n - 1;
 
         if ( from != m_frameInterval.from )
         {
@@ -616,7 +676,17 @@ void Plots::onCurrentFrameChanged()
 }
 
 //---------------------------------------------------------------------------
-void Plots::setCursorPos( int newFramePos )
+void Plots::setCursorPos( qint64 newFramePos )
+{
+    moveCursor( newFramePos );
+
+    // Only the cursors are moved if the visible frames are the same, see PlotCursor
+    if ( m_scaleWidget->scaleDiv() != m_replottedScaleDiv )
+        replotAll();
+}
+
+//---------------------------------------------------------------------------
+void Plots::moveCursor( qint64 newFramePos )
 {
     setFramePos( newFramePos );
 
@@ -642,32 +712,21 @@ void Plots::setCursorPos( int newFramePos )
 
     m_scaleWidget->setScale( m_timeInterval.from, m_timeInterval.to);
     m_scaleWidget->update();
-
-    replotAll();
 }
 
 //---------------------------------------------------------------------------
 void Plots::updateSamples( Plot* plot )
 {
-    const size_t plotType = plot->type();
-    const size_t plotGroup = plot->group();
-    const CommonStats* stat = stats( plot->streamPos() );
-
-    auto streamInfo = PerStreamType[plotType];
-
-    for(auto j = 0; j < streamInfo.PerGroup[plotGroup].Count; ++j)
-    {
-        plot->replot();
-    }
+    plot->replot();
 }
 
 //---------------------------------------------------------------------------
-void Plots::Zoom_Move( int Begin )
+void Plots::Zoom_Move( qint64 Begin )
 {
-    const int n = m_frameInterval.count();
+    const qint64 n = m_frameInterval.count();
 
-    const int from = qMax( Begin, 0 );
-    const int to = qMin( numFrames(), from + n ) - 1;
+    const qint64 from = qMax<qint64>( Begin, 0 );
+    const qint64 to = qMin( numFrames(), from + n ) - 1;
 
     setVisibleFrames( to - n + 1, to );
 
@@ -781,16 +840,14 @@ void showEditFrameCommentsDialog(QWidget* parentWidget, FileInformation* info, C
     {
         if(stats->comments[frameIndex] != nullptr)
         {
-            delete [] stats->comments[frameIndex];
-            stats->comments[frameIndex] = nullptr;
+            stats->Comment_Set(frameIndex, nullptr);
             info->setCommentsUpdated(stats);
         }
     } else // result == QDialog::Accepted
     {
         if(!stats->comments[frameIndex] || strcmp(stats->comments[frameIndex], textValue.toUtf8().constData()) != 0)
         {
-            delete [] stats->comments[frameIndex];
-            stats->comments[frameIndex] = strdup(textValue.toUtf8().constData());
+            stats->Comment_Set(frameIndex, textValue.toUtf8().constData());
             info->setCommentsUpdated(stats);
         }
     }
@@ -925,6 +982,10 @@ void Plots::changeOrder(QList<std::tuple<quint64, quint64>> newOrder)
         if(plot)
             currentOrderedPlotsInfo.push_back(std::make_tuple(plot->group(), plot->type(), plot->streamPos()));
 
+        auto placeholder = dynamic_cast<PlotPlaceholder*> (plotItem->widget());
+        if(placeholder)
+            currentOrderedPlotsInfo.push_back(std::make_tuple(placeholder->group(), placeholder->type(), placeholder->streamPos()));
+
         auto commentsPlot = qobject_cast<CommentsPlot*> (plotItem->widget());
         if(commentsPlot)
             currentOrderedPlotsInfo.push_back(std::make_tuple(0, Type_Comments, 0));
@@ -1131,6 +1192,14 @@ QJsonObject Plots::saveBarchartsProfile()
                     plotObject.insert("plotFormulas", plotFormulas);
                     conditionsArray.append(plotObject);
                 }
+                else if (m_placeholders[streamPos][group]) {
+                    // Not shown since the profile was loaded
+                    for(auto condition : m_barchartsProfile.value("profileFormulas").toArray()) {
+                        auto conditionObject = condition.toObject();
+                        if(conditionObject.value("streamPos").toInt() == streamPos && conditionObject.value("plotType").toInt() == type && conditionObject.value("plotGroup").toInt() == group)
+                            conditionsArray.append(conditionObject);
+                    }
+                }
         }
     }
 
@@ -1142,6 +1211,9 @@ void Plots::loadBarchartsProfile(const QJsonObject& profile)
 {
     QJsonArray conditions = profile.value("profileFormulas").toArray();
 
+    // Plots created afterwards get their conditions from it
+    m_barchartsProfile = profile;
+
     for ( size_t streamPos = 0; streamPos < m_fileInfoData->Stats.size(); streamPos++ )
     {
         if ( m_fileInfoData->Stats[streamPos] && m_plots[streamPos] ) {
@@ -1176,35 +1248,37 @@ void Plots::loadBarchartsProfile(const QJsonObject& profile)
 
         if(streamPos < m_fileInfoData->Stats.size() && m_fileInfoData->Stats[streamPos] && m_plots[streamPos]) {
             if(plotType == m_fileInfoData->Stats[streamPos]->Type_Get() && plotGroup < PerStreamType[plotType].CountOfGroups) {
-                if (m_plots[streamPos][plotGroup]) {
-                    auto plot = m_plots[streamPos][plotGroup];
-
-                    for(auto plotCondition : plotFormulas) {
-                        auto plotConditionObject = plotCondition.toObject();
-
-                        auto curveIndex = plotConditionObject.value("chartIndex").toInt();
-                        if(curveIndex < plot->curvesCount()) {
-                            auto curveData = plot->getData(curveIndex);
-                            auto formulas = plotConditionObject.value("formulas").toArray();
-
-                            for(auto formula : formulas) {
-                                auto formulaObject = formula.toObject();
-                                auto value = formulaObject.value("value").toString();
-                                auto color = QColor(formulaObject.value("color").toString());
-                                auto label = formulaObject.value("label").toString();
-                                auto eliminateSpikes = formulaObject.value("eliminateSpikes").toBool();
-
-                                curveData->mutableConditions().add(value, color, label, eliminateSpikes);
-                            }
-                        }
-                    }
+                if (m_plots[streamPos][plotGroup])
+                    loadBarchartsProfile(m_plots[streamPos][plotGroup], plotFormulas);
+            }
+        }
+    }
+}
 
-                    if(plot->isBarchart())
-                        plot->replot();
-                }
+void Plots::loadBarchartsProfile(Plot* plot, const QJsonArray& plotFormulas)
+{
+    for(auto plotCondition : plotFormulas) {
+        auto plotConditionObject = plotCondition.toObject();
+
+        auto curveIndex = plotConditionObject.value("chartIndex").toInt();
+        if(curveIndex < plot->curvesCount()) {
+            auto curveData = plot->getData(curveIndex);
+            auto formulas = plotConditionObject.value("formulas").toArray();
+
+            for(auto formula : formulas) {
+                auto formulaObject = formula.toObject();
+                auto value = formulaObject.value("value").toString();
+                auto color = QColor(formulaObject.value("color").toString());
+                auto label = formulaObject.value("label").toString();
+                auto eliminateSpikes = formulaObject.value("eliminateSpikes").toBool();
+
+                curveData->mutableConditions().add(value, color, label, eliminateSpikes);
             }
         }
     }
+
+    if(plot->isBarchart())
+        plot->replot();
 }
 
 void Plots::alignXAxis( const QwtPlot* plot )
@@ -1224,7 +1298,7 @@ void Plots::alignXAxis( const QwtPlot* plot )
 }
 
 //---------------------------------------------------------------------------
-void Plots::onCursorMoved( int framePos )
+void Plots::onCursorMoved( qint64 framePos )
 {
     m_fileInfoData->Frames_Pos_Set( framePos );
     setCursorPos( framePos );
@@ -1273,15 +1347,27 @@ void Plots::onXAxisFormatChanged( int format )
 //---------------------------------------------------------------------------
 void Plots::setPlotVisible( size_t type, size_t group, bool on )
 {
+    bool created = false;
     for ( size_t streamPos = 0; streamPos < m_fileInfoData->Stats.size(); streamPos++ )
         if ( m_fileInfoData->Stats[streamPos] && m_plots[streamPos] )
         {
-            if ( type == m_fileInfoData->Stats[streamPos]->Type_Get() && m_plots[streamPos] && m_plots[streamPos][group] && on != m_plots[streamPos][group]->isVisibleTo( this ))
+            // Plots are created when first shown, and kept hidden afterwards
+            if ( on && type == m_fileInfoData->Stats[streamPos]->Type_Get() && m_placeholders[streamPos][group] )
+            {
+                Plot* plot = createPlot( streamPos, group );
+                plot->setVisible( true );
+                plot->legend()->setVisible( true );
+                created = true;
+            }
+            else if ( type == m_fileInfoData->Stats[streamPos]->Type_Get() && m_plots[streamPos] && m_plots[streamPos][group] && on != m_plots[streamPos][group]->isVisibleTo( this ))
             {
                 m_plots[streamPos][group]->setVisible( on );
                 m_plots[streamPos][group]->legend()->setVisible( on );
             }
         }
+
+    if ( created )
+        alignYAxes();
 }
 
 void Plots::setCommentsVisible(bool visible)
@@ -1376,7 +1462,7 @@ void Plots::zoomXAxis( ZoomTypes zoomType )
         m_zoomFactor = 0;
 
     qDebug() << "m_zoomFactor: " << m_zoomFactor;
-    int numVisibleFrames = m_fileInfoData->Frames_Count_Get() >> m_zoomFactor;
+    qint64 numVisibleFrames = m_fileInfoData->Frames_Count_Get() >> m_zoomFactor;
 
     if(m_zoomType == ZoomOneToOne)
     {
@@ -1384,8 +1470,8 @@ void Plots::zoomXAxis( ZoomTypes zoomType )
         m_zoomFactor = log(double(m_fileInfoData->Frames_Count_Get()) / numVisibleFrames) / log(2);
     }
 
-    int to = qMin( framePos() + numVisibleFrames / 2, numFrames() );
-    int from = qMax( 0, to - numVisibleFrames );
+    qint64 to = qMin( framePos() + numVisibleFrames / 2, numFrames() );
+    qint64 from = qMax<qint64>( 0, to - numVisibleFrames );
     if ( to - from < numVisibleFrames)
         to = from + numVisibleFrames;
 
@@ -1424,6 +1510,8 @@ bool Plots::isZoomed() const
 //---------------------------------------------------------------------------
 void Plots::replotAll()
 {
+    m_replottedScaleDiv = m_scaleWidget->scaleDiv();
+
     for ( size_t streamPos = 0; streamPos < m_fileInfoData->Stats.size(); streamPos++ )
         if ( m_fileInfoData->Stats[streamPos] && m_plots[streamPos] )
         {
@@ -1449,3 +1537,26 @@ void Plots::replotAll()
         panel->refresh();
     }
 }
+
+//---------------------------------------------------------------------------
+void Plots::replotNewFrames()
+{
+    for ( size_t streamPos = 0; streamPos < m_fileInfoData->Stats.size(); streamPos++ )
+        if ( m_fileInfoData->Stats[streamPos] && m_plots[streamPos] )
+        {
+            size_t type = m_fileInfoData->Stats[streamPos]->Type_Get();
+
+            for ( int group = 0; group < PerStreamType[type].CountOfGroups; group++ )
+                if (m_plots[streamPos][group])
+            {
+                m_plots[streamPos][group]->setAxisScaleDiv( QwtPlot::xBottom, m_scaleWidget->scaleDiv() );
+                m_plots[streamPos][group]->replotNewFrames();
+            }
+        }
+
+    if(m_commentsPlot && m_commentsPlot->isVisible())
+    {
+        m_commentsPlot->setAxisScaleDiv( QwtPlot::xBottom, m_scaleWidget->scaleDiv() );
+        m_commentsPlot->replot();
+    }
+}
@@ -16,10 +16,14 @@
 #include "panelsview.h"
 #include <unordered_set>
 
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QWidget>
+#include <qwt_scale_div.h>
 
 class QwtPlot;
 class Plot;
+class PlotPlaceholder;
 class PlotScaleWidget;
 class PlayerControl;
 class YMinMaxSelector;
@@ -36,13 +40,13 @@ public:
     {
     }
 
-    int count() const
+    qint64 count() const
     {
         return to - from + 1;
     }
 
-    int from;
-    int to;
+    qint64 from;
+    qint64 to;
 };
 
 class TimeInterval
@@ -98,19 +102,19 @@ public:
     void updatePlotsVisibility(const QMap<QString, std::tuple<quint64, quint64>> & visiblePlots);
     void updatePlotsYAxisMinMaxMode();
 
-    const QwtPlot*              plot( size_t streamPos, size_t group ) const;
+    const QwtPlot*              plot( size_t streamPos, size_t group ) const; // NULL if not shown yet
     CommentsPlot*               commentsPlot() const { return m_commentsPlot; }
 
     PanelsView*                 panelsView(size_t index) const { return m_PanelsViews[index]; }
     size_t                      panelsCount() const { return m_PanelsViews.size(); }
 
-    void                        Zoom_Move( int Begin );
+    void                        Zoom_Move( qint64 Begin );
     void                        refresh();
 
     void                        zoomXAxis( ZoomTypes type );
     bool                        isZoomed() const;
     FrameInterval               visibleFrames() const;
-    int                         numFrames() const { return stats()->x_Current_Max; }
+    qint64                      numFrames() const { return stats()->x_Current_Max; }
 
     virtual bool                eventFilter( QObject *, QEvent * );
     void                        changeOrder(QList<std::tuple<quint64, quint64>> filterSelectorsInfo);
@@ -122,33 +126,38 @@ public:
     void showYMinMaxConfigDialog(const size_t plotGroup, Plot* plot, const stream_info& streamInfo, QToolButton* button);
 
 Q_SIGNALS:
-    void visibleFramesChanged(int from, int to);
+    void visibleFramesChanged(qint64 from, qint64 to);
     void                        barchartProfileChanged();
     void reloadYAxisMinMaxMode();
 
 public Q_SLOTS:
     void                        onCurrentFrameChanged();
     void                        alignYAxes();
-    void                        setCursorPos( int framePos );
+    void                        setCursorPos( qint64 framePos );
 
 private Q_SLOTS:
-    void                        onCursorMoved( int index );
+    void                        onCursorMoved( qint64 index );
     void                        onXAxisFormatChanged( int index );
 
 private:
     void                        replotAll();
+    void                        replotNewFrames(); // Of the frames parsed since the last call, see Plot::replotNewFrames()
+
+    Plot*                       createPlot( size_t streamPos, size_t group ); // In the rows of its placeholder
+    void                        loadBarchartsProfile( Plot* plot, const QJsonArray& plotFormulas );
 
     void                        initAxisFormat( int index );
     void                        updateSamples( Plot* );
+    void                        moveCursor( qint64 framePos ); // Without replot
 
     void                        alignXAxis( const QwtPlot* );
 
-    void                        setVisibleFrames( int from, int to, bool force = false );
+    void                        setVisibleFrames( qint64 from, qint64 to, bool force = false );
 
     const CommonStats*          stats( size_t statsPos = (size_t)-1 ) const { if ( statsPos == (size_t)-1 ) return m_fileInfoData->ReferenceStat(); else return m_fileInfoData->Stats[statsPos]; }
     CommonStats*                stats( size_t statsPos = (size_t)-1 ) { if ( statsPos == (size_t)-1 ) return m_fileInfoData->ReferenceStat(); else return m_fileInfoData->Stats[statsPos]; }
-    int                         framePos( size_t statsPos = (size_t)-1 ) const { return m_fileInfoData->Frames_Pos_Get(statsPos); }
-    void                        setFramePos( size_t framePos, size_t statsPos = (size_t)-1 ) const { m_fileInfoData->Frames_Pos_Set(framePos, statsPos); }
+    qint64                      framePos( size_t statsPos = (size_t)-1 ) const { return m_fileInfoData->Frames_Pos_Get(statsPos); }
+    void                        setFramePos( qint64 framePos, size_t statsPos = (size_t)-1 ) const { m_fileInfoData->Frames_Pos_Set(framePos, statsPos); }
 
 private:
     YMinMaxSelector*            m_yMinMaxSelector;
@@ -157,10 +166,13 @@ private:
     std::vector<PanelsView*>    m_PanelsViews;
     PlayerControl*              m_playerControl;
     Plot***                     m_plots; // pointer on an array of streams and groups per stream and Plot* per group
+    PlotPlaceholder***          m_placeholders; // same, until the plot is created
+    QJsonObject                 m_barchartsProfile; // last loaded, for the plots created afterwards
     int                         m_plotsCount;
 
     FrameInterval               m_frameInterval;
     TimeInterval                m_timeInterval;
+    QwtScaleDiv                 m_replottedScaleDiv; // Of the last replotAll()
     int                         m_zoomFactor;
     ZoomTypes                   m_zoomType;
 
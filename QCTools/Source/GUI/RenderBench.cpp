@@ -0,0 +1,221 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "GUI/RenderBench.h"
+#include "GUI/mainwindow.h"
+#include "GUI/Plot.h"
+#include "GUI/Plots.h"
+#include "GUI/TinyDisplay.h"
+#include "GUI/panelsview.h"
+#include "Core/FileInformation.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+// Zoom levels of the pan and panels interactions, a 16th of the file
+const int PanZoom = 4;
+
+//---------------------------------------------------------------------------
+// Nearest rank, Times sorted
+double percentile(const std::vector<double>& times, double ratio)
+{
+    size_t rank = (size_t)std::ceil(ratio * times.size());
+    return times[std::min(times.size() - 1, rank ? rank - 1 : 0)];
+}
+
+}
+
+//***************************************************************************
+// Constructor/Destructor
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+RenderBench::RenderBench(MainWindow* window, int steps, const QString& output)
+: QObject(window)
+, Window(window)
+, Steps(std::max(steps, 2))
+, Output(output)
+, Waited(0)
+{
+    Timer.setInterval(100);
+    connect(&Timer, &QTimer::timeout, this, &RenderBench::waitLoaded);
+}
+
+//---------------------------------------------------------------------------
+void RenderBench::start()
+{
+    Timer.start();
+}
+
+//---------------------------------------------------------------------------
+void RenderBench::waitLoaded()
+{
+    Waited++;
+    auto file = Window->getCurrenFileInformation();
+    if (!file || !file->parsed() || !Window->PlotsArea || !Window->TinyDisplayArea)
+    {
+        // Not opened (not a report or a media file) once the opening is done
+        if (Window->Files.empty() && Window->FilesOpening.empty() && Waited > 10)
+        {
+            Timer.stop();
+            std::cerr << "render-bench: no file opened" << std::endl;
+            QCoreApplication::exit(1);
+        }
+        return;
+    }
+
+    Timer.stop();
+    run();
+    QCoreApplication::exit(write());
+}
+
+//***************************************************************************
+// Interactions
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void RenderBench::run()
+{
+    auto file = Window->getCurrenFileInformation();
+    auto plots = Window->PlotsArea;
+    plots->show();
+    Window->TinyDisplayArea->show();
+    QApplication::processEvents();
+
+    const qint64 frames = plots->numFrames();
+    auto position = [&](int step, qint64 count) {
+        return count > 1 ? (qint64)step * (count - 1) / (Steps - 1) : 0;
+    };
+
+    // In as long as the plots are zoomable then out back to the whole file
+    bool zoomIn = true;
+    measure("zoom", [&](int) {
+        if (zoomIn && plots->visibleFrames().count() <= 4)
+            zoomIn = false;
+        else if (!zoomIn && !plots->isZoomed())
+            zoomIn = true;
+        if (zoomIn)
+            Window->Zoom_In();
+        else
+            Window->Zoom_Out();
+    });
+    plots->zoomXAxis(Plots::ZoomOneToOne);
+
+    // Cursor moved frame by frame, plots cursors and thumbnails updated
+    measure("scrub", [&](int step) {
+        file->Frames_Pos_Set(std::min<qint64>(frames / 2 + step, frames - 1));
+    });
+
+    // Cursor moved across the whole file, thumbnails not cached
+    measure("seek", [&](int step) {
+        file->Frames_Pos_Set(position(step, frames));
+    });
+    file->Frames_Pos_Set(0);
+
+    // Barcharts toggled one plot at a time, then back
+    auto charts = plots->findChildren<Plot*>();
+    std::vector<bool> barcharts;
+    for (auto chart : charts)
+        barcharts.push_back(chart->isBarchart());
+    if (!charts.empty())
+        measure("barchart", [&](int step) {
+            auto chart = charts[step % charts.size()];
+            chart->setBarchart(!chart->isBarchart());
+        });
+    for (int i = 0; i < charts.size(); ++i)
+        charts[i]->setBarchart(barcharts[i]);
+
+    // Zoomed view moved from the start to the end of the file
+    for (int i = 0; i < PanZoom && plots->visibleFrames().count() > 4; ++i)
+        Window->Zoom_In();
+    const qint64 visible = plots->visibleFrames().count();
+    measure("pan", [&](int step) {
+        Window->Zoom_Move(position(step, frames - visible + 1));
+    });
+
+    // Panels alone scrolled over the same window
+    if (plots->panelsCount())
+        measure("panels", [&](int step) {
+            qint64 from = position(step, frames - visible + 1);
+            for (size_t i = 0; i < plots->panelsCount(); ++i)
+                plots->panelsView(i)->setVisibleFrames(from, from + visible - 1);
+        });
+}
+
+//---------------------------------------------------------------------------
+void RenderBench::measure(const char* name, const std::function<void(int)>& step)
+{
+    std::vector<double> times;
+    QElapsedTimer timer;
+    for (int i = 0; i < Steps; ++i)
+    {
+        timer.start();
+        step(i);
+        Window->repaint();
+        QApplication::processEvents();
+        times.push_back(timer.nsecsElapsed() / 1e6);
+    }
+
+    double total = 0;
+    for (auto time : times)
+        total += time;
+    std::sort(times.begin(), times.end());
+
+    Results.append(QJsonObject {
+        {"interaction", name},
+        {"steps", Steps},
+        {"mean_ms", total / Steps},
+        {"p50_ms", percentile(times, 0.50)},
+        {"p90_ms", percentile(times, 0.90)},
+        {"p99_ms", percentile(times, 0.99)},
+        {"max_ms", times.back()},
+    });
+    std::cerr << name << ": p50 " << percentile(times, 0.50) << " ms, p99 " << percentile(times, 0.99) << " ms" << std::endl;
+}
+
+//---------------------------------------------------------------------------
+int RenderBench::write()
+{
+    auto file = Window->getCurrenFileInformation();
+    QJsonObject document {
+        {"qt", qVersion()},
+        {"os", QSysInfo::prettyProductName()},
+        {"cpu", QSysInfo::currentCpuArchitecture()},
+        {"platform", QApplication::platformName()},
+        {"file", file->fileName()},
+        {"frames", Window->PlotsArea->numFrames()},
+        {"width", Window->width()},
+        {"height", Window->height()},
+        {"results", Results},
+    };
+    auto json = QJsonDocument(document).toJson();
+    if (Output.isEmpty())
+    {
+        std::cout << json.constData();
+        return 0;
+    }
+
+    QFile output(Output);
+    if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size())
+    {
+        std::cerr << Output.toStdString() << " can not be written" << std::endl;
+        return 1;
+    }
+    return 0;
+}
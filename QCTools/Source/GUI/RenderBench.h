@@ -0,0 +1,59 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef RenderBenchH
+#define RenderBenchH
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#include <QJsonArray>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <functional>
+
+class MainWindow;
+//---------------------------------------------------------------------------
+
+//***************************************************************************
+// Frame times of the stats views (--render-bench): once the report opened in
+// the main window is loaded, scripted interactions are run on Plots,
+// PanelsView and TinyDisplay, each step being the change then the repaint of
+// the window. The percentiles of the steps of each interaction are written as
+// JSON and the application quits. Run with the offscreen platform, so the
+// times do not depend on a display.
+//***************************************************************************
+
+class RenderBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Constructor/Destructor
+    RenderBench (MainWindow* window, int steps, const QString& output);
+
+    // Waits for the report then runs the interactions
+    void start ();
+
+private Q_SLOTS:
+    void waitLoaded();
+
+private:
+    void run();
+    // Step is called Steps times, with its index
+    void measure(const char* name, const std::function<void(int)>& step);
+    int write();
+
+    MainWindow* Window;
+    int Steps;
+    QString Output;
+    QTimer Timer;
+    int Waited;
+    QJsonArray Results;
+};
+
+#endif
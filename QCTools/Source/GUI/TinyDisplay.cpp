@@ -15,13 +15,34 @@
 #include <QToolButton>
 #include <QLabel>
 #include <QApplication>
+#include <QImage>
+#include <QPixmap>
+#include <QRunnable>
 #include <QVector>
+#include <functional>
+
+namespace {
+
+class PrefetchTask : public QRunnable
+{
+public:
+    explicit PrefetchTask(const std::function<void()>& function) : m_function(function) {}
+    void run() override { m_function(); }
+
+private:
+    std::function<void()> m_function;
+};
+
+}
 
 TinyDisplay::TinyDisplay(QWidget *parent, FileInformation* FileInformationData_)
     : QWidget(parent),
       lastWidth(0),
+      pixmaps(CACHED_THUMBS),
       FileInfoData(FileInformationData_)
 {
+    prefetchPool.setMaxThreadCount(1);
+
     needsUpdate = true;
     lastFramePos = 0;
 
@@ -41,6 +62,9 @@ TinyDisplay::TinyDisplay(QWidget *parent, FileInformation* FileInformationData_)
 
 TinyDisplay::~TinyDisplay()
 {
+    prefetchPool.clear();
+    prefetchPool.waitForDone();
+
     while (!thumbnails.empty()) {
         QToolButton *t = thumbnails.takeLast();
         delete t;
@@ -133,18 +157,57 @@ QPixmap toPixmap(const QByteArray& bytes)
     return pixmap;
 }
 
-QPixmap toPixmap(QAVVideoFrame frame) {
-#if QT_VERSION > QT_VERSION_CHECK(6, 0, 0)
-    QVideoFrame vf = frame;
-    QImage img = vf.toImage();
-#elif QT_VERSION > QT_VERSION_CHECK(5, 13, 0)
-    QVideoFrame vf = frame;
-    QImage img = vf.image();
-#else
-    QImage img(frame.frame()->data[0], frame.frame()->width, frame.frame()->height, frame.frame()->linesize[0], QImage::Format_RGB888);
-#endif //
-
-    return QPixmap::fromImage(img);
+// Thumbnails are 72x72, bigger images are cropped
+static QImage toImage(const Thumbnail& thumbnail) {
+    if (thumbnail.Rgb.isEmpty())
+        return QImage();
+
+    QImage img((const uchar*) thumbnail.Rgb.constData(), thumbnail.Width, thumbnail.Height, thumbnail.Width * 3, QImage::Format_RGB888);
+    if (img.width() == 72 && img.height() == 72)
+        return img.copy();
+    return img.copy(0, 0, 72, 72);
+}
+
+QPixmap TinyDisplay::thumbnail(unsigned long framePos)
+{
+    if (QPixmap* pixmap = pixmaps.object(framePos))
+        return *pixmap;
+
+    auto frameThumbnail = FileInfoData->getThumbnail(framePos);
+    QImage image = toImage(frameThumbnail);
+    if (image.isNull())
+        return QPixmap();
+
+    // Preview of a frame not parsed yet, replaced once parsed
+    if (frameThumbnail.IsApproximate)
+        return QPixmap::fromImage(image);
+
+    QPixmap* pixmap = new QPixmap(QPixmap::fromImage(image));
+    pixmaps.insert(framePos, pixmap);
+    return *pixmap;
+}
+
+void TinyDisplay::prefetch(unsigned long from, unsigned long to)
+{
+    for (unsigned long framePos = from; framePos < to; ++framePos) {
+        if (pixmaps.contains(framePos) || prefetching.contains(framePos))
+            continue;
+
+        // Converted to an image by the worker, a pixmap is made by the GUI thread only
+        prefetching.insert(framePos);
+        prefetchPool.start(new PrefetchTask([this, framePos] {
+            auto frameThumbnail = FileInfoData->getThumbnail(framePos);
+            QImage image = frameThumbnail.IsApproximate ? QImage() : toImage(frameThumbnail);
+            QMetaObject::invokeMethod(this, "thumbnailConverted", Qt::QueuedConnection, Q_ARG(ulong, framePos), Q_ARG(QImage, image));
+        }));
+    }
+}
+
+void TinyDisplay::thumbnailConverted(ulong framePos, const QImage& image)
+{
+    prefetching.remove(framePos);
+    if (!image.isNull() && !pixmaps.contains(framePos))
+        pixmaps.insert(framePos, new QPixmap(QPixmap::fromImage(image)));
 }
 
 void TinyDisplay::Update(bool updateBigDisplay)
@@ -165,7 +228,7 @@ void TinyDisplay::Update(bool updateBigDisplay)
     unsigned long currentFrame = FileInfoData->Frames_Pos_Get();
 
     // current frame positions in the movie
-    unsigned long current = FileInfoData->ReferenceStat()->x_Current;
+    unsigned long current = FileInfoData->ReferenceStat()->x_Current_Get();
     unsigned long current_max = FileInfoData->ReferenceStat()->x_Current_Max;
 
     // do we need to update thumbnails?
@@ -179,42 +242,23 @@ void TinyDisplay::Update(bool updateBigDisplay)
         unsigned long total_thumbs = thumbnails.size();
         unsigned int center = total_thumbs / 2;
 
-        if (needsUpdate || framePos > lastFramePos) {
-            // movie is moving forward
-            unsigned long diff = framePos - lastFramePos;
-            for (unsigned i = 0; i < total_thumbs; ++i) {
-                if (framePos + i >= center && framePos - center + i < current) {
-                    if (!needsUpdate && (diff < total_thumbs && i < total_thumbs - diff)) {
-                        thumbnails[i]->setIcon(thumbnails[i+diff]->icon());
-                    } else {
-                        QPixmap pixmap = toPixmap(FileInfoData->getThumbnail(framePos - center + i));
-                        thumbnails[i]->setIcon(pixmap.copy(0, 0, 72, 72));
-                    }
-                } else {
-                    thumbnails[i]->setIcon(emptyPixmap);
-                    needsUpdate = true;
-                }
-            }
-
-        } else {
-            // movie is moving backward
-            unsigned long diff = lastFramePos - framePos;
-            for (int i = total_thumbs - 1; i >= 0; --i) {
-                unsigned ui = (unsigned) i;
-                if (framePos + ui >= center && framePos - center + ui < current) {
-                    if (diff < total_thumbs && i - (int) diff >= 0) {
-                        thumbnails[ui]->setIcon(thumbnails[ui-diff]->icon());
-					} else {
-                        QPixmap pixmap = toPixmap(FileInfoData->getThumbnail(framePos - center + ui));
-                        thumbnails[ui]->setIcon(pixmap.copy(0, 0, 72, 72));
-					}
-                } else {
-                    thumbnails[ui]->setIcon(emptyPixmap);
-                    needsUpdate = true;
-                }
+        for (unsigned i = 0; i < total_thumbs; ++i) {
+            if (framePos + i >= center && framePos - center + i < current) {
+                thumbnails[i]->setIcon(thumbnail(framePos - center + i));
+            } else {
+                thumbnails[i]->setIcon(emptyPixmap);
+                needsUpdate = true;
             }
         }
 
+        // Next and previous pages, stale requests of a fast scrub are dropped
+        prefetchPool.clear();
+        prefetching.clear();
+        unsigned long first = framePos >= center ? framePos - center : 0;
+        unsigned long last = qMin<unsigned long>(framePos - center + total_thumbs, current);
+        prefetch(last, qMin<unsigned long>(last + total_thumbs, current));
+        prefetch(first >= total_thumbs ? first - total_thumbs : 0, first);
+
         lastFramePos = framePos;
 
         // This assures that if the thumbs are not yet available due to pre-processing,
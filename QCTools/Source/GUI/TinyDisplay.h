@@ -8,6 +8,11 @@
 #define GUI_TinyDisplay_H
 
 #include <QWidget>
+#include <QCache>
+#include <QImage>
+#include <QPixmap>
+#include <QSet>
+#include <QThreadPool>
 #include <QVector>
 #include <QResizeEvent>
 
@@ -40,6 +45,7 @@ private:
     static const int            TOTAL_THUMBS = 9;
     static const int            THUMB_WIDTH = 84;
     static const int            THUMB_HEIGHT = 84;
+    static const int            CACHED_THUMBS = 256;
 
     QPixmap                     emptyPixmap;
     QPixmap                     scaledLogo;
@@ -48,6 +54,14 @@ private:
 
     QHBoxLayout*                Layout;
 
+    // Pixmaps of the thumbnails around the current frame, the ones of the next and previous pages are converted in advance by a worker
+    QPixmap                     thumbnail(unsigned long framePos);
+    void                        prefetch(unsigned long from, unsigned long to);
+
+    QCache<unsigned long, QPixmap> pixmaps;
+    QThreadPool                 prefetchPool;
+    QSet<unsigned long>         prefetching;
+
 protected:
     FileInformation*            FileInfoData;
 
@@ -65,6 +79,7 @@ Q_SIGNALS:
 private Q_SLOTS:
     void                        thumbsLayoutResized();
     void                        on_thumbnails_clicked(bool checked);
+    void                        thumbnailConverted(ulong framePos, const QImage& image);
 };
 
 #endif
@@ -41,7 +41,7 @@ void BarchartConditionEditor::setDefaultColor(const QColor &color)
     getCondition(0)->setColor(m_defaultColor);
 }
 
-QCompleter* BarchartConditionEditor::makeCompleter(QJSEngine& engine)
+QCompleter* BarchartConditionEditor::makeCompleter(const QList<QPair<QString, QString>>& words)
 {
     class CompleterModel : public QStandardItemModel {
     public:
@@ -75,7 +75,6 @@ QCompleter* BarchartConditionEditor::makeCompleter(QJSEngine& engine)
     QCompleter *completer = new QCompleter(this);
     CompleterModel* model = new CompleterModel(completer);
 
-    CompleterModel::Words words = engine.property("autocomplete").value<CompleterModel::Words>();
     model->setWords(words);
 
     completer->setModel(model);
@@ -88,9 +87,9 @@ void BarchartConditionEditor::setConditions(const PlotSeriesData::Conditions &va
 {
     auto condition = getCondition(0);
     Q_ASSERT(condition);
-    condition->setJsEngine(&value.m_engine);
+    condition->setConditions(&value);
 
-    auto completer = makeCompleter(value.m_engine);
+    auto completer = makeCompleter(value.m_autocomplete);
 
     if(value.m_items.size() == 0)
     {
@@ -123,7 +122,7 @@ void BarchartConditionEditor::setConditions(const PlotSeriesData::Conditions &va
             auto condition = getCondition(i);
             Q_ASSERT(condition);
 
-            condition->setJsEngine(&value.m_engine);
+            condition->setConditions(&value);
             condition->setCompleter(completer);
             condition->setColor(value.m_items[i].m_color);
             condition->setName(value.m_items[i].m_label);
@@ -136,10 +135,10 @@ void BarchartConditionEditor::setConditions(const PlotSeriesData::Conditions &va
 void BarchartConditionEditor::onConditionsUpdated()
 {
     Q_ASSERT(getCondition(0));
-    if(!getCondition(0)->getJsEngine())
+    if(!getCondition(0)->getConditions())
         return;
 
-    auto completer = makeCompleter(*getCondition(0)->getJsEngine());
+    auto completer = makeCompleter(getCondition(0)->getConditions()->m_autocomplete);
     for(auto i = 0; i < conditionsCount(); ++i)
     {
         getCondition(i)->setCompleter(completer);
@@ -154,7 +153,7 @@ void BarchartConditionEditor::addCondition()
     }
 
     auto input = new BarchartConditionInput();
-    input->setJsEngine(getCondition(0)->getJsEngine());
+    input->setConditions(getCondition(0)->getConditions());
     input->setCompleter(getCondition(0)->getCompleter());
     input->setColor(m_defaultColor);
     ui->verticalLayout->insertWidget(index + 1, input);
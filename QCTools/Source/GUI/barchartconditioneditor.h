@@ -28,7 +28,7 @@ public:
     void setDefaultColor(const QColor& color);
     void setConditions(const PlotSeriesData::Conditions& value);
 
-    QCompleter* makeCompleter(QJSEngine& engine);
+    QCompleter* makeCompleter(const QList<QPair<QString, QString>>& words);
 
 public Q_SLOTS:
     void onConditionsUpdated();
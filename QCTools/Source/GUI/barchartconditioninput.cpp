@@ -1,5 +1,6 @@
 #include "GUI/barchartconditioninput.h"
 #include "ui_barchartconditioninput.h"
+#include "Core/ConditionExpression.h"
 #include <QColorDialog>
 #include <QJSValueList>
 #include <QList>
@@ -9,7 +10,7 @@
 BarchartConditionInput::BarchartConditionInput(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::BarchartConditionInput),
-    m_engine(nullptr)
+    m_conditions(nullptr)
 {
     ui->setupUi(this);
 
@@ -27,7 +28,7 @@ BarchartConditionInput::BarchartConditionInput(QWidget *parent) :
     m_validationTimer.setInterval(500);
 
     connect(&m_validationTimer, &QTimer::timeout, [&] {
-            assert(m_engine);
+            assert(m_conditions);
 
             QColor color;
             if(ui->condition_lineEdit->text().isEmpty())
@@ -35,9 +36,20 @@ BarchartConditionInput::BarchartConditionInput(QWidget *parent) :
                 color = m_defaultTextColor;
                 ui->condition_lineEdit->setToolTip("No condition\n\n" + getTooltipHelp());
             }
+            else if(ConditionExpression::Compile(ui->condition_lineEdit->text().toStdString(), [this](const std::string& name, double& value) {
+                        auto constant = m_conditions->m_constants.find(name);
+                        if(constant == m_conditions->m_constants.end())
+                            return false;
+                        value = constant->second;
+                        return true;
+                    }))
+            {
+                color = m_validatedTextColor;
+                ui->condition_lineEdit->setToolTip("Success\n\n" + getTooltipHelp());
+            }
             else
             {
-                auto result = PlotSeriesData::Condition::makeConditionFunction(m_engine, ui->condition_lineEdit->text());
+                auto result = PlotSeriesData::makeConditionFunction(m_conditions->m_constants, ui->condition_lineEdit->text());
                 if(result.isError() || !result.isCallable()) {
                     color = m_errorTextColor;
                     ui->condition_lineEdit->setToolTip("Error: " + result.toString());
@@ -113,21 +125,21 @@ QString BarchartConditionInput::getCondition() const
     return ui->condition_lineEdit->text();
 }
 
-void BarchartConditionInput::setJsEngine(QJSEngine *engine)
+void BarchartConditionInput::setConditions(const PlotSeriesData::Conditions *conditions)
 {
-    m_engine = engine;
+    m_conditions = conditions;
 }
 
-QJSEngine *BarchartConditionInput::getJsEngine() const
+const PlotSeriesData::Conditions *BarchartConditionInput::getConditions() const
 {
-    return m_engine;
+    return m_conditions;
 }
 
 void BarchartConditionInput::setCompleter(QCompleter *completer)
 {
-    Q_ASSERT(m_engine);
+    Q_ASSERT(m_conditions);
     ui->condition_lineEdit->setCompleter(completer);
-    m_autocompletion = m_engine->property("autocomplete").value<QList<QPair<QString, QString>>>();
+    m_autocompletion = m_conditions->m_autocomplete;
 }
 
 QCompleter *BarchartConditionInput::getCompleter() const
@@ -33,8 +33,9 @@ public:
     void setCondition(const QString& value);
     QString getCondition() const;
 
-    void setJsEngine(QJSEngine* engine);
-    QJSEngine* getJsEngine() const;
+    // Constants and help of the condition
+    void setConditions(const PlotSeriesData::Conditions* conditions);
+    const PlotSeriesData::Conditions* getConditions() const;
 
     void setCompleter(QCompleter* completer);
     QCompleter* getCompleter() const;
@@ -62,7 +63,7 @@ private:
     Ui::BarchartConditionInput *ui;
 
     QTimer m_validationTimer;
-    QJSEngine* m_engine;
+    const PlotSeriesData::Conditions* m_conditions;
 
     QColor m_defaultTextColor;
     QColor m_validatedTextColor;
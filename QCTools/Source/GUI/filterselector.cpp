@@ -8,6 +8,45 @@
 #include <cmath>
 #include <QStandardItemModel>
 
+namespace
+{
+typedef QPair<QString, int> FilterInfo;
+typedef QList<FilterInfo> FiltersGroup;
+typedef QVector<FiltersGroup> FiltersGroups;
+
+// Filters between separators, sorted by name, computed once for all the selectors
+const FiltersGroups& sortedFiltersGroups()
+{
+    static const FiltersGroups Result = [] {
+        FiltersGroups filtersGroups;
+
+        for (int FilterPos=0; FilterPos<FiltersListDefault_Count; FilterPos++)
+        {
+            const char* filterName = Filters[FilterPos].Name;
+            if (strcmp(filterName, "(Separator)"))
+            {
+                if(filtersGroups.empty())
+                    filtersGroups.push_back(FiltersGroup());
+
+                filtersGroups.back().append(FilterInfo(filterName, FilterPos));
+            }
+            else
+            {
+                filtersGroups.push_back(FiltersGroup());
+            }
+        }
+
+        for(auto& filterGroup : filtersGroups)
+            std::sort(filterGroup.begin(), filterGroup.end(), [](const FilterInfo& i1, const FilterInfo& i2) {
+                return i1.first < i2.first;
+            });
+
+        return filtersGroups;
+    }();
+    return Result;
+}
+}
+
 FilterSelector::FilterSelector(QWidget *parent, const std::function<bool(const char*)>& nameFilter) : QFrame(parent), FileInfoData(nullptr)
 {
     setFrameStyle(QFrame::NoFrame);
@@ -39,52 +78,19 @@ FilterSelector::FilterSelector(QWidget *parent, const std::function<bool(const c
 
     m_filterOptions.FiltersList->setFont(Font);
 
-    typedef QPair<QString, int> FilterInfo;
-    typedef QList<FilterInfo> FiltersGroup;
-    typedef QVector<FiltersGroup> FiltersGroups;
-
-    struct Sort
-    {
-        static bool filterInfoLessThan(const FilterInfo& i1, const FilterInfo& i2)
-        {
-            return i1.first < i2.first;
-        }
-    };
-
-    FiltersGroups filtersGroups;
-
-    for (size_t FilterPos=0; FilterPos<FiltersListDefault_Count; FilterPos++)
-    {
-        const char* filterName = Filters[FilterPos].Name;
-        if (strcmp(filterName, "(Separator)") && strcmp(filterName, "(End)"))
-        {
-            if(filtersGroups.empty())
-                filtersGroups.push_back(FiltersGroup());
-
-            filtersGroups.back().append(FilterInfo(filterName, FilterPos));
-        }
-        else if (strcmp(filterName, "(End)"))
-        {
-            filtersGroups.push_back(FiltersGroup());
-        }
-    }
+    const FiltersGroups& filtersGroups = sortedFiltersGroups();
 
     for(int i = 0; i < filtersGroups.length(); ++i)
     {
-        FiltersGroup & filterGroup = filtersGroups[i];
-        std::sort(filterGroup.begin(), filterGroup.end(), Sort::filterInfoLessThan);
+        const FiltersGroup & filterGroup = filtersGroups[i];
 
         for(FiltersGroup::const_iterator it = filterGroup.cbegin(); it != filterGroup.cend(); ++it)
         {
-            auto first = it->first;
-            auto second = it->second;
-
-            auto filterNameString = first.toStdString();
-            const char* filterName = filterNameString.c_str();
+            const char* filterName = Filters[it->second].Name;
             if(nameFilter && !nameFilter(filterName))
                 continue;
 
-            m_filterOptions.FiltersList->addItem(first, second);
+            m_filterOptions.FiltersList->addItem(it->first, it->second);
         }
 
         if(i != (filtersGroups.length() - 1))
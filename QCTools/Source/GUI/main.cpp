@@ -15,21 +15,41 @@
 
 #include <Core/logging.h>
 #include <Core/Preferences.h>
+#include <Core/StatsProcessParser.h>
+#include <Core/Tracing.h>
 #ifdef __MACOSX__
     #include <ApplicationServices/ApplicationServices.h>
 #endif //__MACOSX__
 
 #include "mainwindow.h"
 #include "config.h"
+#include "RenderBench.h"
 
 int main(int argc, char *argv[])
 {
     qputenv("QT_AVPLAYER_NO_HWDEVICE", "1");
 
+    // Helper process of the parsing, without a display
+    if (argc > 1 && strcmp(argv[1], StatsProcessParser::Worker_Option) == 0)
+    {
+        QCoreApplication app(argc, argv);
+        return StatsProcessParser::Worker(app.arguments().mid(2));
+    }
+
+    // The frame times of the benchmark do not depend on a display
+    bool renderBench = false;
+    for (int Pos=1; Pos<argc; Pos++)
+        if(strcmp(argv[Pos], "--render-bench") == 0)
+            renderBench = true;
+    if (renderBench && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
     QApplication a(argc, argv);
     Logging logging;
 
     QStringList files;
+    QString renderBenchOutput;
+    int renderBenchSteps = 200;
     for (int Pos=1; Pos<argc; Pos++)
     {
         if(strcmp(argv[Pos], "--debug") == 0)
@@ -44,6 +64,17 @@ int main(int argc, char *argv[])
         {
             Preferences().resetSettings();
         }
+        else if(strcmp(argv[Pos], "--render-bench") == 0)
+        {
+        }
+        else if(strcmp(argv[Pos], "--render-bench-output") == 0 && Pos + 1 < argc)
+        {
+            renderBenchOutput = QString::fromLocal8Bit(argv[++Pos]);
+        }
+        else if(strcmp(argv[Pos], "--render-bench-steps") == 0 && Pos + 1 < argc)
+        {
+            renderBenchSteps = atoi(argv[++Pos]);
+        }
         else
         {
             files.append(QString::fromLocal8Bit(argv[Pos]));
@@ -52,23 +83,39 @@ int main(int argc, char *argv[])
         qDebug() << "arg: " << argv[Pos];
     }
 
+    QCTOOLS_TRACE(Category_Startup, "application created at {} ms", Tracing::elapsed());
     MainWindow w(NULL);
+    QCTOOLS_TRACE(Category_Startup, "main window created at {} ms", Tracing::elapsed());
 
     auto screen = QApplication::primaryScreen();
     auto availableGeometry = screen->availableGeometry();
     auto newSize = availableGeometry.size() * 0.95;
     auto newGeometry = QStyle::alignedRect(Qt::LayoutDirectionAuto, Qt::AlignCenter, newSize, availableGeometry);
 
+    // Same window size whatever the screen, for comparable runs
+    if (renderBench)
+        newGeometry = QRect(0, 0, 1920, 1080);
+
     qDebug() << "new size: " << newSize << "availableGeometry: " << availableGeometry << "new geometry: " << newGeometry;
     w.setGeometry(newGeometry);
 
+    if (renderBench && files.size() != 1)
+    {
+        std::cerr << "--render-bench needs one report or media file" << std::endl;
+        return 1;
+    }
+    RenderBench* bench = renderBench ? new RenderBench(&w, renderBenchSteps, renderBenchOutput) : nullptr;
+
     QTimer::singleShot(0, [&]() {
+        QCTOOLS_TRACE(Category_Startup, "main window shown at {} ms", Tracing::elapsed());
         for (auto file : files)
         {
-            w.addFile(file);
+            w.addFile(file, files.size() > 1);
         }
         if (files.size() > 0)
             w.addFile_finish();
+        if (bench)
+            bench->start();
     });
 
     qDebug() << "size: " << w.size() << "pos: " << w.pos();
@@ -10,6 +10,12 @@
 #include "ui_mainwindow.h"
 #include "GUI/Plots.h"
 #include "GUI/preferences.h"
+#include "GUI/ParsingCounters.h"
+#include "GUI/MemoryView.h"
+#include "Core/QCvaultIndex.h"
+#include "Core/RemoteReport.h"
+#include "Core/StatsCompression.h"
+#include "Core/TraceEvents.h"
 
 #include <QFileDialog>
 #include <QScrollBar>
@@ -20,6 +26,7 @@
 #include <QUrl>
 #include <QDropEvent>
 #include <QDragEnterEvent>
+#include <QMouseEvent>
 #include <QMimeData>
 #include <QLabel>
 #include <QToolButton>
@@ -35,6 +42,7 @@
 #include <QClipboard>
 #include <QGuiApplication>
 #include <clocale>
+#include <limits>
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 #include <QDesktopWidget>
@@ -116,6 +124,18 @@ MainWindow::MainWindow(QWidget *parent) :
     // Files
     setFilesCurrentPos((size_t)-1);
 
+    // Export of all the files
+    connect(&m_exportQueue, &ExportQueue::exported, this, [this](FileInformation* file, const QString& fileName) {
+        if(m_qcvaultExports.remove(fileName) && file->parsed())
+            QCvaultIndex::Add(QFileInfo(fileName).dir().absolutePath(), QCvaultIndex::Fingerprint(file->fileName()), file->ActiveFilters & Prefs->ActiveFilters, fileName);
+    });
+    connect(&m_exportQueue, &ExportQueue::queueProgressChanged, this, [this](int done, int total, int percent) {
+        statusBar()->showMessage(QString("Exporting %1 files: %2 done, %3%").arg(total).arg(done).arg(percent));
+    });
+    connect(&m_exportQueue, &ExportQueue::finished, this, [this]() {
+        statusBar()->showMessage("All files exported");
+    });
+
     // Deck
     DeckRunning=false;
 }
@@ -130,6 +150,8 @@ MainWindow::~MainWindow()
     // Files (must be deleted first in order to stop ffmpeg processes)
     for (size_t Pos=0; Pos<Files.size(); Pos++)
         delete Files[Pos];
+    for (size_t Pos=0; Pos<FilesOpening.size(); Pos++)
+        delete FilesOpening[Pos];
 
     // Plots
     delete PlotsArea;
@@ -166,6 +188,24 @@ void MainWindow::on_actionOpen_triggered()
     openFile();
 }
 
+//---------------------------------------------------------------------------
+// Report of a file analyzed by a qcli --serve of another host, read while it is written (see RemoteReport)
+void MainWindow::on_actionOpen_remote_file_triggered()
+{
+    bool ok = false;
+    auto name = QInputDialog::getText(this, tr("Open remote file"), tr("File on the host of a qcli --serve tcp:<port> instance:"),
+                                      QLineEdit::Normal, "qcli://<host>:<port>/<path>", &ok);
+    if(!ok)
+        return;
+    if(!RemoteReport::IsRemote(name))
+    {
+        QMessageBox::warning(this, "Can't open file", QString("%1 is not a qcli://<host>:<port>/<path> name").arg(name));
+        return;
+    }
+    addFile(name);
+    addFile_finish();
+}
+
 //---------------------------------------------------------------------------
 void MainWindow::on_actionClose_triggered()
 {
@@ -247,7 +287,21 @@ void MainWindow::on_actionExport_XmlGz_Prompt_triggered()
     if (getFilesCurrentPos()>=Files.size() || !Files[getFilesCurrentPos()])
         return;
 
-    QString FileName=QFileDialog::getSaveFileName(this, "Export to .qctools.xml.gz", Files[getFilesCurrentPos()]->fileName() + ".qctools.xml.gz", "Statistic files (*.qctools.xml *.qctools.xml.gz *.xml.gz *.xml)", 0);
+    QString FileName=QFileDialog::getSaveFileName(this, "Export to .qctools.xml.gz", Files[getFilesCurrentPos()]->fileName() + ".qctools.xml.gz", "Statistic files (*.qctools.xml *.qctools.xml.gz *.qctools.xml.zst *.xml.gz *.xml)", 0);
+    if (FileName.size()==0)
+        return;
+
+    Files[getFilesCurrentPos()]->Export_XmlGz(FileName, Prefs->ActiveFilters);
+    statusBar()->showMessage("Exported to "+FileName);
+}
+
+//---------------------------------------------------------------------------
+void MainWindow::on_actionExport_Arrow_Prompt_triggered()
+{
+    if (getFilesCurrentPos()>=Files.size() || !Files[getFilesCurrentPos()])
+        return;
+
+    QString FileName=QFileDialog::getSaveFileName(this, "Export to .arrow", Files[getFilesCurrentPos()]->fileName() + ".arrow", "Arrow tables (*.arrow *.feather)", 0);
     if (FileName.size()==0)
         return;
 
@@ -255,13 +309,40 @@ void MainWindow::on_actionExport_XmlGz_Prompt_triggered()
     statusBar()->showMessage("Exported to "+FileName);
 }
 
+//---------------------------------------------------------------------------
+void MainWindow::on_actionExport_Range_Prompt_triggered()
+{
+    if (getFilesCurrentPos()>=Files.size() || !Files[getFilesCurrentPos()] || !PlotsArea)
+        return;
+
+    // Frames shown by the plots, e.g. zoomed on a problem, with their thumbnails and panels
+    auto file = Files[getFilesCurrentPos()];
+    auto frames = PlotsArea->visibleFrames();
+    QString FileName=QFileDialog::getSaveFileName(this, "Export the visible range", file->fileName() + QString(".%1-%2.qctools.mkv").arg(frames.from).arg(frames.to),
+                                                  "Statistic files (*.qctools.mkv *.qctools.xml.gz *.qctools.xml.zst *.qctools.xml)", 0);
+    if (FileName.size()==0)
+        return;
+
+    if (!file->setExportRange(frames.from, frames.to + 1, true))
+    {
+        statusBar()->showMessage("No frame to export in the visible range");
+        return;
+    }
+    if (FileName.endsWith(".qctools.mkv"))
+        file->Export_QCTools_Mkv(FileName, Prefs->ActiveFilters);
+    else
+        file->Export_XmlGz(FileName, Prefs->ActiveFilters);
+    file->setExportRange(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+    statusBar()->showMessage(QString("Frames %1 to %2 exported to %3").arg(frames.from).arg(frames.to).arg(FileName));
+}
+
 //---------------------------------------------------------------------------
 void MainWindow::on_actionExport_XmlGz_Sidecar_triggered()
 {
     if (getFilesCurrentPos() >= Files.size() || !Files[getFilesCurrentPos()])
         return;
 
-    QString FileName = Files[getFilesCurrentPos()]->fileName() + ".qctools.xml.gz";
+    QString FileName = Files[getFilesCurrentPos()]->fileName() + StatsCompression::Extension(StatsCompression::Format_Get());
 
     Files[getFilesCurrentPos()]->Export_XmlGz(FileName, Prefs->ActiveFilters);
     statusBar()->showMessage("Exported to " + FileName);
@@ -277,12 +358,10 @@ void MainWindow::on_actionExport_XmlGz_SidecarAll_triggered()
         if (!parsed)
             continue; // Does not export if not fully parsed
 
-        QString FileName = file->fileName() + ".qctools.xml.gz";
+        QString FileName = file->fileName() + StatsCompression::Extension(StatsCompression::Format_Get());
 
-        file->Export_XmlGz(FileName, Prefs->ActiveFilters);
+        m_exportQueue.Add(file, FileName, ExportQueue::Format_XmlGz, Prefs->ActiveFilters);
     }
-
-    statusBar()->showMessage("All files exported to sidecar file");
 }
 
 //---------------------------------------------------------------------------
@@ -323,10 +402,8 @@ void MainWindow::on_actionExport_Mkv_SidecarAll_triggered()
 
         QString FileName = file->fileName() + ".qctools.mkv";
 
-        file->Export_QCTools_Mkv(FileName, Prefs->ActiveFilters);
+        m_exportQueue.Add(file, FileName, ExportQueue::Format_Mkv, Prefs->ActiveFilters);
     }
-
-    statusBar()->showMessage("All files exported to sidecar file");
 }
 
 //---------------------------------------------------------------------------
@@ -343,7 +420,10 @@ void MainWindow::on_actionExport_Mkv_QCvault_triggered()
         return;
     }
 
-    Files[getFilesCurrentPos()]->Export_QCTools_Mkv(FileName, Prefs->ActiveFilters);
+    auto file = Files[getFilesCurrentPos()];
+    file->Export_QCTools_Mkv(FileName, Prefs->ActiveFilters);
+    if (file->parsed())
+        QCvaultIndex::Add(outPath.absolutePath(), QCvaultIndex::Fingerprint(file->fileName()), file->ActiveFilters & Prefs->ActiveFilters, FileName);
     statusBar()->showMessage("Exported to " + FileName);
 }
 
@@ -365,7 +445,8 @@ void MainWindow::on_actionExport_Mkv_QCvaultAll_triggered()
             return;
         }
 
-        file->Export_QCTools_Mkv(FileName, Prefs->ActiveFilters);
+        m_qcvaultExports.insert(FileName);
+        m_exportQueue.Add(file, FileName, ExportQueue::Format_Mkv, Prefs->ActiveFilters);
     }
 }
 
@@ -390,6 +471,10 @@ void MainWindow::on_actionFilesList_triggered()
         ui->actionExport_XmlGz_Sidecar->setVisible(false);
     if (ui->actionExport_Mkv_Prompt)
         ui->actionExport_Mkv_Prompt->setVisible(false);
+    if (ui->actionExport_Arrow_Prompt)
+        ui->actionExport_Arrow_Prompt->setVisible(false);
+    if (ui->actionExport_Range_Prompt)
+        ui->actionExport_Range_Prompt->setVisible(false);
     if (ui->actionExport_Mkv_Sidecar)
         ui->actionExport_Mkv_Sidecar->setVisible(false);
     if (ui->actionExport_Mkv_QCvault)
@@ -440,6 +525,10 @@ void MainWindow::on_actionGraphsLayout_triggered()
         ui->actionExport_XmlGz_Sidecar->setVisible(true);
     if (ui->actionExport_Mkv_Prompt)
         ui->actionExport_Mkv_Prompt->setVisible(true);
+    if (ui->actionExport_Arrow_Prompt)
+        ui->actionExport_Arrow_Prompt->setVisible(true);
+    if (ui->actionExport_Range_Prompt)
+        ui->actionExport_Range_Prompt->setVisible(true);
     if (ui->actionExport_Mkv_Sidecar)
         ui->actionExport_Mkv_Sidecar->setVisible(true);
     //if (ui->actionPrint)
@@ -461,7 +550,14 @@ void MainWindow::on_actionGraphsLayout_triggered()
         ui->setupFilters_pushButton->show();
 
     if (PlotsArea)
+    {
         PlotsArea->show();
+
+        // Plots are created when first shown
+        QMap<QString, std::tuple<quint64, quint64>> filters;
+        m_plotsChooser->getSelectedFilters(&filters);
+        PlotsArea->updatePlotsVisibility(filters);
+    }
     if (TinyDisplayArea)
         TinyDisplayArea->show();
     if (FilesListArea)
@@ -582,7 +678,7 @@ void MainWindow::dropEvent(QDropEvent *Event)
         QList<QUrl> urls=Event->mimeData()->urls();
         for (int Pos=0; Pos<urls.size(); Pos++)
         {
-            addFile(urls[Pos].toLocalFile());
+            addFile(urls[Pos].toLocalFile(), urls.size()>1);
         }
     }
 
@@ -827,6 +923,8 @@ void MainWindow::updateExportActions()
     ui->actionExport_Mkv_Prompt->setEnabled(exportEnabled);
     ui->actionExport_Mkv_Sidecar->setEnabled(exportEnabled);
     ui->actionExport_Mkv_QCvault->setEnabled(exportEnabled);
+    ui->actionExport_Arrow_Prompt->setEnabled(exportEnabled);
+    ui->actionExport_Range_Prompt->setEnabled(exportEnabled);
 
     ui->menuLegacy_outputs->setEnabled(ui->actionExport_XmlGz_Prompt->isEnabled() || ui->actionExport_XmlGz_Sidecar->isEnabled() || ui->actionExport_XmlGz_SidecarAll->isEnabled());
 }
@@ -866,14 +964,11 @@ void MainWindow::on_actionNavigateNextComment_triggered()
 
     auto framesCount = Files[getFilesCurrentPos()]->VideoFrameCount_Get();
     auto currentPos = Files[getFilesCurrentPos()]->Frames_Pos_Get();
-    while(++currentPos < framesCount)
+    auto nextPos = Files[getFilesCurrentPos()]->ReferenceStat()->comments.Next(currentPos);
+    if(nextPos != StatsComments::None && (qint64)nextPos < (qint64)framesCount)
     {
-        if(Files[getFilesCurrentPos()]->ReferenceStat()->comments[currentPos])
-        {
-            Files[getFilesCurrentPos()]->Frames_Pos_Set(currentPos);
-            PlotsArea->onCurrentFrameChanged();
-            break;
-        }
+        Files[getFilesCurrentPos()]->Frames_Pos_Set(nextPos);
+        PlotsArea->onCurrentFrameChanged();
     }
 }
 
@@ -883,16 +978,12 @@ void MainWindow::on_actionNavigatePreviousComment_triggered()
         return;
 
     auto currentPos = Files[getFilesCurrentPos()]->Frames_Pos_Get();
-    while(--currentPos >= 0)
+    auto previousPos = Files[getFilesCurrentPos()]->ReferenceStat()->comments.Previous(currentPos);
+    if(previousPos != StatsComments::None)
     {
-        if(Files[getFilesCurrentPos()]->ReferenceStat()->comments[currentPos])
-        {
-            Files[getFilesCurrentPos()]->Frames_Pos_Set(currentPos);
-            PlotsArea->onCurrentFrameChanged();
-            break;
-        }
+        Files[getFilesCurrentPos()]->Frames_Pos_Set(previousPos);
+        PlotsArea->onCurrentFrameChanged();
     }
-
 }
 
 void MainWindow::openRecentFile()
@@ -911,7 +1002,7 @@ void MainWindow::openRecentFile()
 
         if(!fileAlreadyOpened)
         {
-            if(!QFile::exists(action->text()))
+            if(!RemoteReport::IsRemote(action->text()) && !QFile::exists(action->text()))
             {
                 QMessageBox::warning(this, "Can't open file", QString("File %1 doesn't exist").arg(action->text()));
             } else {
@@ -962,6 +1053,27 @@ void MainWindow::moveEvent(QMoveEvent *event)
     }
 }
 
+bool MainWindow::eventFilter(QObject* object, QEvent* event)
+{
+    // Background analysis, see FileInformation::ParsingInteraction()
+    switch(event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+        FileInformation::ParsingInteraction();
+        break;
+    case QEvent::MouseMove:
+        if(static_cast<QMouseEvent*>(event)->buttons() != Qt::NoButton)
+            FileInformation::ParsingInteraction();
+        break;
+    default:
+        break;
+    }
+
+    return QMainWindow::eventFilter(object, event);
+}
+
 size_t MainWindow::getFilesCurrentPos() const
 {
     return files_CurrentPos;
@@ -987,6 +1099,18 @@ void MainWindow::setFilesCurrentPos(const size_t &value)
 
     ui->actionReveal_file_location->setEnabled(isFileSelected());
     ui->actionFiltersLayout->setEnabled(isFileSelected());
+
+    // Parsed first
+    FileInformation::ParsingCurrent_Set(getCurrenFileInformation());
+    applyMemoryBudget();
+}
+
+void MainWindow::applyMemoryBudget()
+{
+    FileInformation* current = files_CurrentPos < Files.size() ? Files[files_CurrentPos] : nullptr;
+    m_memoryBudget.Use(current);
+    m_memoryBudget.Apply(Files, current);
+    m_exportQueue.Current_Set(current);
 }
 
 bool MainWindow::isFileSelected() const
@@ -1050,6 +1174,36 @@ void MainWindow::on_actionShow_hide_filters_panel_triggered()
         m_player->showHideFilters();
 }
 
+void MainWindow::on_actionShow_analysis_counters_triggered()
+{
+    if(!m_parsingCounters)
+        m_parsingCounters = new ParsingCounters([this]() { return getCurrenFileInformation(); }, this);
+    m_parsingCounters->show();
+    m_parsingCounters->raise();
+}
+
+void MainWindow::on_actionShow_memory_usage_triggered()
+{
+    if(!m_memoryView)
+        m_memoryView = new MemoryView([this]() { return Files; }, [this]() { return PlotsArea; }, this);
+    m_memoryView->show();
+    m_memoryView->raise();
+}
+
+void MainWindow::on_actionRecord_trace_toggled(bool checked)
+{
+    if(checked)
+    {
+        TraceEvents::Start();
+        return;
+    }
+
+    // Stopped even if not saved
+    QString FileName=QFileDialog::getSaveFileName(this, "Save analysis trace", "qctools-trace.json", "Chrome trace event files (*.json)", 0);
+    if(!TraceEvents::Stop(FileName) && !FileName.isEmpty())
+        QMessageBox::warning(this, "Can't save trace", QString("File %1 can not be written").arg(FileName));
+}
+
 void MainWindow::on_copyToClipboard_pushButton_clicked()
 {
     QGuiApplication::clipboard()->setText(ui->fileNamesBox->currentText());
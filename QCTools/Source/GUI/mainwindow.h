@@ -15,11 +15,14 @@
 #include <QPushButton>
 #include <QJsonDocument>
 #include <QPointer>
+#include <QSet>
 
 #include <vector>
 
 #include "Core/Core.h"
 #include "Core/FileInformation.h"
+#include "Core/ExportQueue.h"
+#include "Core/MemoryBudget.h"
 #include "Core/SignalServerConnectionChecker.h"
 #include "GUI/TinyDisplay.h"
 #include "GUI/Info.h"
@@ -39,6 +42,8 @@ class QDragEnterEvent;
 class QPushButton;
 class QComboBox;
 class QCheckBox;
+class ParsingCounters;
+class MemoryView;
 
 class PerPicture;
 class PreferencesDialog;
@@ -88,7 +93,8 @@ public:
     void                        createFilesList             ();
     void                        clearGraphsLayout           ();
     void                        createGraphsLayout          ();
-    void                        addFile                     (const QString &FileName);
+    void                        addFile                     (const QString &FileName, bool Async=false);
+    void                        addFile_opened              (FileInformation* File, bool IsValid);
     void                        addFile_finish              ();
     void                        selectFile                  (int newFilePos);
     void                        selectDisplayFile           (int newFilePos);
@@ -103,9 +109,12 @@ public:
     QLabel*                     DragDrop_Text;
 
     QPointer<PlotsChooser> m_plotsChooser;
+    QPointer<ParsingCounters> m_parsingCounters;
+    QPointer<MemoryView> m_memoryView;
 
     // Files
     std::vector<FileInformation*> Files;
+    std::vector<FileInformation*> FilesOpening;             // Opened asynchronously, added to Files once opened
     size_t                      Thumbnails_Modulo;
 
     // Deck
@@ -151,6 +160,8 @@ private Q_SLOTS:
 
     void on_actionOpen_triggered();
 
+    void on_actionOpen_remote_file_triggered();
+
     void on_actionClose_triggered();
 
     void on_actionCloseAll_triggered();
@@ -177,6 +188,10 @@ private Q_SLOTS:
 
     void on_actionExport_Mkv_QCvaultAll_triggered();
 
+    void on_actionExport_Arrow_Prompt_triggered();
+
+    void on_actionExport_Range_Prompt_triggered();
+
     void on_actionExport_XmlGz_Prompt_triggered();
 
     void on_actionExport_XmlGz_Sidecar_triggered();
@@ -220,6 +235,7 @@ private Q_SLOTS:
     void onSignalServerConnectionChanged(SignalServerConnectionChecker::State state);
     void updateConnectionIndicator();
     void updateSignalServerSettings();
+    void updateAnalysisSettings();
 
     void updateSignalServerCheckUploadedStatus();
     void updateSignalServerUploadStatus();
@@ -227,6 +243,7 @@ private Q_SLOTS:
 
     void updateExportActions();
     void updateExportAllAction();
+    void applyMemoryBudget();
     void showPlayer();
 
     void on_actionNavigateNextComment_triggered();
@@ -247,6 +264,10 @@ private Q_SLOTS:
 
     void on_actionShow_hide_filters_panel_triggered();
 
+    void on_actionShow_analysis_counters_triggered();
+    void on_actionShow_memory_usage_triggered();
+    void on_actionRecord_trace_toggled(bool checked);
+
     void on_copyToClipboard_pushButton_clicked();
 
     void on_setupFilters_pushButton_clicked();
@@ -257,6 +278,7 @@ protected:
     void closeEvent(QCloseEvent* event);
     void resizeEvent(QResizeEvent* event);
     void moveEvent(QMoveEvent *event);
+    bool eventFilter(QObject* object, QEvent* event);
 
 private:
     void updateScrollBar( bool blockSignals = false );
@@ -270,6 +292,9 @@ private:
     SignalServerConnectionChecker* connectionChecker;
     QWidget* connectionIndicator;
     size_t files_CurrentPos { (size_t) -1 };
+    MemoryBudget m_memoryBudget;
+    ExportQueue m_exportQueue;                              // Export of all the files
+    QSet<QString> m_qcvaultExports;                         // Reports of m_exportQueue indexed once written, see QCvaultIndex
 
     QJsonDocument m_barchartsProfile;
     QComboBox* m_profileSelectorCombobox;
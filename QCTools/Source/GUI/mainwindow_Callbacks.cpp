@@ -74,7 +74,7 @@ void MainWindow::TimeOut ()
             CommonStats* Stats=Files[Files_Pos]->ReferenceStat();
             if (Stats)
             {
-                VideoFramePos_Total+=Stats->x_Current;
+                VideoFramePos_Total+=Stats->x_Current_Get();
                 VideoFrameCount_Total+=Stats->x_Current_Max;
             }
         }
@@ -101,9 +101,9 @@ void MainWindow::TimeOut ()
             qDebug() << "reading stats.... ";
 
             std::stringstream Message;
-            Message<<"Parsing frame "<<Stats->x_Current;
+            Message<<"Parsing frame "<<Stats->x_Current_Get();
             if (Stats->x_Current_Max)
-                Message<<"/"<<Stats->x_Current_Max<<" ("<<(int)((double)Stats->x_Current)*100/Stats->x_Current_Max<<"%)";
+                Message<<"/"<<Stats->x_Current_Max<<" ("<<(int)((double)Stats->x_Current_Get())*100/Stats->x_Current_Max<<"%)";
             QStatusBar* StatusBar=statusBar();
             if (StatusBar)
                 StatusBar->showMessage((Message.str()+Message_Total.str()).c_str());
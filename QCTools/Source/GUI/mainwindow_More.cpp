@@ -16,6 +16,7 @@
 #include <QPalette>
 #include <QMessageBox>
 #include <QStandardPaths>
+#include <algorithm>
 
 #include "Core/Core.h"
 #include "GUI/player.h"
@@ -42,7 +43,7 @@ void MainWindow::openFile()
 {
     QStringList List=QFileDialog::getOpenFileNames(this, "Open file", "", "All (*.*);;\
                                                                            Audio files (*.wav);;\
-                                                                           Statistic files (*.qctools.xml *.qctools.xml.gz *.xml.gz *.xml);;\
+                                                                           Statistic files (*.qctools.xml *.qctools.xml.gz *.qctools.xml.zst *.xml.gz *.xml);;\
                                                                            Statistic files with thumbnails (*.qctools.mkv);;\
                                                                            Video files (*.avi *.mkv *.mov *.mxf *.mp4 *.ts *.m2ts)", 0);
     if (List.empty())
@@ -50,7 +51,7 @@ void MainWindow::openFile()
 
     for (int Pos=0; Pos<List.size(); Pos++)
     {
-        addFile(List[Pos]);
+        addFile(List[Pos], List.size()>1);
     }
 
     addFile_finish();
@@ -111,6 +112,9 @@ void MainWindow::closeAllFiles()
     for (size_t Pos=0; Pos<Files.size(); Pos++)
         delete Files[Pos];
     Files.clear();
+    for (size_t Pos=0; Pos<FilesOpening.size(); Pos++)
+        delete FilesOpening[Pos];
+    FilesOpening.clear();
     ui->fileNamesBox->clear();
     createDragDrop();
     ui->actionFilesList->setChecked(false);
@@ -257,6 +261,8 @@ void MainWindow::createFilesList()
     clearDragDrop();
 
     FilesListArea=new FilesList(this);
+    connect(&m_exportQueue, &ExportQueue::progressChanged, FilesListArea, &FilesList::updateExportProgress);
+    connect(&m_exportQueue, &ExportQueue::queueProgressChanged, FilesListArea, &FilesList::updateExportQueueProgress);
     if (!ui->actionFilesList->isChecked())
         FilesListArea->hide();
     ui->verticalLayout->addWidget(FilesListArea);
@@ -484,13 +490,28 @@ void MainWindow::createGraphsLayout()
 }
 
 //---------------------------------------------------------------------------
-void MainWindow::addFile(const QString &FileName)
+void MainWindow::addFile(const QString &FileName, bool Async)
 {
     if (FileName.isEmpty())
         return;
 
     qDebug() << "addFile: " << FileName;
 
+    // Several files: the rows are shown at once, each file is added once opened
+    // One file too if its report is shown while it is read (see FileInformation::ProgressiveReports_Set)
+    if (Async || FileInformation::ProgressiveReports_Get())
+    {
+        FileInformation* Temp=new FileInformation(signalServer, FileName, Prefs->ActiveFilters, Prefs->ActiveAllTracks, preferences->getActivePanels(), preferences->createQCvaultFileNameString(FileName), 0, false);
+        connect(Temp, &FileInformation::opened, this, [this, Temp](bool IsValid) {
+            addFile_opened(Temp, IsValid);
+        });
+        FilesOpening.push_back(Temp);
+        Temp->open();
+
+        updateRecentFiles(FileName);
+        return;
+    }
+
     // Launch analysis
     FileInformation* Temp=new FileInformation(signalServer, FileName, Prefs->ActiveFilters, Prefs->ActiveAllTracks, preferences->getActivePanels(), preferences->createQCvaultFileNameString(FileName));
     if (!Temp->isValid() && !Temp->hasStats())
@@ -502,6 +523,7 @@ void MainWindow::addFile(const QString &FileName)
 
     connect(Temp, SIGNAL(positionChanged()), this, SLOT(Update()), Qt::DirectConnection); // direct connection is required here to get Update called from separate thread
     connect(Temp, SIGNAL(parsingCompleted(bool)), this, SLOT(updateExportAllAction()));
+    connect(Temp, SIGNAL(parsingCompleted(bool)), this, SLOT(applyMemoryBudget()));
 
     Temp->setIndex(Files.size());
     Temp->setExportFilters(Prefs->ActiveFilters);
@@ -512,6 +534,45 @@ void MainWindow::addFile(const QString &FileName)
     updateRecentFiles(FileName);
 }
 
+//---------------------------------------------------------------------------
+void MainWindow::addFile_opened(FileInformation* File, bool IsValid)
+{
+    auto Opening=std::find(FilesOpening.begin(), FilesOpening.end(), File);
+    if (Opening==FilesOpening.end())
+        return;
+    FilesOpening.erase(Opening);
+
+    if (!IsValid)
+    {
+        // From its own signal
+        File->deleteLater();
+        statusBar()->showMessage(QString("File %1 is invalid or unsupported").arg(File->fileName()));
+    }
+    else
+    {
+        connect(File, SIGNAL(positionChanged()), this, SLOT(Update()), Qt::DirectConnection); // direct connection is required here to get Update called from separate thread
+        connect(File, SIGNAL(parsingCompleted(bool)), this, SLOT(updateExportAllAction()));
+        connect(File, SIGNAL(parsingCompleted(bool)), this, SLOT(applyMemoryBudget()));
+
+        File->setIndex(Files.size());
+        File->setExportFilters(Prefs->ActiveFilters);
+
+        Files.push_back(File);
+        ui->fileNamesBox->addItem(File->fileName());
+        updateExportAllAction();
+
+        // Only file, opened after addFile_finish(): its plots are shown and refreshed while its report is read
+        if (Files.size() == 1 && FilesOpening.empty() && !isFileSelected())
+        {
+            selectFile(0);
+            TimeOut();
+        }
+    }
+
+    if (FilesListArea && FilesListArea->isVisible())
+        FilesListArea->UpdateAll();
+}
+
 //---------------------------------------------------------------------------
 void MainWindow::addFile_finish()
 {
@@ -525,7 +586,7 @@ void MainWindow::addFile_finish()
         updateExportActions();
         updateExportAllAction();
     }
-    if (Files.size()>1)
+    if (Files.size()+FilesOpening.size()>1)
     {
         ui->actionFilesList->trigger();
 
@@ -629,7 +690,7 @@ void MainWindow::Update()
 
         int Milliseconds=(int)-1;
         if (fileInfo && !fileInfo->Stats.empty()
-         && ( framesPos<fileInfo->ReferenceStat()->x_Current
+         && ( framesPos<fileInfo->ReferenceStat()->x_Current_Get()
           || (framesPos<fileInfo->ReferenceStat()->x_Current_Max && fileInfo->ReferenceStat()->x[1][framesPos]))) //Also includes when stats are not ready but timestamp is available
             Milliseconds=(int)(fileInfo->ReferenceStat()->x[1][framesPos]*1000);
         else
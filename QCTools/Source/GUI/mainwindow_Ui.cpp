@@ -16,10 +16,14 @@
 #include "GUI/Comments.h"
 #include "GUI/playercontrol.h"
 #include "GUI/draggablechildrenbehaviour.h"
+#include "Core/AnalysisProfiles.h"
 #include "Core/Core.h"
+#include "Core/CommonStats.h"
 #include "Core/VideoCore.h"
+#include "Core/StatsCompression.h"
 
 #include <QFileDialog>
+#include <QApplication>
 #include <QScrollBar>
 #include <QSizePolicy>
 #include <QScrollArea>
@@ -266,6 +270,10 @@ void MainWindow::Ui_Init()
         ui->setupFilters_pushButton->hide();
 
     preferences = new Preferences(this);
+    FileInformation::KeyFramePreview_Set(true);
+    FileInformation::LazyItems_Set(true);
+    FileInformation::ProgressiveReports_Set(true);
+    updateAnalysisSettings();
 
     for (quint64 type = 0; type < Type_Max; type++)
     {
@@ -318,6 +326,7 @@ void MainWindow::Ui_Init()
     //Preferences
     Prefs=new PreferencesDialog(preferences, connectionChecker, this);
     connect(Prefs, SIGNAL(saved()), this, SLOT(updateSignalServerSettings()));
+    connect(Prefs, SIGNAL(saved()), this, SLOT(updateAnalysisSettings()));
     connect(Prefs, &PreferencesDialog::saved, [&]() {
 
         if(!PlotsArea)
@@ -384,6 +393,35 @@ void MainWindow::Ui_Init()
     }
 }
 
+//---------------------------------------------------------------------------
+// At start and once the preferences are saved, most of them for the files opened next
+void MainWindow::updateAnalysisSettings()
+{
+    FileInformation::DecoderThreads_Set(preferences->decoderThreads());
+    FileInformation::DecoderThreadType_Set(preferences->decoderThreadType());
+    FileInformation::FilterThreads_Set(preferences->filterThreads());
+    FileInformation::ThumbnailsCodec_Set(preferences->thumbnailsCodec());
+    FileInformation::PanelsCodec_Set(preferences->panelsCodec());
+    auto reportCompression = StatsCompression::Format_FromName(preferences->reportCompression());
+    StatsCompression::Format_Set(StatsCompression::Check(reportCompression).isEmpty() ? reportCompression : StatsCompression::Format_Gzip);
+    StatsCompression::Level_Set(preferences->reportCompressionLevel());
+    FileInformation::Sampling_Set(preferences->sampling());
+    m_memoryBudget.Limit_Set((size_t)qMax(0, preferences->memoryBudget())*1024*1024);
+    CommonStats::ColdCompression_Set(preferences->statsColdCompression());
+    FileInformation::AnalysisProfile_Set(AnalysisProfiles::FromName(preferences->analysisProfile()));
+    FileInformation::BackgroundParsing_Set(preferences->backgroundAnalysis());
+    FileInformation::AnalysisProcess_Set(preferences->analysisProcess());
+    if (preferences->backgroundAnalysis())
+    {
+        // Input events of all the windows (plots, player...) tell the parsers the user interacts
+        FileInformation::ParsingInteractionCores_Set(preferences->backgroundAnalysisCores());
+        qApp->installEventFilter(this);
+    }
+    else
+        qApp->removeEventFilter(this);
+    Plot::setOpenGLCanvas(preferences->plotsOpenGL());
+}
+
 //---------------------------------------------------------------------------
 bool MainWindow::isPlotZoomable() const
 {
@@ -517,10 +555,11 @@ void MainWindow::updateScrollBar( bool blockSignals )
 
         sb->blockSignals( blockSignals );
 
-        sb->setRange( 0, PlotsArea->numFrames() - intv.count() + 1 );
-        sb->setValue( intv.from );
-        sb->setPageStep( intv.count() );
-        sb->setSingleStep( intv.count() );
+        // QScrollBar positions are int
+        sb->setRange( 0, int( PlotsArea->numFrames() - intv.count() + 1 ) );
+        sb->setValue( int( intv.from ) );
+        sb->setPageStep( int( intv.count() ) );
+        sb->setSingleStep( int( intv.count() ) );
 
         sb->blockSignals( false );
 
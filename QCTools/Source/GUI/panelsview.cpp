@@ -2,9 +2,32 @@
 #include "Comments.h"
 #include "Plot.h"
 #include <QDebug>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QPushButton>
+#include <QRunnable>
 #include <QWheelEvent>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+// Fixed point of the scales of the tiles
+const qint64 scaleOne = 1 << 16;
+
+std::atomic<quint64> tilesCount { 0 };
+
+class PrefetchTask : public QRunnable
+{
+public:
+    explicit PrefetchTask(const std::function<void()>& function) : m_function(function) {}
+    void run() override { m_function(); }
+
+private:
+    std::function<void()> m_function;
+};
+
+}
 
 class PanelCursor : public PlotCursor {
 public:
@@ -32,8 +55,11 @@ public:
     QwtPlot* m_plot;
 };
 
-PanelsView::PanelsView(QWidget *parent, const QString& panelTitle, const QString& yaxis, const QString& legend, CommentsPlot* plot) : QFrame(parent), m_actualWidth(0), m_plot(plot)
+PanelsView::PanelsView(QWidget *parent, const QString& panelTitle, const QString& yaxis, const QString& legend, CommentsPlot* plot) : QFrame(parent), m_actualWidth(0), m_plot(plot),
+    m_tilesId(++tilesCount)
 {
+    m_prefetchPool.setMaxThreadCount(1);
+
     qDebug() << "creating PanelsView: " << panelTitle;
 
     m_PlotCursor = new PanelCursor(this, plot);
@@ -78,6 +104,9 @@ PanelsView::PanelsView(QWidget *parent, const QString& panelTitle, const QString
 
 PanelsView::~PanelsView()
 {
+    m_prefetchPool.clear();
+    m_prefetchPool.waitForDone();
+
     delete m_legend;
 }
 
@@ -89,7 +118,7 @@ void PanelsView::setProvider(const std::function<int ()> &getPanelsCount, const
 
 void PanelsView::getPanelsBounds(int &startPanelIndex, int &startPanelOffset, int &endPanelIndex, int &endPanelLength)
 {
-    auto panelSize = getPanelImage(0).size();
+    auto panelSize = this->panelSize();
     if(panelSize.isEmpty()) {
         startPanelIndex = 0;
         startPanelOffset = 0;
@@ -100,26 +129,29 @@ void PanelsView::getPanelsBounds(int &startPanelIndex, int &startPanelOffset, in
 
     auto panelWidth = panelSize.width();
 
-    startPanelOffset = m_startFrame % panelWidth;
-    startPanelIndex = (m_startFrame - startPanelOffset) / panelWidth;
+    startPanelOffset = int(m_startFrame % panelWidth);
+    startPanelIndex = int((m_startFrame - startPanelOffset) / panelWidth);
 
-    endPanelLength = m_endFrame % panelWidth;
-    endPanelIndex = (m_endFrame - endPanelLength) / panelWidth;
+    endPanelLength = int(m_endFrame % panelWidth);
+    endPanelIndex = int((m_endFrame - endPanelLength) / panelWidth);
 }
 
 void PanelsView::refresh()
 {
-    m_panelPixmap = QPixmap();
-    repaint();
+    // Composed again only if panels were added
+    if(getPanelsCount && getPanelsCount() != m_composedPanelsCount)
+        m_panelPixmap = QPixmap();
+    update();
     m_PlotCursor->updateOverlay();
 }
 
-void PanelsView::setVisibleFrames(int from, int to)
+void PanelsView::setVisibleFrames(qint64 from, qint64 to)
 {
     m_startFrame = from;
     m_endFrame = to;
     qDebug() << "from: " << from << "to: " << to;
 
+    m_panelPixmap = QPixmap();
     refresh();
 }
 
@@ -128,10 +160,77 @@ void PanelsView::setActualWidth(int actualWidth)
     if(m_actualWidth != actualWidth)
     {
         m_actualWidth = actualWidth;
+        m_panelPixmap = QPixmap();
         refresh();
     }
 }
 
+QSize PanelsView::panelSize()
+{
+    // All the panel images have the size of the first one
+    if(m_panelSize.isEmpty() && getPanelsCount() > 0)
+        m_panelSize = getPanelImage(0).size();
+    return m_panelSize;
+}
+
+void PanelsView::tileBounds(int index, qint64 scale, int &left, int &width)
+{
+    // From the position of the frames, so the tiles of the same scale are joined whatever the first visible frame is
+    const qint64 panelWidth = m_panelSize.width();
+    left = int((index * panelWidth * scale + scaleOne / 2) / scaleOne);
+    width = int(((index + 1) * panelWidth * scale + scaleOne / 2) / scaleOne) - left;
+}
+
+QImage PanelsView::tile(int index, qint64 scale, int height)
+{
+    const PanelTileCache::Key key { m_tilesId, index, scale, height };
+    auto image = PanelTileCache::instance().find(key);
+    if(!image.isNull())
+        return image;
+
+    int left, width;
+    tileBounds(index, scale, left, width);
+    return makeTile(key, width);
+}
+
+QImage PanelsView::makeTile(const PanelTileCache::Key &key, int width)
+{
+    auto image = getPanelImage(key.index);
+    if(image.isNull() || width <= 0)
+        return QImage();
+
+    // Not smoothed, as the painter scaling it before
+    image = image.scaled(width, key.height, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    PanelTileCache::instance().insert(key, image);
+    return image;
+}
+
+void PanelsView::prefetch(int firstIndex, int lastIndex, qint64 scale, int height)
+{
+    for(auto index = firstIndex; index <= lastIndex; ++index)
+    {
+        const PanelTileCache::Key key { m_tilesId, index, scale, height };
+        if(PanelTileCache::instance().contains(key))
+            continue;
+
+        {
+            QMutexLocker locker(&m_prefetchMutex);
+            if(m_prefetching.contains(key))
+                continue;
+            m_prefetching.insert(key);
+        }
+
+        int left, width;
+        tileBounds(index, scale, left, width);
+        m_prefetchPool.start(new PrefetchTask([this, key, width] {
+            makeTile(key, width);
+
+            QMutexLocker locker(&m_prefetchMutex);
+            m_prefetching.remove(key);
+        }));
+    }
+}
+
 void PanelsView::setCursorPos(double x)
 {
     m_PlotCursor->setPosition( x );
@@ -144,7 +243,7 @@ void PanelsView::setLeftOffset(int leftOffset)
 
 void PanelsView::onPickerMoved(const QPointF &pos)
 {
-    const int idx = m_plot->frameAt( pos.x() );
+    const qint64 idx = m_plot->frameAt( pos.x() );
     if ( idx >= 0 )
         Q_EMIT cursorMoved( idx );
 }
@@ -208,12 +307,13 @@ void PanelsView::paintEvent(QPaintEvent *e)
 
     p.restore();
 
-    if(m_panelPixmap.isNull())
-    {
-        auto availableWidth = w - (leftMargin + m_leftOffset + 1) - (rightMargin + m_leftOffset - 1);
-        auto availableHeight = h - lineWidth();
+    auto availableWidth = w - (leftMargin + m_leftOffset + 1) - (rightMargin + m_leftOffset - 1);
+    auto availableHeight = h - lineWidth();
 
+    if(m_panelPixmap.isNull() || m_panelPixmap.size() != QSize(availableWidth, availableHeight))
+    {
         auto panelsCount = getPanelsCount();
+        m_composedPanelsCount = panelsCount;
         if(panelsCount == 0) {
             m_panelPixmap = QPixmap(availableWidth, availableHeight);
             m_panelPixmap.fill(fillColor);
@@ -222,42 +322,38 @@ void PanelsView::paintEvent(QPaintEvent *e)
             return;
         }
 
-        auto sx = m_actualWidth == 0 ? 1 : ((qreal) availableWidth / m_actualWidth);
-        auto sy = (qreal)availableHeight / getPanelImage(0).height();
-
         m_panelPixmap = QPixmap(availableWidth, availableHeight);
         m_panelPixmap.fill(fillColor);
         QPainter p(&m_panelPixmap);
 
+        // Pixels per frame
         auto totalFrames = m_endFrame - m_startFrame;
-        auto zx = (qreal) m_actualWidth / totalFrames;
-
-        QTransform scalingViewMatrix(sx, 0, 0, sy, 0, 0);
-        QTransform scalingZoomMatrix(zx, 0, 0, 1, 0, 0);
-        p.setTransform(scalingViewMatrix * scalingZoomMatrix);
+        auto sx = m_actualWidth == 0 ? 1 : ((qreal) availableWidth / m_actualWidth);
+        auto zx = totalFrames <= 0 ? 0 : (qreal) m_actualWidth / totalFrames;
+        auto scale = qRound64(sx * zx * scaleOne);
 
         int startPanelOffset, startPanelIndex, endPanelLength, endPanelIndex;
         getPanelsBounds(startPanelIndex, startPanelOffset, endPanelIndex, endPanelLength);
+        endPanelIndex = qMin(endPanelIndex, panelsCount - 1);
 
-        int x = 0;
-        int y = 0;
-
-        for(auto i = startPanelIndex; i <= endPanelIndex; ++i) {
-
-            qDebug() << "getPanelsCount(): " << getPanelsCount();
-            if(i < getPanelsCount())
-            {
-                auto image = getPanelImage(i);
-                qDebug() << "getPanelImage: " << i << image.width() << image.height();
-
-                auto imageXOffset = ((i == startPanelIndex) ? startPanelOffset : 0);
-                auto imageWidth = ((i == endPanelIndex) ? endPanelLength : image.width());
-                auto imageHeight = image.height();
-
-                QRect sr(imageXOffset, 0, imageWidth, imageHeight);
-                p.drawImage(QPointF(x, y), image, sr);
-                x += (sr.width() - imageXOffset);
+        if(scale > 0 && !m_panelSize.isEmpty())
+        {
+            // Frames after the last visible one are out of the pixmap
+            const int origin = int((m_startFrame * scale + scaleOne / 2) / scaleOne);
+            for(auto i = startPanelIndex; i <= endPanelIndex; ++i) {
+                auto image = tile(i, scale, availableHeight);
+                if(image.isNull())
+                    continue;
+
+                int left, width;
+                tileBounds(i, scale, left, width);
+                p.drawImage(QPoint(left - origin, 0), image);
             }
+
+            // The same count of panels on each side
+            auto visibleCount = endPanelIndex - startPanelIndex + 1;
+            prefetch(qMax(0, startPanelIndex - visibleCount), startPanelIndex - 1, scale, availableHeight);
+            prefetch(endPanelIndex + 1, qMin(panelsCount - 1, endPanelIndex + visibleCount), scale, availableHeight);
         }
     }
 
@@ -270,7 +366,7 @@ void PanelsView::wheelEvent(QWheelEvent *event)
     if(getPanelsCount() == 0)
         return;
 
-    auto panelImageHeight = getPanelImage(0).height();
+    auto panelImageHeight = panelSize().height();
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     auto delta = event->delta();
 #else
@@ -2,10 +2,14 @@
 #define PANELSVIEW_H
 
 #include "PlotLegend.h"
+#include "PanelTileCache.h"
 
 #include <QFrame>
+#include <QMutex>
+#include <QSet>
 #include <QSize>
 #include <QPen>
+#include <QThreadPool>
 #include <functional>
 #include <qwt_legend.h>
 #include <qwt_picker_machine.h>
@@ -354,9 +358,11 @@ public:
     PlotLegend *plotLegend() { return m_plotLegend; }
     QWidget* legend() { return m_legend; }
     void setLegend(QWidget* item) { m_legend = item; }
+    // Memory of the panels composed for the visible frames
+    qint64 pixmapBytes() const { return qint64(m_panelPixmap.width()) * m_panelPixmap.height() * m_panelPixmap.depth() / 8; }
 
 public Q_SLOTS:
-    void setVisibleFrames(int from, int to);
+    void setVisibleFrames(qint64 from, qint64 to);
     void setActualWidth(int width);
     void setCursorPos(double x);
     void setLeftOffset(int leftOffset);
@@ -368,9 +374,22 @@ protected:
     void wheelEvent(QWheelEvent *event);
 
 Q_SIGNALS:
-    void cursorMoved( int index );
+    void cursorMoved( qint64 index );
 
 private:
+    // Panel images are drawn from tiles scaled to their size on screen, the neighbours of the visible ones are made in advance
+    QSize panelSize();
+    void tileBounds(int index, qint64 scale, int& left, int& width);
+    QImage tile(int index, qint64 scale, int height);
+    QImage makeTile(const PanelTileCache::Key& key, int width);
+    void prefetch(int firstIndex, int lastIndex, qint64 scale, int height);
+
+    const quint64 m_tilesId;
+    QSize m_panelSize;
+    int m_composedPanelsCount { -1 };
+    QThreadPool m_prefetchPool;
+    QMutex m_prefetchMutex;
+    QSet<PanelTileCache::Key> m_prefetching;
 
     QPixmap m_panelPixmap;
     PlotLegend* m_plotLegend;
@@ -385,8 +404,8 @@ private:
     QString m_middleYLabel;
 
     int m_leftOffset { 0 };
-    int m_startFrame;
-    int m_endFrame;
+    qint64 m_startFrame;
+    qint64 m_endFrame;
     int m_actualWidth;
     std::function<int()> getPanelsCount;
     std::function<QImage(int)> getPanelImage;
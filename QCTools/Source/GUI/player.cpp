@@ -10,11 +10,14 @@
 #include <QStandardPaths>
 #include <QTimer>
 #include <QMetaMethod>
+#include <QRegularExpression>
 #include <QGraphicsItem>
 #include <QGraphicsObject>
 #include <QFileDialog>
 #include <QGraphicsView>
 #include <QGraphicsVideoItem>
+#include <QPainter>
+#include <QtNumeric>
 #include "draggablechildrenbehaviour.h"
 #include "SelectionArea.h"
 #include <float.h>
@@ -24,6 +27,7 @@ extern "C" {
 #include <libavfilter/buffersink.h>
 #include <libavutil/avassert.h>
 #include <libavutil/bprint.h>
+#include <libavutil/pixdesc.h>
 #include <libavformat/avformat.h>
 }
 
@@ -49,6 +53,10 @@ Player::Player(QWidget *parent) :
     scene->addItem(m_w);
 
     m_player = new MediaPlayer();
+    m_player->setFilterCacheSize(filterCacheSize);
+    m_player->setParallelFilters(true);
+    // Fast playback shows one frame by frame duration, the others are skipped or not filtered
+    m_player->setScrub(true);
 
     QObject::connect(m_player, &QAVPlayer::audioFrame, m_player, [this](const QAVAudioFrame &frame) {
         if(!ui->playerSlider->isSliderDown() && !m_mute)
@@ -57,25 +65,24 @@ Player::Player(QWidget *parent) :
 
     QObject::connect(m_player, &QAVPlayer::videoFrame, m_player, [this](const QAVVideoFrame &frame) {
 
-        videoFrame = frame.convertTo(AV_PIX_FMT_RGB32);
-
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-        auto surface = m_w->videoSurface();
-        if (!surface->isActive() || surface->surfaceFormat().frameSize() != videoFrame.size()) {
-            surface->start({videoFrame.size(), videoFrame.pixelFormat(), videoFrame.handleType()});
-            updateVideoOutputSize();
+        // Decoded on the GPU and not filtered (see applyFilter()): the surface is shown as is,
+        // it is downloaded only on export and not cached so the decoder can reuse it
+        if(frame.handleType() != QAVVideoFrame::NoHandle) {
+            m_gpuFrame = frame;
+            videoFrame = frame;
+            presentVideoFrame();
+            return;
         }
-        if (surface->isActive())
-            surface->present(videoFrame);
-#else
-            if(m_w->videoSink()->videoFrame().size() != videoFrame.size()) {
-                m_w->videoSink()->setVideoFrame(videoFrame);
-                QTimer::singleShot(0, [this] { updateVideoOutputSize(); });
-            } else {
-                m_w->videoSink()->setVideoFrame(videoFrame);
-            }
-#endif
+        m_gpuFrame = QAVVideoFrame();
 
+        if(!updateVideoFrame(frame))
+            return;
+        presentVideoFrame();
+
+        if(m_framesCount && m_player->duration() > 0) {
+            QMutexLocker locker(&m_cachedFramesMutex);
+            m_cachedFrames.insert(nearestFrame(frame.pts() * 1000), new QVideoFrame(videoFrame), qMax(1, videoFrame.width() * videoFrame.height() * 4 / 1024));
+        }
     },
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
         Qt::AutoConnection
@@ -177,54 +184,8 @@ Player::Player(QWidget *parent) :
     ui->filterGroupBox->layout()->setContentsMargins(2, 2, 2, 2);
     ui->filterGroupBox->setMinimumHeight(50 * MaxFilters);
 
-    static const char* adjustments[] = {
-        "Adjust Signal",
-        nullptr
-    };
-
-    for(int i = 0; i < 6; ++i) {
-        m_filterSelectors[i] = new FilterSelector(this, [&](const char* filterName) {
-            auto i = 0;
-            while(adjustments[i]) {
-                if(strcmp(adjustments[i], filterName) == 0)
-                    return false;
-
-                ++i;
-            }
-
-            return true;
-        });
-
-        handleFilterChange(m_filterSelectors[i], i);
-        ui->filterGroupBox->layout()->addWidget(m_filterSelectors[i]);
-    }
-
-    m_draggableBehaviour = new DraggableChildrenBehaviour(static_cast<QVBoxLayout*> (ui->filterGroupBox->layout()));
-    connect(m_draggableBehaviour, &DraggableChildrenBehaviour::childPositionChanged, [&](QWidget* child, int oldPos, int newPos) {
-        applyFilter();
-    });
-
-    m_adjustmentSelector = new FilterSelector(nullptr, [&](const char* filterName) {
-        auto i = 0;
-        while(adjustments[i]) {
-            if(strcmp(adjustments[i], filterName) == 0)
-                return true;
-
-            ++i;
-        }
-
-        return false;
-    });
-
-    m_adjustmentSelector->setMinimumHeight(50);
-    m_adjustmentSelector->selectCurrentFilter(-1);
-    m_adjustmentSelector->setCurrentIndex(18);
-
-    handleFilterChange(m_adjustmentSelector, -1);
-
     ui->adjustmentsGroupBox->setLayout(new QVBoxLayout);
     ui->adjustmentsGroupBox->layout()->setContentsMargins(2, 2, 2, 2);
-    ui->adjustmentsGroupBox->layout()->addWidget(m_adjustmentSelector);
 
     m_filterUpdateTimer.setSingleShot(true);
     connect(&m_filterUpdateTimer, &QTimer::timeout, this, &Player::applyFilter);
@@ -265,6 +226,10 @@ Player::Player(QWidget *parent) :
         h /= m_scaleFactor;
         m_selectionAreaGeometry.setRect(x, y, w, h);
     });
+
+    // the selection, in pixels of the frames, is the region of interest of the files opened next while the button is checked
+    for (auto spinBox : { ui->xDoubleSpinBox, ui->yDoubleSpinBox, ui->wDoubleSpinBox, ui->hDoubleSpinBox })
+        connect(spinBox, SIGNAL(valueChanged(double)), this, SLOT(updateRegionOfInterest()));
 }
 
 Player::~Player()
@@ -391,6 +356,7 @@ private:
 void Player::playPaused(qint64 ms)
 {
     qDebug() << "play to " << ms;
+    updateKeyFrames();
 
     ui->playerSlider->setDisabled(true);
 
@@ -402,6 +368,59 @@ void Player::playPaused(qint64 ms)
     qDebug() << "play to " << ms << " done...";
 }
 
+void Player::createFilterSelectors()
+{
+    // Created with the first file or when shown: each one lists all the filters, too long for the startup
+    if(m_adjustmentSelector)
+        return;
+
+    static const char* adjustments[] = {
+        "Adjust Signal",
+        nullptr
+    };
+
+    for(int i = 0; i < 6; ++i) {
+        m_filterSelectors[i] = new FilterSelector(this, [&](const char* filterName) {
+            auto i = 0;
+            while(adjustments[i]) {
+                if(strcmp(adjustments[i], filterName) == 0)
+                    return false;
+
+                ++i;
+            }
+
+            return true;
+        });
+
+        handleFilterChange(m_filterSelectors[i], i);
+        ui->filterGroupBox->layout()->addWidget(m_filterSelectors[i]);
+    }
+
+    m_draggableBehaviour = new DraggableChildrenBehaviour(static_cast<QVBoxLayout*> (ui->filterGroupBox->layout()));
+    connect(m_draggableBehaviour, &DraggableChildrenBehaviour::childPositionChanged, [&](QWidget* child, int oldPos, int newPos) {
+        applyFilter();
+    });
+
+    m_adjustmentSelector = new FilterSelector(nullptr, [&](const char* filterName) {
+        auto i = 0;
+        while(adjustments[i]) {
+            if(strcmp(adjustments[i], filterName) == 0)
+                return true;
+
+            ++i;
+        }
+
+        return false;
+    });
+
+    m_adjustmentSelector->setMinimumHeight(50);
+    m_adjustmentSelector->selectCurrentFilter(-1);
+    m_adjustmentSelector->setCurrentIndex(18);
+
+    handleFilterChange(m_adjustmentSelector, -1);
+    ui->adjustmentsGroupBox->layout()->addWidget(m_adjustmentSelector);
+}
+
 void Player::setFile(FileInformation *fileInfo)
 {
     if(fileInfo == nullptr) {
@@ -421,6 +440,7 @@ void Player::setFile(FileInformation *fileInfo)
         delete commentsPlot;
 
         m_fileInformation = fileInfo;
+        createFilterSelectors();
 
         m_commentsPlot = createCommentsPlot(m_fileInformation, nullptr);
         m_commentsPlot->enableAxis(QwtPlot::yLeft, false);
@@ -435,7 +455,7 @@ void Player::setFile(FileInformation *fileInfo)
         dynamic_cast<QFrame*>(m_commentsPlot->canvas())->setFrameStyle( QFrame::NoFrame );
         dynamic_cast<QFrame*>(m_commentsPlot->canvas())->setContentsMargins(0, 0, 0, 0);
 
-        connect( m_commentsPlot, SIGNAL( cursorMoved( int ) ), SLOT( onCursorMoved( int ) ) );
+        connect( m_commentsPlot, SIGNAL( cursorMoved( qint64 ) ), SLOT( onCursorMoved( qint64 ) ) );
         m_commentsPlot->canvas()->installEventFilter( this );
         ui->commentsPlaceHolderFrame->layout()->addWidget(m_commentsPlot);
 
@@ -472,6 +492,11 @@ void Player::setFile(FileInformation *fileInfo)
         }
 
         m_player->stop();
+        m_keyFrames.clear();
+        m_keyFramesScanned = 0;
+        m_previewKeyFramesCount = 0;
+        m_player->setKeyFrames(m_keyFrames);
+        clearCachedFrames();
         m_player->setFile(fileInfo->fileName());
 
         QEventLoop loop;
@@ -534,6 +559,11 @@ void Player::seekBySlider(int value)
 
     qDebug() << "seek to: " << value;
 
+    // Scrubbing shows the frames already displayed at once
+    if(showCachedFrameAt(framePos))
+        return;
+
+    updateKeyFrames();
     m_player->seek(newValue);
 }
 
@@ -565,6 +595,8 @@ void Player::showHideFilters()
 
 void Player::showEvent(QShowEvent *event)
 {
+    createFilterSelectors();
+
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 
 #else
@@ -619,7 +651,7 @@ void Player::updateInfoLabels()
 
     int Milliseconds=(int)-1;
     if (m_fileInformation && !m_fileInformation->Stats.empty()
-     && ( framesPos<m_fileInformation->ReferenceStat()->x_Current
+     && ( framesPos<m_fileInformation->ReferenceStat()->x_Current_Get()
       || (framesPos<m_fileInformation->ReferenceStat()->x_Current_Max && m_fileInformation->ReferenceStat()->x[1][framesPos]))) //Also includes when stats are not ready but timestamp is available
         Milliseconds=(int)(m_fileInformation->ReferenceStat()->x[1][framesPos]*1000);
     else
@@ -751,6 +783,9 @@ void Player::updateVideoOutputSize()
 
 void Player::applyFilter()
 {
+    if(!m_adjustmentSelector)
+        return;
+
     bool useSelectionArea = false;
     if(m_filterSelectors[0]->getFilterName() == "Normal")
     {
@@ -816,6 +851,8 @@ void Player::applyFilter()
     }
 
     ui->loupe_groupBox->setEnabled(useSelectionArea);
+    if (!useSelectionArea)
+        ui->regionOfInterest_pushButton->setChecked(false);
     m_selectionArea->setVisible(useSelectionArea);
 
     ui->plainTextEdit->clear();
@@ -850,6 +887,14 @@ void Player::applyFilter()
         return;
     }
 
+    // Plain "Normal" only converts to RGB, which the video output does: frames are not filtered
+    // so hardware decoded ones stay on the GPU
+    if(definedAudioFilters.empty() && definedVideoFilters.length() == 1 && definedVideoFilters[0] == replaceFilterTokens("format=${preview_pix_fmt},scale")
+        && replaceFilterTokens(m_adjustmentSelector->getFilter()).isEmpty() && !ui->graphmonitor_checkBox->isChecked()) {
+        setFilter(QString());
+        return;
+    }
+
     QString combinedVideoFilter;
     if(!definedVideoFilters.empty())
     {
@@ -866,6 +911,25 @@ void Player::applyFilter()
 
         ui->plainTextEdit->appendPlainText(QString("*** layout ***: \n\n%1").arg(layout));
 
+        // Several views without audio: each one is filtered by its own graph from the same decoded frames,
+        // so changing a view does not filter the others again, and they are composed as xstack would do
+        if(definedAudioFilters.empty() && definedVideoFilters.length() > 1 && !ui->graphmonitor_checkBox->isChecked()) {
+            auto adjustmentFilterString = replaceFilterTokens(m_adjustmentSelector->getFilter());
+            QStringList viewFilters;
+            for(const auto& definedVideoFilter : definedVideoFilters)
+                viewFilters.append("sws_flags=neighbor;" + (!adjustmentFilterString.isEmpty() ? (adjustmentFilterString + ",") : QString()) + definedVideoFilter + ",format=rgb24");
+
+            ui->plainTextEdit->appendPlainText(QString("*** views ***: \n\n%1").arg(viewFilters.join("\n")));
+
+            {
+                QMutexLocker locker(&m_viewsMutex);
+                m_viewsLayout = layout;
+                m_viewsFitToGrid = ui->fitToGrid_checkBox->isChecked();
+            }
+            setFilters(viewFilters);
+            return;
+        }
+
         QString videoSplits[] = {
             "sws_flags=neighbor;%1",
             "sws_flags=neighbor;%1split=2[x1][x2];",
@@ -1019,7 +1083,11 @@ void Player::handleFileInformationPositionChanges()
 
             // ScopedMute mute(m_player);
 
-            m_player->seek(qint64(ms));
+            if(!showCachedFrameAt(m_fileInformation->Frames_Pos_Get()))
+            {
+                updateKeyFrames();
+                m_player->seek(qint64(ms));
+            }
             m_ignorePositionChanges = false;
             ui->playerSlider->setValue(ms);
         }
@@ -1028,7 +1096,7 @@ void Player::handleFileInformationPositionChanges()
     m_commentsPlot->setCursorPos(m_fileInformation->Frames_Pos_Get());
 }
 
-void Player::onCursorMoved(int x)
+void Player::onCursorMoved(qint64 x)
 {
     m_commentsPlot->setCursorPos(x);
     seekBySlider(frameToMs(x));
@@ -1205,16 +1273,158 @@ qint64 Player::timeStringToMs(const QString &timeValue)
     return ms;
 }
 
+// Filters keeping frames or values of the previous frames, their graph is not reused nor fed with the shown frame only
+static bool isTemporalFilter(const QString &filter)
+{
+    static const char* temporalFilters[] = {
+        "tblend",
+        "tmix",
+        "thistogram",
+        "tile",
+        "idet",
+        "drawgraph",
+        nullptr
+    };
+
+    for(auto i = 0; temporalFilters[i]; ++i) {
+        if(filter.contains(QRegularExpression(QString("(^|[,;\\]])%1(=|,|;|\\[|$)").arg(temporalFilters[i]))))
+            return true;
+    }
+
+    return false;
+}
+
 void Player::setFilter(const QString &filter)
 {
-    m_player->setFilter(filter);
+    setFilters(filter.isEmpty() ? QStringList() : QStringList { filter });
+}
+
+void Player::setFilters(const QStringList &filters)
+{
+    clearCachedFrames();
+    QList<bool> cacheable;
+    for(const auto& filter : filters)
+        cacheable.append(!isTemporalFilter(filter));
+
+    // Frames of the unchanged views are kept, moved to their new position
+    bool hasAllViews = true;
+    {
+        QMutexLocker locker(&m_viewsMutex);
+        QVector<QImage> views(filters.size() > 1 ? filters.size() : 0);
+        QVector<double> viewsPts(views.size(), qQNaN());
+        for(auto i = 0; i < views.size(); ++i) {
+            auto previous = m_viewDescs.indexOf(filters[i]);
+            if(previous >= 0 && previous < m_views.size()) {
+                views[i] = m_views[previous];
+                viewsPts[i] = m_viewsPts[previous];
+                m_viewDescs[previous].clear();
+            }
+            hasAllViews &= !views[i].isNull();
+        }
+        m_viewDescs = views.isEmpty() ? QStringList() : filters;
+        m_views = views;
+        m_viewsPts = viewsPts;
+    }
+
+    m_player->setFilters(filters, cacheable);
     if(m_player->isPaused())
     {
+        // The shown frame is filtered again by the changed graphs, else decoded again from the previous key frame
+        if(m_player->refilter())
+        {
+            // Only views removed or moved
+            if(hasAllViews && filters.size() > 1) {
+                composeViews();
+                presentVideoFrame();
+            }
+            return;
+        }
+
         m_player->seek(m_player->position());
         m_player->pause();
     }
 }
 
+bool Player::updateVideoFrame(const QAVVideoFrame &frame)
+{
+    QMutexLocker locker(&m_viewsMutex);
+    if(m_viewDescs.size() < 2) {
+        videoFrame = frame.convertTo(AV_PIX_FMT_RGB32);
+        return true;
+    }
+
+    // Named "<graph>:<output>"
+    bool isView = false;
+    auto view = frame.filterName().section(':', 0, 0).toInt(&isView);
+    if(!isView || view < 0 || view >= m_views.size())
+        return false;
+
+    auto viewFrame = frame.convertTo(AV_PIX_FMT_RGB32);
+    auto mapData = viewFrame.map();
+    m_views[view] = QImage(mapData.data[0], mapData.size.width(), mapData.size.height(), mapData.bytesPerLine[0], QImage::Format_RGB32).copy();
+    m_viewsPts[view] = frame.pts();
+
+    // Composed with the last view, or with any view once all of them have the frame (filtered again when paused)
+    if(view != m_views.size() - 1) {
+        for(auto pts : m_viewsPts)
+            if(pts != frame.pts())
+                return false;
+    }
+
+    locker.unlock();
+    composeViews();
+    return true;
+}
+
+void Player::composeViews()
+{
+    QMutexLocker locker(&m_viewsMutex);
+    if(m_views.isEmpty())
+        return;
+
+    // Fit to grid: views scaled to the first one
+    QVector<QSize> sizes;
+    for(const auto& view : m_views)
+        sizes.append(m_viewsFitToGrid ? m_views[0].size() : view.size());
+
+    // Positions as "x_y" in the layout, with sums of 0, wN and hN
+    auto position = [&](const QString& expression) {
+        int result = 0;
+        for(const auto& term : expression.split('+')) {
+            auto index = term.mid(1).toInt();
+            if(term.startsWith('w') && index < sizes.size())
+                result += sizes[index].width();
+            else if(term.startsWith('h') && index < sizes.size())
+                result += sizes[index].height();
+        }
+        return result;
+    };
+
+    auto positions = m_viewsLayout.split('|');
+    QVector<QRect> rects;
+    QRect bounds;
+    for(auto i = 0; i < m_views.size(); ++i) {
+        auto xy = positions.value(i).split('_');
+        rects.append(QRect(QPoint(position(xy.value(0)), position(xy.value(1 % xy.size()))), sizes[i]));
+        bounds |= rects.back();
+    }
+    if(bounds.isEmpty())
+        return;
+
+    QAVVideoFrame canvas(QSize(bounds.right() + 1, bounds.bottom() + 1), AV_PIX_FMT_RGB32);
+    auto mapData = canvas.map();
+    QImage image(mapData.data[0], mapData.size.width(), mapData.size.height(), mapData.bytesPerLine[0], QImage::Format_RGB32);
+    image.fill(QColor(112, 128, 144)); // slategray
+    QPainter painter(&image);
+    for(auto i = 0; i < m_views.size(); ++i) {
+        if(!m_views[i].isNull())
+            painter.drawImage(rects[i], m_views[i]);
+    }
+    painter.end();
+
+    videoFrame = canvas;
+}
+
 QString getPixFmtLookupValue(QString pixFormatName, int index) {
     static QMap<QString, QStringList> pixFmtLookup = []() -> QMap<QString, QStringList> {
         QMap<QString, QStringList> map;
@@ -1244,6 +1454,17 @@ QString getPixFmtLookupValue(QString pixFormatName, int index) {
     return "unk";
 }
 
+// Decoded format if the filters of the "Normal" formulas take it (planar YUV or gray, in memory), else 4:4:4
+// Formats drawbox or drawtext do not support in this FFmpeg are converted by the graph as if there was no format filter
+static QString getPreviewPixFmt(const std::string& pixFormatName)
+{
+    auto desc = av_pix_fmt_desc_get(av_get_pix_fmt(pixFormatName.c_str()));
+    if(!desc || !((desc->flags & AV_PIX_FMT_FLAG_PLANAR) || desc->nb_components == 1) || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_FLOAT | AV_PIX_FMT_FLAG_BAYER))
+        || desc->nb_components == 2 || desc->nb_components > 3 || (desc->nb_components == 3 && desc->comp[1].plane == desc->comp[2].plane)) // Alpha, semi-planar (nv12, p010)
+        return "yuv444p";
+    return QString::fromLatin1(desc->name);
+}
+
 QString Player::replaceFilterTokens(const QString &filterString)
 {
     QString str = filterString;
@@ -1253,6 +1474,8 @@ QString Player::replaceFilterTokens(const QString &filterString)
     str.replace(QString("${framerate}"), QString::number(m_player->videoFrameRate()));
     str.replace(QString("${dar}"), QString::number(m_fileInformation->dar()));
     str.replace(QString("${pix_fmt}"), QString::fromStdString(m_fileInformation->pixFormatName()));
+    if(str.contains(QString("${preview_pix_fmt}")))
+        str.replace(QString("${preview_pix_fmt}"), getPreviewPixFmt(m_fileInformation->pixFormatName()));
     if(str.contains(QString("${pix_fmt:1}")))
         str.replace(QString("${pix_fmt:1}"), getPixFmtLookupValue(QString::fromStdString(m_fileInformation->pixFormatName()), 1));
     if(str.contains(QString("${pix_fmt:2}")))
@@ -1307,18 +1530,111 @@ QString Player::replaceFilterTokens(const QString &filterString)
     return str;
 }
 
-qint64 Player::frameToMs(int frame)
+qint64 Player::frameToMs(qint64 frame)
 {
     auto ms = qint64(qreal(m_player->duration()) * frame / m_framesCount);
     return ms;
 }
 
-int Player::msToFrame(qint64 ms)
+qint64 Player::msToFrame(qint64 ms)
 {
     auto frame = ceil(qreal(ms) * m_framesCount / m_player->duration());
     return frame;
 }
 
+qint64 Player::nearestFrame(double ms)
+{
+    return qRound64(ms * m_framesCount / m_player->duration());
+}
+
+void Player::presentVideoFrame()
+{
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    auto surface = m_w->videoSurface();
+    if (!surface->isActive() || surface->surfaceFormat().frameSize() != videoFrame.size()) {
+        surface->start({videoFrame.size(), videoFrame.pixelFormat(), videoFrame.handleType()});
+        updateVideoOutputSize();
+    }
+    if (surface->isActive())
+        surface->present(videoFrame);
+#else
+    if(m_w->videoSink()->videoFrame().size() != videoFrame.size()) {
+        m_w->videoSink()->setVideoFrame(videoFrame);
+        QTimer::singleShot(0, [this] { updateVideoOutputSize(); });
+    } else {
+        m_w->videoSink()->setVideoFrame(videoFrame);
+    }
+#endif
+}
+
+void Player::updateKeyFrames()
+{
+    // Same times as the seeks (frameToMs), so the key frame before a frame is found whatever the time stamps
+    auto stats = m_fileInformation ? m_fileInformation->ReferenceStat() : nullptr;
+    if(!stats || stats->Type_Get() != Type_Video || !m_framesCount || m_player->duration() <= 0)
+        return;
+
+    const size_t count = stats->x_Current_Get();
+    auto previewKeyFrames = m_fileInformation->previewKeyFrames();
+    if(count <= m_keyFramesScanned && previewKeyFrames.size() == m_previewKeyFramesCount)
+        return;
+
+    for(size_t frame = m_keyFramesScanned; frame < count; ++frame)
+        if(stats->key_frames[frame])
+            m_keyFrames.append({ frameToMs(int(frame)) / 1000.0, stats->pkt_pos[frame] });
+    m_keyFramesScanned = count;
+    m_previewKeyFramesCount = previewKeyFrames.size();
+
+    // Approximate ones of the preview after the frames parsed so far
+    auto keyFrames = m_keyFrames;
+    auto parsedTime = frameToMs(int(count)) / 1000.0;
+    for(const auto& keyFrame : previewKeyFrames)
+        if(keyFrame.first >= parsedTime)
+            keyFrames.append(keyFrame);
+
+    m_player->setKeyFrames(keyFrames);
+}
+
+bool Player::showCachedFrame(int offset)
+{
+    if(!m_player->isPaused() || !m_framesCount || m_player->duration() <= 0)
+        return false;
+
+    return showCachedFrameAt(nearestFrame(m_player->position()) + offset);
+}
+
+bool Player::showCachedFrameAt(int frame)
+{
+    if(!m_player->isPaused() || !m_framesCount || m_player->duration() <= 0)
+        return false;
+
+    if(frame < 0 || frame >= m_framesCount)
+        return false;
+
+    {
+        QMutexLocker locker(&m_cachedFramesMutex);
+        auto cached = m_cachedFrames.object(frame);
+        if(!cached)
+            return false;
+        videoFrame = *cached;
+        m_gpuFrame = QAVVideoFrame();
+    }
+    presentVideoFrame();
+
+    // The player decodes the same frame, its position follows
+    const auto ms = frameToMs(frame);
+    updateKeyFrames();
+    m_player->seek(ms);
+    m_player->specifyPosition(ms);
+    return true;
+}
+
+void Player::clearCachedFrames()
+{
+    QMutexLocker locker(&m_cachedFramesMutex);
+    m_cachedFrames.clear();
+}
+
 void Player::on_graphmonitor_checkBox_clicked(bool checked)
 {
     applyFilter();
@@ -1348,6 +1664,10 @@ void Player::on_goToEnd_pushButton_clicked()
 
 void Player::on_prev_pushButton_clicked()
 {
+    if(showCachedFrame(-1))
+        return;
+
+    updateKeyFrames();
     auto newPosition = m_player->position() - 1;
     qDebug() << "stepping backward..." << m_player->position();
     SignalWaiter waiter(m_player, "stepped(qint64)");
@@ -1360,6 +1680,9 @@ void Player::on_prev_pushButton_clicked()
 
 void Player::on_next_pushButton_clicked()
 {
+    if(showCachedFrame(1))
+        return;
+
     auto newPosition = m_player->position() + 1;
     qDebug() << "stepping forward..." << m_player->position();
     SignalWaiter waiter(m_player, "stepped(qint64)");
@@ -1396,6 +1719,7 @@ void Player::on_goToTime_lineEdit_returnPressed()
     ui->plainTextEdit->clear();
     ui->plainTextEdit->appendPlainText(QString("*** go to: %1 ***").arg(ms));
 
+    updateKeyFrames();
     m_player->seek(ms);
 }
 
@@ -1405,9 +1729,9 @@ void Player::on_export_pushButton_clicked()
     auto fileName = QFileDialog::getSaveFileName(this, "Export video frame", "", "*.png");
     if(!fileName.isEmpty()) {
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-        auto image = videoFrame.image();
+        auto image = m_gpuFrame ? QVideoFrame(m_gpuFrame.convertTo(AV_PIX_FMT_RGB32)).image() : videoFrame.image();
 #else
-        auto image = videoFrame.toImage();
+        auto image = m_gpuFrame ? QVideoFrame(m_gpuFrame.convertTo(AV_PIX_FMT_RGB32)).toImage() : videoFrame.toImage();
 #endif // QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
         image.save(fileName);
     }
@@ -1449,3 +1773,21 @@ void Player::on_hDoubleSpinBox_valueChanged(double arg1)
     m_selectionArea->setGeometry(geometry);
 }
 
+
+void Player::on_regionOfInterest_pushButton_toggled(bool checked)
+{
+    Q_UNUSED(checked);
+    updateRegionOfInterest();
+}
+
+void Player::updateRegionOfInterest()
+{
+    if (!ui->regionOfInterest_pushButton->isChecked()) {
+        FileInformation::RegionOfInterest_Set(QRect());
+        return;
+    }
+
+    FileInformation::RegionOfInterest_Set(QRect(qRound(ui->xDoubleSpinBox->value()), qRound(ui->yDoubleSpinBox->value()),
+                                                qRound(ui->wDoubleSpinBox->value()), qRound(ui->hDoubleSpinBox->value())));
+}
+
@@ -2,6 +2,9 @@
 #define PLAYER_H
 
 #include <QMainWindow>
+#include <QCache>
+#include <QImage>
+#include <QMutex>
 #include <QPushButton>
 #include <QTimer>
 #include <QWidget>
@@ -205,7 +208,7 @@ private Q_SLOTS:
     void updateVideoOutputSize();
     void applyFilter();
     void handleFileInformationPositionChanges();
-    void onCursorMoved(int index);
+    void onCursorMoved(qint64 index);
 
 private Q_SLOTS:
     void on_playPause_pushButton_clicked();
@@ -246,16 +249,41 @@ private Q_SLOTS:
 
     void on_hDoubleSpinBox_valueChanged(double arg1);
 
+    void on_regionOfInterest_pushButton_toggled(bool checked);
+
+    void updateRegionOfInterest();
+
 private:
     void setScaleSliderPercentage(int percents);
     void setScaleSpinboxPercentage(int percents);
     void handleFilterChange(FilterSelector *filterSelector, int filterIndex);
+    void createFilterSelectors();
     void setFilter(const QString& filter);
+    void setFilters(const QStringList& filters);
     QString replaceFilterTokens(const QString& filterString);
 
 private:
-    qint64 frameToMs(int frame);
-    int msToFrame(qint64 ms);
+    qint64 frameToMs(qint64 frame);
+    qint64 msToFrame(qint64 ms);
+    qint64 nearestFrame(double ms);
+
+    // Video frame presented on the video item
+    void presentVideoFrame();
+
+    // Video frame from a filtered frame, the views filtered by their own graph (see applyFilter()) are composed
+    // in it; false if the frame waits for the frames of the other views
+    bool updateVideoFrame(const QAVVideoFrame& frame);
+    void composeViews();
+
+    // Key frames found by the analysis so far, for the seeks of the player
+    void updateKeyFrames();
+
+    // Displays the frame at offset from the current one if it was already displayed with the current filters,
+    // the player seeks to it in the background; false if the frame is not cached or the player is not paused
+    bool showCachedFrame(int offset);
+    // Same for a frame number, e.g. the one of the cursor dragged across the plots
+    bool showCachedFrameAt(int frame);
+    void clearCachedFrames();
 
 private:
     Ui::Player *ui;
@@ -267,15 +295,16 @@ private:
 
     QScopedPointer<QAVAudioOutput> m_audioOutput;
     QVideoFrame videoFrame;
+    QAVVideoFrame m_gpuFrame; // Displayed frame if it is on the GPU, see applyFilter()
 
     bool m_handlePlayPauseClick;
 
-    int m_framesCount;
+    qint64 m_framesCount;
 
     FileInformation* m_fileInformation;
-    FilterSelector* m_filterSelectors[6];
-    FilterSelector* m_adjustmentSelector;
-    DraggableChildrenBehaviour* m_draggableBehaviour;
+    FilterSelector* m_filterSelectors[6] {};
+    FilterSelector* m_adjustmentSelector { nullptr };
+    DraggableChildrenBehaviour* m_draggableBehaviour { nullptr };
     CommentsPlot* m_commentsPlot;
     bool m_seekOnFileInformationPositionChange;
     bool m_ignorePositionChanges;
@@ -285,6 +314,27 @@ private:
     qreal m_scaleFactor;
     QSize m_videoFrameSize;
     QTimer m_filterUpdateTimer;
+
+    // See updateKeyFrames()
+    QVector<QPair<double, qint64>> m_keyFrames;
+    size_t m_keyFramesScanned { 0 };
+    int m_previewKeyFramesCount { 0 }; // See FileInformation::previewKeyFrames()
+
+    // Frames displayed with the current filters by frame number, cost in KiB, see showCachedFrame()
+    static const int cachedFramesKiB = 256 * 1024;
+    QMutex m_cachedFramesMutex;
+    QCache<int, QVideoFrame> m_cachedFrames { cachedFramesKiB };
+
+    // Filter graphs kept for switching back to a filter without creating it again, see setFilter()
+    static const int filterCacheSize = 6;
+
+    // Last frame of each view filtered by its own graph, see updateVideoFrame()
+    QMutex m_viewsMutex;
+    QStringList m_viewDescs;
+    QString m_viewsLayout; // As xstack
+    bool m_viewsFitToGrid { false };
+    QVector<QImage> m_views;
+    QVector<double> m_viewsPts;
 };
 
 #endif // PLAYER_H
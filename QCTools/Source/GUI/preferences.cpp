@@ -9,6 +9,9 @@
 #include "ui_preferences.h"
 #include "Core/SignalServerConnectionChecker.h"
 #include "Core/Preferences.h"
+#include "Core/AnalysisProfiles.h"
+#include "Core/StatsCompression.h"
+#include "Core/FFmpegVideoEncoder.h"
 #include <QSettings>
 #include <QStandardPaths>
 #include <QMetaType>
@@ -19,6 +22,7 @@
 #include <QTimer>
 #include <QFileDialog>
 #include <QDesktopServices>
+#include <QMessageBox>
 //---------------------------------------------------------------------------
 
 //***************************************************************************
@@ -38,6 +42,21 @@ PreferencesDialog::PreferencesDialog(Preferences* preferences, SignalServerConne
     connect(this, SIGNAL(accepted()), this, SLOT(OnAccepted()));
     connect(this, SIGNAL(rejected()), this, SLOT(OnRejected()));
 
+    for (int Profile = 0; Profile < AnalysisProfiles::Profile_Max; Profile++)
+        ui->analysisProfile_comboBox->addItem(AnalysisProfiles::Name((AnalysisProfiles::profile)Profile));
+
+    // Formats of this build only
+    for (int Format = 0; Format < StatsCompression::Format_Max; Format++)
+        if (StatsCompression::Check((StatsCompression::format)Format).isEmpty())
+            ui->reportCompression_comboBox->addItem(StatsCompression::Name((StatsCompression::format)Format));
+    connect(ui->sampling_comboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this](int index) {
+        ui->sampling_spinBox->setEnabled(index == 2);
+    });
+#ifndef QCTOOLS_QWT_OPENGL
+    ui->plotsOpenGL_checkBox->setEnabled(false);
+    ui->plotsOpenGL_checkBox->setToolTip("Qwt is built without OpenGL");
+#endif
+
     Load();
 }
 
@@ -121,15 +140,39 @@ void PreferencesDialog::Load()
     ui->Filters_Video_EntropyDiff->setChecked(ActiveFilters[ActiveFilter_Video_EntropyDiff]);
     ui->Filters_Video_blockdetect->setChecked(ActiveFilters[ActiveFilter_Video_blockdetect]);
     ui->Filters_Video_blurdetect->setChecked(ActiveFilters[ActiveFilter_Video_blurdetect]);
+    ui->Filters_Video_blackdetect->setChecked(ActiveFilters[ActiveFilter_Video_blackdetect]);
+    ui->Filters_Video_freezedetect->setChecked(ActiveFilters[ActiveFilter_Video_freezedetect]);
+    ui->Filters_Video_HdrLight->setChecked(ActiveFilters[ActiveFilter_Video_HdrLight]);
     ui->Filters_Audio_EbuR128->setChecked(ActiveFilters[ActiveFilter_Audio_EbuR128]);
     ui->Filters_Audio_aphasemeter->setChecked(ActiveFilters[ActiveFilter_Audio_aphasemeter]);
     ui->Filters_Audio_astats->setChecked(ActiveFilters[ActiveFilter_Audio_astats]);
+    ui->Filters_Audio_silencedetect->setChecked(ActiveFilters[ActiveFilter_Audio_silencedetect]);
 
     ui->Tracks_Video_First->setChecked(!ActiveAllTracks[Type_Video]);
     ui->Tracks_Video_All->setChecked(ActiveAllTracks[Type_Video]);
     ui->Tracks_Audio_First->setChecked(!ActiveAllTracks[Type_Audio]);
     ui->Tracks_Audio_All->setChecked(ActiveAllTracks[Type_Audio]);
 
+    ui->memoryBudget_spinBox->setValue(preferences->memoryBudget());
+    ui->backgroundAnalysis_checkBox->setChecked(preferences->backgroundAnalysis());
+    ui->backgroundAnalysisCores_spinBox->setValue(preferences->backgroundAnalysisCores());
+    ui->analysisProcess_checkBox->setChecked(preferences->analysisProcess());
+    ui->analysisProfile_comboBox->setCurrentIndex(qMax(0, ui->analysisProfile_comboBox->findText(preferences->analysisProfile())));
+    auto sampling = preferences->sampling();
+    ui->sampling_comboBox->setCurrentIndex(sampling < 0 ? 1 : sampling > 1 ? 2 : 0);
+    if (sampling > 1)
+        ui->sampling_spinBox->setValue(sampling);
+    auto reportCompression = ui->reportCompression_comboBox->findText(preferences->reportCompression());
+    ui->reportCompression_comboBox->setCurrentIndex(reportCompression >= 0 ? reportCompression : ui->reportCompression_comboBox->findText(StatsCompression::Name(StatsCompression::Format_Gzip)));
+    ui->reportCompressionLevel_spinBox->setValue(preferences->reportCompressionLevel());
+    ui->decoderThreads_spinBox->setValue(preferences->decoderThreads());
+    auto decoderThreadType = preferences->decoderThreadType();
+    ui->decoderThreadType_comboBox->setCurrentIndex(decoderThreadType == "frame" ? 1 : decoderThreadType == "slice" ? 2 : 0);
+    ui->filterThreads_spinBox->setValue(preferences->filterThreads());
+    ui->thumbnailsCodec_lineEdit->setText(preferences->thumbnailsCodec());
+    ui->panelsCodec_lineEdit->setText(preferences->panelsCodec());
+    ui->plotsOpenGL_checkBox->setChecked(preferences->plotsOpenGL());
+
     if (QCvaultPathString().isEmpty())
         ui->QCvaultPath_None->setChecked(true);
     else if (QCvaultPathString()==defaultQCvaultPathString())
@@ -163,6 +206,46 @@ void PreferencesDialog::Save()
         A.insert(*it);
     preferences->setActivePanels(A);
 
+    preferences->setMemoryBudget(ui->memoryBudget_spinBox->value());
+    preferences->setBackgroundAnalysis(ui->backgroundAnalysis_checkBox->isChecked());
+    preferences->setBackgroundAnalysisCores(ui->backgroundAnalysisCores_spinBox->value());
+    preferences->setAnalysisProcess(ui->analysisProcess_checkBox->isChecked());
+    preferences->setAnalysisProfile(ui->analysisProfile_comboBox->currentText());
+    switch (ui->sampling_comboBox->currentIndex())
+    {
+    case 1: preferences->setSampling(-1); break;
+    case 2: preferences->setSampling(ui->sampling_spinBox->value()); break;
+    default: preferences->setSampling(0);
+    }
+    preferences->setReportCompression(ui->reportCompression_comboBox->currentText());
+    preferences->setReportCompressionLevel(ui->reportCompressionLevel_spinBox->value());
+    preferences->setDecoderThreads(ui->decoderThreads_spinBox->value());
+    switch (ui->decoderThreadType_comboBox->currentIndex())
+    {
+    case 1: preferences->setDecoderThreadType("frame"); break;
+    case 2: preferences->setDecoderThreadType("slice"); break;
+    default: preferences->setDecoderThreadType(QString());
+    }
+    preferences->setFilterThreads(ui->filterThreads_spinBox->value());
+
+    // Encoders not available are not kept, the previous ones stay
+    QStringList codecIssues;
+    auto codecIsAvailable = [&codecIssues](const QString& codec) {
+        auto issue = codec.isEmpty() ? QString() : FFmpegVideoEncoder::Codec::parse(codec).check();
+        if (!issue.isEmpty())
+            codecIssues.append(QString("%1: %2").arg(codec).arg(issue));
+        return issue.isEmpty();
+    };
+    auto thumbnailsCodec = ui->thumbnailsCodec_lineEdit->text().trimmed();
+    if (codecIsAvailable(thumbnailsCodec))
+        preferences->setThumbnailsCodec(thumbnailsCodec);
+    auto panelsCodec = ui->panelsCodec_lineEdit->text().trimmed();
+    if (codecIsAvailable(panelsCodec))
+        preferences->setPanelsCodec(panelsCodec);
+    preferences->setPlotsOpenGL(ui->plotsOpenGL_checkBox->isChecked());
+    if (!codecIssues.isEmpty())
+        QMessageBox::warning(this, "Preferences", "Encoders not available, the previous ones are kept:\n" + codecIssues.join('\n'));
+
     preferences->setQCvaultPathString(ui->QCvaultPath_lineEdit->text());
 
     preferences->setSignalServerUrlString(ui->signalServerUrl_lineEdit->text());
@@ -202,12 +285,20 @@ void PreferencesDialog::OnAccepted()
         ActiveFilters.set(ActiveFilter_Video_blockdetect);
     if (ui->Filters_Video_blurdetect->isChecked())
         ActiveFilters.set(ActiveFilter_Video_blurdetect);
+    if (ui->Filters_Video_blackdetect->isChecked())
+        ActiveFilters.set(ActiveFilter_Video_blackdetect);
+    if (ui->Filters_Video_freezedetect->isChecked())
+        ActiveFilters.set(ActiveFilter_Video_freezedetect);
+    if (ui->Filters_Video_HdrLight->isChecked())
+        ActiveFilters.set(ActiveFilter_Video_HdrLight);
     if (ui->Filters_Audio_EbuR128->isChecked())
         ActiveFilters.set(ActiveFilter_Audio_EbuR128);
     if (ui->Filters_Audio_aphasemeter->isChecked())
         ActiveFilters.set(ActiveFilter_Audio_aphasemeter);
     if (ui->Filters_Audio_astats->isChecked())
         ActiveFilters.set(ActiveFilter_Audio_astats);
+    if (ui->Filters_Audio_silencedetect->isChecked())
+        ActiveFilters.set(ActiveFilter_Audio_silencedetect);
 
     ActiveAllTracks.reset();
     if (ui->Tracks_Video_All->isChecked())
@@ -29,6 +29,11 @@ bool YMinMaxSelector::isMinMaxFromThePlot() const
     return ui->minMaxOfThePlot_radioButton->isChecked();
 }
 
+bool YMinMaxSelector::isMinMaxOfTheVisibleFrames() const
+{
+    return ui->minMaxOfTheVisibleFrames_radioButton->isChecked();
+}
+
 bool YMinMaxSelector::isFormula() const
 {
     return ui->minMaxSystemProvided_radioButton->isChecked();
@@ -62,6 +67,8 @@ void YMinMaxSelector::setPlot(Plot *plot)
         ui->minMaxSystemProvided_radioButton->setChecked(true);
     } else if(plot->yAxisMinMaxMode() == Plot::Custom) {
         ui->customMinMax_radioButton->setChecked(true);
+    } else if(plot->yAxisMinMaxMode() == Plot::MinMaxOfTheVisibleFrames) {
+        ui->minMaxOfTheVisibleFrames_radioButton->setChecked(true);
     }
 
     double min, max;
@@ -100,6 +107,10 @@ void YMinMaxSelector::on_apply_pushButton_clicked()
     {
         m_plot->setYAxisMinMaxMode(Plot::MinMaxOfThePlot);
     }
+    else if(isMinMaxOfTheVisibleFrames())
+    {
+        m_plot->setYAxisMinMaxMode(Plot::MinMaxOfTheVisibleFrames);
+    }
     else if(isCustom())
     {
         m_plot->setYAxisCustomMinMax(ui->min_doubleSpinBox->value(), ui->max_doubleSpinBox->value());
@@ -180,6 +191,13 @@ void YMinMaxSelector::on_minMaxOfThePlot_radioButton_clicked()
 }
 
 
+void YMinMaxSelector::on_minMaxOfTheVisibleFrames_radioButton_clicked()
+{
+    updateApplyButton();
+    updateMinMaxStyling();
+}
+
+
 void YMinMaxSelector::on_minMaxSystemProvided_radioButton_clicked()
 {
     updateApplyButton();
@@ -17,6 +17,7 @@ public:
     ~YMinMaxSelector();
 
     bool isMinMaxFromThePlot() const;
+    bool isMinMaxOfTheVisibleFrames() const;
     bool isFormula() const;
     bool isCustom() const;
 
@@ -30,6 +31,7 @@ private Q_SLOTS:
     void on_min_doubleSpinBox_valueChanged(double arg1);
     void on_max_doubleSpinBox_valueChanged(double arg1);
     void on_minMaxOfThePlot_radioButton_clicked();
+    void on_minMaxOfTheVisibleFrames_radioButton_clicked();
     void on_minMaxSystemProvided_radioButton_clicked();
     void on_customMinMax_radioButton_clicked();
 
@@ -0,0 +1,408 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "microbench.h"
+#include "Core/ConditionExpression.h"
+#include "Core/StatsNumbers.h"
+#include "Core/StatsXmlWriter.h"
+#include "Core/VideoCore.h"
+#include "Core/VideoStats.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QThread>
+#include <QtAVPlayer/qavframe.h>
+#include <QtAVPlayer/qavstream.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+#include <libavutil/dict.h>
+}
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+const int Width = 1920;
+const int Height = 1080;
+const int64_t FrameDuration = 40; // 25 fps in the time base of the stream
+const size_t MetadataVariants = 64; // Sets of values the frames cycle through
+
+// Results read so the compiler keeps the loops
+volatile double sink;
+
+//---------------------------------------------------------------------------
+// Video stream of the synthetic frames, and their metadata
+struct source
+{
+    AVFormatContext* context;
+    std::vector<AVDictionary*> metadata;
+
+    source(bool allItems)
+    {
+        context = avformat_alloc_context();
+        AVStream* stream = avformat_new_stream(context, nullptr);
+        stream->time_base = AVRational {1, 1000};
+        stream->avg_frame_rate = AVRational {25, 1};
+        stream->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+        stream->codecpar->width = Width;
+        stream->codecpar->height = Height;
+
+        // Values of all the items of the filters, or the ones of the plot only, different from one set to the next
+        for(size_t variant = 0; variant < MetadataVariants; ++variant)
+        {
+            AVDictionary* dictionary = nullptr;
+            for(size_t j = 0; j < Item_VideoMax; ++j)
+            {
+                const auto& item = VideoPerItem[j];
+                if(!item.FFmpeg_Name || item.Filter == activefilter(-1) || (!allItems && j != Item_YAVG && j != Item_YMAX))
+                    continue;
+                char value[32];
+                snprintf(value, sizeof(value), "%.6f", (double)((j * 13 + variant * 7) % 256) + variant / 64.0);
+                av_dict_set(&dictionary, item.FFmpeg_Name, value, 0);
+            }
+            metadata.push_back(dictionary);
+        }
+    }
+
+    ~source()
+    {
+        for(auto& dictionary : metadata)
+            av_dict_free(&dictionary);
+        avformat_free_context(context);
+    }
+};
+
+//---------------------------------------------------------------------------
+// Access to the memory management of the parsers
+class ReservingStats : public VideoStats
+{
+public:
+    using VideoStats::VideoStats;
+
+    void reserve(size_t frames) {Data_Reserve(frames);}
+    size_t reserved() const {return Data_Reserved;}
+};
+
+}
+
+//***************************************************************************
+// Benchmarks
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+// As the parsers do for each frame of the stats graphs
+qint64 MicroBench::statsFromFrame(size_t frames, bool allItems, std::unique_ptr<VideoStats>& stats)
+{
+    source input(allItems);
+    QAVStream stream(0, input.context);
+    stats.reset(new VideoStats(frames, 0, &stream));
+    stats->setWidth(Width);
+    stats->setHeight(Height);
+
+    QAVFrame frame;
+    AVFrame* avFrame = frame.frame();
+    avFrame->width = Width;
+    avFrame->height = Height;
+    avFrame->format = AV_PIX_FMT_YUV422P;
+    avFrame->key_frame = 1;
+    avFrame->pict_type = AV_PICTURE_TYPE_I;
+    avFrame->pkt_size = 200000;
+    avFrame->pkt_duration = FrameDuration;
+
+    QElapsedTimer timer;
+    timer.start();
+    for(size_t i = 0; i < frames; ++i)
+    {
+        avFrame->pts = i * FrameDuration;
+        avFrame->pkt_pos = i * avFrame->pkt_size;
+        avFrame->metadata = input.metadata[i % MetadataVariants];
+        stats->TimeStampFromFrame(frame, stats->x_Current);
+        stats->StatsFromFrame(frame, Width, Height);
+    }
+    stats->StatsFinish();
+    qint64 elapsed = timer.nsecsElapsed();
+
+    // Owned by the source
+    avFrame->metadata = nullptr;
+    return elapsed;
+}
+
+//---------------------------------------------------------------------------
+// As the reload of a report
+qint64 MicroBench::parseFrame(const std::string& xml, size_t& frames)
+{
+    std::unique_ptr<VideoStats> stats(new VideoStats(0));
+
+    QElapsedTimer timer;
+    timer.start();
+    CommonStats::statsFromExternalData(xml.data(), xml.size(), [&](int type, int) -> CommonStats* {
+        return type == Type_Video ? stats.get() : nullptr;
+    });
+    stats->StatsFromExternalData_Finish();
+    qint64 elapsed = timer.nsecsElapsed();
+
+    frames = stats->x_Current;
+    return elapsed;
+}
+
+//---------------------------------------------------------------------------
+// As the export of a report, window frames at a time (as the checkpoints of the live analysis)
+qint64 MicroBench::statsToXml(VideoStats& stats, size_t window, std::string* xml)
+{
+    activefilters filters;
+    filters.set();
+    StatsXmlWriter writer([&](const char* data, size_t size) {
+        if(xml)
+            xml->append(data, size);
+        return true;
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    writer.Text("<ffprobe:ffprobe>\n    <frames>\n");
+    for(size_t begin = 0; begin < stats.x_Current; begin += window)
+        stats.StatsToXML(writer, filters, begin, std::min(begin + window, stats.x_Current));
+    writer.Text("    </frames>\n</ffprobe:ffprobe>\n");
+    writer.Finish();
+    return timer.nsecsElapsed();
+}
+
+//---------------------------------------------------------------------------
+// Growth of the columns from the default reservation of a stream of unknown length, one chunk at a time
+qint64 MicroBench::dataReserve(size_t frames)
+{
+    std::unique_ptr<ReservingStats> stats(new ReservingStats(0));
+
+    QElapsedTimer timer;
+    timer.start();
+    while(stats->reserved() < frames)
+        stats->reserve(stats->reserved());
+    return timer.nsecsElapsed();
+}
+
+//---------------------------------------------------------------------------
+// As PlotSeriesData::setView() then sample() for each position, the pyramid of the item is built by the first view
+qint64 MicroBench::plotPositions(VideoStats& stats, size_t buckets)
+{
+    std::vector<uint32_t> positions;
+    double sum = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    stats.y_PlotPositions(Item_YAVG, 0, stats.x_Current, buckets, positions);
+    for(auto position : positions)
+        sum += stats.x[1][position] + stats.y[Item_YAVG][position];
+    qint64 elapsed = timer.nsecsElapsed();
+
+    sink = sum;
+    return elapsed;
+}
+
+//---------------------------------------------------------------------------
+// As PlotSeriesData::toBarchart() for each frame, with the native version of the condition
+qint64 MicroBench::barchart(VideoStats& stats)
+{
+    auto condition = ConditionExpression::Compile("y > 235 || y < 16", [](const std::string&, double&) { return false; });
+    if(!condition)
+        return 0;
+    std::vector<uint64_t> bits;
+
+    QElapsedTimer timer;
+    timer.start();
+    condition->Match(stats.y[Item_YMAX], 0, stats.x_Current, bits);
+    qint64 elapsed = timer.nsecsElapsed();
+
+    sink = bits.empty() ? 0 : bits.back();
+    return elapsed;
+}
+
+//---------------------------------------------------------------------------
+// As the ingest and the parsing do for each value of the metadata and of the attributes, or with atof() of the C library
+qint64 MicroBench::parseNumbers(const std::vector<std::string>& values, bool libc)
+{
+    double sum = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    if(libc)
+    {
+        for(const auto& value : values)
+            sum += std::atof(value.c_str());
+    }
+    else
+    {
+        for(const auto& value : values)
+            sum += Number_ToDouble(value.c_str());
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+
+    sink = sum;
+    return elapsed;
+}
+
+//***************************************************************************
+// Run
+//***************************************************************************
+
+//---------------------------------------------------------------------------
+void MicroBench::measure(const QString& name, size_t frames, const std::function<qint64()>& run)
+{
+    if(!only.isEmpty() && !only.contains(name))
+        return;
+
+    qint64 best = 0;
+    for(int i = 0; i < repeat; ++i)
+    {
+        qint64 elapsed = run();
+        if(!i || elapsed < best)
+            best = elapsed;
+    }
+    double perFrame = frames ? (double)best / frames : 0;
+
+    results.append(QJsonObject {
+        {"benchmark", name},
+        {"frames", (qint64)frames},
+        {"seconds", best / 1e9},
+        {"ns_per_frame", perFrame},
+    });
+    std::cerr << name.toStdString() << ": " << perFrame << " ns/frame (" << frames << " frames)" << std::endl;
+}
+
+//---------------------------------------------------------------------------
+int MicroBench::exec(QCoreApplication& a)
+{
+    auto arguments = a.arguments();
+    size_t frames = 100000;
+    size_t points = 1000000;
+    size_t window = 10000;
+    QString output;
+    for(int i = 1; i < arguments.size(); ++i)
+    {
+        auto count = [&]() { return (i + 1) < arguments.size() ? (size_t)arguments.at(++i).toULongLong() : (size_t)0; };
+        if(arguments.at(i) == "-o" && (i + 1) < arguments.size())
+            output = arguments.at(++i);
+        else if(arguments.at(i) == "--frames")
+            frames = count();
+        else if(arguments.at(i) == "--points")
+            points = count();
+        else if(arguments.at(i) == "--window")
+            window = count();
+        else if(arguments.at(i) == "--repeat")
+            repeat = (int)count();
+        else if(arguments.at(i) == "--only" && (i + 1) < arguments.size())
+            only = arguments.at(++i).split(',');
+        else
+        {
+            frames = 0;
+            break;
+        }
+    }
+    if(!frames || !points || !window || repeat <= 0)
+    {
+        std::cout << "Usage: qctools-microbench [options]" << std::endl
+                  << "-o <file>" << std::endl
+                  << "    Write the JSON results in this file instead of stdout." << std::endl
+                  << "--frames <count>" << std::endl
+                  << "    Frames of the ingest, export and parsing benchmarks. Default is 100000." << std::endl
+                  << "--points <count>" << std::endl
+                  << "    Frames of the plot benchmarks, values of the number parsing ones. Default is 1000000." << std::endl
+                  << "--window <count>" << std::endl
+                  << "    Frames exported at a time. Default is 10000." << std::endl
+                  << "--repeat <count>" << std::endl
+                  << "    Runs of each benchmark, the fastest one is kept. Default is 5." << std::endl
+                  << "--only <name,...>" << std::endl
+                  << "    Benchmarks run: stats_from_frame, stats_to_xml, parse_frame, data_reserve," << std::endl
+                  << "    plot_view, plot_samples, barchart, parse_numbers, parse_numbers_libc." << std::endl
+                  << "    Default is all of them." << std::endl;
+        return 1;
+    }
+
+    // Frames of all the items, kept for the export, and their report for the parsing
+    std::unique_ptr<VideoStats> stats;
+    measure("stats_from_frame", frames, [&]() { return statsFromFrame(frames, true, stats); });
+    if(!stats)
+        statsFromFrame(frames, true, stats);
+    measure("stats_to_xml", frames, [&]() { return statsToXml(*stats, window, nullptr); });
+    std::string xml;
+    statsToXml(*stats, window, &xml);
+    stats.reset();
+    size_t parsedFrames = 0;
+    measure("parse_frame", frames, [&]() { return parseFrame(xml, parsedFrames); });
+    xml.clear();
+    measure("data_reserve", points, [&]() { return dataReserve(points); });
+
+    // Curves of one item, the pyramid of a new stats is built by each run
+    measure("plot_view", points, [&]() {
+        std::unique_ptr<VideoStats> plotStats;
+        statsFromFrame(points, false, plotStats);
+        return plotPositions(*plotStats, Width);
+    });
+    statsFromFrame(points, false, stats);
+    measure("plot_samples", points, [&]() {
+        QElapsedTimer timer;
+        timer.start();
+        double sum = 0;
+        for(size_t i = 0; i < stats->x_Current; ++i)
+            sum += stats->x[1][i] + stats->y[Item_YAVG][i];
+        sink = sum;
+        return timer.nsecsElapsed();
+    });
+    measure("barchart", points, [&]() { return barchart(*stats); });
+    stats.reset();
+
+    // Values as the filters write them (%.6f of the stats, %g of the kernels) and as the reports have them (integers)
+    std::vector<std::string> values;
+    values.reserve(points);
+    for(size_t i = 0; i < points; ++i)
+    {
+        char value[32];
+        double number = (double)((i * 13) % 256) + (i % 64) / 64.0;
+        switch(i % 3)
+        {
+            case 0: snprintf(value, sizeof(value), "%.6f", number); break;
+            case 1: snprintf(value, sizeof(value), "%g", -number / 1000); break;
+            default: snprintf(value, sizeof(value), "%zu", i * 4096); break;
+        }
+        values.push_back(value);
+    }
+    measure("parse_numbers", points, [&]() { return parseNumbers(values, false); });
+    measure("parse_numbers_libc", points, [&]() { return parseNumbers(values, true); });
+
+    QJsonObject document {
+        {"ffmpeg", av_version_info()},
+        {"qt", qVersion()},
+        {"os", QSysInfo::prettyProductName()},
+        {"cpu", QSysInfo::currentCpuArchitecture()},
+        {"threads", QThread::idealThreadCount()},
+        {"results", results},
+    };
+    auto json = QJsonDocument(document).toJson();
+    if(output.isEmpty())
+    {
+        std::cout << json.constData();
+    }
+    else
+    {
+        QFile file(output);
+        if(!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+        {
+            std::cerr << output.toStdString() << " can not be written" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+//---------------------------------------------------------------------------
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class VideoStats;
+
+//---------------------------------------------------------------------------
+// Time of the hot paths of the analysis alone, in nanoseconds per frame, so a
+// change of one of them is measured without the decoding and the filters of
+// qctools-bench.
+//
+// The frames are synthetic: metadata of all the video items (as set by the
+// filters) for the ingest, the XML of these frames for the parsing and the
+// export, one value per frame for the plots (the decimation of the curves
+// and the conditions of the barcharts), the values of the metadata for the
+// parsing of the numbers. Each benchmark is run several times, the fastest
+// run is kept. Results are written as JSON.
+class MicroBench
+{
+public:
+    int exec(QCoreApplication& a);
+
+private:
+    // Each one returns the nanoseconds of one run
+    qint64 statsFromFrame(size_t frames, bool allItems, std::unique_ptr<VideoStats>& stats);
+    qint64 parseFrame(const std::string& xml, size_t& frames);
+    qint64 statsToXml(VideoStats& stats, size_t window, std::string* xml);
+    qint64 dataReserve(size_t frames);
+    qint64 plotPositions(VideoStats& stats, size_t buckets);
+    qint64 barchart(VideoStats& stats);
+    qint64 parseNumbers(const std::vector<std::string>& values, bool libc);
+
+    void measure(const QString& name, size_t frames, const std::function<qint64()>& run);
+
+    QStringList only;               // Names of the benchmarks run, all of them if empty
+    int repeat {5};
+    QJsonArray results;
+};
+
+#endif // MICROBENCH_H
@@ -0,0 +1,124 @@
+/*  Copyright (c) BAVC. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license that can
+ *  be found in the License.html file in the root of the source tree.
+ */
+
+//---------------------------------------------------------------------------
+#include "Core/CpuFeatures.h"
+#include "Core/SignalStatsKernel.h"
+
+#include <QtTest/QtTest>
+
+extern "C"
+{
+#include <libavfilter/avfilter.h>
+#include <libavfilter/buffersink.h>
+#include <libavutil/dict.h>
+#include <libavutil/frame.h>
+}
+
+//---------------------------------------------------------------------------
+// Values of SignalStatsKernel compared to the ones of the signalstats filter of the FFmpeg linked, frame by frame
+// and as written in the metadata (see SignalStatsKernel::Check), for each instruction set available on the machine
+class tst_SignalStatsKernel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+    void sameAsFilter_data();
+    void sameAsFilter();
+};
+
+//---------------------------------------------------------------------------
+namespace
+{
+
+// Frames of a generated clip through the filter and the kernel, the first difference if any
+QString compare(const QString& source, bool lumaOnly, int& frames)
+{
+    const QByteArray description = (source + ",signalstats=stat=tout+vrep+brng").toUtf8();
+    AVFilterGraph* graph = avfilter_graph_alloc();
+    AVFilterInOut* inputs = nullptr;
+    AVFilterInOut* outputs = nullptr;
+    AVFilterContext* sink = nullptr;
+    bool ok = graph
+        && avfilter_graph_create_filter(&sink, avfilter_get_by_name("buffersink"), "out", nullptr, nullptr, graph) >= 0
+        && avfilter_graph_parse2(graph, description.constData(), &inputs, &outputs) >= 0
+        && !inputs && outputs && !outputs->next
+        && avfilter_link(outputs->filter_ctx, outputs->pad_idx, sink, 0) >= 0
+        && avfilter_graph_config(graph, nullptr) >= 0;
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+
+    QString result;
+    frames = 0;
+    if (!ok)
+        result = QString("graph %1 can not be created").arg(description.constData());
+
+    SignalStatsKernel kernel(lumaOnly);
+    AVFrame* frame = av_frame_alloc();
+    while (result.isEmpty() && av_buffersink_get_frame(sink, frame) >= 0) {
+        if (!av_dict_get(frame->metadata, SignalStatsKernel::Name(SignalStatsKernel::Value_YAVG), nullptr, 0))
+            result = QString("frame %1 has no metadata of the filter").arg(frames);
+        else if (!kernel.Compute(frame))
+            result = QString("frame %1 is not computed").arg(frames);
+        else {
+            auto differences = kernel.Check(frame->metadata);
+            if (!differences.empty())
+                result = QString("frame %1: %2").arg(frames).arg(differences.c_str());
+        }
+        av_frame_unref(frame);
+        ++frames;
+    }
+    av_frame_free(&frame);
+    avfilter_graph_free(&graph);
+    return result;
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
+void tst_SignalStatsKernel::cleanup()
+{
+    CpuFeatures::Set(CpuFeatures::Best());
+}
+
+//---------------------------------------------------------------------------
+void tst_SignalStatsKernel::sameAsFilter_data()
+{
+    QTest::addColumn<QString>("source");
+    QTest::addColumn<bool>("lumaOnly");
+
+    // Noise for the temporal outliers and the differences, contrast for the values out of the broadcast range
+    const QString clip = QLatin1String("testsrc2=size=352x288:rate=25:duration=2,noise=alls=24:allf=t+u,eq=contrast=1.6,format=");
+    for (const char* format : { "yuv420p", "yuv422p", "yuv444p", "yuv410p", "yuvj420p", "yuv420p10le", "yuv422p12le", "yuv444p16le" })
+        QTest::newRow(format) << clip + format << false;
+    QTest::newRow("yuv420p luma only") << clip + "yuv420p" << true;
+    QTest::newRow("yuv420p10le luma only") << clip + "yuv420p10le" << true;
+
+    // Odd sizes, the last columns and lines of the chroma and the tails of the vector loops
+    QTest::newRow("yuv420p odd size") << QString("testsrc2=size=355x233:rate=25:duration=1,noise=alls=24:allf=t+u,format=yuv420p") << false;
+    QTest::newRow("yuv422p10le odd size") << QString("testsrc2=size=355x233:rate=25:duration=1,noise=alls=24:allf=t+u,format=yuv422p10le") << false;
+}
+
+//---------------------------------------------------------------------------
+void tst_SignalStatsKernel::sameAsFilter()
+{
+    QFETCH(QString, source);
+    QFETCH(bool, lumaOnly);
+
+    for (int level = 0; level < CpuFeatures::Level_Max; ++level) {
+        if (!CpuFeatures::Set((CpuFeatures::level)level))
+            continue;
+
+        int frames = 0;
+        auto difference = compare(source, lumaOnly, frames);
+        QVERIFY2(difference.isEmpty(), qPrintable(QString("%1: %2").arg(CpuFeatures::Name((CpuFeatures::level)level)).arg(difference)));
+        QVERIFY(frames > 1);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_SignalStatsKernel)
+#include "tst_signalstatskernel.moc"
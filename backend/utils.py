@@ -2,6 +2,8 @@ import gzip
 import json
 import math
 import os
+import re
+import shutil
 import subprocess
 import xml.etree.ElementTree as ET
 from copy import deepcopy
@@ -596,6 +598,21 @@ def run_qctools_analysis(file_path, preset):
     if filter_names:
         base_command.extend(["-f", "+".join(filter_names)])
 
+    # Frames for the OCR detector from this pass, so it does not decode the file again
+    overlay_text = next(
+        (item for item in preset.get("ffmpeg", []) if isinstance(item, dict) and item.get("id") == "overlaytext"),
+        None,
+    )
+    feed_dir = _ocr_frame_feed_dir(file_path)
+    if overlay_text and overlay_text.get("enabled") and cv2 is not None and pytesseract is not None:
+        params = overlay_text.get("params", {}) if isinstance(overlay_text.get("params"), dict) else {}
+        base_command.extend([
+            "-frame-feed",
+            feed_dir,
+            "-frame-feed-interval",
+            str(_ocr_sample_interval(params)),
+        ])
+
     preferred_video = "all" if preset.get("video_tracks") == "all" else "1"
     preferred_audio = "all" if preset.get("audio_tracks") == "all" else "1"
 
@@ -610,6 +627,7 @@ def run_qctools_analysis(file_path, preset):
                 os.remove(xml_output_path)
             except OSError:
                 pass
+        shutil.rmtree(feed_dir, ignore_errors=True)
 
         command = list(base_command)
         command.extend(["-video", video_opt])
@@ -1156,6 +1174,83 @@ def _parse_csv_list(text):
     return [item.strip().lower() for item in str(text).split(",") if item.strip()]
 
 
+def _ocr_sample_interval(params):
+    return max(0.2, _coerce_float(params.get("sample_interval"), 1.0) or 1.0)
+
+
+def _ocr_frame_feed_dir(file_path):
+    return f"{file_path}.ocr_frames"
+
+
+def _read_ocr_frame_feed(feed_dir):
+    """Frames written by qcli -frame-feed, (timestamp, path) of the first video stream by time."""
+    pattern = re.compile(r"^s(\d+)_t(\d+)\.pgm$")
+    by_stream: Dict[int, List[Any]] = {}
+    try:
+        names = os.listdir(feed_dir)
+    except OSError:
+        return []
+    for name in names:
+        match = pattern.match(name)
+        if match:
+            by_stream.setdefault(int(match.group(1)), []).append(
+                (int(match.group(2)) / 1000.0, os.path.join(feed_dir, name))
+            )
+    if not by_stream:
+        return []
+    return sorted(by_stream[min(by_stream)])
+
+
+def _iter_ocr_frames(file_path, sample_interval):
+    """(sample duration, iterator of (timestamp, grayscale frame, scale to the source size)), None if no frames."""
+    feed_dir = _ocr_frame_feed_dir(file_path)
+    feed = _read_ocr_frame_feed(feed_dir)
+    if feed:
+        cap = cv2.VideoCapture(file_path)
+        source_width = cap.get(cv2.CAP_PROP_FRAME_WIDTH) if cap.isOpened() else 0
+        cap.release()
+
+        def from_feed():
+            try:
+                for timestamp, path in feed:
+                    gray = cv2.imread(path, cv2.IMREAD_GRAYSCALE)
+                    if gray is None:
+                        continue
+                    scale = source_width / gray.shape[1] if source_width and gray.shape[1] else 1.0
+                    yield timestamp, gray, scale
+            finally:
+                shutil.rmtree(feed_dir, ignore_errors=True)
+
+        return sample_interval, from_feed()
+
+    cap = cv2.VideoCapture(file_path)
+    if not cap.isOpened():
+        print(f"Unable to open video for overlay text detection: {file_path}")
+        return None
+
+    fps = cap.get(cv2.CAP_PROP_FPS)
+    if not fps or fps <= 0:
+        fps = 25.0
+
+    total_frames = int(cap.get(cv2.CAP_PROP_FRAME_COUNT) or 0)
+    step = max(1, int(round(sample_interval * fps)))
+
+    def from_decoding():
+        try:
+            frame_index = 0
+            while total_frames == 0 or frame_index < total_frames:
+                cap.set(cv2.CAP_PROP_POS_FRAMES, frame_index)
+                success, frame = cap.read()
+                if not success:
+                    break
+                yield frame_index / fps, cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY), 1.0
+                frame_index += step
+        finally:
+            cap.release()
+
+    return step / fps, from_decoding()
+
+
 def detect_overlay_text(file_path, params, default_severity="non_critical"):
     if cv2 is None or pytesseract is None:
         print("Skipping overlay text detection because OCR dependencies are unavailable.")
@@ -1164,9 +1259,10 @@ def detect_overlay_text(file_path, params, default_severity="non_critical"):
     cache_path = f"{file_path}.ocr.json"
     cache = _load_ocr_cache(cache_path)
     if cache:
+        shutil.rmtree(_ocr_frame_feed_dir(file_path), ignore_errors=True)
         return cache.get("issues", [])
 
-    sample_interval = max(0.2, _coerce_float(params.get("sample_interval"), 1.0) or 1.0)
+    sample_interval = _ocr_sample_interval(params)
     min_confidence = min(100.0, max(0.0, _coerce_float(params.get("min_confidence"), 70.0) or 70.0))
     min_chars = int(max(1, _coerce_float(params.get("min_chars"), 5.0) or 5))
     min_duration = max(0.2, _coerce_float(params.get("min_duration"), 1.5) or 1.5)
@@ -1175,31 +1271,15 @@ def detect_overlay_text(file_path, params, default_severity="non_critical"):
     allowlist_phrases = _parse_csv_list(params.get("allowlist_phrases"))
     flag_keywords = _parse_csv_list(params.get("flag_keywords")) or ["click", "press", "error", "warning", "analyze"]
 
-    cap = cv2.VideoCapture(file_path)
-    if not cap.isOpened():
-        print(f"Unable to open video for overlay text detection: {file_path}")
+    frames = _iter_ocr_frames(file_path, sample_interval)
+    if frames is None:
         return []
-
-    fps = cap.get(cv2.CAP_PROP_FPS)
-    if not fps or fps <= 0:
-        fps = 25.0
-
-    total_frames = int(cap.get(cv2.CAP_PROP_FRAME_COUNT) or 0)
-    step = max(1, int(round(sample_interval * fps)))
-    sample_duration = step / fps
+    sample_duration, frames = frames
 
     tracks: Dict[str, Dict[str, Any]] = {}
     issues: List[Dict[str, Any]] = []
 
-    frame_index = 0
-    while total_frames == 0 or frame_index < total_frames:
-        cap.set(cv2.CAP_PROP_POS_FRAMES, frame_index)
-        success, frame = cap.read()
-        if not success:
-            break
-
-        timestamp = frame_index / fps if fps else 0.0
-        gray = cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY)
+    for timestamp, gray, scale in frames:
         data = pytesseract.image_to_data(gray, output_type=pytesseract.Output.DICT)
 
         seen_this_frame = set()
@@ -1219,7 +1299,7 @@ def detect_overlay_text(file_path, params, default_severity="non_critical"):
             if len(cleaned) < min_chars:
                 continue
 
-            height = int(data.get("height", [0])[idx] or 0)
+            height = int(round((data.get("height", [0])[idx] or 0) * scale))
             if height < min_box_height:
                 continue
 
@@ -1227,9 +1307,9 @@ def detect_overlay_text(file_path, params, default_severity="non_critical"):
             if allowlist_phrases and any(normalized.find(phrase) != -1 for phrase in allowlist_phrases):
                 continue
 
-            left = int(data.get("left", [0])[idx] or 0)
-            top = int(data.get("top", [0])[idx] or 0)
-            width = int(data.get("width", [0])[idx] or 0)
+            left = int(round((data.get("left", [0])[idx] or 0) * scale))
+            top = int(round((data.get("top", [0])[idx] or 0) * scale))
+            width = int(round((data.get("width", [0])[idx] or 0) * scale))
 
             seen_this_frame.add(normalized)
             track = tracks.get(normalized)
@@ -1298,10 +1378,6 @@ def detect_overlay_text(file_path, params, default_severity="non_critical"):
         for key in to_remove:
             tracks.pop(key, None)
 
-        frame_index += step
-
-    cap.release()
-
     for track in list(tracks.values()):
         end_time = track["last_seen"] + sample_duration
         duration = max(end_time - track["start"], sample_duration)